@@ -29,6 +29,12 @@ DEFINES += QT_NO_CAST_FROM_BYTEARRAY
 DEFINES += QT_NO_CAST_TO_ASCII
 #DEFINES += QT_NO_CAST_FROM_ASCII
 
+# Minimum compiled log level for the macros in src/logging/loggingmacros.h
+# 0 = debug (default), 1 = info, 2 = warning and 3 = critical. Use "qmake ATOOLS_LOG_LEVEL=1" for production builds.
+!isEmpty(ATOOLS_LOG_LEVEL) {
+  DEFINES += ATOOLS_MIN_LOG_LEVEL=$$ATOOLS_LOG_LEVEL
+}
+
 unix {
   DEFINES += GIT_REVISION_ATOOLS='\\"$$system(git rev-parse --short HEAD)\\"'
 
@@ -44,6 +50,7 @@ win32 {
   SIMCONNECT="C:\Program Files (x86)\Microsoft Games\Microsoft Flight Simulator X SDK"
   INCLUDEPATH += "C:\Program Files (x86)\Microsoft Games\Microsoft Flight Simulator X SDK\SDK\Core Utilities Kit\SimConnect SDK\inc"
   LIBS += "C:\Program Files (x86)\Microsoft Games\Microsoft Flight Simulator X SDK\SDK\Core Utilities Kit\SimConnect SDK\lib\SimConnect.lib"
+  LIBS += -lpsapi
 }
 
 macx {
@@ -176,6 +183,7 @@ HEADERS += src/atools.h \
     src/fs/sc/simconnecttypes.h \
     src/sql/sqlrecord.h \
     src/util/heap.h \
+    src/util/monotonicarena.h \
     src/util/htmlbuilder.h \
     src/gui/filehistoryhandler.h \
     src/gui/mapposhistory.h \
@@ -274,7 +282,68 @@ HEADERS += src/atools.h \
     src/gui/tools.h \
     src/fs/perf/aircraftperf.h \
     src/fs/perf/aircraftperfhandler.h \
-    src/fs/perf/aircraftperfconstants.h
+    src/fs/perf/aircraftperfconstants.h \
+    src/fs/db/bglreaderpool.h \
+    src/fs/db/filestatechecker.h \
+    src/fs/scenery/filemanifest.h \
+    src/sql/sqlprofiler.h \
+    src/geo/posarray.h \
+    src/geo/linestringindex.h \
+    src/geo/rtree.h \
+    src/geo/compactpos.h \
+    src/geo/legcache.h \
+    src/geo/polygonindex.h \
+    src/fs/common/routegraph.h \
+    src/fs/db/routegraphwriter.h \
+    src/util/indexedheap.h \
+    src/routing/routefinder.h \
+    src/fs/xp/xplinetokenizer.h \
+    src/sql/sqlbatch.h \
+    src/fs/sc/simconnectdatabuffer.h \
+    src/fs/sc/aircraftfilter.h \
+    src/fs/sc/replaywriterthread.h \
+    src/fs/sc/latencystats.h \
+    src/fs/online/onlineindex.h \
+    src/fs/weather/metarscanner.h \
+    src/fs/weather/metarindex.h \
+    src/fs/weather/metarbulkdecoder.h \
+    src/fs/weather/weatherfield.h \
+    src/io/textwriter.h \
+    src/fs/perf/samplestatistics.h \
+    src/fs/pln/flightplanconverter.h \
+    src/fs/bgl/bglwaypointwriter.h \
+    src/logging/loggingqueue.h \
+    src/logging/loggingwriterthread.h \
+    src/logging/loggingratelimiter.h \
+    src/logging/loggingmacros.h \
+    src/util/perfcounters.h \
+    src/util/tracerecorder.h \
+    src/util/memoryinfo.h \
+    src/util/flathash.h \
+    src/util/stringpool.h \
+    src/util/xxhash.h \
+    src/fs/db/navduplicateindex.h \
+    src/fs/db/navmemorystore.h \
+    src/fs/db/rtreequery.h \
+    src/fs/db/textsearchquery.h \
+    src/fs/db/maptiles.h \
+    src/fs/db/databasesnapshot.h \
+    src/fs/db/boundarylod.h \
+    src/sql/sqlconnectionpool.h \
+    src/fs/db/airportdetailreader.h \
+    src/sql/sqlwarmup.h \
+    src/util/taskscheduler.h \
+    src/fs/navdatabasebatch.h \
+    src/fs/db/idallocator.h \
+    src/fs/db/tablestatistics.h \
+    src/fs/db/compilecheckpoint.h \
+    src/fs/sc/trafficgenerator.h \
+    src/fs/sc/xpsharedmemory.h \
+    src/fs/db/proceduregeometry.h \
+    src/fs/db/hilbertorder.h \
+    src/fs/common/groundindex.h \
+    src/fs/bgl/recordlayout.h \
+    src/fs/bgl/nav/navlayout.h
 
 SOURCES += src/atools.cpp \
     src/exception.cpp \
@@ -394,6 +463,7 @@ SOURCES += src/atools.cpp \
     src/fs/sc/simconnectreply.cpp \
     src/sql/sqlrecord.cpp \
     src/util/heap.cpp \
+    src/util/monotonicarena.cpp \
     src/util/htmlbuilder.cpp \
     src/gui/filehistoryhandler.cpp \
     src/gui/mapposhistory.cpp \
@@ -491,7 +561,64 @@ SOURCES += src/atools.cpp \
     src/gui/tools.cpp \
     src/fs/perf/aircraftperf.cpp \
     src/fs/perf/aircraftperfhandler.cpp \
-    src/fs/perf/aircraftperfconstants.cpp
+    src/fs/perf/aircraftperfconstants.cpp \
+    src/fs/db/bglreaderpool.cpp \
+    src/fs/db/filestatechecker.cpp \
+    src/fs/scenery/filemanifest.cpp \
+    src/sql/sqlprofiler.cpp \
+    src/geo/posarray.cpp \
+    src/geo/linestringindex.cpp \
+    src/geo/rtree.cpp \
+    src/geo/compactpos.cpp \
+    src/geo/legcache.cpp \
+    src/geo/polygonindex.cpp \
+    src/fs/common/routegraph.cpp \
+    src/fs/db/routegraphwriter.cpp \
+    src/util/indexedheap.cpp \
+    src/routing/routefinder.cpp \
+    src/fs/xp/xplinetokenizer.cpp \
+    src/sql/sqlbatch.cpp \
+    src/fs/sc/simconnectdatabuffer.cpp \
+    src/fs/sc/aircraftfilter.cpp \
+    src/fs/sc/replaywriterthread.cpp \
+    src/fs/sc/latencystats.cpp \
+    src/fs/online/onlineindex.cpp \
+    src/fs/weather/metarscanner.cpp \
+    src/fs/weather/metarindex.cpp \
+    src/fs/weather/metarbulkdecoder.cpp \
+    src/fs/weather/weatherfield.cpp \
+    src/io/textwriter.cpp \
+    src/fs/perf/samplestatistics.cpp \
+    src/fs/pln/flightplanconverter.cpp \
+    src/fs/bgl/bglwaypointwriter.cpp \
+    src/logging/loggingwriterthread.cpp \
+    src/logging/loggingratelimiter.cpp \
+    src/util/perfcounters.cpp \
+    src/util/tracerecorder.cpp \
+    src/util/memoryinfo.cpp \
+    src/util/flathash.cpp \
+    src/util/stringpool.cpp \
+    src/util/xxhash.cpp \
+    src/fs/db/navduplicateindex.cpp \
+    src/fs/db/navmemorystore.cpp \
+    src/fs/db/rtreequery.cpp \
+    src/fs/db/textsearchquery.cpp \
+    src/fs/db/maptiles.cpp \
+    src/fs/db/databasesnapshot.cpp \
+    src/fs/db/boundarylod.cpp \
+    src/sql/sqlconnectionpool.cpp \
+    src/fs/db/airportdetailreader.cpp \
+    src/sql/sqlwarmup.cpp \
+    src/util/taskscheduler.cpp \
+    src/fs/navdatabasebatch.cpp \
+    src/fs/db/idallocator.cpp \
+    src/fs/db/tablestatistics.cpp \
+    src/fs/db/compilecheckpoint.cpp \
+    src/fs/sc/trafficgenerator.cpp \
+    src/fs/sc/xpsharedmemory.cpp \
+    src/fs/db/proceduregeometry.cpp \
+    src/fs/db/hilbertorder.cpp \
+    src/fs/common/groundindex.cpp
 
 
 unix {
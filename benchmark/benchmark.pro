@@ -0,0 +1,57 @@
+#*****************************************************************************
+# Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#****************************************************************************
+
+# Benchmarks for atools. Not part of libatools.
+# Applications using the benchmarks have to link this library before libatools.
+
+QT       += sql xml svg core widgets network
+QT       -= gui
+
+CONFIG += c++14
+
+INCLUDEPATH += $$PWD/src $$PWD/../src
+
+DEFINES += QT_NO_CAST_FROM_BYTEARRAY
+DEFINES += QT_NO_CAST_TO_ASCII
+
+unix {
+  # Enable to count allocations in ParserBenchmark. Replaces malloc for the whole application - glibc only.
+  #DEFINES+=ATOOLS_COUNT_ALLOCATIONS
+}
+
+win32 {
+  DEFINES += _USE_MATH_DEFINES
+  DEFINES += NOMINMAX
+}
+
+TARGET = atoolsbenchmark
+TEMPLATE = lib
+CONFIG += staticlib
+
+HEADERS += src/benchmark/benchmarkutil.h \
+    src/geo/geobenchmark.h \
+    src/routing/routebenchmark.h \
+    src/fs/xp/xpcompilebenchmark.h \
+    src/fs/db/readbenchmark.h \
+    src/fs/util/parserbenchmark.h
+
+SOURCES += src/benchmark/benchmarkutil.cpp \
+    src/geo/geobenchmark.cpp \
+    src/routing/routebenchmark.cpp \
+    src/fs/xp/xpcompilebenchmark.cpp \
+    src/fs/db/readbenchmark.cpp \
+    src/fs/util/parserbenchmark.cpp
@@ -0,0 +1,114 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "benchmark/benchmarkutil.h"
+#include "atools.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTextStream>
+
+#include <algorithm>
+#include <numeric>
+
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+namespace atools {
+namespace benchmark {
+
+double elapsedMs(const QElapsedTimer& timer)
+{
+  return timer.nsecsElapsed() / 1000000.;
+}
+
+double measureMs(const std::function<void()>& function)
+{
+  QElapsedTimer timer;
+  timer.start();
+  function();
+  return elapsedMs(timer);
+}
+
+TimingSummary summarize(QVector<double> timesMs)
+{
+  TimingSummary summary = {timesMs.size(), 0., 0., 0., 0., 0.};
+  if(!timesMs.isEmpty())
+  {
+    std::sort(timesMs.begin(), timesMs.end());
+    auto percentile = [&timesMs](double fraction) -> double
+                      {
+                        return timesMs.at(static_cast<int>(fraction * (timesMs.size() - 1) + 0.5));
+                      };
+
+    summary.totalMs = std::accumulate(timesMs.begin(), timesMs.end(), 0.);
+    summary.p50Ms = percentile(0.5);
+    summary.p90Ms = percentile(0.9);
+    summary.p99Ms = percentile(0.99);
+    summary.maxMs = timesMs.last();
+  }
+  return summary;
+}
+
+qint64 peakMemoryKb()
+{
+#if defined(Q_OS_UNIX)
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) == 0)
+#if defined(Q_OS_MAC)
+    // Bytes on macOS
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+  return -1;
+}
+
+void printBuildInfo(QTextStream& out)
+{
+  out << "Build " << QSysInfo::buildAbi() << " CPU " << QSysInfo::currentCpuArchitecture()
+      << " OS " << QSysInfo::prettyProductName() << endl;
+}
+
+void printTimingHeader(QTextStream& out)
+{
+  out << "Total ms" << "P50 ms" << "P90 ms" << "P99 ms" << "Max ms";
+}
+
+void printTiming(QTextStream& out, const TimingSummary& summary)
+{
+  out << QString::number(summary.totalMs, 'f', 2) << QString::number(summary.p50Ms, 'f', 3)
+      << QString::number(summary.p90Ms, 'f', 3) << QString::number(summary.p99Ms, 'f', 3)
+      << QString::number(summary.maxMs, 'f', 3);
+}
+
+QJsonObject buildInfoJson()
+{
+  QJsonObject info;
+  info.insert("compiler_version", QString("atools %1 (revision %2)").arg(atools::version()).arg(atools::gitRevision()));
+  info.insert("build", QSysInfo::buildAbi());
+  info.insert("cpu", QSysInfo::currentCpuArchitecture());
+  info.insert("timestamp", QDateTime::currentDateTime().toString(Qt::ISODate));
+  return info;
+}
+
+} // namespace benchmark
+} // namespace atools
@@ -0,0 +1,64 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_BENCHMARK_BENCHMARKUTIL_H
+#define ATOOLS_BENCHMARK_BENCHMARKUTIL_H
+
+#include <QVector>
+
+#include <functional>
+
+class QElapsedTimer;
+class QJsonObject;
+class QTextStream;
+
+namespace atools {
+namespace benchmark {
+
+/* Summary of a number of timed samples. All times are in milliseconds and are 0 if there are no samples. */
+struct TimingSummary
+{
+  int count;
+  double totalMs, p50Ms, p90Ms, p99Ms, maxMs;
+};
+
+/* Time since start of timer in milliseconds with the timer's full resolution */
+double elapsedMs(const QElapsedTimer& timer);
+
+/* Call function once and return the elapsed time in milliseconds */
+double measureMs(const std::function<void()>& function);
+
+/* Sum, percentiles and maximum of the given samples */
+atools::benchmark::TimingSummary summarize(QVector<double> timesMs);
+
+/* Peak resident memory of the process or -1 if not available on this platform */
+qint64 peakMemoryKb();
+
+/* Print one line with ABI, CPU and operating system to be placed above result tables */
+void printBuildInfo(QTextStream& out);
+
+/* Print the column headers and the values of a summary as five columns with the currently set field width */
+void printTimingHeader(QTextStream& out);
+void printTiming(QTextStream& out, const atools::benchmark::TimingSummary& summary);
+
+/* Compiler version, ABI, CPU and timestamp for JSON reports */
+QJsonObject buildInfoJson();
+
+} // namespace benchmark
+} // namespace atools
+
+#endif // ATOOLS_BENCHMARK_BENCHMARKUTIL_H
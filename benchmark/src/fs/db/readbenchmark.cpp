@@ -0,0 +1,389 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/readbenchmark.h"
+
+#include "fs/db/airportdetailreader.h"
+#include "fs/db/navmemorystore.h"
+#include "fs/db/rtreequery.h"
+#include "fs/db/textsearchquery.h"
+#include "geo/calculations.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlutil.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+#include <algorithm>
+#include <random>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+using atools::sql::SqlQuery;
+using atools::geo::Pos;
+using atools::geo::Rect;
+
+/* Fixed seed for comparable workloads */
+const static unsigned int SEED = 4711;
+
+/* Radius for nearest navaid queries */
+const static float NEAREST_RADIUS_METER = atools::geo::nmToMeter(200.f);
+const static int NEAREST_NUM = 10;
+
+/* Tables for viewport queries and the corresponding memory store type */
+const static QVector<std::pair<QString, NavStoreType> > VIEWPORT_TABLES = {
+  std::make_pair(QString("airport"), STORE_AIRPORT),
+  std::make_pair(QString("vor"), STORE_VOR),
+  std::make_pair(QString("ndb"), STORE_NDB),
+  std::make_pair(QString("waypoint"), STORE_WAYPOINT)
+};
+
+ReadBenchmark::ReadBenchmark(sql::SqlDatabase *sqlDb)
+  : db(sqlDb)
+{
+
+}
+
+void ReadBenchmark::generateWorkload(int num)
+{
+  workload = ReadBenchmarkWorkload();
+  std::mt19937 generator(SEED);
+
+  // Airports are used as anchors for viewports and positions
+  QVector<Pos> airportPos;
+  QVector<int> airportIds;
+  QStringList names;
+  SqlQuery query(db);
+  query.setForwardOnly(true);
+  query.exec("select airport_id, ident, name, lonx, laty from airport order by airport_id");
+  while(query.next())
+  {
+    airportIds.append(query.valueInt(0));
+    names.append(query.valueStr(1));
+    names.append(query.valueStr(2).section(' ', 0, 0));
+    airportPos.append(Pos(query.valueFloat(3), query.valueFloat(4)));
+  }
+
+  query.exec("select ident from nav_search order by nav_search_id");
+  while(query.next())
+    names.append(query.valueStr(0));
+  names.removeAll(QString());
+
+  if(airportIds.isEmpty() || names.isEmpty())
+  {
+    qWarning() << Q_FUNC_INFO << "No airports or navaids in database";
+    return;
+  }
+
+  std::uniform_int_distribution<int> airportDist(0, airportIds.size() - 1);
+  std::uniform_int_distribution<int> nameDist(0, names.size() - 1);
+  std::uniform_int_distribution<int> prefixDist(1, 4);
+  std::uniform_real_distribution<float> sizeDist(0.5f, 20.f), jitterDist(-0.5f, 0.5f);
+
+  for(int i = 0; i < num; i++)
+  {
+    // Viewport centered at a random airport not crossing the anti-meridian
+    const Pos& center = airportPos.at(airportDist(generator));
+    float width = sizeDist(generator), height = width / 2.f;
+    float west = std::max(center.getLonX() - width / 2.f, -180.f), east = std::min(west + width, 180.f);
+    float north = std::min(center.getLatY() + height / 2.f, 90.f), south = std::max(north - height, -90.f);
+    workload.viewports.append(Rect(west, north, east, south));
+
+    const Pos& pos = airportPos.at(airportDist(generator));
+    workload.positions.append(Pos(pos.getLonX() + jitterDist(generator), pos.getLatY() + jitterDist(generator)));
+
+    workload.searchTexts.append(names.at(nameDist(generator)).left(prefixDist(generator)));
+    workload.airportIds.append(airportIds.at(airportDist(generator)));
+  }
+}
+
+bool ReadBenchmark::loadWorkload(const QString& filename)
+{
+  QFile file(filename);
+  if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+    return false;
+  }
+
+  workload = ReadBenchmarkWorkload();
+  QTextStream stream(&file);
+  stream.setCodec("UTF-8");
+  int lineNum = 0;
+  while(!stream.atEnd())
+  {
+    QString line = stream.readLine().trimmed();
+    lineNum++;
+    if(line.isEmpty() || line.startsWith('#'))
+      continue;
+
+    QString type = line.section(' ', 0, 0).toLower();
+    QString value = line.section(' ', 1).trimmed();
+    QStringList values = value.split(' ', QString::SkipEmptyParts);
+
+    if(type == "viewport" && values.size() == 4)
+      workload.viewports.append(Rect(values.at(0).toFloat(), values.at(1).toFloat(),
+                                     values.at(2).toFloat(), values.at(3).toFloat()));
+    else if(type == "nearest" && values.size() == 2)
+      workload.positions.append(Pos(values.at(0).toFloat(), values.at(1).toFloat()));
+    else if(type == "search" && !value.isEmpty())
+      workload.searchTexts.append(value);
+    else if(type == "airport" && values.size() == 1)
+      workload.airportIds.append(values.at(0).toInt());
+    else
+      qWarning() << Q_FUNC_INFO << filename << "Invalid line" << lineNum << line;
+  }
+  file.close();
+  return true;
+}
+
+QVector<ReadBenchmarkResult> ReadBenchmark::run()
+{
+  QVector<ReadBenchmarkResult> results;
+  const ReadBenchmarkWorkload& wl = workload;
+
+  // Check features =====================================================
+  bool rtree = features.testFlag(READ_RTREE), fts = features.testFlag(READ_FTS),
+       memory = features.testFlag(READ_MEMORY_STORE);
+
+  if(rtree && (!RTreeQuery::isAvailable(db) || !RTreeQuery::hasIndex(db, "airport")))
+  {
+    qWarning() << Q_FUNC_INFO << "R*Tree not available - skipping";
+    rtree = false;
+  }
+
+  if(fts && (!TextSearchQuery::isAvailable(db) || !TextSearchQuery::hasIndex(db)))
+  {
+    qWarning() << Q_FUNC_INFO << "FTS5 not available - skipping";
+    fts = false;
+  }
+
+  NavMemoryStore store;
+  if(memory)
+    results.append(measure("memory store load", 1, [&](int) -> int {
+      store.load(db);
+      return store.size(STORE_AIRPORT) + store.size(STORE_WAYPOINT) + store.size(STORE_VOR) +
+      store.size(STORE_NDB);
+    }));
+
+  // Viewport =====================================================
+  for(const std::pair<QString, NavStoreType>& table : VIEWPORT_TABLES)
+  {
+    QString idCol = table.first + "_id";
+    SqlQuery query(db);
+    query.prepare("select " + idCol + ", ident, lonx, laty from " + table.first +
+                  " where lonx between :west and :east and laty between :south and :north");
+
+    results.append(measure("viewport " + table.first, wl.viewports.size(), [&](int index) -> int {
+      const Rect& rect = wl.viewports.at(index);
+      query.bindValue(":west", rect.getWest());
+      query.bindValue(":east", rect.getEast());
+      query.bindValue(":south", rect.getSouth());
+      query.bindValue(":north", rect.getNorth());
+      query.exec();
+      int rows = 0;
+      while(query.next())
+        rows++;
+      return rows;
+    }));
+
+    if(rtree && RTreeQuery::hasIndex(db, table.first))
+    {
+      results.append(measure("viewport " + table.first + " rtree", wl.viewports.size(), [&](int index) -> int {
+        SqlQuery rtreeQuery(db);
+        rtreeQuery.exec("select " + idCol + ", ident, lonx, laty from " + table.first + " where " +
+                        RTreeQuery::rectCondition(table.first, idCol, wl.viewports.at(index)));
+        int rows = 0;
+        while(rtreeQuery.next())
+          rows++;
+        return rows;
+      }));
+    }
+
+    if(memory)
+    {
+      QVector<int> rows;
+      results.append(measure("viewport " + table.first + " memory", wl.viewports.size(), [&](int index) -> int {
+        store.getRowsInRect(rows, table.second, wl.viewports.at(index));
+        return rows.size();
+      }));
+    }
+  }
+
+  // Nearest =====================================================
+  {
+    SqlQuery query(db);
+    query.prepare("select vor_id, lonx, laty from vor "
+                  "where lonx between :west and :east and laty between :south and :north");
+    results.append(measure("nearest vor", wl.positions.size(), [&](int index) -> int {
+      const Pos& pos = wl.positions.at(index);
+      Rect rect(pos, NEAREST_RADIUS_METER);
+      query.bindValue(":west", rect.getWest());
+      query.bindValue(":east", rect.getEast());
+      query.bindValue(":south", rect.getSouth());
+      query.bindValue(":north", rect.getNorth());
+      query.exec();
+
+      QVector<std::pair<float, int> > nearest;
+      while(query.next())
+      {
+        float dist = pos.distanceMeterTo(Pos(query.valueFloat(1), query.valueFloat(2)));
+        if(dist <= NEAREST_RADIUS_METER)
+          nearest.append(std::make_pair(dist, query.valueInt(0)));
+      }
+      int num = std::min(NEAREST_NUM, nearest.size());
+      std::partial_sort(nearest.begin(), nearest.begin() + num, nearest.end());
+      return num;
+    }));
+
+    if(memory)
+      results.append(measure("nearest vor memory", wl.positions.size(), [&](int index) -> int {
+        return store.getRowsNearest(STORE_VOR, wl.positions.at(index), NEAREST_NUM, NEAREST_RADIUS_METER).size();
+      }));
+  }
+
+  // Search =====================================================
+  {
+    SqlQuery navQuery(db), airportQuery(db);
+    navQuery.prepare("select nav_search_id, ident, name from nav_search where ident like :text limit 20");
+    airportQuery.prepare("select airport_id, ident, name from airport "
+                         "where ident like :text or name like :text limit 20");
+    results.append(measure("search", wl.searchTexts.size(), [&](int index) -> int {
+      int rows = 0;
+      for(SqlQuery *query : {&navQuery, &airportQuery})
+      {
+        query->bindValue(":text", wl.searchTexts.at(index) + "%");
+        query->exec();
+        while(query->next())
+          rows++;
+      }
+      return rows;
+    }));
+
+    if(fts)
+      results.append(measure("search fts", wl.searchTexts.size(), [&](int index) -> int {
+        return TextSearchQuery::autocomplete(db, wl.searchTexts.at(index)).size();
+      }));
+  }
+
+  // Airport details =====================================================
+  {
+    AirportDetailReader reader(db);
+    AirportDetail detail;
+    results.append(measure("airport details", wl.airportIds.size(), [&](int index) -> int {
+      return reader.getDetail(detail, wl.airportIds.at(index)) ? 1 : 0;
+    }));
+
+    // Batches of 20 like an airport cluster on the map
+    const int BATCH = 20;
+    QVector<AirportDetail> details;
+    results.append(measure("airport details batch", (wl.airportIds.size() + BATCH - 1) / BATCH,
+                           [&](int index) -> int {
+      reader.getDetails(details, wl.airportIds.mid(index * BATCH, BATCH));
+      return details.size();
+    }));
+  }
+
+  // Procedures =====================================================
+  {
+    SqlQuery approachQuery(db), approachLegQuery(db), transitionQuery(db), transitionLegQuery(db);
+    approachQuery.prepare("select * from approach where airport_id = :id");
+    approachLegQuery.prepare("select * from approach_leg where approach_id = :id order by approach_leg_id");
+    transitionQuery.prepare("select * from transition where approach_id = :id");
+    transitionLegQuery.prepare("select * from transition_leg where transition_id = :id "
+                               "order by transition_leg_id");
+
+    results.append(measure("procedures", wl.airportIds.size(), [&](int index) -> int {
+      int rows = 0;
+      QVector<int> approachIds, transitionIds;
+      approachQuery.bindValue(":id", wl.airportIds.at(index));
+      approachQuery.exec();
+      while(approachQuery.next())
+        approachIds.append(approachQuery.valueInt("approach_id"));
+      rows += approachIds.size();
+
+      for(int approachId : approachIds)
+      {
+        approachLegQuery.bindValue(":id", approachId);
+        approachLegQuery.exec();
+        while(approachLegQuery.next())
+          rows++;
+
+        transitionQuery.bindValue(":id", approachId);
+        transitionQuery.exec();
+        while(transitionQuery.next())
+          transitionIds.append(transitionQuery.valueInt("transition_id"));
+      }
+      rows += transitionIds.size();
+
+      for(int transitionId : transitionIds)
+      {
+        transitionLegQuery.bindValue(":id", transitionId);
+        transitionLegQuery.exec();
+        while(transitionLegQuery.next())
+          rows++;
+      }
+      return rows;
+    }));
+  }
+
+  return results;
+}
+
+ReadBenchmarkResult ReadBenchmark::measure(const QString& name, int count,
+                                           const std::function<int(int index)>& function)
+{
+  qint64 rows = 0;
+  QVector<double> timesMs;
+  timesMs.reserve(count);
+
+  QElapsedTimer timer;
+  for(int i = 0; i < count; i++)
+  {
+    timer.start();
+    rows += function(i);
+    timesMs.append(atools::benchmark::elapsedMs(timer));
+  }
+  return {name, rows, atools::benchmark::summarize(timesMs)};
+}
+
+void ReadBenchmark::print(QTextStream& out, const QVector<ReadBenchmarkResult>& results)
+{
+  atools::benchmark::printBuildInfo(out);
+
+  out << qSetFieldWidth(28) << left << "Query" << qSetFieldWidth(8) << right << "Count"
+      << qSetFieldWidth(10) << "Rows" << qSetFieldWidth(12);
+  atools::benchmark::printTimingHeader(out);
+  out << qSetFieldWidth(0) << endl;
+
+  for(const ReadBenchmarkResult& result : results)
+  {
+    out << qSetFieldWidth(28) << left << result.name << qSetFieldWidth(8) << right << result.timing.count
+        << qSetFieldWidth(10) << result.rows << qSetFieldWidth(12);
+    atools::benchmark::printTiming(out, result.timing);
+    out << qSetFieldWidth(0) << endl;
+  }
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
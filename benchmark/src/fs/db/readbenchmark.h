@@ -0,0 +1,124 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_READBENCHMARK_H
+#define ATOOLS_FS_DB_READBENCHMARK_H
+
+#include "benchmark/benchmarkutil.h"
+#include "geo/rect.h"
+
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+class QTextStream;
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace db {
+
+/* Result of one query class. rows is the sum of all returned rows. */
+struct ReadBenchmarkResult
+{
+  QString name;
+  qint64 rows;
+  atools::benchmark::TimingSummary timing;
+};
+
+/* Optional features to compare against plain SQL queries */
+enum ReadBenchmarkFeature
+{
+  READ_SQL = 0,
+  READ_RTREE = 1 << 0, /* Viewport queries using the R*Tree tables */
+  READ_FTS = 1 << 1, /* Ident and name search using the FTS5 table */
+  READ_MEMORY_STORE = 1 << 2 /* Viewport and nearest queries using NavMemoryStore */
+};
+
+Q_DECLARE_FLAGS(ReadBenchmarkFeatures, ReadBenchmarkFeature);
+Q_DECLARE_OPERATORS_FOR_FLAGS(atools::fs::db::ReadBenchmarkFeatures);
+
+/* Queries to run. Each list is one query class. */
+struct ReadBenchmarkWorkload
+{
+  QVector<atools::geo::Rect> viewports;
+  QVector<atools::geo::Pos> positions;
+  QStringList searchTexts;
+  QVector<int> airportIds;
+};
+
+/*
+ * Benchmark for the read side of a compiled database. Measures viewport queries for airports and navaids,
+ * nearest navaids, ident and name search, airport details and procedure loading.
+ *
+ * The workload can be generated from the database with a fixed seed or loaded from a text file with one query
+ * per line. Empty lines and lines starting with "#" are ignored:
+ * viewport <west> <north> <east> <south>
+ * nearest <lonx> <laty>
+ * search <text>
+ * airport <airport_id>
+ *
+ * Features that are not available in the database are skipped with a warning.
+ * The database is not modified.
+ */
+class ReadBenchmark
+{
+public:
+  explicit ReadBenchmark(atools::sql::SqlDatabase *sqlDb);
+
+  /* Generate num queries for each class from random airports and navaids of the database */
+  void generateWorkload(int num);
+
+  /* Load workload file as described above. Returns false if the file cannot be read. */
+  bool loadWorkload(const QString& filename);
+
+  const atools::fs::db::ReadBenchmarkWorkload& getWorkload() const
+  {
+    return workload;
+  }
+
+  /* Features to use in addition to plain SQL. Default is READ_SQL only. */
+  void setFeatures(atools::fs::db::ReadBenchmarkFeatures value)
+  {
+    features = value;
+  }
+
+  /* Run all query classes */
+  QVector<atools::fs::db::ReadBenchmarkResult> run();
+
+  /* Print results as a table with one line per query class */
+  static void print(QTextStream& out, const QVector<atools::fs::db::ReadBenchmarkResult>& results);
+
+private:
+  /* Call function count times with the query index. Function returns the number of rows. */
+  static atools::fs::db::ReadBenchmarkResult measure(const QString& name, int count,
+                                                     const std::function<int(int index)>& function);
+
+  atools::sql::SqlDatabase *db;
+  atools::fs::db::ReadBenchmarkWorkload workload;
+  atools::fs::db::ReadBenchmarkFeatures features = READ_SQL;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_READBENCHMARK_H
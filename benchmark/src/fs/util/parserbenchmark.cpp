@@ -0,0 +1,701 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/util/parserbenchmark.h"
+
+#include "benchmark/benchmarkutil.h"
+#include "exception.h"
+#include "fs/online/onlinedatamanager.h"
+#include "fs/perf/aircraftperf.h"
+#include "fs/pln/flightplan.h"
+#include "fs/pln/flightplanio.h"
+#include "fs/weather/metarparser.h"
+#include "io/inireader.h"
+#include "util/csvreader.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+
+// Allocation counting ==================================================================
+#if defined(ATOOLS_COUNT_ALLOCATIONS) && defined(__GLIBC__)
+#define ATOOLS_ALLOCATION_COUNTER
+
+/* Replaces the glibc allocation functions for the whole application. operator new and Qt containers
+ * end up here too. free() is not replaced since only the number of allocations is of interest. */
+static std::atomic<qint64> allocationCounter(0);
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t num, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size)
+{
+  allocationCounter.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t num, size_t size)
+{
+  allocationCounter.fetch_add(1, std::memory_order_relaxed);
+  return __libc_calloc(num, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+  allocationCounter.fetch_add(1, std::memory_order_relaxed);
+  return __libc_realloc(ptr, size);
+}
+
+}
+#endif
+
+namespace atools {
+namespace fs {
+namespace util {
+
+using atools::geo::Pos;
+using atools::fs::pln::Flightplan;
+using atools::fs::pln::FlightplanEntry;
+using atools::fs::pln::FlightplanIO;
+
+/* Fixed seed for comparable corpora */
+const static unsigned int SEED = 4711;
+
+static qint64 currentAllocations()
+{
+#ifdef ATOOLS_ALLOCATION_COUNTER
+  return allocationCounter.load(std::memory_order_relaxed);
+
+#else
+  return 0;
+
+#endif
+}
+
+/* Random uppercase identifier */
+static QString randomIdent(std::mt19937& generator, int length)
+{
+  std::uniform_int_distribution<int> letterDist(0, 25);
+  QString ident;
+  for(int i = 0; i < length; i++)
+    ident.append(QChar('A' + letterDist(generator)));
+  return ident;
+}
+
+/* Random printable text with spaces */
+static QString randomText(std::mt19937& generator, int length)
+{
+  std::uniform_int_distribution<int> wordDist(2, 9);
+  QString text;
+  while(text.size() < length)
+  {
+    if(!text.isEmpty())
+      text.append(' ');
+    text.append(randomIdent(generator, wordDist(generator)).toLower());
+  }
+  return text.left(length);
+}
+
+/* N50* 2.00', E008* 34.33', +000364.00 */
+static QString coordStringFs9(const Pos& pos)
+{
+  float lat = std::abs(pos.getLatY()), lon = std::abs(pos.getLonX());
+  return QString("%1%2* %3', %4%5* %6', +%7").
+         arg(pos.getLatY() > 0.f ? "N" : "S").arg(static_cast<int>(lat), 2, 10, QChar('0')).
+         arg((lat - std::floor(lat)) * 60.f, 0, 'f', 2).
+         arg(pos.getLonX() > 0.f ? "E" : "W").arg(static_cast<int>(lon), 3, 10, QChar('0')).
+         arg((lon - std::floor(lon)) * 60.f, 0, 'f', 2).
+         arg(pos.getAltitude(), 9, 'f', 2, QChar('0'));
+}
+
+/* Airport to airport plan with the given number of enroute waypoints along a great circle like line */
+static Flightplan generatePlan(std::mt19937& generator, int numWaypoints)
+{
+  std::uniform_real_distribution<float> jitterDist(-0.3f, 0.3f);
+  std::uniform_int_distribution<int> typeDist(0, 2), airwayDist(0, 3), identLenDist(3, 5);
+
+  const Pos departure(8.570556f, 50.033333f, 364.f), destination(-73.778889f, 40.639722f, 13.f);
+
+  Flightplan plan;
+  plan.setTitle("EDDF to KJFK");
+  plan.setDescription("EDDF, KJFK");
+  plan.setFlightplanType(atools::fs::pln::IFR);
+  plan.setRouteType(atools::fs::pln::HIGH_ALTITUDE);
+  plan.setCruisingAltitude(35000);
+  plan.setDepartureIdent("EDDF");
+  plan.setDepartureAiportName("Frankfurt Am Main");
+  plan.setDeparturePosition(departure);
+  plan.setDestinationIdent("KJFK");
+  plan.setDestinationAiportName("John F Kennedy Intl");
+  plan.setDestinationPosition(destination);
+
+  FlightplanEntry start;
+  start.setWaypointType(atools::fs::pln::entry::AIRPORT);
+  start.setIcaoIdent("EDDF");
+  start.setWaypointId("EDDF");
+  start.setPosition(departure);
+  plan.appendEntry(std::move(start));
+
+  QString airway;
+  for(int i = 0; i < numWaypoints; i++)
+  {
+    float fraction = (i + 1.f) / (numWaypoints + 1.f);
+    Pos pos(departure.getLonX() + (destination.getLonX() - departure.getLonX()) * fraction + jitterDist(generator),
+            departure.getLatY() + (destination.getLatY() - departure.getLatY()) * fraction + jitterDist(generator));
+
+    // Change airway every few waypoints and use direct legs in between
+    if(i % 5 == 0)
+      airway = airwayDist(generator) == 0 ? QString() : randomIdent(generator, 1) + QString::number(i % 900 + 1);
+
+    FlightplanEntry entry;
+    int type = typeDist(generator);
+    QString ident = randomIdent(generator, type == 0 ? 5 : identLenDist(generator) - (type == 2 ? 1 : 0));
+    entry.setWaypointType(type == 0 ? atools::fs::pln::entry::INTERSECTION :
+                          (type == 1 ? atools::fs::pln::entry::VOR : atools::fs::pln::entry::NDB));
+    entry.setIcaoIdent(ident);
+    entry.setWaypointId(ident);
+    entry.setIcaoRegion(randomIdent(generator, 2));
+    entry.setAirway(airway);
+    entry.setPosition(pos);
+    plan.appendEntry(std::move(entry));
+  }
+
+  FlightplanEntry end;
+  end.setWaypointType(atools::fs::pln::entry::AIRPORT);
+  end.setIcaoIdent("KJFK");
+  end.setWaypointId("KJFK");
+  end.setPosition(destination);
+  plan.appendEntry(std::move(end));
+  return plan;
+}
+
+/* FS9 PLN as written by FS9 itself since FlightplanIO cannot save this format */
+static QString fs9Text(const Flightplan& plan)
+{
+  QString text;
+  QTextStream stream(&text, QIODevice::WriteOnly);
+  stream << "[flightplan]" << endl
+         << "AppVersion=9.1.40901" << endl
+         << "title=" << plan.getTitle() << endl
+         << "description=" << plan.getDescription() << endl
+         << "type=IFR" << endl
+         << "routetype=1" << endl
+         << "cruising_altitude=" << plan.getCruisingAltitude() << endl
+         << "departure_id=" << plan.getDepartureIdent() << ", " << coordStringFs9(plan.getDeparturePosition()) << endl
+         << "departure_position=1" << endl
+         << "destination_id=" << plan.getDestinationIdent() << ", "
+         << coordStringFs9(plan.getDestinationPosition()) << endl
+         << "departure_name=" << plan.getDepartureAiportName().toUpper() << endl
+         << "destination_name=" << plan.getDestinationAiportName().toUpper() << endl
+         << "alternate_name=" << endl;
+
+  // waypoint.1=KK, WIK, , WIK, V, N58* 27.53', W003* 06.02', +000000.00,J555
+  int index = 0;
+  for(const FlightplanEntry& entry : plan.getEntries())
+    stream << "waypoint." << index++ << "=" << entry.getIcaoRegion() << ", " << entry.getIcaoIdent() << ", , "
+           << entry.getWaypointId() << ", " << entry.getWaypointTypeAsStringShort() << ", "
+           << coordStringFs9(entry.getPosition()) << "," << entry.getAirway() << endl;
+  stream.flush();
+  return text;
+}
+
+static bool writeFile(const QString& filename, const QString& text)
+{
+  QFile file(filename);
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+    return false;
+  }
+  file.write(text.toUtf8());
+  file.close();
+  return true;
+}
+
+/* Counts sections and key/value pairs */
+class CountingIniReader :
+  public atools::io::IniReader
+{
+public:
+  qint64 sections = 0, keyValues = 0;
+
+protected:
+  virtual void onStartDocument(const QString&) override
+  {
+  }
+
+  virtual void onEndDocument(const QString&) override
+  {
+  }
+
+  virtual void onStartSection(const QString&, const QString&) override
+  {
+    sections++;
+  }
+
+  virtual void onEndSection(const QString&, const QString&) override
+  {
+  }
+
+  virtual void onKeyValue(const QString&, const QString&, const QString&, const QString&) override
+  {
+    keyValues++;
+  }
+
+};
+
+ParserBenchmark::ParserBenchmark(sql::SqlDatabase *onlineDb)
+  : db(onlineDb)
+{
+
+}
+
+bool ParserBenchmark::isCountingAllocations()
+{
+#ifdef ATOOLS_ALLOCATION_COUNTER
+  return true;
+
+#else
+  return false;
+
+#endif
+}
+
+QVector<ParserBenchmarkResult> ParserBenchmark::run()
+{
+  QVector<ParserBenchmarkResult> results;
+
+  QTemporaryDir tempDir;
+  if(!tempDir.isValid())
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot create temporary directory";
+    return results;
+  }
+
+  try
+  {
+    runFlightplan(results, tempDir.path());
+    runMetar(results);
+    runWhazzup(results);
+    runCsv(results);
+    runIni(results, tempDir.path());
+    runPerf(results, tempDir.path());
+  }
+  catch(atools::Exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Benchmark failed" << e.what();
+  }
+  return results;
+}
+
+void ParserBenchmark::runFlightplan(QVector<ParserBenchmarkResult>& results, const QString& dir)
+{
+  std::mt19937 generator(SEED);
+  FlightplanIO io;
+
+  // Typical airline route and oceanic worst-case with many waypoints
+  for(const std::pair<QString, int>& corpus : {std::make_pair(QString("representative"), 30),
+                                               std::make_pair(QString("worst-case"), 2000)})
+  {
+    Flightplan plan = generatePlan(generator, corpus.second);
+    int iterations = std::max(1, 6000 / corpus.second) * scale;
+
+    QString base = dir + "/plan_" + QString::number(corpus.second);
+    io.saveFsx(plan, base + ".pln", atools::fs::pln::SAVE_NO_OPTIONS);
+    io.saveFms(plan, base + ".fms", "1810", true);
+    io.saveFlp(plan, base + ".flp");
+    writeFile(base + "_fs9.pln", fs9Text(plan));
+
+    // load() detects the format from the file prefix first which is part of the measurement
+    for(const std::pair<QString, QString>& format : {std::make_pair(QString("FSX PLN"), QString(".pln")),
+                                                     std::make_pair(QString("FS9 PLN"), QString("_fs9.pln")),
+                                                     std::make_pair(QString("FMS 11"), QString(".fms")),
+                                                     std::make_pair(QString("FLP"), QString(".flp"))})
+    {
+      QString filename = base + format.second;
+      results.append(measure(format.first + " " + corpus.first, iterations, QFileInfo(filename).size(),
+                             [&]() -> qint64 {
+        Flightplan loaded;
+        io.load(loaded, filename);
+        return loaded.getEntries().size();
+      }));
+    }
+  }
+}
+
+void ParserBenchmark::runMetar(QVector<ParserBenchmarkResult>& results)
+{
+  std::mt19937 generator(SEED);
+  std::uniform_int_distribution<int> dirDist(0, 35), speedDist(2, 25), cloudDist(5, 250), tempDist(-15, 30),
+  qnhDist(980, 1040), dayDist(1, 28), minDist(0, 59);
+
+  const static QStringList WEATHER({"-RA", "RA", "+SHRA", "BR", "FG", "-SN", "TSRA", "-DZ", "VCSH", "HZ"});
+  const static QStringList COVER({"FEW", "SCT", "BKN", "OVC"});
+
+  QStringList representative, worst;
+  for(int i = 0; i < 5000 * scale; i++)
+  {
+    QString station = randomIdent(generator, 4);
+    QString time = QString("%1%2%3Z").arg(dayDist(generator), 2, 10, QChar('0')).
+                   arg(i % 24, 2, 10, QChar('0')).arg(minDist(generator), 2, 10, QChar('0'));
+    int temp = tempDist(generator);
+    QString tempStr = QString("%1%2/%3%4").arg(temp < 0 ? "M" : "").arg(std::abs(temp), 2, 10, QChar('0')).
+                      arg(temp - 3 < 0 ? "M" : "").arg(std::abs(temp - 3), 2, 10, QChar('0'));
+
+    // EDDF 141350Z 24012KT 9999 FEW035 SCT050 12/07 Q1015 NOSIG
+    representative.append(QString("%1 %2 %3%4KT 9999 %5%6 %7 Q%8 NOSIG").
+                          arg(station).arg(time).
+                          arg(dirDist(generator) * 10, 3, 10, QChar('0')).
+                          arg(speedDist(generator), 2, 10, QChar('0')).
+                          arg(COVER.at(i % 2)).arg(cloudDist(generator), 3, 10, QChar('0')).
+                          arg(tempStr).arg(qnhDist(generator)));
+
+    // Variable gusting wind, runway visual range, several weather and cloud groups, trends and remarks
+    QStringList groups({station, time, "AUTO",
+                        QString("%1%2G%3KT").arg(dirDist(generator) * 10, 3, 10, QChar('0')).
+                        arg(speedDist(generator), 2, 10, QChar('0')).arg(speedDist(generator) + 25),
+                        "280V340", "1 1/2SM", "R04R/2600V4000FT", "R22L/P6000FT"});
+    for(int w = 0; w < 3; w++)
+      groups.append(WEATHER.at((i + w) % WEATHER.size()));
+    for(int c = 0; c < 4; c++)
+      groups.append(COVER.at(c) + QString("%1").arg(cloudDist(generator) / (4 - c), 3, 10, QChar('0')) +
+                    (c == 3 ? "CB" : ""));
+    groups << tempStr << QString("A%1").arg(2900 + qnhDist(generator) % 100) << "WS R22L"
+           << "TEMPO 2000 +TSRA BKN005CB" << "BECMG 25020G35KT 4000 SHRA OVC010"
+           << "RMK AO2 PK WND 30032/1335 SLP132 P0012 T01780172 10189 20150 53012";
+    worst.append(groups.join(' '));
+  }
+
+  for(const std::pair<QString, const QStringList *>& corpus :
+      {std::make_pair(QString("METAR representative"), &representative),
+       std::make_pair(QString("METAR worst-case"), &worst)})
+  {
+    qint64 bytes = 0;
+    for(const QString& metar : *corpus.second)
+      bytes += metar.size();
+
+    results.append(measure(corpus.first, 1, bytes, [&]() -> qint64 {
+      qint64 records = 0;
+      for(const QString& metar : *corpus.second)
+      {
+        atools::fs::weather::MetarParser parser(metar);
+        if(parser.isValid())
+          records++;
+      }
+      return records;
+    }));
+  }
+}
+
+void ParserBenchmark::runWhazzup(QVector<ParserBenchmarkResult>& results)
+{
+  if(db == nullptr)
+  {
+    qWarning() << Q_FUNC_INFO << "No database - skipping whazzup";
+    return;
+  }
+
+  std::mt19937 generator(SEED);
+  std::uniform_real_distribution<float> lonDist(-180.f, 180.f), latDist(-70.f, 70.f);
+  std::uniform_int_distribution<int> altDist(0, 41000), speedDist(0, 520), headingDist(0, 359),
+  cidDist(800000, 1600000);
+
+  atools::fs::online::OnlinedataManager manager(db);
+  manager.createSchema();
+  manager.initQueries();
+
+  // Worst-case has long routes, remarks and multi line ATIS for every ATC station
+  for(const std::pair<QString, bool>& corpus : {std::make_pair(QString("whazzup representative"), false),
+                                                std::make_pair(QString("whazzup worst-case"), true)})
+  {
+    bool worst = corpus.second;
+    int numClients = 1500 * scale;
+
+    QStringList lines({"!GENERAL:", "VERSION = 9", "RELOAD = 2", "UPDATE = 20181014120000", "ATIS ALLOW MIN = 5",
+                       QString("CONNECTED CLIENTS = %1").arg(numClients), "!CLIENTS:"});
+    for(int i = 0; i < numClients; i++)
+    {
+      bool atc = i % 10 == 0;
+      QStringList fields;
+      for(int f = 0; f < 41; f++)
+        fields.append(QString());
+
+      fields[0] = atc ? randomIdent(generator, 4) + "_APP" : randomIdent(generator, 3) + QString::number(i);
+      fields[1] = QString::number(cidDist(generator));
+      fields[2] = randomText(generator, worst ? 40 : 15);
+      fields[3] = atc ? "ATC" : "PILOT";
+      fields[5] = QString::number(latDist(generator), 'f', 5);
+      fields[6] = QString::number(lonDist(generator), 'f', 5);
+      fields[14] = "GERMANY";
+      fields[15] = "100";
+      fields[16] = "1";
+      fields[37] = "20181014100000";
+
+      if(atc)
+      {
+        fields[4] = "118.500";
+        fields[18] = "5";
+        fields[19] = "150";
+        QStringList atis;
+        for(int a = 0; a < (worst ? 8 : 1); a++)
+          atis.append(randomText(generator, 60));
+        fields[35] = atis.join("^§");
+        fields[36] = "20181014115500";
+      }
+      else
+      {
+        fields[7] = QString::number(altDist(generator));
+        fields[8] = QString::number(speedDist(generator));
+        fields[9] = "B738";
+        fields[10] = "450";
+        fields[11] = randomIdent(generator, 4);
+        fields[12] = "FL350";
+        fields[13] = randomIdent(generator, 4);
+        fields[17] = "2000";
+        fields[21] = "I";
+        fields[22] = "1200";
+        fields[23] = "1200";
+        fields[24] = "7";
+        fields[25] = "30";
+        fields[26] = "9";
+        fields[27] = "0";
+        fields[28] = randomIdent(generator, 4);
+        fields[29] = worst ? randomText(generator, 250) : "/V/";
+
+        QStringList route;
+        for(int r = 0; r < (worst ? 100 : 10); r++)
+          route.append(randomIdent(generator, r % 2 == 0 ? 5 : 4));
+        fields[30] = route.join(' ');
+        fields[38] = QString::number(headingDist(generator));
+        fields[39] = "29.92";
+        fields[40] = "1013";
+      }
+      lines.append(fields.join(':') + ':');
+    }
+    QString text = lines.join('\n');
+
+    results.append(measure(corpus.first, 5 * scale, text.size(), [&]() -> qint64 {
+      manager.readFromWhazzup(text, atools::fs::online::VATSIM, QDateTime());
+      return numClients;
+    }));
+  }
+  manager.deInitQueries();
+}
+
+void ParserBenchmark::runCsv(QVector<ParserBenchmarkResult>& results)
+{
+  std::mt19937 generator(SEED);
+  std::uniform_real_distribution<float> lonDist(-180.f, 180.f), latDist(-90.f, 90.f);
+
+  QStringList representative, worst;
+  for(int i = 0; i < 20000 * scale; i++)
+  {
+    QString ident = randomIdent(generator, 4), lon = QString::number(lonDist(generator), 'f', 6),
+            lat = QString::number(latDist(generator), 'f', 6);
+
+    // Airport,Frankfurt,EDDF,ED,Description,,250,364,8.570556,50.033333,2.1,,2018-10-14T12:00:00
+    representative.append(QString("Airport,%1,%2,ED,%3,,250,364,%4,%5,2.1,,2018-10-14T12:00:00").
+                          arg(randomText(generator, 12)).arg(ident).arg(randomText(generator, 30)).
+                          arg(lon).arg(lat));
+
+    // All fields escaped, separators and double escape characters in fields and linefeeds in every third row
+    QString description = "\"" + randomText(generator, 40) + ", with \"\"quotes\"\"" +
+                          (i % 3 == 0 ? "\n" + randomText(generator, 40) + "\n" + randomText(generator, 20) :
+                           QString()) + "\"";
+    worst.append(QString("\"Bookmark\",\"%1, %2\",\"%3\",\"ED\",%4,\"\",\"250\",\"364\",\"%5\",\"%6\",\"2.1\","
+                         "\"tag1, tag2\",\"2018-10-14T12:00:00\"").
+                 arg(randomText(generator, 12)).arg(randomText(generator, 12)).arg(ident).arg(description).
+                 arg(lon).arg(lat));
+  }
+
+  for(const std::pair<QString, const QStringList *>& corpus :
+      {std::make_pair(QString("representative"), &representative),
+       std::make_pair(QString("worst-case"), &worst)})
+  {
+    // Split lines before since reading the file is not part of the parser
+    QString text = corpus.second->join('\n');
+    QStringList lines = text.split('\n');
+
+    for(bool refs : {false, true})
+    {
+      atools::util::CsvReader reader(',', '"', true);
+      results.append(measure(QString("CSV ") + (refs ? "refs " : "") + corpus.first, 1, text.size(),
+                             [&]() -> qint64 {
+        qint64 records = 0;
+        for(const QString& line : lines)
+        {
+          if(line.isEmpty() && !reader.isInEscape())
+            continue;
+
+          if(refs)
+            reader.readCsvLineRefs(line);
+          else
+            reader.readCsvLine(line);
+
+          if(!reader.isInEscape())
+            records++;
+        }
+        return records;
+      }));
+    }
+  }
+}
+
+void ParserBenchmark::runIni(QVector<ParserBenchmarkResult>& results, const QString& dir)
+{
+  std::mt19937 generator(SEED);
+
+  for(const std::pair<QString, bool>& corpus : {std::make_pair(QString("ini representative"), false),
+                                                std::make_pair(QString("ini worst-case"), true)})
+  {
+    bool worst = corpus.second;
+
+    // scenery.cfg like file. Worst-case has comments, padding, long values and many keys per section.
+    QStringList lines({"[General]", "Title=FS9 World Scenery", "Description=FS9 Scenery Data",
+                       "Clean_on_Exit=TRUE", ""});
+    for(int i = 0; i < 3000 * scale; i++)
+    {
+      lines.append(QString(worst ? "  [ Area.%1 ]  " : "[Area.%1]").arg(i + 1, 3, 10, QChar('0')));
+      if(worst)
+        lines.append("; " + randomText(generator, 60));
+
+      QStringList keys({"Title", "Local", "Layer", "Active", "Required"});
+      QStringList values({randomText(generator, worst ? 80 : 20),
+                          "Addon Scenery\\" + randomText(generator, worst ? 120 : 15),
+                          QString::number(i + 1), "TRUE", "FALSE"});
+      if(worst)
+      {
+        for(int k = 0; k < 15; k++)
+        {
+          keys.append(QString("Texture_%1").arg(k));
+          values.append(randomText(generator, 40));
+        }
+      }
+
+      for(int k = 0; k < keys.size(); k++)
+        lines.append(worst ? "  " + keys.at(k) + "   =   " + values.at(k) + "   " : keys.at(k) + "=" + values.at(k));
+      lines.append(QString());
+    }
+
+    QString filename = dir + (worst ? "/scenery_worst.cfg" : "/scenery.cfg");
+    writeFile(filename, lines.join('\n'));
+
+    CountingIniReader reader;
+    results.append(measure(corpus.first, 5 * scale, QFileInfo(filename).size(), [&]() -> qint64 {
+      reader.keyValues = 0;
+      reader.read(filename);
+      return reader.keyValues;
+    }));
+  }
+}
+
+void ParserBenchmark::runPerf(QVector<ParserBenchmarkResult>& results, const QString& dir)
+{
+  std::mt19937 generator(SEED);
+
+  // QSettings keeps parsed files in a cache - use one file per iteration to measure parsing
+  const int NUM_FILES = 200 * scale;
+  for(const std::pair<QString, bool>& corpus : {std::make_pair(QString("performance representative"), false),
+                                                std::make_pair(QString("performance worst-case"), true)})
+  {
+    QStringList filenames;
+    qint64 bytes = 0;
+    for(int i = 0; i < NUM_FILES; i++)
+    {
+      atools::fs::perf::AircraftPerf perf;
+      perf.setName(randomText(generator, 20));
+      perf.setAircraftType("B738");
+
+      // Long multi line description which has to be escaped and unescaped by QSettings
+      if(corpus.second)
+      {
+        QStringList description;
+        for(int d = 0; d < 20; d++)
+          description.append(randomText(generator, 70) + ", \"notes\"");
+        perf.setDescription(description.join('\n'));
+      }
+      else
+        perf.setDescription(randomText(generator, 40));
+
+      QString filename = dir + QString("/perf_%1_%2.lnmperf").arg(corpus.second).arg(i);
+      perf.save(filename);
+      bytes += QFileInfo(filename).size();
+      filenames.append(filename);
+    }
+
+    int index = 0;
+    results.append(measure(corpus.first, NUM_FILES, bytes / NUM_FILES, [&]() -> qint64 {
+      atools::fs::perf::AircraftPerf perf;
+      perf.load(filenames.at(index++));
+      return 1;
+    }));
+  }
+}
+
+ParserBenchmarkResult ParserBenchmark::measure(const QString& name, int iterations, qint64 bytes,
+                                               const std::function<qint64()>& function)
+{
+  ParserBenchmarkResult result = {name, iterations, bytes * iterations, 0, isCountingAllocations() ? 0 : -1, 0.};
+
+  qint64 allocations = currentAllocations();
+  QElapsedTimer timer;
+  timer.start();
+  for(int i = 0; i < iterations; i++)
+    result.records += function();
+  result.totalMs = atools::benchmark::elapsedMs(timer);
+
+  if(isCountingAllocations())
+    result.allocations = currentAllocations() - allocations;
+  return result;
+}
+
+void ParserBenchmark::print(QTextStream& out, const QVector<ParserBenchmarkResult>& results)
+{
+  atools::benchmark::printBuildInfo(out);
+
+  out << qSetFieldWidth(34) << left << "Parser" << qSetFieldWidth(8) << right << "Iter"
+      << qSetFieldWidth(12) << "MB" << "Records" << "Total ms" << "MB/s" << "Records/s" << "Allocs/rec"
+      << qSetFieldWidth(0) << endl;
+
+  for(const ParserBenchmarkResult& result : results)
+  {
+    double seconds = std::max(result.totalMs, 0.001) / 1000.;
+    double mb = result.bytes / (1024. * 1024.);
+    out << qSetFieldWidth(34) << left << result.name << qSetFieldWidth(8) << right << result.iterations
+        << qSetFieldWidth(12) << QString::number(mb, 'f', 2) << result.records
+        << QString::number(result.totalMs, 'f', 1) << QString::number(mb / seconds, 'f', 2)
+        << QString::number(result.records / seconds, 'f', 0)
+        << (result.allocations < 0 || result.records == 0 ? QString("n/a") :
+        QString::number(static_cast<double>(result.allocations) / result.records, 'f', 1))
+        << qSetFieldWidth(0) << endl;
+  }
+}
+
+} // namespace util
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,98 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_UTIL_PARSERBENCHMARK_H
+#define ATOOLS_FS_UTIL_PARSERBENCHMARK_H
+
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+class QTextStream;
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace util {
+
+/* Result of one parser and corpus. allocations is -1 if allocation counting is not compiled in. */
+struct ParserBenchmarkResult
+{
+  QString name;
+  int iterations;
+  qint64 bytes, records, allocations;
+  double totalMs;
+};
+
+/*
+ * Throughput benchmark for the text and file format parsers. Covers the flight plan loaders for FSX PLN,
+ * FS9 PLN, X-Plane FMS and Aerosoft FLP, METAR, whazzup.txt, CSV, ini files and aircraft performance files.
+ *
+ * Each parser runs on a representative and a worst-case corpus which are generated with a fixed seed into a
+ * temporary directory. Worst-case means long routes, long lines, escaped CSV fields and METARs with many groups.
+ *
+ * Allocations are counted by replacing malloc, calloc and realloc when compiled with the define
+ * ATOOLS_COUNT_ALLOCATIONS on Linux with glibc. This also counts Qt container and operator new allocations.
+ * Do not enable it for production builds.
+ */
+class ParserBenchmark
+{
+public:
+  /* onlineDb is used for whazzup parsing which writes into the database. Whazzup is skipped if null.
+   * Online tables in the database are dropped and recreated. */
+  explicit ParserBenchmark(atools::sql::SqlDatabase *onlineDb = nullptr);
+
+  /* Scale factor for corpus sizes. Default is 1. */
+  void setScale(int value)
+  {
+    scale = value;
+  }
+
+  /* Generate all corpora and run all parsers */
+  QVector<atools::fs::util::ParserBenchmarkResult> run();
+
+  /* Print results as a table with MB/s, records/s and allocations per record */
+  static void print(QTextStream& out, const QVector<atools::fs::util::ParserBenchmarkResult>& results);
+
+  /* true if compiled with ATOOLS_COUNT_ALLOCATIONS and supported on this platform */
+  static bool isCountingAllocations();
+
+private:
+  /* Call function iterations times. Function returns the number of records parsed. bytes is per iteration. */
+  static atools::fs::util::ParserBenchmarkResult measure(const QString& name, int iterations, qint64 bytes,
+                                                         const std::function<qint64()>& function);
+
+  void runFlightplan(QVector<atools::fs::util::ParserBenchmarkResult>& results, const QString& dir);
+  void runMetar(QVector<atools::fs::util::ParserBenchmarkResult>& results);
+  void runWhazzup(QVector<atools::fs::util::ParserBenchmarkResult>& results);
+  void runCsv(QVector<atools::fs::util::ParserBenchmarkResult>& results);
+  void runIni(QVector<atools::fs::util::ParserBenchmarkResult>& results, const QString& dir);
+  void runPerf(QVector<atools::fs::util::ParserBenchmarkResult>& results, const QString& dir);
+
+  atools::sql::SqlDatabase *db;
+  int scale = 1;
+};
+
+} // namespace util
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_UTIL_PARSERBENCHMARK_H
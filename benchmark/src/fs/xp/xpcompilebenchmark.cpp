@@ -0,0 +1,418 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/xp/xpcompilebenchmark.h"
+#include "benchmark/benchmarkutil.h"
+#include "fs/xp/xpdatacompiler.h"
+#include "fs/navdatabase.h"
+#include "fs/navdatabaseerrors.h"
+#include "fs/progresshandler.h"
+#include "fs/scenery/sceneryarea.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlutil.h"
+#include "atools.h"
+#include "exception.h"
+
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include <cmath>
+#include <random>
+
+namespace atools {
+namespace fs {
+namespace xp {
+
+using atools::buildPathNoCase;
+
+/* Fixed seed for comparable datasets */
+const static unsigned int SEED = 4711;
+
+/* Number of fields in a CIFP procedure row including the row code split at the colon */
+const static int NUM_CIFP_FIELDS = 39;
+
+/* Create directory and open file for writing. Throws an exception on error. */
+static void openForWrite(QFile& file, const QStringList& path)
+{
+  QString filepath = atools::buildPath(path);
+  QDir().mkpath(QFileInfo(filepath).path());
+  file.setFileName(filepath);
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    throw atools::Exception(QString("Cannot open file \"%1\". Reason: %2.").arg(filepath).arg(file.errorString()));
+}
+
+/* Files matching pattern in all directories */
+static QStringList listFiles(const QStringList& dirs, const QString& pattern)
+{
+  QStringList files;
+  for(const QString& dir : dirs)
+  {
+    for(const QFileInfo& fileinfo : QDir(dir).entryInfoList({pattern}, QDir::Files, QDir::Name))
+      files.append(fileinfo.filePath());
+  }
+  return files;
+}
+
+/* Format coordinate like 47:26:30 N */
+static QString openAirCoord(float value, char positive, char negative)
+{
+  float absValue = std::abs(value);
+  int deg = static_cast<int>(absValue), min = static_cast<int>((absValue - deg) * 60.f);
+  int sec = static_cast<int>((absValue - deg - min / 60.f) * 3600.f);
+  return QString("%1:%2:%3 %4").arg(deg, 2, 10, QChar('0')).arg(min, 2, 10, QChar('0')).
+         arg(sec, 2, 10, QChar('0')).arg(value < 0.f ? negative : positive);
+}
+
+XpCompileBenchmark::XpCompileBenchmark(sql::SqlDatabase *sqlDb)
+  : db(sqlDb)
+{
+  options.setSimulatorType(atools::fs::FsPaths::XPLANE11);
+}
+
+void XpCompileBenchmark::generate(const QString& basePath, int numFixes, int numNavaids, int numAirports,
+                                  int numAirspaces)
+{
+  options.setBasepath(basePath);
+
+  std::mt19937 generator(SEED);
+  std::uniform_real_distribution<float> lonX(-120.f, -80.f), latY(25.f, 50.f), offset(-0.02f, 0.02f);
+  QString defaultData = atools::buildPath({basePath, "Resources", "default data"});
+
+  // earth_fix.dat ====================================================
+  QFile file;
+  openForWrite(file, {defaultData, "earth_fix.dat"});
+  QTextStream stream(&file);
+  stream << "I" << endl << "1101 Version - data cycle 1809, build 20180902, metadata FixXP1101. Benchmark." << endl
+         << endl;
+
+  QStringList fixIdents;
+  for(int i = 0; i < numFixes; i++)
+  {
+    QString ident = "F" + QString::number(i, 36).toUpper().rightJustified(4, '0');
+    fixIdents.append(ident);
+    stream << QString::number(latY(generator), 'f', 9) << " " << QString::number(lonX(generator), 'f', 9)
+           << " " << ident << " ENRT K2" << endl;
+  }
+  stream << "99" << endl;
+  file.close();
+
+  // earth_nav.dat ====================================================
+  openForWrite(file, {defaultData, "earth_nav.dat"});
+  stream.setDevice(&file);
+  stream << "I" << endl << "1150 Version - data cycle 1809, build 20180902, metadata NavXP1150. Benchmark." << endl
+         << endl;
+
+  for(int i = 0; i < numNavaids; i++)
+  {
+    QString ident = QString::number(i, 36).toUpper().rightJustified(3, '0');
+    QString lat = QString::number(latY(generator), 'f', 8), lon = QString::number(lonX(generator), 'f', 8);
+    if(i % 2 == 0)
+      stream << "3 " << lat << " " << lon << " 429 " << 10800 + (i % 200) * 5 << " 130 12.000 " << ident
+             << " ENRT K2 BENCHMARK " << i << " VORTAC" << endl;
+    else
+      stream << "2 " << lat << " " << lon << " 0 " << 200 + (i % 300) << " 50 0.000 " << ident
+             << " ENRT K2 BENCHMARK " << i << " NDB" << endl;
+  }
+  stream << "99" << endl;
+  file.close();
+
+  // earth_awy.dat - airways connecting consecutive fixes ==============
+  openForWrite(file, {defaultData, "earth_awy.dat"});
+  stream.setDevice(&file);
+  stream << "I" << endl << "1100 Version - data cycle 1809, build 20180902, metadata AwyXP1100. Benchmark." << endl
+         << endl;
+
+  for(int i = 0; i + 1 < fixIdents.size(); i++)
+  {
+    if(i % 20 != 19)
+      stream << fixIdents.at(i) << " K2 11 " << fixIdents.at(i + 1) << " K2 11 N " << (i % 2) + 1
+             << " 50 450 " << (i % 2 == 0 ? "V" : "J") << i / 20 << endl;
+  }
+  stream << "99" << endl;
+  file.close();
+
+  // apt.dat with runway, pavement, parking and frequency for each airport ===========
+  openForWrite(file, {basePath, "Resources", "default scenery", "default apt dat", "Earth nav data", "apt.dat"});
+  stream.setDevice(&file);
+  stream << "I" << endl << "1100 Version - data cycle 1809, build 20180902, metadata AptXP1100. Benchmark." << endl
+         << endl;
+
+  QStringList airportIdents;
+  for(int i = 0; i < numAirports; i++)
+  {
+    QString ident = "X" + QString::number(i, 36).toUpper().rightJustified(3, '0');
+    airportIdents.append(ident);
+    float lat = latY(generator), lon = lonX(generator);
+    auto coord = [lat, lon](float latOffset, float lonOffset) -> QString
+                 {
+                   return QString::number(lat + latOffset, 'f', 8) + " " + QString::number(lon + lonOffset, 'f', 8);
+                 };
+
+    stream << "1 433 0 0 " << ident << " Benchmark Airport " << i << endl;
+    stream << "1302 datum_lat " << QString::number(lat, 'f', 8) << endl;
+    stream << "1302 datum_lon " << QString::number(lon, 'f', 8) << endl;
+    stream << "100 45.72 1 0 0.00 1 2 1 09 " << coord(0.f, -0.02f) << " 0 0 2 0 0 1 27 "
+           << coord(0.f, 0.02f) << " 0 0 2 0 0 1" << endl;
+    stream << "110 1 0.25 90.00 Taxiway" << endl;
+    stream << "111 " << coord(0.002f, -0.01f) << endl;
+    stream << "112 " << coord(0.002f, 0.f) << " " << coord(0.003f, 0.f) << endl;
+    stream << "111 " << coord(0.002f, 0.01f) << endl;
+    stream << "113 " << coord(0.004f + offset(generator) / 10.f, 0.f) << endl;
+    for(int p = 0; p < 5; p++)
+      stream << "1300 " << coord(0.004f, -0.004f + p * 0.002f) << " 180.0 gate jets|turboprops A" << p << endl;
+    stream << "54 11830 TWR" << endl;
+    stream << "53 12190 GND" << endl;
+    stream << endl;
+  }
+  stream << "99" << endl;
+  file.close();
+
+  // CIFP files with one SID per airport =======================================
+  std::uniform_int_distribution<int> fixIndex(0, std::max(fixIdents.size() - 1, 0));
+  for(const QString& ident : airportIdents)
+  {
+    openForWrite(file, {defaultData, "CIFP", ident + ".dat"});
+    stream.setDevice(&file);
+    for(int leg = 0; leg < 4 && !fixIdents.isEmpty(); leg++)
+    {
+      QStringList fields;
+      for(int f = 0; f < NUM_CIFP_FIELDS; f++)
+        fields.append(" ");
+      fields[1] = QString::number((leg + 1) * 10).rightJustified(3, '0');
+      fields[2] = "5";
+      fields[3] = "BNCH1";
+      fields[4] = "RW09";
+      fields[5] = fixIdents.at(fixIndex(generator));
+      fields[6] = "K2";
+      fields[7] = "E";
+      fields[8] = "A";
+      fields[9] = "E   ";
+      fields[12] = leg == 0 ? "IF" : "TF";
+      fields[23] = "+";
+      fields[24] = QString::number(3000 + leg * 2000).rightJustified(5, '0');
+      fields[26] = "18000";
+      fields[37] = "D";
+      fields[38] = " ;";
+      stream << "SID:" << fields.mid(1).join(",") << endl;
+    }
+    file.close();
+  }
+
+  // OpenAir airspaces - polygons and circles ===================================
+  openForWrite(file, {defaultData, "airspaces", "benchmark.txt"});
+  stream.setDevice(&file);
+  std::uniform_real_distribution<float> radius(0.1f, 0.5f);
+  for(int i = 0; i < numAirspaces; i++)
+  {
+    float lat = latY(generator), lon = lonX(generator);
+    stream << "* Benchmark airspace " << i << endl;
+    stream << "AC " << (i % 3 == 0 ? "D" : (i % 3 == 1 ? "R" : "C")) << endl;
+    stream << "AN BENCHMARK " << i << endl;
+    stream << "AL GND" << endl;
+    stream << "AH " << (i % 2 == 0 ? "FL100" : "2500 MSL") << endl;
+
+    if(i % 2 == 0)
+    {
+      for(int p = 0; p < 12; p++)
+      {
+        float angle = static_cast<float>(p * 2. * M_PI / 12.), r = radius(generator);
+        stream << "DP " << openAirCoord(lat + std::sin(angle) * r, 'N', 'S') << " "
+               << openAirCoord(lon + std::cos(angle) * r, 'E', 'W') << endl;
+      }
+    }
+    else
+    {
+      stream << "V X=" << openAirCoord(lat, 'N', 'S') << " " << openAirCoord(lon, 'E', 'W') << endl;
+      stream << "DC " << QString::number(radius(generator) * 20.f, 'f', 1) << endl;
+    }
+    stream << endl;
+  }
+  file.close();
+}
+
+QVector<XpCompileBenchmarkResult> XpCompileBenchmark::run()
+{
+  QVector<XpCompileBenchmarkResult> results;
+  QString basePath = options.getBasepath();
+
+  atools::fs::NavDatabase(&options, db, nullptr, QString()).createSchema();
+
+  // Collect errors instead of throwing exceptions for single files
+  atools::fs::NavDatabaseErrors errors;
+  errors.init(atools::fs::scenery::SceneryArea(1, 1, "X-Plane", QString()));
+
+  atools::fs::ProgressHandler progress(&options);
+  XpDataCompiler compiler(*db, options, &progress, &errors);
+
+  // Same directories as used by the compiler
+  QString customData = buildPathNoCase({basePath, "Custom Data"});
+  QString defaultData = buildPathNoCase({basePath, "Resources", "default data"});
+  QString earthData = QFileInfo::exists(buildPathNoCase({customData, "earth_fix.dat"})) ? customData : defaultData;
+  QString aptDat = buildPathNoCase({basePath, "Resources", "default scenery", "default apt dat",
+                                    "Earth nav data", "apt.dat"});
+
+  results.append(measureStep("Prepare", QStringList(), {"magdecl"}, [&compiler]() -> void
+        {
+          compiler.writeBasepathScenery();
+          compiler.compileMagDeclBgl();
+        }));
+
+  results.append(measureStep("Default apt.dat", {aptDat}, {"airport", "runway", "apron", "parking", "com"},
+                             [&compiler]() -> void
+        {
+          compiler.compileDefaultApt();
+        }));
+
+  results.append(measureStep("Earth fix", {buildPathNoCase({earthData, "earth_fix.dat"})}, {"waypoint"},
+                             [&compiler]() -> void
+        {
+          compiler.compileEarthFix();
+        }));
+
+  results.append(measureStep("Earth nav", {buildPathNoCase({earthData, "earth_nav.dat"})},
+                             {"vor", "ndb", "marker", "ils"}, [&compiler]() -> void
+        {
+          compiler.compileEarthNav();
+        }));
+
+  results.append(measureStep("Airspaces", listFiles({buildPathNoCase({customData, "airspaces"}),
+                                                     buildPathNoCase({defaultData, "airspaces"})}, "*.txt"),
+                             {"boundary"}, [&compiler]() -> void
+        {
+          compiler.compileAirspaces();
+        }));
+
+  results.append(measureStep("Earth airway", {buildPathNoCase({earthData, "earth_awy.dat"})}, {"airway_temp"},
+                             [&compiler]() -> void
+        {
+          compiler.compileEarthAirway();
+        }));
+
+  results.append(measureStep("CIFP", listFiles({buildPathNoCase({customData, "CIFP"}),
+                                                buildPathNoCase({defaultData, "CIFP"})}, "*.dat"),
+                             {"approach", "approach_leg", "transition", "transition_leg"}, [&compiler]() -> void
+        {
+          compiler.compileCifp();
+        }));
+
+  compiler.close();
+
+  for(const atools::fs::NavDatabaseErrors::SceneryErrors& sceneryErrors : errors.sceneryErrors)
+  {
+    for(const atools::fs::NavDatabaseErrors::SceneryFileError& fileError : sceneryErrors.fileErrors)
+      qWarning() << Q_FUNC_INFO << "Error in" << fileError.filepath << fileError.lineNum << fileError.errorMessage;
+  }
+  return results;
+}
+
+XpCompileBenchmarkResult XpCompileBenchmark::measureStep(const QString& name, const QStringList& files,
+                                                         const QStringList& tables,
+                                                         const std::function<void()>& function)
+{
+  qint64 rowsBefore = countRows(tables);
+
+  double ms = atools::benchmark::measureMs(function);
+
+  XpCompileBenchmarkResult result = {name, countLines(files), countRows(tables) - rowsBefore, ms, 0., 0.};
+  if(ms > 0.)
+  {
+    result.linesPerSecond = result.lines * 1000. / ms;
+    result.rowsPerSecond = result.rows * 1000. / ms;
+  }
+  return result;
+}
+
+qint64 XpCompileBenchmark::countRows(const QStringList& tables) const
+{
+  atools::sql::SqlUtil util(db);
+  qint64 rows = 0;
+  for(const QString& table : tables)
+  {
+    if(util.hasTable(table))
+      rows += util.rowCount(table);
+  }
+  return rows;
+}
+
+qint64 XpCompileBenchmark::countLines(const QStringList& files)
+{
+  qint64 lines = 0;
+  for(const QString& filename : files)
+  {
+    QFile file(filename);
+    if(file.open(QIODevice::ReadOnly))
+    {
+      lines += file.readAll().count('\n');
+      file.close();
+    }
+  }
+  return lines;
+}
+
+void XpCompileBenchmark::print(QTextStream& out, const QVector<XpCompileBenchmarkResult>& results)
+{
+  atools::benchmark::printBuildInfo(out);
+
+  out << qSetFieldWidth(20) << left << "Step" << qSetFieldWidth(12) << right << "Lines" << "Rows"
+      << "Total ms" << qSetFieldWidth(14) << "Lines/s" << "Rows/s" << qSetFieldWidth(0) << endl;
+
+  for(const XpCompileBenchmarkResult& result : results)
+    out << qSetFieldWidth(20) << left << result.name << qSetFieldWidth(12) << right
+        << result.lines << result.rows << QString::number(result.milliseconds, 'f', 2) << qSetFieldWidth(14)
+        << QString::number(result.linesPerSecond, 'f', 0) << QString::number(result.rowsPerSecond, 'f', 0)
+        << qSetFieldWidth(0) << endl;
+}
+
+bool XpCompileBenchmark::writeJson(const QString& filename, const QVector<XpCompileBenchmarkResult>& results) const
+{
+  QJsonArray steps;
+  for(const XpCompileBenchmarkResult& result : results)
+  {
+    QJsonObject obj;
+    obj.insert("name", result.name);
+    obj.insert("milliseconds", result.milliseconds);
+    obj.insert("lines", result.lines);
+    obj.insert("rows", result.rows);
+    obj.insert("lines_per_second", result.linesPerSecond);
+    obj.insert("rows_per_second", result.rowsPerSecond);
+    steps.append(obj);
+  }
+
+  QJsonObject report = atools::benchmark::buildInfoJson();
+  report.insert("threads", options.isReadParallel() ? options.getNumThreads() : 1);
+  report.insert("steps", steps);
+
+  QFile file(filename);
+  if(file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    file.write(QJsonDocument(report).toJson());
+    file.close();
+    return true;
+  }
+  else
+  {
+    qWarning() << "Cannot write benchmark report" << file.fileName() << file.errorString();
+    return false;
+  }
+}
+
+} // namespace xp
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,102 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_XP_XPCOMPILEBENCHMARK_H
+#define ATOOLS_FS_XP_XPCOMPILEBENCHMARK_H
+
+#include "fs/navdatabaseoptions.h"
+
+#include <QVector>
+
+#include <functional>
+
+class QTextStream;
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace xp {
+
+/* Result of one compile step. Time is in milliseconds. */
+struct XpCompileBenchmarkResult
+{
+  QString name;
+  qint64 lines, rows;
+  double milliseconds, linesPerSecond, rowsPerSecond;
+};
+
+/*
+ * Benchmark for the steps of the X-Plane compiler to measure the gains of reading and parsing optimizations.
+ *
+ * Runs on an X-Plane installation or on a reduced dataset written by generate() which mirrors the X-Plane
+ * directory layout. Data is generated with a fixed seed so that results of different builds are comparable.
+ * The file magdec/magdec.bgl has to be available in the application or settings directory as for a normal
+ * compilation.
+ */
+class XpCompileBenchmark
+{
+public:
+  /* Schema is created in the database and all tables are filled. Use an empty database. */
+  explicit XpCompileBenchmark(atools::sql::SqlDatabase *sqlDb);
+
+  /* Write earth_fix.dat, earth_nav.dat, earth_awy.dat, apt.dat, CIFP and airspace files below basePath.
+   * Overwrites existing files. Sets the base path for run(). */
+  void generate(const QString& basePath, int numFixes, int numNavaids, int numAirports, int numAirspaces);
+
+  /* Use an existing X-Plane installation or reference dataset */
+  void setBasePath(const QString& value)
+  {
+    options.setBasepath(value);
+  }
+
+  /* Threads for parallel reading. Default is 1 which reads sequentially. */
+  void setNumThreads(int value)
+  {
+    options.setNumThreads(value);
+    options.setReadParallel(value > 1);
+  }
+
+  /* Run all compile steps */
+  QVector<atools::fs::xp::XpCompileBenchmarkResult> run();
+
+  /* Print results as a table with one line per step */
+  static void print(QTextStream& out, const QVector<atools::fs::xp::XpCompileBenchmarkResult>& results);
+
+  /* Write results and build information to a JSON file. Returns false if the file cannot be written. */
+  bool writeJson(const QString& filename, const QVector<atools::fs::xp::XpCompileBenchmarkResult>& results) const;
+
+private:
+  /* Run compile step once and measure time, number of lines in files and inserted rows into tables */
+  atools::fs::xp::XpCompileBenchmarkResult measureStep(const QString& name, const QStringList& files,
+                                                       const QStringList& tables,
+                                                       const std::function<void()>& function);
+
+  qint64 countRows(const QStringList& tables) const;
+  static qint64 countLines(const QStringList& files);
+
+  atools::sql::SqlDatabase *db;
+  atools::fs::NavDatabaseOptions options;
+};
+
+} // namespace xp
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_XP_XPCOMPILEBENCHMARK_H
@@ -0,0 +1,240 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "geo/geobenchmark.h"
+#include "benchmark/benchmarkutil.h"
+#include "geo/calculations.h"
+#include "geo/linestring.h"
+#include "geo/linestringindex.h"
+#include "geo/posarray.h"
+#include "geo/rect.h"
+
+#include <QDate>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <random>
+
+namespace atools {
+namespace geo {
+
+/* Fixed seed for comparable datasets */
+const static unsigned int SEED = 4711;
+
+/* Accumulates results to keep the compiler from removing the benchmarked calls */
+static volatile float sink = 0.f;
+
+GeoBenchmark::GeoBenchmark(int numPositions, int repeat)
+  : numPositions(std::max(numPositions, 2)), repeat(std::max(repeat, 1))
+{
+
+}
+
+GeoBenchmark::Dataset GeoBenchmark::createDataset(const QString& name, float minLonX, float maxLonX,
+                                                  float minLatY, float maxLatY) const
+{
+  std::mt19937 generator(SEED);
+  std::uniform_real_distribution<float> lonX(minLonX, maxLonX), latY(minLatY, maxLatY), course(0.f, 360.f);
+
+  Dataset dataset;
+  dataset.name = name;
+  dataset.positions.reserve(numPositions);
+  dataset.courses.reserve(numPositions);
+  for(int i = 0; i < numPositions; i++)
+  {
+    // Allow values beyond the anti-meridian to be normalized
+    dataset.positions.append(Pos(lonX(generator), latY(generator)));
+    dataset.courses.append(course(generator));
+  }
+  return dataset;
+}
+
+GeoBenchmarkResult GeoBenchmark::measure(const QString& name, const Dataset& dataset,
+                                         const std::function<float(int i)>& function) const
+{
+  int size = dataset.positions.size();
+  float sum = 0.f;
+
+  QElapsedTimer timer;
+  timer.start();
+  for(int r = 0; r < repeat; r++)
+  {
+    for(int i = 0; i < size; i++)
+      sum += function(i);
+  }
+  qint64 nsecs = timer.nsecsElapsed();
+  sink = sink + sum;
+
+  qint64 calls = static_cast<qint64>(size) * repeat;
+  return {name, dataset.name, calls, static_cast<double>(nsecs) / static_cast<double>(calls)};
+}
+
+GeoBenchmarkResult GeoBenchmark::measureBatch(const QString& name, const Dataset& dataset,
+                                              const std::function<float()>& function) const
+{
+  float sum = 0.f;
+
+  QElapsedTimer timer;
+  timer.start();
+  for(int r = 0; r < repeat; r++)
+    sum += function();
+  qint64 nsecs = timer.nsecsElapsed();
+  sink = sink + sum;
+
+  qint64 calls = static_cast<qint64>(dataset.positions.size()) * repeat;
+  return {name, dataset.name, calls, static_cast<double>(nsecs) / static_cast<double>(calls)};
+}
+
+void GeoBenchmark::runDataset(QVector<GeoBenchmarkResult>& results, const Dataset& dataset) const
+{
+  const QVector<Pos>& pos = dataset.positions;
+  const QVector<float>& crs = dataset.courses;
+  int last = pos.size() - 1;
+
+  // Single calls between consecutive positions ==================================
+  results.append(measure("Pos::distanceMeterTo", dataset, [&](int i) -> float {
+          return pos.at(i).distanceMeterTo(pos.at(i < last ? i + 1 : 0));
+        }));
+
+  results.append(measure("Pos::distanceMeterToRhumb", dataset, [&](int i) -> float {
+          return pos.at(i).distanceMeterToRhumb(pos.at(i < last ? i + 1 : 0));
+        }));
+
+  results.append(measure("Pos::angleDegTo", dataset, [&](int i) -> float {
+          return pos.at(i).angleDegTo(pos.at(i < last ? i + 1 : 0));
+        }));
+
+  results.append(measure("Pos::endpoint", dataset, [&](int i) -> float {
+          return pos.at(i).endpoint(100000.f, crs.at(i)).getLatY();
+        }));
+
+  results.append(measure("Pos::intersectingRadials", dataset, [&](int i) -> float {
+          int j = i < last ? i + 1 : 0;
+          return Pos::intersectingRadials(pos.at(i), crs.at(i), pos.at(j), crs.at(j)).getLatY();
+        }));
+
+  results.append(measure("Pos::normalized", dataset, [&](int i) -> float {
+          return pos.at(i).normalized().getLonX();
+        }));
+
+  results.append(measure("Rect::overlaps", dataset, [&](int i) -> float {
+          Rect rect1(pos.at(i), 50000.f), rect2(pos.at(i < last ? i + 1 : 0), 2000000.f);
+          return rect1.overlaps(rect2) ? 1.f : 0.f;
+        }));
+
+  results.append(measure("Rect::contains", dataset, [&](int i) -> float {
+          return Rect(pos.at(i), 2000000.f).contains(pos.at(i < last ? i + 1 : 0)) ? 1.f : 0.f;
+        }));
+
+  results.append(measure("windCorrectedHeading", dataset, [&](int i) -> float {
+          return windCorrectedHeading(static_cast<float>(i % 80), crs.at(i), crs.at(i < last ? i + 1 : 0), 250.f);
+        }));
+
+  QDate date(2018, 6, 21);
+  results.append(measure("calculateSunriseSunset", dataset, [&](int i) -> float {
+          bool neverRises, neverSets;
+          return static_cast<float>(calculateSunriseSunset(neverRises, neverSets, pos.at(i), date,
+                                                          SUNRISE_CIVIL).msecsSinceStartOfDay());
+        }));
+
+  // Float against double templates ==================================
+  results.append(measure("normalizeCourse<float>", dataset, [&](int i) -> float {
+          return normalizeCourse(crs.at(i) * 3.f - 400.f);
+        }));
+
+  results.append(measure("normalizeCourse<double>", dataset, [&](int i) -> float {
+          return static_cast<float>(normalizeCourse(static_cast<double>(crs.at(i)) * 3. - 400.));
+        }));
+
+  results.append(measure("normalizeLonXDeg<float>", dataset, [&](int i) -> float {
+          return normalizeLonXDeg(pos.at(i).getLonX() + 180.f);
+        }));
+
+  results.append(measure("normalizeLonXDeg<double>", dataset, [&](int i) -> float {
+          return static_cast<float>(normalizeLonXDeg(static_cast<double>(pos.at(i).getLonX()) + 180.));
+        }));
+
+  // Batch against single calls from one position to all ==================================
+  PosArray posArray(pos);
+  QVector<float> values;
+  results.append(measureBatch("PosArray::distancesMeter", dataset, [&]() -> float {
+          posArray.distancesMeter(pos.first(), values);
+          return values.last();
+        }));
+
+  results.append(measureBatch("PosArray::nearest", dataset, [&]() -> float {
+          return static_cast<float>(posArray.nearest(pos.first()));
+        }));
+
+  LineString line;
+  for(int i = 0; i < std::min(pos.size(), 1000); i++)
+    line.append(pos.at(i));
+  LineStringIndex lineIndex(line);
+  results.append(measure("LineString::distanceMeterToLineString", dataset, [&](int i) -> float {
+          LineDistance result;
+          line.distanceMeterToLineString(pos.at(i), result);
+          return result.distance;
+        }));
+
+  results.append(measure("LineString::distanceMeterToLineString(index)", dataset, [&](int i) -> float {
+          LineDistance result;
+          line.distanceMeterToLineString(pos.at(i), result, lineIndex);
+          return result.distance;
+        }));
+
+  const Pos& from = pos.first();
+  const Pos& to = pos.at(1);
+  float distance = from.distanceMeterTo(to);
+  results.append(measureBatch("Pos::interpolate", dataset, [&]() -> float {
+          float step = 1.f / pos.size(), sum = 0.f;
+          for(int i = 0; i < pos.size(); i++)
+            sum += from.interpolate(to, distance, step * static_cast<float>(i)).getLatY();
+          return sum;
+        }));
+
+  LineString points;
+  results.append(measureBatch("Pos::interpolatePoints", dataset, [&]() -> float {
+          points.clear();
+          from.interpolatePoints(to, distance, pos.size(), points);
+          return points.last().getLatY();
+        }));
+}
+
+QVector<GeoBenchmarkResult> GeoBenchmark::run()
+{
+  QVector<GeoBenchmarkResult> results;
+  runDataset(results, createDataset("global", -180.f, 180.f, -80.f, 80.f));
+  runDataset(results, createDataset("poles", -180.f, 180.f, 89.f, 90.f));
+  runDataset(results, createDataset("antimeridian", 170.f, 190.f, -60.f, 60.f));
+  return results;
+}
+
+void GeoBenchmark::print(QTextStream& out, const QVector<GeoBenchmarkResult>& results)
+{
+  atools::benchmark::printBuildInfo(out);
+
+  out << qSetFieldWidth(48) << left << "Case" << qSetFieldWidth(14) << "Dataset"
+      << qSetFieldWidth(12) << right << "Calls" << qSetFieldWidth(14) << "ns/call" << qSetFieldWidth(0) << endl;
+
+  for(const GeoBenchmarkResult& result : results)
+    out << qSetFieldWidth(48) << left << result.name << qSetFieldWidth(14) << result.dataset
+        << qSetFieldWidth(12) << right << result.calls
+        << qSetFieldWidth(14) << QString::number(result.nsPerCall, 'f', 2) << qSetFieldWidth(0) << endl;
+}
+
+} // namespace geo
+} // namespace atools
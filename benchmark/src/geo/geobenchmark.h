@@ -0,0 +1,85 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_GEO_GEOBENCHMARK_H
+#define ATOOLS_GEO_GEOBENCHMARK_H
+
+#include "geo/pos.h"
+
+#include <QVector>
+
+#include <functional>
+
+class QTextStream;
+
+namespace atools {
+namespace geo {
+
+/* Result of one benchmark case */
+struct GeoBenchmarkResult
+{
+  QString name, dataset;
+  qint64 calls;
+  double nsPerCall;
+};
+
+/*
+ * Micro benchmarks for the geo module to compare implementations across compilers and CPUs.
+ *
+ * Covers single calls of Pos, Rect and calculation functions, batch variants, float against double templates
+ * and datasets with positions near the poles and the anti-meridian. Data is generated with a fixed seed so results
+ * of different builds are comparable.
+ */
+class GeoBenchmark
+{
+public:
+  /* numPositions: size of each dataset. repeat: number of runs over each dataset per case. */
+  explicit GeoBenchmark(int numPositions = 10000, int repeat = 10);
+
+  /* Run all cases. Can take several seconds. */
+  QVector<atools::geo::GeoBenchmarkResult> run();
+
+  /* Print results as a table with one line per case together with build information */
+  static void print(QTextStream& out, const QVector<atools::geo::GeoBenchmarkResult>& results);
+
+private:
+  struct Dataset
+  {
+    QString name;
+    QVector<atools::geo::Pos> positions;
+    QVector<float> courses;
+  };
+
+  Dataset createDataset(const QString& name, float minLonX, float maxLonX, float minLatY, float maxLatY) const;
+
+  /* Calls function for index 0 to size - 1 of the dataset repeat times and measures time per call */
+  atools::geo::GeoBenchmarkResult measure(const QString& name, const Dataset& dataset,
+                                          const std::function<float(int i)>& function) const;
+
+  /* Calls function processing the whole dataset at once repeat times and measures time per position */
+  atools::geo::GeoBenchmarkResult measureBatch(const QString& name, const Dataset& dataset,
+                                               const std::function<float()>& function) const;
+
+  void runDataset(QVector<atools::geo::GeoBenchmarkResult>& results, const Dataset& dataset) const;
+
+  int numPositions, repeat;
+};
+
+} // namespace geo
+} // namespace atools
+
+#endif // ATOOLS_GEO_GEOBENCHMARK_H
@@ -0,0 +1,278 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "routing/routebenchmark.h"
+#include "fs/db/airwayresolver.h"
+#include "fs/db/routeedgewriter.h"
+#include "fs/db/routegraphwriter.h"
+#include "fs/progresshandler.h"
+#include "geo/calculations.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlscript.h"
+#include "sql/sqlutil.h"
+
+#include <QElapsedTimer>
+#include <QTemporaryFile>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace atools {
+namespace routing {
+
+using atools::benchmark::peakMemoryKb;
+using atools::benchmark::summarize;
+using atools::sql::SqlQuery;
+using atools::sql::SqlScript;
+using atools::fs::common::RouteNetwork;
+using atools::fs::common::ROUTE_RADIO;
+using atools::fs::common::ROUTE_AIRWAY;
+
+/* Fixed seed for comparable datasets and queries */
+const static unsigned int SEED = 4711;
+
+RouteBenchmark::RouteBenchmark(sql::SqlDatabase *sqlDb)
+  : db(sqlDb)
+{
+
+}
+
+void RouteBenchmark::generate(int numWaypoints, int numAirways, int numRadioNodes)
+{
+  SqlScript script(db, false);
+  script.executeScript(":/atools/resources/sql/fs/db/create_nav_schema.sql");
+  script.executeScript(":/atools/resources/sql/fs/db/create_route_schema.sql");
+
+  std::mt19937 generator(SEED);
+  std::uniform_real_distribution<float> jitter(-0.2f, 0.2f);
+
+  // Grid of waypoints with about 30 NM spacing - reduce spacing for large grids to stay in the valid range
+  int side = std::max(static_cast<int>(std::ceil(std::sqrt(static_cast<double>(numWaypoints)))), 2);
+  float spacing = std::min(0.5f, 60.f / side);
+  float leftLonX = -120.f, bottomLatY = 20.f;
+
+  SqlQuery insertWaypoint(db);
+  insertWaypoint.prepare("insert into waypoint (waypoint_id, file_id, ident, region, type, "
+                         "num_victor_airway, num_jet_airway, mag_var, lonx, laty) "
+                         "values(?, 1, ?, 'ZZ', 'WN', 1, 1, 0, ?, ?)");
+  QVariantList ids, idents, lonXs, latYs;
+  for(int row = 0; row < side; row++)
+  {
+    for(int col = 0; col < side; col++)
+    {
+      int id = row * side + col + 1;
+      ids.append(id);
+      idents.append(QString::number(id, 36).toUpper().rightJustified(5, '0'));
+      lonXs.append(leftLonX + col * spacing * 2.f + jitter(generator) * spacing);
+      latYs.append(bottomLatY + row * spacing + jitter(generator) * spacing);
+    }
+  }
+  insertWaypoint.addBindValue(ids);
+  insertWaypoint.addBindValue(idents);
+  insertWaypoint.addBindValue(lonXs);
+  insertWaypoint.addBindValue(latYs);
+  insertWaypoint.execBatch();
+
+  // Straight airways along rows and columns with random start and length
+  SqlQuery insertPoint(db);
+  insertPoint.prepare("insert into airway_point (waypoint_id, name, type, mid_type, mid_ident, mid_region, "
+                      "previous_type, previous_ident, previous_region, previous_minimum_altitude, "
+                      "previous_maximum_altitude, previous_direction, "
+                      "next_type, next_ident, next_region, next_minimum_altitude, next_maximum_altitude, "
+                      "next_direction) "
+                      "values(:waypoint_id, :name, :type, 'WN', :mid_ident, 'ZZ', "
+                      ":previous_type, :previous_ident, :previous_region, :previous_minimum_altitude, "
+                      ":previous_maximum_altitude, :previous_direction, "
+                      ":next_type, :next_ident, :next_region, :next_minimum_altitude, :next_maximum_altitude, "
+                      ":next_direction)");
+
+  std::uniform_int_distribution<int> position(0, side - 1), length(5, 30);
+  for(int airway = 0; airway < numAirways; airway++)
+  {
+    bool horizontal = airway % 2 == 0, victor = (airway / 2) % 2 == 0;
+    int fixed = position(generator), start = position(generator);
+    int end = std::min(start + length(generator), side);
+    QString name = (victor ? "V" : "J") + QString::number(airway);
+
+    for(int i = start; i < end; i++)
+    {
+      int id = horizontal ? fixed * side + i + 1 : i * side + fixed + 1;
+      int prevId = horizontal ? id - 1 : id - side, nextId = horizontal ? id + 1 : id + side;
+      const QVariant nullStr(QVariant::String), nullInt(QVariant::Int);
+
+      insertPoint.bindValue(":waypoint_id", id);
+      insertPoint.bindValue(":name", name);
+      insertPoint.bindValue(":type", victor ? "V" : "J");
+      insertPoint.bindValue(":mid_ident", idents.at(id - 1));
+
+      bool hasPrev = i > start, hasNext = i < end - 1;
+      insertPoint.bindValue(":previous_type", hasPrev ? QVariant("WN") : nullStr);
+      insertPoint.bindValue(":previous_ident", hasPrev ? idents.at(prevId - 1) : nullStr);
+      insertPoint.bindValue(":previous_region", hasPrev ? QVariant("ZZ") : nullStr);
+      insertPoint.bindValue(":previous_minimum_altitude", hasPrev ? QVariant(victor ? 3000 : 18000) : nullInt);
+      insertPoint.bindValue(":previous_maximum_altitude", hasPrev ? QVariant(victor ? 17999 : 45000) : nullInt);
+      insertPoint.bindValue(":previous_direction", hasPrev ? QVariant("N") : nullStr);
+      insertPoint.bindValue(":next_type", hasNext ? QVariant("WN") : nullStr);
+      insertPoint.bindValue(":next_ident", hasNext ? idents.at(nextId - 1) : nullStr);
+      insertPoint.bindValue(":next_region", hasNext ? QVariant("ZZ") : nullStr);
+      insertPoint.bindValue(":next_minimum_altitude", hasNext ? QVariant(victor ? 3000 : 18000) : nullInt);
+      insertPoint.bindValue(":next_maximum_altitude", hasNext ? QVariant(victor ? 17999 : 45000) : nullInt);
+      insertPoint.bindValue(":next_direction", hasNext ? QVariant("N") : nullStr);
+      insertPoint.exec();
+    }
+  }
+
+  // Airway nodes for all waypoints - type is both airway types and waypoint
+  SqlQuery query(db);
+  query.exec("insert into route_node_airway (nav_id, type, lonx, laty) "
+             "select waypoint_id, 7 * 16, lonx, laty from waypoint");
+
+  // Radio navaids with random position, type and range in the grid area
+  std::uniform_real_distribution<float> lonX(leftLonX, leftLonX + side * spacing * 2.f),
+  latY(bottomLatY, bottomLatY + side * spacing), rangeNm(50.f, 200.f);
+  std::uniform_int_distribution<int> type(0, 2);
+  const int TYPES[] = {1 /* VOR */, 2 /* VORDME */, 4 /* NDB */};
+
+  ids.clear();
+  QVariantList types, ranges;
+  lonXs.clear();
+  latYs.clear();
+  for(int i = 0; i < numRadioNodes; i++)
+  {
+    ids.append(i + 1);
+    types.append(TYPES[type(generator)]);
+    ranges.append(atools::geo::nmToMeter(rangeNm(generator)));
+    lonXs.append(lonX(generator));
+    latYs.append(latY(generator));
+  }
+
+  SqlQuery insertRadio(db);
+  insertRadio.prepare("insert into route_node_radio (nav_id, type, range, lonx, laty) values(?, ?, ?, ?, ?)");
+  insertRadio.addBindValue(ids);
+  insertRadio.addBindValue(types);
+  insertRadio.addBindValue(ranges);
+  insertRadio.addBindValue(lonXs);
+  insertRadio.addBindValue(latYs);
+  insertRadio.execBatch();
+
+  db->commit();
+}
+
+QVector<RouteBenchmarkResult> RouteBenchmark::run()
+{
+  QVector<RouteBenchmarkResult> results;
+  atools::fs::ProgressHandler progress(&options);
+
+  if(atools::sql::SqlUtil(db).hasTableAndRows("airway_point"))
+    results.append(measureStep("Airway resolution", [this, &progress]() -> void
+          {
+            atools::fs::db::AirwayResolver resolver(db, progress);
+            resolver.setNumThreads(numThreads);
+            resolver.run();
+          }));
+
+  results.append(measureStep("Radio route edges", [this, &progress]() -> void
+        {
+          atools::fs::db::RouteEdgeWriter edgeWriter(db, progress, 10);
+          edgeWriter.setNumThreads(numThreads);
+          edgeWriter.run();
+        }));
+
+  results.append(measureStep("Airway route edges", [this]() -> void
+        {
+          SqlScript(db, false).executeScript(":/atools/resources/sql/fs/db/populate_route_edge.sql");
+          db->commit();
+        }));
+
+  // Export to a temporary file which is removed when leaving
+  QTemporaryFile graphFile;
+  graphFile.open();
+  graphFile.close();
+  results.append(measureStep("Route graph export", [this, &graphFile]() -> void
+        {
+          atools::fs::db::RouteGraphWriter(db).write(graphFile.fileName());
+        }));
+
+  results.append(measureStep("Route graph open", [this, &graphFile]() -> void
+        {
+          graph.open(graphFile.fileName());
+        }));
+
+  if(graph.isOpen())
+  {
+    RouteFinder finder(graph);
+    results.append(measureQueries("Radio route queries", finder, MODE_RADIO, ROUTE_RADIO));
+    results.append(measureQueries("Airway route queries", finder, MODE_AIRWAY, ROUTE_AIRWAY));
+    results.append(measureQueries("Mixed route queries", finder, MODE_MIXED, ROUTE_AIRWAY));
+    graph.close();
+  }
+  return results;
+}
+
+RouteBenchmarkResult RouteBenchmark::measureStep(const QString& name, const std::function<void()>& function)
+{
+  QVector<double> times({atools::benchmark::measureMs(function)});
+  return {name, 0, summarize(times), peakMemoryKb()};
+}
+
+RouteBenchmarkResult RouteBenchmark::measureQueries(const QString& name, RouteFinder& finder, RouteMode mode,
+                                                    RouteNetwork network)
+{
+  QVector<double> times;
+  int notFound = 0, numNodes = graph.numNodes(network);
+  if(numNodes > 1)
+  {
+    std::mt19937 generator(SEED);
+    std::uniform_int_distribution<int> node(0, numNodes - 1);
+    QVector<RouteLeg> route;
+    QElapsedTimer timer;
+
+    for(int i = 0; i < numQueries; i++)
+    {
+      RouteNode from = {network, node(generator)}, to = {network, node(generator)};
+      timer.start();
+      if(!finder.calculateRoute(mode, from, to, route))
+        notFound++;
+      times.append(atools::benchmark::elapsedMs(timer));
+    }
+  }
+  return {name, notFound, summarize(times), peakMemoryKb()};
+}
+
+void RouteBenchmark::print(QTextStream& out, const QVector<RouteBenchmarkResult>& results)
+{
+  atools::benchmark::printBuildInfo(out);
+
+  out << qSetFieldWidth(24) << left << "Step" << qSetFieldWidth(8) << right << "Count" << "Failed"
+      << qSetFieldWidth(12);
+  atools::benchmark::printTimingHeader(out);
+  out << qSetFieldWidth(14) << "Peak kB" << qSetFieldWidth(0) << endl;
+
+  for(const RouteBenchmarkResult& result : results)
+  {
+    out << qSetFieldWidth(24) << left << result.name << qSetFieldWidth(8) << right
+        << result.timing.count << result.notFound << qSetFieldWidth(12);
+    atools::benchmark::printTiming(out, result.timing);
+    out << qSetFieldWidth(14) << result.peakMemoryKb << qSetFieldWidth(0) << endl;
+  }
+}
+
+} // namespace routing
+} // namespace atools
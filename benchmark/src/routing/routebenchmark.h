@@ -0,0 +1,103 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_ROUTING_ROUTEBENCHMARK_H
+#define ATOOLS_ROUTING_ROUTEBENCHMARK_H
+
+#include "benchmark/benchmarkutil.h"
+#include "fs/navdatabaseoptions.h"
+#include "routing/routefinder.h"
+
+#include <QVector>
+
+#include <functional>
+
+class QTextStream;
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+
+namespace routing {
+
+/* Result of one benchmark step or one set of route queries */
+struct RouteBenchmarkResult
+{
+  QString name;
+  int notFound;
+  atools::benchmark::TimingSummary timing;
+
+  /* Peak resident memory of the process after the step or -1 if not available on this platform */
+  qint64 peakMemoryKb;
+};
+
+/*
+ * Benchmark for airway resolution, route edge generation, route graph export and route queries to track
+ * regressions in compilation time and interactive route calculation.
+ *
+ * Runs on a copy of a compiled reference database or on a generated network. Queries use random origin and
+ * destination pairs generated with a fixed seed so that results of different builds are comparable.
+ */
+class RouteBenchmark
+{
+public:
+  /* Airway, route node and route edge tables in the database are modified. Use a copy of a reference database. */
+  explicit RouteBenchmark(atools::sql::SqlDatabase *sqlDb);
+
+  /* Create the navigation and route schema and fill it with a jittered grid of waypoints, straight airways along
+   * grid rows and columns and randomly placed radio navaids. */
+  void generate(int numWaypoints, int numAirways, int numRadioNodes);
+
+  /* Number of route queries per network. Default is 1000. */
+  void setNumQueries(int value)
+  {
+    numQueries = value;
+  }
+
+  /* Threads for airway resolution and edge generation. Default is 1. */
+  void setNumThreads(int value)
+  {
+    numThreads = value;
+  }
+
+  /* Run all steps. Airway resolution is skipped if table airway_point is missing which is the case for
+   * a finished compiled database. */
+  QVector<atools::routing::RouteBenchmarkResult> run();
+
+  /* Print results as a table with one line per step */
+  static void print(QTextStream& out, const QVector<atools::routing::RouteBenchmarkResult>& results);
+
+private:
+  /* Run function once and measure time */
+  atools::routing::RouteBenchmarkResult measureStep(const QString& name, const std::function<void()>& function);
+
+  /* Run numQueries random queries in the network */
+  atools::routing::RouteBenchmarkResult measureQueries(const QString& name, atools::routing::RouteFinder& finder,
+                                                       atools::routing::RouteMode mode,
+                                                       atools::fs::common::RouteNetwork network);
+
+  atools::sql::SqlDatabase *db;
+  atools::fs::NavDatabaseOptions options;
+  atools::fs::common::RouteGraph graph;
+  int numQueries = 1000, numThreads = 1;
+};
+
+} // namespace routing
+} // namespace atools
+
+#endif // ATOOLS_ROUTING_ROUTEBENCHMARK_H
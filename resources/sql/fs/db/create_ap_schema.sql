@@ -561,6 +561,33 @@ create index if not exists idx_transition_leg_transition_id on transition_leg(tr
 
 -- **************************************************
 
+drop table if exists approach_leg_geometry;
+
+-- Precalculated approach leg geometry. Only filled if option ProcedureLegGeometry is set.
+-- See atools::fs::db::ProcedureGeometry.
+create table approach_leg_geometry
+(
+  approach_leg_id integer primary key,
+  num_points integer not null,          -- Number of points in the simplified geometry
+  geometry blob not null,               -- From end of previous leg to termination of this leg
+foreign key(approach_leg_id) references approach_leg(approach_leg_id)
+);
+
+-- **************************************************
+
+drop table if exists transition_leg_geometry;
+
+-- Precalculated transition leg geometry. Columns are the same as for approach_leg_geometry.
+create table transition_leg_geometry
+(
+  transition_leg_id integer primary key,
+  num_points integer not null,
+  geometry blob not null,
+foreign key(transition_leg_id) references transition_leg(transition_leg_id)
+);
+
+-- **************************************************
+
 drop table if exists parking;
 
 -- Parking spot. Includes fuel and vehicle parking.
@@ -53,6 +53,25 @@ foreign key(file_id) references bgl_file(bgl_file_id)
 
 create index if not exists idx_boundary_file_id on boundary(file_id);
 
+-- *************************************************************
+
+drop table if exists boundary_lod;
+
+-- Simplified boundary geometries for lower zoom levels. Only filled if option BoundaryLevelOfDetail is set.
+-- See atools::fs::db::BoundaryLod.
+create table boundary_lod
+(
+  boundary_lod_id integer primary key,
+  boundary_id integer not null,
+  level integer not null,               -- 1 is the finest simplified level - full geometry is in table boundary
+  tolerance double not null,            -- Simplification tolerance in degrees
+  num_points integer not null,          -- Number of points in the simplified geometry
+  geometry blob not null,
+foreign key(boundary_id) references boundary(boundary_id)
+);
+
+create index if not exists idx_boundary_lod_boundary_id on boundary_lod(boundary_id, level);
+
 -- minimum off route altitude
 drop table if exists mora_grid;
 
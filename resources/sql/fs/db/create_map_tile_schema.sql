@@ -0,0 +1,17 @@
+-- *************************************************************
+-- Table for pre-tiled map layers. Only created if option MapTileMaxZoom is not negative.
+--
+-- data contains the compressed features of a web mercator tile.
+-- See atools::fs::db::MapTileWriter and atools::fs::db::MapTileReader.
+-- *************************************************************
+
+drop table if exists map_tile;
+
+create table map_tile
+(
+  zoom integer not null,
+  x integer not null,
+  y integer not null,
+  data blob not null,
+primary key (zoom, x, y)
+);
@@ -32,7 +32,11 @@ create table metadata
   airac_cycle varchar(10),            -- AIRAC cycle (not FSX/P3D)
   valid_through varchar(10),          -- AIRAC cycle valid through (not FSX/P3D/XP11)
   data_source varchar(10),            -- Data source, FSX, FSXSE, P3DV2, P3DV3, P3DV3, XP11 or NG (Navigraph)
-  compiler_version varchar(1000)      -- Compiler program version and revision string
+  compiler_version varchar(1000),     -- Compiler program version and revision string
+  checkpoint_step integer,            -- Number of completed steps. Only set while compiling. Used to resume.
+  checkpoint_name varchar(250),       -- Name of the last completed step
+  checkpoint_options varchar(100),    -- Hash of the compilation options
+  checkpoint_rowids varchar(10000)    -- Largest rowid of all tables at the checkpoint as "table:rowid;..."
 );
 
 -- **************************************************
@@ -75,6 +79,21 @@ foreign key(scenery_area_id) references scenery_area(scenery_area_id)
 
 create index if not exists idx_bgl_file_scenery_area_id on bgl_file(scenery_area_id);
 
+drop table if exists bgl_file_state;
+
+-- State of all scenery files that were scanned during the last compilation.
+-- Used by the incremental mode to detect changes. Contains also files without content.
+-- Filled only after a successful compilation of FSX or P3D scenery.
+create table bgl_file_state
+(
+  filepath varchar(1000) not null,         -- Absolute filename including full path
+  size integer not null,                   -- File size in bytes
+  file_modification_time integer not null, -- Modification time of the file. Seconds since Epoch.
+  hash blob                                -- Optional MD5 hash of the file content
+);
+
+-- **************************************************
+
 drop table if exists script;
 
 -- A database preparation script containiing create index statements for example
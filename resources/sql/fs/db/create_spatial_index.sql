@@ -0,0 +1,63 @@
+-- *************************************************************
+-- Create R*Tree spatial indexes for all tables shown on the map.
+-- Needs SQLite compiled with the R*Tree module. Only run if option SpatialIndex is set.
+--
+-- Each table <name> gets a virtual table <name>_rtree with columns id, min_lonx, max_lonx,
+-- min_laty and max_laty. Rectangles crossing the anti-meridian are stored with max_lonx
+-- increased by 360 degree. Queries have to check the search rectangle also shifted by 360
+-- degree. See atools::fs::db::RTreeQuery.
+-- *************************************************************
+
+-- Airports, airway segments and boundaries with bounding rectangles
+drop table if exists airport_rtree;
+create virtual table airport_rtree using rtree(id, min_lonx, max_lonx, min_laty, max_laty);
+insert into airport_rtree
+select airport_id, left_lonx, case when left_lonx > right_lonx then right_lonx + 360 else right_lonx end, bottom_laty, top_laty
+from airport;
+
+drop table if exists airway_rtree;
+create virtual table airway_rtree using rtree(id, min_lonx, max_lonx, min_laty, max_laty);
+insert into airway_rtree
+select airway_id, left_lonx, case when left_lonx > right_lonx then right_lonx + 360 else right_lonx end, bottom_laty, top_laty
+from airway;
+
+drop table if exists boundary_rtree;
+create virtual table boundary_rtree using rtree(id, min_lonx, max_lonx, min_laty, max_laty);
+insert into boundary_rtree
+select boundary_id, min_lonx, case when min_lonx > max_lonx then max_lonx + 360 else max_lonx end, min_laty, max_laty
+from boundary;
+
+-- Navaids and parking positions
+drop table if exists waypoint_rtree;
+create virtual table waypoint_rtree using rtree(id, min_lonx, max_lonx, min_laty, max_laty);
+insert into waypoint_rtree select waypoint_id, lonx, lonx, laty, laty from waypoint;
+
+drop table if exists vor_rtree;
+create virtual table vor_rtree using rtree(id, min_lonx, max_lonx, min_laty, max_laty);
+insert into vor_rtree select vor_id, lonx, lonx, laty, laty from vor;
+
+drop table if exists ndb_rtree;
+create virtual table ndb_rtree using rtree(id, min_lonx, max_lonx, min_laty, max_laty);
+insert into ndb_rtree select ndb_id, lonx, lonx, laty, laty from ndb;
+
+drop table if exists marker_rtree;
+create virtual table marker_rtree using rtree(id, min_lonx, max_lonx, min_laty, max_laty);
+insert into marker_rtree select marker_id, lonx, lonx, laty, laty from marker;
+
+drop table if exists parking_rtree;
+create virtual table parking_rtree using rtree(id, min_lonx, max_lonx, min_laty, max_laty);
+insert into parking_rtree select parking_id, lonx, lonx, laty, laty from parking;
+
+-- ILS including the feather. Use the whole longitude range for the few crossing the anti-meridian.
+drop table if exists ils_rtree;
+create virtual table ils_rtree using rtree(id, min_lonx, max_lonx, min_laty, max_laty);
+insert into ils_rtree
+select ils_id,
+  case when max_lonx - min_lonx > 180 then -180 else min_lonx end,
+  case when max_lonx - min_lonx > 180 then 180 else max_lonx end,
+  min_laty, max_laty
+from (
+  select ils_id,
+    min(lonx, end1_lonx, end2_lonx) as min_lonx, max(lonx, end1_lonx, end2_lonx) as max_lonx,
+    min(laty, end1_laty, end2_laty) as min_laty, max(laty, end1_laty, end2_laty) as max_laty
+  from ils);
@@ -0,0 +1,25 @@
+-- *************************************************************
+-- Create the FTS5 full text index for ident, name, region and city searches.
+-- Needs SQLite compiled with FTS5. Only run if option FullTextSearch is set.
+--
+-- source is "airport" or "nav_search" and source_id the id in this table.
+-- Prefix indexes speed up autocomplete queries. See atools::fs::db::TextSearchQuery.
+-- *************************************************************
+
+drop table if exists nav_text_search;
+
+create virtual table nav_text_search using fts5(
+  ident, name, region, city,
+  source unindexed, source_id unindexed,
+  prefix = '1 2 3',
+  tokenize = 'unicode61 remove_diacritics 1'
+);
+
+insert into nav_text_search (ident, name, region, city, source, source_id)
+select ident, name, region, city, 'airport', airport_id from airport;
+
+insert into nav_text_search (ident, name, region, city, source, source_id)
+select ident, name, region, null, 'nav_search', nav_search_id from nav_search;
+
+-- Merge all b-trees for faster queries
+insert into nav_text_search (nav_text_search) values ('optimize');
@@ -0,0 +1,27 @@
+-- *************************************************************
+-- Remove duplicate airports and airway points resulting from add-on BGL files.
+-- Used instead of delete_duplicates.sql if navaids, waypoints and ILS are
+-- already deduplicated while writing (option DeduplicateOnWrite).
+-- *************************************************************
+
+-- Print duplicate airports to the log
+select airport_id, ident, name, scenery_local_path, bgl_filename from airport
+where airport_id not in (select max(airport_id) from airport group by ident);
+
+-- Delete duplicate airports with the lowest id (stock)
+delete from airport
+where airport_id not in (select max(airport_id) from airport group by ident);
+
+delete from approach where airport_id not in (select airport_id from airport);
+delete from approach_leg where approach_id not in (select approach_id from approach);
+delete from transition where approach_id not in (select approach_id from approach);
+delete from transition_leg where transition_id not in (select transition_id from transition);
+
+-- Delete duplicate airway points
+delete from airway_point
+where airway_point_id not in (
+  select max(airway_point_id)
+  from airway_point
+  group by name, type, mid_type, mid_ident, mid_region,
+      next_type, next_ident, next_region, previous_type, previous_ident, previous_region
+);
@@ -22,6 +22,8 @@
 -- Order is important to avoid fk conflicts
 
 -- drop approach
+drop table if exists transition_leg_geometry;
+drop table if exists approach_leg_geometry;
 drop table if exists transition_leg;
 drop table if exists approach_leg;
 drop table if exists transition;
@@ -23,6 +23,7 @@
 
 -- drop meta
 drop table if exists bgl_file;
+drop table if exists bgl_file_state;
 drop table if exists scenery_area;
 drop table if exists metadata;
 
@@ -30,5 +30,6 @@ drop table if exists marker;
 drop table if exists ndb;
 drop table if exists vor;
 drop table if exists waypoint;
+drop table if exists boundary_lod;
 drop table if exists boundary;
 
@@ -28,3 +28,19 @@ drop table if exists route_node_radio;
 drop table if exists route_node_airway;
 drop table if exists nav_search;
 
+-- drop spatial indexes
+drop table if exists airport_rtree;
+drop table if exists airway_rtree;
+drop table if exists boundary_rtree;
+drop table if exists waypoint_rtree;
+drop table if exists vor_rtree;
+drop table if exists ndb_rtree;
+drop table if exists marker_rtree;
+drop table if exists parking_rtree;
+drop table if exists ils_rtree;
+
+-- drop full text search
+drop table if exists nav_text_search;
+
+-- drop map tiles
+drop table if exists map_tile;
@@ -0,0 +1,128 @@
+-- *****************************************************************************
+-- Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+--
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation, either version 3 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+-- ****************************************************************************/
+
+-- *************************************************************
+-- Update the route_node and route_edge_airway tables inside a region only.
+-- The temporary table route_region has to contain the region split at the anti-meridian.
+-- route_edge_radio is updated in class RouteEdgeWriter afterwards.
+-- *************************************************************
+
+-- Update route_node_radio table with VOR and NDB inside the region -----------------------------------
+
+delete from route_node_radio
+where exists (select 1 from route_region r
+              where lonx between r.left_lonx and r.right_lonx and laty between r.bottom_laty and r.top_laty);
+
+insert into route_node_radio (nav_id, type, range, lonx, laty)
+select vor_id as nav_id,
+  case
+    when dme_altitude is null then 1 -- VOR
+    else 2                           -- VORDME
+  end as type,
+  (range * 1852.216) as range, lonx, laty
+from vor v where dme_only = 0 and type != 'TC' and
+  exists (select 1 from route_region r
+          where v.lonx between r.left_lonx and r.right_lonx and v.laty between r.bottom_laty and r.top_laty);
+
+insert into route_node_radio (nav_id, type, range, lonx, laty)
+select ndb_id as nav_id, 4 as type, (range  * 1852.216) as range, lonx, laty
+from ndb n where
+  exists (select 1 from route_region r
+          where n.lonx between r.left_lonx and r.right_lonx and n.laty between r.bottom_laty and r.top_laty);
+
+-- Update route_node_airway and route_edge_airway tables inside the region -----------------------------------
+
+-- Remove all segments touching the region before the node ids change
+delete from route_edge_airway
+where from_node_id in (select node_id from route_node_airway n join route_region r
+                       on n.lonx between r.left_lonx and r.right_lonx and n.laty between r.bottom_laty and r.top_laty) or
+  to_node_id in (select node_id from route_node_airway n join route_region r
+                 on n.lonx between r.left_lonx and r.right_lonx and n.laty between r.bottom_laty and r.top_laty);
+
+delete from route_node_airway
+where exists (select 1 from route_region r
+              where lonx between r.left_lonx and r.right_lonx and laty between r.bottom_laty and r.top_laty);
+
+-- Type field: airway type is in bits 4-7 and a subtype (vor, etc.) is stored in bits 0-3 - see populate_route_node.sql
+insert into route_node_airway (nav_id, type, lonx, laty)
+select w.waypoint_id as nav_id,
+  case when w.num_victor_airway > 0 and w.num_jet_airway = 0 then
+  -- Waypoint victor
+  case when w.type = 'N' then 5 * 16 + 4         -- victor + NDB
+    when w.type = 'V' then
+    case when v.dme_only = 1 then 5 * 16 + 3     -- victor + DME
+    when v.dme_altitude is null then 5 * 16 + 1  -- victor + VOR
+    else 5 * 16 + 2                              -- victor + VORDME
+    end
+  else 5 * 16                                      -- victor + Waypoint only
+  end
+  when w.num_victor_airway = 0 and w.num_jet_airway > 0 then
+  -- Waypoint jet
+  case when w.type = 'N' then 6 * 16 + 4         -- jet + NDB
+  when w.type = 'V' then
+    case when v.dme_only = 1 then 6 * 16 + 3     -- jet + DME
+    when v.dme_altitude is null then 6 * 16 + 1  -- jet + VOR
+    else 6 * 16 + 2                              -- jet + VORDME
+    end
+    else 6 * 16                                      -- jet + Waypoint only
+    end
+  when w.num_victor_airway > 0 and w.num_jet_airway > 0 then
+  -- Waypoint both
+  case when w.type = 'N' then 7 * 16 + 4         -- both + NDB
+  when w.type = 'V' then
+    case when v.dme_only = 1 then 7 * 16 + 3     -- both + DME
+    when v.dme_altitude is null then 7 * 16 + 1  -- both + VOR
+    else 7 * 16 + 2                              -- both + VORDME
+    end
+    else 7 * 16                                      -- both + Waypoint only
+    end
+  else null -- Should never happen - let it fail with not null
+  end as type, w.lonx, w.laty
+from waypoint w left outer join vor v on w.nav_id = v.vor_id
+where (w.num_victor_airway > 0 or w.num_jet_airway > 0) and
+  exists (select 1 from route_region r
+          where w.lonx between r.left_lonx and r.right_lonx and w.laty between r.bottom_laty and r.top_laty);
+
+-- Add all segments touching the region again
+insert into route_edge_airway (airway_id, from_node_id, from_node_type, to_node_id, to_node_type, type,
+                               direction, minimum_altitude, maximum_altitude, airway_name)
+select a.airway_id, n1.node_id as from_node_id,
+  n1.type as from_node_type,
+  n2.node_id as to_node_id,
+  n2.type as to_node_type,
+case
+  when a.airway_type = 'V' then 5
+  when a.airway_type = 'J' then 6
+  when a.airway_type = 'B' then 7
+  else 0
+end as type,
+case
+  -- 0 = both, 1 = forward only (from -> to), 2 = backward only (to -> from)
+  -- when a.direction = 'N' then 0
+  when a.direction = 'F' then 1
+  when a.direction = 'B' then 2
+  else 0
+end as direction,
+a.minimum_altitude,
+a.maximum_altitude,
+a.airway_name as airway_name
+from airway a
+join route_node_airway n1 on a.from_waypoint_id = n1.nav_id
+join route_node_airway n2 on a.to_waypoint_id = n2.nav_id
+where exists (select 1 from route_region r
+              where (n1.lonx between r.left_lonx and r.right_lonx and n1.laty between r.bottom_laty and r.top_laty) or
+                    (n2.lonx between r.left_lonx and r.right_lonx and n2.laty between r.bottom_laty and r.top_laty));
@@ -0,0 +1,29 @@
+-- *****************************************************************************
+-- Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+--
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation, either version 3 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+-- ****************************************************************************/
+
+-- Read state of the Logbook.BIN files for incremental loading in atools::fs::lb::LogbookLoader.
+-- Created if missing so it can be added to existing logbook databases.
+
+create table if not exists logbook_file
+(
+  simulator_id integer primary key, -- Simulator type
+  file_size integer not null,       -- Size of Logbook.BIN when it was read
+  file_offset integer not null,     -- Byte offset after the last read entry
+  entry_count integer not null,     -- Number of entries in file up to file_offset including filtered ones
+  next_logbook_id integer not null, -- Logbook id for the next entry
+  checksum integer not null         -- Checksum of the bytes before file_offset to detect a rewritten file
+);
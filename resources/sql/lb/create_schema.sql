@@ -19,6 +19,10 @@
 
 drop table if exists logbook;
 
+-- Read state and totals are not valid anymore - see create_file_schema.sql and create_stats_schema.sql
+drop table if exists logbook_file;
+drop table if exists logbook_statistics;
+
 -- Table holding logbook entries read from Logbook.BIN of FSX.
 -- The table is denormalized to speed up searches and does not need
 -- the optional airport table.
@@ -0,0 +1,38 @@
+-- *****************************************************************************
+-- Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+--
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation, either version 3 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+-- ****************************************************************************/
+
+-- Precomputed totals for atools::fs::lb::Logbook::getSummaries.
+-- Updated incrementally for each loaded entry. Created if missing so it can be added to existing databases.
+
+create table if not exists logbook_statistics
+(
+  simulator_id integer not null,    -- Simulator type
+  stats_type integer not null,      -- 0 = airport, 1 = aircraft, 2 = month - see atools::fs::lb::SummaryType
+  key text not null,                -- Airport ICAO, aircraft description or month as yyyy-MM
+  sub_key text not null,            -- Aircraft registration - empty for other types
+  num_flights integer not null,     -- Flights departing or arriving at airport or using aircraft in month
+  num_departures integer not null,  -- Departures at airport - same as num_flights for other types
+  num_arrivals integer not null,    -- Arrivals at airport - same as num_flights for other types
+  total_time real not null,         -- Sum of total time in decimal hours
+  night_time real not null,         -- Sum of night time in decimal hours
+  instrument_time real not null,    -- Sum of IFR time in decimal hours
+  distance real not null,           -- Sum of distance in nautical miles for flights having airport coordinates
+primary key (simulator_id, stats_type, key, sub_key)
+);
+
+create index if not exists idx_logbook_statistics_flights on logbook_statistics(simulator_id, stats_type, num_flights);
+create index if not exists idx_logbook_sim_startdate on logbook(simulator_id, startdate);
@@ -22,6 +22,8 @@ drop view if exists logbook_all;
 
 drop table if exists logbook_visits;
 drop table if exists logbook;
+drop table if exists logbook_file;
+drop table if exists logbook_statistics;
 
 
 
@@ -26,6 +26,8 @@
 #include <QTextCodec>
 #include <QCoreApplication>
 #include <QDateTime>
+#include <QMutex>
+#include <QHash>
 
 namespace atools {
 
@@ -161,6 +163,72 @@ bool contains(const QString& name, const std::initializer_list<const char *>& li
   return false;
 }
 
+/* Directory listing cache for buildPathNoCase - active while a PathNoCaseCache exists */
+struct DirEntry
+{
+  QString name;
+  bool isDir;
+};
+
+static QMutex pathCacheMutex;
+static int pathCacheUsers = 0;
+static QHash<QString, QVector<DirEntry> > pathCache;
+
+PathNoCaseCache::PathNoCaseCache()
+{
+  QMutexLocker locker(&pathCacheMutex);
+  pathCacheUsers++;
+}
+
+PathNoCaseCache::~PathNoCaseCache()
+{
+  QMutexLocker locker(&pathCacheMutex);
+  if(--pathCacheUsers == 0)
+    pathCache.clear();
+}
+
+#if !defined(Q_OS_WIN32) && !defined(Q_OS_MACOS)
+/* Find entry in directory using the cache. Exact match is preferred over a case insensitive one.
+ * Returns false if the cache is not active. */
+static bool findCachedDirEntry(const QDir& dir, const QString& path, QString& name, bool& isDir, bool& found)
+{
+  QMutexLocker locker(&pathCacheMutex);
+  if(pathCacheUsers == 0)
+    return false;
+
+  auto it = pathCache.find(dir.path());
+  if(it == pathCache.end())
+  {
+    // Read directory once
+    QVector<DirEntry> entries;
+    for(const QFileInfo& fileinfo : dir.entryInfoList(QDir::AllEntries, QDir::Name | QDir::IgnoreCase))
+      entries.append({fileinfo.fileName(), fileinfo.isDir()});
+    it = pathCache.insert(dir.path(), entries);
+  }
+
+  const DirEntry *caseMatch = nullptr;
+  for(const DirEntry& entry : it.value())
+  {
+    if(entry.name == path)
+    {
+      caseMatch = &entry;
+      break;
+    }
+    else if(caseMatch == nullptr && entry.name.compare(path, Qt::CaseInsensitive) == 0)
+      caseMatch = &entry;
+  }
+
+  found = caseMatch != nullptr;
+  if(found)
+  {
+    name = caseMatch->name;
+    isDir = caseMatch->isDir;
+  }
+  return true;
+}
+
+#endif
+
 QString buildPathNoCase(const QStringList& paths)
 {
 
@@ -179,6 +247,25 @@ QString buildPathNoCase(const QStringList& paths)
       dir = path;
     else
     {
+      QString cachedName;
+      bool cachedIsDir = false, cachedFound = false;
+      if(findCachedDirEntry(dir, path, cachedName, cachedIsDir, cachedFound))
+      {
+        // Use cached directory listing
+        if(!cachedFound)
+          dir = dir.path() + QDir::separator() + path;
+        else if(cachedIsDir)
+          // Directory exists - change into it without checking again
+          dir.setPath(QDir::cleanPath(dir.path() + QDir::separator() + cachedName));
+        else
+        {
+          file = cachedName;
+          break;
+        }
+        i++;
+        continue;
+      }
+
       // Get entries that match exacly the next path element
       QStringList entries = dir.entryList({path});
 
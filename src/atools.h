@@ -75,6 +75,20 @@ QString elideTextLinesShort(QString str, int maxLength);
 /* Concatenates all paths parts with the QDir::separator() and fetches names correcting the case */
 QString buildPathNoCase(const QStringList& paths);
 
+/* Caches directory listings used by buildPathNoCase while at least one instance exists.
+ * Avoids repeated directory reads when building many paths, e.g. while compiling a database.
+ * Directories must not be modified while the cache is active. Thread safe. */
+class PathNoCaseCache
+{
+public:
+  PathNoCaseCache();
+  ~PathNoCaseCache();
+
+  PathNoCaseCache(const PathNoCaseCache& other) = delete;
+  PathNoCaseCache& operator=(const PathNoCaseCache& other) = delete;
+
+};
+
 /* Simply concatenates all paths parts with the QDir::separator() */
 QString buildPath(const QStringList& paths);
 
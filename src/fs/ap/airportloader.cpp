@@ -17,6 +17,7 @@
 
 #include "fs/ap/airportloader.h"
 
+#include "sql/sqlbatch.h"
 #include "sql/sqldatabase.h"
 #include "sql/sqlquery.h"
 #include "sql/sqlscript.h"
@@ -33,6 +34,12 @@ using atools::sql::SqlDatabase;
 using atools::sql::SqlScript;
 using atools::sql::SqlQuery;
 using atools::sql::SqlUtil;
+using atools::sql::SqlBatch;
+
+/* Element names compared without conversion */
+const static QLatin1String DATA("data"), ICAO("ICAO"), ICAO_NAME("ICAOName"), CITY("City"), STATE("State"),
+COUNTRY("Country"), LONGITUDE("Longitude"), LATITUDE("Latitude"), ALTITUDE("Altitude"), RUNWAY("Runway"),
+LEN("Len"), ILS_FREQ("ILSFreq"), EDGE_LIGHTS("EdgeLights");
 
 AirportLoader::AirportLoader(SqlDatabase *sqlDb)
   : db(sqlDb)
@@ -42,6 +49,7 @@ AirportLoader::AirportLoader(SqlDatabase *sqlDb)
 
 AirportLoader::~AirportLoader()
 {
+  delete batch;
   delete query;
 }
 
@@ -49,7 +57,8 @@ void AirportLoader::loadAirports(const QString& filename)
 {
   QFile xmlFile(filename);
 
-  if(xmlFile.open(QIODevice::ReadOnly | QIODevice::Text))
+  // XML reader handles line endings itself - avoid text mode conversion
+  if(xmlFile.open(QIODevice::ReadOnly))
   {
     using atools::settings::Settings;
     SqlScript script(db);
@@ -62,16 +71,25 @@ void AirportLoader::loadAirports(const QString& filename)
 
     reader.readNextStartElement();
 
-    if(reader.name() == "data")
+    if(reader.name() == DATA)
     {
       numLoaded = 0;
       // Use insert or replace
       query->prepare(SqlUtil(db).buildInsertStatement("airport", "or replace"));
+      delete batch;
+      batch = new SqlBatch(query, BATCH_SIZE);
       readData();
+
+      if(reader.error() == QXmlStreamReader::NoError)
+        batch->exec();
     }
     else
       reader.raiseError(QObject::tr("The file is not an runways.xml file. Element \"data\" not found."));
 
+    delete batch;
+    batch = nullptr;
+    strings.clear();
+
     if(reader.error() == QXmlStreamReader::NoError)
     {
       db->commit();
@@ -99,7 +117,7 @@ void AirportLoader::readData()
 
   while(reader.readNextStartElement())
   {
-    if(reader.name() == "ICAO")
+    if(reader.name() == ICAO)
       readIcao();
     else
       // Error will be recognized later
@@ -109,44 +127,47 @@ void AirportLoader::readData()
 
 void AirportLoader::readIcao()
 {
-  QStringRef id = reader.attributes().value("id");
-  query->bindValue(":icao", id.toString());
+  // Collect values first since the batch needs a value for each column
+  QVariant name, city, state, country;
+  double longitude = 0., latitude = 0.;
+  int altitude = 0;
 
+  QString icao = reader.attributes().value("id").toString();
   bool hasLights = false, hasIls = false;
   int maxRunwayLength = 0;
 
   while(reader.readNextStartElement())
   {
     // Read only a part of the elementss
-    QStringRef name = reader.name();
-    if(name == "ICAOName")
-      query->bindValue(":name", reader.readElementText());
-    else if(name == "City")
-      query->bindValue(":city", reader.readElementText());
-    else if(name == "State")
-      query->bindValue(":state", reader.readElementText());
-    else if(name == "Country")
-      query->bindValue(":country", reader.readElementText());
-    else if(name == "Longitude")
-      query->bindValue(":longitude", reader.readElementText().toDouble());
-    else if(name == "Latitude")
-      query->bindValue(":latitude", reader.readElementText().toDouble());
-    else if(name == "Altitude")
-      query->bindValue(":altitude", reader.readElementText().toInt());
-    else if(name == "Runway")
+    QStringRef elementName = reader.name();
+    if(elementName == ICAO_NAME)
+      name = reader.readElementText();
+    else if(elementName == CITY)
+      city = intern(reader.readElementText());
+    else if(elementName == STATE)
+      state = intern(reader.readElementText());
+    else if(elementName == COUNTRY)
+      country = intern(reader.readElementText());
+    else if(elementName == LONGITUDE)
+      longitude = reader.readElementText().toDouble();
+    else if(elementName == LATITUDE)
+      latitude = reader.readElementText().toDouble();
+    else if(elementName == ALTITUDE)
+      altitude = reader.readElementText().toInt();
+    else if(elementName == RUNWAY)
       while(reader.readNextStartElement())
       {
         QStringRef rName = reader.name();
-        if(rName == "Len")
+        if(rName == LEN)
           maxRunwayLength = qMax(reader.readElementText().toInt(), maxRunwayLength);
-        else if(rName == "ILSFreq")
+        else if(rName == ILS_FREQ)
         {
           if(!reader.readElementText().trimmed().isEmpty())
             hasIls = true;
         }
-        else if(rName == "EdgeLights")
+        else if(rName == EDGE_LIGHTS)
         {
-          if(reader.readElementText().trimmed() != "NONE")
+          if(reader.readElementText().trimmed() != QLatin1String("NONE"))
             hasLights = true;
         }
         else
@@ -154,12 +175,32 @@ void AirportLoader::readIcao()
       }
     else
       reader.skipCurrentElement();
-    numLoaded++;
   }
-  query->bindValue(":max_runway_length", maxRunwayLength);
-  query->bindValue(":has_lights", hasLights ? 1 : 0);
-  query->bindValue(":has_ils", hasIls ? 1 : 0);
-  query->exec();
+
+  batch->bindValue(":icao", icao);
+  batch->bindValue(":name", name);
+  batch->bindValue(":city", city);
+  batch->bindValue(":state", state);
+  batch->bindValue(":country", country);
+  batch->bindValue(":longitude", longitude);
+  batch->bindValue(":latitude", latitude);
+  batch->bindValue(":altitude", altitude);
+  batch->bindValue(":max_runway_length", maxRunwayLength);
+  batch->bindValue(":has_lights", hasLights ? 1 : 0);
+  batch->bindValue(":has_ils", hasIls ? 1 : 0);
+  batch->addRow();
+  numLoaded++;
+}
+
+QVariant AirportLoader::intern(const QString& str)
+{
+  if(str.isEmpty())
+    return QVariant(QVariant::String);
+
+  auto it = strings.constFind(str);
+  if(it == strings.constEnd())
+    it = strings.insert(str, str);
+  return it.value();
 }
 
 void AirportLoader::dropDatabase()
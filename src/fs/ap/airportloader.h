@@ -20,6 +20,8 @@
 
 #include "sql/sqlquery.h"
 
+#include <QHash>
+#include <QVariant>
 #include <QXmlStreamReader>
 
 namespace atools {
@@ -27,6 +29,7 @@ namespace atools {
 namespace sql {
 class SqlDatabase;
 class SqlQuery;
+class SqlBatch;
 }
 
 namespace fs {
@@ -35,6 +38,9 @@ namespace ap {
 /*
  * Loads the runways.xml file into a SQL database.
  * Only a limited set of airport information is loaded.
+ *
+ * The file is streamed and rows are inserted in batches within one transaction.
+ * Memory use does not depend on the file size.
  */
 class AirportLoader
 {
@@ -66,14 +72,24 @@ public:
 
 private:
   atools::sql::SqlDatabase *db;
+  /* Number of airports collected before the insert is executed */
+  const int BATCH_SIZE = 2000;
+
   atools::sql::SqlQuery *query;
+  atools::sql::SqlBatch *batch = nullptr;
   int numLoaded = 0;
   QXmlStreamReader reader;
 
+  /* Shared strings for values like city, state and country which repeat for many airports */
+  QHash<QString, QString> strings;
+
   void readData();
   void readIcao();
   void readRunway();
 
+  /* Returns a shared copy of str or null variant if empty */
+  QVariant intern(const QString& str);
+
 };
 
 } // namespace fs
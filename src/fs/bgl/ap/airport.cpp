@@ -114,6 +114,21 @@ Airport::Airport(const NavDatabaseOptions *options, BinaryStream *bs,
   QStringList taxinames;
   int helipadStart = 1;
 
+  // Look up filters only once - excluded subrecords are skipped using their size without reading their content
+  bool incRunway = options->isIncludedNavDbObject(type::RUNWAY);
+  bool incCom = options->isIncludedNavDbObject(type::COM);
+  bool incParking = options->isIncludedNavDbObject(type::PARKING);
+  bool incApproach = options->isIncludedNavDbObject(type::APPROACH);
+  bool incWaypoint = options->isIncludedNavDbObject(type::WAYPOINT);
+  bool incApron = options->isIncludedNavDbObject(type::APRON);
+  bool incApronLight = incApron && options->isIncludedNavDbObject(type::APRONLIGHT);
+  bool incHelipad = options->isIncludedNavDbObject(type::HELIPAD);
+  bool incStart = options->isIncludedNavDbObject(type::START);
+  bool incFence = options->isIncludedNavDbObject(type::FENCE);
+  bool incTaxiway = options->isIncludedNavDbObject(type::TAXIWAY);
+  bool incTaxiwayRunway = options->isIncludedNavDbObject(type::TAXIWAY_RUNWAY);
+  bool incVehicle = options->isIncludedNavDbObject(type::VEHICLE);
+
   int subrecordIndex = 0;
   while(bs->tellg() < startOffset + size)
   {
@@ -129,7 +144,7 @@ Airport::Airport(const NavDatabaseOptions *options, BinaryStream *bs,
         break;
       case rec::RUNWAY_P3D_V4:
       case rec::RUNWAY:
-        if(options->isIncludedNavDbObject(type::RUNWAY))
+        if(incRunway)
         {
           r.seekToStart();
 
@@ -147,7 +162,7 @@ Airport::Airport(const NavDatabaseOptions *options, BinaryStream *bs,
         }
         break;
       case rec::COM:
-        if(options->isIncludedNavDbObject(type::COM))
+        if(incCom)
         {
           r.seekToStart();
           coms.append(Com(options, bs));
@@ -155,7 +170,7 @@ Airport::Airport(const NavDatabaseOptions *options, BinaryStream *bs,
         break;
       case rec::TAXI_PARKING_FS9: // FS9 parking has slightly different structure
       case rec::TAXI_PARKING:
-        if(options->isIncludedNavDbObject(type::PARKING))
+        if(incParking)
         {
           int numParkings = bs->readUShort();
           for(int i = 0; i < numParkings; i++)
@@ -170,14 +185,14 @@ Airport::Airport(const NavDatabaseOptions *options, BinaryStream *bs,
         }
         break;
       case rec::APPROACH:
-        if(options->isIncludedNavDbObject(type::APPROACH))
+        if(incApproach)
         {
           r.seekToStart();
           approaches.append(Approach(options, bs));
         }
         break;
       case rec::AIRPORT_WAYPOINT:
-        if(options->isIncludedNavDbObject(type::WAYPOINT))
+        if(incWaypoint)
         {
           r.seekToStart();
           Waypoint wp(options, bs);
@@ -194,7 +209,7 @@ Airport::Airport(const NavDatabaseOptions *options, BinaryStream *bs,
         break;
 
       case rec::APRON_FIRST:
-        if(options->isIncludedNavDbObject(type::APRON))
+        if(incApron)
         {
           r.seekToStart();
           aprons.append(Apron(options, bs));
@@ -202,26 +217,29 @@ Airport::Airport(const NavDatabaseOptions *options, BinaryStream *bs,
         break;
       case rec::APRON_SECOND_P3D_V4:
       case rec::APRON_SECOND:
-        // if(options->includeBglObject(type::APRON2)) will be omitted when writing to the database
-        r.seekToStart();
-        aprons2.append(Apron2(options, bs, type == rec::APRON_SECOND_P3D_V4));
+        // Second apron record is only used together with the first one
+        if(incApron)
+        {
+          r.seekToStart();
+          aprons2.append(Apron2(options, bs, type == rec::APRON_SECOND_P3D_V4));
+        }
         break;
       case rec::APRON_EDGE_LIGHTS:
-        if(options->isIncludedNavDbObject(type::APRON) && options->isIncludedNavDbObject(type::APRONLIGHT))
+        if(incApronLight)
         {
           r.seekToStart();
           apronLights.append(ApronEdgeLight(options, bs));
         }
         break;
       case rec::HELIPAD:
-        if(options->isIncludedNavDbObject(type::HELIPAD))
+        if(incHelipad)
         {
           r.seekToStart();
           helipads.append(Helipad(options, bs));
         }
         break;
       case rec::START:
-        if(options->isIncludedNavDbObject(type::START))
+        if(incStart)
         {
           r.seekToStart();
           Start start(options, bs);
@@ -233,14 +251,14 @@ Airport::Airport(const NavDatabaseOptions *options, BinaryStream *bs,
         }
         break;
       case rec::JETWAY:
-        if(options->isIncludedNavDbObject(type::PARKING))
+        if(incParking)
         {
           r.seekToStart();
           jetways.append(Jetway(options, bs));
         }
         break;
       case rec::FENCE_BOUNDARY:
-        if(options->isIncludedNavDbObject(type::FENCE))
+        if(incFence)
         {
           r.seekToStart();
           fences.append(Fence(options, bs));
@@ -248,7 +266,7 @@ Airport::Airport(const NavDatabaseOptions *options, BinaryStream *bs,
         numBoundaryFence++;
         break;
       case rec::FENCE_BLAST:
-        if(options->isIncludedNavDbObject(type::FENCE))
+        if(incFence)
         {
           r.seekToStart();
           fences.append(Fence(options, bs));
@@ -259,16 +277,16 @@ Airport::Airport(const NavDatabaseOptions *options, BinaryStream *bs,
         break;
       case rec::TAXI_PATH_P3D_V4:
       case rec::TAXI_PATH:
-        if(options->isIncludedNavDbObject(type::TAXIWAY))
+        if(incTaxiway)
         {
           int numPaths = bs->readUShort();
           for(int i = 0; i < numPaths; i++)
           {
             TaxiPath path(bs, type == rec::TAXI_PATH_P3D_V4);
             if((path.getType() == atools::fs::bgl::taxipath::RUNWAY &&
-                !options->isIncludedNavDbObject(type::TAXIWAY_RUNWAY)) ||
+                !incTaxiwayRunway) ||
                (path.getType() == atools::fs::bgl::taxipath::VEHICLE &&
-                !options->isIncludedNavDbObject(type::VEHICLE)))
+                !incVehicle))
               continue;
 
             taxipaths.append(path);
@@ -276,7 +294,7 @@ Airport::Airport(const NavDatabaseOptions *options, BinaryStream *bs,
         }
         break;
       case rec::TAXI_POINT:
-        if(options->isIncludedNavDbObject(type::TAXIWAY))
+        if(incTaxiway)
         {
           int numPoints = bs->readUShort();
           for(int i = 0; i < numPoints; i++)
@@ -284,7 +302,7 @@ Airport::Airport(const NavDatabaseOptions *options, BinaryStream *bs,
         }
         break;
       case rec::TAXI_NAME:
-        if(options->isIncludedNavDbObject(type::TAXIWAY))
+        if(incTaxiway)
         {
           int numNames = bs->readUShort();
           for(int i = 0; i < numNames; i++)
@@ -325,7 +343,7 @@ Airport::Airport(const NavDatabaseOptions *options, BinaryStream *bs,
   // Set the jetway flag on parking
   updateParking(jetways, parkingNumberIndex);
 
-  if(!options->isIncludedNavDbObject(type::VEHICLE))
+  if(!incVehicle)
     removeVehicleParking();
 
   // Update all the number fields and the bounding rectangle
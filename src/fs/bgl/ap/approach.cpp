@@ -52,8 +52,7 @@ Approach::Approach(const NavDatabaseOptions *options, BinaryStream *bs)
   fixIdent = converter::intToIcao((fixFlags >> 5) & 0xfffffff, true);
 
   unsigned int fixIdentFlags = bs->readUInt();
-  fixRegion = converter::intToIcao(fixIdentFlags & 0x7ff, true);
-  fixAirportIdent = converter::intToIcao((fixIdentFlags >> 11) & 0x1fffff, true);
+  converter::intToRegionAndIcao(fixIdentFlags, fixRegion, fixAirportIdent);
 
   altitude = bs->readFloat();
   heading = bs->readFloat(); // TODO wiki heading is float degrees
@@ -44,8 +44,7 @@ ApproachLeg::ApproachLeg(io::BinaryStream *bs, bool ismissed)
   fixIdent = converter::intToIcao((fixFlags >> 5) & 0xfffffff, true);
 
   unsigned int fixIdentFlags = bs->readUInt();
-  fixRegion = converter::intToIcao(fixIdentFlags & 0x7ff, true);
-  fixAirportIdent = converter::intToIcao((fixIdentFlags >> 11) & 0x1fffff, true);
+  converter::intToRegionAndIcao(fixIdentFlags, fixRegion, fixAirportIdent);
 
   unsigned int recFixFlags = bs->readUInt();
   recommendedFixType = static_cast<ap::fix::ApproachFixType>(recFixFlags & 0xf);
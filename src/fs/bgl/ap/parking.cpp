@@ -16,6 +16,8 @@
 *****************************************************************************/
 
 #include "fs/bgl/ap/parking.h"
+#include "fs/bgl/converter.h"
+#include "fs/bgl/recordlayout.h"
 #include "io/binarystream.h"
 
 namespace atools {
@@ -24,6 +26,51 @@ namespace bgl {
 
 using atools::io::BinaryStream;
 
+namespace layout {
+
+/* FS9 parking */
+struct Parking
+{
+  typedef Field<0, quint32> Flags;
+  typedef Field<4, float> Radius;
+  typedef Field<8, float> Heading;
+  typedef Field<12, qint32> LonX;
+  typedef Field<16, qint32> LatY;
+  static Q_DECL_CONSTEXPR int SIZE = LatY::END;
+};
+
+/* FSX and P3D parking with tee offsets */
+struct TaxiParking
+{
+  typedef Field<0, quint32> Flags;
+  typedef Field<4, float> Radius;
+  typedef Field<8, float> Heading;
+  typedef Field<12, quint8[16]> TeeOffsets;
+  typedef Field<28, qint32> LonX;
+  typedef Field<32, qint32> LatY;
+  static Q_DECL_CONSTEXPR int SIZE = LatY::END;
+};
+
+static_assert(isContiguous<Parking::Flags, Parking::Radius, Parking::Heading, Parking::LonX, Parking::LatY>(),
+              "Invalid parking layout");
+static_assert(isContiguous<TaxiParking::Flags, TaxiParking::Radius, TaxiParking::Heading, TaxiParking::TeeOffsets,
+                           TaxiParking::LonX, TaxiParking::LatY>(), "Invalid taxi parking layout");
+
+} // namespace layout
+
+/* Read the fixed part of both parking layouts */
+template<typename LAYOUT>
+static void readParkingBlock(BinaryStream *bs, unsigned int& flags, float& radius, float& heading,
+                             BglPosition& position)
+{
+  layout::RecordBlock<LAYOUT> block(bs);
+  flags = block.template get<typename LAYOUT::Flags>();
+  radius = block.template get<typename LAYOUT::Radius>();
+  heading = block.template get<typename LAYOUT::Heading>(); // TODO wiki heading is float degrees
+  position = BglPosition(converter::intToLonX(block.template get<typename LAYOUT::LonX>()),
+                         converter::intToLatY(block.template get<typename LAYOUT::LatY>()));
+}
+
 QString Parking::parkingTypeToStr(ap::ParkingType type)
 {
   switch(type)
@@ -223,21 +270,18 @@ Parking::Parking()
 
 Parking::Parking(BinaryStream *bs, rec::AirportRecordType rectype)
 {
-  unsigned int flags = bs->readUInt();
+  unsigned int flags;
+  if(rectype == rec::TAXI_PARKING) // TODO wiki mention FS9 format
+    readParkingBlock<layout::TaxiParking>(bs, flags, radius, heading, position);
+  else
+    readParkingBlock<layout::Parking>(bs, flags, radius, heading, position);
+
   name = static_cast<ap::ParkingName>(flags & 0x3f);
   pushBack = static_cast<ap::PushBack>((flags >> 6) & 0x3);
   type = static_cast<ap::ParkingType>((flags >> 8) & 0xf);
   number = (flags >> 12) & 0xfff;
   int numAirlineCodes = (flags >> 24) & 0xff;
 
-  radius = bs->readFloat();
-  heading = bs->readFloat(); // TODO wiki heading is float degrees
-
-  if(rectype == rec::TAXI_PARKING) // TODO wiki mention FS9 format
-    bs->skip(16);  // teeOffset 1-4
-
-  position = BglPosition(bs);
-
   for(int i = 0; i < numAirlineCodes; i++)
     airlineCodes.append(bs->readString(4));
 }
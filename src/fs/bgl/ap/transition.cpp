@@ -78,8 +78,7 @@ Transition::Transition(const NavDatabaseOptions *options, BinaryStream *bs)
   transFixIdent = converter::intToIcao((transFixFlags >> 5) & 0xfffffff, true);
 
   unsigned int fixIdentFlags = bs->readUInt();
-  fixRegion = converter::intToIcao(fixIdentFlags & 0x7ff, true);
-  fixAirportIdent = converter::intToIcao((fixIdentFlags >> 11) & 0x1fffff, true);
+  converter::intToRegionAndIcao(fixIdentFlags, fixRegion, fixAirportIdent);
 
   altitude = bs->readFloat();
 
@@ -87,8 +86,7 @@ Transition::Transition(const NavDatabaseOptions *options, BinaryStream *bs)
   {
     dmeIdent = converter::intToIcao(bs->readUInt());
     unsigned int tempFixIdentFlags = bs->readUInt();
-    dmeRegion = converter::intToIcao(tempFixIdentFlags & 0x7ff, true);
-    dmeAirportIdent = converter::intToIcao((tempFixIdentFlags >> 11) & 0x1fffff, true);
+    converter::intToRegionAndIcao(tempFixIdentFlags, dmeRegion, dmeAirportIdent);
     dmeRadial = bs->readInt();
     dmeDist = bs->readFloat();
   }
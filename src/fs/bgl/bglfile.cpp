@@ -32,6 +32,7 @@
 #include "fs/bgl/nav/waypoint.h"
 #include "fs/bgl/boundary.h"
 #include "fs/bgl/recordtypes.h"
+#include "logging/loggingmacros.h"
 
 #include <QList>
 #include <QDebug>
@@ -81,6 +82,12 @@ void BglFile::readFile(QString file)
       return;
 
     readSections(&bs);
+    if(sections.isEmpty())
+    {
+      // Nothing of interest in the section directory - e.g. files with models, textures or exclusions only
+      ifs.close();
+      return;
+    }
 
     if(options->isIncludedNavDbObject(type::BOUNDARY))
       readBoundaryRecords(&bs);
@@ -91,12 +98,12 @@ void BglFile::readFile(QString file)
   }
 }
 
-bool BglFile::isValid()
+bool BglFile::isValid() const
 {
   return header.isValid();
 }
 
-bool BglFile::hasContent()
+bool BglFile::hasContent() const
 {
   return !(airports.isEmpty() &&
            namelists.isEmpty() &&
@@ -170,14 +177,14 @@ void BglFile::handleBoundaries(BinaryStream *bs)
 
     rec.seekToEnd();
   }
-  if(options->isVerbose())
+  if(ATOOLS_VERBOSE(options->isVerbose()))
     qDebug() << "Num boundary records" << numRecs;
 }
 
 void BglFile::readHeader(BinaryStream *bs)
 {
   header = Header(options, bs);
-  if(options->isVerbose())
+  if(ATOOLS_VERBOSE(options->isVerbose()))
     qDebug() << header;
 }
 
@@ -188,10 +195,10 @@ void BglFile::readSections(BinaryStream *bs)
   {
     Section s = Section(options, bs);
 
-    // Add only supported sections to the list
-    if(supportedSectionTypes.contains(s.getType()))
+    // Add only supported sections to the list which contain objects that are not excluded by configuration
+    if(supportedSectionTypes.contains(s.getType()) && isSectionIncluded(s.getType()))
     {
-      if(options->isVerbose())
+      if(ATOOLS_VERBOSE(options->isVerbose()))
         qDebug() << s;
       sections.append(s);
     }
@@ -208,7 +215,7 @@ void BglFile::readSections(BinaryStream *bs)
       for(unsigned int i = 0; i < section.getNumSubsections(); i++)
       {
         Subsection s(options, bs, section);
-        if(options->isVerbose())
+        if(ATOOLS_VERBOSE(options->isVerbose()))
           qDebug() << s;
         subsections.append(s);
       }
@@ -216,6 +223,35 @@ void BglFile::readSections(BinaryStream *bs)
   }
 }
 
+bool BglFile::isSectionIncluded(section::SectionType type) const
+{
+  switch(type)
+  {
+    case section::AIRPORT:
+    case section::AIRPORT_ALT:
+      return options->isIncludedNavDbObject(type::AIRPORT);
+
+    case section::ILS_VOR:
+      return options->isIncludedNavDbObject(type::ILS) || options->isIncludedNavDbObject(type::VOR);
+
+    case section::NDB:
+      return options->isIncludedNavDbObject(type::NDB);
+
+    case section::MARKER:
+      return options->isIncludedNavDbObject(type::MARKER);
+
+    case section::WAYPOINT:
+      return options->isIncludedNavDbObject(type::WAYPOINT);
+
+    case section::BOUNDARY:
+      return options->isIncludedNavDbObject(type::BOUNDARY);
+
+    default:
+      // Name lists, TACAN and others are always read
+      return true;
+  }
+}
+
 const Record *BglFile::handleIlsVor(BinaryStream *bs)
 {
   // Read only type before creating concrete object
@@ -249,7 +285,7 @@ void BglFile::readRecords(BinaryStream *bs)
   {
     section::SectionType type = subsection.getParent().getType();
 
-    if(options->isVerbose())
+    if(ATOOLS_VERBOSE(options->isVerbose()))
     {
       qDebug() << "=======================";
       qDebug().nospace().noquote() << "Records of 0x" << hex << subsection.getFirstDataRecordOffset() << dec
@@ -387,8 +423,7 @@ void BglFile::deleteAllObjects()
   sections.clear();
   subsections.clear();
 
-  qDeleteAll(allRecords);
-  allRecords.clear();
+  arena.reset();
 
   filename = QString();
   size = 0;
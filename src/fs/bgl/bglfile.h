@@ -24,6 +24,9 @@
 #include "fs/bgl/subsection.h"
 #include "fs/navdatabaseoptions.h"
 #include "io/binarystream.h"
+#include "util/monotonicarena.h"
+#include "logging/loggingratelimiter.h"
+#include "logging/loggingmacros.h"
 
 #include <QString>
 #include <QList>
@@ -146,17 +149,21 @@ public:
   /*
    * @return true if any relevant content is available. Header and sections do not count.
    */
-  bool hasContent();
+  bool hasContent() const;
 
   /*
    * @return true if header and section structure is valid
    */
-  bool isValid();
+  bool isValid() const;
 
 private:
   void deleteAllObjects();
   void readHeader(atools::io::BinaryStream *bs);
   void readSections(atools::io::BinaryStream *bs);
+
+  /* false if the section contains only objects that are excluded by the configuration.
+   * Such sections are dropped from the directory before any subsection or record is read. */
+  bool isSectionIncluded(atools::fs::bgl::section::SectionType type) const;
   void readRecords(atools::io::BinaryStream *bs);
   const Record *handleIlsVor(atools::io::BinaryStream *bs);
 
@@ -175,8 +182,8 @@ private:
   qint64 size;
   const NavDatabaseOptions *options;
 
-  /* Keep a list of all records to make object deletion easier */
-  QList<const atools::fs::bgl::Record *> allRecords;
+  /* Owns all records of the current file. Reset before reading the next file. */
+  atools::util::MonotonicArena arena;
 
   QList<const atools::fs::bgl::Airport *> airports;
   QList<const atools::fs::bgl::Namelist *> namelists;
@@ -201,11 +208,11 @@ private:
 template<typename TYPE>
 const TYPE *BglFile::createRecord(atools::io::BinaryStream *bs, QList<const TYPE *> *list)
 {
-  TYPE *rec = new TYPE(options, bs);
+  TYPE *rec = arena.create<TYPE>(options, bs);
 
   if(rec->isExcluded())
   {
-    delete rec;
+    arena.destroyLast(rec);
     return nullptr;
   }
 
@@ -213,13 +220,13 @@ const TYPE *BglFile::createRecord(atools::io::BinaryStream *bs, QList<const TYPE
   {
     // Print warning only for navaids that are not disabled
     if(!rec->isDisabled())
-      qWarning() << "Found invalid record: " << rec->getObjectName();
+      ATOOLS_LOG_LIMITED(qWarning() << "Found invalid record: " << rec->getObjectName());
     rec->seekToStart();
-    delete rec;
+    arena.destroyLast(rec);
     return nullptr;
   }
 
-  if(options->isVerbose())
+  if(ATOOLS_VERBOSE(options->isVerbose()))
   {
     qDebug() << "----";
     qDebug() << *rec;
@@ -227,7 +234,6 @@ const TYPE *BglFile::createRecord(atools::io::BinaryStream *bs, QList<const TYPE
 
   if(list != nullptr)
     list->append(rec);
-  allRecords.append(rec);
   return rec;
 }
 
@@ -235,11 +241,11 @@ template<typename TYPE>
 const TYPE *BglFile::createRecord(atools::io::BinaryStream *bs, QList<const TYPE *> *list,
                                   atools::fs::bgl::flags::CreateFlags flags)
 {
-  TYPE *rec = new TYPE(options, bs, flags);
+  TYPE *rec = arena.create<TYPE>(options, bs, flags);
 
   if(rec->isExcluded())
   {
-    delete rec;
+    arena.destroyLast(rec);
     return nullptr;
   }
 
@@ -247,13 +253,13 @@ const TYPE *BglFile::createRecord(atools::io::BinaryStream *bs, QList<const TYPE
   {
     // Print warning only for navaids that are not disabled
     if(!rec->isDisabled())
-      qWarning() << "Found invalid record: " << rec->getObjectName();
+      ATOOLS_LOG_LIMITED(qWarning() << "Found invalid record: " << rec->getObjectName());
     rec->seekToStart();
-    delete rec;
+    arena.destroyLast(rec);
     return nullptr;
   }
 
-  if(options->isVerbose())
+  if(ATOOLS_VERBOSE(options->isVerbose()))
   {
     qDebug() << "----";
     qDebug() << *rec;
@@ -261,7 +267,6 @@ const TYPE *BglFile::createRecord(atools::io::BinaryStream *bs, QList<const TYPE
 
   if(list != nullptr)
     list->append(rec);
-  allRecords.append(rec);
   return rec;
 }
 
@@ -0,0 +1,244 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/bgl/bglwaypointwriter.h"
+
+#include "exception.h"
+#include "fs/bgl/converter.h"
+#include "fs/bgl/header.h"
+#include "fs/bgl/recordtypes.h"
+#include "fs/bgl/sectiontype.h"
+#include "geo/pos.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace atools {
+namespace fs {
+namespace bgl {
+
+/* Cell level for grouping records into subsections. Level 0 has 3 columns and 2 rows. */
+static const int CELL_LEVEL = 9;
+static const quint32 CELL_COLUMNS = 3 << CELL_LEVEL;
+static const quint32 CELL_ROWS = 2 << CELL_LEVEL;
+
+/* Sizes of section and subsection table entries */
+static const int SECTION_SIZE = 20;
+static const int SUBSECTION_SIZE = 16;
+
+/* Size flag for sections with subsections of 16 bytes. See Section. */
+static const quint32 SECTION_SIZE_FLAG = 1;
+
+/* Writes little endian values at the current position and advances it */
+class BufferWriter
+{
+public:
+  explicit BufferWriter(char *buffer)
+    : mem(reinterpret_cast<uchar *>(buffer))
+  {
+  }
+
+  void writeUInt(quint32 value)
+  {
+    qToLittleEndian(value, mem);
+    mem += 4;
+  }
+
+  void writeInt(qint32 value)
+  {
+    qToLittleEndian(value, mem);
+    mem += 4;
+  }
+
+  void writeUShort(quint16 value)
+  {
+    qToLittleEndian(value, mem);
+    mem += 2;
+  }
+
+  void writeUByte(quint8 value)
+  {
+    *mem++ = value;
+  }
+
+  void writeFloat(float value)
+  {
+    quint32 intValue;
+    memcpy(&intValue, &value, sizeof(intValue));
+    writeUInt(intValue);
+  }
+
+private:
+  uchar *mem;
+};
+
+BglWaypointWriter::BglWaypointWriter()
+{
+
+}
+
+void BglWaypointWriter::reserve(int numWaypoints)
+{
+  lonX.reserve(numWaypoints);
+  latY.reserve(numWaypoints);
+  magVar.reserve(numWaypoints);
+  ident.reserve(numWaypoints);
+  regionFlags.reserve(numWaypoints);
+  cell.reserve(numWaypoints);
+  type.reserve(numWaypoints);
+}
+
+void BglWaypointWriter::addWaypoint(const atools::geo::Pos& pos, const QString& waypointIdent,
+                                    const QString& region, float magvar, nav::WaypointType waypointType,
+                                    const QString& airportIdent)
+{
+  qint32 x = converter::lonXToInt(pos.getLonX());
+  qint32 y = converter::latYToInt(pos.getLatY());
+  lonX.append(x);
+  latY.append(y);
+  magVar.append(converter::magvarToFs(magvar));
+  ident.append(converter::icaoToInt(waypointIdent));
+
+  // Region in the lower 11 bits and airport in the upper 21 bits
+  regionFlags.append((converter::icaoToInt(region.left(2), true) & 0x7ff) |
+                     ((converter::icaoToInt(airportIdent.left(4), true) & 0x1fffff) << 11));
+  type.append(static_cast<quint8>(waypointType));
+
+  // Grid coordinates use 28 bits per unit at level 0
+  quint32 column = std::min(static_cast<quint32>(std::max(x, 0)) >> (28 - CELL_LEVEL), CELL_COLUMNS - 1);
+  quint32 row = std::min(static_cast<quint32>(std::max(y, 0)) >> (28 - CELL_LEVEL), CELL_ROWS - 1);
+  cell.append(row * CELL_COLUMNS + column);
+}
+
+void BglWaypointWriter::clear()
+{
+  lonX.clear();
+  latY.clear();
+  magVar.clear();
+  ident.clear();
+  regionFlags.clear();
+  cell.clear();
+  type.clear();
+}
+
+QByteArray BglWaypointWriter::getData() const
+{
+  int num = size();
+
+  // Sort indexes by cell to get contiguous records for each subsection
+  QVector<int> order(num);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](int i1, int i2) -> bool {
+                     return cell.at(i1) < cell.at(i2);
+                   });
+
+  int numSubsections = 0;
+  for(int i = 0; i < num; i++)
+  {
+    if(i == 0 || cell.at(order.at(i)) != cell.at(order.at(i - 1)))
+      numSubsections++;
+  }
+
+  int numSections = num > 0 ? 1 : 0;
+  int subsectionOffset = static_cast<int>(Header::HEADER_SIZE) + numSections * SECTION_SIZE;
+  int recordOffset = subsectionOffset + numSubsections * SUBSECTION_SIZE;
+  int totalSize = recordOffset + num * WAYPOINT_RECORD_SIZE;
+
+  // Allocate once and fill all bytes in one pass
+  QByteArray data(totalSize, '\0');
+  BufferWriter writer(data.data());
+
+  // Header ==============================
+  unsigned int lowDateTime, highDateTime;
+  converter::timeToFiletime(QDateTime::currentDateTimeUtc().toTime_t(), lowDateTime, highDateTime);
+  writer.writeUInt(Header::MAGIC_NUMBER1);
+  writer.writeUInt(Header::HEADER_SIZE);
+  writer.writeUInt(lowDateTime);
+  writer.writeUInt(highDateTime);
+  writer.writeUInt(Header::MAGIC_NUMBER2);
+  writer.writeUInt(static_cast<quint32>(numSections));
+  for(int i = 0; i < 8; i++)
+    // QMIDs are not used by the readers
+    writer.writeUInt(0);
+
+  if(num == 0)
+    return data;
+
+  // Section ==============================
+  writer.writeUInt(section::WAYPOINT);
+  writer.writeUInt(SECTION_SIZE_FLAG);
+  writer.writeUInt(static_cast<quint32>(numSubsections));
+  writer.writeUInt(static_cast<quint32>(subsectionOffset));
+  writer.writeUInt(static_cast<quint32>(numSubsections * SUBSECTION_SIZE));
+
+  // Subsections ==============================
+  int offset = recordOffset;
+  for(int i = 0; i < num;)
+  {
+    int start = i;
+    quint32 id = cell.at(order.at(i));
+    while(i < num && cell.at(order.at(i)) == id)
+      i++;
+
+    writer.writeUInt(id);
+    writer.writeInt(i - start);
+    writer.writeInt(offset);
+    writer.writeInt((i - start) * WAYPOINT_RECORD_SIZE);
+    offset += (i - start) * WAYPOINT_RECORD_SIZE;
+  }
+
+  // Records ==============================
+  for(int index : order)
+  {
+    writer.writeUShort(rec::WAYPOINT);
+    writer.writeUInt(WAYPOINT_RECORD_SIZE);
+    writer.writeUByte(type.at(index));
+    writer.writeUByte(0); // Number of airways
+    writer.writeInt(lonX.at(index));
+    writer.writeInt(latY.at(index));
+    writer.writeFloat(magVar.at(index));
+    writer.writeUInt(ident.at(index));
+    writer.writeUInt(regionFlags.at(index));
+  }
+
+  return data;
+}
+
+void BglWaypointWriter::writeFile(const QString& filename) const
+{
+  QFile file(filename);
+  if(file.open(QIODevice::WriteOnly))
+  {
+    QByteArray data = getData();
+    if(file.write(data) != data.size())
+      throw atools::Exception(QObject::tr("Cannot write BGL file \"%1\". Reason: %2").
+                              arg(filename).arg(file.errorString()));
+    file.close();
+  }
+  else
+    throw atools::Exception(QObject::tr("Cannot open BGL file \"%1\". Reason: %2").
+                            arg(filename).arg(file.errorString()));
+}
+
+} // namespace bgl
+} // namespace fs
+} // namespace atools
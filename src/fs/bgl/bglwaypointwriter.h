@@ -0,0 +1,93 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_BGL_BGLWAYPOINTWRITER_H
+#define ATOOLS_BGL_BGLWAYPOINTWRITER_H
+
+#include "fs/bgl/nav/waypoint.h"
+
+#include <QVector>
+
+namespace atools {
+namespace geo {
+class Pos;
+}
+namespace fs {
+namespace bgl {
+
+/*
+ * Writes a binary BGL file containing a waypoint section. Inverse of the waypoint reading in BglFile.
+ *
+ * Waypoints are converted into the BGL binary format when added and kept in columnar arrays. The file is written
+ * in one pass into a buffer which is allocated once with the final size. Records are grouped into subsections
+ * by level 9 cells of the BGL coordinate grid.
+ *
+ * Waypoints have no names in BGL files. Therefore no name list is written.
+ */
+class BglWaypointWriter
+{
+public:
+  BglWaypointWriter();
+
+  /* Preallocate space for waypoints */
+  void reserve(int numWaypoints);
+
+  /*
+   * Add a waypoint.
+   * @param ident up to five digits or letters
+   * @param region two character ICAO region
+   * @param magVar magnetic variation with East positive and West negative
+   * @param airportIdent optional ICAO airport ident up to four characters
+   */
+  void addWaypoint(const atools::geo::Pos& pos, const QString& ident, const QString& region, float magVar,
+                   atools::fs::bgl::nav::WaypointType type = atools::fs::bgl::nav::NAMED,
+                   const QString& airportIdent = QString());
+
+  int size() const
+  {
+    return lonX.size();
+  }
+
+  bool isEmpty() const
+  {
+    return lonX.isEmpty();
+  }
+
+  void clear();
+
+  /* Get the complete BGL file contents */
+  QByteArray getData() const;
+
+  /* Write BGL file. Throws Exception on error. */
+  void writeFile(const QString& filename) const;
+
+  /* Size of a waypoint record without airways */
+  static const int WAYPOINT_RECORD_SIZE = 0x1c;
+
+private:
+  /* Columns in BGL format */
+  QVector<qint32> lonX, latY;
+  QVector<float> magVar;
+  QVector<quint32> ident, regionFlags, cell;
+  QVector<quint8> type;
+};
+
+} // namespace bgl
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_BGL_BGLWAYPOINTWRITER_H
@@ -17,8 +17,9 @@
 
 #include "fs/bgl/converter.h"
 #include "exception.h"
+#include "util/stringpool.h"
 
-#include <QVarLengthArray>
+#include <QVector>
 #include <QDebug>
 
 namespace atools {
@@ -27,65 +28,129 @@ namespace bgl {
 namespace converter {
 
 static const char *RUNWAY_DESIGNATORS[] = {"", "L", "R", "C", "W", "A", "B"};
+static const int NUM_DESIGNATORS = 7;
+
+/* Runway numbers 1-36 and 37-44 for the special direction codes */
+static const int NUM_RUNWAY_NUMBERS = 45;
+
+/* Character for each base 38 digit of the packed ICAO format. 0 terminates, 1 maps to '6' like the
+ * original arithmetic conversion, 2-11 are digits and 12-37 letters. */
+static const char ICAO_CHARS[38] = {
+  '\0', '6', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9',
+  'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M',
+  'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z'
+};
+
+/* 38^5 - values above need more than five characters */
+static const unsigned int ICAO_MAX = 38u * 38u * 38u * 38u * 38u;
+
+/* Decode ICAO value into buffer of characters. Returns length or -1 if invalid. */
+static int decodeIcao(unsigned int value, char buf[5])
+{
+  if(value >= ICAO_MAX)
+    return -1;
+
+  // Extract all five base 38 digits with the least significant first
+  unsigned int digits[5];
+  for(int i = 0; i < 5; i++)
+  {
+    digits[i] = value % 38;
+    value /= 38;
+  }
+
+  // Valid characters end at the first zero digit and are stored in reverse order
+  int len = 0;
+  while(len < 5 && digits[len] != 0)
+    len++;
+
+  for(int i = 0; i < len; i++)
+    buf[len - 1 - i] = ICAO_CHARS[digits[i]];
+  return len;
+}
+
+static QString icaoToString(unsigned int value)
+{
+  if(value == 0)
+    return QString();
+
+  char buf[5];
+  int len = decodeIcao(value, buf);
+  return len > 0 ? QString::fromLatin1(buf, len) : QString();
+}
+
+/* All possible region codes (11 bits) decoded once and shared implicitly. Thread safe static initialization. */
+static const QVector<QString>& regionTable()
+{
+  static const QVector<QString> table = [] {
+      QVector<QString> t(0x800);
+      for(unsigned int i = 0; i < 0x800; i++)
+        t[static_cast<int>(i)] = icaoToString(i);
+      return t;
+    } ();
+  return table;
+}
 
 QString intToIcao(unsigned int icao, bool noBitShift)
 {
-  QString icaoStr;
   unsigned int value = icao;
   // The ICAO identifiers for primary and secondary ILS in a runway record are not shifted.
   if(!noBitShift)
     value = value >> 5;
 
-  if(value == 0)
-    return QString();
+  // Region codes and other small values need no allocation
+  if(value < 0x800)
+    return regionTable().at(static_cast<int>(value));
 
-  QVarLengthArray<unsigned int, 5> codedArr({0, 0, 0, 0, 0});
-  unsigned int coded = 0;
+  // Idents repeat in many records - decode into a stack buffer and get the shared instance from the pool
+  char buf[5];
+  QChar chars[5];
+  int len = decodeIcao(value, buf);
+  for(int i = 0; i < len; i++)
+    chars[i] = QLatin1Char(buf[i]);
 
-  // First extract the coded/compressed values
-  int idx = 0;
-  if(value > 37)
-  {
-    while(value > 37)
-    {
-      if(idx >= codedArr.size())
-        return QString();
-
-      coded = value % 38;
-      codedArr[idx++] = coded;
-      value = (value - coded) / 38;
-      if(value < 38)
-      {
-        if(idx >= codedArr.size())
-          return QString();
-
-        coded = value;
-        codedArr[idx++] = coded;
-      }
-    }
-  }
-  else
-    codedArr[idx++] = value;
+  QString raw = QString::fromRawData(chars, len);
+  return atools::util::StringPool::compileInstance().intern(QStringRef(&raw));
+}
 
-  // Convert the decompressed bytes to characters
-  for(int i = 0; i < 5; i++)
+unsigned int icaoToInt(const QString& icao, bool noBitShift)
+{
+  unsigned int value = 0;
+  for(int i = 0; i < icao.size() && i < 5; i++)
   {
-    coded = codedArr.at(i);
-    if(coded == 0)
-      break;
-    if(coded > 1 && coded < 12)
-      icaoStr.insert(0, '0' + (coded - 2));
+    char c = icao.at(i).toUpper().toLatin1();
+    if(c >= '0' && c <= '9')
+      value = value * 38 + static_cast<unsigned int>(c - '0') + 2;
+    else if(c >= 'A' && c <= 'Z')
+      value = value * 38 + static_cast<unsigned int>(c - 'A') + 12;
     else
-      icaoStr.insert(0, 'A' + (coded - 12));
+      qWarning() << "Invalid character in ICAO identifier" << icao;
   }
-  return icaoStr;
+
+  return noBitShift ? value : value << 5;
 }
 
-QString designatorStr(int designator)
+void intToRegionAndIcao(unsigned int regionFlags, QString& region, QString& airportIdent)
 {
+  region = intToIcao(regionFlags & 0x7ff, true);
+  airportIdent = intToIcao((regionFlags >> 11) & 0x1fffff, true);
+}
 
-  if(designator >= 0 && designator <= 6)
-    return RUNWAY_DESIGNATORS[designator];
+/* Designators as shared strings */
+static const QVector<QString>& designatorTable()
+{
+  static const QVector<QString> table = [] {
+      QVector<QString> t;
+      for(int i = 0; i < NUM_DESIGNATORS; i++)
+        t.append(QString(RUNWAY_DESIGNATORS[i]));
+      return t;
+    } ();
+  return table;
+}
+
+QString designatorStr(int designator)
+{
+  if(designator >= 0 && designator < NUM_DESIGNATORS)
+    return designatorTable().at(designator);
   else
   {
     qWarning() << "Value for designator out of range in designatorStr()" << designator;
@@ -93,7 +158,8 @@ QString designatorStr(int designator)
   }
 }
 
-QString runwayToStr(int runwayNumber, int designator)
+/* Arithmetic conversion used to fill the table and for values out of range */
+static QString runwayToStrInternal(int runwayNumber, int designator)
 {
   QString retval;
   if(runwayNumber < 10)
@@ -147,6 +213,31 @@ QString runwayToStr(int runwayNumber, int designator)
 
 }
 
+/* Names for all valid number and designator combinations. Index is number * NUM_DESIGNATORS + designator. */
+static const QVector<QString>& runwayTable()
+{
+  static const QVector<QString> table = [] {
+      QVector<QString> t;
+      t.reserve(NUM_RUNWAY_NUMBERS * NUM_DESIGNATORS);
+      for(int number = 0; number < NUM_RUNWAY_NUMBERS; number++)
+      {
+        for(int designator = 0; designator < NUM_DESIGNATORS; designator++)
+          t.append(runwayToStrInternal(number, designator));
+      }
+      return t;
+    } ();
+  return table;
+}
+
+QString runwayToStr(int runwayNumber, int designator)
+{
+  if(runwayNumber >= 0 && runwayNumber < NUM_RUNWAY_NUMBERS && designator >= 0 && designator < NUM_DESIGNATORS)
+    return runwayTable().at(runwayNumber * NUM_DESIGNATORS + designator);
+  else
+    // Prints warnings
+    return runwayToStrInternal(runwayNumber, designator);
+}
+
 time_t filetime(unsigned int lowDateTime, unsigned int highDateTime)
 {
   // number of seconds from 1 Jan. 1601 00:00 to 1 Jan 1970 00:00 UTC
@@ -160,6 +251,16 @@ time_t filetime(unsigned int lowDateTime, unsigned int highDateTime)
   return static_cast<time_t>(filetime);
 }
 
+void timeToFiletime(time_t time, unsigned int& lowDateTime, unsigned int& highDateTime)
+{
+  static const unsigned long long FILETIME_EPOCH_DIFF = 11644473600LL;
+  static const unsigned long long FILETIME_SECOND = 10000000LL;
+
+  unsigned long long filetime = (static_cast<unsigned long long>(time) + FILETIME_EPOCH_DIFF) * FILETIME_SECOND;
+  lowDateTime = static_cast<unsigned int>(filetime & 0xffffffff);
+  highDateTime = static_cast<unsigned int>(filetime >> 32);
+}
+
 } // namespace  converter
 } // namespace bgl
 } // namespace fs
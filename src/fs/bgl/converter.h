@@ -44,9 +44,24 @@ inline float intToLatY(int latY)
   return 90.0f - latY * (180.0f / (2.f * 0x10000000));
 }
 
+/* Converts longitude degrees to the BGL specific coordinate format. Inverse of intToLonX(). */
+inline int lonXToInt(float lonX)
+{
+  return static_cast<int>((lonX + 180.0) * (3.0 * 0x10000000 / 360.0) + 0.5);
+}
+
+/* Converts latitude degrees to the BGL specific coordinate format. Inverse of intToLatY(). */
+inline int latYToInt(float latY)
+{
+  return static_cast<int>((90.0 - latY) * (2.0 * 0x10000000 / 180.0) + 0.5);
+}
+
 /* Get the time in seconds since epoch from the BGL header specific format */
 time_t filetime(unsigned int lowDateTime, unsigned int highDateTime);
 
+/* Convert seconds since epoch to the BGL header format. Inverse of filetime(). */
+void timeToFiletime(time_t time, unsigned int& lowDateTime, unsigned int& highDateTime);
+
 /*
  * Convert the BGL ICAO format to string
  * @param noBitShift if true do not shift 5 bits to the right
@@ -54,12 +69,31 @@ time_t filetime(unsigned int lowDateTime, unsigned int highDateTime);
 QString intToIcao(unsigned int icao, bool noBitShift = false);
 
 /*
- * Convert BGL runway designator to a string like "L", "C", "R" or "W"
+ * Convert a string to the BGL ICAO format. Inverse of intToIcao(). Only digits and letters are allowed and
+ * the string is truncated to five characters. Lowercase letters are converted to uppercase.
+ * @param noBitShift if true do not shift 5 bits to the left
+ */
+unsigned int icaoToInt(const QString& icao, bool noBitShift = false);
+
+/*
+ * Decode the region (bits 0-10) and airport ident (bits 11-31) of the region and airport field used by
+ * navaid, waypoint and procedure records in one call.
+ */
+void intToRegionAndIcao(unsigned int regionFlags, QString& region, QString& airportIdent);
+
+/* Inverse of adjustMagvar(). Converts East positive and West negative values to the FS format. */
+inline float magvarToFs(float magVar)
+{
+  return magVar > 0.f ? 360.f - magVar : -magVar;
+}
+
+/*
+ * Convert BGL runway designator to a string like "L", "C", "R" or "W". Returns a shared string.
  */
 QString designatorStr(int designator);
 
 /*
- * Create a full runway name from number and designator.
+ * Create a full runway name from number and designator. Valid combinations are taken from a precomputed table.
  * @return Runway name like "12", "24C" or "NE"
  */
 QString runwayToStr(int runwayNumber, int designator);
@@ -121,10 +121,10 @@ public:
   }
 
   static const unsigned int HEADER_SIZE = 0x38;
+  static const unsigned int MAGIC_NUMBER1 = 0x19920201;
+  static const unsigned int MAGIC_NUMBER2 = 0x08051803;
 
 private:
-  const unsigned int MAGIC_NUMBER1 = 0x19920201;
-  const unsigned int MAGIC_NUMBER2 = 0x08051803;
 
   friend QDebug operator<<(QDebug out, const atools::fs::bgl::Header& header);
 
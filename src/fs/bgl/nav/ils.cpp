@@ -21,6 +21,7 @@
 #include "fs/bgl/nav/glideslope.h"
 
 #include "fs/bgl/converter.h"
+#include "fs/bgl/nav/navlayout.h"
 #include "fs/bgl/recordtypes.h"
 #include "io/binarystream.h"
 
@@ -42,8 +43,10 @@ enum IlsFlags
 Ils::Ils(const NavDatabaseOptions *options, BinaryStream *bs)
   : NavBase(options, bs), localizer(nullptr), glideslope(nullptr), dme(nullptr)
 {
-  bs->readUByte();
-  int flags = bs->readUByte();
+  typedef layout::IlsVor L;
+  layout::RecordBlock<L> block(bs);
+
+  int flags = block.get<L::Flags>();
 
   backcourse = (flags & FLAGS_BC) == FLAGS_BC;
   // TODO  compare values with record presence
@@ -53,15 +56,16 @@ Ils::Ils(const NavDatabaseOptions *options, BinaryStream *bs)
   // hasNav = (flags & FLAGS_NAV) == FLAGS_NAV;
 
   // ILS transmitter position
-  position = BglPosition(bs, true, 1000.f);
-  frequency = bs->readInt() / 1000;
-  range = bs->readFloat();
-  magVar = converter::adjustMagvar(bs->readFloat());
+  position = BglPosition(converter::intToLonX(block.get<L::LonX>()), converter::intToLatY(block.get<L::LatY>()),
+                         block.get<L::Altitude>() / 1000.f);
+  frequency = block.get<L::Frequency>() / 1000;
+  range = block.get<L::Range>();
+  magVar = converter::adjustMagvar(block.get<L::MagVar>());
 
   // ILS ident
-  ident = converter::intToIcao(bs->readUInt());
+  ident = converter::intToIcao(block.get<L::Ident>());
 
-  unsigned int regionFlags = bs->readUInt();
+  unsigned int regionFlags = block.get<L::RegionFlags>();
   // Two letter region code
   region = converter::intToIcao(regionFlags & 0x7ff, true); // TODO wiki region is never set
   // Read airport ICAO ident
@@ -17,6 +17,7 @@
 
 #include "fs/bgl/nav/marker.h"
 #include "fs/bgl/converter.h"
+#include "fs/bgl/nav/navlayout.h"
 #include "io/binarystream.h"
 
 namespace atools {
@@ -60,12 +61,16 @@ Marker::Marker(const NavDatabaseOptions *options, BinaryStream *bs)
   : Record(options, bs)
 {
   // TODO wiki clarify structure
-  heading = ((float)bs->readUByte()) / 255.f * 360.f;
-  type = static_cast<nav::MarkerType>(bs->readUByte());
+  typedef layout::Marker L;
+  layout::RecordBlock<L> block(bs);
 
-  position = BglPosition(bs, true, 1000.f);
-  ident = converter::intToIcao(bs->readUInt());
-  region = converter::intToIcao(bs->readUInt()); // TODO wiki is always null
+  heading = ((float)block.get<L::Heading>()) / 255.f * 360.f;
+  type = static_cast<nav::MarkerType>(block.get<L::Type>());
+
+  position = BglPosition(converter::intToLonX(block.get<L::LonX>()), converter::intToLatY(block.get<L::LatY>()),
+                         block.get<L::Altitude>() / 1000.f);
+  ident = converter::intToIcao(block.get<L::Ident>());
+  region = converter::intToIcao(block.get<L::Region>()); // TODO wiki is always null
 }
 
 Marker::~Marker()
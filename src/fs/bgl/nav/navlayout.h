@@ -0,0 +1,103 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_BGL_NAV_NAVLAYOUT_H
+#define ATOOLS_BGL_NAV_NAVLAYOUT_H
+
+#include "fs/bgl/recordlayout.h"
+
+namespace atools {
+namespace fs {
+namespace bgl {
+namespace layout {
+
+/* Fixed part of the navaid records following the record header. See atools::fs::bgl::layout::RecordBlock. */
+
+/* VOR, DME and ILS. Same record with different types. */
+struct IlsVor
+{
+  typedef Field<0, quint8> Type;
+  typedef Field<1, quint8> Flags;
+  typedef Field<2, qint32> LonX;
+  typedef Field<6, qint32> LatY;
+  typedef Field<10, qint32> Altitude; // Millimeter
+  typedef Field<14, qint32> Frequency; // Hz
+  typedef Field<18, float> Range;
+  typedef Field<22, float> MagVar;
+  typedef Field<26, quint32> Ident;
+  typedef Field<30, quint32> RegionFlags;
+  static Q_DECL_CONSTEXPR int SIZE = RegionFlags::END;
+};
+
+static_assert(isContiguous<IlsVor::Type, IlsVor::Flags, IlsVor::LonX, IlsVor::LatY, IlsVor::Altitude,
+                           IlsVor::Frequency, IlsVor::Range, IlsVor::MagVar, IlsVor::Ident,
+                           IlsVor::RegionFlags>(), "Invalid ILS/VOR layout");
+
+struct Ndb
+{
+  typedef Field<0, qint16> Type;
+  typedef Field<2, qint32> Frequency; // 10 Hz
+  typedef Field<6, qint32> LonX;
+  typedef Field<10, qint32> LatY;
+  typedef Field<14, qint32> Altitude; // Millimeter
+  typedef Field<18, float> Range;
+  typedef Field<22, float> MagVar;
+  typedef Field<26, quint32> Ident;
+  typedef Field<30, quint32> RegionFlags;
+  static Q_DECL_CONSTEXPR int SIZE = RegionFlags::END;
+};
+
+static_assert(isContiguous<Ndb::Type, Ndb::Frequency, Ndb::LonX, Ndb::LatY, Ndb::Altitude, Ndb::Range,
+                           Ndb::MagVar, Ndb::Ident, Ndb::RegionFlags>(), "Invalid NDB layout");
+
+/* Airway segments follow the fixed part */
+struct Waypoint
+{
+  typedef Field<0, quint8> Type;
+  typedef Field<1, quint8> NumAirways;
+  typedef Field<2, qint32> LonX;
+  typedef Field<6, qint32> LatY;
+  typedef Field<10, float> MagVar;
+  typedef Field<14, quint32> Ident;
+  typedef Field<18, quint32> RegionFlags;
+  static Q_DECL_CONSTEXPR int SIZE = RegionFlags::END;
+};
+
+static_assert(isContiguous<Waypoint::Type, Waypoint::NumAirways, Waypoint::LonX, Waypoint::LatY, Waypoint::MagVar,
+                           Waypoint::Ident, Waypoint::RegionFlags>(), "Invalid waypoint layout");
+
+struct Marker
+{
+  typedef Field<0, quint8> Heading; // 0-255 for a full circle
+  typedef Field<1, quint8> Type;
+  typedef Field<2, qint32> LonX;
+  typedef Field<6, qint32> LatY;
+  typedef Field<10, qint32> Altitude; // Millimeter
+  typedef Field<14, quint32> Ident;
+  typedef Field<18, quint32> Region;
+  static Q_DECL_CONSTEXPR int SIZE = Region::END;
+};
+
+static_assert(isContiguous<Marker::Heading, Marker::Type, Marker::LonX, Marker::LatY, Marker::Altitude,
+                           Marker::Ident, Marker::Region>(), "Invalid marker layout");
+
+} // namespace layout
+} // namespace bgl
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_BGL_NAV_NAVLAYOUT_H
@@ -17,6 +17,7 @@
 
 #include "fs/bgl/nav/ndb.h"
 #include "fs/bgl/converter.h"
+#include "fs/bgl/nav/navlayout.h"
 #include "fs/bgl/recordtypes.h"
 #include "io/binarystream.h"
 
@@ -49,16 +50,19 @@ QString Ndb::ndbTypeToStr(nav::NdbType type)
 Ndb::Ndb(const NavDatabaseOptions *options, BinaryStream *bs)
   : NavBase(options, bs)
 {
-  type = static_cast<nav::NdbType>(bs->readShort());
-  frequency = bs->readInt() / 10;
-  position = BglPosition(bs, true, 1000.f);
-  range = bs->readFloat();
-  magVar = converter::adjustMagvar(bs->readFloat());
-  ident = converter::intToIcao(bs->readUInt());
-
-  unsigned int regionFlags = bs->readUInt();
-  region = converter::intToIcao(regionFlags & 0x7ff, true);
-  airportIdent = converter::intToIcao((regionFlags >> 11) & 0x1fffff, true);
+  typedef layout::Ndb L;
+  layout::RecordBlock<L> block(bs);
+
+  type = static_cast<nav::NdbType>(block.get<L::Type>());
+  frequency = block.get<L::Frequency>() / 10;
+  position = BglPosition(converter::intToLonX(block.get<L::LonX>()), converter::intToLatY(block.get<L::LatY>()),
+                         block.get<L::Altitude>() / 1000.f);
+  range = block.get<L::Range>();
+  magVar = converter::adjustMagvar(block.get<L::MagVar>());
+  ident = converter::intToIcao(block.get<L::Ident>());
+
+  unsigned int regionFlags = block.get<L::RegionFlags>();
+  converter::intToRegionAndIcao(regionFlags, region, airportIdent);
 
   // Read only name subrecord
   if(bs->tellg() < startOffset + size)
@@ -44,8 +44,7 @@ Tacan::Tacan(const NavDatabaseOptions *options, BinaryStream *bs)
   magVar = converter::adjustMagvar(bs->readFloat());
   ident = converter::intToIcao(bs->readUInt());
   unsigned int regionFlags = bs->readUInt();
-  region = converter::intToIcao(regionFlags & 0x7ff, true);
-  airportIdent = converter::intToIcao((regionFlags >> 11) & 0x1fffff, true);
+  converter::intToRegionAndIcao(regionFlags, region, airportIdent);
 
   while(bs->tellg() < startOffset + size)
   {
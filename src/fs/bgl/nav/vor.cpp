@@ -22,6 +22,7 @@
 #include "io/binarystream.h"
 
 #include "fs/bgl/converter.h"
+#include "fs/bgl/nav/navlayout.h"
 #include "fs/bgl/recordtypes.h"
 
 namespace atools {
@@ -48,22 +49,26 @@ enum VorFlags
 Vor::Vor(const NavDatabaseOptions *options, BinaryStream *bs)
   : NavBase(options, bs)
 {
-  type = static_cast<nav::IlsVorType>(bs->readUByte());
-  int flags = bs->readUByte();
+  typedef layout::IlsVor L;
+  layout::RecordBlock<L> block(bs);
+
+  type = static_cast<nav::IlsVorType>(block.get<L::Type>());
+  int flags = block.get<L::Flags>();
 
   dmeOnly = (flags & FLAGS_DME_ONLY) == 0;
   // TODO compare flags with record presence
   // hasDme = (flags & FLAGS_DME) == FLAGS_DME;
   // hasNav = (flags & FLAGS_NAV) == FLAGS_NAV;
 
-  position = BglPosition(bs, true, 1000.f);
-  frequency = bs->readInt() / 1000;
-  range = bs->readFloat();
-  magVar = converter::adjustMagvar(bs->readFloat());
+  position = BglPosition(converter::intToLonX(block.get<L::LonX>()), converter::intToLatY(block.get<L::LatY>()),
+                         block.get<L::Altitude>() / 1000.f);
+  frequency = block.get<L::Frequency>() / 1000;
+  range = block.get<L::Range>();
+  magVar = converter::adjustMagvar(block.get<L::MagVar>());
 
-  ident = converter::intToIcao(bs->readUInt());
+  ident = converter::intToIcao(block.get<L::Ident>());
 
-  unsigned int regionFlags = bs->readUInt();
+  unsigned int regionFlags = block.get<L::RegionFlags>();
   region = converter::intToIcao(regionFlags & 0x7ff, true);
 
   // TODO report wiki error ap ident is never set
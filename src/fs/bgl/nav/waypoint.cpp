@@ -18,6 +18,7 @@
 #include "fs/bgl/nav/waypoint.h"
 #include "fs/bgl/converter.h"
 #include "fs/bgl/nav/airwaysegment.h"
+#include "fs/bgl/nav/navlayout.h"
 #include "io/binarystream.h"
 #include "fs/navdatabaseoptions.h"
 
@@ -79,16 +80,17 @@ QString Waypoint::getObjectName() const
 Waypoint::Waypoint(const NavDatabaseOptions *options, BinaryStream *bs)
   : Record(options, bs)
 {
-  type = static_cast<nav::WaypointType>(bs->readUByte());
-  int numAirways = bs->readUByte();
-  position = BglPosition(bs);
-  magVar = converter::adjustMagvar(bs->readFloat());
-  unsigned int identInt = bs->readUInt();
-  ident = converter::intToIcao(identInt);
-
-  unsigned int regionFlags = bs->readUInt();
-  region = converter::intToIcao(regionFlags & 0x7ff, true);
-  airportIdent = converter::intToIcao((regionFlags >> 11) & 0x1fffff, true);
+  typedef layout::Waypoint L;
+  layout::RecordBlock<L> block(bs);
+
+  type = static_cast<nav::WaypointType>(block.get<L::Type>());
+  int numAirways = block.get<L::NumAirways>();
+  position = BglPosition(converter::intToLonX(block.get<L::LonX>()), converter::intToLatY(block.get<L::LatY>()));
+  magVar = converter::adjustMagvar(block.get<L::MagVar>());
+  ident = converter::intToIcao(block.get<L::Ident>());
+
+  unsigned int regionFlags = block.get<L::RegionFlags>();
+  converter::intToRegionAndIcao(regionFlags, region, airportIdent);
 
   if(region.isEmpty() && !isDisabled())
     qWarning().nospace().noquote() << "Waypoint at " << position << " ident " << ident << " has no region";
@@ -62,6 +62,8 @@ Namelist::Namelist(const NavDatabaseOptions *options, BinaryStream *bs)
   bs->seekg(startOffset + icaoListOffset);
 
   // Now put the names into NamelistEntrys
+  entries.reserve(numICAO);
+  identIndex.reserve(numICAO);
   for(int i = 0; i < numICAO; i++)
   {
     NamelistEntry icaoRec;
@@ -75,6 +77,7 @@ Namelist::Namelist(const NavDatabaseOptions *options, BinaryStream *bs)
 
     bs->skip(4); // QMID Level 9 Square.
 
+    identIndex.insert(icaoRec.airportIdent, entries.size());
     entries.append(icaoRec);
   }
 }
@@ -23,6 +23,7 @@
 
 #include <QString>
 #include <QList>
+#include <QHash>
 
 namespace atools {
 namespace io {
@@ -51,11 +52,21 @@ public:
     return entries;
   }
 
+  /* Get entry for airport ident or null if not found. Uses an index built when reading. */
+  const atools::fs::bgl::NamelistEntry *getEntry(const QString& airportIdent) const
+  {
+    int index = identIndex.value(airportIdent, -1);
+    return index != -1 ? &entries.at(index) : nullptr;
+  }
+
 private:
   friend QDebug operator<<(QDebug out, const atools::fs::bgl::Namelist& record);
 
   QList<atools::fs::bgl::NamelistEntry> entries;
 
+  /* Maps airport ident to index in entries. Last entry wins for duplicates. */
+  QHash<QString, int> identIndex;
+
   void readList(QStringList& names, atools::io::BinaryStream *bs, int numRegionNames, int regionListOffset);
 
 };
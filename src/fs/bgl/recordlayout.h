@@ -0,0 +1,127 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_BGL_RECORDLAYOUT_H
+#define ATOOLS_BGL_RECORDLAYOUT_H
+
+#include "io/binarystream.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+namespace atools {
+namespace fs {
+namespace bgl {
+namespace layout {
+
+/*
+ * Compile time descriptor for one little endian field of a fixed size record block.
+ * OFFSET is relative to the start of the block.
+ */
+template<int OFFSET, typename TYPE>
+struct Field
+{
+  typedef TYPE Type;
+  static Q_DECL_CONSTEXPR int BEGIN = OFFSET;
+  static Q_DECL_CONSTEXPR int END = OFFSET + static_cast<int>(sizeof(TYPE));
+};
+
+/* true if all fields follow each other without gaps or overlaps */
+template<typename FIELD>
+Q_DECL_CONSTEXPR bool isContiguous()
+{
+  return true;
+}
+
+template<typename FIELD1, typename FIELD2, typename ... FIELDS>
+Q_DECL_CONSTEXPR bool isContiguous()
+{
+  return FIELD1::END == FIELD2::BEGIN && isContiguous<FIELD2, FIELDS ...>();
+}
+
+/* Decode a little endian value from an unaligned buffer */
+template<typename TYPE>
+inline TYPE decode(const uchar *data)
+{
+  return qFromLittleEndian<TYPE>(data);
+}
+
+template<>
+inline qint8 decode<qint8>(const uchar *data)
+{
+  return static_cast<qint8>(*data);
+}
+
+template<>
+inline quint8 decode<quint8>(const uchar *data)
+{
+  return *data;
+}
+
+template<>
+inline float decode<float>(const uchar *data)
+{
+  quint32 value = qFromLittleEndian<quint32>(data);
+  float result;
+  memcpy(&result, &value, sizeof(result));
+  return result;
+}
+
+/*
+ * Fixed size block of a record read with one call from the stream. Fields are unpacked on access without
+ * stream overhead. LAYOUT has to define SIZE and the fields as Field types.
+ *
+ * Points directly into the file if the stream is memory mapped. Otherwise the block is copied into a buffer.
+ * Throws an Exception like BinaryStream if the file is too short.
+ */
+template<typename LAYOUT>
+class RecordBlock
+{
+public:
+  explicit RecordBlock(atools::io::BinaryStream *bs)
+  {
+    data = bs->readBlock(buffer, LAYOUT::SIZE);
+  }
+
+  RecordBlock(const RecordBlock& other) = delete;
+  RecordBlock& operator=(const RecordBlock& other) = delete;
+
+  template<typename FIELD>
+  typename FIELD::Type get() const
+  {
+    static_assert(FIELD::BEGIN >= 0 && FIELD::END <= LAYOUT::SIZE, "Field outside of record layout");
+    return decode<typename FIELD::Type>(data + FIELD::BEGIN);
+  }
+
+  /* Raw bytes of the block */
+  const uchar *getData() const
+  {
+    return data;
+  }
+
+private:
+  const uchar *data;
+  uchar buffer[LAYOUT::SIZE];
+};
+
+} // namespace layout
+} // namespace bgl
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_BGL_RECORDLAYOUT_H
@@ -110,11 +110,12 @@ QVariant AirportIndex::getRunwayEndId(const QString& airportIcao, const QString&
 
 bool AirportIndex::addAirport(const QString& airportIcao, int airportId)
 {
-  if(icaoToIdMap.contains(IndexName(airportIcao)))
+  IndexName key(airportIcao);
+  if(icaoToIdMap.contains(key))
     return false;
   else
   {
-    icaoToIdMap.insert(IndexName(airportIcao), airportId);
+    icaoToIdMap.insert(key, airportId);
     return true;
   }
 }
@@ -18,6 +18,8 @@
 #ifndef ATOOLS_XPAIRPORTINDEX_H
 #define ATOOLS_XPAIRPORTINDEX_H
 
+#include "util/flathash.h"
+
 #include <QHash>
 #include <QSet>
 #include <QVariant>
@@ -115,10 +117,10 @@ public:
 
 private:
   // Map ICAO id to database airport_id
-  QHash<IndexName, int> icaoToIdMap;
+  atools::util::FlatHash<IndexName, int> icaoToIdMap;
   QHash<QString, int> airportIlsIdMap;
   QSet<QString> skippedIlsSet;
-  QHash<IndexName2, int> icaoRunwayNameToEndId;
+  atools::util::FlatHash<IndexName2, int> icaoRunwayNameToEndId;
 
 };
 
@@ -127,5 +129,6 @@ private:
 } // namespace atools
 
 Q_DECLARE_TYPEINFO(atools::fs::common::IndexName, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(atools::fs::common::IndexName2, Q_PRIMITIVE_TYPE);
 
 #endif // ATOOLS_XPAIRPORTINDEX_H
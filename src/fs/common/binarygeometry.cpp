@@ -18,11 +18,146 @@
 #include "fs/common/binarygeometry.h"
 
 #include <QDataStream>
+#include <QDebug>
+
+#include <cmath>
 
 namespace atools {
 namespace fs {
 namespace common {
 
+/* First four bytes of the packed format in big endian order. Cannot be a point count of the float format. */
+static const quint32 PACKED_MAGIC = 0xffff0002;
+static const quint8 PACKED_FLAG_BOUNDING_RECT = 0x01;
+static const int PACKED_HEADER_SIZE = 5; // Magic and flags
+static const double PACKED_QUANTIZATION = 1.e6;
+
+static inline qint32 quantize(float value)
+{
+  return static_cast<qint32>(std::lround(static_cast<double>(value) * PACKED_QUANTIZATION));
+}
+
+static inline float dequantize(qint32 value)
+{
+  return static_cast<float>(value / PACKED_QUANTIZATION);
+}
+
+static void writeVarint(QByteArray& bytes, quint32 value)
+{
+  while(value >= 0x80)
+  {
+    bytes.append(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  bytes.append(static_cast<char>(value));
+}
+
+/* Zigzag encoding keeps small negative values short */
+static void writeSignedVarint(QByteArray& bytes, qint32 value)
+{
+  writeVarint(bytes, (static_cast<quint32>(value) << 1) ^ static_cast<quint32>(value >> 31));
+}
+
+template<typename LINE>
+static QByteArray writePacked(const LINE& line, const atools::geo::Rect& rect)
+{
+  QByteArray bytes;
+  // Magic, flags, size, rectangle and about three bytes for each coordinate
+  bytes.reserve(PACKED_HEADER_SIZE + 25 + line.size() * 6);
+
+  for(int shift = 24; shift >= 0; shift -= 8)
+    bytes.append(static_cast<char>((PACKED_MAGIC >> shift) & 0xff));
+  bytes.append(static_cast<char>(rect.isValid() ? PACKED_FLAG_BOUNDING_RECT : 0));
+  writeVarint(bytes, static_cast<quint32>(line.size()));
+
+  if(rect.isValid())
+  {
+    writeSignedVarint(bytes, quantize(rect.getWest()));
+    writeSignedVarint(bytes, quantize(rect.getNorth()));
+    writeSignedVarint(bytes, quantize(rect.getEast()));
+    writeSignedVarint(bytes, quantize(rect.getSouth()));
+  }
+
+  qint32 lastLonX = 0, lastLatY = 0;
+  for(const auto& pos : line)
+  {
+    qint32 lonx = quantize(pos.getLonX()), laty = quantize(pos.getLatY());
+    writeSignedVarint(bytes, lonx - lastLonX);
+    writeSignedVarint(bytes, laty - lastLatY);
+    lastLonX = lonx;
+    lastLatY = laty;
+  }
+  return bytes;
+}
+
+/* Decodes the packed format. All read methods return false if data is truncated. */
+class PackedReader
+{
+public:
+  explicit PackedReader(const QByteArray& bytes)
+    : cur(bytes.constData() + PACKED_HEADER_SIZE), end(bytes.constData() + bytes.size()),
+    flags(static_cast<quint8>(bytes.at(PACKED_HEADER_SIZE - 1)))
+  {
+  }
+
+  bool readHeader(quint32& size, atools::geo::Rect& rect)
+  {
+    if(!readVarint(size))
+      return false;
+
+    if(flags & PACKED_FLAG_BOUNDING_RECT)
+    {
+      qint32 west, north, east, south;
+      if(!readSignedVarint(west) || !readSignedVarint(north) || !readSignedVarint(east) || !readSignedVarint(south))
+        return false;
+      rect = atools::geo::Rect(dequantize(west), dequantize(north), dequantize(east), dequantize(south));
+    }
+    else
+      rect = atools::geo::Rect();
+    return true;
+  }
+
+  bool next(float& lonx, float& laty)
+  {
+    qint32 deltaLonX, deltaLatY;
+    if(!readSignedVarint(deltaLonX) || !readSignedVarint(deltaLatY))
+      return false;
+
+    lastLonX += deltaLonX;
+    lastLatY += deltaLatY;
+    lonx = dequantize(lastLonX);
+    laty = dequantize(lastLatY);
+    return true;
+  }
+
+private:
+  bool readVarint(quint32& value)
+  {
+    value = 0;
+    for(int shift = 0; shift < 35 && cur < end; shift += 7)
+    {
+      quint8 byte = static_cast<quint8>(*cur++);
+      value |= static_cast<quint32>(byte & 0x7f) << shift;
+      if(!(byte & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  bool readSignedVarint(qint32& value)
+  {
+    quint32 zigzag;
+    if(!readVarint(zigzag))
+      return false;
+    value = static_cast<qint32>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+    return true;
+  }
+
+  const char *cur, *end;
+  quint8 flags;
+  qint32 lastLonX = 0, lastLatY = 0;
+};
+
 BinaryGeometry::BinaryGeometry(const geo::LineString& value)
   : geometry(value)
 {
@@ -39,9 +174,50 @@ BinaryGeometry::BinaryGeometry()
 
 }
 
+bool BinaryGeometry::isPacked(const QByteArray& bytes)
+{
+  if(bytes.size() < PACKED_HEADER_SIZE)
+    return false;
+
+  const uchar *data = reinterpret_cast<const uchar *>(bytes.constData());
+  quint32 magic = (static_cast<quint32>(data[0]) << 24) | (static_cast<quint32>(data[1]) << 16) |
+                  (static_cast<quint32>(data[2]) << 8) | static_cast<quint32>(data[3]);
+  return magic == PACKED_MAGIC;
+}
+
+bool BinaryGeometry::readBoundingRect(geo::Rect& rect, const QByteArray& bytes)
+{
+  rect = atools::geo::Rect();
+  if(!isPacked(bytes))
+    return false;
+
+  quint32 size;
+  PackedReader reader(bytes);
+  return reader.readHeader(size, rect) && rect.isValid();
+}
+
 void BinaryGeometry::readFromByteArray(const QByteArray& bytes)
 {
   geometry.clear();
+  geometryIndex.clear();
+
+  if(isPacked(bytes))
+  {
+    quint32 size;
+    float lonx, laty;
+    atools::geo::Rect rect;
+    PackedReader reader(bytes);
+    if(reader.readHeader(size, rect))
+    {
+      geometry.reserve(static_cast<int>(size));
+      for(quint32 i = 0; i < size && reader.next(lonx, laty); i++)
+        geometry.append(lonx, laty);
+    }
+
+    if(static_cast<quint32>(geometry.size()) != size)
+      qWarning() << Q_FUNC_INFO << "Truncated geometry";
+    return;
+  }
 
   QDataStream in(bytes);
   in.setVersion(QDataStream::Qt_5_5);
@@ -57,8 +233,18 @@ void BinaryGeometry::readFromByteArray(const QByteArray& bytes)
   }
 }
 
-QByteArray BinaryGeometry::writeToByteArray()
+const geo::LineStringIndex& BinaryGeometry::getGeometryIndex() const
+{
+  if(!geometryIndex.isValidFor(geometry))
+    geometryIndex.build(geometry);
+  return geometryIndex;
+}
+
+QByteArray BinaryGeometry::writeToByteArray(Format format)
 {
+  if(format == FORMAT_PACKED)
+    return writePacked(geometry, geometry.boundingRect());
+
   QByteArray bytes;
   QDataStream out(&bytes, QIODevice::WriteOnly);
   out.setVersion(QDataStream::Qt_5_5);
@@ -70,6 +256,59 @@ QByteArray BinaryGeometry::writeToByteArray()
   return bytes;
 }
 
+void BinaryGeometry::readFromByteArray(geo::CompactLineString& compact, const QByteArray& bytes)
+{
+  compact.clear();
+
+  if(isPacked(bytes))
+  {
+    quint32 size;
+    float lonx, laty;
+    atools::geo::Rect rect;
+    PackedReader reader(bytes);
+    if(reader.readHeader(size, rect))
+    {
+      compact.reserve(static_cast<int>(size));
+      for(quint32 i = 0; i < size && reader.next(lonx, laty); i++)
+        compact.append(atools::geo::CompactPos(lonx, laty));
+    }
+
+    if(static_cast<quint32>(compact.size()) != size)
+      qWarning() << Q_FUNC_INFO << "Truncated geometry";
+    return;
+  }
+
+  QDataStream in(bytes);
+  in.setVersion(QDataStream::Qt_5_5);
+  in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+  quint32 size;
+  float lonx, laty;
+  in >> size;
+  compact.reserve(static_cast<int>(size));
+  for(unsigned int i = 0; i < size; i++)
+  {
+    in >> lonx >> laty;
+    compact.append(atools::geo::CompactPos(lonx, laty));
+  }
+}
+
+QByteArray BinaryGeometry::writeToByteArray(const geo::CompactLineString& compact, Format format)
+{
+  if(format == FORMAT_PACKED)
+    return writePacked(compact, compact.toLineString().boundingRect());
+
+  QByteArray bytes;
+  QDataStream out(&bytes, QIODevice::WriteOnly);
+  out.setVersion(QDataStream::Qt_5_5);
+  out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+  out << static_cast<quint32>(compact.size());
+  for(const atools::geo::CompactPos& pos : compact)
+    out << pos.getLonX() << pos.getLatY();
+  return bytes;
+}
+
 } // namespace common
 } // namespace fs
 } // namespace atools
@@ -19,6 +19,9 @@
 #define ATOOLS_BINARYGEOMETRY_H
 
 #include "geo/linestring.h"
+#include "geo/linestringindex.h"
+#include "geo/compactpos.h"
+#include "geo/rect.h"
 
 class QByteArray;
 
@@ -31,34 +34,66 @@ namespace common {
  *
  * Writes a simple lat/long (not altitude) list in single floating point precision into a byte array which can be used
  * to write and read it into and from a database BLOB.
+ *
+ * The packed format stores coordinates quantized to 1e-6 degree and delta encoded as variable length integers
+ * after a header containing a magic number, flags and the bounding rectangle.
+ * Reading detects the format automatically.
  */
 class BinaryGeometry
 {
 public:
+  enum Format
+  {
+    /* Number of points and single precision floats. Readable by all versions. */
+    FORMAT_FLOAT,
+
+    /* Quantized, delta and varint encoded with bounding rectangle */
+    FORMAT_PACKED
+  };
+
   BinaryGeometry(const atools::geo::LineString& value);
   BinaryGeometry(const QByteArray& bytes);
   BinaryGeometry();
 
   void readFromByteArray(const QByteArray& bytes);
-  QByteArray writeToByteArray();
+  QByteArray writeToByteArray(atools::fs::common::BinaryGeometry::Format format = FORMAT_FLOAT);
+
+  /* Read and write compact geometries using the same binary format without converting to a line string */
+  static void readFromByteArray(atools::geo::CompactLineString& compact, const QByteArray& bytes);
+  static QByteArray writeToByteArray(const atools::geo::CompactLineString& compact,
+                                     atools::fs::common::BinaryGeometry::Format format = FORMAT_FLOAT);
+
+  /* Get the bounding rectangle from the header without decoding the points.
+   * Returns false if bytes are not in packed format. */
+  static bool readBoundingRect(atools::geo::Rect& rect, const QByteArray& bytes);
+
+  /* true if bytes are in packed format */
+  static bool isPacked(const QByteArray& bytes);
 
   const atools::geo::LineString& getGeometry() const
   {
     return geometry;
   }
 
+  /* Segment index for LineString::distanceMeterToLineString. Built on first access and kept until
+   * the geometry changes. */
+  const atools::geo::LineStringIndex& getGeometryIndex() const;
+
   void swapGeometry(atools::geo::LineString& other)
   {
     geometry.swap(other);
+    geometryIndex.clear();
   }
 
   void setGeometry(const atools::geo::LineString& value)
   {
     geometry = value;
+    geometryIndex.clear();
   }
 
 private:
   atools::geo::LineString geometry;
+  mutable atools::geo::LineStringIndex geometryIndex;
 };
 
 } // namespace common
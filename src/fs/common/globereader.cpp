@@ -23,9 +23,14 @@
 #include "geo/linestring.h"
 #include "geo/line.h"
 
+#include <algorithm>
 #include <cmath>
 #include <QDataStream>
 #include <QDir>
+#include <QtEndian>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
 
 using atools::geo::Pos;
 using atools::geo::Line;
@@ -41,11 +46,14 @@ GlobeReader::GlobeReader(const QString& dataDirParam)
   dataFiles.fill(nullptr, NUM_DATAFILES);
   dataStreams.fill(nullptr, NUM_DATAFILES);
   dataFilenames.fill(QString(), NUM_DATAFILES);
+  mappedData.fill(nullptr, NUM_DATAFILES);
+  setCacheSize(DEFAULT_CACHE_SIZE);
 }
 
 GlobeReader::~GlobeReader()
 {
   closeFiles();
+  closePyramid();
 }
 
 bool GlobeReader::isDirValid(const QString& path)
@@ -87,9 +95,46 @@ bool GlobeReader::openFiles()
     else
       qWarning() << "Found invalid file" << fileEntry.filePath();
   }
+
+  if(memoryMapped)
+  {
+    // Map all files now - lookups must not change state
+    for(int i = 0; i < NUM_DATAFILES; i++)
+      mapFile(i);
+  }
   return true;
 }
 
+void GlobeReader::setMemoryMapped(bool value)
+{
+  if(value && sizeof(void *) < 8)
+  {
+    qWarning() << Q_FUNC_INFO << "Memory mapped mode needs a 64 bit system";
+    value = false;
+  }
+
+  if(value != memoryMapped)
+  {
+    closeFiles();
+    memoryMapped = value;
+  }
+}
+
+bool GlobeReader::mapFile(int i)
+{
+  openFile(i);
+  QFile *dataFile = dataFiles[i];
+  if(dataFile != nullptr)
+  {
+    mappedData[i] = dataFile->map(0, dataFile->size());
+    if(mappedData[i] != nullptr)
+      return true;
+
+    qWarning() << Q_FUNC_INFO << "Cannot map file" << dataFile->fileName() << dataFile->errorString();
+  }
+  return false;
+}
+
 void GlobeReader::openFile(int i)
 {
   const QString& name = dataFilenames.at(i);
@@ -114,6 +159,12 @@ void GlobeReader::openFile(int i)
 
 void GlobeReader::closeFile(int i)
 {
+  if(mappedData[i] != nullptr)
+  {
+    dataFiles[i]->unmap(const_cast<uchar *>(mappedData[i]));
+    mappedData[i] = nullptr;
+  }
+
   if(dataStreams[i] != nullptr)
   {
     delete dataStreams[i];
@@ -132,6 +183,14 @@ void GlobeReader::closeFiles()
 {
   for(int i = 0; i < NUM_DATAFILES; i++)
     closeFile(i);
+  blockCache.clear();
+}
+
+void GlobeReader::setCacheSize(qint64 bytes)
+{
+  cacheSize = std::max(bytes, 0LL);
+  blockCache.setMaxCost(static_cast<int>(std::min(cacheSize / 1024LL,
+                                                  static_cast<qint64>(std::numeric_limits<int>::max()))));
 }
 
 float GlobeReader::getElevation(const atools::geo::Pos& pos)
@@ -139,6 +198,16 @@ float GlobeReader::getElevation(const atools::geo::Pos& pos)
   int fileIndex;
   qint64 fileOffset = calcFileOffset(pos.getLonX(), pos.getLatY(), fileIndex);
 
+  if(memoryMapped)
+  {
+    // Files are either mapped or missing - nothing is opened here
+    const uchar *data = mappedData.at(fileIndex);
+    return data != nullptr ? qFromLittleEndian<qint16>(data + fileOffset) : INVALID;
+  }
+
+  if(cacheSize > 0)
+    return getElevationCached(fileIndex, fileOffset);
+
   openFile(fileIndex);
   QFile *dataFile = dataFiles[fileIndex];
 
@@ -155,47 +224,100 @@ float GlobeReader::getElevation(const atools::geo::Pos& pos)
     return INVALID;
 }
 
-void GlobeReader::getElevations(atools::geo::LineString& elevations, const atools::geo::LineString& linestring)
+float GlobeReader::getElevationCached(int fileIndex, qint64 fileOffset)
 {
-  QList<Pos> positions;
+  qint64 sample = fileOffset / 2;
+  int row = static_cast<int>(sample / TILE_COLUMNS), col = static_cast<int>(sample % TILE_COLUMNS);
+  int blockRow = row / BLOCK_SIZE, blockCol = col / BLOCK_SIZE;
+
+  quint64 key = (static_cast<quint64>(fileIndex) << 32) | (static_cast<quint64>(blockRow) << 16) |
+                static_cast<quint64>(blockCol);
+
+  Block *block = blockCache.object(key);
+  if(block == nullptr)
+  {
+    block = readBlock(fileIndex, blockRow, blockCol);
+    if(block == nullptr)
+      return INVALID;
+
+    // Cache takes ownership and might delete the block if it does not fit
+    int cost = std::max(block->samples.size() * static_cast<int>(sizeof(qint16)) / 1024, 1);
+    qint16 sampleValue = block->samples.at((row % BLOCK_SIZE) * block->columns + col % BLOCK_SIZE);
+    blockCache.insert(key, block, cost);
+    return sampleValue;
+  }
+  return block->samples.at((row % BLOCK_SIZE) * block->columns + col % BLOCK_SIZE);
+}
 
+GlobeReader::Block *GlobeReader::readBlock(int fileIndex, int blockRow, int blockCol)
+{
+  openFile(fileIndex);
+  QFile *dataFile = dataFiles[fileIndex];
+  if(dataFile == nullptr)
+    return nullptr;
+
+  // Clip block at file borders
+  int fileRows = static_cast<int>(dataFile->size() / 2 / TILE_COLUMNS);
+  int firstRow = blockRow * BLOCK_SIZE, firstCol = blockCol * BLOCK_SIZE;
+  int rows = std::min(BLOCK_SIZE, fileRows - firstRow), columns = std::min(BLOCK_SIZE, TILE_COLUMNS - firstCol);
+  if(rows <= 0 || columns <= 0)
+    return nullptr;
+
+  Block *block = new Block;
+  block->columns = columns;
+  block->samples.resize(rows * columns);
+
+  // Read one block line per row and convert from little endian
+  QByteArray buffer(columns * 2, '\0');
+  for(int row = 0; row < rows; row++)
+  {
+    dataFile->seek((static_cast<qint64>(firstRow + row) * TILE_COLUMNS + firstCol) * 2);
+    if(dataFile->read(buffer.data(), buffer.size()) != buffer.size())
+    {
+      qWarning() << Q_FUNC_INFO << "Error reading" << dataFile->fileName() << dataFile->errorString();
+      delete block;
+      return nullptr;
+    }
+
+    const uchar *bytes = reinterpret_cast<const uchar *>(buffer.constData());
+    qint16 *dest = block->samples.data() + row * columns;
+    for(int col = 0; col < columns; col++)
+      dest[col] = qFromLittleEndian<qint16>(bytes + col * 2);
+  }
+  return block;
+}
+
+void GlobeReader::getElevations(atools::geo::LineString& elevations, const atools::geo::LineString& linestring)
+{
   if(linestring.size() < 2)
     return;
 
+  // Collect sample points of all long segments first to read them in one pass
+  LineString positions;
+  QVector<std::pair<int, int> > segmentRanges;
   for(int i = 0; i < linestring.size() - 1; i++)
   {
     Line line = Line(linestring.at(i), linestring.at(i + 1));
-
     float length = line.lengthMeter();
 
+    int first = positions.size();
     if(length > MIN_LENGTH_FOR_INTERPOLATION)
-    {
       line.interpolatePoints(length, static_cast<int>(length / INTERPOLATION_SEGMENT_LENGTH), positions);
+    segmentRanges.append(std::make_pair(first, positions.size()));
+  }
+
+  QVector<float> values;
+  getElevationValues(values, positions);
+
+  for(int i = 0; i < linestring.size() - 1; i++)
+  {
+    Line line = Line(linestring.at(i), linestring.at(i + 1));
 
+    if(line.lengthMeter() > MIN_LENGTH_FOR_INTERPOLATION)
+    {
       Pos lastDropped;
-      for(const Pos& pos : positions)
-      {
-        float elevation = getElevation(pos);
-
-        if(!elevations.isEmpty())
-        {
-          if(atools::almostEqual(elevations.last().getAltitude(), elevation, SAME_ELEVATION_EPSILON))
-          {
-            // Drop points with similar altitude
-            lastDropped = pos;
-            lastDropped.setAltitude(elevation);
-            continue;
-          }
-          else if(lastDropped.isValid())
-          {
-            // Add last point of a stretch with similar altitude
-            elevations.append(lastDropped);
-            lastDropped = Pos();
-          }
-        }
-
-        elevations.append(pos.alt(elevation));
-      }
+      for(int j = segmentRanges.at(i).first; j < segmentRanges.at(i).second; j++)
+        appendElevation(elevations, positions.at(j), values.at(j), lastDropped);
     }
     else if(!elevations.isEmpty())
       elevations.append(line.getPos1().alt(getElevation(elevations.last())));
@@ -207,6 +329,389 @@ void GlobeReader::getElevations(atools::geo::LineString& elevations, const atool
     elevations.last().setAltitude(getElevation(elevations.last()));
 }
 
+void GlobeReader::appendElevation(LineString& elevations, const Pos& pos, float elevation, Pos& lastDropped)
+{
+  if(!elevations.isEmpty())
+  {
+    if(atools::almostEqual(elevations.last().getAltitude(), elevation, SAME_ELEVATION_EPSILON))
+    {
+      // Drop points with similar altitude
+      lastDropped = pos;
+      lastDropped.setAltitude(elevation);
+      return;
+    }
+    else if(lastDropped.isValid())
+    {
+      // Add last point of a stretch with similar altitude
+      elevations.append(lastDropped);
+      lastDropped = Pos();
+    }
+  }
+
+  elevations.append(pos.alt(elevation));
+}
+
+void GlobeReader::getMaxElevations(LineString& elevations, const LineString& linestring, float resolutionMeter)
+{
+  // Find coarsest level which is fine enough
+  const PyramidLevel *level = nullptr;
+  for(const PyramidLevel& lvl : pyramidLevels)
+  {
+    if(lvl.factor * SAMPLE_SIZE_METER <= resolutionMeter)
+      level = &lvl;
+  }
+
+  if(pyramidData == nullptr || level == nullptr)
+  {
+    getElevations(elevations, linestring);
+    return;
+  }
+
+  if(linestring.size() < 2)
+    return;
+
+  // Sample at half cell size to catch all cells along the line
+  float sampleDistance = level->factor * SAMPLE_SIZE_METER / 2.f;
+  LineString positions;
+  for(int i = 0; i < linestring.size() - 1; i++)
+  {
+    Line line = Line(linestring.at(i), linestring.at(i + 1));
+    float length = line.lengthMeter();
+
+    positions.clear();
+    line.interpolatePoints(length, std::max(static_cast<int>(length / sampleDistance), 1), positions);
+    if(positions.isEmpty())
+      positions.append(line.getPos1());
+
+    Pos lastDropped;
+    for(const Pos& pos : positions)
+      appendElevation(elevations, pos, getPyramidElevation(pos, *level), lastDropped);
+  }
+
+  elevations.append(linestring.last());
+  elevations.last().setAltitude(getPyramidElevation(elevations.last(), *level));
+}
+
+bool GlobeReader::readGridRow(int gridRow, QVector<qint16>& row)
+{
+  row.resize(GRID_COLUMNS);
+  QByteArray buffer(TILE_COLUMNS * 2, '\0');
+
+  for(int fileCol = 0; fileCol < 4; fileCol++)
+  {
+    int fileIndex;
+    qint64 fileOffset = calcFileOffset(fileCol * TILE_COLUMNS, gridRow, fileIndex);
+    qint16 *dest = row.data() + fileCol * TILE_COLUMNS;
+
+    openFile(fileIndex);
+    QFile *dataFile = dataFiles[fileIndex];
+    if(dataFile == nullptr)
+    {
+      std::fill(dest, dest + TILE_COLUMNS, static_cast<qint16>(PYRAMID_NO_DATA));
+      continue;
+    }
+
+    if(!dataFile->seek(fileOffset) || dataFile->read(buffer.data(), buffer.size()) != buffer.size())
+    {
+      qWarning() << Q_FUNC_INFO << "Error reading" << dataFile->fileName() << dataFile->errorString();
+      return false;
+    }
+
+    const uchar *bytes = reinterpret_cast<const uchar *>(buffer.constData());
+    for(int col = 0; col < TILE_COLUMNS; col++)
+      dest[col] = qFromLittleEndian<qint16>(bytes + col * 2);
+  }
+  return true;
+}
+
+bool GlobeReader::createPyramid(const QString& filename)
+{
+  const int LEVEL_FACTOR = 4, NUM_LEVELS = 3;
+
+  // First level is built from the full grid row by row
+  QVector<QVector<qint16> > levelData;
+  QVector<PyramidLevel> levels;
+  int columns = (GRID_COLUMNS + LEVEL_FACTOR - 1) / LEVEL_FACTOR, rows = (GRID_ROWS + LEVEL_FACTOR - 1) / LEVEL_FACTOR;
+  levels.append({LEVEL_FACTOR, columns, rows, 0});
+  levelData.append(QVector<qint16>(columns * rows, static_cast<qint16>(PYRAMID_NO_DATA)));
+
+  QVector<qint16> row;
+  for(int gridRow = 0; gridRow < GRID_ROWS; gridRow++)
+  {
+    if(!readGridRow(gridRow, row))
+      return false;
+
+    qint16 *dest = levelData.first().data() + (gridRow / LEVEL_FACTOR) * columns;
+    for(int col = 0; col < GRID_COLUMNS; col++)
+      dest[col / LEVEL_FACTOR] = std::max(dest[col / LEVEL_FACTOR], row.at(col));
+  }
+
+  // Build coarser levels from the previous one
+  for(int i = 1; i < NUM_LEVELS; i++)
+  {
+    const PyramidLevel& prev = levels.at(i - 1);
+    const QVector<qint16>& prevData = levelData.at(i - 1);
+    columns = (prev.columns + LEVEL_FACTOR - 1) / LEVEL_FACTOR;
+    rows = (prev.rows + LEVEL_FACTOR - 1) / LEVEL_FACTOR;
+
+    QVector<qint16> data(columns * rows, static_cast<qint16>(PYRAMID_NO_DATA));
+    for(int r = 0; r < prev.rows; r++)
+    {
+      qint16 *dest = data.data() + (r / LEVEL_FACTOR) * columns;
+      const qint16 *src = prevData.constData() + r * prev.columns;
+      for(int c = 0; c < prev.columns; c++)
+        dest[c / LEVEL_FACTOR] = std::max(dest[c / LEVEL_FACTOR], src[c]);
+    }
+    levels.append({prev.factor * LEVEL_FACTOR, columns, rows, 0});
+    levelData.append(data);
+  }
+
+  // Header: magic number, version, number of levels and factor, columns, rows for each level
+  qint64 offset = 12 + levels.size() * 12;
+  for(PyramidLevel& level : levels)
+  {
+    level.offset = offset;
+    offset += static_cast<qint64>(level.columns) * level.rows * 2;
+  }
+
+  QFile file(filename);
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+    return false;
+  }
+
+  QByteArray header(static_cast<int>(levels.first().offset), '\0');
+  uchar *headerPtr = reinterpret_cast<uchar *>(header.data());
+  qToLittleEndian<quint32>(PYRAMID_MAGIC_NUMBER, headerPtr);
+  qToLittleEndian<quint32>(PYRAMID_VERSION, headerPtr + 4);
+  qToLittleEndian<quint32>(static_cast<quint32>(levels.size()), headerPtr + 8);
+  for(int i = 0; i < levels.size(); i++)
+  {
+    qToLittleEndian<quint32>(static_cast<quint32>(levels.at(i).factor), headerPtr + 12 + i * 12);
+    qToLittleEndian<quint32>(static_cast<quint32>(levels.at(i).columns), headerPtr + 16 + i * 12);
+    qToLittleEndian<quint32>(static_cast<quint32>(levels.at(i).rows), headerPtr + 20 + i * 12);
+  }
+  bool ok = file.write(header) == header.size();
+
+  for(int i = 0; i < levelData.size() && ok; i++)
+  {
+    const QVector<qint16>& data = levelData.at(i);
+    QByteArray bytes(data.size() * 2, '\0');
+    uchar *bytePtr = reinterpret_cast<uchar *>(bytes.data());
+    for(int j = 0; j < data.size(); j++)
+      qToLittleEndian<qint16>(data.at(j), bytePtr + j * 2);
+    ok = file.write(bytes) == bytes.size();
+  }
+
+  if(!ok)
+    qWarning() << Q_FUNC_INFO << "Cannot write" << filename << file.errorString();
+  file.close();
+  return ok;
+}
+
+bool GlobeReader::openPyramid(const QString& filename)
+{
+  closePyramid();
+
+  pyramidFile = new QFile(filename);
+  if(!pyramidFile->open(QIODevice::ReadOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << pyramidFile->errorString();
+    closePyramid();
+    return false;
+  }
+
+  qint64 size = pyramidFile->size();
+  const uchar *data = size >= 12 ? pyramidFile->map(0, size) : nullptr;
+  if(data != nullptr && qFromLittleEndian<quint32>(data) == PYRAMID_MAGIC_NUMBER &&
+     qFromLittleEndian<quint32>(data + 4) == PYRAMID_VERSION)
+  {
+    int numLevels = static_cast<int>(qFromLittleEndian<quint32>(data + 8));
+    qint64 offset = 12 + numLevels * 12;
+    if(numLevels > 0 && offset <= size)
+    {
+      for(int i = 0; i < numLevels; i++)
+      {
+        PyramidLevel level;
+        level.factor = static_cast<int>(qFromLittleEndian<quint32>(data + 12 + i * 12));
+        level.columns = static_cast<int>(qFromLittleEndian<quint32>(data + 16 + i * 12));
+        level.rows = static_cast<int>(qFromLittleEndian<quint32>(data + 20 + i * 12));
+        level.offset = offset;
+        offset += static_cast<qint64>(level.columns) * level.rows * 2;
+        pyramidLevels.append(level);
+      }
+
+      if(offset == size)
+      {
+        pyramidData = data;
+        qDebug() << Q_FUNC_INFO << "Mapped" << filename << "with" << numLevels << "levels";
+        return true;
+      }
+    }
+  }
+
+  qWarning() << Q_FUNC_INFO << "Invalid pyramid file" << filename;
+  if(data != nullptr)
+    pyramidFile->unmap(const_cast<uchar *>(data));
+  closePyramid();
+  return false;
+}
+
+void GlobeReader::closePyramid()
+{
+  if(pyramidFile != nullptr)
+  {
+    if(pyramidData != nullptr)
+      pyramidFile->unmap(const_cast<uchar *>(pyramidData));
+    delete pyramidFile;
+  }
+  pyramidFile = nullptr;
+  pyramidData = nullptr;
+  pyramidLevels.clear();
+}
+
+float GlobeReader::getPyramidElevation(const Pos& pos, const PyramidLevel& level) const
+{
+  int gridCol, gridRow;
+  calcGridPos(pos.getLonX(), pos.getLatY(), gridCol, gridRow);
+
+  int col = std::min(gridCol / level.factor, level.columns - 1), row = std::min(gridRow / level.factor, level.rows - 1);
+  qint16 value = qFromLittleEndian<qint16>(pyramidData + level.offset + (static_cast<qint64>(row) * level.columns + col) * 2);
+  return value == PYRAMID_NO_DATA ? INVALID : value;
+}
+
+void GlobeReader::calcGridPos(double lonx, double laty, int& gridCol, int& gridRow)
+{
+  gridCol = static_cast<int>(GRID_COLUMNS * (lonx + 180.) / 360.);
+  gridRow = static_cast<int>(GRID_ROWS * (180. - (laty + 90.)) / 180.);
+
+  // Normalize / rollover values
+  while(gridCol >= GRID_COLUMNS)
+    gridCol -= GRID_COLUMNS;
+  while(gridCol < 0)
+    gridCol += GRID_COLUMNS;
+
+  while(gridRow >= GRID_ROWS)
+    gridRow -= GRID_ROWS;
+  while(gridRow < 0)
+    gridRow += GRID_ROWS;
+}
+
+/* Sample position in file and index in result */
+struct GlobeSample
+{
+  qint64 offset;
+  int index;
+
+  bool operator<(const GlobeSample& other) const
+  {
+    return offset < other.offset;
+  }
+
+};
+
+/* Reads sorted samples from one file with an own file handle. Adjacent samples are merged into one read. */
+class GlobeFileTask :
+  public QRunnable
+{
+public:
+  GlobeFileTask(const QString& filenameParam, const QVector<GlobeSample> *samplesParam, float *valuesParam)
+    : filename(filenameParam), samples(samplesParam), values(valuesParam)
+  {
+    setAutoDelete(true);
+  }
+
+  virtual void run() override
+  {
+    QFile file(filename);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot open file" << filename << file.errorString();
+      for(const GlobeSample& sample : *samples)
+        values[sample.index] = INVALID;
+      return;
+    }
+
+    QByteArray buffer;
+    int begin = 0;
+    while(begin < samples->size())
+    {
+      // Extend the range as long as the samples are close enough
+      qint64 firstOffset = samples->at(begin).offset;
+      int end = begin + 1;
+      while(end < samples->size() &&
+            samples->at(end).offset - samples->at(end - 1).offset <= GlobeReader::MAX_READ_GAP_BYTES &&
+            samples->at(end).offset + 2 - firstOffset <= GlobeReader::MAX_READ_BYTES)
+        end++;
+
+      qint64 size = samples->at(end - 1).offset + 2 - firstOffset;
+      buffer.resize(static_cast<int>(size));
+      bool ok = file.seek(firstOffset) && file.read(buffer.data(), size) == size;
+      if(!ok)
+        qWarning() << Q_FUNC_INFO << "Error reading" << filename << file.errorString();
+
+      const uchar *bytes = reinterpret_cast<const uchar *>(buffer.constData());
+      for(int i = begin; i < end; i++)
+      {
+        const GlobeSample& sample = samples->at(i);
+        values[sample.index] = ok ? qFromLittleEndian<qint16>(bytes + (sample.offset - firstOffset)) : INVALID;
+      }
+      begin = end;
+    }
+  }
+
+private:
+  QString filename;
+  const QVector<GlobeSample> *samples;
+  float *values;
+};
+
+void GlobeReader::getElevationValues(QVector<float>& values, const atools::geo::LineString& positions)
+{
+  values.fill(INVALID, positions.size());
+
+  if(memoryMapped)
+  {
+    // Only memory access - no need to sort
+    for(int i = 0; i < positions.size(); i++)
+      values[i] = getElevation(positions.at(i));
+    return;
+  }
+
+  // Group samples by file and sort by offset
+  QVector<QVector<GlobeSample> > fileSamples(NUM_DATAFILES);
+  for(int i = 0; i < positions.size(); i++)
+  {
+    int fileIndex;
+    qint64 fileOffset = calcFileOffset(positions.at(i).getLonX(), positions.at(i).getLatY(), fileIndex);
+    fileSamples[fileIndex].append({fileOffset, i});
+  }
+
+  QVector<int> fileIndexes;
+  for(int i = 0; i < NUM_DATAFILES; i++)
+  {
+    if(!fileSamples.at(i).isEmpty() && !dataFilenames.at(i).isEmpty())
+    {
+      std::sort(fileSamples[i].begin(), fileSamples[i].end());
+      fileIndexes.append(i);
+    }
+  }
+
+  float *valuePtr = values.data();
+  if(fileIndexes.size() == 1)
+    // Avoid thread overhead for a single file
+    GlobeFileTask(dataFilenames.at(fileIndexes.first()), &fileSamples.at(fileIndexes.first()), valuePtr).run();
+  else if(fileIndexes.size() > 1)
+  {
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(std::min(fileIndexes.size(), QThread::idealThreadCount()));
+    for(int fileIndex : fileIndexes)
+      threadPool.start(new GlobeFileTask(dataFilenames.at(fileIndex), &fileSamples.at(fileIndex), valuePtr));
+    threadPool.waitForDone();
+  }
+}
+
 qint64 GlobeReader::calcFileOffset(const atools::geo::Pos& pos, int& fileIndex)
 {
   return calcFileOffset(pos.getLonX(), pos.getLatY(), fileIndex);
@@ -18,6 +18,7 @@
 #ifndef ATOOLS_DTM_GLOBEREADER_H
 #define ATOOLS_DTM_GLOBEREADER_H
 
+#include <QCache>
 #include <QFile>
 #include <QVector>
 
@@ -33,6 +34,8 @@ class LineString;
 namespace fs {
 namespace common {
 
+class GlobeFileTask;
+
 static Q_DECL_CONSTEXPR float INVALID = std::numeric_limits<float>::max();
 static Q_DECL_CONSTEXPR float OCEAN = -500.f;
 
@@ -48,19 +51,64 @@ public:
   /* Valid if at least one file with matching name and size was found. */
   static bool isDirValid(const QString& path);
 
-  /* Collect file names (up to 16). Files are opened on demand */
+  /* Collect file names (up to 16). Files are opened on demand or all mapped into memory if memory mapped mode is on */
   bool openFiles();
   void closeFiles();
 
+  /* Map all files into memory on openFiles() instead of reading them. Lookups are then only a pointer
+   * calculation and do not change the state of this object which allows concurrent calls of getElevation().
+   * Needs about 1.8 GB address space and is ignored on 32 bit systems. Call before openFiles(). */
+  void setMemoryMapped(bool value);
+
+  bool isMemoryMapped() const
+  {
+    return memoryMapped;
+  }
+
   /* Elevation in meter */
   float getElevation(const atools::geo::Pos& pos);
 
+  /* Memory budget for the block cache in bytes. Blocks of BLOCK_SIZE x BLOCK_SIZE samples are read from the files
+   * and the least recently used ones are removed if the budget is exceeded. 0 disables the cache and
+   * reads single samples. Default is DEFAULT_CACHE_SIZE. */
+  void setCacheSize(qint64 bytes);
+
+  qint64 getCacheSize() const
+  {
+    return cacheSize;
+  }
+
   /* Get elevations along a great circle line. Will create a point every 500 meters and delete
    * consecutive ones with same elevation */
   void getElevations(geo::LineString& elevations, const atools::geo::LineString& linestring);
 
+  /* Elevation in meter for each position in the same order. Samples are sorted by file and offset and
+   * close samples are read together. Files are read in parallel using separate file handles. */
+  void getElevationValues(QVector<float>& values, const atools::geo::LineString& positions);
+
+  /* Preprocessing step which writes a pyramid of maximum elevations for cells of 4 x 4, 16 x 16 and 64 x 64
+   * samples to a binary file. Reads all GLOBE files once which takes a while. Returns false on error. */
+  bool createPyramid(const QString& filename);
+
+  /* Map a pyramid file written by createPyramid(). Returns false if the file is missing or invalid. */
+  bool openPyramid(const QString& filename);
+  void closePyramid();
+
+  bool isPyramidValid() const
+  {
+    return pyramidData != nullptr;
+  }
+
+  /* Get maximum elevations along a great circle line for a profile which needs only the given resolution
+   * in meter. Uses the coarsest pyramid level which has cells not larger than the resolution and samples
+   * each segment at half the cell size. Consecutive points with the same elevation are removed.
+   * Falls back to getElevations() if no pyramid is loaded or the resolution needs the full grid. */
+  void getMaxElevations(geo::LineString& elevations, const atools::geo::LineString& linestring,
+                        float resolutionMeter);
+
 private:
   friend class::DtmTest;
+  friend class GlobeFileTask;
 
   /* Source data parameters */
   static Q_DECL_CONSTEXPR int NUM_DATAFILES = 16;
@@ -79,6 +127,53 @@ private:
   /* Points are considered equal if they are equal within this range in meter */
   static Q_DECL_CONSTEXPR float SAME_ELEVATION_EPSILON = 1.f;
 
+  /* Samples closer than this are read with one read call */
+  static Q_DECL_CONSTEXPR qint64 MAX_READ_GAP_BYTES = 4096;
+  /* Maximum size of a merged read */
+  static Q_DECL_CONSTEXPR qint64 MAX_READ_BYTES = 256 * 1024;
+
+  /* Width and height of a cached block in samples */
+  static Q_DECL_CONSTEXPR int BLOCK_SIZE = 256;
+  static Q_DECL_CONSTEXPR qint64 DEFAULT_CACHE_SIZE = 64LL * 1024LL * 1024LL;
+
+  /* Block of samples read from a file. May be smaller than BLOCK_SIZE at the file borders. */
+  struct Block
+  {
+    QVector<qint16> samples;
+    int columns;
+  };
+
+  /* Read sample from cached block or load block from file */
+  float getElevationCached(int fileIndex, qint64 fileOffset);
+  Block *readBlock(int fileIndex, int blockRow, int blockCol);
+
+  /* Downsampled level in the pyramid file */
+  struct PyramidLevel
+  {
+    int factor, columns, rows;
+    qint64 offset; /* Byte offset of first value in file */
+  };
+
+  /* Size of a full resolution sample of 30 arc seconds at the equator in meter */
+  static Q_DECL_CONSTEXPR float SAMPLE_SIZE_METER = 926.f;
+  /* Value in pyramid for cells which have no data file */
+  static Q_DECL_CONSTEXPR qint16 PYRAMID_NO_DATA = std::numeric_limits<qint16>::min();
+  static Q_DECL_CONSTEXPR quint32 PYRAMID_MAGIC_NUMBER = 0x47504D58;
+  static Q_DECL_CONSTEXPR quint32 PYRAMID_VERSION = 1;
+
+  /* Read a full row of the global grid from all four files. Missing files give PYRAMID_NO_DATA. */
+  bool readGridRow(int gridRow, QVector<qint16>& row);
+
+  /* Max elevation of the cell at position for a pyramid level */
+  float getPyramidElevation(const atools::geo::Pos& pos, const PyramidLevel& level) const;
+
+  /* Drop points with a similar elevation as the last one. Adds the last dropped point of a stretch. */
+  static void appendElevation(geo::LineString& elevations, const atools::geo::Pos& pos, float elevation,
+                              atools::geo::Pos& lastDropped);
+
+  /* Column and row in global grid normalized to valid ranges */
+  static void calcGridPos(double lonx, double laty, int& gridCol, int& gridRow);
+
   /* Calculate file index and byte offset within file */
   qint64 calcFileOffset(int gridCol, int gridRow, int& fileIndex);
   qint64 calcFileOffset(const atools::geo::Pos& pos, int& fileIndex);
@@ -87,10 +182,26 @@ private:
   void closeFile(int i);
   void openFile(int i);
 
+  /* Open and map file. Returns false on error. */
+  bool mapFile(int i);
+
   QString dataDir;
   QVector<QString> dataFilenames;
   QVector<QFile *> dataFiles;
   QVector<QDataStream *> dataStreams;
+
+  /* Mapped file contents in memory mapped mode */
+  QVector<const uchar *> mappedData;
+  bool memoryMapped = false;
+
+  /* Mapped pyramid file */
+  QFile *pyramidFile = nullptr;
+  const uchar *pyramidData = nullptr;
+  QVector<PyramidLevel> pyramidLevels;
+
+  /* Key is file index, block row and block column. Cost is in kB. */
+  QCache<quint64, Block> blockCache;
+  qint64 cacheSize = DEFAULT_CACHE_SIZE;
 };
 
 } // namespace common
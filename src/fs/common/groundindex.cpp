@@ -0,0 +1,380 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/common/groundindex.h"
+
+#include "fs/sc/simconnectuseraircraft.h"
+#include "geo/calculations.h"
+#include "geo/rect.h"
+#include "geo/simplespatialindex.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QHash>
+
+#include <algorithm>
+#include <cmath>
+
+namespace atools {
+namespace fs {
+namespace common {
+
+using atools::geo::Pos;
+using atools::sql::SqlQuery;
+
+/* Meter per degree latitude for the local flat coordinates */
+static const float METER_PER_DEGREE = atools::geo::nmToMeter(60.f);
+
+/* Grid cell size for taxi paths in meter */
+static const float CELL_METER = 50.f;
+
+/* Extra distance in meter allowed beyond the runway width */
+static const float RUNWAY_MARGIN_METER = 5.f;
+
+/* Distance to the segment and position along the segment from the first point in local coordinates */
+static float segmentDistance(float x, float y, float x1, float y1, float x2, float y2, float *along = nullptr)
+{
+  float dx = x2 - x1, dy = y2 - y1;
+  float lengthSq = dx * dx + dy * dy;
+  float t = lengthSq > 0.f ? ((x - x1) * dx + (y - y1) * dy) / lengthSq : 0.f;
+
+  if(along != nullptr)
+    *along = t * std::sqrt(lengthSq);
+
+  t = std::min(std::max(t, 0.f), 1.f);
+  float px = x1 + t * dx - x, py = y1 + t * dy - y;
+  return std::sqrt(px * px + py * py);
+}
+
+static quint64 cellKey(int cellX, int cellY)
+{
+  return (static_cast<quint64>(static_cast<quint32>(cellX)) << 32) | static_cast<quint32>(cellY);
+}
+
+struct GroundIndex::Airport
+{
+  struct Runway
+  {
+    int endIds[2];
+    QString names[2];
+    float headings[2];
+    float x1, y1, x2, y2, length, halfWidth;
+  };
+
+  struct Parking
+  {
+    int id, number;
+    QString name;
+    float radiusMeter;
+    Pos pos;
+  };
+
+  struct TaxiPath
+  {
+    int id;
+    QString name;
+    float x1, y1, x2, y2, halfWidth;
+  };
+
+  /* Convert to flat coordinates in meter relative to the airport center */
+  void toLocal(const Pos& pos, float& x, float& y) const
+  {
+    float lonDiff = pos.getLonX() - center.getLonX();
+    if(lonDiff > 180.f)
+      lonDiff -= 360.f;
+    else if(lonDiff < -180.f)
+      lonDiff += 360.f;
+
+    x = lonDiff * METER_PER_DEGREE * lonScale;
+    y = (pos.getLatY() - center.getLatY()) * METER_PER_DEGREE;
+  }
+
+  int id;
+  Pos center;
+  float lonScale;
+
+  QVector<Runway> runways;
+  atools::geo::SimpleSpatialIndex<int, Parking> parking;
+  QVector<TaxiPath> taxiPaths;
+
+  /* Maps grid cell to indexes in taxiPaths */
+  QHash<quint64, QVector<int> > taxiGrid;
+};
+
+GroundIndex::GroundIndex(atools::sql::SqlDatabase *sqlDb, float loadRadiusNm, int cacheSize)
+  : db(sqlDb), loadRadiusMeter(atools::geo::nmToMeter(loadRadiusNm)), airports(cacheSize)
+{
+}
+
+GroundIndex::~GroundIndex()
+{
+}
+
+void GroundIndex::clear()
+{
+  nearbyAirports.clear();
+  lastQueryPos = Pos();
+  airports.clear();
+}
+
+void GroundIndex::updatePosition(const Pos& pos)
+{
+  if(!pos.isValid())
+    return;
+
+  // Query again only after moving more than half of the radius
+  if(lastQueryPos.isValid() && lastQueryPos.distanceMeterTo(pos) < loadRadiusMeter / 2.f)
+    return;
+
+  lastQueryPos = pos;
+  nearbyAirports.clear();
+  numRangeQueries++;
+
+  SqlQuery query(db);
+  query.prepare("select airport_id, lonx, laty from airport "
+                "where lonx between :west and :east and laty between :south and :north");
+
+  // Cover the load radius for all positions until the next query
+  atools::geo::Rect rect(pos, loadRadiusMeter * 1.5f);
+  for(const atools::geo::Rect& r : rect.splitAtAntiMeridian())
+  {
+    query.bindValue(":west", r.getWest());
+    query.bindValue(":east", r.getEast());
+    query.bindValue(":south", r.getSouth());
+    query.bindValue(":north", r.getNorth());
+    query.exec();
+    while(query.next())
+      nearbyAirports.append(qMakePair(query.value(0).toInt(),
+                                      Pos(query.value(1).toFloat(), query.value(2).toFloat())));
+  }
+}
+
+QVector<GroundIndex::Airport *> GroundIndex::airportsInRange(const Pos& pos)
+{
+  updatePosition(pos);
+
+  QVector<QPair<int, Pos> > inRange;
+  for(const QPair<int, Pos>& nearby : nearbyAirports)
+  {
+    if(nearby.second.distanceMeterTo(pos) < loadRadiusMeter)
+      inRange.append(nearby);
+  }
+
+  // Avoid that inserting into the cache deletes airports already in the result
+  if(inRange.size() > airports.maxCost())
+    airports.setMaxCost(inRange.size());
+
+  QVector<Airport *> result;
+  for(const QPair<int, Pos>& nearby : inRange)
+    result.append(airport(nearby.first, nearby.second));
+  return result;
+}
+
+GroundIndex::Airport *GroundIndex::airport(int airportId, const Pos& pos)
+{
+  Airport *ap = airports.object(airportId);
+  if(ap == nullptr)
+  {
+    ap = loadAirport(airportId, pos);
+    airports.insert(airportId, ap);
+  }
+  return ap;
+}
+
+GroundIndex::Airport *GroundIndex::loadAirport(int airportId, const Pos& pos)
+{
+  numAirportsLoaded++;
+
+  Airport *ap = new Airport;
+  ap->id = airportId;
+  ap->center = pos;
+  ap->lonScale = std::cos(atools::geo::toRadians(pos.getLatY()));
+
+  SqlQuery query(db);
+  query.prepare("select p.runway_end_id, p.name, p.heading, s.runway_end_id, s.name, s.heading, "
+                "r.primary_lonx, r.primary_laty, r.secondary_lonx, r.secondary_laty, r.width "
+                "from runway r join runway_end p on r.primary_end_id = p.runway_end_id "
+                "join runway_end s on r.secondary_end_id = s.runway_end_id where r.airport_id = :id");
+  query.bindValue(":id", airportId);
+  query.exec();
+  while(query.next())
+  {
+    Airport::Runway runway;
+    runway.endIds[0] = query.value(0).toInt();
+    runway.names[0] = query.value(1).toString();
+    runway.headings[0] = query.value(2).toFloat();
+    runway.endIds[1] = query.value(3).toInt();
+    runway.names[1] = query.value(4).toString();
+    runway.headings[1] = query.value(5).toFloat();
+    ap->toLocal(Pos(query.value(6).toFloat(), query.value(7).toFloat()), runway.x1, runway.y1);
+    ap->toLocal(Pos(query.value(8).toFloat(), query.value(9).toFloat()), runway.x2, runway.y2);
+    runway.length = std::sqrt((runway.x2 - runway.x1) * (runway.x2 - runway.x1) +
+                              (runway.y2 - runway.y1) * (runway.y2 - runway.y1));
+    runway.halfWidth = atools::geo::feetToMeter(query.value(10).toFloat()) / 2.f;
+    ap->runways.append(runway);
+  }
+
+  query.prepare("select parking_id, name, number, radius, lonx, laty from parking where airport_id = :id");
+  query.bindValue(":id", airportId);
+  query.exec();
+  while(query.next())
+  {
+    Airport::Parking parking;
+    parking.id = query.value(0).toInt();
+    parking.name = query.value(1).toString();
+    parking.number = query.value(2).toInt();
+    parking.radiusMeter = atools::geo::feetToMeter(query.value(3).toFloat());
+    parking.pos = Pos(query.value(4).toFloat(), query.value(5).toFloat());
+    ap->parking.insert(parking.id, parking, parking.pos);
+  }
+
+  query.prepare("select taxi_path_id, name, width, start_lonx, start_laty, end_lonx, end_laty "
+                "from taxi_path where airport_id = :id");
+  query.bindValue(":id", airportId);
+  query.exec();
+  while(query.next())
+  {
+    Airport::TaxiPath path;
+    path.id = query.value(0).toInt();
+    path.name = query.value(1).toString();
+    path.halfWidth = atools::geo::feetToMeter(query.value(2).toFloat()) / 2.f;
+    ap->toLocal(Pos(query.value(3).toFloat(), query.value(4).toFloat()), path.x1, path.y1);
+    ap->toLocal(Pos(query.value(5).toFloat(), query.value(6).toFloat()), path.x2, path.y2);
+
+    // Add to all cells covered by the bounding rectangle including width
+    int index = ap->taxiPaths.size();
+    ap->taxiPaths.append(path);
+    int minX = static_cast<int>(std::floor((std::min(path.x1, path.x2) - path.halfWidth) / CELL_METER));
+    int maxX = static_cast<int>(std::floor((std::max(path.x1, path.x2) + path.halfWidth) / CELL_METER));
+    int minY = static_cast<int>(std::floor((std::min(path.y1, path.y2) - path.halfWidth) / CELL_METER));
+    int maxY = static_cast<int>(std::floor((std::max(path.y1, path.y2) + path.halfWidth) / CELL_METER));
+    for(int cx = minX; cx <= maxX; cx++)
+    {
+      for(int cy = minY; cy <= maxY; cy++)
+        ap->taxiGrid[cellKey(cx, cy)].append(index);
+    }
+  }
+  return ap;
+}
+
+bool GroundIndex::findRunway(GroundRunway& result, const Pos& pos, float headingTrue, float headingToleranceDeg)
+{
+  bool found = false;
+  for(const Airport *ap : airportsInRange(pos))
+  {
+    float x, y;
+    ap->toLocal(pos, x, y);
+
+    for(const Airport::Runway& runway : ap->runways)
+    {
+      float along;
+      float cross = segmentDistance(x, y, runway.x1, runway.y1, runway.x2, runway.y2, &along);
+      if(along < 0.f || along > runway.length || cross > runway.halfWidth + RUNWAY_MARGIN_METER)
+        continue;
+
+      if(found && cross >= result.crossTrackMeter)
+        continue;
+
+      // Use the end facing the aircraft heading
+      float diff0 = atools::geo::angleAbsDiff(headingTrue, runway.headings[0]);
+      float diff1 = atools::geo::angleAbsDiff(headingTrue, runway.headings[1]);
+      int end = diff0 <= diff1 ? 0 : 1;
+
+      result.airportId = ap->id;
+      result.runwayEndId = runway.endIds[end];
+      result.name = runway.names[end];
+      result.alongMeter = end == 0 ? along : runway.length - along;
+      result.crossTrackMeter = cross;
+      result.headingDiff = end == 0 ? diff0 : diff1;
+      result.headingMatch = result.headingDiff <= headingToleranceDeg;
+      found = true;
+    }
+  }
+  return found;
+}
+
+bool GroundIndex::findParking(GroundParking& result, const Pos& pos, float maxDistanceMeter)
+{
+  bool found = false;
+  for(Airport *ap : airportsInRange(pos))
+  {
+    QVector<int> nearest = ap->parking.getNearest(pos, 1);
+    if(nearest.isEmpty())
+      continue;
+
+    Airport::Parking parking = ap->parking.value(nearest.first());
+    float distance = parking.pos.distanceMeterTo(pos);
+    if(distance > maxDistanceMeter || (found && distance >= result.distanceMeter))
+      continue;
+
+    result.airportId = ap->id;
+    result.parkingId = parking.id;
+    result.number = parking.number;
+    result.name = parking.name;
+    result.distanceMeter = distance;
+    result.inside = distance <= parking.radiusMeter;
+    found = true;
+  }
+  return found;
+}
+
+bool GroundIndex::findTaxiPath(GroundTaxiPath& result, const Pos& pos)
+{
+  bool found = false;
+  for(const Airport *ap : airportsInRange(pos))
+  {
+    float x, y;
+    ap->toLocal(pos, x, y);
+
+    int cellX = static_cast<int>(std::floor(x / CELL_METER)), cellY = static_cast<int>(std::floor(y / CELL_METER));
+    for(int index : ap->taxiGrid.value(cellKey(cellX, cellY)))
+    {
+      const Airport::TaxiPath& path = ap->taxiPaths.at(index);
+      float cross = segmentDistance(x, y, path.x1, path.y1, path.x2, path.y2);
+      if(cross > path.halfWidth || (found && cross >= result.crossTrackMeter))
+        continue;
+
+      result.airportId = ap->id;
+      result.taxiPathId = path.id;
+      result.name = path.name;
+      result.crossTrackMeter = cross;
+      found = true;
+    }
+  }
+  return found;
+}
+
+bool GroundIndex::findRunway(GroundRunway& result, const sc::SimConnectUserAircraft& aircraft,
+                             float headingToleranceDeg)
+{
+  return findRunway(result, aircraft.getPosition(), aircraft.getHeadingDegTrue(), headingToleranceDeg);
+}
+
+bool GroundIndex::findParking(GroundParking& result, const sc::SimConnectUserAircraft& aircraft,
+                              float maxDistanceMeter)
+{
+  return findParking(result, aircraft.getPosition(), maxDistanceMeter);
+}
+
+bool GroundIndex::findTaxiPath(GroundTaxiPath& result, const sc::SimConnectUserAircraft& aircraft)
+{
+  return findTaxiPath(result, aircraft.getPosition());
+}
+
+} // namespace common
+} // namespace fs
+} // namespace atools
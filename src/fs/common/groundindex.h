@@ -0,0 +1,155 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_COMMON_GROUNDINDEX_H
+#define ATOOLS_FS_COMMON_GROUNDINDEX_H
+
+#include "geo/pos.h"
+
+#include <QCache>
+#include <QPair>
+#include <QVector>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace sc {
+class SimConnectUserAircraft;
+}
+
+namespace common {
+
+/* Runway the aircraft is on */
+struct GroundRunway
+{
+  int airportId = -1, runwayEndId = -1;
+  QString name;
+
+  /* Distance from the threshold of the end along the centerline and distance to the centerline in meter */
+  float alongMeter = 0.f, crossTrackMeter = 0.f;
+
+  /* Difference between aircraft heading and runway end heading in degrees */
+  float headingDiff = 0.f;
+
+  /* Heading difference is within tolerance */
+  bool headingMatch = false;
+};
+
+/* Nearest parking spot */
+struct GroundParking
+{
+  int airportId = -1, parkingId = -1, number = -1;
+  QString name;
+  float distanceMeter = 0.f;
+
+  /* Aircraft is within the radius of the parking */
+  bool inside = false;
+};
+
+/* Taxi path segment under the aircraft */
+struct GroundTaxiPath
+{
+  int airportId = -1, taxiPathId = -1;
+  QString name;
+  float crossTrackMeter = 0.f;
+};
+
+/*
+ * In memory index for runways, parking and taxi paths of the airports around the user aircraft.
+ *
+ * Airports within the load radius are read from the database when the aircraft comes into range and kept in
+ * a small cache. The database is only queried again once the aircraft has moved more than half the load
+ * radius. All other lookups use local flat coordinates per airport and a grid for taxi paths.
+ *
+ * Not thread safe.
+ */
+class GroundIndex
+{
+public:
+  GroundIndex(atools::sql::SqlDatabase *sqlDb, float loadRadiusNm = 5.f, int cacheSize = 10);
+  ~GroundIndex();
+
+  GroundIndex(const GroundIndex& other) = delete;
+  GroundIndex& operator=(const GroundIndex& other) = delete;
+
+  /* Load airports around the position if needed. Called by all lookups below. */
+  void updatePosition(const atools::geo::Pos& pos);
+
+  /* Runway the position is on. Matches the end having the heading nearest to headingTrue.
+   * Returns false if the position is not on a runway. */
+  bool findRunway(atools::fs::common::GroundRunway& result, const atools::geo::Pos& pos, float headingTrue,
+                  float headingToleranceDeg = 30.f);
+
+  /* Nearest parking within maxDistanceMeter. Returns false if none was found. */
+  bool findParking(atools::fs::common::GroundParking& result, const atools::geo::Pos& pos,
+                   float maxDistanceMeter = 100.f);
+
+  /* Taxi path segment having the position within its width. Returns false if none was found. */
+  bool findTaxiPath(atools::fs::common::GroundTaxiPath& result, const atools::geo::Pos& pos);
+
+  /* Convenience methods using position and heading of the aircraft */
+  bool findRunway(atools::fs::common::GroundRunway& result, const atools::fs::sc::SimConnectUserAircraft& aircraft,
+                  float headingToleranceDeg = 30.f);
+  bool findParking(atools::fs::common::GroundParking& result,
+                   const atools::fs::sc::SimConnectUserAircraft& aircraft, float maxDistanceMeter = 100.f);
+  bool findTaxiPath(atools::fs::common::GroundTaxiPath& result,
+                    const atools::fs::sc::SimConnectUserAircraft& aircraft);
+
+  /* Remove all loaded airports, e.g. after switching the database */
+  void clear();
+
+  /* Number of airports loaded from the database so far */
+  int getNumAirportsLoaded() const
+  {
+    return numAirportsLoaded;
+  }
+
+  /* Number of database queries for airports in range */
+  int getNumRangeQueries() const
+  {
+    return numRangeQueries;
+  }
+
+private:
+  struct Airport;
+
+  /* Airport from the cache. Loaded from the database if needed. */
+  Airport *airport(int airportId, const atools::geo::Pos& pos);
+  Airport *loadAirport(int airportId, const atools::geo::Pos& pos);
+
+  /* Loaded airports within the load radius of pos */
+  QVector<Airport *> airportsInRange(const atools::geo::Pos& pos);
+
+  atools::sql::SqlDatabase *db;
+  float loadRadiusMeter;
+
+  /* Ids and positions of airports near the last query position */
+  QVector<QPair<int, atools::geo::Pos> > nearbyAirports;
+  atools::geo::Pos lastQueryPos;
+
+  QCache<int, Airport> airports;
+  int numAirportsLoaded = 0, numRangeQueries = 0;
+};
+
+} // namespace common
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_COMMON_GROUNDINDEX_H
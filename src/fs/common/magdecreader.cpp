@@ -16,15 +16,24 @@
 *****************************************************************************/
 
 #include "fs/common/magdecreader.h"
+#include "fs/db/databasesnapshot.h"
 #include "io/binarystream.h"
 #include "geo/pos.h"
+#include "geo/linestring.h"
 #include "sql/sqldatabase.h"
 #include "sql/sqlutil.h"
 #include "atools.h"
 
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QDebug>
+#include <QHash>
+#include <QMutex>
+#include <QtEndian>
 #include <cmath>
+#include <cstring>
+#include <algorithm>
 
 #include "sql/sqlquery.h"
 
@@ -34,10 +43,30 @@ namespace atools {
 namespace fs {
 namespace common {
 
+/* Decoded grid of a magdec.bgl file */
+struct MagDecCacheEntry
+{
+  QDateTime lastModified;
+  QDate referenceDate;
+  QVector<float> values;
+};
+
+static QHash<QString, MagDecCacheEntry> sharedCache;
+static QMutex sharedCacheMutex;
+static bool sharedCacheEnabled = false;
+
 MagDecReader::MagDecReader()
 {
 }
 
+void MagDecReader::setSharedCacheEnabled(bool enabled)
+{
+  QMutexLocker locker(&sharedCacheMutex);
+  sharedCacheEnabled = enabled;
+  if(!enabled)
+    sharedCache.clear();
+}
+
 MagDecReader::~MagDecReader()
 {
   delete[] magDeclValues;
@@ -49,6 +78,24 @@ void MagDecReader::readFromBgl(const QString& filename)
   magDeclValues = nullptr;
 
   QFile file(filename);
+  QDateTime lastModified = QFileInfo(filename).lastModified();
+
+  {
+    QMutexLocker locker(&sharedCacheMutex);
+    if(sharedCacheEnabled)
+    {
+      auto it = sharedCache.constFind(filename);
+      if(it != sharedCache.constEnd() && it->lastModified == lastModified)
+      {
+        referenceDate = it->referenceDate;
+        numValues = static_cast<quint32>(it->values.size());
+        magDeclValues = new float[numValues];
+        std::copy(it->values.constBegin(), it->values.constEnd(), magDeclValues);
+        buildPaddedGrid();
+        return;
+      }
+    }
+  }
 
   if(file.exists())
   {
@@ -107,7 +154,16 @@ void MagDecReader::readFromBgl(const QString& filename)
         // MV (W01.1°) = 65536 - (65536*1.1/360) = 65336 (0xFF38)
         magDeclValues[i] = static_cast<float>(stream.readShort()) / 65536.f * 360.f;
 
+      buildPaddedGrid();
       file.close();
+
+      QMutexLocker locker(&sharedCacheMutex);
+      if(sharedCacheEnabled)
+      {
+        MagDecCacheEntry entry = {lastModified, referenceDate, QVector<float>(static_cast<int>(numValues))};
+        std::copy(magDeclValues, magDeclValues + numValues, entry.values.begin());
+        sharedCache.insert(filename, entry);
+      }
     }
   }
 }
@@ -126,6 +182,24 @@ void MagDecReader::readFromBytes(const QByteArray& bytes)
 
   for(unsigned int i = 0; i < numValues; i++)
     in >> magDeclValues[i];
+
+  buildPaddedGrid();
+}
+
+void MagDecReader::buildPaddedGrid()
+{
+  paddedGrid.clear();
+  if(numValues != (GRID_COLUMNS - 1) * GRID_ROWS)
+  {
+    qWarning() << Q_FUNC_INFO << "Unexpected number of values" << numValues;
+    return;
+  }
+
+  paddedGrid.resize(GRID_COLUMNS * GRID_ROWS);
+  std::copy(magDeclValues, magDeclValues + numValues, paddedGrid.begin());
+
+  // Repeat first column at the end to avoid the wrap around for interpolation
+  std::copy(magDeclValues, magDeclValues + GRID_ROWS, paddedGrid.begin() + numValues);
 }
 
 void MagDecReader::writeToTable(sql::SqlDatabase& db) const
@@ -146,6 +220,10 @@ void MagDecReader::writeToTable(sql::SqlDatabase& db) const
 
 bool MagDecReader::readFromTable(sql::SqlDatabase& db)
 {
+  atools::fs::db::DatabaseSnapshot snapshot;
+  if(snapshot.attach(db.databaseName()) && readFromSnapshot(snapshot))
+    return true;
+
   if(atools::sql::SqlUtil(db).hasTable("magdecl"))
   {
     atools::sql::SqlQuery query(db);
@@ -170,10 +248,64 @@ bool MagDecReader::readFromTable(sql::SqlDatabase& db)
   return false;
 }
 
+bool MagDecReader::readFromSnapshot(const db::DatabaseSnapshot& snapshot)
+{
+  qint64 size;
+  const uchar *section = snapshot.getSection(atools::fs::db::SNAPSHOT_MAGDECL, size);
+  if(section == nullptr || size < 8)
+    return false;
+
+  quint32 num = qFromLittleEndian<quint32>(section + 4);
+  if(size != 8 + static_cast<qint64>(num) * 4)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid snapshot section size" << size;
+    return false;
+  }
+
+  clear();
+  numValues = num;
+  magDeclValues = new float[numValues];
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+  memcpy(magDeclValues, section + 8, numValues * 4);
+#else
+  for(quint32 i = 0; i < numValues; i++)
+  {
+    quint32 value = qFromLittleEndian<quint32>(section + 8 + i * 4);
+    memcpy(&magDeclValues[i], &value, 4);
+  }
+#endif
+  buildPaddedGrid();
+
+  QDateTime timestamp;
+  timestamp.setTime_t(qFromLittleEndian<quint32>(section));
+  referenceDate = timestamp.date();
+  qInfo() << Q_FUNC_INFO << "Reference date" << referenceDate;
+  return true;
+}
+
+QByteArray MagDecReader::writeToSnapshotBytes() const
+{
+  if(!isValid())
+    throw new Exception("MagDecReader is invalid");
+
+  QByteArray bytes(8 + static_cast<int>(numValues) * 4, '\0');
+  uchar *bytePtr = reinterpret_cast<uchar *>(bytes.data());
+  qToLittleEndian<quint32>(QDateTime(getReferenceDate()).toTime_t(), bytePtr);
+  qToLittleEndian<quint32>(numValues, bytePtr + 4);
+  for(quint32 i = 0; i < numValues; i++)
+  {
+    quint32 value;
+    memcpy(&value, &magDeclValues[i], 4);
+    qToLittleEndian<quint32>(value, bytePtr + 8 + i * 4);
+  }
+  return bytes;
+}
+
 void MagDecReader::clear()
 {
   delete[] magDeclValues;
   magDeclValues = nullptr;
+  paddedGrid.clear();
 }
 
 QByteArray MagDecReader::writeToBytes() const
@@ -240,6 +372,91 @@ float MagDecReader::getMagVar(const geo::Pos& pos) const
   }
 }
 
+void MagDecReader::getMagVar(QVector<float>& magvars, const geo::LineString& positions) const
+{
+  magvars.resize(positions.size());
+  getMagVar(magvars.data(), positions.constData(), positions.size());
+}
+
+void MagDecReader::getMagVar(float *magvars, const geo::Pos *positions, int numPositions) const
+{
+  if(!isValid())
+    throw new Exception("MagDecReader is invalid");
+
+  if(paddedGrid.isEmpty())
+  {
+    // Grid has not the expected layout - use the slow path
+    for(int i = 0; i < numPositions; i++)
+      magvars[i] = positions[i].isValid() ? getMagVar(positions[i]) : 0.f;
+    return;
+  }
+
+  // Process in blocks to keep the temporary arrays in the cache and the loops simple
+  const int BLOCK_SIZE = 256;
+  int bottomLeft[BLOCK_SIZE], bottomRight[BLOCK_SIZE], topLeft[BLOCK_SIZE], topRight[BLOCK_SIZE];
+  float fracX[BLOCK_SIZE], fracY[BLOCK_SIZE];
+  float fQ11[BLOCK_SIZE], fQ21[BLOCK_SIZE], fQ12[BLOCK_SIZE], fQ22[BLOCK_SIZE];
+  const float *grid = paddedGrid.constData();
+
+  for(int blockStart = 0; blockStart < numPositions; blockStart += BLOCK_SIZE)
+  {
+    int num = std::min(BLOCK_SIZE, numPositions - blockStart);
+    const geo::Pos *pos = positions + blockStart;
+
+    // Calculate grid indexes and weights - same cells as used by getMagVar(const Pos&)
+    for(int i = 0; i < num; i++)
+    {
+      float lonX = 0.f, latY = 0.f;
+      if(pos[i].isValid())
+      {
+        Pos posNorm(pos[i].normalized());
+        lonX = posNorm.getLonX();
+        latY = posNorm.getLatY();
+      }
+
+      float minLonX = std::floor(lonX), minLatY = std::floor(latY);
+      int col1 = static_cast<int>(minLonX);
+      if(col1 < 0)
+        col1 += 360;
+      int col2 = col1 + static_cast<int>(std::ceil(lonX) - minLonX);
+      int row1 = static_cast<int>(minLatY) + 90;
+      int row2 = row1 + static_cast<int>(std::ceil(latY) - minLatY);
+
+      bottomLeft[i] = col1 * GRID_ROWS + row1;
+      bottomRight[i] = col2 * GRID_ROWS + row1;
+      topLeft[i] = col1 * GRID_ROWS + row2;
+      topRight[i] = col2 * GRID_ROWS + row2;
+      fracX[i] = lonX - minLonX;
+      fracY[i] = latY - minLatY;
+    }
+
+    // Gather values for the four corners
+    for(int i = 0; i < num; i++)
+    {
+      fQ11[i] = grid[bottomRight[i]];
+      fQ21[i] = grid[bottomLeft[i]];
+      fQ12[i] = grid[topLeft[i]];
+      fQ22[i] = grid[topRight[i]];
+    }
+
+    // Bilinear interpolation using the same weights as getMagVar(const Pos&)
+    float *result = magvars + blockStart;
+    for(int i = 0; i < num; i++)
+    {
+      float fR1 = (1.f - fracX[i]) * fQ11[i] + fracX[i] * fQ21[i];
+      float fR2 = (1.f - fracX[i]) * fQ12[i] + fracX[i] * fQ22[i];
+      result[i] = (1.f - fracY[i]) * fR1 + fracY[i] * fR2;
+    }
+
+    // Invalid positions get zero
+    for(int i = 0; i < num; i++)
+    {
+      if(!pos[i].isValid())
+        result[i] = 0.f;
+    }
+  }
+}
+
 float MagDecReader::magvar(int offset) const
 {
   if(offset >= 0 && offset < static_cast<int>(numValues))
@@ -20,16 +20,22 @@
 
 #include <QByteArray>
 #include <QDate>
+#include <QVector>
 
 namespace atools {
 namespace geo {
 class Pos;
+class LineString;
 }
 namespace sql {
 class SqlDatabase;
 }
 
 namespace fs {
+namespace db {
+class DatabaseSnapshot;
+}
+
 namespace common {
 
 /*
@@ -44,9 +50,22 @@ public:
   /* Read values from magdec.bgl file */
   void readFromBgl(const QString& filename);
 
-  /* Read values from table "magdecl" returns true if successfull and table exists. */
+  /* Keep decoded magdec.bgl grids in a process wide cache by file path and modification time.
+   * Allows several compilations running at the same time to share the grid. Thread safe.
+   * Disabling clears the cache. */
+  static void setSharedCacheEnabled(bool enabled);
+
+  /* Read values from table "magdecl" returns true if successfull and table exists.
+   * Uses the snapshot file next to the database instead if it exists and is valid. */
   bool readFromTable(atools::sql::SqlDatabase& db);
 
+  /* Read values from the magnetic declination section of an attached snapshot. Returns false if not found. */
+  bool readFromSnapshot(const atools::fs::db::DatabaseSnapshot& snapshot);
+
+  /* Section for the snapshot with little endian reference time, number of values and values.
+   * Object has to be valid. */
+  QByteArray writeToSnapshotBytes() const;
+
   /* Writes values to table "magdecl". Object has to be valid */
   void writeToTable(atools::sql::SqlDatabase& db) const;
 
@@ -64,6 +83,12 @@ public:
    */
   float getMagVar(const atools::geo::Pos& pos) const;
 
+  /* Same as above for many positions. Interpolation is done in blocks on the padded grid without range checks
+   * which allows the compiler to vectorize the arithmetic. magvars is resized to the number of positions.
+   * Invalid positions get a value of 0. Throws exception if object is not valid. */
+  void getMagVar(QVector<float>& magvars, const atools::geo::LineString& positions) const;
+  void getMagVar(float *magvars, const atools::geo::Pos *positions, int numPositions) const;
+
   const QDate& getReferenceDate() const
   {
     return referenceDate;
@@ -76,9 +101,17 @@ private:
   int offset(int lonX, int latY) const;
   float magvar(int offset) const;
 
+  /* Fill paddedGrid from magDeclValues */
+  void buildPaddedGrid();
+
   QDate referenceDate;
   quint32 numValues = 0;
   float *magDeclValues = nullptr;
+
+  /* Values by longitude column and latitude row with longitude 0 to 360 where 360 repeats column 0.
+   * Longitudes -179 to -1 are stored as 181 to 359 as in the BGL file. */
+  QVector<float> paddedGrid;
+  const static int GRID_ROWS = 181, GRID_COLUMNS = 361;
 };
 
 } // namespace common
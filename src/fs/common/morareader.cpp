@@ -19,8 +19,12 @@
 #include "sql/sqlquery.h"
 #include "sql/sqlutil.h"
 #include "geo/pos.h"
+#include "geo/linestring.h"
 
 #include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
 
 using atools::sql::SqlQuery;
 using atools::sql::SqlUtil;
@@ -43,7 +47,7 @@ MoraReader::MoraReader(sql::SqlDatabase& sqlDb)
 
 MoraReader::~MoraReader()
 {
-
+  unmap();
 }
 
 bool MoraReader::readFromTable(atools::sql::SqlDatabase& sqlDb)
@@ -62,6 +66,25 @@ bool MoraReader::readFromTable()
     return false;
   }
 
+  // Try the grid file first which avoids loading and decoding the blob
+  SqlQuery sizeQuery(db);
+  sizeQuery.exec("select lonx_columns, laty_rows, version from mora_grid");
+  if(sizeQuery.next() && sizeQuery.valueInt("version") == static_cast<int>(DATA_VERSION))
+  {
+    int columns = sizeQuery.valueInt("lonx_columns"), rows = sizeQuery.valueInt("laty_rows");
+    sizeQuery.finish();
+
+    if(readFromFile(gridFilename(db->databaseName())))
+    {
+      if(lonxColums == columns && latyRows == rows)
+        return true;
+
+      qWarning() << Q_FUNC_INFO << "MORA grid file does not match table";
+      clear();
+    }
+  }
+  sizeQuery.finish();
+
   SqlQuery moraReadQuery(db);
   moraReadQuery.exec("select * from mora_grid");
 
@@ -76,27 +99,22 @@ bool MoraReader::readFromTable()
     latyRows = moraReadQuery.valueInt("laty_rows");
     QByteArray bytes = moraReadQuery.value("geometry").toByteArray();
 
-    // Read data from blob
-    QDataStream in(&bytes, QIODevice::ReadOnly);
-    in.setVersion(QDataStream::Qt_5_5);
-    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
-
-    // Read and check header
-    quint32 magicNumber, dataVersion;
-    in >> magicNumber >> dataVersion;
+    // Read and check header - QDataStream writes big endian
+    if(bytes.size() < 8)
+      throw Exception("Invalid data size in MORA data");
 
-    if(magicNumber != MAGIC_NUMBER_DATA)
+    const uchar *bytePtr = reinterpret_cast<const uchar *>(bytes.constData());
+    if(qFromBigEndian<quint32>(bytePtr) != MAGIC_NUMBER_DATA)
       throw Exception("Invalid magic number in MORA data");
-    if(dataVersion != DATA_VERSION)
+    if(qFromBigEndian<quint32>(bytePtr + 4) != DATA_VERSION)
       throw Exception("Invalid data version in MORA data");
 
-    // Read blob into vector
-    quint16 value;
-    while(!in.atEnd())
-    {
-      in >> value;
-      datagrid.append(value);
-    }
+    // Convert blob into vector in one loop instead of reading values from a stream
+    int numValues = (bytes.size() - 8) / 2;
+    datagrid.resize(numValues);
+    quint16 *dest = datagrid.data();
+    for(int i = 0; i < numValues; i++)
+      dest[i] = qFromBigEndian<quint16>(bytePtr + 8 + i * 2);
 
     // Check size
     if(datagrid.size() != lonxColums * latyRows)
@@ -105,6 +123,7 @@ bool MoraReader::readFromTable()
     qInfo() << Q_FUNC_INFO << db->databaseName() << "MORA data loaded"
             << lonxColums << "x *" << latyRows << "y" << bytes.size() << "bytes";
 
+    data = datagrid.constData();
     dataAvailable = true;
     return true;
   }
@@ -122,6 +141,7 @@ void MoraReader::writeToTable(const QVector<quint16>& grid, int columns, int row
   datagrid = grid;
   lonxColums = columns;
   latyRows = rows;
+  data = datagrid.constData();
   dataAvailable = true;
 
   SqlQuery moraWriteQuery(db);
@@ -149,6 +169,114 @@ void MoraReader::writeToTable(const QVector<quint16>& grid, int columns, int row
   moraWriteQuery.bindValue(":laty_rows", latyRows);
   moraWriteQuery.bindValue(":geometry", bytes);
   moraWriteQuery.exec();
+
+  // Write the mappable file too if the database is a file
+  QString dbName = db->databaseName();
+  if(!dbName.isEmpty() && dbName != ":memory:" && QFileInfo(dbName).isFile())
+    writeToFile(gridFilename(dbName));
+}
+
+QString MoraReader::gridFilename(const QString& databaseName)
+{
+  return databaseName + ".mora";
+}
+
+bool MoraReader::writeToFile(const QString& filename) const
+{
+  if(data == nullptr)
+    throw Exception("MORA data not available");
+
+  QByteArray bytes(FILE_HEADER_SIZE + lonxColums * latyRows * 2, '\0');
+  uchar *bytePtr = reinterpret_cast<uchar *>(bytes.data());
+  qToLittleEndian<quint32>(MAGIC_NUMBER_FILE, bytePtr);
+  qToLittleEndian<quint32>(FILE_VERSION, bytePtr + 4);
+  qToLittleEndian<quint32>(static_cast<quint32>(lonxColums), bytePtr + 8);
+  qToLittleEndian<quint32>(static_cast<quint32>(latyRows), bytePtr + 12);
+
+  for(int i = 0; i < lonxColums * latyRows; i++)
+    qToLittleEndian<quint16>(data[i], bytePtr + FILE_HEADER_SIZE + i * 2);
+
+  QFile file(filename);
+  if(file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    bool ok = file.write(bytes) == bytes.size();
+    file.close();
+    if(ok)
+      return true;
+  }
+  qWarning() << Q_FUNC_INFO << "Cannot write" << filename << file.errorString();
+  return false;
+}
+
+bool MoraReader::readFromFile(const QString& filename)
+{
+  clear();
+
+  if(!QFileInfo(filename).isFile())
+    return false;
+
+  QFile *file = new QFile(filename);
+  if(!file->open(QIODevice::ReadOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file->errorString();
+    delete file;
+    return false;
+  }
+
+  const uchar *bytePtr = nullptr;
+  qint64 size = file->size();
+  if(size >= FILE_HEADER_SIZE)
+  {
+    mappedData = file->map(0, size);
+    bytePtr = mappedData;
+  }
+
+  if(bytePtr != nullptr && qFromLittleEndian<quint32>(bytePtr) == MAGIC_NUMBER_FILE &&
+     qFromLittleEndian<quint32>(bytePtr + 4) == FILE_VERSION)
+  {
+    int columns = static_cast<int>(qFromLittleEndian<quint32>(bytePtr + 8));
+    int rows = static_cast<int>(qFromLittleEndian<quint32>(bytePtr + 12));
+
+    if(size == FILE_HEADER_SIZE + static_cast<qint64>(columns) * rows * 2)
+    {
+      mappedFile = file;
+      lonxColums = columns;
+      latyRows = rows;
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+      // Use mapped values directly
+      data = reinterpret_cast<const quint16 *>(bytePtr + FILE_HEADER_SIZE);
+#else
+      datagrid.resize(columns * rows);
+      for(int i = 0; i < columns * rows; i++)
+        datagrid[i] = qFromLittleEndian<quint16>(bytePtr + FILE_HEADER_SIZE + i * 2);
+      data = datagrid.constData();
+#endif
+
+      dataAvailable = true;
+      qInfo() << Q_FUNC_INFO << filename << "MORA data mapped" << lonxColums << "x *" << latyRows << "y";
+      return true;
+    }
+  }
+
+  qWarning() << Q_FUNC_INFO << "Invalid MORA grid file" << filename;
+  if(mappedData != nullptr)
+    file->unmap(mappedData);
+  mappedData = nullptr;
+  delete file;
+  return false;
+}
+
+void MoraReader::unmap()
+{
+  if(mappedFile != nullptr)
+  {
+    if(mappedData != nullptr)
+      mappedFile->unmap(mappedData);
+    delete mappedFile;
+  }
+  mappedFile = nullptr;
+  mappedData = nullptr;
 }
 
 bool MoraReader::isDataAvailable()
@@ -158,6 +286,8 @@ bool MoraReader::isDataAvailable()
 
 void MoraReader::clear()
 {
+  unmap();
+  data = nullptr;
   datagrid.clear();
   lonxColums = latyRows = 0;
   dataAvailable = false;
@@ -202,7 +332,63 @@ int MoraReader::getMoraFt(int lonx, int laty) const
 
   int pos = (-laty + 90) * 360 + lonx + 180;
 
-  return datagrid.at(pos);
+  if(pos < 0 || pos >= lonxColums * latyRows)
+    throw Exception("MORA grid index out of range");
+
+  return data[pos];
+}
+
+void MoraReader::getMoraFt(QVector<int>& legMora, const geo::LineString& line) const
+{
+  if(!dataAvailable)
+    throw Exception("MORA data not available");
+
+  legMora.clear();
+  if(line.size() < 2)
+    return;
+  legMora.reserve(line.size() - 1);
+
+  // Sample distance well below the cell size of one degree
+  const float SAMPLE_DISTANCE_METER = 10000.f;
+
+  atools::geo::LineString points;
+  for(int i = 0; i < line.size() - 1; i++)
+  {
+    const atools::geo::Pos& from = line.at(i);
+    const atools::geo::Pos& to = line.at(i + 1);
+
+    points.clear();
+    float distanceMeter = from.distanceMeterTo(to);
+    from.interpolatePoints(to, distanceMeter, std::max(static_cast<int>(distanceMeter / SAMPLE_DISTANCE_METER), 1),
+                           points);
+    points.append(to);
+
+    int maxMora = OCEAN;
+    bool known = false, unknown = false;
+    int lastLonx = std::numeric_limits<int>::max(), lastLaty = std::numeric_limits<int>::max();
+    for(const atools::geo::Pos& pos : points)
+    {
+      if(!pos.isValid())
+        continue;
+
+      int lonx = static_cast<int>(pos.getLonX()), laty = static_cast<int>(pos.getLatY());
+      if(lonx == lastLonx && laty == lastLaty)
+        // Still in the same cell
+        continue;
+      lastLonx = lonx;
+      lastLaty = laty;
+
+      int mora = getMoraFt(lonx, laty);
+      if(mora == UNKNOWN)
+        unknown = true;
+      else if(mora != ERROR)
+      {
+        known = true;
+        maxMora = std::max(maxMora, mora);
+      }
+    }
+    legMora.append(!known && unknown ? UNKNOWN : maxMora);
+  }
 }
 
 } // namespace common
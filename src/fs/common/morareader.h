@@ -21,9 +21,12 @@
 #include <QString>
 #include <QVector>
 
+class QFile;
+
 namespace atools {
 namespace geo {
 class Pos;
+class LineString;
 }
 namespace sql {
 class SqlDatabase;
@@ -48,15 +51,26 @@ public:
   MoraReader(atools::sql::SqlDatabase& sqlDb);
   virtual ~MoraReader();
 
-  /* Read values from table "mora_grid". returns true if successfull and table exists. */
+  /* Read values from table "mora_grid". returns true if successfull and table exists.
+   * Maps the grid file next to the database instead of decoding the blob if the file exists and matches. */
   bool readFromTable();
 
   /* Sets database and reads as above */
   bool readFromTable(sql::SqlDatabase& sqlDb);
 
-  /* Writes values to table "mora_grid". Object has to be valid. Copies data to this instance. */
+  /* Writes values to table "mora_grid". Object has to be valid. Copies data to this instance.
+   * Also writes the grid file next to a file based database. */
   void writeToTable(const QVector<quint16>& datagrid, int columns, int rows);
 
+  /* Write grid to a binary file which can be memory mapped by readFromFile(). Returns false on error. */
+  bool writeToFile(const QString& filename) const;
+
+  /* Map grid from a file written by writeToFile(). Returns false if the file is missing or invalid. */
+  bool readFromFile(const QString& filename);
+
+  /* Name of the grid file for a database file */
+  static QString gridFilename(const QString& databaseName);
+
   /* True if table is present in schema and has one row */
   bool isDataAvailable();
 
@@ -66,7 +80,7 @@ public:
   /* true if loaded */
   bool isValid() const
   {
-    return !datagrid.isEmpty();
+    return data != nullptr;
   }
 
   /* Returns minimum off route altitude at position in feet * 100, UNKNOWN, ERROR or OCEAN.
@@ -79,6 +93,12 @@ public:
   int getMoraFt(const atools::geo::Pos& pos) const;
   int getMoraFt(int lonx, int laty) const;
 
+  /* Fills legMora with the maximum MORA for each leg of the line in one pass. legMora has line.size() - 1
+   * entries. The great circle path of each leg is sampled and cells are looked up once.
+   * A leg gets UNKNOWN only if no cell has a known value and OCEAN if all cells are ocean. ERROR cells are ignored.
+   * Throws exception if object is not valid. */
+  void getMoraFt(QVector<int>& legMora, const atools::geo::LineString& line) const;
+
   /* Not surveyed */
   const static quint16 UNKNOWN = std::numeric_limits<quint16>::max();
 
@@ -89,14 +109,27 @@ public:
   const static quint16 OCEAN = 0;
 
 private:
+  /* Unmap file and reset data pointer */
+  void unmap();
+
   atools::sql::SqlDatabase *db;
   bool dataAvailable = false;
   QVector<quint16> datagrid;
   int lonxColums = 0, latyRows = 0;
 
+  /* Points either to datagrid or to the mapped file */
+  const quint16 *data = nullptr;
+  QFile *mappedFile = nullptr;
+  uchar *mappedData = nullptr;
+
   const static quint32 MAGIC_NUMBER_DATA = 0xA5B44CDB;
   const static quint32 DATA_VERSION = 1;
 
+  /* Grid file with header of magic number, version, columns and rows followed by little endian values */
+  const static quint32 MAGIC_NUMBER_FILE = 0xA5B44CDC;
+  const static quint32 FILE_VERSION = 1;
+  const static int FILE_HEADER_SIZE = 16;
+
 };
 
 } // namespace common
@@ -21,13 +21,18 @@
 #include "fs/xp/xpconstants.h"
 #include "fs/progresshandler.h"
 #include "atools.h"
+#include "util/stringpool.h"
 #include "sql/sqlrecord.h"
 
 #include "sql/sqlutil.h"
+#include "sql/sqlbatch.h"
+
+#include <cmath>
 
 #pragma GCC diagnostic ignored "-Wswitch-enum"
 
 using atools::sql::SqlQuery;
+using atools::sql::SqlBatch;
 using atools::sql::SqlUtil;
 using atools::sql::SqlRecord;
 using atools::sql::SqlRecordVector;
@@ -411,15 +416,15 @@ void ProcedureWriter::finishProcedure(const ProcedureInput& line)
       Procedure& appr = approaches.first();
       assignApproachIds(appr);
       assignApproachLegIds(appr.legRecords);
-      insertApproachQuery->bindAndExecRecord(appr.record);
-      insertApproachLegQuery->bindAndExecRecords(appr.legRecords);
+      insertRecord(insertApproachQuery, approachBatch, appr.record);
+      insertRecords(insertApproachLegQuery, approachLegBatch, appr.legRecords);
 
       // Write transitions for one approach
       for(Procedure& trans : transitions)
       {
         assignTransitionIds(trans);
-        insertTransitionQuery->bindAndExecRecord(trans.record);
-        insertTransitionLegQuery->bindAndExecRecords(trans.legRecords);
+        insertRecord(insertTransitionQuery, transitionBatch, trans.record);
+        insertRecords(insertTransitionLegQuery, transitionLegBatch, trans.legRecords);
       }
     }
   }
@@ -495,13 +500,13 @@ void ProcedureWriter::finishProcedure(const ProcedureInput& line)
       {
         assignApproachIds(appr);
         // qDebug() << appr.legRecords;
-        insertApproachQuery->bindAndExecRecord(appr.record);
+        insertRecord(insertApproachQuery, approachBatch, appr.record);
 
         if(starCommon.isValid())
         {
           // Prefix the common route legs to the STAR
           assignApproachLegIds(starCommon.legRecords);
-          insertApproachLegQuery->bindAndExecRecords(starCommon.legRecords);
+          insertRecords(insertApproachLegQuery, approachLegBatch, starCommon.legRecords);
 
           // Remove the IF of the STAR which will be replaced by the TF of the common route
           if(appr.legRecords.first().value(":type") == "IF")
@@ -510,13 +515,13 @@ void ProcedureWriter::finishProcedure(const ProcedureInput& line)
 
         // Write SID or STAR legs
         assignApproachLegIds(appr.legRecords);
-        insertApproachLegQuery->bindAndExecRecords(appr.legRecords);
+        insertRecords(insertApproachLegQuery, approachLegBatch, appr.legRecords);
 
         if(sidCommon.isValid())
         {
           // Append the common route legs to the SID
           assignApproachLegIds(sidCommon.legRecords);
-          insertApproachLegQuery->bindAndExecRecords(sidCommon.legRecords);
+          insertRecords(insertApproachLegQuery, approachLegBatch, sidCommon.legRecords);
         }
 
         // Assign a new set of ids and write a duplicate of all transitions for the current approach
@@ -524,16 +529,60 @@ void ProcedureWriter::finishProcedure(const ProcedureInput& line)
         {
           assignTransitionIds(trans);
           // qDebug() << trans.legRecords;
-          insertTransitionQuery->bindAndExecRecord(trans.record);
-          insertTransitionLegQuery->bindAndExecRecords(trans.legRecords);
+          insertRecord(insertTransitionQuery, transitionBatch, trans.record);
+          insertRecords(insertTransitionLegQuery, transitionLegBatch, trans.legRecords);
         }
       }
     }
   }
 
+  // Write collected rows if a batch is full
+  if(batchMode && approachLegBatch->size() + transitionLegBatch->size() >= BATCH_SIZE)
+    flush();
+
   reset();
 }
 
+void ProcedureWriter::insertRecord(SqlQuery *query, SqlBatch *batch, const SqlRecord& record)
+{
+  if(batch != nullptr)
+    batch->addRecord(record);
+  else
+    query->bindAndExecRecord(record);
+}
+
+void ProcedureWriter::insertRecords(SqlQuery *query, SqlBatch *batch, const SqlRecordVector& records)
+{
+  if(batch != nullptr)
+  {
+    for(const SqlRecord& record : records)
+      batch->addRecord(record);
+  }
+  else
+    query->bindAndExecRecords(records);
+}
+
+void ProcedureWriter::setBatchMode(bool value)
+{
+  // Write pending rows before queries are recreated
+  flush();
+
+  batchMode = value;
+  initQueries();
+}
+
+void ProcedureWriter::flush()
+{
+  if(batchMode)
+  {
+    // Parent tables first
+    approachBatch->exec();
+    approachLegBatch->exec();
+    transitionBatch->exec();
+    transitionLegBatch->exec();
+  }
+}
+
 void ProcedureWriter::writeApproach(const ProcedureInput& line)
 {
   // Ids are assigned later
@@ -1025,7 +1074,15 @@ ProcedureWriter::NavIdInfo ProcedureWriter::navaidType(const QString& context, c
       }
     }
 
-    if(pos.isValid() && !pos.isNull())
+    if(pos.isValid() && !pos.isNull() && batchMode)
+    {
+      NavIdInfo inf = findWaypointCached(name, region, pos);
+      if(inf.type == "WN" || inf.type == "WU")
+        return NavIdInfo("W", inf.region);
+      else if(inf.type == "N" || inf.type == "V")
+        return inf;
+    }
+    else if(pos.isValid() && !pos.isNull())
     {
       // Try an exact and faster coordinate search first
       // For that we need double coordinate values
@@ -1239,6 +1296,66 @@ void ProcedureWriter::apprRunwayNameAndSuffix(const ProcedureInput& line, QStrin
   }
 }
 
+ProcedureWriter::NavIdInfo ProcedureWriter::findWaypointCached(const QString& name, const QString& region,
+                                                               const geo::DPos& pos)
+{
+  if(!waypointCacheLoaded)
+    loadWaypointCache();
+
+  // Same as findWaypointExactQuery and findWaypointQuery
+  const WaypointEntry *found = nullptr;
+  double foundDist = std::numeric_limits<double>::max();
+  for(const WaypointEntry& entry : waypointCache.value(name))
+  {
+    if(!region.isEmpty() && entry.region.compare(region, Qt::CaseInsensitive) != 0)
+      continue;
+
+    if(entry.lonx == pos.getLonX() && entry.laty == pos.getLatY())
+    {
+      // Exact match
+      found = &entry;
+      break;
+    }
+
+    double dist = std::abs(entry.lonx - pos.getLonX()) + std::abs(entry.laty - pos.getLatY());
+    if(dist < 0.001 && dist < foundDist)
+    {
+      found = &entry;
+      foundDist = dist;
+    }
+  }
+
+  if(found != nullptr)
+    return NavIdInfo(found->type, found->region);
+  else
+    return NavIdInfo();
+}
+
+void ProcedureWriter::loadWaypointCache()
+{
+  waypointCache.clear();
+
+  // Share the few distinct region and type strings between all entries
+  atools::util::StringPool& pool = atools::util::StringPool::compileInstance();
+
+  SqlQuery query(db);
+  query.exec("select ident, region, type, lonx, laty from waypoint");
+  int identCol = query.columnIndex("ident"), regionCol = query.columnIndex("region"),
+      typeCol = query.columnIndex("type"), lonxCol = query.columnIndex("lonx"), latyCol = query.columnIndex("laty");
+  while(query.next())
+  {
+    WaypointEntry entry;
+    entry.region = pool.intern(query.valueStr(regionCol));
+    entry.type = pool.intern(query.valueStr(typeCol));
+    entry.lonx = query.valueDouble(lonxCol);
+    entry.laty = query.valueDouble(latyCol);
+    waypointCache[query.valueStr(identCol)].append(entry);
+  }
+  waypointCacheLoaded = true;
+
+  qDebug() << Q_FUNC_INFO << "Loaded" << waypointCache.size() << "waypoint idents";
+}
+
 void ProcedureWriter::initQueries()
 {
   deInitQueries();
@@ -1269,10 +1386,34 @@ void ProcedureWriter::initQueries()
   findWaypointExactQuery->prepare("select type, region from waypoint where ident = :ident and region like :region and "
                                   "lonx = :lonx and laty = :laty");
 
+  if(batchMode)
+  {
+    approachBatch = new SqlBatch(insertApproachQuery, std::numeric_limits<int>::max());
+    approachLegBatch = new SqlBatch(insertApproachLegQuery, std::numeric_limits<int>::max());
+    transitionBatch = new SqlBatch(insertTransitionQuery, std::numeric_limits<int>::max());
+    transitionLegBatch = new SqlBatch(insertTransitionLegQuery, std::numeric_limits<int>::max());
+  }
+
 }
 
 void ProcedureWriter::deInitQueries()
 {
+  // Rows not flushed are discarded
+  delete approachBatch;
+  approachBatch = nullptr;
+
+  delete approachLegBatch;
+  approachLegBatch = nullptr;
+
+  delete transitionBatch;
+  transitionBatch = nullptr;
+
+  delete transitionLegBatch;
+  transitionLegBatch = nullptr;
+
+  waypointCache.clear();
+  waypointCacheLoaded = false;
+
   delete insertApproachQuery;
   insertApproachQuery = nullptr;
 
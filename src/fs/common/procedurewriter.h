@@ -23,11 +23,14 @@
 #include "sql/sqlrecord.h"
 #include "geo/pos.h"
 
+#include <QHash>
+
 namespace atools {
 
 namespace sql {
 class SqlDatabase;
 class SqlQuery;
+class SqlBatch;
 }
 
 namespace fs {
@@ -130,6 +133,14 @@ public:
   /* Reset after writing procedures for one airport */
   void reset();
 
+  /* Collect procedures, transitions and legs and write them in large batches. Also loads all waypoints into
+   * memory on the first lookup which avoids one or two queries per leg.
+   * The waypoint table has to be complete before writing and flush() has to be called when done. */
+  void setBatchMode(bool value);
+
+  /* Write all collected rows in batch mode. Does nothing otherwise. */
+  void flush();
+
 private:
   /* Used to store a procedure before writing to the database */
   struct Procedure
@@ -170,9 +181,25 @@ private:
     QString type, region; // Region is always set - either value passed to the method or found value
   };
 
+  /* Waypoint, VOR or NDB from the waypoint table for batch mode */
+  struct WaypointEntry
+  {
+    QString region, type;
+    double lonx, laty;
+  };
+
   void initQueries();
   void deInitQueries();
 
+  /* Same as findWaypointExactQuery and findWaypointQuery but using the in memory cache */
+  NavIdInfo findWaypointCached(const QString& name, const QString& region, const geo::DPos& pos);
+  void loadWaypointCache();
+
+  /* Insert directly or add to batch if batch is not null */
+  void insertRecord(atools::sql::SqlQuery *query, atools::sql::SqlBatch *batch, const atools::sql::SqlRecord& record);
+  void insertRecords(atools::sql::SqlQuery *query, atools::sql::SqlBatch *batch,
+                     const atools::sql::SqlRecordVector& records);
+
   /* Write an approach, SID, STAR or transition */
   void writeProcedure(const ProcedureInput& line);
 
@@ -230,6 +257,16 @@ private:
                         *updateAirportQuery = nullptr,
                         *findWaypointExactQuery = nullptr, *findWaypointQuery = nullptr;
 
+  /* Number of legs collected before writing in batch mode */
+  const int BATCH_SIZE = 10000;
+
+  bool batchMode = false, waypointCacheLoaded = false;
+  atools::sql::SqlBatch *approachBatch = nullptr, *approachLegBatch = nullptr, *transitionBatch = nullptr,
+                        *transitionLegBatch = nullptr;
+
+  /* Maps ident to all waypoints having this ident */
+  QHash<QString, QVector<WaypointEntry> > waypointCache;
+
   /* Index to look up airport and runway ids */
   atools::fs::common::AirportIndex *airportIndex;
   const atools::sql::SqlRecord APPROACH_RECORD, APPROACH_LEG_RECORD, TRANSITION_RECORD, TRANSITION_LEG_RECORD;
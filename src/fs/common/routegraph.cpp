@@ -0,0 +1,163 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/common/routegraph.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cstring>
+
+namespace atools {
+namespace fs {
+namespace common {
+
+/* Number of 32 bit arrays with node and edge count elements */
+const static quint64 NUM_NODE_ARRAYS = 4;
+const static quint64 NUM_EDGE_ARRAYS = 7;
+
+RouteGraph::RouteGraph()
+{
+
+}
+
+RouteGraph::~RouteGraph()
+{
+  close();
+}
+
+quint64 RouteGraph::graphSize(quint32 numNodes, quint32 numEdges)
+{
+  quint64 size = (NUM_NODE_ARRAYS * numNodes + (numNodes + 1ULL) + NUM_EDGE_ARRAYS * numEdges) * 4ULL;
+
+  // Align to eight bytes
+  return (size + 7ULL) & ~7ULL;
+}
+
+bool RouteGraph::open(const QString& filename)
+{
+  close();
+
+  file.setFileName(filename);
+  if(!file.open(QIODevice::ReadOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+    return false;
+  }
+
+  quint64 fileSize = static_cast<quint64>(file.size());
+  if(fileSize < sizeof(RouteGraphFileHeader))
+  {
+    qWarning() << Q_FUNC_INFO << "File too small" << filename;
+    close();
+    return false;
+  }
+
+  data = file.map(0, file.size());
+  if(data == nullptr)
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot map" << filename << file.errorString();
+    close();
+    return false;
+  }
+
+  RouteGraphFileHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if(std::memcmp(header.magic, "ATRG", 4) != 0 || header.version != FILE_VERSION)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid file header or version in" << filename;
+    close();
+    return false;
+  }
+
+  for(int i = 0; i < ROUTE_NUM_NETWORKS; i++)
+  {
+    quint32 nodes = header.numNodes[i], edges = header.numEdges[i];
+    if(header.offset[i] % 8 != 0 || header.offset[i] > fileSize ||
+       graphSize(nodes, edges) > fileSize - header.offset[i])
+    {
+      qWarning() << Q_FUNC_INFO << "Invalid graph offset or size in" << filename;
+      close();
+      return false;
+    }
+
+    const uchar *ptr = data + header.offset[i];
+    Graph& graph = graphs[i];
+    graph.numNodes = nodes;
+    graph.numEdges = edges;
+    graph.nodeIds = reinterpret_cast<const qint32 *>(ptr);
+    graph.nodeTypes = graph.nodeIds + nodes;
+    graph.lonX = reinterpret_cast<const float *>(graph.nodeTypes + nodes);
+    graph.latY = graph.lonX + nodes;
+    graph.edgeOffsets = reinterpret_cast<const quint32 *>(graph.latY + nodes);
+    graph.edgeTargets = graph.edgeOffsets + nodes + 1;
+    graph.distances = reinterpret_cast<const qint32 *>(graph.edgeTargets + edges);
+    graph.airwayIds = graph.distances + edges;
+    graph.types = graph.airwayIds + edges;
+    graph.directions = graph.types + edges;
+    graph.minAltitudes = graph.directions + edges;
+    graph.maxAltitudes = graph.minAltitudes + edges;
+
+    // RouteFinder does no bounds checks - offsets have to be ascending and targets have to be valid nodes
+    bool valid = graph.edgeOffsets[nodes] == edges;
+    for(quint32 n = 0; n < nodes && valid; n++)
+      valid = graph.edgeOffsets[n] <= graph.edgeOffsets[n + 1];
+
+    for(quint32 e = 0; e < edges && valid; e++)
+      valid = graph.edgeTargets[e] < nodes;
+
+    if(!valid)
+    {
+      qWarning() << Q_FUNC_INFO << "Invalid edge offsets or targets in" << filename;
+      close();
+      return false;
+    }
+  }
+
+  qInfo() << Q_FUNC_INFO << "Opened" << filename
+          << "radio nodes" << graphs[ROUTE_RADIO].numNodes << "edges" << graphs[ROUTE_RADIO].numEdges
+          << "airway nodes" << graphs[ROUTE_AIRWAY].numNodes << "edges" << graphs[ROUTE_AIRWAY].numEdges;
+  return true;
+}
+
+void RouteGraph::close()
+{
+  if(data != nullptr)
+    file.unmap(const_cast<uchar *>(data));
+  data = nullptr;
+
+  if(file.isOpen())
+    file.close();
+
+  for(Graph& graph : graphs)
+    graph = Graph();
+}
+
+int RouteGraph::nodeIndex(RouteNetwork network, int nodeId) const
+{
+  const Graph& graph = graphs[network];
+  const qint32 *end = graph.nodeIds + graph.numNodes;
+  const qint32 *it = std::lower_bound(graph.nodeIds, end, nodeId);
+  if(it != end && *it == nodeId)
+    return static_cast<int>(it - graph.nodeIds);
+  else
+    return -1;
+}
+
+} // namespace common
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,180 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_COMMON_ROUTEGRAPH_H
+#define ATOOLS_FS_COMMON_ROUTEGRAPH_H
+
+#include <QFile>
+
+namespace atools {
+namespace fs {
+namespace common {
+
+/* Networks stored in a route graph file */
+enum RouteNetwork
+{
+  ROUTE_RADIO = 0, /* route_node_radio and route_edge_radio */
+  ROUTE_AIRWAY = 1, /* route_node_airway and route_edge_airway */
+  ROUTE_NUM_NETWORKS = 2
+};
+
+/* File header. All values are in native byte order. Graph data is aligned to eight bytes. */
+struct RouteGraphFileHeader
+{
+  char magic[4];
+  quint32 version;
+  quint32 numNodes[ROUTE_NUM_NETWORKS];
+  quint32 numEdges[ROUTE_NUM_NETWORKS];
+  quint64 offset[ROUTE_NUM_NETWORKS];
+};
+
+/*
+ * Read only routing graph in compressed sparse row format written by atools::fs::db::RouteGraphWriter.
+ * The file is memory mapped and arrays are accessed directly without copying.
+ *
+ * Nodes are ordered by node_id. Edges of node i are edgesBegin(i) to edgesEnd(i) - 1 and are ordered by edge_id.
+ * Airway segments are stored for both nodes with the direction adjusted to the stored orientation.
+ * An airway edge can be traversed from its source to its target unless direction is 2 (backward only).
+ * Each graph contains these arrays:
+ * Nodes: node id, type, longitude, latitude (float), edge offsets (numNodes + 1)
+ * Edges: target node index, distance in meter, airway id, type, direction, minimum altitude, maximum altitude
+ *
+ * Airway type, direction and altitudes are 0 for the radio network. Direction has the same meaning as
+ * route_edge_airway.direction.
+ */
+class RouteGraph
+{
+public:
+  RouteGraph();
+  ~RouteGraph();
+
+  /* Map file. Returns false and logs a warning if the file cannot be opened or is not valid.
+   * Checks all edge offsets and targets which reads the whole edge index once. */
+  bool open(const QString& filename);
+  void close();
+
+  bool isOpen() const
+  {
+    return data != nullptr;
+  }
+
+  int numNodes(RouteNetwork network) const
+  {
+    return static_cast<int>(graphs[network].numNodes);
+  }
+
+  int numEdges(RouteNetwork network) const
+  {
+    return static_cast<int>(graphs[network].numEdges);
+  }
+
+  /* Node index for a node_id or -1 if not found. Uses binary search. */
+  int nodeIndex(RouteNetwork network, int nodeId) const;
+
+  int nodeId(RouteNetwork network, int index) const
+  {
+    return graphs[network].nodeIds[index];
+  }
+
+  int nodeType(RouteNetwork network, int index) const
+  {
+    return graphs[network].nodeTypes[index];
+  }
+
+  float nodeLonX(RouteNetwork network, int index) const
+  {
+    return graphs[network].lonX[index];
+  }
+
+  float nodeLatY(RouteNetwork network, int index) const
+  {
+    return graphs[network].latY[index];
+  }
+
+  int edgesBegin(RouteNetwork network, int index) const
+  {
+    return static_cast<int>(graphs[network].edgeOffsets[index]);
+  }
+
+  int edgesEnd(RouteNetwork network, int index) const
+  {
+    return static_cast<int>(graphs[network].edgeOffsets[index + 1]);
+  }
+
+  /* Index of the node the edge points to */
+  int edgeTarget(RouteNetwork network, int edge) const
+  {
+    return static_cast<int>(graphs[network].edgeTargets[edge]);
+  }
+
+  int edgeDistanceMeter(RouteNetwork network, int edge) const
+  {
+    return graphs[network].distances[edge];
+  }
+
+  int edgeAirwayId(RouteNetwork network, int edge) const
+  {
+    return graphs[network].airwayIds[edge];
+  }
+
+  int edgeType(RouteNetwork network, int edge) const
+  {
+    return graphs[network].types[edge];
+  }
+
+  int edgeDirection(RouteNetwork network, int edge) const
+  {
+    return graphs[network].directions[edge];
+  }
+
+  int edgeMinAltitude(RouteNetwork network, int edge) const
+  {
+    return graphs[network].minAltitudes[edge];
+  }
+
+  int edgeMaxAltitude(RouteNetwork network, int edge) const
+  {
+    return graphs[network].maxAltitudes[edge];
+  }
+
+  static Q_DECL_CONSTEXPR quint32 FILE_VERSION = 2;
+
+  /* Size of the graph data in bytes */
+  static quint64 graphSize(quint32 numNodes, quint32 numEdges);
+
+private:
+  /* Pointers into the mapped file */
+  struct Graph
+  {
+    quint32 numNodes = 0, numEdges = 0;
+    const qint32 *nodeIds = nullptr, *nodeTypes = nullptr;
+    const float *lonX = nullptr, *latY = nullptr;
+    const quint32 *edgeOffsets = nullptr, *edgeTargets = nullptr;
+    const qint32 *distances = nullptr, *airwayIds = nullptr, *types = nullptr, *directions = nullptr,
+                 *minAltitudes = nullptr, *maxAltitudes = nullptr;
+  };
+
+  Graph graphs[ROUTE_NUM_NETWORKS];
+  QFile file;
+  const uchar *data = nullptr;
+};
+
+} // namespace common
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_COMMON_ROUTEGRAPH_H
@@ -18,6 +18,9 @@
 #include "fs/common/xpgeometry.h"
 
 #include <QDataStream>
+#include <QDebug>
+
+#include <cmath>
 
 using atools::geo::Pos;
 
@@ -48,10 +51,137 @@ void XpGeometry::addHoleNode(const geo::Pos& node, const geo::Pos& control, bool
   geometry.holes.last().append({node, control});
 }
 
+/* Fixed point resolution of coordinates */
+static const double COORD_FACTOR = 1.e7;
+
+static void writeVarInt(QByteArray& bytes, quint64 value)
+{
+  while(value >= 0x80)
+  {
+    bytes.append(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  bytes.append(static_cast<char>(value));
+}
+
+static bool readVarInt(const char *& data, const char *end, quint64& value)
+{
+  value = 0;
+  for(int shift = 0; data < end && shift < 64; shift += 7)
+  {
+    quint8 byte = static_cast<quint8>(*data++);
+    value |= static_cast<quint64>(byte & 0x7f) << shift;
+    if(!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+/* Zigzag coding keeps small negative values short */
+static void writeDelta(QByteArray& bytes, qint64 delta)
+{
+  writeVarInt(bytes, (static_cast<quint64>(delta) << 1) ^ static_cast<quint64>(delta >> 63));
+}
+
+static bool readDelta(const char *& data, const char *end, qint64& delta)
+{
+  quint64 value;
+  if(!readVarInt(data, end, value))
+    return false;
+  delta = static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+  return true;
+}
+
+static qint64 toFixed(float value)
+{
+  return static_cast<qint64>(std::llround(static_cast<double>(value) * COORD_FACTOR));
+}
+
+static float fromFixed(qint64 value)
+{
+  return static_cast<float>(static_cast<double>(value) / COORD_FACTOR);
+}
+
 void XpGeometry::readFromByteArray(const QByteArray& bytes)
 {
   clear();
 
+  if(bytes.isEmpty())
+    return;
+
+  if(static_cast<quint8>(bytes.at(0)) != COMPACT_MAGIC)
+  {
+    readLegacy(bytes);
+    return;
+  }
+
+  const char *data = bytes.constData() + 1, *end = bytes.constData() + bytes.size();
+  if(data >= end || static_cast<quint8>(*data++) != COMPACT_VERSION)
+  {
+    qWarning() << Q_FUNC_INFO << "Unknown pavement geometry version";
+    return;
+  }
+
+  quint64 numHoles;
+  qint64 lastLonX = 0, lastLatY = 0;
+  if(!readVarInt(data, end, numHoles) || !readRing(data, end, geometry.boundary, lastLonX, lastLatY))
+  {
+    qWarning() << Q_FUNC_INFO << "Truncated pavement geometry";
+    clear();
+    return;
+  }
+
+  for(quint64 i = 0; i < numHoles; i++)
+  {
+    geometry.holes.append(Boundary());
+    if(!readRing(data, end, geometry.holes.last(), lastLonX, lastLatY))
+    {
+      qWarning() << Q_FUNC_INFO << "Truncated pavement geometry";
+      clear();
+      return;
+    }
+  }
+}
+
+bool XpGeometry::readRing(const char *& data, const char *end, Boundary& ring, qint64& lastLonX, qint64& lastLatY)
+{
+  quint64 numNodes;
+  if(!readVarInt(data, end, numNodes))
+    return false;
+
+  // Curve flags - one bit per node
+  quint64 numFlagBytes = (numNodes + 7) / 8;
+  if(static_cast<quint64>(end - data) < numFlagBytes)
+    return false;
+  const char *flags = data;
+  data += numFlagBytes;
+
+  ring.reserve(static_cast<int>(numNodes));
+  for(quint64 i = 0; i < numNodes; i++)
+  {
+    qint64 dLonX, dLatY;
+    if(!readDelta(data, end, dLonX) || !readDelta(data, end, dLatY))
+      return false;
+    lastLonX += dLonX;
+    lastLatY += dLatY;
+
+    Node node;
+    node.node = Pos(fromFixed(lastLonX), fromFixed(lastLatY));
+
+    if(static_cast<quint8>(flags[i / 8]) & (1 << (i % 8)))
+    {
+      // Control point relative to node
+      if(!readDelta(data, end, dLonX) || !readDelta(data, end, dLatY))
+        return false;
+      node.control = Pos(fromFixed(lastLonX + dLonX), fromFixed(lastLatY + dLatY));
+    }
+    ring.append(node);
+  }
+  return true;
+}
+
+void XpGeometry::readLegacy(const QByteArray& bytes)
+{
   QDataStream in(bytes);
   in.setVersion(QDataStream::Qt_5_5);
   in.setFloatingPointPrecision(QDataStream::SinglePrecision);
@@ -82,34 +212,57 @@ void XpGeometry::readFromByteArray(const QByteArray& bytes)
 
 QByteArray XpGeometry::writeToByteArray()
 {
-  QByteArray bytes;
-  QDataStream out(&bytes, QIODevice::WriteOnly);
-  out.setVersion(QDataStream::Qt_5_5);
-  out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+  // Estimate size to avoid reallocation - flag byte plus up to about six bytes per coordinate
+  int numNodes = geometry.boundary.size();
+  for(const Boundary& hole : geometry.holes)
+    numNodes += hole.size();
 
-  out << static_cast<quint32>(geometry.boundary.size());
-  for(const Node& node : geometry.boundary)
-    writeNode(out, node);
+  QByteArray bytes;
+  bytes.reserve(16 + numNodes * 13);
+  bytes.append(static_cast<char>(COMPACT_MAGIC));
+  bytes.append(static_cast<char>(COMPACT_VERSION));
+  writeVarInt(bytes, static_cast<quint64>(geometry.holes.size()));
 
-  out << static_cast<quint16>(geometry.holes.size());
+  qint64 lastLonX = 0, lastLatY = 0;
+  writeRing(bytes, geometry.boundary, lastLonX, lastLatY);
   for(const Boundary& hole : geometry.holes)
-  {
-    out << static_cast<quint32>(hole.size());
-    for(const Node& node : hole)
-      writeNode(out, node);
-  }
+    writeRing(bytes, hole, lastLonX, lastLatY);
 
   return bytes;
-
 }
 
-void XpGeometry::writeNode(QDataStream& out, const atools::fs::common::Node& node)
+void XpGeometry::writeRing(QByteArray& bytes, const Boundary& ring, qint64& lastLonX, qint64& lastLatY)
 {
-  if(node.control.isValid())
-    out << NODE_TYPE_CURVE << node.node.getLonX() << node.node.getLatY()
-        << node.control.getLonX() << node.control.getLatY();
-  else
-    out << NODE_TYPE_LINE << node.node.getLonX() << node.node.getLatY();
+  writeVarInt(bytes, static_cast<quint64>(ring.size()));
+
+  // Curve flags - one bit per node
+  quint8 flags = 0;
+  for(int i = 0; i < ring.size(); i++)
+  {
+    if(ring.at(i).control.isValid())
+      flags |= static_cast<quint8>(1 << (i % 8));
+
+    if(i % 8 == 7 || i == ring.size() - 1)
+    {
+      bytes.append(static_cast<char>(flags));
+      flags = 0;
+    }
+  }
+
+  for(const Node& node : ring)
+  {
+    qint64 lonX = toFixed(node.node.getLonX()), latY = toFixed(node.node.getLatY());
+    writeDelta(bytes, lonX - lastLonX);
+    writeDelta(bytes, latY - lastLatY);
+    lastLonX = lonX;
+    lastLatY = latY;
+
+    if(node.control.isValid())
+    {
+      writeDelta(bytes, toFixed(node.control.getLonX()) - lonX);
+      writeDelta(bytes, toFixed(node.control.getLatY()) - latY);
+    }
+  }
 }
 
 void XpGeometry::readNode(QDataStream& in, atools::fs::common::Node& node)
@@ -41,8 +41,14 @@ struct XpGeo
 
 /*
  * X-Plane pavement geometry for common use in database and client code.
- * Writes a simple lat/long array in single floating point precision into an byte array which can be used
+ * Writes nodes and Bezier control points into a compact byte array which can be used
  * to write it into a database BLOB.
+ *
+ * Coordinates are stored as fixed point values with 1e-7 degree resolution. Nodes are delta coded
+ * to the previous node and control points to their node. Deltas are written as zigzag variable length integers
+ * which needs around two to three bytes per coordinate for typical airport pavements.
+ *
+ * The old format (single precision lat/long array using QDataStream) can still be read.
  */
 class XpGeometry
 {
@@ -54,7 +60,10 @@ public:
 
   void addHoleNode(const atools::geo::Pos& node, const atools::geo::Pos& control, bool newHole);
 
+  /* Reads compact and old format */
   void readFromByteArray(const QByteArray& bytes);
+
+  /* Writes compact format in one pass */
   QByteArray writeToByteArray();
 
   bool isEmpty() const
@@ -70,12 +79,21 @@ public:
   }
 
 private:
-  void writeNode(QDataStream& out, const Node& node);
+  void readLegacy(const QByteArray& bytes);
   void readNode(QDataStream& in, atools::fs::common::Node& node);
 
+  /* Write one ring: node count, curve flags and delta coded coordinates */
+  void writeRing(QByteArray& bytes, const Boundary& ring, qint64& lastLonX, qint64& lastLatY);
+  bool readRing(const char *& data, const char *end, Boundary& ring, qint64& lastLonX, qint64& lastLatY);
+
   static constexpr qint8 NODE_TYPE_LINE = 0x01;
   static constexpr qint8 NODE_TYPE_CURVE = 0x02;
 
+  /* First byte of compact format. Cannot be the first byte of the old format which starts with
+   * the big endian 32 bit node count. */
+  static constexpr quint8 COMPACT_MAGIC = 0xff;
+  static constexpr quint8 COMPACT_VERSION = 1;
+
   atools::fs::common::XpGeo geometry;
 
 };
@@ -0,0 +1,142 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/airportdetailreader.h"
+
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QStringList>
+
+#include <algorithm>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+AirportDetailReader::AirportDetailReader(sql::SqlDatabase *sqlDb)
+  : db(sqlDb)
+{
+}
+
+template<typename FUNC>
+void AirportDetailReader::readChildren(const QString& queryStr, const QString& idList, FUNC func) const
+{
+  sql::SqlQuery query(db);
+  query.setForwardOnly(true);
+  query.exec(queryStr.arg(idList));
+  while(query.next())
+    func(query);
+}
+
+bool AirportDetailReader::getDetail(AirportDetail& detail, int airportId) const
+{
+  QVector<AirportDetail> details;
+  getDetails(details, {airportId});
+  if(!details.isEmpty())
+  {
+    detail = details.first();
+    return true;
+  }
+  return false;
+}
+
+void AirportDetailReader::getDetails(QVector<AirportDetail>& details, const QVector<int>& airportIds) const
+{
+  details.clear();
+
+  // Index into details for each airport id
+  QHash<int, int> indexById;
+  QVector<int> ids;
+  for(int id : airportIds)
+  {
+    if(!indexById.contains(id))
+    {
+      indexById.insert(id, -1);
+      ids.append(id);
+    }
+  }
+
+  for(int start = 0; start < ids.size(); start += MAX_IDS_PER_QUERY)
+  {
+    QStringList idStrings;
+    for(int i = start; i < std::min(start + MAX_IDS_PER_QUERY, ids.size()); i++)
+      idStrings.append(QString::number(ids.at(i)));
+    QString idList = idStrings.join(",");
+
+    readChildren("select * from airport where airport_id in (%1)", idList, [&](sql::SqlQuery& query) {
+      AirportDetail detail;
+      detail.airport = query.record();
+      indexById[detail.airport.valueInt("airport_id")] = details.size();
+      details.append(detail);
+    });
+
+    readChildren("select * from runway where airport_id in (%1)", idList, [&](sql::SqlQuery& query) {
+      int index = indexById.value(query.valueInt("airport_id"), -1);
+      if(index != -1)
+        details[index].runways.append(query.record());
+    });
+
+    readChildren("select e.*, r.runway_id, r.airport_id from runway_end e "
+                 "join runway r on e.runway_end_id = r.primary_end_id or e.runway_end_id = r.secondary_end_id "
+                 "where r.airport_id in (%1)", idList, [&](sql::SqlQuery& query) {
+      int index = indexById.value(query.valueInt("airport_id"), -1);
+      if(index != -1)
+        details[index].runwayEnds.append(query.record());
+    });
+
+    readChildren("select * from com where airport_id in (%1)", idList, [&](sql::SqlQuery& query) {
+      int index = indexById.value(query.valueInt("airport_id"), -1);
+      if(index != -1)
+        details[index].coms.append(query.record());
+    });
+
+    readChildren("select * from helipad where airport_id in (%1)", idList, [&](sql::SqlQuery& query) {
+      int index = indexById.value(query.valueInt("airport_id"), -1);
+      if(index != -1)
+        details[index].helipads.append(query.record());
+    });
+
+    readChildren("select * from approach where airport_id in (%1)", idList, [&](sql::SqlQuery& query) {
+      int index = indexById.value(query.valueInt("airport_id"), -1);
+      if(index != -1)
+        details[index].approaches.append(query.record());
+    });
+
+    readChildren("select airport_id, type, count(1) as num from parking where airport_id in (%1) "
+                 "group by airport_id, type", idList, [&](sql::SqlQuery& query) {
+      int index = indexById.value(query.valueInt("airport_id"), -1);
+      if(index != -1)
+        details[index].parkingCounts.insert(query.valueStr("type"), query.valueInt("num"));
+    });
+  }
+
+  // Bring into the order of the given ids - rows of the airport query are unordered
+  QVector<AirportDetail> ordered;
+  ordered.reserve(details.size());
+  for(int id : ids)
+  {
+    int index = indexById.value(id, -1);
+    if(index != -1)
+      ordered.append(details.at(index));
+  }
+  details.swap(ordered);
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,79 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_AIRPORTDETAILREADER_H
+#define ATOOLS_FS_DB_AIRPORTDETAILREADER_H
+
+#include "sql/sqlrecord.h"
+
+#include <QHash>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace db {
+
+/* Airport row and all related rows needed for tooltips and information panels */
+struct AirportDetail
+{
+  atools::sql::SqlRecord airport;
+
+  /* Rows of table runway and runway_end. Runway ends have an additional column runway_id. */
+  atools::sql::SqlRecordVector runways, runwayEnds;
+
+  /* Rows of table com, helipad and approach without legs and transitions */
+  atools::sql::SqlRecordVector coms, helipads, approaches;
+
+  /* Number of parking spots by column parking.type */
+  QHash<QString, int> parkingCounts;
+};
+
+/*
+ * Loads details for many airports at once using one query per child table with a list of airport ids.
+ * Avoids the queries per airport when showing tooltips or information for a cluster of airports.
+ */
+class AirportDetailReader
+{
+public:
+  AirportDetailReader(atools::sql::SqlDatabase *sqlDb);
+
+  /* Fill details in the order of airportIds. Unknown ids are left out and duplicates are loaded only once.
+   * Throws SqlException in case of error. */
+  void getDetails(QVector<atools::fs::db::AirportDetail>& details, const QVector<int>& airportIds) const;
+
+  /* Same for a single airport. Returns false if not found. */
+  bool getDetail(atools::fs::db::AirportDetail& detail, int airportId) const;
+
+private:
+  /* Run query for one chunk of ids and append each row to the vector selected by the callback */
+  template<typename FUNC>
+  void readChildren(const QString& queryStr, const QString& idList, FUNC func) const;
+
+  atools::sql::SqlDatabase *db;
+
+  /* Limit length of the id list in a single statement */
+  const static int MAX_IDS_PER_QUERY = 500;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_AIRPORTDETAILREADER_H
@@ -29,7 +29,9 @@
 #include <QString>
 #include <QList>
 #include <algorithm>
-#include <QQueue>
+#include <QThreadPool>
+
+#include <numeric>
 
 namespace atools {
 namespace fs {
@@ -64,49 +66,6 @@ static const QString WAYPOINT_QUERY(
   "  left outer join waypoint next on r.next_ident = next.ident and r.next_region = next.region "
   "order by r.name");
 
-/* Airway segment with from/to position and IDs */
-struct AirwayResolver::AirwaySegment
-{
-  AirwaySegment()
-  {
-
-  }
-
-  AirwaySegment(int fromId, int toId, char direction, int minAltitude, int maxAltitude, QString airwayType,
-                const atools::geo::Pos& fromPosition, const atools::geo::Pos& toPosition)
-    : type(airwayType), dir(direction), fromWaypointId(fromId), toWaypointId(toId),
-    minAlt(minAltitude), maxAlt(maxAltitude),
-    fromPos(fromPosition), toPos(toPosition)
-  {
-  }
-
-  bool operator==(const AirwaySegment& other) const
-  {
-    return fromWaypointId == other.fromWaypointId && toWaypointId == other.toWaypointId;
-
-  }
-
-  bool operator<(const AirwaySegment& other) const
-  {
-    return std::pair<int, int>(fromWaypointId, toWaypointId) <
-           std::pair<int, int>(other.fromWaypointId, other.toWaypointId);
-  }
-
-  QString type;
-  char dir = '\0';
-  int fromWaypointId = 0, toWaypointId = 0, minAlt = 0, maxAlt;
-  atools::geo::Pos fromPos, toPos;
-};
-
-uint qHash(const AirwayResolver::AirwaySegment& segment)
-{
-  return static_cast<unsigned int>(segment.fromWaypointId) ^
-         static_cast<unsigned int>(segment.toWaypointId) ^
-         static_cast<unsigned int>(segment.minAlt) ^
-         static_cast<unsigned int>(segment.maxAlt) ^
-         qHash(segment.type);
-}
-
 AirwayResolver::AirwayResolver(sql::SqlDatabase *sqlDb, atools::fs::ProgressHandler& progress)
   : progressHandler(progress), curAirwayId(1), numAirways(0), airwayInsertStmt(sqlDb), db(sqlDb)
 {
@@ -129,6 +88,28 @@ void AirwayResolver::assignWaypointIds()
   qInfo() << "Updated" << updated << "waypoint_id in airway table";
 }
 
+/* Connects the segments of a range of airways in a worker thread */
+class AirwayTask :
+  public QRunnable
+{
+public:
+  AirwayTask(QVector<AirwayResolver::Airway> *airwayList, int beginIndex, int endIndex)
+    : airways(airwayList), begin(beginIndex), end(endIndex)
+  {
+    setAutoDelete(true);
+  }
+
+  virtual void run() override
+  {
+    for(int i = begin; i < end; i++)
+      AirwayResolver::buildAirway((*airways)[i]);
+  }
+
+private:
+  QVector<AirwayResolver::Airway> *airways;
+  int begin, end;
+};
+
 bool AirwayResolver::run()
 {
   bool aborted = false;
@@ -139,20 +120,41 @@ bool AirwayResolver::run()
   int deleted = query.numRowsAffected();
   qInfo() << "Removed" << deleted << "from airway table";
 
-  // Use set to
-  QSet<AirwaySegment> airway;
+  // Airways collected for the current first character of the name
+  QVector<Airway> airways;
   QString currentAirway;
 
   // Get all airway_point rows and join previous and next waypoints to the result by ident and region
   // Result is ordered by airway name
   query.exec(WAYPOINT_QUERY);
+
+  // Resolve column indexes once for the whole result
+  const int nameIdx = query.columnIndex("name"), typeIdx = query.columnIndex("type"),
+            waypointIdIdx = query.columnIndex("waypoint_id"),
+            lonxIdx = query.columnIndex("lonx"), latyIdx = query.columnIndex("laty"),
+            prevWaypointIdIdx = query.columnIndex("prev_waypoint_id"),
+            prevMinAltIdx = query.columnIndex("previous_minimum_altitude"),
+            prevMaxAltIdx = query.columnIndex("previous_maximum_altitude"),
+            prevDirIdx = query.columnIndex("previous_direction"),
+            nextWaypointIdIdx = query.columnIndex("next_waypoint_id"),
+            nextMinAltIdx = query.columnIndex("next_minimum_altitude"),
+            nextMaxAltIdx = query.columnIndex("next_maximum_altitude"),
+            nextDirIdx = query.columnIndex("next_direction"),
+            prevLonxIdx = query.columnIndex("prev_lonx"), prevLatyIdx = query.columnIndex("prev_laty"),
+            nextLonxIdx = query.columnIndex("next_lonx"), nextLatyIdx = query.columnIndex("next_laty");
+
   while(query.next())
   {
-    QString awName = query.value("name").toString();
-    QString awType = query.value("type").toString();
+    QString awName = query.valueStr(nameIdx);
+    QString awType = query.valueStr(typeIdx);
 
     if(currentAirway.isEmpty() || awName.at(0) != currentAirway.at(0))
     {
+      // Connect and save all airways collected for the previous first character
+      buildAirways(airways);
+      writeAirways(airways);
+      airways.clear();
+
       // Send a progress report for each airway name having a new first characters
       db->commit();
       QString msg = QString(tr("Creating airways: %1...")).arg(awName);
@@ -163,190 +165,148 @@ bool AirwayResolver::run()
 
     if(awName != currentAirway)
     {
-      // A new airway comes from from the query save the current one to the database
-      if(!airway.empty())
-      {
-        // Build airway fragments
-        QVector<Fragment> fragments;
-        buildAirway(currentAirway, airway, fragments);
-
-        // Remove all fragments that are contained by others
-        cleanFragments(fragments);
-
-        for(const Fragment& fragment : fragments)
-        {
-          for(const TypeRowValueVector& bindRow : fragment.boundValues)
-          {
-            airwayInsertStmt.bindValues(bindRow);
-            airwayInsertStmt.exec();
-            numAirways += airwayInsertStmt.numRowsAffected();
-          }
-        }
-        airway.clear();
-      }
+      // A new airway comes from from the query
+      airways.append(Airway());
+      airways.last().name = awName;
       currentAirway = awName;
     }
 
-    int currentWpId = query.value("waypoint_id").toInt();
-    Pos currentWpPos(query.value("lonx").toFloat(), query.value("laty").toFloat());
+    QVector<AirwaySegment>& segments = airways.last().segments;
+
+    int currentWpId = query.valueInt(waypointIdIdx);
+    Pos currentWpPos(query.valueFloat(lonxIdx), query.valueFloat(latyIdx));
 
-    QVariant prevWpIdColVal = query.value("prev_waypoint_id");
-    int prevMinAlt = query.value("previous_minimum_altitude").toInt();
-    int prevMaxAlt = query.value("previous_maximum_altitude").toInt();
-    char prevDir = atools::strToChar(query.value("previous_direction").toString());
+    QVariant prevWpIdColVal = query.value(prevWaypointIdIdx);
+    int prevMinAlt = query.valueInt(prevMinAltIdx);
+    int prevMaxAlt = query.valueInt(prevMaxAltIdx);
+    char prevDir = atools::strToChar(query.valueStr(prevDirIdx));
 
-    QVariant nextWpIdColVal = query.value("next_waypoint_id");
-    int nextMinAlt = query.value("next_minimum_altitude").toInt();
-    int nextMaxAlt = query.value("next_maximum_altitude").toInt();
-    char nextDir = atools::strToChar(query.value("next_direction").toString());
+    QVariant nextWpIdColVal = query.value(nextWaypointIdIdx);
+    int nextMinAlt = query.valueInt(nextMinAltIdx);
+    int nextMaxAlt = query.valueInt(nextMaxAltIdx);
+    char nextDir = atools::strToChar(query.valueStr(nextDirIdx));
 
     if(!prevWpIdColVal.isNull())
     {
       // Previous waypoint found - add segment
-      Pos prevPos(query.value("prev_lonx").toFloat(), query.value("prev_laty").toFloat());
+      Pos prevPos(query.valueFloat(prevLonxIdx), query.valueFloat(prevLatyIdx));
 
       if(currentWpPos.distanceMeterTo(prevPos) < atools::geo::nmToMeter(maxAirwaySegmentLength))
-        airway.insert(AirwaySegment(prevWpIdColVal.toInt(), currentWpId, prevDir, prevMinAlt, prevMaxAlt, awType,
-                                    prevPos, currentWpPos));
+        segments.append(AirwaySegment(prevWpIdColVal.toInt(), currentWpId, prevDir, prevMinAlt, prevMaxAlt, awType,
+                                      prevPos, currentWpPos));
     }
 
     if(!nextWpIdColVal.isNull())
     {
       // Next waypoint found - add segment
-      Pos nextPos(query.value("next_lonx").toFloat(), query.value("next_laty").toFloat());
+      Pos nextPos(query.valueFloat(nextLonxIdx), query.valueFloat(nextLatyIdx));
 
       if(currentWpPos.distanceMeterTo(nextPos) < atools::geo::nmToMeter(maxAirwaySegmentLength))
-        airway.insert(AirwaySegment(currentWpId, nextWpIdColVal.toInt(), nextDir, nextMinAlt, nextMaxAlt, awType,
-                                    currentWpPos, nextPos));
+        segments.append(AirwaySegment(currentWpId, nextWpIdColVal.toInt(), nextDir, nextMinAlt, nextMaxAlt, awType,
+                                      currentWpPos, nextPos));
     }
   }
 
-  qInfo() << "Added " << numAirways << " airway segments";
-
   if(!aborted)
+  {
+    buildAirways(airways);
+    writeAirways(airways);
     db->commit();
+  }
+
+  qInfo() << "Added " << numAirways << " airway segments";
 
   return aborted;
 }
 
-void AirwayResolver::buildAirway(const QString& airwayName, QSet<AirwaySegment>& airway,
-                                 QVector<Fragment>& fragments)
+void AirwayResolver::buildAirways(QVector<Airway>& airways)
 {
-  // Queue of waypoints that will get waypoints in order prependend and appendend
-  QQueue<AirwaySegment> newAirway;
+  int threads = std::min(std::max(numThreads, 1), airways.size());
+  if(threads > 1)
+  {
+    // Airways are independent - split the list into one range per thread
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(threads);
+
+    int rangeSize = (airways.size() + threads - 1) / threads;
+    for(int rangeBegin = 0; rangeBegin < airways.size(); rangeBegin += rangeSize)
+      threadPool.start(new AirwayTask(&airways, rangeBegin, std::min(rangeBegin + rangeSize, airways.size())));
+    threadPool.waitForDone();
+  }
+  else
+  {
+    for(Airway& airway : airways)
+      buildAirway(airway);
+  }
+}
+
+void AirwayResolver::buildAirway(Airway& airway)
+{
+  QVector<AirwaySegment>& segments = airway.segments;
 
-  // Segments indexed by from waypoint ID
-  QHash<int, AirwaySegment> segsByFromWpId;
-  // Segments indexed by to waypoint ID
-  QHash<int, AirwaySegment> segsByToWpId;
+  // Sort by from and to waypoint and remove duplicates which appear for both from and to waypoint rows
+  std::sort(segments.begin(), segments.end());
+  segments.erase(std::unique(segments.begin(), segments.end()), segments.end());
 
-  // Fill the index
-  for(const AirwaySegment& segment : airway)
+  // Segment indexes by from and to waypoint ID - first one wins for branching airways
+  QHash<int, int> segsByFromWpId, segsByToWpId;
+  segsByFromWpId.reserve(segments.size());
+  segsByToWpId.reserve(segments.size());
+  for(int i = 0; i < segments.size(); i++)
   {
-    segsByFromWpId[segment.fromWaypointId] = segment;
-    segsByToWpId[segment.toWaypointId] = segment;
+    if(!segsByFromWpId.contains(segments.at(i).fromWaypointId))
+      segsByFromWpId.insert(segments.at(i).fromWaypointId, i);
+    if(!segsByToWpId.contains(segments.at(i).toWaypointId))
+      segsByToWpId.insert(segments.at(i).toWaypointId, i);
   }
 
-  int fragmentNum = 1;
-  QHash<int, AirwaySegment>::const_iterator it;
-  AirwaySegment segment;
+  // Each segment is used by one fragment only
+  QVector<bool> used(segments.size(), false);
+  QList<int> chain;
 
-  // Iterator over all waypoints in the airway which are neither ordered nor connected yet
-  // All waypoints in airway have same airway name
-  while(!airway.empty())
+  for(int i = 0; i < segments.size(); i++)
   {
-    newAirway.clear();
+    if(used.at(i))
+      continue;
 
-    // Take a random waypoint from the unordered airway and add it to the queue
-    segment = *airway.begin();
-    airway.erase(airway.begin());
-    newAirway.append(segment);
+    // Start a new fragment and follow predecessors and successors
+    chain.clear();
+    chain.append(i);
+    used[i] = true;
 
-    bool foundTo, foundFrom;
-
-    // Now collect predecessors and successors for all waypoints
-    do
+    int next;
+    while((next = segsByToWpId.value(segments.at(chain.first()).fromWaypointId, -1)) != -1 && !used.at(next))
     {
-      foundTo = false;
-      foundFrom = false;
-
-      // Take a segment from the front of the queue and find predecessors
-      segment = newAirway.front();
-      it = segsByToWpId.find(segment.fromWaypointId);
-      if(it != segsByToWpId.end() && airway.find(it.value()) != airway.end())
-      {
-        // Found a predecessor in the index - add it to the new airway and remove it from the queue
-        segment = it.value();
-        newAirway.prepend(segment);
-
-        airway.erase(airway.find(segment));
-        foundTo = true;
-      }
-
-      // Take a segment from the end of the queue and find successors
-      segment = newAirway.back();
-      it = segsByFromWpId.find(segment.toWaypointId);
-      if(it != segsByFromWpId.end() && airway.find(it.value()) != airway.end())
-      {
-        // Found a successor in the index - add it to the new airway and remove it from the queue
-        segment = it.value();
-        newAirway.append(segment);
+      chain.prepend(next);
+      used[next] = true;
+    }
 
-        airway.erase(airway.find(segment));
-        foundFrom = true;
-      }
-    } while(foundTo || foundFrom);
+    while((next = segsByFromWpId.value(segments.at(chain.last()).toWaypointId, -1)) != -1 && !used.at(next))
+    {
+      chain.append(next);
+      used[next] = true;
+    }
 
-    // Write airway fragment - there may be more fragments for the same airway name
-    AirwaySegment last;
-    int seqNo = 1;
     Fragment fragment;
-
-    for(const AirwaySegment& newSegment : newAirway)
+    fragment.segments.reserve(chain.size());
+    fragment.waypoints.reserve(chain.size() * 2);
+    for(int index : chain)
     {
-      last = newSegment;
-
-      fragment.waypoints.insert(newSegment.fromWaypointId);
-      fragment.waypoints.insert(newSegment.toWaypointId);
-
-      // Create bounding rect for this segment
-      Rect bounding(newSegment.fromPos);
-      bounding.extend(newSegment.toPos);
-
-      TypeRowValueVector row;
-
-      row.append(std::make_pair(":airway_id", curAirwayId));
-      row.append(std::make_pair(":airway_name", airwayName));
-      row.append(std::make_pair(":airway_type", newSegment.type));
-      row.append(std::make_pair(":airway_fragment_no", fragmentNum));
-      row.append(std::make_pair(":sequence_no", seqNo));
-
-      row.append(std::make_pair(":from_waypoint_id", newSegment.fromWaypointId));
-      row.append(std::make_pair(":to_waypoint_id", newSegment.toWaypointId));
-
-      row.append(std::make_pair(":direction", atools::charToStr(newSegment.dir)));
-      row.append(std::make_pair(":minimum_altitude", newSegment.minAlt));
-      row.append(std::make_pair(":maximum_altitude", newSegment.maxAlt));
-      row.append(std::make_pair(":left_lonx", bounding.getTopLeft().getLonX()));
-      row.append(std::make_pair(":top_laty", bounding.getTopLeft().getLatY()));
-      row.append(std::make_pair(":right_lonx", bounding.getBottomRight().getLonX()));
-      row.append(std::make_pair(":bottom_laty", bounding.getBottomRight().getLatY()));
-
-      // Write start and end coordinates for this segment
-      row.append(std::make_pair(":from_lonx", newSegment.fromPos.getLonX()));
-      row.append(std::make_pair(":from_laty", newSegment.fromPos.getLatY()));
-      row.append(std::make_pair(":to_lonx", newSegment.toPos.getLonX()));
-      row.append(std::make_pair(":to_laty", newSegment.toPos.getLatY()));
-
-      fragment.boundValues.append(row);
-
-      seqNo++;
-      curAirwayId++;
+      const AirwaySegment& segment = segments.at(index);
+      fragment.segments.append(segment);
+      fragment.waypoints.append(segment.fromWaypointId);
+      fragment.waypoints.append(segment.toWaypointId);
     }
-    fragments.append(fragment);
 
-    fragmentNum++;
+    std::sort(fragment.waypoints.begin(), fragment.waypoints.end());
+    fragment.waypoints.erase(std::unique(fragment.waypoints.begin(), fragment.waypoints.end()),
+                             fragment.waypoints.end());
+    airway.fragments.append(fragment);
   }
+
+  // Remove all fragments that are contained by others
+  cleanFragments(airway.fragments);
+  segments.clear();
 }
 
 void AirwayResolver::cleanFragments(QVector<Fragment>& fragments)
@@ -359,29 +319,114 @@ void AirwayResolver::cleanFragments(QVector<Fragment>& fragments)
   if(it != fragments.end())
     fragments.erase(it, fragments.end());
 
-  // Erase all segments that are contained by another
-  for(int i = 0; i < fragments.size(); i++)
+  if(fragments.size() < 2)
+    return;
+
+  // Check fragments from largest to smallest so that each one has to be compared with the kept larger ones only
+  QVector<int> order(fragments.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&fragments](int i1, int i2) -> bool
+        {
+          return fragments.at(i1).waypoints.size() > fragments.at(i2).waypoints.size();
+        });
+
+  QVector<int> kept;
+  QVector<bool> remove(fragments.size(), false);
+  for(int index : order)
   {
-    Fragment& f1 = fragments[i];
-    for(int j = 0; j < fragments.size(); j++)
+    const QVector<int>& waypoints = fragments.at(index).waypoints;
+    for(int keptIndex : kept)
     {
-      if(j == i)
-        continue;
+      const QVector<int>& keptWaypoints = fragments.at(keptIndex).waypoints;
+      if(std::includes(keptWaypoints.begin(), keptWaypoints.end(), waypoints.begin(), waypoints.end()))
+      {
+        remove[index] = true;
+        break;
+      }
+    }
+
+    if(!remove.at(index))
+      kept.append(index);
+  }
 
-      Fragment& f2 = fragments[j];
+  // Remove the marked segments and keep the order
+  QVector<Fragment> result;
+  for(int i = 0; i < fragments.size(); i++)
+  {
+    if(!remove.at(i))
+      result.append(fragments.at(i));
+  }
+  fragments.swap(result);
+}
+
+void AirwayResolver::writeAirways(const QVector<Airway>& airways)
+{
+  QVariantList ids, names, types, fragmentNos, sequenceNos, fromIds, toIds, directions, minAlts, maxAlts,
+               leftLonX, topLatY, rightLonX, bottomLatY, fromLonX, fromLatY, toLonX, toLatY;
 
-      if(!f2.waypoints.isEmpty() && f1.waypoints.contains(f2.waypoints))
-        f2.waypoints.clear();
+  for(const Airway& airway : airways)
+  {
+    int fragmentNum = 1;
+    for(const Fragment& fragment : airway.fragments)
+    {
+      int seqNo = 1;
+      for(const AirwaySegment& segment : fragment.segments)
+      {
+        // Create bounding rect for this segment
+        Rect bounding(segment.fromPos);
+        bounding.extend(segment.toPos);
+
+        ids.append(curAirwayId++);
+        names.append(airway.name);
+        types.append(segment.type);
+        fragmentNos.append(fragmentNum);
+        sequenceNos.append(seqNo++);
+
+        fromIds.append(segment.fromWaypointId);
+        toIds.append(segment.toWaypointId);
+
+        directions.append(atools::charToStr(segment.dir));
+        minAlts.append(segment.minAlt);
+        maxAlts.append(segment.maxAlt);
+        leftLonX.append(bounding.getTopLeft().getLonX());
+        topLatY.append(bounding.getTopLeft().getLatY());
+        rightLonX.append(bounding.getBottomRight().getLonX());
+        bottomLatY.append(bounding.getBottomRight().getLatY());
+
+        // Write start and end coordinates for this segment
+        fromLonX.append(segment.fromPos.getLonX());
+        fromLatY.append(segment.fromPos.getLatY());
+        toLonX.append(segment.toPos.getLonX());
+        toLatY.append(segment.toPos.getLatY());
+      }
+      fragmentNum++;
     }
   }
 
-  // Remove the marked segments
-  auto it2 = std::remove_if(fragments.begin(), fragments.end(), [](const Fragment& f) -> bool
-        {
-          return f.waypoints.isEmpty();
-        });
-  if(it2 != fragments.end())
-    fragments.erase(it2, fragments.end());
+  if(ids.isEmpty())
+    return;
+
+  airwayInsertStmt.bindValue(":airway_id", ids);
+  airwayInsertStmt.bindValue(":airway_name", names);
+  airwayInsertStmt.bindValue(":airway_type", types);
+  airwayInsertStmt.bindValue(":airway_fragment_no", fragmentNos);
+  airwayInsertStmt.bindValue(":sequence_no", sequenceNos);
+  airwayInsertStmt.bindValue(":from_waypoint_id", fromIds);
+  airwayInsertStmt.bindValue(":to_waypoint_id", toIds);
+  airwayInsertStmt.bindValue(":direction", directions);
+  airwayInsertStmt.bindValue(":minimum_altitude", minAlts);
+  airwayInsertStmt.bindValue(":maximum_altitude", maxAlts);
+  airwayInsertStmt.bindValue(":left_lonx", leftLonX);
+  airwayInsertStmt.bindValue(":top_laty", topLatY);
+  airwayInsertStmt.bindValue(":right_lonx", rightLonX);
+  airwayInsertStmt.bindValue(":bottom_laty", bottomLatY);
+  airwayInsertStmt.bindValue(":from_lonx", fromLonX);
+  airwayInsertStmt.bindValue(":from_laty", fromLatY);
+  airwayInsertStmt.bindValue(":to_lonx", toLonX);
+  airwayInsertStmt.bindValue(":to_laty", toLatY);
+  airwayInsertStmt.execBatch();
+
+  numAirways += ids.size();
 }
 
 } // namespace writer
@@ -21,7 +21,6 @@
 #include "sql/sqlquery.h"
 #include "geo/pos.h"
 
-#include <QSet>
 #include <QCoreApplication>
 
 namespace atools {
@@ -51,7 +50,38 @@ public:
    */
   bool run();
 
-  struct AirwaySegment;
+  /* Airway segment with from/to position and IDs */
+  struct AirwaySegment
+  {
+    AirwaySegment()
+    {
+
+    }
+
+    AirwaySegment(int fromId, int toId, char direction, int minAltitude, int maxAltitude, QString airwayType,
+                  const atools::geo::Pos& fromPosition, const atools::geo::Pos& toPosition)
+      : type(airwayType), dir(direction), fromWaypointId(fromId), toWaypointId(toId),
+      minAlt(minAltitude), maxAlt(maxAltitude),
+      fromPos(fromPosition), toPos(toPosition)
+    {
+    }
+
+    bool operator==(const AirwaySegment& other) const
+    {
+      return fromWaypointId == other.fromWaypointId && toWaypointId == other.toWaypointId;
+    }
+
+    bool operator<(const AirwaySegment& other) const
+    {
+      return std::pair<int, int>(fromWaypointId, toWaypointId) <
+             std::pair<int, int>(other.fromWaypointId, other.toWaypointId);
+    }
+
+    QString type;
+    char dir = '\0';
+    int fromWaypointId = 0, toWaypointId = 0, minAlt = 0, maxAlt = 0;
+    atools::geo::Pos fromPos, toPos;
+  };
 
   /*
    * Assigns the waypoint_id in table airway_point. Not needed for all compilations.
@@ -63,21 +93,39 @@ public:
     maxAirwaySegmentLength = value;
   }
 
+  /* Number of threads used to connect airway segments. Default is 1. */
+  void setNumThreads(int value)
+  {
+    numThreads = value;
+  }
+
 private:
-  int maxAirwaySegmentLength = 1000;
+  friend class AirwayTask;
 
-  typedef std::pair<QString, QVariant> TypeRowValue;
-  typedef QVector<TypeRowValue> TypeRowValueVector;
+  int maxAirwaySegmentLength = 1000, numThreads = 1;
 
+  /* Connected chain of segments */
   struct Fragment
   {
-    QSet<int> waypoints;
-    QVector<TypeRowValueVector> boundValues;
+    QVector<AirwaySegment> segments;
+    QVector<int> waypoints; /* Sorted waypoint ids of all segments */
   };
 
-  void buildAirway(const QString& airwayName, QSet<atools::fs::db::AirwayResolver::AirwaySegment>& airway,
-                   QVector<Fragment>& fragments);
-  void cleanFragments(QVector<Fragment>& fragments);
+  /* All segments of an airway name and the resulting fragments */
+  struct Airway
+  {
+    QString name;
+    QVector<AirwaySegment> segments;
+    QVector<Fragment> fragments;
+  };
+
+  /* Connect all segments of all airways to fragments. Uses worker threads for larger lists. */
+  void buildAirways(QVector<Airway>& airways);
+  static void buildAirway(Airway& airway);
+  static void cleanFragments(QVector<Fragment>& fragments);
+
+  /* Write all fragments using one batch insert */
+  void writeAirways(const QVector<Airway>& airways);
 
   atools::fs::ProgressHandler& progressHandler;
   int curAirwayId, numAirways;
@@ -24,7 +24,7 @@ namespace db {
 
 void atools::fs::db::AirportFileWriter::writeObject(const atools::fs::bgl::Airport *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing airport file " << type->getIdent();
 
   bind(":airport_file_id", getNextId());
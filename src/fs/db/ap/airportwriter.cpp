@@ -61,9 +61,19 @@ using atools::geo::meterToFeet;
 
 void AirportWriter::setNameLists(const QList<const Namelist *>& namelists)
 {
-  for(const Namelist *iter : namelists)
-    for(const NamelistEntry &i : iter->getNameList())
-      nameListIndex[i.getAirportIdent()] = &i;
+  nameLists = namelists;
+}
+
+const NamelistEntry *AirportWriter::findNameEntry(const QString& airportIdent) const
+{
+  // Search backwards since the last entry wins for duplicates
+  for(int i = nameLists.size() - 1; i >= 0; i--)
+  {
+    const NamelistEntry *entry = nameLists.at(i)->getEntry(airportIdent);
+    if(entry != nullptr)
+      return entry;
+  }
+  return nullptr;
 }
 
 void AirportWriter::writeObject(const Airport *type)
@@ -98,8 +108,13 @@ void AirportWriter::writeObject(const Airport *type)
   if(getOptions().isDeletes())
   {
     if(delAp != nullptr || isRealAddon)
+    {
+      // Delete processor reads from the database - write all pending rows first
+      dw.flushWriters();
+
       // Now delete the stock/default airport
       deleteProcessor.preProcessDelete();
+    }
   }
 
   QStringList sceneryLocalPaths, bglFilenames;
@@ -121,21 +136,15 @@ void AirportWriter::writeObject(const Airport *type)
   else
     bind(":region", type->getRegion());
 
-  NameListMapConstIterType it = nameListIndex.find(type->getIdent());
-  if(it != nameListIndex.end())
+  const NamelistEntry *nl = findNameEntry(type->getIdent());
+  if(nl != nullptr)
   {
-    const NamelistEntry *nl = it.value();
-    if(nl != nullptr)
-    {
-      bind(":country", nl->getCountryName());
-      bind(":state", nl->getStateName());
-      bind(":city", nl->getCityName());
+    bind(":country", nl->getCountryName());
+    bind(":state", nl->getStateName());
+    bind(":city", nl->getCityName());
 
-      if(!nl->getRegionIdent().isEmpty())
-        bind(":region", nl->getRegionIdent());
-    }
-    else
-      qWarning().nospace().noquote() << "NameEntry for airport " << type->getIdent() << " is null";
+    if(!nl->getRegionIdent().isEmpty())
+      bind(":region", nl->getRegionIdent());
   }
   else
     qWarning().nospace().noquote() << "NameEntry for airport " << type->getIdent() << " not found";
@@ -274,11 +283,19 @@ void AirportWriter::writeObject(const Airport *type)
       dw.getDeleteAirportWriter()->writeOne(delAp);
 
       if(getOptions().isDeletes())
-        // Now delete the stock/default airport
+      {
+        // Now delete the stock/default airport - deferred mode only records the changes
+        if(!getOptions().isDeferredDelete())
+          dw.flushWriters();
         deleteProcessor.postProcessDelete();
+      }
     }
     else if(isRealAddon)
+    {
+      if(!getOptions().isDeferredDelete())
+        dw.flushWriters();
       deleteProcessor.postProcessDelete();
+    }
   }
 }
 
@@ -25,7 +25,7 @@
 #include "fs/bgl/nl/namelist.h"
 #include "fs/db/datawriter.h"
 
-#include <QHash>
+#include <QList>
 
 namespace atools {
 namespace fs {
@@ -65,13 +65,21 @@ public:
     return currentPos;
   }
 
+  /* Remove or update all replaced airports collected in deferred delete mode. Called at the end of each
+   * scenery area. */
+  void flushDeferredDeletes()
+  {
+    deleteProcessor.flushDeferred();
+  }
+
 private:
   virtual void writeObject(const atools::fs::bgl::Airport *type) override;
 
-  typedef QHash<QString, const atools::fs::bgl::NamelistEntry *> NameListMapType;
-  typedef NameListMapType::const_iterator NameListMapConstIterType;
-  /* Maps airport ICAO idents to NamelistEntrys */
-  NameListMapType nameListIndex;
+  /* Get name entry from the name lists of the current file or null if not found */
+  const atools::fs::bgl::NamelistEntry *findNameEntry(const QString& airportIdent) const;
+
+  /* Name lists of the current BGL file. Each one has an index of airport idents. */
+  QList<const atools::fs::bgl::Namelist *> nameLists;
 
   QString currentIdent;
   atools::geo::Pos currentPos;
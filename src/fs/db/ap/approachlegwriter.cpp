@@ -32,7 +32,7 @@ using atools::fs::bgl::ApproachLeg;
 
 void ApproachLegWriter::writeObject(const ApproachLeg *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing approach leg for airport "
              << getDataWriter().getAirportWriter()->getCurrentAirportIdent();
 
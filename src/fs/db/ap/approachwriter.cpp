@@ -39,7 +39,7 @@ using namespace atools;
 
 void ApproachWriter::writeObject(const Approach *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing Approach for airport "
              << getDataWriter().getAirportWriter()->getCurrentAirportIdent();
 
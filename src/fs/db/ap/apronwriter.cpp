@@ -34,7 +34,7 @@ using atools::fs::bgl::Runway;
 
 void ApronWriter::writeObject(const std::pair<const bgl::Apron *, const bgl::Apron2 *> *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing Apron for airport "
              << getDataWriter().getAirportWriter()->getCurrentAirportIdent();
 
@@ -50,8 +50,12 @@ void ApronWriter::writeObject(const std::pair<const bgl::Apron *, const bgl::Apr
   for(const bgl::BglPosition& pos : type->first->getVertices())
     positions.append(pos.getPos());
 
+  atools::fs::common::BinaryGeometry::Format format = getOptions().isPackedGeometry() ?
+                                                      atools::fs::common::BinaryGeometry::FORMAT_PACKED :
+                                                      atools::fs::common::BinaryGeometry::FORMAT_FLOAT;
+
   atools::fs::common::BinaryGeometry geo(positions);
-  bind(":vertices", geo.writeToByteArray());
+  bind(":vertices", geo.writeToByteArray(format));
 
   if(getOptions().isIncludedNavDbObject(type::APRON2) && type->second != nullptr)
   {
@@ -61,7 +65,7 @@ void ApronWriter::writeObject(const std::pair<const bgl::Apron *, const bgl::Apr
 
     geo.setGeometry(positions);
 
-    bind(":vertices2", geo.writeToByteArray());
+    bind(":vertices2", geo.writeToByteArray(format));
 
     // Triangles are space and comma separated
     bind(":triangles", toBytes(type->second->getTriangleIndex()));
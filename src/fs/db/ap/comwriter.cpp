@@ -29,7 +29,7 @@ using atools::fs::bgl::Com;
 
 void ComWriter::writeObject(const Com *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing COM for airport "
              << getDataWriter().getAirportWriter()->getCurrentAirportIdent();
 
@@ -29,7 +29,7 @@ using atools::fs::bgl::DeleteAirport;
 
 void DeleteAirportWriter::writeObject(const DeleteAirport *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing Delete for airport "
              << getDataWriter().getAirportWriter()->getCurrentAirportIdent();
 
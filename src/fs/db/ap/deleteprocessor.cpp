@@ -18,6 +18,7 @@
 #include "fs/db/ap/deleteprocessor.h"
 #include "sql/sqldatabase.h"
 #include "sql/sqlquery.h"
+#include "logging/loggingmacros.h"
 #include "geo/calculations.h"
 #include "sql/sqlutil.h"
 #include "fs/db/datawriter.h"
@@ -39,6 +40,79 @@ using atools::sql::SqlQuery;
 using atools::sql::SqlUtil;
 using bgl::util::isFlagSet;
 
+/* Facility tables which are either removed or relinked to the new airport. Executed in this order. */
+enum Feature
+{
+  FEATURE_APPROACH = 1 << 0,
+  FEATURE_APRON_LIGHT = 1 << 1,
+  FEATURE_APRON = 1 << 2,
+  FEATURE_COM = 1 << 3,
+  FEATURE_HELIPAD = 1 << 4,
+  FEATURE_TAXI_PATH = 1 << 5,
+  FEATURE_START = 1 << 6,
+  FEATURE_RUNWAY = 1 << 7,
+  FEATURE_PARKING = 1 << 8,
+  FEATURE_FENCE = 1 << 9
+};
+
+const static QVector<std::pair<int, QString> > FEATURE_TABLES(
+{
+  std::make_pair(FEATURE_APPROACH, QString("approach")),
+  std::make_pair(FEATURE_APRON_LIGHT, QString("apron_light")),
+  std::make_pair(FEATURE_APRON, QString("apron")),
+  std::make_pair(FEATURE_COM, QString("com")),
+  std::make_pair(FEATURE_HELIPAD, QString("helipad")),
+  std::make_pair(FEATURE_TAXI_PATH, QString("taxi_path")),
+  std::make_pair(FEATURE_START, QString("start")),
+  std::make_pair(FEATURE_RUNWAY, QString("runway")),
+  std::make_pair(FEATURE_PARKING, QString("parking")),
+  std::make_pair(FEATURE_FENCE, QString("fence"))
+});
+
+/* Groups of airport columns which are copied from the previous to the new airport */
+const static QVector<QStringList> COPY_COLUMN_GROUPS(
+{
+  {"num_approach"},
+  {"num_apron"},
+  {"tower_frequency", "atis_frequency", "awos_frequency", "asos_frequency", "unicom_frequency", "num_com"},
+  {"num_helipad"},
+  {"num_taxi_path"},
+  {"num_starts"},
+  {"is_closed", "num_runway_hard", "num_runway_soft", "num_runway_water", "num_runway_light",
+   "num_runway_end_closed", "num_runway_end_vasi", "num_runway_end_als", "longest_runway_length",
+   "longest_runway_width", "longest_runway_heading", "longest_runway_surface", "num_runways",
+   "left_lonx", "top_laty", "right_lonx", "bottom_laty"},
+  {"num_parking_gate", "num_parking_ga_ramp", "num_parking_cargo", "num_parking_mil_cargo",
+   "num_parking_mil_combat", "num_jetway", "largest_parking_ramp", "largest_parking_gate"},
+  {"num_boundary_fence"},
+  {"fuel_flags", "has_avgas", "has_jetfuel"},
+  {"has_tower_object"},
+  {"tower_altitude"},
+  {"tower_lonx", "tower_laty"},
+  {"mag_var"},
+  {"is_addon"}
+});
+
+/* Bits for COPY_COLUMN_GROUPS */
+enum CopyGroup
+{
+  COPY_APPROACH = 1 << 0,
+  COPY_APRON = 1 << 1,
+  COPY_COM = 1 << 2,
+  COPY_HELIPAD = 1 << 3,
+  COPY_TAXI_PATH = 1 << 4,
+  COPY_START = 1 << 5,
+  COPY_RUNWAY = 1 << 6,
+  COPY_PARKING = 1 << 7,
+  COPY_FENCE = 1 << 8,
+  COPY_FUEL = 1 << 9,
+  COPY_TOWER_OBJECT = 1 << 10,
+  COPY_TOWER_ALTITUDE = 1 << 11,
+  COPY_TOWER_POS = 1 << 12,
+  COPY_MAG_VAR = 1 << 13,
+  COPY_ADDON = 1 << 14
+};
+
 DeleteProcessor::DeleteProcessor(atools::sql::SqlDatabase& sqlDb, const NavDatabaseOptions& opts)
   : options(opts), db(&sqlDb)
 {
@@ -81,8 +155,28 @@ DeleteProcessor::DeleteProcessor(atools::sql::SqlDatabase& sqlDb, const NavDatab
   updateBoundingStmt = new SqlQuery(sqlDb);
   fetchBoundingStmt = new SqlQuery(sqlDb);
 
-  // Most queries act on all other airports with the given ident except the current one
-  // where a.ident = :apIdent and a.airport_id <> :curApId
+  if(options.isDeferredDelete())
+  {
+    // Actions for each replaced airport - executed in flushDeferred()
+    SqlQuery query(sqlDb);
+    query.exec("drop table if exists temp.airport_delete");
+    query.exec("create temp table airport_delete (prev_airport_id integer primary key, "
+               "cur_airport_id integer not null, delete_mask integer not null, update_mask integer not null, "
+               "copy_mask integer not null, rating integer not null, moved integer not null)");
+    query.exec("create unique index temp.idx_airport_delete_cur on airport_delete(cur_airport_id)");
+
+    // Runway ends of deleted runways which have to be removed after the runways
+    query.exec("drop table if exists temp.airport_delete_runway_end");
+    query.exec("create temp table airport_delete_runway_end (runway_end_id integer primary key)");
+
+    insertDeferredStmt = new SqlQuery(sqlDb);
+    insertDeferredStmt->prepare("insert into temp.airport_delete (prev_airport_id, cur_airport_id, delete_mask, "
+                                "update_mask, copy_mask, rating, moved) "
+                                "values(:prevApId, :curApId, :deleteMask, :updateMask, :copyMask, :rating, :moved)");
+  }
+
+  // Queries act on the previous airport with the same ident and the highest id which is found by
+  // selectAirportStmt. This is the same for immediate and deferred mode.
 
   // Define subqueries for features to delete
 
@@ -113,7 +207,7 @@ DeleteProcessor::DeleteProcessor(atools::sql::SqlDatabase& sqlDb, const NavDatab
     "select airport_id, num_apron, num_com, num_helipad, num_taxi_path, num_runways, "
     "num_approach, num_starts, is_addon, rating, "
     "bgl_filename, scenery_local_path, altitude, lonx, laty "
-    "from airport where ident = :apIdent and airport_id <> :curApId order by airport_id desc limit 1");
+    "from airport where ident = :apIdent and airport_id <> :curApId order by airport_id desc limit 2");
 
   // Delete all facilities of the old airport
   deleteComStmt->prepare(delAptFeatureStmt("com"));
@@ -204,12 +298,13 @@ DeleteProcessor::~DeleteProcessor()
 
   delete updateBoundingStmt;
   delete fetchBoundingStmt;
+  delete insertDeferredStmt;
 }
 
 void DeleteProcessor::init(const DeleteAirport *deleteAirportRec, const Airport *airport,
                            int airportId)
 {
-  if(options.isVerbose())
+  if(ATOOLS_VERBOSE(options.isVerbose()))
     qInfo() << Q_FUNC_INFO << airport->getIdent() << "current id" << currentAirportId;
 
   newAirport = airport;
@@ -221,7 +316,7 @@ void DeleteProcessor::init(const DeleteAirport *deleteAirportRec, const Airport
 
 void DeleteProcessor::preProcessDelete()
 {
-  if(options.isVerbose())
+  if(ATOOLS_VERBOSE(options.isVerbose()))
     qInfo() << Q_FUNC_INFO;
 
   // Calculate delete flags either from delete record or current airport
@@ -230,6 +325,14 @@ void DeleteProcessor::preProcessDelete()
   // Get facility counts for current airport
   extractPreviousAirportFeatures();
 
+  if(hasPrevious && deferredIds.contains(prevAirportId))
+  {
+    // Previous airport is part of a pending change or replaced an airport itself - execute all changes
+    // to get the same order as in immediate mode and read the previous airport again
+    flushDeferred();
+    extractPreviousAirportFeatures();
+  }
+
   // Delete the whole tree of approaches, transitions and legs on the old airport later in
   // ":/atools/resources/sql/fs/db/delete_duplicates.sql"
 
@@ -248,187 +351,252 @@ void DeleteProcessor::preProcessDelete()
 
 void DeleteProcessor::postProcessDelete()
 {
-  if(options.isVerbose())
+  if(ATOOLS_VERBOSE(options.isVerbose()))
     qInfo() << Q_FUNC_INFO << newAirport->getIdent() << "current id" << currentAirportId;
-  QStringList copyAirportColumns;
 
+  if(!hasPrevious)
+    // Nothing to remove or update
+    return;
+
+  // Tables to remove from or relink to the new airport and column groups to copy over
+  int deleteMask = 0, updateMask = 0, copyMask = 0;
+  auto removeOrUpdate = [&deleteMask, &updateMask, &copyMask](int feature, bool remove, int copyGroup)
+                        {
+                          if(remove)
+                            deleteMask |= feature;
+                          else
+                          {
+                            updateMask |= feature;
+                            copyMask |= copyGroup;
+                          }
+                        };
+
+  // Relink the approaches to the new airport and update the count on the airport
+  // transferApproaches(); not needed this is covered by sql update script
   if(prevHasApproach)
-  {
-    removeOrUpdate(deleteApproachStmt, updateApproachStmt, bgl::del::APPROACHES);
-
-    if(hasPrevious && !isFlagSet(deleteFlags, bgl::del::APPROACHES))
-    {
-      // Relink the approaches to the new airport and update the count on the airport
-      // transferApproaches(); not needed this is covered by sql update script
-      copyAirportColumns.append("num_approach");
-    }
-  }
+    removeOrUpdate(FEATURE_APPROACH, isFlagSet(deleteFlags, bgl::del::APPROACHES), COPY_APPROACH);
 
   // Work on facilities that will be either removed or attached to the new airport depending on flags
   if(prevHasApron)
   {
-    removeOrUpdate(deleteApronLightStmt, updateApronLightStmt, bgl::del::APRONLIGHTS);
-    removeOrUpdate(deleteApronStmt, updateApronStmt, bgl::del::APRONS);
-
-    if(!isFlagSet(deleteFlags, bgl::del::APRONS) && hasPrevious)
-      // Update apron count in new airport
-      copyAirportColumns.append("num_apron");
+    removeOrUpdate(FEATURE_APRON_LIGHT, isFlagSet(deleteFlags, bgl::del::APRONLIGHTS), 0);
+    removeOrUpdate(FEATURE_APRON, isFlagSet(deleteFlags, bgl::del::APRONS), COPY_APRON);
   }
 
+  // Copy all frequencies to the new airport if not removed
   if(prevHasCom)
-  {
-    removeOrUpdate(deleteComStmt, updateComStmt, bgl::del::COMS);
-
-    if(!isFlagSet(deleteFlags, bgl::del::COMS) && hasPrevious)
-    {
-      // Copy all frequencies to the new airport
-      copyAirportColumns << "tower_frequency" << "atis_frequency" << "awos_frequency" << "asos_frequency"
-                         << "unicom_frequency" << "num_com";
-    }
-  }
+    removeOrUpdate(FEATURE_COM, isFlagSet(deleteFlags, bgl::del::COMS), COPY_COM);
 
   if(prevHasHelipad)
-  {
-    removeOrUpdate(deleteHelipadStmt, updateHelipadStmt, bgl::del::HELIPADS);
-
-    if(!isFlagSet(deleteFlags, bgl::del::HELIPADS) && hasPrevious)
-      // Update helipad count in new airport
-      copyAirportColumns.append("num_helipad");
-  }
+    removeOrUpdate(FEATURE_HELIPAD, isFlagSet(deleteFlags, bgl::del::HELIPADS), COPY_HELIPAD);
 
   if(prevHasTaxi)
-  {
-    removeOrUpdate(deleteTaxiPathStmt, updateTaxiPathStmt, bgl::del::TAXIWAYS);
-
-    if(!isFlagSet(deleteFlags, bgl::del::TAXIWAYS) && hasPrevious)
-      // Update taxi count in new airport
-      copyAirportColumns.append("num_taxi_path");
-  }
+    removeOrUpdate(FEATURE_TAXI_PATH, isFlagSet(deleteFlags, bgl::del::TAXIWAYS), COPY_TAXI_PATH);
 
   if(prevHasStart)
-  {
-    removeOrUpdate(deleteStartStmt, updateStartStmt, bgl::del::STARTS);
+    removeOrUpdate(FEATURE_START, isFlagSet(deleteFlags, bgl::del::STARTS), COPY_START);
+
+  if(prevHasRunways)
+    removeOrUpdate(FEATURE_RUNWAY, isFlagSet(deleteFlags, bgl::del::RUNWAYS), COPY_RUNWAY);
+
+  // New airport has parking - delete the previous ones, otherwise transfer previous ones and update counts
+  removeOrUpdate(FEATURE_PARKING, !newAirport->getParkings().isEmpty(), COPY_PARKING);
+
+  // Same for fences
+  removeOrUpdate(FEATURE_FENCE, !newAirport->getFences().isEmpty(), COPY_FENCE);
+
+  // Copy fuel flags from previous airport if this one doesn't have any
+  if(newAirport->getFuelFlags() == atools::fs::bgl::ap::NO_FUEL_FLAGS)
+    copyMask |= COPY_FUEL;
+
+  // Update tower TODO not accurate
+  if(!newAirport->hasTowerObj())
+    copyMask |= COPY_TOWER_OBJECT;
+
+  if(newAirport->getTowerPosition().getAltitude() == 0.f)
+    copyMask |= COPY_TOWER_ALTITUDE;
+
+  if(newAirport->getTowerPosition().getPos().isNull() || !newAirport->getTowerPosition().getPos().isValid())
+    copyMask |= COPY_TOWER_POS;
+
+  if(newAirport->getMagVar() == 0.f)
+    // TODO FSAD does not update magvar in their airports yet
+    copyMask |= COPY_MAG_VAR;
+
+  if(isAddon)
+    // Previous was an addon - keep this state here, even if this airport is excluded
+    copyMask |= COPY_ADDON;
 
-    if(!isFlagSet(deleteFlags, bgl::del::STARTS) && hasPrevious)
-      // Update start count in new airport
-      copyAirportColumns.append("num_starts");
+  // Get the best rating
+  int currentRating = std::max(newAirport->calculateRating(isAddon), previousRating);
+
+  // Airport has moved more than 500 meter - update bounding rectangle
+  bool moved = newAirport->getPosition().getPos().distanceMeterTo(prevPos) > 500;
+
+  if(insertDeferredStmt != nullptr)
+  {
+    recordDeferred(deleteMask, updateMask, copyMask, currentRating, moved);
+    return;
   }
 
-  if(prevHasRunways)
+  // Delete and update statements in order of FEATURE_TABLES - runways are deleted in removeRunways()
+  const std::pair<SqlQuery *, SqlQuery *> featureStmts[] =
+  {
+    std::make_pair(deleteApproachStmt, updateApproachStmt),
+    std::make_pair(deleteApronLightStmt, updateApronLightStmt),
+    std::make_pair(deleteApronStmt, updateApronStmt),
+    std::make_pair(deleteComStmt, updateComStmt),
+    std::make_pair(deleteHelipadStmt, updateHelipadStmt),
+    std::make_pair(deleteTaxiPathStmt, updateTaxiPathStmt),
+    std::make_pair(deleteStartStmt, updateStartStmt),
+    std::make_pair(deleteRunwayStmt, updateRunwayStmt),
+    std::make_pair(deleteParkingStmt, updateParkingStmt),
+    std::make_pair(deleteFenceStmt, updateFenceStmt)
+  };
+
+  // Remove or relink facilities
+  for(int i = 0; i < FEATURE_TABLES.size(); i++)
   {
-    if(isFlagSet(deleteFlags, bgl::del::RUNWAYS))
-      removeRunways();
-    else if(hasPrevious)
+    int feature = FEATURE_TABLES.at(i).first;
+    const QString& table = FEATURE_TABLES.at(i).second;
+
+    if(deleteMask & feature)
     {
-      // Relink runways
-      bindAndExecute(updateRunwayStmt, "runways updated");
-      copyAirportColumns << "is_closed" << "num_runway_hard" << "num_runway_soft" << "num_runway_water" <<
-        "num_runway_light" << "num_runway_end_closed" << "num_runway_end_vasi" << "num_runway_end_als" <<
-        "longest_runway_length" << "longest_runway_width" <<
-        "longest_runway_heading" << "longest_runway_surface" << "num_runways" << "left_lonx" << "top_laty" <<
-        "right_lonx" << "bottom_laty";
+      if(feature == FEATURE_RUNWAY)
+        removeRunways();
+      else
+        bindAndExecute(featureStmts[i].first, table + " deleted");
     }
+    else if(updateMask & feature)
+      bindAndExecute(featureStmts[i].second, table + " updated");
   }
 
-  if(!newAirport->getParkings().isEmpty())
-    // New airport has parking - delete the previous ones
-    bindAndExecute(deleteParkingStmt, "parking spots deleted");
-  else if(hasPrevious)
-  {
-    // New airport has no parking - transfer previous ones and update counts
-    bindAndExecute(updateParkingStmt, "parking spots updated");
+  SqlQuery update(db);
+  update.prepare("update airport set rating = :rating where airport_id = :apid");
+  update.bindValue(":rating", currentRating);
+  update.bindValue(":apid", currentAirportId);
+  update.exec();
 
-    copyAirportColumns << "num_parking_gate" << "num_parking_ga_ramp" << "num_parking_cargo"
-                       << "num_parking_mil_cargo" << "num_parking_mil_combat" << "num_jetway"
-                       << "largest_parking_ramp" << "largest_parking_gate";
-  }
+  copyAirportValues(copyMask);
 
-  if(!newAirport->getFences().isEmpty())
-    // New airport has fences - delete the previous ones
-    bindAndExecute(deleteFenceStmt, "fences deleted");
-  else if(hasPrevious)
-  {
-    // New airport has no fences - transfer previous ones and update counts
-    bindAndExecute(updateFenceStmt, "fences updated");
-    copyAirportColumns.append("num_boundary_fence");
-  }
+  if(moved)
+    updateBoundingRect(currentAirportId);
 
-  if(hasPrevious)
-  {
-    if(newAirport->getFuelFlags() == atools::fs::bgl::ap::NO_FUEL_FLAGS)
-    {
-      // Copy fuel flags from previous airport if this one doesn't have any
-      QStringList cols;
-      cols << "fuel_flags" << "has_avgas" << "has_jetfuel";
+  // Delete old airport after copying values over
+  bindAndExecute(deleteDeleteApStmt, "delete airports deleted");
 
-      for(const QString& col : cols)
-        copyAirportColumns.append(col);
-    }
+  removeAirport();
+}
+
+void DeleteProcessor::recordDeferred(int deleteMask, int updateMask, int copyMask, int rating, bool moved)
+{
+  insertDeferredStmt->bindValue(":prevApId", prevAirportId);
+  insertDeferredStmt->bindValue(":curApId", currentAirportId);
+  insertDeferredStmt->bindValue(":deleteMask", deleteMask);
+  insertDeferredStmt->bindValue(":updateMask", updateMask);
+  insertDeferredStmt->bindValue(":copyMask", copyMask);
+  insertDeferredStmt->bindValue(":rating", rating);
+  insertDeferredStmt->bindValue(":moved", moved);
+  insertDeferredStmt->exec();
+
+  deferredIds.insert(prevAirportId);
+  deferredIds.insert(currentAirportId);
+}
 
-    // Update tower TODO not accurate
-    if(!newAirport->hasTowerObj())
-      copyAirportColumns.append("has_tower_object");
+void DeleteProcessor::flushDeferred()
+{
+  if(insertDeferredStmt == nullptr || deferredIds.isEmpty())
+    return;
+
+  if(ATOOLS_VERBOSE(options.isVerbose()))
+    qInfo() << Q_FUNC_INFO << "airports" << deferredIds.size() / 2;
 
-    if(newAirport->getTowerPosition().getAltitude() == 0.f)
-      copyAirportColumns.append("tower_altitude");
+  const QString prevIds("select prev_airport_id from temp.airport_delete");
+  const QString curIds("select cur_airport_id from temp.airport_delete");
 
-    if(newAirport->getTowerPosition().getPos().isNull() || !newAirport->getTowerPosition().getPos().isValid())
+  // Remove or relink facilities in the same order as immediate mode
+  for(const std::pair<int, QString>& table : FEATURE_TABLES)
+  {
+    QString bit = QString::number(table.first);
+    QString where = " where airport_id in (" + prevIds + " where (%1 & " + bit + ") <> 0)";
+
+    if(table.first == FEATURE_RUNWAY)
     {
-      copyAirportColumns.append("tower_lonx");
-      copyAirportColumns.append("tower_laty");
+      // Collect ends first and delete them after the runways due to foreign key from rw -> rw end
+      bindAndExecute("insert or ignore into temp.airport_delete_runway_end (runway_end_id) "
+                     "select primary_end_id from runway" + where.arg("delete_mask") + " union "
+                     "select secondary_end_id from runway" + where.arg("delete_mask"), "runway ends collected");
+      bindAndExecute("delete from runway" + where.arg("delete_mask"), "runways deleted");
+      bindAndExecute("delete from runway_end where runway_end_id in "
+                     "(select runway_end_id from temp.airport_delete_runway_end)", "runway ends deleted");
+      db->exec("delete from temp.airport_delete_runway_end");
     }
+    else
+      bindAndExecute("delete from " + table.second + where.arg("delete_mask"), table.second + " deleted");
 
-    if(newAirport->getMagVar() == 0.f)
-      // TODO FSAD does not update magvar in their airports yet
-      copyAirportColumns.append("mag_var");
-
-    // Get the best rating
-    int currentRating = std::max(newAirport->calculateRating(isAddon), previousRating);
-    SqlQuery update(db);
-    update.prepare("update airport set rating = :rating where airport_id = :apid");
-    update.bindValue(":rating", currentRating);
-    update.bindValue(":apid", currentAirportId);
-    update.exec();
-
-    if(isAddon)
-      // Previous was an addon - keep this state here, even if this airport is excluded
-      copyAirportColumns.append("is_addon");
+    // Correlated sub query since update from is not supported by older SQLite
+    bindAndExecute("update " + table.second + " set airport_id = "
+                   "(select d.cur_airport_id from temp.airport_delete d where d.prev_airport_id = " +
+                   table.second + ".airport_id)" + where.arg("update_mask"), table.second + " updated");
   }
 
-  copyAirportValues(copyAirportColumns);
-  updateBoundingRect();
+  bindAndExecute("update airport set rating = "
+                 "(select d.rating from temp.airport_delete d where d.cur_airport_id = airport.airport_id) "
+                 "where airport_id in (" + curIds + ")", "ratings updated");
 
-  // Delete old airport after copying values over
-  bindAndExecute(deleteDeleteApStmt, "delete airports deleted");
+  // Copy column groups from previous to new airports
+  for(int i = 0; i < COPY_COLUMN_GROUPS.size(); i++)
+  {
+    QStringList setCols;
+    for(const QString& col : COPY_COLUMN_GROUPS.at(i))
+      setCols.append(col + " = (select p." + col + " from airport p join temp.airport_delete d on "
+                     "p.airport_id = d.prev_airport_id where d.cur_airport_id = airport.airport_id)");
+
+    bindAndExecute("update airport set " + setCols.join(", ") +
+                   " where airport_id in (" + curIds + " where (copy_mask & " + QString::number(1 << i) + ") <> 0)",
+                   "airports updated");
+  }
 
-  removeAirport();
+  // Moved airports are rare - update one by one
+  QList<int> movedIds;
+  SqlQuery movedQuery(db);
+  movedQuery.prepare(curIds + " where moved <> 0");
+  fetchIds(&movedQuery, movedIds, "moved airports");
+  for(int id : movedIds)
+    updateBoundingRect(id);
+
+  // Delete old airport after copying values over and unlink navigation as in removeAirport()
+  bindAndExecute("delete from delete_airport where airport_id in (" + prevIds + ")", "delete airports deleted");
+  for(const QString& table : {QString("waypoint"), QString("vor"), QString("ndb")})
+    bindAndExecute("update " + table + " set airport_id = "
+                   "(select d.cur_airport_id from temp.airport_delete d where d.prev_airport_id = " + table +
+                   ".airport_id) where airport_id in (" + prevIds + ")", table + " updated");
+  bindAndExecute("delete from airport where airport_id in (" + prevIds + ")", "airports deleted");
+
+  db->exec("delete from temp.airport_delete");
+  deferredIds.clear();
 }
 
-void DeleteProcessor::updateBoundingRect()
+void DeleteProcessor::updateBoundingRect(int airportId)
 {
-  if(hasPrevious && newAirport->getPosition().getPos().distanceMeterTo(prevPos) > 500)
+  fetchBoundingStmt->bindValue(":apid", airportId);
+  executeStatement(fetchBoundingStmt, "Fetch bounding");
+  if(fetchBoundingStmt->next())
   {
-    // Airport has moved more than 500 meter - update bounding rectangle
-
-    fetchBoundingStmt->bindValue(":apid", currentAirportId);
-    executeStatement(fetchBoundingStmt, "Fetch bounding");
-    if(fetchBoundingStmt->next())
+    if(!fetchBoundingStmt->isNull("left_lonx") &&
+       !fetchBoundingStmt->isNull("top_laty") &&
+       !fetchBoundingStmt->isNull("right_lonx") &&
+       !fetchBoundingStmt->isNull("bottom_laty"))
     {
-      if(!fetchBoundingStmt->isNull("left_lonx") &&
-         !fetchBoundingStmt->isNull("top_laty") &&
-         !fetchBoundingStmt->isNull("right_lonx") &&
-         !fetchBoundingStmt->isNull("bottom_laty"))
-      {
-        updateBoundingStmt->bindValue(":apid", currentAirportId);
-        updateBoundingStmt->bindValue(":leftlonx", fetchBoundingStmt->value("left_lonx").toFloat());
-        updateBoundingStmt->bindValue(":toplaty", fetchBoundingStmt->value("top_laty").toFloat());
-        updateBoundingStmt->bindValue(":rightlonx", fetchBoundingStmt->value("right_lonx").toFloat());
-        updateBoundingStmt->bindValue(":bottomlaty", fetchBoundingStmt->value("bottom_laty").toFloat());
-        executeStatement(updateBoundingStmt, "Update bounding");
-      }
+      updateBoundingStmt->bindValue(":apid", airportId);
+      updateBoundingStmt->bindValue(":leftlonx", fetchBoundingStmt->value("left_lonx").toFloat());
+      updateBoundingStmt->bindValue(":toplaty", fetchBoundingStmt->value("top_laty").toFloat());
+      updateBoundingStmt->bindValue(":rightlonx", fetchBoundingStmt->value("right_lonx").toFloat());
+      updateBoundingStmt->bindValue(":bottomlaty", fetchBoundingStmt->value("bottom_laty").toFloat());
+      executeStatement(updateBoundingStmt, "Update bounding");
     }
-    fetchBoundingStmt->finish();
   }
+  fetchBoundingStmt->finish();
 }
 
 void DeleteProcessor::removeRunways()
@@ -466,7 +634,7 @@ int DeleteProcessor::executeStatement(SqlQuery *stmt, const QString& what)
   stmt->exec();
   int retval = stmt->numRowsAffected();
 
-  if(options.isVerbose())
+  if(ATOOLS_VERBOSE(options.isVerbose()))
     if(retval > 0)
       qDebug() << retval << " " << what /* << "bound" << stmt->boundValues()*/;
 
@@ -479,22 +647,10 @@ void DeleteProcessor::fetchIds(SqlQuery *stmt, QList<int>& ids, const QString& w
   while(stmt->next())
     ids.append(stmt->value(0).toInt());
 
-  if(options.isVerbose())
+  if(ATOOLS_VERBOSE(options.isVerbose()))
     qDebug() << ids.size() << " " << what /*<< "bound" << stmt->boundValues()*/;
 }
 
-/* use the remove of update query for a feture depending on the delete flag */
-void DeleteProcessor::removeOrUpdate(SqlQuery *deleteStmt, SqlQuery *updateStmt,
-                                     bgl::del::DeleteAllFlags flag)
-{
-  QString delTypeStr = bgl::DeleteAirport::deleteAllFlagsToStr(flag).toLower();
-
-  if(isFlagSet(deleteFlags, flag))
-    bindAndExecute(deleteStmt, delTypeStr + " deleted");
-  else
-    bindAndExecute(updateStmt, delTypeStr + " updated");
-}
-
 /* Create a statement that sets all airport_id columns to null in the given table that have
  * an airport_id that belongs to the other airports */
 QString DeleteProcessor::updateAptFeatureToNullStmt(const QString& table)
@@ -634,12 +790,24 @@ void DeleteProcessor::extractPreviousAirportFeatures()
       << " (BGL " << sceneryLocalPath << "/" << bglFilename << ")"
       << " to " << atools::roundToInt(atools::geo::meterToFeet(newAirport->getPosition().getAltitude()))
       << " ft";
+
+    // Second row is an older airport which is not replaced - ignore airports already recorded for removal
+    if(selectAirportStmt->next() && !deferredIds.contains(selectAirportStmt->valueInt("airport_id")))
+      qWarning() << Q_FUNC_INFO << "More than one previous airport for" << ident
+                 << "- only airport id" << prevAirportId << "is replaced";
   }
   selectAirportStmt->finish();
 }
 
-void DeleteProcessor::copyAirportValues(const QStringList& copyAirportColumns)
+void DeleteProcessor::copyAirportValues(int copyMask)
 {
+  QStringList copyAirportColumns;
+  for(int i = 0; i < COPY_COLUMN_GROUPS.size(); i++)
+  {
+    if(copyMask & (1 << i))
+      copyAirportColumns.append(COPY_COLUMN_GROUPS.at(i));
+  }
+
   if(!copyAirportColumns.isEmpty())
   {
     SqlQuery query(db), insert(db);
@@ -20,6 +20,8 @@
 
 #include "fs/bgl/ap/airport.h"
 
+#include <QSet>
+
 namespace bgl {
 namespace ap {
 class Airport;
@@ -43,6 +45,13 @@ class ApproachWriter;
 /*
  * Deletes stock/default airports for a new airport. Uses the delete records and removes or updates all
  * old airports and their facilities.
+ *
+ * In deferred mode (option DeferredDelete) postProcessDelete only records the previous and new airport ids and
+ * the actions in a temporary table. All changes are then done with a few set based statements in flushDeferred().
+ *
+ * Both modes replace only the previous airport with the highest id. Older airports with the same ident are kept
+ * and a warning is logged. If the previous airport is part of a recorded change in deferred mode, all recorded
+ * changes are executed first. Both modes produce the same database.
  */
 class DeleteProcessor
 {
@@ -67,6 +76,10 @@ public:
    */
   void postProcessDelete();
 
+  /* Execute all recorded removals and updates in deferred mode. Writers have to be flushed before.
+   * Does nothing if deferred mode is off or nothing was recorded. */
+  void flushDeferred();
+
   const QString& getBglFilename() const
   {
     return bglFilename;
@@ -83,11 +96,10 @@ private:
 
   void removeRunways();
   void removeAirport();
+  void recordDeferred(int deleteMask, int updateMask, int copyMask, int rating, bool moved);
 
   QString updateAptFeatureStmt(const QString& table);
   QString delAptFeatureStmt(const QString& table);
-  void removeOrUpdate(sql::SqlQuery *deleteStmt, sql::SqlQuery *updateStmt,
-                      atools::fs::bgl::del::DeleteAllFlags flag);
   QString updateAptFeatureToNullStmt(const QString& table);
   void removeApproachesAndTransitions(const QList<int>& ids);
   void extractDeleteFlags();
@@ -95,8 +107,8 @@ private:
   int bindAndExecute(sql::SqlQuery *query, const QString& msg);
   int bindAndExecute(const QString& sql, const QString& msg);
   void extractPreviousAirportFeatures();
-  void copyAirportValues(const QStringList& copyAirportColumns);
-  void updateBoundingRect();
+  void copyAirportValues(int copyMask);
+  void updateBoundingRect(int airportId);
 
   const atools::fs::NavDatabaseOptions& options;
 
@@ -122,7 +134,8 @@ private:
   *deleteTaxiPathStmt = nullptr, *updateTaxiPathStmt = nullptr,
   *deleteComStmt = nullptr, *updateComStmt = nullptr,
   *fetchPrimaryAppStmt = nullptr, *fetchSecondaryAppStmt = nullptr,
-  *updateBoundingStmt = nullptr, *fetchBoundingStmt = nullptr;
+  *updateBoundingStmt = nullptr, *fetchBoundingStmt = nullptr,
+  *insertDeferredStmt = nullptr;
 
   const atools::fs::bgl::DeleteAirport *deleteAirport = nullptr;
   atools::fs::bgl::del::DeleteAllFlags deleteFlags = atools::fs::bgl::del::NONE;
@@ -138,6 +151,8 @@ private:
   int prevAirportId = 0;
   atools::geo::Pos prevPos;
 
+  /* Previous and current airport ids recorded in deferred mode */
+  QSet<int> deferredIds;
 };
 
 } // namespace writer
@@ -33,7 +33,7 @@ using atools::fs::bgl::Runway;
 
 void FenceWriter::writeObject(const bgl::Fence *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing Fence for airport "
              << getDataWriter().getAirportWriter()->getCurrentAirportIdent();
 
@@ -46,7 +46,9 @@ void FenceWriter::writeObject(const bgl::Fence *type)
     positions.append(pos.getPos());
 
   atools::fs::common::BinaryGeometry geo(positions);
-  bind(":vertices", geo.writeToByteArray());
+  bind(":vertices", geo.writeToByteArray(getOptions().isPackedGeometry() ?
+                                         atools::fs::common::BinaryGeometry::FORMAT_PACKED :
+                                         atools::fs::common::BinaryGeometry::FORMAT_FLOAT));
 
   executeStatement();
 }
@@ -44,7 +44,7 @@ HelipadWriter::~HelipadWriter()
 
 void HelipadWriter::writeObject(const Helipad *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing Helipad for airport "
              << getDataWriter().getAirportWriter()->getCurrentAirportIdent();
 
@@ -32,7 +32,7 @@ using atools::geo::meterToFeet;
 
 void ParkingWriter::writeObject(const Parking *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing Parking for airport "
              << getDataWriter().getAirportWriter()->getCurrentAirportIdent();
 
@@ -33,7 +33,7 @@ using atools::geo::meterToFeet;
 
 void RunwayEndWriter::writeObject(const RunwayEnd *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing Runway end " << type->getName() << " for airport "
              << getDataWriter().getAirportWriter()->getCurrentAirportIdent();
 
@@ -51,7 +51,7 @@ void RunwayWriter::writeObject(const Runway *type)
   int secondaryEndId = runwayEndWriter->getCurrentId();
   getRunwayIndex()->add(apIdent, type->getSecondary().getName(), secondaryEndId);
 
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing Runway for airport " << apIdent;
 
   // Write runway
@@ -33,7 +33,7 @@ using atools::geo::meterToFeet;
 
 void StartWriter::writeObject(const Start *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing Start for airport "
              << getDataWriter().getAirportWriter()->getCurrentAirportIdent();
 
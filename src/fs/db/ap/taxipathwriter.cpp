@@ -36,7 +36,7 @@ using atools::geo::meterToFeet;
 
 void TaxiPathWriter::writeObject(const TaxiPath *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing TaxiPath for airport "
              << getDataWriter().getAirportWriter()->getCurrentAirportIdent();
 
@@ -32,7 +32,7 @@ using atools::fs::bgl::ApproachLeg;
 
 void TransitionLegWriter::writeObject(const ApproachLeg *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing transition leg for airport "
              << getDataWriter().getAirportWriter()->getCurrentAirportIdent();
 
@@ -36,7 +36,7 @@ using atools::geo::meterToNm;
 
 void TransitionWriter::writeObject(const Transition *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing Transition for airport "
              << getDataWriter().getAirportWriter()->getCurrentAirportIdent();
 
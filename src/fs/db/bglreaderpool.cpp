@@ -0,0 +1,182 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/bglreaderpool.h"
+
+#include "fs/bgl/bglfile.h"
+#include "fs/navdatabaseoptions.h"
+#include "exception.h"
+#include "util/tracerecorder.h"
+
+#include <QDebug>
+#include <QRunnable>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+/* One read ahead buffer holding a file object tree and its options */
+struct BglReaderSlot
+{
+  BglReaderSlot(const atools::fs::NavDatabaseOptions& opts)
+    : options(opts.copyForThread()), bglFile(&options)
+  {
+  }
+
+  /* Records keep a pointer to the options. Therefore each slot needs its own copy. */
+  atools::fs::NavDatabaseOptions options;
+  atools::fs::bgl::BglFile bglFile;
+
+  /* Index of the currently assigned file or -1 if free */
+  int fileIndex = -1;
+  bool done = false, error = false;
+  QString errorMessage;
+};
+
+// -------------------------------------------------------------------------------
+/* Reads one file into a slot in a pool thread */
+class BglReaderTask :
+  public QRunnable
+{
+public:
+  BglReaderTask(BglReaderPool *readerPool, BglReaderSlot *readerSlot, const QString& file)
+    : pool(readerPool), slot(readerSlot), filepath(file)
+  {
+    setAutoDelete(true);
+  }
+
+  virtual void run() override
+  {
+    ATOOLS_TRACE_SPAN("BglReaderTask", "bgl");
+
+    QString errorMessage;
+    bool error = false;
+    try
+    {
+      slot->bglFile.readFile(filepath);
+    }
+    catch(atools::Exception& e)
+    {
+      errorMessage = e.what();
+      error = true;
+    }
+    catch(...)
+    {
+      error = true;
+    }
+    pool->fileDone(slot, errorMessage, error);
+  }
+
+private:
+  BglReaderPool *pool;
+  BglReaderSlot *slot;
+  QString filepath;
+};
+
+// -------------------------------------------------------------------------------
+BglReaderPool::BglReaderPool(const NavDatabaseOptions& opts, const QSet<bgl::section::SectionType>& sectionTypes,
+                             int numThreads, int numSlotsParam)
+{
+  threadPool.setMaxThreadCount(std::max(numThreads, 1));
+
+  int numSlots = numSlotsParam < 1 ? threadPool.maxThreadCount() * 2 : numSlotsParam;
+  for(int i = 0; i < numSlots; i++)
+  {
+    BglReaderSlot *slot = new BglReaderSlot(opts);
+    slot->bglFile.setSupportedSectionTypes(sectionTypes);
+    readerSlots.append(slot);
+  }
+}
+
+BglReaderPool::~BglReaderPool()
+{
+  cancel();
+  qDeleteAll(readerSlots);
+}
+
+void BglReaderPool::start(const QStringList& filepaths)
+{
+  QMutexLocker locker(&mutex);
+
+  files = filepaths;
+  nextFileIndex = 0;
+  canceled = false;
+
+  for(BglReaderSlot *slot : readerSlots)
+    scheduleNext(slot);
+}
+
+const bgl::BglFile *BglReaderPool::waitForFile(int index, QString& errorMessage, bool& error)
+{
+  // Slots are assigned round robin
+  BglReaderSlot *slot = readerSlots.at(index % readerSlots.size());
+
+  QMutexLocker locker(&mutex);
+  if(slot->fileIndex != index)
+    throw atools::Exception(QString("Invalid file index %1 in BGL reader pool").arg(index));
+
+  while(!slot->done)
+    doneCondition.wait(&mutex);
+
+  errorMessage = slot->errorMessage;
+  error = slot->error;
+  return &slot->bglFile;
+}
+
+void BglReaderPool::release(int index)
+{
+  BglReaderSlot *slot = readerSlots.at(index % readerSlots.size());
+
+  QMutexLocker locker(&mutex);
+  slot->fileIndex = -1;
+  scheduleNext(slot);
+}
+
+void BglReaderPool::cancel()
+{
+  {
+    QMutexLocker locker(&mutex);
+    canceled = true;
+  }
+  threadPool.waitForDone();
+}
+
+void BglReaderPool::fileDone(BglReaderSlot *slot, const QString& errorMessage, bool error)
+{
+  QMutexLocker locker(&mutex);
+  slot->errorMessage = errorMessage;
+  slot->error = error;
+  slot->done = true;
+  doneCondition.wakeAll();
+}
+
+void BglReaderPool::scheduleNext(BglReaderSlot *slot)
+{
+  // Called with locked mutex
+  if(!canceled && nextFileIndex < files.size())
+  {
+    slot->fileIndex = nextFileIndex++;
+    slot->done = false;
+    slot->error = false;
+    slot->errorMessage.clear();
+    threadPool.start(new BglReaderTask(this, slot, files.at(slot->fileIndex)));
+  }
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
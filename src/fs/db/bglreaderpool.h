@@ -0,0 +1,111 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_BGLREADERPOOL_H
+#define ATOOLS_FS_DB_BGLREADERPOOL_H
+
+#include "fs/bgl/sectiontype.h"
+
+#include <QMutex>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+
+namespace atools {
+namespace fs {
+class NavDatabaseOptions;
+
+namespace bgl {
+class BglFile;
+}
+
+namespace db {
+
+struct BglReaderSlot;
+
+/*
+ * Reads BGL files in a pool of worker threads into separate BglFile object trees.
+ * Each worker uses its own thread safe copy of the options.
+ *
+ * Files are handed out strictly in the order of the given file list which allows the caller to write
+ * the content using one database connection exactly the same way as in the serial mode.
+ * The number of files decoded in advance is limited by the number of slots.
+ *
+ * Usage: call start(), then for each file index in ascending order call waitForFile() and release().
+ */
+class BglReaderPool
+{
+public:
+  /*
+   * @param opts Options. A deep copy is created for each slot.
+   * @param sectionTypes Sections to read. Passed to BglFile::setSupportedSectionTypes
+   * @param numThreads Number of worker threads
+   * @param numSlotsParam Number of BglFile objects that can be read ahead. Uses twice the number of threads if < 1.
+   */
+  BglReaderPool(const atools::fs::NavDatabaseOptions& opts,
+                const QSet<atools::fs::bgl::section::SectionType>& sectionTypes,
+                int numThreads, int numSlotsParam = 0);
+  ~BglReaderPool();
+
+  /* Start reading files in background. Does not block. */
+  void start(const QStringList& filepaths);
+
+  /*
+   * Blocks until the file at index is read.
+   * @param index Index into the file list given to start(). Has to be called in ascending order.
+   * @param errorMessage Exception message if reading failed. Content of the file is not valid then.
+   * @return File object which is valid until release() is called for the same index.
+   */
+  const atools::fs::bgl::BglFile *waitForFile(int index, QString& errorMessage, bool& error);
+
+  /* Frees the slot of the given file and schedules the next file for reading. */
+  void release(int index);
+
+  /* Stop scheduling new files and wait for running workers. */
+  void cancel();
+
+  int getNumThreads() const
+  {
+    return threadPool.maxThreadCount();
+  }
+
+private:
+  friend class BglReaderTask;
+
+  /* Called by workers when done */
+  void fileDone(atools::fs::db::BglReaderSlot *slot, const QString& errorMessage, bool error);
+
+  /* Schedule next file into slot if any is left */
+  void scheduleNext(atools::fs::db::BglReaderSlot *slot);
+
+  QVector<atools::fs::db::BglReaderSlot *> readerSlots;
+  QStringList files;
+  int nextFileIndex = 0;
+  bool canceled = false;
+
+  QThreadPool threadPool;
+  QMutex mutex;
+  QWaitCondition doneCondition;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_BGLREADERPOOL_H
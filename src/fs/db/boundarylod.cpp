@@ -0,0 +1,133 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/boundarylod.h"
+
+#include "geo/linestring.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+/* Tolerance in degrees for levels 1 to n. About 500 m to 30 km. */
+static const float LEVEL_TOLERANCES[] = {0.005f, 0.02f, 0.08f, 0.3f};
+static const int NUM_LEVELS = sizeof(LEVEL_TOLERANCES) / sizeof(LEVEL_TOLERANCES[0]);
+
+/* Minimum reduction of points compared to the previous level */
+static const float MIN_REDUCTION = 0.75f;
+
+BoundaryLod::BoundaryLod(sql::SqlDatabase *sqlDb)
+  : db(sqlDb)
+{
+}
+
+int BoundaryLod::getNumLevels()
+{
+  return NUM_LEVELS;
+}
+
+int BoundaryLod::levelForTolerance(float toleranceDeg)
+{
+  int level = 0;
+  while(level < NUM_LEVELS && LEVEL_TOLERANCES[level] <= toleranceDeg)
+    level++;
+  return level;
+}
+
+void BoundaryLod::write(atools::fs::common::BinaryGeometry::Format format)
+{
+  QElapsedTimer timer;
+  timer.start();
+  numWritten = 0;
+
+  db->exec("delete from boundary_lod");
+
+  sql::SqlQuery insertQuery(db);
+  insertQuery.prepare("insert into boundary_lod (boundary_id, level, tolerance, num_points, geometry) "
+                      "values(:id, :level, :tolerance, :num, :geometry)");
+
+  sql::SqlQuery query(db);
+  query.setForwardOnly(true);
+  query.exec("select boundary_id, geometry from boundary where geometry is not null");
+  while(query.next())
+  {
+    atools::fs::common::BinaryGeometry geometry(query.value(1).toByteArray());
+    const atools::geo::LineString& full = geometry.getGeometry();
+    int lastSize = full.size();
+
+    for(int level = 1; level <= NUM_LEVELS; level++)
+    {
+      atools::geo::LineString simplified(full);
+      simplified.simplify(LEVEL_TOLERANCES[level - 1]);
+
+      if(simplified.size() > lastSize * MIN_REDUCTION)
+        // Not worth storing - try next coarser level
+        continue;
+
+      atools::fs::common::BinaryGeometry lod(simplified);
+      insertQuery.bindValue(":id", query.value(0));
+      insertQuery.bindValue(":level", level);
+      insertQuery.bindValue(":tolerance", LEVEL_TOLERANCES[level - 1]);
+      insertQuery.bindValue(":num", simplified.size());
+      insertQuery.bindValue(":geometry", lod.writeToByteArray(format));
+      insertQuery.exec();
+      numWritten++;
+
+      lastSize = simplified.size();
+      if(lastSize <= 3)
+        break;
+    }
+  }
+  db->commit();
+
+  qInfo() << Q_FUNC_INFO << "Wrote" << numWritten << "simplified boundaries in" << timer.elapsed() << "ms";
+}
+
+void BoundaryLod::getGeometry(atools::geo::LineString& geometry, int boundaryId, int level) const
+{
+  geometry.clear();
+
+  sql::SqlQuery query(db);
+  if(level > 0)
+  {
+    query.prepare("select geometry from boundary_lod where boundary_id = :id and level <= :level "
+                  "order by level desc limit 1");
+    query.bindValue(":id", boundaryId);
+    query.bindValue(":level", level);
+    query.exec();
+    if(query.next())
+    {
+      atools::fs::common::BinaryGeometry(query.value(0).toByteArray()).swapGeometry(geometry);
+      return;
+    }
+  }
+
+  query.prepare("select geometry from boundary where boundary_id = :id");
+  query.bindValue(":id", boundaryId);
+  query.exec();
+  if(query.next() && !query.isNull(0))
+    atools::fs::common::BinaryGeometry(query.value(0).toByteArray()).swapGeometry(geometry);
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,87 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_BOUNDARYLOD_H
+#define ATOOLS_FS_DB_BOUNDARYLOD_H
+
+#include "fs/common/binarygeometry.h"
+
+namespace atools {
+namespace geo {
+class LineString;
+}
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace db {
+
+/*
+ * Writes and reads simplified airspace boundary geometries in table boundary_lod.
+ *
+ * Each level is simplified from the full geometry with the Douglas-Peucker algorithm using the tolerance of
+ * the level. Levels that do not reduce the number of points by at least a quarter compared to the previous
+ * level are not stored. Level 0 is the full geometry in table boundary.
+ */
+class BoundaryLod
+{
+public:
+  BoundaryLod(atools::sql::SqlDatabase *sqlDb);
+
+  /* Replace all rows in table boundary_lod. Throws SqlException in case of error. */
+  void write(atools::fs::common::BinaryGeometry::Format format);
+
+  /* Highest level having a tolerance not larger than toleranceDeg. 0 if the full geometry is needed. */
+  static int levelForTolerance(float toleranceDeg);
+
+  /* Level for a pixel tolerance where a pixel covers degreesPerPixel on the map */
+  static int levelForPixels(float pixelTolerance, float degreesPerPixel)
+  {
+    return levelForTolerance(pixelTolerance * degreesPerPixel);
+  }
+
+  /* Get the coarsest stored geometry for the boundary not exceeding the given level.
+   * Falls back to the full geometry from table boundary. Geometry is empty if the boundary does not exist. */
+  void getGeometry(atools::geo::LineString& geometry, int boundaryId, int level) const;
+
+  /* Get geometry for a pixel tolerance as above */
+  void getGeometry(atools::geo::LineString& geometry, int boundaryId, float pixelTolerance,
+                   float degreesPerPixel) const
+  {
+    getGeometry(geometry, boundaryId, levelForPixels(pixelTolerance, degreesPerPixel));
+  }
+
+  /* Number of simplified geometries written */
+  int getNumWritten() const
+  {
+    return numWritten;
+  }
+
+  /* Number of levels excluding the full geometry */
+  static int getNumLevels();
+
+private:
+  atools::sql::SqlDatabase *db;
+  int numWritten = 0;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_BOUNDARYLOD_H
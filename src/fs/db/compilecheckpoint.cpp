@@ -0,0 +1,217 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/compilecheckpoint.h"
+
+#include "fs/db/databasemeta.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlrecord.h"
+#include "sql/sqlutil.h"
+
+#include <QDebug>
+#include <QStringList>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+using atools::sql::SqlQuery;
+using atools::sql::SqlUtil;
+
+CompileCheckpoint::CompileCheckpoint(atools::sql::SqlDatabase *sqlDb, const QString& optionsHash)
+  : db(sqlDb), options(optionsHash)
+{
+}
+
+bool CompileCheckpoint::load()
+{
+  currentStep = resumeStep = 0;
+  resumeStepName.clear();
+  resumeRowIds.clear();
+
+  if(!SqlUtil(db).hasTable("metadata") || !db->record("metadata").contains("checkpoint_step"))
+    return false;
+
+  int step = 0, majorVersion = 0, minorVersion = 0;
+  QString name, checkpointOptions, rowIds, cycle;
+  SqlQuery query(db);
+  query.exec("select * from metadata limit 1");
+  if(query.next())
+  {
+    atools::sql::SqlRecord rec = query.record();
+    majorVersion = rec.valueInt("db_version_major");
+    minorVersion = rec.valueInt("db_version_minor");
+    step = rec.valueInt("checkpoint_step", 0);
+    name = rec.valueStr("checkpoint_name", QString());
+    checkpointOptions = rec.valueStr("checkpoint_options", QString());
+    rowIds = rec.valueStr("checkpoint_rowids", QString());
+    cycle = rec.valueStr("airac_cycle", QString());
+  }
+  query.finish();
+
+  if(step <= 0)
+    return false;
+
+  if(majorVersion != DatabaseMeta::DB_VERSION_MAJOR || minorVersion != DatabaseMeta::DB_VERSION_MINOR)
+  {
+    qInfo() << Q_FUNC_INFO << "Checkpoint was written by database version" << majorVersion << minorVersion;
+    return false;
+  }
+
+  if(checkpointOptions != options)
+  {
+    qInfo() << Q_FUNC_INFO << "Checkpoint was written by a compilation using other options";
+    return false;
+  }
+
+  // A crash can leave a damaged file if the journal or synchronous writes are disabled
+  SqlQuery check(db);
+  check.exec("PRAGMA quick_check");
+  QString result = check.next() ? check.valueStr(0) : QString();
+  check.finish();
+  if(result != "ok")
+  {
+    qWarning() << Q_FUNC_INFO << "Database integrity check failed:" << result;
+    return false;
+  }
+
+  for(const QString& entry : rowIds.split(';', QString::SkipEmptyParts))
+    resumeRowIds.insert(entry.section(':', 0, 0), entry.section(':', 1, 1).toLongLong());
+
+  resumeStep = step;
+  resumeStepName = name;
+  airacCycle = cycle;
+  qInfo() << Q_FUNC_INFO << "Found checkpoint after step" << resumeStep << resumeStepName;
+  return true;
+}
+
+void CompileCheckpoint::restore()
+{
+  int numRows = 0, numTables = 0;
+  QHash<QString, qint64> current = collectRowIds();
+  for(auto it = current.constBegin(); it != current.constEnd(); ++it)
+  {
+    if(!resumeRowIds.contains(it.key()))
+    {
+      // Table was created after the checkpoint
+      db->exec("drop table if exists " + it.key());
+      numTables++;
+    }
+    else if(it.value() > resumeRowIds.value(it.key()) && resumeRowIds.value(it.key()) >= 0)
+    {
+      SqlQuery query(db);
+      query.exec(QString("delete from %1 where rowid > %2").arg(it.key()).arg(resumeRowIds.value(it.key())));
+      numRows += query.numRowsAffected();
+    }
+  }
+  db->commit();
+
+  qInfo() << Q_FUNC_INFO << "Removed" << numRows << "rows and" << numTables << "tables written after the checkpoint";
+}
+
+bool CompileCheckpoint::nextStep(const QString& name)
+{
+  currentStep++;
+  stepName = name;
+
+  if(currentStep <= resumeStep)
+  {
+    if(currentStep == resumeStep && name != resumeStepName)
+      qWarning() << Q_FUNC_INFO << "Step" << currentStep << name << "differs from checkpoint" << resumeStepName;
+    return true;
+  }
+  return false;
+}
+
+void CompileCheckpoint::finishStep()
+{
+  if(currentStep <= resumeStep)
+    return;
+
+  QHash<QString, qint64> rowIds = collectRowIds();
+  QStringList entries;
+  for(auto it = rowIds.constBegin(); it != rowIds.constEnd(); ++it)
+    entries.append(QString("%1:%2").arg(it.key()).arg(it.value()));
+  entries.sort();
+
+  SqlQuery query(db);
+  query.exec("select count(1) from metadata");
+  bool hasRow = query.next() && query.valueInt(0) > 0;
+  query.finish();
+
+  if(!hasRow)
+  {
+    // Version is needed to check the checkpoint - row is replaced when the compilation is finished
+    query.prepare("insert into metadata (db_version_major, db_version_minor) values(:major, :minor)");
+    query.bindValue(":major", DatabaseMeta::DB_VERSION_MAJOR);
+    query.bindValue(":minor", DatabaseMeta::DB_VERSION_MINOR);
+    query.exec();
+  }
+
+  query.prepare("update metadata set checkpoint_step = :step, checkpoint_name = :name, "
+                "checkpoint_options = :options, checkpoint_rowids = :rowids, airac_cycle = :cycle");
+  query.bindValue(":step", currentStep);
+  query.bindValue(":name", stepName);
+  query.bindValue(":options", options);
+  query.bindValue(":rowids", entries.join(';'));
+  query.bindValue(":cycle", airacCycle.isEmpty() ? QVariant(QVariant::String) : airacCycle);
+  query.exec();
+}
+
+QHash<QString, qint64> CompileCheckpoint::collectRowIds() const
+{
+  QStringList tables, virtualTables;
+  SqlQuery query(db);
+  query.exec("select name, sql from sqlite_master "
+             "where type = 'table' and sql is not null and name not like 'sqlite_%' and name <> 'metadata'");
+  while(query.next())
+  {
+    tables.append(query.valueStr("name"));
+    if(query.valueStr("sql").startsWith("CREATE VIRTUAL TABLE", Qt::CaseInsensitive))
+      virtualTables.append(query.valueStr("name"));
+  }
+  query.finish();
+
+  QHash<QString, qint64> rowIds;
+  for(const QString& table : tables)
+  {
+    bool shadow = false;
+    for(const QString& virtualTable : virtualTables)
+      shadow |= table.startsWith(virtualTable + "_");
+
+    if(shadow)
+      // Dropped together with the virtual table
+      continue;
+
+    if(virtualTables.contains(table))
+      // Filled and dropped as a whole by scripts - only keep the name
+      rowIds.insert(table, -1);
+    else
+    {
+      SqlQuery maxQuery(db);
+      maxQuery.exec("select max(rowid) from " + table);
+      rowIds.insert(table, maxQuery.next() ? maxQuery.value(0).toLongLong() : 0);
+      maxQuery.finish();
+    }
+  }
+  return rowIds;
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
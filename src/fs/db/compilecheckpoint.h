@@ -0,0 +1,96 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_COMPILECHECKPOINT_H
+#define ATOOLS_FS_DB_COMPILECHECKPOINT_H
+
+#include <QHash>
+#include <QString>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+namespace fs {
+namespace db {
+
+/*
+ * Records the completed steps of a database compilation in the metadata table which allows to resume an
+ * aborted compilation from the last checkpoint.
+ *
+ * Steps are counted in order of execution. The order has to be the same for the aborted and the resumed
+ * compilation which is ensured by comparing a hash of the options. The largest rowid of all tables is saved
+ * with each checkpoint. Rows which were committed after the last checkpoint by a partially written step are
+ * deleted before resuming.
+ *
+ * The checkpoint columns are cleared when the metadata is updated at the end of a successful compilation.
+ */
+class CompileCheckpoint
+{
+public:
+  /*
+   * @param sqlDb Database that is compiled
+   * @param optionsHash Identifies options and simulator of the compilation
+   */
+  CompileCheckpoint(atools::sql::SqlDatabase *sqlDb, const QString& optionsHash);
+
+  /* Load the checkpoint of an aborted compilation. Has to be called before the schema is dropped.
+   * @return false if there is no checkpoint, it was written by a compilation using other options or
+   * the database file is damaged. */
+  bool load();
+
+  /* Delete all rows and tables written after the loaded checkpoint */
+  void restore();
+
+  /* Start the next step. Returns true if the step was already completed and has to be skipped. */
+  bool nextStep(const QString& name);
+
+  /* Save the step started by nextStep() as completed. Does not commit. Nothing is saved for skipped steps. */
+  void finishStep();
+
+  /* true if a checkpoint was loaded */
+  bool isResumed() const
+  {
+    return resumeStep > 0;
+  }
+
+  /* AIRAC cycle which is saved with the next checkpoint or was loaded with the last one */
+  const QString& getAiracCycle() const
+  {
+    return airacCycle;
+  }
+
+  void setAiracCycle(const QString& value)
+  {
+    airacCycle = value;
+  }
+
+private:
+  /* Largest rowid of all tables excluding metadata and virtual tables */
+  QHash<QString, qint64> collectRowIds() const;
+
+  atools::sql::SqlDatabase *db;
+  QString options, stepName, resumeStepName, airacCycle;
+  int currentStep = 0, resumeStep = 0;
+  QHash<QString, qint64> resumeRowIds;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_COMPILECHECKPOINT_H
@@ -17,6 +17,8 @@
 
 #include "fs/db/databasemeta.h"
 
+#include "fs/db/databasesnapshot.h"
+#include "sql/sqldatabase.h"
 #include "sql/sqlquery.h"
 #include "sql/sqlutil.h"
 
@@ -41,6 +43,26 @@ DatabaseMeta::DatabaseMeta(sql::SqlDatabase& sqlDb)
 
 void DatabaseMeta::init()
 {
+  // Avoid the query if the snapshot next to the database file is valid
+  atools::fs::db::DatabaseSnapshot snapshot;
+  if(snapshot.attach(db->databaseName()))
+  {
+    QVariantMap metadata = snapshot.getMetadata();
+    if(!metadata.isEmpty())
+    {
+      majorVersion = metadata.value("db_version_major").toInt();
+      minorVersion = metadata.value("db_version_minor").toInt();
+      lastLoadTime = metadata.value("last_load_timestamp").toDateTime();
+      sidStar = metadata.value("has_sid_star", false).toBool();
+      airacCycle = metadata.value("airac_cycle").toString();
+      validThrough = metadata.value("valid_through").toString();
+      dataSource = metadata.value("data_source").toString();
+      compilerVersion = metadata.value("compiler_version").toString();
+      valid = true;
+      return;
+    }
+  }
+
   if(SqlUtil(db).hasTable("metadata"))
   {
     SqlQuery query(db);
@@ -59,7 +81,9 @@ void DatabaseMeta::init()
       validThrough = rec.valueStr("valid_through", QString());
       dataSource = rec.valueStr("data_source", QString());
       compilerVersion = rec.valueStr("compiler_version", QString());
-      valid = true;
+
+      // Metadata row is written early by checkpoints of an unfinished compilation
+      valid = rec.valueInt("checkpoint_step", 0) == 0;
     }
     query.finish();
   }
@@ -61,7 +61,7 @@ public:
   }
 
   /*
-   * @return true if the database metadata table was found
+   * @return true if the database metadata table was found. false for the database of an aborted compilation.
    */
   bool isValid() const
   {
@@ -124,8 +124,9 @@ public:
    * 11 transition_altitude in airport
    * 12 Several changes towards 3.2.
    * 13 Fix for VASI assignment in X-Plane
+   * 14 Compilation checkpoint columns in metadata
    */
-  static const int DB_VERSION_MINOR = 12;
+  static const int DB_VERSION_MINOR = 14;
 
   void init();
 
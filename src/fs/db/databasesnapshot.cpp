@@ -0,0 +1,240 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/databasesnapshot.h"
+
+#include "fs/common/magdecreader.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlrecord.h"
+#include "sql/sqlutil.h"
+#include "util/xxhash.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+/* Size and modification time identify the database file the snapshot was written for */
+static void databaseFileInfo(const QString& databaseName, quint64& size, qint64& modified)
+{
+  QFileInfo fileinfo(databaseName);
+  size = static_cast<quint64>(fileinfo.size());
+  modified = fileinfo.lastModified().toMSecsSinceEpoch();
+}
+
+static bool isFileDatabase(const QString& databaseName)
+{
+  return !databaseName.isEmpty() && databaseName != ":memory:" && QFileInfo(databaseName).isFile();
+}
+
+DatabaseSnapshot::DatabaseSnapshot()
+{
+}
+
+DatabaseSnapshot::~DatabaseSnapshot()
+{
+  detach();
+}
+
+QString DatabaseSnapshot::snapshotFilename(const QString& databaseName)
+{
+  return databaseName + ".snapshot";
+}
+
+bool DatabaseSnapshot::writeSnapshot(sql::SqlDatabase& db)
+{
+  QString dbName = db.databaseName();
+  if(!isFileDatabase(dbName))
+    return false;
+
+  // Remove old file to let the readers below use SQL
+  QString filename = snapshotFilename(dbName);
+  QFile::remove(filename);
+
+  QVector<std::pair<SnapshotSection, QByteArray> > sections;
+
+  if(atools::sql::SqlUtil(db).hasTable("metadata"))
+  {
+    QVariantMap metadata;
+    atools::sql::SqlQuery query(db);
+    query.exec("select * from metadata limit 1");
+    if(query.next())
+    {
+      atools::sql::SqlRecord rec = query.record();
+      for(int i = 0; i < rec.count(); i++)
+        metadata.insert(rec.fieldName(i), rec.value(i));
+    }
+    query.finish();
+
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_5);
+    out << metadata;
+    sections.append(std::make_pair(SNAPSHOT_METADATA, bytes));
+  }
+
+  atools::fs::common::MagDecReader magDecReader;
+  if(magDecReader.readFromTable(db))
+    sections.append(std::make_pair(SNAPSHOT_MAGDECL, magDecReader.writeToSnapshotBytes()));
+
+  // Directory and sections
+  QByteArray body(sections.size() * DIRECTORY_ENTRY_SIZE, '\0');
+  for(int i = 0; i < sections.size(); i++)
+  {
+    // Align to eight bytes relative to the file start
+    while((HEADER_SIZE + body.size()) % 8 != 0)
+      body.append('\0');
+
+    uchar *entry = reinterpret_cast<uchar *>(body.data()) + i * DIRECTORY_ENTRY_SIZE;
+    qToLittleEndian<quint32>(sections.at(i).first, entry);
+    qToLittleEndian<quint64>(static_cast<quint64>(HEADER_SIZE + body.size()), entry + 8);
+    qToLittleEndian<quint64>(static_cast<quint64>(sections.at(i).second.size()), entry + 16);
+    body.append(sections.at(i).second);
+  }
+
+  quint64 dbSize;
+  qint64 dbModified;
+  databaseFileInfo(dbName, dbSize, dbModified);
+
+  QByteArray header(HEADER_SIZE, '\0');
+  uchar *headerPtr = reinterpret_cast<uchar *>(header.data());
+  qToLittleEndian<quint32>(MAGIC_NUMBER, headerPtr);
+  qToLittleEndian<quint32>(FILE_VERSION, headerPtr + 4);
+  qToLittleEndian<quint32>(static_cast<quint32>(sections.size()), headerPtr + 8);
+  qToLittleEndian<quint64>(dbSize, headerPtr + 16);
+  qToLittleEndian<qint64>(dbModified, headerPtr + 24);
+  qToLittleEndian<quint64>(atools::util::xxHash64(body.constData(), body.size()), headerPtr + 32);
+
+  QSaveFile saveFile(filename);
+  if(saveFile.open(QIODevice::WriteOnly))
+  {
+    saveFile.write(header);
+    saveFile.write(body);
+    if(saveFile.commit())
+    {
+      qInfo() << Q_FUNC_INFO << "Wrote" << filename << "with" << sections.size() << "sections";
+      return true;
+    }
+  }
+  qWarning() << Q_FUNC_INFO << "Cannot write" << filename << saveFile.errorString();
+  return false;
+}
+
+bool DatabaseSnapshot::attach(const QString& databaseName)
+{
+  detach();
+
+  if(!isFileDatabase(databaseName))
+    return false;
+
+  QString filename = snapshotFilename(databaseName);
+  if(!QFileInfo(filename).isFile())
+    return false;
+
+  file = new QFile(filename);
+  if(file->open(QIODevice::ReadOnly) && file->size() >= HEADER_SIZE)
+  {
+    dataSize = file->size();
+    data = file->map(0, dataSize);
+  }
+
+  if(data != nullptr)
+  {
+    quint64 dbSize;
+    qint64 dbModified;
+    databaseFileInfo(databaseName, dbSize, dbModified);
+    quint32 numSections = qFromLittleEndian<quint32>(data + 8);
+
+    if(qFromLittleEndian<quint32>(data) == MAGIC_NUMBER && qFromLittleEndian<quint32>(data + 4) == FILE_VERSION &&
+       HEADER_SIZE + static_cast<qint64>(numSections) * DIRECTORY_ENTRY_SIZE <= dataSize &&
+       qFromLittleEndian<quint64>(data + 16) == dbSize && qFromLittleEndian<qint64>(data + 24) == dbModified &&
+       qFromLittleEndian<quint64>(data + 32) ==
+       atools::util::xxHash64(reinterpret_cast<const char *>(data + HEADER_SIZE), dataSize - HEADER_SIZE))
+      return true;
+
+    qInfo() << Q_FUNC_INFO << "Snapshot" << filename << "is invalid or outdated";
+  }
+  else
+    qWarning() << Q_FUNC_INFO << "Cannot map" << filename << file->errorString();
+
+  detach();
+  return false;
+}
+
+void DatabaseSnapshot::detach()
+{
+  if(file != nullptr)
+  {
+    if(data != nullptr)
+      file->unmap(const_cast<uchar *>(data));
+    delete file;
+  }
+  file = nullptr;
+  data = nullptr;
+  dataSize = 0;
+}
+
+const uchar *DatabaseSnapshot::getSection(SnapshotSection section, qint64& size) const
+{
+  size = 0;
+  if(data == nullptr)
+    return nullptr;
+
+  quint32 numSections = qFromLittleEndian<quint32>(data + 8);
+  for(quint32 i = 0; i < numSections; i++)
+  {
+    const uchar *entry = data + HEADER_SIZE + i * DIRECTORY_ENTRY_SIZE;
+    if(qFromLittleEndian<quint32>(entry) == section)
+    {
+      quint64 offset = qFromLittleEndian<quint64>(entry + 8);
+      quint64 sectionSize = qFromLittleEndian<quint64>(entry + 16);
+      if(offset + sectionSize > static_cast<quint64>(dataSize))
+        return nullptr;
+
+      size = static_cast<qint64>(sectionSize);
+      return data + offset;
+    }
+  }
+  return nullptr;
+}
+
+QVariantMap DatabaseSnapshot::getMetadata() const
+{
+  QVariantMap metadata;
+  qint64 size;
+  const uchar *section = getSection(SNAPSHOT_METADATA, size);
+  if(section != nullptr)
+  {
+    QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char *>(section), static_cast<int>(size));
+    QDataStream in(bytes);
+    in.setVersion(QDataStream::Qt_5_5);
+    in >> metadata;
+  }
+  return metadata;
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,101 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_DATABASESNAPSHOT_H
+#define ATOOLS_FS_DB_DATABASESNAPSHOT_H
+
+#include <QVariantMap>
+
+class QFile;
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace db {
+
+/* Section ids in the snapshot file */
+enum SnapshotSection : quint32
+{
+  /* QDataStream serialized QVariantMap of the metadata row */
+  SNAPSHOT_METADATA = 1,
+
+  /* Magnetic declination written by MagDecReader::writeToSnapshotBytes() */
+  SNAPSHOT_MAGDECL = 2
+};
+
+/*
+ * Memory mapped snapshot of small tables that are read at application startup. Written next to a file based
+ * database after compilation and named "<database>.snapshot". Readers attach to the file and fall back to
+ * SQL queries if it is missing, invalid or does not belong to the current database file.
+ *
+ * Layout in little endian: header with magic number, version, number of sections, size and last modification
+ * time of the database file and a xxHash64 checksum of all following bytes. Followed by a directory of section
+ * id, offset and size and the section data aligned to eight bytes.
+ *
+ * The MORA grid is not included since it has its own mappable file. See MoraReader::gridFilename().
+ */
+class DatabaseSnapshot
+{
+public:
+  DatabaseSnapshot();
+  ~DatabaseSnapshot();
+
+  DatabaseSnapshot(const DatabaseSnapshot& other) = delete;
+  DatabaseSnapshot& operator=(const DatabaseSnapshot& other) = delete;
+
+  /* Read metadata and magnetic declination from the database and write the snapshot file next to it.
+   * Removes an existing snapshot first. Does nothing and returns false if the database is not a file. */
+  static bool writeSnapshot(atools::sql::SqlDatabase& db);
+
+  /* Name of the snapshot file for a database file */
+  static QString snapshotFilename(const QString& databaseName);
+
+  /* Map the snapshot for the database file. Returns false if missing, invalid or stale. */
+  bool attach(const QString& databaseName);
+
+  /* Unmap file */
+  void detach();
+
+  bool isAttached() const
+  {
+    return data != nullptr;
+  }
+
+  /* Pointer into the mapped file for the section or null if not found. size is set to the section size. */
+  const uchar *getSection(atools::fs::db::SnapshotSection section, qint64& size) const;
+
+  /* Column names and values of the metadata table. Empty if not attached. */
+  QVariantMap getMetadata() const;
+
+private:
+  QFile *file = nullptr;
+  const uchar *data = nullptr;
+  qint64 dataSize = 0;
+
+  const static quint32 MAGIC_NUMBER = 0xA5B44CE0;
+  const static quint32 FILE_VERSION = 1;
+  const static int HEADER_SIZE = 40, DIRECTORY_ENTRY_SIZE = 24;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_DATABASESNAPSHOT_H
@@ -19,6 +19,7 @@
 
 #include "fs/bgl/bglfile.h"
 #include "fs/scenery/fileresolver.h"
+#include "fs/scenery/filemanifest.h"
 #include "fs/navdatabaseoptions.h"
 #include "sql/sqldatabase.h"
 #include "fs/db/nav/waypointwriter.h"
@@ -35,6 +36,7 @@
 #include "fs/db/ap/rw/runwayendwriter.h"
 #include "fs/db/runwayindex.h"
 #include "fs/db/dbairportindex.h"
+#include "fs/db/navduplicateindex.h"
 #include "fs/db/ap/approachwriter.h"
 #include "fs/db/ap/approachlegwriter.h"
 #include "fs/db/ap/transitionlegwriter.h"
@@ -52,9 +54,11 @@
 #include "fs/db/ap/deleteairportwriter.h"
 #include "fs/scenery/fileresolver.h"
 #include "fs/db/meta/sceneryareawriter.h"
+#include "fs/db/bglreaderpool.h"
 #include "atools.h"
 #include "fs/common/magdecreader.h"
 #include "settings/settings.h"
+#include "util/tracerecorder.h"
 
 #include <QDebug>
 #include <QFileInfo>
@@ -111,6 +115,9 @@ DataWriter::DataWriter(SqlDatabase& sqlDb, const NavDatabaseOptions& opts, atool
   runwayIndex = new RunwayIndex();
   airportIndex = new DbAirportIndex();
 
+  if(options.isDeduplicateOnWrite())
+    navDuplicateIndex = new NavDuplicateIndex(options.isVerbose());
+
   magDecReader = new MagDecReader();
 }
 
@@ -121,6 +128,10 @@ DataWriter::~DataWriter()
 
 void DataWriter::close()
 {
+  cancelReadAhead();
+  flushWriters();
+  writers.clear();
+
   delete bglFileWriter;
   bglFileWriter = nullptr;
   delete sceneryAreaWriter;
@@ -179,6 +190,8 @@ void DataWriter::close()
   runwayIndex = nullptr;
   delete airportIndex;
   airportIndex = nullptr;
+  delete navDuplicateIndex;
+  navDuplicateIndex = nullptr;
   delete magDecReader;
   magDecReader = nullptr;
 }
@@ -193,127 +206,333 @@ float DataWriter::getMagVar(const geo::Pos& pos, float defaultValue) const
 
 void DataWriter::writeSceneryArea(const SceneryArea& area)
 {
-  QStringList filepaths, filenames;
+  ATOOLS_TRACE_SPAN("DataWriter::writeSceneryArea", "scenery", area.getTitle());
+
+  QStringList filepaths, errorMessages;
+  QList<QPair<QString, QString> > duplicates;
 
   // Get all BGL files in this scenery area
-  atools::fs::scenery::FileResolver resolver(options);
-  resolver.getFiles(area, &filepaths, &filenames);
+  if(fileManifest != nullptr && fileManifest->contains(area))
+  {
+    filepaths = fileManifest->getFilepaths(area);
+    errorMessages = fileManifest->getErrorMessages(area);
+    duplicates = fileManifest->getDuplicates(area);
+  }
+  else
+  {
+    atools::fs::scenery::FileResolver resolver(options);
+    resolver.getFiles(area, &filepaths);
+    errorMessages = resolver.getErrorMessages();
+  }
 
   if(sceneryErrors != nullptr)
-    sceneryErrors->sceneryErrorsMessages.append(resolver.getErrorMessages());
-  progressHandler->reportErrors(resolver.getErrorMessages().size());
+    sceneryErrors->sceneryErrorsMessages.append(errorMessages);
+  progressHandler->reportErrors(errorMessages.size());
 
-  if(!filepaths.empty())
+  if(!filepaths.empty() || !duplicates.empty())
   {
     // Write the scenera area metadata
     sceneryAreaWriter->writeOne(area);
 
-    BglFile bglFile(&options);
+    if(!filepaths.empty())
+    {
+      if((options.isReadParallel() || options.isReadPrefetch()) && fileManifest != nullptr && !readAheadDisabled)
+        writeFilesReadAhead(filepaths);
+      else if(options.isReadParallel() && filepaths.size() > 1)
+        writeFilesParallel(filepaths, options.getNumThreads());
+      else if(options.isReadPrefetch() && filepaths.size() > 1)
+        // One thread and two buffers - next file is read while the current one is written
+        writeFilesParallel(filepaths, 1, 2);
+      else
+        writeFilesSerial(filepaths);
+    }
+
+    // Only add file records for files having the same content as an already loaded file
+    for(const QPair<QString, QString>& duplicate : duplicates)
+    {
+      if(aborted)
+        break;
+
+      if(!bglFileWriter->writeDuplicate(duplicate.first, duplicate.second))
+        qWarning() << Q_FUNC_INFO << "Original" << duplicate.second << "of duplicate" << duplicate.first
+                   << "not loaded";
+    }
 
-    bglFile.setSupportedSectionTypes(SUPPORTED_SECTION_TYPES);
+    if(!duplicates.isEmpty())
+      qInfo() << Q_FUNC_INFO << "Skipped" << duplicates.size() << "duplicate files in" << area.getTitle();
 
-    for(int i = 0; i < filepaths.size(); i++)
+    // Writers are already flushed after each BGL file
+    airportWriter->flushDeferredDeletes();
+
+    if(navDuplicateIndex != nullptr)
+      navDuplicateIndex->deleteReplaced(db);
+
+    if(commitAreas)
+      db.commit();
+    progressHandler->setNumObjectsWritten(numObjectsWritten);
+  }
+}
+
+void DataWriter::writeFilesSerial(const QStringList& filepaths)
+{
+  BglFile bglFile(&options);
+
+  bglFile.setSupportedSectionTypes(SUPPORTED_SECTION_TYPES);
+
+  for(int i = 0; i < filepaths.size(); i++)
+  {
+    if((aborted = reportBglFile(filepaths.at(i))) == true)
+      return;
+
+    QString currentBglFilePath = filepaths.at(i);
+
+    try
     {
-      progressHandler->setNumFiles(numFiles);
-      progressHandler->setNumAirports(airportIdents.size());
-      progressHandler->setNumNamelists(numNamelists);
-      progressHandler->setNumVors(numVors);
-      progressHandler->setNumIls(numIls);
-      progressHandler->setNumNdbs(numNdbs);
-      progressHandler->setNumMarker(numMarker);
-      progressHandler->setNumBoundaries(numBoundaries);
-      progressHandler->setNumWaypoints(numWaypoints);
-      progressHandler->setNumObjectsWritten(numObjectsWritten);
-
-      if((aborted = progressHandler->reportBglFile(filepaths.at(i))) == true)
-        return;
-
-      QString currentBglFilePath = filepaths.at(i);
-
-      try
-      {
-        // Read all records into a internal object tree (atools::fs::bgl namespace)
-        bglFile.readFile(currentBglFilePath);
-
-        if(bglFile.hasContent() && bglFile.isValid())
-        {
-          // if(!bglFile.getHeader().hasValidMagicNumber())
-          // qWarning() << "Content in file with invalid magic number";
-
-          // Write BGL file metadata
-          bglFileWriter->writeOne(bglFile);
-
-          // Clear the indexes
-          runwayIndex->clear();
-          airportIndex->clear();
-
-          // Execution order is important due to dependencies between the writers
-          // (i.e. ILS writer looks for runway end ids)
-          // Writer also need to access the ids of their parent record objects
-          // (i.e. runway needs the current airport ID
-
-          airportWriter->setNameLists(bglFile.getNamelists());
-
-          // Write airport and all subrecords like runways, approaches, parking and so on
-          airportWriter->write(bglFile.getAirports());
-          airportFileWriter->write(bglFile.getAirports());
-
-          // Write all navaids to the database
-          waypointWriter->write(bglFile.getWaypoints());
-          vorWriter->write(bglFile.getVors());
-          tacanWriter->write(bglFile.getTacans());
-          ndbWriter->write(bglFile.getNdbs());
-          markerWriter->write(bglFile.getMarker());
-          ilsWriter->write(bglFile.getIls());
-
-          boundaryWriter->write(bglFile.getBoundaries());
-
-          for(const atools::fs::bgl::Airport *ap : bglFile.getAirports())
-            airportIdents.insert(ap->getIdent());
-
-          numNamelists += bglFile.getNamelists().size();
-          numVors += bglFile.getVors().size() + bglFile.getTacans().size();
-          numIls += bglFile.getIls().size();
-          numNdbs += bglFile.getNdbs().size();
-          numMarker += bglFile.getMarker().size();
-          numWaypoints += bglFile.getWaypoints().size();
-          numBoundaries += bglFile.getBoundaries().size();
-          numFiles++;
-        }
-
-        // Print a one line short report on airports that were found in the BGL
-        if(!bglFile.getAirports().isEmpty())
-        {
-          QStringList apIcaos;
-          for(const atools::fs::bgl::Airport *ap : bglFile.getAirports())
-          {
-            // Truncate at 10
-            if(apIcaos.size() < 10)
-              apIcaos.append(ap->getIdent());
-            else
-              break;
-          }
-          if(bglFile.getAirports().size() > 10)
-            apIcaos.append("...");
-          qDebug() << "Found" << bglFile.getAirports().size() << "airports. idents:" << apIcaos.join(",");
-        }
-      }
-      catch(atools::Exception& e)
-      {
-        qCritical() << "Caught exception reading" << currentBglFilePath << ":" << e.what();
-        progressHandler->reportError();
-        if(sceneryErrors != nullptr)
-          sceneryErrors->fileErrors.append({currentBglFilePath, QString(e.what()), 0});
-      }
-      catch(...)
-      {
-        qCritical() << "Caught unknown exception reading" << currentBglFilePath;
-        progressHandler->reportError();
-        if(sceneryErrors != nullptr)
-          sceneryErrors->fileErrors.append({currentBglFilePath, QString(), 0});
-      }
+      // Read all records into a internal object tree (atools::fs::bgl namespace)
+      bglFile.readFile(currentBglFilePath);
+      writeBglFile(bglFile);
     }
-    db.commit();
+    catch(atools::Exception& e)
+    {
+      reportFileError(currentBglFilePath, e.what());
+    }
+    catch(...)
+    {
+      reportFileError(currentBglFilePath, QString());
+    }
+  }
+}
+
+void DataWriter::writeFilesParallel(const QStringList& filepaths, int numThreads, int numSlots)
+{
+  // Read files in background and write them in the same order as the serial mode
+  BglReaderPool pool(options, SUPPORTED_SECTION_TYPES, std::max(1, std::min(numThreads, filepaths.size())),
+                     numSlots);
+  pool.start(filepaths);
+
+  for(int i = 0; i < filepaths.size(); i++)
+  {
+    if((aborted = reportBglFile(filepaths.at(i))) == true)
+    {
+      pool.cancel();
+      return;
+    }
+
+    writePooledFile(pool, i, filepaths.at(i));
+  }
+}
+
+void DataWriter::writeFilesReadAhead(const QStringList& filepaths)
+{
+  if(readAheadPool == nullptr)
+  {
+    // Start reading all files of all areas at the first area
+    readAheadFiles = fileManifest->getAllFilepaths();
+    readAheadIndex = 0;
+    if(options.isReadParallel())
+      readAheadPool = new BglReaderPool(options, SUPPORTED_SECTION_TYPES,
+                                        std::max(1, std::min(options.getNumThreads(), readAheadFiles.size())));
+    else
+      // Prefetch only - one thread and two buffers
+      readAheadPool = new BglReaderPool(options, SUPPORTED_SECTION_TYPES, 1, 2);
+    readAheadPool->start(readAheadFiles);
+  }
+
+  if(readAheadFiles.mid(readAheadIndex, filepaths.size()) != filepaths)
+  {
+    // Areas are not written in manifest order - continue with one pool per area
+    qWarning() << Q_FUNC_INFO << "Files do not match manifest order. Disabling read ahead.";
+    cancelReadAhead();
+    readAheadDisabled = true;
+
+    if(filepaths.size() > 1)
+      writeFilesParallel(filepaths, options.isReadParallel() ? options.getNumThreads() : 1,
+                         options.isReadParallel() ? 0 : 2);
+    else
+      writeFilesSerial(filepaths);
+    return;
+  }
+
+  for(const QString& filepath : filepaths)
+  {
+    if((aborted = reportBglFile(filepath)) == true)
+    {
+      cancelReadAhead();
+      return;
+    }
+
+    writePooledFile(*readAheadPool, readAheadIndex, filepath);
+    readAheadIndex++;
+  }
+
+  if(readAheadIndex >= readAheadFiles.size())
+  {
+    // All files done - remaining areas not in the manifest use one pool per area
+    cancelReadAhead();
+    readAheadDisabled = true;
+  }
+}
+
+void DataWriter::writePooledFile(BglReaderPool& pool, int poolIndex, const QString& filepath)
+{
+  QString errorMessage;
+  bool error = false;
+
+  // Wait until the file is read by a worker thread
+  const BglFile *bglFile = pool.waitForFile(poolIndex, errorMessage, error);
+
+  if(error)
+    reportFileError(filepath, errorMessage);
+  else
+  {
+    try
+    {
+      writeBglFile(*bglFile);
+    }
+    catch(atools::Exception& e)
+    {
+      reportFileError(filepath, e.what());
+    }
+    catch(...)
+    {
+      reportFileError(filepath, QString());
+    }
+  }
+
+  // Give slot free for the next file
+  pool.release(poolIndex);
+}
+
+void DataWriter::cancelReadAhead()
+{
+  if(readAheadPool != nullptr)
+  {
+    readAheadPool->cancel();
+    delete readAheadPool;
+    readAheadPool = nullptr;
+  }
+  readAheadFiles.clear();
+  readAheadIndex = 0;
+}
+
+bool DataWriter::reportBglFile(const QString& filepath)
+{
+  progressHandler->setNumFiles(numFiles);
+  progressHandler->setNumAirports(airportIdents.size());
+  progressHandler->setNumNamelists(numNamelists);
+  progressHandler->setNumVors(numVors);
+  progressHandler->setNumIls(numIls);
+  progressHandler->setNumNdbs(numNdbs);
+  progressHandler->setNumMarker(numMarker);
+  progressHandler->setNumBoundaries(numBoundaries);
+  progressHandler->setNumWaypoints(numWaypoints);
+  progressHandler->setNumObjectsWritten(numObjectsWritten);
+
+  return progressHandler->reportBglFile(filepath);
+}
+
+void DataWriter::reportFileError(const QString& filepath, const QString& message)
+{
+  if(message.isEmpty())
+    qCritical() << "Caught unknown exception reading" << filepath;
+  else
+    qCritical() << "Caught exception reading" << filepath << ":" << message;
+
+  progressHandler->reportError();
+  if(sceneryErrors != nullptr)
+    sceneryErrors->fileErrors.append({filepath, message, 0});
+}
+
+void DataWriter::registerWriter(WriterBaseBasic *writer)
+{
+  writers.append(writer);
+}
+
+void DataWriter::unregisterWriter(WriterBaseBasic *writer)
+{
+  writers.removeAll(writer);
+}
+
+void DataWriter::flushWriters()
+{
+  for(WriterBaseBasic *writer : writers)
+    writer->flush();
+}
+
+void DataWriter::initIdsFromDatabase()
+{
+  for(WriterBaseBasic *writer : writers)
+    writer->initIdFromDatabase();
+}
+
+void DataWriter::writeBglFile(const BglFile& bglFile)
+{
+  progressHandler->incBytesRead(bglFile.getFilesize());
+
+  if(bglFile.hasContent() && bglFile.isValid())
+  {
+    // if(!bglFile.getHeader().hasValidMagicNumber())
+    // qWarning() << "Content in file with invalid magic number";
+
+    // Write BGL file metadata
+    bglFileWriter->writeOne(bglFile);
+
+    // Clear the indexes
+    runwayIndex->clear();
+    airportIndex->clear();
+
+    // Execution order is important due to dependencies between the writers
+    // (i.e. ILS writer looks for runway end ids)
+    // Writer also need to access the ids of their parent record objects
+    // (i.e. runway needs the current airport ID
+
+    airportWriter->setNameLists(bglFile.getNamelists());
+
+    // Write airport and all subrecords like runways, approaches, parking and so on
+    airportWriter->write(bglFile.getAirports());
+    airportFileWriter->write(bglFile.getAirports());
+
+    // Write all navaids to the database
+    waypointWriter->write(bglFile.getWaypoints());
+    vorWriter->write(bglFile.getVors());
+    tacanWriter->write(bglFile.getTacans());
+    ndbWriter->write(bglFile.getNdbs());
+    markerWriter->write(bglFile.getMarker());
+    ilsWriter->write(bglFile.getIls());
+
+    boundaryWriter->write(bglFile.getBoundaries());
+
+    // Write all batched rows of this file to get errors reported for the right file
+    flushWriters();
+
+    for(const atools::fs::bgl::Airport *ap : bglFile.getAirports())
+      airportIdents.insert(ap->getIdent());
+
+    numNamelists += bglFile.getNamelists().size();
+    numVors += bglFile.getVors().size() + bglFile.getTacans().size();
+    numIls += bglFile.getIls().size();
+    numNdbs += bglFile.getNdbs().size();
+    numMarker += bglFile.getMarker().size();
+    numWaypoints += bglFile.getWaypoints().size();
+    numBoundaries += bglFile.getBoundaries().size();
+    numFiles++;
+  }
+
+  // Print a one line short report on airports that were found in the BGL
+  if(!bglFile.getAirports().isEmpty())
+  {
+    QStringList apIcaos;
+    for(const atools::fs::bgl::Airport *ap : bglFile.getAirports())
+    {
+      // Truncate at 10
+      if(apIcaos.size() < 10)
+        apIcaos.append(ap->getIdent());
+      else
+        break;
+    }
+    if(bglFile.getAirports().size() > 10)
+      apIcaos.append("...");
+    qDebug() << "Found" << bglFile.getAirports().size() << "airports. idents:" << apIcaos.join(",");
   }
 }
 
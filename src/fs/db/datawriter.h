@@ -21,8 +21,12 @@
 #include <QList>
 #include <QSet>
 #include <QString>
+#include <QStringList>
+#include <QVector>
 
 #include "fs/navdatabaseerrors.h"
+#include "fs/db/idallocator.h"
+#include "fs/db/tablestatistics.h"
 
 namespace atools {
 namespace sql {
@@ -39,11 +43,16 @@ class MagDecReader;
 }
 namespace scenery {
 class SceneryArea;
+class FileManifest;
+}
+namespace bgl {
+class BglFile;
 }
 class ProgressHandler;
 
 namespace db {
 
+class BglReaderPool;
 class BglFileWriter;
 class SceneryAreaWriter;
 class AirportWriter;
@@ -68,11 +77,13 @@ class StartWriter;
 class HelipadWriter;
 class RunwayIndex;
 class DbAirportIndex;
+class NavDuplicateIndex;
 class ApronWriter;
 class ApronLightWriter;
 class FenceWriter;
 class TaxiPathWriter;
 class BoundaryWriter;
+class WriterBaseBasic;
 
 /*
  * Keeps all writer objects and calls them in order to write BGL records to the database.
@@ -101,6 +112,17 @@ public:
     numObjectsWritten++;
   }
 
+  /* Writers add themselves on construction to allow flushing of pending batched inserts */
+  void registerWriter(atools::fs::db::WriterBaseBasic *writer);
+  void unregisterWriter(atools::fs::db::WriterBaseBasic *writer);
+
+  /* Write all pending batched rows of all writers to the database. Has to be called before the
+   * database content is read or a BGL file is finished. */
+  void flushWriters();
+
+  /* Continue the ids of all writers after the rows in the database when resuming an aborted compilation */
+  void initIdsFromDatabase();
+
   /*
    * @return true if the progress callback reported an abort (i.e. Cancel button pressed)
    */
@@ -125,6 +147,31 @@ public:
     return runwayIndex;
   }
 
+  /* Id sequences of all writers for this database */
+  atools::fs::db::IdAllocator& getIdAllocator()
+  {
+    return idAllocator;
+  }
+
+  /* Rows and coordinate ranges collected by all writers */
+  atools::fs::db::TableStatistics& getTableStatistics()
+  {
+    return tableStatistics;
+  }
+
+  const atools::fs::db::TableStatistics& getTableStatistics() const
+  {
+    return tableStatistics;
+  }
+
+  /*
+   * @return index for duplicate navaids or null if option deduplicate on write is not set
+   */
+  NavDuplicateIndex *getNavDuplicateIndex()
+  {
+    return navDuplicateIndex;
+  }
+
   /*
    * @return configuration options for the scenery library compiler
    */
@@ -251,12 +298,50 @@ public:
     sceneryErrors = errors;
   }
 
+  /* Use already resolved files from the manifest instead of scanning the scenery directories again.
+   * Areas not contained in the manifest are still resolved. Manifest is not owned. */
+  void setFileManifest(const atools::fs::scenery::FileManifest *manifest)
+  {
+    fileManifest = manifest;
+  }
+
+  /* true: commit at the end of each scenery area. Default is true.
+   * Disabled for checkpoints which commit the area rows together with the checkpoint. */
+  void setCommitAreas(bool value)
+  {
+    commitAreas = value;
+  }
+
   /* Close all writers and queries */
   void close();
 
   float getMagVar(const atools::geo::Pos & pos, float defaultValue) const;
 
 private:
+  /* Read and write files one by one */
+  void writeFilesSerial(const QStringList& filepaths);
+
+  /* Read files in a thread pool and write them in list order. numSlots limits the files read in advance
+   * and defaults to twice the number of threads. */
+  void writeFilesParallel(const QStringList& filepaths, int numThreads, int numSlots = 0);
+
+  /* Write files of an area using one pool reading all files of the manifest. This allows to read ahead
+   * across area boundaries. Falls back to writeFilesParallel if the area files do not match the manifest order. */
+  void writeFilesReadAhead(const QStringList& filepaths);
+
+  /* Wait for file at poolIndex in the pool, write it and release the slot */
+  void writePooledFile(atools::fs::db::BglReaderPool& pool, int poolIndex, const QString& filepath);
+
+  /* Stop and delete the read ahead pool */
+  void cancelReadAhead();
+
+  /* Write all content of the file object tree to the database */
+  void writeBglFile(const atools::fs::bgl::BglFile& bglFile);
+
+  /* Update numbers and report progress. Returns true if aborted. */
+  bool reportBglFile(const QString& filepath);
+  void reportFileError(const QString& filepath, const QString& message);
+
   int numFiles = 0, numNamelists = 0, numVors = 0, numIls = 0,
       numNdbs = 0, numMarker = 0, numWaypoints = 0, numBoundaries = 0, numObjectsWritten = 0;
   bool aborted = false;
@@ -266,6 +351,16 @@ private:
   atools::sql::SqlDatabase& db;
   atools::fs::ProgressHandler *progressHandler = nullptr;
   atools::fs::NavDatabaseErrors::SceneryErrors *sceneryErrors = nullptr;
+  const atools::fs::scenery::FileManifest *fileManifest = nullptr;
+
+  /* Reads all files of the manifest in the order of areas */
+  atools::fs::db::BglReaderPool *readAheadPool = nullptr;
+  QStringList readAheadFiles;
+  int readAheadIndex = 0;
+  bool readAheadDisabled = false, commitAreas = true;
+
+  /* All writers in order of creation */
+  QVector<atools::fs::db::WriterBaseBasic *> writers;
 
   atools::fs::db::BglFileWriter *bglFileWriter = nullptr;
   atools::fs::db::SceneryAreaWriter *sceneryAreaWriter = nullptr;
@@ -301,8 +396,13 @@ private:
 
   atools::fs::db::BoundaryWriter *boundaryWriter = nullptr;
 
+  /* Id sequences of all writers - not shared with other databases */
+  atools::fs::db::IdAllocator idAllocator;
+  atools::fs::db::TableStatistics tableStatistics;
+
   atools::fs::db::RunwayIndex *runwayIndex = nullptr;
   atools::fs::db::DbAirportIndex *airportIndex = nullptr;
+  atools::fs::db::NavDuplicateIndex *navDuplicateIndex = nullptr;
   atools::fs::common::MagDecReader *magDecReader = nullptr;
 
   const atools::fs::NavDatabaseOptions& options;
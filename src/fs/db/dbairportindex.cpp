@@ -25,14 +25,14 @@ namespace db {
 
 void DbAirportIndex::add(const QString& airportIdent, int airportId)
 {
-  airportIndexMap[airportIdent] = airportId;
+  airportIndexMap.insert(atools::fs::common::IndexName(airportIdent), airportId);
 }
 
 int DbAirportIndex::getAirportId(const QString& airportIdent, const QString& sourceObject)
 {
-  AirportIndexTypeConstIter it = airportIndexMap.find(airportIdent);
-  if(it != airportIndexMap.end())
-    return it.value();
+  const int *id = airportIndexMap.find(atools::fs::common::IndexName(airportIdent));
+  if(id != nullptr)
+    return *id;
   else
   {
     qWarning().nospace().noquote() << "Airport ID for ident " << airportIdent << " not found for " <<
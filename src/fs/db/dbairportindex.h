@@ -18,7 +18,7 @@
 #ifndef ATOOLS_FS_DB_AIRPORTINDEX_H
 #define ATOOLS_FS_DB_AIRPORTINDEX_H
 
-#include <QHash>
+#include "fs/common/airportindex.h"
 
 namespace atools {
 namespace fs {
@@ -26,7 +26,7 @@ namespace db {
 
 /*
  * Index that maps airport idents airport IDs. This used for each BGL file and does not cross
- * the file boundary.
+ * the file boundary. Idents are limited to ten Latin-1 characters.
  */
 class DbAirportIndex
 {
@@ -58,8 +58,7 @@ public:
   }
 
 private:
-  typedef QHash<QString, int> AirportIndexType;
-  typedef atools::fs::db::DbAirportIndex::AirportIndexType::const_iterator AirportIndexTypeConstIter;
+  typedef atools::util::FlatHash<atools::fs::common::IndexName, int> AirportIndexType;
 
   atools::fs::db::DbAirportIndex::AirportIndexType airportIndexMap;
 };
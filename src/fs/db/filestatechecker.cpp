@@ -0,0 +1,175 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/filestatechecker.h"
+
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlutil.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+using atools::sql::SqlQuery;
+using atools::sql::SqlUtil;
+
+/* Key of the options row. Cannot clash with an absolute file path. */
+static const QLatin1String OPTIONS_KEY("::options");
+
+FileStateChecker::FileStateChecker(atools::sql::SqlDatabase *sqlDb, bool useHash)
+  : db(sqlDb), hash(useHash)
+{
+}
+
+bool FileStateChecker::loadPrevious()
+{
+  previousStates.clear();
+  previousLoaded = false;
+
+  if(SqlUtil(db).hasTable("bgl_file_state"))
+  {
+    SqlQuery query(db);
+    query.exec("select filepath, size, file_modification_time, hash from bgl_file_state");
+    while(query.next())
+    {
+      FileState state;
+      state.size = query.value("size").toLongLong();
+      state.modificationTime = query.value("file_modification_time").toLongLong();
+      state.hash = query.value("hash").toByteArray();
+      previousStates.insert(query.value("filepath").toString(), state);
+    }
+    query.finish();
+
+    // An empty table is left from an old or aborted compilation
+    previousLoaded = !previousStates.isEmpty();
+  }
+
+  qDebug() << Q_FUNC_INFO << "Loaded" << previousStates.size() << "file states";
+  return previousLoaded;
+}
+
+void FileStateChecker::addCurrent(const QString& filepath)
+{
+  QFileInfo fi(filepath);
+
+  FileState state;
+  state.size = fi.size();
+  state.modificationTime = fi.lastModified().toMSecsSinceEpoch() / 1000;
+
+  if(hash)
+  {
+    QFile file(filepath);
+    if(file.open(QIODevice::ReadOnly))
+    {
+      QCryptographicHash md5(QCryptographicHash::Md5);
+      if(md5.addData(&file))
+        state.hash = md5.result();
+      file.close();
+    }
+    else
+      qWarning() << Q_FUNC_INFO << "Cannot open" << filepath << file.errorString();
+  }
+
+  currentStates.insert(QDir::toNativeSeparators(fi.absoluteFilePath()), state);
+}
+
+void FileStateChecker::addCurrent(const QStringList& filepaths)
+{
+  for(const QString& filepath : filepaths)
+    addCurrent(filepath);
+}
+
+void FileStateChecker::addOptions(const QString& optionsHash)
+{
+  FileState state;
+  state.hash = optionsHash.toLatin1();
+  currentStates.insert(OPTIONS_KEY, state);
+}
+
+bool FileStateChecker::isEqual(const QString& key, const FileState& previous, const FileState& current) const
+{
+  if(key == OPTIONS_KEY)
+    // Options hash is always compared
+    return previous.hash == current.hash;
+
+  if(previous.size != current.size || previous.modificationTime != current.modificationTime)
+    return false;
+
+  // Compare hash only if available for both
+  if(hash && !previous.hash.isEmpty() && !current.hash.isEmpty())
+    return previous.hash == current.hash;
+
+  return true;
+}
+
+QStringList FileStateChecker::getChangedFiles() const
+{
+  QStringList changed;
+
+  // Added or changed files
+  for(auto it = currentStates.constBegin(); it != currentStates.constEnd(); ++it)
+  {
+    auto prev = previousStates.constFind(it.key());
+    if(prev == previousStates.constEnd() || !isEqual(it.key(), prev.value(), it.value()))
+      changed.append(it.key());
+  }
+
+  // Removed files
+  for(auto it = previousStates.constBegin(); it != previousStates.constEnd(); ++it)
+  {
+    if(!currentStates.contains(it.key()))
+      changed.append(it.key());
+  }
+
+  return changed;
+}
+
+bool FileStateChecker::isUnchanged() const
+{
+  return previousLoaded && getChangedFiles().isEmpty();
+}
+
+void FileStateChecker::writeCurrent()
+{
+  SqlQuery query(db);
+  query.exec("delete from bgl_file_state");
+
+  query.prepare("insert into bgl_file_state (filepath, size, file_modification_time, hash) "
+                "values(:filepath, :size, :time, :hash)");
+
+  for(auto it = currentStates.constBegin(); it != currentStates.constEnd(); ++it)
+  {
+    query.bindValue(":filepath", it.key());
+    query.bindValue(":size", it.value().size);
+    query.bindValue(":time", it.value().modificationTime);
+    query.bindValue(":hash", it.value().hash.isEmpty() ? QVariant(QVariant::ByteArray) : it.value().hash);
+    query.exec();
+  }
+  db->commit();
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,92 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_FILESTATECHECKER_H
+#define ATOOLS_FS_DB_FILESTATECHECKER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QStringList>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace db {
+
+/*
+ * Detects changes of scenery files between two compilations for the incremental mode.
+ * Size, modification time and optionally a MD5 hash of every scenery file that was scanned
+ * are stored in the table "bgl_file_state" at the end of a successful compilation.
+ *
+ * Files without any content are included too since these are not written to "bgl_file".
+ * A hash of the compilation options is stored in an additional row since options and filters change the result too.
+ */
+class FileStateChecker
+{
+public:
+  /*
+   * @param sqlDb Database containing the state of the last compilation
+   * @param useHash Calculate a content hash for each file additionally
+   */
+  FileStateChecker(atools::sql::SqlDatabase *sqlDb, bool useHash);
+
+  /* Load state of the last compilation. Has to be called before the schema is dropped.
+   * @return false if there is no previous state or the table does not exist */
+  bool loadPrevious();
+
+  /* Add a file of the current compilation */
+  void addCurrent(const QString& filepath);
+  void addCurrent(const QStringList& filepaths);
+
+  /* Add a hash identifying all options and filters which change the result of the current compilation */
+  void addOptions(const QString& optionsHash);
+
+  /* Files that are new or have changed since the last compilation and files that were removed */
+  QStringList getChangedFiles() const;
+
+  /* true if previous state was loaded and no file was added, removed or changed */
+  bool isUnchanged() const;
+
+  /* Write current state into table "bgl_file_state". Call after successful compilation. */
+  void writeCurrent();
+
+private:
+  struct FileState
+  {
+    qint64 size = 0;
+    qint64 modificationTime = 0;
+    QByteArray hash;
+  };
+
+  bool isEqual(const QString& key, const FileState& previous, const FileState& current) const;
+
+  atools::sql::SqlDatabase *db;
+  bool hash;
+  bool previousLoaded = false;
+
+  /* Key is the native absolute file path */
+  QHash<QString, FileState> previousStates, currentStates;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_FILESTATECHECKER_H
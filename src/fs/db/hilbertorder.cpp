@@ -0,0 +1,134 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/hilbertorder.h"
+
+#include "fs/db/idallocator.h"
+#include "sql/sqlbatch.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+/* Number of cells in each direction for the curve */
+static const quint32 HILBERT_SIZE = 1 << 16;
+
+HilbertOrder::HilbertOrder(sql::SqlDatabase *sqlDb)
+  : db(sqlDb)
+{
+}
+
+quint32 HilbertOrder::index(float lonx, float laty)
+{
+  quint32 x = static_cast<quint32>(std::min(std::max((lonx + 180.f) / 360.f, 0.f), 1.f) * (HILBERT_SIZE - 1));
+  quint32 y = static_cast<quint32>(std::min(std::max((laty + 90.f) / 180.f, 0.f), 1.f) * (HILBERT_SIZE - 1));
+
+  quint32 d = 0;
+  for(quint32 s = HILBERT_SIZE / 2; s > 0; s /= 2)
+  {
+    quint32 rx = (x & s) > 0 ? 1 : 0;
+    quint32 ry = (y & s) > 0 ? 1 : 0;
+    d += s * s * ((3 * rx) ^ ry);
+
+    // Rotate quadrant
+    if(ry == 0)
+    {
+      if(rx == 1)
+      {
+        x = HILBERT_SIZE - 1 - x;
+        y = HILBERT_SIZE - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+void HilbertOrder::run()
+{
+  QElapsedTimer timer;
+  timer.start();
+  numRows = 0;
+
+  reorderTable("airport", "lonx", "laty");
+  reorderTable("waypoint", "lonx", "laty");
+  reorderTable("vor", "lonx", "laty");
+  reorderTable("ndb", "lonx", "laty");
+  reorderTable("parking", "lonx", "laty");
+  reorderTable("boundary", "(min_lonx + max_lonx) / 2", "(min_laty + max_laty) / 2");
+  db->commit();
+
+  qInfo() << Q_FUNC_INFO << "Renumbered" << numRows << "rows in" << timer.elapsed() << "ms";
+}
+
+void HilbertOrder::reorderTable(const QString& table, const QString& lonxExpr, const QString& latyExpr)
+{
+  QString idCol = table + "_id";
+
+  db->exec("drop table if exists temp.hilbert_key");
+  db->exec("create temporary table hilbert_key (id integer primary key, hilbert integer not null)");
+
+  // Calculate curve position for each row
+  sql::SqlQuery insertQuery(db);
+  insertQuery.prepare("insert into hilbert_key (id, hilbert) values(:id, :hilbert)");
+  sql::SqlBatch batch(&insertQuery);
+
+  sql::SqlQuery query(db);
+  query.setForwardOnly(true);
+  query.exec("select " + idCol + ", " + lonxExpr + ", " + latyExpr + " from " + table);
+  while(query.next())
+  {
+    batch.bindValue(":id", query.value(0));
+    batch.bindValue(":hilbert", index(query.value(1).toFloat(), query.value(2).toFloat()));
+    batch.addRow();
+  }
+  batch.exec();
+
+  // Keep load order for equal positions
+  QString orderBy = "(select hilbert from hilbert_key where hilbert_key.id = " + table + "." + idCol + "), " + idCol;
+  atools::fs::db::IdAllocator::renumber(*db, table, idCol, references(table), orderBy);
+  numRows += batch.getNumExecuted();
+
+  db->exec("drop table if exists temp.hilbert_key");
+}
+
+QVector<QPair<QString, QString> > HilbertOrder::references(const QString& table) const
+{
+  QVector<QPair<QString, QString> > refs;
+  for(const QString& name : db->tables())
+  {
+    sql::SqlQuery query(db);
+    query.exec("pragma foreign_key_list(" + name + ")");
+    while(query.next())
+    {
+      if(query.value("table").toString().compare(table, Qt::CaseInsensitive) == 0)
+        refs.append(qMakePair(name, query.value("from").toString()));
+    }
+  }
+  return refs;
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,74 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_HILBERTORDER_H
+#define ATOOLS_FS_DB_HILBERTORDER_H
+
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace db {
+
+/*
+ * Renumbers the rows of the spatial tables airport, waypoint, vor, ndb, parking and boundary in Hilbert curve
+ * order of their coordinates. SQLite stores rows in order of the primary key which means that objects
+ * close together on the map are also close together in the database file after the next VACUUM or
+ * compact export.
+ *
+ * All columns referencing the renumbered ids by foreign key are updated using IdAllocator::renumber().
+ * Has to run before waypoint.nav_id is set and before derived tables like nav_search or the routing
+ * tables are filled.
+ */
+class HilbertOrder
+{
+public:
+  HilbertOrder(atools::sql::SqlDatabase *sqlDb);
+
+  /* Renumber all tables and commit. Throws SqlException in case of error. */
+  void run();
+
+  /* Position on a Hilbert curve of order 16 covering the whole world */
+  static quint32 index(float lonx, float laty);
+
+  /* Number of rows renumbered */
+  int getNumRows() const
+  {
+    return numRows;
+  }
+
+private:
+  void reorderTable(const QString& table, const QString& lonxExpr, const QString& latyExpr);
+
+  /* Table and column of all foreign keys in the database pointing to table */
+  QVector<QPair<QString, QString> > references(const QString& table) const;
+
+  atools::sql::SqlDatabase *db;
+  int numRows = 0;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_HILBERTORDER_H
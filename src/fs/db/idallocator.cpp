@@ -0,0 +1,93 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/idallocator.h"
+
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QDebug>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+using atools::sql::SqlQuery;
+
+IdAllocator::IdAllocator()
+{
+}
+
+IdAllocator::~IdAllocator()
+{
+  qDeleteAll(sequences);
+}
+
+IdSequence *IdAllocator::getSequence(const QString& name)
+{
+  QMutexLocker locker(&mutex);
+  IdSequence *sequence = sequences.value(name, nullptr);
+  if(sequence == nullptr)
+  {
+    sequence = new IdSequence;
+    sequences.insert(name, sequence);
+  }
+  return sequence;
+}
+
+void IdAllocator::reset()
+{
+  QMutexLocker locker(&mutex);
+  for(IdSequence *sequence : sequences)
+    sequence->reset();
+}
+
+int IdAllocator::renumber(atools::sql::SqlDatabase& db, const QString& table, const QString& idColumn,
+                          const QVector<QPair<QString, QString> >& references, const QString& orderBy)
+{
+  SqlQuery query(db);
+  query.exec("drop table if exists temp.id_map");
+  query.exec("create temporary table id_map (new_id integer primary key, old_id integer not null unique)");
+  query.exec(QString("insert into id_map (old_id) select %1 from %2 order by %3").
+             arg(idColumn).arg(table).arg(orderBy.isEmpty() ? idColumn : orderBy));
+  int numRows = query.numRowsAffected();
+
+  // Count rows which get a new id
+  query.exec("select count(1) from id_map where new_id <> old_id");
+  int changed = query.next() ? query.valueInt(0) : 0;
+
+  if(changed > 0)
+  {
+    for(const QPair<QString, QString>& ref : references)
+      query.exec(QString("update %1 set %2 = (select new_id from id_map where old_id = %1.%2) "
+                         "where %2 is not null").arg(ref.first).arg(ref.second));
+
+    // Negate first - avoids conflicts of old and new ids in the primary key while updating
+    query.exec(QString("update %1 set %2 = -%2").arg(table).arg(idColumn));
+    query.exec(QString("update %1 set %2 = (select new_id from id_map where old_id = -%1.%2)").
+               arg(table).arg(idColumn));
+  }
+
+  query.exec("drop table if exists temp.id_map");
+
+  qInfo() << Q_FUNC_INFO << table << "rows" << numRows << "renumbered" << changed;
+  return changed;
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,148 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_IDALLOCATOR_H
+#define ATOOLS_FS_DB_IDALLOCATOR_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QVector>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+namespace fs {
+namespace db {
+
+/*
+ * Range of ids reserved for one worker or shard. Ids are handed out without any locking.
+ */
+class IdRange
+{
+public:
+  IdRange()
+  {
+  }
+
+  IdRange(int firstId, int lastId)
+    : first(firstId), last(lastId), nextId(firstId)
+  {
+  }
+
+  /* Next id or -1 if the range is exhausted */
+  int next()
+  {
+    return nextId <= last ? nextId++ : -1;
+  }
+
+  bool isExhausted() const
+  {
+    return nextId > last;
+  }
+
+  int getFirst() const
+  {
+    return first;
+  }
+
+  int getLast() const
+  {
+    return last;
+  }
+
+private:
+  int first = 0, last = -1, nextId = 0;
+};
+
+/*
+ * Thread safe id sequence for one table. Ids start at 1.
+ */
+class IdSequence
+{
+public:
+  /* Increase id and return it */
+  int next()
+  {
+    return counter.fetchAndAddOrdered(1) + 1;
+  }
+
+  /* Last id returned by next() or the last id of the last reserved range */
+  int getCurrent() const
+  {
+    return counter.loadAcquire();
+  }
+
+  /* Reserve count consecutive ids which are not returned by next() or other ranges */
+  atools::fs::db::IdRange reserve(int count)
+  {
+    int last = counter.fetchAndAddOrdered(count) + count;
+    return IdRange(last - count + 1, last);
+  }
+
+  /* Start again. The next id will be value + 1. */
+  void reset(int value = 0)
+  {
+    counter.storeRelease(value);
+  }
+
+private:
+  QAtomicInt counter = 0;
+};
+
+/*
+ * Keeps the id sequences for all writers of one database. Owned by the DataWriter which makes compiling
+ * several databases in one process independent of each other.
+ *
+ * Parallel writers can reserve disjoint ranges which leaves gaps in the ids. These can be closed by renumber().
+ */
+class IdAllocator
+{
+public:
+  IdAllocator();
+  ~IdAllocator();
+
+  IdAllocator(const IdAllocator& other) = delete;
+  IdAllocator& operator=(const IdAllocator& other) = delete;
+
+  /* Get sequence by name. Created on first access and valid as long as the allocator. Thread safe. */
+  atools::fs::db::IdSequence *getSequence(const QString& name);
+
+  /* Start all sequences at 1 again */
+  void reset();
+
+  /*
+   * Optional deterministic renumbering after parallel writing. Assigns dense ids starting at 1 in order of
+   * the old ids to idColumn of table and updates all referencing columns given as table/column pairs.
+   * orderBy is an optional SQL order expression on the columns of table replacing the old id order.
+   * Returns the number of renumbered rows. Throws SqlException on error.
+   */
+  static int renumber(atools::sql::SqlDatabase& db, const QString& table, const QString& idColumn,
+                      const QVector<QPair<QString, QString> >& references, const QString& orderBy = QString());
+
+private:
+  QHash<QString, atools::fs::db::IdSequence *> sequences;
+  QMutex mutex;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_IDALLOCATOR_H
@@ -0,0 +1,371 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/maptiles.h"
+
+#include "fs/common/binarygeometry.h"
+#include "geo/calculations.h"
+#include "geo/rect.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlscript.h"
+#include "sql/sqlutil.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+
+#include <cmath>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+/* Web Mercator latitude limit */
+static const double MAX_LAT = 85.05112878;
+
+/* Simplification tolerance is one pixel of a 256 pixel tile */
+static const double SIMPLIFY_TOLERANCE = MAP_TILE_EXTENT / 256.;
+
+/* Lowest zoom for navaids and airways */
+static const int MIN_ZOOM_AIRWAY = 6;
+
+static inline quint64 tileId(int zoom, int x, int y)
+{
+  return (static_cast<quint64>(zoom) << 48) | (static_cast<quint64>(x) << 24) | static_cast<quint64>(y);
+}
+
+/* Normalized web mercator coordinates 0 to 1 */
+static QPointF toMercator(double lonx, double laty)
+{
+  double siny = std::sin(atools::geo::toRadians(std::min(std::max(laty, -MAX_LAT), MAX_LAT)));
+  return QPointF((lonx + 180.) / 360., 0.5 - std::log((1. + siny) / (1. - siny)) / (4. * M_PI));
+}
+
+static double mercatorToLat(double y)
+{
+  return atools::geo::toDegree(std::atan(std::sinh(M_PI * (1. - 2. * y))));
+}
+
+/* Iterative Douglas-Peucker simplification */
+static void simplifyLine(QVector<QPointF>& points, double tolerance)
+{
+  if(points.size() < 3)
+    return;
+
+  QVector<bool> keep(points.size(), false);
+  keep.first() = keep.last() = true;
+
+  QVector<std::pair<int, int> > stack;
+  stack.append(std::make_pair(0, points.size() - 1));
+  while(!stack.isEmpty())
+  {
+    std::pair<int, int> range = stack.takeLast();
+    const QPointF& p1 = points.at(range.first);
+    const QPointF& p2 = points.at(range.second);
+    double dx = p2.x() - p1.x(), dy = p2.y() - p1.y();
+    double len = std::sqrt(dx * dx + dy * dy);
+
+    int maxIndex = -1;
+    double maxDist = tolerance;
+    for(int i = range.first + 1; i < range.second; i++)
+    {
+      const QPointF& p = points.at(i);
+      double dist = len > 0. ? std::abs(dy * p.x() - dx * p.y() + p2.x() * p1.y() - p2.y() * p1.x()) / len :
+                    std::hypot(p.x() - p1.x(), p.y() - p1.y());
+      if(dist > maxDist)
+      {
+        maxDist = dist;
+        maxIndex = i;
+      }
+    }
+
+    if(maxIndex != -1)
+    {
+      keep[maxIndex] = true;
+      stack.append(std::make_pair(range.first, maxIndex));
+      stack.append(std::make_pair(maxIndex, range.second));
+    }
+  }
+
+  QVector<QPointF> simplified;
+  for(int i = 0; i < points.size(); i++)
+    if(keep.at(i))
+      simplified.append(points.at(i));
+  points.swap(simplified);
+}
+
+// =====================================================================================
+MapTileKey MapTileKey::fromPos(int zoom, const geo::Pos& pos)
+{
+  int num = 1 << zoom;
+  QPointF merc = toMercator(pos.getLonX(), pos.getLatY());
+  return {zoom, std::min(std::max(static_cast<int>(merc.x() * num), 0), num - 1),
+          std::min(std::max(static_cast<int>(merc.y() * num), 0), num - 1)};
+}
+
+geo::Rect MapTileKey::getRect() const
+{
+  double num = 1 << zoom;
+  return atools::geo::Rect(x / num * 360. - 180., mercatorToLat(y / num), (x + 1) / num * 360. - 180.,
+                           mercatorToLat((y + 1) / num));
+}
+
+// =====================================================================================
+MapTileWriter::MapTileWriter(sql::SqlDatabase *sqlDb, int maxZoomLevel)
+  : db(sqlDb), maxZoom(std::min(std::max(maxZoomLevel, 0), 12))
+{
+}
+
+void MapTileWriter::write()
+{
+  QElapsedTimer timer;
+  timer.start();
+  numTiles = 0;
+
+  sql::SqlScript script(db, true);
+  script.executeScript(":/atools/resources/sql/fs/db/create_map_tile_schema.sql");
+
+  QVector<SourceFeature> features;
+  loadPoints(features, TILE_AIRPORT,
+             "select airport_id, ident, lonx, laty, "
+             "case when longest_runway_length > 8000 and num_runway_hard > 0 then 0 "
+             "when longest_runway_length > 4000 then 4 else 6 end from airport");
+  loadPoints(features, TILE_VOR, "select vor_id, ident, lonx, laty, 5 from vor");
+  loadPoints(features, TILE_NDB, "select ndb_id, ident, lonx, laty, 6 from ndb");
+  loadAirways(features);
+  loadBoundaries(features);
+
+  sql::SqlQuery insertQuery(db);
+  insertQuery.prepare("insert into map_tile (zoom, x, y, data) values(:zoom, :x, :y, :data)");
+  for(int zoom = 0; zoom <= maxZoom; zoom++)
+    writeZoom(features, zoom, insertQuery);
+  db->commit();
+
+  qInfo() << Q_FUNC_INFO << "Wrote" << numTiles << "tiles for" << features.size() << "features up to zoom"
+          << maxZoom << "in" << timer.elapsed() << "ms";
+}
+
+void MapTileWriter::loadPoints(QVector<SourceFeature>& features, MapTileLayer layer, const QString& queryStr)
+{
+  sql::SqlQuery query(db);
+  query.setForwardOnly(true);
+  query.exec(queryStr);
+  while(query.next())
+    features.append({layer, query.valueInt(0), query.valueInt(4), query.valueStr(1),
+                     {QPointF(query.valueDouble(2), query.valueDouble(3))}});
+}
+
+void MapTileWriter::loadAirways(QVector<SourceFeature>& features)
+{
+  sql::SqlQuery query(db);
+  query.setForwardOnly(true);
+  query.exec("select airway_id, airway_name, from_lonx, from_laty, to_lonx, to_laty from airway");
+  while(query.next())
+    features.append({TILE_AIRWAY, query.valueInt(0), MIN_ZOOM_AIRWAY, query.valueStr(1),
+                     {QPointF(query.valueDouble(2), query.valueDouble(3)),
+                      QPointF(query.valueDouble(4), query.valueDouble(5))}});
+}
+
+void MapTileWriter::loadBoundaries(QVector<SourceFeature>& features)
+{
+  sql::SqlQuery query(db);
+  query.setForwardOnly(true);
+  query.exec("select boundary_id, name, geometry from boundary");
+  while(query.next())
+  {
+    atools::fs::common::BinaryGeometry geometry(query.value(2).toByteArray());
+    SourceFeature feature = {TILE_BOUNDARY, query.valueInt(0), 0, query.valueStr(1), QVector<QPointF>()};
+    for(const atools::geo::Pos& pos : geometry.getGeometry())
+      feature.lonLat.append(QPointF(pos.getLonX(), pos.getLatY()));
+    features.append(feature);
+  }
+}
+
+void MapTileWriter::writeZoom(const QVector<SourceFeature>& features, int zoom, sql::SqlQuery& insertQuery)
+{
+  int num = 1 << zoom;
+  double worldSize = static_cast<double>(num) * MAP_TILE_EXTENT;
+  QHash<quint64, QVector<MapTileFeature> > tiles;
+
+  for(const SourceFeature& source : features)
+  {
+    if(source.minZoom > zoom)
+      continue;
+
+    // Project into world coordinates and split where lines cross the anti-meridian
+    QVector<QVector<QPointF> > parts(1);
+    for(const QPointF& lonLat : source.lonLat)
+    {
+      QPointF merc = toMercator(lonLat.x(), lonLat.y()) * worldSize;
+      if(!parts.last().isEmpty() && std::abs(parts.last().last().x() - merc.x()) > worldSize / 2.)
+        parts.append(QVector<QPointF>());
+      parts.last().append(merc);
+    }
+
+    for(QVector<QPointF>& part : parts)
+    {
+      simplifyLine(part, SIMPLIFY_TOLERANCE);
+
+      // Add to all tiles touched by the bounding rectangle
+      double minX = worldSize, minY = worldSize, maxX = 0., maxY = 0.;
+      for(const QPointF& p : part)
+      {
+        minX = std::min(minX, p.x());
+        minY = std::min(minY, p.y());
+        maxX = std::max(maxX, p.x());
+        maxY = std::max(maxY, p.y());
+      }
+
+      int tileMinX = std::max(static_cast<int>(minX / MAP_TILE_EXTENT), 0);
+      int tileMaxX = std::min(static_cast<int>(maxX / MAP_TILE_EXTENT), num - 1);
+      int tileMinY = std::max(static_cast<int>(minY / MAP_TILE_EXTENT), 0);
+      int tileMaxY = std::min(static_cast<int>(maxY / MAP_TILE_EXTENT), num - 1);
+
+      for(int tileY = tileMinY; tileY <= tileMaxY; tileY++)
+      {
+        for(int tileX = tileMinX; tileX <= tileMaxX; tileX++)
+        {
+          MapTileFeature feature = {source.layer, source.id, source.ident, QVector<QPoint>()};
+          feature.points.reserve(part.size());
+          for(const QPointF& p : part)
+          {
+            QPoint tilePoint(qRound(p.x() - tileX * MAP_TILE_EXTENT), qRound(p.y() - tileY * MAP_TILE_EXTENT));
+            if(feature.points.isEmpty() || feature.points.last() != tilePoint)
+              feature.points.append(tilePoint);
+          }
+          tiles[tileId(zoom, tileX, tileY)].append(feature);
+        }
+      }
+    }
+  }
+
+  for(auto it = tiles.constBegin(); it != tiles.constEnd(); ++it)
+  {
+    insertQuery.bindValue(":zoom", zoom);
+    insertQuery.bindValue(":x", static_cast<int>((it.key() >> 24) & 0xffffff));
+    insertQuery.bindValue(":y", static_cast<int>(it.key() & 0xffffff));
+    insertQuery.bindValue(":data", MapTileReader::writeTile(it.value()));
+    insertQuery.exec();
+    numTiles++;
+  }
+}
+
+// =====================================================================================
+MapTileReader::MapTileReader(sql::SqlDatabase *sqlDb, int cacheSize)
+  : db(sqlDb), cache(cacheSize)
+{
+}
+
+bool MapTileReader::hasTiles() const
+{
+  return sql::SqlUtil(db).hasTableAndRows("map_tile");
+}
+
+int MapTileReader::getMaxZoom() const
+{
+  sql::SqlQuery query(db);
+  query.exec("select max(zoom) from map_tile");
+  if(query.next() && !query.isNull(0))
+    return query.valueInt(0);
+  return -1;
+}
+
+QVector<MapTileFeature> MapTileReader::getTile(const MapTileKey& key)
+{
+  quint64 id = tileId(key.zoom, key.x, key.y);
+  QVector<MapTileFeature> *cached = cache.object(id);
+  if(cached != nullptr)
+    return *cached;
+
+  QVector<MapTileFeature> features;
+  sql::SqlQuery query(db);
+  query.prepare("select data from map_tile where zoom = :zoom and x = :x and y = :y");
+  query.bindValue(":zoom", key.zoom);
+  query.bindValue(":x", key.x);
+  query.bindValue(":y", key.y);
+  query.exec();
+  if(query.next())
+    features = readTile(query.value(0).toByteArray());
+
+  cache.insert(id, new QVector<MapTileFeature>(features));
+  return features;
+}
+
+QByteArray MapTileReader::writeTile(const QVector<MapTileFeature>& features)
+{
+  QByteArray bytes;
+  QDataStream out(&bytes, QIODevice::WriteOnly);
+  out.setVersion(QDataStream::Qt_5_5);
+
+  out << static_cast<quint32>(features.size());
+  for(const MapTileFeature& feature : features)
+  {
+    out << static_cast<quint8>(feature.layer) << static_cast<qint32>(feature.id) << feature.ident
+        << static_cast<quint32>(feature.points.size());
+
+    // Delta encoded to improve compression
+    QPoint last;
+    for(const QPoint& point : feature.points)
+    {
+      out << static_cast<qint32>(point.x() - last.x()) << static_cast<qint32>(point.y() - last.y());
+      last = point;
+    }
+  }
+  return qCompress(bytes);
+}
+
+QVector<MapTileFeature> MapTileReader::readTile(const QByteArray& bytes)
+{
+  QVector<MapTileFeature> features;
+  QByteArray data = qUncompress(bytes);
+  QDataStream in(data);
+  in.setVersion(QDataStream::Qt_5_5);
+
+  quint32 numFeatures;
+  in >> numFeatures;
+  features.reserve(static_cast<int>(numFeatures));
+  for(quint32 i = 0; i < numFeatures && in.status() == QDataStream::Ok; i++)
+  {
+    quint8 layer;
+    qint32 id, x, y;
+    quint32 numPoints;
+    MapTileFeature feature;
+    in >> layer >> id >> feature.ident >> numPoints;
+    feature.layer = static_cast<MapTileLayer>(layer);
+    feature.id = id;
+    feature.points.reserve(static_cast<int>(numPoints));
+
+    QPoint last;
+    for(quint32 j = 0; j < numPoints; j++)
+    {
+      in >> x >> y;
+      last += QPoint(x, y);
+      feature.points.append(last);
+    }
+    features.append(feature);
+  }
+
+  if(in.status() != QDataStream::Ok)
+    qWarning() << Q_FUNC_INFO << "Invalid tile data";
+  return features;
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
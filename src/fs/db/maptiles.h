@@ -0,0 +1,152 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_MAPTILES_H
+#define ATOOLS_FS_DB_MAPTILES_H
+
+#include <QCache>
+#include <QString>
+#include <QPoint>
+#include <QVector>
+
+namespace atools {
+namespace geo {
+class Pos;
+class Rect;
+}
+namespace sql {
+class SqlDatabase;
+class SqlQuery;
+}
+
+namespace fs {
+namespace db {
+
+/* Web Mercator tile address. x and y are 0 to 2^zoom - 1 with y = 0 at the north. */
+struct MapTileKey
+{
+  int zoom, x, y;
+
+  /* Tile containing the position */
+  static atools::fs::db::MapTileKey fromPos(int zoom, const atools::geo::Pos& pos);
+
+  /* Geographic bounding rectangle of the tile */
+  atools::geo::Rect getRect() const;
+};
+
+enum MapTileLayer
+{
+  TILE_AIRPORT,
+  TILE_VOR,
+  TILE_NDB,
+  TILE_AIRWAY,
+  TILE_BOUNDARY
+};
+
+/*
+ * Feature of a tile. Points are projected into tile coordinates where 0 to MAP_TILE_EXTENT covers the tile.
+ * Lines can extend beyond the tile and have to be clipped when drawing.
+ */
+struct MapTileFeature
+{
+  atools::fs::db::MapTileLayer layer;
+  int id;
+  QString ident;
+  QVector<QPoint> points;
+};
+
+/* Tile coordinate range */
+static Q_DECL_CONSTEXPR int MAP_TILE_EXTENT = 4096;
+
+/*
+ * Writes pre-projected and simplified features for all zoom levels from 0 to maxZoom into the table map_tile.
+ * Run after the database is complete. Only tiles containing features are stored.
+ *
+ * Airports are selected by longest runway for low zoom levels.
+ * Navaids and airways appear only at higher zoom levels.
+ */
+class MapTileWriter
+{
+public:
+  MapTileWriter(atools::sql::SqlDatabase *sqlDb, int maxZoomLevel);
+
+  /* Drop and create table and write all tiles. Throws SqlException in case of error. */
+  void write();
+
+  /* Number of tiles written */
+  int getNumTiles() const
+  {
+    return numTiles;
+  }
+
+private:
+  /* Feature in geographic coordinates with the lowest zoom level it is shown on */
+  struct SourceFeature
+  {
+    atools::fs::db::MapTileLayer layer;
+    int id, minZoom;
+    QString ident;
+    QVector<QPointF> lonLat;
+  };
+
+  void loadPoints(QVector<SourceFeature>& features, atools::fs::db::MapTileLayer layer, const QString& queryStr);
+  void loadAirways(QVector<SourceFeature>& features);
+  void loadBoundaries(QVector<SourceFeature>& features);
+  void writeZoom(const QVector<SourceFeature>& features, int zoom, atools::sql::SqlQuery& insertQuery);
+
+  atools::sql::SqlDatabase *db;
+  int maxZoom, numTiles = 0;
+};
+
+/*
+ * Reads tiles written by MapTileWriter. Keeps recently used tiles in a cache.
+ */
+class MapTileReader
+{
+public:
+  MapTileReader(atools::sql::SqlDatabase *sqlDb, int cacheSize = 256);
+
+  /* true if the database contains a tile table */
+  bool hasTiles() const;
+
+  /* Features of the tile. Empty if the tile does not exist. */
+  QVector<atools::fs::db::MapTileFeature> getTile(const atools::fs::db::MapTileKey& key);
+
+  /* Highest zoom level available or -1 if no tiles */
+  int getMaxZoom() const;
+
+  void clearCache()
+  {
+    cache.clear();
+  }
+
+  /* Decode a tile blob */
+  static QVector<atools::fs::db::MapTileFeature> readTile(const QByteArray& bytes);
+
+  /* Encode features into a tile blob */
+  static QByteArray writeTile(const QVector<atools::fs::db::MapTileFeature>& features);
+
+private:
+  atools::sql::SqlDatabase *db;
+  QCache<quint64, QVector<atools::fs::db::MapTileFeature> > cache;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_MAPTILES_H
@@ -34,20 +34,42 @@ void BglFileWriter::writeObject(const BglFile *type)
   currentFilepath = type->getFilepath();
   currentFilename = QFileInfo(type->getFilepath()).fileName();
 
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing BGL file " << type->getFilepath();
 
-  QFileInfo fi(type->getFilepath());
+  int createTime = static_cast<int>(type->getHeader().getCreationTimestamp());
+  bindFile(currentFilepath, createTime, type->getFilesize());
+  executeStatement();
+
+  if(getOptions().isDeduplicateFiles())
+    writtenFiles.insert(currentFilepath, {createTime, type->getFilesize()});
+}
+
+bool BglFileWriter::writeDuplicate(const QString& filepath, const QString& originalFilepath)
+{
+  auto it = writtenFiles.constFind(originalFilepath);
+  if(it == writtenFiles.constEnd())
+    return false;
+
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
+    qDebug() << "Writing duplicate BGL file " << filepath << "of" << originalFilepath;
+
+  bindFile(filepath, it.value().createTime, it.value().size);
+  executeStatement();
+  return true;
+}
+
+void BglFileWriter::bindFile(const QString& filepath, int createTime, qint64 size)
+{
+  QFileInfo fi(filepath);
 
   bind(":bgl_file_id", getNextId());
   bind(":scenery_area_id", getDataWriter().getSceneryAreaWriter()->getCurrentId());
-  bind(":bgl_create_time", static_cast<int>(type->getHeader().getCreationTimestamp()));
+  bind(":bgl_create_time", createTime);
   bind(":file_modification_time", static_cast<int>(fi.lastModified().toTime_t()));
-  bind(":filepath", QDir::toNativeSeparators(currentFilepath));
-  bind(":filename", QDir::toNativeSeparators(currentFilename));
-  bind(":size", type->getFilesize());
-
-  executeStatement();
+  bind(":filepath", QDir::toNativeSeparators(filepath));
+  bind(":filename", QDir::toNativeSeparators(fi.fileName()));
+  bind(":size", size);
 }
 
 } // namespace writer
@@ -21,6 +21,8 @@
 #include "fs/db/writerbase.h"
 #include "fs/bgl/bglfile.h"
 
+#include <QHash>
+
 namespace atools {
 namespace fs {
 namespace db {
@@ -48,11 +50,25 @@ public:
     return currentFilepath;
   }
 
+  /* Write a file record for a file having the same content as the already written file originalFilepath.
+   * The file is not read. Returns false if the original was not written. Needs option DeduplicateFiles. */
+  bool writeDuplicate(const QString& filepath, const QString& originalFilepath);
+
 protected:
   virtual void writeObject(const bgl::BglFile *type) override;
 
+  /* Header values of written files needed for duplicates */
+  struct FileValues
+  {
+    int createTime;
+    qint64 size;
+  };
+
+  void bindFile(const QString& filepath, int createTime, qint64 size);
+
   QString currentFilename, currentFilepath;
   int sceneryAreaId;
+  QHash<QString, FileValues> writtenFiles;
 };
 
 } // namespace writer
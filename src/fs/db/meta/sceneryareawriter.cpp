@@ -32,7 +32,7 @@ void SceneryAreaWriter::writeObject(const SceneryArea *type)
 {
   currentSceneryLocalPath = type->getLocalPath();
 
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing SceneryArea layer " << type->getLayer() << " title " << type->getTitle();
 
   bind(":scenery_area_id", getNextId());
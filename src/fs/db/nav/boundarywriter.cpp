@@ -35,7 +35,7 @@ namespace  bl = bgl::boundaryline;
 
 void BoundaryWriter::writeObject(const Boundary *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing BOUNDARY " << type->getName();
 
   bind(":boundary_id", getNextId());
@@ -81,7 +81,9 @@ void BoundaryWriter::writeObject(const Boundary *type)
   bind(":min_laty", type->getMinPosition().getLatY());
 
   atools::fs::common::BinaryGeometry geo(fetchAirspaceLines(type));
-  bind(":geometry", geo.writeToByteArray());
+  bind(":geometry", geo.writeToByteArray(getOptions().isPackedGeometry() ?
+                                         atools::fs::common::BinaryGeometry::FORMAT_PACKED :
+                                         atools::fs::common::BinaryGeometry::FORMAT_FLOAT));
   executeStatement();
 }
 
@@ -21,6 +21,7 @@
 #include "fs/bgl/nav/localizer.h"
 #include "fs/bgl/util.h"
 #include "fs/db/datawriter.h"
+#include "fs/db/navduplicateindex.h"
 #include "sql/sqlquery.h"
 #include "fs/navdatabaseoptions.h"
 #include "fs/db/runwayindex.h"
@@ -39,7 +40,7 @@ using atools::geo::Pos;
 
 void IlsWriter::writeObject(const Ils *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing ILS " << type->getIdent() << " name " << type->getName();
 
   bind(":ils_id", getNextId());
@@ -134,7 +135,13 @@ void IlsWriter::writeObject(const Ils *type)
     isComplete = true;
 
   if(getOptions().isIncomplete() || isComplete)
+  {
     executeStatement();
+
+    NavDuplicateIndex *duplicateIndex = getDataWriter().getNavDuplicateIndex();
+    if(duplicateIndex != nullptr)
+      duplicateIndex->addIls(getCurrentId(), type->getIdent(), type->getName(), pos.getPos());
+  }
 }
 
 } // namespace writer
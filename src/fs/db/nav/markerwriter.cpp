@@ -18,6 +18,7 @@
 #include "fs/db/nav/markerwriter.h"
 #include "fs/db/meta/bglfilewriter.h"
 #include "fs/db/datawriter.h"
+#include "fs/db/navduplicateindex.h"
 #include "fs/bgl/util.h"
 #include "geo/calculations.h"
 #include "atools.h"
@@ -30,7 +31,7 @@ using atools::fs::bgl::Marker;
 
 void MarkerWriter::writeObject(const Marker *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing Marker " << type->getIdent();
 
   using namespace atools::geo;
@@ -47,6 +48,11 @@ void MarkerWriter::writeObject(const Marker *type)
   bind(":laty", type->getPosition().getLatY());
 
   executeStatement();
+
+  NavDuplicateIndex *duplicateIndex = getDataWriter().getNavDuplicateIndex();
+  if(duplicateIndex != nullptr)
+    duplicateIndex->addMarker(getCurrentId(), bgl::Marker::markerTypeToStr(type->getType()), type->getHeading(),
+                              type->getPosition().getPos());
 }
 
 } // namespace writer
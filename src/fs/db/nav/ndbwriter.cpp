@@ -20,6 +20,7 @@
 #include "fs/db/datawriter.h"
 #include "fs/bgl/util.h"
 #include "fs/db/dbairportindex.h"
+#include "fs/db/navduplicateindex.h"
 #include "geo/calculations.h"
 #include "atools.h"
 
@@ -31,7 +32,7 @@ using atools::fs::bgl::Ndb;
 
 void NdbWriter::writeObject(const Ndb *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing NDB " << type->getIdent() << type->getName();
 
   using namespace atools::geo;
@@ -63,6 +64,11 @@ void NdbWriter::writeObject(const Ndb *type)
   }
 
   executeStatement();
+
+  NavDuplicateIndex *duplicateIndex = getDataWriter().getNavDuplicateIndex();
+  if(duplicateIndex != nullptr)
+    duplicateIndex->addNdb(getCurrentId(), type->getIdent(), type->getRegion(), type->getFrequency(),
+                           type->getPosition().getPos());
 }
 
 } // namespace writer
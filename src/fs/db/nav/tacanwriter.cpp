@@ -37,7 +37,7 @@ using namespace atools;
 
 void TacanWriter::writeObject(const bgl::Tacan *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing TACAN " << type->getIdent() << type->getName();
 
   // Use VOR id
@@ -21,6 +21,7 @@
 #include "fs/db/datawriter.h"
 #include "fs/bgl/util.h"
 #include "fs/db/dbairportindex.h"
+#include "fs/db/navduplicateindex.h"
 #include "geo/calculations.h"
 #include "atools.h"
 
@@ -35,7 +36,7 @@ using namespace atools;
 
 void VorWriter::writeObject(const Vor *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing VOR " << type->getIdent() << type->getName();
 
   bind(":vor_id", getNextId());
@@ -82,6 +83,12 @@ void VorWriter::writeObject(const Vor *type)
     bindNullFloat(":dme_laty");
   }
   executeStatement();
+
+  NavDuplicateIndex *duplicateIndex = getDataWriter().getNavDuplicateIndex();
+  if(duplicateIndex != nullptr)
+    duplicateIndex->addVor(getCurrentId(), type->getIdent(), type->getRegion(),
+                           bgl::IlsVor::ilsVorTypeToStr(type->getType()), type->getFrequency(),
+                           type->isDmeOnly(), dme != nullptr, type->getPosition().getPos());
 }
 
 } // namespace writer
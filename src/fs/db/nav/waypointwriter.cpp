@@ -20,6 +20,7 @@
 #include "fs/db/meta/bglfilewriter.h"
 #include "fs/db/datawriter.h"
 #include "fs/db/dbairportindex.h"
+#include "fs/db/navduplicateindex.h"
 
 namespace atools {
 namespace fs {
@@ -29,7 +30,7 @@ using atools::fs::bgl::Waypoint;
 
 void WaypointWriter::writeObject(const Waypoint *type)
 {
-  if(getOptions().isVerbose())
+  if(ATOOLS_VERBOSE(getOptions().isVerbose()))
     qDebug() << "Writing Waypoint " << type->getIdent();
 
   bind(":waypoint_id", getNextId());
@@ -58,6 +59,11 @@ void WaypointWriter::writeObject(const Waypoint *type)
 
   executeStatement();
 
+  NavDuplicateIndex *duplicateIndex = getDataWriter().getNavDuplicateIndex();
+  if(duplicateIndex != nullptr)
+    duplicateIndex->addWaypoint(getCurrentId(), type->getIdent(), type->getRegion(),
+                                bgl::Waypoint::waypointTypeToStr(type->getType()), type->getPosition().getPos());
+
   AirwaySegmentWriter *tempAirwayWriter = getDataWriter().getAirwaySegmentWriter();
   tempAirwayWriter->write(type->getAirways());
 }
@@ -0,0 +1,145 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/navduplicateindex.h"
+
+#include "geo/pos.h"
+#include "sql/sqlquery.h"
+
+#include <QDebug>
+#include <QStringList>
+
+#include <algorithm>
+#include <cmath>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+/* Table and id column for each index table */
+static const char *TABLES[][2] =
+{
+  {"vor", "vor_id"},
+  {"ndb", "ndb_id"},
+  {"marker", "marker_id"},
+  {"ils", "ils_id"},
+  {"waypoint", "waypoint_id"}
+};
+
+/* Maximum number of ids in one delete statement */
+static const int MAX_DELETE_IDS = 500;
+
+NavDuplicateIndex::NavDuplicateIndex(bool verboseLogging)
+  : verbose(verboseLogging)
+{
+}
+
+NavDuplicateIndex::~NavDuplicateIndex()
+{
+}
+
+void NavDuplicateIndex::addVor(int id, const QString& ident, const QString& region, const QString& type,
+                               int frequency, bool dmeOnly, bool hasDme, const geo::Pos& pos)
+{
+  add(VOR, ident + '|' + region + '|' + type + '|' + QString::number(frequency) + '|' +
+      (dmeOnly ? '1' : '0') + (hasDme ? '1' : '0'), id, pos, 0.1f);
+}
+
+void NavDuplicateIndex::addNdb(int id, const QString& ident, const QString& region, int frequency,
+                               const geo::Pos& pos)
+{
+  add(NDB, ident + '|' + region + '|' + QString::number(frequency), id, pos, 0.1f);
+}
+
+void NavDuplicateIndex::addMarker(int id, const QString& type, float heading, const geo::Pos& pos)
+{
+  add(MARKER, type + '|' + QString::number(heading), id, pos, 0.01f);
+}
+
+void NavDuplicateIndex::addIls(int id, const QString& ident, const QString& name, const geo::Pos& pos)
+{
+  // Same ident and name close by or same ident very close
+  add(ILS, ident, id, pos, 0.01f, name, 0.1f);
+}
+
+void NavDuplicateIndex::addWaypoint(int id, const QString& ident, const QString& region, const QString& type,
+                                    const geo::Pos& pos)
+{
+  add(WAYPOINT, ident + '|' + region + '|' + type, id, pos, 0.1f);
+}
+
+void NavDuplicateIndex::add(Table table, const QString& key, int id, const geo::Pos& pos, float maxDist,
+                            const QString& name, float nameMaxDist)
+{
+  QVector<Entry>& list = entries[table][key];
+
+  for(int i = list.size() - 1; i >= 0; i--)
+  {
+    const Entry& entry = list.at(i);
+    float dist = std::abs(entry.lonx - pos.getLonX()) + std::abs(entry.laty - pos.getLatY());
+    if(dist < maxDist || (dist < nameMaxDist && entry.name == name))
+    {
+      if(verbose)
+        qDebug() << "Replacing duplicate" << TABLES[table][0] << entry.id << key << "by" << id;
+
+      replacedIds[table].append(entry.id);
+      numReplaced++;
+      list.remove(i);
+    }
+  }
+
+  list.append({id, pos.getLonX(), pos.getLatY(), name});
+}
+
+void NavDuplicateIndex::deleteReplaced(sql::SqlDatabase& db)
+{
+  sql::SqlQuery query(db);
+
+  for(int table = 0; table < NUM_TABLES; table++)
+  {
+    QVector<int>& ids = replacedIds[table];
+    if(ids.isEmpty())
+      continue;
+
+    qDebug() << Q_FUNC_INFO << "Deleting" << ids.size() << "duplicates from" << TABLES[table][0];
+
+    for(int start = 0; start < ids.size(); start += MAX_DELETE_IDS)
+    {
+      QStringList idList;
+      for(int i = start; i < std::min(start + MAX_DELETE_IDS, ids.size()); i++)
+        idList.append(QString::number(ids.at(i)));
+
+      query.exec(QString("delete from %1 where %2 in (%3)").
+                 arg(TABLES[table][0]).arg(TABLES[table][1]).arg(idList.join(",")));
+    }
+    ids.clear();
+  }
+}
+
+void NavDuplicateIndex::clear()
+{
+  for(int table = 0; table < NUM_TABLES; table++)
+  {
+    entries[table].clear();
+    replacedIds[table].clear();
+  }
+  numReplaced = 0;
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,102 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_NAVDUPLICATEINDEX_H
+#define ATOOLS_FS_DB_NAVDUPLICATEINDEX_H
+
+#include <QHash>
+#include <QVector>
+
+namespace atools {
+namespace geo {
+class Pos;
+}
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace db {
+
+/*
+ * Detects duplicate VOR, NDB, marker, ILS and waypoints while writing BGL files. Replaces the self joins in
+ * delete_duplicates.sql using the same rules: An already written object having the same key values and
+ * being close by (manhattan distance in degree) is replaced by the new one. This keeps add-on objects
+ * loaded later and removes stock objects.
+ *
+ * Replaced objects are deleted from the database by deleteReplaced().
+ */
+class NavDuplicateIndex
+{
+public:
+  /* Logs each replaced object if verbose is true */
+  explicit NavDuplicateIndex(bool verboseLogging = false);
+  ~NavDuplicateIndex();
+
+  void addVor(int id, const QString& ident, const QString& region, const QString& type, int frequency,
+              bool dmeOnly, bool hasDme, const atools::geo::Pos& pos);
+  void addNdb(int id, const QString& ident, const QString& region, int frequency, const atools::geo::Pos& pos);
+  void addMarker(int id, const QString& type, float heading, const atools::geo::Pos& pos);
+  void addIls(int id, const QString& ident, const QString& name, const atools::geo::Pos& pos);
+  void addWaypoint(int id, const QString& ident, const QString& region, const QString& type,
+                   const atools::geo::Pos& pos);
+
+  /* Delete all objects replaced since the last call from the database.
+   * All writers have to be flushed before since replaced rows might still be pending in a batch. */
+  void deleteReplaced(atools::sql::SqlDatabase& db);
+
+  /* Total number of replaced objects */
+  int getNumReplaced() const
+  {
+    return numReplaced;
+  }
+
+  void clear();
+
+private:
+  enum Table
+  {
+    VOR,
+    NDB,
+    MARKER,
+    ILS,
+    WAYPOINT,
+    NUM_TABLES
+  };
+
+  struct Entry
+  {
+    int id;
+    float lonx, laty;
+    QString name;
+  };
+
+  /* Replace all entries of key closer than maxDist or closer than nameMaxDist if the name is equal */
+  void add(Table table, const QString& key, int id, const atools::geo::Pos& pos, float maxDist,
+           const QString& name = QString(), float nameMaxDist = 0.f);
+
+  QHash<QString, QVector<Entry> > entries[NUM_TABLES];
+  QVector<int> replacedIds[NUM_TABLES];
+  int numReplaced = 0;
+  bool verbose;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_NAVDUPLICATEINDEX_H
@@ -0,0 +1,246 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/navmemorystore.h"
+
+#include "geo/rect.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "util/stringpool.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+/* One degree grid */
+static const int GRID_COLS = 360;
+static const int GRID_ROWS = 180;
+static const int GRID_CELLS = GRID_COLS * GRID_ROWS;
+
+/* First radius for nearest search. Doubled until enough results are found. */
+static const float NEAREST_START_RADIUS_METER = 50000.f;
+
+/* All queries return the same columns in the same order */
+static const QString QUERIES[STORE_NUM_TYPES] =
+{
+  "select airport_id, ident, region, name, '' as type, 0 as frequency, rating, longest_runway_length, "
+  "lonx, laty from airport",
+  "select waypoint_id, ident, region, '' as name, type, 0 as frequency, 0 as rating, 0 as longest_runway_length, "
+  "lonx, laty from waypoint",
+  "select vor_id, ident, region, name, type, frequency, 0 as rating, 0 as longest_runway_length, "
+  "lonx, laty from vor",
+  "select ndb_id, ident, region, name, type, frequency, 0 as rating, 0 as longest_runway_length, "
+  "lonx, laty from ndb"
+};
+
+NavMemoryStore::NavMemoryStore()
+{
+}
+
+NavMemoryStore::~NavMemoryStore()
+{
+}
+
+void NavMemoryStore::load(sql::SqlDatabase *db)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  clear();
+  for(int type = 0; type < STORE_NUM_TYPES; type++)
+    loadTable(db, static_cast<NavStoreType>(type), QUERIES[type]);
+  loaded = true;
+
+  qInfo() << Q_FUNC_INFO << "Loaded" << size(STORE_AIRPORT) << "airports" << size(STORE_WAYPOINT) << "waypoints"
+          << size(STORE_VOR) << "VOR" << size(STORE_NDB) << "NDB in" << timer.elapsed() << "ms";
+}
+
+void NavMemoryStore::clear()
+{
+  for(int type = 0; type < STORE_NUM_TYPES; type++)
+    tables[type] = Table();
+  loaded = false;
+}
+
+void NavMemoryStore::loadTable(sql::SqlDatabase *db, NavStoreType type, const QString& queryStr)
+{
+  struct Row
+  {
+    int cell, id, frequency, rating, longestRunwayLength;
+    float lonx, laty;
+    QString ident, region, name, type;
+  };
+
+  atools::util::StringPool& pool = atools::util::StringPool::instance();
+  QVector<Row> rows;
+
+  sql::SqlQuery query(db);
+  query.setForwardOnly(true);
+  query.exec(queryStr);
+  while(query.next())
+  {
+    float lonx = query.valueFloat(8), laty = query.valueFloat(9);
+    rows.append({cellRow(laty) * GRID_COLS + cellCol(lonx), query.valueInt(0), query.valueInt(5),
+                 query.valueInt(6), query.valueInt(7), lonx, laty,
+                 pool.intern(query.valueStr(1)), pool.intern(query.valueStr(2)), query.valueStr(3),
+                 pool.intern(query.valueStr(4))});
+  }
+
+  // Sort by cell and keep database order within cells
+  std::stable_sort(rows.begin(), rows.end(), [](const Row& r1, const Row& r2) -> bool {
+    return r1.cell < r2.cell;
+  });
+
+  Table& table = tables[type];
+  int num = rows.size();
+  table.ids.reserve(num);
+  table.frequencies.reserve(num);
+  table.ratings.reserve(num);
+  table.longestRunwayLengths.reserve(num);
+  table.lonx.reserve(num);
+  table.laty.reserve(num);
+  table.idents.reserve(num);
+  table.regions.reserve(num);
+  table.names.reserve(num);
+  table.types.reserve(num);
+  table.idIndex.reserve(num);
+  table.cellStart.fill(0, GRID_CELLS + 1);
+
+  for(int i = 0; i < num; i++)
+  {
+    const Row& row = rows.at(i);
+    table.ids.append(row.id);
+    table.frequencies.append(row.frequency);
+    table.ratings.append(row.rating);
+    table.longestRunwayLengths.append(row.longestRunwayLength);
+    table.lonx.append(row.lonx);
+    table.laty.append(row.laty);
+    table.idents.append(row.ident);
+    table.regions.append(row.region);
+    table.names.append(row.name);
+    table.types.append(row.type);
+    table.identIndex[row.ident].append(i);
+    table.idIndex.insert(row.id, i);
+    table.cellStart[row.cell + 1]++;
+  }
+
+  // Convert counts to start rows
+  std::partial_sum(table.cellStart.begin(), table.cellStart.end(), table.cellStart.begin());
+}
+
+int NavMemoryStore::cellCol(float lonx)
+{
+  return std::min(std::max(static_cast<int>(std::floor(lonx + 180.f)), 0), GRID_COLS - 1);
+}
+
+int NavMemoryStore::cellRow(float laty)
+{
+  return std::min(std::max(static_cast<int>(std::floor(laty + 90.f)), 0), GRID_ROWS - 1);
+}
+
+QVector<int> NavMemoryStore::getRowsInRect(NavStoreType type, const geo::Rect& rect) const
+{
+  QVector<int> rows;
+  getRowsInRect(rows, type, rect);
+  return rows;
+}
+
+void NavMemoryStore::getRowsInRect(QVector<int>& rows, NavStoreType type, const geo::Rect& rect) const
+{
+  rows.clear();
+  if(!rect.isValid() || tables[type].ids.isEmpty())
+    return;
+
+  for(const atools::geo::Rect& r : rect.splitAtAntiMeridian())
+    addRowsInRect(rows, tables[type], r.getWest(), r.getNorth(), r.getEast(), r.getSouth());
+}
+
+void NavMemoryStore::addRowsInRect(QVector<int>& rows, const Table& table, float west, float north, float east,
+                                   float south) const
+{
+  int colMin = cellCol(west), colMax = cellCol(east);
+  for(int cellY = cellRow(south); cellY <= cellRow(north); cellY++)
+  {
+    // Cells colMin to colMax are one contiguous range of rows
+    int end = table.cellStart.at(cellY * GRID_COLS + colMax + 1);
+    for(int row = table.cellStart.at(cellY * GRID_COLS + colMin); row < end; row++)
+    {
+      float lonx = table.lonx.at(row), laty = table.laty.at(row);
+      if(lonx >= west && lonx <= east && laty >= south && laty <= north)
+        rows.append(row);
+    }
+  }
+}
+
+QVector<int> NavMemoryStore::getRowsNearest(NavStoreType type, const geo::Pos& pos, int num,
+                                            float maxRadiusMeter) const
+{
+  if(!pos.isValid() || num <= 0 || tables[type].ids.isEmpty())
+    return QVector<int>();
+
+  QVector<std::pair<float, int> > found;
+  QVector<int> rows;
+  float radius = std::min(NEAREST_START_RADIUS_METER, maxRadiusMeter);
+  while(true)
+  {
+    // All objects within the radius are inside the bounding rectangle of the circle
+    getRowsInRect(rows, type, atools::geo::Rect(pos, radius));
+
+    found.clear();
+    for(int row : rows)
+    {
+      float dist = pos.distanceMeterTo(getPosition(type, row));
+      if(dist <= radius)
+        found.append(std::make_pair(dist, row));
+    }
+
+    if(found.size() >= num || radius >= maxRadiusMeter)
+      break;
+    radius = std::min(radius * 2.f, maxRadiusMeter);
+  }
+
+  std::sort(found.begin(), found.end());
+
+  QVector<int> result;
+  for(int i = 0; i < std::min(num, found.size()); i++)
+    result.append(found.at(i).second);
+  return result;
+}
+
+QVector<int> NavMemoryStore::getRowsByIdent(NavStoreType type, const QString& ident) const
+{
+  return tables[type].identIndex.value(ident);
+}
+
+NavStoreEntry NavMemoryStore::getEntry(NavStoreType type, int row) const
+{
+  const Table& table = tables[type];
+  return {table.ids.at(row), table.idents.at(row), table.regions.at(row), table.names.at(row),
+          table.types.at(row), table.frequencies.at(row), table.ratings.at(row),
+          table.longestRunwayLengths.at(row), getPosition(type, row)};
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,157 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_NAVMEMORYSTORE_H
+#define ATOOLS_FS_DB_NAVMEMORYSTORE_H
+
+#include "geo/pos.h"
+
+#include <QHash>
+#include <QVector>
+
+namespace atools {
+namespace geo {
+class Rect;
+}
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace db {
+
+/* Tables kept in NavMemoryStore */
+enum NavStoreType
+{
+  STORE_AIRPORT,
+  STORE_WAYPOINT,
+  STORE_VOR,
+  STORE_NDB,
+  STORE_NUM_TYPES
+};
+
+/* One row of the store. Fields not available for a type are empty or 0. */
+struct NavStoreEntry
+{
+  int id;
+  QString ident, region, name, type;
+  int frequency, rating, longestRunwayLength;
+  atools::geo::Pos position;
+};
+
+/*
+ * Read only in memory copy of the airport, waypoint, VOR and NDB tables for fast map and tooltip queries.
+ *
+ * Each table is stored as separate columns (structure of arrays) with rows sorted by a one degree grid cell.
+ * Rows of neighbouring cells in a grid row are consecutive, so rectangle queries read contiguous ranges.
+ * Hash indexes map idents and database ids to rows.
+ *
+ * Queries return row indexes which can be used with the getters. Rows are valid until the next load() or
+ * clear(). Queries are const and can be called from several threads but not while loading.
+ */
+class NavMemoryStore
+{
+public:
+  NavMemoryStore();
+  ~NavMemoryStore();
+
+  NavMemoryStore(const NavMemoryStore& other) = delete;
+  NavMemoryStore& operator=(const NavMemoryStore& other) = delete;
+
+  /* Load all tables from the database replacing current content. Call again after compiling.
+   * Throws SqlException in case of error. */
+  void load(atools::sql::SqlDatabase *db);
+
+  void clear();
+
+  bool isLoaded() const
+  {
+    return loaded;
+  }
+
+  int size(atools::fs::db::NavStoreType type) const
+  {
+    return tables[type].ids.size();
+  }
+
+  /* Rows of all objects inside the rectangle. Rectangles crossing the anti-meridian are supported. */
+  QVector<int> getRowsInRect(atools::fs::db::NavStoreType type, const atools::geo::Rect& rect) const;
+  void getRowsInRect(QVector<int>& rows, atools::fs::db::NavStoreType type, const atools::geo::Rect& rect) const;
+
+  /* Rows of up to num nearest objects within maxRadiusMeter ordered by great circle distance */
+  QVector<int> getRowsNearest(atools::fs::db::NavStoreType type, const atools::geo::Pos& pos, int num,
+                              float maxRadiusMeter) const;
+
+  /* Rows of all objects with the given ident */
+  QVector<int> getRowsByIdent(atools::fs::db::NavStoreType type, const QString& ident) const;
+
+  /* Row for database id or -1 if not found */
+  int getRowById(atools::fs::db::NavStoreType type, int id) const
+  {
+    return tables[type].idIndex.value(id, -1);
+  }
+
+  /* Getters for rows */
+  int getId(atools::fs::db::NavStoreType type, int row) const
+  {
+    return tables[type].ids.at(row);
+  }
+
+  const QString& getIdent(atools::fs::db::NavStoreType type, int row) const
+  {
+    return tables[type].idents.at(row);
+  }
+
+  atools::geo::Pos getPosition(atools::fs::db::NavStoreType type, int row) const
+  {
+    return atools::geo::Pos(tables[type].lonx.at(row), tables[type].laty.at(row));
+  }
+
+  atools::fs::db::NavStoreEntry getEntry(atools::fs::db::NavStoreType type, int row) const;
+
+private:
+  /* Columns of one table. All vectors have the same size. */
+  struct Table
+  {
+    QVector<int> ids, frequencies, ratings, longestRunwayLengths;
+    QVector<float> lonx, laty;
+    QVector<QString> idents, regions, names, types;
+
+    /* Rows of grid cell c are cellStart[c] to cellStart[c + 1] - 1 */
+    QVector<int> cellStart;
+    QHash<QString, QVector<int> > identIndex;
+    QHash<int, int> idIndex;
+  };
+
+  void loadTable(atools::sql::SqlDatabase *db, atools::fs::db::NavStoreType type, const QString& queryStr);
+
+  /* Add rows of a rectangle not crossing the anti-meridian */
+  void addRowsInRect(QVector<int>& rows, const Table& table, float west, float north, float east,
+                     float south) const;
+
+  static int cellCol(float lonx);
+  static int cellRow(float laty);
+
+  Table tables[STORE_NUM_TYPES];
+  bool loaded = false;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_NAVMEMORYSTORE_H
@@ -0,0 +1,481 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/proceduregeometry.h"
+
+#include "geo/calculations.h"
+#include "geo/linestring.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+using atools::geo::Pos;
+using atools::geo::LineString;
+using atools::geo::nmToMeter;
+using atools::geo::opposedCourseDeg;
+using atools::geo::normalizeCourse;
+
+/* Estimated climb gradient for legs terminating at an altitude */
+static const float CLIMB_FT_PER_NM = 250.f;
+
+/* Ground speed used to convert leg time to distance */
+static const float SPEED_KTS = 200.f;
+
+/* Length of legs with manual termination or a failed intercept */
+static const float MANUAL_NM = 3.f;
+
+/* Turn radius for holds and procedure turns */
+static const float TURN_RADIUS_NM = 1.f;
+
+/* Maximum distance for intercepts before falling back to a manual termination */
+static const float MAX_INTERCEPT_NM = 30.f;
+
+/* Segments of a full circle for arcs and turns */
+static const int CIRCLE_SEGMENTS = 72;
+
+/* Simplification tolerance in degrees. About 20 meters. */
+static const float SIMPLIFY_TOLERANCE_DEG = 0.0002f;
+
+/* Columns common to approach and transition legs. Procedure and leg ids are added by the caller. */
+static const QString LEG_COLUMNS("a.approach_id, a.suffix, l.type, l.turn_direction, "
+                                 "l.fix_type, l.fix_ident, l.fix_region, "
+                                 "l.recommended_fix_type, l.recommended_fix_ident, l.recommended_fix_region, "
+                                 "l.is_true_course, l.course, l.distance, l.time, l.theta, l.rho, l.altitude1, "
+                                 "p.airport_id, p.lonx, p.laty, p.mag_var, p.altitude");
+
+struct ProcedureGeometry::Leg
+{
+  int id, procedureId, approachId, airportId;
+  bool sid;
+  QString type, turn;
+  Pos fix, recommended, airportPos;
+
+  /* All courses converted to true */
+  float course, theta, rho, distanceNm, timeMin, altitude, airportAltitude;
+  bool hasCourse, hasDistance, hasTime;
+
+  bool turnRight() const
+  {
+    return turn == "R";
+  }
+
+  /* Length from distance or time. Returns defaultNm if neither is given. */
+  float lengthNm(float defaultNm) const
+  {
+    if(hasDistance && distanceNm > 0.f)
+      return distanceNm;
+    else if(hasTime && timeMin > 0.f)
+      return timeMin * SPEED_KTS / 60.f;
+    else
+      return defaultNm;
+  }
+
+  /* Estimated length for legs terminating at an altitude */
+  float altitudeLengthNm() const
+  {
+    return std::min(std::max((altitude - airportAltitude) / CLIMB_FT_PER_NM, 0.5f), 10.f);
+  }
+};
+
+/* First termination point on course where the distance to the navaid equals distanceNm.
+ * Uses a local flat approximation which is sufficient for terminal procedure distances. */
+static Pos dmeTermination(const Pos& start, float course, const Pos& navaid, float distanceNm)
+{
+  float distMeter = nmToMeter(distanceNm);
+  if(!navaid.isValid())
+    return start.endpoint(distMeter, course);
+
+  float navaidDist = start.distanceMeterTo(navaid);
+  double angle = atools::geo::toRadians(static_cast<double>(start.angleDegTo(navaid) - course));
+  double along = navaidDist * std::cos(angle), across = navaidDist * std::sin(angle);
+  double disc = static_cast<double>(distMeter) * distMeter - across * across;
+
+  double dist;
+  if(disc < 0.)
+    // Never reaches the distance - use closest point
+    dist = along;
+  else if(navaidDist > distMeter && along - std::sqrt(disc) > 0.)
+    // Outside and flying inbound - first crossing
+    dist = along - std::sqrt(disc);
+  else
+    dist = along + std::sqrt(disc);
+
+  if(dist <= 0.)
+    return start;
+
+  return start.endpoint(static_cast<float>(dist), course);
+}
+
+/* Racetrack starting and ending at the fix with inbound course */
+static void hold(LineString& line, const Pos& fix, float inboundCourse, bool turnRight, float legNm)
+{
+  float side = turnRight ? 90.f : -90.f;
+  float radius = nmToMeter(TURN_RADIUS_NM), length = nmToMeter(legNm);
+  float outbound = opposedCourseDeg(inboundCourse);
+
+  Pos center1 = fix.endpoint(radius, normalizeCourse(inboundCourse + side));
+  Pos abeam = fix.endpoint(radius * 2.f, normalizeCourse(inboundCourse + side));
+  Pos outboundEnd = abeam.endpoint(length, outbound);
+  Pos center2 = center1.endpoint(length, outbound);
+  Pos inboundStart = fix.endpoint(length, outbound);
+
+  line.append(fix);
+  line.append(LineString(center1, fix, abeam, turnRight, CIRCLE_SEGMENTS));
+  line.append(outboundEnd);
+  line.append(LineString(center2, outboundEnd, inboundStart, turnRight, CIRCLE_SEGMENTS));
+  line.append(fix);
+}
+
+ProcedureGeometry::ProcedureGeometry(sql::SqlDatabase *sqlDb)
+  : db(sqlDb)
+{
+}
+
+void ProcedureGeometry::write(atools::fs::common::BinaryGeometry::Format format)
+{
+  QElapsedTimer timer;
+  timer.start();
+  numWritten = numSkipped = 0;
+  sidEndPos.clear();
+
+  db->exec("delete from approach_leg_geometry");
+  db->exec("delete from transition_leg_geometry");
+
+  loadFixes();
+
+  // Approaches first to get the end positions of SIDs for the transitions
+  writeLegs("approach_leg",
+            "select l.approach_leg_id, l.approach_id, " + LEG_COLUMNS +
+            " from approach_leg l join approach a on l.approach_id = a.approach_id "
+            "join airport p on a.airport_id = p.airport_id "
+            "order by l.approach_id, l.approach_leg_id", format);
+
+  writeLegs("transition_leg",
+            "select l.transition_leg_id, l.transition_id, " + LEG_COLUMNS +
+            " from transition_leg l join transition t on l.transition_id = t.transition_id "
+            "join approach a on t.approach_id = a.approach_id "
+            "join airport p on a.airport_id = p.airport_id "
+            "order by l.transition_id, l.transition_leg_id", format);
+  db->commit();
+
+  fixes.clear();
+  sidEndPos.clear();
+
+  qInfo() << Q_FUNC_INFO << "Wrote" << numWritten << "leg geometries and skipped" << numSkipped
+          << "in" << timer.elapsed() << "ms";
+}
+
+void ProcedureGeometry::loadFixes()
+{
+  fixes.clear();
+
+  // Terminal waypoints and NDB are in the same tables
+  struct FixTable
+  {
+    QString type, query;
+  };
+  const QVector<FixTable> tables(
+  {
+    {"W", "select ident, region, lonx, laty from waypoint"},
+    {"V", "select ident, region, lonx, laty from vor"},
+    {"N", "select ident, region, lonx, laty from ndb"},
+    {"L", "select ident, region, lonx, laty from ils"},
+    {"A", "select ident, region, lonx, laty from airport"},
+
+    // Runway ends are keyed by airport id and name
+    {"R", "select cast(r.airport_id as text) || '|' || e.name, null, e.lonx, e.laty from runway r "
+          "join runway_end e on e.runway_end_id = r.primary_end_id or e.runway_end_id = r.secondary_end_id"}
+  });
+
+  for(const FixTable& table : tables)
+  {
+    sql::SqlQuery query(db);
+    query.setForwardOnly(true);
+    query.exec(table.query);
+    while(query.next())
+      fixes.insert(table.type + "|" + query.value(0).toString(),
+                   {query.value(1).toString(), Pos(query.value(2).toFloat(), query.value(3).toFloat())});
+  }
+}
+
+Pos ProcedureGeometry::fixPos(const QString& type, const QString& ident, const QString& region,
+                              int airportId, const Pos& airportPos) const
+{
+  if(type.isEmpty() || ident.isEmpty())
+    return Pos();
+
+  QString key;
+  if(type == "R")
+  {
+    // X-Plane and DFD use "RW" prefix
+    QString name = ident.startsWith("RW") ? ident.mid(2) : ident;
+    key = "R|" + QString::number(airportId) + "|" + name;
+  }
+  else if(type == "TW")
+    key = "W|" + ident;
+  else if(type == "TN")
+    key = "N|" + ident;
+  else
+    key = type + "|" + ident;
+
+  // Use nearest to the airport for duplicates
+  Pos pos;
+  float minDist = std::numeric_limits<float>::max();
+  for(auto it = fixes.constFind(key); it != fixes.constEnd() && it.key() == key; ++it)
+  {
+    if(!region.isEmpty() && !it.value().region.isEmpty() && region != it.value().region)
+      continue;
+
+    float dist = airportPos.distanceMeterTo(it.value().pos);
+    if(dist < minDist)
+    {
+      minDist = dist;
+      pos = it.value().pos;
+    }
+  }
+  return pos;
+}
+
+void ProcedureGeometry::writeLegs(const QString& legTable, const QString& queryStr,
+                                  atools::fs::common::BinaryGeometry::Format format)
+{
+  sql::SqlQuery insertQuery(db);
+  insertQuery.prepare("insert into " + legTable + "_geometry (" + legTable + "_id, num_points, geometry) "
+                      "values(:id, :num, :geometry)");
+
+  QVector<Leg> legs;
+  sql::SqlQuery query(db);
+  query.setForwardOnly(true);
+  query.exec(queryStr);
+  while(query.next())
+  {
+    Leg leg;
+    leg.id = query.value(0).toInt();
+    leg.procedureId = query.value(1).toInt();
+
+    if(!legs.isEmpty() && legs.last().procedureId != leg.procedureId)
+    {
+      writeProcedure(insertQuery, legs, format);
+      legs.clear();
+    }
+
+    leg.approachId = query.value(2).toInt();
+    leg.sid = query.value(3).toString() == "D";
+    leg.type = query.value(4).toString();
+    leg.turn = query.value(5).toString();
+    leg.airportId = query.value(19).toInt();
+    leg.airportPos = Pos(query.value(20).toFloat(), query.value(21).toFloat());
+    leg.fix = fixPos(query.value(6).toString(), query.value(7).toString(), query.value(8).toString(),
+                     leg.airportId, leg.airportPos);
+    leg.recommended = fixPos(query.value(9).toString(), query.value(10).toString(), query.value(11).toString(),
+                             leg.airportId, leg.airportPos);
+
+    float magvar = query.value(12).toBool() ? 0.f : query.value(22).toFloat();
+    leg.hasCourse = !query.isNull(13);
+    leg.course = normalizeCourse(query.value(13).toFloat() + magvar);
+    leg.hasDistance = !query.isNull(14);
+    leg.distanceNm = query.value(14).toFloat();
+    leg.hasTime = !query.isNull(15);
+    leg.timeMin = query.value(15).toFloat();
+    leg.theta = query.value(16).toFloat();
+    leg.rho = query.value(17).toFloat();
+    leg.altitude = query.value(18).toFloat();
+    leg.airportAltitude = query.value(23).toFloat();
+    legs.append(leg);
+  }
+
+  if(!legs.isEmpty())
+    writeProcedure(insertQuery, legs, format);
+}
+
+void ProcedureGeometry::writeProcedure(sql::SqlQuery& insertQuery, QVector<Leg>& legs,
+                                       atools::fs::common::BinaryGeometry::Format format)
+{
+  Pos start;
+  if(legs.first().sid)
+    // Transitions of a SID start at the end of the common route
+    start = sidEndPos.value(legs.first().approachId);
+
+  for(int i = 0; i < legs.size(); i++)
+  {
+    LineString line;
+    calculateLeg(line, legs, i, start);
+    line.removeInvalid();
+    line.removeDuplicates();
+
+    if(line.isEmpty())
+    {
+      numSkipped++;
+      start = Pos();
+      continue;
+    }
+
+    start = line.last();
+    if(line.size() > 2)
+      line.simplify(SIMPLIFY_TOLERANCE_DEG);
+
+    atools::fs::common::BinaryGeometry geometry(line);
+    insertQuery.bindValue(":id", legs.at(i).id);
+    insertQuery.bindValue(":num", line.size());
+    insertQuery.bindValue(":geometry", geometry.writeToByteArray(format));
+    insertQuery.exec();
+    numWritten++;
+  }
+
+  if(legs.first().sid && start.isValid())
+    sidEndPos.insert(legs.first().approachId, start);
+}
+
+void ProcedureGeometry::calculateLeg(LineString& line, const QVector<Leg>& legs, int index, const Pos& start) const
+{
+  const Leg& leg = legs.at(index);
+  const QString& type = leg.type;
+
+  // Heading and course legs start at the previous termination or at the fix
+  Pos from = start.isValid() ? start : leg.fix;
+
+  if(type == "IF")
+    line.append(leg.fix);
+  else if(type == "TF" || type == "DF" || type == "CF")
+  {
+    if(!leg.fix.isValid())
+      return;
+
+    if(start.isValid())
+      line.append(start);
+    else if(type == "CF" && leg.hasCourse && leg.hasDistance && leg.distanceNm > 0.f)
+      // First leg - calculate start from course and distance
+      line.append(leg.fix.endpoint(nmToMeter(leg.distanceNm), opposedCourseDeg(leg.course)));
+    line.append(leg.fix);
+  }
+  else if(type == "AF" || type == "RF")
+  {
+    // Arc around recommended navaid or center fix
+    if(!leg.fix.isValid())
+      return;
+
+    if(start.isValid() && leg.recommended.isValid())
+      line.append(LineString(leg.recommended, start, leg.fix, leg.turnRight(), CIRCLE_SEGMENTS));
+    else if(start.isValid())
+      line.append(start);
+    line.append(leg.fix);
+  }
+  else if(type == "HA" || type == "HF" || type == "HM")
+  {
+    if(leg.fix.isValid())
+      hold(line, leg.fix, leg.course, leg.turn != "L", leg.lengthNm(SPEED_KTS / 60.f));
+  }
+  else if(type == "PI")
+  {
+    // Simplified procedure turn - outbound, turn and back on the reverse course
+    if(!leg.fix.isValid())
+      return;
+
+    float side = leg.turnRight() ? 90.f : -90.f;
+    Pos outbound = leg.fix.endpoint(nmToMeter(leg.lengthNm(leg.rho > 0.f ? leg.rho : MANUAL_NM)), leg.course);
+    Pos turned = outbound.endpoint(nmToMeter(TURN_RADIUS_NM * 2.f), normalizeCourse(leg.course + side));
+    line.append(leg.fix);
+    line.append(outbound);
+    line.append(turned);
+    line.append(turned.endpoint(nmToMeter(MANUAL_NM), opposedCourseDeg(leg.course)));
+  }
+  else
+  {
+    // Leg types starting at the fix
+    bool fromFix = type.startsWith('F');
+    if(fromFix)
+      from = leg.fix;
+
+    if(!from.isValid() || !leg.hasCourse)
+      return;
+
+    line.append(from);
+
+    if(type == "FA" || type == "CA" || type == "VA")
+      line.append(from.endpoint(nmToMeter(leg.altitudeLengthNm()), leg.course));
+    else if(type == "FD" || type == "CD" || type == "VD")
+      line.append(dmeTermination(from, leg.course, leg.recommended, leg.lengthNm(MANUAL_NM)));
+    else if(type == "FC")
+      line.append(from.endpoint(nmToMeter(leg.lengthNm(MANUAL_NM)), leg.course));
+    else if(type == "CR" || type == "VR")
+    {
+      Pos radial = leg.recommended.isValid() ?
+                   Pos::intersectingRadials(from, leg.course, leg.recommended, leg.theta) : Pos();
+      if(radial.isValid() && from.distanceMeterTo(radial) < nmToMeter(MAX_INTERCEPT_NM))
+        line.append(radial);
+      else
+        line.append(from.endpoint(nmToMeter(MANUAL_NM), leg.course));
+    }
+    else if(type == "CI" || type == "VI")
+    {
+      // Intercept the inbound course of the next leg
+      Pos intercept;
+      if(index + 1 < legs.size())
+      {
+        const Leg& next = legs.at(index + 1);
+        if(next.fix.isValid() && next.hasCourse)
+          intercept = Pos::intersectingRadials(from, leg.course, next.fix, opposedCourseDeg(next.course));
+      }
+
+      if(intercept.isValid() && from.distanceMeterTo(intercept) < nmToMeter(MAX_INTERCEPT_NM))
+        line.append(intercept);
+      else
+        line.append(from.endpoint(nmToMeter(MANUAL_NM), leg.course));
+    }
+    else
+      // FM, VM and unknown
+      line.append(from.endpoint(nmToMeter(leg.lengthNm(MANUAL_NM)), leg.course));
+  }
+}
+
+void ProcedureGeometry::getApproachLegGeometry(atools::geo::LineString& geometry, int approachLegId) const
+{
+  geometry.clear();
+
+  sql::SqlQuery query(db);
+  query.prepare("select geometry from approach_leg_geometry where approach_leg_id = :id");
+  query.bindValue(":id", approachLegId);
+  query.exec();
+  if(query.next())
+    atools::fs::common::BinaryGeometry(query.value(0).toByteArray()).swapGeometry(geometry);
+}
+
+void ProcedureGeometry::getTransitionLegGeometry(atools::geo::LineString& geometry, int transitionLegId) const
+{
+  geometry.clear();
+
+  sql::SqlQuery query(db);
+  query.prepare("select geometry from transition_leg_geometry where transition_leg_id = :id");
+  query.bindValue(":id", transitionLegId);
+  query.exec();
+  if(query.next())
+    atools::fs::common::BinaryGeometry(query.value(0).toByteArray()).swapGeometry(geometry);
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,109 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_PROCEDUREGEOMETRY_H
+#define ATOOLS_FS_DB_PROCEDUREGEOMETRY_H
+
+#include "fs/common/binarygeometry.h"
+#include "geo/pos.h"
+
+#include <QMultiHash>
+
+namespace atools {
+namespace geo {
+class LineString;
+}
+namespace sql {
+class SqlDatabase;
+class SqlQuery;
+}
+
+namespace fs {
+namespace db {
+
+/*
+ * Calculates the geometry of all procedure legs once after loading and writes it to the tables
+ * approach_leg_geometry and transition_leg_geometry.
+ *
+ * Fixes, arcs, DME and radial terminations, intercepts and holds are calculated from the leg parameters.
+ * Distances for altitude and manual terminations are estimated. The geometry starts at the end of the
+ * previous leg and ends at the termination of the leg. Legs having no fix position or no previous leg
+ * where needed are not stored.
+ */
+class ProcedureGeometry
+{
+public:
+  ProcedureGeometry(atools::sql::SqlDatabase *sqlDb);
+
+  /* Replace all rows in both geometry tables. Throws SqlException in case of error. */
+  void write(atools::fs::common::BinaryGeometry::Format format);
+
+  /* Get the stored geometry for a leg. Geometry is empty if the leg has no stored geometry. */
+  void getApproachLegGeometry(atools::geo::LineString& geometry, int approachLegId) const;
+  void getTransitionLegGeometry(atools::geo::LineString& geometry, int transitionLegId) const;
+
+  /* Number of leg geometries written */
+  int getNumWritten() const
+  {
+    return numWritten;
+  }
+
+  /* Number of legs skipped because of missing fixes */
+  int getNumSkipped() const
+  {
+    return numSkipped;
+  }
+
+private:
+  struct Leg;
+
+  /* Load positions of all navaids, waypoints, runway ends and airports */
+  void loadFixes();
+
+  /* Read legs of all approaches or transitions and write the geometry. Procedures are ordered by id. */
+  void writeLegs(const QString& legTable, const QString& queryStr, atools::fs::common::BinaryGeometry::Format format);
+  void writeProcedure(atools::sql::SqlQuery& insertQuery, QVector<Leg>& legs,
+                      atools::fs::common::BinaryGeometry::Format format);
+
+  /* Calculate geometry for leg at index where start is the end of the previous leg or invalid */
+  void calculateLeg(atools::geo::LineString& line, const QVector<Leg>& legs, int index,
+                    const atools::geo::Pos& start) const;
+
+  atools::geo::Pos fixPos(const QString& type, const QString& ident, const QString& region,
+                          int airportId, const atools::geo::Pos& airportPos) const;
+
+  atools::sql::SqlDatabase *db;
+  int numWritten = 0, numSkipped = 0;
+
+  struct Fix
+  {
+    QString region;
+    atools::geo::Pos pos;
+  };
+
+  /* Key is type and ident. Multiple entries for equal keys - nearest to the airport is used. */
+  QMultiHash<QString, Fix> fixes;
+
+  /* End position of the last leg of each SID to connect the following transitions */
+  QHash<int, atools::geo::Pos> sidEndPos;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_PROCEDUREGEOMETRY_H
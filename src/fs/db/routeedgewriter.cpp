@@ -25,6 +25,11 @@
 #include "fs/progresshandler.h"
 
 #include <QElapsedTimer>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QSet>
+
+#include <numeric>
 
 namespace atools {
 namespace fs {
@@ -61,8 +66,40 @@ const int PRIORITY_BY_TYPE[] = {0 /* None */, 2 /* VOR */, 3 /* VORDME */, 0 /*
 const float INFLATE_RECT_LON_DEGREES = 6.f;
 const float INFLATE_RECT_LAT_DEGREES = 4.f;
 
-/* Report progress twice a second */
-const int MIN_PROGRESS_REPORT_MS = 500;
+/* Candidate node for an edge */
+struct TempNodeTo
+{
+  int nodeId;
+  int type; // VOR=1, VORDME=2, DME=3, NDB=4,
+  int range;
+  int distance;
+  int priority;
+};
+
+/* Keeps the first MAX_EDGES_PER_SECTOR nodes of a sector in sort order. Equal nodes are inserted in front of
+ * existing ones like a sorted insert using std::lower_bound. */
+struct SectorNodes
+{
+  TempNodeTo nodes[MAX_EDGES_PER_SECTOR];
+  int size = 0;
+
+  template<typename LESS>
+  void insert(const TempNodeTo& node, LESS lessThan)
+  {
+    int pos = 0;
+    while(pos < size && lessThan(nodes[pos], node))
+      pos++;
+
+    if(pos < MAX_EDGES_PER_SECTOR)
+    {
+      for(int i = std::min(size, MAX_EDGES_PER_SECTOR - 1); i > pos; i--)
+        nodes[i] = nodes[i - 1];
+      nodes[pos] = node;
+      size = std::min(size + 1, MAX_EDGES_PER_SECTOR);
+    }
+  }
+
+};
 
 // Query result column indexes
 enum ColumnIndex
@@ -85,228 +122,390 @@ RouteEdgeWriter::RouteEdgeWriter(atools::sql::SqlDatabase *sqlDb, atools::fs::Pr
 
 }
 
+/* Read all nodes and add them to the spatial index. Index payload is the position in the node list. */
+void RouteEdgeWriter::loadNodes()
+{
+  SqlQuery query("select node_id, range, type, lonx, laty from route_node_radio", db);
+  query.exec();
+  while(query.next())
+  {
+    Pos pos(query.value(LONX).toFloat(), query.value(LATY).toFloat());
+    nodeIndex.insert(Rect(pos), nodes.size());
+    nodes.append({query.value(NODE_ID).toInt(), query.value(RANGE).toInt(), query.value(TYPE).toInt(), pos});
+  }
+
+  // Build now since the index is read by several threads later
+  nodeIndex.build();
+}
+
+void RouteEdgeWriter::setRegion(const Rect& value)
+{
+  region = value;
+}
+
+void RouteEdgeWriter::prepareRegion()
+{
+  // Nodes within radio range of the region can get new neighbours
+  Rect outerRect(region);
+  for(const Pos& corner : {region.getTopLeft(), region.getTopRight(), region.getBottomLeft(), region.getBottomRight()})
+    outerRect.extend(Rect(corner, MAX_RADIO_RANGE_METER));
+
+  QSet<int> nodeIndexes;
+  for(int i : nodeIndex.getOverlapping(outerRect))
+    nodeIndexes.insert(i);
+
+  // Nodes outside having edges to nodes which were removed from the region
+  QHash<int, int> indexByNodeId;
+  for(int i = 0; i < nodes.size(); i++)
+    indexByNodeId.insert(nodes.at(i).nodeId, i);
+
+  SqlQuery query(db);
+  query.exec("select distinct from_node_id from route_edge_radio "
+             "where to_node_id not in (select node_id from route_node_radio)");
+  while(query.next())
+  {
+    int index = indexByNodeId.value(query.valueInt(0), -1);
+    if(index != -1)
+      nodeIndexes.insert(index);
+  }
+
+  // Remove all edges from or to removed nodes
+  query.exec("delete from route_edge_radio "
+             "where from_node_id not in (select node_id from route_node_radio) or "
+             "to_node_id not in (select node_id from route_node_radio)");
+  int deleted = query.numRowsAffected();
+
+  processNodes = nodeIndexes.toList().toVector();
+  std::sort(processNodes.begin(), processNodes.end());
+
+  // Remove edges of all nodes which will be calculated again
+  QVariantList fromNodeIdVars;
+  for(int i : processNodes)
+    fromNodeIdVars.append(nodes.at(i).nodeId);
+
+  if(!fromNodeIdVars.isEmpty())
+  {
+    SqlQuery deleteQuery(db);
+    deleteQuery.prepare("delete from route_edge_radio where from_node_id = ?");
+    deleteQuery.addBindValue(fromNodeIdVars);
+    deleteQuery.execBatch();
+    deleted += deleteQuery.numRowsAffected();
+  }
+
+  qInfo() << "Region" << region << ": removed" << deleted << "from route_edge_radio table";
+}
+
+void RouteEdgeWriter::nodesInRect(QVector<Node>& result, const Rect& queryRect, SqlQuery *nearestStmt)
+{
+  if(nearestStmt != nullptr)
+  {
+    for(const Rect& rect : queryRect.splitAtAntiMeridian())
+    {
+      bindCoordinatePointInRect(rect, nearestStmt);
+
+      nearestStmt->exec();
+      while(nearestStmt->next())
+        result.append({nearestStmt->value(NODE_ID).toInt(), nearestStmt->value(RANGE).toInt(),
+                       nearestStmt->value(TYPE).toInt(),
+                       Pos(nearestStmt->value(LONX).toFloat(), nearestStmt->value(LATY).toFloat())});
+    }
+  }
+  else
+  {
+    for(int i : nodeIndex.getOverlapping(queryRect))
+      result.append(nodes.at(i));
+  }
+}
+
+/* Calculates edges for a range of nodes in a worker thread */
+class RouteEdgeTask :
+  public QRunnable
+{
+public:
+  RouteEdgeTask(RouteEdgeWriter *edgeWriter, int beginIndex, int endIndex, RouteEdgeWriter::Edges *edgeList)
+    : writer(edgeWriter), begin(beginIndex), end(endIndex), edges(edgeList)
+  {
+    setAutoDelete(true);
+  }
+
+  virtual void run() override
+  {
+    writer->nodeEdges(begin, end, nullptr, *edges);
+  }
+
+private:
+  RouteEdgeWriter *writer;
+  int begin, end;
+  RouteEdgeWriter::Edges *edges;
+};
+
 bool RouteEdgeWriter::run()
 {
   bool aborted = false;
 
-  // Iterate over all radio navaids
-  SqlQuery selectNodesQuery("select node_id, range, type, lonx, laty from route_node_radio", db);
+  // All radio navaids in memory with spatial index for the nearest searches
+  nodes.clear();
+  nodeIndex.clear();
+  loadNodes();
 
-  // Get all nodes nearby this navaids
+  // Get all nodes nearby this navaids if SQL is used for searching
   SqlQuery nearestNodesQuery(db);
-  nearestNodesQuery.prepare("select node_id, range, type, lonx, laty from route_node_radio "
-                            "where lonx between ? and ? and laty between ? and ?");
+  if(useSql)
+    nearestNodesQuery.prepare("select node_id, range, type, lonx, laty from route_node_radio "
+                              "where lonx between ? and ? and laty between ? and ?");
 
-  // Insert edges into databases
-  SqlQuery insertEdgesQuery(db);
-  insertEdgesQuery.prepare("insert into route_edge_radio "
-                           "(from_node_id, from_node_type, to_node_id, to_node_type, distance) "
-                           "values(?, ?, ?, ?, ?)");
+  // Database connection cannot be shared between threads
+  int threads = useSql ? 1 : std::max(numThreads, 1);
 
-  // Clean the result table
-  SqlQuery stmt(db);
-  stmt.exec("delete from route_edge_radio");
-  int deleted = stmt.numRowsAffected();
-  qInfo() << "Removed" << deleted << "from route_edge_radio table";
+  processNodes.clear();
+  if(region.isValid())
+    prepareRegion();
+  else
+  {
+    // Clean the result table
+    SqlQuery stmt(db);
+    stmt.exec("delete from route_edge_radio");
+    int deleted = stmt.numRowsAffected();
+    qInfo() << "Removed" << deleted << "from route_edge_radio table";
+
+    processNodes.resize(nodes.size());
+    std::iota(processNodes.begin(), processNodes.end(), 0);
+  }
 
-  int numRows = SqlUtil(db).rowCount("route_node_radio");
-  qInfo() << numRows << "nodes to process";
-  int rowsPerStep = static_cast<int>(std::ceil(static_cast<float>(numRows) / static_cast<float>(numSteps)));
+  int numRows = processNodes.size();
+  qInfo() << numRows << "nodes to process using" << threads << "threads";
+  int rowsPerStep = std::max(static_cast<int>(std::ceil(static_cast<float>(numRows) /
+                                                        static_cast<float>(numSteps))), 1);
 
-  QVariantList toNodeIdVars, toNodeTypeVars, toNodeDistanceVars, fromNodeIdVars, fromNodeTypeVars;
+  QThreadPool threadPool;
+  threadPool.setMaxThreadCount(threads);
 
   QElapsedTimer timer;
   timer.start();
-  qint64 elapsed = timer.elapsed();
-  int row = 0, steps = 0;
-  int average = 0, total = 0, maximum = 0, numEmpty = 0;
+  int steps = 0;
 
-  selectNodesQuery.exec();
-  while(selectNodesQuery.next())
+  // Process nodes in blocks of one progress step. Each block is split into one range per thread.
+  // Results are collected in node order which keeps the output independent of the number of threads.
+  Edges edges;
+  for(int blockBegin = 0; blockBegin < numRows; blockBegin += rowsPerStep)
   {
-    if((row++ % rowsPerStep) == 0)
+    // Calls handler only every 500 ms - otherwise updates only progress count
+    steps++;
+    if((aborted = progressHandler.reportOtherThrottled(tr("Populating VOR/NDB Routing Table"))) == true)
+      break;
+
+    int blockEnd = std::min(blockBegin + rowsPerStep, numRows);
+    if(threads > 1)
     {
-      qint64 elapsed2 = timer.elapsed();
+      int rangeSize = (blockEnd - blockBegin + threads - 1) / threads;
+      QVector<Edges> rangeEdges(threads);
+      for(int i = 0; i < threads; i++)
+      {
+        int rangeBegin = std::min(blockBegin + i * rangeSize, blockEnd);
+        int rangeEnd = std::min(rangeBegin + rangeSize, blockEnd);
+        if(rangeBegin < rangeEnd)
+          threadPool.start(new RouteEdgeTask(this, rangeBegin, rangeEnd, &rangeEdges[i]));
+      }
+      threadPool.waitForDone();
 
-      // Update only every 500 ms - otherwise update only progress count
-      bool silent = !(elapsed + MIN_PROGRESS_REPORT_MS < elapsed2);
-      if(!silent)
-        elapsed = elapsed2;
+      for(const Edges& rangeEdge : rangeEdges)
+        edges.append(rangeEdge);
+    }
+    else
+      nodeEdges(blockBegin, blockEnd, useSql ? &nearestNodesQuery : nullptr, edges);
+  }
 
-      steps++;
-      if((aborted = progressHandler.reportOther(tr("Populating VOR/NDB Routing Table"), -1, silent)) == true)
-        break;
+  if(!aborted)
+  {
+    writeEdges(edges);
+
+    int total = edges.toNodeIds.size(), average = 0, maximum = 0, numEmpty = 0;
+    for(int count : edges.numEdges)
+    {
+      average = (average + count) / 2;
+      maximum = std::max(maximum, count);
+      if(count == 0)
+        numEmpty++;
     }
 
-    // Look at each node
-    int fromRangeMeter = selectNodesQuery.value(RANGE).toInt();
-    int fromNodeId = selectNodesQuery.value(NODE_ID).toInt();
-    int fromNodeType = selectNodesQuery.value(TYPE).toInt();
+    qDebug() << "Edge writer: total" << total << "average" << average
+             << "max" << maximum << "numEmpty" << numEmpty << "time" << timer.elapsed() << "ms";
+  }
+
+  nodes.clear();
+  nodeIndex.clear();
+  processNodes.clear();
+
+  // Eat up any remaining progress steps
+  progressHandler.increaseCurrent(numSteps - steps);
+
+  if(!aborted)
+    db->commit();
+
+  return aborted;
+}
 
-    Pos pos(selectNodesQuery.value(LONX).toFloat(), selectNodesQuery.value(LATY).toFloat());
+void RouteEdgeWriter::nodeEdges(int begin, int end, SqlQuery *nearestStmt, Edges& edges)
+{
+  QVector<Node> candidates;
+  QVector<int> toNodeIds, toNodeTypes, toNodeDistances;
+  NearestBuffers buffers;
+
+  for(int index = begin; index < end; index++)
+  {
+    // Look at each node
+    const Node& node = nodes.at(processNodes.at(index));
+    int fromRangeMeter = node.range;
+    int fromNodeId = node.nodeId;
+    int fromNodeType = node.type;
+    const Pos& pos = node.pos;
 
     // Clear result lists
-    toNodeIdVars.clear();
-    toNodeTypeVars.clear();
-    toNodeDistanceVars.clear();
+    toNodeIds.clear();
+    toNodeTypes.clear();
+    toNodeDistances.clear();
 
     // Get all navaids in bounding rectangle - first iterations
     Rect queryRect(pos, MAX_RADIO_RANGE_METER);
-    bool nearestSatisfied = nearest(nearestNodesQuery, fromNodeId, pos, queryRect, fromRangeMeter,
-                                    toNodeIdVars, toNodeTypeVars, toNodeDistanceVars);
+    candidates.clear();
+    nodesInRect(candidates, queryRect, nearestStmt);
+    bool nearestSatisfied = nearest(candidates, fromNodeId, pos, fromRangeMeter, buffers,
+                                    toNodeIds, toNodeTypes, toNodeDistances);
 
     // If not all sectors have an edge increase rectangle and try again for MAX_ITERATIONS
     int maxIter = 0;
     while(!nearestSatisfied)
     {
-      toNodeIdVars.clear();
-      toNodeTypeVars.clear();
-      toNodeDistanceVars.clear();
+      toNodeIds.clear();
+      toNodeTypes.clear();
+      toNodeDistances.clear();
       queryRect.inflate(INFLATE_RECT_LON_DEGREES, INFLATE_RECT_LAT_DEGREES);
-      nearestSatisfied = nearest(nearestNodesQuery, fromNodeId, pos, queryRect, fromRangeMeter,
-                                 toNodeIdVars, toNodeTypeVars, toNodeDistanceVars);
+      candidates.clear();
+      nodesInRect(candidates, queryRect, nearestStmt);
+      nearestSatisfied = nearest(candidates, fromNodeId, pos, fromRangeMeter, buffers,
+                                 toNodeIds, toNodeTypes, toNodeDistances);
       if(maxIter++ > MAX_ITERATIONS)
         break;
     }
 
-    // Update from value arrays with values for bind
-    fromNodeIdVars.clear();
-    fromNodeTypeVars.clear();
-    for(int i = 0; i < toNodeIdVars.size(); i++)
+    for(int i = 0; i < toNodeIds.size(); i++)
     {
-      fromNodeIdVars.append(fromNodeId);
-      fromNodeTypeVars.append(fromNodeType);
+      edges.fromNodeIds.append(fromNodeId);
+      edges.fromNodeTypes.append(fromNodeType);
     }
-
-    // Use batch update to insert values into edge table
-    insertEdgesQuery.addBindValue(fromNodeIdVars);
-    insertEdgesQuery.addBindValue(fromNodeTypeVars);
-    insertEdgesQuery.addBindValue(toNodeIdVars);
-    insertEdgesQuery.addBindValue(toNodeTypeVars);
-    insertEdgesQuery.addBindValue(toNodeDistanceVars);
-    insertEdgesQuery.execBatch();
-
-    total += toNodeIdVars.size();
-    average = (average + toNodeIdVars.size()) / 2;
-    maximum = std::max(maximum, toNodeIdVars.size());
-
-    if(toNodeIdVars.size() == 0)
-      numEmpty++;
+    edges.toNodeIds.append(toNodeIds);
+    edges.toNodeTypes.append(toNodeTypes);
+    edges.distances.append(toNodeDistances);
+    edges.numEdges.append(toNodeIds.size());
   }
+}
 
-  qDebug() << "Edge writer: total" << total << "average" << average
-           << "max" << maximum << "numEmpty" << numEmpty;
-
-  // Eat up any remaining progress steps
-  progressHandler.increaseCurrent(numSteps - steps);
-
-  if(!aborted)
-    db->commit();
+void RouteEdgeWriter::writeEdges(const Edges& edges)
+{
+  QVariantList fromNodeIdVars, fromNodeTypeVars, toNodeIdVars, toNodeTypeVars, toNodeDistanceVars;
+  fromNodeIdVars.reserve(edges.fromNodeIds.size());
+  fromNodeTypeVars.reserve(edges.fromNodeIds.size());
+  toNodeIdVars.reserve(edges.fromNodeIds.size());
+  toNodeTypeVars.reserve(edges.fromNodeIds.size());
+  toNodeDistanceVars.reserve(edges.fromNodeIds.size());
+
+  for(int i = 0; i < edges.fromNodeIds.size(); i++)
+  {
+    fromNodeIdVars.append(edges.fromNodeIds.at(i));
+    fromNodeTypeVars.append(edges.fromNodeTypes.at(i));
+    toNodeIdVars.append(edges.toNodeIds.at(i));
+    toNodeTypeVars.append(edges.toNodeTypes.at(i));
+    toNodeDistanceVars.append(edges.distances.at(i));
+  }
 
-  return aborted;
+  // Insert edges into databases using one batch update
+  SqlQuery insertEdgesQuery(db);
+  insertEdgesQuery.prepare("insert into route_edge_radio "
+                           "(from_node_id, from_node_type, to_node_id, to_node_type, distance) "
+                           "values(?, ?, ?, ?, ?)");
+  insertEdgesQuery.addBindValue(fromNodeIdVars);
+  insertEdgesQuery.addBindValue(fromNodeTypeVars);
+  insertEdgesQuery.addBindValue(toNodeIdVars);
+  insertEdgesQuery.addBindValue(toNodeTypeVars);
+  insertEdgesQuery.addBindValue(toNodeDistanceVars);
+  insertEdgesQuery.execBatch();
 }
 
 /*
  * Get nearest neighbours for a navaid
- * @param nearestStmt
+ * @param candidates all nodes in the current query rectangle
  * @param fromNodeId node ID for current navaid
  * @param pos position of current navaid
- * @param queryRect current query rectangle
  * @param fromRangeMeter range for current navaid
  * @param toNodeIds result list
  * @param toNodeTypes result list
  * @param toNodeDistances result list
  * @return
  */
-bool RouteEdgeWriter::nearest(SqlQuery& nearestStmt, int fromNodeId, const Pos& pos, const Rect& queryRect,
-                              int fromRangeMeter, QVariantList& toNodeIds,
-                              QVariantList& toNodeTypes, QVariantList& toNodeDistances)
+bool RouteEdgeWriter::nearest(const QVector<Node>& candidates, int fromNodeId, const Pos& pos,
+                              int fromRangeMeter, NearestBuffers& buffers, QVector<int>& toNodeIds,
+                              QVector<int>& toNodeTypes, QVector<int>& toNodeDistances)
 {
-  struct TempNodeTo
+  // Calculate distances and courses to all candidates at once
+  buffers.positions.clear();
+  buffers.positions.reserve(candidates.size());
+  for(const Node& candidate : candidates)
+    buffers.positions.append(candidate.pos);
+  buffers.positions.distancesMeter(pos, buffers.distances);
+  buffers.positions.coursesDeg(pos, buffers.courses);
+
+  // Nodes with reachable navaids sorted by priority and farthest first - one list per sector
+  SectorNodes sectorsReachable[NUM_SECTORS];
+
+  // Nodes with unreachable navaids sorted by priority and nearest first - one list per sector
+  SectorNodes sectorsOther[NUM_SECTORS];
+
+  const float *distances = buffers.distances.constData(), *courses = buffers.courses.constData();
+  for(int i = 0; i < candidates.size(); i++)
   {
-    int nodeId;
-    int type; // VOR=1, VORDME=2, DME=3, NDB=4,
-    int range;
-    int distance;
-    int priority;
-  };
-
-  // Nodes with reachable navaids - one list of nodes per sector
-  QVector<QVector<TempNodeTo> > sectorsReachable;
-  for(int i = 0; i < NUM_SECTORS; i++)
-    sectorsReachable.append(QVector<TempNodeTo>());
-
-  // Nodes with unreachable navaids - one list of nodes per sector
-  QVector<QVector<TempNodeTo> > sectorsOther;
-  for(int i = 0; i < NUM_SECTORS; i++)
-    sectorsOther.append(QVector<TempNodeTo>());
-
-  for(const Rect& rect : queryRect.splitAtAntiMeridian())
-  {
-    bindCoordinatePointInRect(rect, &nearestStmt);
-
-    nearestStmt.exec();
-
-    while(nearestStmt.next())
-    {
-      int toNodeId = nearestStmt.value(NODE_ID).toInt();
-      if(toNodeId == fromNodeId)
-        continue;
-
-      int toRangeMeter = nearestStmt.value(RANGE).toInt();
-      Pos toPos(nearestStmt.value(LONX).toFloat(), nearestStmt.value(LATY).toFloat());
-      int distanceMeter = static_cast<int>(pos.distanceMeterTo(toPos) + 0.5f);
-
-      if(distanceMeter < MIN_DISTANCE_METER)
-        // Navaid is too close
-        continue;
-
-      int courseDeg = static_cast<int>(pos.angleDegTo(toPos) + 0.5f);
-      if(courseDeg >= 360)
-        courseDeg -= 360;
-
-      // Calculate sector number for this node
-      int sectorNum = courseDeg / (360 / NUM_SECTORS);
-
-      int toNodeType = nearestStmt.value(TYPE).toInt();
-
-      TempNodeTo tmp = {toNodeId, toNodeType, toRangeMeter, distanceMeter, PRIORITY_BY_TYPE[toNodeType]};
-
-      bool reachable = fromRangeMeter + toRangeMeter > distanceMeter;
-
-      QVector<TempNodeTo>::iterator it;
-
-      if(reachable)
-      {
-        QVector<TempNodeTo>& sector = sectorsReachable[sectorNum];
-
-        // farthest at beginning of list
-        it = std::lower_bound(sector.begin(), sector.end(), tmp,
-                              [](const TempNodeTo& n1, const TempNodeTo& n2) -> bool
-              {
-                if(n1.priority == n2.priority)
-                  return n1.distance > n2.distance;
-                else
-                  return n1.priority > n2.priority;
-              });
-        sector.insert(it, tmp);
-      }
-      else
-      {
-        QVector<TempNodeTo>& sector = sectorsOther[sectorNum];
-
-        // nearest at beginning of list
-        it = std::lower_bound(sector.begin(), sector.end(), tmp,
-                              [](const TempNodeTo& n1, const TempNodeTo& n2) -> bool
-              {
-                if(n1.priority == n2.priority)
-                  return n1.distance < n2.distance;
-                else
-                  return n1.priority > n2.priority;
-              });
-        sector.insert(it, tmp);
-      }
-    }
+    const Node& candidate = candidates.at(i);
+    int toNodeId = candidate.nodeId;
+    if(toNodeId == fromNodeId)
+      continue;
+
+    int toRangeMeter = candidate.range;
+    int distanceMeter = static_cast<int>(distances[i] + 0.5f);
+
+    if(distanceMeter < MIN_DISTANCE_METER)
+      // Navaid is too close
+      continue;
+
+    int courseDeg = static_cast<int>(courses[i] + 0.5f);
+    if(courseDeg >= 360)
+      courseDeg -= 360;
+
+    // Calculate sector number for this node
+    int sectorNum = courseDeg / (360 / NUM_SECTORS);
+
+    int toNodeType = candidate.type;
+
+    TempNodeTo tmp = {toNodeId, toNodeType, toRangeMeter, distanceMeter, PRIORITY_BY_TYPE[toNodeType]};
+
+    bool reachable = fromRangeMeter + toRangeMeter > distanceMeter;
+
+    if(reachable)
+      // farthest at beginning of list
+      sectorsReachable[sectorNum].insert(tmp, [](const TempNodeTo& n1, const TempNodeTo& n2) -> bool
+            {
+              if(n1.priority == n2.priority)
+                return n1.distance > n2.distance;
+              else
+                return n1.priority > n2.priority;
+            });
+    else
+      // nearest at beginning of list
+      sectorsOther[sectorNum].insert(tmp, [](const TempNodeTo& n1, const TempNodeTo& n2) -> bool
+            {
+              if(n1.priority == n2.priority)
+                return n1.distance < n2.distance;
+              else
+                return n1.priority > n2.priority;
+            });
   }
 
   bool retval = true;
@@ -314,10 +513,10 @@ bool RouteEdgeWriter::nearest(SqlQuery& nearestStmt, int fromNodeId, const Pos&
   // Now check for each sector if conditions are met
   for(int sectorNum = 0; sectorNum < NUM_SECTORS; sectorNum++)
   {
-    const QVector<TempNodeTo>& sectorReachable = sectorsReachable.value(sectorNum);
-    const QVector<TempNodeTo>& sectorOther = sectorsOther.value(sectorNum);
-    int numOtherEntries = std::min(sectorOther.size(), MAX_EDGES_PER_SECTOR);
-    int numReachableEntries = std::min(sectorReachable.size(), MAX_EDGES_PER_SECTOR);
+    const SectorNodes& sectorReachable = sectorsReachable[sectorNum];
+    const SectorNodes& sectorOther = sectorsOther[sectorNum];
+    int numOtherEntries = sectorOther.size;
+    int numReachableEntries = sectorReachable.size;
 
     // We need more nodes for this sector
     if(numOtherEntries + numReachableEntries < MIN_EDGES_PER_SECTOR)
@@ -326,7 +525,7 @@ bool RouteEdgeWriter::nearest(SqlQuery& nearestStmt, int fromNodeId, const Pos&
     // Add all reachable first for this sector
     for(int i = 0; i < numReachableEntries; i++)
     {
-      const TempNodeTo& tn = sectorReachable.at(i);
+      const TempNodeTo& tn = sectorReachable.nodes[i];
       toNodeIds.append(tn.nodeId);
       toNodeTypes.append(tn.type);
       toNodeDistances.append(tn.distance);
@@ -335,7 +534,7 @@ bool RouteEdgeWriter::nearest(SqlQuery& nearestStmt, int fromNodeId, const Pos&
     // Then add the unreachable
     for(int i = 0; i < numOtherEntries; i++)
     {
-      const TempNodeTo& tn = sectorOther.at(i);
+      const TempNodeTo& tn = sectorOther.nodes[i];
       toNodeIds.append(tn.nodeId);
       toNodeTypes.append(tn.type);
       toNodeDistances.append(tn.distance);
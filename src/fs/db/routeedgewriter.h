@@ -18,16 +18,18 @@
 #ifndef ATOOLS_ROUTEEDGEWRITER_H
 #define ATOOLS_ROUTEEDGEWRITER_H
 
+#include "geo/pos.h"
+#include "geo/posarray.h"
+#include "geo/rect.h"
+#include "geo/rtree.h"
+
 #include <QVariantList>
+#include <QVector>
 #include <QCoreApplication>
 
 class QString;
 
 namespace atools {
-namespace geo {
-class Rect;
-class Pos;
-}
 namespace sql {
 class SqlDatabase;
 class SqlQuery;
@@ -57,13 +59,91 @@ public:
    */
   bool run();
 
+  /* Search nearest nodes with SQL queries instead of the in memory index. Slower and always uses one thread.
+   * Default is false. */
+  void setUseSqlQueries(bool value)
+  {
+    useSql = value;
+  }
+
+  /* Limit run() to the nodes inside region plus MAX_RADIO_RANGE_METER and to nodes having edges to removed nodes.
+   * All other edges are kept. route_node_radio has to be updated inside region before calling run().
+   * An invalid region updates all edges which is the default. */
+  void setRegion(const atools::geo::Rect& value);
+
+  /* Number of threads for the in memory search. Default is 1. */
+  void setNumThreads(int value)
+  {
+    numThreads = value;
+  }
+
 private:
+  friend class RouteEdgeTask;
+
+  /* Radio navaid node as loaded from route_node_radio */
+  struct Node
+  {
+    int nodeId;
+    int range;
+    int type; // VOR=1, VORDME=2, DME=3, NDB=4,
+    atools::geo::Pos pos;
+  };
+
+  /* Edges for a range of nodes in node order */
+  struct Edges
+  {
+    QVector<int> fromNodeIds, fromNodeTypes, toNodeIds, toNodeTypes, distances;
+
+    /* Number of edges for each node */
+    QVector<int> numEdges;
+
+    void append(const Edges& other)
+    {
+      fromNodeIds.append(other.fromNodeIds);
+      fromNodeTypes.append(other.fromNodeTypes);
+      toNodeIds.append(other.toNodeIds);
+      toNodeTypes.append(other.toNodeTypes);
+      distances.append(other.distances);
+      numEdges.append(other.numEdges);
+    }
+
+  };
+
+  /* Reused buffers for the distance and course calculation to all candidates of a node */
+  struct NearestBuffers
+  {
+    atools::geo::PosArray positions;
+    QVector<float> distances, courses;
+  };
+
+  void loadNodes();
+
+  /* Select nodes to process and remove their edges */
+  void prepareRegion();
+
+  /* Calculate edges for nodes begin to end - 1. Thread safe if nearestStmt is null. */
+  void nodeEdges(int begin, int end, atools::sql::SqlQuery *nearestStmt, Edges& edges);
+  void writeEdges(const Edges& edges);
+
+  /* Collect all nodes in rectangle from database or from index if nearestStmt is null */
+  void nodesInRect(QVector<Node>& result, const atools::geo::Rect& queryRect, atools::sql::SqlQuery *nearestStmt);
+
   void bindCoordinatePointInRect(const atools::geo::Rect& rect, atools::sql::SqlQuery *query);
-  bool nearest(atools::sql::SqlQuery& nearestStmt, int fromNodeId, const geo::Pos& pos,
-               const geo::Rect& queryRect,
-               int fromRangeMeter, QVariantList& toNodeIds, QVariantList& toNodeTypes,
-               QVariantList& toNodeDistances);
+  bool nearest(const QVector<Node>& candidates, int fromNodeId, const geo::Pos& pos,
+               int fromRangeMeter, NearestBuffers& buffers, QVector<int>& toNodeIds, QVector<int>& toNodeTypes,
+               QVector<int>& toNodeDistances);
+
+  /* All nodes and index. Index payload is the position in the node list. Only valid while running. */
+  QVector<Node> nodes;
+  atools::geo::RTree<int> nodeIndex;
+
+  /* Indexes into nodes for which edges are calculated */
+  QVector<int> processNodes;
+
+  atools::geo::Rect region;
 
+  bool useSql = false;
+  int numThreads = 1;
   int numSteps = 10;
   atools::fs::ProgressHandler& progressHandler;
   atools::sql::SqlDatabase *db;
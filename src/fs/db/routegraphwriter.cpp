@@ -0,0 +1,200 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/routegraphwriter.h"
+#include "fs/common/routegraph.h"
+#include "geo/pos.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+
+#include <cstring>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+using atools::sql::SqlQuery;
+using atools::fs::common::RouteGraph;
+using atools::fs::common::RouteGraphFileHeader;
+
+/* Write array content in native byte order */
+template<typename TYPE>
+static void writeArray(QIODevice& device, const QVector<TYPE>& array)
+{
+  if(!array.isEmpty())
+    device.write(reinterpret_cast<const char *>(array.constData()),
+                 static_cast<qint64>(array.size()) * static_cast<qint64>(sizeof(TYPE)));
+}
+
+RouteGraphWriter::RouteGraphWriter(sql::SqlDatabase *sqlDb)
+  : db(sqlDb)
+{
+
+}
+
+bool RouteGraphWriter::write(const QString& filename)
+{
+  Graph graphs[common::ROUTE_NUM_NETWORKS];
+  readGraph(graphs[common::ROUTE_RADIO], false);
+  readGraph(graphs[common::ROUTE_AIRWAY], true);
+
+  RouteGraphFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, "ATRG", 4);
+  header.version = RouteGraph::FILE_VERSION;
+
+  quint64 offset = (sizeof(RouteGraphFileHeader) + 7ULL) & ~7ULL;
+  for(int i = 0; i < common::ROUTE_NUM_NETWORKS; i++)
+  {
+    header.numNodes[i] = static_cast<quint32>(graphs[i].nodeIds.size());
+    header.numEdges[i] = static_cast<quint32>(graphs[i].edgeTargets.size());
+    header.offset[i] = offset;
+    offset += RouteGraph::graphSize(header.numNodes[i], header.numEdges[i]);
+  }
+
+  QFile file(filename);
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot write route graph" << filename << file.errorString();
+    return false;
+  }
+
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  for(int i = 0; i < common::ROUTE_NUM_NETWORKS; i++)
+  {
+    // Pad up to graph start
+    QByteArray padding(static_cast<int>(header.offset[i] - static_cast<quint64>(file.pos())), '\0');
+    file.write(padding);
+    writeGraph(file, graphs[i]);
+  }
+
+  bool ok = file.error() == QFileDevice::NoError;
+  file.close();
+
+  if(ok)
+    qInfo() << Q_FUNC_INFO << "Wrote route graph" << filename << file.size() << "bytes";
+  else
+    qWarning() << Q_FUNC_INFO << "Error writing route graph" << filename << file.errorString();
+  return ok;
+}
+
+void RouteGraphWriter::readGraph(Graph& graph, bool airway)
+{
+  QString table = airway ? "airway" : "radio";
+
+  // Nodes ordered by id allow binary search in the reader
+  QHash<int, int> nodeIndexById;
+  SqlQuery nodeQuery("select node_id, type, lonx, laty from route_node_" + table + " order by node_id", db);
+  nodeQuery.exec();
+  while(nodeQuery.next())
+  {
+    nodeIndexById.insert(nodeQuery.valueInt(0), graph.nodeIds.size());
+    graph.nodeIds.append(nodeQuery.valueInt(0));
+    graph.nodeTypes.append(nodeQuery.valueInt(1));
+    graph.lonX.append(nodeQuery.valueFloat(2));
+    graph.latY.append(nodeQuery.valueFloat(3));
+  }
+
+  // Airway table has no distance column - calculated from the node positions below
+  QString columns = airway ?
+                    "from_node_id, to_node_id, -1, airway_id, type, direction, minimum_altitude, maximum_altitude" :
+                    "from_node_id, to_node_id, distance, 0, 0, 0, 0, 0";
+
+  // Collect edges for each source node - airway segments are added in both directions
+  QVector<QVector<Edge> > nodeEdges(graph.nodeIds.size());
+
+  SqlQuery edgeQuery("select " + columns + " from route_edge_" + table + " order by edge_id", db);
+  edgeQuery.exec();
+  while(edgeQuery.next())
+  {
+    int from = nodeIndexById.value(edgeQuery.valueInt(0), -1);
+    int to = nodeIndexById.value(edgeQuery.valueInt(1), -1);
+    if(from == -1 || to == -1)
+    {
+      qWarning() << Q_FUNC_INFO << "Edge with unknown node in" << table
+                 << edgeQuery.valueInt(0) << edgeQuery.valueInt(1);
+      continue;
+    }
+
+    int distance = edgeQuery.valueInt(2);
+    if(distance < 0)
+      distance = static_cast<int>(atools::geo::Pos(graph.lonX.at(from), graph.latY.at(from)).
+                                  distanceMeterTo(atools::geo::Pos(graph.lonX.at(to), graph.latY.at(to))) + 0.5f);
+
+    Edge edge = {to, distance, edgeQuery.valueInt(3), edgeQuery.valueInt(4), edgeQuery.valueInt(5),
+                 edgeQuery.valueInt(6), edgeQuery.valueInt(7)};
+    nodeEdges[from].append(edge);
+
+    if(airway)
+    {
+      // Reverse edge - forward only becomes backward only and vice versa
+      edge.target = from;
+      if(edge.direction == 1)
+        edge.direction = 2;
+      else if(edge.direction == 2)
+        edge.direction = 1;
+      nodeEdges[to].append(edge);
+    }
+  }
+
+  graph.edgeOffsets.append(0);
+  for(const QVector<Edge>& edges : nodeEdges)
+  {
+    for(const Edge& edge : edges)
+    {
+      graph.edgeTargets.append(static_cast<quint32>(edge.target));
+      graph.distances.append(edge.distance);
+      graph.airwayIds.append(edge.airwayId);
+      graph.types.append(edge.type);
+      graph.directions.append(edge.direction);
+      graph.minAltitudes.append(edge.minAltitude);
+      graph.maxAltitudes.append(edge.maxAltitude);
+    }
+    graph.edgeOffsets.append(static_cast<quint32>(graph.edgeTargets.size()));
+  }
+}
+
+void RouteGraphWriter::writeGraph(QIODevice& device, const Graph& graph)
+{
+  writeArray(device, graph.nodeIds);
+  writeArray(device, graph.nodeTypes);
+  writeArray(device, graph.lonX);
+  writeArray(device, graph.latY);
+  writeArray(device, graph.edgeOffsets);
+  writeArray(device, graph.edgeTargets);
+  writeArray(device, graph.distances);
+  writeArray(device, graph.airwayIds);
+  writeArray(device, graph.types);
+  writeArray(device, graph.directions);
+  writeArray(device, graph.minAltitudes);
+  writeArray(device, graph.maxAltitudes);
+
+  // Pad to eight byte alignment as expected by RouteGraph::graphSize
+  qint64 size = static_cast<qint64>(RouteGraph::graphSize(static_cast<quint32>(graph.nodeIds.size()),
+                                                          static_cast<quint32>(graph.edgeTargets.size())));
+  qint64 written = (graph.nodeIds.size() * 5LL + 1LL + graph.edgeTargets.size() * 7LL) * 4LL;
+  if(size > written)
+    device.write(QByteArray(static_cast<int>(size - written), '\0'));
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,71 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_ROUTEGRAPHWRITER_H
+#define ATOOLS_FS_DB_ROUTEGRAPHWRITER_H
+
+#include <QVector>
+
+class QIODevice;
+class QString;
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace db {
+
+/*
+ * Exports the route network tables route_node_radio, route_edge_radio, route_node_airway and
+ * route_edge_airway into a binary graph file in compressed sparse row format.
+ * Use atools::fs::common::RouteGraph to read the file.
+ */
+class RouteGraphWriter
+{
+public:
+  RouteGraphWriter(atools::sql::SqlDatabase *sqlDb);
+
+  /* Write graph file. Returns false and logs a warning if the file cannot be written. */
+  bool write(const QString& filename);
+
+private:
+  struct Graph
+  {
+    QVector<qint32> nodeIds, nodeTypes;
+    QVector<float> lonX, latY;
+    QVector<quint32> edgeOffsets, edgeTargets;
+    QVector<qint32> distances, airwayIds, types, directions, minAltitudes, maxAltitudes;
+  };
+
+  struct Edge
+  {
+    int target, distance, airwayId, type, direction, minAltitude, maxAltitude;
+  };
+
+  void readGraph(Graph& graph, bool airway);
+  void writeGraph(QIODevice& device, const Graph& graph);
+
+  atools::sql::SqlDatabase *db;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_ROUTEGRAPHWRITER_H
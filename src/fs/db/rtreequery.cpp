@@ -0,0 +1,84 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/rtreequery.h"
+
+#include "geo/rect.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlutil.h"
+
+#include <QStringList>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+static QString num(float value)
+{
+  return QString::number(static_cast<double>(value), 'f', 6);
+}
+
+bool RTreeQuery::isAvailable(sql::SqlDatabase *db)
+{
+  sql::SqlQuery query(db);
+  query.exec("select sqlite_compileoption_used('ENABLE_RTREE')");
+  return query.next() && query.valueBool(0);
+}
+
+bool RTreeQuery::hasIndex(sql::SqlDatabase *db, const QString& table)
+{
+  return sql::SqlUtil(db).hasTable(indexTable(table));
+}
+
+QString RTreeQuery::overlapCondition(const geo::Rect& rect)
+{
+  if(!rect.isValid())
+    return "0";
+
+  QStringList conditions;
+  for(const atools::geo::Rect& r : rect.splitAtAntiMeridian())
+  {
+    QString lat = QString("min_laty <= %1 and max_laty >= %2").arg(num(r.getNorth())).arg(num(r.getSouth()));
+
+    // Normal rectangles and rectangles crossing the anti-meridian which extend beyond 180
+    conditions.append(QString("(min_lonx <= %1 and max_lonx >= %2 and %3)").
+                      arg(num(r.getEast())).arg(num(r.getWest())).arg(lat));
+    conditions.append(QString("(min_lonx <= %1 and max_lonx >= %2 and %3)").
+                      arg(num(r.getEast() + 360.f)).arg(num(r.getWest() + 360.f)).arg(lat));
+  }
+  return conditions.join(" or ");
+}
+
+QString RTreeQuery::rectCondition(const QString& table, const QString& idColumn, const geo::Rect& rect)
+{
+  return QString("%1 in (select id from %2 where %3)").arg(idColumn).arg(indexTable(table)).
+         arg(overlapCondition(rect));
+}
+
+QVector<int> RTreeQuery::getIds(sql::SqlDatabase *db, const QString& table, const geo::Rect& rect)
+{
+  QVector<int> ids;
+  sql::SqlQuery query(db);
+  query.exec(QString("select id from %1 where %2").arg(indexTable(table)).arg(overlapCondition(rect)));
+  while(query.next())
+    ids.append(query.valueInt(0));
+  return ids;
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,70 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_RTREEQUERY_H
+#define ATOOLS_FS_DB_RTREEQUERY_H
+
+#include <QVector>
+
+namespace atools {
+namespace geo {
+class Rect;
+}
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace db {
+
+/*
+ * Helper methods for the R*Tree spatial index tables created by create_spatial_index.sql.
+ *
+ * Index table for e.g. "airport" is "airport_rtree" with the columns id, min_lonx, max_lonx, min_laty and max_laty.
+ * Rectangles crossing the anti-meridian are stored with max_lonx increased by 360 degree. The conditions
+ * built here consider this and split search rectangles crossing the anti-meridian.
+ */
+class RTreeQuery
+{
+public:
+  /* true if SQLite was compiled with the R*Tree module */
+  static bool isAvailable(atools::sql::SqlDatabase *db);
+
+  /* true if the index table exists for table */
+  static bool hasIndex(atools::sql::SqlDatabase *db, const QString& table);
+
+  static QString indexTable(const QString& table)
+  {
+    return table + "_rtree";
+  }
+
+  /* Condition for the where clause of the index table selecting all bounding rectangles overlapping rect */
+  static QString overlapCondition(const atools::geo::Rect& rect);
+
+  /* Condition for a where clause selecting all rows of table overlapping rect,
+   * e.g. "airport_id in (select id from airport_rtree where ...)". Usable for any query on table. */
+  static QString rectCondition(const QString& table, const QString& idColumn, const atools::geo::Rect& rect);
+
+  /* Ids of all rows of table overlapping rect */
+  static QVector<int> getIds(atools::sql::SqlDatabase *db, const QString& table, const atools::geo::Rect& rect);
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_RTREEQUERY_H
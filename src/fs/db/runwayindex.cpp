@@ -29,7 +29,7 @@ using std::make_pair;
 
 void RunwayIndex::add(const QString& airportIdent, const QString& runwayName, int runwayEndId)
 {
-  runwayIndexMap[RunwayIndexKeyType(airportIdent, runwayName)] = runwayEndId;
+  runwayIndexMap.insert(RunwayIndexKeyType(airportIdent, runwayName), runwayEndId);
 }
 
 int RunwayIndex::getRunwayEndId(const QString& airportIdent,
@@ -41,9 +41,9 @@ int RunwayIndex::getRunwayEndId(const QString& airportIdent,
 
   RunwayIndexKeyType key(airportIdent, runwayName);
 
-  RunwayIndexTypeConstIter it = runwayIndexMap.find(key);
-  if(it != runwayIndexMap.end())
-    return it.value();
+  const int *id = runwayIndexMap.find(key);
+  if(id != nullptr)
+    return *id;
   else
   {
     qWarning().nospace().noquote() << "Runway end ID for airport " << airportIdent << " and runway " <<
@@ -18,7 +18,7 @@
 #ifndef ATOOLS_FS_DB_RUNWAYINDEX_H
 #define ATOOLS_FS_DB_RUNWAYINDEX_H
 
-#include <QHash>
+#include "fs/common/airportindex.h"
 
 namespace atools {
 namespace fs {
@@ -26,7 +26,7 @@ namespace db {
 
 /*
  * Index that maps airport idents and runway names to runway end IDs. This used for each BGL file and does not cross
- * the file boundary.
+ * the file boundary. Idents and runway names are limited to ten Latin-1 characters each.
  */
 class RunwayIndex
 {
@@ -60,11 +60,10 @@ public:
   }
 
 private:
-  /* key of airport ident and runway name. Use QPair since it has a hash function */
-  typedef QPair<QString, QString> RunwayIndexKeyType;
+  /* key of airport ident and runway name */
+  typedef atools::fs::common::IndexName2 RunwayIndexKeyType;
 
-  typedef QHash<atools::fs::db::RunwayIndex::RunwayIndexKeyType, int> RunwayIndexType;
-  typedef atools::fs::db::RunwayIndex::RunwayIndexType::const_iterator RunwayIndexTypeConstIter;
+  typedef atools::util::FlatHash<atools::fs::db::RunwayIndex::RunwayIndexKeyType, int> RunwayIndexType;
 
   atools::fs::db::RunwayIndex::RunwayIndexType runwayIndexMap;
 };
@@ -0,0 +1,90 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/tablestatistics.h"
+
+#include <QDebug>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+TableStatistics::TableStatistics()
+{
+}
+
+TableStatistics::~TableStatistics()
+{
+  qDeleteAll(stats);
+}
+
+TableStats *TableStatistics::getStats(const QString& table)
+{
+  TableStats *tableStats = stats.value(table, nullptr);
+  if(tableStats == nullptr)
+  {
+    tableStats = new TableStats;
+    stats.insert(table, tableStats);
+  }
+  return tableStats;
+}
+
+const TableStats *TableStatistics::findStats(const QString& table) const
+{
+  return stats.value(table, nullptr);
+}
+
+QStringList TableStatistics::getTables() const
+{
+  QStringList tables = stats.keys();
+  tables.sort();
+  return tables;
+}
+
+void TableStatistics::print(QDebug& out) const
+{
+  QDebugStateSaver saver(out);
+  out.noquote().nospace();
+
+  int total = 0;
+  out << "Rows written (table, rows, longitude range, latitude range):" << endl;
+  for(const QString& table : getTables())
+  {
+    const TableStats& tableStats = *stats.value(table);
+    out << table << ": " << tableStats.rows;
+    if(tableStats.hasCoordinates())
+    {
+      out << ", " << tableStats.minLonX << " to " << tableStats.maxLonX
+          << ", " << tableStats.minLatY << " to " << tableStats.maxLatY;
+      if(tableStats.hasCoordinateViolations())
+        out << " *** coordinate violations ***";
+    }
+    out << endl;
+    total += tableStats.rows;
+  }
+  out << "Total rows written: " << total << endl;
+}
+
+void TableStatistics::clear()
+{
+  qDeleteAll(stats);
+  stats.clear();
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,108 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_TABLESTATISTICS_H
+#define ATOOLS_FS_DB_TABLESTATISTICS_H
+
+#include <QHash>
+#include <QStringList>
+
+#include <algorithm>
+#include <limits>
+
+class QDebug;
+
+namespace atools {
+namespace fs {
+namespace db {
+
+/* Rows written and range of coordinates for one table */
+struct TableStats
+{
+  int rows = 0;
+  float minLonX = std::numeric_limits<float>::max(), maxLonX = std::numeric_limits<float>::lowest(),
+        minLatY = std::numeric_limits<float>::max(), maxLatY = std::numeric_limits<float>::lowest();
+
+  /* true if at least one coordinate was added */
+  bool hasCoordinates() const
+  {
+    return minLonX <= maxLonX;
+  }
+
+  /* true if any longitude or latitude is outside of the valid range */
+  bool hasCoordinateViolations() const
+  {
+    return hasCoordinates() && (minLonX < -180.f || maxLonX > 180.f || minLatY < -90.f || maxLatY > 90.f);
+  }
+
+  void addLonX(float lonX)
+  {
+    minLonX = std::min(minLonX, lonX);
+    maxLonX = std::max(maxLonX, lonX);
+  }
+
+  void addLatY(float latY)
+  {
+    minLatY = std::min(minLatY, latY);
+    maxLatY = std::max(maxLatY, latY);
+  }
+};
+
+/*
+ * Statistics collected by the writers while inserting. Replaces count and range queries over large tables
+ * for validation and the database report.
+ *
+ * Counts are rows written and do not consider rows removed later by scripts like the duplicate removal.
+ * Not thread safe. Writers of one table have to write from the same thread.
+ */
+class TableStatistics
+{
+public:
+  TableStatistics();
+  ~TableStatistics();
+
+  TableStatistics(const TableStatistics& other) = delete;
+  TableStatistics& operator=(const TableStatistics& other) = delete;
+
+  /* Get statistics for table. Created on first access and valid as long as this object. */
+  atools::fs::db::TableStats *getStats(const QString& table);
+
+  /* Statistics for table or null if nothing was written */
+  const atools::fs::db::TableStats *findStats(const QString& table) const;
+
+  bool isEmpty() const
+  {
+    return stats.isEmpty();
+  }
+
+  /* Sorted table names */
+  QStringList getTables() const;
+
+  /* Print table with rows and coordinate ranges for all tables */
+  void print(QDebug& out) const;
+
+  void clear();
+
+private:
+  QHash<QString, atools::fs::db::TableStats *> stats;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_TABLESTATISTICS_H
@@ -0,0 +1,78 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/textsearchquery.h"
+
+#include "sql/sqlquery.h"
+#include "sql/sqlutil.h"
+
+#include <QRegularExpression>
+#include <QStringList>
+
+namespace atools {
+namespace fs {
+namespace db {
+
+bool TextSearchQuery::isAvailable(sql::SqlDatabase *db)
+{
+  sql::SqlQuery query(db);
+  query.exec("select sqlite_compileoption_used('ENABLE_FTS5')");
+  return query.next() && query.valueBool(0);
+}
+
+bool TextSearchQuery::hasIndex(sql::SqlDatabase *db)
+{
+  return sql::SqlUtil(db).hasTable("nav_text_search");
+}
+
+QString TextSearchQuery::matchExpression(const QString& text)
+{
+  // Quoting all words avoids any interpretation of FTS5 operators in user input
+  static const QRegularExpression SEPARATORS("[\\s\"'*:^(){}+-]+");
+
+  QStringList words;
+  for(const QString& word : text.split(SEPARATORS, QString::SkipEmptyParts))
+    words.append("\"" + word + "\"*");
+  return words.join(" ");
+}
+
+QVector<TextSearchResult> TextSearchQuery::autocomplete(sql::SqlDatabase *db, const QString& text, int limit)
+{
+  QVector<TextSearchResult> results;
+  QString match = matchExpression(text);
+  if(match.isEmpty())
+    return results;
+
+  sql::SqlQuery query(db);
+  query.prepare("select source, source_id, ident, name, region, city from nav_text_search "
+                "where nav_text_search match :match "
+                "order by ident = :ident collate nocase desc, bm25(nav_text_search, 10.0, 5.0, 1.0, 2.0) "
+                "limit :limit");
+  query.bindValue(":match", match);
+  query.bindValue(":ident", text.trimmed());
+  query.bindValue(":limit", limit);
+  query.exec();
+
+  while(query.next())
+    results.append({query.valueStr(0), query.valueInt(1), query.valueStr(2), query.valueStr(3),
+                    query.valueStr(4), query.valueStr(5)});
+  return results;
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,67 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_TEXTSEARCHQUERY_H
+#define ATOOLS_FS_DB_TEXTSEARCHQUERY_H
+
+#include <QVector>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace db {
+
+/* One result of an autocomplete query. source is "airport" or "nav_search". */
+struct TextSearchResult
+{
+  QString source;
+  int sourceId;
+  QString ident, name, region, city;
+};
+
+/*
+ * Prefix and autocomplete queries on the FTS5 table nav_text_search created by create_text_search.sql.
+ *
+ * Results are ranked with exact ident matches first followed by the BM25 rank weighting ident above
+ * name, city and region.
+ */
+class TextSearchQuery
+{
+public:
+  /* true if SQLite was compiled with FTS5 */
+  static bool isAvailable(atools::sql::SqlDatabase *db);
+
+  /* true if the full text search table exists */
+  static bool hasIndex(atools::sql::SqlDatabase *db);
+
+  /* Build a FTS5 match expression from user input where each word is a prefix.
+   * E.g. "san fr" results in "\"san\"* \"fr\"*". Returns an empty string if text contains no words. */
+  static QString matchExpression(const QString& text);
+
+  /* Get up to limit results for words of text where the last word can be incomplete */
+  static QVector<atools::fs::db::TextSearchResult> autocomplete(atools::sql::SqlDatabase *db, const QString& text,
+                                                                int limit = 20);
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_TEXTSEARCHQUERY_H
@@ -22,6 +22,8 @@
 
 #include <QList>
 
+#include <typeinfo>
+
 namespace atools {
 namespace sql {
 class SqlDatabase;
@@ -73,7 +75,7 @@ public:
    */
   int getCurrentId() const
   {
-    return id;
+    return idSequence->getCurrent();
   }
 
   /*
@@ -82,7 +84,21 @@ public:
    */
   int getNextId()
   {
-    return ++id;
+    return idSequence->next();
+  }
+
+  /* Reserve a disjoint range of ids for a parallel worker or shard */
+  atools::fs::db::IdRange reserveIds(int count)
+  {
+    return idSequence->reserve(count);
+  }
+
+  /* Sequences can be shared by writers of different tables. Ids are only increased. */
+  virtual void initIdFromDatabase() override
+  {
+    int maxId = getMaxIdFromDatabase();
+    if(maxId > idSequence->getCurrent())
+      idSequence->reset(maxId);
   }
 
 protected:
@@ -94,20 +110,19 @@ protected:
   virtual void writeObject(const TYPE *type) = 0;
 
 private:
-  static int id;
+  /* Shared by all writers of the same type for one database */
+  atools::fs::db::IdSequence *idSequence;
 };
 
 // -----------------------------------------------------------------------------
 
-template<typename TYPE>
-int WriterBase<TYPE>::id = 0;
-
 template<typename TYPE> WriterBase<TYPE>::WriterBase(sql::SqlDatabase& db,
                                                      atools::fs::db::DataWriter& dataWriter,
                                                      const QString& tablename,
                                                      const QString& sqlParam)
   : WriterBaseBasic(db, dataWriter, tablename, sqlParam)
 {
+  idSequence = getIdSequence(QString(typeid(TYPE).name()));
 }
 
 template<typename TYPE> WriterBase<TYPE>::~WriterBase()
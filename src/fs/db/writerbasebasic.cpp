@@ -19,9 +19,12 @@
 #include "fs/db/datawriter.h"
 #include "sql/sqldatabase.h"
 #include "sql/sqlutil.h"
+#include "util/perfcounters.h"
 
 #include <QDataStream>
 
+#include <algorithm>
+
 namespace atools {
 namespace fs {
 namespace db {
@@ -29,11 +32,14 @@ namespace db {
 using atools::sql::SqlUtil;
 using atools::sql::SqlQuery;
 
+/* Default limit for bind variables in SQLite before 3.32 */
+static const int MAX_BIND_VARIABLES = 999;
+
 WriterBaseBasic::WriterBaseBasic(atools::sql::SqlDatabase& sqlDb,
                                  DataWriter& writer,
                                  const QString& table,
                                  const QString& sqlParam)
-  : sqlQuery(sqlDb), tablename(table), db(sqlDb), dataWriter(writer)
+  : sqlQuery(sqlDb), tablename(table), db(sqlDb), dataWriter(writer), batchQuery(sqlDb)
 {
   if(sqlParam.isEmpty())
     sqlStatement = SqlUtil(&db).buildInsertStatement(tablename);
@@ -42,10 +48,134 @@ WriterBaseBasic::WriterBaseBasic(atools::sql::SqlDatabase& sqlDb,
   sqlQuery = SqlQuery(db);
 
   sqlQuery.prepare(sqlStatement);
+
+  // Batching only for generated insert statements
+  if(sqlParam.isEmpty() && dataWriter.getOptions().getInsertBatchSize() > 1)
+    initBatch(dataWriter.getOptions().getInsertBatchSize());
+
+  if(batchRows == 0)
+    initPlaceholderIndexes();
+
+  rowCounter = atools::util::PerfRegistry::counter("db.rows." + tablename);
+  tableStats = dataWriter.getTableStatistics().getStats(tablename);
+
+  dataWriter.registerWriter(this);
 }
 
 WriterBaseBasic::~WriterBaseBasic()
 {
+  dataWriter.unregisterWriter(this);
+}
+
+void WriterBaseBasic::initBatch(int batchSize)
+{
+  atools::sql::SqlRecord record = db.record(tablename);
+  placeholderIndex.clear();
+  for(int i = 0; i < record.count(); i++)
+  {
+    placeholderIndex.insert(":" + record.fieldName(i), columns.size());
+    columns.append(record.fieldName(i));
+  }
+
+  if(columns.isEmpty())
+    return;
+
+  // Older SQLite versions allow only 999 bind variables per statement
+  batchRows = std::min(batchSize, std::max(1, MAX_BIND_VARIABLES / columns.size()));
+  if(batchRows > 1)
+  {
+    currentRow.fill(QVariant(), columns.size());
+    pendingValues.reserve(batchRows * columns.size());
+    batchQuery.prepare(buildBatchStatement(batchRows));
+  }
+  else
+    batchRows = 0;
+}
+
+void WriterBaseBasic::initPlaceholderIndexes()
+{
+  // Resolve names once to bind by position - keep named binding if a placeholder is used more than once
+  placeholderIndex = sqlQuery.getPlaceholderIndexes();
+  for(int idx : placeholderIndex)
+  {
+    if(idx == -1)
+    {
+      placeholderIndex.clear();
+      break;
+    }
+  }
+}
+
+QString WriterBaseBasic::buildBatchStatement(int numRows) const
+{
+  QString row = "(" + QString("?, ").repeated(columns.size() - 1) + "?)";
+
+  QStringList rows;
+  for(int i = 0; i < numRows; i++)
+    rows.append(row);
+
+  return "insert into " + tablename + " (" + columns.join(", ") + ") values " + rows.join(", ");
+}
+
+void WriterBaseBasic::flush()
+{
+  if(numPendingRows == 0)
+    return;
+
+  SqlQuery tailQuery(db);
+  SqlQuery *query = &batchQuery;
+  if(numPendingRows < batchRows)
+  {
+    // Rest of rows for the last incomplete batch
+    tailQuery.prepare(buildBatchStatement(numPendingRows));
+    query = &tailQuery;
+  }
+
+  for(int i = 0; i < pendingValues.size(); i++)
+  {
+    const QVariant& value = pendingValues.at(i);
+    // Unbound values are null like in a normal prepared query
+    query->bindValue(i, value.isValid() ? value : QVariant(QVariant::String));
+  }
+
+  int numRows = numPendingRows;
+  pendingValues.clear();
+  numPendingRows = 0;
+
+  query->exec();
+  if(query->numRowsAffected() != numRows)
+    throw atools::sql::SqlException("Noting inserted", query->lastQuery());
+}
+
+void WriterBaseBasic::bindValue(const QString& placeholder, const QVariant& val)
+{
+  // Collect coordinate ranges for the database report
+  if(placeholder == QLatin1String(":lonx"))
+  {
+    if(!val.isNull())
+      tableStats->addLonX(val.toFloat());
+  }
+  else if(placeholder == QLatin1String(":laty"))
+  {
+    if(!val.isNull())
+      tableStats->addLatY(val.toFloat());
+  }
+
+  if(batchRows > 0)
+  {
+    int idx = placeholderIndex.value(placeholder, -1);
+    if(idx == -1)
+      throw atools::sql::SqlException("Bind name \"" + placeholder + "\" does not exist in table", tablename);
+    currentRow[idx] = val;
+  }
+  else
+  {
+    int idx = placeholderIndex.value(placeholder, -1);
+    if(idx == -1)
+      sqlQuery.bindValue(placeholder, val);
+    else
+      sqlQuery.bindValue(idx, val);
+  }
 }
 
 const NavDatabaseOptions& WriterBaseBasic::getOptions()
@@ -58,6 +188,26 @@ RunwayIndex *WriterBaseBasic::getRunwayIndex()
   return dataWriter.getRunwayIndex();
 }
 
+IdSequence *WriterBaseBasic::getIdSequence(const QString& name)
+{
+  return dataWriter.getIdAllocator().getSequence(name);
+}
+
+int WriterBaseBasic::getMaxIdFromDatabase() const
+{
+  int maxId = 0;
+  QString idColumn = tablename + "_id";
+  if(!tablename.isEmpty() && db.record(tablename).contains(idColumn))
+  {
+    SqlQuery query(db);
+    query.exec("select max(" + idColumn + ") from " + tablename);
+    if(query.next())
+      maxId = query.valueInt(0);
+    query.finish();
+  }
+  return maxId;
+}
+
 DbAirportIndex *WriterBaseBasic::getAirportIndex()
 {
   return dataWriter.getAirportIndex();
@@ -65,12 +215,12 @@ DbAirportIndex *WriterBaseBasic::getAirportIndex()
 
 void WriterBaseBasic::bindBool(const QString& placeholder, bool val)
 {
-  return sqlQuery.bindValue(placeholder, val ? 1 : 0);
+  return bindValue(placeholder, val ? 1 : 0);
 }
 
 void WriterBaseBasic::bind(const QString& placeholder, const QVariant& val)
 {
-  return sqlQuery.bindValue(placeholder, val);
+  return bindValue(placeholder, val);
 }
 
 void WriterBaseBasic::bindIntOrNull(const QString& placeholder, const QVariant& val)
@@ -78,32 +228,49 @@ void WriterBaseBasic::bindIntOrNull(const QString& placeholder, const QVariant&
   if(val.toInt() == 0)
     bindNullInt(placeholder);
   else
-    return sqlQuery.bindValue(placeholder, val);
+    return bindValue(placeholder, val);
 }
 
 void WriterBaseBasic::bindNullInt(const QString& placeholder)
 {
-  return sqlQuery.bindValue(placeholder, QVariant(QVariant::Int));
+  return bindValue(placeholder, QVariant(QVariant::Int));
 }
 
 void WriterBaseBasic::bindNullFloat(const QString& placeholder)
 {
-  return sqlQuery.bindValue(placeholder, QVariant(QVariant::Double));
+  return bindValue(placeholder, QVariant(QVariant::Double));
 }
 
 void WriterBaseBasic::bindNullString(const QString& placeholder)
 {
-  return sqlQuery.bindValue(placeholder, QVariant(QVariant::String));
+  return bindValue(placeholder, QVariant(QVariant::String));
 }
 
 void WriterBaseBasic::executeStatement()
 {
+  if(batchRows > 0)
+  {
+    // Values are kept for the next row like in a prepared query
+    pendingValues += currentRow;
+    numPendingRows++;
+
+    if(numPendingRows >= batchRows)
+      flush();
+
+    dataWriter.increaseNumObjects();
+    rowCounter->add();
+    tableStats->rows++;
+    return;
+  }
+
   sqlQuery.exec();
   int numUpdated = sqlQuery.numRowsAffected();
   if(numUpdated == 0)
     throw atools::sql::SqlException("Noting inserted", sqlStatement);
 
   dataWriter.increaseNumObjects();
+  rowCounter->add();
+  tableStats->rows++;
 }
 
 } // namespace writer
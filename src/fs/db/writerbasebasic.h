@@ -19,15 +19,24 @@
 #define ATOOLS_FS_DB_WRITERBASEBASIC_H
 
 #include "sql/sqlquery.h"
+#include "fs/db/idallocator.h"
+#include "fs/db/tablestatistics.h"
 #include "fs/bgl/bglposition.h"
+#include "logging/loggingmacros.h"
 
 #include <QDataStream>
+#include <QHash>
+#include <QVector>
 
 namespace atools {
 namespace sql {
 class SqlDatabase;
 }
 
+namespace util {
+class PerfCounter;
+}
+
 namespace fs {
 class NavDatabaseOptions;
 namespace db {
@@ -38,6 +47,9 @@ class DataWriter;
 /*
  * Template free base class for all writer classes that store BGL record content into the database.
  * Keeps the SQL statement and has utilitly methods for binding values to it.
+ *
+ * Rows for generated insert statements are collected and written with one multi row insert
+ * if a batch size is set in the options. The DataWriter flushes all writers when needed.
  */
 class WriterBaseBasic
 {
@@ -56,6 +68,14 @@ public:
 
   virtual ~WriterBaseBasic();
 
+  /* Write all pending batched rows. Throws SqlException if not all rows were inserted. */
+  void flush();
+
+  /* Continue ids after the rows already in the table. Used when resuming an aborted compilation. */
+  virtual void initIdFromDatabase()
+  {
+  }
+
 protected:
   atools::fs::db::DataWriter& getDataWriter()
   {
@@ -64,6 +84,12 @@ protected:
 
   const atools::fs::NavDatabaseOptions& getOptions();
   atools::fs::db::RunwayIndex *getRunwayIndex();
+
+  /* Id sequence from the allocator of the data writer */
+  atools::fs::db::IdSequence *getIdSequence(const QString& name);
+
+  /* Largest value of column "tablename_id" or 0 if the table is empty or has no such column */
+  int getMaxIdFromDatabase() const;
   atools::fs::db::DbAirportIndex *getAirportIndex();
 
   /*
@@ -92,11 +118,30 @@ protected:
   void executeStatement();
 
 private:
+  void bindValue(const QString& placeholder, const QVariant& val);
+  void initBatch(int batchSize);
+  void initPlaceholderIndexes();
+  QString buildBatchStatement(int numRows) const;
+
   atools::sql::SqlQuery sqlQuery; // Either custom query or generated insert statement
   QString sqlStatement, tablename;
   atools::sql::SqlDatabase& db;
   atools::fs::db::DataWriter& dataWriter;
 
+  /* Placeholder name to column index in batch mode or to bind position in the prepared statement otherwise */
+  QHash<QString, int> placeholderIndex;
+
+  /* Batch mode - values of the row currently being bound are kept like for a normal prepared query */
+  QStringList columns;
+  QVector<QVariant> currentRow, pendingValues;
+  atools::sql::SqlQuery batchQuery; // Prepared for a full batch
+  int batchRows = 0, numPendingRows = 0;
+
+  /* Counts rows written for table in PerfRegistry */
+  atools::util::PerfCounter *rowCounter = nullptr;
+
+  /* Rows and coordinate ranges for this database - owned by the data writer */
+  atools::fs::db::TableStats *tableStats = nullptr;
 };
 
 template<typename TYPE>
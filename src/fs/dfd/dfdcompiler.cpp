@@ -33,11 +33,17 @@
 #include "fs/common/airportindex.h"
 #include "fs/common/binarygeometry.h"
 #include "fs/common/morareader.h"
+#include "exception.h"
+#include "sql/sqlbatch.h"
+#include "util/tracerecorder.h"
 
 #include <QApplication>
 #include <QDataStream>
 #include <QDebug>
 #include <QFileInfo>
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QThreadPool>
 
 using atools::fs::common::MagDecReader;
 using atools::fs::common::MetadataWriter;
@@ -46,6 +52,7 @@ using atools::sql::SqlUtil;
 using atools::sql::SqlScript;
 using atools::sql::SqlRecordVector;
 using atools::sql::SqlRecord;
+using atools::sql::SqlBatch;
 using atools::geo::Pos;
 using atools::geo::LineString;
 using atools::geo::DPos;
@@ -56,6 +63,12 @@ namespace atools {
 namespace fs {
 namespace ng {
 
+/* Number of airports read by a thread in one query */
+const static int PROCEDURE_AIRPORTS_PER_CHUNK = 50;
+
+/* Chunks started per thread while the previous ones are written */
+const static int PROCEDURE_CHUNKS_PER_THREAD = 8;
+
 /* Length of the ILS feather */
 static const float ILS_FEATHER_LEN_NM = 9;
 static const float ILS_FEATHER_WIDTH = 4.f;
@@ -77,63 +90,78 @@ DfdCompiler::~DfdCompiler()
 
 void DfdCompiler::writeAirports()
 {
+  ATOOLS_TRACE_SPAN("DfdCompiler::writeAirports", "dfd");
+
   progress->reportOther("Writing airports");
 
   // Clear in memory indexes
   airportRectMap.clear();
   longestRunwaySurfaceMap.clear();
 
+  SqlBatch airportBatch(airportWriteQuery), airportFileBatch(airportFileWriteQuery);
+
   // Fill default values which are not nullable an are not available
-  airportWriteQuery->bindValue(":fuel_flags", 0);
-  airportWriteQuery->bindValue(":has_avgas", 0);
-  airportWriteQuery->bindValue(":has_jetfuel", 0);
-  airportWriteQuery->bindValue(":has_tower_object", 0);
-  airportWriteQuery->bindValue(":is_closed", 0);
-  airportWriteQuery->bindValue(":is_addon", 0);
-  airportWriteQuery->bindValue(":num_boundary_fence", 0);
-  airportWriteQuery->bindValue(":num_parking_gate", 0);
-  airportWriteQuery->bindValue(":num_parking_ga_ramp", 0);
-  airportWriteQuery->bindValue(":num_parking_cargo", 0);
-  airportWriteQuery->bindValue(":num_parking_mil_cargo", 0);
-  airportWriteQuery->bindValue(":num_parking_mil_combat", 0);
-  airportWriteQuery->bindValue(":num_runway_light", 0);
-  airportWriteQuery->bindValue(":num_runway_end_closed", 0);
-  airportWriteQuery->bindValue(":num_runway_end_vasi", 0);
-  airportWriteQuery->bindValue(":num_runway_end_als", 0);
-  airportWriteQuery->bindValue(":num_apron", 0);
-  airportWriteQuery->bindValue(":num_taxi_path", 0);
-  airportWriteQuery->bindValue(":num_helipad", 0);
-  airportWriteQuery->bindValue(":num_jetway", 0);
-  airportWriteQuery->bindValue(":num_starts", 0);
-
-  airportWriteQuery->bindValue(":rating", 1); // Set minimum value so that airports are not empty
-
-  airportWriteQuery->bindValue(":num_com", 0); // Filled later in populate_com.sql
-  airportWriteQuery->bindValue(":num_approach", 0); // Filled later by procedure writer
+  airportBatch.bindConstant(":fuel_flags", 0);
+  airportBatch.bindConstant(":has_avgas", 0);
+  airportBatch.bindConstant(":has_jetfuel", 0);
+  airportBatch.bindConstant(":has_tower_object", 0);
+  airportBatch.bindConstant(":is_closed", 0);
+  airportBatch.bindConstant(":is_addon", 0);
+  airportBatch.bindConstant(":num_boundary_fence", 0);
+  airportBatch.bindConstant(":num_parking_gate", 0);
+  airportBatch.bindConstant(":num_parking_ga_ramp", 0);
+  airportBatch.bindConstant(":num_parking_cargo", 0);
+  airportBatch.bindConstant(":num_parking_mil_cargo", 0);
+  airportBatch.bindConstant(":num_parking_mil_combat", 0);
+  airportBatch.bindConstant(":num_runway_light", 0);
+  airportBatch.bindConstant(":num_runway_end_closed", 0);
+  airportBatch.bindConstant(":num_runway_end_vasi", 0);
+  airportBatch.bindConstant(":num_runway_end_als", 0);
+  airportBatch.bindConstant(":num_apron", 0);
+  airportBatch.bindConstant(":num_taxi_path", 0);
+  airportBatch.bindConstant(":num_helipad", 0);
+  airportBatch.bindConstant(":num_jetway", 0);
+  airportBatch.bindConstant(":num_starts", 0);
+
+  airportBatch.bindConstant(":rating", 1); // Set minimum value so that airports are not empty
+
+  airportBatch.bindConstant(":num_com", 0); // Filled later in populate_com.sql
+  airportBatch.bindConstant(":num_approach", 0); // Filled later by procedure writer
 
   // "tower_frequency", "atis_frequency", "awos_frequency", "asos_frequency", "unicom_frequency":
   // Filled later in populate_com.sql
 
   // Fill default values which are not nullable and are populated later
-  airportWriteQuery->bindValue(":is_3d", 0); // X-Plane only
-  airportWriteQuery->bindValue(":num_runway_hard", 0);
-  airportWriteQuery->bindValue(":num_runway_soft", 0);
-  airportWriteQuery->bindValue(":num_runway_water", 0);
-  airportWriteQuery->bindValue(":longest_runway_length", 0);
-  airportWriteQuery->bindValue(":longest_runway_width", 0);
-  airportWriteQuery->bindValue(":longest_runway_heading", 0);
-  airportWriteQuery->bindValue(":num_runway_end_ils", 0);
-  airportWriteQuery->bindValue(":num_runways", 0);
-
-  // Read airports from source
+  airportBatch.bindConstant(":is_3d", 0); // X-Plane only
+  airportBatch.bindConstant(":num_runway_hard", 0);
+  airportBatch.bindConstant(":num_runway_soft", 0);
+  airportBatch.bindConstant(":num_runway_water", 0);
+  airportBatch.bindConstant(":longest_runway_length", 0);
+  airportBatch.bindConstant(":longest_runway_width", 0);
+  airportBatch.bindConstant(":longest_runway_heading", 0);
+  airportBatch.bindConstant(":num_runway_end_ils", 0);
+  airportBatch.bindConstant(":num_runways", 0);
+  airportBatch.bindConstant(":file_id", FILE_ID);
+
+  // Read all airports from source in one scan
   airportQuery->exec();
+  int identCol = airportQuery->columnIndex("airport_identifier"),
+      nameCol = airportQuery->columnIndex("airport_name"),
+      lonxCol = airportQuery->columnIndex("airport_ref_longitude"),
+      latyCol = airportQuery->columnIndex("airport_ref_latitude"),
+      elevationCol = airportQuery->columnIndex("elevation"),
+      surfaceCol = airportQuery->columnIndex("longest_runway_surface_code"),
+      areaCodeCol = airportQuery->columnIndex("area_code"),
+      icaoCodeCol = airportQuery->columnIndex("icao_code"),
+      transAltCol = airportQuery->columnIndex("transition_altitude");
+
   while(airportQuery->next())
   {
-    Pos pos(airportQuery->valueFloat("airport_ref_longitude"),
-            airportQuery->valueFloat("airport_ref_latitude"),
-            airportQuery->valueFloat("elevation"));
+    Pos pos(airportQuery->valueFloat(lonxCol), airportQuery->valueFloat(latyCol),
+            airportQuery->valueFloat(elevationCol));
 
-    QString ident = airportQuery->valueStr("airport_identifier");
+    QString ident = airportQuery->valueStr(identCol);
+    QString name = airportQuery->valueStr(nameCol);
 
     // Start with a minimum rectangle of about 100 meter which will be extended later
     Rect airportRect(pos);
@@ -142,83 +170,147 @@ void DfdCompiler::writeAirports()
     airportRectMap.insert(ident, airportRect);
 
     // Needed later for workaround for number or runways with certain surfaces
-    longestRunwaySurfaceMap.insert(ident, airportQuery->valueStr("longest_runway_surface_code"));
+    longestRunwaySurfaceMap.insert(ident, airportQuery->valueStr(surfaceCol));
 
-    airportWriteQuery->bindValue(":airport_id", ++curAirportId);
+    airportBatch.bindValue(":airport_id", ++curAirportId);
 
     // Add ident to id mapping
     airportIndex->addAirport(ident, curAirportId);
 
-    airportWriteQuery->bindValue(":file_id", FILE_ID);
-    airportWriteQuery->bindValue(":ident", ident);
-    airportWriteQuery->bindValue(":name", utl::capAirportName(airportQuery->valueStr("airport_name")));
-    airportWriteQuery->bindValue(":country", airportQuery->valueStr("area_code"));
-    airportWriteQuery->bindValue(":region", airportQuery->valueStr("icao_code"));
-    airportWriteQuery->bindValue(":is_military", utl::isNameMilitary(airportQuery->valueStr("airport_name")));
+    airportBatch.bindValue(":ident", ident);
+    airportBatch.bindValue(":name", utl::capAirportName(name));
+    airportBatch.bindValue(":country", airportQuery->valueStr(areaCodeCol));
+    airportBatch.bindValue(":region", airportQuery->valueStr(icaoCodeCol));
+    airportBatch.bindValue(":is_military", utl::isNameMilitary(name));
 
     // Will be extended later when reading runways
-    airportWriteQuery->bindValue(":left_lonx", airportRect.getTopLeft().getLonX());
-    airportWriteQuery->bindValue(":top_laty", airportRect.getTopLeft().getLatY());
-    airportWriteQuery->bindValue(":right_lonx", airportRect.getBottomRight().getLonX());
-    airportWriteQuery->bindValue(":bottom_laty", airportRect.getBottomRight().getLatY());
-
-    airportWriteQuery->bindValue(":mag_var", magDecReader->getMagVar(pos));
-    airportWriteQuery->bindValue(":transition_altitude", airportQuery->value("transition_altitude"));
-    airportWriteQuery->bindValue(":altitude", pos.getAltitude());
-    airportWriteQuery->bindValue(":lonx", pos.getLonX());
-    airportWriteQuery->bindValue(":laty", pos.getLatY());
-    airportWriteQuery->exec();
-
-    airportFileWriteQuery->bindValue(":ident", ident);
-    airportFileWriteQuery->exec();
+    airportBatch.bindValue(":left_lonx", airportRect.getTopLeft().getLonX());
+    airportBatch.bindValue(":top_laty", airportRect.getTopLeft().getLatY());
+    airportBatch.bindValue(":right_lonx", airportRect.getBottomRight().getLonX());
+    airportBatch.bindValue(":bottom_laty", airportRect.getBottomRight().getLatY());
+
+    airportBatch.bindValue(":mag_var", magDecReader->getMagVar(pos));
+    airportBatch.bindValue(":transition_altitude", airportQuery->value(transAltCol));
+    airportBatch.bindValue(":altitude", pos.getAltitude());
+    airportBatch.bindValue(":lonx", pos.getLonX());
+    airportBatch.bindValue(":laty", pos.getLatY());
+    airportBatch.addRow();
+
+    airportFileBatch.bindValue(":ident", ident);
+    airportFileBatch.addRow();
   }
+  airportBatch.exec();
+  airportFileBatch.exec();
   db.commit();
 }
 
 void DfdCompiler::writeRunways()
 {
+  ATOOLS_TRACE_SPAN("DfdCompiler::writeRunways", "dfd");
+
   progress->reportOther("Writing runways");
 
+  runwayBatch = new SqlBatch(runwayWriteQuery);
+  runwayEndBatch = new SqlBatch(runwayEndWriteQuery);
+  airportUpdateBatch = new SqlBatch(airportUpdateQuery);
+
+  // Values which are not available
+  runwayBatch->bindConstant(":pattern_altitude", 0);
+  runwayBatch->bindConstant(":marking_flags", 0);
+  runwayBatch->bindConstant(":has_center_red", 0);
+
+  runwayEndBatch->bindConstant(":blast_pad", 0);
+  runwayEndBatch->bindConstant(":overrun", 0);
+  runwayEndBatch->bindConstant(":has_closed_markings", 0);
+  runwayEndBatch->bindConstant(":has_stol_markings", 0);
+  runwayEndBatch->bindConstant(":is_pattern", 0);
+  runwayEndBatch->bindConstant(":has_end_lights", 0);
+  runwayEndBatch->bindConstant(":has_reils", 0);
+  runwayEndBatch->bindConstant(":has_touchdown_lights", 0);
+  runwayEndBatch->bindConstant(":num_strobes", 0);
+
+  // Read all runways ordered by airport in one scan
   runwayQuery->exec();
-
-  SqlRecordVector runways;
+  int aptCol = runwayQuery->columnIndex("airport_identifier"),
+      identCol = runwayQuery->columnIndex("runway_identifier"),
+      lonxCol = runwayQuery->columnIndex("runway_longitude"),
+      latyCol = runwayQuery->columnIndex("runway_latitude"),
+      bearingCol = runwayQuery->columnIndex("runway_true_bearing"),
+      elevationCol = runwayQuery->columnIndex("landing_threshold_elevation"),
+      displacedCol = runwayQuery->columnIndex("displaced_threshold_distance"),
+      lengthCol = runwayQuery->columnIndex("runway_length"),
+      widthCol = runwayQuery->columnIndex("runway_width"),
+      llzCol = runwayQuery->columnIndex("llz_identifier");
+
+  QVector<RunwayEnd> runways;
   QString lastApt;
   while(runwayQuery->next())
   {
-    QString apt = runwayQuery->valueStr("airport_identifier");
+    QString apt = runwayQuery->valueStr(aptCol);
 
     if(!lastApt.isEmpty() && lastApt != apt)
+    {
       // Airport ID has changed write collected runways
       writeRunwaysForAirport(runways, lastApt);
+      runways.clear();
+    }
 
     // Collect runways
-    runways.append(runwayQuery->record());
+    RunwayEnd end;
+    end.ident = runwayQuery->valueStr(identCol);
+    end.llzIdent = runwayQuery->valueStr(llzCol);
+    end.pos = Pos(runwayQuery->valueFloat(lonxCol), runwayQuery->valueFloat(latyCol));
+    end.trueBearing = runwayQuery->valueFloat(bearingCol);
+    end.thresholdElevation = runwayQuery->valueInt(elevationCol);
+    end.displacedThreshold = runwayQuery->valueInt(displacedCol);
+    end.length = runwayQuery->valueInt(lengthCol);
+    end.width = runwayQuery->valueInt(widthCol);
+    end.closed = false;
+    runways.append(end);
     lastApt = apt;
   }
   writeRunwaysForAirport(runways, lastApt);
+
+  // Runway ends first to allow foreign keys
+  runwayEndBatch->exec();
+  runwayBatch->exec();
+  airportUpdateBatch->exec();
+
+  deleteRunwayBatches();
   db.commit();
 }
 
-void DfdCompiler::writeRunwaysForAirport(SqlRecordVector& runways, const QString& apt)
+void DfdCompiler::deleteRunwayBatches()
 {
-  QVector<std::pair<SqlRecord, SqlRecord> > runwaypairs;
-
-  // area_code
-  // icao_code
-  // airport_identifier
-  // runway_identifier
-  // runway_latitude
-  // runway_longitude
-  // runway_gradient
-  // runway_magnetic_bearing
-  // runway_true_bearing
-  // landing_threshold_elevation
-  // displaced_threshold_distance
-  // threshold_crossing_height
-  // runway_length
-  // runway_width
-  // llz_identifier
-  // llz_mls_gls_category
+  delete runwayBatch;
+  runwayBatch = nullptr;
+
+  delete runwayEndBatch;
+  runwayEndBatch = nullptr;
+
+  delete airportUpdateBatch;
+  airportUpdateBatch = nullptr;
+}
+
+void DfdCompiler::bindRunwayEnd(const RunwayEnd& end, int endId, const QString& endType)
+{
+  runwayEndBatch->bindValue(":runway_end_id", endId);
+  runwayEndBatch->bindValue(":name", end.ident.mid(2));
+  runwayEndBatch->bindValue(":end_type", endType);
+  runwayEndBatch->bindValue(":offset_threshold", end.displacedThreshold);
+  runwayEndBatch->bindValue(":is_takeoff", !end.closed);
+  runwayEndBatch->bindValue(":is_landing", !end.closed);
+  runwayEndBatch->bindValue(":ils_ident", end.llzIdent);
+  runwayEndBatch->bindValue(":heading", end.trueBearing);
+  runwayEndBatch->bindValue(":altitude", end.thresholdElevation);
+  runwayEndBatch->bindValue(":lonx", end.pos.getLonX());
+  runwayEndBatch->bindValue(":laty", end.pos.getLatY());
+  runwayEndBatch->addRow();
+}
+
+void DfdCompiler::writeRunwaysForAirport(const QVector<RunwayEnd>& runways, const QString& apt)
+{
+  QVector<std::pair<RunwayEnd, RunwayEnd> > runwaypairs;
 
   // Find matching opposing ends in the list
   pairRunways(runwaypairs, runways);
@@ -226,38 +318,30 @@ void DfdCompiler::writeRunwaysForAirport(SqlRecordVector& runways, const QString
   int numRunways = 0, numRunwayIls = 0, longestRunwayLength = 0, longestRunwayWidth = 0;
   float longestRunwayHeading = 0.f;
   Rect airportRect = airportRectMap.value(apt);
+  QVariant airportId = airportIndex->getAirportId(apt);
 
   // Iterate over all runways / end pairs
-  for(const std::pair<SqlRecord, SqlRecord>& runwaypair : runwaypairs)
+  for(const std::pair<RunwayEnd, RunwayEnd>& runwaypair : runwaypairs)
   {
-    SqlRecord primaryRec = runwaypair.first;
-    SqlRecord secondaryRec = runwaypair.second;
+    const RunwayEnd& primary = runwaypair.first;
+    const RunwayEnd& secondary = runwaypair.second;
 
     // Generate new end ids here
     int primaryEndId = ++curRunwayEndId, secondaryEndId = ++curRunwayEndId;
 
-    int length = primaryRec.valueInt("runway_length");
-    int width = primaryRec.valueInt("runway_width");
+    int length = primary.length;
+    int width = primary.width;
 
     // Use average threshold elevation for runway elevation
-    int alt = (primaryRec.valueInt("landing_threshold_elevation") +
-               secondaryRec.valueInt("landing_threshold_elevation")) / 2;
-
-    // Get primary and secondary end coordinates
-    Pos primaryPos(primaryRec.valueFloat("runway_longitude"), primaryRec.valueFloat("runway_latitude"));
-    Pos secondaryPos(secondaryRec.valueFloat("runway_longitude"), secondaryRec.valueFloat("runway_latitude"));
+    int alt = (primary.thresholdElevation + secondary.thresholdElevation) / 2;
 
     // Calculate center point
-    Pos centerPos = primaryPos.interpolate(secondaryPos, 0.5f);
-
-    float heading = primaryRec.valueFloat("runway_true_bearing");
-    float opposedHeading = secondaryRec.valueFloat("runway_true_bearing");
+    Pos centerPos = primary.pos.interpolate(secondary.pos, 0.5f);
 
-    // qDebug() << apt << primaryEndId << p.valueStr("runway_identifier")
-    // << secondaryEndId << s.valueStr("runway_identifier");
+    float heading = primary.trueBearing;
 
     // Count ILS
-    if(primaryRec.valueStr("llz_identifier").isEmpty())
+    if(primary.llzIdent.isEmpty())
       numRunwayIls++;
 
     // Remember the longest data
@@ -270,82 +354,31 @@ void DfdCompiler::writeRunwaysForAirport(SqlRecordVector& runways, const QString
     numRunways++;
 
     // Calculate the end coordinates
-    airportRect.extend(primaryPos);
-    airportRect.extend(secondaryPos);
-
-    bool pClosed = primaryRec.valueBool("is_closed", false);
-    bool sClosed = secondaryRec.valueBool("is_closed", false);
+    airportRect.extend(primary.pos);
+    airportRect.extend(secondary.pos);
 
     // Write runway =======================================
-    runwayWriteQuery->bindValue(":runway_id", ++curRunwayId);
-    runwayWriteQuery->bindValue(":airport_id", airportIndex->getAirportId(apt));
-    runwayWriteQuery->bindValue(":primary_end_id", primaryEndId);
-    runwayWriteQuery->bindValue(":secondary_end_id", secondaryEndId);
-    runwayWriteQuery->bindValue(":length", length);
-    runwayWriteQuery->bindValue(":width", width);
-    runwayWriteQuery->bindValue(":heading", heading);
-    runwayWriteQuery->bindValue(":pattern_altitude", 0);
-    runwayWriteQuery->bindValue(":marking_flags", 0);
-    runwayWriteQuery->bindValue(":has_center_red", 0);
-    runwayWriteQuery->bindValue(":primary_lonx", primaryPos.getLonX());
-    runwayWriteQuery->bindValue(":primary_laty", primaryPos.getLatY());
-    runwayWriteQuery->bindValue(":secondary_lonx", secondaryPos.getLonX());
-    runwayWriteQuery->bindValue(":secondary_laty", secondaryPos.getLatY());
-    runwayWriteQuery->bindValue(":altitude", alt);
-    runwayWriteQuery->bindValue(":lonx", centerPos.getLonX());
-    runwayWriteQuery->bindValue(":laty", centerPos.getLatY());
-
-    // Write the primary end =======================================
-    runwayEndWriteQuery->bindValue(":runway_end_id", primaryEndId);
-    runwayEndWriteQuery->bindValue(":name", primaryRec.valueStr("runway_identifier").mid(2));
-    runwayEndWriteQuery->bindValue(":end_type", "P");
-    runwayEndWriteQuery->bindValue(":offset_threshold", primaryRec.valueInt("displaced_threshold_distance"));
-    runwayEndWriteQuery->bindValue(":blast_pad", 0);
-    runwayEndWriteQuery->bindValue(":overrun", 0);
-    runwayEndWriteQuery->bindValue(":has_closed_markings", 0);
-    runwayEndWriteQuery->bindValue(":has_stol_markings", 0);
-    runwayEndWriteQuery->bindValue(":is_takeoff", !pClosed);
-    runwayEndWriteQuery->bindValue(":is_landing", !pClosed);
-    runwayEndWriteQuery->bindValue(":is_pattern", 0);
-    runwayEndWriteQuery->bindValue(":has_end_lights", 0);
-    runwayEndWriteQuery->bindValue(":has_reils", 0);
-    runwayEndWriteQuery->bindValue(":has_touchdown_lights", 0);
-    runwayEndWriteQuery->bindValue(":num_strobes", 0);
-    runwayEndWriteQuery->bindValue(":ils_ident", primaryRec.valueStr("llz_identifier"));
-    runwayEndWriteQuery->bindValue(":heading", heading);
-    runwayEndWriteQuery->bindValue(":altitude", primaryRec.valueInt("landing_threshold_elevation"));
-    runwayEndWriteQuery->bindValue(":lonx", primaryPos.getLonX());
-    runwayEndWriteQuery->bindValue(":laty", primaryPos.getLatY());
-    runwayEndWriteQuery->exec();
-
-    // Write the secondary end =======================================
-    runwayEndWriteQuery->bindValue(":runway_end_id", secondaryEndId);
-    runwayEndWriteQuery->bindValue(":name", secondaryRec.valueStr("runway_identifier").mid(2));
-    runwayEndWriteQuery->bindValue(":end_type", "S");
-    runwayEndWriteQuery->bindValue(":offset_threshold", secondaryRec.valueInt("displaced_threshold_distance"));
-    runwayEndWriteQuery->bindValue(":blast_pad", 0);
-    runwayEndWriteQuery->bindValue(":overrun", 0);
-    runwayEndWriteQuery->bindValue(":has_closed_markings", 0);
-    runwayEndWriteQuery->bindValue(":has_stol_markings", 0);
-    runwayEndWriteQuery->bindValue(":is_takeoff", !sClosed);
-    runwayEndWriteQuery->bindValue(":is_landing", !sClosed);
-    runwayEndWriteQuery->bindValue(":is_pattern", 0);
-    runwayEndWriteQuery->bindValue(":has_end_lights", 0);
-    runwayEndWriteQuery->bindValue(":has_reils", 0);
-    runwayEndWriteQuery->bindValue(":has_touchdown_lights", 0);
-    runwayEndWriteQuery->bindValue(":num_strobes", 0);
-    runwayEndWriteQuery->bindValue(":ils_ident", secondaryRec.valueStr("llz_identifier"));
-    runwayEndWriteQuery->bindValue(":heading", opposedHeading);
-    runwayEndWriteQuery->bindValue(":altitude", secondaryRec.valueInt("landing_threshold_elevation"));
-    runwayEndWriteQuery->bindValue(":lonx", secondaryPos.getLonX());
-    runwayEndWriteQuery->bindValue(":laty", secondaryPos.getLatY());
-    runwayEndWriteQuery->exec();
-
-    runwayWriteQuery->exec();
+    runwayBatch->bindValue(":runway_id", ++curRunwayId);
+    runwayBatch->bindValue(":airport_id", airportId);
+    runwayBatch->bindValue(":primary_end_id", primaryEndId);
+    runwayBatch->bindValue(":secondary_end_id", secondaryEndId);
+    runwayBatch->bindValue(":length", length);
+    runwayBatch->bindValue(":width", width);
+    runwayBatch->bindValue(":heading", heading);
+    runwayBatch->bindValue(":primary_lonx", primary.pos.getLonX());
+    runwayBatch->bindValue(":primary_laty", primary.pos.getLatY());
+    runwayBatch->bindValue(":secondary_lonx", secondary.pos.getLonX());
+    runwayBatch->bindValue(":secondary_laty", secondary.pos.getLatY());
+    runwayBatch->bindValue(":altitude", alt);
+    runwayBatch->bindValue(":lonx", centerPos.getLonX());
+    runwayBatch->bindValue(":laty", centerPos.getLatY());
+    runwayBatch->addRow();
+
+    // Write the primary and secondary end =======================================
+    bindRunwayEnd(primary, primaryEndId, "P");
+    bindRunwayEnd(secondary, secondaryEndId, "S");
   }
 
-  runways.clear();
-
   // Do a workaround for insufficient runway information
   const QString& surface = longestRunwaySurfaceMap.value(apt);
   int numRunwayHard = 0, numRunwaySoft = 0, numRunwayWater = 0;
@@ -366,32 +399,38 @@ void DfdCompiler::writeRunwaysForAirport(SqlRecordVector& runways, const QString
   }
 
   // Update airport information
-  airportUpdateQuery->bindValue(":aptid", airportIndex->getAirportId(apt));
-  airportUpdateQuery->bindValue(":num_runway_hard", numRunwayHard);
-  airportUpdateQuery->bindValue(":num_runway_soft", numRunwaySoft);
-  airportUpdateQuery->bindValue(":num_runway_water", numRunwayWater);
-  airportUpdateQuery->bindValue(":longest_runway_length", longestRunwayLength);
-  airportUpdateQuery->bindValue(":longest_runway_width", longestRunwayWidth);
-  airportUpdateQuery->bindValue(":longest_runway_heading", longestRunwayHeading);
-  airportUpdateQuery->bindValue(":num_runway_end_ils", numRunwayIls);
-  airportUpdateQuery->bindValue(":num_runways", numRunways);
-  airportUpdateQuery->bindValue(":left_lonx", airportRect.getTopLeft().getLonX());
-  airportUpdateQuery->bindValue(":top_laty", airportRect.getTopLeft().getLatY());
-  airportUpdateQuery->bindValue(":right_lonx", airportRect.getBottomRight().getLonX());
-  airportUpdateQuery->bindValue(":bottom_laty", airportRect.getBottomRight().getLatY());
-  airportUpdateQuery->exec();
+  airportUpdateBatch->bindValue(":aptid", airportId);
+  airportUpdateBatch->bindValue(":num_runway_hard", numRunwayHard);
+  airportUpdateBatch->bindValue(":num_runway_soft", numRunwaySoft);
+  airportUpdateBatch->bindValue(":num_runway_water", numRunwayWater);
+  airportUpdateBatch->bindValue(":longest_runway_length", longestRunwayLength);
+  airportUpdateBatch->bindValue(":longest_runway_width", longestRunwayWidth);
+  airportUpdateBatch->bindValue(":longest_runway_heading", longestRunwayHeading);
+  airportUpdateBatch->bindValue(":num_runway_end_ils", numRunwayIls);
+  airportUpdateBatch->bindValue(":num_runways", numRunways);
+  airportUpdateBatch->bindValue(":left_lonx", airportRect.getTopLeft().getLonX());
+  airportUpdateBatch->bindValue(":top_laty", airportRect.getTopLeft().getLatY());
+  airportUpdateBatch->bindValue(":right_lonx", airportRect.getBottomRight().getLonX());
+  airportUpdateBatch->bindValue(":bottom_laty", airportRect.getBottomRight().getLatY());
+  airportUpdateBatch->addRow();
 }
 
-void DfdCompiler::pairRunways(QVector<std::pair<SqlRecord, SqlRecord> >& runwaypairs,
-                              const SqlRecordVector& runways)
+void DfdCompiler::pairRunways(QVector<std::pair<RunwayEnd, RunwayEnd> >& runwaypairs,
+                              const QVector<RunwayEnd>& runways)
 {
+  // Index of runway end by name for this airport
+  QHash<QString, int> endIndex;
+  for(int i = 0; i < runways.size(); i++)
+  {
+    if(!endIndex.contains(runways.at(i).ident))
+      endIndex.insert(runways.at(i).ident, i);
+  }
+
   // Go through the list of runways and find matching runway ends like 9R / 27L
   QSet<QString> found;
-  for(const SqlRecord& rw : runways)
+  for(const RunwayEnd& rw : runways)
   {
-    float heading = rw.valueFloat("runway_true_bearing");
-    float opposedHeading = atools::geo::opposedCourseDeg(heading);
-    QString rwident = rw.valueStr("runway_identifier");
+    const QString& rwident = rw.ident;
 
     if(found.contains(rwident))
       // Already worked on that runway end
@@ -421,42 +460,35 @@ void DfdCompiler::pairRunways(QVector<std::pair<SqlRecord, SqlRecord> >& runwayp
     QString opposedRname = "RW" + (opposedRnum < 10 ? "0" : QString()) + QString::number(opposedRnum) + opposedDesig;
 
     // Try to find the other end in the list
-    bool foundEnd = false;
-    for(const SqlRecord& opposed : runways)
+    int opposedIndex = endIndex.value(opposedRname, -1);
+    if(opposedIndex != -1)
     {
-      if(opposed.valueStr("runway_identifier") == opposedRname)
-      {
-        // Remember that we already worked on this
-        found.insert(opposedRname);
-        found.insert(rwident);
-
-        // Add to result
-        runwaypairs.append(std::make_pair(rw, opposed));
-        foundEnd = true;
-        break;
-      }
-    }
+      // Remember that we already worked on this
+      found.insert(opposedRname);
+      found.insert(rwident);
 
-    if(!foundEnd)
+      // Add to result
+      runwaypairs.append(std::make_pair(rw, runways.at(opposedIndex)));
+    }
+    else
     {
       // Nothing found - assume other end is closed if not found
-      SqlRecord opposedRec(rw);
-      opposedRec.setValue("runway_identifier", opposedRname);
-      opposedRec.setValue("displaced_threshold_distance", 0);
-      opposedRec.setValue("llz_identifier", QVariant(QVariant::String));
-      opposedRec.setValue("runway_true_bearing", opposedHeading);
-
-      // Set closed sign
-      opposedRec.appendField("is_closed", QVariant::Bool);
-      opposedRec.setValue("is_closed", true);
-
-      runwaypairs.append(std::make_pair(rw, opposedRec));
+      RunwayEnd opposed(rw);
+      opposed.ident = opposedRname;
+      opposed.displacedThreshold = 0;
+      opposed.llzIdent.clear();
+      opposed.trueBearing = atools::geo::opposedCourseDeg(rw.trueBearing);
+      opposed.closed = true;
+
+      runwaypairs.append(std::make_pair(rw, opposed));
     }
   }
 }
 
 void DfdCompiler::writeNavaids()
 {
+  ATOOLS_TRACE_SPAN("DfdCompiler::writeNavaids", "dfd");
+
   progress->reportOther("Writing navaids");
 
   SqlScript script(db, true /*options->isVerbose()*/);
@@ -468,6 +500,8 @@ void DfdCompiler::writeNavaids()
 
 void DfdCompiler::writeCom()
 {
+  ATOOLS_TRACE_SPAN("DfdCompiler::writeCom", "dfd");
+
   progress->reportOther("Writing COM Frequencies");
 
   SqlScript script(db, true /*options->isVerbose()*/);
@@ -479,6 +513,8 @@ void DfdCompiler::writeCom()
 
 void DfdCompiler::writeAirspaces()
 {
+  ATOOLS_TRACE_SPAN("DfdCompiler::writeAirspaces", "dfd");
+
   progress->reportOther("Writing Airspaces");
 
   QString arcCols("arc_origin_latitude, arc_origin_longitude, arc_distance, arc_bearing, ");
@@ -595,6 +631,8 @@ void DfdCompiler::writeAirspaces()
 
 void DfdCompiler::writeAirspaceCom()
 {
+  ATOOLS_TRACE_SPAN("DfdCompiler::writeAirspaceCom", "dfd");
+
   progress->reportOther("Writing Airspaces COM");
 
   // Update COM fields in boundary
@@ -900,7 +938,9 @@ void DfdCompiler::finishAirspace()
     airspaceWriteQuery->bindValue(":min_laty", bounding.getSouth());
 
     atools::fs::common::BinaryGeometry geo(curAirspaceLine);
-    airspaceWriteQuery->bindValue(":geometry", geo.writeToByteArray());
+    airspaceWriteQuery->bindValue(":geometry", geo.writeToByteArray(options.isPackedGeometry() ?
+                                                                    atools::fs::common::BinaryGeometry::FORMAT_PACKED :
+                                                                    atools::fs::common::BinaryGeometry::FORMAT_FLOAT));
     airspaceWriteQuery->exec();
   }
 
@@ -910,6 +950,8 @@ void DfdCompiler::finishAirspace()
 
 void DfdCompiler::writeAirways()
 {
+  ATOOLS_TRACE_SPAN("DfdCompiler::writeAirways", "dfd");
+
   progress->reportOther("Writing airways");
 
   // Get airways joined with waypoints
@@ -1018,6 +1060,11 @@ void DfdCompiler::writeAirways()
 
 void DfdCompiler::writeProcedures()
 {
+  ATOOLS_TRACE_SPAN("DfdCompiler::writeProcedures", "dfd");
+
+  // Navaids and waypoints are complete - use in memory lookups and write in batches
+  procWriter->setBatchMode(true);
+
   progress->reportOther("Writing approaches and transitions");
   writeProcedure("src.tbl_iaps", "APPCH");
 
@@ -1026,10 +1073,15 @@ void DfdCompiler::writeProcedures()
 
   progress->reportOther("Writing STARs");
   writeProcedure("src.tbl_stars", "STAR");
+
+  procWriter->flush();
+  procWriter->setBatchMode(false);
 }
 
 void DfdCompiler::writeMora()
 {
+  ATOOLS_TRACE_SPAN("DfdCompiler::writeMora", "dfd");
+
   using atools::fs::common::MoraReader;
 
   const static QString MORA_FIELD_NAME("mora%1");
@@ -1121,23 +1173,39 @@ void DfdCompiler::writeMora()
   db.commit();
 }
 
+QString DfdCompiler::procedureSelectStatement(const atools::sql::SqlDatabase& sqlDb, const QString& table,
+                                             bool withRange)
+{
+  return SqlUtil(sqlDb).buildSelectStatement(table) +
+         // " where airport_identifier in ('CYBK') "
+         // "and procedure_identifier = 'R34'"
+         (withRange ? " where airport_identifier >= :first and airport_identifier <= :last " : QString()) +
+         " order by airport_identifier, procedure_identifier, route_type, transition_identifier, seqno ";
+}
+
 void DfdCompiler::writeProcedure(const QString& table, const QString& rowCode)
 {
+  if(options.isReadParallel() && options.getNumThreads() > 1)
+  {
+    writeProcedureParallel(table, rowCode);
+    return;
+  }
+
   // Get procedures ordered from the table
-  SqlQuery query(SqlUtil(db).buildSelectStatement(table) +
-                 // " where airport_identifier in ('CYBK') "
-                 // "and procedure_identifier = 'R34'"
-                 " order by airport_identifier, procedure_identifier, route_type, transition_identifier, seqno ", db);
+  SqlQuery query(procedureSelectStatement(db, table, false), db);
   query.exec();
-  atools::fs::common::ProcedureInput procInput;
+  atools::fs::common::ProcedureInput procInput, lastInput;
+
+  // Avoid field name lookups for each row
+  ProcedureColumns cols;
+  cols.init(query);
 
-  QString curAirport;
   procInput.rowCode = rowCode;
   int num = 0;
   while(query.next())
   {
-    QString airportIdent = query.valueStr("airport_identifier");
-    if(query.valueStr("area_code") == "CTL")
+    QString airportIdent = query.valueStr(cols.airportIdent);
+    if(query.valueStr(cols.areaCode) == "CTL")
       // Ignore artificial circle-to-land duplicates
       continue;
 
@@ -1149,67 +1217,277 @@ void DfdCompiler::writeProcedure(const QString& table, const QString& rowCode)
     if((++num % 10000) == 0)
       qDebug() << num << airportIdent << "...";
 
-    if(!curAirport.isEmpty() && airportIdent != curAirport)
-    {
-      // Write all procedures of this airport
-      procWriter->finish(procInput);
-      procWriter->reset();
-    }
-
     // qDebug() << query.record();
     // Fill context for error reporting
     procInput.context = QString("File %1, airport %2, procedure %3, transition %4").
                         arg(db.databaseName()).
-                        arg(query.valueStr("airport_identifier")).
-                        arg(query.valueStr("procedure_identifier")).
-                        arg(query.valueStr("transition_identifier"));
+                        arg(airportIdent).
+                        arg(query.valueStr(cols.procIdent)).
+                        arg(query.valueStr(cols.transIdent));
 
     procInput.airportIdent = airportIdent;
-    procInput.airportId = airportIndex->getAirportId(airportIdent).toInt();
 
     // Fill data for procedure writer
-    fillProcedureInput(procInput, query);
+    fillProcedureInput(procInput, query, cols);
+
+    writeProcedureInput(procInput, lastInput);
+  }
+  procWriter->finish(lastInput);
+  procWriter->reset();
+}
+
+void DfdCompiler::writeProcedureInput(atools::fs::common::ProcedureInput& procInput,
+                                      atools::fs::common::ProcedureInput& lastInput)
+{
+  if(!lastInput.airportIdent.isEmpty() && procInput.airportIdent != lastInput.airportIdent)
+  {
+    // Write all procedures of the last airport
+    procWriter->finish(lastInput);
+    procWriter->reset();
+  }
 
-    // Leave the complicated states to the procedure writer
-    procWriter->write(procInput);
+  procInput.airportId = airportIndex->getAirportId(procInput.airportIdent).toInt();
 
-    curAirport = procInput.airportIdent;
+  // Leave the complicated states to the procedure writer
+  procWriter->write(procInput);
+
+  lastInput = procInput;
+}
+
+/* Procedure rows of a range of airports read by a thread */
+struct ProcedureChunk
+{
+  QString firstAirport, lastAirport;
+  QVector<atools::fs::common::ProcedureInput> procInputs;
+  QString errorMessage; /* Not empty if reading failed */
+};
+
+/* Reads procedure rows of a range of chunks using an own read only connection to the source database */
+class ProcedureChunkTask :
+  public QRunnable
+{
+public:
+  ProcedureChunkTask(QVector<ProcedureChunk> *chunkList, int beginIndex, int endIndex, const QString& sourceDb,
+                     const QString& tableName, const QString& rowCodeParam, const QString& contextDb)
+    : chunks(chunkList), begin(beginIndex), end(endIndex), sourceDatabase(sourceDb), table(tableName),
+    rowCode(rowCodeParam), contextDatabase(contextDb)
+  {
+    setAutoDelete(true);
   }
-  procWriter->finish(procInput);
+
+  virtual void run() override
+  {
+    ATOOLS_TRACE_SPAN("ProcedureChunkTask", "dfd");
+
+    using atools::sql::SqlDatabase;
+    static QAtomicInt connectionId;
+
+    // Connections can only be used in the thread where they were created
+    QString connectionName = QString("atools_dfd_procedures_%1").arg(connectionId.fetchAndAddRelaxed(1));
+    try
+    {
+      SqlDatabase sourceDb = SqlDatabase::addDatabase("QSQLITE", connectionName);
+      sourceDb.setDatabaseName(sourceDatabase);
+      sourceDb.setConnectOptions("QSQLITE_OPEN_READONLY");
+      sourceDb.setReadonly();
+      sourceDb.open();
+
+      {
+        SqlQuery query(sourceDb);
+        query.prepare(DfdCompiler::procedureSelectStatement(sourceDb, table, true));
+
+        for(int i = begin; i < end; i++)
+        {
+          ProcedureChunk& chunk = (*chunks)[i];
+          query.bindValue(":first", chunk.firstAirport);
+          query.bindValue(":last", chunk.lastAirport);
+          query.exec();
+
+          DfdCompiler::ProcedureColumns cols;
+          cols.init(query);
+
+          while(query.next())
+          {
+            if(query.valueStr(cols.areaCode) == "CTL")
+              // Ignore artificial circle-to-land duplicates
+              continue;
+
+            atools::fs::common::ProcedureInput procInput;
+            procInput.rowCode = rowCode;
+            procInput.airportIdent = query.valueStr(cols.airportIdent);
+
+            // Fill context for error reporting
+            procInput.context = QString("File %1, airport %2, procedure %3, transition %4").
+                                arg(contextDatabase).
+                                arg(procInput.airportIdent).
+                                arg(query.valueStr(cols.procIdent)).
+                                arg(query.valueStr(cols.transIdent));
+
+            DfdCompiler::fillProcedureInput(procInput, query, cols);
+            chunk.procInputs.append(procInput);
+          }
+          query.finish();
+        }
+      }
+      sourceDb.close();
+    }
+    catch(std::exception& e)
+    {
+      (*chunks)[begin].errorMessage = e.what();
+    }
+    SqlDatabase::removeDatabase(connectionName);
+  }
+
+private:
+  QVector<ProcedureChunk> *chunks;
+  int begin, end;
+  QString sourceDatabase, table, rowCode, contextDatabase;
+};
+
+void DfdCompiler::writeProcedureParallel(const QString& table, const QString& rowCode)
+{
+  // Split the ordered airport list into ranges
+  QVector<ProcedureChunk> allChunks;
+  SqlQuery airportQuery(db);
+  airportQuery.exec("select distinct airport_identifier from " + table + " order by airport_identifier");
+  int num = 0;
+  while(airportQuery.next())
+  {
+    QString ident = airportQuery.valueStr(0);
+    if((num++ % PROCEDURE_AIRPORTS_PER_CHUNK) == 0)
+    {
+      allChunks.append(ProcedureChunk());
+      allChunks.last().firstAirport = ident;
+    }
+    allChunks.last().lastAirport = ident;
+  }
+
+  // Table name without schema prefix for the separate connections
+  QString sourceTable = table.section('.', -1);
+
+  int numThreads = options.getNumThreads();
+  int batchSize = numThreads * PROCEDURE_CHUNKS_PER_THREAD;
+
+  // Chunks being written and chunks being read - declared before the pool which waits for all tasks
+  QVector<ProcedureChunk> current, next;
+
+  QThreadPool threadPool;
+  threadPool.setMaxThreadCount(numThreads);
+
+  int nextChunk = 0;
+  auto startChunks = [&](QVector<ProcedureChunk>& chunks) -> void
+  {
+    chunks = allChunks.mid(nextChunk, batchSize);
+    nextChunk += chunks.size();
+
+    int rangeSize = std::max(chunks.size() / numThreads, 1);
+    for(int rangeBegin = 0; rangeBegin < chunks.size(); rangeBegin += rangeSize)
+      threadPool.start(new ProcedureChunkTask(&chunks, rangeBegin, std::min(rangeBegin + rangeSize, chunks.size()),
+                                              options.getSourceDatabase(), sourceTable, rowCode,
+                                              db.databaseName()));
+  };
+
+  startChunks(current);
+  threadPool.waitForDone();
+
+  atools::fs::common::ProcedureInput lastInput;
+  lastInput.rowCode = rowCode;
+  while(!current.isEmpty())
+  {
+    // Read the next set of airports while the current ones are written
+    startChunks(next);
+
+    for(ProcedureChunk& chunk : current)
+    {
+      if(!chunk.errorMessage.isEmpty())
+      {
+        procWriter->reset();
+        threadPool.waitForDone();
+        throw atools::Exception(QString("Caught exception reading procedures from \"%1\" for airports %2 to %3. "
+                                        "Message: %4").
+                                arg(table).arg(chunk.firstAirport).arg(chunk.lastAirport).arg(chunk.errorMessage));
+      }
+
+      for(atools::fs::common::ProcedureInput& procInput : chunk.procInputs)
+        writeProcedureInput(procInput, lastInput);
+      chunk.procInputs.clear();
+    }
+
+    threadPool.waitForDone();
+    current.swap(next);
+  }
+  procWriter->finish(lastInput);
   procWriter->reset();
 }
 
-void DfdCompiler::fillProcedureInput(atools::fs::common::ProcedureInput& procInput, const atools::sql::SqlQuery& query)
+void DfdCompiler::ProcedureColumns::init(const SqlQuery& query)
+{
+  airportIdent = query.columnIndex("airport_identifier");
+  areaCode = query.columnIndex("area_code");
+  seqNo = query.columnIndex("seqno");
+  routeType = query.columnIndex("route_type");
+  procIdent = query.columnIndex("procedure_identifier");
+  transIdent = query.columnIndex("transition_identifier");
+  waypointIdent = query.columnIndex("waypoint_identifier");
+  waypointIcaoCode = query.columnIndex("waypoint_icao_code");
+  waypointDescCode = query.columnIndex("waypoint_description_code");
+  waypointLonx = query.columnIndex("waypoint_longitude");
+  waypointLaty = query.columnIndex("waypoint_latitude");
+  turnDir = query.columnIndex("turn_direction");
+  pathTerm = query.columnIndex("path_termination");
+  recdNavaid = query.columnIndex("recommanded_navaid");
+  recdNavaidLonx = query.columnIndex("recommanded_navaid_longitude");
+  recdNavaidLaty = query.columnIndex("recommanded_navaid_latitude");
+  theta = query.columnIndex("theta");
+  rho = query.columnIndex("rho");
+  magCourse = query.columnIndex("magnetic_course");
+  distTime = query.columnIndex("route_distance_holding_distance_time");
+  // Not available in older databases
+  distanceTimeFlag = query.record(true /* allowInvalidQuery */).indexOf("distance_time");
+  altDescr = query.columnIndex("altitude_description");
+  altitude1 = query.columnIndex("altitude1");
+  altitude2 = query.columnIndex("altitude2");
+  transAlt = query.columnIndex("transition_altitude");
+  speedLimitDescr = query.columnIndex("speed_limit_description");
+  speedLimit = query.columnIndex("speed_limit");
+  centerWaypoint = query.columnIndex("center_waypoint");
+  centerWaypointLonx = query.columnIndex("center_waypoint_longitude");
+  centerWaypointLaty = query.columnIndex("center_waypoint_latitude");
+}
+
+void DfdCompiler::fillProcedureInput(atools::fs::common::ProcedureInput& procInput, const atools::sql::SqlQuery& query,
+                                     const ProcedureColumns& cols)
 {
-  procInput.seqNr = query.valueInt("seqno");
-  procInput.routeType = atools::strToChar(query.valueStr("route_type"));
-  procInput.sidStarAppIdent = query.valueStr("procedure_identifier");
-  procInput.transIdent = query.valueStr("transition_identifier");
-  procInput.fixIdent = query.valueStr("waypoint_identifier").trimmed();
-  procInput.region = query.valueStr("waypoint_icao_code").trimmed();
+  procInput.seqNr = query.valueInt(cols.seqNo);
+  procInput.routeType = atools::strToChar(query.valueStr(cols.routeType));
+  procInput.sidStarAppIdent = query.valueStr(cols.procIdent);
+  procInput.transIdent = query.valueStr(cols.transIdent);
+  procInput.fixIdent = query.valueStr(cols.waypointIdent).trimmed();
+  procInput.region = query.valueStr(cols.waypointIcaoCode).trimmed();
   // procInput.secCode = query.valueStr(""); // Not available
   // procInput.subCode = query.valueStr(""); // Not available
-  procInput.descCode = query.valueStr("waypoint_description_code");
-  procInput.waypointPos = DPos(query.valueDouble("waypoint_longitude"), query.valueDouble("waypoint_latitude"));
+  procInput.descCode = query.valueStr(cols.waypointDescCode);
+  procInput.waypointPos = DPos(query.valueDouble(cols.waypointLonx), query.valueDouble(cols.waypointLaty));
 
-  procInput.turnDir = query.valueStr("turn_direction");
-  procInput.pathTerm = query.valueStr("path_termination");
-  procInput.recdNavaid = query.valueStr("recommanded_navaid").trimmed();
+  procInput.turnDir = query.valueStr(cols.turnDir);
+  procInput.pathTerm = query.valueStr(cols.pathTerm);
+  procInput.recdNavaid = query.valueStr(cols.recdNavaid).trimmed();
   // procInput.recdIcaoCode = query.valueStr(""); // Not available
   // procInput.recdSecCode = query.valueStr("");  // Not available
   // procInput.recdSubCode = query.valueStr("");  // Not available
-  procInput.recdWaypointPos = DPos(query.valueDouble("recommanded_navaid_longitude"),
-                                   query.valueDouble("recommanded_navaid_latitude"));
+  procInput.recdWaypointPos = DPos(query.valueDouble(cols.recdNavaidLonx),
+                                   query.valueDouble(cols.recdNavaidLaty));
 
-  procInput.theta = query.valueFloat("theta");
-  procInput.rho = query.valueFloat("rho");
-  procInput.magCourse = query.valueFloat("magnetic_course");
+  procInput.theta = query.valueFloat(cols.theta);
+  procInput.rho = query.valueFloat(cols.rho);
+  procInput.magCourse = query.valueFloat(cols.magCourse);
 
-  float distTime = query.valueFloat("route_distance_holding_distance_time");
+  float distTime = query.valueFloat(cols.distTime);
   procInput.rteHoldTime = procInput.rteHoldDist = 0.f;
   if(procInput.pathTerm.startsWith("H"))
   {
-    QString distTimeFlag = query.valueStr("distance_time", QString()).trimmed().toUpper();
+    QString distTimeFlag = cols.distanceTimeFlag != -1 ?
+                           query.valueStr(cols.distanceTimeFlag).trimmed().toUpper() : QString();
     if(distTimeFlag == "D")
       procInput.rteHoldDist = distTime;
     else if(distTimeFlag == "T")
@@ -1226,23 +1504,41 @@ void DfdCompiler::fillProcedureInput(atools::fs::common::ProcedureInput& procInp
   else
     procInput.rteHoldDist = distTime;
 
-  procInput.altDescr = query.valueStr("altitude_description");
-  procInput.altitude = query.valueStr("altitude1");
-  procInput.altitude2 = query.valueStr("altitude2");
-  procInput.transAlt = query.valueStr("transition_altitude");
-  procInput.speedLimitDescr = query.valueStr("speed_limit_description");
-  procInput.speedLimit = query.valueInt("speed_limit");
+  procInput.altDescr = query.valueStr(cols.altDescr);
+  procInput.altitude = query.valueStr(cols.altitude1);
+  procInput.altitude2 = query.valueStr(cols.altitude2);
+  procInput.transAlt = query.valueStr(cols.transAlt);
+  procInput.speedLimitDescr = query.valueStr(cols.speedLimitDescr);
+  procInput.speedLimit = query.valueInt(cols.speedLimit);
 
-  procInput.centerFixOrTaaPt = query.valueStr("center_waypoint");
+  procInput.centerFixOrTaaPt = query.valueStr(cols.centerWaypoint);
   // procInput.centerIcaoCode = query.valueStr(""); // Not available
   // procInput.centerSecCode = query.valueStr("");  // Not available
   // procInput.centerSubCode = query.valueStr("");  // Not available
-  procInput.centerPos = DPos(query.valueDouble("center_waypoint_longitude"),
-                             query.valueDouble("center_waypoint_latitude"));
+  procInput.centerPos = DPos(query.valueDouble(cols.centerWaypointLonx),
+                             query.valueDouble(cols.centerWaypointLaty));
 
   // procInput.gnssFmsIndicator = query.valueStr("");
 }
 
+void DfdCompiler::initFromDatabase()
+{
+  SqlQuery query(db);
+  query.exec("select max(airport_id) from airport");
+  curAirportId = query.next() ? query.valueInt(0) : 0;
+  query.exec("select max(runway_id) from runway");
+  curRunwayId = query.next() ? query.valueInt(0) : 0;
+  query.exec("select max(runway_end_id) from runway_end");
+  curRunwayEndId = query.next() ? query.valueInt(0) : 0;
+  query.exec("select max(boundary_id) from boundary");
+  curAirspaceId = query.next() ? query.valueInt(0) : 0;
+
+  query.exec("select airport_id, ident from airport");
+  while(query.next())
+    airportIndex->addAirport(query.valueStr("ident"), query.valueInt("airport_id"));
+  query.finish();
+}
+
 void DfdCompiler::close()
 {
   delete magDecReader;
@@ -1273,6 +1569,8 @@ void DfdCompiler::readHeader()
 
 void DfdCompiler::compileMagDeclBgl()
 {
+  ATOOLS_TRACE_SPAN("DfdCompiler::compileMagDeclBgl", "dfd");
+
   // Look first in config dir and then in local dir
   QString file =
     atools::settings::Settings::instance().getOverloadedPath(atools::buildPath({QApplication::applicationDirPath(),
@@ -1294,41 +1592,92 @@ void DfdCompiler::writeFileAndSceneryMetadata()
 
 void DfdCompiler::updateMagvar()
 {
+  ATOOLS_TRACE_SPAN("DfdCompiler::updateMagvar", "dfd");
+
   progress->reportOther("Updating magnetic declination");
 
-  atools::fs::common::MagDecReader *magdec = magDecReader;
-  SqlUtil::UpdateColFuncType func =
-    [magdec](const atools::sql::SqlQuery& from, atools::sql::SqlQuery& to) -> bool
-    {
-      to.bindValue(":mag_var", magdec->getMagVar(Pos(from.valueFloat("lonx"),
-                                                     from.valueFloat("laty"))));
-      return true;
-    };
-
-  SqlUtil util(db);
-  util.updateColumnInTable("waypoint", "waypoint_id", {"lonx", "laty"}, {"mag_var"}, func);
-  util.updateColumnInTable("ndb", "ndb_id", {"lonx", "laty"}, {"mag_var"}, func);
-  util.updateColumnInTable("vor", "vor_id", {"lonx", "laty"}, {"mag_var"}, "mag_var is null", func);
+  updateMagvar("waypoint", "waypoint_id", QString());
+  updateMagvar("ndb", "ndb_id", QString());
   db.commit();
 }
 
-void DfdCompiler::updateTacanChannel()
+void DfdCompiler::updateMagvar(const QString& table, const QString& idColumn, const QString& where)
 {
-  progress->reportOther("Updating VORTAC and TACAN channels");
+  // Read all coordinates first to calculate declination for all rows at once
+  QVector<int> ids;
+  LineString positions;
 
-  SqlUtil::UpdateColFuncType func =
-    [](const atools::sql::SqlQuery& from, atools::sql::SqlQuery& to) -> bool
-    {
-      QString type = from.valueStr("type");
-      if(type == "TC" || type.startsWith("VT")) // TACAN or VORTAC
-      {
-        to.bindValue(":channel", atools::fs::util::tacanChannelForFrequency(from.valueInt("frequency") / 10));
-        return true;
-      }
-      else
-        return false;
-    };
-  SqlUtil(db).updateColumnInTable("vor", "vor_id", {"frequency", "type"}, {"channel"}, func);
+  SqlQuery query(db);
+  query.exec("select " + idColumn + ", lonx, laty from " + table + (where.isEmpty() ? QString() : " where " + where));
+  while(query.next())
+  {
+    ids.append(query.valueInt(0));
+    positions.append(query.valueFloat(1), query.valueFloat(2));
+  }
+
+  QVector<float> magvars;
+  magDecReader->getMagVar(magvars, positions);
+
+  SqlQuery updateQuery(db);
+  updateQuery.prepare("update " + table + " set mag_var = :mag_var where " + idColumn + " = :id");
+  SqlBatch batch(&updateQuery);
+  for(int i = 0; i < ids.size(); i++)
+  {
+    batch.bindValue(":mag_var", magvars.at(i));
+    batch.bindValue(":id", ids.at(i));
+    batch.addRow();
+  }
+  batch.exec();
+}
+
+void DfdCompiler::updateVorMagvarAndTacanChannel()
+{
+  ATOOLS_TRACE_SPAN("DfdCompiler::updateVorMagvarAndTacanChannel", "dfd");
+
+  progress->reportOther("Updating VOR declination and VORTAC and TACAN channels");
+
+  // One scan for both missing declination and channels
+  QVector<int> ids;
+  QVector<bool> magvarMissing;
+  QVector<QVariant> channels;
+  LineString positions;
+
+  SqlQuery query(db);
+  query.exec("select vor_id, lonx, laty, mag_var is null as magvar_missing, type, frequency from vor");
+  int idIdx = query.columnIndex("vor_id"), lonxIdx = query.columnIndex("lonx"), latyIdx = query.columnIndex("laty"),
+      missingIdx = query.columnIndex("magvar_missing"), typeIdx = query.columnIndex("type"),
+      frequencyIdx = query.columnIndex("frequency");
+  while(query.next())
+  {
+    QString type = query.valueStr(typeIdx);
+    bool missing = query.valueBool(missingIdx);
+    bool tacan = type == "TC" || type.startsWith("VT"); // TACAN or VORTAC
+
+    if(!missing && !tacan)
+      continue;
+
+    ids.append(query.valueInt(idIdx));
+    magvarMissing.append(missing);
+    positions.append(query.valueFloat(lonxIdx), query.valueFloat(latyIdx));
+    channels.append(tacan ? atools::fs::util::tacanChannelForFrequency(query.valueInt(frequencyIdx) / 10) : QVariant());
+  }
+
+  QVector<float> magvars;
+  magDecReader->getMagVar(magvars, positions);
+
+  // Null values keep the current column value
+  SqlQuery updateQuery(db);
+  updateQuery.prepare("update vor set mag_var = coalesce(:mag_var, mag_var), channel = coalesce(:channel, channel) "
+                      "where vor_id = :id");
+  SqlBatch batch(&updateQuery);
+  for(int i = 0; i < ids.size(); i++)
+  {
+    batch.bindValue(":mag_var", magvarMissing.at(i) ? QVariant(magvars.at(i)) : QVariant(QVariant::Double));
+    batch.bindValue(":channel", channels.at(i).isNull() ? QVariant(QVariant::String) : channels.at(i));
+    batch.bindValue(":id", ids.at(i));
+    batch.addRow();
+  }
+  batch.exec();
   db.commit();
 }
 
@@ -1336,35 +1685,61 @@ void DfdCompiler::updateIlsGeometry()
 {
   progress->reportOther("Updating ILS geometry");
 
-  SqlUtil::UpdateColFuncType func =
-    [](const atools::sql::SqlQuery& from, atools::sql::SqlQuery& to) -> bool
-    {
-      // Position of the pointy end
-      Pos pos(from.valueFloat("lonx"), from.valueFloat("laty"));
-
-      float length = atools::geo::nmToMeter(ILS_FEATHER_LEN_NM);
-      float heading = atools::geo::opposedCourseDeg(from.valueFloat("loc_heading"));
-
-      // Corner endpoints
-      Pos p1 = pos.endpoint(length, heading - ILS_FEATHER_WIDTH / 2.f).normalize();
-      Pos p2 = pos.endpoint(length, heading + ILS_FEATHER_WIDTH / 2.f).normalize();
-
-      // Calculated the center point between corners - move it a bit towareds the pointy end
-      float featherWidth = p1.distanceMeterTo(p2);
-      Pos pmid = pos.endpoint(length - featherWidth / 2, heading).normalize();
-
-      to.bindValue(":end1_lonx", p1.getLonX());
-      to.bindValue(":end1_laty", p1.getLatY());
-      to.bindValue(":end_mid_lonx", pmid.getLonX());
-      to.bindValue(":end_mid_laty", pmid.getLatY());
-      to.bindValue(":end2_lonx", p2.getLonX());
-      to.bindValue(":end2_laty", p2.getLatY());
-      return true;
-    };
-
-  SqlUtil(db).updateColumnInTable("ils", "ils_id", {"lonx", "laty", "loc_heading"},
-                                  {"end1_lonx", "end1_laty", "end_mid_lonx", "end_mid_laty", "end2_lonx", "end2_laty"},
-                                  func);
+  // Read all positions and headings first
+  QVector<int> ids;
+  QVector<float> headings;
+  LineString positions;
+
+  SqlQuery query(db);
+  query.exec("select ils_id, lonx, laty, loc_heading from ils");
+  while(query.next())
+  {
+    ids.append(query.valueInt(0));
+    positions.append(query.valueFloat(1), query.valueFloat(2));
+    headings.append(query.valueFloat(3));
+  }
+
+  // Calculate all feathers
+  const float length = atools::geo::nmToMeter(ILS_FEATHER_LEN_NM);
+  LineString ends1, endsMid, ends2;
+  ends1.reserve(ids.size());
+  endsMid.reserve(ids.size());
+  ends2.reserve(ids.size());
+  for(int i = 0; i < ids.size(); i++)
+  {
+    // Position of the pointy end
+    const Pos& pos = positions.at(i);
+    float heading = atools::geo::opposedCourseDeg(headings.at(i));
+
+    // Corner endpoints
+    Pos p1 = pos.endpoint(length, heading - ILS_FEATHER_WIDTH / 2.f).normalize();
+    Pos p2 = pos.endpoint(length, heading + ILS_FEATHER_WIDTH / 2.f).normalize();
+
+    // Calculated the center point between corners - move it a bit towareds the pointy end
+    float featherWidth = p1.distanceMeterTo(p2);
+    ends1.append(p1);
+    endsMid.append(pos.endpoint(length - featherWidth / 2, heading).normalize());
+    ends2.append(p2);
+  }
+
+  // Write back
+  SqlQuery updateQuery(db);
+  updateQuery.prepare("update ils set end1_lonx = :end1_lonx, end1_laty = :end1_laty, "
+                      "end_mid_lonx = :end_mid_lonx, end_mid_laty = :end_mid_laty, "
+                      "end2_lonx = :end2_lonx, end2_laty = :end2_laty where ils_id = :id");
+  SqlBatch batch(&updateQuery);
+  for(int i = 0; i < ids.size(); i++)
+  {
+    batch.bindValue(":end1_lonx", ends1.at(i).getLonX());
+    batch.bindValue(":end1_laty", ends1.at(i).getLatY());
+    batch.bindValue(":end_mid_lonx", endsMid.at(i).getLonX());
+    batch.bindValue(":end_mid_laty", endsMid.at(i).getLatY());
+    batch.bindValue(":end2_lonx", ends2.at(i).getLonX());
+    batch.bindValue(":end2_laty", ends2.at(i).getLatY());
+    batch.bindValue(":id", ids.at(i));
+    batch.addRow();
+  }
+  batch.exec();
   db.commit();
 }
 
@@ -1379,44 +1754,41 @@ void DfdCompiler::updateTreeLetterAirportCodes()
     return;
   }
 
-  QHash<QString, QString> codeMap;
-  SqlQuery codeQuery("select airport_identifier, airport_identifier_3letter "
-                     "from src.tbl_airports where airport_identifier_3letter is not null", db);
-  codeQuery.exec();
-  while(codeQuery.next())
-    codeMap.insert(codeQuery.valueStr("airport_identifier"), codeQuery.valueStr("airport_identifier_3letter"));
-  codeQuery.finish();
+  // Copy code mapping into a temporary table to update each column with one statement
+  SqlQuery query(db);
+  query.exec("drop table if exists temp.airport_code_map");
+  query.exec("create temp table airport_code_map (code4 varchar(10) primary key, code3 varchar(10))");
+  query.exec("insert or ignore into temp.airport_code_map (code4, code3) "
+             "select airport_identifier, airport_identifier_3letter "
+             "from src.tbl_airports where airport_identifier_3letter is not null");
 
-  updateTreeLetterAirportCodes(codeMap, "airport", "ident");
-  updateTreeLetterAirportCodes(codeMap, "airport_file", "ident");
-  updateTreeLetterAirportCodes(codeMap, "approach", "airport_ident");
+  updateTreeLetterAirportCodes("airport", "ident");
+  updateTreeLetterAirportCodes("airport_file", "ident");
+  updateTreeLetterAirportCodes("approach", "airport_ident");
 
   // Not used in DFD
-  // updateTreeLetterAirportCodes(codeMap, "approach", "fix_airport_ident");
-  // updateTreeLetterAirportCodes(codeMap, "approach_leg", "fix_airport_ident");
-  // updateTreeLetterAirportCodes(codeMap, "transition", "fix_airport_ident");
-  // updateTreeLetterAirportCodes(codeMap, "transition", "dme_airport_ident");
-  // updateTreeLetterAirportCodes(codeMap, "transition_leg", "fix_airport_ident");
-
-  updateTreeLetterAirportCodes(codeMap, "ils", "loc_airport_ident");
-  updateTreeLetterAirportCodes(codeMap, "airway_point", "next_airport_ident");
-  updateTreeLetterAirportCodes(codeMap, "airway_point", "previous_airport_ident");
+  // updateTreeLetterAirportCodes("approach", "fix_airport_ident");
+  // updateTreeLetterAirportCodes("approach_leg", "fix_airport_ident");
+  // updateTreeLetterAirportCodes("transition", "fix_airport_ident");
+  // updateTreeLetterAirportCodes("transition", "dme_airport_ident");
+  // updateTreeLetterAirportCodes("transition_leg", "fix_airport_ident");
+
+  updateTreeLetterAirportCodes("ils", "loc_airport_ident");
+  updateTreeLetterAirportCodes("airway_point", "next_airport_ident");
+  updateTreeLetterAirportCodes("airway_point", "previous_airport_ident");
+
+  query.exec("drop table temp.airport_code_map");
 }
 
-void DfdCompiler::updateTreeLetterAirportCodes(const QHash<QString, QString> codeMap, const QString& table,
-                                               const QString& column)
+void DfdCompiler::updateTreeLetterAirportCodes(const QString& table, const QString& column)
 {
   qInfo() << "Updating three-letter codes in" << table << column;
-  SqlQuery update(db);
-  update.prepare("update " + table + " set " + column + " = :code3 where " + column + " = :code4");
 
-  QList<QString> codes4 = codeMap.keys();
-  for(const QString& code4 :codes4)
-  {
-    update.bindValue(":code4", code4);
-    update.bindValue(":code3", codeMap.value(code4));
-    update.exec();
-  }
+  // Correlated sub query since update from is not supported by older SQLite
+  SqlQuery update(db);
+  update.exec("update " + table + " set " + column + " = "
+              "(select m.code3 from temp.airport_code_map m where m.code4 = " + table + "." + column + ") "
+              "where " + column + " in (select code4 from temp.airport_code_map)");
 }
 
 void DfdCompiler::initQueries()
@@ -1488,6 +1860,8 @@ void DfdCompiler::deInitQueries()
   if(metadataWriter != nullptr)
     metadataWriter->deInitQueries();
 
+  deleteRunwayBatches();
+
   delete airportQuery;
   airportQuery = nullptr;
 
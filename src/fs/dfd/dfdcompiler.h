@@ -27,6 +27,7 @@ namespace atools {
 namespace sql {
 class SqlDatabase;
 class SqlQuery;
+class SqlBatch;
 class SqlRecordVector;
 class SqlRecord;
 }
@@ -51,8 +52,12 @@ namespace ng {
  * Creates a Little Navmap scenery database from an extended DFD database.
  * Only for command line based compilation.
  */
+class ProcedureChunkTask;
+
 class DfdCompiler
 {
+  friend class ProcedureChunkTask;
+
 public:
   DfdCompiler(atools::sql::SqlDatabase& sqlDb, const atools::fs::NavDatabaseOptions& opts,
               atools::fs::ProgressHandler *progressHandler, atools::fs::NavDatabaseErrors *navdatabaseErrors);
@@ -81,6 +86,9 @@ public:
   /* Write a single dummy scenery area and file */
   void writeFileAndSceneryMetadata();
 
+  /* Restore ids and airport index from the already loaded data when resuming an aborted compilation */
+  void initFromDatabase();
+
   /* Attach source database with alias "src" */
   void attachDatabase();
   void detachDatabase();
@@ -107,8 +115,8 @@ public:
   /* Update declination for waypoint and NDB */
   void updateMagvar();
 
-  /* Update TACAN and VORTAC channels */
-  void updateTacanChannel();
+  /* Update missing VOR declination and TACAN and VORTAC channels in one pass */
+  void updateVorMagvarAndTacanChannel();
 
   /* Calculate the ILS endpoints for map displayy */
   void updateIlsGeometry();
@@ -129,19 +137,59 @@ public:
   void updateTreeLetterAirportCodes();
 
 private:
+  /* Calculate declination for all rows of the table matching the optional where clause */
+  void updateMagvar(const QString& table, const QString& idColumn, const QString& where);
+
+  /* Runway end as read from tbl_runways */
+  struct RunwayEnd
+  {
+    QString ident, llzIdent;
+    atools::geo::Pos pos;
+    float trueBearing;
+    int length, width, thresholdElevation, displacedThreshold;
+    bool closed;
+  };
+
   /* Write all collected runways for an airport */
-  void writeRunwaysForAirport(sql::SqlRecordVector& runways, const QString& apt);
+  void writeRunwaysForAirport(const QVector<RunwayEnd>& runways, const QString& apt);
+
+  /* Add runway end to batch */
+  void bindRunwayEnd(const RunwayEnd& end, int endId, const QString& endType);
 
   /* Match opposing runway ends */
-  void pairRunways(QVector<std::pair<atools::sql::SqlRecord, atools::sql::SqlRecord> >& runwaypairs,
-                   const sql::SqlRecordVector& runways);
+  void pairRunways(QVector<std::pair<RunwayEnd, RunwayEnd> >& runwaypairs, const QVector<RunwayEnd>& runways);
+
+  void deleteRunwayBatches();
 
   /* Fill input structure for ProcedureWriter */
-  void fillProcedureInput(atools::fs::common::ProcedureInput& procInput, const atools::sql::SqlQuery& query);
+  /* Column indexes of the procedure tables resolved once per result */
+  struct ProcedureColumns
+  {
+    void init(const atools::sql::SqlQuery& query);
+
+    int airportIdent, areaCode, seqNo, routeType, procIdent, transIdent, waypointIdent, waypointIcaoCode,
+        waypointDescCode, waypointLonx, waypointLaty, turnDir, pathTerm, recdNavaid, recdNavaidLonx,
+        recdNavaidLaty, theta, rho, magCourse, distTime, distanceTimeFlag, altDescr, altitude1, altitude2,
+        transAlt, speedLimitDescr, speedLimit, centerWaypoint, centerWaypointLonx, centerWaypointLaty;
+  };
+
+  static void fillProcedureInput(atools::fs::common::ProcedureInput& procInput, const atools::sql::SqlQuery& query,
+                                 const ProcedureColumns& cols);
+
+  /* Get ordered statement for a procedure table. Filter by airport range if withRange is true. */
+  static QString procedureSelectStatement(const atools::sql::SqlDatabase& sqlDb, const QString& table, bool withRange);
 
   /* Write on procedure type - SID, STAR, approaches */
   void writeProcedure(const QString& table, const QString& rowCode);
 
+  /* Same as writeProcedure() but reads airport ranges in threads using separate read only connections
+   * to the source database. Procedures are written in airport order by this thread. */
+  void writeProcedureParallel(const QString& table, const QString& rowCode);
+
+  /* Assign airport id and pass row to the writer. Finishes the airport of lastInput if the airport changes. */
+  void writeProcedureInput(atools::fs::common::ProcedureInput& procInput,
+                           atools::fs::common::ProcedureInput& lastInput);
+
   /* Start airspace and fill insert query with general airspace data like limits and name from the first source column */
   void beginAirspace(const sql::SqlQuery& query);
 
@@ -164,7 +212,8 @@ private:
   int airspaceAlt(const QString& altStr);
 
   /* Update airport ident with three letter code for given table */
-  void updateTreeLetterAirportCodes(const QHash<QString, QString> codeMap, const QString& table, const QString& column);
+  /* Update column from temporary table airport_code_map */
+  void updateTreeLetterAirportCodes(const QString& table, const QString& column);
 
   /* Airspace segment containing information */
   struct AirspaceSeg
@@ -203,6 +252,9 @@ private:
                         *runwayEndWriteQuery = nullptr, *metadataQuery = nullptr, *airspaceWriteQuery = nullptr,
                         *moraQuery = nullptr;
 
+  /* Only valid while writing runways */
+  atools::sql::SqlBatch *runwayBatch = nullptr, *runwayEndBatch = nullptr, *airportUpdateBatch = nullptr;
+
 };
 
 } // namespace ng
@@ -24,8 +24,12 @@
 #include "geo/calculations.h"
 #include "geo/pos.h"
 #include "sql/sqlutil.h"
+#include "sql/sqlbatch.h"
+#include "sql/sqlscript.h"
+#include "settings/settings.h"
 
 #include <QDebug>
+#include <QHash>
 
 namespace atools {
 namespace fs {
@@ -33,20 +37,57 @@ namespace lb {
 
 using atools::sql::SqlDatabase;
 using atools::sql::SqlQuery;
+using atools::sql::SqlBatch;
 using atools::io::BinaryStream;
+using atools::sql::SqlScript;
+using atools::settings::Settings;
 
 Logbook::Logbook(SqlDatabase *sqlDb, FsPaths::SimulatorType type)
   : db(sqlDb), sim(type)
 {
 }
 
+/* Totals collected while reading for each SummaryType and added to table logbook_statistics */
+typedef QHash<QString, LogbookSummary> SummaryHash;
+
+static void addSummary(SummaryHash summaries[], SummaryType type, const QString& key, const QString& subKey,
+                       const LogbookEntry& e, const QVariant& distance, int departures, int arrivals)
+{
+  LogbookSummary& summary = summaries[type][key + QChar('\t') + subKey];
+  summary.key = key;
+  summary.subKey = subKey;
+  summary.numFlights++;
+  summary.numDepartures += departures;
+  summary.numArrivals += arrivals;
+  summary.totalTime += e.getTotalTimeMin();
+  summary.nightTime += e.getNightTime();
+  summary.instrumentTime += e.getInstrumentTime();
+  if(!distance.isNull())
+    summary.distance += distance.toDouble();
+}
+
+/* Columns from the airport table */
+struct LogbookAirport
+{
+  QVariant name, city, state, country;
+  double lonx, laty;
+  bool found, hasCoords;
+};
+
+void Logbook::setStartPosition(qint64 offset, int entryNumber, int logbookId)
+{
+  startOffset = offset;
+  startEntryNumber = entryNumber;
+  startLogbookId = logbookId;
+}
+
 void Logbook::read(QFile *file, const LogbookEntryFilter& filter, bool append)
 {
   // TODO read also dummy entries to allow write back
   BinaryStream bs(file, QDataStream::LittleEndian);
 
   qint64 size = bs.getFileSize();
-  if(size == 0 || size > std::numeric_limits<int>::max())
+  if(size == 0 || size > std::numeric_limits<int>::max() || startOffset > size)
   {
     // Lets assume that logbook files are never bigger than 2GB
     db->rollback();
@@ -59,21 +100,69 @@ void Logbook::read(QFile *file, const LogbookEntryFilter& filter, bool append)
   SqlQuery entryStmt = LogbookEntry::prepareEntryStatement(db);
   SqlQuery visitStmt = LogbookEntry::prepareVisitStatement(db);
 
+  // Visits are written after each entry batch since they refer to the entries
+  SqlBatch entryBatch(&entryStmt);
+  SqlBatch visitBatch(&visitStmt, std::numeric_limits<int>::max());
+  entryBatch.bindConstant(":simulator_id", sim);
+  visitBatch.bindConstant(":simulator_id", sim);
+
   SqlQuery airportStmt(db);
   if(hasAirports)
     airportStmt.prepare("select name, city, state, country, longitude, latitude "
                         "from airport where icao = :icao");
 
-  SqlQuery countStmt(db);
+  // Airports are looked up only once
+  QHash<QString, LogbookAirport> airportCache;
+  auto airport = [&](const QString& icao) -> LogbookAirport
+  {
+    auto it = airportCache.constFind(icao);
+    if(it != airportCache.constEnd())
+      return it.value();
+
+    LogbookAirport ap = {QVariant(QVariant::String), QVariant(QVariant::String), QVariant(QVariant::String),
+                         QVariant(QVariant::String), 0., 0., false, false};
+    airportStmt.bindValue(":icao", icao);
+    airportStmt.exec();
+    if(airportStmt.next())
+    {
+      ap.found = true;
+      ap.name = airportStmt.value("name").toString();
+      ap.city = airportStmt.value("city").toString();
+      ap.state = airportStmt.value("state").toString();
+      ap.country = airportStmt.value("country").toString();
 
-  countStmt.exec("select count(*) from logbook where simulator_id = " + QString().setNum(sim));
-  if(countStmt.next())
-    numEntriesInDb = countStmt.value(0).toInt();
+      if(!airportStmt.isNull("latitude") && !airportStmt.isNull("longitude"))
+      {
+        ap.lonx = airportStmt.value("longitude").toDouble();
+        ap.laty = airportStmt.value("latitude").toDouble();
+        ap.hasCoords = true;
+      }
+    }
+    airportCache.insert(icao, ap);
+    return ap;
+  };
 
-  // Calculate the next available logbook ID
-  countStmt.exec("select max(logbook_id) from logbook where simulator_id = " + QString().setNum(sim));
-  if(countStmt.next())
-    logbookId = countStmt.value(0).toInt() + 1;
+  SqlQuery countStmt(db);
+
+  if(startOffset > 0)
+  {
+    // Continue after the last read entry - all following are new
+    bs.seekg(startOffset);
+    entryNumber = numEntriesInDb = startEntryNumber;
+    logbookId = startLogbookId;
+    append = true;
+  }
+  else
+  {
+    countStmt.exec("select count(*) from logbook where simulator_id = " + QString().setNum(sim));
+    if(countStmt.next())
+      numEntriesInDb = countStmt.value(0).toInt();
+
+    // Calculate the next available logbook ID
+    countStmt.exec("select max(logbook_id) from logbook where simulator_id = " + QString().setNum(sim));
+    if(countStmt.next())
+      logbookId = countStmt.value(0).toInt() + 1;
+  }
 
   // Calculate the next available visit ID
   countStmt.exec("select max(visit_id) from logbook_visits");
@@ -83,6 +172,7 @@ void Logbook::read(QFile *file, const LogbookEntryFilter& filter, bool append)
   qDebug() << "Found" << numEntriesInDb << "entries in database";
 
   LogbookEntry e(&bs);
+  SummaryHash summaries[3];
 
   while(bs.tellg() < size)
   {
@@ -101,81 +191,77 @@ void Logbook::read(QFile *file, const LogbookEntryFilter& filter, bool append)
 
     if(type == types::RECORD_LOGBOOK_ENTRY)
     {
-      e.read(startpos, length, entryNumber);
-
-      qDebug().nospace() << "Read entry number " << entryNumber << " (" << e << ")";
-
       // Add only new entries in append mode
       if(!append || entryNumber >= numEntriesInDb)
       {
+        // Read only the fields needed for the filter before decoding the rest
+        e.readHeader(entryNumber);
         if(filter.canStore(e))
         {
-          // Sets optional fields already to null
-          e.fillEntryStatement(entryStmt);
+          e.readDetails(startpos, length);
+          qDebug().nospace() << "Read entry number " << entryNumber << " (" << e << ")";
 
-          entryStmt.bindValue(":logbook_id", logbookId);
-          entryStmt.bindValue(":simulator_id", sim);
+          e.fillEntryBatch(entryBatch);
+          entryBatch.bindValue(":logbook_id", logbookId);
 
-          // select and add airport information if airport table is available
+          QVariant distance(QVariant::Double);
+
+          // Add airport information if airport table is available
           if(hasAirports)
           {
-            double startLon = 0., startLat = 0., destLon = 0., destLat = 0.;
-            bool hasStartCoord = false, hasDestCoord = false;
-
-            airportStmt.bindValue(":icao", e.getAirportFrom());
-            airportStmt.exec();
-            if(airportStmt.next())
-            {
-              entryStmt.bindValue(":airport_from_name", airportStmt.value("name").toString());
-              entryStmt.bindValue(":airport_from_city", airportStmt.value("city").toString());
-              entryStmt.bindValue(":airport_from_state", airportStmt.value("state").toString());
-              entryStmt.bindValue(":airport_from_country", airportStmt.value("country").toString());
-
-              if(!airportStmt.isNull("latitude") && !airportStmt.isNull("longitude"))
-              {
-                startLon = airportStmt.value("longitude").toDouble();
-                startLat = airportStmt.value("latitude").toDouble();
-                hasStartCoord = true;
-              }
-            }
-
-            airportStmt.bindValue(":icao", e.getAirportTo());
-            airportStmt.exec();
-            if(airportStmt.next())
-            {
-              entryStmt.bindValue(":airport_to_name", airportStmt.value("name").toString());
-              entryStmt.bindValue(":airport_to_city", airportStmt.value("city").toString());
-              entryStmt.bindValue(":airport_to_state", airportStmt.value("state").toString());
-              entryStmt.bindValue(":airport_to_country", airportStmt.value("country").toString());
-
-              if(!airportStmt.isNull("latitude") && !airportStmt.isNull("longitude"))
-              {
-                destLon = airportStmt.value("longitude").toDouble();
-                destLat = airportStmt.value("latitude").toDouble();
-                hasDestCoord = true;
-              }
-            }
+            LogbookAirport from = airport(e.getAirportFrom()), to = airport(e.getAirportTo());
+            entryBatch.bindValue(":airport_from_name", from.name);
+            entryBatch.bindValue(":airport_from_city", from.city);
+            entryBatch.bindValue(":airport_from_state", from.state);
+            entryBatch.bindValue(":airport_from_country", from.country);
+            entryBatch.bindValue(":airport_to_name", to.name);
+            entryBatch.bindValue(":airport_to_city", to.city);
+            entryBatch.bindValue(":airport_to_state", to.state);
+            entryBatch.bindValue(":airport_to_country", to.country);
 
             // Store distance if there is a start and a destination airport
-            if(hasStartCoord && hasDestCoord)
-              entryStmt.bindValue(":distance", calcDist(startLon, startLat, destLon, destLat));
-            else
-              entryStmt.bindValue(":distance", QVariant(QVariant::Double));
+            if(from.hasCoords && to.hasCoords)
+              distance = calcDist(static_cast<float>(from.lonx), static_cast<float>(from.laty),
+                                  static_cast<float>(to.lonx), static_cast<float>(to.laty));
+            entryBatch.bindValue(":distance", distance);
+          }
+          else
+          {
+            for(const QString& col : {":airport_from_name", ":airport_from_city", ":airport_from_state",
+                                      ":airport_from_country", ":airport_to_name", ":airport_to_city",
+                                      ":airport_to_state", ":airport_to_country"})
+              entryBatch.bindValue(col, QVariant(QVariant::String));
+            entryBatch.bindValue(":distance", QVariant(QVariant::Double));
           }
-
-          entryStmt.exec();
 
           // Store all intermediate destinations in a separate table
           for(int i = 0; i < e.getNumVisits(); i++)
           {
-            e.fillVisitStatement(visitStmt, i);
-            visitStmt.bindValue(":visit_id", visitId);
-            visitStmt.bindValue(":logbook_id", logbookId);
-            visitStmt.bindValue(":simulator_id", sim);
-            visitStmt.exec();
+            e.fillVisitBatch(visitBatch, i);
+            visitBatch.bindValue(":visit_id", visitId);
+            visitBatch.bindValue(":logbook_id", logbookId);
+            visitBatch.addRow();
             visitId++;
           }
 
+          // Collect totals - a flight with same start and destination counts once for the airport
+          if(e.getAirportFrom() == e.getAirportTo())
+            addSummary(summaries, SUMMARY_AIRPORT, e.getAirportFrom(), QString(), e, distance, 1, 1);
+          else
+          {
+            addSummary(summaries, SUMMARY_AIRPORT, e.getAirportFrom(), QString(), e, distance, 1, 0);
+            addSummary(summaries, SUMMARY_AIRPORT, e.getAirportTo(), QString(), e, distance, 0, 1);
+          }
+          addSummary(summaries, SUMMARY_AIRCRAFT, e.getAircraftDescription(), e.getAircraftRegistration(), e,
+                     distance, 1, 1);
+          if(e.getDateTime().isValid())
+            addSummary(summaries, SUMMARY_MONTH, e.getDateTime().toString("yyyy-MM"), QString(), e, distance, 1, 1);
+
+          entryBatch.addRow();
+          if(entryBatch.size() == 0)
+            // Entries were written - add visits
+            visitBatch.exec();
+
           inserted++;
         } // if(filter.canStore
         else
@@ -185,6 +271,8 @@ void Logbook::read(QFile *file, const LogbookEntryFilter& filter, bool append)
         logbookId++;
       } // if(!append ...
 
+      // Skip rest of filtered or old entries without decoding
+      bs.seekg(startpos + length);
       entryNumber++;
     }
     else
@@ -194,11 +282,139 @@ void Logbook::read(QFile *file, const LogbookEntryFilter& filter, bool append)
     }
   } // while
 
+  entryBatch.exec();
+  visitBatch.exec();
+  for(SummaryType type : {SUMMARY_AIRPORT, SUMMARY_AIRCRAFT, SUMMARY_MONTH})
+    writeSummaries(type, summaries[type]);
+
   qDebug() << "Read" << entryNumber << "entries. Inserted" << inserted << "entries and fitered out"
            << filtered << "entries.";
 
   db->commit();
   numLoaded = inserted;
+  numEntries = entryNumber;
+  nextLogbookId = logbookId;
+  endOffset = bs.tellg();
+}
+
+void Logbook::writeSummaries(SummaryType type, const QHash<QString, LogbookSummary>& summaries)
+{
+  if(summaries.isEmpty())
+    return;
+
+  SqlScript(db).executeScript(Settings::getOverloadedPath(":/atools/resources/sql/lb/create_stats_schema.sql"));
+
+  SqlQuery updateStmt(db);
+  updateStmt.prepare("update logbook_statistics set num_flights = num_flights + :flights, "
+                     "num_departures = num_departures + :departures, num_arrivals = num_arrivals + :arrivals, "
+                     "total_time = total_time + :total, night_time = night_time + :night, "
+                     "instrument_time = instrument_time + :instrument, distance = distance + :distance "
+                     "where simulator_id = :sim and stats_type = :type and key = :key and sub_key = :subkey");
+
+  SqlQuery insertStmt(db);
+  insertStmt.prepare("insert into logbook_statistics (simulator_id, stats_type, key, sub_key, num_flights, "
+                     "num_departures, num_arrivals, total_time, night_time, instrument_time, distance) "
+                     "values(:sim, :type, :key, :subkey, :flights, :departures, :arrivals, "
+                     ":total, :night, :instrument, :distance)");
+
+  // Add to existing rows or insert new ones
+  for(const LogbookSummary& summary : summaries)
+  {
+    for(SqlQuery *stmt : {&updateStmt, &insertStmt})
+    {
+      stmt->bindValue(":sim", sim);
+      stmt->bindValue(":type", type);
+      stmt->bindValue(":key", summary.key);
+      stmt->bindValue(":subkey", summary.subKey);
+      stmt->bindValue(":flights", summary.numFlights);
+      stmt->bindValue(":departures", summary.numDepartures);
+      stmt->bindValue(":arrivals", summary.numArrivals);
+      stmt->bindValue(":total", summary.totalTime);
+      stmt->bindValue(":night", summary.nightTime);
+      stmt->bindValue(":instrument", summary.instrumentTime);
+      stmt->bindValue(":distance", summary.distance);
+      stmt->exec();
+
+      if(stmt == &updateStmt && updateStmt.numRowsAffected() > 0)
+        break;
+    }
+  }
+}
+
+QVector<LogbookSummary> Logbook::getSummaries(SummaryType type, const QString& keyPattern, int maxRows) const
+{
+  QVector<LogbookSummary> summaries;
+  if(!atools::sql::SqlUtil(db).hasTable("logbook_statistics"))
+    return summaries;
+
+  SqlQuery query(db);
+  query.prepare(QString("select key, sub_key, num_flights, num_departures, num_arrivals, total_time, night_time, "
+                        "instrument_time, distance from logbook_statistics "
+                        "where simulator_id = :sim and stats_type = :type %1 order by %2 limit %3").
+                arg(keyPattern.isEmpty() ? QString() : "and key like :pattern").
+                arg(type == SUMMARY_MONTH ? "key" : "num_flights desc, key").
+                arg(maxRows));
+  query.bindValue(":sim", sim);
+  query.bindValue(":type", type);
+  if(!keyPattern.isEmpty())
+    query.bindValue(":pattern", keyPattern);
+
+  query.exec();
+  while(query.next())
+  {
+    LogbookSummary summary;
+    summary.key = query.valueStr(0);
+    summary.subKey = query.valueStr(1);
+    summary.numFlights = query.valueInt(2);
+    summary.numDepartures = query.valueInt(3);
+    summary.numArrivals = query.valueInt(4);
+    summary.totalTime = query.valueDouble(5);
+    summary.nightTime = query.valueDouble(6);
+    summary.instrumentTime = query.valueDouble(7);
+    summary.distance = query.valueDouble(8);
+    summaries.append(summary);
+  }
+  return summaries;
+}
+
+LogbookSummary Logbook::getTotals(const QString& fromMonth, const QString& toMonth) const
+{
+  LogbookSummary totals;
+  if(!atools::sql::SqlUtil(db).hasTable("logbook_statistics"))
+    return totals;
+
+  // Month rows contain each flight with a valid date exactly once
+  SqlQuery query(db);
+  query.prepare(QString("select sum(num_flights), sum(total_time), sum(night_time), sum(instrument_time), "
+                        "sum(distance) from logbook_statistics where simulator_id = :sim and stats_type = :type%1%2").
+                arg(fromMonth.isEmpty() ? QString() : " and key >= :from").
+                arg(toMonth.isEmpty() ? QString() : " and key <= :to"));
+  query.bindValue(":sim", sim);
+  query.bindValue(":type", SUMMARY_MONTH);
+  if(!fromMonth.isEmpty())
+    query.bindValue(":from", fromMonth);
+  if(!toMonth.isEmpty())
+    query.bindValue(":to", toMonth);
+
+  query.exec();
+  if(query.next())
+  {
+    totals.numFlights = totals.numDepartures = totals.numArrivals = query.valueInt(0);
+    totals.totalTime = query.valueDouble(1);
+    totals.nightTime = query.valueDouble(2);
+    totals.instrumentTime = query.valueDouble(3);
+    totals.distance = query.valueDouble(4);
+  }
+  return totals;
+}
+
+void Logbook::clearSummaries(atools::sql::SqlDatabase *db, FsPaths::SimulatorType type)
+{
+  if(atools::sql::SqlUtil(db).hasTable("logbook_statistics"))
+  {
+    SqlQuery query(db);
+    query.exec("delete from logbook_statistics where simulator_id = " + QString::number(static_cast<int>(type)));
+  }
 }
 
 double Logbook::calcDist(float startLon, float startLat, float destLon, float destLat) const
@@ -20,7 +20,9 @@
 
 #include "fs/fspaths.h"
 
+#include <QHash>
 #include <QString>
+#include <QVector>
 
 class QFile;
 
@@ -36,6 +38,22 @@ namespace lb {
 class LogbookEntry;
 class LogbookEntryFilter;
 
+/* Type of precomputed totals in table logbook_statistics */
+enum SummaryType
+{
+  SUMMARY_AIRPORT = 0, /* Key is the airport ICAO */
+  SUMMARY_AIRCRAFT = 1, /* Key is the aircraft description and sub key the registration */
+  SUMMARY_MONTH = 2 /* Key is the start month as yyyy-MM in UTC. Entries with invalid dates are not counted. */
+};
+
+/* Totals for an airport, aircraft or month. Times are decimal hours and distance is nautical miles. */
+struct LogbookSummary
+{
+  QString key, subKey;
+  int numFlights = 0, numDepartures = 0, numArrivals = 0;
+  double totalTime = 0., nightTime = 0., instrumentTime = 0., distance = 0.;
+};
+
 /*
  * Reads a FSX logbook file and writes the entries into the given database.
  */
@@ -70,11 +88,55 @@ public:
     return numLoaded;
   }
 
+  /*
+   * Start reading at the byte offset of an entry instead of the file start. All entries from there are new.
+   * entryNumber and logbookId are the values for the entry at offset as returned by a previous read.
+   */
+  void setStartPosition(qint64 offset, int entryNumber, int logbookId);
+
+  /* Byte offset after the last complete entry of the last read */
+  qint64 getEndOffset() const
+  {
+    return endOffset;
+  }
+
+  /* Number of entries in the file including the ones before the start position */
+  int getNumEntries() const
+  {
+    return numEntries;
+  }
+
+  /*
+   * Precomputed totals for the simulator of this object read from table logbook_statistics.
+   * keyPattern is an SQL like pattern for the key. Ordered by number of flights descending or by month for
+   * SUMMARY_MONTH. Returns all rows if maxRows is -1.
+   */
+  QVector<atools::fs::lb::LogbookSummary> getSummaries(atools::fs::lb::SummaryType type,
+                                                       const QString& keyPattern = QString(), int maxRows = -1) const;
+
+  /* Totals of all flights in the month range yyyy-MM inclusive. Empty values do not limit the range. */
+  atools::fs::lb::LogbookSummary getTotals(const QString& fromMonth = QString(),
+                                           const QString& toMonth = QString()) const;
+
+  /* Remove totals of the simulator */
+  static void clearSummaries(atools::sql::SqlDatabase *db, atools::fs::FsPaths::SimulatorType type);
+
+  /* Id which will be used for the next entry */
+  int getNextLogbookId() const
+  {
+    return nextLogbookId;
+  }
+
 private:
+  /* Add totals to table logbook_statistics. Hash key is not used. */
+  void writeSummaries(atools::fs::lb::SummaryType type,
+                      const QHash<QString, atools::fs::lb::LogbookSummary>& summaries);
+
   /* calculate distance in nautical miles */
   double calcDist(float startLon, float startLat, float destLon, float destLat) const;
 
-  int numLoaded = 0;
+  int numLoaded = 0, numEntries = 0, nextLogbookId = 0, startEntryNumber = 0, startLogbookId = 0;
+  qint64 startOffset = 0, endOffset = 0;
   atools::sql::SqlDatabase *db;
   atools::fs::FsPaths::SimulatorType sim;
 };
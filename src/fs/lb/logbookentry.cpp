@@ -18,6 +18,7 @@
 #include "fs/lb/logbookentry.h"
 #include "io/binarystream.h"
 #include "sql/sqlutil.h"
+#include "sql/sqlbatch.h"
 
 #include <QDebug>
 #include <QString>
@@ -39,6 +40,12 @@ LogbookEntry::LogbookEntry(BinaryStream *bs)
 }
 
 void LogbookEntry::read(qint64 startpos, qint64 len, int entryNumber)
+{
+  readHeader(entryNumber);
+  readDetails(startpos, len);
+}
+
+void LogbookEntry::readHeader(int entryNumber)
 {
   reset();
 
@@ -78,7 +85,10 @@ void LogbookEntry::read(qint64 startpos, qint64 len, int entryNumber)
   totalTime = checkNull(stream->readFloat(), "total time", entryNumber);
   nightTime = stream->readFloat();
   instrumentTime = stream->readFloat();
+}
 
+void LogbookEntry::readDetails(qint64 startpos, qint64 len)
+{
   // Aircraft information
   aircraftType = static_cast<types::AircraftType>(stream->readUByte());
   flags = stream->readUShort();
@@ -201,6 +211,28 @@ void LogbookEntry::fillEntryStatement(SqlQuery& stmt)
     stmt.bindValue(":startdate", QVariant(0));
 }
 
+void LogbookEntry::fillEntryBatch(atools::sql::SqlBatch& batch) const
+{
+  batch.bindValue(":airport_from_icao", airportFrom);
+  batch.bindValue(":airport_to_icao", airportTo);
+  batch.bindValue(":description", description);
+  batch.bindValue(":total_time", totalTime);
+  batch.bindValue(":night_time", nightTime);
+  batch.bindValue(":instrument_time", instrumentTime);
+  batch.bindValue(":aircraft_reg", aircraftRegistration);
+  batch.bindValue(":aircraft_descr", aircraftDescription);
+  batch.bindValue(":aircraft_type", aircraftType);
+  batch.bindValue(":aircraft_flags", flags & types::AIRCRAFT_FLAG_MULTIMOTOR);
+  batch.bindValue(":visits", visitsToString());
+  batch.bindValue(":startdate", dateTime.isValid() ? QVariant(dateTime.toTime_t()) : QVariant(0));
+}
+
+void LogbookEntry::fillVisitBatch(atools::sql::SqlBatch& batch, int visitIndex) const
+{
+  batch.bindValue(":airport", airportVisits.at(visitIndex).getAirport());
+  batch.bindValue(":landings", airportVisits.at(visitIndex).getLandings());
+}
+
 SqlQuery LogbookEntry::prepareEntryStatement(SqlDatabase *db)
 {
   SqlQuery q(db);
@@ -29,6 +29,7 @@ namespace atools {
 namespace sql {
 class SqlDatabase;
 class SqlQuery;
+class SqlBatch;
 }
 namespace io {
 class BinaryStream;
@@ -55,6 +56,13 @@ public:
 
   void read(qint64 startpos, qint64 len, int entryNumber);
 
+  /* Read only date, airports and times which are needed for LogbookEntryFilter.
+   * Either call readDetails afterwards or skip the rest of the entry. */
+  void readHeader(int entryNumber);
+
+  /* Read aircraft information and subrecords after readHeader */
+  void readDetails(qint64 startpos, qint64 len);
+
   /* Prepare a query to insert rows into the logbook table */
   static atools::sql::SqlQuery prepareEntryStatement(atools::sql::SqlDatabase *db);
 
@@ -67,6 +75,13 @@ public:
   /* Fill the prepared statement with values */
   void fillVisitStatement(atools::sql::SqlQuery& stmt, int visitIndex);
 
+  /* Bind values for a row of the logbook table. Does not bind ids, distance and the airport
+   * name, city, state and country columns. */
+  void fillEntryBatch(atools::sql::SqlBatch& batch) const;
+
+  /* Bind airport and landings for a row of the logbook_visits table */
+  void fillVisitBatch(atools::sql::SqlBatch& batch, int visitIndex) const;
+
   int getNumVisits() const
   {
     return airportVisits.size();
@@ -139,6 +154,17 @@ private:
     return totalTime;
   }
 
+  /* Decimal hours */
+  float getNightTime() const
+  {
+    return nightTime;
+  }
+
+  float getInstrumentTime() const
+  {
+    return instrumentTime;
+  }
+
 private:
   /* Print the entry to a stream or qdebug */
   template<typename T>
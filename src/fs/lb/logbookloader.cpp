@@ -28,6 +28,8 @@
 #include <QDebug>
 #include <QFile>
 
+#include <algorithm>
+
 namespace atools {
 namespace fs {
 namespace lb {
@@ -37,6 +39,9 @@ using atools::sql::SqlScript;
 using atools::sql::SqlQuery;
 using atools::sql::SqlUtil;
 
+/* Number of bytes before the read offset used to detect a rewritten file */
+const static qint64 CHECKSUM_BYTES = 256;
+
 LogbookLoader::LogbookLoader(SqlDatabase *sqlDb)
   : db(sqlDb)
 {
@@ -52,7 +57,12 @@ void LogbookLoader::loadLogbook(const QString& filename, FsPaths::SimulatorType
 
     SqlScript script(db);
 
-    if(!append)
+    // Check if entries can be added to the last read state
+    qint64 offset = 0;
+    int entryCount = 0, nextLogbookId = 0;
+    loadedIncremental = incremental && readFileState(file, type, offset, entryCount, nextLogbookId);
+
+    if(!append && !loadedIncremental)
     {
       SqlUtil util(db);
       if(!(util.hasTable("logbook") && util.hasTable("logbook_visits")))
@@ -73,19 +83,29 @@ void LogbookLoader::loadLogbook(const QString& filename, FsPaths::SimulatorType
         deleteStmt.exec("delete from logbook where simulator_id = " +
                         QString::number(static_cast<int>(type)));
         qInfo() << "Deleted" << deleteStmt.numRowsAffected() << "of sim type" << type;
+
+        Logbook::clearSummaries(db, type);
       }
     }
 
     Logbook logbook(db, type);
-    logbook.read(&file, filter, append);
+    if(loadedIncremental)
+    {
+      qInfo() << "Loading logbook incrementally from offset" << offset << "entry" << entryCount;
+      logbook.setStartPosition(offset, entryCount, nextLogbookId);
+    }
+
+    logbook.read(&file, filter, append || loadedIncremental);
     numLoaded = logbook.getNumLoaded();
 
-    if(!append)
+    if(!append && !loadedIncremental)
     {
       db->commit();
       script.executeScript(Settings::getOverloadedPath(":/atools/resources/sql/lb/finish_schema.sql"));
     }
 
+    writeFileState(file, type, logbook);
+
     file.close();
     db->commit();
   }
@@ -102,10 +122,73 @@ void LogbookLoader::dropDatabase()
   using atools::settings::Settings;
 
   SqlScript script(db);
-  script.executeScript(Settings::getOverloadedPath(":/atools/resources/sql/drop_lb_schema.sql"));
+  script.executeScript(Settings::getOverloadedPath(":/atools/resources/sql/lb/drop_schema.sql"));
   db->commit();
 }
 
+bool LogbookLoader::readFileState(QFile& file, FsPaths::SimulatorType type, qint64& offset, int& entryCount,
+                                  int& nextLogbookId)
+{
+  SqlUtil util(db);
+  if(!util.hasTable("logbook") || !util.hasTable("logbook_visits") || !util.hasTable("logbook_file"))
+    return false;
+
+  SqlQuery query(db);
+  query.prepare("select file_size, file_offset, entry_count, next_logbook_id, checksum "
+                "from logbook_file where simulator_id = :sim");
+  query.bindValue(":sim", static_cast<int>(type));
+  query.exec();
+  if(!query.next())
+    return false;
+
+  offset = query.value("file_offset").toLongLong();
+  entryCount = query.valueInt("entry_count");
+  nextLogbookId = query.valueInt("next_logbook_id");
+  qint64 oldSize = query.value("file_size").toLongLong();
+  quint16 oldChecksum = static_cast<quint16>(query.valueInt("checksum"));
+  query.finish();
+
+  // File was truncated or rewritten by the simulator
+  if(offset <= 0 || file.size() < oldSize || file.size() < offset || checksum(file, offset) != oldChecksum)
+  {
+    qInfo() << "Logbook file" << file.fileName() << "changed. Doing full reload.";
+    return false;
+  }
+  return true;
+}
+
+void LogbookLoader::writeFileState(QFile& file, FsPaths::SimulatorType type, const Logbook& logbook)
+{
+  using atools::settings::Settings;
+
+  SqlScript script(db);
+  script.executeScript(Settings::getOverloadedPath(":/atools/resources/sql/lb/create_file_schema.sql"));
+
+  SqlQuery query(db);
+  query.prepare("insert or replace into logbook_file "
+                "(simulator_id, file_size, file_offset, entry_count, next_logbook_id, checksum) "
+                "values(:sim, :size, :offset, :count, :nextid, :checksum)");
+  query.bindValue(":sim", static_cast<int>(type));
+  query.bindValue(":size", file.size());
+  query.bindValue(":offset", logbook.getEndOffset());
+  query.bindValue(":count", logbook.getNumEntries());
+  query.bindValue(":nextid", logbook.getNextLogbookId());
+  query.bindValue(":checksum", checksum(file, logbook.getEndOffset()));
+  query.exec();
+}
+
+quint16 LogbookLoader::checksum(QFile& file, qint64 offset)
+{
+  qint64 pos = file.pos();
+  qint64 num = std::min(offset, CHECKSUM_BYTES);
+
+  file.seek(offset - num);
+  QByteArray bytes = file.read(num);
+  file.seek(pos);
+
+  return qChecksum(bytes.constData(), static_cast<uint>(bytes.size()));
+}
+
 } // namespace lb
 } // namespace fs
 } // namespace atools
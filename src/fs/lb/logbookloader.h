@@ -22,6 +22,8 @@
 
 #include <QString>
 
+class QFile;
+
 namespace atools {
 
 namespace sql {
@@ -32,6 +34,7 @@ namespace fs {
 namespace lb {
 
 class LogbookEntryFilter;
+class Logbook;
 
 /*
  * Reads the FSX Logbook.BIN file into a Sqlite database.
@@ -68,9 +71,35 @@ public:
   /* Drops all tables and views */
   void dropDatabase();
 
+  /*
+   * Remember the read position for each simulator and load only entries added since the last call of
+   * loadLogbook. Falls back to the mode given by append if the file was rewritten or read state is missing.
+   */
+  void setIncremental(bool value)
+  {
+    incremental = value;
+  }
+
+  /* true if the last loadLogbook call read only new entries */
+  bool wasIncremental() const
+  {
+    return loadedIncremental;
+  }
+
 private:
+  /* Read state from table logbook_file. Returns false if not found or the file does not match. */
+  bool readFileState(QFile& file, atools::fs::FsPaths::SimulatorType type, qint64& offset, int& entryCount,
+                     int& nextLogbookId);
+
+  /* Save read state after loading */
+  void writeFileState(QFile& file, atools::fs::FsPaths::SimulatorType type, const atools::fs::lb::Logbook& logbook);
+
+  /* Checksum of the bytes before offset. Keeps file position. */
+  static quint16 checksum(QFile& file, qint64 offset);
+
   atools::sql::SqlDatabase *db;
   int numLoaded = 0;
+  bool incremental = false, loadedIncremental = false;
 };
 
 } // namespace lb
@@ -18,28 +18,63 @@
 #include "fs/navdatabase.h"
 #include "sql/sqldatabase.h"
 #include "sql/sqlscript.h"
+#include "sql/sqlprofiler.h"
 #include "fs/db/datawriter.h"
 #include "fs/scenery/sceneryarea.h"
 #include "sql/sqlutil.h"
+#include "sql/sqlconnectionpool.h"
 #include "sql/sqltransaction.h"
 #include "fs/scenery/scenerycfg.h"
 #include "fs/scenery/addoncfg.h"
 #include "fs/db/airwayresolver.h"
 #include "fs/db/routeedgewriter.h"
+#include "fs/db/routegraphwriter.h"
 #include "fs/progresshandler.h"
 #include "fs/scenery/fileresolver.h"
+#include "fs/scenery/filemanifest.h"
 #include "fs/scenery/addonpackage.h"
 #include "fs/scenery/addoncomponent.h"
 #include "fs/xp/xpdatacompiler.h"
 #include "fs/dfd/dfdcompiler.h"
+#include "fs/db/compilecheckpoint.h"
 #include "fs/db/databasemeta.h"
+#include "fs/db/databasesnapshot.h"
+#include "fs/db/filestatechecker.h"
+#include "fs/db/navmemorystore.h"
+#include "fs/db/tablestatistics.h"
+#include "fs/db/rtreequery.h"
+#include "fs/db/textsearchquery.h"
+#include "fs/db/maptiles.h"
+#include "fs/db/boundarylod.h"
+#include "fs/db/proceduregeometry.h"
+#include "fs/db/hilbertorder.h"
+#include "geo/rect.h"
+#include "util/perfcounters.h"
+#include "util/stringpool.h"
+#include "util/taskscheduler.h"
+#include "util/tracerecorder.h"
 #include "atools.h"
 
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QElapsedTimer>
+#include <QFile>
 #include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSharedPointer>
 #include <QStandardPaths>
+#include <QThread>
+
+#include <algorithm>
+#include <cstdio>
+
+#if defined(Q_OS_WIN32)
+#include <windows.h>
+#endif
 
 namespace atools {
 namespace fs {
@@ -49,11 +84,68 @@ const int PROGRESS_NUM_STEPS = 23;
 const int PROGRESS_NUM_DB_REPORT_STEPS = 4;
 const int PROGRESS_NUM_RESOLVE_AIRWAY_STEPS = 1;
 const int PROGRESS_NUM_DEDUPLICATE_STEPS = 1;
+const int PROGRESS_NUM_SPATIAL_INDEX_STEPS = 1;
+const int PROGRESS_NUM_FULL_TEXT_SEARCH_STEPS = 1;
+const int PROGRESS_NUM_MAP_TILE_STEPS = 1;
+const int PROGRESS_NUM_BOUNDARY_LOD_STEPS = 1;
+const int PROGRESS_NUM_PROCEDURE_GEOMETRY_STEPS = 1;
+const int PROGRESS_NUM_HILBERT_ORDER_STEPS = 1;
 const int PROGRESS_NUM_ANALYZE_STEPS = 1;
 const int PROGRESS_NUM_VACCUM_STEPS = 1;
 const int PROGRESS_NUM_DROP_INDEX_STEPS = 2;
+const int PROGRESS_NUM_ROUTE_GRAPH_STEPS = 1;
+const int PROGRESS_NUM_IN_MEMORY_STEPS = 1;
+const int PROGRESS_NUM_COMPACT_EXPORT_STEPS = 1;
+const int PROGRESS_NUM_ROUTE_REGION_STEPS = 3;
 const int PROGRESS_DFD_EXTRA_STEPS = 13;
 
+/* Number of running compilations sharing StringPool::compileInstance() */
+static QAtomicInt activeCompilations;
+
+/* Drop the compiler string pool after the last compilation. Interned strings stay valid where still used. */
+static void releaseCompilePool()
+{
+  if(!activeCompilations.deref())
+    atools::util::StringPool::compileInstance().clear();
+}
+
+/* Fast but unsafe settings for compilation. Journal is kept in memory to allow rollback on abort.
+ * Page size is only effective for new and empty database files. */
+static const QStringList BULK_LOAD_PRAGMAS(
+{
+  "PRAGMA page_size=4096",
+  "PRAGMA journal_mode=MEMORY",
+  "PRAGMA synchronous=OFF",
+  "PRAGMA locking_mode=EXCLUSIVE",
+  "PRAGMA cache_size=-262144",
+  "PRAGMA temp_store=MEMORY",
+  "PRAGMA mmap_size=268435456"
+});
+
+/* Connection name for in-memory compilation */
+static const QLatin1String IN_MEMORY_CONNECTION_NAME("atools_navdatabase_in_memory");
+
+/* Estimated database size in MB for in-memory compilation if no previous database file exists */
+static const qint64 IN_MEMORY_ESTIMATE_XPLANE_MB = 1500;
+static const qint64 IN_MEMORY_ESTIMATE_MB = 800;
+
+/* Compilation needs more memory than the final file size for temporary tables and indexes */
+static const double IN_MEMORY_ESTIMATE_FACTOR = 1.5;
+
+/* SQLite cache size in kB if memory soft limit is exceeded */
+static const int MEMORY_LIMIT_CACHE_SIZE_KB = 16384;
+
+/* Settings changed by the bulk load profile. The values active before compilation are restored afterwards and
+ * these safe values are used only if a value cannot be read. Memory mapping is kept for faster reading. */
+static const QStringList SAFE_PRAGMAS(
+{
+  "PRAGMA journal_mode=DELETE",
+  "PRAGMA synchronous=FULL",
+  "PRAGMA locking_mode=NORMAL",
+  "PRAGMA cache_size=-2000",
+  "PRAGMA temp_store=DEFAULT"
+});
+
 using atools::sql::SqlDatabase;
 using atools::sql::SqlScript;
 using atools::sql::SqlQuery;
@@ -66,6 +158,39 @@ using atools::fs::scenery::SceneryArea;
 using atools::fs::scenery::AddOnComponent;
 using atools::fs::scenery::AddOnPackage;
 
+/* Result of probing and reading one add-on.xml file */
+struct AddOnPackageResult
+{
+  bool exists = false;
+  QSharedPointer<AddOnPackage> package;
+
+  /* Exception message if reading failed */
+  QString error;
+};
+
+/* Checks if an add-on.xml file exists and reads it using the package cache */
+static void readAddOnPackage(const QString& file, AddOnPackageResult *result)
+{
+  QFileInfo fileinfo(file);
+  result->exists = fileinfo.exists() && fileinfo.isFile();
+
+  if(result->exists)
+  {
+    try
+    {
+      result->package.reset(new AddOnPackage(file, true /* useCache */));
+    }
+    catch(std::exception& e)
+    {
+      result->error = e.what();
+    }
+    catch(...)
+    {
+      result->error = "Unknown exception reading " + file;
+    }
+  }
+}
+
 NavDatabase::NavDatabase(const NavDatabaseOptions *readerOptions, sql::SqlDatabase *sqlDb,
                          NavDatabaseErrors *databaseErrors, const QString& revision)
   : db(sqlDb), errors(databaseErrors), options(readerOptions), gitRevision(revision)
@@ -75,10 +200,432 @@ NavDatabase::NavDatabase(const NavDatabaseOptions *readerOptions, sql::SqlDataba
 
 void NavDatabase::create(const QString& codec)
 {
-  createInternal(codec);
+  activeCompilations.ref();
+
+  // Settings are restored on the file database at the end
+  if(options->isBulkLoad())
+    previousPragmas = currentPragmas(SAFE_PRAGMAS);
+
+  // Compile into a temporary in-memory database which is written to the file at the end
+  SqlDatabase memoryDb;
+  QString memoryConnectionName;
+  if(isCompileInMemory())
+  {
+    // Several databases might be compiled at the same time
+    static QAtomicInt connectionId;
+    memoryConnectionName = QString("%1_%2").arg(IN_MEMORY_CONNECTION_NAME).arg(connectionId.fetchAndAddRelaxed(1));
+    memoryDb = SqlDatabase::addDatabase("QSQLITE", memoryConnectionName);
+    memoryDb.setDatabaseName(":memory:");
+    memoryDb.setAutocommit(db->isAutocommit());
+    memoryDb.setAutomaticTransactions(db->isAutomaticTransactions());
+    memoryDb.open();
+    fileDb = db;
+    db = &memoryDb;
+  }
+
+  // Switch back to the file database if not already done by writeInMemoryDatabase()
+  auto closeMemoryDb = [this, &memoryDb, &memoryConnectionName]() -> void
+  {
+    if(fileDb != nullptr)
+    {
+      db = fileDb;
+      fileDb = nullptr;
+    }
+
+    if(memoryDb.isValid())
+    {
+      if(memoryDb.isOpen())
+        memoryDb.close();
+      memoryDb = SqlDatabase();
+      SqlDatabase::removeDatabase(memoryConnectionName);
+    }
+  };
+
+  if(options->isBulkLoad())
+    applyPragmas(BULK_LOAD_PRAGMAS, "Bulk load");
+
+  bool trace = !options->getTraceFile().isEmpty();
+  if(trace)
+  {
+    atools::util::TraceRecorder::clear();
+    atools::util::TraceRecorder::setEnabled(true);
+  }
+
+  // Single pool of threads for all parallel steps of the compilation if no shared one is set
+  QScopedPointer<atools::util::TaskScheduler> scheduler;
+  if(sharedScheduler != nullptr)
+    taskScheduler = sharedScheduler;
+  else
+  {
+    scheduler.reset(new atools::util::TaskScheduler(options->getNumThreads()));
+    taskScheduler = scheduler.data();
+  }
+
+  try
+  {
+    createInternal(codec);
+    if(aborted)
+      // Remove all (partial) changes
+      db->rollback();
+  }
+  catch(...)
+  {
+    // Cancel check refers to the progress handler of createInternal()
+    if(!scheduler.isNull())
+      scheduler->setCancelCheck(nullptr);
+    taskScheduler = nullptr;
+    delete checkpoint;
+    checkpoint = nullptr;
+    closeMemoryDb();
+    if(options->isBulkLoad())
+      restorePreviousPragmas();
+    if(trace)
+      writeTrace();
+    releaseCompilePool();
+    throw;
+  }
+
+  if(!scheduler.isNull())
+    scheduler->setCancelCheck(nullptr);
+  taskScheduler = nullptr;
+  delete checkpoint;
+  checkpoint = nullptr;
+  closeMemoryDb();
+
+  if(options->isBulkLoad())
+    applyPragmas(previousPragmas, "Restore");
+
+  if(trace)
+    writeTrace();
+
+  releaseCompilePool();
+
+  // Refresh read side copy of the new data
+  if(memoryStore != nullptr && !aborted && (!unchanged || !memoryStore->isLoaded()))
+    memoryStore->load(db);
+
+  // Write startup snapshot last since it is bound to size and modification time of the database file
+  if(!aborted)
+    atools::fs::db::DatabaseSnapshot::writeSnapshot(*db);
+}
+
+void NavDatabase::writeTrace()
+{
+  atools::util::TraceRecorder::setEnabled(false);
+  atools::util::TraceRecorder::writeJson(options->getTraceFile());
+  atools::util::TraceRecorder::clear();
+}
+
+void NavDatabase::applyPragmas(const QStringList& pragmas, const QString& profile)
+{
+  for(const QString& pragma : pragmas)
+  {
+    QElapsedTimer timer;
+    timer.start();
+
+    if(db->isAutocommit())
+      db->exec(pragma);
+    else
+      // Rolls back and opens a new transaction since journal mode cannot be changed inside a transaction
+      db->executePragmas({pragma});
+
+    qInfo() << profile << "profile:" << pragma << "took" << timer.elapsed() << "ms";
+  }
+}
+
+bool NavDatabase::isCompileInMemory() const
+{
+  int limitMb = options->getCompileInMemoryLimitMb();
+  if(limitMb <= 0)
+    return false;
+
+  QString filename = db->databaseName();
+  if(filename.isEmpty() || filename == ":memory:")
+    return false;
+
+  if(options->isIncremental())
+  {
+    // Previous file states are needed from the database file
+    qInfo() << "In-memory compilation not used in incremental mode";
+    return false;
+  }
+
+  // Use size of the previous database file if available
+  QFileInfo fileinfo(filename);
+  qint64 sizeMb = fileinfo.exists() ? fileinfo.size() / (1024 * 1024) : 0;
+  if(sizeMb < 1)
+    sizeMb = options->getSimulatorType() == atools::fs::FsPaths::XPLANE11 ?
+             IN_MEMORY_ESTIMATE_XPLANE_MB : IN_MEMORY_ESTIMATE_MB;
+
+  qint64 estimatedMb = static_cast<qint64>(sizeMb * IN_MEMORY_ESTIMATE_FACTOR);
+  if(estimatedMb > limitMb)
+  {
+    qInfo() << "In-memory compilation: estimated size" << estimatedMb << "MB exceeds limit" << limitMb
+            << "MB. Compiling on disk.";
+    return false;
+  }
+
+  qInfo() << "In-memory compilation: estimated size" << estimatedMb << "MB, limit" << limitMb << "MB";
+  return true;
+}
+
+void NavDatabase::writeInMemoryDatabase()
+{
+  QString filename = fileDb->databaseName();
+  QString tempFilename = filename + ".inmemory";
+
+  QElapsedTimer timer;
+  timer.start();
+
+  // Sequential write of all pages into a new file
+  QFile::remove(tempFilename);
+  db->commit();
+  db->vacuumInto(tempFilename);
+  qint64 copyMs = timer.elapsed();
+
+  replaceDatabaseFile(fileDb, tempFilename);
+
+  db = fileDb;
+  fileDb = nullptr;
+
+  qInfo() << "In-memory compilation: wrote" << QFileInfo(filename).size() / (1024 * 1024) << "MB to"
+          << filename << "in" << copyMs << "ms, total" << timer.elapsed() << "ms";
+}
+
+void NavDatabase::replaceDatabaseFile(atools::sql::SqlDatabase *database, const QString& newFilename)
+{
+  QString filename = database->databaseName();
+
+  // Needs a closed connection
+  database->close();
+
+  // Replace in one step - readers see either the old or the new file
+#if defined(Q_OS_WIN32)
+  bool renamed = MoveFileExW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(newFilename).utf16()),
+                             reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(filename).utf16()),
+                             MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+  bool renamed = std::rename(QFile::encodeName(newFilename).constData(), QFile::encodeName(filename).constData()) == 0;
+#endif
+
+  // Journals of the old file would be applied to the new one
+  if(renamed)
+  {
+    for(const QString& suffix : {QString("-journal"), QString("-wal"), QString("-shm")})
+      QFile::remove(filename + suffix);
+  }
+
+  database->open();
+
+  if(!renamed)
+    throw Exception(tr("Cannot rename \"%1\" to \"%2\".").arg(newFilename).arg(filename));
+}
+
+void NavDatabase::writeCompactDatabase()
+{
+  QString filename = db->databaseName();
+  QString compactFilename = filename + ".compact";
+
+  QElapsedTimer timer;
+  timer.start();
+
+  QFile::remove(compactFilename);
+  db->commit();
+
+  // Collect schema in order of creation ============================
+  QStringList tables, virtualTables, tableSql, otherSql;
+  SqlQuery schemaQuery("select type, name, sql from sqlite_master "
+                       "where sql is not null and name not like 'sqlite_%' order by rowid", db);
+  schemaQuery.exec();
+  while(schemaQuery.next())
+  {
+    QString sql = schemaQuery.valueStr("sql");
+    if(schemaQuery.valueStr("type") == "table")
+    {
+      tables.append(schemaQuery.valueStr("name"));
+      tableSql.append(sql);
+      if(sql.startsWith("CREATE VIRTUAL TABLE", Qt::CaseInsensitive))
+        virtualTables.append(schemaQuery.valueStr("name"));
+    }
+    else
+      otherSql.append(sql);
+  }
+  schemaQuery.finish();
+
+  // Shadow tables of R-tree and FTS5 are created and filled by their virtual tables
+  static const QStringList SHADOW_SUFFIXES({"_node", "_rowid", "_parent", "_data", "_idx", "_content", "_docsize",
+                                            "_config"});
+  for(int i = tables.size() - 1; i >= 0; i--)
+  {
+    bool shadow = false;
+    for(const QString& virtualTable : virtualTables)
+    {
+      for(const QString& suffix : SHADOW_SUFFIXES)
+        shadow |= tables.at(i) == virtualTable + suffix;
+    }
+
+    if(shadow)
+    {
+      tables.removeAt(i);
+      tableSql.removeAt(i);
+    }
+  }
+
+  int pageSize = 4096;
+  SqlQuery pageQuery("PRAGMA page_size", db);
+  pageQuery.exec();
+  if(pageQuery.next())
+    pageSize = pageQuery.valueInt(0);
+  pageQuery.finish();
+
+  // Create tables in the new file ============================
+  static QAtomicInt connectionId;
+  QString connectionName = QString("atools_navdatabase_compact_%1").arg(connectionId.fetchAndAddRelaxed(1));
+  {
+    SqlDatabase compactDb = SqlDatabase::addDatabase("QSQLITE", connectionName);
+    compactDb.setDatabaseName(compactFilename);
+    compactDb.setAutomaticTransactions(false);
+    compactDb.open({"PRAGMA page_size=" + QString::number(pageSize), "PRAGMA journal_mode=OFF"});
+    for(const QString& sql : tableSql)
+      compactDb.exec(sql);
+    compactDb.close();
+  }
+  SqlDatabase::removeDatabase(connectionName);
+
+  // Copy all rows in primary key order through the attached file ============================
+  db->attachDatabase(compactFilename, "compact");
+  db->executePragmas({"PRAGMA compact.journal_mode=OFF", "PRAGMA compact.synchronous=OFF"});
+  for(const QString& table : tables)
+  {
+    QStringList columns;
+    SqlQuery columnQuery("PRAGMA main.table_info(\"" + table + "\")", db);
+    columnQuery.exec();
+    while(columnQuery.next())
+      columns.append("\"" + columnQuery.valueStr("name") + "\"");
+    columnQuery.finish();
+
+    // Keep rowids of FTS tables which are not part of the columns
+    if(virtualTables.contains(table) && !columns.isEmpty() &&
+       tableSql.at(tables.indexOf(table)).contains("fts", Qt::CaseInsensitive))
+      columns.prepend("rowid");
+
+    QString columnList = columns.join(", ");
+    db->exec("insert into compact.\"" + table + "\" (" + columnList + ") select " + columnList +
+             " from main.\"" + table + "\" order by rowid");
+  }
+  db->commit();
+  db->detachDatabase("compact");
+  qint64 copyMs = timer.elapsed();
+
+  // Create indexes, views and triggers after the data ============================
+  {
+    SqlDatabase compactDb = SqlDatabase::addDatabase("QSQLITE", connectionName);
+    compactDb.setDatabaseName(compactFilename);
+    compactDb.setAutomaticTransactions(false);
+    compactDb.open({"PRAGMA journal_mode=OFF", "PRAGMA synchronous=OFF", "PRAGMA cache_size=-262144",
+                    "PRAGMA temp_store=MEMORY"});
+
+    for(const QString& sql : otherSql)
+      compactDb.exec(sql);
+
+    // Merge the b-trees of the freshly filled FTS tables
+    for(const QString& table : virtualTables)
+    {
+      if(tableSql.at(tables.indexOf(table)).contains("fts", Qt::CaseInsensitive))
+        compactDb.exec("insert into \"" + table + "\" (\"" + table + "\") values ('optimize')");
+    }
+
+    if(options->isAnalyzeDatabase())
+      compactDb.analyze();
+
+    compactDb.exec("PRAGMA journal_mode=DELETE");
+    compactDb.close();
+  }
+  SqlDatabase::removeDatabase(connectionName);
+
+  qint64 oldSize = QFileInfo(filename).size();
+  replaceDatabaseFile(db, compactFilename);
+
+  qInfo() << "Compact export: size" << oldSize / (1024 * 1024) << "MB to" << QFileInfo(filename).size() / (1024 * 1024)
+          << "MB. Copy took" << copyMs << "ms, total" << timer.elapsed() << "ms";
+}
+
+QStringList NavDatabase::currentPragmas(const QStringList& defaultPragmas) const
+{
+  QStringList pragmas;
+  for(const QString& pragma : defaultPragmas)
+  {
+    // Get name from "PRAGMA name=value"
+    QString name = pragma.section('=', 0, 0).section(' ', 1).trimmed();
+
+    SqlQuery query(db);
+    query.exec("PRAGMA " + name);
+    if(query.next() && !query.value(0).toString().isEmpty())
+      pragmas.append(QString("PRAGMA %1=%2").arg(name).arg(query.value(0).toString()));
+    else
+      pragmas.append(pragma);
+  }
+  return pragmas;
+}
+
+void NavDatabase::restorePreviousPragmas()
+{
+  try
+  {
+    applyPragmas(previousPragmas, "Restore");
+  }
+  catch(atools::Exception& e)
+  {
+    // Do not hide the original exception
+    qWarning() << "Restoring safe database settings failed" << e.what();
+  }
+}
+
+bool NavDatabase::updateRouteTables(const atools::geo::Rect& region)
+{
+  ProgressHandler progress(options);
+  progress.setTotal(PROGRESS_NUM_ROUTE_REGION_STEPS);
+  aborted = false;
+
+  // Temporary table used by the update script - split to allow simple between queries
+  SqlQuery query(db);
+  query.exec("drop table if exists temp.route_region");
+  query.exec("create temporary table route_region "
+             "(left_lonx double, top_laty double, right_lonx double, bottom_laty double)");
+  query.prepare("insert into route_region (left_lonx, top_laty, right_lonx, bottom_laty) values(?, ?, ?, ?)");
+  for(const atools::geo::Rect& rect : region.splitAtAntiMeridian())
+  {
+    query.bindValue(0, rect.getWest());
+    query.bindValue(1, rect.getNorth());
+    query.bindValue(2, rect.getEast());
+    query.bindValue(3, rect.getSouth());
+    query.exec();
+  }
+
+  if(!runScript(&progress, "fs/db/update_route_region.sql", tr("Updating routing tables")) &&
+     options->isCreateRouteTables())
+  {
+    if(!(aborted = progress.reportOther(tr("Updating route edges for VOR and NDB"))))
+    {
+      atools::fs::db::RouteEdgeWriter edgeWriter(db, progress, 1);
+      edgeWriter.setNumThreads(options->isReadParallel() ? options->getNumThreads() : 1);
+      edgeWriter.setRegion(region);
+      progress.startStage(tr("Updating route edges for VOR and NDB"));
+      aborted = edgeWriter.run();
+      progress.finishStage();
+    }
+  }
+
+  query.exec("drop table if exists temp.route_region");
+
   if(aborted)
-    // Remove all (partial) changes
     db->rollback();
+  else
+  {
+    db->commit();
+    progress.reportFinish();
+  }
+  return aborted;
 }
 
 void NavDatabase::createSchema()
@@ -159,7 +706,9 @@ bool NavDatabase::isSceneryConfigValid(const QString& filename, const QString& c
         try
         {
           // Read the scenery file and check if it has at least one scenery area
+          // Keep the parse result for the compilation in readSceneryConfig()
           SceneryCfg cfg(codec);
+          cfg.setUseCache(true);
           cfg.read(filename);
 
           return !cfg.getAreas().isEmpty();
@@ -228,8 +777,16 @@ bool NavDatabase::isBasePathValid(const QString& filepath, QString& error, atool
 
 void NavDatabase::createInternal(const QString& sceneryConfigCodec)
 {
+  ATOOLS_TRACE_SPAN("NavDatabase::createInternal", "compile");
+
   int numProgressReports = 0, numSceneryAreas = 0, xplaneExtraSteps = 0;
+
   SceneryCfg cfg(sceneryConfigCodec);
+  atools::fs::scenery::FileManifest manifest(*options);
+  unchanged = false;
+
+  // Read each directory only once when resolving X-Plane paths case insensitive
+  atools::PathNoCaseCache pathCache;
 
   QElapsedTimer timer;
   timer.start();
@@ -268,7 +825,8 @@ void NavDatabase::createInternal(const QString& sceneryConfigCodec)
     readSceneryConfig(cfg);
 
     // Count the files for exact progress reporting
-    countFiles(cfg, &numProgressReports, &numSceneryAreas);
+    // Files are enumerated only once here and the manifest is used later for loading
+    countFiles(cfg, manifest, &numProgressReports, &numSceneryAreas);
     total = numProgressReports + numSceneryAreas + PROGRESS_NUM_STEPS;
     routePartFraction = 4;
   }
@@ -282,15 +840,46 @@ void NavDatabase::createInternal(const QString& sceneryConfigCodec)
   if(options->isDeduplicate())
     total += PROGRESS_NUM_DEDUPLICATE_STEPS;
 
-  if(options->isAnalyzeDatabase())
-    total += PROGRESS_NUM_ANALYZE_STEPS;
+  if(options->isSpatialIndex())
+    total += PROGRESS_NUM_SPATIAL_INDEX_STEPS;
+
+  if(options->isFullTextSearch())
+    total += PROGRESS_NUM_FULL_TEXT_SEARCH_STEPS;
+
+  if(options->getMapTileMaxZoom() >= 0)
+    total += PROGRESS_NUM_MAP_TILE_STEPS;
+
+  if(options->isBoundaryLevelOfDetail())
+    total += PROGRESS_NUM_BOUNDARY_LOD_STEPS;
+
+  if(options->isProcedureLegGeometry())
+    total += PROGRESS_NUM_PROCEDURE_GEOMETRY_STEPS;
+
+  if(options->isHilbertOrder())
+    total += PROGRESS_NUM_HILBERT_ORDER_STEPS;
 
-  if(options->isVacuumDatabase())
-    total += PROGRESS_NUM_VACCUM_STEPS;
+  // In-memory compilation writes a compact file already
+  bool compactExport = options->isCompactExport() && fileDb == nullptr;
+  if(compactExport)
+    total += PROGRESS_NUM_COMPACT_EXPORT_STEPS;
+  else
+  {
+    if(options->isAnalyzeDatabase())
+      total += PROGRESS_NUM_ANALYZE_STEPS;
+
+    if(options->isVacuumDatabase())
+      total += PROGRESS_NUM_VACCUM_STEPS;
+  }
 
   if(options->isDropIndexes())
     total += PROGRESS_NUM_DROP_INDEX_STEPS;
 
+  if(!options->getRouteGraphFile().isEmpty())
+    total += PROGRESS_NUM_ROUTE_GRAPH_STEPS;
+
+  if(fileDb != nullptr)
+    total += PROGRESS_NUM_IN_MEMORY_STEPS;
+
   // Assume this one takes a quarter of the total number of steps
   int numRouteSteps = total / routePartFraction;
   if(options->isCreateRouteTables())
@@ -299,10 +888,121 @@ void NavDatabase::createInternal(const QString& sceneryConfigCodec)
   ProgressHandler progress(options);
   progress.setTotal(total);
 
-  createSchemaInternal(&progress);
+  // Skip pending tasks once the user aborts - shared schedulers run tasks of other compilations too
+  if(sharedScheduler == nullptr)
+    taskScheduler->setCancelCheck([&progress]() -> bool {
+      return progress.isAborted();
+    });
+
+  bool cacheReduced = false;
+  if(options->getMemorySoftLimitMb() > 0)
+  {
+    progress.setMemorySoftLimit(options->getMemorySoftLimitMb() * 1024LL, [this, &cacheReduced](qint64)
+    {
+      // Write pending changes to release dirty pages and reduce the page cache once
+      db->commit();
+      if(!cacheReduced)
+      {
+        db->exec("PRAGMA cache_size=-" + QString::number(MEMORY_LIMIT_CACHE_SIZE_KB));
+        cacheReduced = true;
+      }
+      db->exec("PRAGMA shrink_memory");
+    });
+  }
+
+  // Collect state of all scenery files for the next incremental compilation =====================
+  // Also needed to check for changed files when resuming
+  QScopedPointer<atools::fs::db::FileStateChecker> fileStates;
+  if(sim != atools::fs::FsPaths::NAVIGRAPH && (options->isIncremental() || options->isResume()))
+  {
+    fileStates.reset(new atools::fs::db::FileStateChecker(db, options->isIncrementalHash()));
+    fileStates->addOptions(incrementalOptionsHash());
+
+    if(sim == atools::fs::FsPaths::XPLANE11)
+      // All dat, CIFP and airspace files and the custom scenery packs
+      fileStates->addCurrent(atools::fs::xp::XpDataCompiler::findAllFiles(*options));
+    else
+    {
+      // Scenery.cfg defines layer order which affects the result as well
+      fileStates->addCurrent(options->getSceneryFile());
+      fileStates->addCurrent(manifest.getAllFilepaths(true /* includeDuplicates */));
+    }
+
+    if(options->isIncremental())
+    {
+      // Previous state has to be loaded before dropping the schema
+      if(atools::fs::db::DatabaseMeta(db).isDatabaseCompatible() && fileStates->loadPrevious())
+      {
+        if(fileStates->isUnchanged())
+        {
+          // Nothing to do - leave the database as it is
+          qInfo() << "Incremental mode: no changes found. Database is left unchanged.";
+          unchanged = true;
+          progress.reportFinish();
+          return;
+        }
+
+        // Deduplication, airway resolution and route and search tables are built across all files. Reload all.
+        QStringList changed = fileStates->getChangedFiles();
+        qInfo() << "Incremental mode:" << changed.size() << "files changed. Doing full reload.";
+        if(options->isVerbose())
+          qInfo() << changed;
+      }
+      else
+        qInfo() << "Incremental mode: no compatible previous compilation found. Doing full reload.";
+    }
+  }
+
+  // Record completed steps to allow resuming an aborted compilation ===================================
+  // Not for in-memory compilation which is lost on abort
+  if(fileDb == nullptr)
+  {
+    checkpoint = new atools::fs::db::CompileCheckpoint(db, checkpointOptionsHash());
+
+    if(options->isResume())
+    {
+      if(options->isDeduplicateOnWrite() && sim != atools::fs::FsPaths::XPLANE11 &&
+         sim != atools::fs::FsPaths::NAVIGRAPH)
+        // Index of written navaids is kept only in memory
+        qInfo() << "Resume: not possible with deduplicate on write. Doing full reload.";
+      else if(options->isAutocommit())
+        // Updates and deletes of a partially written step cannot be rolled back
+        qInfo() << "Resume: not possible with autocommit. Doing full reload.";
+      else if(!checkpoint->load())
+        qInfo() << "Resume: no usable checkpoint found. Doing full reload.";
+      else if(!fileStates.isNull() && !(fileStates->loadPrevious() && fileStates->isUnchanged()))
+      {
+        qInfo() << "Resume: scenery files changed since the checkpoint. Doing full reload.";
+        delete checkpoint;
+        checkpoint = new atools::fs::db::CompileCheckpoint(db, checkpointOptionsHash());
+      }
+    }
+  }
+
+  // Let SQLite use helper threads for sorting when creating indexes and running the post processing scripts.
+  // Writes are serialized by SQLite even in WAL mode which does not allow to run scripts in parallel.
+  if(options->isReadParallel())
+    db->exec("pragma threads = " + QString::number(options->getNumThreads()));
+
+  progress.startStage(tr("Creating schema"));
+  if(isStepDone("Schema"))
+    // Remove partially written data of the aborted step
+    checkpoint->restore();
+  else
+  {
+    createSchemaInternal(&progress);
+
+    // Scenery files are compared when resuming
+    if(!fileStates.isNull() && checkpoint != nullptr)
+      fileStates->writeCurrent();
+    finishStep();
+  }
+  progress.finishStage(0);
   if(aborted)
     return;
 
+  bool resumed = checkpoint != nullptr && checkpoint->isResumed();
+
   // -----------------------------------------------------------------------
   // Create empty data writer pointers which will read all files and fill the database
   // Pointers will be initialized on demand/compilation type
@@ -323,7 +1023,11 @@ void NavDatabase::createInternal(const QString& sceneryConfigCodec)
 
     // Load Navigraph from source database ======================================================
     dfdCompiler.reset(new atools::fs::ng::DfdCompiler(*db, *options, &progress, errors));
+    if(resumed)
+      dfdCompiler->initFromDatabase();
+    progress.startStage(tr("Loading Navigraph"));
     loadDfd(&progress, dfdCompiler.data(), area);
+    progress.finishStage();
     dfdCompiler->close();
   }
   else if(sim == atools::fs::FsPaths::XPLANE11)
@@ -337,14 +1041,27 @@ void NavDatabase::createInternal(const QString& sceneryConfigCodec)
 
     // Load X-Plane scenery database ======================================================
     xpDataCompiler.reset(new atools::fs::xp::XpDataCompiler(*db, *options, &progress, errors));
+    if(resumed)
+      xpDataCompiler->initFromDatabase(checkpoint->getAiracCycle());
+    progress.startStage(tr("Loading X-Plane"));
     loadXplane(&progress, xpDataCompiler.data(), area);
+    progress.finishStage();
     xpDataCompiler->close();
   }
   else
   {
     // Load FSX / P3D scenery database ======================================================
     fsDataWriter.reset(new atools::fs::db::DataWriter(*db, *options, &progress));
-    loadFsxP3d(&progress, fsDataWriter.data(), cfg);
+    fsDataWriter->setFileManifest(&manifest);
+
+    // Area rows and deletes are committed with the checkpoint in finishStep()
+    fsDataWriter->setCommitAreas(checkpoint == nullptr);
+    if(resumed)
+      fsDataWriter->initIdsFromDatabase();
+    // Scripts run in loadFsxP3d are sub-stages
+    progress.startStage(tr("Loading scenery"));
+    loadFsxP3d(&progress, fsDataWriter.data(), cfg, manifest);
+    progress.finishStage();
     fsDataWriter->close();
   }
 
@@ -361,17 +1078,26 @@ void NavDatabase::createInternal(const QString& sceneryConfigCodec)
     if((aborted = progress.reportOther(tr("Creating airways"))))
       return;
 
-    // Read airway_point table, connect all waypoints and write the ordered result into the airway table
-    atools::fs::db::AirwayResolver resolver(db, progress);
+    if(!isStepDone("Airways"))
+    {
+      // Read airway_point table, connect all waypoints and write the ordered result into the airway table
+      atools::fs::db::AirwayResolver resolver(db, progress);
 
-    if(sim != atools::fs::FsPaths::NAVIGRAPH && sim != atools::fs::FsPaths::XPLANE11)
-      // Drop large segments only for FSX/P3D - default is 1000 nm
-      resolver.setMaxAirwaySegmentLength(20000);
+      if(sim != atools::fs::FsPaths::NAVIGRAPH && sim != atools::fs::FsPaths::XPLANE11)
+        // Drop large segments only for FSX/P3D - default is 1000 nm
+        resolver.setMaxAirwaySegmentLength(20000);
 
-    resolver.assignWaypointIds();
+      resolver.setNumThreads(options->isReadParallel() ? options->getNumThreads() : 1);
 
-    if((aborted = resolver.run()))
-      return;
+      progress.startStage(tr("Creating airways"));
+      resolver.assignWaypointIds();
+
+      aborted = resolver.run();
+      progress.finishStage();
+      if(aborted)
+        return;
+      finishStep();
+    }
   }
 
   if(sim != atools::fs::FsPaths::XPLANE11 && sim != atools::fs::FsPaths::NAVIGRAPH)
@@ -381,6 +1107,19 @@ void NavDatabase::createInternal(const QString& sceneryConfigCodec)
       return;
   }
 
+  if(options->isHilbertOrder())
+  {
+    if((aborted = progress.reportOther(tr("Sorting airports and navaids"))))
+      return;
+
+    if(!isStepDone("Hilbert order"))
+    {
+      // Renumber before any derived tables and waypoint nav_ids are created
+      atools::fs::db::HilbertOrder(db).run();
+      finishStep();
+    }
+  }
+
   // Set the nav_ids (VOR, NDB) in the waypoint table and update the airway counts
   if((aborted = runScript(&progress, "fs/db/update_wp_ids.sql", tr("Updating waypoints"))))
     return;
@@ -415,6 +1154,21 @@ void NavDatabase::createInternal(const QString& sceneryConfigCodec)
   if((aborted = runScript(&progress, "fs/db/populate_nav_search.sql", tr("Collecting navaids for search"))))
     return;
 
+  if(options->isFullTextSearch())
+  {
+    if(atools::fs::db::TextSearchQuery::isAvailable(db))
+    {
+      if((aborted = runScript(&progress, "fs/db/create_text_search.sql", tr("Creating full text search"))))
+        return;
+    }
+    else
+    {
+      qWarning() << Q_FUNC_INFO << "SQLite FTS5 not available. No full text search created.";
+      if((aborted = progress.reportOther(tr("Creating full text search"))))
+        return;
+    }
+  }
+
   // Fill tables for automatic flight plan calculation
   if((aborted = runScript(&progress, "fs/db/populate_route_node.sql", tr("Populating routing tables"))))
     return;
@@ -424,10 +1178,18 @@ void NavDatabase::createInternal(const QString& sceneryConfigCodec)
     if((aborted = progress.reportOther(tr("Creating route edges for VOR and NDB"))))
       return;
 
-    // Create a network of VOR and NDB stations that allow radio navaid routing
-    atools::fs::db::RouteEdgeWriter edgeWriter(db, progress, numRouteSteps);
-    if((aborted = edgeWriter.run()))
-      return;
+    if(!isStepDone("Route edges"))
+    {
+      // Create a network of VOR and NDB stations that allow radio navaid routing
+      atools::fs::db::RouteEdgeWriter edgeWriter(db, progress, numRouteSteps);
+      edgeWriter.setNumThreads(options->isReadParallel() ? options->getNumThreads() : 1);
+      progress.startStage(tr("Creating route edges for VOR and NDB"));
+      aborted = edgeWriter.run();
+      progress.finishStage();
+      if(aborted)
+        return;
+      finishStep();
+    }
   }
 
   if((aborted = runScript(&progress, "fs/db/populate_route_edge.sql", tr("Creating route edges waypoints"))))
@@ -445,6 +1207,62 @@ void NavDatabase::createInternal(const QString& sceneryConfigCodec)
   if((aborted = runScript(&progress, "fs/db/finish_schema.sql", tr("Creating indexes for search"))))
     return;
 
+  if(options->isBoundaryLevelOfDetail())
+  {
+    if((aborted = progress.reportOther(tr("Simplifying airspaces"))))
+      return;
+
+    if(!isStepDone("Boundary level of detail"))
+    {
+      atools::fs::db::BoundaryLod boundaryLod(db);
+      boundaryLod.write(options->isPackedGeometry() ? atools::fs::common::BinaryGeometry::FORMAT_PACKED :
+                        atools::fs::common::BinaryGeometry::FORMAT_FLOAT);
+      finishStep();
+    }
+  }
+
+  if(options->isProcedureLegGeometry())
+  {
+    if((aborted = progress.reportOther(tr("Calculating procedure geometry"))))
+      return;
+
+    if(!isStepDone("Procedure leg geometry"))
+    {
+      atools::fs::db::ProcedureGeometry procedureGeometry(db);
+      procedureGeometry.write(options->isPackedGeometry() ? atools::fs::common::BinaryGeometry::FORMAT_PACKED :
+                              atools::fs::common::BinaryGeometry::FORMAT_FLOAT);
+      finishStep();
+    }
+  }
+
+  if(options->isSpatialIndex())
+  {
+    if(atools::fs::db::RTreeQuery::isAvailable(db))
+    {
+      if((aborted = runScript(&progress, "fs/db/create_spatial_index.sql", tr("Creating spatial indexes"))))
+        return;
+    }
+    else
+    {
+      qWarning() << Q_FUNC_INFO << "SQLite R*Tree module not available. No spatial indexes created.";
+      if((aborted = progress.reportOther(tr("Creating spatial indexes"))))
+        return;
+    }
+  }
+
+  if(options->getMapTileMaxZoom() >= 0)
+  {
+    if((aborted = progress.reportOther(tr("Creating map tiles"))))
+      return;
+
+    if(!isStepDone("Map tiles"))
+    {
+      atools::fs::db::MapTileWriter tileWriter(db, options->getMapTileMaxZoom());
+      tileWriter.write();
+      finishStep();
+    }
+  }
+
   // =====================================================================
   // Update the metadata in the database
   atools::fs::db::DatabaseMeta databaseMetadata(db);
@@ -462,8 +1280,25 @@ void NavDatabase::createInternal(const QString& sceneryConfigCodec)
                                       arg(QApplication::applicationVersion()).
                                       arg(gitRevision));
 
+  // Replaces the metadata row which clears the checkpoint - database is complete
   databaseMetadata.updateAll();
   db->commit();
+  delete checkpoint;
+  checkpoint = nullptr;
+
+  if(!options->getRouteGraphFile().isEmpty())
+  {
+    if((aborted = progress.reportOther(tr("Exporting route graph"))))
+      return;
+
+    progress.startStage(tr("Exporting route graph"));
+    atools::fs::db::RouteGraphWriter(db).write(options->getRouteGraphFile());
+    progress.finishStage(0);
+  }
+
+  // Save file states only if all steps were successful
+  if(!fileStates.isNull())
+    fileStates->writeCurrent();
 
   if(!dfdCompiler.isNull())
     // database is kept locked by queries - need to close this late to avoid statistics generation for attached
@@ -472,15 +1307,19 @@ void NavDatabase::createInternal(const QString& sceneryConfigCodec)
   // ================================================================================================
   // Done here - now only some options statistics and reports are left
 
+  // Rows and coordinate ranges collected while writing FSX/P3D scenery
+  const atools::fs::db::TableStatistics *statistics =
+    fsDataWriter.isNull() ? nullptr : &fsDataWriter->getTableStatistics();
+
   if(options->isBasicValidation())
-    basicValidation(&progress);
+    basicValidation(&progress, statistics);
 
   if(options->isDatabaseReport())
   {
     // Do a report of problems rather than failing totally during loading
     if(!fsDataWriter.isNull())
       fsDataWriter->logResults();
-    createDatabaseReport(&progress);
+    createDatabaseReport(&progress, statistics);
   }
 
   if(options->isDropIndexes())
@@ -495,25 +1334,55 @@ void NavDatabase::createInternal(const QString& sceneryConfigCodec)
 
     dropAllIndexes();
   }
-  if(options->isVacuumDatabase())
+
+  if(compactExport)
+  {
+    // Replaces vacuum and analyze
+    if((aborted = progress.reportOther(tr("Writing Compact Database"))))
+      return;
+
+    progress.startStage(tr("Writing Compact Database"));
+    writeCompactDatabase();
+    progress.finishStage(0);
+  }
+
+  if(options->isVacuumDatabase() && !compactExport)
   {
     if((aborted = progress.reportOther(tr("Vacuum Database"))))
       return;
 
+    progress.startStage(tr("Vacuum Database"));
     db->vacuum();
+    progress.finishStage(0);
   }
 
-  if(options->isAnalyzeDatabase())
+  if(options->isAnalyzeDatabase() && !compactExport)
   {
     if((aborted = progress.reportOther(tr("Analyze Database"))))
       return;
 
+    progress.startStage(tr("Analyze Database"));
     db->analyze();
+    progress.finishStage(0);
+  }
+
+  if(fileDb != nullptr)
+  {
+    if((aborted = progress.reportOther(tr("Writing Database File"))))
+      return;
+
+    progress.startStage(tr("Writing Database File"));
+    writeInMemoryDatabase();
+    progress.finishStage(0);
   }
 
   // Send the final progress report
   progress.reportFinish();
 
+  progress.logStageTimings();
+  if(!options->getTimingReportFile().isEmpty())
+    writeTimingReport(progress, timer.elapsed());
+
   qDebug() << "Time" << timer.elapsed() / 1000 << "seconds";
 }
 
@@ -521,35 +1390,57 @@ bool NavDatabase::loadDfd(ProgressHandler *progress, ng::DfdCompiler *dfdCompile
 {
   progress->reportSceneryArea(&area);
 
-  dfdCompiler->writeFileAndSceneryMetadata();
+  if(!isStepDone("Scenery"))
+  {
+    dfdCompiler->writeFileAndSceneryMetadata();
+    finishStep();
+  }
 
   dfdCompiler->attachDatabase();
 
+  // Queries, declination and cycle are needed in memory when resuming too
   dfdCompiler->initQueries();
   dfdCompiler->compileMagDeclBgl();
   dfdCompiler->readHeader();
-  dfdCompiler->writeMora();
 
-  if(options->isIncludedNavDbObject(atools::fs::type::AIRPORT))
+  if(!isStepDone("MORA"))
+  {
+    dfdCompiler->writeMora();
+    finishStep();
+  }
+
+  if(options->isIncludedNavDbObject(atools::fs::type::AIRPORT) && !isStepDone("Airports"))
   {
+    // Runways use information collected while writing airports
     dfdCompiler->writeAirports();
     if(options->isIncludedNavDbObject(atools::fs::type::RUNWAY))
       dfdCompiler->writeRunways();
+    finishStep();
   }
-  if(options->isIncludedNavDbObject(atools::fs::type::WAYPOINT) ||
-     options->isIncludedNavDbObject(atools::fs::type::VOR) ||
-     options->isIncludedNavDbObject(atools::fs::type::NDB) ||
-     options->isIncludedNavDbObject(atools::fs::type::MARKER) ||
-     options->isIncludedNavDbObject(atools::fs::type::ILS))
+
+  if((options->isIncludedNavDbObject(atools::fs::type::WAYPOINT) ||
+      options->isIncludedNavDbObject(atools::fs::type::VOR) ||
+      options->isIncludedNavDbObject(atools::fs::type::NDB) ||
+      options->isIncludedNavDbObject(atools::fs::type::MARKER) ||
+      options->isIncludedNavDbObject(atools::fs::type::ILS)) && !isStepDone("Navaids"))
+  {
     dfdCompiler->writeNavaids();
+    finishStep();
+  }
 
-  if(options->isIncludedNavDbObject(atools::fs::type::BOUNDARY))
+  if(options->isIncludedNavDbObject(atools::fs::type::BOUNDARY) && !isStepDone("Airspaces"))
   {
+    // COM uses the airspace ids collected while writing airspaces
     dfdCompiler->writeAirspaces();
     dfdCompiler->writeAirspaceCom();
+    finishStep();
   }
 
-  dfdCompiler->writeCom();
+  if(!isStepDone("COM"))
+  {
+    dfdCompiler->writeCom();
+    finishStep();
+  }
 
   if((aborted = runScript(progress, "fs/db/create_indexes_post_load.sql", tr("Creating indexes"))))
     return true;
@@ -561,15 +1452,25 @@ bool NavDatabase::loadDfd(ProgressHandler *progress, ng::DfdCompiler *dfdCompile
       return true;
   }
 
-  if(options->isIncludedNavDbObject(atools::fs::type::AIRWAY))
+  if(options->isIncludedNavDbObject(atools::fs::type::AIRWAY) && !isStepDone("Airways"))
+  {
     dfdCompiler->writeAirways();
+    finishStep();
+  }
 
-  dfdCompiler->updateMagvar();
-  dfdCompiler->updateTacanChannel();
-  dfdCompiler->updateIlsGeometry();
+  if(!isStepDone("Magnetic declination"))
+  {
+    dfdCompiler->updateMagvar();
+    dfdCompiler->updateVorMagvarAndTacanChannel();
+    dfdCompiler->updateIlsGeometry();
+    finishStep();
+  }
 
-  if(options->isIncludedNavDbObject(atools::fs::type::APPROACH))
+  if(options->isIncludedNavDbObject(atools::fs::type::APPROACH) && !isStepDone("Procedures"))
+  {
     dfdCompiler->writeProcedures();
+    finishStep();
+  }
   db->commit();
 
   if((aborted = runScript(progress, "fs/db/create_indexes_post_load.sql", tr("Creating indexes"))))
@@ -583,7 +1484,11 @@ bool NavDatabase::loadDfd(ProgressHandler *progress, ng::DfdCompiler *dfdCompile
 
   db->commit();
 
-  dfdCompiler->updateTreeLetterAirportCodes();
+  if(!isStepDone("Three letter airport codes"))
+  {
+    dfdCompiler->updateTreeLetterAirportCodes();
+    finishStep();
+  }
 
   db->commit();
 
@@ -600,43 +1505,55 @@ bool NavDatabase::loadXplane(ProgressHandler *progress, atools::fs::xp::XpDataCo
   if((aborted = progress->reportSceneryArea(&area)))
     return true;
 
-  if((aborted = xpDataCompiler->writeBasepathScenery()))
+  // Run a compiler method as a step and keep the cycle for resuming since it is read from the file headers
+  auto step = [this, xpDataCompiler](const QString& name, bool (atools::fs::xp::XpDataCompiler::*func)()) -> bool
+  {
+    return runStep(name, [this, xpDataCompiler, func]() -> bool {
+      bool abort = (xpDataCompiler->*func)();
+      if(checkpoint != nullptr)
+        checkpoint->setAiracCycle(xpDataCompiler->getAiracCycle());
+      return abort;
+    });
+  };
+
+  if((aborted = step("Scenery", &atools::fs::xp::XpDataCompiler::writeBasepathScenery)))
     return true;
 
+  // Declination is needed in memory when resuming too
   if((aborted = xpDataCompiler->compileMagDeclBgl()))
     return true;
 
   if(options->isIncludedNavDbObject(atools::fs::type::AIRPORT))
   {
     // X-Plane 11/Custom Scenery/KSEA Demo Area/Earth nav data/apt.dat
-    if((aborted = xpDataCompiler->compileCustomApt())) // Add-on
+    if((aborted = step("Custom apt", &atools::fs::xp::XpDataCompiler::compileCustomApt))) // Add-on
       return true;
 
     // X-Plane 11/Custom Scenery/Global Airports/Earth nav data/apt.dat
-    if((aborted = xpDataCompiler->compileCustomGlobalApt()))
+    if((aborted = step("Custom global apt", &atools::fs::xp::XpDataCompiler::compileCustomGlobalApt)))
       return true;
 
     // X-Plane 11/Resources/default scenery/default apt dat/Earth nav data/apt.dat
     // Mandatory
-    if((aborted = xpDataCompiler->compileDefaultApt()))
+    if((aborted = step("Default apt", &atools::fs::xp::XpDataCompiler::compileDefaultApt)))
       return true;
   }
 
   if(options->isIncludedNavDbObject(atools::fs::type::ILS))
   {
     // ILS corrections - "X-PLane/Custom Scenery/Global Airports/Earth nav data/earth_nav.dat"
-    if((aborted = xpDataCompiler->compileLocalizers()))
+    if((aborted = step("Localizers", &atools::fs::xp::XpDataCompiler::compileLocalizers)))
       return true;
   }
 
   if(options->isIncludedNavDbObject(atools::fs::type::WAYPOINT))
   {
     // In resources or Custom Data - mandatory
-    if((aborted = xpDataCompiler->compileEarthFix()))
+    if((aborted = step("Earth fix", &atools::fs::xp::XpDataCompiler::compileEarthFix)))
       return true;
 
     // Optional user data
-    if((aborted = xpDataCompiler->compileUserFix()))
+    if((aborted = step("User fix", &atools::fs::xp::XpDataCompiler::compileUserFix)))
       return true;
   }
 
@@ -646,11 +1563,11 @@ bool NavDatabase::loadXplane(ProgressHandler *progress, atools::fs::xp::XpDataCo
      options->isIncludedNavDbObject(atools::fs::type::ILS))
   {
     // In resources or Custom Data - mandatory
-    if((aborted = xpDataCompiler->compileEarthNav()))
+    if((aborted = step("Earth nav", &atools::fs::xp::XpDataCompiler::compileEarthNav)))
       return true;
 
     // Optional user data
-    if((aborted = xpDataCompiler->compileUserNav()))
+    if((aborted = step("User nav", &atools::fs::xp::XpDataCompiler::compileUserNav)))
       return true;
   }
 
@@ -660,7 +1577,7 @@ bool NavDatabase::loadXplane(ProgressHandler *progress, atools::fs::xp::XpDataCo
   if(options->isIncludedNavDbObject(atools::fs::type::BOUNDARY))
   {
     // Airspaces
-    if((aborted = xpDataCompiler->compileAirspaces()))
+    if((aborted = step("Airspaces", &atools::fs::xp::XpDataCompiler::compileAirspaces)))
       return true;
   }
 
@@ -674,27 +1591,29 @@ bool NavDatabase::loadXplane(ProgressHandler *progress, atools::fs::xp::XpDataCo
   if(options->isIncludedNavDbObject(atools::fs::type::AIRWAY))
   {
     // In resources or Custom Data - mandatory
-    if((aborted = xpDataCompiler->compileEarthAirway()))
+    if((aborted = step("Earth airway", &atools::fs::xp::XpDataCompiler::compileEarthAirway)))
       return true;
 
     if((aborted = runScript(progress, "fs/db/xplane/prepare_airway.sql", tr("Preparing Airways"))))
       return true;
 
-    if((aborted = xpDataCompiler->postProcessEarthAirway()))
+    if((aborted = step("Airway post process", &atools::fs::xp::XpDataCompiler::postProcessEarthAirway)))
       return true;
   }
 
   if(options->isIncludedNavDbObject(atools::fs::type::APPROACH))
   {
-    if((aborted = xpDataCompiler->compileCifp()))
+    if((aborted = step("CIFP", &atools::fs::xp::XpDataCompiler::compileCifp)))
       return true;
   }
   db->commit();
   return false;
 }
 
-bool NavDatabase::loadFsxP3d(ProgressHandler *progress, atools::fs::db::DataWriter *fsDataWriter, const SceneryCfg& cfg)
+bool NavDatabase::loadFsxP3d(ProgressHandler *progress, atools::fs::db::DataWriter *fsDataWriter, const SceneryCfg& cfg,
+                             const atools::fs::scenery::FileManifest& manifest)
 {
+  // Declination is needed in memory when resuming too
   fsDataWriter->readMagDeclBgl();
 
   for(const atools::fs::scenery::SceneryArea& area : cfg.getAreas())
@@ -705,6 +1624,13 @@ bool NavDatabase::loadFsxP3d(ProgressHandler *progress, atools::fs::db::DataWrit
       if((aborted = progress->reportSceneryArea(&area)))
         return true;
 
+      if(isStepDone(QString("Area %1 %2").arg(area.getAreaNumber()).arg(area.getLocalPath())))
+      {
+        // Loaded by the aborted compilation - errors of this area are not reported again
+        progress->increaseCurrent(manifest.getFilepaths(area).size());
+        continue;
+      }
+
       NavDatabaseErrors::SceneryErrors err;
       if(errors != nullptr)
         // Prepare structure for error collection
@@ -724,6 +1650,7 @@ bool NavDatabase::loadFsxP3d(ProgressHandler *progress, atools::fs::db::DataWrit
 
       if((aborted = fsDataWriter->isAborted()))
         return true;
+      finishStep();
     }
   }
   db->commit();
@@ -734,32 +1661,39 @@ bool NavDatabase::loadFsxP3d(ProgressHandler *progress, atools::fs::db::DataWrit
   if(options->isDeduplicate())
   {
     // Delete duplicates before any foreign keys ids are assigned
-    if((aborted = runScript(progress, "fs/db/delete_duplicates.sql", tr("Clean up"))))
+    // Navaids are already deduplicated by the writers if deduplicate on write is set
+    QString script = options->isDeduplicateOnWrite() ?
+                     "fs/db/delete_duplicates_airport.sql" : "fs/db/delete_duplicates.sql";
+    if((aborted = runScript(progress, script, tr("Clean up"))))
       return true;
   }
 
   return false;
 }
 
-bool NavDatabase::basicValidation(ProgressHandler *progress)
+bool NavDatabase::basicValidation(ProgressHandler *progress, const atools::fs::db::TableStatistics *statistics)
 {
   if((aborted = progress->reportOther(tr("Basic Validation"))))
     return true;
 
   for(const QString& table : options->getBasicValidationTables().keys())
-    basicValidateTable(table, options->getBasicValidationTables().value(table));
+    basicValidateTable(table, options->getBasicValidationTables().value(table), statistics);
 
   return false;
 }
 
-void NavDatabase::basicValidateTable(const QString& table, int minCount)
+void NavDatabase::basicValidateTable(const QString& table, int minCount,
+                                     const atools::fs::db::TableStatistics *statistics)
 {
   SqlUtil util(db);
   if(!util.hasTable(table))
     throw Exception("Table \"" + table + "\" not found.");
 
-  int count = 0;
-  if((count = util.rowCount(table)) < minCount)
+  // Use rows written if available - count only tables filled by scripts or other compilers
+  const atools::fs::db::TableStats *tableStats = statistics != nullptr ? statistics->findStats(table) : nullptr;
+
+  int count = tableStats != nullptr && tableStats->rows > 0 ? tableStats->rows : util.rowCount(table);
+  if(count < minCount)
     throw Exception(QString("Table \"%1\" has only %2 rows. Minimum required is %3").arg(table).arg(count).arg(minCount));
 
   qInfo() << "Table" << table << "is OK. Has" << count << "rows. Minimum required is" << minCount;
@@ -817,67 +1751,226 @@ void NavDatabase::dropAllIndexes()
   db->commit();
 }
 
-bool NavDatabase::createDatabaseReport(ProgressHandler *progress)
+bool NavDatabase::createDatabaseReport(ProgressHandler *progress, const atools::fs::db::TableStatistics *statistics)
 {
   QDebug info(qInfo());
   atools::sql::SqlUtil util(db);
+  bool deep = options->isDatabaseReportDeep();
+  bool hasStatistics = statistics != nullptr && !statistics->isEmpty();
 
   if((aborted = progress->reportOther(tr("Creating table statistics"))))
     return true;
 
   info << endl;
-  util.printTableStats(info);
+  if(hasStatistics)
+    statistics->print(info);
 
-  if((aborted = progress->reportOther(tr("Creating report on values"))))
-    return true;
+  if(deep || !hasStatistics)
+  {
+    info << endl;
+    util.printTableStats(info);
+  }
 
-  info << endl;
-  util.createColumnReport(info);
+  if(atools::sql::SqlProfiler::isEnabled())
+  {
+    info << endl;
+    atools::sql::SqlUtil::printQueryProfile(info);
+  }
 
-  if((aborted = progress->reportOther(tr("Creating report on duplicates"))))
-    return true;
+  if(!atools::util::PerfRegistry::isEmpty())
+  {
+    info << endl << "Performance counters:";
+    atools::util::PerfRegistry::print(info);
+    info << endl;
+  }
 
+  info << endl << "Compilation stages:";
+  progress->printStageTimings(info);
   info << endl;
 
-  util.reportDuplicates(info, "airport", "airport_id", {"ident"});
-  info << endl;
+  const QStringList coordinateTables({"airport", "vor", "ndb", "marker", "waypoint"});
+  if(!deep)
+  {
+    // Skip the expensive queries but keep the number of progress steps
+    progress->increaseCurrent(PROGRESS_NUM_DB_REPORT_STEPS - 1);
 
-  util.reportDuplicates(info, "vor", "vor_id", {"ident", "region", "lonx", "laty"});
-  info << endl;
+    // Query only tables where the collected ranges show invalid coordinates
+    QStringList violationTables;
+    for(const QString& table : coordinateTables)
+    {
+      const atools::fs::db::TableStats *tableStats = hasStatistics ? statistics->findStats(table) : nullptr;
+      if(tableStats != nullptr && tableStats->hasCoordinateViolations())
+        violationTables.append(table);
+    }
 
-  util.reportDuplicates(info, "ndb", "ndb_id", {"ident", "type", "frequency", "region", "lonx", "laty"});
-  info << endl;
+    if(!violationTables.isEmpty())
+    {
+      info << endl;
+      reportCoordinateViolations(info, util, violationTables);
+    }
+    return false;
+  }
 
-  util.reportDuplicates(info, "waypoint", "waypoint_id", {"ident", "type", "region", "lonx", "laty"});
-  info << endl;
+  // All sections are independent of each other and can run at the same time
+  QVector<ReportSection> sections;
+
+  // Column values - one section per table
+  QStringList tables = db->tables();
+  std::sort(tables.begin(), tables.end());
+  sections.append([](SqlUtil&, QDebug& out) {
+    out << endl << "Column value report for database:" << endl;
+  });
+  for(const QString& table : tables)
+    sections.append([table](SqlUtil& sectionUtil, QDebug& out) {
+      sectionUtil.createColumnReport(out, {table}, false /* printHeader */);
+    });
+
+  // Duplicates
+  const QVector<std::pair<QString, QStringList> > duplicateTables(
+  {
+    {"airport", {"ident"}},
+    {"vor", {"ident", "region", "lonx", "laty"}},
+    {"ndb", {"ident", "type", "frequency", "region", "lonx", "laty"}},
+    {"waypoint", {"ident", "type", "region", "lonx", "laty"}},
+    {"ils", {"ident", "lonx", "laty"}},
+    {"marker", {"type", "heading", "lonx", "laty"}},
+    {"helipad", {"lonx", "laty"}},
+    {"parking", {"lonx", "laty"}},
+    {"start", {"lonx", "laty"}},
+    {"runway", {"heading", "lonx", "laty"}},
+    {"bgl_file", {"filename"}}
+  });
+  sections.append([](SqlUtil&, QDebug& out) {
+    out << endl;
+  });
+  for(const std::pair<QString, QStringList>& dup : duplicateTables)
+    sections.append([dup](SqlUtil& sectionUtil, QDebug& out) {
+      sectionUtil.reportDuplicates(out, dup.first, dup.first + "_id", dup.second);
+      out << endl;
+    });
+
+  // Coordinate ranges
+  for(const QString& table : coordinateTables)
+    sections.append([this, table](SqlUtil& sectionUtil, QDebug& out) {
+      reportCoordinateViolations(out, sectionUtil, {table});
+    });
+
+  if((aborted = progress->reportOther(tr("Creating report on values, duplicates and coordinates"))))
+    return true;
+  progress->increaseCurrent(PROGRESS_NUM_DB_REPORT_STEPS - 2);
 
-  util.reportDuplicates(info, "ils", "ils_id", {"ident", "lonx", "laty"});
-  info << endl;
+  runReportSections(info, sections);
 
-  util.reportDuplicates(info, "marker", "marker_id", {"type", "heading", "lonx", "laty"});
-  info << endl;
+  return false;
+}
 
-  util.reportDuplicates(info, "helipad", "helipad_id", {"lonx", "laty"});
-  info << endl;
+void NavDatabase::runReportSections(QDebug& out, const QVector<ReportSection>& sections)
+{
+  ATOOLS_TRACE_SPAN("NavDatabase::runReportSections", "report");
 
-  util.reportDuplicates(info, "parking", "parking_id", {"lonx", "laty"});
-  info << endl;
+  QElapsedTimer timer;
+  timer.start();
 
-  util.reportDuplicates(info, "start", "start_id", {"lonx", "laty"});
-  info << endl;
+  QString filename = db->databaseName();
+  bool parallel = taskScheduler != nullptr && taskScheduler->getNumThreads() > 1 && fileDb == nullptr &&
+                  !filename.isEmpty() && filename != ":memory:" && QFileInfo::exists(filename);
 
-  util.reportDuplicates(info, "runway", "runway_id", {"heading", "lonx", "laty"});
-  info << endl;
+  // Output of each section - printed in order at the end
+  QVector<QString> texts(sections.size());
 
-  util.reportDuplicates(info, "bgl_file", "bgl_file_id", {"filename"});
-  info << endl;
+  if(parallel)
+  {
+    // Other connections have to see all data
+    db->commit();
 
-  if((aborted = progress->reportOther(tr("Creating report on coordinate duplicates"))))
-    return true;
+    if(options->isBulkLoad())
+    {
+      // Exclusive lock of the bulk load settings would block the read only connections
+      // Lock is released on the next access of the database
+      applyPragmas({"PRAGMA locking_mode=NORMAL"}, "Report");
+      db->exec("select count(1) from sqlite_master");
+      db->commit();
+    }
+
+    atools::sql::SqlConnectionPool pool(filename, 0, false /* enableWal */);
+    atools::util::TaskGroup group(*taskScheduler);
+    for(int i = 0; i < sections.size(); i++)
+    {
+      group.run([&pool, &sections, &texts, i]() -> void
+      {
+        try
+        {
+          QDebug sectionOut(&texts[i]);
+          sectionOut.noquote().nospace();
+          SqlUtil sectionUtil(pool.connection());
+          sections.at(i)(sectionUtil, sectionOut);
+        }
+        catch(...)
+        {
+          // Connections have to be closed in the worker thread
+          pool.releaseConnection();
+          throw;
+        }
+        pool.releaseConnection();
+      });
+    }
+    group.wait();
+  }
+  else
+  {
+    SqlUtil util(db);
+    for(int i = 0; i < sections.size(); i++)
+    {
+      QDebug sectionOut(&texts[i]);
+      sectionOut.noquote().nospace();
+      sections.at(i)(util, sectionOut);
+    }
+  }
 
-  reportCoordinateViolations(info, util, {"airport", "vor", "ndb", "marker", "waypoint"});
+  QDebugStateSaver saver(out);
+  out.noquote().nospace();
+  for(const QString& text : texts)
+    out << text;
 
-  return false;
+  qInfo() << Q_FUNC_INFO << sections.size() << "sections" << (parallel ? "in parallel" : "sequential")
+          << "took" << timer.elapsed() << "ms";
+}
+
+void NavDatabase::writeTimingReport(const ProgressHandler& progress, qint64 totalMs)
+{
+  QJsonArray stages;
+  for(const atools::fs::StageTiming& stage : progress.getStageTimings())
+  {
+    QJsonObject obj;
+    obj.insert("name", stage.name);
+    obj.insert("level", stage.level);
+    obj.insert("milliseconds", stage.milliseconds);
+    obj.insert("rows_affected", stage.rowsAffected);
+    obj.insert("bytes_read", stage.bytesRead);
+    obj.insert("memory_kb", stage.memoryKb);
+    obj.insert("memory_change_kb", stage.memoryChangeKb);
+    obj.insert("memory_peak_kb", stage.memoryPeakKb);
+    obj.insert("peak_increase_kb", stage.peakIncreaseKb);
+    stages.append(obj);
+  }
+
+  QJsonObject report;
+  report.insert("simulator", FsPaths::typeToShortName(options->getSimulatorType()));
+  report.insert("compiler_version", QString("atools %1 (revision %2)").arg(atools::version()).arg(atools::gitRevision()));
+  report.insert("timestamp", QDateTime::currentDateTime().toString(Qt::ISODate));
+  report.insert("total_milliseconds", totalMs);
+  report.insert("stages", stages);
+  report.insert("performance", atools::util::PerfRegistry::toJson());
+
+  QFile file(options->getTimingReportFile());
+  if(file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    file.write(QJsonDocument(report).toJson());
+    file.close();
+    qInfo() << "Wrote timing report to" << file.fileName();
+  }
+  else
+    qWarning() << "Cannot write timing report" << file.fileName() << file.errorString();
 }
 
 bool NavDatabase::runScript(ProgressHandler *progress, const QString& scriptFile, const QString& message)
@@ -887,14 +1980,73 @@ bool NavDatabase::runScript(ProgressHandler *progress, const QString& scriptFile
   if((aborted = progress->reportOther(message)))
     return true;
 
+  if(isStepDone(scriptFile))
+    return false;
+
+  progress->startStage(scriptFile);
   script.executeScript(":/atools/resources/sql/" + scriptFile);
+
+  // Script and checkpoint are committed together
+  finishStep();
+  progress->finishStage(script.getNumRowsAffected());
+  return false;
+}
+
+bool NavDatabase::isStepDone(const QString& name)
+{
+  return checkpoint != nullptr && checkpoint->nextStep(name);
+}
+
+void NavDatabase::finishStep()
+{
+  if(checkpoint != nullptr)
+    checkpoint->finishStep();
   db->commit();
+}
+
+bool NavDatabase::runStep(const QString& name, const std::function<bool()>& func)
+{
+  if(isStepDone(name))
+    return false;
+
+  if(func())
+    return true;
+
+  finishStep();
   return false;
 }
 
+QString NavDatabase::incrementalOptionsHash() const
+{
+  // Modes which do not change the result
+  NavDatabaseOptions opts = options->copyForThread();
+  opts.setIncremental(false);
+  opts.setIncrementalHash(false);
+  opts.setResume(false);
+  opts.setNumThreads(0);
+
+  QString str;
+  QDebug(&str) << opts << FsPaths::typeToShortName(options->getSimulatorType())
+               << opts.getBasepath() << opts.getSceneryFile();
+  return QString(QCryptographicHash::hash(str.toUtf8(), QCryptographicHash::Md5).toHex());
+}
+
+QString NavDatabase::checkpointOptionsHash() const
+{
+  // Resume does not change the result
+  NavDatabaseOptions opts = options->copyForThread();
+  opts.setResume(false);
+
+  QString str;
+  QDebug(&str) << opts << FsPaths::typeToShortName(options->getSimulatorType())
+               << opts.getBasepath() << opts.getSceneryFile() << opts.getSourceDatabase();
+  return QString(QCryptographicHash::hash(str.toUtf8(), QCryptographicHash::Md5).toHex());
+}
+
 void NavDatabase::readSceneryConfig(atools::fs::scenery::SceneryCfg& cfg)
 {
-  // Get entries from scenery.cfg file
+  // Get entries from scenery.cfg file - uses the parse result of isSceneryConfigValid() if file is unchanged
+  cfg.setUseCache(true);
   cfg.read(options->getSceneryFile());
 
   FsPaths::SimulatorType sim = options->getSimulatorType();
@@ -924,8 +2076,8 @@ void NavDatabase::readSceneryConfig(atools::fs::scenery::SceneryCfg& cfg)
     QVector<AddOnComponent> noLayerComponents;
     QStringList noLayerPaths;
 
-    // Use this to weed out duplicates to the add-on.xml files
-    QSet<QString> addonFilePaths;
+    // Add-on directories in order of discovery - packages are read later in parallel
+    QFileInfoList addonEntries;
 
     // Got through the two or more discovery paths ===============
     for(const QString& addonPath : addonPaths)
@@ -933,11 +2085,8 @@ void NavDatabase::readSceneryConfig(atools::fs::scenery::SceneryCfg& cfg)
       QDir addonDir(addonPath);
       if(addonDir.exists())
       {
-        QFileInfoList addonEntries(addonDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot));
-
         // Read addon directories as they appear in the file system
-        for(QFileInfo addonEntry : addonEntries)
-          readAddOnComponents(areaNum, cfg, noLayerComponents, noLayerPaths, addonFilePaths, addonEntry);
+        addonEntries.append(addonDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot));
       }
       else
         qWarning() << Q_FUNC_INFO << addonDir << "does not exist";
@@ -962,9 +2111,10 @@ void NavDatabase::readSceneryConfig(atools::fs::scenery::SceneryCfg& cfg)
     {
       // AppData\Roaming\Lockheed Martin\Prepar3D v4\add-ons.cfg
       AddOnCfg addonConfigRoaming("utf-8");
+      addonConfigRoaming.setUseCache(true);
       addonConfigRoaming.read(addonsCfgFile);
       for(const AddOnCfgEntry& entry:addonConfigRoaming.getEntries())
-        readAddOnComponents(areaNum, cfg, noLayerComponents, noLayerPaths, addonFilePaths, QFileInfo(entry.path));
+        addonEntries.append(QFileInfo(entry.path));
     }
 
     // Read the add-on.cfg from ProgramData =========================
@@ -985,11 +2135,14 @@ void NavDatabase::readSceneryConfig(atools::fs::scenery::SceneryCfg& cfg)
     if(QFileInfo::exists(addonsAllUsersCfgFile))
     {
       AddOnCfg addonConfigProgramData("utf-8");
+      addonConfigProgramData.setUseCache(true);
       addonConfigProgramData.read(addonsAllUsersCfgFile);
       for(const AddOnCfgEntry& entry:addonConfigProgramData.getEntries())
-        readAddOnComponents(areaNum, cfg, noLayerComponents, noLayerPaths, addonFilePaths, QFileInfo(entry.path));
+        addonEntries.append(QFileInfo(entry.path));
     }
 
+    readAddOnPackages(areaNum, cfg, noLayerComponents, noLayerPaths, addonEntries);
+
     // Bring added add-on.xml in order with the rest sort by layer
     cfg.sortAreas();
 
@@ -1020,61 +2173,113 @@ void NavDatabase::readSceneryConfig(atools::fs::scenery::SceneryCfg& cfg)
   cfg.sortAreas();
 }
 
-void NavDatabase::readAddOnComponents(int& areaNum, atools::fs::scenery::SceneryCfg& cfg,
-                                      QVector<AddOnComponent>& noLayerComponents,
-                                      QStringList& noLayerPaths, QSet<QString>& addonPaths, QFileInfo addonEntry)
+void NavDatabase::readAddOnPackages(int& areaNum, atools::fs::scenery::SceneryCfg& cfg,
+                                    QVector<AddOnComponent>& noLayerComponents, QStringList& noLayerPaths,
+                                    const QFileInfoList& addonEntries)
 {
-  QFileInfo addonFile(addonEntry.absoluteFilePath() + QDir::separator() + QLatin1Literal("add-on.xml"));
-  if(addonFile.exists() && addonFile.isFile())
+  // Get add-on.xml files and one read result for each distinct file
+  QStringList addonFiles;
+  QVector<int> resultIndexes;
+  QHash<QString, int> fileToResultIndex;
+  for(const QFileInfo& addonEntry : addonEntries)
   {
-    if(addonPaths.contains(addonFile.absoluteFilePath()))
+    QString addonFile = QFileInfo(addonEntry.absoluteFilePath() + QDir::separator() +
+                                  QLatin1Literal("add-on.xml")).absoluteFilePath();
+    if(!fileToResultIndex.contains(addonFile))
+      fileToResultIndex.insert(addonFile, fileToResultIndex.size());
+    addonFiles.append(addonFile);
+    resultIndexes.append(fileToResultIndex.value(addonFile));
+  }
+
+  // Probe and parse files in parallel - each task writes only into its own result
+  QVector<AddOnPackageResult> results(fileToResultIndex.size());
+  {
+    // Use a temporary scheduler if called outside of a compilation
+    QScopedPointer<atools::util::TaskScheduler> localScheduler;
+    if(taskScheduler == nullptr)
+      localScheduler.reset(new atools::util::TaskScheduler(std::min(options->getNumThreads(), 8)));
+
+    atools::util::TaskGroup group(taskScheduler != nullptr ? *taskScheduler : *localScheduler);
+    for(auto it = fileToResultIndex.constBegin(); it != fileToResultIndex.constEnd(); ++it)
     {
-      qInfo() << "Found duplicate addon file" << addonFile.filePath();
-      return;
+      QString file = it.key();
+      AddOnPackageResult *result = &results[it.value()];
+      group.run([file, result]() {
+        readAddOnPackage(file, result);
+      });
     }
+    group.wait();
+  }
 
-    qInfo() << "Found addon file" << addonFile.filePath();
-    addonPaths.insert(addonFile.absoluteFilePath());
+  // Add components in order of discovery to keep the layer order
+  QSet<QString> addonFilePaths;
+  for(int i = 0; i < addonFiles.size(); i++)
+  {
+    const QString& addonFile = addonFiles.at(i);
+    const AddOnPackageResult& result = results.at(resultIndexes.at(i));
 
-    AddOnPackage package(addonFile.filePath());
-    qInfo() << "Name" << package.getName() << "Description" << package.getDescription();
+    if(!result.exists)
+    {
+      qWarning() << Q_FUNC_INFO << addonFile << "does not exist or is not a directory";
+      continue;
+    }
 
-    for(const AddOnComponent& component : package.getComponents())
+    // Weed out duplicates of add-on.xml files
+    if(addonFilePaths.contains(addonFile))
     {
-      qInfo() << "Component" << component.getLayer()
-              << "Name" << component.getName()
-              << "Description" << component.getPath();
+      qInfo() << "Found duplicate addon file" << addonFile;
+      continue;
+    }
 
-      QDir compPath(component.getPath());
+    qInfo() << "Found addon file" << addonFile;
+    addonFilePaths.insert(addonFile);
 
-      if(compPath.isRelative())
-        // Convert relative path to absolute based on add-on file directory
-        compPath = package.getBaseDirectory() + QDir::separator() + compPath.path();
+    if(result.package.isNull())
+      throw atools::Exception(result.error);
 
-      if(compPath.dirName().toLower() == "scenery")
-        // Remove if it points to scenery directory
-        compPath.cdUp();
+    readAddOnComponents(areaNum, cfg, noLayerComponents, noLayerPaths, *result.package);
+  }
+}
 
-      compPath.makeAbsolute();
+void NavDatabase::readAddOnComponents(int& areaNum, atools::fs::scenery::SceneryCfg& cfg,
+                                      QVector<AddOnComponent>& noLayerComponents, QStringList& noLayerPaths,
+                                      const AddOnPackage& package)
+{
+  qInfo() << "Name" << package.getName() << "Description" << package.getDescription();
 
-      areaNum++;
+  for(const AddOnComponent& component : package.getComponents())
+  {
+    qInfo() << "Component" << component.getLayer()
+            << "Name" << component.getName()
+            << "Description" << component.getPath();
 
-      if(!compPath.exists())
-        qWarning() << "Path does not exist" << compPath;
+    QDir compPath(component.getPath());
 
-      if(component.getLayer() == -1)
-      {
-        // Add entries without layers later at the end of the list
-        // Layer is only used if add-on does not provide a layer
-        noLayerComponents.append(component);
-        noLayerPaths.append(compPath.path());
-      }
-      else
-        cfg.appendArea(SceneryArea(areaNum, component.getLayer(), component.getName(), compPath.path()));
+    if(compPath.isRelative())
+      // Convert relative path to absolute based on add-on file directory
+      compPath = package.getBaseDirectory() + QDir::separator() + compPath.path();
+
+    if(compPath.dirName().toLower() == "scenery")
+      // Remove if it points to scenery directory
+      compPath.cdUp();
+
+    compPath.makeAbsolute();
+
+    areaNum++;
+
+    if(!compPath.exists())
+      qWarning() << "Path does not exist" << compPath;
+
+    if(component.getLayer() == -1)
+    {
+      // Add entries without layers later at the end of the list
+      // Layer is only used if add-on does not provide a layer
+      noLayerComponents.append(component);
+      noLayerPaths.append(compPath.path());
     }
+    else
+      cfg.appendArea(SceneryArea(areaNum, component.getLayer(), component.getName(), compPath.path()));
   }
-  else
-    qWarning() << Q_FUNC_INFO << addonFile.filePath() << "does not exist or is not a directory";
 }
 
 void NavDatabase::reportCoordinateViolations(QDebug& out, atools::sql::SqlUtil& util,
@@ -1088,20 +2293,23 @@ void NavDatabase::reportCoordinateViolations(QDebug& out, atools::sql::SqlUtil&
   }
 }
 
-void NavDatabase::countFiles(const atools::fs::scenery::SceneryCfg& cfg, int *numFiles, int *numSceneryAreas)
+void NavDatabase::countFiles(const atools::fs::scenery::SceneryCfg& cfg, atools::fs::scenery::FileManifest& manifest,
+                             int *numFiles, int *numSceneryAreas)
 {
   qDebug() << "Counting files";
 
+  // Use same conditions as in loadFsxP3d()
+  QList<SceneryArea> areas;
   for(const atools::fs::scenery::SceneryArea& area : cfg.getAreas())
   {
-    if(area.isActive() && options->isIncludedLocalPath(area.getLocalPath()))
-    {
-      atools::fs::scenery::FileResolver resolver(*options, true);
-
-      *numFiles += resolver.getFiles(area);
-      (*numSceneryAreas)++;
-    }
+    if((area.isActive() || options->isReadInactive()) && options->isIncludedLocalPath(area.getLocalPath()))
+      areas.append(area);
   }
+
+  manifest.build(areas);
+
+  *numFiles += manifest.getNumFiles();
+  *numSceneryAreas += manifest.getNumAreas();
   qDebug() << "Counting files done." << *numFiles << "files to process";
 }
 
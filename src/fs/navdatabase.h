@@ -25,12 +25,21 @@
 #include <QDebug>
 #include <QCoreApplication>
 #include <QFileInfo>
+#include <QStringList>
+
+#include <functional>
 
 namespace atools {
+namespace geo {
+class Rect;
+}
 namespace sql {
 class SqlDatabase;
 class SqlUtil;
 }
+namespace util {
+class TaskScheduler;
+}
 
 namespace fs {
 class NavDatabaseOptions;
@@ -38,10 +47,15 @@ class NavDatabaseOptions;
 namespace scenery {
 class SceneryCfg;
 class AddOnComponent;
+class AddOnPackage;
+class FileManifest;
 }
 
 namespace db {
+class CompileCheckpoint;
 class DataWriter;
+class NavMemoryStore;
+class TableStatistics;
 }
 
 namespace xp {
@@ -76,6 +90,26 @@ public:
    * @param codec Scenery.cfg codec */
   void create(const QString& codec);
 
+  /* Rebuild route nodes and edges only inside region after navaids in region were changed.
+   * Radio edges of nodes up to the maximum radio range around region are calculated again.
+   * Airway segments outside of region have to be unchanged.
+   * atools::Exception is thrown in case of error. Changes are rolled back if aborted by the progress callback.
+   * @return true if aborted */
+  bool updateRouteTables(const atools::geo::Rect& region);
+
+  /* Optional in memory store which is loaded again from the database after a successful create() */
+  void setMemoryStore(atools::fs::db::NavMemoryStore *store)
+  {
+    memoryStore = store;
+  }
+
+  /* Run parallel steps on this scheduler instead of an own one. Used to compile several databases at once.
+   * Tasks are not canceled by the scheduler in this case but by the progress checks of each step. */
+  void setTaskScheduler(atools::util::TaskScheduler *scheduler)
+  {
+    sharedScheduler = scheduler;
+  }
+
   /* Does not load anything and only creates the empty database schema.
    * Configuration is not used and can be null. atools::Exception is thrown in case of error. */
   void createSchema();
@@ -89,6 +123,14 @@ public:
     return aborted;
   }
 
+  /*
+   * @return true if incremental mode found no changed scenery files and the database was not touched
+   */
+  bool isUnchanged() const
+  {
+    return unchanged;
+  }
+
   /*
    * Checks if scenery.cfg file exists and is valid (contains areas).
    *
@@ -118,44 +160,119 @@ private:
   /* Internal creation of the full database */
   void createInternal(const QString& sceneryConfigCodec);
 
+  /* Execute each pragma of a profile and log the time needed */
+  void applyPragmas(const QStringList& pragmas, const QString& profile);
+
+  /* Read the current values of all pragmas in defaultPragmas. Uses the default for values that cannot be read. */
+  QStringList currentPragmas(const QStringList& defaultPragmas) const;
+
+  /* Apply settings saved before bulk load after an exception without throwing */
+  void restorePreviousPragmas();
+
+  /* true if in-memory compilation is enabled and the estimated database size fits into the limit */
+  bool isCompileInMemory() const;
+
+  /* Write the in-memory database into the file of fileDb and switch back to the file database.
+   * The file connection is closed and reopened without pragmas. */
+  void writeInMemoryDatabase();
+
+  /* Copy all tables into a new file, create indexes, views and triggers there and replace the database file.
+   * The connection is closed and reopened without pragmas. */
+  void writeCompactDatabase();
+
+  /* Close db, replace its file with the given one and open it again */
+  void replaceDatabaseFile(atools::sql::SqlDatabase *database, const QString& newFilename);
+
   /* Read FSX/P3D scenery configuration */
   void readSceneryConfig(atools::fs::scenery::SceneryCfg& cfg);
 
   /* Source dependent compilation methods */
   bool loadFsxP3d(atools::fs::ProgressHandler *progress, atools::fs::db::DataWriter *fsDataWriter,
-                  const scenery::SceneryCfg& cfg);
+                  const scenery::SceneryCfg& cfg, const atools::fs::scenery::FileManifest& manifest);
   bool loadXplane(atools::fs::ProgressHandler *progress, atools::fs::xp::XpDataCompiler *xpDataCompiler,
                   const atools::fs::scenery::SceneryArea& area);
   bool loadDfd(atools::fs::ProgressHandler *progress, atools::fs::ng::DfdCompiler *dfdCompiler,
                const atools::fs::scenery::SceneryArea& area);
 
   /* Reporting to log file and/or console */
-  bool createDatabaseReport(ProgressHandler *progress);
-  bool basicValidation(ProgressHandler *progress);
-  void basicValidateTable(const QString& table, int minCount);
+  /* Statistics are collected by the writers and are null if not available (X-Plane and DFD).
+   * Tables without statistics are checked by SQL queries. */
+  bool createDatabaseReport(ProgressHandler *progress, const atools::fs::db::TableStatistics *statistics);
+  bool basicValidation(ProgressHandler *progress, const atools::fs::db::TableStatistics *statistics);
+  void basicValidateTable(const QString& table, int minCount, const atools::fs::db::TableStatistics *statistics);
   void reportCoordinateViolations(QDebug& out, atools::sql::SqlUtil& util, const QStringList& tables);
 
-  /* Count files in FSX/P3D scenery configuration */
-  void countFiles(const atools::fs::scenery::SceneryCfg& cfg, int *numFiles, int *numSceneryAreas);
+  /* One independent part of the database report */
+  typedef std::function<void(atools::sql::SqlUtil& util, QDebug& out)> ReportSection;
+
+  /* Print sections in the given order. Sections run in parallel on read only connections if the database
+   * is a file and more than one thread is available. Sequential otherwise. */
+  void runReportSections(QDebug& out, const QVector<ReportSection>& sections);
+
+  /* Resolve all files in FSX/P3D scenery configuration into the manifest and count them */
+  void countFiles(const atools::fs::scenery::SceneryCfg& cfg, atools::fs::scenery::FileManifest& manifest,
+                  int *numFiles, int *numSceneryAreas);
 
-  /* Run and report SQL script */
+  /* Write stage timings as JSON into the file given in the options */
+  void writeTimingReport(const atools::fs::ProgressHandler& progress, qint64 totalMs);
+
+  /* Stop recording and write trace events to the file given in options */
+  void writeTrace();
+
+  /* Run and report SQL script. Each script is a step for checkpoints. */
   bool runScript(atools::fs::ProgressHandler *progress, const QString& scriptFile, const QString& message);
 
+  /* Count the next step for checkpoints. Returns true if the step was completed by the resumed compilation. */
+  bool isStepDone(const QString& name);
+
+  /* Save a checkpoint for the current step and commit */
+  void finishStep();
+
+  /* Run func as a step if not already done. func and this return true if the compilation was aborted. */
+  bool runStep(const QString& name, const std::function<bool()>& func);
+
+  /* Identifies options and simulator of a compilation for checkpoints */
+  QString checkpointOptionsHash() const;
+
+  /* Hash of all options and filters which change the result. Stored with the file states. */
+  QString incrementalOptionsHash() const;
+
   void createPreparationScript();
   void dropAllIndexes();
 
+  /* Read add-on.xml files of all add-on directories in parallel and add the components in the given order */
+  void readAddOnPackages(int& areaNum, atools::fs::scenery::SceneryCfg& cfg,
+                         QVector<scenery::AddOnComponent>& noLayerComponents,
+                         QStringList& noLayerPaths, const QFileInfoList& addonEntries);
+
   void readAddOnComponents(int& areaNum, atools::fs::scenery::SceneryCfg& cfg,
                            QVector<scenery::AddOnComponent>& noLayerComponents,
-                           QStringList& noLayerPaths, QSet<QString>& addonPaths, QFileInfo addonEntry);
+                           QStringList& noLayerPaths, const atools::fs::scenery::AddOnPackage& package);
 
   /* For metadata */
 
   atools::sql::SqlDatabase *db;
+
+  /* Database file connection while db points to the in-memory database. Otherwise null. */
+  atools::sql::SqlDatabase *fileDb = nullptr;
   atools::fs::NavDatabaseErrors *errors = nullptr;
   const atools::fs::NavDatabaseOptions *options;
-  bool aborted = false;
+  bool aborted = false, unchanged = false;
   QString gitRevision;
 
+  /* Database settings before bulk load which are restored after compilation */
+  QStringList previousPragmas;
+  atools::fs::db::NavMemoryStore *memoryStore = nullptr;
+
+  /* Shared by all parallel steps. Only valid while createInternal() runs. */
+  atools::util::TaskScheduler *taskScheduler = nullptr;
+
+  /* Set from outside and used instead of an own scheduler. Not owned. */
+  atools::util::TaskScheduler *sharedScheduler = nullptr;
+
+  /* Records completed steps while compiling into a file. Null otherwise and after the metadata update. */
+  atools::fs::db::CompileCheckpoint *checkpoint = nullptr;
+
 };
 
 } // namespace fs
@@ -0,0 +1,156 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/navdatabasebatch.h"
+
+#include "fs/navdatabase.h"
+#include "fs/navdatabaseoptions.h"
+#include "fs/common/magdecreader.h"
+#include "sql/sqldatabase.h"
+#include "util/taskscheduler.h"
+#include "exception.h"
+
+#include <QAtomicInt>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <functional>
+
+namespace atools {
+namespace fs {
+
+using atools::sql::SqlDatabase;
+
+/* Compiles one target in a thread of the pool */
+class NavDatabaseBatchTask :
+  public QRunnable
+{
+public:
+  NavDatabaseBatchTask(const std::function<void()>& func)
+    : function(func)
+  {
+  }
+
+  virtual void run() override
+  {
+    function();
+  }
+
+private:
+  std::function<void()> function;
+};
+
+NavDatabaseBatch::NavDatabaseBatch(const QString& revision, int numThreads)
+  : gitRevision(revision), threads(numThreads)
+{
+}
+
+void NavDatabaseBatch::addTarget(const NavDatabaseOptions *options, const QString& databaseFile,
+                                 NavDatabaseErrors *errors, const QString& sceneryConfigCodec)
+{
+  targets.append({options, databaseFile, sceneryConfigCodec, errors});
+}
+
+bool NavDatabaseBatch::create(int maxConcurrentTargets)
+{
+  results.clear();
+  results.resize(targets.size());
+  if(targets.isEmpty())
+    return true;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  // Load identical magdec.bgl files only once
+  atools::fs::common::MagDecReader::setSharedCacheEnabled(true);
+
+  // Shared by the parallel steps of all targets
+  atools::util::TaskScheduler scheduler(threads);
+
+  // Threads are mostly waiting for the database or the scheduler
+  QThreadPool pool;
+  pool.setMaxThreadCount(maxConcurrentTargets > 0 ? std::min(maxConcurrentTargets, targets.size()) : targets.size());
+
+  static QAtomicInt connectionId;
+  for(int i = 0; i < targets.size(); i++)
+  {
+    const Target& target = targets.at(i);
+    NavDatabaseBatchResult& result = results[i];
+    result.databaseFile = target.databaseFile;
+
+    pool.start(new NavDatabaseBatchTask([this, &target, &result, &scheduler]() -> void
+    {
+      QElapsedTimer targetTimer;
+      targetTimer.start();
+
+      // Connections can only be used in the thread where they were created
+      QString connectionName = QString("atools_navdatabase_batch_%1").arg(connectionId.fetchAndAddRelaxed(1));
+      try
+      {
+        SqlDatabase db = SqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(target.databaseFile);
+        db.open();
+
+        NavDatabase navDatabase(target.options, &db, target.errors, gitRevision);
+        navDatabase.setTaskScheduler(&scheduler);
+        navDatabase.create(target.codec);
+
+        result.aborted = navDatabase.isAborted();
+        result.success = !result.aborted;
+        db.close();
+      }
+      catch(atools::Exception& e)
+      {
+        result.errorMessage = e.what();
+      }
+      catch(std::exception& e)
+      {
+        result.errorMessage = e.what();
+      }
+      catch(...)
+      {
+        result.errorMessage = "Unknown exception";
+      }
+      SqlDatabase::removeDatabase(connectionName);
+      result.milliseconds = targetTimer.elapsed();
+
+      if(result.success)
+        qInfo() << "Batch compilation of" << result.databaseFile << "done in" << result.milliseconds << "ms";
+      else
+        qWarning() << "Batch compilation of" << result.databaseFile << "failed after" << result.milliseconds
+                   << "ms" << (result.aborted ? "aborted" : result.errorMessage);
+    }));
+  }
+  pool.waitForDone();
+
+  atools::fs::common::MagDecReader::setSharedCacheEnabled(false);
+
+  bool success = std::all_of(results.constBegin(), results.constEnd(),
+                             [](const NavDatabaseBatchResult& result) -> bool {
+    return result.success;
+  });
+
+  qInfo() << "Batch compilation of" << targets.size() << "databases took" << timer.elapsed() << "ms"
+          << (success ? "" : "with errors");
+  return success;
+}
+
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,85 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_NAVDATABASEBATCH_H
+#define ATOOLS_FS_NAVDATABASEBATCH_H
+
+#include <QString>
+#include <QVector>
+
+namespace atools {
+namespace fs {
+
+class NavDatabaseOptions;
+class NavDatabaseErrors;
+
+/* Result of one database compiled by NavDatabaseBatch */
+struct NavDatabaseBatchResult
+{
+  QString databaseFile;
+  bool success = false, aborted = false;
+  QString errorMessage; // Exception message if failed
+  qint64 milliseconds = 0;
+};
+
+/*
+ * Compiles several databases at the same time, e.g. for all simulators. Each target runs NavDatabase::create()
+ * in its own thread with its own database connection while all parallel steps of the targets share one task
+ * scheduler. Parsed SQL resource scripts and magnetic declination grids are shared between the targets.
+ *
+ * Progress callbacks of the options are called from the thread of the respective target.
+ * Tracing is process wide and should be enabled for one target only.
+ */
+class NavDatabaseBatch
+{
+public:
+  /* Number of scheduler threads is QThread::idealThreadCount() if numThreads < 1 */
+  explicit NavDatabaseBatch(const QString& revision = QString(), int numThreads = 0);
+
+  /* Add a database to compile. Options and errors have to be valid until create() returns. An existing database
+   * file is overwritten. */
+  void addTarget(const atools::fs::NavDatabaseOptions *options, const QString& databaseFile,
+                 atools::fs::NavDatabaseErrors *errors = nullptr, const QString& sceneryConfigCodec = QString());
+
+  /* Compile all targets. Up to maxConcurrentTargets run at the same time or all if < 1.
+   * Exceptions are caught and stored in the results. Returns true if all targets were successful. */
+  bool create(int maxConcurrentTargets = 0);
+
+  /* Results in order of addTarget() */
+  const QVector<atools::fs::NavDatabaseBatchResult>& getResults() const
+  {
+    return results;
+  }
+
+private:
+  struct Target
+  {
+    const atools::fs::NavDatabaseOptions *options;
+    QString databaseFile, codec;
+    atools::fs::NavDatabaseErrors *errors;
+  };
+
+  QVector<Target> targets;
+  QVector<atools::fs::NavDatabaseBatchResult> results;
+  QString gitRevision;
+  int threads;
+};
+
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_NAVDATABASEBATCH_H
@@ -24,6 +24,9 @@
 #include <QRegExp>
 #include <QDir>
 #include <QSettings>
+#include <QThread>
+
+#include <algorithm>
 
 namespace atools {
 namespace fs {
@@ -42,6 +45,31 @@ NavDatabaseOptions::ProgressCallbackType NavDatabaseOptions::getProgressCallback
   return progressCallback;
 }
 
+int NavDatabaseOptions::getNumThreads() const
+{
+  if(numThreads > 0)
+    return numThreads;
+  else
+    return std::max(QThread::idealThreadCount(), 1);
+}
+
+NavDatabaseOptions NavDatabaseOptions::copyForThread() const
+{
+  NavDatabaseOptions retval(*this);
+
+  // Create new regular expression objects in all lists
+  for(QList<QRegExp> *list : {&retval.fileFiltersInc, &retval.pathFiltersInc, &retval.addonFiltersInc,
+                              &retval.airportIcaoFiltersInc, &retval.fileFiltersExcl, &retval.pathFiltersExcl,
+                              &retval.addonFiltersExcl, &retval.airportIcaoFiltersExcl,
+                              &retval.highPriorityFiltersInc, &retval.dirExcludesGui,
+                              &retval.filePathExcludesGui, &retval.addonDirExcludes})
+  {
+    for(QRegExp& regexp : *list)
+      regexp = QRegExp(regexp.pattern(), regexp.caseSensitivity(), regexp.patternSyntax());
+  }
+  return retval;
+}
+
 void NavDatabaseOptions::addToDirectoryExcludes(const QStringList& filter)
 {
   addToFilter(createFilterList(filter), dirExcludesGui);
@@ -216,6 +244,31 @@ void NavDatabaseOptions::loadFromSettings(QSettings& settings)
   setFlag(type::VACUUM_DATABASE, settings.value("Options/VacuumDatabase", true).toBool());
   setFlag(type::ANALYZE_DATABASE, settings.value("Options/AnalyzeDatabase", true).toBool());
   setFlag(type::DROP_INDEXES, settings.value("Options/DropAllIndexes", false).toBool());
+  setFlag(type::READ_PARALLEL, settings.value("Options/ReadParallel", false).toBool());
+  setNumThreads(settings.value("Options/NumThreads", 0).toInt());
+  setInsertBatchSize(settings.value("Options/InsertBatchSize", 100).toInt());
+  setFlag(type::INCREMENTAL, settings.value("Options/Incremental", false).toBool());
+  setFlag(type::INCREMENTAL_HASH, settings.value("Options/IncrementalHash", false).toBool());
+  setFlag(type::BULK_LOAD, settings.value("Options/BulkLoad", false).toBool());
+  setFlag(type::DEFERRED_DELETE, settings.value("Options/DeferredDelete", false).toBool());
+  setFlag(type::DEDUPLICATE_FILES, settings.value("Options/DeduplicateFiles", false).toBool());
+  setFlag(type::DEDUPLICATE_ON_WRITE, settings.value("Options/DeduplicateOnWrite", false).toBool());
+  setFlag(type::PACKED_GEOMETRY, settings.value("Options/PackedGeometry", false).toBool());
+  setFlag(type::SPATIAL_INDEX, settings.value("Options/SpatialIndex", false).toBool());
+  setFlag(type::FULL_TEXT_SEARCH, settings.value("Options/FullTextSearch", false).toBool());
+  setFlag(type::BOUNDARY_LOD, settings.value("Options/BoundaryLevelOfDetail", false).toBool());
+  setFlag(type::READ_PREFETCH, settings.value("Options/ReadPrefetch", false).toBool());
+  setFlag(type::DATABASE_REPORT_DEEP, settings.value("Options/DatabaseReportDeep", false).toBool());
+  setFlag(type::COMPACT_EXPORT, settings.value("Options/CompactExport", false).toBool());
+  setFlag(type::RESUME, settings.value("Options/Resume", false).toBool());
+  setFlag(type::PROCEDURE_LEG_GEOMETRY, settings.value("Options/ProcedureLegGeometry", false).toBool());
+  setHilbertOrder(settings.value("Options/HilbertOrder", false).toBool());
+  setTimingReportFile(settings.value("Options/TimingReportFile").toString());
+  setTraceFile(settings.value("Options/TraceFile").toString());
+  setMemorySoftLimitMb(settings.value("Options/MemorySoftLimitMb", 0).toInt());
+  setMapTileMaxZoom(settings.value("Options/MapTileMaxZoom", -1).toInt());
+  setCompileInMemoryLimitMb(settings.value("Options/CompileInMemoryLimitMb", 0).toInt());
+  setRouteGraphFile(settings.value("Options/RouteGraphFile").toString());
 
   addToHighPriorityFiltersInc(settings.value("Filter/IncludeHighPriorityFilter").toStringList());
 
@@ -321,6 +374,11 @@ QDebug operator<<(QDebug out, const NavDatabaseOptions& opts)
 {
   QDebugStateSaver saver(out);
   out.nospace().noquote() << "Options[flags " << opts.flags;
+  out << ", threads " << opts.numThreads;
+  out << ", insert batch " << opts.insertBatchSize;
+  out << ", map tile zoom " << opts.mapTileMaxZoom;
+  out << ", in memory limit " << opts.compileInMemoryLimitMb;
+  out << ", hilbert order " << opts.hilbertOrder;
 
   out << ", Include file filter [";
   for(const QRegExp& f : opts.fileFiltersInc)
@@ -372,17 +430,28 @@ QDebug operator<<(QDebug out, const NavDatabaseOptions& opts)
     out << f.pattern() << ", ";
   out << "]";
 
+  out << ", Exclude file path filter [";
+  for(const QRegExp& f : opts.filePathExcludesGui)
+    out << f.pattern() << ", ";
+  out << "]";
+
   out << ", Exclude addon directory filter [";
   for(const QRegExp& f : opts.addonDirExcludes)
     out << f.pattern() << ", ";
   out << "]";
 
+  // Sort sets to get the same output in each process for the options hashes
+  QList<type::NavDbObjectType> types = opts.navDbObjectTypeFiltersInc.toList();
+  std::sort(types.begin(), types.end());
   out << ", Include type filter [";
-  for(type::NavDbObjectType type : opts.navDbObjectTypeFiltersInc)
+  for(type::NavDbObjectType type : types)
     out << type::navDbObjectTypeToString(type) << ", ";
   out << "]";
+
+  types = opts.navDbObjectTypeFiltersExcl.toList();
+  std::sort(types.begin(), types.end());
   out << ", Exclude type filter [";
-  for(type::NavDbObjectType type : opts.navDbObjectTypeFiltersExcl)
+  for(type::NavDbObjectType type : types)
     out << type::navDbObjectTypeToString(type) << ", ";
 
   out << "]";
@@ -136,7 +136,60 @@ enum OptionFlag
   ANALYZE_DATABASE = 1 << 13,
 
   /* Remove all indexes */
-  DROP_INDEXES = 1 << 14
+  DROP_INDEXES = 1 << 14,
+
+  /* Read BGL files in a pool of worker threads while writing to the database in file order.
+   * Used for FSX and P3D and for X-Plane apt.dat and CIFP files. Database content is identical to the serial mode. */
+  READ_PARALLEL = 1 << 15,
+
+  /* Compare size and modification time of all BGL or X-Plane dat files with the last compilation and
+   * leave the database untouched if nothing has changed. Not used for Navigraph. */
+  INCREMENTAL = 1 << 16,
+
+  /* Also compare a content hash in incremental mode */
+  INCREMENTAL_HASH = 1 << 17,
+
+  /* Apply the bulk load pragma profile during compilation and switch back to safe settings afterwards */
+  BULK_LOAD = 1 << 18,
+
+  /* Collect removal of stock airports replaced by add-on airports and run it with a few set based
+   * statements at the end of each scenery area */
+  DEFERRED_DELETE = 1 << 19,
+
+  /* Load BGL files having identical content in several scenery areas only once */
+  DEDUPLICATE_FILES = 1 << 20,
+
+  /* Detect duplicate navaids, waypoints and ILS in memory while writing instead of the post load script */
+  DEDUPLICATE_ON_WRITE = 1 << 21,
+
+  /* Write boundary, apron and fence geometry in the packed format. Needs a newer reader. */
+  PACKED_GEOMETRY = 1 << 22,
+
+  /* Create R*Tree spatial index tables for map objects after loading */
+  SPATIAL_INDEX = 1 << 23,
+
+  /* Create FTS5 full text search table for idents, names, regions and cities */
+  FULL_TEXT_SEARCH = 1 << 24,
+
+  /* Write simplified boundary geometries for lower zoom levels */
+  BOUNDARY_LOD = 1 << 25,
+
+  /* Read the next BGL file in one background thread while writing the current one */
+  READ_PREFETCH = 1 << 26,
+
+  /* Run duplicate, column value and coordinate range queries on all tables for the database report */
+  DATABASE_REPORT_DEEP = 1 << 27,
+
+  /* Write all tables into a new file and replace the database instead of VACUUM */
+  COMPACT_EXPORT = 1 << 28,
+
+  /* Continue an aborted compilation from the last checkpoint */
+  RESUME = 1 << 29,
+
+  /* Calculate and store the geometry of all procedure legs after loading */
+  PROCEDURE_LEG_GEOMETRY = 1 << 30
+
+  /* All bits are used. Add further options as separate members of NavDatabaseOptions. */
 };
 
 Q_DECLARE_FLAGS(OptionFlags, OptionFlag);
@@ -185,6 +238,60 @@ public:
     sourceDatabase = value;
   }
 
+  /*
+   * Write wall time, rows and bytes of all compilation stages as JSON to this file if not empty.
+   * Used to compare loader performance between releases.
+   */
+  void setTimingReportFile(const QString& value)
+  {
+    timingReportFile = value;
+  }
+
+  /*
+   * Record spans of compilation stages and threads and write them as Chrome trace event JSON to this file
+   * if not empty. See atools::util::TraceRecorder.
+   */
+  void setTraceFile(const QString& value)
+  {
+    traceFile = value;
+  }
+
+  /*
+   * Commit and shrink the SQLite cache at stage boundaries if resident process memory exceeds this value
+   * in MB. 0 disables the check.
+   */
+  void setMemorySoftLimitMb(int value)
+  {
+    memorySoftLimitMb = value;
+  }
+
+  /*
+   * Write pre-tiled map layers up to this zoom level into table map_tile after compilation.
+   * -1 disables tiles. See atools::fs::db::MapTileWriter.
+   */
+  void setMapTileMaxZoom(int value)
+  {
+    mapTileMaxZoom = value;
+  }
+
+  /*
+   * Compile into an in-memory database and write it to the database file in one sequential pass at the end.
+   * Compiles on disk if the estimated database size exceeds this value in MB. 0 disables in-memory compilation.
+   */
+  void setCompileInMemoryLimitMb(int value)
+  {
+    compileInMemoryLimitMb = value;
+  }
+
+  /*
+   * Export the route network tables into this binary graph file after compilation if not empty.
+   * Can be loaded with atools::fs::common::RouteGraph.
+   */
+  void setRouteGraphFile(const QString& value)
+  {
+    routeGraphFile = value;
+  }
+
   /*
    * Set verbose logging. This is only useful with small datasets. Default is false.
    */
@@ -218,6 +325,35 @@ public:
     flags.setFlag(type::DATABASE_REPORT, value);
   }
 
+  /*
+   * True: add SQL checks for duplicates, column values and coordinate ranges over all tables to the report.
+   * Otherwise the report uses statistics collected while writing. Default is false.
+   */
+  void setDatabaseReportDeep(bool value)
+  {
+    flags.setFlag(type::DATABASE_REPORT_DEEP, value);
+  }
+
+  /*
+   * True: copy all tables in rowid order into a new database file, create indexes afterwards and replace the
+   * database file. Gives the same result as VACUUM with less I/O. VacuumDatabase is ignored and AnalyzeDatabase
+   * is done on the new file. Not used for in-memory compilation which writes a compact file already.
+   */
+  void setCompactExport(bool value)
+  {
+    flags.setFlag(type::COMPACT_EXPORT, value);
+  }
+
+  /*
+   * True: continue an aborted compilation after the last step recorded in the metadata table. Does a full
+   * compilation if there is no checkpoint or it was saved using other options or scenery files.
+   * Checkpoints are always saved when compiling into the database file.
+   */
+  void setResume(bool value)
+  {
+    flags.setFlag(type::RESUME, value);
+  }
+
   /*
    * true: Filter out dummy runways that were created for ATC and traffic. Default is true.
    */
@@ -271,6 +407,112 @@ public:
     flags.setFlag(type::READ_ADDON_XML, value);
   }
 
+  /* Read BGL files in parallel using a thread pool */
+  void setReadParallel(bool value)
+  {
+    flags.setFlag(type::READ_PARALLEL, value);
+  }
+
+  /* Double buffered reading with one background thread which reads the next BGL file while the current
+   * one is written. Uses less memory and threads than ReadParallel. Ignored if ReadParallel is set. */
+  void setReadPrefetch(bool value)
+  {
+    flags.setFlag(type::READ_PREFETCH, value);
+  }
+
+  /* Skip compilation if no scenery file has changed since the last run */
+  void setIncremental(bool value)
+  {
+    flags.setFlag(type::INCREMENTAL, value);
+  }
+
+  /* Additionally compare file content hashes in incremental mode. Slower but catches files
+   * replaced with the same size and modification time. */
+  void setIncrementalHash(bool value)
+  {
+    flags.setFlag(type::INCREMENTAL_HASH, value);
+  }
+
+  /* Use fast but unsafe SQLite settings like exclusive locking and no sync while compiling.
+   * Safe settings are restored when compilation is finished. */
+  void setBulkLoad(bool value)
+  {
+    flags.setFlag(type::BULK_LOAD, value);
+  }
+
+  /* Remove or relink features of replaced airports at the end of each scenery area instead of
+   * for each airport. Database content is identical. */
+  void setDeferredDelete(bool value)
+  {
+    flags.setFlag(type::DEFERRED_DELETE, value);
+  }
+
+  /* Calculate a content hash for each BGL file when scanning. Later copies of a file are not read and only
+   * added to the file metadata. */
+  void setDeduplicateFiles(bool value)
+  {
+    flags.setFlag(type::DEDUPLICATE_FILES, value);
+  }
+
+  /* Replace duplicate navaids, waypoints and ILS when writing FSX/P3D scenery. Only airports and airway points
+   * are deduplicated by script afterwards. Needs deduplicate to be enabled. */
+  void setDeduplicateOnWrite(bool value)
+  {
+    flags.setFlag(type::DEDUPLICATE_ON_WRITE, value);
+  }
+
+  /* Store geometry blobs quantized and delta encoded. See BinaryGeometry::FORMAT_PACKED. */
+  void setPackedGeometry(bool value)
+  {
+    flags.setFlag(type::PACKED_GEOMETRY, value);
+  }
+
+  /* Create R*Tree tables for airports, navaids, airways, boundaries and parking. Ignored if the SQLite
+   * R*Tree module is not available. */
+  void setSpatialIndex(bool value)
+  {
+    flags.setFlag(type::SPATIAL_INDEX, value);
+  }
+
+  /* Create table nav_text_search for airports and navaids. Ignored if SQLite FTS5 is not available. */
+  void setFullTextSearch(bool value)
+  {
+    flags.setFlag(type::FULL_TEXT_SEARCH, value);
+  }
+
+  /* Fill table boundary_lod with simplified airspace geometries. See atools::fs::db::BoundaryLod. */
+  void setBoundaryLevelOfDetail(bool value)
+  {
+    flags.setFlag(type::BOUNDARY_LOD, value);
+  }
+
+  /* Fill tables approach_leg_geometry and transition_leg_geometry. See atools::fs::db::ProcedureGeometry. */
+  void setProcedureLegGeometry(bool value)
+  {
+    flags.setFlag(type::PROCEDURE_LEG_GEOMETRY, value);
+  }
+
+  /* Store airports, navaids, parking and boundaries in Hilbert curve order. See atools::fs::db::HilbertOrder.
+   * The file layout follows the new order after vacuum or compact export. */
+  void setHilbertOrder(bool value)
+  {
+    hilbertOrder = value;
+  }
+
+  /* Number of worker threads for parallel reading and for the shared task scheduler of the compilation.
+   * 0 or a negative value uses the number of CPU cores. */
+  void setNumThreads(int value)
+  {
+    numThreads = value;
+  }
+
+  /* Number of rows collected per table before they are written with one multi row insert statement.
+   * 1 or lower disables batching. Default is 100. */
+  void setInsertBatchSize(int value)
+  {
+    insertBatchSize = value;
+  }
+
   typedef std::function<bool (const atools::fs::NavDatabaseProgress&)> ProgressCallbackType;
 
   /* Set progress callback function/method */
@@ -300,6 +542,36 @@ public:
     return sourceDatabase;
   }
 
+  const QString& getTimingReportFile() const
+  {
+    return timingReportFile;
+  }
+
+  const QString& getTraceFile() const
+  {
+    return traceFile;
+  }
+
+  int getMemorySoftLimitMb() const
+  {
+    return memorySoftLimitMb;
+  }
+
+  int getMapTileMaxZoom() const
+  {
+    return mapTileMaxZoom;
+  }
+
+  int getCompileInMemoryLimitMb() const
+  {
+    return compileInMemoryLimitMb;
+  }
+
+  const QString& getRouteGraphFile() const
+  {
+    return routeGraphFile;
+  }
+
   bool isDeletes() const
   {
     return flags & type::DELETES;
@@ -340,6 +612,21 @@ public:
     return flags & type::DATABASE_REPORT;
   }
 
+  bool isDatabaseReportDeep() const
+  {
+    return flags & type::DATABASE_REPORT_DEEP;
+  }
+
+  bool isCompactExport() const
+  {
+    return flags & type::COMPACT_EXPORT;
+  }
+
+  bool isResume() const
+  {
+    return flags & type::RESUME;
+  }
+
   bool isVacuumDatabase() const
   {
     return flags & type::VACUUM_DATABASE;
@@ -380,6 +667,84 @@ public:
     return flags & type::READ_ADDON_XML;
   }
 
+  bool isReadParallel() const
+  {
+    return flags & type::READ_PARALLEL;
+  }
+
+  bool isReadPrefetch() const
+  {
+    return flags & type::READ_PREFETCH;
+  }
+
+  bool isIncremental() const
+  {
+    return flags & type::INCREMENTAL;
+  }
+
+  bool isIncrementalHash() const
+  {
+    return flags & type::INCREMENTAL_HASH;
+  }
+
+  bool isBulkLoad() const
+  {
+    return flags & type::BULK_LOAD;
+  }
+
+  bool isDeferredDelete() const
+  {
+    return flags & type::DEFERRED_DELETE;
+  }
+
+  bool isDeduplicateFiles() const
+  {
+    return flags & type::DEDUPLICATE_FILES;
+  }
+
+  bool isDeduplicateOnWrite() const
+  {
+    return (flags & type::DEDUPLICATE) && (flags & type::DEDUPLICATE_ON_WRITE);
+  }
+
+  bool isPackedGeometry() const
+  {
+    return flags & type::PACKED_GEOMETRY;
+  }
+
+  bool isSpatialIndex() const
+  {
+    return flags & type::SPATIAL_INDEX;
+  }
+
+  bool isFullTextSearch() const
+  {
+    return flags & type::FULL_TEXT_SEARCH;
+  }
+
+  bool isBoundaryLevelOfDetail() const
+  {
+    return flags & type::BOUNDARY_LOD;
+  }
+
+  bool isProcedureLegGeometry() const
+  {
+    return flags & type::PROCEDURE_LEG_GEOMETRY;
+  }
+
+  bool isHilbertOrder() const
+  {
+    return hilbertOrder;
+  }
+
+  /* Returns configured number of threads or number of CPU cores if not set */
+  int getNumThreads() const;
+
+  int getInsertBatchSize() const
+  {
+    return insertBatchSize;
+  }
+
   /* Pure file name */
   bool isIncludedFilename(const QString& filename) const;
 
@@ -430,6 +795,10 @@ public:
     basicValidationTables = value;
   }
 
+  /* Returns a deep copy of this object which can be used safely in another thread.
+   * QRegExp is not thread safe and the implicitly shared filter lists have to be detached. */
+  NavDatabaseOptions copyForThread() const;
+
 private:
   friend QDebug operator<<(QDebug out, const atools::fs::NavDatabaseOptions& opts);
 
@@ -456,7 +825,7 @@ private:
   QString fromNativeSeparator(const QString& path) const;
   QStringList createFilterList(const QStringList& pathList);
 
-  QString sceneryFile, basepath, sourceDatabase;
+  QString sceneryFile, basepath, sourceDatabase, timingReportFile, traceFile, routeGraphFile;
 
   atools::fs::type::OptionFlags flags;
 
@@ -471,6 +840,12 @@ private:
   ProgressCallbackType progressCallback = nullptr;
 
   atools::fs::FsPaths::SimulatorType simulatorType = atools::fs::FsPaths::FSX;
+
+  int numThreads = 0, insertBatchSize = 100, memorySoftLimitMb = 0, mapTileMaxZoom = -1,
+      compileInMemoryLimitMb = 0;
+
+  /* Separate from flags since all bits of OptionFlag are used */
+  bool hilbertOrder = false;
 };
 
 } // namespace fs
@@ -33,9 +33,10 @@ const QString BLUESPAN("<span style=\"color: #0000ff; font-weight:bold\">"), END
 const QString REDSPAN("<span style=\"color: #ff0000; font-weight:bold\">");
 
 NavServer::NavServer(QObject *parent, atools::fs::ns::NavServerOptions optionFlags, int inetPort)
-  : QTcpServer(parent), options(optionFlags), port(inetPort)
+  : QTcpServer(parent), options(optionFlags), port(inetPort), latencyStats("server")
 {
   qDebug("NavServer created");
+  qRegisterMetaType<atools::fs::ns::NavServerPacketPtr>();
 }
 
 NavServer::~NavServer()
@@ -51,6 +52,10 @@ void NavServer::stopServer()
   if(isListening())
     close();
 
+  if(dataReader != nullptr)
+    disconnect(dataReader, &atools::fs::sc::DataReaderThread::postSimConnectData, this,
+               &NavServer::postSimConnectData);
+
   // Stop all worker threads
   QSet<NavServerWorker *> workersCopy(workers);
   for(NavServerWorker *worker : workersCopy)
@@ -67,6 +72,10 @@ bool NavServer::startServer(atools::fs::sc::DataReaderThread *dataReaderThread)
   dataReader = dataReaderThread;
   qDebug() << "Navserver starting";
 
+  // Serialize in the reader thread context once for all workers
+  connect(dataReader, &atools::fs::sc::DataReaderThread::postSimConnectData, this,
+          &NavServer::postSimConnectData, Qt::DirectConnection);
+
   QStringList hostNameList, hostIpList;
   bool retval = listen(QHostAddress::AnyIPv4, static_cast<quint16>(port));
 
@@ -139,7 +148,7 @@ void NavServer::incomingConnection(qintptr socketDescriptor)
   qDebug() << "Incoming connection";
 
   // Create a worker and set name
-  NavServerWorker *worker = new NavServerWorker(socketDescriptor, nullptr, options);
+  NavServerWorker *worker = new NavServerWorker(socketDescriptor, nullptr, options, &latencyStats);
   worker->setObjectName("SocketWorker-" + QString::number(socketDescriptor));
 
   // Create new thread and move the worker into the thread context
@@ -154,9 +163,8 @@ void NavServer::incomingConnection(qintptr socketDescriptor)
           threadFinished(worker);
         });
 
-  // Data reader will send simconnect packages through this connection
-  connect(dataReader, &atools::fs::sc::DataReaderThread::postSimConnectData, worker,
-          &NavServerWorker::postSimConnectData);
+  // Server will send serialized simconnect packages through this connection
+  connect(this, &NavServer::postPacket, worker, &NavServerWorker::postPacket);
   connect(worker, &NavServerWorker::postWeatherRequest,
           dataReader, &atools::fs::sc::DataReaderThread::setWeatherRequest);
 
@@ -173,8 +181,7 @@ void NavServer::threadFinished(NavServerWorker *worker)
   // A thread has finished - lock the list so the thread can be removed from the list
   QMutexLocker locker(&threadsMutex);
 
-  disconnect(dataReader, &atools::fs::sc::DataReaderThread::postSimConnectData, worker,
-             &NavServerWorker::postSimConnectData);
+  disconnect(this, &NavServer::postPacket, worker, &NavServerWorker::postPacket);
 
   // TODO crashes when connected
   // disconnect(worker, &NavServerWorker::postCommand,
@@ -187,12 +194,52 @@ void NavServer::threadFinished(NavServerWorker *worker)
   worker->thread()->deleteLater();
 }
 
+void NavServer::postSimConnectData(atools::fs::sc::SimConnectData dataPacket)
+{
+  if(!hasConnections())
+    return;
+
+  QSharedPointer<NavServerPacket> packet(new NavServerPacket);
+  packet->packetId = dataPacket.getPacketId();
+  packet->weather = !dataPacket.getMetars().isEmpty();
+
+  if(packet->weather && dataPacket.getUserAircraftConst().getPosition().isValid())
+    qWarning() << "Aircraft and metar mixed";
+
+  // Full format for older clients and clients which missed the previous packet
+  packet->full = dataPacket.toByteArray();
+
+  if(!packet->weather)
+  {
+    // Weather packets have no aircraft and would remove all from the delta state
+    packet->delta = dataPacket.toByteArray(&deltaState);
+    packet->keyFrame = deltaState.isKeyFrame();
+    packet->sequence = ++sequence;
+  }
+
+  packet->postUs = atools::fs::sc::LatencyStats::nowUs();
+  if(dataPacket.getFetchEndUs() > 0 && !packet->weather)
+    // Not set for replays
+    latencyStats.addSample(atools::fs::sc::LATENCY_POST, packet->postUs - dataPacket.getFetchEndUs());
+
+  emit postPacket(packet);
+}
+
 bool NavServer::hasConnections() const
 {
   QMutexLocker locker(&threadsMutex);
   return workers.size() > 0;
 }
 
+QVector<NavServerClientStats> NavServer::getClientStats() const
+{
+  QMutexLocker locker(&threadsMutex);
+  QVector<NavServerClientStats> stats;
+  for(const NavServerWorker *worker : workers)
+    stats.append(worker->getStats());
+  return stats;
+}
+
 } // namespace ns
 } // namespace fs
 } // namespace atools
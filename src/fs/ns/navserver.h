@@ -19,6 +19,8 @@
 #define LITTLENAVCONNECT_NAVSERVER_H
 
 #include "fs/ns/navservercommon.h"
+#include "fs/sc/latencystats.h"
+#include "fs/sc/simconnectdata.h"
 
 #include <QMutex>
 #include <QTcpServer>
@@ -27,7 +29,6 @@ namespace atools {
 namespace fs {
 namespace sc {
 
-class SimConnectData;
 class DataReaderThread;
 }
 
@@ -52,24 +53,53 @@ public:
   /* true if any workers are in the list */
   bool hasConnections() const;
 
+  /* Socket queue depth and dropped packets for each connected client */
+  QVector<atools::fs::ns::NavServerClientStats> getClientStats() const;
+
   /* Need a stop/start to use new port */
   void setPort(int value)
   {
     port = value;
   }
 
+  /* Statistics for serialization, socket write, round trip and client stages of all connections.
+   * Use setLogIntervalSec() to get a periodic log line. Thread safe. */
+  atools::fs::sc::LatencyStats& getLatencyStats()
+  {
+    return latencyStats;
+  }
+
+  const atools::fs::sc::LatencyStats& getLatencyStats() const
+  {
+    return latencyStats;
+  }
+
+signals:
+  /* Sent to all workers for each serialized data packet */
+  void postPacket(atools::fs::ns::NavServerPacketPtr packet);
+
 private:
   void incomingConnection(qintptr socketDescriptor) override;
+
+  /* Called in the context of the data reader thread. Serializes the data once and sends it to all workers. */
+  void postSimConnectData(atools::fs::sc::SimConnectData dataPacket);
   void threadFinished(NavServerWorker *worker);
 
   atools::fs::ns::NavServerOptions options = NONE;
-  atools::fs::sc::DataReaderThread *dataReader;
+  atools::fs::sc::DataReaderThread *dataReader = nullptr;
 
   QSet<NavServerWorker *> workers;
   // Needed to lock for any modifications of the workers set
   mutable QMutex threadsMutex;
 
   int port = 51968;
+
+  /* Delta state for the packets sent to all clients - only used in the data reader thread */
+  atools::fs::sc::SimConnectDataDeltaState deltaState;
+  quint64 sequence = 0;
+
+  /* Shared by all workers */
+  atools::fs::sc::LatencyStats latencyStats;
 };
 
 } // namespace ns
@@ -19,6 +19,9 @@
 #define ATOOLS_NS_COMMON_H
 
 #include <QLoggingCategory>
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QString>
 
 namespace atools {
 namespace fs {
@@ -38,8 +41,45 @@ Q_DECLARE_OPERATORS_FOR_FLAGS(atools::fs::ns::NavServerOptions);
 /* Declare a own logging category to append in the text edit */
 Q_DECLARE_LOGGING_CATEGORY(gui);
 
+/* Data packet which is serialized once by NavServer and written by all workers. Not modified after creation. */
+struct NavServerPacket
+{
+  /* Full format which is understood by all clients */
+  QByteArray full;
+
+  /* Delta to the previous packet with aircraft. Empty for weather packets. */
+  QByteArray delta;
+
+  /* Counts packets with aircraft. Workers can send a delta only if they sent the previous packet. */
+  quint64 sequence = 0;
+
+  /* Monotonic timestamp of serialization from LatencyStats::nowUs() */
+  qint64 postUs = 0;
+  int packetId = 0;
+  bool keyFrame = false, weather = false;
+};
+
+typedef QSharedPointer<const atools::fs::ns::NavServerPacket> NavServerPacketPtr;
+
+/* Statistics for one client connection */
+struct NavServerClientStats
+{
+  QString peerAddress;
+
+  /* Current and maximum number of bytes waiting in the socket buffer */
+  qint64 bytesToWrite = 0, maxBytesToWrite = 0;
+
+  /* Packets not sent because of missing replies */
+  int droppedPackets = 0;
+
+  /* Packets replaced by a newer one while the socket buffer was full */
+  int coalescedPackets = 0;
+};
+
 } // namespace ns
 } // namespace fs
 } // namespace atools
 
+Q_DECLARE_METATYPE(atools::fs::ns::NavServerPacketPtr);
+
 #endif // ATOOLS_NS_COMMON_H
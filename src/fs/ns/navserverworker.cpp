@@ -20,17 +20,21 @@
 #include "fs/ns/navserverworker.h"
 #include "fs/ns/navservercommon.h"
 #include "fs/sc/simconnectreply.h"
+#include "fs/sc/latencystats.h"
 
 #include <QThread>
 #include <QTcpSocket>
 
+#include <algorithm>
+
 namespace atools {
 namespace fs {
 namespace ns {
 
 NavServerWorker::NavServerWorker(qintptr socketDescriptor, NavServer *parent,
-                                 atools::fs::ns::NavServerOptions optionFlags)
-  : QObject(parent), socketDescr(socketDescriptor), options(optionFlags)
+                                 atools::fs::ns::NavServerOptions optionFlags,
+                                 atools::fs::sc::LatencyStats *latency)
+  : QObject(parent), socketDescr(socketDescriptor), options(optionFlags), latencyStats(latency)
 {
   qDebug() << "NavServerWorker created" << QThread::currentThread()->objectName();
 }
@@ -49,6 +53,7 @@ void NavServerWorker::threadStarted()
     socket = new QTcpSocket();
     connect(socket, &QTcpSocket::disconnected, this, &NavServerWorker::socketDisconnected);
     connect(socket, &QTcpSocket::readyRead, this, &NavServerWorker::readyReadReplyFromSocket);
+    connect(socket, &QTcpSocket::bytesWritten, this, &NavServerWorker::socketBytesWritten);
   }
 
   if(!socket->setSocketDescriptor(socketDescr, QAbstractSocket::ConnectedState, QIODevice::ReadWrite))
@@ -60,6 +65,11 @@ void NavServerWorker::threadStarted()
   peerAddr = socket->peerAddress().toString();
   hostInfo = QHostInfo::fromName(peerAddr);
 
+  {
+    QMutexLocker locker(&statsMutex);
+    stats.peerAddress = peerAddr;
+  }
+
   qInfo(gui).noquote().nospace() << tr("Connection from %1 (%2).").arg(hostInfo.hostName()).arg(peerAddr);
 
   qDebug() << "NavServerWorker Connection from " << hostInfo.hostName() << " (" << peerAddr << ") "
@@ -71,6 +81,7 @@ void NavServerWorker::socketDisconnected()
   qInfo(gui).noquote().nospace() << tr("Connection from %1 (%2) closed.").
     arg(hostInfo.hostName()).arg(peerAddr);
 
+  pendingPacket.reset();
   socket->deleteLater();
   socket = nullptr;
   thread()->exit();
@@ -104,7 +115,15 @@ void NavServerWorker::readyReadReplyFromSocket()
     if(options & VERBOSE)
       qDebug() << "NavServerWorker readyReadReply packet id" << reply.getPacketId();
 
-    if(reply.getCommand() == atools::fs::sc::CMD_WEATHER_REQUEST)
+    if(reply.getCommand().testFlag(atools::fs::sc::CMD_DELTA_PROTOCOL) && !deltaProtocol)
+    {
+      // Client understands deltas - start with a full packet or key frame
+      qInfo() << "NavServerWorker using delta protocol for" << peerAddr;
+      deltaProtocol = true;
+      lastSequence = 0;
+    }
+
+    if(reply.getCommand().testFlag(atools::fs::sc::CMD_WEATHER_REQUEST))
     {
       if(options & VERBOSE)
         qDebug() << "NavServerWorker::readyReadReply got weather request";
@@ -119,61 +138,142 @@ void NavServerWorker::readyReadReplyFromSocket()
                  << "last ids" << lastPacketIds;
 
       // Normal reply - remove id from sent list
-      lastPacketIds.remove(reply.getPacketId());
+      qint64 writeUs = lastPacketIds.take(reply.getPacketId());
+      if(writeUs > 0)
+      {
+        qint64 roundTripUs = atools::fs::sc::LatencyStats::nowUs() - writeUs;
+        latencyStats->addSample(atools::fs::sc::LATENCY_ROUND_TRIP, roundTripUs);
+
+        if(reply.getCommand().testFlag(atools::fs::sc::CMD_LATENCY_REPORT))
+        {
+          // Client measured its processing time - the rest is network transfer in both directions
+          latencyStats->addSample(atools::fs::sc::LATENCY_CLIENT, reply.getClientDelayUs());
+          latencyStats->addSample(atools::fs::sc::LATENCY_NETWORK,
+                                  std::max(Q_INT64_C(0), roundTripUs - reply.getClientDelayUs()));
+        }
+      }
     }
   }
   if(options & VERBOSE)
     qDebug() << "NavServerWorker::readyReadReply leave";
 }
 
-void NavServerWorker::postSimConnectData(atools::fs::sc::SimConnectData dataPacket)
+void NavServerWorker::postPacket(atools::fs::ns::NavServerPacketPtr packet)
 {
   if(options & VERBOSE)
-    qDebug() << "NavServerWorker postSimConnectData" << QThread::currentThread()->objectName()
+    qDebug() << "NavServerWorker postPacket" << QThread::currentThread()->objectName()
              << "last ids" << lastPacketIds;
 
-  if(!dataPacket.getMetars().isEmpty())
+  if(lastPacketIds.size() > 1 && packet->packetId > 0)
   {
-    if(options & VERBOSE)
-      qDebug() << "NavServerWorker::postSimConnectData metars num " << dataPacket.getMetars().size();
-
-    if(dataPacket.getUserAircraftConst().getPosition().isValid())
-      qWarning() << "Aircraft and metar mixed";
+    // No reply received in the meantime - count it as dropped package and do not send a new package
+    handleDroppedPackages(tr("Missing reply"));
+    return;
   }
 
-  if(lastPacketIds.size() > 1 && dataPacket.getPacketId() > 0)
+  if(!packet->weather && socket->bytesToWrite() > MAX_BYTES_TO_WRITE)
   {
-    // No reply received in the meantime - count it as dropped package and do not send a new package
-    handleDroppedPackages(tr("Missing reply"));
+    // Client cannot keep up and the socket buffer is filling - keep only the newest packet
+    // which is sent once the buffer drains
+    if(pendingPacket.isNull())
+      qInfo() << "NavServerWorker client" << peerAddr << "is slow. Bytes to write" << socket->bytesToWrite();
+    else
+    {
+      QMutexLocker locker(&statsMutex);
+      stats.coalescedPackets++;
+    }
+
+    pendingPacket = packet;
+    updateQueueStats();
     return;
   }
 
+  writePacket(packet);
+}
+
+void NavServerWorker::socketBytesWritten()
+{
+  if(!pendingPacket.isNull() && socket->bytesToWrite() <= MAX_BYTES_TO_WRITE)
+  {
+    // Buffer drained - send newest packet. Sends a full packet if deltas were skipped.
+    NavServerPacketPtr packet = pendingPacket;
+    pendingPacket.reset();
+    writePacket(packet);
+  }
+  else
+    updateQueueStats();
+}
+
+atools::fs::ns::NavServerClientStats NavServerWorker::getStats() const
+{
+  QMutexLocker locker(&statsMutex);
+  return stats;
+}
+
+void NavServerWorker::updateQueueStats()
+{
+  qint64 bytesToWrite = socket != nullptr ? socket->bytesToWrite() : 0;
+
+  QMutexLocker locker(&statsMutex);
+  stats.bytesToWrite = bytesToWrite;
+  stats.maxBytesToWrite = std::max(stats.maxBytesToWrite, bytesToWrite);
+}
+
+void NavServerWorker::writePacket(atools::fs::ns::NavServerPacketPtr packet)
+{
   if(inPost)
     // We're already posting
     qCritical() << "Nested post";
 
-  if(dataPacket.getPacketId() > 0)
+  if(packet->packetId > 0)
     // Insert packet id in sent list if this is not a weather request
-    lastPacketIds.insert(dataPacket.getPacketId());
+    lastPacketIds.insert(packet->packetId, 0);
 
   inPost = true;
 
-  int written;
-  written = dataPacket.write(socket);
-  if(dataPacket.getStatus() != atools::fs::sc::OK)
-    qWarning(gui).noquote().nospace() << tr("Error writing data: %1.").arg(dataPacket.getStatusText());
+  // Deltas refer to the previous packet - send full packet if it was dropped
+  const QByteArray *block = &packet->full;
+  if(!packet->weather)
+  {
+    if(deltaProtocol && (packet->keyFrame || (lastSequence > 0 && packet->sequence == lastSequence + 1)))
+      block = &packet->delta;
+    lastSequence = packet->sequence;
+  }
+
+  atools::fs::sc::SimConnectStatus status = atools::fs::sc::OK;
+  int written = atools::fs::sc::SimConnectDataBase::writeBlock(socket, *block, status);
+  if(status != atools::fs::sc::OK)
+    qWarning(gui).noquote().nospace() << tr("Error writing data: %1.").
+      arg(atools::fs::sc::SimConnectDataBase::statusText(status));
 
   if(!socket->flush())
     qWarning() << "NavServerWorker Reply to client not flushed";
 
+  if(status == atools::fs::sc::OK && packet->packetId > 0)
+  {
+    qint64 writeUs = atools::fs::sc::LatencyStats::nowUs();
+    latencyStats->addSample(atools::fs::sc::LATENCY_WRITE, writeUs - packet->postUs);
+
+    // Remember for round trip - list might have been cleared due to dropped packages
+    if(lastPacketIds.contains(packet->packetId))
+      lastPacketIds.insert(packet->packetId, writeUs);
+  }
+
+  updateQueueStats();
+
   if(options & VERBOSE)
-    qDebug() << "NavServerWorker written" << written << "flush" << flush << "id" << dataPacket.getPacketId();
+    qDebug() << "NavServerWorker written" << written << "id" << packet->packetId;
 
   inPost = false;
 }
 
 void NavServerWorker::handleDroppedPackages(const QString& reason)
 {
+  {
+    QMutexLocker locker(&statsMutex);
+    stats.droppedPackets++;
+  }
+
   droppedPackages++;
   if(droppedPackages > MAX_DROPPED_PACKAGES)
   {
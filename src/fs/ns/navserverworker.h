@@ -24,7 +24,8 @@
 #include "fs/ns/navservercommon.h"
 
 #include <QHostInfo>
-#include <QSet>
+#include <QHash>
+#include <QMutex>
 
 class QTcpSocket;
 
@@ -33,6 +34,13 @@ namespace fs {
 namespace ns {
 
 class NavServer;
+}
+
+namespace sc {
+class LatencyStats;
+}
+
+namespace ns {
 
 /* Worker for threads that are spawned for each incoming connection. Worker approach is used to ensure that
  * singals to this object are using this thread's context. */
@@ -42,11 +50,17 @@ class NavServerWorker :
   Q_OBJECT
 
 public:
-  NavServerWorker(qintptr socketDescriptor, NavServer *parent, atools::fs::ns::NavServerOptions optionFlags);
+  /* Latency samples are added to latency which has to outlive the worker */
+  NavServerWorker(qintptr socketDescriptor, NavServer *parent, atools::fs::ns::NavServerOptions optionFlags,
+                  atools::fs::sc::LatencyStats *latency);
   virtual ~NavServerWorker();
 
-  /* Receives sim connect data from DataReader thread and writes to socket. */
-  void postSimConnectData(atools::fs::sc::SimConnectData dataPacket);
+  /* Receives serialized sim connect data from NavServer and writes to socket. If the socket buffer of a slow
+   * client exceeds MAX_BYTES_TO_WRITE only the newest packet is kept and sent once the buffer drains. */
+  void postPacket(atools::fs::ns::NavServerPacketPtr packet);
+
+  /* Queue and drop statistics. Can be called from any thread. */
+  atools::fs::ns::NavServerClientStats getStats() const;
 
   /* Signal posted by thread to indicate it has started . */
   void threadStarted();
@@ -62,13 +76,21 @@ private:
   /* Read reply from remote end. */
   void readyReadReplyFromSocket();
 
+  /* Send pending packet if the socket buffer drained */
+  void socketBytesWritten();
+
+  void writePacket(atools::fs::ns::NavServerPacketPtr packet);
+  void updateQueueStats();
+
   /* Count dropped packages and write a message if too many accumulated. */
   void handleDroppedPackages(const QString& reason);
 
   const int MAX_DROPPED_PACKAGES = 50;
 
+  /* Packets are coalesced if more than this is waiting in the socket buffer */
+  const qint64 MAX_BYTES_TO_WRITE = 256 * 1024;
+
   qintptr socketDescr;
-  atools::fs::sc::SimConnectData data;
   QTcpSocket *socket = nullptr;
 
   atools::fs::ns::NavServerOptions options = NONE;
@@ -77,8 +99,21 @@ private:
   int droppedPackages = 0;
   bool inPost = false;
 
-  /* Add packet id on send and remove when reply is received */
-  QSet<int> lastPacketIds;
+  /* Set when the client requested the delta protocol in a reply */
+  bool deltaProtocol = false;
+
+  /* Newest packet which was held back due to a full socket buffer */
+  atools::fs::ns::NavServerPacketPtr pendingPacket;
+
+  atools::fs::ns::NavServerClientStats stats;
+  mutable QMutex statsMutex;
+
+  /* Sequence number of the last sent packet with aircraft. 0 if none was sent. */
+  quint64 lastSequence = 0;
+
+  /* Add packet id and write timestamp on send and remove when reply is received */
+  QHash<int, qint64> lastPacketIds;
+  atools::fs::sc::LatencyStats *latencyStats;
   QString peerAddr;
   QHostInfo hostInfo;
 
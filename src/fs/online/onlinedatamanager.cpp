@@ -19,6 +19,7 @@
 
 #include "fs/online/statustextparser.h"
 #include "fs/online/whazzuptextparser.h"
+#include "fs/online/onlineindex.h"
 
 #include "sql/sqlquery.h"
 #include "sql/sqltransaction.h"
@@ -45,6 +46,8 @@ OnlinedataManager::OnlinedataManager(sql::SqlDatabase *sqlDb)
   status = new StatusTextParser;
   whazzup = new WhazzupTextParser(db);
   whazzupServers = new WhazzupTextParser(db);
+  clientIndex = new OnlineIndex;
+  atcIndex = new OnlineIndex;
 }
 
 OnlinedataManager::~OnlinedataManager()
@@ -52,6 +55,8 @@ OnlinedataManager::~OnlinedataManager()
   delete status;
   delete whazzup;
   delete whazzupServers;
+  delete clientIndex;
+  delete atcIndex;
 }
 
 bool OnlinedataManager::readFromWhazzup(const QString& whazzupTxt, atools::fs::online::Format format,
@@ -60,12 +65,90 @@ bool OnlinedataManager::readFromWhazzup(const QString& whazzupTxt, atools::fs::o
   SqlTransaction transaction(db);
   bool retval = whazzup->read(whazzupTxt, format, lastUpdate);
   if(retval)
+  {
     transaction.commit();
+    updateIndexes();
+  }
   else
     transaction.rollback();
   return retval;
 }
 
+void OnlinedataManager::updateIndexes()
+{
+  const OnlineChanges& changes = whazzup->getChanges();
+
+  if(changes.isEmpty() || changes.full)
+  {
+    // Not in diff mode or tables rebuilt - load all
+    QVector<OnlineIndexEntry> entries;
+    SqlQuery clientQuery("select * from client", db);
+    clientQuery.exec();
+    while(clientQuery.next())
+      entries.append(indexEntry(clientQuery.record(), false /* isAtc */));
+    clientIndex->reset(entries);
+
+    entries.clear();
+    SqlQuery atcQuery("select * from atc", db);
+    atcQuery.exec();
+    while(atcQuery.next())
+      entries.append(indexEntry(atcQuery.record(), true /* isAtc */));
+    atcIndex->reset(entries);
+  }
+  else
+  {
+    // Load only changed rows
+    QVector<OnlineIndexEntry> entries;
+    SqlQuery clientQuery("select * from client where client_id = :id", db);
+    for(int id : changes.addedClients + changes.updatedClients)
+    {
+      clientQuery.bindValue(":id", id);
+      clientQuery.exec();
+      if(clientQuery.next())
+        entries.append(indexEntry(clientQuery.record(), false /* isAtc */));
+    }
+    clientIndex->update(entries, changes.removedClients);
+
+    entries.clear();
+    SqlQuery atcQuery("select * from atc where atc_id = :id", db);
+    for(int id : changes.addedAtc + changes.updatedAtc)
+    {
+      atcQuery.bindValue(":id", id);
+      atcQuery.exec();
+      if(atcQuery.next())
+        entries.append(indexEntry(atcQuery.record(), true /* isAtc */));
+    }
+    atcIndex->update(entries, changes.removedAtc);
+  }
+}
+
+void OnlinedataManager::clearIndexes()
+{
+  clientIndex->clear();
+  atcIndex->clear();
+}
+
+OnlineIndexEntry OnlinedataManager::indexEntry(const SqlRecord& record, bool isAtc)
+{
+  OnlineIndexEntry entry;
+  entry.id = record.valueInt(isAtc ? "atc_id" : "client_id");
+  entry.callsign = record.valueStr("callsign");
+  entry.pos = atools::geo::Pos(record.valueFloat("lonx"), record.valueFloat("laty"));
+
+  if(isAtc)
+  {
+    // Circle radius and bounding are already adjusted by the ATC sizes of the parser
+    entry.radiusNm = record.valueFloat("radius");
+    entry.bounding = atools::geo::Rect(record.valueFloat("min_lonx"), record.valueFloat("max_laty"),
+                                       record.valueFloat("max_lonx"), record.valueFloat("min_laty"));
+  }
+  else
+    entry.bounding = atools::geo::Rect(entry.pos);
+
+  entry.record = record;
+  return entry;
+}
+
 bool OnlinedataManager::readServersFromWhazzup(const QString& whazzupTxt, Format format, const QDateTime& lastUpdate)
 {
   SqlTransaction transaction(db);
@@ -131,6 +214,8 @@ void OnlinedataManager::createSchema()
 
   script.executeScript(":/atools/resources/sql/fs/online/create_online_schema.sql");
   transaction.commit();
+  whazzup->clearDiffState();
+  clearIndexes();
 }
 
 void OnlinedataManager::clearData()
@@ -140,6 +225,8 @@ void OnlinedataManager::clearData()
   for(const QString& table : tables)
     db->exec("delete from " + table);
   transaction.commit();
+  whazzup->clearDiffState();
+  clearIndexes();
 }
 
 void OnlinedataManager::dropSchema()
@@ -151,6 +238,8 @@ void OnlinedataManager::dropSchema()
 
   script.executeScript(":/atools/resources/sql/fs/online/drop_online_schema.sql");
   transaction.commit();
+  whazzup->clearDiffState();
+  clearIndexes();
 }
 
 void OnlinedataManager::reset()
@@ -176,36 +265,25 @@ void OnlinedataManager::getClientAircraftById(atools::fs::sc::SimConnectAircraft
 
 sql::SqlRecord OnlinedataManager::getClientRecordById(int clientId)
 {
-  SqlQuery query(db);
-  query.prepare("select * from client where client_id = :id");
-  query.bindValue(":id", clientId);
-  query.exec();
-  SqlRecord rec;
-  if(query.next())
-    rec = query.record();
-  query.finish();
-  return rec;
+  // Called often for tooltips and map display
+  OnlineIndexEntry entry;
+  if(clientIndex->getById(clientId, entry))
+    return entry.record;
+  else
+    return SqlRecord();
 }
 
 sql::SqlRecordVector OnlinedataManager::getClientRecordsByCallsign(const QString& callsign)
 {
-  SqlQuery query(db);
-  query.prepare("select * from client where callsign = :callsign");
-  query.bindValue(":callsign", callsign);
-  query.exec();
   sql::SqlRecordVector recs;
-  while(query.next())
-    recs.append(query.record());
+  for(const OnlineIndexEntry& entry : clientIndex->getByCallsign(callsign))
+    recs.append(entry.record);
   return recs;
 }
 
 void OnlinedataManager::getClientCallsignAndPosMap(QHash<QString, geo::Pos>& clientMap)
 {
-  clientMap.clear();
-  SqlQuery query("select callsign, lonx, laty from client", db);
-  query.exec();
-  while(query.next())
-    clientMap.insert(query.valueStr("callsign"), atools::geo::Pos(query.valueFloat("lonx"), query.valueFloat("laty")));
+  clientIndex->getCallsignAndPosMap(clientMap);
 }
 
 int OnlinedataManager::getNumClients() const
@@ -218,6 +296,16 @@ void OnlinedataManager::setAtcSize(const QHash<fac::FacilityType, int>& value)
   whazzup->setAtcSize(value);
 }
 
+void OnlinedataManager::setDiffMode(bool value)
+{
+  whazzup->setDiffMode(value);
+}
+
+const OnlineChanges& OnlinedataManager::getChanges() const
+{
+  return whazzup->getChanges();
+}
+
 void OnlinedataManager::fillFromClient(sc::SimConnectAircraft& ac, const sql::SqlRecord& record)
 {
   if(record.valueBool("prefile") || record.valueStr("client_type") != "PILOT")
@@ -239,7 +327,7 @@ void OnlinedataManager::fillFromClient(sc::SimConnectAircraft& ac, const sql::Sq
   ac.numberOfEngines = 0;
 
   ac.objectId = static_cast<quint32>(record.valueInt("client_id"));
-  ac.airplaneReg = record.valueStr("callsign");
+  ac.strings->airplaneReg = record.valueStr("callsign");
 
   // record.valueStr("vid");
   // record.valueStr("name");
@@ -253,15 +341,15 @@ void OnlinedataManager::fillFromClient(sc::SimConnectAircraft& ac, const sql::Sq
   // ac.airplaneFlightnumber,
 
   ac.groundSpeedKts = record.valueFloat("groundspeed");
-  ac.airplaneType = record.valueStr("flightplan_aircraft");
+  ac.strings->airplaneType = record.valueStr("flightplan_aircraft");
 
   // record.valueStr("flightplan_cruising_speed");
 
-  ac.fromIdent = record.valueStr("flightplan_departure_aerodrome");
+  ac.strings->fromIdent = record.valueStr("flightplan_departure_aerodrome");
 
   // record.valueStr("flightplan_cruising_level");
 
-  ac.toIdent = record.valueStr("flightplan_destination_aerodrome");
+  ac.strings->toIdent = record.valueStr("flightplan_destination_aerodrome");
 
   // record.valueStr("server");
   // record.valueStr("protocol");
@@ -45,6 +45,8 @@ namespace online {
 
 class StatusTextParser;
 class WhazzupTextParser;
+class OnlineIndex;
+struct OnlineIndexEntry;
 
 /*
  * Facade for online classes that parse whazzup.txt and status.txt files for IVAO, VATSIM or other muultiplayer
@@ -53,6 +55,8 @@ class WhazzupTextParser;
  * All content from whazzup.txt is written into the given database.
  *
  * Check for schema and create this before reading.
+ *
+ * Clients and ATC stations are additionally kept in memory indexes which are updated after each read.
  */
 class OnlinedataManager
 {
@@ -127,13 +131,14 @@ public:
   /* Get aircraft from table client by id and fill data into aircraft class. */
   void getClientAircraftById(atools::fs::sc::SimConnectAircraft& aircraft, int clientId);
 
-  /* Get all rows for a client_id */
+  /* Get all rows for a client_id. Uses the client index. */
   atools::sql::SqlRecord getClientRecordById(int clientId);
 
-  /* Get all rows for clients that match the callsign. Normally only one. */
+  /* Get all rows for clients that match the callsign. Normally only one. Uses the client index. */
   atools::sql::SqlRecordVector getClientRecordsByCallsign(const QString& callsign);
 
-  /* Fill the map with callsign as key and position as value. Used for online/simulator deduplication. */
+  /* Fill the map with callsign as key and position as value. Used for online/simulator deduplication.
+   * Uses the client index. */
   void getClientCallsignAndPosMap(QHash<QString, geo::Pos>& clientMap);
 
   /* Number of client aircraft in client table */
@@ -142,12 +147,36 @@ public:
   /* Set default circle radii for certain ATC types where visual range is unusable */
   void setAtcSize(const QHash<atools::fs::online::fac::FacilityType, int>& value);
 
+  /* Update client and atc tables incrementally on each whazzup read. See WhazzupTextParser::setDiffMode(). */
+  void setDiffMode(bool value);
+
+  /* Client and atc ids added, updated or removed by the last successful readFromWhazzup() in diff mode */
+  const atools::fs::online::OnlineChanges& getChanges() const;
+
+  /* In-memory index of table client for rectangle, nearest and callsign queries. Can be used from any thread. */
+  const atools::fs::online::OnlineIndex& getClientIndex() const
+  {
+    return *clientIndex;
+  }
+
+  /* In-memory index of table atc including coverage circles. Can be used from any thread. */
+  const atools::fs::online::OnlineIndex& getAtcIndex() const
+  {
+    return *atcIndex;
+  }
+
 private:
+  /* Update indexes from the tables using the changes of the last read if available */
+  void updateIndexes();
+  void clearIndexes();
+  static atools::fs::online::OnlineIndexEntry indexEntry(const atools::sql::SqlRecord& record, bool isAtc);
+
   atools::sql::SqlDatabase *db;
 
   atools::fs::online::WhazzupTextParser *whazzup = nullptr;
   atools::fs::online::WhazzupTextParser *whazzupServers = nullptr;
   atools::fs::online::StatusTextParser *status = nullptr;
+  atools::fs::online::OnlineIndex *clientIndex = nullptr, *atcIndex = nullptr;
 
 };
 
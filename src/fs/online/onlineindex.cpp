@@ -0,0 +1,291 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/online/onlineindex.h"
+
+#include "geo/calculations.h"
+
+#include <QSet>
+
+#include <algorithm>
+#include <cmath>
+
+namespace atools {
+namespace fs {
+namespace online {
+
+/* Size of a grid cell in degrees */
+const static float CELL_SIZE_DEG = 2.f;
+const static int GRID_COLUMNS = static_cast<int>(360.f / CELL_SIZE_DEG);
+const static int GRID_ROWS = static_cast<int>(180.f / CELL_SIZE_DEG);
+
+/* Lower bound for the length of one degree */
+const static float MIN_METER_PER_DEG = atools::geo::nmToMeter(60.f) * 0.99f;
+
+OnlineIndex::OnlineIndex()
+{
+
+}
+
+void OnlineIndex::clear()
+{
+  QWriteLocker locker(&lock);
+  entries.clear();
+  callsignIndex.clear();
+  grid.clear();
+}
+
+void OnlineIndex::reset(const QVector<OnlineIndexEntry>& newEntries)
+{
+  QWriteLocker locker(&lock);
+  entries.clear();
+  callsignIndex.clear();
+  grid.clear();
+
+  entries.reserve(newEntries.size());
+  for(const OnlineIndexEntry& entry : newEntries)
+    insertInternal(entry);
+}
+
+void OnlineIndex::update(const QVector<OnlineIndexEntry>& updatedEntries, const QVector<int>& removedIds)
+{
+  QWriteLocker locker(&lock);
+  for(int id : removedIds)
+    removeInternal(id);
+
+  for(const OnlineIndexEntry& entry : updatedEntries)
+    insertInternal(entry);
+}
+
+bool OnlineIndex::getById(int id, OnlineIndexEntry& entry) const
+{
+  QReadLocker locker(&lock);
+  auto it = entries.constFind(id);
+  if(it != entries.constEnd())
+  {
+    entry = it.value();
+    return true;
+  }
+  return false;
+}
+
+QVector<OnlineIndexEntry> OnlineIndex::getByCallsign(const QString& callsign) const
+{
+  QReadLocker locker(&lock);
+  QVector<OnlineIndexEntry> retval;
+  for(auto it = callsignIndex.constFind(callsign); it != callsignIndex.constEnd() && it.key() == callsign; ++it)
+    retval.append(entries.value(it.value()));
+  return retval;
+}
+
+QVector<OnlineIndexEntry> OnlineIndex::getInRect(const geo::Rect& rect) const
+{
+  QVector<OnlineIndexEntry> retval;
+  if(!rect.isValid())
+    return retval;
+
+  QVector<int> cellIndexes;
+  cellsForRect(cellIndexes, rect);
+
+  QReadLocker locker(&lock);
+  QSet<int> found;
+  for(int cellIndex : cellIndexes)
+  {
+    auto cellIt = grid.constFind(cellIndex);
+    if(cellIt == grid.constEnd())
+      continue;
+
+    for(int id : cellIt.value())
+    {
+      const OnlineIndexEntry& entry = entries.value(id);
+      if(entry.bounding.isPoint() ? rect.contains(entry.pos) : rect.overlaps(entry.bounding))
+      {
+        // ATC stations can span more than one cell
+        if(!found.contains(id))
+        {
+          found.insert(id);
+          retval.append(entry);
+        }
+      }
+    }
+  }
+  return retval;
+}
+
+QVector<OnlineIndexEntry> OnlineIndex::getNearest(const geo::Pos& pos, int maxNum, float maxDistanceMeter) const
+{
+  QVector<OnlineIndexEntry> retval;
+  if(!pos.isValid() || maxNum <= 0)
+    return retval;
+
+  int centerCol = column(pos.getLonX()), centerRow = row(pos.getLatY());
+  QVector<std::pair<float, int> > candidates;
+  QSet<int> found;
+
+  QReadLocker locker(&lock);
+  for(int ring = 0; ring <= std::max(GRID_COLUMNS / 2, GRID_ROWS); ring++)
+  {
+    // Lower bound of the distance to all cells in this ring - longitude degrees shrink towards the poles
+    float maxLat = std::min(std::abs(pos.getLatY()) + ring * CELL_SIZE_DEG, 89.f);
+    float ringDist = std::max(ring - 1, 0) * CELL_SIZE_DEG * MIN_METER_PER_DEG *
+                     static_cast<float>(std::cos(atools::geo::toRadians(maxLat)));
+
+    if(ringDist > maxDistanceMeter)
+      break;
+
+    if(candidates.size() >= maxNum)
+    {
+      std::partial_sort(candidates.begin(), candidates.begin() + maxNum, candidates.end());
+      if(candidates.at(maxNum - 1).first < ringDist)
+        break;
+    }
+
+    for(int r = centerRow - ring; r <= centerRow + ring; r++)
+    {
+      if(r < 0 || r >= GRID_ROWS)
+        continue;
+
+      // Visit only the border of the ring
+      int step = (r == centerRow - ring || r == centerRow + ring) ? 1 : std::max(ring * 2, 1);
+      for(int c = centerCol - ring; c <= centerCol + ring; c += step)
+      {
+        // Wrap at the anti-meridian
+        int col = (c % GRID_COLUMNS + GRID_COLUMNS) % GRID_COLUMNS;
+        auto cellIt = grid.constFind(r * GRID_COLUMNS + col);
+        if(cellIt == grid.constEnd())
+          continue;
+
+        for(int id : cellIt.value())
+        {
+          if(found.contains(id))
+            continue;
+          found.insert(id);
+
+          float dist = pos.distanceMeterTo(entries.value(id).pos);
+          if(dist <= maxDistanceMeter)
+            candidates.append(std::make_pair(dist, id));
+        }
+      }
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end());
+  for(int i = 0; i < candidates.size() && i < maxNum; i++)
+    retval.append(entries.value(candidates.at(i).second));
+  return retval;
+}
+
+QVector<OnlineIndexEntry> OnlineIndex::getCovering(const geo::Pos& pos) const
+{
+  QVector<OnlineIndexEntry> retval;
+  if(!pos.isValid())
+    return retval;
+
+  QReadLocker locker(&lock);
+  auto cellIt = grid.constFind(row(pos.getLatY()) * GRID_COLUMNS + column(pos.getLonX()));
+  if(cellIt != grid.constEnd())
+  {
+    for(int id : cellIt.value())
+    {
+      const OnlineIndexEntry& entry = entries.value(id);
+      if(entry.radiusNm > 0.f && entry.bounding.contains(pos) &&
+         pos.distanceMeterTo(entry.pos) <= atools::geo::nmToMeter(entry.radiusNm))
+        retval.append(entry);
+    }
+  }
+  return retval;
+}
+
+void OnlineIndex::getCallsignAndPosMap(QHash<QString, geo::Pos>& map) const
+{
+  map.clear();
+  QReadLocker locker(&lock);
+  map.reserve(entries.size());
+  for(const OnlineIndexEntry& entry : entries)
+    map.insert(entry.callsign, entry.pos);
+}
+
+int OnlineIndex::size() const
+{
+  QReadLocker locker(&lock);
+  return entries.size();
+}
+
+void OnlineIndex::insertInternal(const OnlineIndexEntry& entry)
+{
+  if(entries.contains(entry.id))
+    removeInternal(entry.id);
+
+  entries.insert(entry.id, entry);
+  callsignIndex.insert(entry.callsign, entry.id);
+
+  QVector<int> cellIndexes;
+  cellsForRect(cellIndexes, entry.bounding.isValid() ? entry.bounding : atools::geo::Rect(entry.pos));
+  for(int cellIndex : cellIndexes)
+    grid[cellIndex].append(entry.id);
+}
+
+void OnlineIndex::removeInternal(int id)
+{
+  auto it = entries.find(id);
+  if(it == entries.end())
+    return;
+
+  callsignIndex.remove(it.value().callsign, id);
+
+  QVector<int> cellIndexes;
+  cellsForRect(cellIndexes, it.value().bounding.isValid() ? it.value().bounding : atools::geo::Rect(it.value().pos));
+  for(int cellIndex : cellIndexes)
+  {
+    auto cellIt = grid.find(cellIndex);
+    if(cellIt != grid.end())
+    {
+      cellIt.value().removeOne(id);
+      if(cellIt.value().isEmpty())
+        grid.erase(cellIt);
+    }
+  }
+  entries.erase(it);
+}
+
+void OnlineIndex::cellsForRect(QVector<int>& cellIndexes, const geo::Rect& rect) const
+{
+  for(const atools::geo::Rect& r : rect.splitAtAntiMeridian())
+  {
+    int west = column(r.getWest()), east = column(r.getEast());
+    int north = row(r.getNorth()), south = row(r.getSouth());
+    for(int rw = south; rw <= north; rw++)
+    {
+      for(int col = west; col <= east; col++)
+        cellIndexes.append(rw * GRID_COLUMNS + col);
+    }
+  }
+}
+
+int OnlineIndex::column(float lonX) const
+{
+  return std::min(std::max(static_cast<int>((lonX + 180.f) / CELL_SIZE_DEG), 0), GRID_COLUMNS - 1);
+}
+
+int OnlineIndex::row(float latY) const
+{
+  return std::min(std::max(static_cast<int>((latY + 90.f) / CELL_SIZE_DEG), 0), GRID_ROWS - 1);
+}
+
+} // namespace online
+} // namespace fs
+} // namespace atools
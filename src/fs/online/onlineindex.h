@@ -0,0 +1,120 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_ONLINE_ONLINEINDEX_H
+#define ATOOLS_FS_ONLINE_ONLINEINDEX_H
+
+#include "geo/pos.h"
+#include "geo/rect.h"
+#include "sql/sqlrecord.h"
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QVector>
+
+namespace atools {
+namespace fs {
+namespace online {
+
+/* Client or ATC station in the online index */
+struct OnlineIndexEntry
+{
+  /* client_id or atc_id */
+  int id = -1;
+  QString callsign;
+  atools::geo::Pos pos;
+
+  /* Bounding rectangle of the coverage circle for ATC. Single point for clients. */
+  atools::geo::Rect bounding;
+
+  /* Coverage circle radius for ATC. 0 for clients. */
+  float radiusNm = 0.f;
+
+  /* Full row of table client or atc */
+  atools::sql::SqlRecord record;
+};
+
+/*
+ * In-memory store of online clients or ATC stations mirroring the client or atc table.
+ * Entries are put into a grid of cells for rectangle and nearest queries and are additionally
+ * indexed by id and callsign.
+ *
+ * All methods are thread safe. Queries return copies and can run in parallel.
+ */
+class OnlineIndex
+{
+public:
+  OnlineIndex();
+
+  /* Remove all entries */
+  void clear();
+
+  /* Replace all entries */
+  void reset(const QVector<atools::fs::online::OnlineIndexEntry>& entries);
+
+  /* Insert or replace the given entries and remove the entries with the given ids in one step */
+  void update(const QVector<atools::fs::online::OnlineIndexEntry>& entries, const QVector<int>& removedIds);
+
+  /* Get entry by id. Returns false if not found. */
+  bool getById(int id, atools::fs::online::OnlineIndexEntry& entry) const;
+
+  /* All entries matching the callsign. Normally only one. */
+  QVector<atools::fs::online::OnlineIndexEntry> getByCallsign(const QString& callsign) const;
+
+  /* All entries where the position (clients) or coverage rectangle (ATC) touches the rectangle */
+  QVector<atools::fs::online::OnlineIndexEntry> getInRect(const atools::geo::Rect& rect) const;
+
+  /* Up to maxNum entries nearest to pos within maxDistanceMeter sorted by distance */
+  QVector<atools::fs::online::OnlineIndexEntry> getNearest(const atools::geo::Pos& pos, int maxNum,
+                                                           float maxDistanceMeter) const;
+
+  /* All ATC stations where the coverage circle contains pos */
+  QVector<atools::fs::online::OnlineIndexEntry> getCovering(const atools::geo::Pos& pos) const;
+
+  /* Fill the map with callsign as key and position as value */
+  void getCallsignAndPosMap(QHash<QString, atools::geo::Pos>& map) const;
+
+  int size() const;
+
+  bool isEmpty() const
+  {
+    return size() == 0;
+  }
+
+private:
+  void insertInternal(const atools::fs::online::OnlineIndexEntry& entry);
+  void removeInternal(int id);
+
+  /* Get cell indexes covered by the rectangle */
+  void cellsForRect(QVector<int>& cellIndexes, const atools::geo::Rect& rect) const;
+  int column(float lonX) const;
+  int row(float latY) const;
+
+  QHash<int, atools::fs::online::OnlineIndexEntry> entries;
+  QMultiHash<QString, int> callsignIndex;
+
+  /* Grid cell index to entry ids */
+  QHash<int, QVector<int> > grid;
+
+  mutable QReadWriteLock lock;
+};
+
+} // namespace online
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_ONLINE_ONLINEINDEX_H
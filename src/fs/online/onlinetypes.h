@@ -131,6 +131,32 @@ enum Simulator
 
 }
 
+/* Rows changed by the last whazzup update in diff mode. Ids are client_id or atc_id. */
+struct OnlineChanges
+{
+  QVector<int> addedClients, updatedClients, removedClients, addedAtc, updatedAtc, removedAtc;
+
+  /* Tables were rebuilt and all rows are reported as added */
+  bool full = false;
+
+  void clear()
+  {
+    addedClients.clear();
+    updatedClients.clear();
+    removedClients.clear();
+    addedAtc.clear();
+    updatedAtc.clear();
+    removedAtc.clear();
+    full = false;
+  }
+
+  bool isEmpty() const
+  {
+    return !full && addedClients.isEmpty() && updatedClients.isEmpty() && removedClients.isEmpty() &&
+           addedAtc.isEmpty() && updatedAtc.isEmpty() && removedAtc.isEmpty();
+  }
+};
+
 QString facilityTypeText(int type);
 QString facilityTypeText(atools::fs::online::fac::FacilityType type);
 
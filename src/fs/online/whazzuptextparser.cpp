@@ -18,6 +18,7 @@
 #include "fs/online/whazzuptextparser.h"
 
 #include "sql/sqlquery.h"
+#include "sql/sqlbatch.h"
 #include "sql/sqlutil.h"
 #include "geo/calculations.h"
 #include "sql/sqldatabase.h"
@@ -28,6 +29,8 @@
 
 using atools::sql::SqlDatabase;
 using atools::sql::SqlQuery;
+using atools::sql::SqlBatch;
+using atools::sql::SqlRecord;
 using atools::sql::SqlUtil;
 using atools::geo::Rect;
 using atools::geo::LineString;
@@ -59,16 +62,19 @@ bool WhazzupTextParser::read(QTextStream& stream, Format streamFormat, const QDa
 
   // Read through file to get all sections
   QSet<QString> sections;
-  while(!stream.atEnd())
+  while(stream.readLineInto(&lineBuffer))
   {
-    QString line = stream.readLine().trimmed();
+    QStringRef line = lineBuffer.midRef(0).trimmed();
     if(line.startsWith("!"))
       // Remember section
-      sections.insert(line.mid(1).toUpper().trimmed().replace(':', ""));
+      sections.insert(line.mid(1).toString().toUpper().trimmed().replace(':', ""));
   }
 
+  changes.clear();
+  diffActive = diffMode && diffValid;
+
   // Delete tables for available sections and keep others
-  if(sections.contains("CLIENTS"))
+  if(sections.contains("CLIENTS") && !diffActive)
   {
     db->exec("delete from client");
     db->exec("delete from atc");
@@ -86,9 +92,10 @@ bool WhazzupTextParser::read(QTextStream& stream, Format streamFormat, const QDa
   // Got back and read the whole file
   stream.seek(0);
   format = streamFormat;
-  while(!stream.atEnd())
+  bool retval = true;
+  while(stream.readLineInto(&lineBuffer))
   {
-    QString line = stream.readLine().trimmed();
+    QStringRef line = lineBuffer.midRef(0).trimmed();
 
     // Skip comments and empty lines
     if(line.isEmpty() || line.startsWith(";") || line.startsWith("#"))
@@ -96,40 +103,88 @@ bool WhazzupTextParser::read(QTextStream& stream, Format streamFormat, const QDa
 
     if(line.startsWith("!"))
       // Remember section
-      curSection = line.mid(1).toUpper().trimmed().replace(':', "");
+      curSection = line.mid(1).toString().toUpper().trimmed().replace(':', "");
     else
     {
       // Parse the section data  (CSV like with : separator
       if(curSection == "GENERAL")
       {
-        QDateTime update = parseGeneralSection(line);
+        QDateTime update = parseGeneralSection(line.toString());
 
         if(update.isValid())
         {
           if(update <= lastUpdate)
+          {
             // This is older than the last update - bail out
-            return false;
+            retval = false;
+            break;
+          }
         }
         updateTimestamp = update;
       }
       else if(curSection == "CLIENTS")
       {
-        QStringList columns = line.split(":");
+        splitLine(line);
 
         // Check client type
-        parseSection(columns, at(columns, 3) == "ATC" /*ATC*/, false /* prefile */);
+        parseSection(field(3) == "ATC" /*ATC*/, false /* prefile */);
       }
       else if(curSection == "PREFILE")
-        parseSection(line.split(":"), false /*ATC*/, true /* prefile */);
+      {
+        splitLine(line);
+        parseSection(false /*ATC*/, true /* prefile */);
+      }
       else if(curSection == "SERVERS")
-        parseServersSection(line);
+        parseServersSection(line.toString());
       else if(curSection == "VOICE" || curSection == "VOICE_SERVERS" || curSection == "VOICE SERVERS")
-        parseVoiceSection(line);
+        parseVoiceSection(line.toString());
       else if(curSection == "AIRPORTS")
-        parseVoiceSection(line);
+        parseVoiceSection(line.toString());
     }
   }
-  return true;
+
+  if(diffMode && sections.contains("CLIENTS"))
+  {
+    if(retval)
+    {
+      if(diffActive)
+      {
+        writeDiff(clientRows, lastClientRows, clientBatch, clientUpdateBatch, &clientUpdateRecord, clientDeleteBatch,
+                  ":client_id", changes.addedClients, changes.updatedClients, changes.removedClients);
+        writeDiff(atcRows, lastAtcRows, atcBatch, nullptr, nullptr, atcDeleteBatch,
+                  ":atc_id", changes.addedAtc, changes.updatedAtc, changes.removedAtc);
+      }
+      else
+      {
+        // Tables were rebuilt
+        changes.full = true;
+        changes.addedClients = clientRows.keys().toVector();
+        changes.addedAtc = atcRows.keys().toVector();
+      }
+
+      // Keep rows for next comparison
+      lastClientRows.swap(clientRows);
+      lastAtcRows.swap(atcRows);
+      diffValid = true;
+    }
+    clientRows.clear();
+    atcRows.clear();
+  }
+
+  // Write remaining rows - caller rolls back if the file is outdated
+  clientBatch->exec();
+  atcBatch->exec();
+  if(diffActive)
+  {
+    clientUpdateBatch->exec();
+    clientDeleteBatch->exec();
+    atcDeleteBatch->exec();
+  }
+
+  if(stringPool.size() > MAX_STRING_POOL_SIZE)
+    stringPool.clear();
+
+  return retval;
 }
 
 QDateTime WhazzupTextParser::parseGeneralSection(const QString& line)
@@ -156,7 +211,7 @@ QDateTime WhazzupTextParser::parseGeneralSection(const QString& line)
   return update;
 }
 
-void WhazzupTextParser::parseSection(const QStringList& line, bool isAtc, bool isPrefile)
+void WhazzupTextParser::parseSection(bool isAtc, bool isPrefile)
 {
   // Columns in file
   // IVAO format .................................. // VATSIM format
@@ -213,83 +268,84 @@ void WhazzupTextParser::parseSection(const QStringList& line, bool isAtc, bool i
   // .............................................. // 40 QNH_Mb
   // IVAO format .................................. // VATSIM format
 
-  atools::sql::SqlQuery *insertQuery = isAtc ? atcInsertQuery : clientInsertQuery;
+  // Collect all values in the record since the batch needs a value for each column
+  SqlRecord& insertRecord = isAtc ? atcRecord : clientRecord;
 
   int index = 0;
-  insertQuery->clearBoundValues();
+  insertRecord.clearValues();
 
-  const QString callsign = at(line, index++);
-  insertQuery->bindValue(":callsign", callsign);
+  const QString callsign = field(index++);
+  insertRecord.setValue(":callsign", callsign);
 
-  const QString vid = at(line, index++);
-  insertQuery->bindValue(":vid", vid);
-  insertQuery->bindValue(":name", convertName(at(line, index++)));
+  const QString vid = field(index++);
+  insertRecord.setValue(":vid", vid);
+  insertRecord.setValue(":name", convertName(field(index++)));
 
   if(!isAtc)
-    insertQuery->bindValue(":prefile", isPrefile);
+    insertRecord.setValue(":prefile", isPrefile);
 
   // Get client type so we can check if it goes into a atc or client table
-  QString clientType = at(line, index++);
+  QString clientType = fieldIntern(index++);
   bool atc = clientType == "ATC";
-  insertQuery->bindValue(":client_type", clientType);
+  insertRecord.setValue(":client_type", clientType);
 
   if(atc)
   {
     QStringList freqStrToBind;
-    for(const QString& str : at(line, index).split("&"))
+    for(const QString& str : field(index).split("&"))
       freqStrToBind.append(QString::number(atools::roundToInt(str.trimmed().toDouble() * 1000.)));
-    insertQuery->bindValue(":frequency", freqStrToBind);
+    insertRecord.setValue(":frequency", freqStrToBind);
   }
   index++;
 
-  float laty = atFloat(line, index++);
-  insertQuery->bindValue(":laty", laty);
+  float laty = atFlofield(index++);
+  insertRecord.setValue(":laty", laty);
 
-  float lonx = atFloat(line, index++);
-  insertQuery->bindValue(":lonx", lonx);
+  float lonx = atFlofield(index++);
+  insertRecord.setValue(":lonx", lonx);
 
   if(!atc)
   {
-    QString alt = at(line, index).trimmed();
+    QString alt = field(index).trimmed();
     if(alt.startsWith("FL"))
       // Convert flight level to altitude
-      insertQuery->bindValue(":altitude", alt.mid(2).toInt() * 100);
+      insertRecord.setValue(":altitude", alt.mid(2).toInt() * 100);
     else if(alt.startsWith("F"))
-      insertQuery->bindValue(":altitude", alt.mid(1).toInt() * 100);
+      insertRecord.setValue(":altitude", alt.mid(1).toInt() * 100);
     else
-      insertQuery->bindValue(":altitude", alt.toInt());
+      insertRecord.setValue(":altitude", alt.toInt());
   }
   index++;
 
-  QString groundspeed = at(line, index);
+  QString groundspeed = field(index);
   if(!atc)
-    insertQuery->bindValue(":groundspeed", groundspeed);
+    insertRecord.setValue(":groundspeed", groundspeed);
   index++;
 
   if(!atc)
   {
-    insertQuery->bindValue(":flightplan_aircraft", at(line, index++));
-    insertQuery->bindValue(":flightplan_cruising_speed", at(line, index++));
-    insertQuery->bindValue(":flightplan_departure_aerodrome", at(line, index++));
-    insertQuery->bindValue(":flightplan_cruising_level", at(line, index++));
-    insertQuery->bindValue(":flightplan_destination_aerodrome", at(line, index++));
+    insertRecord.setValue(":flightplan_aircraft", fieldIntern(index++));
+    insertRecord.setValue(":flightplan_cruising_speed", fieldIntern(index++));
+    insertRecord.setValue(":flightplan_departure_aerodrome", fieldIntern(index++));
+    insertRecord.setValue(":flightplan_cruising_level", fieldIntern(index++));
+    insertRecord.setValue(":flightplan_destination_aerodrome", fieldIntern(index++));
   }
   else
     index += 5;
 
-  insertQuery->bindValue(":server", at(line, index++));
-  insertQuery->bindValue(":protocol", at(line, index++));
-  insertQuery->bindValue(":combined_rating", at(line, index++));
+  insertRecord.setValue(":server", fieldIntern(index++));
+  insertRecord.setValue(":protocol", fieldIntern(index++));
+  insertRecord.setValue(":combined_rating", fieldIntern(index++));
 
   if(!atc)
-    insertQuery->bindValue(":transponder_code", at(line, index));
+    insertRecord.setValue(":transponder_code", field(index));
   index++;
 
   atools::fs::online::fac::FacilityType facilityType =
-    static_cast<atools::fs::online::fac::FacilityType>(atInt(line, index++));
-  insertQuery->bindValue(":facility_type", facilityType);
+    static_cast<atools::fs::online::fac::FacilityType>(fieldInt(index++));
+  insertRecord.setValue(":facility_type", facilityType);
 
-  int visualRange = atInt(line, index++);
+  int visualRange = fieldInt(index++);
   int circleRadius = visualRange;
 
   if(atc)
@@ -339,28 +395,28 @@ void WhazzupTextParser::parseSection(const QStringList& line, bool isAtc, bool i
     if(circleRadius == -1)
       circleRadius = visualRange;
 
-    insertQuery->bindValue(":type", boundaryType);
-    insertQuery->bindValue(":com_type", comType);
-    insertQuery->bindValue(":radius", circleRadius);
+    insertRecord.setValue(":type", boundaryType);
+    insertRecord.setValue(":com_type", comType);
+    insertRecord.setValue(":radius", circleRadius);
   }
 
-  insertQuery->bindValue(":visual_range", visualRange);
+  insertRecord.setValue(":visual_range", visualRange);
 
   if(!atc)
   {
-    insertQuery->bindValue(":flightplan_revision", at(line, index++));
-    insertQuery->bindValue(":flightplan_flight_rules", at(line, index++));
-    QString departureTime = at(line, index++);
+    insertRecord.setValue(":flightplan_revision", field(index++));
+    insertRecord.setValue(":flightplan_flight_rules", fieldIntern(index++));
+    QString departureTime = field(index++);
     if(!departureTime.isEmpty() && departureTime != "0")
-      insertQuery->bindValue(":flightplan_departure_time", departureTime);
-    QString actualDepartureTime = at(line, index++);
+      insertRecord.setValue(":flightplan_departure_time", departureTime);
+    QString actualDepartureTime = field(index++);
     if(!actualDepartureTime.isEmpty() && actualDepartureTime != "0")
-      insertQuery->bindValue(":flightplan_actual_departure_time", actualDepartureTime);
+      insertRecord.setValue(":flightplan_actual_departure_time", actualDepartureTime);
 
     // Convert two fields to minutes
-    int hoursEnroute = atInt(line, index++);
-    int minsEnroute = atInt(line, index++);
-    insertQuery->bindValue(":flightplan_enroute_minutes", hoursEnroute * 60 + minsEnroute);
+    int hoursEnroute = fieldInt(index++);
+    int minsEnroute = fieldInt(index++);
+    insertRecord.setValue(":flightplan_enroute_minutes", hoursEnroute * 60 + minsEnroute);
 
     QTime eta;
     double enrouteMin = hoursEnroute * 60 + minsEnroute;
@@ -377,12 +433,12 @@ void WhazzupTextParser::parseSection(const QStringList& line, bool isAtc, bool i
           static_cast<int>(depTime.msecsSinceStartOfDay() + enrouteMin * 60. * 1000.));
 
       if(eta.isValid())
-        insertQuery->bindValue(":flightplan_estimated_arrival_time", eta.toString("hhmm"));
+        insertRecord.setValue(":flightplan_estimated_arrival_time", eta.toString("hhmm"));
     }
 
-    insertQuery->bindValue(":flightplan_alternate_aerodrome", at(line, index++));
-    insertQuery->bindValue(":flightplan_other_info", at(line, index++));
-    insertQuery->bindValue(":flightplan_route", at(line, index++));
+    insertRecord.setValue(":flightplan_alternate_aerodrome", fieldIntern(index++));
+    insertRecord.setValue(":flightplan_other_info", field(index++));
+    insertRecord.setValue(":flightplan_route", field(index++));
   }
   else
     index += 11;
@@ -393,32 +449,32 @@ void WhazzupTextParser::parseSection(const QStringList& line, bool isAtc, bool i
     index += 4;
     if(atc)
     {
-      insertQuery->bindValue(":atis", convertAtisText(at(line, index++)));
-      insertQuery->bindValue(":atis_time", parseDateTime(line, index++));
+      insertRecord.setValue(":atis", convertAtisText(field(index++)));
+      insertRecord.setValue(":atis_time", parseDateTime(index++));
     }
     else
       index += 2;
 
-    insertQuery->bindValue(":connection_time", parseDateTime(line, index++));
-    insertQuery->bindValue(":software_name", at(line, index++));
-    insertQuery->bindValue(":software_version", at(line, index++));
-    insertQuery->bindValue(":administrative_rating", atInt(line, index++));
-    insertQuery->bindValue(":atc_pilot_rating", atInt(line, index++));
+    insertRecord.setValue(":connection_time", parseDateTime(index++));
+    insertRecord.setValue(":software_name", fieldIntern(index++));
+    insertRecord.setValue(":software_version", fieldIntern(index++));
+    insertRecord.setValue(":administrative_rating", fieldInt(index++));
+    insertRecord.setValue(":atc_pilot_rating", fieldInt(index++));
 
     if(!atc)
     {
-      insertQuery->bindValue(":flightplan_2nd_alternate_aerodrome", at(line, index++));
-      insertQuery->bindValue(":flightplan_type_of_flight", at(line, index++));
-      insertQuery->bindValue(":flightplan_persons_on_board", atInt(line, index++));
-      insertQuery->bindValue(":heading", atInt(line, index++));
-      insertQuery->bindValue(":on_ground", atInt(line, index++));
+      insertRecord.setValue(":flightplan_2nd_alternate_aerodrome", fieldIntern(index++));
+      insertRecord.setValue(":flightplan_type_of_flight", fieldIntern(index++));
+      insertRecord.setValue(":flightplan_persons_on_board", fieldInt(index++));
+      insertRecord.setValue(":heading", fieldInt(index++));
+      insertRecord.setValue(":on_ground", fieldInt(index++));
     }
     else
       index += 5;
 
-    insertQuery->bindValue(":simulator", at(line, index++));
+    insertRecord.setValue(":simulator", fieldIntern(index++));
     if(!atc)
-      insertQuery->bindValue(":plane", at(line, index));
+      insertRecord.setValue(":plane", field(index));
     index++;
   }
   else if(format == VATSIM)
@@ -428,27 +484,27 @@ void WhazzupTextParser::parseSection(const QStringList& line, bool isAtc, bool i
 
     if(atc)
     {
-      insertQuery->bindValue(":atis", convertAtisText(at(line, index++)));
-      insertQuery->bindValue(":atis_time", parseDateTime(line, index++));
+      insertRecord.setValue(":atis", convertAtisText(field(index++)));
+      insertRecord.setValue(":atis_time", parseDateTime(index++));
     }
     else
       index += 2;
 
-    insertQuery->bindValue(":connection_time", parseDateTime(line, index++));
+    insertRecord.setValue(":connection_time", parseDateTime(index++));
     if(!atc)
-      insertQuery->bindValue(":heading", atInt(line, index));
+      insertRecord.setValue(":heading", fieldInt(index));
     index++;
 
     if(!atc)
     {
       bool ok = false;
       float gs = groundspeed.toFloat(&ok);
-      insertQuery->bindValue(":on_ground", ok && gs < 30.f);
+      insertRecord.setValue(":on_ground", ok && gs < 30.f);
     }
 
-    float qnhInHg = atFloat(line, index++);
-    float qnhInMbar = atFloat(line, index++);
-    insertQuery->bindValue(":qnh_mb", (atools::geo::inHgToMbar(qnhInHg) + qnhInMbar) / 2.f);
+    float qnhInHg = atFlofield(index++);
+    float qnhInMbar = atFlofield(index++);
+    insertRecord.setValue(":qnh_mb", (atools::geo::inHgToMbar(qnhInHg) + qnhInMbar) / 2.f);
   }
 
   if(atc)
@@ -467,14 +523,14 @@ void WhazzupTextParser::parseSection(const QStringList& line, bool isAtc, bool i
 
     // Add bounding rectancle
     Rect bounding = lineString.boundingRect();
-    insertQuery->bindValue(":max_lonx", bounding.getEast());
-    insertQuery->bindValue(":max_laty", bounding.getNorth());
-    insertQuery->bindValue(":min_lonx", bounding.getWest());
-    insertQuery->bindValue(":min_laty", bounding.getSouth());
+    insertRecord.setValue(":max_lonx", bounding.getEast());
+    insertRecord.setValue(":max_laty", bounding.getNorth());
+    insertRecord.setValue(":min_lonx", bounding.getWest());
+    insertRecord.setValue(":min_laty", bounding.getSouth());
 
     // Store geometry in same format as boundaries
     atools::fs::common::BinaryGeometry geo(lineString);
-    insertQuery->bindValue(":geometry", geo.writeToByteArray());
+    insertRecord.setValue(":geometry", geo.writeToByteArray());
   }
 
   // =============================================================================
@@ -484,9 +540,14 @@ void WhazzupTextParser::parseSection(const QStringList& line, bool isAtc, bool i
   int id = getSemiPermanentId(isAtc ? atcIdMap : clientIdMap, isAtc ? curAtcId : curClientId, hashKey);
 
   // qDebug() << hashKey << id;
-  insertQuery->bindValue(isAtc ? ":atc_id" : ":client_id", id);
+  insertRecord.setValue(isAtc ? ":atc_id" : ":client_id", id);
+
+  if(diffMode)
+    (isAtc ? atcRows : clientRows).insert(id, insertRecord);
 
-  insertQuery->exec();
+  if(!diffActive)
+    // Otherwise written after comparing all rows
+    (isAtc ? atcBatch : clientBatch)->addRecord(insertRecord);
 }
 
 int WhazzupTextParser::getSemiPermanentId(QHash<QString, int>& idMap, int& curId, const QString& key)
@@ -500,14 +561,138 @@ int WhazzupTextParser::getSemiPermanentId(QHash<QString, int>& idMap, int& curId
   return id;
 }
 
-QDateTime WhazzupTextParser::parseDateTime(const QStringList& line, int index)
+void WhazzupTextParser::splitLine(const QStringRef& line)
+{
+  numFields = 0;
+  int begin = 0;
+  while(begin <= line.size())
+  {
+    int end = line.indexOf(':', begin);
+    if(end == -1)
+      end = line.size();
+
+    if(numFields < fields.size())
+      fields[numFields] = line.mid(begin, end - begin);
+    else
+      fields.append(line.mid(begin, end - begin));
+    numFields++;
+    begin = end + 1;
+  }
+}
+
+QStringRef WhazzupTextParser::fieldRef(int index) const
+{
+  if(index < numFields)
+    return fields.at(index).trimmed();
+  else
+    qWarning() << "Invalid index" << index << "for" << lineBuffer;
+  return QStringRef();
+}
+
+QString WhazzupTextParser::field(int index) const
+{
+  return fieldRef(index).toString();
+}
+
+QString WhazzupTextParser::fieldIntern(int index)
+{
+  QStringRef ref = fieldRef(index);
+  if(ref.isEmpty())
+    return QString();
+
+  // Look up using the line buffer without copying
+  QSet<QString>::const_iterator it = stringPool.constFind(QString::fromRawData(ref.unicode(), ref.size()));
+  if(it != stringPool.constEnd())
+    return *it;
+
+  QString str = ref.toString();
+  stringPool.insert(str);
+  return str;
+}
+
+int WhazzupTextParser::fieldInt(int index) const
+{
+  int num = 0;
+  QStringRef str = fieldRef(index);
+  if(!str.isEmpty())
+  {
+    bool ok;
+    num = str.toInt(&ok);
+    if(!ok)
+      qWarning() << "Invalid number" << str << "at" << index << "for" << lineBuffer;
+  }
+  return num;
+}
+
+float WhazzupTextParser::fieldFloat(int index) const
 {
-  QString str = at(line, index++);
+  float num = 0.f;
+  QStringRef str = fieldRef(index);
+  if(!str.isEmpty())
+  {
+    bool ok;
+    num = str.toFloat(&ok);
+    if(!ok)
+      qWarning() << "Invalid floating point number" << str << "at" << index << "for" << lineBuffer;
+  }
+  return num;
+}
+
+void WhazzupTextParser::writeDiff(const QHash<int, SqlRecord>& rows, const QHash<int, SqlRecord>& lastRows,
+                                  SqlBatch *insertBatch, SqlBatch *updateBatch, SqlRecord *updateRecord,
+                                  SqlBatch *deleteBatch, const QString& idPlaceholder,
+                                  QVector<int>& added, QVector<int>& updated, QVector<int>& removed)
+{
+  for(auto it = rows.constBegin(); it != rows.constEnd(); ++it)
+  {
+    auto lastIt = lastRows.constFind(it.key());
+    if(lastIt == lastRows.constEnd())
+    {
+      insertBatch->addRecord(it.value());
+      added.append(it.key());
+    }
+    else if(lastIt.value() != it.value())
+    {
+      bool onlyUpdateFields = updateBatch != nullptr;
+      for(int i = 0; i < it.value().count() && onlyUpdateFields; i++)
+      {
+        if(!updateRecord->contains(it.value().fieldName(i)) && it.value().value(i) != lastIt.value().value(i))
+          onlyUpdateFields = false;
+      }
+
+      if(onlyUpdateFields)
+      {
+        // Position or status changed
+        for(int i = 0; i < updateRecord->count(); i++)
+          updateRecord->setValue(i, it.value().value(updateRecord->fieldName(i)));
+        updateBatch->addRecord(*updateRecord);
+      }
+      else
+        // Flight plan or other fields changed - replace row
+        insertBatch->addRecord(it.value());
+      updated.append(it.key());
+    }
+  }
+
+  for(auto it = lastRows.constBegin(); it != lastRows.constEnd(); ++it)
+  {
+    if(!rows.contains(it.key()))
+    {
+      deleteBatch->bindValue(idPlaceholder, it.key());
+      deleteBatch->addRow();
+      removed.append(it.key());
+    }
+  }
+}
+
+QDateTime WhazzupTextParser::parseDateTime(int index)
+{
+  QString str = field(index);
   if(!str.isEmpty())
   {
     QDateTime datetime = QDateTime::fromString(str, "yyyyMMddhhmmss");
     if(!datetime.isValid())
-      qWarning() << "Invalid datetime at index" << index << line.at(index) << "in line" << line;
+      qWarning() << "Invalid datetime at index" << index << str << "in line" << lineBuffer;
     return datetime;
   }
   else
@@ -580,9 +765,37 @@ void WhazzupTextParser::initQueries()
 
   clientInsertQuery = new SqlQuery(db);
   clientInsertQuery->prepare(util.buildInsertStatement("client", "or replace"));
+  clientBatch = new SqlBatch(clientInsertQuery);
+  clientRecord = db->record("client", ":");
 
   atcInsertQuery = new SqlQuery(db);
   atcInsertQuery->prepare(util.buildInsertStatement("atc", "or replace"));
+  atcBatch = new SqlBatch(atcInsertQuery);
+  atcRecord = db->record("atc", ":");
+
+  // Fields which change often for moving aircraft
+  const QStringList updateColumns({"groundspeed", "transponder_code", "heading", "on_ground", "qnh_mb",
+                                   "altitude", "lonx", "laty"});
+  QStringList assignments;
+  clientUpdateRecord.clear();
+  for(const QString& column : updateColumns)
+  {
+    assignments.append(column + " = :" + column);
+    clientUpdateRecord.appendField(":" + column, clientRecord.fieldType(":" + column));
+  }
+  clientUpdateRecord.appendField(":client_id", QVariant::Int);
+
+  clientUpdateQuery = new SqlQuery(db);
+  clientUpdateQuery->prepare("update client set " + assignments.join(", ") + " where client_id = :client_id");
+  clientUpdateBatch = new SqlBatch(clientUpdateQuery);
+
+  clientDeleteQuery = new SqlQuery(db);
+  clientDeleteQuery->prepare("delete from client where client_id = :client_id");
+  clientDeleteBatch = new SqlBatch(clientDeleteQuery);
+
+  atcDeleteQuery = new SqlQuery(db);
+  atcDeleteQuery->prepare("delete from atc where atc_id = :atc_id");
+  atcDeleteBatch = new SqlBatch(atcDeleteQuery);
 
   serverInsertQuery = new SqlQuery(db);
   serverInsertQuery->prepare(util.buildInsertStatement("server", QString(), {"server_id"}));
@@ -593,6 +806,30 @@ void WhazzupTextParser::initQueries()
 
 void WhazzupTextParser::deInitQueries()
 {
+  delete clientBatch;
+  clientBatch = nullptr;
+
+  delete atcBatch;
+  atcBatch = nullptr;
+
+  delete clientUpdateBatch;
+  clientUpdateBatch = nullptr;
+
+  delete clientDeleteBatch;
+  clientDeleteBatch = nullptr;
+
+  delete atcDeleteBatch;
+  atcDeleteBatch = nullptr;
+
+  delete clientUpdateQuery;
+  clientUpdateQuery = nullptr;
+
+  delete clientDeleteQuery;
+  clientDeleteQuery = nullptr;
+
+  delete atcDeleteQuery;
+  atcDeleteQuery = nullptr;
+
   delete clientInsertQuery;
   clientInsertQuery = nullptr;
 
@@ -611,9 +848,18 @@ void WhazzupTextParser::resetForNewOptions()
   // Clear the id maps but do not reset the current ids to avoid overlaps
   atcIdMap.clear();
   clientIdMap.clear();
+  clearDiffState();
   reset();
 }
 
+void WhazzupTextParser::clearDiffState()
+{
+  diffValid = diffActive = false;
+  lastClientRows.clear();
+  lastAtcRows.clear();
+  changes.clear();
+}
+
 void WhazzupTextParser::reset()
 {
   curSection.clear();
@@ -20,9 +20,12 @@
 
 #include "geo/pos.h"
 #include "fs/online/onlinetypes.h"
+#include "sql/sqlrecord.h"
 
 #include <QDateTime>
+#include <QSet>
 #include <QString>
+#include <QVector>
 
 class QTextStream;
 
@@ -30,6 +33,7 @@ namespace atools {
 namespace sql {
 class SqlDatabase;
 class SqlQuery;
+class SqlBatch;
 }
 
 namespace fs {
@@ -88,9 +92,29 @@ public:
     atcRadius = value;
   }
 
+  /* Update tables client and atc by comparing with the last file instead of deleting and inserting all rows.
+   * New rows are inserted, rows with changed position or status are updated and missing rows deleted.
+   * The first read rebuilds the tables. */
+  void setDiffMode(bool value)
+  {
+    diffMode = value;
+    if(!diffMode)
+      clearDiffState();
+  }
+
+  /* Changes of the last successful read in diff mode */
+  const atools::fs::online::OnlineChanges& getChanges() const
+  {
+    return changes;
+  }
+
+  /* Forget the rows of the last file. Call if the tables were modified elsewhere. */
+  void clearDiffState();
+
 private:
   QDateTime parseGeneralSection(const QString& line);
-  void parseSection(const QStringList& line, bool isAtc, bool isPrefile);
+  /* Parse client or prefile from the fields of the current line */
+  void parseSection(bool isAtc, bool isPrefile);
   void parseServersSection(const QString& line);
   void parseVoiceSection(const QString& line);
   void parseAirportSection(const QString& line);
@@ -99,12 +123,31 @@ private:
   QString convertAtisText(QString atis);
 
   /* Read datetime format */
-  QDateTime parseDateTime(const QStringList& line, int index);
+  QDateTime parseDateTime(int index);
+
+  /* Split line at colons into fields referencing the line buffer */
+  void splitLine(const QStringRef& line);
+
+  /* Trimmed field of the current line. Empty and warning if index is out of range. */
+  QStringRef fieldRef(int index) const;
+  QString field(int index) const;
+  int fieldInt(int index) const;
+  float fieldFloat(int index) const;
+
+  /* Field as shared string from the pool for values repeated in many lines like aircraft types or servers */
+  QString fieldIntern(int index);
 
   /* Fix UTF-8 name embedded in ANSI encoding in file */
   QString convertName(QString name);
   int getSemiPermanentId(QHash<QString, int>& idMap, int& curId, const QString& key);
 
+  /* Write differences between rows of the last and the current file. Changed rows are updated using
+   * updateBatch if only the fields in updateRecord differ. Otherwise they are replaced. */
+  void writeDiff(const QHash<int, atools::sql::SqlRecord>& rows, const QHash<int, atools::sql::SqlRecord>& lastRows,
+                 atools::sql::SqlBatch *insertBatch, atools::sql::SqlBatch *updateBatch,
+                 atools::sql::SqlRecord *updateRecord, atools::sql::SqlBatch *deleteBatch,
+                 const QString& idPlaceholder, QVector<int>& added, QVector<int>& updated, QVector<int>& removed);
+
   QString curSection;
   atools::fs::online::Format format = atools::fs::online::UNKNOWN;
 
@@ -124,6 +167,30 @@ private:
   atools::sql::SqlQuery *clientInsertQuery = nullptr, *atcInsertQuery = nullptr,
                         *serverInsertQuery = nullptr, *airportInsertQuery = nullptr;
 
+  /* Clients and ATC are inserted in batches. Records collect the values of one row. */
+  atools::sql::SqlBatch *clientBatch = nullptr, *atcBatch = nullptr;
+  atools::sql::SqlRecord clientRecord, atcRecord;
+
+  /* Buffer for the current line and fields referencing it. Vector only grows - numFields gives the number of
+   * valid entries. */
+  QString lineBuffer;
+  QVector<QStringRef> fields;
+  int numFields = 0;
+
+  /* Diff mode: rows of the last and current file keyed by id. Valid after the first read. */
+  bool diffMode = false, diffValid = false, diffActive = false;
+  QHash<int, atools::sql::SqlRecord> clientRows, atcRows, lastClientRows, lastAtcRows;
+  atools::fs::online::OnlineChanges changes;
+
+  /* Queries for diff mode. Clients get an update for position and status fields. */
+  atools::sql::SqlQuery *clientUpdateQuery = nullptr, *clientDeleteQuery = nullptr, *atcDeleteQuery = nullptr;
+  atools::sql::SqlBatch *clientUpdateBatch = nullptr, *clientDeleteBatch = nullptr, *atcDeleteBatch = nullptr;
+  atools::sql::SqlRecord clientUpdateRecord;
+
+  /* Interned strings - cleared if too large */
+  QSet<QString> stringPool;
+  const int MAX_STRING_POOL_SIZE = 20000;
+
   // Assign row ids manually
   int curClientId = 1, curAtcId = 1;
 
@@ -144,7 +144,7 @@ void AircraftPerfHandler::simDataChanged(const sc::SimConnectData& simulatorData
     perf->setTaxiFuel(startFuel - aircraft.getFuelTotalGalLbs(fuelAsVol));
 
   // Sample every 500 ms ========================================
-  if(now > lastSampleTimeMs + SAMPLE_TIME_MS)
+  if(now > lastSampleTimeMs + sampleTimeMs)
   {
     samplePhase(flightSegment, aircraft, now, now - lastSampleTimeMs);
     lastSampleTimeMs = now;
@@ -188,6 +188,8 @@ void AircraftPerfHandler::samplePhase(FlightSegment flightSegment, const SimConn
 
     case atools::fs::perf::CLIMB:
       {
+        sampleStatistics(climbStats, aircraft, now);
+
         qint64 lastSampleDuration = now - lastClimbSampleTimeMs;
         perf->setClimbSpeed(sampleValue(lastSampleDuration, curSampleDuration, perf->getClimbSpeed(),
                                         aircraft.getTrueAirspeedKts()));
@@ -200,6 +202,8 @@ void AircraftPerfHandler::samplePhase(FlightSegment flightSegment, const SimConn
 
     case atools::fs::perf::CRUISE:
       {
+        sampleStatistics(cruiseStats, aircraft, now);
+
         qint64 lastSampleDuration = now - lastCruiseSampleTimeMs;
         perf->setCruiseSpeed(sampleValue(lastSampleDuration, curSampleDuration, perf->getCruiseSpeed(),
                                          aircraft.getTrueAirspeedKts()));
@@ -210,6 +214,8 @@ void AircraftPerfHandler::samplePhase(FlightSegment flightSegment, const SimConn
 
     case atools::fs::perf::DESCENT:
       {
+        sampleStatistics(descentStats, aircraft, now);
+
         qint64 lastSampleDuration = now - lastDescentSampleTimeMs;
         perf->setDescentSpeed(sampleValue(lastSampleDuration, curSampleDuration, perf->getDescentSpeed(),
                                           aircraft.getTrueAirspeedKts()));
@@ -223,6 +229,46 @@ void AircraftPerfHandler::samplePhase(FlightSegment flightSegment, const SimConn
   }
 }
 
+void AircraftPerfHandler::sampleStatistics(SegmentStatistics& stats, const SimConnectUserAircraft& aircraft,
+                                           qint64 now)
+{
+  double timeSec = now / 1000.;
+  stats.fuelFlow.add(timeSec, aircraft.getFuelFlowGalLbsPerHour(perf->useFuelAsVolume()));
+  stats.trueAirspeed.add(timeSec, aircraft.getTrueAirspeedKts());
+  stats.verticalSpeed.add(timeSec, aircraft.getVerticalSpeedFeetPerMin());
+}
+
+const SegmentStatistics *AircraftPerfHandler::getSegmentStatistics(FlightSegment segment) const
+{
+  switch(segment)
+  {
+    case atools::fs::perf::CLIMB:
+      return &climbStats;
+
+    case atools::fs::perf::CRUISE:
+      return &cruiseStats;
+
+    case atools::fs::perf::DESCENT:
+      return &descentStats;
+
+    case atools::fs::perf::NONE:
+    case atools::fs::perf::DEPARTURE_PARKING:
+    case atools::fs::perf::INVALID:
+    case atools::fs::perf::DESTINTATION_PARKING:
+    case atools::fs::perf::DESTINATION_TAXI:
+    case atools::fs::perf::DEPARTURE_TAXI:
+      break;
+  }
+  return nullptr;
+}
+
+void AircraftPerfHandler::clearStatistics()
+{
+  climbStats.clear();
+  cruiseStats.clear();
+  descentStats.clear();
+}
+
 bool AircraftPerfHandler::isClimbing(const SimConnectUserAircraft& aircraft) const
 {
   return aircraft.getVerticalSpeedFeetPerMin() > 200.f;
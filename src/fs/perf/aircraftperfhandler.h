@@ -21,6 +21,7 @@
 #include <QObject>
 
 #include "fs/perf/aircraftperfconstants.h"
+#include "fs/perf/samplestatistics.h"
 
 namespace atools {
 namespace fs {
@@ -36,6 +37,21 @@ namespace fs {
 namespace perf {
 
 class AircraftPerf;
+
+/* Sample statistics for the climb, cruise or descent segment */
+struct SegmentStatistics
+{
+  /* Fuel flow in lbs/gal per hour, true airspeed in knots and vertical speed in ft/min */
+  atools::fs::perf::SampleStatistics fuelFlow, trueAirspeed, verticalSpeed;
+
+  void clear()
+  {
+    fuelFlow.clear();
+    trueAirspeed.clear();
+    verticalSpeed.clear();
+  }
+};
+
 /*
  * Collects automatic performance information from a flight being fed by simulator events.
  *
@@ -90,6 +106,18 @@ public:
   /* Simulator event that trigger data collection */
   void simDataChanged(const atools::fs::sc::SimConnectData& simulatorData);
 
+  /* Statistics of all samples for climb, cruise and descent. nullptr for other segments. */
+  const atools::fs::perf::SegmentStatistics *getSegmentStatistics(atools::fs::perf::FlightSegment segment) const;
+
+  /* Remove all samples from the segment statistics */
+  void clearStatistics();
+
+  /* Minimum time between samples in milliseconds. Default is 500. */
+  void setSampleIntervalMs(qint64 value)
+  {
+    sampleTimeMs = value;
+  }
+
 signals:
   void flightSegmentChanged(const atools::fs::perf::FlightSegment& flightSegment);
   void reportUpdated();
@@ -112,8 +140,14 @@ private:
   atools::fs::perf::FlightSegment currentFlightSegment = NONE;
   float cruiseAltitude = 0.f, startFuel = 0.f, totalFuelConsumed = 0.f;
 
+  /* Add the values to the statistics of the segment */
+  void sampleStatistics(atools::fs::perf::SegmentStatistics& stats, const sc::SimConnectUserAircraft& aircraft,
+                        qint64 now);
+
   /* Do not calculate values more often than this */
-  const static qint64 SAMPLE_TIME_MS = 500L;
+  qint64 sampleTimeMs = 500L;
+
+  atools::fs::perf::SegmentStatistics climbStats, cruiseStats, descentStats;
 
   /* Last time of sample to allow calculation of averages */
   qint64 lastSampleTimeMs = 0L;
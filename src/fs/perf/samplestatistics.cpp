@@ -0,0 +1,235 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/perf/samplestatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace atools {
+namespace fs {
+namespace perf {
+
+P2Quantile::P2Quantile(double quantile)
+  : p(std::min(std::max(quantile, 0.), 1.))
+{
+  clear();
+}
+
+void P2Quantile::clear()
+{
+  count = 0;
+  for(int i = 0; i < 5; i++)
+  {
+    heights[i] = 0.;
+    positions[i] = i;
+  }
+
+  desired[0] = 0.;
+  desired[1] = 2. * p;
+  desired[2] = 4. * p;
+  desired[3] = 2. + 2. * p;
+  desired[4] = 4.;
+
+  increments[0] = 0.;
+  increments[1] = p / 2.;
+  increments[2] = p;
+  increments[3] = (1. + p) / 2.;
+  increments[4] = 1.;
+}
+
+void P2Quantile::add(double value)
+{
+  if(count < 5)
+  {
+    // Collect first samples sorted
+    heights[count++] = value;
+    std::sort(heights, heights + count);
+    return;
+  }
+  count++;
+
+  // Find cell containing value and adjust extreme markers
+  int k;
+  if(value < heights[0])
+  {
+    heights[0] = value;
+    k = 0;
+  }
+  else if(value >= heights[4])
+  {
+    heights[4] = value;
+    k = 3;
+  }
+  else
+  {
+    k = 0;
+    while(k < 3 && value >= heights[k + 1])
+      k++;
+  }
+
+  for(int i = k + 1; i < 5; i++)
+    positions[i]++;
+  for(int i = 0; i < 5; i++)
+    desired[i] += increments[i];
+
+  // Move middle markers if they are off their desired position by one or more
+  for(int i = 1; i < 4; i++)
+  {
+    double d = desired[i] - positions[i];
+    if((d >= 1. && positions[i + 1] - positions[i] > 1) || (d <= -1. && positions[i - 1] - positions[i] < -1))
+    {
+      int dir = d > 0. ? 1 : -1;
+      double h = parabolic(i, dir);
+      if(heights[i - 1] < h && h < heights[i + 1])
+        heights[i] = h;
+      else
+        heights[i] = linear(i, dir);
+      positions[i] += dir;
+    }
+  }
+}
+
+double P2Quantile::parabolic(int i, int d) const
+{
+  double n0 = positions[i - 1], n1 = positions[i], n2 = positions[i + 1];
+  return heights[i] + d / (n2 - n0) *
+         ((n1 - n0 + d) * (heights[i + 1] - heights[i]) / (n2 - n1) +
+          (n2 - n1 - d) * (heights[i] - heights[i - 1]) / (n1 - n0));
+}
+
+double P2Quantile::linear(int i, int d) const
+{
+  return heights[i] + d * (heights[i + d] - heights[i]) / (positions[i + d] - positions[i]);
+}
+
+double P2Quantile::getValue() const
+{
+  if(count == 0)
+    return 0.;
+
+  if(count <= 5)
+  {
+    // Exact from sorted samples
+    int index = static_cast<int>(std::round(p * (count - 1)));
+    return heights[index];
+  }
+  return heights[2];
+}
+
+// ==============================================================================================
+SampleStatistics::SampleStatistics(int windowSize)
+  : median(0.5), p10(0.1), p90(0.9)
+{
+  values.resize(std::max(windowSize, 2));
+  times.resize(values.size());
+}
+
+void SampleStatistics::clear()
+{
+  next = numInWindow = count = 0;
+  sumX = sumY = sumXY = sumXX = timeBase = 0.;
+  mean = m2 = minValue = maxValue = 0.;
+  median.clear();
+  p10.clear();
+  p90.clear();
+}
+
+void SampleStatistics::add(double timeSec, float value)
+{
+  // Welford update for mean and variance
+  count++;
+  double delta = value - mean;
+  mean += delta / count;
+  m2 += delta * (value - mean);
+
+  if(count == 1)
+  {
+    minValue = maxValue = value;
+    timeBase = timeSec;
+  }
+  else
+  {
+    minValue = std::min(minValue, static_cast<double>(value));
+    maxValue = std::max(maxValue, static_cast<double>(value));
+  }
+
+  median.add(value);
+  p10.add(value);
+  p90.add(value);
+
+  // Remove oldest sample from regression sums if window is full
+  int size = values.size();
+  if(numInWindow == size)
+  {
+    double x = times.at(next), y = values.at(next);
+    sumX -= x;
+    sumY -= y;
+    sumXY -= x * y;
+    sumXX -= x * x;
+  }
+  else
+    numInWindow++;
+
+  double x = timeSec - timeBase;
+  values[next] = value;
+  times[next] = x;
+  sumX += x;
+  sumY += value;
+  sumXY += x * value;
+  sumXX += x * x;
+  next = (next + 1) % size;
+}
+
+double SampleStatistics::getVariance() const
+{
+  return count > 1 ? m2 / (count - 1) : 0.;
+}
+
+double SampleStatistics::getStdDev() const
+{
+  return std::sqrt(getVariance());
+}
+
+double SampleStatistics::getTrendPerSec() const
+{
+  if(numInWindow < 2)
+    return 0.;
+
+  double n = numInWindow;
+  double denominator = n * sumXX - sumX * sumX;
+  if(std::abs(denominator) < 1.e-9)
+    return 0.;
+
+  return (n * sumXY - sumX * sumY) / denominator;
+}
+
+QVector<float> SampleStatistics::getRecent() const
+{
+  QVector<float> recent;
+  recent.reserve(numInWindow);
+
+  int size = values.size();
+  int first = numInWindow == size ? next : 0;
+  for(int i = 0; i < numInWindow; i++)
+    recent.append(values.at((first + i) % size));
+  return recent;
+}
+
+} // namespace perf
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,148 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_PERF_SAMPLESTATISTICS_H
+#define ATOOLS_FS_PERF_SAMPLESTATISTICS_H
+
+#include <QVector>
+
+namespace atools {
+namespace fs {
+namespace perf {
+
+/*
+ * Streaming estimate of a single quantile using the P-square algorithm by Jain and Chlamtac.
+ * Uses five markers and constant time and memory for each sample. Exact for up to five samples.
+ */
+class P2Quantile
+{
+public:
+  /* quantile in range 0 to 1 like 0.5 for median */
+  explicit P2Quantile(double quantile = 0.5);
+
+  void add(double value);
+  void clear();
+
+  /* Current estimate or 0 if no samples were added */
+  double getValue() const;
+
+  int getCount() const
+  {
+    return count;
+  }
+
+private:
+  double parabolic(int i, int d) const;
+  double linear(int i, int d) const;
+
+  double p;
+
+  /* Marker heights, actual and desired positions and desired position increments */
+  double heights[5], desired[5], increments[5];
+  int positions[5];
+  int count = 0;
+};
+
+/*
+ * Statistics of a series of samples which are updated in constant time per sample.
+ *
+ * Total count, mean, variance (Welford), minimum, maximum and quantiles are calculated over all samples.
+ * The last samples are kept in a fixed size ring buffer which is used for the trend (linear regression slope)
+ * over this window. The regression sums are updated incrementally when samples leave the window.
+ */
+class SampleStatistics
+{
+public:
+  /* windowSize is the number of recent samples kept for the trend and getRecent() */
+  explicit SampleStatistics(int windowSize = 1200);
+
+  /* Add a sample at the given time in seconds. Time has to increase. */
+  void add(double timeSec, float value);
+  void clear();
+
+  int getCount() const
+  {
+    return count;
+  }
+
+  double getMean() const
+  {
+    return mean;
+  }
+
+  /* Sample variance and standard deviation. 0 for less than two samples. */
+  double getVariance() const;
+  double getStdDev() const;
+
+  double getMin() const
+  {
+    return minValue;
+  }
+
+  double getMax() const
+  {
+    return maxValue;
+  }
+
+  /* Estimated quantiles over all samples */
+  double getMedian() const
+  {
+    return median.getValue();
+  }
+
+  double getPercentile10() const
+  {
+    return p10.getValue();
+  }
+
+  double getPercentile90() const
+  {
+    return p90.getValue();
+  }
+
+  /* Change of value per second by linear regression over the samples in the window. 0 for less than two. */
+  double getTrendPerSec() const;
+
+  /* Samples in the window ordered from oldest to newest */
+  QVector<float> getRecent() const;
+
+  int getWindowSize() const
+  {
+    return values.size();
+  }
+
+private:
+  /* Ring buffer with values and times */
+  QVector<float> values;
+  QVector<double> times;
+  int next = 0, numInWindow = 0;
+
+  /* Regression sums for the window. Times are relative to the first sample to keep precision. */
+  double sumX = 0., sumY = 0., sumXY = 0., sumXX = 0., timeBase = 0.;
+
+  /* Welford running mean and sum of squared differences */
+  int count = 0;
+  double mean = 0., m2 = 0., minValue = 0., maxValue = 0.;
+
+  P2Quantile median, p10, p90;
+};
+
+} // namespace perf
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_PERF_SAMPLESTATISTICS_H
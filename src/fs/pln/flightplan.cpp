@@ -37,6 +37,11 @@ Flightplan::Flightplan(const Flightplan& other)
 
 }
 
+Flightplan::Flightplan(Flightplan&& other)
+{
+  this->operator=(std::move(other));
+}
+
 Flightplan::~Flightplan()
 {
 
@@ -64,6 +69,41 @@ Flightplan& Flightplan::operator=(const Flightplan& other)
   return *this;
 }
 
+Flightplan& Flightplan::operator=(Flightplan&& other)
+{
+  flightplanType = other.flightplanType;
+  routeType = other.routeType;
+  cruisingAlt = other.cruisingAlt;
+  appVersionMajor = std::move(other.appVersionMajor);
+  appVersionBuild = std::move(other.appVersionBuild);
+  title = std::move(other.title);
+  departureIdent = std::move(other.departureIdent);
+  destinationIdent = std::move(other.destinationIdent);
+  description = std::move(other.description);
+  departureParkingName = std::move(other.departureParkingName);
+  departureAiportName = std::move(other.departureAiportName);
+  destinationAiportName = std::move(other.destinationAiportName);
+  departurePos = other.departurePos;
+  destinationPos = other.destinationPos;
+  entries = std::move(other.entries);
+  properties = std::move(other.properties);
+  fileFormat = other.fileFormat;
+  return *this;
+}
+
+void Flightplan::appendEntry(FlightplanEntry&& entry)
+{
+  // QList has no rvalue append - move into a default constructed node
+  entries.append(FlightplanEntry());
+  entries.last() = std::move(entry);
+}
+
+void Flightplan::prependEntry(FlightplanEntry&& entry)
+{
+  entries.prepend(FlightplanEntry());
+  entries.first() = std::move(entry);
+}
+
 void Flightplan::removeNoSaveEntries()
 {
   auto it = std::remove_if(entries.begin(), entries.end(),
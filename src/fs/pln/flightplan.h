@@ -44,9 +44,11 @@ class Flightplan
 public:
   Flightplan();
   Flightplan(const atools::fs::pln::Flightplan& other);
+  Flightplan(atools::fs::pln::Flightplan&& other);
   ~Flightplan();
 
   atools::fs::pln::Flightplan& operator=(const atools::fs::pln::Flightplan& other);
+  atools::fs::pln::Flightplan& operator=(atools::fs::pln::Flightplan&& other);
 
   /*
    * @return Get all flight plan entries/waypoints. These include start and destination.
@@ -56,6 +58,10 @@ public:
     return entries;
   }
 
+  /* Add entry by moving it into the list. Entry is empty afterwards. */
+  void appendEntry(atools::fs::pln::FlightplanEntry&& entry);
+  void prependEntry(atools::fs::pln::FlightplanEntry&& entry);
+
   /* Clear out all entries with no save = true */
   void removeNoSaveEntries();
 
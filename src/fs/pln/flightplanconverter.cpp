@@ -0,0 +1,243 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/pln/flightplanconverter.h"
+
+#include "exception.h"
+#include "fs/pln/flightplan.h"
+#include "fs/pln/flightplanio.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+
+namespace atools {
+namespace fs {
+namespace pln {
+
+/* Minimum number of files converted by one pool task */
+static const int CONVERT_MIN_FILES_PER_TASK = 4;
+
+/* Converts a range of files and writes into the given result slots */
+class FlightplanConvertTask :
+  public QRunnable
+{
+public:
+  FlightplanConvertTask(const FlightplanConverter& flightplanConverter, const QStringList& filepaths,
+                        int fromIndex, int toIndex, FlightplanConvertResult *resultList)
+    : converter(flightplanConverter), files(filepaths), from(fromIndex), to(toIndex), results(resultList)
+  {
+    setAutoDelete(true);
+  }
+
+  virtual void run() override
+  {
+    for(int i = from; i < to; i++)
+      convertFile(files.at(i), results[i]);
+  }
+
+  void convertFile(const QString& file, FlightplanConvertResult& result);
+
+private:
+  void save(const FlightplanConverter::Target& target, const QString& outFile);
+
+  const FlightplanConverter& converter;
+  const QStringList& files;
+  int from, to;
+  FlightplanConvertResult *results;
+
+  // Reused for all files of this task
+  FlightplanIO io;
+  Flightplan plan;
+};
+
+void FlightplanConvertTask::convertFile(const QString& file, FlightplanConvertResult& result)
+{
+  result.inputFile = file;
+
+  try
+  {
+    plan.clear();
+    io.load(plan, file);
+  }
+  catch(atools::Exception& e)
+  {
+    result.errors.append(e.getMessage());
+    return;
+  }
+  catch(...)
+  {
+    result.errors.append(FlightplanConverter::tr("Unknown error loading \"%1\"").arg(file));
+    return;
+  }
+
+  QString baseName = QFileInfo(file).completeBaseName();
+  for(const FlightplanConverter::Target& target : converter.targets)
+  {
+    QString outFile = QDir(target.outputDir).filePath(baseName + "." +
+                                                      FlightplanConverter::formatExtension(target.format));
+    try
+    {
+      save(target, outFile);
+      result.outputFiles.append(outFile);
+    }
+    catch(atools::Exception& e)
+    {
+      result.errors.append(e.getMessage());
+    }
+    catch(...)
+    {
+      result.errors.append(FlightplanConverter::tr("Unknown error saving \"%1\"").arg(outFile));
+    }
+  }
+}
+
+void FlightplanConvertTask::save(const FlightplanConverter::Target& target, const QString& outFile)
+{
+  switch(target.format)
+  {
+    case atools::fs::pln::CONVERT_PLN_FSX:
+      io.saveFsx(plan, outFile, target.options);
+      break;
+
+    case atools::fs::pln::CONVERT_FMS3:
+      io.saveFms(plan, outFile, converter.airacCycle, false /* FMS 11 */);
+      break;
+
+    case atools::fs::pln::CONVERT_FMS11:
+      io.saveFms(plan, outFile, converter.airacCycle, true /* FMS 11 */);
+      break;
+
+    case atools::fs::pln::CONVERT_FLP:
+      io.saveFlp(plan, outFile);
+      break;
+
+    case atools::fs::pln::CONVERT_RTE:
+      io.saveRte(plan, outFile);
+      break;
+
+    case atools::fs::pln::CONVERT_FPR:
+      io.saveFpr(plan, outFile);
+      break;
+
+    case atools::fs::pln::CONVERT_FLTPLAN:
+      io.saveFltplan(plan, outFile);
+      break;
+
+    case atools::fs::pln::CONVERT_BBS_PLN:
+      io.saveBbsPln(plan, outFile);
+      break;
+
+    case atools::fs::pln::CONVERT_GARMIN_GNS:
+      io.saveGarminGns(plan, outFile, target.options);
+      break;
+  }
+}
+
+// -------------------------------------------------------------------------------
+FlightplanConverter::FlightplanConverter(int threads)
+  : numThreads(threads > 0 ? threads : std::max(QThread::idealThreadCount(), 1))
+{
+
+}
+
+void FlightplanConverter::addTarget(ConvertFormat format, const QString& outputDir, SaveOptions options)
+{
+  targets.append({format, outputDir, options});
+}
+
+void FlightplanConverter::clearTargets()
+{
+  targets.clear();
+}
+
+QVector<FlightplanConvertResult> FlightplanConverter::convert(const QStringList& files) const
+{
+  QVector<FlightplanConvertResult> results(files.size());
+
+  // Several tasks per thread to balance large and small plans
+  int filesPerTask = std::max(CONVERT_MIN_FILES_PER_TASK, files.size() / (numThreads * 4));
+
+  if(numThreads > 1 && files.size() > filesPerTask)
+  {
+    // Each task writes only its own range of slots
+    FlightplanConvertResult *resultData = results.data();
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+    for(int i = 0; i < files.size(); i += filesPerTask)
+      pool.start(new FlightplanConvertTask(*this, files, i, std::min(i + filesPerTask, files.size()), resultData));
+    pool.waitForDone();
+  }
+  else
+  {
+    FlightplanConvertTask task(*this, files, 0, files.size(), results.data());
+    task.run();
+  }
+
+  numErrors = 0;
+  for(const FlightplanConvertResult& result : results)
+  {
+    if(result.hasErrors())
+    {
+      qWarning() << Q_FUNC_INFO << result.inputFile << result.errors;
+      numErrors++;
+    }
+  }
+
+  qDebug() << Q_FUNC_INFO << "Converted" << files.size() << "files into" << targets.size() << "formats"
+           << numErrors << "errors";
+  return results;
+}
+
+QString FlightplanConverter::formatExtension(ConvertFormat format)
+{
+  switch(format)
+  {
+    case atools::fs::pln::CONVERT_PLN_FSX:
+    case atools::fs::pln::CONVERT_BBS_PLN:
+      return "pln";
+
+    case atools::fs::pln::CONVERT_FMS3:
+    case atools::fs::pln::CONVERT_FMS11:
+      return "fms";
+
+    case atools::fs::pln::CONVERT_FLP:
+      return "flp";
+
+    case atools::fs::pln::CONVERT_RTE:
+      return "rte";
+
+    case atools::fs::pln::CONVERT_FPR:
+      return "fpr";
+
+    case atools::fs::pln::CONVERT_FLTPLAN:
+      return "fltplan";
+
+    case atools::fs::pln::CONVERT_GARMIN_GNS:
+      return "fpl";
+  }
+  return QString();
+}
+
+} // namespace pln
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,116 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_PLN_FLIGHTPLANCONVERTER_H
+#define ATOOLS_FS_PLN_FLIGHTPLANCONVERTER_H
+
+#include "fs/pln/flightplanconstants.h"
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QVector>
+
+namespace atools {
+namespace fs {
+namespace pln {
+
+/* Target formats for batch conversion */
+enum ConvertFormat
+{
+  CONVERT_PLN_FSX, // FSX or P3D XML PLN
+  CONVERT_FMS3, // X-Plane version 3 FMS
+  CONVERT_FMS11, // X-Plane version 11 FMS
+  CONVERT_FLP, // Aerosoft airbus or FlightFactor Boeing
+  CONVERT_RTE, // PMDG RTE
+  CONVERT_FPR, // Majestic Dash 400 binary
+  CONVERT_FLTPLAN, // iFly FLTPLAN
+  CONVERT_BBS_PLN, // Blackbox Simulations Airbus PLN
+  CONVERT_GARMIN_GNS // Reality XP GNS XML
+};
+
+/* Result of one input file. Output files are in the order of the targets. */
+struct FlightplanConvertResult
+{
+  QString inputFile;
+  QStringList outputFiles, errors;
+
+  bool hasErrors() const
+  {
+    return !errors.isEmpty();
+  }
+
+};
+
+/*
+ * Loads flight plans and saves them in one or more target formats using a thread pool.
+ *
+ * Each pool task has its own FlightplanIO and Flightplan which are reused for all files of the task.
+ * Errors are collected per file and do not stop the conversion of other files.
+ */
+class FlightplanConverter
+{
+  Q_DECLARE_TR_FUNCTIONS(FlightplanConverter)
+
+public:
+  /* Uses numThreads or the ideal thread count if 0 */
+  explicit FlightplanConverter(int numThreads = 0);
+
+  /* Add a target format. Files are written into outputDir using the base name of the input file and the
+   * extension of the format. */
+  void addTarget(atools::fs::pln::ConvertFormat format, const QString& outputDir,
+                 atools::fs::pln::SaveOptions options = atools::fs::pln::SAVE_NO_OPTIONS);
+  void clearTargets();
+
+  /* Cycle is written into FMS files */
+  void setAiracCycle(const QString& value)
+  {
+    airacCycle = value;
+  }
+
+  /* Convert all files into all targets. Returns one result for each input file in the same order. */
+  QVector<atools::fs::pln::FlightplanConvertResult> convert(const QStringList& files) const;
+
+  /* Number of files having errors in the last conversion */
+  int getNumErrors() const
+  {
+    return numErrors;
+  }
+
+  /* File extension without dot */
+  static QString formatExtension(atools::fs::pln::ConvertFormat format);
+
+private:
+  friend class FlightplanConvertTask;
+
+  struct Target
+  {
+    ConvertFormat format;
+    QString outputDir;
+    SaveOptions options;
+  };
+
+  int numThreads;
+  QString airacCycle;
+  QVector<Target> targets;
+  mutable int numErrors = 0;
+};
+
+} // namespace pln
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_PLN_FLIGHTPLANCONVERTER_H
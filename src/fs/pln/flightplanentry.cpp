@@ -17,6 +17,8 @@
 
 #include "fs/pln/flightplanentry.h"
 
+#include "util/stringpool.h"
+
 namespace atools {
 namespace fs {
 namespace pln {
@@ -30,24 +32,9 @@ FlightplanEntry::~FlightplanEntry()
 
 }
 
-FlightplanEntry::FlightplanEntry(const FlightplanEntry& other)
-{
-  this->operator=(other);
-
-}
-
-FlightplanEntry& FlightplanEntry::operator=(const FlightplanEntry& other)
+QString FlightplanEntry::intern(const QString& str)
 {
-  waypointType = other.waypointType;
-  waypointId = other.waypointId;
-  airway = other.airway;
-  icaoRegion = other.icaoRegion;
-  icaoIdent = other.icaoIdent;
-  name = other.name;
-  magvar = other.magvar;
-  position = other.position;
-  noSave = other.noSave;
-  return *this;
+  return atools::util::StringPool::instance().intern(str);
 }
 
 const QString& FlightplanEntry::getWaypointTypeAsString() const
@@ -27,7 +27,8 @@ namespace fs {
 namespace pln {
 
 namespace entry {
-enum WaypointType
+/* Stored as one byte in FlightplanEntry */
+enum WaypointType : quint8
 {
   UNKNOWN,
   AIRPORT,
@@ -41,15 +42,20 @@ enum WaypointType
 
 /*
  * Waypoint or airport as part of the flight plan. Also covers departure and destination airports.
+ *
+ * Waypoint id, ICAO ident, region and airway are interned in a global pool. Entries having the same
+ * idents share the string data which saves memory for long routes and many plans kept in memory.
  */
 class FlightplanEntry
 {
 public:
   FlightplanEntry();
-  FlightplanEntry(const atools::fs::pln::FlightplanEntry& other);
+  FlightplanEntry(const atools::fs::pln::FlightplanEntry& other) = default;
+  FlightplanEntry(atools::fs::pln::FlightplanEntry&& other) = default;
   ~FlightplanEntry();
 
-  FlightplanEntry& operator=(const atools::fs::pln::FlightplanEntry& other);
+  FlightplanEntry& operator=(const atools::fs::pln::FlightplanEntry& other) = default;
+  FlightplanEntry& operator=(atools::fs::pln::FlightplanEntry&& other) = default;
 
   /*
    * @return waypoint type as string like "VOR", "Waypoint" or "User"
@@ -79,7 +85,7 @@ public:
 
   void setWaypointId(const QString& value)
   {
-    waypointId = value;
+    waypointId = intern(value);
   }
 
   /*
@@ -92,7 +98,7 @@ public:
 
   void setAirway(const QString& value)
   {
-    airway = value;
+    airway = intern(value);
   }
 
   /*
@@ -105,7 +111,7 @@ public:
 
   void setIcaoRegion(const QString& value)
   {
-    icaoRegion = value;
+    icaoRegion = intern(value);
   }
 
   /*
@@ -118,7 +124,7 @@ public:
 
   void setIcaoIdent(const QString& value)
   {
-    icaoIdent = value;
+    icaoIdent = intern(value);
   }
 
   /*
@@ -180,10 +186,14 @@ private:
   static const QString& waypointTypeToString(atools::fs::pln::entry::WaypointType type);
   static atools::fs::pln::entry::WaypointType stringToWaypointType(const QString& str);
 
-  atools::fs::pln::entry::WaypointType waypointType = entry::UNKNOWN;
+  /* Get shared instance of the string from the pool. Long strings are returned unchanged. */
+  static QString intern(const QString& str);
+
+  // Ordered by size to avoid padding
   QString waypointId, airway, icaoRegion, icaoIdent, name;
   atools::geo::Pos position;
   float magvar = 0.f;
+  atools::fs::pln::entry::WaypointType waypointType = entry::UNKNOWN;
   bool noSave = false;
 };
 
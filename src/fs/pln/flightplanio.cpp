@@ -30,7 +30,12 @@
 #include <QDateTime>
 #include <QFile>
 #include <QFileInfo>
+#include <QDir>
 #include <QRegularExpression>
+#include <QRunnable>
+#include <QTextCodec>
+#include <QThread>
+#include <QThreadPool>
 #include <QXmlStreamReader>
 
 using atools::geo::Pos;
@@ -48,6 +53,17 @@ static const QRegularExpression FS9_MATCH(
   "(^appversion\\s*=|^title\\s*=|^description\\s*=|^type\\s*=|"
   "^routetype\\s*=|^cruising_altitude\\s*=|^departure_id\\s*=|^destination_id\\s*=)");
 
+/* Bytes read for format detection. Second size is used only if lines were cut off by the first. */
+static const qint64 PROBE_PREFIX_SIZE = 4096;
+static const qint64 PROBE_PREFIX_SIZE_MAX = 65536;
+
+/* Number of non empty lines and maximum number of bytes per line used for format detection */
+static const int PROBE_NUM_LINES = 4;
+static const int PROBE_LINE_LENGTH = 256;
+
+/* Minimum number of files probed by one pool task */
+static const int PROBE_MIN_FILES_PER_TASK = 16;
+
 /* Format structs for the Majestic Software MJC8 Q400.
  * Structs need to be packed to avoid padding. */
 namespace fpr {
@@ -105,6 +121,30 @@ struct FprPlan
 
 } // namespace fpr
 
+/* Detects the format for a range of files and writes the results into the given slots */
+class FlightplanProbeTask :
+  public QRunnable
+{
+public:
+  FlightplanProbeTask(const QStringList& filepaths, int fromIndex, int toIndex, FileFormat *formatList)
+    : files(filepaths), from(fromIndex), to(toIndex), formats(formatList)
+  {
+    setAutoDelete(true);
+  }
+
+  virtual void run() override
+  {
+    for(int i = from; i < to; i++)
+      formats[i] = FlightplanIO::detectFormat(files.at(i));
+  }
+
+private:
+  const QStringList& files;
+  int from, to;
+  FileFormat *formats;
+};
+
+// -------------------------------------------------------------------------------
 FlightplanIO::FlightplanIO()
 {
 
@@ -117,46 +157,44 @@ FlightplanIO::~FlightplanIO()
 
 void FlightplanIO::load(atools::fs::pln::Flightplan& plan, const QString& file)
 {
-  // Get first four non empty lines - always returns a list of four
-  QStringList lines = probeFile4(file);
+  // Look at the first four non empty lines
+  QString errorMessage;
+  bool empty = false;
+  FileFormat format = probeFile(file, &errorMessage, &empty);
+
+  if(!errorMessage.isEmpty())
+    throw Exception("Error reading \"" + file + "\": " + errorMessage);
 
-  if(lines.isEmpty())
+  if(empty)
     throw Exception(tr("Cannot open empty flight plan file \"%1\".").arg(file));
 
-  if(lines.first().startsWith("[corte]"))
-    // FLP: [CoRte]
-    loadFlp(plan, file);
-  else if(lines.at(0).startsWith("<?xml version") && lines.at(1).startsWith("<simbase.document"))
-    // FSX PLN <?xml version
-    loadFsx(plan, file);
-  else if(lines.at(0).startsWith("[flightplan]") && FS9_MATCH.match(lines.at(1)).hasMatch())
-    // FS9 ini format
-    loadFs9(plan, file);
-  else if(lines.at(0).startsWith("[fscfp]"))
-    // FSC ini format
-    loadFsc(plan, file);
-  else if((lines.at(0) == "i" || lines.at(0) == "a") &&
-          lines.at(1).startsWith("3 version") &&
-          lines.at(2).at(0).isDigit() &&
-          lines.at(3).at(0).isDigit())
-    // Old format
-    // I
-    // 3 version
-    // 1
-    // 4
-    loadFms(plan, file);
-  else if((lines.at(0) == "i" || lines.at(0) == "a") &&
-          lines.at(1).startsWith("1100 version") &&
-          lines.at(2).startsWith("cycle"))
-    // New v11 format
-    // I
-    // 1100 Version
-    // CYCLE 1710
-    loadFms(plan, file);
-  else
-    throw Exception(tr("Cannot open flight plan file \"%1\". No supported flight plan format detected. "
-                       "Only PLN (FSX XML, FS9 INI and FSC), FMS and FLP are supported.").arg(file));
+  switch(format)
+  {
+    case atools::fs::pln::FLP:
+      loadFlp(plan, file);
+      break;
+
+    case atools::fs::pln::PLN_FSX:
+      loadFsx(plan, file);
+      break;
+
+    case atools::fs::pln::PLN_FS9:
+      loadFs9(plan, file);
+      break;
+
+    case atools::fs::pln::PLN_FSC:
+      loadFsc(plan, file);
+      break;
 
+    case atools::fs::pln::FMS3:
+    case atools::fs::pln::FMS11:
+      loadFms(plan, file);
+      break;
+
+    case atools::fs::pln::NONE:
+      throw Exception(tr("Cannot open flight plan file \"%1\". No supported flight plan format detected. "
+                         "Only PLN (FSX XML, FS9 INI and FSC), FMS and FLP are supported.").arg(file));
+  }
 }
 
 void FlightplanIO::loadFlp(atools::fs::pln::Flightplan& plan, const QString& file)
@@ -223,7 +261,7 @@ void FlightplanIO::loadFlp(atools::fs::pln::Flightplan& plan, const QString& fil
             if(wptNum != -1)
             {
               // not the first iteration
-              plan.entries.append(entry);
+              plan.appendEntry(std::move(entry));
               entry = FlightplanEntry();
             }
             wptNum = num;
@@ -248,7 +286,7 @@ void FlightplanIO::loadFlp(atools::fs::pln::Flightplan& plan, const QString& fil
           {
             if(wptNum != -1)
             {
-              plan.entries.append(entry);
+              plan.appendEntry(std::move(entry));
               entry = FlightplanEntry();
             }
             wptNum = num;
@@ -263,7 +301,7 @@ void FlightplanIO::loadFlp(atools::fs::pln::Flightplan& plan, const QString& fil
               FlightplanEntry from;
               from.setIcaoIdent(value);
               from.setWaypointId(value);
-              plan.entries.append(from);
+              plan.appendEntry(std::move(from));
             }
           }
           else if(fromTo.toLower() == "to")
@@ -293,9 +331,9 @@ void FlightplanIO::loadFlp(atools::fs::pln::Flightplan& plan, const QString& fil
         }
       }
     }
-    plan.entries.append(entry);
-    plan.entries.prepend(departure);
-    plan.entries.append(destination);
+    plan.appendEntry(std::move(entry));
+    plan.prependEntry(std::move(departure));
+    plan.appendEntry(std::move(destination));
 
     flpFile.close();
     plan.flightplanType = IFR;
@@ -498,7 +536,7 @@ void FlightplanIO::loadFms(atools::fs::pln::Flightplan& plan, const QString& fil
           entry.setWaypointId(ident);
           entry.setAirway(airway);
 
-          plan.entries.append(entry);
+          plan.appendEntry(std::move(entry));
         }
         else
           throw Exception(tr("Invalid FMS file. Number of sections is not %2: %1").
@@ -604,13 +642,13 @@ void FlightplanIO::loadFsc(atools::fs::pln::Flightplan& plan, const QString& fil
           else if(type == "uwp" || !atools::fs::util::isValidIdent(ident))
             entry.setWaypointType(atools::fs::pln::entry::USER);
 
-          plan.entries.append(entry);
+          plan.appendEntry(std::move(entry));
         }
       }
     }
 
-    plan.entries.prepend(departure);
-    plan.entries.append(destination);
+    plan.prependEntry(std::move(departure));
+    plan.appendEntry(std::move(destination));
 
     plnFile.close();
 
@@ -751,7 +789,7 @@ void FlightplanIO::loadFs9(atools::fs::pln::Flightplan& plan, const QString& fil
               throw Exception(tr("Invalid flight plan file \"%1\".").arg(file));
           }
 
-          plan.entries.append(entry);
+          plan.appendEntry(std::move(entry));
         }
         // else if(key == "alternate_name") ignore
       }
@@ -2002,35 +2040,168 @@ const QStringList& FlightplanIO::getAcceptedFlightPlanExtensions()
   return ACCEPTED_EXTENSIONS;
 }
 
-QStringList FlightplanIO::probeFile4(const QString& file)
+FileFormat FlightplanIO::detectFormat(const QString& file)
+{
+  return probeFile(file, nullptr, nullptr);
+}
+
+FileFormat FlightplanIO::detectFormatFromPrefix(const QByteArray& prefix)
+{
+  int numLines = 0;
+  return formatFromPrefix(prefix, numLines);
+}
+
+QVector<FileFormat> FlightplanIO::detectFormats(const QStringList& files, int numThreads)
+{
+  QVector<FileFormat> formats(files.size(), NONE);
+
+  if(numThreads <= 0)
+    numThreads = std::max(QThread::idealThreadCount(), 1);
+
+  // Probing is dominated by file open latency - use several tasks per thread to balance slow files
+  int filesPerTask = std::max(PROBE_MIN_FILES_PER_TASK, files.size() / (numThreads * 4));
+
+  if(numThreads > 1 && files.size() > filesPerTask)
+  {
+    // Each task writes only its own range of slots
+    FileFormat *results = formats.data();
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+    for(int i = 0; i < files.size(); i += filesPerTask)
+      pool.start(new FlightplanProbeTask(files, i, std::min(i + filesPerTask, files.size()), results));
+    pool.waitForDone();
+  }
+  else
+  {
+    for(int i = 0; i < files.size(); i++)
+      formats[i] = detectFormat(files.at(i));
+  }
+  return formats;
+}
+
+QMap<QString, FileFormat> FlightplanIO::detectFormatsInDirectory(const QString& dir, int numThreads)
+{
+  QStringList filters;
+  for(const QString& ext : ACCEPTED_EXTENSIONS)
+    filters.append("*." + ext);
+
+  QStringList files;
+  for(const QFileInfo& fileinfo : QDir(dir).entryInfoList(filters, QDir::Files | QDir::Readable, QDir::Name))
+    files.append(fileinfo.filePath());
+
+  QVector<FileFormat> formats = detectFormats(files, numThreads);
+
+  QMap<QString, FileFormat> result;
+  for(int i = 0; i < files.size(); i++)
+    result.insert(files.at(i), formats.at(i));
+  return result;
+}
+
+FileFormat FlightplanIO::probeFile(const QString& file, QString *errorMessage, bool *empty)
 {
   QFile testFile(file);
+  if(!testFile.open(QIODevice::ReadOnly))
+  {
+    if(errorMessage != nullptr)
+      *errorMessage = testFile.errorString();
+    return NONE;
+  }
 
-  QStringList lines;
-  if(testFile.open(QIODevice::ReadOnly))
+  qint64 fileSize = testFile.size();
+  FileFormat format = NONE;
+  int numLines = 0;
+  for(qint64 prefixSize : {PROBE_PREFIX_SIZE, PROBE_PREFIX_SIZE_MAX})
   {
-    QTextStream stream(&testFile);
-    stream.setCodec("UTF-8");
-    stream.setAutoDetectUnicode(true);
-    int numLines = 0;
-    while(!stream.atEnd() && numLines < 4)
+    qint64 size = std::min(fileSize, prefixSize);
+
+    // Map the prefix if possible which avoids copying - fall back to reading for unsupported file systems
+    uchar *mem = size > 0 ? testFile.map(0, size) : nullptr;
+    if(mem != nullptr)
     {
-      QString line = stream.readLine().trimmed();
-      if(!line.isEmpty())
-      {
-        lines.append(line.toLower().simplified());
-        numLines++;
-      }
+      format = formatFromPrefix(QByteArray::fromRawData(reinterpret_cast<const char *>(mem), static_cast<int>(size)),
+                                numLines);
+      testFile.unmap(mem);
+    }
+    else
+    {
+      testFile.seek(0);
+      format = formatFromPrefix(testFile.read(size), numLines);
     }
 
-    for(int i = lines.size(); i < 4; i++)
-      lines.append(QString());
-    testFile.close();
+    // Read more only if the prefix ended before all lines were found
+    if(format != NONE || numLines >= PROBE_NUM_LINES || size >= fileSize)
+      break;
   }
-  else
-    throw Exception("Error reading \"" + filename + "\": " + testFile.errorString());
+  testFile.close();
 
-  return lines;
+  if(empty != nullptr)
+    *empty = numLines == 0;
+  return format;
+}
+
+FileFormat FlightplanIO::formatFromPrefix(const QByteArray& prefix, int& numLines)
+{
+  QByteArray data(prefix);
+  int pos = 0;
+  if(data.startsWith("\xef\xbb\xbf"))
+    // Skip UTF-8 BOM
+    pos = 3;
+  else if(data.startsWith("\xff\xfe") || data.startsWith("\xfe\xff"))
+    // Convert only the prefix of UTF-16 files - codec is detected by BOM
+    data = QTextCodec::codecForUtfText(data)->toUnicode(data).toUtf8();
+
+  // Get first four non empty lines converted to lowercase
+  QByteArray lines[PROBE_NUM_LINES];
+  numLines = 0;
+  while(pos < data.size() && numLines < PROBE_NUM_LINES)
+  {
+    int end = data.indexOf('\n', pos);
+    if(end == -1)
+      end = data.size();
+
+    // Only the start of a line is needed for comparison
+    QByteArray line = data.mid(pos, std::min(end - pos, PROBE_LINE_LENGTH)).simplified();
+    if(!line.isEmpty())
+      lines[numLines++] = line.toLower();
+    pos = end + 1;
+  }
+
+  auto startsWithDigit = [](const QByteArray& line) -> bool {
+                           return !line.isEmpty() && line.at(0) >= '0' && line.at(0) <= '9';
+                         };
+
+  if(lines[0].startsWith("[corte]"))
+    // FLP: [CoRte]
+    return FLP;
+  else if(lines[0].startsWith("<?xml version") && lines[1].startsWith("<simbase.document"))
+    // FSX PLN <?xml version
+    return PLN_FSX;
+  else if(lines[0].startsWith("[flightplan]") && FS9_MATCH.match(QString::fromUtf8(lines[1])).hasMatch())
+    // FS9 ini format
+    return PLN_FS9;
+  else if(lines[0].startsWith("[fscfp]"))
+    // FSC ini format
+    return PLN_FSC;
+  else if((lines[0] == "i" || lines[0] == "a") &&
+          lines[1].startsWith("3 version") &&
+          startsWithDigit(lines[2]) &&
+          startsWithDigit(lines[3]))
+    // Old format
+    // I
+    // 3 version
+    // 1
+    // 4
+    return FMS3;
+  else if((lines[0] == "i" || lines[0] == "a") &&
+          lines[1].startsWith("1100 version") &&
+          lines[2].startsWith("cycle"))
+    // New v11 format
+    // I
+    // 1100 Version
+    // CYCLE 1710
+    return FMS11;
+  else
+    return NONE;
 }
 
 QString FlightplanIO::flightplanTypeToString(FlightplanType type)
@@ -2130,16 +2301,21 @@ void FlightplanIO::adjustDepartureAndDestination(atools::fs::pln::Flightplan& pl
 {
   if(!plan.entries.isEmpty())
   {
+    // Use const references to avoid detaching and copying the entries
+    const QList<FlightplanEntry>& entries = plan.entries;
+    const FlightplanEntry& first = entries.first();
+    const FlightplanEntry& last = entries.last();
+
     if(plan.departureIdent.isEmpty())
-      plan.departureIdent = plan.entries.first().getIcaoIdent();
+      plan.departureIdent = first.getIcaoIdent();
     if(!plan.departurePos.isValid())
-      plan.departurePos = plan.entries.first().getPosition();
+      plan.departurePos = first.getPosition();
 
     if(plan.destinationIdent.isEmpty())
-      plan.destinationIdent = plan.entries.last().getIcaoIdent();
+      plan.destinationIdent = last.getIcaoIdent();
 
     if(!plan.destinationPos.isValid())
-      plan.destinationPos = plan.entries.last().getPosition();
+      plan.destinationPos = last.getPosition();
 
     if(plan.title.isEmpty())
       plan.title = QString("%1 to %2").arg(plan.departureIdent).arg(plan.destinationIdent);
@@ -2277,7 +2453,7 @@ void FlightplanIO::readWaypoint(atools::fs::pln::Flightplan& plan, QXmlStreamRea
     else
       reader.skipCurrentElement();
   }
-  plan.entries.append(entry);
+  plan.appendEntry(std::move(entry));
 }
 
 } // namespace pln
@@ -21,6 +21,8 @@
 #include "fs/pln/flightplanconstants.h"
 
 #include <QApplication>
+#include <QMap>
+#include <QVector>
 
 class QXmlStreamReader;
 
@@ -102,10 +104,29 @@ public:
 
   static const QStringList& getAcceptedFlightPlanExtensions();
 
+  /* Detect the format of a flight plan file by looking at the first few non empty lines. Maps or reads only a
+   * small prefix of the file and does not decode the rest. Returns NONE if the format is not supported or
+   * the file cannot be read. */
+  static atools::fs::pln::FileFormat detectFormat(const QString& file);
+
+  /* Detect the format from the first bytes of a file. Accepts UTF-8 with or without BOM and UTF-16 with BOM. */
+  static atools::fs::pln::FileFormat detectFormatFromPrefix(const QByteArray& prefix);
+
+  /* Detect formats of all files in parallel using numThreads or the ideal thread count if 0.
+   * Returns a list in the same order as files. */
+  static QVector<atools::fs::pln::FileFormat> detectFormats(const QStringList& files, int numThreads = 0);
+
+  /* Detect formats of all files having an accepted extension in the directory. Not recursive.
+   * Key is the file path. */
+  static QMap<QString, atools::fs::pln::FileFormat> detectFormatsInDirectory(const QString& dir, int numThreads = 0);
+
 private:
-  /* Get the first four lines of a file converted to lowercase to check type.
-   *  Returns a list with always four strings. */
-  QStringList probeFile4(const QString& file);
+  /* Detect format from a bounded file prefix. Retries once with a larger prefix if lines were cut off.
+   * Error message is set if the file cannot be opened and empty is set if no non empty line was found. */
+  static atools::fs::pln::FileFormat probeFile(const QString& file, QString *errorMessage, bool *empty);
+
+  /* Check the first four non empty lines of the prefix. numLines returns the number of non empty lines found. */
+  static atools::fs::pln::FileFormat formatFromPrefix(const QByteArray& prefix, int& numLines);
 
   /* Load specific formats after content detection */
   void loadFsx(atools::fs::pln::Flightplan& plan, const QString& file);
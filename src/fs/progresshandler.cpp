@@ -18,6 +18,8 @@
 #include "fs/progresshandler.h"
 #include "fs/navdatabaseoptions.h"
 #include "fs/scenery/sceneryarea.h"
+#include "util/memoryinfo.h"
+#include "util/tracerecorder.h"
 
 #include <QDebug>
 
@@ -50,6 +52,22 @@ bool ProgressHandler::reportOtherMsg(const QString& otherAction)
   return callHandler();
 }
 
+bool ProgressHandler::reportOtherThrottled(const QString& otherAction, int increase)
+{
+  info.current += increase;
+
+  if(reportTimer.isValid() && reportTimer.elapsed() < reportIntervalMs)
+    // Too early - keep counting only
+    return isAborted();
+
+  info.otherAction = otherAction;
+  info.newFile = false;
+  info.newSceneryArea = false;
+  info.newOther = true;
+
+  return callHandler();
+}
+
 bool ProgressHandler::reportOther(const QString& otherAction, int current, bool silent)
 {
   if(current != -1)
@@ -116,6 +134,106 @@ void ProgressHandler::reset()
   info.newOther = false;
   info.firstCall = true;
   info.lastCall = false;
+  abortedFlag.storeRelease(0);
+  pendingCurrent.storeRelease(0);
+  pendingObjectsWritten.storeRelease(0);
+  pendingErrors.storeRelease(0);
+  reportTimer.invalidate();
+
+  stageTimings.clear();
+  stageStack.clear();
+  bytesRead = 0;
+}
+
+void ProgressHandler::startStage(const QString& name)
+{
+  StageTiming timing;
+  timing.name = name;
+  timing.level = stageStack.size();
+
+  RunningStage stage;
+  stage.index = stageTimings.size();
+  stage.traced = atools::util::TraceRecorder::isEnabled();
+  if(stage.traced)
+    atools::util::TraceRecorder::begin(name, "stage");
+
+  collectConcurrentCounters();
+  stage.bytesRead = bytesRead;
+  stage.objectsWritten = info.numObjectsWritten;
+  stage.memoryKb = atools::util::MemoryInfo::currentRssKb();
+  stage.peakKb = atools::util::MemoryInfo::peakRssKb();
+  stage.timer.start();
+
+  // Keep order of start
+  stageTimings.append(timing);
+  stageStack.append(stage);
+}
+
+void ProgressHandler::finishStage(int rowsAffected)
+{
+  if(stageStack.isEmpty())
+    return;
+
+  RunningStage stage = stageStack.takeLast();
+  StageTiming& timing = stageTimings[stage.index];
+
+  collectConcurrentCounters();
+  timing.milliseconds = stage.timer.elapsed();
+  timing.bytesRead = bytesRead - stage.bytesRead;
+  timing.rowsAffected = rowsAffected < 0 ? info.numObjectsWritten - stage.objectsWritten : rowsAffected;
+
+  timing.memoryKb = atools::util::MemoryInfo::currentRssKb();
+  timing.memoryPeakKb = atools::util::MemoryInfo::peakRssKb();
+  if(timing.memoryKb >= 0 && stage.memoryKb >= 0)
+    timing.memoryChangeKb = timing.memoryKb - stage.memoryKb;
+  if(timing.memoryPeakKb >= 0 && stage.peakKb >= 0)
+    timing.peakIncreaseKb = timing.memoryPeakKb - stage.peakKb;
+
+  if(stage.traced)
+    atools::util::TraceRecorder::end(timing.name, "stage");
+
+  checkMemoryLimit(timing.memoryKb);
+}
+
+void ProgressHandler::checkMemoryLimit(qint64 memoryKb)
+{
+  if(memoryLimitKb > 0 && memoryKb > memoryLimitKb && memoryLimitCallback)
+  {
+    qWarning() << Q_FUNC_INFO << "Memory" << memoryKb << "kB exceeds soft limit" << memoryLimitKb << "kB";
+    memoryLimitCallback(memoryKb);
+  }
+}
+
+void ProgressHandler::logStageTimings() const
+{
+  QDebug out(qInfo());
+  printStageTimings(out);
+}
+
+void ProgressHandler::printStageTimings(QDebug& out) const
+{
+  QDebugStateSaver saver(out);
+  out.noquote().nospace();
+
+  qint64 total = 0;
+  out << endl << "======================================================================" << endl;
+  out << QString("%1 %2 %3 %4 %5 %6").
+    arg("Stage", -50).arg("Time ms", 10).arg("Rows", 10).arg("Bytes read", 14).arg("Memory kB", 12).arg("Peak +kB", 10)
+      << endl;
+  for(const StageTiming& stage : stageTimings)
+  {
+    // Indent sub-stages
+    QString name = (QString(stage.level * 2, ' ') + stage.name).left(50);
+    out << QString("%1 %2 %3 %4 %5 %6").
+      arg(name, -50).arg(stage.milliseconds, 10).arg(stage.rowsAffected, 10).arg(stage.bytesRead, 14).
+      arg(stage.memoryKb, 12).arg(stage.peakIncreaseKb, 10) << endl;
+
+    // Sub-stages are already contained in the parent stage
+    if(stage.level == 0)
+      total += stage.milliseconds;
+  }
+  out << QString("%1 %2").arg("Total", -50).arg(total, 10) << endl;
+  out << "======================================================================";
 }
 
 bool ProgressHandler::reportSceneryArea(const scenery::SceneryArea *sceneryArea, int current)
@@ -137,6 +255,9 @@ bool ProgressHandler::callHandler()
 {
   bool retval = false;
 
+  collectConcurrentCounters();
+  reportTimer.start();
+
   // Alway call default handler - this one cannot call cancel
   defaultHandler(info);
 
@@ -144,12 +265,22 @@ bool ProgressHandler::callHandler()
     // Call user handler
     retval = handler(info);
 
+  if(retval)
+    abortedFlag.storeRelease(1);
+
   if(info.firstCall)
     info.firstCall = false;
 
   return retval;
 }
 
+void ProgressHandler::collectConcurrentCounters()
+{
+  info.current += pendingCurrent.fetchAndStoreRelaxed(0);
+  info.numObjectsWritten += pendingObjectsWritten.fetchAndStoreRelaxed(0);
+  info.numErrors += pendingErrors.fetchAndStoreRelaxed(0);
+}
+
 /*
  * Default handler prints to console or log only
  */
@@ -21,12 +21,38 @@
 #include "fs/navdatabaseprogress.h"
 #include "fs/navdatabaseoptions.h"
 
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <functional>
+
+class QDebug;
+
 namespace atools {
 namespace fs {
 namespace scenery {
 class SceneryArea;
 }
 
+/*
+ * Wall time and counters for one step of the compilation process.
+ */
+struct StageTiming
+{
+  QString name;
+
+  /* Nesting depth. 0 for top level stages which are summed up for the total. */
+  int level = 0;
+  qint64 milliseconds = 0;
+  int rowsAffected = 0;
+  qint64 bytesRead = 0;
+
+  /* Resident process memory in kB at end of stage, its change during the stage and the process peak at end of the
+   * stage. A stage raising the peak shows peakIncreaseKb > 0. All -1 if not available. */
+  qint64 memoryKb = -1, memoryChangeKb = -1, memoryPeakKb = -1, peakIncreaseKb = -1;
+};
+
 /*
  * Progress handler. Fills the NavDatabaseProgress object with information and calls the progress callback.
  */
@@ -67,6 +93,42 @@ public:
   /* Only send message without incrementing progress */
   bool reportOtherMsg(const QString& otherAction);
 
+  /*
+   * Increment progress by increase and send message about other processes but call the handler only if the
+   * report interval has passed since the last call. Cheap enough to be called for each row.
+   * Returns true if aborted.
+   */
+  bool reportOtherThrottled(const QString& otherAction, int increase = 1);
+
+  /* Minimum time between two callbacks for reportOtherThrottled. Default is 500 ms. */
+  void setReportIntervalMs(int value)
+  {
+    reportIntervalMs = value;
+  }
+
+  /* Thread safe lock free counters which can be incremented from worker threads. Values are added to the progress
+   * information on the next callback which has to be triggered by the thread owning this handler. */
+  void incCurrentConcurrent(int value = 1)
+  {
+    pendingCurrent.fetchAndAddRelaxed(value);
+  }
+
+  void incNumObjectsWrittenConcurrent(int value = 1)
+  {
+    pendingObjectsWritten.fetchAndAddRelaxed(value);
+  }
+
+  void reportErrorConcurrent()
+  {
+    pendingErrors.fetchAndAddRelaxed(1);
+  }
+
+  /* true if a callback returned true to abort. Thread safe and cheap enough to be polled by worker threads. */
+  bool isAborted() const
+  {
+    return abortedFlag.loadAcquire() == 1;
+  }
+
   /* set total amount of progress steps */
   void setTotal(int total);
 
@@ -177,6 +239,40 @@ public:
     info.numObjectsWritten += value;
   }
 
+  /* Increase number of bytes read from scenery files */
+  void incBytesRead(qint64 value)
+  {
+    bytesRead += value;
+  }
+
+  /* Start timing of a compilation stage. Stages can be nested and a stage started while another one is running
+   * becomes a sub-stage of the running one. */
+  void startStage(const QString& name);
+
+  /* Finish the innermost running stage. Number of rows affected is taken from the objects written
+   * since start of the stage if rowsAffected is negative. */
+  void finishStage(int rowsAffected = -1);
+
+  /* Get all stages in order of start. Stages still running have a time of 0. */
+  const QVector<atools::fs::StageTiming>& getStageTimings() const
+  {
+    return stageTimings;
+  }
+
+  /* Print a table of all stages to the info log channel */
+  void logStageTimings() const;
+
+  /* Print a table of all stages with sub-stages indented. Total is summed up from top level stages. */
+  void printStageTimings(QDebug& out) const;
+
+  /* Called at stage boundaries with current resident memory in kB if it exceeds the limit.
+   * Can be used to commit or to shrink caches. A limit <= 0 disables the check. */
+  void setMemorySoftLimit(qint64 limitKb, const std::function<void(qint64 memoryKb)>& callback)
+  {
+    memoryLimitKb = limitKb;
+    memoryLimitCallback = callback;
+  }
+
 private:
   void defaultHandler(const atools::fs::NavDatabaseProgress& inf);
 
@@ -184,8 +280,41 @@ private:
 
   atools::fs::NavDatabaseProgress info;
 
+  /* Running stage and counters at its start */
+  struct RunningStage
+  {
+    int index; // in stageTimings
+    QElapsedTimer timer;
+    qint64 bytesRead, memoryKb, peakKb;
+    int objectsWritten;
+    bool traced; // Begin of stage was recorded in TraceRecorder
+  };
+
+  /* Stage timing */
+  QVector<atools::fs::StageTiming> stageTimings;
+  QVector<RunningStage> stageStack;
+  qint64 bytesRead = 0;
+
+  /* Soft memory limit */
+  qint64 memoryLimitKb = 0;
+  std::function<void(qint64 memoryKb)> memoryLimitCallback;
+
+  /* Call soft limit callback if memory exceeds limit */
+  void checkMemoryLimit(qint64 memoryKb);
+
   bool callHandler();
 
+  QAtomicInt abortedFlag = 0;
+
+  /* Add values of the concurrent counters to info and reset them */
+  void collectConcurrentCounters();
+
+  QAtomicInt pendingCurrent = 0, pendingObjectsWritten = 0, pendingErrors = 0;
+
+  /* Throttling for reportOtherThrottled - restarted on each callback */
+  QElapsedTimer reportTimer;
+  int reportIntervalMs = 500;
+
   QString numbersAsString(const atools::fs::NavDatabaseProgress& inf);
 
 };
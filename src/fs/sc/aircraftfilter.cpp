@@ -0,0 +1,192 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/sc/aircraftfilter.h"
+
+#include "fs/sc/simconnectaircraft.h"
+#include "geo/calculations.h"
+#include "geo/pos.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+using atools::geo::Pos;
+
+void AircraftFilter::filter(QVector<int>& indexes, const Pos& userPos, const QVector<Pos>& positions) const
+{
+  indexes.clear();
+  indexes.reserve(positions.size());
+
+  if(!isActive() || !userPos.isValid())
+  {
+    for(int i = 0; i < positions.size(); i++)
+      indexes.append(i);
+    return;
+  }
+
+  QVector<Candidate> found;
+  if(radiusKm > 0.f)
+    filterGrid(found, userPos, positions);
+  else
+    filterAll(found, userPos, positions);
+
+  std::sort(found.begin(), found.end(), [](const Candidate& c1, const Candidate& c2) -> bool
+        {
+          return c1.distanceKm < c2.distanceKm;
+        });
+
+  if(maxCount > 0 && found.size() > maxCount)
+    found.resize(maxCount);
+
+  for(const Candidate& candidate : found)
+    indexes.append(candidate.index);
+}
+
+void AircraftFilter::filter(QVector<SimConnectAircraft>& aircraft, const Pos& userPos) const
+{
+  if(!isActive() || !userPos.isValid())
+    return;
+
+  QVector<Pos> positions;
+  positions.reserve(aircraft.size());
+  for(const SimConnectAircraft& ac : aircraft)
+    positions.append(ac.getPosition());
+
+  QVector<int> indexes;
+  filter(indexes, userPos, positions);
+
+  QVector<bool> keep(aircraft.size(), false);
+  for(int index : indexes)
+    keep[index] = true;
+
+  QVector<SimConnectAircraft> filtered;
+  filtered.reserve(indexes.size());
+  for(int i = 0; i < aircraft.size(); i++)
+  {
+    if(keep.at(i) || aircraft.at(i).isUser())
+      filtered.append(aircraft.at(i));
+  }
+  aircraft.swap(filtered);
+}
+
+void AircraftFilter::filterAll(QVector<Candidate>& found, const Pos& userPos, const QVector<Pos>& positions) const
+{
+  found.reserve(positions.size());
+  for(int i = 0; i < positions.size(); i++)
+  {
+    if(positions.at(i).isValid())
+      found.append({userPos.distanceMeterTo(positions.at(i)) / 1000.f, i});
+  }
+}
+
+void AircraftFilter::filterGrid(QVector<Candidate>& found, const Pos& userPos, const QVector<Pos>& positions) const
+{
+  const float KM_PER_DEG = atools::geo::nmToKm(60.f);
+  const float halfSizeKm = radiusKm * PLANAR_MARGIN;
+  const float cellKm = 2.f * halfSizeKm / GRID_SIZE;
+  const float cosLat = std::max(atools::geo::cosDeg(userPos.getLatY()), 0.01f);
+
+  // Assign candidates to cells using counting sort to avoid allocation per cell
+  QVector<int> cellOfCandidate(positions.size(), -1);
+  QVector<int> cellStart(GRID_SIZE * GRID_SIZE + 1, 0);
+  for(int i = 0; i < positions.size(); i++)
+  {
+    const Pos& pos = positions.at(i);
+    if(!pos.isValid())
+      continue;
+
+    float dx = atools::geo::normalizeLonXDeg(pos.getLonX() - userPos.getLonX()) * cosLat * KM_PER_DEG;
+    float dy = (pos.getLatY() - userPos.getLatY()) * KM_PER_DEG;
+    if(std::abs(dx) >= halfSizeKm || std::abs(dy) >= halfSizeKm)
+      continue;
+
+    int col = std::min(static_cast<int>((dx + halfSizeKm) / cellKm), GRID_SIZE - 1);
+    int row = std::min(static_cast<int>((dy + halfSizeKm) / cellKm), GRID_SIZE - 1);
+    cellOfCandidate[i] = row * GRID_SIZE + col;
+    cellStart[cellOfCandidate.at(i) + 1]++;
+  }
+
+  for(int i = 1; i < cellStart.size(); i++)
+    cellStart[i] += cellStart.at(i - 1);
+
+  QVector<int> sorted(cellStart.last());
+  QVector<int> fill(cellStart);
+  for(int i = 0; i < positions.size(); i++)
+  {
+    if(cellOfCandidate.at(i) != -1)
+      sorted[fill[cellOfCandidate.at(i)]++] = i;
+  }
+
+  // Visit cells from the center outwards
+  const QVector<QPair<float, int> >& order = cellOrder();
+  for(int c = 0; c < order.size(); c++)
+  {
+    if(maxCount > 0 && found.size() >= maxCount)
+    {
+      // Stop if all remaining cells are farther away than the current farthest of the nearest aircraft
+      std::nth_element(found.begin(), found.begin() + (maxCount - 1), found.end(),
+                       [](const Candidate& c1, const Candidate& c2) -> bool
+            {
+              return c1.distanceKm < c2.distanceKm;
+            });
+      if(order.at(c).first * cellKm / PLANAR_MARGIN > found.at(maxCount - 1).distanceKm)
+        break;
+    }
+
+    int cell = order.at(c).second;
+    for(int j = cellStart.at(cell); j < cellStart.at(cell + 1); j++)
+    {
+      int index = sorted.at(j);
+      float distanceKm = userPos.distanceMeterTo(positions.at(index)) / 1000.f;
+      if(distanceKm <= radiusKm)
+        found.append({distanceKm, index});
+    }
+  }
+}
+
+const QVector<QPair<float, int> >& AircraftFilter::cellOrder()
+{
+  static const QVector<QPair<float, int> > order = buildCellOrder();
+  return order;
+}
+
+QVector<QPair<float, int> > AircraftFilter::buildCellOrder()
+{
+  QVector<QPair<float, int> > order;
+
+  // Center of the grid is at GRID_SIZE / 2 in cell units
+  const float center = GRID_SIZE / 2.f;
+  for(int row = 0; row < GRID_SIZE; row++)
+  {
+    for(int col = 0; col < GRID_SIZE; col++)
+    {
+      float dx = std::max({static_cast<float>(col) - center, center - static_cast<float>(col + 1), 0.f});
+      float dy = std::max({static_cast<float>(row) - center, center - static_cast<float>(row + 1), 0.f});
+      order.append(qMakePair(std::sqrt(dx * dx + dy * dy), row * GRID_SIZE + col));
+    }
+  }
+  std::sort(order.begin(), order.end());
+  return order;
+}
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,109 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_SC_AIRCRAFTFILTER_H
+#define ATOOLS_FS_SC_AIRCRAFTFILTER_H
+
+#include <QPair>
+#include <QVector>
+
+namespace atools {
+namespace geo {
+class Pos;
+}
+namespace fs {
+namespace sc {
+
+class SimConnectAircraft;
+
+/*
+ * Reduces AI traffic to the aircraft within a radius around the user aircraft and to a maximum number
+ * of nearest aircraft.
+ *
+ * Candidates are sorted into a grid around the user position using a fast planar approximation. Cells are
+ * visited in order of distance and exact distances are calculated only for these. Traversal stops when
+ * enough aircraft are found and remaining cells are farther away.
+ */
+class AircraftFilter
+{
+public:
+  /* Radius around user aircraft. 0 for no limit which is the default. */
+  void setRadiusKm(float value)
+  {
+    radiusKm = value;
+  }
+
+  float getRadiusKm() const
+  {
+    return radiusKm;
+  }
+
+  /* Maximum number of nearest aircraft. 0 for no limit which is the default. */
+  void setMaxCount(int value)
+  {
+    maxCount = value;
+  }
+
+  int getMaxCount() const
+  {
+    return maxCount;
+  }
+
+  bool isActive() const
+  {
+    return radiusKm > 0.f || maxCount > 0;
+  }
+
+  /* Get indexes of positions to keep ordered by distance to the user position. Gives all indexes in
+   * original order if the filter is not active or the user position is not valid. */
+  void filter(QVector<int>& indexes, const atools::geo::Pos& userPos,
+              const QVector<atools::geo::Pos>& positions) const;
+
+  /* Remove aircraft from list. Aircraft flagged as user are kept. */
+  void filter(QVector<atools::fs::sc::SimConnectAircraft>& aircraft, const atools::geo::Pos& userPos) const;
+
+private:
+  /* Number of cells for each side */
+  const static int GRID_SIZE = 16;
+
+  /* Error of the planar approximation for the covered area */
+  static Q_DECL_CONSTEXPR float PLANAR_MARGIN = 1.1f;
+
+  struct Candidate
+  {
+    float distanceKm;
+    int index;
+  };
+
+  void filterAll(QVector<Candidate>& found, const atools::geo::Pos& userPos,
+                 const QVector<atools::geo::Pos>& positions) const;
+  void filterGrid(QVector<Candidate>& found, const atools::geo::Pos& userPos,
+                  const QVector<atools::geo::Pos>& positions) const;
+
+  /* Cell indexes ordered by minimum distance to the center and minimum distance in cell units */
+  static const QVector<QPair<float, int> >& cellOrder();
+  static QVector<QPair<float, int> > buildCellOrder();
+
+  float radiusKm = 0.f;
+  int maxCount = 0;
+};
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_SC_AIRCRAFTFILTER_H
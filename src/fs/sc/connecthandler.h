@@ -19,6 +19,7 @@
 #define ATOOLS_FS_CONNECTHANDLER_H
 
 #include "fs/sc/simconnecttypes.h"
+#include "fs/sc/aircraftfilter.h"
 
 namespace atools {
 namespace fs {
@@ -71,6 +72,14 @@ public:
   /* Name which can be used when saving options */
   virtual QString getName() const = 0;
 
+  /* Filter for AI traffic which is applied in fetchData() */
+  void setAircraftFilter(const atools::fs::sc::AircraftFilter& value)
+  {
+    aircraftFilter = value;
+  }
+
+protected:
+  atools::fs::sc::AircraftFilter aircraftFilter;
 };
 
 } // namespace sc
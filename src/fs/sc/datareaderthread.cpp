@@ -19,20 +19,29 @@
 
 #include "fs/sc/simconnecthandler.h"
 #include "fs/sc/xpconnecthandler.h"
+#include "fs/sc/replaywriterthread.h"
+#include "geo/calculations.h"
+#include "zip/gzip.h"
 #include "settings/settings.h"
+#include "logging/loggingratelimiter.h"
+#include "logging/loggingmacros.h"
 
 #include <QDebug>
 #include <QDateTime>
 #include <QFile>
 #include <QDataStream>
 #include <QApplication>
+#include <QBuffer>
+
+#include <algorithm>
+#include <limits>
 
 namespace atools {
 namespace fs {
 namespace sc {
 
 DataReaderThread::DataReaderThread(QObject *parent, bool verboseLog)
-  : QThread(parent), verbose(verboseLog)
+  : QThread(parent), verbose(verboseLog), latencyStats("data reader")
 {
   qDebug() << Q_FUNC_INFO;
   setObjectName("DataReaderThread");
@@ -40,6 +49,7 @@ DataReaderThread::DataReaderThread(QObject *parent, bool verboseLog)
   qInfo() << "SimConnect available:" << (handler != nullptr ? handler->isLoaded() : false);
 
   options = atools::fs::sc::FETCH_AI_AIRCRAFT | atools::fs::sc::FETCH_AI_BOAT;
+  replaySeekTimestamp = 0;
 }
 
 DataReaderThread::~DataReaderThread()
@@ -51,7 +61,17 @@ void DataReaderThread::setHandler(ConnectHandler *connectHandler)
 {
   qDebug() << Q_FUNC_INFO << connectHandler->getName();
 
+  QMutexLocker locker(&handlerMutex);
   handler = connectHandler;
+  handler->setAircraftFilter(aircraftFilter);
+}
+
+void DataReaderThread::setAircraftFilter(const AircraftFilter& value)
+{
+  QMutexLocker locker(&handlerMutex);
+  aircraftFilter = value;
+  if(handler != nullptr)
+    handler->setAircraftFilter(aircraftFilter);
 }
 
 void DataReaderThread::connectToSimulator()
@@ -108,50 +128,67 @@ void DataReaderThread::run()
   // Main loop  ============================================
   while(!terminate)
   {
-    atools::fs::sc::SimConnectData data;
+    // Fill buffer slot directly if buffered
+    atools::fs::sc::SimConnectData signalData;
+    atools::fs::sc::SimConnectData& data = notification == NOTIFY_SIGNAL ? signalData : dataBuffer.beginWrite();
     atools::fs::sc::Options opts = options;
 
     if(loadReplayFile != nullptr)
     {
       // Do replay ============================================
-      data.read(loadReplayFile);
+      quint32 seekTimestamp = replaySeekTimestamp.exchange(0);
+      if(seekTimestamp > 0)
+        seekReplayIndex(seekTimestamp);
 
-      if(data.getStatus() == OK)
+      // Compressed replays are read from the current decompressed block
+      if(replayCompressed && !readReplayBlock())
+        qWarning() << Q_FUNC_INFO << "Replay closed due to invalid block";
+      else
       {
-        if(loadReplayFile->atEnd())
-          loadReplayFile->seek(REPLAY_FILE_DATA_START_OFFSET);
+        data.read(replayCompressed ? replayBlockBuffer : replayDevice);
 
-        // Remove boat and ship traffic depending on settings for testing purposes
-        QVector<SimConnectAircraft>& aiAircraft = data.getAiAircraft();
-        if(!(opts & atools::fs::sc::FETCH_AI_AIRCRAFT))
+        if(data.getStatus() == OK)
         {
-          QVector<SimConnectAircraft>::iterator it =
-            std::remove_if(aiAircraft.begin(), aiAircraft.end(), [](const SimConnectAircraft& aircraft) -> bool
-                {
-                  return !aircraft.isUser() && aircraft.getCategory() != atools::fs::sc::BOAT;
-                });
-          if(it != aiAircraft.end())
-            aiAircraft.erase(it, aiAircraft.end());
+          if(!replayCompressed && replayDevice->pos() >= replayDataEnd)
+            replayDevice->seek(REPLAY_FILE_DATA_START_OFFSET);
+
+          // Remove boat and ship traffic depending on settings for testing purposes
+          QVector<SimConnectAircraft>& aiAircraft = data.getAiAircraft();
+          if(!(opts & atools::fs::sc::FETCH_AI_AIRCRAFT))
+          {
+            QVector<SimConnectAircraft>::iterator it =
+              std::remove_if(aiAircraft.begin(), aiAircraft.end(), [](const SimConnectAircraft& aircraft) -> bool
+                  {
+                    return !aircraft.isUser() && aircraft.getCategory() != atools::fs::sc::BOAT;
+                  });
+            if(it != aiAircraft.end())
+              aiAircraft.erase(it, aiAircraft.end());
+          }
+
+          if(!(opts & atools::fs::sc::FETCH_AI_BOAT))
+          {
+            QVector<SimConnectAircraft>::iterator it =
+              std::remove_if(aiAircraft.begin(), aiAircraft.end(), [](const SimConnectAircraft& aircraft) -> bool
+                  {
+                    return !aircraft.isUser() && aircraft.getCategory() == atools::fs::sc::BOAT;
+                  });
+            if(it != aiAircraft.end())
+              aiAircraft.erase(it, aiAircraft.end());
+          }
+
+          {
+            QMutexLocker locker(&handlerMutex);
+            aircraftFilter.filter(aiAircraft, data.getUserAircraftConst().getPosition());
+          }
+
+          postData(data);
         }
-
-        if(!(opts & atools::fs::sc::FETCH_AI_BOAT))
+        else
         {
-          QVector<SimConnectAircraft>::iterator it =
-            std::remove_if(aiAircraft.begin(), aiAircraft.end(), [](const SimConnectAircraft& aircraft) -> bool
-                {
-                  return !aircraft.isUser() && aircraft.getCategory() == atools::fs::sc::BOAT;
-                });
-          if(it != aiAircraft.end())
-            aiAircraft.erase(it, aiAircraft.end());
+          emit postLogMessage(tr("Error reading \"%1\": %2.").
+                              arg(loadReplayFilepath).arg(data.getStatusText()), true);
+          closeReplay();
         }
-
-        emit postSimConnectData(data);
-      }
-      else
-      {
-        emit postLogMessage(tr("Error reading \"%1\": %2.").
-                            arg(loadReplayFilepath).arg(data.getStatusText()), true);
-        closeReplay();
       }
     }
     else if(fetchData(data, SIMCONNECT_AI_RADIUS_KM, opts))
@@ -160,11 +197,22 @@ void DataReaderThread::run()
       if(verbose && !data.getMetars().isEmpty())
         qDebug() << "DataReaderThread::run() num metars" << data.getMetars().size();
 
-      emit postSimConnectData(data);
-
+      // Save before posting since the consumer owns the data afterwards in buffered mode
       if(saveReplayFile != nullptr && saveReplayFile->isOpen() && data.getPacketId() > 0)
+      {
         // Save only simulator packets, not weather replys
-        data.write(saveReplayFile);
+        if(replayWriter != nullptr)
+          // Compress and write in background
+          replayWriter->addPacket(data.toByteArray(), static_cast<quint32>(data.getPacketTimestamp()));
+        else
+        {
+          replayIndex.append({static_cast<quint32>(data.getPacketTimestamp()),
+                              static_cast<quint64>(saveReplayFile->pos())});
+          data.write(saveReplayFile);
+        }
+      }
+
+      postData(data);
     }
     else
     {
@@ -174,7 +222,7 @@ void DataReaderThread::run()
         connected = false;
         emit disconnectedFromSimulator();
 
-        qWarning() << "Error fetching data from simulator.";
+        ATOOLS_LOG_LIMITED(qWarning() << "Error fetching data from simulator.");
 
         if(numErrors++ > MAX_NUMBER_OF_ERRORS)
         {
@@ -195,6 +243,8 @@ void DataReaderThread::run()
     if(loadReplayFile != nullptr)
       sleepMs = static_cast<unsigned long>(static_cast<float>(replayUpdateRateMs) /
                                            static_cast<float>(replaySpeed));
+    else if(adaptiveUpdateRate && connected)
+      sleepMs = adaptiveSleepMs(data);
     else
       sleepMs = updateRate;
 
@@ -218,7 +268,7 @@ void DataReaderThread::run()
 
 bool DataReaderThread::fetchData(atools::fs::sc::SimConnectData& data, int radiusKm, Options options)
 {
-  if(verbose)
+  if(ATOOLS_VERBOSE(verbose))
     qDebug() << Q_FUNC_INFO << "enter";
 
   if(!handler->isLoaded())
@@ -232,7 +282,7 @@ bool DataReaderThread::fetchData(atools::fs::sc::SimConnectData& data, int radiu
 
   if(weatherRequested)
   {
-    if(verbose)
+    if(ATOOLS_VERBOSE(verbose))
       qDebug() << "DataReaderThread::fetchData weather";
 
     handler->fetchWeatherData(data);
@@ -245,16 +295,22 @@ bool DataReaderThread::fetchData(atools::fs::sc::SimConnectData& data, int radiu
   }
   else
   {
-    if(verbose)
+    if(ATOOLS_VERBOSE(verbose))
       qDebug() << "DataReaderThread::fetchData nextPacketId" << nextPacketId;
 
+    qint64 startUs = LatencyStats::nowUs();
     retval = handler->fetchData(data, radiusKm, options);
+    qint64 endUs = LatencyStats::nowUs();
+
+    data.setFetchTimestampsUs(startUs, endUs);
+    if(retval)
+      latencyStats.addSample(LATENCY_FETCH, endUs - startUs);
     data.setPacketId(nextPacketId++);
   }
 
   data.setPacketTimestamp(QDateTime::currentDateTime().toTime_t());
 
-  if(verbose)
+  if(ATOOLS_VERBOSE(verbose))
     if(weatherRequested && !data.getMetars().isEmpty())
       qDebug() << "Weather requested and found";
 
@@ -263,12 +319,73 @@ bool DataReaderThread::fetchData(atools::fs::sc::SimConnectData& data, int radiu
 
   handler->addWeatherRequest(WeatherRequest());
 
-  if(verbose)
+  if(ATOOLS_VERBOSE(verbose))
     qDebug() << Q_FUNC_INFO << "leave";
 
   return retval;
 }
 
+unsigned long DataReaderThread::adaptiveSleepMs(const SimConnectData& data)
+{
+  // Thresholds where the fastest update rate is used
+  const float MAX_TURN_RATE_DEG_S = 3.f, MAX_VERTICAL_SPEED_FPM = 1500.f, APPROACH_ALTITUDE_FT = 3000.f,
+              TAXI_SPEED_KTS = 2.f;
+
+  // Data may be handed over to the consumer already in buffered mode - only read here
+  const SimConnectUserAircraft& user = data.getUserAircraftConst();
+  qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+  float activity = 0.f;
+
+  bool paused;
+  {
+    QMutexLocker locker(&handlerMutex);
+    paused = handler->isSimPaused();
+  }
+
+  if(!paused && data.isUserAircraftValid())
+  {
+    // Turn rate from heading change since last fetch
+    if(lastFetchMs > 0 && nowMs > lastFetchMs)
+    {
+      float turnRate = atools::geo::angleAbsDiff(user.getHeadingDegTrue(), lastHeadingDegTrue) /
+                       (static_cast<float>(nowMs - lastFetchMs) / 1000.f);
+      activity = std::max(activity, turnRate / MAX_TURN_RATE_DEG_S);
+    }
+
+    activity = std::max(activity, std::abs(user.getVerticalSpeedFeetPerMin()) / MAX_VERTICAL_SPEED_FPM);
+
+    if(user.isOnGround())
+    {
+      // Taxi or takeoff run
+      if(user.getGroundSpeedKts() > TAXI_SPEED_KTS)
+        activity = 1.f;
+    }
+    else if(user.getAltitudeAboveGroundFt() < APPROACH_ALTITUDE_FT)
+      // Approach or departure
+      activity = std::max(activity, 1.f - user.getAltitudeAboveGroundFt() / APPROACH_ALTITUDE_FT);
+
+    lastHeadingDegTrue = user.getHeadingDegTrue();
+  }
+  lastFetchMs = nowMs;
+
+  activity = std::min(activity, 1.f);
+  unsigned long sleepMs = static_cast<unsigned long>(adaptiveMaxMs - activity * (adaptiveMaxMs - adaptiveMinMs));
+
+  if(ATOOLS_VERBOSE(verbose))
+    qDebug() << Q_FUNC_INFO << "activity" << activity << "sleep" << sleepMs << "paused" << paused;
+  return sleepMs;
+}
+
+void DataReaderThread::postData(SimConnectData& data)
+{
+  if(notification == NOTIFY_SIGNAL || data.getPacketId() == 0)
+    // Weather replies must not be dropped
+    emit postSimConnectData(data);
+  else if(dataBuffer.endWrite() && notification == NOTIFY_BUFFER_SIGNAL)
+    // Notify only if last packet was taken - otherwise it was replaced and a notification is pending
+    emit simConnectDataAvailable();
+}
+
 void DataReaderThread::setSimconnectOptions(Options value)
 {
   options = value;
@@ -309,13 +426,33 @@ void DataReaderThread::setupReplay()
           closeReplay();
           return;
         }
-        if(version != REPLAY_FILE_VERSION)
+        if(version != REPLAY_FILE_VERSION && version != REPLAY_FILE_VERSION_NO_INDEX &&
+           version != REPLAY_FILE_VERSION_COMPRESSED)
         {
           emit postLogMessage(tr("Cannot open \"%1\". Wrong version.").arg(loadReplayFilepath), true);
           closeReplay();
           return;
         }
 
+        readReplayIndex(version);
+        replayCompressed = version == REPLAY_FILE_VERSION_COMPRESSED;
+
+        // Read packets from mapped memory if possible - avoids system calls for each packet
+        // QBuffer is limited to 2 GB
+        if(replayDataEnd <= std::numeric_limits<int>::max())
+          replayMappedData = loadReplayFile->map(0, loadReplayFile->size());
+        if(replayMappedData != nullptr)
+        {
+          replayBuffer = new QBuffer;
+          replayBuffer->setData(QByteArray::fromRawData(reinterpret_cast<const char *>(replayMappedData),
+                                                        static_cast<int>(replayDataEnd)));
+          replayBuffer->open(QIODevice::ReadOnly);
+          replayDevice = replayBuffer;
+        }
+        else
+          replayDevice = loadReplayFile;
+        replayDevice->seek(REPLAY_FILE_DATA_START_OFFSET);
+
         emit postLogMessage(tr("Replaying from \"%1\".").arg(loadReplayFilepath), false);
         emit connectedToSimulator();
       }
@@ -342,13 +479,31 @@ void DataReaderThread::setupReplay()
 
       // Save file header
       QDataStream out(saveReplayFile);
-      out << REPLAY_FILE_MAGIC_NUMBER << REPLAY_FILE_VERSION << static_cast<quint32>(updateRate);
+      out << REPLAY_FILE_MAGIC_NUMBER << (replayCompression ? REPLAY_FILE_VERSION_COMPRESSED : REPLAY_FILE_VERSION)
+          << static_cast<quint32>(updateRate);
+      replayIndex.clear();
+
+      if(replayCompression)
+      {
+        replayWriter = new ReplayWriterThread(saveReplayFile, REPLAY_FILE_INDEX_MAGIC_NUMBER);
+        replayWriter->start();
+      }
     }
   }
 }
 
 void DataReaderThread::closeReplay()
 {
+  if(replayWriter != nullptr)
+  {
+    // Writes remaining packets and index
+    replayWriter->finish();
+    delete replayWriter;
+    replayWriter = nullptr;
+  }
+  else if(saveReplayFile != nullptr && saveReplayFile->isOpen())
+    writeReplayIndex();
+
   if(saveReplayFile != nullptr)
   {
     saveReplayFile->close();
@@ -356,12 +511,152 @@ void DataReaderThread::closeReplay()
     saveReplayFile = nullptr;
   }
 
+  delete replayBuffer;
+  replayBuffer = nullptr;
+  replayDevice = nullptr;
+  delete replayBlockBuffer;
+  replayBlockBuffer = nullptr;
+  replayBlock.clear();
+  replayCompressed = false;
+
   if(loadReplayFile != nullptr)
   {
+    if(replayMappedData != nullptr)
+      loadReplayFile->unmap(replayMappedData);
+    replayMappedData = nullptr;
+
     loadReplayFile->close();
     delete loadReplayFile;
     loadReplayFile = nullptr;
   }
+  replayIndex.clear();
+}
+
+void DataReaderThread::readReplayIndex(quint32 version)
+{
+  replayIndex.clear();
+  replayDataEnd = loadReplayFile->size();
+
+  if(version == REPLAY_FILE_VERSION_NO_INDEX ||
+     replayDataEnd < REPLAY_FILE_DATA_START_OFFSET + REPLAY_FILE_FOOTER_SIZE)
+    return;
+
+  // Read footer
+  QDataStream in(loadReplayFile);
+  in.setVersion(QDataStream::Qt_5_5);
+  loadReplayFile->seek(loadReplayFile->size() - REPLAY_FILE_FOOTER_SIZE);
+
+  quint64 indexOffset;
+  quint32 numEntries, magicNumber;
+  in >> indexOffset >> numEntries >> magicNumber;
+
+  qint64 indexEnd = static_cast<qint64>(indexOffset) +
+                    numEntries * static_cast<qint64>(sizeof(quint32) + sizeof(quint64));
+  if(magicNumber != REPLAY_FILE_INDEX_MAGIC_NUMBER ||
+     indexEnd != loadReplayFile->size() - REPLAY_FILE_FOOTER_SIZE)
+  {
+    // Recording was not closed properly - read sequentially without index
+    qWarning() << Q_FUNC_INFO << "No valid index in" << loadReplayFilepath;
+    return;
+  }
+
+  loadReplayFile->seek(static_cast<qint64>(indexOffset));
+  replayIndex.resize(static_cast<int>(numEntries));
+  for(ReplayIndexEntry& entry : replayIndex)
+    in >> entry.timestamp >> entry.offset;
+  replayDataEnd = static_cast<qint64>(indexOffset);
+
+  qDebug() << Q_FUNC_INFO << "Index entries" << replayIndex.size();
+}
+
+void DataReaderThread::writeReplayIndex()
+{
+  QDataStream out(saveReplayFile);
+  out.setVersion(QDataStream::Qt_5_5);
+
+  // Index of all packets followed by footer pointing to the index
+  quint64 indexOffset = static_cast<quint64>(saveReplayFile->pos());
+  for(const ReplayIndexEntry& entry : replayIndex)
+    out << entry.timestamp << entry.offset;
+  out << indexOffset << static_cast<quint32>(replayIndex.size()) << REPLAY_FILE_INDEX_MAGIC_NUMBER;
+  replayIndex.clear();
+}
+
+void DataReaderThread::seekReplayIndex(quint32 timestamp)
+{
+  if(replayIndex.isEmpty())
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot seek in replay without index";
+    return;
+  }
+
+  // Timestamps are ascending - find first packet not before timestamp
+  auto it = std::lower_bound(replayIndex.constBegin(), replayIndex.constEnd(), timestamp,
+                             [](const ReplayIndexEntry& entry, quint32 ts) -> bool
+        {
+          return entry.timestamp < ts;
+        });
+  if(replayCompressed)
+  {
+    // Index points to blocks - start at the block before and skip packets inside the block
+    if(it != replayIndex.constBegin())
+      --it;
+    replayDevice->seek(static_cast<qint64>(it->offset));
+
+    delete replayBlockBuffer;
+    replayBlockBuffer = nullptr;
+    if(!readReplayBlock())
+      return;
+
+    while(!replayBlockBuffer->atEnd())
+    {
+      qint64 pos = replayBlockBuffer->pos();
+      SimConnectData data;
+      if(!data.read(replayBlockBuffer) || static_cast<quint32>(data.getPacketTimestamp()) >= timestamp)
+      {
+        replayBlockBuffer->seek(pos);
+        break;
+      }
+    }
+  }
+  else
+  {
+    if(it == replayIndex.constEnd())
+      it = replayIndex.constBegin();
+
+    replayDevice->seek(static_cast<qint64>(it->offset));
+  }
+}
+
+bool DataReaderThread::readReplayBlock()
+{
+  if(replayBlockBuffer != nullptr && !replayBlockBuffer->atEnd())
+    return true;
+
+  if(replayDevice->pos() >= replayDataEnd)
+    replayDevice->seek(REPLAY_FILE_DATA_START_OFFSET);
+
+  QDataStream in(replayDevice);
+  in.setVersion(QDataStream::Qt_5_5);
+
+  quint32 compressedSize, numPackets;
+  in >> compressedSize >> numPackets;
+  QByteArray compressed = replayDevice->read(compressedSize);
+
+  delete replayBlockBuffer;
+  replayBlockBuffer = nullptr;
+
+  if(in.status() != QDataStream::Ok || compressed.size() != static_cast<int>(compressedSize) ||
+     !atools::zip::gzipDecompress(compressed, replayBlock) || replayBlock.isEmpty())
+  {
+    emit postLogMessage(tr("Error reading \"%1\": Invalid compressed block.").arg(loadReplayFilepath), true);
+    closeReplay();
+    return false;
+  }
+
+  replayBlockBuffer = new QBuffer(&replayBlock);
+  replayBlockBuffer->open(QIODevice::ReadOnly);
+  return true;
 }
 
 bool DataReaderThread::isSimconnectAvailable()
@@ -381,7 +676,7 @@ bool DataReaderThread::isXplaneHandler()
 
 void DataReaderThread::setWeatherRequest(atools::fs::sc::WeatherRequest request)
 {
-  if(verbose)
+  if(ATOOLS_VERBOSE(verbose))
     qDebug() << Q_FUNC_INFO;
 
   if(saveReplayFile != nullptr)
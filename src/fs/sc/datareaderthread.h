@@ -18,7 +18,9 @@
 #ifndef LITTLENAVCONNECT_DATAREADERTHREAD_H
 #define LITTLENAVCONNECT_DATAREADERTHREAD_H
 
+#include "fs/sc/latencystats.h"
 #include "fs/sc/simconnectdata.h"
+#include "fs/sc/simconnectdatabuffer.h"
 #include "fs/sc/simconnectreply.h"
 
 #include <QMutex>
@@ -26,12 +28,28 @@
 #include <QWaitCondition>
 
 class QFile;
+class QBuffer;
 
 namespace atools {
 namespace fs {
 namespace sc {
 
 class ConnectHandler;
+class ReplayWriterThread;
+
+/* How consumers get simulator data packets */
+enum DataNotification
+{
+  /* Copy of each packet is sent with postSimConnectData() */
+  NOTIFY_SIGNAL,
+
+  /* Packets are handed over in a buffer and simConnectDataAvailable() is sent if the consumer has taken
+   * the last one. Use takeSimConnectData() to get the data. */
+  NOTIFY_BUFFER_SIGNAL,
+
+  /* Packets are handed over in a buffer and the consumer polls using takeSimConnectData() */
+  NOTIFY_BUFFER_POLL
+};
 
 /* Actively reads flight simulator data using the simconnect interface in background and sends a
  * signal for each data package. */
@@ -61,6 +79,17 @@ public:
     updateRate = updateRateMs;
   }
 
+  /* Adjust the fetch interval between minMs and maxMs depending on the user aircraft state instead of
+   * using the fixed update rate. Fast updates are used while turning, climbing, descending, taxiing or
+   * close to the ground. Slow updates are used while parked, cruising or if the simulator is paused.
+   * Not used for replays. */
+  void setAdaptiveUpdateRate(bool enable, unsigned int minMs = 100, unsigned int maxMs = 2000)
+  {
+    adaptiveUpdateRate = enable;
+    adaptiveMinMs = minMs;
+    adaptiveMaxMs = std::max(minMs, maxMs);
+  }
+
   /* If simulator connection is lost try to reconnect every reconnectSec seconds. */
   void setReconnectRateSec(int reconnectSec);
 
@@ -80,6 +109,12 @@ public:
     saveReplayFilepath = value;
   }
 
+  /* Write compressed blocks in a background thread when saving a replay. Default is false. */
+  void setReplayCompression(bool value)
+  {
+    replayCompression = value;
+  }
+
   /* If set all data will be read from that file and all simulator connections will be ignored */
   void setLoadReplayFilepath(const QString& value)
   {
@@ -91,6 +126,25 @@ public:
     replaySpeed = std::max(1, value);
   }
 
+  /* Continue replay at the first packet at or after the timestamp in seconds since epoch. Needs a replay file
+   * with index. Applied in the next iteration of the thread. */
+  void seekReplay(quint32 timestamp)
+  {
+    replaySeekTimestamp = timestamp;
+  }
+
+  /* Timestamps of first and last packet in replay file or 0 if the file has no index.
+   * Valid after connectedToSimulator() was sent. */
+  quint32 getReplayStartTimestamp() const
+  {
+    return replayIndex.isEmpty() ? 0 : replayIndex.first().timestamp;
+  }
+
+  quint32 getReplayEndTimestamp() const
+  {
+    return replayIndex.isEmpty() ? 0 : replayIndex.last().timestamp;
+  }
+
   void closeReplay();
 
   bool isSimconnectAvailable();
@@ -109,10 +163,42 @@ public:
     return handler;
   }
 
+  /* Change how consumers get data. Default is NOTIFY_SIGNAL. Set only while the thread is not running.
+   * Buffered modes have only one consumer and drop packets which were not taken in time instead of
+   * queuing them. Weather replies are always sent with postSimConnectData(). */
+  void setDataNotification(atools::fs::sc::DataNotification value)
+  {
+    notification = value;
+  }
+
+  /* Filter AI traffic by distance to the user aircraft and number. Used for simulator and replay. */
+  void setAircraftFilter(const atools::fs::sc::AircraftFilter& value);
+
+  /* Get latest packet in buffered mode. Null if there is no new packet. Data is valid until the next call.
+   * Call only from one thread. */
+  const atools::fs::sc::SimConnectData *takeSimConnectData()
+  {
+    return dataBuffer.takeLatest();
+  }
+
+  /* Statistics for the fetch stage. Use setLogIntervalSec() to get a periodic log line. Thread safe. */
+  atools::fs::sc::LatencyStats& getLatencyStats()
+  {
+    return latencyStats;
+  }
+
+  const atools::fs::sc::LatencyStats& getLatencyStats() const
+  {
+    return latencyStats;
+  }
+
 signals:
   /* Send on each received data package from the simconnect interface */
   void postSimConnectData(atools::fs::sc::SimConnectData dataPacket);
 
+  /* Send in buffered notification mode if a new packet is available */
+  void simConnectDataAvailable();
+
   void postLogMessage(QString messge, bool warning);
 
   /* Emitted when a connection was established */
@@ -127,6 +213,12 @@ private:
   void setupReplay();
   bool fetchData(atools::fs::sc::SimConnectData& data, int radiusKm, atools::fs::sc::Options options);
 
+  /* Calculate the next fetch interval for the adaptive update rate */
+  unsigned long adaptiveSleepMs(const atools::fs::sc::SimConnectData& data);
+
+  /* Send signal or publish in buffer depending on notification mode */
+  void postData(atools::fs::sc::SimConnectData& data);
+
   atools::fs::sc::ConnectHandler *handler = nullptr;
 
   /* Have to protect options since they will be modified from outside the thread */
@@ -135,11 +227,32 @@ private:
   int numErrors = 0;
   const int MAX_NUMBER_OF_ERRORS = 50;
 
+  /* Version 2 adds a trailing index of packet timestamps and file offsets. Version 3 uses compressed blocks
+   * of packets and the index points to the blocks. */
   const quint32 REPLAY_FILE_MAGIC_NUMBER = 0XCACF4F27;
-  const quint32 REPLAY_FILE_VERSION = 1;
+  const quint32 REPLAY_FILE_VERSION = 2;
+  const quint32 REPLAY_FILE_VERSION_NO_INDEX = 1;
+  const quint32 REPLAY_FILE_VERSION_COMPRESSED = 3;
   const int REPLAY_FILE_DATA_START_OFFSET = sizeof(REPLAY_FILE_MAGIC_NUMBER) + sizeof(REPLAY_FILE_VERSION) +
                                             sizeof(quint32);
 
+  /* Footer is index offset, number of entries and magic number */
+  const quint32 REPLAY_FILE_INDEX_MAGIC_NUMBER = 0x3D1E0F5A;
+  const int REPLAY_FILE_FOOTER_SIZE = sizeof(quint64) + sizeof(quint32) + sizeof(quint32);
+
+  struct ReplayIndexEntry
+  {
+    quint32 timestamp;
+    quint64 offset;
+  };
+
+  void readReplayIndex(quint32 version);
+  void writeReplayIndex();
+  void seekReplayIndex(quint32 timestamp);
+
+  /* Read and decompress the next block if the current one is exhausted. Starts over at the end. */
+  bool readReplayBlock();
+
   const int SIMCONNECT_AI_RADIUS_KM = 200;
 
   QString saveReplayFilepath, loadReplayFilepath;
@@ -147,14 +260,45 @@ private:
   QFile *saveReplayFile = nullptr, *loadReplayFile = nullptr;
   quint32 replayUpdateRateMs = 500;
 
+  /* Replay is read from a buffer on the mapped file if possible. Otherwise from the file. */
+  QIODevice *replayDevice = nullptr;
+  QBuffer *replayBuffer = nullptr;
+  uchar *replayMappedData = nullptr;
+
+  /* End of packet data in replay file. Index follows. */
+  qint64 replayDataEnd = 0;
+
+  /* Current decompressed block for compressed replay files */
+  bool replayCompressed = false, replayCompression = false;
+  QByteArray replayBlock;
+  QBuffer *replayBlockBuffer = nullptr;
+  ReplayWriterThread *replayWriter = nullptr;
+
+  /* Index read from or written to replay file */
+  QVector<ReplayIndexEntry> replayIndex;
+  std::atomic<quint32> replaySeekTimestamp;
+
   bool terminate = false, verbose = false;
   unsigned int updateRate = 500;
+
+  /* Adaptive update rate and values of the last fetch to calculate turn rate */
+  bool adaptiveUpdateRate = false;
+  unsigned int adaptiveMinMs = 100, adaptiveMaxMs = 2000;
+  float lastHeadingDegTrue = 0.f;
+  qint64 lastFetchMs = 0;
   int reconnectRateSec = 10;
   bool connected = false, reconnecting = false;
 
   /* Source for packet ids */
   int nextPacketId = 1;
 
+  atools::fs::sc::DataNotification notification = NOTIFY_SIGNAL;
+
+  /* Protected by handlerMutex */
+  atools::fs::sc::AircraftFilter aircraftFilter;
+  atools::fs::sc::SimConnectDataBuffer dataBuffer;
+  atools::fs::sc::LatencyStats latencyStats;
+
   /* Needed to lock for any modifications of the handler's data (weather) */
   mutable QMutex handlerMutex;
 
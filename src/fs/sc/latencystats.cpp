@@ -0,0 +1,178 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/sc/latencystats.h"
+
+#include <QDebug>
+#include <QStringList>
+
+#include <algorithm>
+#include <chrono>
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+/* Nearest rank percentile of sorted values */
+static qint64 percentile(const QVector<qint64>& sorted, int percent)
+{
+  int index = (percent * sorted.size() + 99) / 100 - 1;
+  return sorted.at(std::min(std::max(index, 0), sorted.size() - 1));
+}
+
+LatencyStats::LatencyStats(const QString& statsName, int windowSize)
+  : name(statsName), size(std::max(1, windowSize))
+{
+  std::fill(nextIndex, nextIndex + LATENCY_NUM_STAGES, 0);
+}
+
+qint64 LatencyStats::nowUs()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LatencyStats::addSample(LatencyStage stage, qint64 microseconds)
+{
+  if(microseconds < 0)
+    return;
+
+  QString summary;
+  {
+    QMutexLocker locker(&mutex);
+    QVector<qint64>& values = samples[stage];
+    if(values.size() < size)
+      values.append(microseconds);
+    else
+      values[nextIndex[stage]] = microseconds;
+    nextIndex[stage] = (nextIndex[stage] + 1) % size;
+
+    if(logIntervalUs > 0)
+    {
+      qint64 now = nowUs();
+      if(lastLogUs == 0)
+        lastLogUs = now;
+      else if(now - lastLogUs >= logIntervalUs)
+      {
+        lastLogUs = now;
+        summary = summaryInternal();
+      }
+    }
+  }
+
+  // Log outside of the lock
+  if(!summary.isEmpty())
+    qInfo().noquote() << summary;
+}
+
+LatencyPercentiles LatencyStats::getPercentiles(LatencyStage stage) const
+{
+  QVector<qint64> values;
+  {
+    QMutexLocker locker(&mutex);
+    values = samples[stage];
+  }
+
+  LatencyPercentiles percentiles = {values.size(), 0, 0, 0, 0};
+  if(!values.isEmpty())
+  {
+    std::sort(values.begin(), values.end());
+    percentiles.p50 = percentile(values, 50);
+    percentiles.p95 = percentile(values, 95);
+    percentiles.p99 = percentile(values, 99);
+    percentiles.max = values.last();
+  }
+  return percentiles;
+}
+
+QString LatencyStats::getSummary() const
+{
+  QMutexLocker locker(&mutex);
+  return summaryInternal();
+}
+
+QString LatencyStats::summaryInternal() const
+{
+  QStringList stages;
+  for(int i = 0; i < LATENCY_NUM_STAGES; i++)
+  {
+    if(samples[i].isEmpty())
+      continue;
+
+    QVector<qint64> values(samples[i]);
+    std::sort(values.begin(), values.end());
+    stages.append(QString("%1 p50 %2 p95 %3 p99 %4 ms").
+                  arg(stageName(static_cast<LatencyStage>(i))).
+                  arg(percentile(values, 50) / 1000., 0, 'f', 1).
+                  arg(percentile(values, 95) / 1000., 0, 'f', 1).
+                  arg(percentile(values, 99) / 1000., 0, 'f', 1));
+  }
+
+  if(stages.isEmpty())
+    return QString();
+  else
+    return QString("Latency %1: %2").arg(name).arg(stages.join(", "));
+}
+
+void LatencyStats::setLogIntervalSec(int intervalSec)
+{
+  QMutexLocker locker(&mutex);
+  logIntervalUs = std::max(0, intervalSec) * 1000000LL;
+  lastLogUs = 0;
+}
+
+void LatencyStats::clear()
+{
+  QMutexLocker locker(&mutex);
+  for(int i = 0; i < LATENCY_NUM_STAGES; i++)
+  {
+    samples[i].clear();
+    nextIndex[i] = 0;
+  }
+}
+
+QString LatencyStats::stageName(LatencyStage stage)
+{
+  switch(stage)
+  {
+    case atools::fs::sc::LATENCY_FETCH:
+      return "fetch";
+
+    case atools::fs::sc::LATENCY_POST:
+      return "post";
+
+    case atools::fs::sc::LATENCY_WRITE:
+      return "write";
+
+    case atools::fs::sc::LATENCY_ROUND_TRIP:
+      return "round trip";
+
+    case atools::fs::sc::LATENCY_NETWORK:
+      return "network";
+
+    case atools::fs::sc::LATENCY_CLIENT:
+      return "client";
+
+    case atools::fs::sc::LATENCY_NUM_STAGES:
+      break;
+  }
+  return "unknown";
+}
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
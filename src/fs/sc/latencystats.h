@@ -0,0 +1,111 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_SC_LATENCYSTATS_H
+#define ATOOLS_FS_SC_LATENCYSTATS_H
+
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+/* Stages of a simulator data packet from fetching to the client */
+enum LatencyStage
+{
+  /* Time of the SimConnect or X-Plane dispatch and fetch of all data */
+  LATENCY_FETCH,
+
+  /* End of fetch until the packet is serialized in NavServer */
+  LATENCY_POST,
+
+  /* Serialization until the packet is written to the socket by NavServerWorker */
+  LATENCY_WRITE,
+
+  /* Socket write until the reply of the client is received */
+  LATENCY_ROUND_TRIP,
+
+  /* Round trip without client processing time. Only for clients reporting their processing time. */
+  LATENCY_NETWORK,
+
+  /* Time between receipt of the packet and sending the reply as reported by the client */
+  LATENCY_CLIENT,
+
+  LATENCY_NUM_STAGES
+};
+
+/* Percentiles in microseconds. All 0 if no samples were added. */
+struct LatencyPercentiles
+{
+  int count;
+  qint64 p50, p95, p99, max;
+};
+
+/*
+ * Rolling latency statistics for the stages of simulator data packets. Keeps the last samples for each stage
+ * in a ring buffer and calculates percentiles on demand. Can write a summary line periodically to the log.
+ *
+ * Thread safe. Samples can be added from the data reader and all socket worker threads.
+ */
+class LatencyStats
+{
+public:
+  /* Name is used in the log line. Percentiles are calculated for the last windowSize samples. */
+  explicit LatencyStats(const QString& statsName, int windowSize = 1000);
+
+  /* Monotonic timestamp in microseconds for latency measurements. Not related to wall clock time and
+   * not comparable across processes. */
+  static qint64 nowUs();
+
+  /* Add sample in microseconds. Negative values are ignored. Logs the summary if the interval has passed. */
+  void addSample(atools::fs::sc::LatencyStage stage, qint64 microseconds);
+
+  atools::fs::sc::LatencyPercentiles getPercentiles(atools::fs::sc::LatencyStage stage) const;
+
+  /* One line with percentiles in milliseconds for all stages having samples */
+  QString getSummary() const;
+
+  /* Write summary to log every intervalSec seconds while samples are added. 0 disables logging (default). */
+  void setLogIntervalSec(int intervalSec);
+
+  /* Remove all samples */
+  void clear();
+
+  static QString stageName(atools::fs::sc::LatencyStage stage);
+
+private:
+  QString summaryInternal() const;
+
+  QString name;
+  int size;
+
+  /* Ring buffers and write position for each stage. Buffers grow up to size. */
+  QVector<qint64> samples[LATENCY_NUM_STAGES];
+  int nextIndex[LATENCY_NUM_STAGES];
+
+  qint64 logIntervalUs = 0, lastLogUs = 0;
+
+  mutable QMutex mutex;
+};
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_SC_LATENCYSTATS_H
@@ -0,0 +1,145 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/sc/replaywriterthread.h"
+
+#include "zip/gzip.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+ReplayWriterThread::ReplayWriterThread(QFile *replayFile, quint32 indexMagicNumber)
+  : file(replayFile), indexMagic(indexMagicNumber)
+{
+  setObjectName("ReplayWriterThread");
+}
+
+ReplayWriterThread::~ReplayWriterThread()
+{
+  finish();
+}
+
+void ReplayWriterThread::addPacket(const QByteArray& packet, quint32 timestamp)
+{
+  QMutexLocker locker(&mutex);
+  if(pendingBytes + packet.size() > MAX_PENDING_BYTES)
+  {
+    // Writer cannot keep up - do not let the queue grow
+    if(numDropped++ % 100 == 0)
+      qWarning() << Q_FUNC_INFO << "Writer falls behind. Dropped" << numDropped << "packets";
+    return;
+  }
+
+  pending.append({packet, timestamp});
+  pendingBytes += packet.size();
+  waitCondition.wakeOne();
+}
+
+void ReplayWriterThread::finish()
+{
+  if(isRunning())
+  {
+    {
+      QMutexLocker locker(&mutex);
+      finishing = true;
+      waitCondition.wakeOne();
+    }
+    wait();
+  }
+}
+
+void ReplayWriterThread::run()
+{
+  qDebug() << Q_FUNC_INFO << "enter";
+
+  QVector<Packet> packets;
+  bool done = false;
+  while(!done)
+  {
+    {
+      QMutexLocker locker(&mutex);
+      while(pending.isEmpty() && !finishing)
+        waitCondition.wait(&mutex);
+
+      packets.swap(pending);
+      pendingBytes = 0;
+      done = finishing;
+    }
+
+    for(const Packet& packet : packets)
+    {
+      if(blockPackets == 0)
+        blockTimestamp = packet.timestamp;
+
+      block.append(packet.data);
+      blockPackets++;
+
+      if(block.size() >= BLOCK_SIZE_BYTES)
+        writeBlock();
+    }
+    packets.clear();
+  }
+
+  writeBlock();
+  writeIndex();
+
+  qDebug() << Q_FUNC_INFO << "leave. Blocks" << index.size();
+}
+
+void ReplayWriterThread::writeBlock()
+{
+  if(blockPackets == 0)
+    return;
+
+  QByteArray compressed;
+  if(atools::zip::gzipCompress(block, compressed, COMPRESSION_LEVEL))
+  {
+    index.append({blockTimestamp, static_cast<quint64>(file->pos())});
+
+    QDataStream out(file);
+    out.setVersion(QDataStream::Qt_5_5);
+    out << static_cast<quint32>(compressed.size()) << static_cast<quint32>(blockPackets);
+    if(file->write(compressed) != compressed.size())
+      qWarning() << Q_FUNC_INFO << "Error writing" << file->fileName() << file->errorString();
+  }
+  else
+    qWarning() << Q_FUNC_INFO << "Error compressing block";
+
+  block.clear();
+  blockPackets = 0;
+}
+
+void ReplayWriterThread::writeIndex()
+{
+  QDataStream out(file);
+  out.setVersion(QDataStream::Qt_5_5);
+
+  quint64 indexOffset = static_cast<quint64>(file->pos());
+  for(const IndexEntry& entry : index)
+    out << entry.timestamp << entry.offset;
+  out << indexOffset << static_cast<quint32>(index.size()) << indexMagic;
+  file->flush();
+}
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,108 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_SC_REPLAYWRITERTHREAD_H
+#define ATOOLS_FS_SC_REPLAYWRITERTHREAD_H
+
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+class QFile;
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+/*
+ * Writes compressed blocks of replay packets in background for DataReaderThread.
+ *
+ * Packets are collected into blocks of about BLOCK_SIZE_BYTES which are compressed with gzip and written
+ * as compressed size, number of packets and data. An index entry with the timestamp of the first packet
+ * and the block offset is kept for each block and written with a footer when finished.
+ *
+ * Adding packets only appends to a list and never waits for compression or disk. Packets are dropped if
+ * the writer falls behind by more than MAX_PENDING_BYTES.
+ */
+class ReplayWriterThread :
+  public QThread
+{
+  Q_OBJECT
+
+public:
+  /* File has to be open and the header has to be written already. Index footer is marked with
+   * indexMagicNumber. */
+  ReplayWriterThread(QFile *replayFile, quint32 indexMagicNumber);
+  virtual ~ReplayWriterThread() override;
+
+  /* Add a serialized packet. Called from the data reader thread. */
+  void addPacket(const QByteArray& packet, quint32 timestamp);
+
+  /* Write all pending packets, the index and the footer and stop the thread. File is not closed. */
+  void finish();
+
+private:
+  virtual void run() override;
+
+  /* Compress and write the current block in the writer thread */
+  void writeBlock();
+  void writeIndex();
+
+  /* Uncompressed size of a block */
+  const int BLOCK_SIZE_BYTES = 512 * 1024;
+
+  /* Limit for packets waiting for the writer */
+  const int MAX_PENDING_BYTES = 64 * 1024 * 1024;
+
+  /* Speed is more important than size */
+  const int COMPRESSION_LEVEL = 1;
+
+  struct Packet
+  {
+    QByteArray data;
+    quint32 timestamp;
+  };
+
+  struct IndexEntry
+  {
+    quint32 timestamp;
+    quint64 offset;
+  };
+
+  QFile *file;
+  quint32 indexMagic;
+
+  /* Protected by mutex */
+  QVector<Packet> pending;
+  int pendingBytes = 0, numDropped = 0;
+  bool finishing = false;
+  QMutex mutex;
+  QWaitCondition waitCondition;
+
+  /* Only used in writer thread */
+  QByteArray block;
+  int blockPackets = 0;
+  quint32 blockTimestamp = 0;
+  QVector<IndexEntry> index;
+};
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_SC_REPLAYWRITERTHREAD_H
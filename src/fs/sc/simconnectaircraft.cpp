@@ -24,12 +24,50 @@ namespace atools {
 namespace fs {
 namespace sc {
 
+/* Bits in quint16 mask for delta encoding */
+enum DeltaField
+{
+  DELTA_LONX = 1 << 0,
+  DELTA_LATY = 1 << 1,
+  DELTA_ALTITUDE = 1 << 2,
+  DELTA_HEADING_TRUE = 1 << 3,
+  DELTA_HEADING_MAG = 1 << 4,
+  DELTA_GROUND_SPEED = 1 << 5,
+  DELTA_INDICATED_SPEED = 1 << 6,
+  DELTA_VERTICAL_SPEED = 1 << 7,
+  DELTA_INDICATED_ALTITUDE = 1 << 8,
+  DELTA_TRUE_AIRSPEED = 1 << 9,
+  DELTA_MACH = 1 << 10,
+  DELTA_FLAGS = 1 << 11
+};
+
+/* Empty strings shared by all default constructed aircraft */
+static const QSharedDataPointer<SimConnectAircraftStrings>& emptyStrings()
+{
+  static const QSharedDataPointer<SimConnectAircraftStrings> empty(new SimConnectAircraftStrings);
+  return empty;
+}
+
+bool SimConnectAircraftStrings::operator==(const SimConnectAircraftStrings& other) const
+{
+  return airplaneTitle == other.airplaneTitle &&
+         airplaneModel == other.airplaneModel &&
+         airplaneReg == other.airplaneReg &&
+         airplaneType == other.airplaneType &&
+         airplaneAirline == other.airplaneAirline &&
+         airplaneFlightnumber == other.airplaneFlightnumber &&
+         fromIdent == other.fromIdent &&
+         toIdent == other.toIdent;
+}
+
 SimConnectAircraft::SimConnectAircraft()
+  : strings(emptyStrings())
 {
 
 }
 
 SimConnectAircraft::SimConnectAircraft(const SimConnectAircraft& other)
+  : strings(other.strings)
 {
   *this = other;
 }
@@ -47,14 +85,16 @@ void SimConnectAircraft::read(QDataStream& in)
   in >> intFlags;
   flags = AircraftFlags(intFlags);
 
-  readString(in, airplaneTitle);
-  readString(in, airplaneModel);
-  readString(in, airplaneReg);
-  readString(in, airplaneType);
-  readString(in, airplaneAirline);
-  readString(in, airplaneFlightnumber);
-  readString(in, fromIdent);
-  readString(in, toIdent);
+  // Detach once
+  SimConnectAircraftStrings& str = *strings;
+  readString(in, str.airplaneTitle);
+  readString(in, str.airplaneModel);
+  readString(in, str.airplaneReg);
+  readString(in, str.airplaneType);
+  readString(in, str.airplaneAirline);
+  readString(in, str.airplaneFlightnumber);
+  readString(in, str.fromIdent);
+  readString(in, str.toIdent);
 
   float lonx, laty, altitude;
   quint8 categoryByte, engineTypeByte;
@@ -100,14 +140,15 @@ void SimConnectAircraft::write(QDataStream& out) const
 {
   out << objectId << static_cast<quint16>(flags);
 
-  writeString(out, airplaneTitle);
-  writeString(out, airplaneModel);
-  writeString(out, airplaneReg);
-  writeString(out, airplaneType);
-  writeString(out, airplaneAirline);
-  writeString(out, airplaneFlightnumber);
-  writeString(out, fromIdent);
-  writeString(out, toIdent);
+  const SimConnectAircraftStrings& str = *strings;
+  writeString(out, str.airplaneTitle);
+  writeString(out, str.airplaneModel);
+  writeString(out, str.airplaneReg);
+  writeString(out, str.airplaneType);
+  writeString(out, str.airplaneAirline);
+  writeString(out, str.airplaneFlightnumber);
+  writeString(out, str.fromIdent);
+  writeString(out, str.toIdent);
 
   out << position.getLonX() << position.getLatY() << position.getAltitude() << headingTrueDeg << headingMagDeg
       << groundSpeedKts << indicatedSpeedKts << verticalSpeedFeetPerMin
@@ -116,14 +157,136 @@ void SimConnectAircraft::write(QDataStream& out) const
       << static_cast<quint8>(category) << static_cast<quint8>(engineType);
 }
 
+void SimConnectAircraft::writeDelta(QDataStream& out, const SimConnectAircraft& last) const
+{
+  // Exact comparison since the client keeps the values of the last packet
+  quint16 mask = 0;
+  if(position.getLonX() != last.position.getLonX())
+    mask |= DELTA_LONX;
+  if(position.getLatY() != last.position.getLatY())
+    mask |= DELTA_LATY;
+  if(position.getAltitude() != last.position.getAltitude())
+    mask |= DELTA_ALTITUDE;
+  if(headingTrueDeg != last.headingTrueDeg)
+    mask |= DELTA_HEADING_TRUE;
+  if(headingMagDeg != last.headingMagDeg)
+    mask |= DELTA_HEADING_MAG;
+  if(groundSpeedKts != last.groundSpeedKts)
+    mask |= DELTA_GROUND_SPEED;
+  if(indicatedSpeedKts != last.indicatedSpeedKts)
+    mask |= DELTA_INDICATED_SPEED;
+  if(verticalSpeedFeetPerMin != last.verticalSpeedFeetPerMin)
+    mask |= DELTA_VERTICAL_SPEED;
+  if(indicatedAltitudeFt != last.indicatedAltitudeFt)
+    mask |= DELTA_INDICATED_ALTITUDE;
+  if(trueAirspeedKts != last.trueAirspeedKts)
+    mask |= DELTA_TRUE_AIRSPEED;
+  if(machSpeed != last.machSpeed)
+    mask |= DELTA_MACH;
+  if(flags != last.flags)
+    mask |= DELTA_FLAGS;
+
+  out << mask;
+  if(mask & DELTA_LONX)
+    out << position.getLonX();
+  if(mask & DELTA_LATY)
+    out << position.getLatY();
+  if(mask & DELTA_ALTITUDE)
+    out << position.getAltitude();
+  if(mask & DELTA_HEADING_TRUE)
+    out << headingTrueDeg;
+  if(mask & DELTA_HEADING_MAG)
+    out << headingMagDeg;
+  if(mask & DELTA_GROUND_SPEED)
+    out << groundSpeedKts;
+  if(mask & DELTA_INDICATED_SPEED)
+    out << indicatedSpeedKts;
+  if(mask & DELTA_VERTICAL_SPEED)
+    out << verticalSpeedFeetPerMin;
+  if(mask & DELTA_INDICATED_ALTITUDE)
+    out << indicatedAltitudeFt;
+  if(mask & DELTA_TRUE_AIRSPEED)
+    out << trueAirspeedKts;
+  if(mask & DELTA_MACH)
+    out << machSpeed;
+  if(mask & DELTA_FLAGS)
+    out << static_cast<quint16>(flags);
+}
+
+void SimConnectAircraft::readDelta(QDataStream& in)
+{
+  quint16 mask;
+  in >> mask;
+
+  float value;
+  if(mask & DELTA_LONX)
+  {
+    in >> value;
+    position.setLonX(value);
+  }
+  if(mask & DELTA_LATY)
+  {
+    in >> value;
+    position.setLatY(value);
+  }
+  if(mask & DELTA_ALTITUDE)
+  {
+    in >> value;
+    position.setAltitude(value);
+  }
+  if(mask & DELTA_HEADING_TRUE)
+    in >> headingTrueDeg;
+  if(mask & DELTA_HEADING_MAG)
+    in >> headingMagDeg;
+  if(mask & DELTA_GROUND_SPEED)
+    in >> groundSpeedKts;
+  if(mask & DELTA_INDICATED_SPEED)
+    in >> indicatedSpeedKts;
+  if(mask & DELTA_VERTICAL_SPEED)
+    in >> verticalSpeedFeetPerMin;
+  if(mask & DELTA_INDICATED_ALTITUDE)
+    in >> indicatedAltitudeFt;
+  if(mask & DELTA_TRUE_AIRSPEED)
+    in >> trueAirspeedKts;
+  if(mask & DELTA_MACH)
+    in >> machSpeed;
+  if(mask & DELTA_FLAGS)
+  {
+    quint16 intFlags;
+    in >> intFlags;
+    flags = AircraftFlags(intFlags);
+  }
+}
+
+bool SimConnectAircraft::isSameStatic(const SimConnectAircraft& other) const
+{
+  return (strings.constData() == other.strings.constData() || *strings == *other.strings) &&
+         numberOfEngines == other.numberOfEngines &&
+         wingSpanFt == other.wingSpanFt &&
+         modelRadiusFt == other.modelRadiusFt &&
+         category == other.category &&
+         engineType == other.engineType;
+}
+
 bool SimConnectAircraft::isSameAircraft(const SimConnectAircraft& other) const
 {
-  return airplaneTitle == other.airplaneTitle &&
-         airplaneModel == other.airplaneModel &&
-         airplaneReg == other.airplaneReg &&
-         airplaneType == other.airplaneType &&
-         airplaneAirline == other.airplaneAirline &&
-         airplaneFlightnumber == other.airplaneFlightnumber;
+  if(strings.constData() == other.strings.constData())
+    return true;
+
+  const SimConnectAircraftStrings& str = *strings, & otherStr = *other.strings;
+  return str.airplaneTitle == otherStr.airplaneTitle &&
+         str.airplaneModel == otherStr.airplaneModel &&
+         str.airplaneReg == otherStr.airplaneReg &&
+         str.airplaneType == otherStr.airplaneType &&
+         str.airplaneAirline == otherStr.airplaneAirline &&
+         str.airplaneFlightnumber == otherStr.airplaneFlightnumber;
+}
+
+void SimConnectAircraft::shareStrings(const SimConnectAircraft& other)
+{
+  // Use constData() to avoid detaching
+  if(strings.constData() != other.strings.constData() && *strings.constData() == *other.strings.constData())
+    strings = other.strings;
 }
 
 } // namespace sc
@@ -21,6 +21,7 @@
 #include "geo/pos.h"
 #include "fs/sc/simconnectdatabase.h"
 
+#include <QSharedData>
 #include <QString>
 
 class QIODevice;
@@ -40,6 +41,7 @@ namespace sc {
 class SimConnectHandler;
 class SimConnectHandlerPrivate;
 class SimConnectData;
+class XpSharedMemory;
 
 // quint8
 enum Category
@@ -65,8 +67,24 @@ enum EngineType
   TURBOPROP = 5
 };
 
+/*
+ * Strings of an aircraft which rarely change. Shared between all copies of an aircraft and only detached
+ * when a value is changed.
+ */
+class SimConnectAircraftStrings :
+  public QSharedData
+{
+public:
+  bool operator==(const SimConnectAircraftStrings& other) const;
+
+  QString airplaneTitle, airplaneType, airplaneModel, airplaneReg,
+          airplaneAirline, airplaneFlightnumber, fromIdent, toIdent;
+};
+
 /*
  * Base aircraft that is used to transfer across network links. For user and AI aircraft.
+ *
+ * Strings are kept in a shared block which makes copies of aircraft lists cheap.
  */
 class SimConnectAircraft :
   public SimConnectDataBase
@@ -79,40 +97,54 @@ public:
   virtual void read(QDataStream& in);
   virtual void write(QDataStream& out) const;
 
+  /* Write a bit mask and all numeric fields which differ from last. Strings and other static fields
+   * are not written. */
+  void writeDelta(QDataStream& out, const SimConnectAircraft& last) const;
+
+  /* Read changes as written by writeDelta() and apply them to this object which has to be a copy of last */
+  void readDelta(QDataStream& in);
+
+  /* true if all fields which are not sent in deltas are equal */
+  bool isSameStatic(const SimConnectAircraft& other) const;
+
+  /* Use the shared strings of other if all are equal. Used to avoid duplicates when the same aircraft
+   * is received or converted repeatedly. */
+  void shareStrings(const SimConnectAircraft& other);
+
   // fs data ----------------------------------------------------
 
   /* Mooney, Boeing, */
   const QString& getAirplaneType() const
   {
-    return airplaneType;
+    return strings->airplaneType;
   }
 
   const QString& getAirplaneAirline() const
   {
-    return airplaneAirline;
+    return strings->airplaneAirline;
   }
 
   const QString& getAirplaneFlightnumber() const
   {
-    return airplaneFlightnumber;
+    return strings->airplaneFlightnumber;
   }
 
   /* Beech Baron 58 Paint 1 */
   const QString& getAirplaneTitle() const
   {
-    return airplaneTitle;
+    return strings->airplaneTitle;
   }
 
   /* Short ICAO code MD80, BE58, etc. */
   const QString& getAirplaneModel() const
   {
-    return airplaneModel;
+    return strings->airplaneModel;
   }
 
   /* N71FS */
   const QString& getAirplaneRegistration() const
   {
-    return airplaneReg;
+    return strings->airplaneReg;
   }
 
   /* Includes actual altitude in feet */
@@ -217,12 +249,12 @@ public:
 
   const QString& getFromIdent() const
   {
-    return fromIdent;
+    return strings->fromIdent;
   }
 
   const QString& getToIdent() const
   {
-    return toIdent;
+    return strings->toIdent;
   }
 
   bool isOnGround() const
@@ -292,24 +324,24 @@ private:
   friend class atools::fs::sc::SimConnectData;
   friend class xpc::XpConnect;
   friend class atools::fs::online::OnlinedataManager;
+  friend class atools::fs::sc::XpSharedMemory;
 
-  QString airplaneTitle, airplaneType, airplaneModel, airplaneReg,
-          airplaneAirline, airplaneFlightnumber, fromIdent, toIdent;
-
+  /* Values changing with each update grouped together */
   atools::geo::Pos position;
   float headingTrueDeg = 0.f, headingMagDeg = 0.f, groundSpeedKts = 0.f, indicatedAltitudeFt = 0.f,
         indicatedSpeedKts = 0.f, trueAirspeedKts = 0.f,
         machSpeed = 0.f, verticalSpeedFeetPerMin = 0.f;
-  quint16 modelRadiusFt = 0, wingSpanFt = 0;
-
-  quint32 objectId = 0L;
-
   AircraftFlags flags = atools::fs::sc::NONE;
+  quint32 objectId = 0L;
 
+  quint16 modelRadiusFt = 0, wingSpanFt = 0;
   Category category;
   EngineType engineType = atools::fs::sc::UNSUPPORTED;
   quint8 numberOfEngines = 0;
   bool debug = false;
+
+  /* Writing through the non-const pointer detaches */
+  QSharedDataPointer<atools::fs::sc::SimConnectAircraftStrings> strings;
 };
 
 } // namespace sc
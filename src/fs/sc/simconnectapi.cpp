@@ -18,6 +18,7 @@
 #include "fs/sc/simconnectapi.h"
 
 #include "win/activationcontext.h"
+#include "fs/sc/trafficgenerator.h"
 
 #include <QDebug>
 
@@ -27,6 +28,9 @@
                      ((*(FARPROC *)&SC_ ## a = \
                          (FARPROC)context.getProcAddress("SimConnect.dll", "SimConnect_" # a)) == NULL))
 
+// Bind to the functions in simconnectdummy.cpp
+#define BINDDUMMY(a) (SC_ ## a = SimConnect_ ## a)
+
 namespace atools {
 namespace fs {
 namespace sc {
@@ -123,6 +127,21 @@ bool SimConnectApi::bindFunctions(atools::win::ActivationContext& context)
   BINDSC(RequestFacilitiesList);
 #else
   Q_UNUSED(context);
+
+  // Dummy functions reply with synthetic traffic if a generator is installed
+  if(atools::fs::sc::TrafficGenerator::getDummyInstance() != nullptr)
+  {
+    BINDDUMMY(Open);
+    BINDDUMMY(Close);
+    BINDDUMMY(AddToDataDefinition);
+    BINDDUMMY(ClearDataDefinition);
+    BINDDUMMY(RequestDataOnSimObjectType);
+    BINDDUMMY(SubscribeToSystemEvent);
+    BINDDUMMY(WeatherRequestInterpolatedObservation);
+    BINDDUMMY(WeatherRequestObservationAtStation);
+    BINDDUMMY(WeatherRequestObservationAtNearestStation);
+    BINDDUMMY(CallDispatch);
+  }
 #endif
 
   qDebug() << Q_FUNC_INFO << "done";
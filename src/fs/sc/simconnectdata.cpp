@@ -17,6 +17,7 @@
 
 #include "fs/sc/simconnectdata.h"
 
+#include "fs/sc/latencystats.h"
 #include "geo/calculations.h"
 
 #include <QDebug>
@@ -43,7 +44,7 @@ SimConnectData::~SimConnectData()
 
 }
 
-bool SimConnectData::read(QIODevice *ioDevice)
+bool SimConnectData::read(QIODevice *ioDevice, SimConnectDataDeltaState *state)
 {
   status = OK;
 
@@ -78,7 +79,7 @@ bool SimConnectData::read(QIODevice *ioDevice)
     return false;
 
   in >> version;
-  if(version != DATA_VERSION)
+  if(version != DATA_VERSION_FULL && !(version == DATA_VERSION && state != nullptr))
   {
     qWarning() << "SimConnectData::read: version mismatch" << version << "!=" << DATA_VERSION;
     status = VERSION_MISMATCH;
@@ -91,13 +92,18 @@ bool SimConnectData::read(QIODevice *ioDevice)
   if(hasUser == 1)
     userAircraft.read(in);
 
-  quint16 numAi = 0;
-  in >> numAi;
-  for(quint16 i = 0; i < numAi; i++)
+  if(version == DATA_VERSION)
+    readAiDelta(in, *state);
+  else
   {
-    SimConnectAircraft ap;
-    ap.read(in);
-    aiAircraft.append(ap);
+    quint16 numAi = 0;
+    in >> numAi;
+    for(quint16 i = 0; i < numAi; i++)
+    {
+      SimConnectAircraft ap;
+      ap.read(in);
+      aiAircraft.append(ap);
+    }
   }
 
   quint16 numMetar = 0;
@@ -123,30 +129,131 @@ bool SimConnectData::read(QIODevice *ioDevice)
     metarResults.append(result);
   }
 
+  if(state != nullptr && version == DATA_VERSION_FULL && metarResults.isEmpty())
+  {
+    // Server sends full packets in between deltas - following deltas refer to this one
+    state->aircraft.clear();
+    for(const SimConnectAircraft& ap : aiAircraft)
+      state->aircraft.insert(ap.objectId, ap);
+  }
+
+  receivedUs = LatencyStats::nowUs();
   return true;
 }
 
+void SimConnectData::readAiDelta(QDataStream& in, SimConnectDataDeltaState& state)
+{
+  quint8 frameType;
+  quint16 numAi = 0;
+  in >> frameType >> numAi;
+
+  // Aircraft missing in this packet are removed from the state
+  QHash<quint32, SimConnectAircraft> current;
+  current.reserve(numAi);
+  for(quint16 i = 0; i < numAi; i++)
+  {
+    quint8 type;
+    in >> type;
+
+    SimConnectAircraft ap;
+    if(type == AIRCRAFT_FULL)
+    {
+      ap.read(in);
+
+      // Key frames repeat all strings - keep the instances of the last packet
+      auto it = state.aircraft.constFind(ap.objectId);
+      if(it != state.aircraft.constEnd())
+        ap.shareStrings(it.value());
+    }
+    else
+    {
+      quint32 id;
+      in >> id;
+      ap = state.aircraft.value(id);
+      ap.readDelta(in);
+
+      if(frameType == FRAME_KEY || !state.aircraft.contains(id))
+      {
+        // Missed the full record - aircraft will appear with the next key frame
+        qWarning() << "SimConnectData::read: no full record for aircraft" << id;
+        continue;
+      }
+    }
+    current.insert(ap.objectId, ap);
+    aiAircraft.append(ap);
+  }
+  state.aircraft.swap(current);
+}
+
+void SimConnectData::writeAiDelta(QDataStream& out, SimConnectDataDeltaState& state) const
+{
+  bool keyFrame = state.packetsSinceKeyFrame < 0 ||
+                  state.packetsSinceKeyFrame >= SimConnectDataDeltaState::KEY_FRAME_INTERVAL;
+  state.packetsSinceKeyFrame = keyFrame ? 0 : state.packetsSinceKeyFrame + 1;
+
+  int numAi = std::min(65535, aiAircraft.size());
+  out << (keyFrame ? FRAME_KEY : FRAME_DELTA) << static_cast<quint16>(numAi);
+
+  QHash<quint32, SimConnectAircraft> current;
+  current.reserve(numAi);
+  for(int i = 0; i < numAi; i++)
+  {
+    const SimConnectAircraft& ap = aiAircraft.at(i);
+    auto it = state.aircraft.constFind(ap.objectId);
+
+    if(keyFrame || it == state.aircraft.constEnd() || !ap.isSameStatic(it.value()))
+    {
+      // New or changed aircraft
+      out << AIRCRAFT_FULL;
+      ap.write(out);
+    }
+    else
+    {
+      out << AIRCRAFT_DELTA << ap.objectId;
+      ap.writeDelta(out, it.value());
+    }
+    current.insert(ap.objectId, ap);
+  }
+  state.aircraft.swap(current);
+}
+
 int SimConnectData::write(QIODevice *ioDevice)
 {
   status = OK;
+  return SimConnectDataBase::writeBlock(ioDevice, toByteArray(nullptr), status);
+}
+
+int SimConnectData::writeDelta(QIODevice *ioDevice, SimConnectDataDeltaState& state)
+{
+  status = OK;
+  return SimConnectDataBase::writeBlock(ioDevice, toByteArray(&state), status);
+}
 
+QByteArray SimConnectData::toByteArray(SimConnectDataDeltaState *state) const
+{
   QByteArray block;
   QDataStream out(&block, QIODevice::WriteOnly);
   out.setVersion(QDataStream::Qt_5_5);
   out.setFloatingPointPrecision(QDataStream::SinglePrecision);
 
-  out << MAGIC_NUMBER_DATA << packetSize << DATA_VERSION << packetId << packetTs;
+  out << MAGIC_NUMBER_DATA << packetSize << (state != nullptr ? DATA_VERSION : DATA_VERSION_FULL)
+      << packetId << packetTs;
 
   bool userValid = userAircraft.getPosition().isValid();
   out << static_cast<quint8>(userValid);
   if(userValid)
     userAircraft.write(out);
 
-  int numAi = std::min(65535, aiAircraft.size());
-  out << static_cast<quint16>(numAi);
+  if(state != nullptr)
+    writeAiDelta(out, *state);
+  else
+  {
+    int numAi = std::min(65535, aiAircraft.size());
+    out << static_cast<quint16>(numAi);
 
-  for(int i = 0; i < numAi; i++)
-    aiAircraft.at(i).write(out);
+    for(int i = 0; i < numAi; i++)
+      aiAircraft.at(i).write(out);
+  }
 
   int numMetar = std::min(65535, metarResults.size());
   out << static_cast<quint16>(numMetar);
@@ -167,7 +274,18 @@ int SimConnectData::write(QIODevice *ioDevice)
   int size = block.size() - static_cast<int>(sizeof(packetSize)) - static_cast<int>(sizeof(MAGIC_NUMBER_DATA));
   out << static_cast<quint32>(size);
 
-  return SimConnectDataBase::writeBlock(ioDevice, block, status);
+  return block;
+}
+
+void SimConnectData::clear()
+{
+  status = OK;
+  packetId = packetTs = 0;
+  magicNumber = packetSize = version = 0;
+  fetchStartUs = fetchEndUs = receivedUs = 0;
+  userAircraft = SimConnectUserAircraft();
+  aiAircraft.clear();
+  metarResults.clear();
 }
 
 SimConnectData SimConnectData::buildDebugForPosition(const geo::Pos& pos, const geo::Pos& lastPos)
@@ -194,15 +312,15 @@ SimConnectData SimConnectData::buildDebugForPosition(const geo::Pos& pos, const
   data.userAircraft.zuluDateTime = QDateTime::currentDateTimeUtc();
   data.userAircraft.localDateTime = QDateTime::currentDateTime();
 
-  data.userAircraft.airplaneTitle = "Title";
-  data.userAircraft.airplaneType = "Type";
-  data.userAircraft.airplaneModel = "Model";
-  data.userAircraft.airplaneReg = "Ref";
-  data.userAircraft.airplaneAirline = "Airline";
-  data.userAircraft.airplaneFlightnumber = "965";
-  data.userAircraft.fromIdent = "EDDF";
+  data.userAircraft.strings->airplaneTitle = "Title";
+  data.userAircraft.strings->airplaneType = "Type";
+  data.userAircraft.strings->airplaneModel = "Model";
+  data.userAircraft.strings->airplaneReg = "Ref";
+  data.userAircraft.strings->airplaneAirline = "Airline";
+  data.userAircraft.strings->airplaneFlightnumber = "965";
+  data.userAircraft.strings->fromIdent = "EDDF";
 
-  data.userAircraft.toIdent = "LIRF";
+  data.userAircraft.strings->toIdent = "LIRF";
   data.userAircraft.altitudeAboveGroundFt = pos.getAltitude();
   data.userAircraft.indicatedAltitudeFt = pos.getAltitude();
 
@@ -25,6 +25,7 @@
 
 #include <QString>
 #include <QDateTime>
+#include <QHash>
 
 class QIODevice;
 
@@ -38,6 +39,37 @@ namespace sc {
 
 class SimConnectHandler;
 
+/*
+ * Keeps the AI aircraft of the last packet for the delta protocol. One object is needed per connection and
+ * on both the sending and the receiving side.
+ */
+class SimConnectDataDeltaState
+{
+public:
+  /* Clear all aircraft and force a key frame for the next written packet */
+  void reset()
+  {
+    aircraft.clear();
+    packetsSinceKeyFrame = -1;
+  }
+
+  /* true if the last written packet was a key frame */
+  bool isKeyFrame() const
+  {
+    return packetsSinceKeyFrame == 0;
+  }
+
+private:
+  friend class atools::fs::sc::SimConnectData;
+
+  /* Send a full packet after this number of deltas */
+  const static int KEY_FRAME_INTERVAL = 50;
+
+  /* Aircraft as sent or received in the last packet keyed by object id */
+  QHash<quint32, atools::fs::sc::SimConnectAircraft> aircraft;
+  int packetsSinceKeyFrame = -1;
+};
+
 /*
  * Class that transfers flight simulator data read using the simconnect interface across the network to
  * a client like Little Navmap. A version of the protocol is maintained to check for application compatibility.
@@ -51,17 +83,30 @@ public:
   virtual ~SimConnectData();
 
   /*
-   * Read from IO device.
+   * Read from IO device. Accepts the full format and the delta format. State is needed to read delta packets
+   * and has to be kept for the whole connection.
    * @return true if it was fully read. False if not or an error occured.
    */
-  bool read(QIODevice *ioDevice);
+  bool read(QIODevice *ioDevice, atools::fs::sc::SimConnectDataDeltaState *state = nullptr);
 
   /*
-   * Write to IO device.
+   * Write to IO device using the full format of version 9 which is understood by all clients.
    * @return number of bytes written
    */
   int write(QIODevice *ioDevice);
 
+  /*
+   * Write to IO device using the delta format. Sends a key frame with all aircraft periodically and
+   * otherwise only changed numeric fields. Static fields like title or registration are sent once for
+   * each aircraft. Use only if the client requested the delta protocol.
+   * @return number of bytes written
+   */
+  int writeDelta(QIODevice *ioDevice, atools::fs::sc::SimConnectDataDeltaState& state);
+
+  /* Serialize into a block as written by write() or by writeDelta() if state is not null. The block can be
+   * written to several devices. */
+  QByteArray toByteArray(atools::fs::sc::SimConnectDataDeltaState *state = nullptr) const;
+
   // metadata ----------------------------------------------------
   /* Serial number for data packet. */
   int getPacketId() const
@@ -86,6 +131,35 @@ public:
     packetTs = static_cast<quint32>(value);
   }
 
+  /* Monotonic timestamps in microseconds from LatencyStats::nowUs() for latency measurement. Not transferred.
+   * Fetch timestamps are set by the data reader and the receive timestamp by read(). 0 if not set. */
+  qint64 getFetchStartUs() const
+  {
+    return fetchStartUs;
+  }
+
+  qint64 getFetchEndUs() const
+  {
+    return fetchEndUs;
+  }
+
+  void setFetchTimestampsUs(qint64 startUs, qint64 endUs)
+  {
+    fetchStartUs = startUs;
+    fetchEndUs = endUs;
+  }
+
+  qint64 getReceivedUs() const
+  {
+    return receivedUs;
+  }
+
+  /* true if the packet was read in delta format. Servers sending deltas accept latency reports in replies. */
+  bool isDeltaFormat() const
+  {
+    return version == DATA_VERSION;
+  }
+
   /*
    * @return data version for this packet format
    */
@@ -133,15 +207,31 @@ public:
     return userAircraft.position.isValid();
   }
 
+  /* Reset to default but keep capacity of containers to allow reusing the object */
+  void clear();
+
 private:
   friend class atools::fs::sc::SimConnectHandler;
   friend class xpc::XpConnect;
 
   const static quint32 MAGIC_NUMBER_DATA = 0xF75E0AF3;
-  const static quint32 DATA_VERSION = 9;
+  const static quint32 DATA_VERSION = 10;
+
+  /* Version without delta encoding */
+  const static quint32 DATA_VERSION_FULL = 9;
+
+  /* Frame types in delta packets */
+  const static quint8 FRAME_KEY = 0, FRAME_DELTA = 1;
+
+  /* Aircraft record types in delta packets */
+  const static quint8 AIRCRAFT_FULL = 0, AIRCRAFT_DELTA = 1;
+
+  void readAiDelta(QDataStream& in, atools::fs::sc::SimConnectDataDeltaState& state);
+  void writeAiDelta(QDataStream& out, atools::fs::sc::SimConnectDataDeltaState& state) const;
 
   quint32 packetId = 0, packetTs = 0;
   quint32 magicNumber = 0, packetSize = 0, version = 0;
+  qint64 fetchStartUs = 0, fetchEndUs = 0, receivedUs = 0;
 
   atools::fs::sc::SimConnectUserAircraft userAircraft;
   QVector<atools::fs::sc::SimConnectAircraft> aiAircraft;
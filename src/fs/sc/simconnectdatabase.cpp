@@ -35,6 +35,11 @@ SimConnectDataBase::~SimConnectDataBase()
 }
 
 QString SimConnectDataBase::getStatusText() const
+{
+  return statusText(status);
+}
+
+QString SimConnectDataBase::statusText(SimConnectStatus status)
 {
   switch(status)
   {
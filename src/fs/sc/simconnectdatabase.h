@@ -46,6 +46,7 @@ public:
    * @return Error status text for last reading or writing call
    */
   QString getStatusText() const;
+  static QString statusText(atools::fs::sc::SimConnectStatus status);
 
   static int writeBlock(QIODevice *ioDevice, const QByteArray& block,
                         atools::fs::sc::SimConnectStatus& status);
@@ -0,0 +1,56 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/sc/simconnectdatabuffer.h"
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+SimConnectDataBuffer::SimConnectDataBuffer()
+  : middle(2)
+{
+
+}
+
+SimConnectData& SimConnectDataBuffer::beginWrite()
+{
+  SimConnectData& data = slots[writeIndex];
+  data.clear();
+  return data;
+}
+
+bool SimConnectDataBuffer::endWrite()
+{
+  int old = middle.exchange(writeIndex | FRESH);
+  writeIndex = old & INDEX_MASK;
+  return !(old & FRESH);
+}
+
+const SimConnectData *SimConnectDataBuffer::takeLatest()
+{
+  if(!(middle.load() & FRESH))
+    return nullptr;
+
+  int old = middle.exchange(readIndex);
+  readIndex = old & INDEX_MASK;
+  return &slots[readIndex];
+}
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,71 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_SC_SIMCONNECTDATABUFFER_H
+#define ATOOLS_FS_SC_SIMCONNECTDATABUFFER_H
+
+#include "fs/sc/simconnectdata.h"
+
+#include <atomic>
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+/*
+ * Lock free handoff of SimConnectData between one producer and one consumer thread. Latest value wins:
+ * if the consumer does not take a packet before the next one is published the older one is dropped.
+ *
+ * Uses three preallocated slots which are reused. The producer fills its slot and swaps it with the
+ * middle slot. The consumer swaps its slot with the middle slot if this contains new data.
+ */
+class SimConnectDataBuffer
+{
+public:
+  SimConnectDataBuffer();
+
+  /* Producer: get the cleared slot to fill. Containers keep their capacity. */
+  atools::fs::sc::SimConnectData& beginWrite();
+
+  /* Producer: publish the slot filled after beginWrite().
+   * @return true if the consumer has taken the previous packet and needs to be notified. false if the
+   * previous packet was replaced. */
+  bool endWrite();
+
+  /* Consumer: get the latest published packet or null if nothing was published since the last call.
+   * Pointer is valid until the next call. */
+  const atools::fs::sc::SimConnectData *takeLatest();
+
+private:
+  /* Set in middle if it was not taken yet */
+  const static int FRESH = 4;
+  const static int INDEX_MASK = 3;
+
+  atools::fs::sc::SimConnectData slots[3];
+
+  /* Only accessed by producer or consumer respectively */
+  int writeIndex = 0, readIndex = 1;
+
+  /* Index of the middle slot and FRESH flag */
+  std::atomic<int> middle;
+};
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_SC_SIMCONNECTDATABUFFER_H
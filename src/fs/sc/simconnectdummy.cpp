@@ -19,15 +19,449 @@
 
 #if !defined(Q_OS_WIN32)
 
+#include "fs/sc/trafficgenerator.h"
+
 #include <QDebug>
+#include <QDateTime>
+#include <QHash>
+
+#include <algorithm>
+#include <cstring>
 
 #pragma GCC diagnostic ignored "-Wold-style-cast"
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 
-HRESULT StringCbLengthA(const char *, size_t cbMax, size_t *pcb)
+using atools::fs::sc::TrafficGenerator;
+using atools::fs::sc::TrafficObject;
+
+/* Simulator variables known by the dummy connection */
+enum DatumKind
+{
+  DATUM_UNKNOWN,
+  DATUM_TITLE,
+  DATUM_ATC_TYPE,
+  DATUM_ATC_MODEL,
+  DATUM_ATC_ID,
+  DATUM_ATC_AIRLINE,
+  DATUM_ATC_FLIGHT_NUMBER,
+  DATUM_CATEGORY,
+  DATUM_IS_USER,
+  DATUM_MODEL_RADIUS,
+  DATUM_WING_SPAN,
+  DATUM_AI_FROM,
+  DATUM_AI_TO,
+  DATUM_ALTITUDE,
+  DATUM_LATITUDE,
+  DATUM_LONGITUDE,
+  DATUM_GROUND_VELOCITY,
+  DATUM_INDICATED_ALTITUDE,
+  DATUM_HEADING_MAG,
+  DATUM_HEADING_TRUE,
+  DATUM_ON_GROUND,
+  DATUM_AIRSPEED_TRUE,
+  DATUM_AIRSPEED_INDICATED,
+  DATUM_AIRSPEED_MACH,
+  DATUM_VERTICAL_SPEED,
+  DATUM_NUM_ENGINES,
+  DATUM_ENGINE_TYPE,
+  DATUM_MAGVAR,
+  DATUM_TRACK_MAG,
+  DATUM_TRACK_TRUE,
+  DATUM_ALT_ABOVE_GROUND,
+  DATUM_GROUND_ALTITUDE,
+  DATUM_AMBIENT_TEMPERATURE,
+  DATUM_TOTAL_AIR_TEMPERATURE,
+  DATUM_WIND_VELOCITY,
+  DATUM_WIND_DIRECTION,
+  DATUM_VISIBILITY,
+  DATUM_SEA_LEVEL_PRESSURE,
+  DATUM_TOTAL_WEIGHT,
+  DATUM_MAX_GROSS_WEIGHT,
+  DATUM_EMPTY_WEIGHT,
+  DATUM_FUEL_QUANTITY,
+  DATUM_FUEL_WEIGHT,
+  DATUM_FUEL_FLOW_PPH,
+  DATUM_FUEL_FLOW_GPH,
+  DATUM_LOCAL_TIME,
+  DATUM_LOCAL_YEAR,
+  DATUM_LOCAL_MONTH,
+  DATUM_LOCAL_DAY,
+  DATUM_ZULU_TIME,
+  DATUM_ZULU_YEAR,
+  DATUM_ZULU_MONTH,
+  DATUM_ZULU_DAY,
+  DATUM_TIME_ZONE_OFFSET
+};
+
+static const struct
+{
+  const char *name;
+  DatumKind kind;
+} DATUM_NAMES[] =
+{
+  {"Title", DATUM_TITLE},
+  {"ATC Type", DATUM_ATC_TYPE},
+  {"ATC Model", DATUM_ATC_MODEL},
+  {"ATC Id", DATUM_ATC_ID},
+  {"ATC Airline", DATUM_ATC_AIRLINE},
+  {"ATC Flight Number", DATUM_ATC_FLIGHT_NUMBER},
+  {"Category", DATUM_CATEGORY},
+  {"Is User Sim", DATUM_IS_USER},
+  {"Visual Model Radius", DATUM_MODEL_RADIUS},
+  {"Wing Span", DATUM_WING_SPAN},
+  {"AI Traffic Fromairport", DATUM_AI_FROM},
+  {"AI Traffic Toairport", DATUM_AI_TO},
+  {"Plane Altitude", DATUM_ALTITUDE},
+  {"Plane Latitude", DATUM_LATITUDE},
+  {"Plane Longitude", DATUM_LONGITUDE},
+  {"Ground Velocity", DATUM_GROUND_VELOCITY},
+  {"Indicated Altitude", DATUM_INDICATED_ALTITUDE},
+  {"Plane Heading Degrees Magnetic", DATUM_HEADING_MAG},
+  {"Plane Heading Degrees True", DATUM_HEADING_TRUE},
+  {"Sim On Ground", DATUM_ON_GROUND},
+  {"Airspeed True", DATUM_AIRSPEED_TRUE},
+  {"Airspeed Indicated", DATUM_AIRSPEED_INDICATED},
+  {"Airspeed Mach", DATUM_AIRSPEED_MACH},
+  {"Vertical Speed", DATUM_VERTICAL_SPEED},
+  {"Number of Engines", DATUM_NUM_ENGINES},
+  {"Engine Type", DATUM_ENGINE_TYPE},
+  {"Magvar", DATUM_MAGVAR},
+  {"GPS Ground Magnetic Track", DATUM_TRACK_MAG},
+  {"GPS Ground True Track", DATUM_TRACK_TRUE},
+  {"Plane Alt Above Ground", DATUM_ALT_ABOVE_GROUND},
+  {"Ground Altitude", DATUM_GROUND_ALTITUDE},
+  {"Ambient Temperature", DATUM_AMBIENT_TEMPERATURE},
+  {"Total Air Temperature", DATUM_TOTAL_AIR_TEMPERATURE},
+  {"Ambient Wind Velocity", DATUM_WIND_VELOCITY},
+  {"Ambient Wind Direction", DATUM_WIND_DIRECTION},
+  {"Ambient Visibility", DATUM_VISIBILITY},
+  {"Sea Level Pressure", DATUM_SEA_LEVEL_PRESSURE},
+  {"Total Weight", DATUM_TOTAL_WEIGHT},
+  {"Max Gross Weight", DATUM_MAX_GROSS_WEIGHT},
+  {"Empty Weight", DATUM_EMPTY_WEIGHT},
+  {"Fuel Total Quantity", DATUM_FUEL_QUANTITY},
+  {"Fuel Total Quantity Weight", DATUM_FUEL_WEIGHT},
+  {"Eng Fuel Flow PPH:1", DATUM_FUEL_FLOW_PPH},
+  {"Eng Fuel Flow PPH:2", DATUM_FUEL_FLOW_PPH},
+  {"Eng Fuel Flow PPH:3", DATUM_FUEL_FLOW_PPH},
+  {"Eng Fuel Flow PPH:4", DATUM_FUEL_FLOW_PPH},
+  {"Eng Fuel Flow GPH:1", DATUM_FUEL_FLOW_GPH},
+  {"Eng Fuel Flow GPH:2", DATUM_FUEL_FLOW_GPH},
+  {"Eng Fuel Flow GPH:3", DATUM_FUEL_FLOW_GPH},
+  {"Eng Fuel Flow GPH:4", DATUM_FUEL_FLOW_GPH},
+  {"Local Time", DATUM_LOCAL_TIME},
+  {"Local Year", DATUM_LOCAL_YEAR},
+  {"Local Month of Year", DATUM_LOCAL_MONTH},
+  {"Local Day of Month", DATUM_LOCAL_DAY},
+  {"Zulu Time", DATUM_ZULU_TIME},
+  {"Zulu Year", DATUM_ZULU_YEAR},
+  {"Zulu Month of Year", DATUM_ZULU_MONTH},
+  {"Zulu Day of Month", DATUM_ZULU_DAY},
+  {"Time Zone Offset", DATUM_TIME_ZONE_OFFSET}
+};
+
+struct Datum
+{
+  DatumKind kind;
+  SIMCONNECT_DATATYPE type;
+
+  /* Engine number for fuel flow */
+  int engine;
+};
+
+/* State of the dummy connection which replies with data from the traffic generator */
+struct DummyConnection
+{
+  bool open = false;
+
+  /* Data definitions by id */
+  QHash<DWORD, QVector<Datum> > definitions;
+
+  /* Replies waiting for the next dispatch call */
+  QVector<QByteArray> packets;
+};
+
+static DummyConnection connection;
+
+static bool isConnected()
+{
+  return connection.open && TrafficGenerator::getDummyInstance() != nullptr;
+}
+
+/* Size of the datum in the reply */
+static int datumSize(SIMCONNECT_DATATYPE type)
+{
+  switch(type)
+  {
+    case SIMCONNECT_DATATYPE_INT32:
+    case SIMCONNECT_DATATYPE_FLOAT32:
+      return 4;
+
+    case SIMCONNECT_DATATYPE_INT64:
+    case SIMCONNECT_DATATYPE_FLOAT64:
+    case SIMCONNECT_DATATYPE_STRING8:
+      return 8;
+
+    case SIMCONNECT_DATATYPE_STRING32:
+      return 32;
+
+    case SIMCONNECT_DATATYPE_STRING64:
+      return 64;
+
+    case SIMCONNECT_DATATYPE_STRING128:
+      return 128;
+
+    case SIMCONNECT_DATATYPE_STRING256:
+      return 256;
+
+    case SIMCONNECT_DATATYPE_STRING260:
+      return 260;
+
+    default:
+      return 0;
+  }
+}
+
+/* Create a zero initialized reply packet with header and size */
+template<typename TYPE>
+static TYPE *newPacket(SIMCONNECT_RECV_ID id, int extraSize)
+{
+  connection.packets.append(QByteArray(static_cast<int>(sizeof(TYPE)) + extraSize, '\0'));
+  TYPE *recv = reinterpret_cast<TYPE *>(connection.packets.last().data());
+  recv->dwSize = static_cast<DWORD>(connection.packets.last().size());
+  recv->dwVersion = 4;
+  recv->dwID = id;
+  return recv;
+}
+
+/* String value of the datum or null if numeric */
+static const QByteArray *datumString(const Datum& datum, const TrafficObject& obj)
+{
+  static const QByteArray AIRPLANE("Airplane"), HELICOPTER("Helicopter"), BOAT("Boat");
+
+  switch(datum.kind)
+  {
+    case DATUM_TITLE:
+      return &obj.title;
+
+    case DATUM_ATC_TYPE:
+      return &obj.atcType;
+
+    case DATUM_ATC_MODEL:
+      return &obj.atcModel;
+
+    case DATUM_ATC_ID:
+      return &obj.atcId;
+
+    case DATUM_ATC_AIRLINE:
+      return &obj.airline;
+
+    case DATUM_ATC_FLIGHT_NUMBER:
+      return &obj.flightNumber;
+
+    case DATUM_AI_FROM:
+      return &obj.fromIdent;
+
+    case DATUM_AI_TO:
+      return &obj.toIdent;
+
+    case DATUM_CATEGORY:
+      return obj.category == atools::fs::sc::HELICOPTER ? &HELICOPTER :
+             (obj.category == atools::fs::sc::BOAT ? &BOAT : &AIRPLANE);
+
+    default:
+      return nullptr;
+  }
+}
+
+/* Numeric value of the datum in the units used by SimConnectHandler */
+static double datumValue(const Datum& datum, const TrafficObject& obj, const TrafficGenerator& generator)
+{
+  float altitude = obj.position.getAltitude();
+  float groundAltitude = obj.category == atools::fs::sc::BOAT ? 0.f : generator.getConfig().center.getAltitude();
+  float fuelFlowPph = obj.engineType == 0 ? 60.f : 2500.f;
+
+  switch(datum.kind)
+  {
+    case DATUM_IS_USER:
+      return obj.user ? 1. : 0.;
+
+    case DATUM_MODEL_RADIUS:
+      return obj.wingSpanFt / 2;
+
+    case DATUM_WING_SPAN:
+      return obj.wingSpanFt;
+
+    case DATUM_ALTITUDE:
+    case DATUM_INDICATED_ALTITUDE:
+      return altitude;
+
+    case DATUM_LATITUDE:
+      return obj.position.getLatY();
+
+    case DATUM_LONGITUDE:
+      return obj.position.getLonX();
+
+    case DATUM_GROUND_VELOCITY:
+    case DATUM_AIRSPEED_TRUE:
+      return obj.speedKts;
+
+    case DATUM_AIRSPEED_INDICATED:
+      // Rough approximation of 2 percent per 1000 ft
+      return obj.speedKts / (1. + altitude / 1000. * 0.02);
+
+    case DATUM_AIRSPEED_MACH:
+      return obj.speedKts / 661.5;
+
+    case DATUM_HEADING_MAG:
+    case DATUM_HEADING_TRUE:
+    case DATUM_TRACK_MAG:
+    case DATUM_TRACK_TRUE:
+      return obj.headingTrueDeg;
+
+    case DATUM_ON_GROUND:
+      return obj.onGround ? 1. : 0.;
+
+    case DATUM_VERTICAL_SPEED:
+      return obj.verticalSpeedFpm / 60.;
+
+    case DATUM_NUM_ENGINES:
+      return obj.numEngines;
+
+    case DATUM_ENGINE_TYPE:
+      return obj.engineType;
+
+    case DATUM_ALT_ABOVE_GROUND:
+      return altitude - groundAltitude;
+
+    case DATUM_GROUND_ALTITUDE:
+      return groundAltitude;
+
+    case DATUM_AMBIENT_TEMPERATURE:
+      return 15. - altitude / 1000. * 2.;
+
+    case DATUM_TOTAL_AIR_TEMPERATURE:
+      return 17. - altitude / 1000. * 2.;
+
+    case DATUM_WIND_VELOCITY:
+      return generator.getWindSpeedKts();
+
+    case DATUM_WIND_DIRECTION:
+      return generator.getWindDirectionDeg();
+
+    case DATUM_VISIBILITY:
+      return 20000.;
+
+    case DATUM_SEA_LEVEL_PRESSURE:
+      return generator.getSeaLevelPressureMbar();
+
+    case DATUM_TOTAL_WEIGHT:
+      return 140000.;
+
+    case DATUM_MAX_GROSS_WEIGHT:
+      return 170000.;
+
+    case DATUM_EMPTY_WEIGHT:
+      return 90000.;
+
+    case DATUM_FUEL_QUANTITY:
+      return 5000.;
+
+    case DATUM_FUEL_WEIGHT:
+      return 5000. * 6.7;
+
+    case DATUM_FUEL_FLOW_PPH:
+      return datum.engine <= obj.numEngines ? fuelFlowPph : 0.;
+
+    case DATUM_FUEL_FLOW_GPH:
+      return datum.engine <= obj.numEngines ? fuelFlowPph / 6.7 : 0.;
+
+    case DATUM_LOCAL_TIME:
+      return QTime::currentTime().msecsSinceStartOfDay() / 1000;
+
+    case DATUM_LOCAL_YEAR:
+      return QDate::currentDate().year();
+
+    case DATUM_LOCAL_MONTH:
+      return QDate::currentDate().month();
+
+    case DATUM_LOCAL_DAY:
+      return QDate::currentDate().day();
+
+    case DATUM_ZULU_TIME:
+      return QDateTime::currentDateTimeUtc().time().msecsSinceStartOfDay() / 1000;
+
+    case DATUM_ZULU_YEAR:
+      return QDateTime::currentDateTimeUtc().date().year();
+
+    case DATUM_ZULU_MONTH:
+      return QDateTime::currentDateTimeUtc().date().month();
+
+    case DATUM_ZULU_DAY:
+      return QDateTime::currentDateTimeUtc().date().day();
+
+    case DATUM_TIME_ZONE_OFFSET:
+      // Positive west of GMT
+      return -QDateTime::currentDateTime().offsetFromUtc();
+
+    default:
+      return 0.;
+  }
+}
+
+/* Write datum into the reply and move dest to the next datum */
+static void writeDatum(char *& dest, const Datum& datum, const TrafficObject& obj, const TrafficGenerator& generator)
 {
-  static HRESULT hr = E_FAIL;
-  return hr;
+  int size = datumSize(datum.type);
+  const QByteArray *str = datumString(datum, obj);
+
+  if(datum.type >= SIMCONNECT_DATATYPE_STRING8 && datum.type <= SIMCONNECT_DATATYPE_STRING260)
+  {
+    // Packet is zero initialized - keep terminating null
+    if(str != nullptr)
+      memcpy(dest, str->constData(), static_cast<size_t>(std::min(str->size(), size - 1)));
+  }
+  else
+  {
+    double value = str == nullptr ? datumValue(datum, obj, generator) : 0.;
+    switch(datum.type)
+    {
+      case SIMCONNECT_DATATYPE_INT32:
+        *reinterpret_cast<qint32 *>(dest) = static_cast<qint32>(value);
+        break;
+
+      case SIMCONNECT_DATATYPE_INT64:
+        *reinterpret_cast<qint64 *>(dest) = static_cast<qint64>(value);
+        break;
+
+      case SIMCONNECT_DATATYPE_FLOAT32:
+        *reinterpret_cast<float *>(dest) = static_cast<float>(value);
+        break;
+
+      case SIMCONNECT_DATATYPE_FLOAT64:
+        *reinterpret_cast<double *>(dest) = value;
+        break;
+
+      default:
+        break;
+    }
+  }
+  dest += size;
+}
+
+HRESULT StringCbLengthA(const char *psz, size_t cbMax, size_t *pcb)
+{
+  if(psz == nullptr)
+    return E_FAIL;
+
+  // Fails if not terminated within cbMax bytes
+  const void *end = memchr(psz, 0, cbMax);
+  if(end == nullptr)
+    return E_FAIL;
+
+  if(pcb != nullptr)
+    *pcb = static_cast<size_t>(static_cast<const char *>(end) - psz);
+  return S_OK;
 }
 
 SIMCONNECTAPI SimConnect_MapClientEventToSimEvent(HANDLE hSimConnect, SIMCONNECT_CLIENT_EVENT_ID EventID,
@@ -90,12 +524,36 @@ SIMCONNECTAPI SimConnect_AddToDataDefinition(HANDLE hSimConnect, SIMCONNECT_DATA
                                              float fEpsilon,
                                              DWORD DatumID)
 {
-  return E_FAIL;
+  if(!isConnected())
+    return E_FAIL;
+
+  Datum datum = {DATUM_UNKNOWN, DatumType, 0};
+  for(const auto& name : DATUM_NAMES)
+  {
+    if(strcmp(name.name, DatumName) == 0)
+    {
+      datum.kind = name.kind;
+      break;
+    }
+  }
+
+  if(datum.kind == DATUM_FUEL_FLOW_PPH || datum.kind == DATUM_FUEL_FLOW_GPH)
+    datum.engine = DatumName[strlen(DatumName) - 1] - '0';
+
+  if(datum.kind == DATUM_UNKNOWN)
+    qWarning() << "Dummy: Unknown datum" << DatumName << "- sending zero";
+
+  connection.definitions[DefineID].append(datum);
+  return S_OK;
 }
 
 SIMCONNECTAPI SimConnect_ClearDataDefinition(HANDLE hSimConnect, SIMCONNECT_DATA_DEFINITION_ID DefineID)
 {
-  return E_FAIL;
+  if(!isConnected())
+    return E_FAIL;
+
+  connection.definitions.remove(DefineID);
+  return S_OK;
 }
 
 SIMCONNECTAPI SimConnect_RequestDataOnSimObject(HANDLE hSimConnect, SIMCONNECT_DATA_REQUEST_ID RequestID,
@@ -113,7 +571,82 @@ SIMCONNECTAPI SimConnect_RequestDataOnSimObjectType(HANDLE hSimConnect, SIMCONNE
                                                     DWORD dwRadiusMeters,
                                                     SIMCONNECT_SIMOBJECT_TYPE type)
 {
-  return E_FAIL;
+  if(!isConnected())
+    return E_FAIL;
+
+  TrafficGenerator *generator = TrafficGenerator::getDummyInstance();
+
+  // The user aircraft is requested once per fetch - advance traffic
+  if(type == SIMCONNECT_SIMOBJECT_TYPE_USER)
+    generator->update();
+
+  // Collect objects of the requested type around the user aircraft
+  const QVector<TrafficObject>& objects = generator->getObjects();
+  const atools::geo::Pos& userPos = objects.first().position;
+  QVector<const TrafficObject *> found;
+  for(const TrafficObject& obj : objects)
+  {
+    bool match = false;
+    switch(type)
+    {
+      case SIMCONNECT_SIMOBJECT_TYPE_USER:
+        match = obj.user;
+        break;
+
+      case SIMCONNECT_SIMOBJECT_TYPE_ALL:
+        match = true;
+        break;
+
+      case SIMCONNECT_SIMOBJECT_TYPE_AIRCRAFT:
+        // Includes the user aircraft like the simulator
+        match = obj.category == atools::fs::sc::AIRPLANE;
+        break;
+
+      case SIMCONNECT_SIMOBJECT_TYPE_HELICOPTER:
+        match = obj.category == atools::fs::sc::HELICOPTER;
+        break;
+
+      case SIMCONNECT_SIMOBJECT_TYPE_BOAT:
+        match = obj.category == atools::fs::sc::BOAT;
+        break;
+
+      case SIMCONNECT_SIMOBJECT_TYPE_GROUND:
+        break;
+    }
+
+    if(match && (obj.user || userPos.distanceMeterTo(obj.position) <= dwRadiusMeters))
+      found.append(&obj);
+  }
+
+  const QVector<Datum> datums = connection.definitions.value(DefineID);
+  int dataSize = 0;
+  for(const Datum& datum : datums)
+    dataSize += datumSize(datum.type);
+
+  // One reply for each object or an empty one if nothing was found
+  DWORD outof = static_cast<DWORD>(found.size());
+  for(int i = 0; i < std::max(found.size(), 1); i++)
+  {
+    // Structure contains the first DWORD of data
+    SIMCONNECT_RECV_SIMOBJECT_DATA_BYTYPE *recv = newPacket<SIMCONNECT_RECV_SIMOBJECT_DATA_BYTYPE>(
+      SIMCONNECT_RECV_ID_SIMOBJECT_DATA_BYTYPE, std::max(dataSize - static_cast<int>(sizeof(DWORD)), 0));
+    recv->dwRequestID = RequestID;
+    recv->dwDefineID = DefineID;
+    recv->dwoutof = outof;
+    recv->dwDefineCount = static_cast<DWORD>(datums.size());
+
+    if(!found.isEmpty())
+    {
+      const TrafficObject& obj = *found.at(i);
+      recv->dwentrynumber = static_cast<DWORD>(i + 1);
+      recv->dwObjectID = obj.objectId;
+
+      char *dest = reinterpret_cast<char *>(&recv->dwData);
+      for(const Datum& datum : datums)
+        writeDatum(dest, datum, obj, *generator);
+    }
+  }
+  return S_OK;
 }
 
 SIMCONNECTAPI SimConnect_SetDataOnSimObject(HANDLE hSimConnect, SIMCONNECT_DATA_DEFINITION_ID DefineID,
@@ -167,7 +700,15 @@ SIMCONNECTAPI SimConnect_RequestReservedKey(HANDLE hSimConnect, SIMCONNECT_CLIEN
 SIMCONNECTAPI SimConnect_SubscribeToSystemEvent(HANDLE hSimConnect, SIMCONNECT_CLIENT_EVENT_ID EventID,
                                                 const char *SystemEventName)
 {
-  return E_FAIL;
+  if(!isConnected())
+    return E_FAIL;
+
+  // Simulator is always running and never paused
+  SIMCONNECT_RECV_EVENT *recv = newPacket<SIMCONNECT_RECV_EVENT>(SIMCONNECT_RECV_ID_EVENT, 0);
+  recv->uGroupID = SIMCONNECT_RECV_EVENT::UNKNOWN_GROUP;
+  recv->uEventID = EventID;
+  recv->dwData = strcmp(SystemEventName, "Sim") == 0 ? 1 : 0;
+  return S_OK;
 }
 
 SIMCONNECTAPI SimConnect_UnsubscribeFromSystemEvent(HANDLE hSimConnect, SIMCONNECT_CLIENT_EVENT_ID EventID)
@@ -175,19 +716,44 @@ SIMCONNECTAPI SimConnect_UnsubscribeFromSystemEvent(HANDLE hSimConnect, SIMCONNE
   return E_FAIL;
 }
 
+/* Queue a generated METAR or an exception if weather is disabled */
+static HRESULT weatherReply(SIMCONNECT_DATA_REQUEST_ID requestId, const QString& ident, const atools::geo::Pos& pos)
+{
+  if(!isConnected())
+    return E_FAIL;
+
+  const TrafficGenerator *generator = TrafficGenerator::getDummyInstance();
+  if(generator->getConfig().weather)
+  {
+    QByteArray metar = generator->metar(ident, pos).toLatin1();
+    SIMCONNECT_RECV_WEATHER_OBSERVATION *recv = newPacket<SIMCONNECT_RECV_WEATHER_OBSERVATION>(
+      SIMCONNECT_RECV_ID_WEATHER_OBSERVATION, metar.size());
+    recv->dwRequestID = requestId;
+    memcpy(recv->szMetar, metar.constData(), static_cast<size_t>(metar.size()));
+  }
+  else
+  {
+    SIMCONNECT_RECV_EXCEPTION *recv = newPacket<SIMCONNECT_RECV_EXCEPTION>(SIMCONNECT_RECV_ID_EXCEPTION, 0);
+    recv->dwException = SIMCONNECT_EXCEPTION_WEATHER_UNABLE_TO_GET_OBSERVATION;
+    recv->dwSendID = SIMCONNECT_RECV_EXCEPTION::UNKNOWN_SENDID;
+    recv->dwIndex = SIMCONNECT_RECV_EXCEPTION::UNKNOWN_INDEX;
+  }
+  return S_OK;
+}
+
 SIMCONNECTAPI SimConnect_WeatherRequestInterpolatedObservation(HANDLE hSimConnect,
                                                                SIMCONNECT_DATA_REQUEST_ID RequestID,
                                                                float lat, float lon,
                                                                float alt)
 {
-  return E_FAIL;
+  return weatherReply(RequestID, QString(), atools::geo::Pos(lon, lat, alt));
 }
 
 SIMCONNECTAPI SimConnect_WeatherRequestObservationAtStation(HANDLE hSimConnect,
                                                             SIMCONNECT_DATA_REQUEST_ID RequestID,
                                                             const char *szICAO)
 {
-  return E_FAIL;
+  return weatherReply(RequestID, QString(szICAO), atools::geo::Pos());
 }
 
 SIMCONNECTAPI SimConnect_WeatherRequestObservationAtNearestStation(HANDLE hSimConnect,
@@ -195,7 +761,7 @@ SIMCONNECTAPI SimConnect_WeatherRequestObservationAtNearestStation(HANDLE hSimCo
                                                                    float lat,
                                                                    float lon)
 {
-  return E_FAIL;
+  return weatherReply(RequestID, QString(), atools::geo::Pos(lon, lat));
 }
 
 SIMCONNECTAPI SimConnect_WeatherCreateStation(HANDLE hSimConnect, SIMCONNECT_DATA_REQUEST_ID RequestID,
@@ -328,7 +894,14 @@ SIMCONNECTAPI SimConnect_CompleteCustomMissionAction(HANDLE hSimConnect, const G
 SIMCONNECTAPI SimConnect_Close(HANDLE hSimConnect)
 {
   qDebug() << "Dummy: SimConnect_Close";
-  return E_FAIL;
+
+  if(!connection.open)
+    return E_FAIL;
+
+  connection.open = false;
+  connection.definitions.clear();
+  connection.packets.clear();
+  return S_OK;
 }
 
 SIMCONNECTAPI SimConnect_RetrieveString(SIMCONNECT_RECV *pData, DWORD cbData, void *pStringV,
@@ -348,12 +921,38 @@ SIMCONNECTAPI SimConnect_Open(HANDLE *phSimConnect, LPCSTR szName, HWND hWnd, DW
                               DWORD ConfigIndex)
 {
   qDebug() << "Dummy: SimConnect_Open";
-  return 1;
+
+  if(TrafficGenerator::getDummyInstance() == nullptr)
+    return 1;
+
+  connection.open = true;
+  connection.definitions.clear();
+  connection.packets.clear();
+  *phSimConnect = &connection;
+
+  SIMCONNECT_RECV_OPEN *recv = newPacket<SIMCONNECT_RECV_OPEN>(SIMCONNECT_RECV_ID_OPEN, 0);
+  strcpy(recv->szApplicationName, "SimConnect Dummy Traffic");
+  recv->dwApplicationVersionMajor = 10;
+  recv->dwSimConnectVersionMajor = 10;
+  return S_OK;
 }
 
 SIMCONNECTAPI SimConnect_CallDispatch(HANDLE hSimConnect, DispatchProc pfcnDispatch, void *pContext)
 {
-  return E_FAIL;
+  if(!isConnected())
+    return E_FAIL;
+
+  // Take all queued replies since the callback might send new requests
+  QVector<QByteArray> packets;
+  packets.swap(connection.packets);
+  for(QByteArray& packet : packets)
+    pfcnDispatch(reinterpret_cast<SIMCONNECT_RECV *>(packet.data()), static_cast<DWORD>(packet.size()), pContext);
+
+  // Keep capacity
+  packets.resize(0);
+  if(connection.packets.isEmpty())
+    connection.packets.swap(packets);
+  return S_OK;
 }
 
 SIMCONNECTAPI SimConnect_GetNextDispatch(HANDLE hSimConnect, SIMCONNECT_RECV **ppData, DWORD *pcbData)
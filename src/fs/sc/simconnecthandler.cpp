@@ -20,17 +20,24 @@
 #include "fs/sc/simconnectapi.h"
 #include "fs/sc/weatherrequest.h"
 #include "fs/sc/simconnectdata.h"
+#include "fs/sc/trafficgenerator.h"
 #include "geo/calculations.h"
 #include "win/activationcontext.h"
+#include "logging/loggingmacros.h"
+#include "util/perfcounters.h"
+#include "util/tracerecorder.h"
 
 #include <QDate>
 #include <QTime>
 #include <QDateTime>
 #include <QThread>
-#include <QSet>
+#include <QHash>
 #include <QCache>
 #include <QLatin1Literal>
 
+#include <cstddef>
+#include <cstring>
+
 #pragma GCC diagnostic ignored "-Wold-style-cast"
 
 using atools::fs::weather::MetarResult;
@@ -152,6 +159,16 @@ struct SimData
   qint32 timeZoneOffsetSeconds;
 };
 
+/* Converted AI aircraft of the last fetch. Strings are reused if the raw strings did not change. */
+struct AiAircraftCacheEntry
+{
+  SimDataAircraft raw;
+  atools::fs::sc::SimConnectAircraft aircraft;
+
+  /* Fetch number when the aircraft was seen the last time */
+  quint32 fetchCount = 0;
+};
+
 class SimConnectHandlerPrivate
 {
 public:
@@ -174,6 +191,17 @@ public:
   void copyToSimData(const SimDataAircraft& simDataUserAircraft,
                      atools::fs::sc::SimConnectAircraft& aircraft);
 
+  /* Copy only variable numeric fields and flags */
+  void copyValuesToSimData(const SimDataAircraft& simDataUserAircraft,
+                           atools::fs::sc::SimConnectAircraft& aircraft);
+
+  /* Convert AI aircraft using the cache */
+  void copyAiToSimData(const SimDataAircraft& simDataAircraft, unsigned long objectId,
+                       atools::fs::sc::SimConnectAircraft& aircraft);
+
+  /* true if the strings of both aircraft are equal */
+  static bool sameStrings(const SimDataAircraft& data1, const SimDataAircraft& data2);
+
   bool checkCall(HRESULT hr, const QString& message);
   bool callDispatch(bool& dataFetched, const QString& message);
 
@@ -183,6 +211,13 @@ public:
   QVector<SimDataAircraft> simDataAircraft;
   QVector<unsigned long> simDataAircraftObjectIds;
 
+  /* AI aircraft keyed by object id */
+  QHash<unsigned long, AiAircraftCacheEntry> aiCache;
+  quint32 fetchCount = 0;
+
+  /* Batched mode: requests which did not receive their last entry yet as bits (1 << DataRequestId) */
+  int pendingRequests = 0;
+
   sc::State state = sc::STATEOK;
 
   atools::fs::sc::WeatherRequest weatherRequest;
@@ -190,16 +225,17 @@ public:
   SIMCONNECT_EXCEPTION simconnectException;
 
   bool simRunning = true, simPaused = false, verbose = false, simConnectLoaded = false,
-       userDataFetched = false, aiDataFetched = false, weatherDataFetched = false;
+       userDataFetched = false, aiDataFetched = false, weatherDataFetched = false, allDataFetched = false;
 };
 
 void SimConnectHandlerPrivate::dispatchProcedure(SIMCONNECT_RECV *pData, DWORD cbData)
 {
-  Q_UNUSED(cbData);
-
-  if(verbose)
+  if(ATOOLS_VERBOSE(verbose))
     qDebug() << "DispatchProcedure entered";
 
+  ATOOLS_PERF_COUNT("simconnect.packets", 1);
+  ATOOLS_PERF_COUNT("simconnect.bytes", cbData);
+
   switch(pData->dwID)
   {
     case SIMCONNECT_RECV_ID_OPEN:
@@ -241,13 +277,13 @@ void SimConnectHandlerPrivate::dispatchProcedure(SIMCONNECT_RECV *pData, DWORD c
         switch(evt->uEventID)
         {
           case EVENT_SIM_PAUSE:
-            if(verbose)
+            if(ATOOLS_VERBOSE(verbose))
               qDebug() << "EVENT_SIM_PAUSE" << evt->dwData;
             simPaused = evt->dwData == 1;
             break;
 
           case EVENT_SIM_STATE:
-            if(verbose)
+            if(ATOOLS_VERBOSE(verbose))
               qDebug() << "EVENT_SIM_STATE" << evt->dwData;
             simRunning = evt->dwData == 1;
             break;
@@ -259,9 +295,16 @@ void SimConnectHandlerPrivate::dispatchProcedure(SIMCONNECT_RECV *pData, DWORD c
       {
         SIMCONNECT_RECV_SIMOBJECT_DATA_BYTYPE *pObjData = static_cast<SIMCONNECT_RECV_SIMOBJECT_DATA_BYTYPE *>(pData);
 
+        // Last entry of a request - entries are one based and dwoutof is 0 if nothing was found
+        if(pendingRequests != 0 && pObjData->dwentrynumber >= pObjData->dwoutof)
+        {
+          pendingRequests &= ~(1 << pObjData->dwRequestID);
+          allDataFetched = pendingRequests == 0;
+        }
+
         if(pObjData->dwRequestID == DATA_REQUEST_ID_USER_AIRCRAFT)
         {
-          if(verbose)
+          if(ATOOLS_VERBOSE(verbose))
             qDebug() << "DATA_REQUEST_ID_USER_AIRCRAFT"
                      << "pObjData->dwDefineCount" << pObjData->dwDefineCount
                      << "pObjData->dwDefineID" << pObjData->dwDefineID
@@ -274,7 +317,7 @@ void SimConnectHandlerPrivate::dispatchProcedure(SIMCONNECT_RECV *pData, DWORD c
           DWORD objectID = pObjData->dwObjectID;
           SimData *simDataPtr = reinterpret_cast<SimData *>(&pObjData->dwData);
 
-          if(verbose)
+          if(ATOOLS_VERBOSE(verbose))
             qDebug() << "ObjectID" << objectID
                      << "Title" << simDataPtr->aircraft.aircraftTitle
                      << "atcType" << simDataPtr->aircraft.aircraftAtcType
@@ -320,7 +363,7 @@ void SimConnectHandlerPrivate::dispatchProcedure(SIMCONNECT_RECV *pData, DWORD c
                 pObjData->dwRequestID == DATA_REQUEST_ID_AI_HELICOPTER ||
                 pObjData->dwRequestID == DATA_REQUEST_ID_AI_BOAT)
         {
-          if(verbose)
+          if(ATOOLS_VERBOSE(verbose))
             qDebug() << "DATA_REQUEST_ID_AI_AIRCRAFT/HELICOPTER/BOAT"
                      << "pObjData->dwDefineCount" << pObjData->dwDefineCount
                      << "pObjData->dwDefineID" << pObjData->dwDefineID
@@ -340,7 +383,7 @@ void SimConnectHandlerPrivate::dispatchProcedure(SIMCONNECT_RECV *pData, DWORD c
                                          sizeof(simDataAircraftPtr->aircraftTitle),
                                          NULL))) // security check
             {
-              if(verbose)
+              if(ATOOLS_VERBOSE(verbose))
                 qDebug() << "ObjectID" << objectID
                          << "Title" << simDataAircraftPtr->aircraftTitle
                          << "atcType" << simDataAircraftPtr->aircraftAtcType
@@ -385,7 +428,7 @@ void SimConnectHandlerPrivate::dispatchProcedure(SIMCONNECT_RECV *pData, DWORD c
            pObjData->dwRequestID == DATA_REQUEST_ID_WEATHER_NEAREST_STATION ||
            pObjData->dwRequestID == DATA_REQUEST_ID_WEATHER_STATION)
         {
-          if(verbose)
+          if(ATOOLS_VERBOSE(verbose))
             qDebug() << "METAR" << pszMETAR;
 
           fetchedMetars.append(QString(pszMETAR));
@@ -395,18 +438,18 @@ void SimConnectHandlerPrivate::dispatchProcedure(SIMCONNECT_RECV *pData, DWORD c
       }
 
     case SIMCONNECT_RECV_ID_QUIT:
-      if(verbose)
+      if(ATOOLS_VERBOSE(verbose))
         qDebug() << "SIMCONNECT_RECV_ID_QUIT";
       simRunning = false;
       state = sc::DISCONNECTED;
       break;
 
     default:
-      if(verbose)
+      if(ATOOLS_VERBOSE(verbose))
         qDebug() << "Received" << pData->dwID;
       break;
   }
-  if(verbose)
+  if(ATOOLS_VERBOSE(verbose))
     qDebug() << "DispatchProcedure finished";
 }
 
@@ -418,15 +461,16 @@ void CALLBACK SimConnectHandlerPrivate::dispatchCallback(SIMCONNECT_RECV *pData,
 
 void SimConnectHandlerPrivate::copyToSimData(const SimDataAircraft& simDataUserAircraft, SimConnectAircraft& aircraft)
 {
-  aircraft.flags = atools::fs::sc::SIM_FSX_P3D;
-  aircraft.airplaneTitle = simDataUserAircraft.aircraftTitle;
-  aircraft.airplaneModel = simDataUserAircraft.aircraftAtcModel;
-  aircraft.airplaneReg = simDataUserAircraft.aircraftAtcId;
-  aircraft.airplaneType = simDataUserAircraft.aircraftAtcType;
-  aircraft.airplaneAirline = simDataUserAircraft.aircraftAtcAirline;
-  aircraft.airplaneFlightnumber = simDataUserAircraft.aircraftAtcFlightNumber;
-  aircraft.fromIdent = simDataUserAircraft.aiFrom;
-  aircraft.toIdent = simDataUserAircraft.aiTo;
+  // Detaches the shared strings once
+  SimConnectAircraftStrings& strings = *aircraft.strings;
+  strings.airplaneTitle = simDataUserAircraft.aircraftTitle;
+  strings.airplaneModel = simDataUserAircraft.aircraftAtcModel;
+  strings.airplaneReg = simDataUserAircraft.aircraftAtcId;
+  strings.airplaneType = simDataUserAircraft.aircraftAtcType;
+  strings.airplaneAirline = simDataUserAircraft.aircraftAtcAirline;
+  strings.airplaneFlightnumber = simDataUserAircraft.aircraftAtcFlightNumber;
+  strings.fromIdent = simDataUserAircraft.aiFrom;
+  strings.toIdent = simDataUserAircraft.aiTo;
 
   QString cat = QString(simDataUserAircraft.category).toLower().trimmed();
   if(cat == "airplane")
@@ -444,6 +488,13 @@ void SimConnectHandlerPrivate::copyToSimData(const SimDataAircraft& simDataUserA
   else if(cat == "viewer")
     aircraft.category = VIEWER;
 
+  copyValuesToSimData(simDataUserAircraft, aircraft);
+}
+
+void SimConnectHandlerPrivate::copyValuesToSimData(const SimDataAircraft& simDataUserAircraft,
+                                                   SimConnectAircraft& aircraft)
+{
+  aircraft.flags = atools::fs::sc::SIM_FSX_P3D;
   aircraft.wingSpanFt = static_cast<quint16>(simDataUserAircraft.wingSpan);
   aircraft.modelRadiusFt = static_cast<quint16>(simDataUserAircraft.modelRadius);
 
@@ -473,9 +524,37 @@ void SimConnectHandlerPrivate::copyToSimData(const SimDataAircraft& simDataUserA
     aircraft.flags |= atools::fs::sc::SIM_PAUSED;
 }
 
+bool SimConnectHandlerPrivate::sameStrings(const SimDataAircraft& data1, const SimDataAircraft& data2)
+{
+  // Title to category and from/to airport are contiguous blocks
+  return memcmp(data1.aircraftTitle, data2.aircraftTitle, offsetof(SimDataAircraft, userSim)) == 0 &&
+         memcmp(data1.aiFrom, data2.aiFrom,
+                offsetof(SimDataAircraft, altitudeFt) - offsetof(SimDataAircraft, aiFrom)) == 0;
+}
+
+void SimConnectHandlerPrivate::copyAiToSimData(const SimDataAircraft& simDataAircraft, unsigned long objectId,
+                                               SimConnectAircraft& aircraft)
+{
+  AiAircraftCacheEntry& entry = aiCache[objectId];
+  if(entry.fetchCount == 0 || !sameStrings(entry.raw, simDataAircraft))
+  {
+    // New aircraft or changed strings - full conversion
+    copyToSimData(simDataAircraft, entry.aircraft);
+    entry.raw = simDataAircraft;
+  }
+  else
+    copyValuesToSimData(simDataAircraft, entry.aircraft);
+
+  entry.aircraft.objectId = static_cast<unsigned int>(objectId);
+  entry.fetchCount = fetchCount;
+
+  // Shares the strings
+  aircraft = entry.aircraft;
+}
+
 bool SimConnectHandlerPrivate::checkCall(HRESULT hr, const QString& message)
 {
-  if(verbose)
+  if(ATOOLS_VERBOSE(verbose))
     qDebug() << "check call" << message;
 
   if(hr != S_OK)
@@ -489,7 +568,7 @@ bool SimConnectHandlerPrivate::checkCall(HRESULT hr, const QString& message)
 
 bool SimConnectHandlerPrivate::callDispatch(bool& dataFetched, const QString& message)
 {
-  if(verbose)
+  if(ATOOLS_VERBOSE(verbose))
     qDebug() << "call dispatch enter" << message;
 
   simconnectException = SIMCONNECT_EXCEPTION_NONE;
@@ -509,15 +588,17 @@ bool SimConnectHandlerPrivate::callDispatch(bool& dataFetched, const QString& me
         state = sc::FETCH_ERROR;
         return false;
       }
-      else if(verbose)
+      else if(ATOOLS_VERBOSE(verbose))
         qDebug() << "SimConnect_CallDispatch during " << message << ": Exception" << simconnectException;
     }
 
-    QThread::msleep(5);
+    // Give the simulator time to send more data
+    if(!dataFetched)
+      QThread::msleep(5);
     dispatchCycles++;
   } while(!dataFetched && dispatchCycles < 50 && simconnectException == SIMCONNECT_EXCEPTION_NONE);
 
-  if(verbose)
+  if(ATOOLS_VERBOSE(verbose))
     qDebug() << "call dispatch leave" << message << "cycles" << dispatchCycles;
 
   return true;
@@ -598,6 +679,15 @@ bool SimConnectHandler::loadSimConnect(const QString& manifestPath)
 {
   p->simConnectLoaded = false;
 
+#if !defined(Q_OS_WIN32)
+  // Synthetic traffic from the dummy functions does not need a library
+  if(TrafficGenerator::getDummyInstance() != nullptr)
+  {
+    p->simConnectLoaded = p->api.bindFunctions(p->context);
+    return p->simConnectLoaded;
+  }
+#endif
+
   if(!p->context.create(manifestPath))
     return false;
 
@@ -782,16 +872,26 @@ bool SimConnectHandler::connect()
 
 bool SimConnectHandler::fetchData(atools::fs::sc::SimConnectData& data, int radiusKm, atools::fs::sc::Options options)
 {
+  ATOOLS_TRACE_SPAN("SimConnectHandler::fetchData", "simconnect");
+
   if(p->verbose)
     qDebug() << "fetchData entered ================================================================";
 
   // === Get AI aircraft =======================================================
-  p->simDataAircraft.clear();
-  p->simDataAircraftObjectIds.clear();
+  // Keep capacity
+  p->simDataAircraft.resize(0);
+  p->simDataAircraftObjectIds.resize(0);
   p->simDataObjectId = 0;
 
+  bool batched = options.testFlag(FETCH_BATCHED);
+  p->pendingRequests = 0;
+
   HRESULT hr = 0;
 
+  // Let the simulator do the coarse filtering if the filter radius is smaller
+  if(aircraftFilter.getRadiusKm() > 0.f)
+    radiusKm = std::min(radiusKm, static_cast<int>(std::ceil(aircraftFilter.getRadiusKm())));
+
   if(options & FETCH_AI_AIRCRAFT)
   {
     hr = p->api.RequestDataOnSimObjectType(
@@ -805,6 +905,8 @@ bool SimConnectHandler::fetchData(atools::fs::sc::SimConnectData& data, int radi
       static_cast<DWORD>(radiusKm) * 1000, SIMCONNECT_SIMOBJECT_TYPE_HELICOPTER);
     if(!p->checkCall(hr, "DATA_REQUEST_ID_AI_HELICOPTER"))
       return false;
+
+    p->pendingRequests |= 1 << DATA_REQUEST_ID_AI_AIRCRAFT | 1 << DATA_REQUEST_ID_AI_HELICOPTER;
   }
 
   if(options & FETCH_AI_BOAT)
@@ -814,10 +916,16 @@ bool SimConnectHandler::fetchData(atools::fs::sc::SimConnectData& data, int radi
       static_cast<DWORD>(radiusKm) * 1000, SIMCONNECT_SIMOBJECT_TYPE_BOAT);
     if(!p->checkCall(hr, "DATA_REQUEST_ID_AI_BOAT"))
       return false;
+
+    p->pendingRequests |= 1 << DATA_REQUEST_ID_AI_BOAT;
   }
 
-  p->callDispatch(p->aiDataFetched,
-                  "DATA_REQUEST_ID_AI_HELICOPTER, DATA_REQUEST_ID_AI_BOAT and DATA_REQUEST_ID_AI_AIRCRAFT");
+  if(!batched)
+  {
+    p->pendingRequests = 0;
+    p->callDispatch(p->aiDataFetched,
+                    "DATA_REQUEST_ID_AI_HELICOPTER, DATA_REQUEST_ID_AI_BOAT and DATA_REQUEST_ID_AI_AIRCRAFT");
+  }
 
   // === Get user aircraft =======================================================
   hr = p->api.RequestDataOnSimObjectType(
@@ -826,24 +934,61 @@ bool SimConnectHandler::fetchData(atools::fs::sc::SimConnectData& data, int radi
   if(!p->checkCall(hr, "DATA_REQUEST_ID_USER_AIRCRAFT"))
     return false;
 
-  p->callDispatch(p->userDataFetched, "DATA_REQUEST_ID_USER_AIRCRAFT");
+  p->userDataFetched = false;
+  if(batched)
+  {
+    // Wait for the last entry of all requests in one loop
+    p->pendingRequests |= 1 << DATA_REQUEST_ID_USER_AIRCRAFT;
+    p->callDispatch(p->allDataFetched, "DATA_REQUEST_ID_USER_AIRCRAFT and AI requests");
+    p->pendingRequests = 0;
+  }
+  else
+    p->callDispatch(p->userDataFetched, "DATA_REQUEST_ID_USER_AIRCRAFT");
 
   p->state = sc::STATEOK;
 
-  // Get user aircraft =======================================================================
-  QSet<unsigned long> objectIds;
-  for(int i = 0; i < p->simDataAircraft.size(); i++)
+  // Get AI aircraft =======================================================================
+  // Filter by distance to user before copying
+  QVector<int> indexes;
+  if(aircraftFilter.isActive() && p->userDataFetched)
+  {
+    QVector<atools::geo::Pos> positions;
+    positions.reserve(p->simDataAircraft.size());
+    for(const SimDataAircraft& simDataAircraft : p->simDataAircraft)
+      positions.append(atools::geo::Pos(simDataAircraft.longitudeDeg, simDataAircraft.latitudeDeg));
+
+    aircraftFilter.filter(indexes, atools::geo::Pos(p->simData.aircraft.longitudeDeg,
+                                                    p->simData.aircraft.latitudeDeg), positions);
+  }
+  else
+  {
+    indexes.reserve(p->simDataAircraft.size());
+    for(int i = 0; i < p->simDataAircraft.size(); i++)
+      indexes.append(i);
+  }
+
+  // Convert into the slots of the data object - capacity is kept if it is reused
+  p->fetchCount++;
+  int numAircraft = data.aiAircraft.size();
+  data.aiAircraft.resize(numAircraft + indexes.size());
+  for(int i : indexes)
   {
     unsigned long oid = p->simDataAircraftObjectIds.at(i);
-    // Avoid duplicates
-    if(!objectIds.contains(oid))
-    {
-      atools::fs::sc::SimConnectAircraft aircraft;
-      p->copyToSimData(p->simDataAircraft.at(i), aircraft);
-      aircraft.objectId = static_cast<unsigned int>(oid);
-      data.aiAircraft.append(aircraft);
-      objectIds.insert(aircraft.objectId);
-    }
+
+    // Avoid duplicates - aircraft was already converted in this fetch
+    QHash<unsigned long, AiAircraftCacheEntry>::const_iterator it = p->aiCache.constFind(oid);
+    if(it == p->aiCache.constEnd() || it->fetchCount != p->fetchCount)
+      p->copyAiToSimData(p->simDataAircraft.at(i), oid, data.aiAircraft[numAircraft++]);
+  }
+  data.aiAircraft.resize(numAircraft);
+
+  // Remove aircraft which disappeared
+  for(QHash<unsigned long, AiAircraftCacheEntry>::iterator it = p->aiCache.begin(); it != p->aiCache.end();)
+  {
+    if(it->fetchCount != p->fetchCount)
+      it = p->aiCache.erase(it);
+    else
+      ++it;
   }
 
   // Get user aircraft =======================================================================
@@ -40,7 +40,8 @@ public:
   SimConnectHandler(bool verboseLogging = false);
   virtual ~SimConnectHandler();
 
-  /* Activate context and load SimConnect DLL */
+  /* Activate context and load SimConnect DLL.
+   * Uses the synthetic traffic of TrafficGenerator::getDummyInstance() on non-Windows platforms if set. */
   bool loadSimConnect(const QString& manifestPath);
   virtual bool isLoaded() const override;
 
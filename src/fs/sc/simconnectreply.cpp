@@ -87,6 +87,9 @@ bool SimConnectReply::read(QIODevice *ioDevice)
 
   weatherRequest.read(in);
 
+  if(command.testFlag(CMD_LATENCY_REPORT))
+    in >> clientDelayUs;
+
   return true;
 }
 
@@ -104,6 +107,9 @@ int SimConnectReply::write(QIODevice *ioDevice)
 
   weatherRequest.write(out);
 
+  if(command.testFlag(CMD_LATENCY_REPORT))
+    out << clientDelayUs;
+
   // Go back and update size
   out.device()->seek(sizeof(MAGIC_NUMBER_REPLY));
   int size = block.size() - static_cast<int>(sizeof(packetSize)) - static_cast<int>(sizeof(MAGIC_NUMBER_REPLY));
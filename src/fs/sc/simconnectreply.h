@@ -25,6 +25,8 @@
 
 #include <QString>
 
+#include <algorithm>
+
 class QIODevice;
 
 namespace atools {
@@ -34,8 +36,16 @@ namespace sc {
 // quint16
 enum CommandEnum
 {
-  CMD_NONE,
-  CMD_WEATHER_REQUEST
+  CMD_NONE = 0,
+  CMD_WEATHER_REQUEST = 1 << 0,
+
+  /* Client can read the delta format of SimConnectData. Only set in normal replies since older servers
+   * compare the command for weather requests. */
+  CMD_DELTA_PROTOCOL = 1 << 1,
+
+  /* Reply carries the client processing time for latency statistics. Changes the packet layout - set only
+   * after a packet in delta format was received which shows that the server can read it. */
+  CMD_LATENCY_REPORT = 1 << 2
 };
 
 Q_DECLARE_FLAGS(Command, CommandEnum);
@@ -112,6 +122,19 @@ public:
     command = value;
   }
 
+  /* Time between receipt of the data packet and sending this reply in microseconds. */
+  quint32 getClientDelayUs() const
+  {
+    return clientDelayUs;
+  }
+
+  /* Sets CMD_LATENCY_REPORT. Use SimConnectData::getReceivedUs() and LatencyStats::nowUs() to calculate. */
+  void setClientDelayUs(qint64 value)
+  {
+    clientDelayUs = static_cast<quint32>(std::max(Q_INT64_C(0), std::min(value, Q_INT64_C(0xffffffff))));
+    command |= CMD_LATENCY_REPORT;
+  }
+
   const atools::fs::sc::WeatherRequest& getWeatherRequest()
   {
     return weatherRequest;
@@ -126,7 +149,7 @@ private:
   const static quint32 MAGIC_NUMBER_REPLY = 0x33ED8272;
   const static quint32 REPLY_VERSION = 5;
 
-  quint32 packetId = 0, packetTs = 0;
+  quint32 packetId = 0, packetTs = 0, clientDelayUs = 0;
   atools::fs::sc::SimConnectStatus status = OK;
   quint32 magicNumber = 0, packetSize = 0, version = 2;
   Command command;
@@ -44,7 +44,10 @@ enum Option
 {
   NO_OPTION = 0,
   FETCH_AI_AIRCRAFT = 1 << 0,
-  FETCH_AI_BOAT = 1 << 1
+  FETCH_AI_BOAT = 1 << 1,
+
+  /* SimConnect only: send all requests at once and wait for the last entry of each in one dispatch loop */
+  FETCH_BATCHED = 1 << 2
 };
 
 Q_DECLARE_FLAGS(Options, Option);
@@ -34,6 +34,7 @@ namespace fs {
 namespace sc {
 class SimConnectHandler;
 class SimConnectData;
+class XpSharedMemory;
 
 /*
  * User aircraft that is used to transfer across network links.
@@ -193,6 +194,7 @@ public:
 private:
   friend class atools::fs::sc::SimConnectHandler;
   friend class atools::fs::sc::SimConnectData;
+  friend class atools::fs::sc::XpSharedMemory;
   friend class xpc::XpConnect;
 
   float
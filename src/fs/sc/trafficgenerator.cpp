@@ -0,0 +1,273 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/sc/trafficgenerator.h"
+
+#include "geo/calculations.h"
+
+#include <QDateTime>
+
+#include <cmath>
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+static TrafficGenerator *dummyInstance = nullptr;
+
+/* Types for the generated AI traffic */
+struct TrafficType
+{
+  const char *title, *atcType, *atcModel, *airline;
+  int numEngines, engineType, wingSpanFt;
+};
+
+static const TrafficType AIRPLANE_TYPES[] =
+{
+  {"Airbus A320 Lufthansa", "AIRBUS", "A320", "Lufthansa", 2, 1, 112},
+  {"Boeing 737-800 Ryanair", "BOEING", "B738", "Ryanair", 2, 1, 117},
+  {"Boeing 777-300ER Emirates", "BOEING", "B77W", "Emirates", 2, 1, 212},
+  {"Embraer 190 KLM", "EMBRAER", "E190", "KLM", 2, 1, 94},
+  {"Dash 8 Q400 Austrian", "DEHAVILLAND", "DH8D", "Austrian", 2, 5, 93},
+  {"Cessna Skyhawk", "CESSNA", "C172", "", 1, 0, 36}
+};
+
+static const TrafficType HELICOPTER_TYPES[] =
+{
+  {"Eurocopter EC135 ADAC", "EUROCOPTER", "EC35", "ADAC", 2, 3, 34},
+  {"Bell 206 JetRanger", "BELL", "B06", "", 1, 3, 33}
+};
+
+static const TrafficType BOAT_TYPES[] =
+{
+  {"Container Ship", "", "", "", 0, 2, 0},
+  {"Sailboat", "", "", "", 0, 2, 0}
+};
+
+static const char *const DESTINATIONS[] =
+{
+  "EGLL", "LFPG", "EHAM", "LEMD", "LIRF", "LOWW", "EKCH", "LSZH", "EDDM", "EDDH"
+};
+
+template<typename TYPE, int SIZE>
+Q_DECL_CONSTEXPR int arraySize(const TYPE (&)[SIZE])
+{
+  return SIZE;
+}
+
+TrafficGenerator::TrafficGenerator(const TrafficGeneratorConfig& generatorConfig)
+  : config(generatorConfig), random(generatorConfig.seed)
+{
+  objects.reserve(1 + config.numAircraft + config.numHelicopters + config.numBoats);
+
+  // User aircraft is always the first object
+  addObject(AIRPLANE, 0);
+  for(int i = 0; i < config.numAircraft; i++)
+    addObject(AIRPLANE, i + 1);
+  for(int i = 0; i < config.numHelicopters; i++)
+    addObject(HELICOPTER, i);
+  for(int i = 0; i < config.numBoats; i++)
+    addObject(BOAT, i);
+
+  timer.start();
+}
+
+void TrafficGenerator::setDummyInstance(TrafficGenerator *generator)
+{
+  dummyInstance = generator;
+}
+
+TrafficGenerator *TrafficGenerator::getDummyInstance()
+{
+  return dummyInstance;
+}
+
+atools::geo::Pos TrafficGenerator::randomPos(float minRadiusNm, float maxRadiusNm, float altitudeFt)
+{
+  std::uniform_real_distribution<float> angle(0.f, 360.f), distance(minRadiusNm, maxRadiusNm);
+  atools::geo::Pos pos = config.center.endpoint(atools::geo::nmToMeter(distance(random)), angle(random));
+  pos.setAltitude(altitudeFt);
+  return pos;
+}
+
+void TrafficGenerator::addObject(Category category, int index)
+{
+  std::uniform_real_distribution<float> unit(0.f, 1.f);
+  const TrafficType *type;
+  TrafficObject obj;
+  obj.category = category;
+  obj.objectId = static_cast<unsigned int>(objects.size() + 1);
+  obj.user = objects.isEmpty();
+  obj.nextWaypoint = 0;
+  obj.verticalSpeedFpm = 0.f;
+  obj.headingTrueDeg = 0.f;
+  obj.onGround = false;
+
+  float radius = config.radiusNm, groundAlt = config.center.getAltitude();
+  if(category == AIRPLANE)
+  {
+    type = &AIRPLANE_TYPES[index % arraySize(AIRPLANE_TYPES)];
+    obj.atcId = QString("D-A%1").arg(index, 3, 36, QChar('0')).toUpper().toLatin1();
+    obj.flightNumber = QByteArray::number(100 + index);
+    obj.fromIdent = config.airportIdent.toLatin1();
+    obj.toIdent = DESTINATIONS[index % arraySize(DESTINATIONS)];
+
+    if(obj.user)
+    {
+      obj.path = config.userRoute;
+      if(obj.path.isEmpty())
+      {
+        // Circuit around the airport
+        for(int i = 0; i < 4; i++)
+        {
+          atools::geo::Pos pos = config.center.endpoint(atools::geo::nmToMeter(radius / 5.f), i * 90.f);
+          pos.setAltitude(groundAlt + 3000.f);
+          obj.path.append(pos);
+        }
+      }
+      obj.speedKts = config.userSpeedKts;
+    }
+    else
+    {
+      // Arrive from the edge of the area, touch down at the center and depart to another point at the edge
+      float cruise = 5000.f + std::round(unit(random) * 30.f) * 1000.f;
+      obj.path.append(randomPos(radius * 0.9f, radius, groundAlt + cruise));
+      obj.path.append(atools::geo::Pos(config.center.getLonX(), config.center.getLatY(), groundAlt));
+      obj.path.append(randomPos(radius * 0.9f, radius, groundAlt + cruise));
+      obj.speedKts = type->engineType == 0 ? 100.f + unit(random) * 20.f : 200.f + unit(random) * 150.f;
+    }
+  }
+  else if(category == HELICOPTER)
+  {
+    type = &HELICOPTER_TYPES[index % arraySize(HELICOPTER_TYPES)];
+    obj.atcId = QString("D-H%1").arg(index, 3, 36, QChar('0')).toUpper().toLatin1();
+    for(int i = 0; i < 4; i++)
+      obj.path.append(randomPos(0.f, radius / 2.f, groundAlt + 1000.f + unit(random) * 1000.f));
+    obj.speedKts = 100.f + unit(random) * 30.f;
+  }
+  else
+  {
+    type = &BOAT_TYPES[index % arraySize(BOAT_TYPES)];
+    for(int i = 0; i < 4; i++)
+      obj.path.append(randomPos(radius / 2.f, radius, 0.f));
+    obj.speedKts = 8.f + unit(random) * 15.f;
+  }
+
+  obj.title = type->title;
+  obj.atcType = type->atcType;
+  obj.atcModel = type->atcModel;
+  obj.airline = type->airline;
+  obj.numEngines = type->numEngines;
+  obj.engineType = type->engineType;
+  obj.wingSpanFt = type->wingSpanFt;
+
+  // Start at a random place along the path
+  obj.position = obj.path.first();
+  obj.nextWaypoint = obj.path.size() > 1 ? 1 : 0;
+  move(obj, unit(random) * 600.f);
+  obj.verticalSpeedFpm = 0.f;
+
+  objects.append(obj);
+}
+
+void TrafficGenerator::update()
+{
+  qint64 stepMs;
+  if(config.fixedStepMs > 0)
+    stepMs = config.fixedStepMs;
+  else
+  {
+    qint64 now = timer.elapsed();
+    stepMs = now - lastTimerMs;
+    lastTimerMs = now;
+  }
+
+  if(stepMs <= 0)
+    return;
+
+  simTimeMs += stepMs;
+  float seconds = stepMs / 1000.f;
+  for(TrafficObject& obj : objects)
+    move(obj, seconds);
+}
+
+void TrafficGenerator::move(TrafficObject& obj, float seconds)
+{
+  if(obj.path.isEmpty() || seconds <= 0.f)
+    return;
+
+  float oldAltitude = obj.position.getAltitude();
+  float remaining = atools::geo::nmToMeter(obj.speedKts) / 3600.f * seconds;
+
+  // Limit iterations in case all waypoints are at the same position
+  for(int i = 0; i <= obj.path.size() && remaining > 0.f; i++)
+  {
+    const atools::geo::Pos& target = obj.path.at(obj.nextWaypoint);
+    float distance = obj.position.distanceMeterTo(target);
+
+    if(distance > 0.f)
+      obj.headingTrueDeg = obj.position.angleDegTo(target);
+
+    if(distance <= remaining)
+    {
+      // Waypoint reached
+      obj.position = target;
+      remaining -= distance;
+      obj.nextWaypoint = (obj.nextWaypoint + 1) % obj.path.size();
+    }
+    else
+    {
+      float altitude = obj.position.getAltitude();
+      obj.position = obj.position.endpoint(remaining, obj.headingTrueDeg);
+      obj.position.setAltitude(altitude + (target.getAltitude() - altitude) * remaining / distance);
+      remaining = 0.f;
+    }
+  }
+
+  obj.verticalSpeedFpm = (obj.position.getAltitude() - oldAltitude) / seconds * 60.f;
+  obj.onGround = obj.category != BOAT && obj.position.getAltitude() < config.center.getAltitude() + 10.f;
+}
+
+int TrafficGenerator::getWindDirectionDeg() const
+{
+  return (270 + static_cast<int>(simTimeMs / 60000) * 10) % 360;
+}
+
+int TrafficGenerator::getWindSpeedKts() const
+{
+  return 8 + static_cast<int>(simTimeMs / 60000) % 8;
+}
+
+int TrafficGenerator::getSeaLevelPressureMbar() const
+{
+  return 1008 + static_cast<int>(simTimeMs / 600000) % 10;
+}
+
+QString TrafficGenerator::metar(const QString& ident, const atools::geo::Pos& pos) const
+{
+  Q_UNUSED(pos);
+
+  return QString("%1 %2Z %3%4KT 9999 FEW030 SCT100 15/08 Q%5").
+         arg(ident.isEmpty() ? config.airportIdent : ident).
+         arg(QDateTime::currentDateTimeUtc().toString("ddhhmm")).
+         arg(getWindDirectionDeg(), 3, 10, QChar('0')).arg(getWindSpeedKts(), 2, 10, QChar('0')).
+         arg(getSeaLevelPressureMbar());
+}
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
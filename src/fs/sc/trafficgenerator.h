@@ -0,0 +1,140 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_SC_TRAFFICGENERATOR_H
+#define ATOOLS_FS_SC_TRAFFICGENERATOR_H
+
+#include "geo/pos.h"
+#include "fs/sc/simconnectaircraft.h"
+
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <random>
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+/* Configuration for the synthetic traffic */
+struct TrafficGeneratorConfig
+{
+  /* Traffic is spread around this position within radiusNm */
+  atools::geo::Pos center = atools::geo::Pos(8.5706f, 50.0333f, 364.f);
+  QString airportIdent = "EDDF";
+  float radiusNm = 50.f;
+
+  int numAircraft = 100, numHelicopters = 10, numBoats = 10;
+
+  /* Waypoints with altitude in feet for the user aircraft. Flies a circuit around center if empty. */
+  QVector<atools::geo::Pos> userRoute;
+  float userSpeedKts = 250.f;
+
+  /* Advance traffic by this time for each update instead of the elapsed wall clock time if > 0.
+   * Gives reproducible runs for profiling. */
+  int fixedStepMs = 0;
+
+  /* Answer weather requests with generated METARs */
+  bool weather = true;
+
+  /* Seed for the random traffic */
+  unsigned int seed = 1;
+};
+
+/* One simulated object */
+struct TrafficObject
+{
+  atools::fs::sc::Category category;
+  unsigned int objectId;
+  bool user;
+
+  QByteArray title, atcType, atcModel, atcId, airline, flightNumber, fromIdent, toIdent;
+  int numEngines, engineType, wingSpanFt;
+
+  /* Altitude in feet */
+  atools::geo::Pos position;
+  float headingTrueDeg, speedKts, verticalSpeedFpm;
+  bool onGround;
+
+  /* Waypoints with altitude which are flown in a loop */
+  QVector<atools::geo::Pos> path;
+  int nextWaypoint;
+};
+
+/*
+ * Synthetic traffic generator which moves AI aircraft, helicopters and boats on plausible paths around an
+ * airport and a user aircraft along a flight plan.
+ *
+ * Used by the SimConnect dummy functions on non-Windows platforms to feed SimConnectHandler and
+ * DataReaderThread with simulated data for benchmarks and profiling without a running simulator.
+ */
+class TrafficGenerator
+{
+public:
+  explicit TrafficGenerator(const atools::fs::sc::TrafficGeneratorConfig& generatorConfig);
+
+  /* Move all objects by the elapsed time or the fixed step */
+  void update();
+
+  /* User aircraft first and all AI objects */
+  const QVector<atools::fs::sc::TrafficObject>& getObjects() const
+  {
+    return objects;
+  }
+
+  const atools::fs::sc::TrafficGeneratorConfig& getConfig() const
+  {
+    return config;
+  }
+
+  /* Generated METAR for the station or the position if the ident is empty */
+  QString metar(const QString& ident, const atools::geo::Pos& pos) const;
+
+  /* Weather which changes slowly over simulation time */
+  int getWindDirectionDeg() const;
+  int getWindSpeedKts() const;
+  int getSeaLevelPressureMbar() const;
+
+  /* Elapsed simulation time */
+  qint64 getSimTimeMs() const
+  {
+    return simTimeMs;
+  }
+
+  /* Install the generator used by the SimConnect dummy functions on non-Windows platforms.
+   * Has to be set before loading SimConnect and connecting. Null disables the dummy connection (default). */
+  static void setDummyInstance(atools::fs::sc::TrafficGenerator *generator);
+  static atools::fs::sc::TrafficGenerator *getDummyInstance();
+
+private:
+  void addObject(atools::fs::sc::Category category, int index);
+  atools::geo::Pos randomPos(float minRadiusNm, float maxRadiusNm, float altitudeFt);
+  void move(atools::fs::sc::TrafficObject& obj, float seconds);
+
+  atools::fs::sc::TrafficGeneratorConfig config;
+  QVector<atools::fs::sc::TrafficObject> objects;
+
+  std::mt19937 random;
+  QElapsedTimer timer;
+  qint64 simTimeMs = 0, lastTimerMs = 0;
+};
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_SC_TRAFFICGENERATOR_H
@@ -41,13 +41,20 @@ XpConnectHandler::~XpConnectHandler()
 
 bool XpConnectHandler::connect()
 {
-  if(sharedMemory.isAttached())
+  if(sharedMemory.isAttached() || slotMemory.isAttached())
   {
     qDebug() << Q_FUNC_INFO << "Already attached";
     state = STATEOK;
     return true;
   }
 
+  // Try lock free transport of newer plugins first
+  if(slotMemory.attach())
+  {
+    state = STATEOK;
+    return true;
+  }
+
   sharedMemory.setKey(atools::fs::sc::SHARED_MEMORY_KEY);
   if(!sharedMemory.attach(QSharedMemory::ReadOnly))
   {
@@ -67,7 +74,18 @@ bool XpConnectHandler::connect()
 bool XpConnectHandler::fetchData(fs::sc::SimConnectData& data, int radiusKm, fs::sc::Options options)
 {
   Q_UNUSED(radiusKm);
-  Q_UNUSED(options);
+
+  if(slotMemory.isAttached())
+  {
+    if(slotMemory.isTerminated())
+    {
+      disconnect();
+      return false;
+    }
+
+    // Converts directly from shared memory without locking
+    return slotMemory.read(data) && postProcess(data, options);
+  }
 
   if(!sharedMemory.isAttached())
   {
@@ -101,14 +119,7 @@ bool XpConnectHandler::fetchData(fs::sc::SimConnectData& data, int radiusKm, fs:
         return false;
       }
 
-      if(data.isUserAircraftValid() && data.getStatus() == OK)
-      {
-        if(!(options & atools::fs::sc::FETCH_AI_AIRCRAFT))
-          // Have to clear this here since the X-Plane plugin has no configuration option
-          data.getAiAircraft().clear();
-
-        return true;
-      }
+      return postProcess(data, options);
     }
     else
       sharedMemory.unlock();
@@ -119,6 +130,22 @@ bool XpConnectHandler::fetchData(fs::sc::SimConnectData& data, int radiusKm, fs:
   return false;
 }
 
+bool XpConnectHandler::postProcess(SimConnectData& data, Options options)
+{
+  if(data.isUserAircraftValid() && data.getStatus() == OK)
+  {
+    if(!(options & atools::fs::sc::FETCH_AI_AIRCRAFT))
+      // Have to clear this here since the X-Plane plugin has no configuration option
+      data.getAiAircraft().clear();
+    else
+      // Plugin sends complete data - filter after reading
+      aircraftFilter.filter(data.getAiAircraft(), data.getUserAircraftConst().getPosition());
+
+    return true;
+  }
+  return false;
+}
+
 bool XpConnectHandler::fetchWeatherData(fs::sc::SimConnectData& data)
 {
   Q_UNUSED(data);
@@ -158,6 +185,7 @@ QString XpConnectHandler::getName() const
 
 void XpConnectHandler::disconnect()
 {
+  slotMemory.detach();
   bool result = sharedMemory.detach();
   qDebug() << Q_FUNC_INFO << "result" << result;
   state = DISCONNECTED;
@@ -19,6 +19,7 @@
 #define ATOOLS_XPCONNECTHANDLER_H
 
 #include "fs/sc/connecthandler.h"
+#include "fs/sc/xpsharedmemory.h"
 
 #include <QSharedMemory>
 #include <functional>
@@ -32,7 +33,10 @@ static const int SHARED_MEMORY_SIZE = 8196;
 static const QLatin1Literal SHARED_MEMORY_KEY("LittleXpconnect");
 
 /*
- * Reads data from a callback function into SimConnectData.
+ * Reads data from the Little Xpconnect plugin into SimConnectData.
+ *
+ * Uses the lock free slot transport of XpSharedMemory if the plugin provides it. Falls back to the
+ * older locked segment where the plugin writes serialized SimConnectData.
  */
 class XpConnectHandler :
   public atools::fs::sc::ConnectHandler
@@ -45,7 +49,7 @@ public:
   XpConnectHandler();
   virtual ~XpConnectHandler();
 
-  /* Attach to shared memory if available */
+  /* Attach to shared memory if available. Prefers the slot transport. */
   virtual bool connect() override;
 
   /* Always loaded since X-Plane is always available */
@@ -78,6 +82,13 @@ public:
 private:
   void disconnect();
 
+  /* Remove AI if not requested or filter them. Returns true if data is valid. */
+  bool postProcess(atools::fs::sc::SimConnectData& data, atools::fs::sc::Options options);
+
+  /* Lock free transport */
+  atools::fs::sc::XpSharedMemory slotMemory;
+
+  /* Old transport locked by a semaphore */
   QSharedMemory sharedMemory;
   atools::fs::sc::State state = DISCONNECTED;
 };
@@ -0,0 +1,403 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/sc/xpsharedmemory.h"
+
+#include "fs/sc/simconnectdata.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+/* Atomics have to work across processes */
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "std::atomic<quint32> is not lock free");
+
+const static quint32 MAGIC_NUMBER = 0x58505348;
+const static quint32 VERSION = 1;
+
+/* Number of attempts if the writer changes the slot while reading */
+const static int MAX_READ_ATTEMPTS = 4;
+
+/* Copy as zero terminated UTF-8 truncated to the buffer size without splitting a character */
+static void copyString(const QString& str, char *dest, int size)
+{
+  QByteArray bytes = str.toUtf8();
+  int len = std::min(bytes.size(), size - 1);
+  if(len < bytes.size())
+  {
+    while(len > 0 && (static_cast<unsigned char>(bytes.at(len)) & 0xc0) == 0x80)
+      len--;
+  }
+  memcpy(dest, bytes.constData(), static_cast<size_t>(len));
+  dest[len] = '\0';
+}
+
+template<int SIZE>
+static QString toString(const char (&str)[SIZE])
+{
+  return QString::fromUtf8(str, static_cast<int>(qstrnlen(str, SIZE)));
+}
+
+static qint64 toMs(const QDateTime& dateTime)
+{
+  return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : 0;
+}
+
+XpSharedMemory::XpSharedMemory()
+{
+
+}
+
+XpSharedMemory::~XpSharedMemory()
+{
+  detach();
+}
+
+bool XpSharedMemory::create()
+{
+  detach();
+  sharedMemory.setKey(XP_SHARED_MEMORY_KEY);
+
+  if(!sharedMemory.create(sizeof(XpSharedHeader)))
+  {
+    // Segment may be left over from a crashed process on Unix
+    if(sharedMemory.error() != QSharedMemory::AlreadyExists || !sharedMemory.attach() ||
+       sharedMemory.size() < static_cast<int>(sizeof(XpSharedHeader)))
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot create" << sharedMemory.errorString();
+      sharedMemory.detach();
+      return false;
+    }
+  }
+
+  memset(sharedMemory.data(), 0, sizeof(XpSharedHeader));
+  header = new (sharedMemory.data()) XpSharedHeader;
+  header->latest.store(0, std::memory_order_relaxed);
+  header->terminate.store(0, std::memory_order_relaxed);
+  for(XpSlot& slot : header->slots)
+    slot.sequence.store(0, std::memory_order_relaxed);
+  header->magicNumber = MAGIC_NUMBER;
+  header->version = VERSION;
+  std::atomic_thread_fence(std::memory_order_release);
+
+  qInfo() << Q_FUNC_INFO << "Created" << sharedMemory.key() << "native" << sharedMemory.nativeKey()
+          << "size" << sharedMemory.size();
+  return true;
+}
+
+bool XpSharedMemory::attach()
+{
+  if(header != nullptr)
+    return true;
+
+  sharedMemory.setKey(XP_SHARED_MEMORY_KEY);
+  if(!sharedMemory.attach(QSharedMemory::ReadOnly))
+  {
+    if(sharedMemory.error() != QSharedMemory::NotFound)
+      qWarning() << Q_FUNC_INFO << "Cannot attach" << sharedMemory.errorString();
+    return false;
+  }
+
+  const XpSharedHeader *hdr = static_cast<const XpSharedHeader *>(sharedMemory.constData());
+  if(sharedMemory.size() < static_cast<int>(sizeof(XpSharedHeader)) || hdr->magicNumber != MAGIC_NUMBER ||
+     hdr->version != VERSION)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid segment or version mismatch" << sharedMemory.size();
+    sharedMemory.detach();
+    return false;
+  }
+
+  header = static_cast<XpSharedHeader *>(sharedMemory.data());
+  aiCache.clear();
+  qInfo() << Q_FUNC_INFO << "Attached to" << sharedMemory.key() << "native" << sharedMemory.nativeKey();
+  return true;
+}
+
+void XpSharedMemory::detach()
+{
+  header = nullptr;
+  aiCache.clear();
+  if(sharedMemory.isAttached())
+    sharedMemory.detach();
+}
+
+void XpSharedMemory::setTerminate()
+{
+  if(header != nullptr)
+    header->terminate.store(1, std::memory_order_release);
+}
+
+bool XpSharedMemory::isTerminated() const
+{
+  return header != nullptr && header->terminate.load(std::memory_order_acquire) != 0;
+}
+
+void XpSharedMemory::write(const SimConnectData& data)
+{
+  if(header == nullptr)
+    return;
+
+  // Write into the slot which was not published last
+  quint32 index = 1 - (header->latest.load(std::memory_order_relaxed) & 1);
+  XpSlot& slot = header->slots[index];
+
+  quint32 sequence = slot.sequence.load(std::memory_order_relaxed);
+  slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.packetId = static_cast<quint32>(data.getPacketId());
+  slot.packetTimestamp = static_cast<quint32>(data.getPacketTimestamp());
+
+  const SimConnectUserAircraft& user = data.getUserAircraftConst();
+  slot.hasUser = data.isUserAircraftValid() ? 1 : 0;
+  if(slot.hasUser)
+  {
+    XpUserAircraftRecord& rec = slot.user;
+    writeRecord(user, rec.aircraft);
+    rec.altitudeAboveGroundFt = user.altitudeAboveGroundFt;
+    rec.groundAltitudeFt = user.groundAltitudeFt;
+    rec.windSpeedKts = user.windSpeedKts;
+    rec.windDirectionDegT = user.windDirectionDegT;
+    rec.ambientTemperatureCelsius = user.ambientTemperatureCelsius;
+    rec.totalAirTemperatureCelsius = user.totalAirTemperatureCelsius;
+    rec.seaLevelPressureMbar = user.seaLevelPressureMbar;
+    rec.pitotIcePercent = user.pitotIcePercent;
+    rec.structuralIcePercent = user.structuralIcePercent;
+    rec.airplaneTotalWeightLbs = user.airplaneTotalWeightLbs;
+    rec.airplaneMaxGrossWeightLbs = user.airplaneMaxGrossWeightLbs;
+    rec.airplaneEmptyWeightLbs = user.airplaneEmptyWeightLbs;
+    rec.fuelTotalQuantityGallons = user.fuelTotalQuantityGallons;
+    rec.fuelTotalWeightLbs = user.fuelTotalWeightLbs;
+    rec.fuelFlowPPH = user.fuelFlowPPH;
+    rec.fuelFlowGPH = user.fuelFlowGPH;
+    rec.magVarDeg = user.magVarDeg;
+    rec.ambientVisibilityMeter = user.ambientVisibilityMeter;
+    rec.trackMagDeg = user.trackMagDeg;
+    rec.trackTrueDeg = user.trackTrueDeg;
+    rec.localDateTimeMs = toMs(user.localDateTime);
+    rec.localOffsetSeconds = user.localDateTime.isValid() ? user.localDateTime.offsetFromUtc() : 0;
+    rec.zuluDateTimeMs = toMs(user.zuluDateTime);
+  }
+
+  const QVector<SimConnectAircraft>& ai = data.getAiAircraftConst();
+  if(ai.size() > XP_MAX_AI_AIRCRAFT)
+    qWarning() << Q_FUNC_INFO << "Too many AI aircraft" << ai.size();
+
+  slot.numAi = static_cast<quint32>(std::min(ai.size(), XP_MAX_AI_AIRCRAFT));
+  for(quint32 i = 0; i < slot.numAi; i++)
+    writeRecord(ai.at(static_cast<int>(i)), slot.ai[i]);
+
+  // Publish
+  slot.sequence.store(sequence + 2, std::memory_order_release);
+  header->latest.store(index, std::memory_order_release);
+}
+
+bool XpSharedMemory::read(SimConnectData& data)
+{
+  if(header == nullptr)
+    return false;
+
+  for(int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++)
+  {
+    const XpSlot& slot = header->slots[header->latest.load(std::memory_order_acquire) & 1];
+    quint32 sequence = slot.sequence.load(std::memory_order_acquire);
+
+    if(sequence == 0)
+      // Nothing written yet
+      return false;
+
+    if(sequence & 1)
+      // Writer lapped the reader and is changing this slot
+      continue;
+
+    readCount++;
+    data.setPacketId(static_cast<int>(slot.packetId));
+    data.setPacketTimestamp(slot.packetTimestamp);
+
+    SimConnectUserAircraft& user = data.getUserAircraft();
+    if(slot.hasUser)
+    {
+      const XpUserAircraftRecord& rec = slot.user;
+      readValues(rec.aircraft, user);
+      readStrings(rec.aircraft.strings, user);
+      user.altitudeAboveGroundFt = rec.altitudeAboveGroundFt;
+      user.groundAltitudeFt = rec.groundAltitudeFt;
+      user.windSpeedKts = rec.windSpeedKts;
+      user.windDirectionDegT = rec.windDirectionDegT;
+      user.ambientTemperatureCelsius = rec.ambientTemperatureCelsius;
+      user.totalAirTemperatureCelsius = rec.totalAirTemperatureCelsius;
+      user.seaLevelPressureMbar = rec.seaLevelPressureMbar;
+      user.pitotIcePercent = rec.pitotIcePercent;
+      user.structuralIcePercent = rec.structuralIcePercent;
+      user.airplaneTotalWeightLbs = rec.airplaneTotalWeightLbs;
+      user.airplaneMaxGrossWeightLbs = rec.airplaneMaxGrossWeightLbs;
+      user.airplaneEmptyWeightLbs = rec.airplaneEmptyWeightLbs;
+      user.fuelTotalQuantityGallons = rec.fuelTotalQuantityGallons;
+      user.fuelTotalWeightLbs = rec.fuelTotalWeightLbs;
+      user.fuelFlowPPH = rec.fuelFlowPPH;
+      user.fuelFlowGPH = rec.fuelFlowGPH;
+      user.magVarDeg = rec.magVarDeg;
+      user.ambientVisibilityMeter = rec.ambientVisibilityMeter;
+      user.trackMagDeg = rec.trackMagDeg;
+      user.trackTrueDeg = rec.trackTrueDeg;
+      user.localDateTime = rec.localDateTimeMs != 0 ?
+                           QDateTime::fromMSecsSinceEpoch(rec.localDateTimeMs, Qt::OffsetFromUTC,
+                                                          rec.localOffsetSeconds) : QDateTime();
+      user.zuluDateTime = rec.zuluDateTimeMs != 0 ?
+                          QDateTime::fromMSecsSinceEpoch(rec.zuluDateTimeMs, Qt::UTC) : QDateTime();
+    }
+    else
+      user = SimConnectUserAircraft();
+
+    // Value might be torn - limit before use
+    int numAi = static_cast<int>(std::min(slot.numAi, static_cast<quint32>(XP_MAX_AI_AIRCRAFT)));
+    QVector<SimConnectAircraft>& ai = data.getAiAircraft();
+    ai.resize(numAi);
+    pendingEntries.clear();
+    for(int i = 0; i < numAi; i++)
+      readAiRecord(slot.ai[i], ai[i]);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(slot.sequence.load(std::memory_order_relaxed) == sequence)
+    {
+      // Consistent snapshot - add converted strings to the cache
+      for(const CacheEntry& entry : pendingEntries)
+        aiCache.insert(entry.aircraft.objectId, entry);
+      pendingEntries.clear();
+
+      // Mark aircraft of this snapshot and remove aircraft which disappeared
+      for(const SimConnectAircraft& aircraft : ai)
+        aiCache[aircraft.objectId].readCount = readCount;
+
+      for(auto it = aiCache.begin(); it != aiCache.end();)
+      {
+        if(it.value().readCount != readCount)
+          it = aiCache.erase(it);
+        else
+          ++it;
+      }
+      return true;
+    }
+  }
+
+  qWarning() << Q_FUNC_INFO << "No consistent snapshot after" << MAX_READ_ATTEMPTS << "attempts";
+  pendingEntries.clear();
+  data.getAiAircraft().clear();
+  data.getUserAircraft() = SimConnectUserAircraft();
+  return false;
+}
+
+void XpSharedMemory::readAiRecord(const XpAircraftRecord& record, SimConnectAircraft& aircraft)
+{
+  // Decode from a local copy only since the writer might change the slot meanwhile
+  XpAircraftRecord copy;
+  memcpy(&copy, &record, sizeof(XpAircraftRecord));
+
+  auto it = aiCache.constFind(copy.objectId);
+  if(it != aiCache.constEnd() && memcmp(&it.value().raw, &copy.strings, sizeof(XpAircraftStrings)) == 0)
+    // Unchanged strings - shares them with the cache entry
+    aircraft = it.value().aircraft;
+  else
+  {
+    // New aircraft or changed strings. Cached by read() only if the snapshot is consistent.
+    CacheEntry entry;
+    memcpy(&entry.raw, &copy.strings, sizeof(XpAircraftStrings));
+    readStrings(entry.raw, entry.aircraft);
+    entry.aircraft.objectId = copy.objectId;
+    pendingEntries.append(entry);
+    aircraft = entry.aircraft;
+  }
+  readValues(copy, aircraft);
+}
+
+void XpSharedMemory::writeRecord(const SimConnectAircraft& aircraft, XpAircraftRecord& record)
+{
+  record.objectId = aircraft.objectId;
+  record.flags = static_cast<quint16>(aircraft.flags);
+  record.wingSpanFt = aircraft.wingSpanFt;
+  record.modelRadiusFt = aircraft.modelRadiusFt;
+  record.category = static_cast<quint8>(aircraft.category);
+  record.engineType = static_cast<quint8>(aircraft.engineType);
+  record.numberOfEngines = aircraft.numberOfEngines;
+  record.lonX = aircraft.position.getLonX();
+  record.latY = aircraft.position.getLatY();
+  record.altitudeFt = aircraft.position.getAltitude();
+  record.headingTrueDeg = aircraft.headingTrueDeg;
+  record.headingMagDeg = aircraft.headingMagDeg;
+  record.groundSpeedKts = aircraft.groundSpeedKts;
+  record.indicatedSpeedKts = aircraft.indicatedSpeedKts;
+  record.verticalSpeedFeetPerMin = aircraft.verticalSpeedFeetPerMin;
+  record.indicatedAltitudeFt = aircraft.indicatedAltitudeFt;
+  record.trueAirspeedKts = aircraft.trueAirspeedKts;
+  record.machSpeed = aircraft.machSpeed;
+
+  // Clear unused bytes to allow comparing the strings block on the reader side
+  XpAircraftStrings& str = record.strings;
+  memset(&str, 0, sizeof(XpAircraftStrings));
+  copyString(aircraft.getAirplaneTitle(), str.title, sizeof(str.title));
+  copyString(aircraft.getAirplaneType(), str.type, sizeof(str.type));
+  copyString(aircraft.getAirplaneModel(), str.model, sizeof(str.model));
+  copyString(aircraft.getAirplaneRegistration(), str.reg, sizeof(str.reg));
+  copyString(aircraft.getAirplaneAirline(), str.airline, sizeof(str.airline));
+  copyString(aircraft.getAirplaneFlightnumber(), str.flightnumber, sizeof(str.flightnumber));
+  copyString(aircraft.getFromIdent(), str.fromIdent, sizeof(str.fromIdent));
+  copyString(aircraft.getToIdent(), str.toIdent, sizeof(str.toIdent));
+}
+
+void XpSharedMemory::readValues(const XpAircraftRecord& record, SimConnectAircraft& aircraft)
+{
+  aircraft.objectId = record.objectId;
+  aircraft.flags = AircraftFlags(record.flags);
+  aircraft.wingSpanFt = record.wingSpanFt;
+  aircraft.modelRadiusFt = record.modelRadiusFt;
+  aircraft.category = static_cast<Category>(record.category);
+  aircraft.engineType = static_cast<EngineType>(record.engineType);
+  aircraft.numberOfEngines = record.numberOfEngines;
+  aircraft.position = atools::geo::Pos(record.lonX, record.latY, record.altitudeFt);
+  aircraft.headingTrueDeg = record.headingTrueDeg;
+  aircraft.headingMagDeg = record.headingMagDeg;
+  aircraft.groundSpeedKts = record.groundSpeedKts;
+  aircraft.indicatedSpeedKts = record.indicatedSpeedKts;
+  aircraft.verticalSpeedFeetPerMin = record.verticalSpeedFeetPerMin;
+  aircraft.indicatedAltitudeFt = record.indicatedAltitudeFt;
+  aircraft.trueAirspeedKts = record.trueAirspeedKts;
+  aircraft.machSpeed = record.machSpeed;
+}
+
+void XpSharedMemory::readStrings(const XpAircraftStrings& strings, SimConnectAircraft& aircraft)
+{
+  // Detaches once
+  SimConnectAircraftStrings& str = *aircraft.strings;
+  str.airplaneTitle = toString(strings.title);
+  str.airplaneType = toString(strings.type);
+  str.airplaneModel = toString(strings.model);
+  str.airplaneReg = toString(strings.reg);
+  str.airplaneAirline = toString(strings.airline);
+  str.airplaneFlightnumber = toString(strings.flightnumber);
+  str.fromIdent = toString(strings.fromIdent);
+  str.toIdent = toString(strings.toIdent);
+}
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,171 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_SC_XPSHAREDMEMORY_H
+#define ATOOLS_FS_SC_XPSHAREDMEMORY_H
+
+#include "fs/sc/simconnectaircraft.h"
+
+#include <QHash>
+#include <QSharedMemory>
+#include <QVector>
+
+#include <atomic>
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+class SimConnectData;
+
+/* Key of the shared memory segment for the slot transport. The old locked segment uses SHARED_MEMORY_KEY. */
+static const QLatin1Literal XP_SHARED_MEMORY_KEY("LittleXpconnectSlots");
+
+/* Maximum number of AI aircraft per snapshot. More are dropped by the writer. */
+static const int XP_MAX_AI_AIRCRAFT = 512;
+
+/* Strings of an aircraft as zero terminated UTF-8. Contiguous to allow comparing with memcmp. */
+struct XpAircraftStrings
+{
+  char title[128], type[32], model[32], reg[32], airline[64], flightnumber[16], fromIdent[8], toIdent[8];
+};
+
+/* Fixed layout aircraft record in shared memory */
+struct XpAircraftRecord
+{
+  quint32 objectId;
+  quint16 flags, wingSpanFt, modelRadiusFt;
+  quint8 category, engineType, numberOfEngines, padding[3];
+  float lonX, latY, altitudeFt, headingTrueDeg, headingMagDeg, groundSpeedKts, indicatedSpeedKts,
+        verticalSpeedFeetPerMin, indicatedAltitudeFt, trueAirspeedKts, machSpeed;
+  XpAircraftStrings strings;
+};
+
+/* Fixed layout user aircraft record. Times are milliseconds since epoch and are invalid if 0. */
+struct XpUserAircraftRecord
+{
+  XpAircraftRecord aircraft;
+  float altitudeAboveGroundFt, groundAltitudeFt, windSpeedKts, windDirectionDegT, ambientTemperatureCelsius,
+        totalAirTemperatureCelsius, seaLevelPressureMbar, pitotIcePercent, structuralIcePercent,
+        airplaneTotalWeightLbs, airplaneMaxGrossWeightLbs, airplaneEmptyWeightLbs, fuelTotalQuantityGallons,
+        fuelTotalWeightLbs, fuelFlowPPH, fuelFlowGPH, magVarDeg, ambientVisibilityMeter, trackMagDeg, trackTrueDeg;
+  qint64 localDateTimeMs, zuluDateTimeMs;
+  qint32 localOffsetSeconds;
+  quint32 padding;
+};
+
+/*
+ * One snapshot. sequence is odd while the writer is changing the slot and is incremented again when done.
+ * A reader copies the values and checks that sequence did not change meanwhile (seqlock).
+ */
+struct XpSlot
+{
+  std::atomic<quint32> sequence;
+  quint32 packetId, packetTimestamp, hasUser, numAi, padding;
+  XpUserAircraftRecord user;
+  XpAircraftRecord ai[XP_MAX_AI_AIRCRAFT];
+};
+
+/* Segment header followed by two slots. latest is the index of the last completely written slot. */
+struct XpSharedHeader
+{
+  quint32 magicNumber, version;
+  std::atomic<quint32> latest, terminate;
+  XpSlot slots[2];
+};
+
+/*
+ * Lock free transport of simulator data from the Little Xpconnect plugin to XpConnectHandler through shared
+ * memory. The plugin writes fixed layout records once per flight loop into the slot not read last and
+ * publishes it. The reader converts the latest published slot directly into SimConnectData without locking.
+ *
+ * Strings are only converted if the raw bytes changed for an aircraft id. One writer and one reader per
+ * segment are supported.
+ */
+class XpSharedMemory
+{
+public:
+  XpSharedMemory();
+  ~XpSharedMemory();
+
+  XpSharedMemory(const XpSharedMemory& other) = delete;
+  XpSharedMemory& operator=(const XpSharedMemory& other) = delete;
+
+  /* Writer side. Create the segment. Returns false if it cannot be created. */
+  bool create();
+
+  /* Reader side. Attach to an existing segment. Returns false if not found or if the version does not match. */
+  bool attach();
+
+  /* Detach or destroy the segment */
+  void detach();
+
+  bool isAttached() const
+  {
+    return header != nullptr;
+  }
+
+  /* Writer side. Write a snapshot and publish it. */
+  void write(const atools::fs::sc::SimConnectData& data);
+
+  /* Writer side. Tell the reader that the simulator is shutting down. */
+  void setTerminate();
+
+  /* Reader side. Convert the latest snapshot into data. Returns false if nothing was published yet or if the
+   * writer changed the slot repeatedly while reading. */
+  bool read(atools::fs::sc::SimConnectData& data);
+
+  /* Reader side. true if the writer called setTerminate() */
+  bool isTerminated() const;
+
+  QString errorString() const
+  {
+    return sharedMemory.errorString();
+  }
+
+private:
+  /* Converted AI aircraft and the raw strings it was converted from */
+  struct CacheEntry
+  {
+    XpAircraftStrings raw;
+    atools::fs::sc::SimConnectAircraft aircraft;
+    quint32 readCount = 0;
+  };
+
+  static void writeRecord(const atools::fs::sc::SimConnectAircraft& aircraft, XpAircraftRecord& record);
+  static void readValues(const XpAircraftRecord& record, atools::fs::sc::SimConnectAircraft& aircraft);
+  static void readStrings(const XpAircraftStrings& strings, atools::fs::sc::SimConnectAircraft& aircraft);
+
+  /* Read AI record using the cache. New or changed entries are collected in pendingEntries. */
+  void readAiRecord(const XpAircraftRecord& record, atools::fs::sc::SimConnectAircraft& aircraft);
+
+  QSharedMemory sharedMemory;
+  XpSharedHeader *header = nullptr;
+
+  /* AI aircraft by object id. Entries not contained in the last snapshot are removed. */
+  QHash<quint32, CacheEntry> aiCache;
+
+  /* Entries converted during the current read attempt. Discarded if the snapshot was torn. */
+  QVector<CacheEntry> pendingEntries;
+  quint32 readCount = 0;
+};
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_SC_XPSHAREDMEMORY_H
@@ -25,16 +25,94 @@
 #include <QDebug>
 #include <QFileInfo>
 #include <QTextCodec>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
 
 namespace atools {
 namespace fs {
 namespace scenery {
 
-AddOnPackage::AddOnPackage(const QString& file)
+/* Cache is cleared when reaching this size */
+static const int MAX_CACHE_ENTRIES = 2000;
+
+/* Parse results keyed by absolute file path */
+class AddOnPackageCache
+{
+public:
+  struct Entry
+  {
+    QDateTime lastModified;
+    qint64 size;
+    QString name, description;
+    QVector<AddOnComponent> components;
+  };
+
+  static AddOnPackageCache& instance()
+  {
+    static AddOnPackageCache cache;
+    return cache;
+  }
+
+  bool get(const QFileInfo& fileinfo, AddOnPackage& package)
+  {
+    QMutexLocker locker(&mutex);
+    auto it = cache.constFind(fileinfo.absoluteFilePath());
+    if(it != cache.constEnd() && it->lastModified == fileinfo.lastModified() && it->size == fileinfo.size())
+    {
+      package.name = it->name;
+      package.description = it->description;
+      package.components = it->components;
+      return true;
+    }
+    return false;
+  }
+
+  void insert(const QFileInfo& fileinfo, const AddOnPackage& package)
+  {
+    QMutexLocker locker(&mutex);
+    if(cache.size() >= MAX_CACHE_ENTRIES)
+      cache.clear();
+    cache.insert(fileinfo.absoluteFilePath(), {fileinfo.lastModified(), fileinfo.size(),
+                                               package.name, package.description, package.components});
+  }
+
+  void clear()
+  {
+    QMutexLocker locker(&mutex);
+    cache.clear();
+  }
+
+private:
+  QMutex mutex;
+  QHash<QString, Entry> cache;
+};
+
+AddOnPackage::AddOnPackage(const QString& file, bool useCache)
 {
   filename = file;
   baseDirectory = QFileInfo(filename).path();
 
+  if(useCache)
+  {
+    QFileInfo fileinfo(filename);
+    if(!AddOnPackageCache::instance().get(fileinfo, *this))
+    {
+      read();
+      AddOnPackageCache::instance().insert(fileinfo, *this);
+    }
+  }
+  else
+    read();
+}
+
+void AddOnPackage::clearCache()
+{
+  AddOnPackageCache::instance().clear();
+}
+
+void AddOnPackage::read()
+{
   QFile xmlFile(filename);
 
   if(xmlFile.open(QIODevice::ReadOnly))
@@ -86,10 +164,10 @@ AddOnPackage::AddOnPackage(const QString& file)
       }
     }
     if(xml->hasError())
-      throw Exception(tr("Cannot read file %1. Reason: %2").arg(file).arg(xml->errorString()));
+      throw Exception(tr("Cannot read file %1. Reason: %2").arg(filename).arg(xml->errorString()));
   }
   else
-    throw Exception(tr("Cannot open file %1. Reason: %2").arg(file).arg(xmlFile.errorString()));
+    throw Exception(tr("Cannot open file %1. Reason: %2").arg(filename).arg(xmlFile.errorString()));
 }
 
 AddOnPackage::~AddOnPackage()
@@ -31,15 +31,22 @@ namespace scenery {
 /*
  * Reads the Prepar3D v4 add-on XML files.
  * Only scenery components are read - all other are ignored.
+ *
+ * Parsed files can be cached in memory. The cache is keyed by file path and is validated by
+ * modification time and size. Cache is thread safe.
  */
 class AddOnPackage
 {
   Q_DECLARE_TR_FUNCTIONS(AddOnPackage)
 
 public:
-  AddOnPackage(const QString& file);
+  /* Reads the file and throws an exception on error. Uses the cache if useCache is true and the file is unchanged. */
+  AddOnPackage(const QString& file, bool useCache = false);
   ~AddOnPackage();
 
+  /* Remove all cached parse results */
+  static void clearCache();
+
   const QVector<atools::fs::scenery::AddOnComponent>& getComponents() const
   {
     return components;
@@ -67,6 +74,10 @@ public:
   }
 
 private:
+  friend class AddOnPackageCache;
+
+  void read();
+
   QString filename, baseDirectory, name, description;
 
   QVector<atools::fs::scenery::AddOnComponent> components;
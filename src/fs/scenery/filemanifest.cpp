@@ -0,0 +1,206 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/scenery/filemanifest.h"
+
+#include "fs/scenery/fileresolver.h"
+#include "fs/scenery/sceneryarea.h"
+#include "fs/navdatabaseoptions.h"
+
+#include <QDebug>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
+
+#include <vector>
+
+namespace atools {
+namespace fs {
+namespace scenery {
+
+/* Resolves files of one area in a pool thread using its own copy of the options */
+class FileManifestTask :
+  public QRunnable
+{
+public:
+  FileManifestTask(const atools::fs::NavDatabaseOptions& opts, const SceneryArea& sceneryArea,
+                   QStringList *filepathList, QStringList *errorList, QVector<quint64> *hashList)
+    : options(opts.copyForThread()), area(sceneryArea), filepaths(filepathList), errors(errorList),
+    hashes(hashList)
+  {
+    setAutoDelete(true);
+  }
+
+  virtual void run() override
+  {
+    FileResolver resolver(options);
+    resolver.getFiles(area, filepaths, nullptr, hashes);
+    *errors = resolver.getErrorMessages();
+  }
+
+private:
+  atools::fs::NavDatabaseOptions options;
+  const SceneryArea& area;
+  QStringList *filepaths, *errors;
+  QVector<quint64> *hashes;
+};
+
+// -------------------------------------------------------------------------------
+FileManifest::FileManifest(const NavDatabaseOptions& opts)
+  : options(opts)
+{
+}
+
+void FileManifest::build(const QList<SceneryArea>& areas)
+{
+  areaFiles.clear();
+  areaKeys.clear();
+  numFiles = 0;
+  numDuplicates = 0;
+
+  // One result slot for each area - written by exactly one task
+  std::vector<AreaFiles> results(static_cast<size_t>(areas.size()));
+
+  bool dedupe = options.isDeduplicateFiles();
+  int numThreads = options.isReadParallel() ? options.getNumThreads() : 1;
+  if(numThreads > 1 && areas.size() > 1)
+  {
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+    for(int i = 0; i < areas.size(); i++)
+    {
+      AreaFiles& result = results[static_cast<size_t>(i)];
+      pool.start(new FileManifestTask(options, areas.at(i), &result.filepaths, &result.errorMessages,
+                                      dedupe ? &result.contentHashes : nullptr));
+    }
+    pool.waitForDone();
+  }
+  else
+  {
+    for(int i = 0; i < areas.size(); i++)
+    {
+      AreaFiles& result = results[static_cast<size_t>(i)];
+      FileResolver resolver(options);
+      resolver.getFiles(areas.at(i), &result.filepaths, nullptr, dedupe ? &result.contentHashes : nullptr);
+      result.errorMessages = resolver.getErrorMessages();
+    }
+  }
+
+  if(dedupe)
+    removeDuplicates(areas, results);
+
+  for(int i = 0; i < areas.size(); i++)
+  {
+    QString key = areaKey(areas.at(i));
+    if(!areaFiles.contains(key))
+    {
+      // Keep the first result if an area is given more than once
+      areaKeys.append(key);
+      areaFiles.insert(key, results.at(static_cast<size_t>(i)));
+    }
+    numFiles += areaFiles.value(key).filepaths.size();
+  }
+
+  qDebug() << Q_FUNC_INFO << "Found" << numFiles << "files in" << areas.size() << "areas"
+           << numDuplicates << "duplicates";
+}
+
+void FileManifest::removeDuplicates(const QList<SceneryArea>& areas, std::vector<AreaFiles>& results)
+{
+  // Content hash to first file in load order
+  QHash<quint64, QString> firstFiles;
+  QSet<QString> keys;
+
+  for(int areaIndex = 0; areaIndex < areas.size(); areaIndex++)
+  {
+    // Areas given more than once are stored only once with the first result - do not check these
+    QString key = areaKey(areas.at(areaIndex));
+    if(keys.contains(key))
+      continue;
+    keys.insert(key);
+
+    AreaFiles& result = results[static_cast<size_t>(areaIndex)];
+    QStringList filepaths;
+    for(int i = 0; i < result.filepaths.size(); i++)
+    {
+      const QString& filepath = result.filepaths.at(i);
+      quint64 hash = result.contentHashes.value(i, 0);
+
+      // 0 is used for unreadable files which are always read to report the error
+      auto it = hash != 0 ? firstFiles.constFind(hash) : firstFiles.constEnd();
+      if(it != firstFiles.constEnd())
+      {
+        qInfo() << Q_FUNC_INFO << "Duplicate" << filepath << "of" << it.value();
+        result.duplicates.append(qMakePair(filepath, it.value()));
+        numDuplicates++;
+      }
+      else
+      {
+        if(hash != 0)
+          firstFiles.insert(hash, filepath);
+        filepaths.append(filepath);
+      }
+    }
+    result.filepaths = filepaths;
+    result.contentHashes.clear();
+  }
+}
+
+bool FileManifest::contains(const SceneryArea& area) const
+{
+  return areaFiles.contains(areaKey(area));
+}
+
+QStringList FileManifest::getFilepaths(const SceneryArea& area) const
+{
+  return areaFiles.value(areaKey(area)).filepaths;
+}
+
+QStringList FileManifest::getErrorMessages(const SceneryArea& area) const
+{
+  return areaFiles.value(areaKey(area)).errorMessages;
+}
+
+QList<QPair<QString, QString> > FileManifest::getDuplicates(const SceneryArea& area) const
+{
+  return areaFiles.value(areaKey(area)).duplicates;
+}
+
+QStringList FileManifest::getAllFilepaths(bool includeDuplicates) const
+{
+  QStringList retval;
+  for(const QString& key : areaKeys)
+  {
+    const AreaFiles& files = areaFiles.value(key);
+    retval.append(files.filepaths);
+    if(includeDuplicates)
+    {
+      for(const QPair<QString, QString>& duplicate : files.duplicates)
+        retval.append(duplicate.first);
+    }
+  }
+  return retval;
+}
+
+QString FileManifest::areaKey(const SceneryArea& area)
+{
+  return QString::number(area.getAreaNumber()) + "|" + area.getLocalPath();
+}
+
+} // namespace scenery
+} // namespace fs
+} // namespace atools
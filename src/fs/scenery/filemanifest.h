@@ -0,0 +1,107 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_SCENERY_FILEMANIFEST_H
+#define ATOOLS_SCENERY_FILEMANIFEST_H
+
+#include <QHash>
+#include <QPair>
+#include <QStringList>
+#include <QVector>
+
+#include <vector>
+
+namespace atools {
+namespace fs {
+class NavDatabaseOptions;
+namespace scenery {
+
+class SceneryArea;
+
+/*
+ * List of all BGL files for a set of scenery areas. Directories are enumerated only once by
+ * FileResolver and the result is used for progress calculation and loading.
+ * Areas are resolved in a thread pool if parallel reading is enabled in the options.
+ *
+ * If file deduplication is enabled a content hash is calculated for each file. Files having the same content
+ * as a file in a previous area or earlier in the same area are not returned by getFilepaths() but by
+ * getDuplicates() together with the first file.
+ */
+class FileManifest
+{
+public:
+  FileManifest(const atools::fs::NavDatabaseOptions& opts);
+
+  /* Resolve files for all given areas. Clears previous content. */
+  void build(const QList<atools::fs::scenery::SceneryArea>& areas);
+
+  /* true if files were resolved for this area */
+  bool contains(const atools::fs::scenery::SceneryArea& area) const;
+
+  /* Filepaths of an area in the same order as returned by FileResolver. Empty if area is not contained. */
+  QStringList getFilepaths(const atools::fs::scenery::SceneryArea& area) const;
+
+  /* Error messages from FileResolver, e.g. for missing directories */
+  QStringList getErrorMessages(const atools::fs::scenery::SceneryArea& area) const;
+
+  /* Files having the same content as an earlier file. Pairs of duplicate and first filepath. */
+  QList<QPair<QString, QString> > getDuplicates(const atools::fs::scenery::SceneryArea& area) const;
+
+  /* All filepaths of all areas in the order of the area list given to build(). Includes duplicates
+   * if includeDuplicates is true. */
+  QStringList getAllFilepaths(bool includeDuplicates = false) const;
+
+  /* Number of files to read excluding duplicates */
+  int getNumFiles() const
+  {
+    return numFiles;
+  }
+
+  int getNumDuplicates() const
+  {
+    return numDuplicates;
+  }
+
+  int getNumAreas() const
+  {
+    return areaFiles.size();
+  }
+
+private:
+  struct AreaFiles
+  {
+    QStringList filepaths, errorMessages;
+    QVector<quint64> contentHashes;
+    QList<QPair<QString, QString> > duplicates;
+  };
+
+  /* Move files with already seen content hashes from filepaths to duplicates */
+  void removeDuplicates(const QList<atools::fs::scenery::SceneryArea>& areas, std::vector<AreaFiles>& results);
+
+  static QString areaKey(const atools::fs::scenery::SceneryArea& area);
+
+  const atools::fs::NavDatabaseOptions& options;
+  QHash<QString, AreaFiles> areaFiles;
+  QStringList areaKeys; // Keeps order of areas
+  int numFiles = 0, numDuplicates = 0;
+};
+
+} // namespace scenery
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_SCENERY_FILEMANIFEST_H
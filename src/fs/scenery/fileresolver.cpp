@@ -18,6 +18,7 @@
 #include "fs/scenery/fileresolver.h"
 #include "fs/scenery/sceneryarea.h"
 #include "fs/navdatabaseoptions.h"
+#include "util/xxhash.h"
 
 #include <QtDebug>
 #include <QFile>
@@ -36,7 +37,8 @@ FileResolver::~FileResolver()
 {
 }
 
-int FileResolver::getFiles(const SceneryArea& area, QStringList *filepaths, QStringList *filenames)
+int FileResolver::getFiles(const SceneryArea& area, QStringList *filepaths, QStringList *filenames,
+                           QVector<quint64> *contentHashes)
 {
   int numFiles = 0;
   errorMessages.clear();
@@ -97,6 +99,12 @@ int FileResolver::getFiles(const SceneryArea& area, QStringList *filepaths, QStr
                     filepaths->append(filepath);
                   if(filenames != nullptr)
                     filenames->append(filename);
+                  if(contentHashes != nullptr)
+                  {
+                    bool ok;
+                    quint64 hash = atools::util::xxHash64File(filepath, &ok);
+                    contentHashes->append(ok ? hash : 0);
+                  }
                 }
               }
               else
@@ -20,6 +20,7 @@
 
 #include <QList>
 #include <QStringList>
+#include <QVector>
 #include <QApplication>
 
 namespace atools {
@@ -49,10 +50,11 @@ public:
    * @param area scenery area to get the BGL files from
    * @param filepaths If not null will get all filepaths (path and filename)
    * @param filenames If not null will get all filenames (only filename)
+   * @param contentHashes If not null will get a xxHash64 of the content of each file or 0 if the file cannot be read
    * @return number of files found
    */
   int getFiles(const atools::fs::scenery::SceneryArea& area, QStringList *filepaths = nullptr,
-               QStringList *filenames = nullptr);
+               QStringList *filenames = nullptr, QVector<quint64> *contentHashes = nullptr);
 
   const QStringList& getErrorMessages() const
   {
@@ -20,9 +20,9 @@
 #include "sql/sqldatabase.h"
 #include "sql/sqlutil.h"
 #include "sql/sqlscript.h"
-#include "sql/sqlexport.h"
 #include "sql/sqltransaction.h"
 #include "sql/sqlquery.h"
+#include "sql/sqlbatch.h"
 #include "util/csvreader.h"
 #include "atools.h"
 #include "geo/pos.h"
@@ -30,6 +30,8 @@
 #include "settings/settings.h"
 #include "fs/util/fsutil.h"
 #include "io/fileroller.h"
+#include "io/textwriter.h"
+#include "fs/bgl/bglwaypointwriter.h"
 
 #include <QDateTime>
 #include <QFile>
@@ -39,6 +41,9 @@
 #include <QDir>
 #include <QRegularExpression>
 #include <QXmlStreamReader>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
 
 namespace atools {
 namespace fs {
@@ -49,13 +54,16 @@ using atools::sql::SqlUtil;
 using atools::sql::SqlDatabase;
 using atools::sql::SqlScript;
 using atools::sql::SqlQuery;
-using atools::sql::SqlExport;
 using atools::sql::SqlRecord;
 using atools::sql::SqlTransaction;
+using atools::sql::SqlBatch;
 
 /* Default visibility. Waypoint is shown on the map at a view distance below this value  */
 const static int VISIBLE_FROM_DEFAULT_NM = 250;
 
+/* Number of decimals for floating point values in CSV export */
+const static int CSV_NUMBER_PRECISION = 10;
+
 /* Simple SqlQuery wrapper which can be used to export all rows or a list of rows by id */
 class QueryWrapper
 {
@@ -349,8 +357,107 @@ SqlRecord UserdataManager::getEmptyRecord()
 
 // VRP,  1NM NORTH SALERNO TOWN, 1NSAL, 40.6964,            14.785,         0,0, IT, FROM SOR VOR: 069° 22NM
 // POI,  Cedar Butte lava flow,  POI,   43.4352891960911, -112.892122541337,0,0,   , photoreal areas
+/* Number of CSV records in a chunk which is parsed by one task */
+const static int CSV_CHUNK_RECORDS = 5000;
+const static int CSV_CHUNKS_PER_THREAD = 2;
+
+/* Parsed and validated userpoint from a CSV record */
+struct CsvRow
+{
+  QString type, name, ident, region, description, tags, altitude;
+  QDateTime lastEdit;
+  int visibleFrom;
+  float lonx, laty;
+};
+
+/* Complete CSV records of a file part and the parsed rows. A record can span more than one line. */
+struct CsvChunk
+{
+  QStringList lines;
+  qint64 endPos = 0; /* Byte offset in file for progress */
+  QVector<CsvRow> rows;
+  QString errorMessage; /* Not empty if validation failed. Rows after the error are not parsed. */
+};
+
+/* Parses and validates a range of chunks. Does the same as the sequential loop in importCsv did. */
+class CsvChunkTask :
+  public QRunnable
+{
+public:
+  CsvChunkTask(QVector<CsvChunk> *chunkList, int index, QChar separatorChar, QChar escapeChar)
+    : chunks(chunkList), chunkIndex(index), separator(separatorChar), escape(escapeChar)
+  {
+    setAutoDelete(true);
+  }
+
+  virtual void run() override
+  {
+    CsvChunk& chunk = (*chunks)[chunkIndex];
+    try
+    {
+      UserdataManager::parseCsvChunk(chunk, separator, escape);
+    }
+    catch(atools::Exception& e)
+    {
+      chunk.errorMessage = e.getMessage();
+    }
+    catch(...)
+    {
+      chunk.errorMessage = UserdataManager::tr("Unknown error while reading CSV file.");
+    }
+    chunk.lines.clear();
+  }
+
+private:
+  QVector<CsvChunk> *chunks;
+  int chunkIndex;
+  QChar separator, escape;
+};
+
+void UserdataManager::parseCsvChunk(CsvChunk& chunk, QChar separator, QChar escape)
+{
+  atools::util::CsvReader reader(separator, escape, true /* trim */);
+  chunk.rows.reserve(chunk.lines.size());
+
+  for(const QString& line : chunk.lines)
+  {
+    // Skip empty lines but add them if within an escaped field
+    if(line.isEmpty() && !reader.isInEscape())
+      continue;
+
+    reader.readCsvLine(line);
+    if(reader.isInEscape())
+      // Still in an escaped line so continue to read unchanged until " shows the end of the field
+      continue;
+
+    const QStringList& values = reader.getValues();
+
+    CsvRow row;
+    row.type = at(values, csv::TYPE);
+    row.name = at(values, csv::NAME);
+    row.ident = at(values, csv::IDENT);
+    row.region = at(values, csv::REGION, true /* no warning */);
+    row.description = at(values, csv::DESCRIPTION);
+    row.tags = at(values, csv::TAGS);
+    row.altitude = at(values, csv::ALT);
+
+    // YYYY-MM-DDTHH:mm:ss
+    row.lastEdit = QDateTime::fromString(at(values, csv::LAST_EDIT, true /* no warning */), Qt::ISODate);
+
+    bool ok;
+    row.visibleFrom = at(values, csv::VISIBLE_FROM, true /* no warning */).toInt(&ok);
+    if(row.visibleFrom <= 0 || !ok)
+      row.visibleFrom = VISIBLE_FROM_DEFAULT_NM;
+
+    validateCoordinates(line, at(values, csv::LONX), at(values, csv::LATY));
+    row.lonx = atFloat(values, csv::LONX);
+    row.laty = atFloat(values, csv::LATY);
+    chunk.rows.append(row);
+  }
+}
+
 int UserdataManager::importCsv(const QString& filepath, atools::fs::userdata::Flags flags, QChar separator,
-                               QChar escape)
+                               QChar escape, const std::function<bool(qint64 bytePos, qint64 fileSize)>& progress)
 {
   SqlTransaction transaction(db);
 
@@ -360,73 +467,126 @@ int UserdataManager::importCsv(const QString& filepath, atools::fs::userdata::Fl
   insertQuery.prepare(insert);
 
   QString absfilepath = QFileInfo(filepath).absoluteFilePath();
-  QDateTime now = QDateTime::currentDateTime();
+  QString now = QDateTime::currentDateTime().toString(Qt::ISODate);
+
+  SqlBatch batch(&insertQuery);
+  batch.bindConstant(":import_file_path", absfilepath);
+  batch.bindConstant(":temp", 0);
 
   int numImported = 0;
+  bool canceled = false;
   QFile file(filepath);
   if(file.open(QIODevice::ReadOnly | QIODevice::Text))
   {
-    atools::util::CsvReader reader(separator, escape, true /* trim */);
-
+    qint64 fileSize = file.size();
     QTextStream stream(&file);
     stream.setCodec("UTF-8");
 
-    int lineNum = 0;
-    while(!stream.atEnd())
+    if(flags & CSV_HEADER && !stream.atEnd())
+      // Ignore header
+      stream.readLine();
+
+    int numThreads = std::max(QThread::idealThreadCount(), 1);
+    int numChunks = numThreads * CSV_CHUNKS_PER_THREAD;
+
+    // Read a set of chunks each ending with a complete record
+    auto readChunks = [&](QVector<CsvChunk>& chunks) -> void
     {
-      if(flags & CSV_HEADER && lineNum == 0)
-        // Ignore header
-        continue;
+      chunks.clear();
+      while(!stream.atEnd() && chunks.size() < numChunks)
+      {
+        CsvChunk chunk;
+        chunk.lines.reserve(CSV_CHUNK_RECORDS + 100);
 
-      QString line = stream.readLine();
+        bool inEscape = false;
+        while(!stream.atEnd())
+        {
+          QString line = stream.readLine();
 
-      // Skip empty lines but add them if within an escaped field
-      if(line.isEmpty() && !reader.isInEscape())
-        continue;
+          // An odd number of escape characters opens or closes an escaped field spanning lines
+          if(line.count(escape) % 2 == 1)
+            inEscape = !inEscape;
+          chunk.lines.append(line);
 
-      reader.readCsvLine(line);
-      if(reader.isInEscape())
-        // Still in an escaped line so continue to read unchanged until " shows the end of the field
-        continue;
+          if(!inEscape && chunk.lines.size() >= CSV_CHUNK_RECORDS)
+            break;
+        }
+        chunk.endPos = file.pos();
+        chunks.append(chunk);
+      }
+    };
 
-      const QStringList& values = reader.getValues();
+    // Chunks being written and chunks being parsed - declared before the pool which waits for all tasks
+    QVector<CsvChunk> current, next;
 
-      insertQuery.bindValue(":type", at(values, csv::TYPE));
-      insertQuery.bindValue(":name", at(values, csv::NAME));
-      insertQuery.bindValue(":ident", at(values, csv::IDENT));
-      insertQuery.bindValue(":region", at(values, csv::REGION, true /* no warning */));
-      insertQuery.bindValue(":description", at(values, csv::DESCRIPTION));
-      insertQuery.bindValue(":tags", at(values, csv::TAGS));
-      insertQuery.bindValue(":import_file_path", absfilepath);
-      insertQuery.bindValue(":temp", 0);
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(numThreads);
 
-      // YYYY-MM-DDTHH:mm:ss
-      QDateTime lastEdit = QDateTime::fromString(at(values, csv::LAST_EDIT, true /* no warning */), Qt::ISODate);
-      if(lastEdit.isValid())
-        insertQuery.bindValue(":last_edit_timestamp", lastEdit.toString(Qt::ISODate));
-      else
-        insertQuery.bindValue(":last_edit_timestamp", now.toString(Qt::ISODate));
+    auto startChunks = [&](QVector<CsvChunk>& chunks) -> void
+    {
+      for(int i = 0; i < chunks.size(); i++)
+        threadPool.start(new CsvChunkTask(&chunks, i, separator, escape));
+    };
 
-      bool ok;
-      int visibleFrom = at(values, csv::VISIBLE_FROM, true /* no warning */).toInt(&ok);
-      if(visibleFrom > 0 && ok)
-        insertQuery.bindValue(":visible_from", visibleFrom);
-      else
-        insertQuery.bindValue(":visible_from", VISIBLE_FROM_DEFAULT_NM);
+    readChunks(current);
+    startChunks(current);
+    threadPool.waitForDone();
 
-      insertQuery.bindValue(":altitude", at(values, csv::ALT));
+    while(!current.isEmpty() && !canceled)
+    {
+      // Parse the next set of chunks while the current ones are written
+      readChunks(next);
+      startChunks(next);
 
-      validateCoordinates(line, at(values, csv::LONX), at(values, csv::LATY));
-      insertQuery.bindValue(":lonx", atFloat(values, csv::LONX));
-      insertQuery.bindValue(":laty", atFloat(values, csv::LATY));
-      insertQuery.exec();
-      lineNum++;
-      numImported++;
+      for(const CsvChunk& chunk : current)
+      {
+        for(const CsvRow& row : chunk.rows)
+        {
+          batch.bindValue(":type", row.type);
+          batch.bindValue(":name", row.name);
+          batch.bindValue(":ident", row.ident);
+          batch.bindValue(":region", row.region);
+          batch.bindValue(":description", row.description);
+          batch.bindValue(":tags", row.tags);
+          batch.bindValue(":last_edit_timestamp", row.lastEdit.isValid() ? row.lastEdit.toString(Qt::ISODate) : now);
+          batch.bindValue(":visible_from", row.visibleFrom);
+          batch.bindValue(":altitude", row.altitude);
+          batch.bindValue(":lonx", row.lonx);
+          batch.bindValue(":laty", row.laty);
+          batch.addRow();
+          numImported++;
+        }
+
+        if(!chunk.errorMessage.isEmpty())
+        {
+          // Stop at the first invalid record in file order - transaction is rolled back
+          threadPool.waitForDone();
+          throw atools::Exception(chunk.errorMessage);
+        }
+
+        if(progress && progress(chunk.endPos, fileSize))
+        {
+          canceled = true;
+          break;
+        }
+      }
+
+      threadPool.waitForDone();
+      current.swap(next);
     }
     file.close();
   }
   else
     throw atools::Exception(tr("Cannot open file \"%1\". Reason: %2.").arg(filepath).arg(file.errorString()));
+
+  if(canceled)
+  {
+    // Discard all rows
+    transaction.rollback();
+    return -1;
+  }
+
+  batch.exec();
   transaction.commit();
   return numImported;
 }
@@ -605,15 +765,8 @@ int UserdataManager::exportCsv(const QString& filepath, const QVector<int>& ids,
   QFile file(filepath);
   if(file.open((flags & APPEND ? QIODevice::Append : QIODevice::WriteOnly) | QIODevice::Text))
   {
-    QTextStream stream(&file);
-    stream.setCodec("UTF-8");
-
-    SqlExport sqlExport;
-    sqlExport.setSeparatorChar(separator);
-    sqlExport.setEscapeChar(escape);
-    sqlExport.setEndline(false);
-    sqlExport.setHeader(flags & CSV_HEADER);
-    sqlExport.setNumberPrecision(10);
+    // Write directly into a large buffer without QTextStream and temporary records
+    atools::io::TextWriter writer(&file);
 
     QueryWrapper query("select type, name, ident, laty, lonx, altitude as elevation, "
                        "0 as mag_var, tags, description, region, visible_from, last_edit_timestamp from userdata", db,
@@ -621,32 +774,57 @@ int UserdataManager::exportCsv(const QString& filepath, const QVector<int>& ids,
 
     if(!endsWithEol && (flags & APPEND))
       // Add needed linefeed for append
-      stream << endl;
+      writer << '\n';
 
     bool first = true;
+    int numColumns = 0;
 
     query.exec();
     while(query.next())
     {
-      if(first && flags & CSV_HEADER)
+      if(first)
       {
         first = false;
-        stream << sqlExport.getResultSetHeader(query.q.record()) << endl;
-      }
-      SqlRecord record = query.q.record();
+        SqlRecord record = query.q.record();
+        numColumns = record.count();
 
-      float magvar = 0.f;
-      if(magDec->isValid())
-        // Can be invalid if not database is loaded (no declination data) and backup is done
-        magvar = magDec->getMagVar(Pos(record.valueFloat("lonx"), record.valueFloat("laty")));
+        if(flags & CSV_HEADER)
+        {
+          for(int i = 0; i < numColumns; i++)
+          {
+            if(i > 0)
+            {
+              writer << separator;
+              writer.writeCsvString(record.fieldName(i), separator, escape);
+            }
+            else
+              writer << record.fieldName(i);
+          }
+          writer << '\n';
+        }
+      }
 
-      // Need to cast otherwise it is not recognized as a floating point number
-      record.setValue("mag_var", static_cast<double>(magvar));
+      for(int i = 0; i < numColumns; i++)
+      {
+        if(i > 0)
+          writer << separator;
 
-      stream << sqlExport.getResultSetRow(record) << endl;
+        if(i == csv::MAGVAR)
+        {
+          float magvar = 0.f;
+          if(magDec->isValid())
+            // Can be invalid if not database is loaded (no declination data) and backup is done
+            magvar = magDec->getMagVar(Pos(query.q.valueFloat(csv::LONX), query.q.valueFloat(csv::LATY)));
+          writer.writeFixed(magvar, CSV_NUMBER_PRECISION);
+        }
+        else
+          writer.writeCsvValue(query.q.value(i), separator, escape, CSV_NUMBER_PRECISION);
+      }
+      writer << '\n';
       numExported++;
     }
 
+    writer.flush();
     file.close();
   }
   else
@@ -704,8 +882,7 @@ int UserdataManager::exportXplane(const QString& filepath, const QVector<int>& i
   QFile file(filepath);
   if(file.open((flags & APPEND ? QIODevice::Append : QIODevice::WriteOnly) | QIODevice::Text))
   {
-    QTextStream stream(&file);
-    stream.setCodec("UTF-8");
+    atools::io::TextWriter writer(&file);
 
     // I
     // 1100 Version - data cycle 1804, build 20180421, metadata FixXP1100. Created by Little Navmap Version 1.9.1.develop (revision 47ef66a) on 2018 04 21T13:25:52
@@ -714,11 +891,11 @@ int UserdataManager::exportXplane(const QString& filepath, const QVector<int>& i
     if(!(flags & APPEND))
     {
       // Add file header
-      stream << "I" << endl << "1100 Version - "
+      writer << "I\n1100 Version - "
              << "data cycle " << QDateTime::currentDateTime().toString("yyMM") << ", "
              << "build " << QDateTime::currentDateTime().toString("yyyyMMdd") << ", "
              << "metadata FixXP1100. "
-             << atools::programFileInfoNoDate() << "." << endl << endl;
+             << atools::programFileInfoNoDate() << ".\n\n";
     }
 
     QueryWrapper query("select userdata_id, ident, name, tags, laty, lonx, altitude, tags, region from userdata", db,
@@ -729,18 +906,20 @@ int UserdataManager::exportXplane(const QString& filepath, const QVector<int>& i
     query.exec();
     while(query.next())
     {
-      QString region = query.q.valueStr("region").toUpper();
-
-      stream << QString::number(query.q.valueDouble("laty"), 'f', 8)
-             << " " << QString::number(query.q.valueDouble("lonx"), 'f', 8)
-             << " " << atools::fs::util::adjustIdent(query.q.valueStr("ident"), 5, query.q.valueInt("userdata_id"))
-             << " " << "ENRT" // Ignore airport here
-             << " " << (region.isEmpty() ? "ZZ" : atools::fs::util::adjustRegion(region))
-             << endl;
+      QString region = query.q.valueStr(8).toUpper();
+
+      writer.writeFixed(query.q.valueDouble(4), 8);
+      writer << ' ';
+      writer.writeFixed(query.q.valueDouble(5), 8);
+      writer << ' ' << atools::fs::util::adjustIdent(query.q.valueStr(1), 5, query.q.valueInt(0))
+             << " ENRT " // Ignore airport here
+             << (region.isEmpty() ? QString("ZZ") : atools::fs::util::adjustRegion(region))
+             << '\n';
       numExported++;
     }
 
-    stream << "99" << endl;
+    writer << "99\n";
+    writer.flush();
 
     file.close();
   }
@@ -760,11 +939,10 @@ int UserdataManager::exportGarmin(const QString& filepath, const QVector<int>& i
   QFile file(filepath);
   if(file.open((flags & APPEND ? QIODevice::Append : QIODevice::WriteOnly) | QIODevice::Text))
   {
-    QTextStream stream(&file);
-    stream.setCodec("UTF-8");
+    atools::io::TextWriter writer(&file);
 
     if(!endsWithEol && (flags & APPEND))
-      stream << endl;
+      writer << '\n';
 
     QueryWrapper query("select userdata_id, ident, name,  laty, lonx from userdata", db, ids);
     // MTHOOD,MT HOOD PEAK,45.3723,-121.69783
@@ -774,17 +952,18 @@ int UserdataManager::exportGarmin(const QString& filepath, const QVector<int>& i
     query.exec();
     while(query.next())
     {
-      stream << atools::fs::util::adjustIdent(query.q.valueStr("ident"), 6, query.q.valueInt("userdata_id"))
-             << ","
-             << query.q.valueStr("name").simplified().toUpper().replace(ADJUST_NAME_REGEXP, "").left(25)
-             << ","
-             << QString::number(query.q.valueDouble("laty"), 'f', 8)
-             << ","
-             << QString::number(query.q.valueDouble("lonx"), 'f', 8)
-             << endl;
+      writer << atools::fs::util::adjustIdent(query.q.valueStr(1), 6, query.q.valueInt(0))
+             << ','
+             << query.q.valueStr(2).simplified().toUpper().replace(ADJUST_NAME_REGEXP, "").left(25)
+             << ',';
+      writer.writeFixed(query.q.valueDouble(3), 8);
+      writer << ',';
+      writer.writeFixed(query.q.valueDouble(4), 8);
+      writer << '\n';
       numExported++;
     }
 
+    writer.flush();
     file.close();
   }
   else
@@ -845,6 +1024,29 @@ int UserdataManager::exportBgl(const QString& filepath, const QVector<int>& ids)
   return numExported;
 }
 
+int UserdataManager::exportBglBinary(const QString& filepath, const QVector<int>& ids)
+{
+  atools::fs::bgl::BglWaypointWriter writer;
+  if(!ids.isEmpty())
+    writer.reserve(ids.size());
+
+  QueryWrapper query("select userdata_id, ident, region, laty, lonx from userdata", db, ids);
+  query.exec();
+  while(query.next())
+  {
+    QString region = query.q.valueStr(2).toUpper();
+    if(region.size() != 2)
+      region = "ZZ";
+
+    Pos pos(query.q.valueFloat(4), query.q.valueFloat(3));
+    writer.addWaypoint(pos, atools::fs::util::adjustIdent(query.q.valueStr(1), 5, query.q.valueInt(0)), region,
+                       magDec->getMagVar(pos));
+  }
+
+  writer.writeFile(filepath);
+  return writer.size();
+}
+
 QString UserdataManager::at(const QStringList& line, int index, bool nowarn)
 {
   if(index < line.size())
@@ -21,6 +21,8 @@
 #include <QApplication>
 #include <QVector>
 
+#include <functional>
+
 namespace atools {
 
 namespace sql {
@@ -39,6 +41,9 @@ class MagDecReader;
 
 namespace userdata {
 
+struct CsvChunk;
+class CsvChunkTask;
+
 enum Flag
 {
   NONE,
@@ -102,9 +107,13 @@ public:
   void getEmptyRecord(atools::sql::SqlRecord& getRecord);
   atools::sql::SqlRecord getEmptyRecord();
 
-  /* Import and export from a predefined CSV format */
+  /* Import and export from a predefined CSV format.
+   * Records are parsed and validated in parallel and written in one transaction.
+   * progress is called with the byte position after each block of records. Return true to cancel.
+   * Returns -1 if canceled. Nothing is imported in this case. */
   int importCsv(const QString& filepath, atools::fs::userdata::Flags flags = atools::fs::userdata::NONE,
-                QChar separator = ',', QChar escape = '"');
+                QChar separator = ',', QChar escape = '"',
+                const std::function<bool(qint64 bytePos, qint64 fileSize)>& progress = nullptr);
   int exportCsv(const QString& filepath, const QVector<int>& ids = QVector<int>(),
                 atools::fs::userdata::Flags flags = atools::fs::userdata::NONE,
                 QChar separator = ',', QChar escape = '"');
@@ -122,6 +131,9 @@ public:
   /* Export waypoints into a XML file for BGL compilation */
   int exportBgl(const QString& filepath, const QVector<int>& ids);
 
+  /* Export waypoints directly into a binary BGL file which needs no compilation. Throws Exception on error. */
+  int exportBglBinary(const QString& filepath, const QVector<int>& ids);
+
   atools::sql::SqlDatabase *getDatabase() const
   {
     return db;
@@ -140,11 +152,16 @@ public:
   void dropSchema();
 
 private:
+  friend class atools::fs::userdata::CsvChunkTask;
+
   /* Prints a warning of colummn does not exist */
-  QString at(const QStringList& line, int index, bool nowarn = false);
+  static QString at(const QStringList& line, int index, bool nowarn = false);
 
   /* throws an exception if the coodinates are not valid */
-  void validateCoordinates(const QString& line, const QString& lonx, const QString& laty);
+  static void validateCoordinates(const QString& line, const QString& lonx, const QString& laty);
+
+  /* Parse and validate all lines of a chunk. Throws an exception for invalid coordinates. */
+  static void parseCsvChunk(atools::fs::userdata::CsvChunk& chunk, QChar separator, QChar escape);
 
   atools::sql::SqlDatabase *db;
   atools::fs::common::MagDecReader *magDec;
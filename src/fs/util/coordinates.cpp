@@ -21,9 +21,12 @@
 #include "atools.h"
 #include "exception.h"
 
-#include <cmath>
+#include <QLocale>
 #include <QRegularExpression>
 
+#include <cmath>
+#include <cstring>
+
 using atools::geo::Pos;
 
 namespace atools {
@@ -32,49 +35,90 @@ namespace util {
 
 // N48194W123096
 const static QString COORDS_FLIGHTPLAN_FORMAT_GFP("%1%2%3%4%5%6");
-const static QRegularExpression LONG_FORMAT_REGEXP_GFP("^([NS])([0-9]{2})([0-9]{3})"
-                                                       "([EW])([0-9]{3})([0-9]{3})$");
-
-// 46N078W
-const static QRegularExpression LONG_FORMAT_REGEXP_DEG("^([0-9]{2})([NS])"
-                                                       "([0-9]{3})([EW])$");
 
 // 4510N06810W
 const static QString COORDS_FLIGHTPLAN_FORMAT_DEG_MIN("%1%2%3%4%5%6");
-const static QRegularExpression LONG_FORMAT_REGEXP_DEG_MIN("^([0-9]{2})([0-9]{2})([NS])"
-                                                           "([0-9]{3})([0-9]{2})([EW])$");
 
 // 481200N0112842E
 const static QString COORDS_FLIGHTPLAN_FORMAT_DEG_MIN_SEC("%1%2%3%4%5%6%7%8");
-const static QRegularExpression LONG_FORMAT_REGEXP_DEG_MIN_SEC("^([0-9]{2})([0-9]{2})([0-9]{2})([NS])"
-                                                               "([0-9]{3})([0-9]{2})([0-9]{2})([EW])$");
 
-// Pattern allows trailing garbage
-// 50:40:42 N 003:13:30 E
-// 31:30:00 N 086:44:59 W
-static QRegularExpression MATCH_COORD_OPENAIR_MIN_SEC("^([\\d]+):([\\d]+):([\\d\\.]+)\\s*([NS])\\s*"
-                                                      "([\\d]+):([\\d]+):([\\d\\.]+)\\s*([EW])");
+// N6400 W07000 or N6400/W07000
+const static QString COORDS_FLIGHTPLAN_FORMAT_PAIR("%1%2/%3%4");
+
+/* Matchers for the fixed width waypoint formats. Avoids regular expressions since these are called for
+ * each coordinate in flight plans and user points. */
+namespace fixed {
+
+/* Returns the string unchanged if it needs no simplification or conversion to upper case */
+static QString normalize(const QString& str)
+{
+  for(QChar c : str)
+  {
+    if(c.isSpace() || c.isLower())
+      return str.simplified().toUpper();
+  }
+  return str;
+}
 
-// Pattern allows trailing garbage
-// 39:06.2 N 121:35.5 W
-static QRegularExpression MATCH_COORD_OPENAIR_MIN("^([\\d]+):([\\d\\.]+)\\s*([NS])\\s*"
-                                                  "([\\d]+):([\\d\\.]+)\\s*([EW])");
+/*
+ * Match string against pattern of the same length. Pattern characters:
+ * 'H' latitude hemisphere N or S, 'V' longitude hemisphere E or W, '0' digit, '/' space or slash.
+ * All other characters have to match exactly.
+ */
+static bool match(const QString& str, const char *pattern)
+{
+  int len = static_cast<int>(std::strlen(pattern));
+  if(str.size() != len)
+    return false;
 
-// 5020N
-const static QRegularExpression LONG_FORMAT_REGEXP_NAT("^([0-9]{2})"
-                                                       "([0-9]{2})N$");
+  for(int i = 0; i < len; i++)
+  {
+    ushort c = str.at(i).unicode();
+    switch(pattern[i])
+    {
+      case 'H':
+        if(c != 'N' && c != 'S')
+          return false;
+        break;
+
+      case 'V':
+        if(c != 'E' && c != 'W')
+          return false;
+        break;
+
+      case '0':
+        if(c < '0' || c > '9')
+          return false;
+        break;
+
+      case '/':
+        if(c != ' ' && c != '/')
+          return false;
+        break;
+
+      default:
+        if(c != static_cast<ushort>(pattern[i]))
+          return false;
+    }
+  }
+  return true;
+}
 
-// N6400 W07000 or N6400/W07000
-const static QString COORDS_FLIGHTPLAN_FORMAT_PAIR("%1%2/%3%4");
-const static QRegularExpression LONG_FORMAT_REGEXP_PAIR("^([NS])([0-9]{2})([0-9]{2})[ /]"
-                                                        "([EW])([0-9]{3})([0-9]{2})$");
-const static QRegularExpression LONG_FORMAT_REGEXP_PAIR2("^([0-9]{2})([0-9]{2})([NS])[ /]"
-                                                         "([0-9]{3})([0-9]{2})([EW])$");
-const static QRegularExpression LONG_FORMAT_REGEXP_PAIR_LAT("^([NS])([0-9]{2})([0-9]{2})$");
-const static QRegularExpression LONG_FORMAT_REGEXP_PAIR_LON("^([EW])([0-9]{3})([0-9]{2})$");
+/* Integer value of num digits at pos. Has to be checked by match() before. */
+static int digits(const QString& str, int pos, int num)
+{
+  int value = 0;
+  for(int i = pos; i < pos + num; i++)
+    value = value * 10 + (str.at(i).unicode() - '0');
+  return value;
+}
+
+static bool validDegrees(int latYDeg, int lonXDeg)
+{
+  return latYDeg <= 90 && lonXDeg <= 180;
+}
 
-atools::geo::Pos degMinSecFormatFromCapture(const QStringList& captured);
-atools::geo::Pos degMinFormatFromCapture(const QStringList& captured);
+} // namespace fixed
 
 // N48194W123096
 // Examples:
@@ -130,31 +174,21 @@ QString toDegMinSecFormat(const atools::geo::Pos& pos)
 // Garmin format N48194W123096
 atools::geo::Pos fromGfpFormat(const QString& str)
 {
-  QRegularExpressionMatch match = LONG_FORMAT_REGEXP_GFP.match(str.simplified().toUpper());
+  QString coords = fixed::normalize(str);
 
-  if(match.hasMatch())
+  if(fixed::match(coords, "H00000V000000"))
   {
-    QStringList captured = match.capturedTexts();
+    int latYDeg = fixed::digits(coords, 1, 2);
+    float latYMin = fixed::digits(coords, 3, 3) / 10.f;
+    float latYSec = (latYMin - std::floor(latYMin)) * 60.f;
 
-    if(captured.size() == 7)
-    {
-      bool latOk, lonOk, latMinOk, lonMinOk;
-      QString ns = captured.at(1);
-      int latYDeg = captured.at(2).toInt(&latOk);
-      float latYMin = captured.at(3).toFloat(&latMinOk) / 10.f;
-      float latYSec = (latYMin - std::floor(latYMin)) * 60.f;
-
-      QString ew = captured.at(4);
-      int lonXDeg = captured.at(5).toInt(&lonOk);
-      float lonXMin = captured.at(6).toFloat(&lonMinOk) / 10.f;
-      float lonXSec = (lonXMin - std::floor(lonXMin)) * 60.f;
-
-      if(latOk && lonOk && latMinOk && lonMinOk &&
-         -90 <= latYDeg && latYDeg <= 90 &&
-         -180 <= lonXDeg && lonXDeg <= 180)
-        return atools::geo::Pos(lonXDeg, static_cast<int>(lonXMin), lonXSec, ew == "W",
-                                latYDeg, static_cast<int>(latYMin), latYSec, ns == "S");
-    }
+    int lonXDeg = fixed::digits(coords, 7, 3);
+    float lonXMin = fixed::digits(coords, 10, 3) / 10.f;
+    float lonXSec = (lonXMin - std::floor(lonXMin)) * 60.f;
+
+    if(fixed::validDegrees(latYDeg, lonXDeg))
+      return atools::geo::Pos(lonXDeg, static_cast<int>(lonXMin), lonXSec, coords.at(6) == 'W',
+                              latYDeg, static_cast<int>(latYMin), latYSec, coords.at(0) == 'S');
   }
   return atools::geo::EMPTY_POS;
 }
@@ -162,27 +196,16 @@ atools::geo::Pos fromGfpFormat(const QString& str)
 // Degrees only 46N078W
 atools::geo::Pos fromDegFormat(const QString& str)
 {
-  QRegularExpressionMatch match = LONG_FORMAT_REGEXP_DEG.match(str.simplified().toUpper());
+  QString coords = fixed::normalize(str);
 
-  if(match.hasMatch())
+  if(fixed::match(coords, "00H000V"))
   {
-    QStringList captured = match.capturedTexts();
+    int latYDeg = fixed::digits(coords, 0, 2);
+    int lonXDeg = fixed::digits(coords, 3, 3);
 
-    if(captured.size() == 5)
-    {
-      bool latOk, lonOk;
-      int latYDeg = captured.at(1).toInt(&latOk);
-      QString ns = captured.at(2);
-
-      int lonXDeg = captured.at(3).toInt(&lonOk);
-      QString ew = captured.at(4);
-
-      if(latOk && lonOk &&
-         -90.f <= latYDeg && latYDeg <= 90.f &&
-         -180.f <= lonXDeg && lonXDeg <= 180.f)
-        return atools::geo::Pos(lonXDeg, 0, 0.f, ew == "W",
-                                latYDeg, 0, 0.f, ns == "S");
-    }
+    if(fixed::validDegrees(latYDeg, lonXDeg))
+      return atools::geo::Pos(lonXDeg, 0, 0.f, coords.at(6) == 'W',
+                              latYDeg, 0, 0.f, coords.at(2) == 'S');
   }
   return atools::geo::EMPTY_POS;
 }
@@ -190,29 +213,18 @@ atools::geo::Pos fromDegFormat(const QString& str)
 // Degrees and minutes 4510N06810W
 atools::geo::Pos fromDegMinFormat(const QString& str)
 {
-  QRegularExpressionMatch match = LONG_FORMAT_REGEXP_DEG_MIN.match(str.simplified().toUpper());
+  QString coords = fixed::normalize(str);
 
-  if(match.hasMatch())
+  if(fixed::match(coords, "0000H00000V"))
   {
-    QStringList captured = match.capturedTexts();
-
-    if(captured.size() == 7)
-    {
-      bool latOk, lonOk, latMinOk, lonMinOk;
-      int latYDeg = captured.at(1).toInt(&latOk);
-      int latYMin = captured.at(2).toInt(&latMinOk);
-      QString ns = captured.at(3);
-
-      int lonXDeg = captured.at(4).toInt(&lonOk);
-      int lonXMin = captured.at(5).toInt(&lonMinOk);
-      QString ew = captured.at(6);
-
-      if(latOk && lonOk && latMinOk && lonMinOk &&
-         -90 <= latYDeg && latYDeg <= 90 &&
-         -180 <= lonXDeg && lonXDeg <= 180)
-        return atools::geo::Pos(lonXDeg, lonXMin, 0.f, ew == "W",
-                                latYDeg, latYMin, 0.f, ns == "S");
-    }
+    int latYDeg = fixed::digits(coords, 0, 2);
+    int latYMin = fixed::digits(coords, 2, 2);
+    int lonXDeg = fixed::digits(coords, 5, 3);
+    int lonXMin = fixed::digits(coords, 8, 2);
+
+    if(fixed::validDegrees(latYDeg, lonXDeg))
+      return atools::geo::Pos(lonXDeg, lonXMin, 0.f, coords.at(10) == 'W',
+                              latYDeg, latYMin, 0.f, coords.at(4) == 'S');
   }
 
   return atools::geo::EMPTY_POS;
@@ -221,10 +233,21 @@ atools::geo::Pos fromDegMinFormat(const QString& str)
 // Degrees, minutes and seconds 481200N0112842E
 atools::geo::Pos fromDegMinSecFormat(const QString& str)
 {
-  QRegularExpressionMatch match = LONG_FORMAT_REGEXP_DEG_MIN_SEC.match(str.simplified().toUpper());
+  QString coords = fixed::normalize(str);
 
-  if(match.hasMatch())
-    return degMinSecFormatFromCapture(match.capturedTexts());
+  if(fixed::match(coords, "000000H0000000V"))
+  {
+    int latYDeg = fixed::digits(coords, 0, 2);
+    int latYMin = fixed::digits(coords, 2, 2);
+    float latYSec = fixed::digits(coords, 4, 2);
+    int lonXDeg = fixed::digits(coords, 7, 3);
+    int lonXMin = fixed::digits(coords, 10, 2);
+    float lonXSec = fixed::digits(coords, 12, 2);
+
+    if(fixed::validDegrees(latYDeg, lonXDeg))
+      return atools::geo::Pos(lonXDeg, lonXMin, lonXSec, coords.at(14) == 'W',
+                              latYDeg, latYMin, latYSec, coords.at(6) == 'S');
+  }
 
   return atools::geo::EMPTY_POS;
 }
@@ -232,49 +255,33 @@ atools::geo::Pos fromDegMinSecFormat(const QString& str)
 // Degrees and minutes in pair N6400 W07000 or N6400/W07000
 atools::geo::Pos fromDegMinPairFormat(const QString& str)
 {
-  QRegularExpressionMatch match = LONG_FORMAT_REGEXP_PAIR.match(str.simplified().toUpper());
-
-  bool latOk = false, lonOk = false, latMinOk = false, lonMinOk = false;
-  QString ns, ew;
-  int latYDeg = 0, latYMin = 0, lonXDeg = 0, lonXMin = 0;
+  QString coords = fixed::normalize(str);
 
-  if(match.hasMatch())
+  int latYDeg, latYMin, lonXDeg, lonXMin;
+  bool south, west;
+  if(fixed::match(coords, "H0000/V00000"))
   {
-    QStringList captured = match.capturedTexts();
-    if(captured.size() == 7)
-    {
-      ns = captured.at(1);
-      latYDeg = captured.at(2).toInt(&latOk);
-      latYMin = captured.at(3).toInt(&latMinOk);
-      ew = captured.at(4);
-      lonXDeg = captured.at(5).toInt(&lonOk);
-      lonXMin = captured.at(6).toInt(&lonMinOk);
-    }
+    south = coords.at(0) == 'S';
+    latYDeg = fixed::digits(coords, 1, 2);
+    latYMin = fixed::digits(coords, 3, 2);
+    west = coords.at(6) == 'W';
+    lonXDeg = fixed::digits(coords, 7, 3);
+    lonXMin = fixed::digits(coords, 10, 2);
   }
-  else
+  else if(fixed::match(coords, "0000H/00000V"))
   {
-    QRegularExpressionMatch match2 = LONG_FORMAT_REGEXP_PAIR2.match(str.simplified().toUpper());
-
-    if(match2.hasMatch())
-    {
-      QStringList captured = match2.capturedTexts();
-      if(captured.size() == 7)
-      {
-        latYDeg = captured.at(1).toInt(&latOk);
-        latYMin = captured.at(2).toInt(&latMinOk);
-        ns = captured.at(3);
-        lonXDeg = captured.at(4).toInt(&lonOk);
-        lonXMin = captured.at(5).toInt(&lonMinOk);
-        ew = captured.at(6);
-      }
-    }
+    latYDeg = fixed::digits(coords, 0, 2);
+    latYMin = fixed::digits(coords, 2, 2);
+    south = coords.at(4) == 'S';
+    lonXDeg = fixed::digits(coords, 6, 3);
+    lonXMin = fixed::digits(coords, 9, 2);
+    west = coords.at(11) == 'W';
   }
+  else
+    return atools::geo::EMPTY_POS;
 
-  if(latOk && lonOk && latMinOk && lonMinOk &&
-     -90 <= latYDeg && latYDeg <= 90 &&
-     -180 <= lonXDeg && lonXDeg <= 180)
-    return atools::geo::Pos(lonXDeg, lonXMin, 0.f, ew == "W",
-                            latYDeg, latYMin, 0.f, ns == "S");
+  if(fixed::validDegrees(latYDeg, lonXDeg))
+    return atools::geo::Pos(lonXDeg, lonXMin, 0.f, west, latYDeg, latYMin, 0.f, south);
   else
     return atools::geo::EMPTY_POS;
 }
@@ -283,24 +290,16 @@ atools::geo::Pos fromDegMinPairFormat(const QString& str)
 // first two figures are the latitude north and the second two figures are the longitude west
 atools::geo::Pos fromNatFormat(const QString& str)
 {
-  QRegularExpressionMatch match = LONG_FORMAT_REGEXP_NAT.match(str.simplified().toUpper());
+  QString coords = fixed::normalize(str);
 
-  if(match.hasMatch())
+  if(fixed::match(coords, "0000N"))
   {
-    QStringList captured = match.capturedTexts();
-
-    if(captured.size() == 3)
-    {
-      bool latOk, lonOk;
-      int latYDeg = captured.at(1).toInt(&latOk);
-      int lonXDeg = captured.at(2).toInt(&lonOk);
-
-      if(latOk && lonOk &&
-         0 <= latYDeg && latYDeg <= 90 &&
-         0 <= lonXDeg && lonXDeg <= 180)
-        return atools::geo::Pos(lonXDeg, 0, 0.f, true, latYDeg, 0, 0.f, false);
-    }
+    int latYDeg = fixed::digits(coords, 0, 2);
+    int lonXDeg = fixed::digits(coords, 2, 2);
+    if(fixed::validDegrees(latYDeg, lonXDeg))
+      return atools::geo::Pos(lonXDeg, 0, 0.f, true, latYDeg, 0, 0.f, false);
   }
+
   return atools::geo::EMPTY_POS;
 }
 
@@ -328,65 +327,126 @@ atools::geo::Pos fromAnyWaypointFormat(const QString& str)
   return atools::geo::EMPTY_POS;
 }
 
-geo::Pos fromOpenAirFormat(const QString& coordStr)
+/* Scanner for OpenAir coordinates. Avoids regular expressions since airspace files contain millions of these. */
+namespace openair {
+
+struct Scanner
 {
-  QRegularExpressionMatch match = MATCH_COORD_OPENAIR_MIN_SEC.match(coordStr.toUpper());
-  if(match.hasMatch())
-    return degMinSecFormatFromCapture(match.capturedTexts());
-  else
+  const QChar *cur, *end;
+
+  void skipSpace()
   {
-    match = MATCH_COORD_OPENAIR_MIN.match(coordStr);
-    if(match.hasMatch())
-      return degMinFormatFromCapture(match.capturedTexts());
+    while(cur < end && cur->isSpace())
+      cur++;
   }
 
-  return atools::geo::EMPTY_POS;
-}
+  /* [0-9]+ */
+  bool integer(int& value)
+  {
+    const QChar *start = cur;
+    value = 0;
+    while(cur < end && cur->isDigit() && value < 100000)
+      value = value * 10 + cur++->digitValue();
+    return cur > start && !(cur < end && cur->isDigit());
+  }
 
-atools::geo::Pos degMinFormatFromCapture(const QStringList& captured)
-{
-  if(captured.size() == 7)
+  /* [0-9\.]+ with at most one dot and at least one digit. Returns false if not a valid number. */
+  bool decimal(float& value, bool& hasDot)
   {
-    bool latOk, lonOk, latMinOk, lonMinOk;
-    int latYDeg = captured.at(1).toInt(&latOk);
-    float latYMin = captured.at(2).toFloat(&latMinOk);
-    QString ns = captured.at(3);
-
-    int lonXDeg = captured.at(4).toInt(&lonOk);
-    float lonXMin = captured.at(5).toFloat(&lonMinOk);
-    QString ew = captured.at(6);
-
-    if(latOk && lonOk && latMinOk && lonMinOk &&
-       -90 <= latYDeg && latYDeg <= 90 &&
-       -180 <= lonXDeg && lonXDeg <= 180)
-      return atools::geo::Pos((lonXDeg + lonXMin / 60.f) * (ew == "W" ? -1.f : 1.f),
-                              (latYDeg + latYMin / 60.f) * (ns == "S" ? -1.f : 1.f));
+    double result = 0., divisor = 1.;
+    int numDigits = 0;
+    hasDot = false;
+    while(cur < end && (cur->isDigit() || *cur == '.'))
+    {
+      if(*cur == '.')
+      {
+        if(hasDot)
+          return false;
+        hasDot = true;
+      }
+      else
+      {
+        result = result * 10. + cur->digitValue();
+        numDigits++;
+        if(hasDot)
+          divisor *= 10.;
+      }
+      cur++;
+    }
+    value = static_cast<float>(result / divisor);
+    return numDigits > 0;
   }
-  return atools::geo::EMPTY_POS;
-}
 
-atools::geo::Pos degMinSecFormatFromCapture(const QStringList& captured)
-{
-  if(captured.size() == 9)
+  bool character(char c)
   {
-    bool latOk, lonOk, latMinOk, lonMinOk, latSecOk, lonSecOk;
-    int latYDeg = captured.at(1).toInt(&latOk);
-    int latYMin = captured.at(2).toInt(&latMinOk);
-    float latYSec = captured.at(3).toFloat(&latSecOk);
-    QString ns = captured.at(4);
-
-    int lonXDeg = captured.at(5).toInt(&lonOk);
-    int lonXMin = captured.at(6).toInt(&lonMinOk);
-    float lonXSec = captured.at(7).toFloat(&lonSecOk);
-    QString ew = captured.at(8);
-
-    if(latOk && lonOk && latMinOk && lonMinOk && latSecOk && lonSecOk &&
-       -90 <= latYDeg && latYDeg <= 90 &&
-       -180 <= lonXDeg && lonXDeg <= 180)
-      return atools::geo::Pos(lonXDeg, lonXMin, lonXSec, ew == "W",
-                              latYDeg, latYMin, latYSec, ns == "S");
+    if(cur < end && cur->toUpper() == QLatin1Char(c))
+    {
+      cur++;
+      return true;
+    }
+    return false;
   }
-  return atools::geo::EMPTY_POS;
+
+  /* Degrees, minutes and optional seconds like 50:40:42 or 39:06.2 followed by one of the hemisphere letters */
+  bool part(int& degrees, float& minutes, float& seconds, bool& hasSeconds, char positive, char negative,
+            bool& isNegative)
+  {
+    bool hasDot;
+    if(!integer(degrees) || !character(':') || !decimal(minutes, hasDot))
+      return false;
+
+    hasSeconds = false;
+    seconds = 0.f;
+    if(cur < end && *cur == ':')
+    {
+      // Minutes have to be an integer if followed by seconds
+      cur++;
+      if(hasDot || !decimal(seconds, hasDot))
+        return false;
+      hasSeconds = true;
+    }
+
+    skipSpace();
+    if(character(positive))
+      isNegative = false;
+    else if(character(negative))
+      isNegative = true;
+    else
+      return false;
+    return true;
+  }
+
+};
+
+} // namespace openair
+
+geo::Pos fromOpenAirFormat(const QString& coordStr)
+{
+  // Pattern allows trailing garbage
+  // 50:40:42 N 003:13:30 E
+  // 31:30:00 N 086:44:59 W
+  // 39:06.2 N 121:35.5 W
+  openair::Scanner scanner = {coordStr.constData(), coordStr.constData() + coordStr.size()};
+
+  int latYDeg, lonXDeg;
+  float latYMin, latYSec, lonXMin, lonXSec;
+  bool latHasSec, lonHasSec, south, west;
+  if(!scanner.part(latYDeg, latYMin, latYSec, latHasSec, 'N', 'S', south))
+    return atools::geo::EMPTY_POS;
+
+  scanner.skipSpace();
+  if(!scanner.part(lonXDeg, lonXMin, lonXSec, lonHasSec, 'E', 'W', west))
+    return atools::geo::EMPTY_POS;
+
+  if(latHasSec != lonHasSec || latYDeg > 90 || lonXDeg > 180)
+    return atools::geo::EMPTY_POS;
+
+  if(latHasSec)
+    return atools::geo::Pos(lonXDeg, static_cast<int>(lonXMin), lonXSec, west,
+                            latYDeg, static_cast<int>(latYMin), latYSec, south);
+  else
+    return atools::geo::Pos((lonXDeg + lonXMin / 60.f) * (west ? -1.f : 1.f),
+                            (latYDeg + latYMin / 60.f) * (south ? -1.f : 1.f));
 }
 
 QRegularExpressionMatch safeMatch(const QRegularExpression& regexp, const QString& str)
@@ -453,11 +513,201 @@ atools::geo::Pos degFromMatch(const QRegularExpressionMatch& match)
   return Pos(lonX, latY);
 }
 
+/* Single pass scanner for the degree, degree/minute and degree/minute/second formats of fromAnyFormat.
+ * Accepts only what the regular expressions accept. Everything else is left to the regular expressions. */
+namespace anyformat {
+
+/* Component values of one coordinate */
+struct Part
+{
+  int numValues = 0;
+  double values[3];
+  bool negative = false;
+};
+
+struct Scanner
+{
+  const QChar *cur, *end;
+  QChar decimalPoint;
+
+  void skipSpace()
+  {
+    while(cur < end && cur->isSpace())
+      cur++;
+  }
+
+  bool hemisphere(char positive, char negative, bool& isNegative)
+  {
+    if(cur < end)
+    {
+      QChar c = cur->toUpper();
+      if(c == QLatin1Char(positive) || c == QLatin1Char(negative))
+      {
+        isNegative = c == QLatin1Char(negative);
+        cur++;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool isNumberStart() const
+  {
+    return cur < end && ((cur->unicode() >= '0' && cur->unicode() <= '9') || *cur == '.' || *cur == decimalPoint);
+  }
+
+  /* [0-9.]+ with at most one decimal point */
+  bool number(double& value, bool& isInteger)
+  {
+    double divisor = 1.;
+    int numDigits = 0;
+    value = 0.;
+    isInteger = true;
+    while(cur < end)
+    {
+      ushort c = cur->unicode();
+      if(c >= '0' && c <= '9')
+      {
+        value = value * 10. + (c - '0');
+        numDigits++;
+        if(!isInteger)
+          divisor *= 10.;
+      }
+      else if(c == '.' || *cur == decimalPoint)
+      {
+        if(!isInteger)
+          // Second point - leave to regular expression
+          return false;
+        isInteger = false;
+      }
+      else
+        break;
+      cur++;
+    }
+    value /= divisor;
+    return numDigits > 0;
+  }
+
+  /* Degree, minute or second sign depending on component index */
+  bool sign(int index)
+  {
+    if(cur < end)
+    {
+      ushort c = cur->unicode();
+      if((index == 0 && (c == 0x00B0 || c == '*')) || (index == 1 && c == '\'') || (index == 2 && c == '"'))
+      {
+        cur++;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /*
+   * One to three numbers separated by space or signs with hemisphere letter before or after.
+   * All numbers except the last one have to be integers.
+   * sepAfterLast is true if the last number is followed by a sign or space.
+   */
+  bool part(Part& result, char positive, char negative, bool leading, bool& sepAfterLast)
+  {
+    skipSpace();
+    if(leading && !hemisphere(positive, negative, result.negative))
+      return false;
+
+    result.numValues = 0;
+    bool lastInteger = true;
+    while(result.numValues < 3)
+    {
+      skipSpace();
+      if(!isNumberStart())
+        break;
+
+      if(!lastInteger)
+        // Only last value can be decimal
+        return false;
+
+      if(!number(result.values[result.numValues], lastInteger))
+        return false;
+
+      // Numbers are always separated since number() consumes all digits and points
+      const QChar *afterNumber = cur;
+      skipSpace();
+      sepAfterLast = sign(result.numValues) || cur > afterNumber;
+      result.numValues++;
+    }
+
+    if(result.numValues == 0)
+      return false;
+
+    skipSpace();
+    if(!leading && !hemisphere(positive, negative, result.negative))
+      return false;
+
+    return true;
+  }
+
+};
+
+/* Build position from both parts. Returns invalid position if any value is out of range. */
+static Pos toPos(const Part& lat, const Part& lon)
+{
+  float latY = 0.f, lonX = 0.f;
+  for(int i = 0; i < lat.numValues; i++)
+  {
+    // Same float conversion as the regular expression path
+    latY += static_cast<float>(lat.values[i]) / (i == 0 ? 1.f : (i == 1 ? 60.f : 3600.f));
+    lonX += static_cast<float>(lon.values[i]) / (i == 0 ? 1.f : (i == 1 ? 60.f : 3600.f));
+  }
+  return Pos(lonX * (lon.negative ? -1.f : 1.f), latY * (lat.negative ? -1.f : 1.f));
+}
+
+/* Returns invalid position if the string does not match one of the formats */
+static Pos scan(const QString& coords, QChar decimalPoint)
+{
+  const QChar *begin = coords.constData(), *end = begin + coords.size();
+
+  // Hemisphere letter before or after number
+  bool leading = false;
+  for(const QChar *c = begin; c < end; c++)
+  {
+    if(!c->isSpace())
+    {
+      leading = !c->isDigit() && *c != '.' && *c != decimalPoint;
+      break;
+    }
+  }
+
+  Scanner scanner = {begin, end, decimalPoint};
+  Part lat, lon;
+  bool latSep = false, lonSep = false;
+  if(!scanner.part(lat, 'N', 'S', leading, latSep) || !scanner.part(lon, 'E', 'W', leading, lonSep))
+    return Pos();
+
+  scanner.skipSpace();
+  if(scanner.cur != end || lat.numValues != lon.numValues)
+    return Pos();
+
+  // Signs or space which are required by the patterns
+  if(leading && !latSep)
+    return Pos();
+  if(!leading && lat.numValues == 2 && (!latSep || !lonSep))
+    return Pos();
+
+  return toPos(lat, lon);
+}
+
+} // namespace anyformat
+
 geo::Pos fromAnyFormat(const QString& coords)
 {
   if(coords.simplified().isEmpty())
     return atools::geo::EMPTY_POS;
 
+  // Try fast scanner first and use regular expressions if it does not recognize the format
+  Pos scanned = anyformat::scan(coords, QLocale().decimalPoint());
+  if(scanned.isValid() && scanned.isValidRange())
+    return scanned;
+
   // Convert local dependent decimal point to dot
   QString coordStr(coords.simplified().toUpper().replace(QLocale().decimalPoint(), "."));
 
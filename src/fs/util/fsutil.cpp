@@ -19,57 +19,118 @@
 #include "atools.h"
 #include "geo/calculations.h"
 
-#include <QRegularExpression>
 #include <QSet>
+#include <QStringList>
+#include <QVector>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 
 namespace atools {
 namespace fs {
 namespace util {
 
-// Closed airport by name
-static const QRegularExpression REGEXP_CLOSED(QLatin1Literal("(\\[X\\]|\\bCLSD\\b|\\bCLOSED\\b)"));
-const static QRegularExpression REGEXP_DIGIT("\\d");
-const static QRegularExpression REGEXP_WHITESPACE("\\s");
-
-/* ICAO speed and altitude matches */
-const static QRegularExpression REGEXP_SPDALT("^([NMK])(\\d{2,4})(([FSAM])(\\d{2,4}))?$");
-const static QRegularExpression REGEXP_SPDALT_ALL("^([NMK])(\\d{3,4})([FSAM])(\\d{3,4})$");
-
-// Look for military designator words
-static const QVector<QRegularExpression> REGEXP_MIL({
-        QRegularExpression(QLatin1Literal("\\bAAF\\b")),
-        QRegularExpression(QLatin1Literal("\\bAB\\b")),
-        QRegularExpression(QLatin1Literal("\\bAF\\b")),
-        QRegularExpression(QLatin1Literal("\\bAFB\\b")),
-        QRegularExpression(QLatin1Literal("\\bAFS\\b")),
-        QRegularExpression(QLatin1Literal("\\bAHP\\b")),
-        QRegularExpression(QLatin1Literal("\\bAIR BASE\\b")),
-        QRegularExpression(QLatin1Literal("\\bAIRBASE\\b")),
-        QRegularExpression(QLatin1Literal("\\bAIR FORCE\\b")),
-        QRegularExpression(QLatin1Literal("\\bANGB\\b")),
-        QRegularExpression(QLatin1Literal("\\bARB\\b")),
-        QRegularExpression(QLatin1Literal("\\bARMY\\b")),
-        // QRegularExpression(QLatin1Literal("\\bGTS\\b")), not an airbase
-        QRegularExpression(QLatin1Literal("\\bLRRS\\b")),
-        QRegularExpression(QLatin1Literal("\\bPMRF\\b")),
-        QRegularExpression(QLatin1Literal("\\bMCAF\\b")),
-        QRegularExpression(QLatin1Literal("\\bMCALF\\b")),
-        QRegularExpression(QLatin1Literal("\\bMCAS\\b")),
-        QRegularExpression(QLatin1Literal("\\bMIL\\b")),
-        QRegularExpression(QLatin1Literal("\\bMILITARY\\b")),
-        QRegularExpression(QLatin1Literal("\\bNAF\\b")),
-        QRegularExpression(QLatin1Literal("\\bNALF\\b")),
-        QRegularExpression(QLatin1Literal("\\bNAS\\b")),
-        QRegularExpression(QLatin1Literal("\\bNAVAL\\b")),
-        QRegularExpression(QLatin1Literal("\\bNAVY\\b")),
-        QRegularExpression(QLatin1Literal("\\bNAWS\\b")),
-        QRegularExpression(QLatin1Literal("\\bNOLF\\b")),
-        QRegularExpression(QLatin1Literal("\\bNS\\b")),
-        QRegularExpression(QLatin1Literal("\\bRAF\\b")),
-        QRegularExpression(QLatin1Literal("\\bRNAS\\b")),
-        QRegularExpression(QLatin1Literal("\\bROYAL MARINES\\b")),
-        QRegularExpression(QLatin1Literal("\\bAFLD\\b"))
-      });
+// Character scanners replacing regular expressions for names and idents. Word characters are ASCII
+// only like "\w" and "\b" in QRegularExpression without Unicode properties.
+
+inline static bool isUpperOrDigit(ushort c)
+{
+  return (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+inline static bool isAsciiDigit(ushort c)
+{
+  return c >= '0' && c <= '9';
+}
+
+inline static bool isWordChar(ushort c)
+{
+  return isUpperOrDigit(c) || (c >= 'a' && c <= 'z') || c == '_';
+}
+
+/* Same as "\\s" */
+inline static bool isAsciiSpace(ushort c)
+{
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline static char asciiUpper(ushort c)
+{
+  return static_cast<char>(c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c);
+}
+
+/* Military designators as whole words. Sorted for binary search. */
+static const char *MIL_WORDS[] = {
+  "AAF", "AB", "AF", "AFB", "AFLD", "AFS", "AHP", "AIRBASE", "ANGB", "ARB", "ARMY", "LRRS", "MCAF", "MCALF",
+  "MCAS", "MIL", "MILITARY", "NAF", "NALF", "NAS", "NAVAL", "NAVY", "NAWS", "NOLF", "NS", "PMRF", "RAF", "RNAS"
+  // "GTS" not an airbase
+};
+
+/* Longest word which has to be compared. Longer words cannot match. */
+static const int MAX_WORD_LEN = 8;
+
+static bool isMilitaryWord(const char *word)
+{
+  return std::binary_search(std::begin(MIL_WORDS), std::end(MIL_WORDS), word,
+                            [](const char *w1, const char *w2) -> bool {
+          return std::strcmp(w1, w2) < 0;
+        });
+}
+
+/* Single or double word military designators like "AIR BASE" separated by exactly one space */
+static bool isMilitaryWords(const char *word, const char *prevWord, bool prevAdjacent)
+{
+  if(prevAdjacent)
+  {
+    if(std::strcmp(prevWord, "AIR") == 0 && (std::strcmp(word, "BASE") == 0 || std::strcmp(word, "FORCE") == 0))
+      return true;
+
+    if(std::strcmp(prevWord, "ROYAL") == 0 && std::strcmp(word, "MARINES") == 0)
+      return true;
+  }
+  return isMilitaryWord(word);
+}
+
+/* Copy str keeping only characters accepted by the function */
+template<typename FUNC>
+static QString filterChars(const QString& str, FUNC accept)
+{
+  QString retval;
+  retval.reserve(str.size());
+  for(QChar c : str)
+  {
+    if(accept(c.unicode()))
+      retval.append(c);
+  }
+  return retval;
+}
+
+/* Parses unit character from units followed by minDigits to four digits at pos.
+ * Returns number of characters consumed or 0 if not matching. */
+static int parseUnitValue(const QString& str, int pos, const char *units, int minDigits, char& unit, int& value)
+{
+  if(pos >= str.size())
+    return 0;
+
+  ushort c = str.at(pos).unicode();
+  if(c == 0 || c > 'Z' || std::strchr(units, c) == nullptr)
+    return 0;
+
+  unit = static_cast<char>(c);
+  value = 0;
+  int numDigits = 0;
+  for(int i = pos + 1; i < str.size() && isAsciiDigit(str.at(i).unicode()); i++)
+  {
+    value = value * 10 + (str.at(i).unicode() - '0');
+    numDigits++;
+  }
+
+  if(numDigits < minDigits || numDigits > 4)
+    return 0;
+
+  return numDigits + 1;
+}
 
 static const QHash<QString, QString> NAME_CODE_MAP(
       {
@@ -375,25 +436,91 @@ int calculateAirportRatingXp(bool isAddon, bool is3D, bool hasTower, int numTaxi
   return rating;
 }
 
+int classifyName(const QString& name, int flags)
+{
+  int result = NAME_NONE;
+  const QChar *data = name.constData();
+  int len = name.size();
+
+  char word[MAX_WORD_LEN + 1] = {0}, prevWord[MAX_WORD_LEN + 1] = {0};
+  int prevEnd = -2;
+
+  int i = 0;
+  while(i < len && result != flags)
+  {
+    ushort c = data[i].unicode();
+
+    if(c == '[' && flags & NAME_CLOSED && i + 2 < len && asciiUpper(data[i + 1].unicode()) == 'X' &&
+       data[i + 2].unicode() == ']')
+      // "[X]" in name
+      result |= NAME_CLOSED;
+
+    if(!isWordChar(c))
+    {
+      i++;
+      continue;
+    }
+
+    // Collect whole word in upper case
+    int start = i;
+    while(i < len && isWordChar(data[i].unicode()))
+      i++;
+    int wordLen = i - start;
+
+    if(wordLen <= MAX_WORD_LEN)
+    {
+      for(int k = 0; k < wordLen; k++)
+        word[k] = asciiUpper(data[start + k].unicode());
+      word[wordLen] = '\0';
+    }
+    else
+      word[0] = '\0';
+
+    if(word[0] != '\0')
+    {
+      if(flags & NAME_CLOSED && (std::strcmp(word, "CLSD") == 0 || std::strcmp(word, "CLOSED") == 0))
+        result |= NAME_CLOSED;
+
+      if(flags & NAME_MILITARY &&
+         isMilitaryWords(word, prevWord, prevEnd + 1 == start && data[prevEnd].unicode() == ' '))
+        result |= NAME_MILITARY;
+    }
+
+    std::strcpy(prevWord, word);
+    prevEnd = i;
+  }
+  return result;
+}
+
+QVector<int> classifyNames(const QStringList& names, int flags)
+{
+  QVector<int> retval;
+  retval.reserve(names.size());
+  for(const QString& name : names)
+    retval.append(classifyName(name, flags));
+  return retval;
+}
+
 bool isNameClosed(const QString& airportName)
 {
-  return REGEXP_CLOSED.match(airportName.toUpper()).hasMatch();
+  return classifyName(airportName, NAME_CLOSED) & NAME_CLOSED;
 }
 
 bool isNameMilitary(const QString& airportName)
 {
-  // Check if airport is military
-  for(const QRegularExpression& s : REGEXP_MIL)
-  {
-    if(s.match(airportName.toUpper()).hasMatch())
-      return true;
-  }
-  return false;
+  return classifyName(airportName, NAME_MILITARY) & NAME_MILITARY;
 }
 
 QString capNavString(const QString& str)
 {
-  if(str.contains(REGEXP_DIGIT) && !str.contains(REGEXP_WHITESPACE))
+  bool hasDigit = false, hasSpace = false;
+  for(QChar c : str)
+  {
+    hasDigit |= isAsciiDigit(c.unicode());
+    hasSpace |= isAsciiSpace(c.unicode());
+  }
+
+  if(hasDigit && !hasSpace)
     // Do not capitalize words that contains numbers but not spaces (airspace names)
     return str;
 
@@ -429,9 +556,9 @@ QString capAirportName(const QString& str)
 
 QString adjustFsxUserWpName(QString name, int length)
 {
-  static const QRegularExpression NAME_REGEXP("[^A-Za-z0-9_ ]");
-  name.replace(NAME_REGEXP, "");
-  name = name.left(length);
+  name = filterChars(name, [](ushort c) -> bool {
+          return isWordChar(c) || c == ' ';
+        }).left(length);
   if(name.isEmpty())
     name = "User_WP";
   return name;
@@ -439,8 +566,7 @@ QString adjustFsxUserWpName(QString name, int length)
 
 QString adjustIdent(QString ident, int length, int id)
 {
-  static const QRegularExpression IDENT_REGEXP("[^A-Z0-9]");
-  ident = ident.toUpper().replace(IDENT_REGEXP, "").left(length);
+  ident = filterChars(ident.toUpper(), isUpperOrDigit).left(length);
   if(ident.isEmpty() && id != -1)
     ident = QString("N%1").arg(id, 4, 36, QChar('0')).left(length);
   return ident.toUpper();
@@ -448,8 +574,7 @@ QString adjustIdent(QString ident, int length, int id)
 
 QString adjustRegion(QString region)
 {
-  static const QRegularExpression IDENT_REGEXP("[^A-Z0-9]");
-  region = region.toUpper().replace(IDENT_REGEXP, "").left(2);
+  region = filterChars(region.toUpper(), isUpperOrDigit).left(2);
   if(region.length() != 2)
     region = "ZZ";
   return region.toUpper();
@@ -457,19 +582,33 @@ QString adjustRegion(QString region)
 
 bool isValidIdent(const QString& ident)
 {
-  static const QRegularExpression IDENT_REGEXP("^[A-Z0-9]{1,5}$");
-  return IDENT_REGEXP.match(ident).hasMatch();
+  if(ident.isEmpty() || ident.size() > 5)
+    return false;
+
+  for(QChar c : ident)
+  {
+    if(!isUpperOrDigit(c.unicode()))
+      return false;
+  }
+  return true;
 }
 
 bool isValidRegion(const QString& region)
 {
-  static const QRegularExpression REGION_REGEXP("^[A-Z0-9]$");
-  return REGION_REGEXP.match(region).hasMatch();
+  return region.size() == 1 && isUpperOrDigit(region.at(0).unicode());
 }
 
 bool speedAndAltitudeMatch(const QString& item)
 {
-  return REGEXP_SPDALT_ALL.match(item).hasMatch();
+  // Same as ^([NMK])(\\d{3,4})([FSAM])(\\d{3,4})$
+  char unit;
+  int value;
+  int speedLen = parseUnitValue(item, 0, "NMK", 3, unit, value);
+  if(speedLen == 0)
+    return false;
+
+  int altLen = parseUnitValue(item, speedLen, "FSAM", 3, unit, value);
+  return altLen > 0 && speedLen + altLen == item.size();
 }
 
 bool extractSpeedAndAltitude(const QString& item, float& speedKnots, float& altFeet, bool *speedOk, bool *altitudeOk)
@@ -490,34 +629,37 @@ bool extractSpeedAndAltitude(const QString& item, float& speedKnots, float& altF
   speedKnots = 0.f;
   altFeet = 0.f;
 
-  // const static QRegularExpression SPDALT(""^([NMK])(\\d{3,4})(([FSAM])(\\d{3,4}))?$"");
-  QRegularExpressionMatch match = REGEXP_SPDALT.match(item);
-  if(match.hasMatch())
-  {
-    QString speedUnit = match.captured(1);
-    float speed = match.captured(2).toFloat(&spdOk);
+  // Same as ^([NMK])(\\d{2,4})(([FSAM])(\\d{2,4}))?$
+  char speedUnit = '\0', altUnit = '\0';
+  int speedValue = 0, altValue = 0;
+  int speedLen = parseUnitValue(item, 0, "NMK", 2, speedUnit, speedValue);
+  int altLen = 0;
+  if(speedLen > 0 && speedLen < item.size())
+    altLen = parseUnitValue(item, speedLen, "FSAM", 2, altUnit, altValue);
 
-    QString altUnit = match.captured(4);
-    float alt = match.captured(5).toFloat(&altOk);
+  if(speedLen > 0 && speedLen + altLen == item.size())
+  {
+    float speed = static_cast<float>(speedValue);
+    float alt = static_cast<float>(altValue);
 
     // Altitude ==============================
-    if(altUnit == "F") // Flight Level
+    if(altUnit == 'F') // Flight Level
       altFeet = alt >= 1000.f ? alt : alt * 100.f;
-    else if(altUnit == "S") // Standard Metric Level in tens of meters
+    else if(altUnit == 'S') // Standard Metric Level in tens of meters
       altFeet = atools::geo::meterToFeet(alt * 10.f);
-    else if(altUnit == "A") // Altitude in hundreds of feet
+    else if(altUnit == 'A') // Altitude in hundreds of feet
       altFeet = alt >= 1000.f ? alt : alt * 100.f;
-    else if(altUnit == "M") // Altitude in tens of meters
+    else if(altUnit == 'M') // Altitude in tens of meters
       altFeet = atools::geo::meterToFeet(alt * 10.f);
     else
       altOk = false;
 
     // Speed ==============================
-    if(speedUnit == "K") // km/h
+    if(speedUnit == 'K') // km/h
       speedKnots = atools::geo::meterToNm(speed * 1000.f);
-    else if(speedUnit == "N") // knots
+    else if(speedUnit == 'N') // knots
       speedKnots = speed;
-    else if(speedUnit == "M") // mach
+    else if(speedUnit == 'M') // mach
       speedKnots = atools::geo::machToTasFromAlt(altFeet, speed / 100.f);
     else
       spdOk = false;
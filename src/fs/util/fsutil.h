@@ -19,6 +19,9 @@
 #define ATOOLS_FS_FSUTIL_H
 
 #include <QString>
+#include <QVector>
+
+class QStringList;
 
 namespace atools {
 namespace fs {
@@ -36,6 +39,21 @@ int calculateAirportRating(bool isAddon, bool hasTower, int numTaxiPaths, int nu
 /* Calculate for X-Plane based on airport facilities */
 int calculateAirportRatingXp(bool isAddon, bool is3D, bool hasTower, int numTaxiPaths, int numParkings, int numAprons);
 
+/* Flags for classifyName */
+enum NameFlag
+{
+  NAME_NONE = 0,
+  NAME_MILITARY = 1 << 0, /* Contains military designator like "AFB" */
+  NAME_CLOSED = 1 << 1 /* Contains "[X]", "CLSD" or "CLOSED" */
+};
+
+/* Scans the name once and returns all matching NameFlag values which are requested in flags.
+ * Faster than calling isNameMilitary and isNameClosed separately. */
+int classifyName(const QString& name, int flags = NAME_MILITARY | NAME_CLOSED);
+
+/* Classify many names. Result contains the NameFlag values for each name in the same order. */
+QVector<int> classifyNames(const QStringList& names, int flags = NAME_MILITARY | NAME_CLOSED);
+
 /* Check the airport name if it contains military designators */
 bool isNameMilitary(const QString& airportName);
 
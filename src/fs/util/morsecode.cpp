@@ -67,31 +67,54 @@ const QHash<QChar, QString> CODES {
 MorseCode::MorseCode(const QString& signSeparator, const QString& charSeparator)
   : signSep(signSeparator), charSep(charSeparator)
 {
+  // Insert sign separators once for all characters
+  for(auto it = CODES.constBegin(); it != CODES.constEnd(); ++it)
+  {
+    QString codeStr;
+    for(QChar cc : it.value())
+    {
+      if(!codeStr.isEmpty())
+        codeStr.append(signSep);
+      codeStr.append(cc);
+    }
+    charCodes[it.key().unicode()] = codeStr;
+  }
 }
 
 MorseCode::~MorseCode()
 {
 }
 
+const QString& MorseCode::charCode(QChar c) const
+{
+  static const QString EMPTY;
+
+  ushort code = c.unicode();
+  if(code >= 'a' && code <= 'z')
+    code = static_cast<ushort>(code - 'a' + 'A');
+  else if(code >= 128)
+    code = c.toUpper().unicode();
+
+  return code < 128 ? charCodes[code] : EMPTY;
+}
+
 QString MorseCode::getCode(const QString& text)
 {
-  QString txt = text.toUpper();
-  QString retval;
+  QHash<QString, QString>::const_iterator it = cache.constFind(text);
+  if(it != cache.constEnd())
+    return it.value();
 
-  for(QChar c : txt)
+  QString retval;
+  for(QChar c : text)
   {
-    QString codeStr;
-    QString code = CODES.value(c);
-    for(QChar cc : code)
-    {
-      if(!codeStr.isEmpty())
-        codeStr.append(signSep);
-      codeStr.append(cc);
-    }
     if(!retval.isEmpty())
       retval.append(charSep);
-    retval.append(codeStr);
+    retval.append(charCode(c));
   }
+
+  if(cache.size() >= MAX_CACHE_SIZE)
+    cache.clear();
+  cache.insert(text, retval);
   return retval;
 }
 
@@ -18,6 +18,7 @@
 #ifndef ATOOLS_FS_UTIL_MORSECODE_H
 #define ATOOLS_FS_UTIL_MORSECODE_H
 
+#include <QHash>
 #include <QString>
 
 namespace atools {
@@ -26,6 +27,9 @@ namespace util {
 
 /*
  * Converts strings to a morse code string.
+ *
+ * Codes including separators are prepared for each character on construction and results are cached.
+ * Repeated calls for the same ident are a hash lookup. Not thread safe.
  */
 class MorseCode
 {
@@ -39,8 +43,25 @@ public:
 
   QString getCode(const QString& text);
 
+  /* Remove all cached results */
+  void clearCache()
+  {
+    cache.clear();
+  }
+
 private:
+  /* Code with sign separators for ASCII character or empty string if there is no code */
+  const QString& charCode(QChar c) const;
+
+  /* Number of cached results before the cache is cleared */
+  static const int MAX_CACHE_SIZE = 2000;
+
   QString signSep, charSep;
+
+  /* Codes with sign separators indexed by ASCII upper case character */
+  QString charCodes[128];
+
+  QHash<QString, QString> cache;
 };
 
 } // namespace util
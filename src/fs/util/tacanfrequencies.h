@@ -24,10 +24,17 @@ namespace atools {
 namespace fs {
 namespace util {
 
-/* VOR frequency for TACAN DME multiplied by 100 and vice versa */
+/* VOR frequency for TACAN DME multiplied by 100 and vice versa. Channel is like "17X" or "017Y".
+ * Returns 0 or an empty string if not found. */
 int frequencyForTacanChannel(const QString& channel);
 QString tacanChannelForFrequency(int frequency);
 
+/* Same as above using channel number 1-126 and band. Lookups are done in constant tables. */
+int frequencyForTacanChannel(int channel, bool yBand);
+
+/* Returns false if frequency has no TACAN channel */
+bool tacanChannelForFrequency(int frequency, int& channel, bool& yBand);
+
 } // namespace util
 } // namespace fs
 } // namespace atools
@@ -0,0 +1,183 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/weather/metarbulkdecoder.h"
+
+#include "fs/weather/metarscanner.h"
+
+#include <QRunnable>
+#include <QThread>
+
+#include <algorithm>
+
+namespace atools {
+namespace fs {
+namespace weather {
+
+/* Number of METARs decoded by one task */
+const static int CHUNK_SIZE = 512;
+
+const static float MPS_TO_KT = static_cast<float>(3600. / atools::geo::nmToMeter(1.));
+
+/* Decodes a range of METARs */
+class MetarDecodeTask :
+  public QRunnable
+{
+public:
+  MetarDecodeTask(const QVector<MetarBulkInput> *metarList, QVector<DecodedMetar> *resultList,
+                  int beginIndex, int endIndex, MetarBulkDecoder *bulkDecoder = nullptr)
+    : metars(metarList), results(resultList), begin(beginIndex), end(endIndex), decoder(bulkDecoder)
+  {
+    setAutoDelete(true);
+  }
+
+  virtual void run() override
+  {
+    for(int i = begin; i < end; i++)
+    {
+      if(decoder != nullptr && decoder->aborted.load() != 0)
+        break;
+      MetarBulkDecoder::decode((*results)[i], metars->at(i));
+    }
+
+    if(decoder != nullptr)
+      decoder->taskFinished();
+  }
+
+private:
+  const QVector<MetarBulkInput> *metars;
+  QVector<DecodedMetar> *results;
+  int begin, end;
+  MetarBulkDecoder *decoder;
+};
+
+MetarBulkDecoder::MetarBulkDecoder(QObject *parent, int numThreads)
+  : QObject(parent)
+{
+  threadPool.setMaxThreadCount(numThreads < 1 ? QThread::idealThreadCount() : numThreads);
+}
+
+MetarBulkDecoder::~MetarBulkDecoder()
+{
+  cancel();
+}
+
+void MetarBulkDecoder::start(const QVector<MetarBulkInput>& metars)
+{
+  cancel();
+
+  input = metars;
+  results.clear();
+  results.resize(input.size());
+  aborted.store(0);
+
+  if(input.isEmpty())
+  {
+    emit decodingFinished();
+    return;
+  }
+
+  // Set counter before the first task can finish
+  pendingTasks.store((input.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+  for(int begin = 0; begin < input.size(); begin += CHUNK_SIZE)
+    threadPool.start(new MetarDecodeTask(&input, &results, begin, std::min(begin + CHUNK_SIZE, input.size()), this));
+}
+
+void MetarBulkDecoder::cancel()
+{
+  aborted.store(1);
+  threadPool.waitForDone();
+  pendingTasks.store(0);
+}
+
+void MetarBulkDecoder::taskFinished()
+{
+  if(pendingTasks.fetchAndAddOrdered(-1) == 1 && aborted.load() == 0)
+    emit decodingFinished();
+}
+
+void MetarBulkDecoder::decode(QVector<DecodedMetar>& results, const QVector<MetarBulkInput>& metars, int numThreads)
+{
+  results.clear();
+  results.resize(metars.size());
+
+  int threads = std::min(numThreads < 1 ? QThread::idealThreadCount() : numThreads,
+                         (metars.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+  if(threads > 1)
+  {
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(threads);
+    for(int begin = 0; begin < metars.size(); begin += CHUNK_SIZE)
+      threadPool.start(new MetarDecodeTask(&metars, &results, begin, std::min(begin + CHUNK_SIZE, metars.size())));
+    threadPool.waitForDone();
+  }
+  else
+  {
+    // Avoid thread overhead for small lists
+    for(int i = 0; i < metars.size(); i++)
+      decode(results[i], metars.at(i));
+  }
+}
+
+void MetarBulkDecoder::decode(DecodedMetar& result, const MetarBulkInput& metar)
+{
+  result = DecodedMetar();
+  result.ident = metar.ident;
+  result.pos = metar.pos;
+
+  MetarScanResult scan;
+  if(!MetarScanner::scan(scan, metar.metar))
+    return;
+
+  result.flightRules = scan.flightRules;
+  result.maxCoverage = scan.maxCoverage;
+  result.visibilityMeter = scan.cavok ? 10000.f : scan.visibilityMeter;
+
+  if(scan.windSpeedMeterPerSec < INVALID_METAR_VALUE)
+  {
+    result.windDir = scan.prevailingWindDir;
+    result.windSpeedKts = scan.windSpeedMeterPerSec * MPS_TO_KT;
+
+    if(result.windDir >= 0)
+    {
+      // Wind blows to the opposite direction
+      float dir = atools::geo::opposedCourseDeg(static_cast<float>(result.windDir));
+      result.windX = result.windSpeedKts * atools::geo::sinDeg(dir);
+      result.windY = result.windSpeedKts * atools::geo::cosDeg(dir);
+    }
+  }
+
+  if(scan.gustSpeedMeterPerSec < INVALID_METAR_VALUE)
+    result.gustSpeedKts = scan.gustSpeedMeterPerSec * MPS_TO_KT;
+
+  float ceilingMeter = scan.vertVisibilityMeter;
+  for(int i = 0; i < scan.numClouds; i++)
+  {
+    const MetarScanCloud& cloud = scan.clouds[i];
+    if(cloud.coverage == MetarCloud::COVERAGE_BROKEN || cloud.coverage == MetarCloud::COVERAGE_OVERCAST)
+      ceilingMeter = std::min(ceilingMeter, cloud.altitudeMeter);
+  }
+
+  if(ceilingMeter < INVALID_METAR_VALUE)
+    result.ceilingFt = atools::geo::meterToFeet(ceilingMeter);
+
+  result.valid = true;
+}
+
+} // namespace weather
+} // namespace fs
+} // namespace atools
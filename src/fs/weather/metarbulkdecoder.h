@@ -0,0 +1,121 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_WEATHER_METARBULKDECODER_H
+#define ATOOLS_FS_WEATHER_METARBULKDECODER_H
+
+#include "fs/weather/metarparser.h"
+#include "geo/pos.h"
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QThreadPool>
+
+namespace atools {
+namespace fs {
+namespace weather {
+
+/* Raw METAR and station position for bulk decoding */
+struct MetarBulkInput
+{
+  QString ident, metar;
+  atools::geo::Pos pos;
+};
+
+/* Compact decoded METAR for map overlays */
+struct DecodedMetar
+{
+  QString ident;
+  atools::geo::Pos pos;
+
+  MetarParser::FlightRules flightRules = MetarParser::UNKNOWN;
+  MetarCloud::Coverage maxCoverage = MetarCloud::COVERAGE_NIL;
+
+  /* Direction the wind is coming from in degrees true. -1 if variable or not available. */
+  int windDir = -1;
+  float windSpeedKts = INVALID_METAR_VALUE, gustSpeedKts = INVALID_METAR_VALUE;
+
+  /* Wind vector in knots pointing where the wind blows to. X is east and Y is north. 0 if variable. */
+  float windX = 0.f, windY = 0.f;
+
+  /* Lowest broken or overcast layer or vertical visibility */
+  float visibilityMeter = INVALID_METAR_VALUE, ceilingFt = INVALID_METAR_VALUE;
+
+  bool valid = false;
+};
+
+/*
+ * Decodes large numbers of METARs in a thread pool using MetarScanner.
+ *
+ * Use the static decode() for a blocking call or start() which returns immediately and emits
+ * decodingFinished() when all results are available.
+ */
+class MetarBulkDecoder :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  /* numThreads < 1 uses the ideal thread count */
+  explicit MetarBulkDecoder(QObject *parent = nullptr, int numThreads = 0);
+  virtual ~MetarBulkDecoder() override;
+
+  /* Decode in background. Cancels a running decoding. */
+  void start(const QVector<atools::fs::weather::MetarBulkInput>& metars);
+
+  /* Stop and wait for running threads. Does not emit decodingFinished(). */
+  void cancel();
+
+  bool isRunning() const
+  {
+    return pendingTasks.load() > 0;
+  }
+
+  /* Results in order of the input of the last start(). Valid after decodingFinished() if isRunning() is false. */
+  const QVector<atools::fs::weather::DecodedMetar>& getResults() const
+  {
+    return results;
+  }
+
+  /* Decode all METARs and block until done. Results are in order of the input. */
+  static void decode(QVector<atools::fs::weather::DecodedMetar>& results,
+                     const QVector<atools::fs::weather::MetarBulkInput>& metars, int numThreads = 0);
+
+  /* Decode a single METAR */
+  static void decode(atools::fs::weather::DecodedMetar& result, const atools::fs::weather::MetarBulkInput& metar);
+
+signals:
+  /* Emitted from a worker thread when the last METAR is decoded. Use a queued connection. */
+  void decodingFinished();
+
+private:
+  friend class MetarDecodeTask;
+
+  /* Called by tasks when their range is done */
+  void taskFinished();
+
+  QThreadPool threadPool;
+  QVector<atools::fs::weather::MetarBulkInput> input;
+  QVector<atools::fs::weather::DecodedMetar> results;
+  QAtomicInt pendingTasks, aborted;
+};
+
+} // namespace weather
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_WEATHER_METARBULKDECODER_H
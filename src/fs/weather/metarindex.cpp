@@ -0,0 +1,412 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/weather/metarindex.h"
+
+#include "fs/weather/weathertypes.h"
+
+#include <QDebug>
+#include <QStringList>
+
+#include <algorithm>
+#include <cmath>
+
+namespace atools {
+namespace fs {
+namespace weather {
+
+/* Stations closer than this are used without interpolation */
+const static float MIN_INTERPOLATION_DIST_METER = 1000.f;
+
+const static float KT_TO_MPS = static_cast<float>(atools::geo::nmToMeter(1.) / 3600.);
+
+MetarIndex::MetarIndex(int cacheSize)
+  : index(cacheSize)
+{
+}
+
+int MetarIndex::update(const QVector<MetarData>& metars)
+{
+  // Fetch coordinates of all new stations before touching the index
+  resolveCoords(metars);
+
+  QSet<QString> idents;
+  for(const MetarData& md : metars)
+    idents.insert(md.ident);
+
+  // Remove stations which are not in the list anymore
+  int numChanged = 0;
+  for(const QString& ident : index.keys())
+  {
+    if(!idents.contains(ident))
+    {
+      index.remove(ident);
+      scanCache.remove(ident);
+      numChanged++;
+    }
+  }
+
+  for(const MetarData& md : metars)
+  {
+    MetarData old;
+    if(index.value(old, md.ident) && old.metar == md.metar && old.timestamp == md.timestamp)
+      // Not changed - avoid rebuilding the spatial index
+      continue;
+
+    atools::geo::Pos pos = coordCache.value(md.ident);
+    if(pos.isValid())
+    {
+      index.insert(md.ident, md, pos);
+      scanCache.remove(md.ident);
+      numChanged++;
+    }
+  }
+  return numChanged;
+}
+
+void MetarIndex::insert(const MetarData& metar, const atools::geo::Pos& pos)
+{
+  if(pos.isValid())
+    coordCache.insert(metar.ident, pos);
+
+  atools::geo::Pos stationPos = airportCoords(metar.ident);
+  if(stationPos.isValid())
+  {
+    index.insert(metar.ident, metar, stationPos);
+    scanCache.remove(metar.ident);
+  }
+}
+
+void MetarIndex::clear()
+{
+  index.clear();
+  scanCache.clear();
+}
+
+MetarResult MetarIndex::getMetar(const QString& station, const geo::Pos& pos, int numInterpolate)
+{
+  MetarResult result;
+  result.requestIdent = station;
+  result.requestPos = pos;
+
+  MetarData data;
+  QString foundKey = index.getTypeOrNearest(data, station, pos);
+  if(!foundKey.isEmpty())
+  {
+    if(foundKey == station)
+      // Found exact match
+      result.metarForStation = data.metar;
+    else
+    {
+      // Found a station nearby
+      result.metarForNearest = data.metar;
+
+      MetarScanResult interpolated;
+      if(numInterpolate > 1 && getInterpolated(interpolated, pos, numInterpolate))
+        result.metarForInterpolated = buildMetar(interpolated, station.isEmpty() ? "XXXX" : station);
+    }
+  }
+
+  result.timestamp = QDateTime::currentDateTime();
+  return result;
+}
+
+QString MetarIndex::getMetar(const QString& station) const
+{
+  return index.value(station).metar;
+}
+
+bool MetarIndex::getScanned(MetarScanResult& result, const QString& station)
+{
+  auto it = scanCache.constFind(station);
+  if(it != scanCache.constEnd())
+  {
+    result = it.value();
+    return result.valid;
+  }
+
+  MetarData data;
+  if(!index.value(data, station))
+    return false;
+
+  MetarScanner::scan(result, data.metar);
+  scanCache.insert(station, result);
+  return result.valid;
+}
+
+bool MetarIndex::getInterpolated(MetarScanResult& result, const geo::Pos& pos, int num, float maxDistanceMeter)
+{
+  MetarScanResult nearest;
+  bool hasNearest = false;
+
+  // Weighted sums and sum of weights for each value
+  double temp = 0., tempW = 0., dew = 0., dewW = 0., press = 0., pressW = 0., vis = 0., visW = 0.;
+  double windU = 0., windV = 0., speed = 0., windW = 0., gust = 0., gustW = 0.;
+
+  for(const QString& ident : index.getNearest(pos, num))
+  {
+    float dist = pos.distanceMeterTo(coordCache.value(ident));
+    if(dist > maxDistanceMeter)
+      break;
+
+    MetarScanResult scan;
+    if(!getScanned(scan, ident))
+      continue;
+
+    if(!hasNearest)
+    {
+      nearest = scan;
+      hasNearest = true;
+
+      if(dist < MIN_INTERPOLATION_DIST_METER)
+        // Station is at the position
+        break;
+    }
+
+    // Inverse distance weighting
+    double weight = 1. / (static_cast<double>(dist) * dist);
+
+    if(scan.temperatureC < INVALID_METAR_VALUE)
+      temp += weight * scan.temperatureC, tempW += weight;
+    if(scan.dewpointC < INVALID_METAR_VALUE)
+      dew += weight * scan.dewpointC, dewW += weight;
+    if(scan.pressureMbar < INVALID_METAR_VALUE)
+      press += weight * scan.pressureMbar, pressW += weight;
+
+    float visibility = scan.cavok ? 10000.f : scan.visibilityMeter;
+    if(visibility < INVALID_METAR_VALUE)
+      vis += weight * visibility, visW += weight;
+
+    if(scan.windSpeedMeterPerSec < INVALID_METAR_VALUE)
+    {
+      speed += weight * scan.windSpeedMeterPerSec;
+      if(scan.prevailingWindDir >= 0)
+      {
+        // Sum up wind vectors for the direction
+        double dir = scan.prevailingWindDir;
+        windU += weight * scan.windSpeedMeterPerSec * atools::geo::sinDeg(dir);
+        windV += weight * scan.windSpeedMeterPerSec * atools::geo::cosDeg(dir);
+      }
+      windW += weight;
+    }
+
+    if(scan.gustSpeedMeterPerSec < INVALID_METAR_VALUE)
+      gust += weight * scan.gustSpeedMeterPerSec, gustW += weight;
+  }
+
+  if(!hasNearest)
+    return false;
+
+  // Clouds, weather, station and time from nearest
+  result = nearest;
+  if(tempW > 0.)
+    result.temperatureC = static_cast<float>(temp / tempW);
+  if(dewW > 0.)
+    result.dewpointC = static_cast<float>(dew / dewW);
+  if(pressW > 0.)
+    result.pressureMbar = static_cast<float>(press / pressW);
+  if(visW > 0.)
+  {
+    result.visibilityMeter = static_cast<float>(vis / visW);
+    result.cavok = result.cavok && result.visibilityMeter >= 10000.f;
+  }
+
+  if(windW > 0.)
+  {
+    result.windSpeedMeterPerSec = static_cast<float>(speed / windW);
+    if(std::abs(windU) > 0. || std::abs(windV) > 0.)
+    {
+      double dir = atools::geo::normalizeCourse(atools::geo::atan2Deg(windU, windV));
+      result.windDir = static_cast<int>(std::round(dir)) % 360;
+    }
+    else
+      result.windDir = -1;
+    result.windRangeFrom = result.windRangeTo = -1;
+  }
+  result.gustSpeedMeterPerSec = gustW > 0. ? static_cast<float>(gust / gustW) : INVALID_METAR_VALUE;
+
+  // Rescan to update flight rules and other derived values
+  return MetarScanner::scan(result, buildMetar(result, QString(result.station)));
+}
+
+QString MetarIndex::buildMetar(const MetarScanResult& result, const QString& ident)
+{
+  QStringList metar;
+  metar.append(ident);
+
+  if(result.day >= 0 && result.hour >= 0 && result.minute >= 0)
+    metar.append(QString("%1%2%3Z").
+                 arg(result.day, 2, 10, QChar('0')).
+                 arg(result.hour, 2, 10, QChar('0')).
+                 arg(result.minute, 2, 10, QChar('0')));
+
+  if(result.windSpeedMeterPerSec < INVALID_METAR_VALUE)
+  {
+    QString wind = result.windDir < 0 ? "VRB" : QString("%1").arg(result.windDir, 3, 10, QChar('0'));
+    wind += QString("%1").arg(static_cast<int>(std::round(result.windSpeedMeterPerSec / KT_TO_MPS)), 2, 10,
+                              QChar('0'));
+    if(result.gustSpeedMeterPerSec < INVALID_METAR_VALUE)
+      wind += QString("G%1").arg(static_cast<int>(std::round(result.gustSpeedMeterPerSec / KT_TO_MPS)), 2, 10,
+                                 QChar('0'));
+    metar.append(wind + "KT");
+  }
+
+  if(result.cavok)
+    metar.append("CAVOK");
+  else if(result.visibilityMeter < INVALID_METAR_VALUE)
+    metar.append(QString("%1").arg(std::min(static_cast<int>(std::round(result.visibilityMeter)), 9999), 4, 10,
+                                   QChar('0')));
+
+  // Present weather ===================
+  int wx = result.weather;
+  QString precip;
+  if(wx & WEATHER_FREEZING)
+    precip += "FZ";
+  if(wx & WEATHER_SHOWER)
+    precip += "SH";
+  if(wx & WEATHER_THUNDERSTORM)
+    precip += "TS";
+  if(wx & WEATHER_DRIZZLE)
+    precip += "DZ";
+  if(wx & WEATHER_RAIN)
+    precip += "RA";
+  if(wx & WEATHER_SNOW)
+    precip += "SN";
+  if(wx & WEATHER_ICE)
+    precip += "IC";
+  if(wx & WEATHER_HAIL)
+    precip += "GR";
+
+  if(precip == "FZ" || precip == "SH" || precip == "FZSH")
+    // Descriptor without phenomenon is not valid
+    precip.clear();
+
+  if(!precip.isEmpty())
+  {
+    if(result.intensity == MetarParser::LIGHT)
+      precip.prepend('-');
+    else if(result.intensity == MetarParser::HEAVY)
+      precip.prepend('+');
+    metar.append(precip);
+  }
+  if(wx & WEATHER_FOG)
+    metar.append("FG");
+  if(wx & WEATHER_MIST)
+    metar.append("BR");
+  if(wx & WEATHER_HAZE)
+    metar.append("HZ");
+  if(wx & WEATHER_SQUALL)
+    metar.append("SQ");
+
+  // Clouds ===================
+  for(int i = 0; i < result.numClouds; i++)
+  {
+    const MetarScanCloud& cloud = result.clouds[i];
+    QString cov;
+    switch(cloud.coverage)
+    {
+      case MetarCloud::COVERAGE_NIL:
+        break;
+
+      case MetarCloud::COVERAGE_CLEAR:
+        cov = "CLR";
+        break;
+
+      case MetarCloud::COVERAGE_FEW:
+        cov = "FEW";
+        break;
+
+      case MetarCloud::COVERAGE_SCATTERED:
+        cov = "SCT";
+        break;
+
+      case MetarCloud::COVERAGE_BROKEN:
+        cov = "BKN";
+        break;
+
+      case MetarCloud::COVERAGE_OVERCAST:
+        cov = "OVC";
+        break;
+    }
+
+    if(cov.isEmpty())
+      continue;
+
+    if(cloud.coverage != MetarCloud::COVERAGE_CLEAR)
+    {
+      if(cloud.altitudeMeter < INVALID_METAR_VALUE)
+        cov += QString("%1").arg(static_cast<int>(std::round(atools::geo::meterToFeet(cloud.altitudeMeter) / 100.f)),
+                                 3, 10, QChar('0'));
+      else
+        cov += "///";
+    }
+    metar.append(cov);
+  }
+
+  if(result.vertVisibilityMeter < INVALID_METAR_VALUE)
+    metar.append(QString("VV%1").arg(static_cast<int>(std::round(atools::geo::meterToFeet(result.vertVisibilityMeter) /
+                                                                 100.f)), 3, 10, QChar('0')));
+
+  // Temperature and pressure ===================
+  if(result.temperatureC < INVALID_METAR_VALUE)
+  {
+    int t = static_cast<int>(std::round(result.temperatureC));
+    QString temp = QString("%1%2/").arg(t < 0 ? "M" : "").arg(std::abs(t), 2, 10, QChar('0'));
+    if(result.dewpointC < INVALID_METAR_VALUE)
+    {
+      int d = static_cast<int>(std::round(result.dewpointC));
+      temp += QString("%1%2").arg(d < 0 ? "M" : "").arg(std::abs(d), 2, 10, QChar('0'));
+    }
+    metar.append(temp);
+  }
+
+  if(result.pressureMbar < INVALID_METAR_VALUE)
+    metar.append(QString("Q%1").arg(static_cast<int>(std::round(result.pressureMbar)), 4, 10, QChar('0')));
+
+  return metar.join(" ");
+}
+
+void MetarIndex::resolveCoords(const QVector<MetarData>& metars)
+{
+  int numFetched = 0;
+  for(const MetarData& md : metars)
+  {
+    if(!coordCache.contains(md.ident))
+    {
+      coordCache.insert(md.ident, fetchAirportCoords ? fetchAirportCoords(md.ident) : atools::geo::Pos());
+      numFetched++;
+    }
+  }
+
+  if(numFetched > 0)
+    qDebug() << Q_FUNC_INFO << "Fetched coordinates for" << numFetched << "stations";
+}
+
+atools::geo::Pos MetarIndex::airportCoords(const QString& ident)
+{
+  auto it = coordCache.constFind(ident);
+  if(it != coordCache.constEnd())
+    return it.value();
+
+  atools::geo::Pos pos = fetchAirportCoords ? fetchAirportCoords(ident) : atools::geo::Pos();
+  coordCache.insert(ident, pos);
+  return pos;
+}
+
+} // namespace weather
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,133 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_WEATHER_METARINDEX_H
+#define ATOOLS_FS_WEATHER_METARINDEX_H
+
+#include "fs/weather/metarscanner.h"
+#include "geo/simplespatialindex.h"
+
+#include <QDateTime>
+#include <QSet>
+
+#include <functional>
+
+namespace atools {
+namespace fs {
+namespace weather {
+
+struct MetarResult;
+
+/* METAR string of a station */
+struct MetarData
+{
+  QString ident, metar;
+  QDateTime timestamp;
+};
+
+/*
+ * Spatial index of METAR strings shared by the weather readers for downloaded files and X-Plane.
+ *
+ * Station coordinates are resolved once for all new stations of an update and kept for later updates.
+ * METARs are scanned lazily using MetarScanner and the results are cached until the station changes.
+ * Allows station, nearest and interpolated lookups.
+ */
+class MetarIndex
+{
+public:
+  /* cacheSize is the size of the nearest cache of the spatial index */
+  explicit MetarIndex(int cacheSize = 5000);
+
+  /* Replace all METARs by the given list. Unchanged stations are kept and stations which are not in the list
+   * are removed. Returns number of changed stations. */
+  int update(const QVector<atools::fs::weather::MetarData>& metars);
+
+  /* Add or replace a single METAR. Uses pos if valid. Otherwise station coordinates are resolved. */
+  void insert(const atools::fs::weather::MetarData& metar, const atools::geo::Pos& pos = atools::geo::Pos());
+
+  /* Remove all METARs. Keeps the station coordinates. */
+  void clear();
+
+  /* Get METAR for the station, the nearest station and an interpolated METAR built from the
+   * numInterpolate nearest stations if the station has no report. No interpolation if numInterpolate < 2. */
+  atools::fs::weather::MetarResult getMetar(const QString& station, const atools::geo::Pos& pos,
+                                            int numInterpolate = 0);
+
+  /* METAR string for station or empty if not found */
+  QString getMetar(const QString& station) const;
+
+  /* Scanned METAR for station. Returns false if not found or not valid. Cached until the station changes. */
+  bool getScanned(atools::fs::weather::MetarScanResult& result, const QString& station);
+
+  /* Values interpolated by inverse distance weighting from the num nearest stations within maxDistanceMeter.
+   * Clouds and weather are taken from the nearest station. Returns false if no station was found. */
+  bool getInterpolated(atools::fs::weather::MetarScanResult& result, const atools::geo::Pos& pos, int num,
+                       float maxDistanceMeter = atools::geo::nmToMeter(200.f));
+
+  /* Build a METAR string from scanned values using the given ident */
+  static QString buildMetar(const atools::fs::weather::MetarScanResult& result, const QString& ident);
+
+  /* Get all ICAO codes that have a weather station */
+  QSet<QString> getIdents() const
+  {
+    return index.keys().toSet();
+  }
+
+  /* Coordinates of a station in the index or an invalid position */
+  atools::geo::Pos getPosition(const QString& station) const
+  {
+    return index.contains(station) ? coordCache.value(station) : atools::geo::Pos();
+  }
+
+  bool isEmpty() const
+  {
+    return index.isEmpty();
+  }
+
+  int size() const
+  {
+    return index.size();
+  }
+
+  /* Set to a function that returns the coordinates for an airport ident. Clears the coordinate cache. */
+  void setFetchAirportCoords(const std::function<atools::geo::Pos(const QString&)>& value)
+  {
+    fetchAirportCoords = value;
+    coordCache.clear();
+  }
+
+private:
+  /* Resolve coordinates for all idents not in the cache */
+  void resolveCoords(const QVector<atools::fs::weather::MetarData>& metars);
+  atools::geo::Pos airportCoords(const QString& ident);
+
+  atools::geo::SimpleSpatialIndex<QString, atools::fs::weather::MetarData> index;
+
+  /* Lazily filled scanner results by ident */
+  QHash<QString, atools::fs::weather::MetarScanResult> scanCache;
+
+  /* Coordinates are fetched only once per airport ident */
+  QHash<QString, atools::geo::Pos> coordCache;
+
+  std::function<atools::geo::Pos(const QString&)> fetchAirportCoords;
+};
+
+} // namespace weather
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_WEATHER_METARINDEX_H
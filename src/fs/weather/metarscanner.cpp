@@ -0,0 +1,808 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/weather/metarscanner.h"
+
+#include <QByteArray>
+#include <QStringRef>
+
+#include <algorithm>
+
+namespace atools {
+namespace fs {
+namespace weather {
+
+/* Minimum number of recognized groups for a valid report - same as MetarParser */
+const static int MIN_GROUPS = 4;
+
+const static float MI_TO_METER = 1609.3412f;
+
+void MetarScanResult::clear()
+{
+  station[0] = '\0';
+  day = hour = minute = -1;
+  windDir = windRangeFrom = windRangeTo = -1;
+  windSpeedMeterPerSec = gustSpeedMeterPerSec = INVALID_METAR_VALUE;
+  visibilityMeter = vertVisibilityMeter = INVALID_METAR_VALUE;
+  cavok = false;
+  temperatureC = dewpointC = pressureMbar = INVALID_METAR_VALUE;
+  numClouds = 0;
+  weather = WEATHER_NONE;
+  intensity = MetarParser::NIL;
+  flightRules = MetarParser::UNKNOWN;
+  maxCoverage = lowestCoverage = MetarCloud::COVERAGE_CLEAR;
+  prevailingWindDir = -1;
+  prevailingWindSpeedMeterPerSec = INVALID_METAR_VALUE;
+  valid = false;
+}
+
+namespace {
+
+inline char toChar(char c)
+{
+  return c;
+}
+
+inline char toChar(QChar c)
+{
+  return c.toLatin1();
+}
+
+inline bool isSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline bool isDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+inline bool isAlpha(char c)
+{
+  return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+/* Scanner for one report. Tokens are pointer and length into the borrowed buffer. */
+template<typename CHAR>
+class Scanner
+{
+public:
+  Scanner(MetarScanResult& scanResult, const CHAR *data, int length)
+    : result(scanResult), cur(data), end(data + length)
+  {
+  }
+
+  bool scan();
+
+private:
+  enum Stage
+  {
+    STAGE_WIND,
+    STAGE_VARIABILITY,
+    STAGE_VISIBILITY,
+    STAGE_RVR,
+    STAGE_WEATHER,
+    STAGE_SKY,
+    STAGE_TEMPERATURE,
+    STAGE_PRESSURE,
+    STAGE_DONE
+  };
+
+  bool nextToken();
+  bool peekToken(const CHAR *& start, int& length) const;
+  bool scanStage(int stage);
+
+  bool scanWind();
+  bool scanVariability();
+  bool scanVisibility();
+  bool scanRwyVisRange();
+  bool scanWeather();
+  bool scanSkyCondition();
+  bool scanTemperature();
+  bool scanPressure();
+  bool isEndOfObservation() const;
+
+  void addVisibility(float meter, int dir);
+  void postProcess();
+
+  char at(int i) const
+  {
+    return i < tokLen ? toChar(tok[i]) : '\0';
+  }
+
+  bool equals(const char *str) const;
+  bool startsWith(const char *str, int pos = 0) const;
+
+  /* Read exactly min to max digits at pos and advance pos */
+  bool number(int& pos, int& value, int min, int max = 0) const;
+
+  MetarScanResult& result;
+  const CHAR *cur, *end, *tok = nullptr;
+  int tokLen = 0, groups = 0;
+  float dirVisibility = INVALID_METAR_VALUE;
+};
+
+template<typename CHAR>
+bool Scanner<CHAR>::nextToken()
+{
+  while(cur < end && isSpace(toChar(*cur)))
+    cur++;
+
+  tok = cur;
+  while(cur < end && !isSpace(toChar(*cur)))
+    cur++;
+  tokLen = static_cast<int>(cur - tok);
+
+  // Report terminator
+  if(tokLen > 0 && toChar(tok[tokLen - 1]) == '=')
+  {
+    tokLen--;
+    end = cur;
+  }
+  return tokLen > 0;
+}
+
+template<typename CHAR>
+bool Scanner<CHAR>::peekToken(const CHAR *& start, int& length) const
+{
+  const CHAR *p = cur;
+  while(p < end && isSpace(toChar(*p)))
+    p++;
+  start = p;
+  while(p < end && !isSpace(toChar(*p)))
+    p++;
+  length = static_cast<int>(p - start);
+  return length > 0;
+}
+
+template<typename CHAR>
+bool Scanner<CHAR>::equals(const char *str) const
+{
+  int i = 0;
+  for(; str[i] != '\0'; i++)
+  {
+    if(at(i) != str[i])
+      return false;
+  }
+  return i == tokLen;
+}
+
+template<typename CHAR>
+bool Scanner<CHAR>::startsWith(const char *str, int pos) const
+{
+  for(int i = 0; str[i] != '\0'; i++)
+  {
+    if(at(pos + i) != str[i])
+      return false;
+  }
+  return true;
+}
+
+template<typename CHAR>
+bool Scanner<CHAR>::number(int& pos, int& value, int min, int max) const
+{
+  value = 0;
+  int i = 0;
+  for(; i < std::max(min, max) && isDigit(at(pos + i)); i++)
+    value = value * 10 + at(pos + i) - '0';
+
+  if(i < min)
+    return false;
+
+  pos += i;
+  return true;
+}
+
+template<typename CHAR>
+bool Scanner<CHAR>::scan()
+{
+  result.clear();
+
+  // Skip report type and preamble date "2018/11/20 10:50" from NOAA files
+  while(nextToken())
+  {
+    if(!(equals("METAR") || equals("SPECI") || (isDigit(at(0)) && (at(4) == '/' || at(2) == ':'))))
+      break;
+  }
+
+  // Station
+  if(tokLen < 3 || tokLen > 4)
+    return false;
+  for(int i = 0; i < tokLen; i++)
+  {
+    if(!(isAlpha(at(i)) || isDigit(at(i))))
+      return false;
+    result.station[i] = at(i);
+  }
+  result.station[tokLen] = '\0';
+  groups++;
+
+  if(!nextToken())
+    return false;
+
+  // Date and time \d{6}Z
+  int pos = 0;
+  if(tokLen == 7 && at(6) == 'Z' && number(pos, result.day, 2) && number(pos, result.hour, 2) &&
+     number(pos, result.minute, 2))
+  {
+    groups++;
+    if(!nextToken())
+      return false;
+  }
+
+  // Modifier
+  if(equals("NIL"))
+    return false;
+  else if(equals("AUTO") || equals("COR") || equals("CCA") || equals("RTD"))
+  {
+    groups++;
+    if(!nextToken())
+      return false;
+  }
+
+  int stage = STAGE_WIND;
+  do
+  {
+    if(isEndOfObservation())
+      break;
+
+    // Try groups in order of the report - unknown groups are skipped
+    for(int st = stage; st < STAGE_DONE; st++)
+    {
+      if(scanStage(st))
+      {
+        // Visibility, runway range, weather and sky conditions can repeat
+        bool repeat = st == STAGE_VISIBILITY || st == STAGE_RVR || st == STAGE_WEATHER || st == STAGE_SKY;
+        stage = repeat ? st : st + 1;
+        break;
+      }
+    }
+  } while(stage < STAGE_DONE && nextToken());
+
+  if(groups < MIN_GROUPS)
+    return false;
+
+  if(!(result.visibilityMeter < INVALID_METAR_VALUE))
+    // Use lowest directional visibility if no other is given
+    result.visibilityMeter = dirVisibility;
+
+  postProcess();
+  result.valid = true;
+  return true;
+}
+
+template<typename CHAR>
+bool Scanner<CHAR>::scanStage(int stage)
+{
+  switch(stage)
+  {
+    case STAGE_WIND:
+      return scanWind();
+
+    case STAGE_VARIABILITY:
+      return scanVariability();
+
+    case STAGE_VISIBILITY:
+      return scanVisibility();
+
+    case STAGE_RVR:
+      return scanRwyVisRange();
+
+    case STAGE_WEATHER:
+      return scanWeather();
+
+    case STAGE_SKY:
+      return scanSkyCondition();
+
+    case STAGE_TEMPERATURE:
+      return scanTemperature();
+
+    case STAGE_PRESSURE:
+      return scanPressure();
+  }
+  return false;
+}
+
+template<typename CHAR>
+bool Scanner<CHAR>::isEndOfObservation() const
+{
+  return equals("RMK") || equals("NOSIG") || equals("TEMPO") || equals("BECMG") || equals("INTER") ||
+         startsWith("PROB") || (startsWith("FM") && isDigit(at(2)));
+}
+
+// (\d{3}|VRB|///)(\d{2,3}|//)(G\d{2,3})?(KT|KMH|KPH|MPS)
+template<typename CHAR>
+bool Scanner<CHAR>::scanWind()
+{
+  int pos = 0, dir = -1, speed = -1, gust = -1;
+  if(startsWith("VRB") || startsWith("///"))
+    pos += 3;
+  else if(!number(pos, dir, 3))
+    return false;
+
+  if(startsWith("//", pos))
+    pos += 2;
+  else if(!number(pos, speed, 2, 3))
+    return false;
+
+  if(at(pos) == 'G')
+  {
+    pos++;
+    if(!number(pos, gust, 2, 3))
+      return false;
+  }
+
+  float factor;
+  if(startsWith("KT", pos))
+    pos += 2, factor = static_cast<float>(atools::geo::nmToMeter(1.) / 3600.);
+  else if(startsWith("KMH", pos) || startsWith("KPH", pos))
+    pos += 3, factor = 1000.f / 3600.f;
+  else if(startsWith("MPS", pos))
+    pos += 3, factor = 1.f;
+  else
+    return false;
+
+  if(pos != tokLen)
+    return false;
+
+  result.windDir = dir;
+  if(speed != -1)
+    result.windSpeedMeterPerSec = speed * factor;
+  if(gust != -1)
+    result.gustSpeedMeterPerSec = gust * factor;
+  groups++;
+  return true;
+}
+
+// \d{3}V\d{3}
+template<typename CHAR>
+bool Scanner<CHAR>::scanVariability()
+{
+  int pos = 0, from, to;
+  if(tokLen != 7 || !number(pos, from, 3) || at(pos++) != 'V' || !number(pos, to, 3))
+    return false;
+
+  result.windRangeFrom = from;
+  result.windRangeTo = to;
+  groups++;
+  return true;
+}
+
+template<typename CHAR>
+bool Scanner<CHAR>::scanVisibility()
+{
+  if(equals("////"))
+  {
+    groups++;
+    return true;
+  }
+
+  int pos = 0, value, dir = -1;
+
+  // \d{4}(NDV|N|NE|E|SE|S|SW|W|NW)?
+  if(tokLen >= 4 && number(pos, value, 4))
+  {
+    if(startsWith("NDV", pos))
+      pos += 3;
+    else if(pos < tokLen)
+    {
+      char c1 = at(pos), c2 = at(pos + 1);
+      if(c1 == 'N')
+        dir = c2 == 'E' ? 45 : (c2 == 'W' ? 315 : 0);
+      else if(c1 == 'S')
+        dir = c2 == 'E' ? 135 : (c2 == 'W' ? 225 : 180);
+      else if(c1 == 'E')
+        dir = 90;
+      else if(c1 == 'W')
+        dir = 270;
+      else
+        return false;
+      pos += (dir % 90) == 0 ? 1 : 2;
+    }
+
+    if(pos != tokLen)
+      return false;
+
+    if(value == 0)
+      value = 50;
+    else if(value == 9999)
+      value = 10000;
+    addVisibility(value, dir);
+    return true;
+  }
+
+  // M?(\d{1,2}|\d{1,2}/\d{1,2}|\d{1,2} \d{1,2}/\d{1,2})(SM|KM)
+  pos = 0;
+  if(at(pos) == 'M')
+    pos++;
+
+  if(!number(pos, value, 1, 2))
+    return false;
+
+  float distance = value;
+  if(pos == tokLen)
+  {
+    // Whole number followed by a fraction like "1 1/2SM"
+    const CHAR *next;
+    int nextLen;
+    if(!peekToken(next, nextLen))
+      return false;
+
+    const CHAR *savedTok = tok;
+    int savedLen = tokLen;
+    tok = next;
+    tokLen = nextLen;
+
+    int num, denom, p = 0;
+    bool ok = number(p, num, 1, 2) && at(p++) == '/' && number(p, denom, 1, 2) && denom > 0 &&
+              startsWith("SM", p) && p + 2 == tokLen;
+    if(!ok)
+    {
+      tok = savedTok;
+      tokLen = savedLen;
+      return false;
+    }
+
+    // Consume the fraction token
+    cur = next + nextLen;
+    addVisibility((distance + static_cast<float>(num) / denom) * MI_TO_METER, -1);
+    return true;
+  }
+
+  if(at(pos) == '/')
+  {
+    pos++;
+    int denom;
+    if(!number(pos, denom, 1, 2) || denom == 0)
+      return false;
+    distance /= denom;
+  }
+
+  if(startsWith("SM", pos))
+    distance *= MI_TO_METER;
+  else if(startsWith("KM", pos))
+    distance *= 1000.f;
+  else
+    return false;
+
+  if(pos + 2 != tokLen)
+    return false;
+
+  addVisibility(distance, -1);
+  return true;
+}
+
+template<typename CHAR>
+void Scanner<CHAR>::addVisibility(float meter, int dir)
+{
+  if(dir != -1)
+    dirVisibility = std::min(dirVisibility, meter);
+  else if(!(result.visibilityMeter < INVALID_METAR_VALUE))
+    // First one is the minimum visibility
+    result.visibilityMeter = meter;
+  groups++;
+}
+
+// R\d\d[LCR]?/...
+template<typename CHAR>
+bool Scanner<CHAR>::scanRwyVisRange()
+{
+  if(at(0) != 'R' || !isDigit(at(1)) || !isDigit(at(2)))
+    return false;
+
+  for(int i = 3; i < tokLen; i++)
+  {
+    if(at(i) == '/')
+    {
+      groups++;
+      return true;
+    }
+  }
+  return false;
+}
+
+// [+-]?(VC)?(MI|PR|BC|DR|BL|SH|TS|FZ)*(DZ|RA|SN|SG|IC|PL|GR|GS|UP|BR|FG|FU|VA|DU|SA|HZ|PY|PO|SQ|FC|SS|DS)+
+template<typename CHAR>
+bool Scanner<CHAR>::scanWeather()
+{
+  if(equals("NSW"))
+    return true;
+
+  int pos = 0;
+  MetarParser::Intensity intensity = MetarParser::MODERATE;
+  if(at(0) == '-')
+    intensity = MetarParser::LIGHT, pos++;
+  else if(at(0) == '+')
+    intensity = MetarParser::HEAVY, pos++;
+
+  bool vicinity = false, recent = false;
+  if(startsWith("VC", pos))
+    vicinity = true, pos += 2;
+  else if(startsWith("RE", pos))
+    recent = true, pos += 2;
+
+  if(pos >= tokLen || (tokLen - pos) % 2 != 0)
+    return false;
+
+  int flags = WEATHER_NONE;
+  bool phenomenon = false;
+  for(; pos < tokLen; pos += 2)
+  {
+    char c1 = at(pos), c2 = at(pos + 1);
+
+#define WCODE(a, b) (c1 == (a) && c2 == (b))
+    if(WCODE('S', 'H'))
+      flags |= WEATHER_SHOWER;
+    else if(WCODE('T', 'S'))
+      flags |= WEATHER_THUNDERSTORM;
+    else if(WCODE('F', 'Z'))
+      flags |= WEATHER_FREEZING;
+    else if(WCODE('M', 'I') || WCODE('P', 'R') || WCODE('B', 'C') || WCODE('D', 'R') || WCODE('B', 'L'))
+      ;
+    else
+    {
+      phenomenon = true;
+      if(WCODE('R', 'A'))
+        flags |= WEATHER_RAIN;
+      else if(WCODE('D', 'Z'))
+        flags |= WEATHER_DRIZZLE;
+      else if(WCODE('S', 'N'))
+        flags |= WEATHER_SNOW;
+      else if(WCODE('G', 'R') || WCODE('G', 'S') || WCODE('P', 'L'))
+        flags |= WEATHER_HAIL;
+      else if(WCODE('I', 'C') || WCODE('S', 'G'))
+        flags |= WEATHER_ICE;
+      else if(WCODE('F', 'G'))
+        flags |= WEATHER_FOG;
+      else if(WCODE('B', 'R'))
+        flags |= WEATHER_MIST;
+      else if(WCODE('H', 'Z') || WCODE('F', 'U') || WCODE('D', 'U') || WCODE('S', 'A') || WCODE('V', 'A') ||
+              WCODE('P', 'Y'))
+        flags |= WEATHER_HAZE;
+      else if(WCODE('S', 'Q') || WCODE('F', 'C') || WCODE('S', 'S') || WCODE('D', 'S') || WCODE('P', 'O'))
+        flags |= WEATHER_SQUALL;
+      else if(!WCODE('U', 'P'))
+        return false;
+    }
+#undef WCODE
+  }
+
+  if(!phenomenon && !(flags & WEATHER_THUNDERSTORM))
+    // Descriptor only like "TS" is allowed but not "SH" alone
+    return false;
+
+  // Weather in the vicinity or recent weather does not affect the station
+  if(!vicinity && !recent)
+  {
+    result.weather |= flags;
+    if(intensity > result.intensity)
+      result.intensity = intensity;
+  }
+  groups++;
+  return true;
+}
+
+template<typename CHAR>
+bool Scanner<CHAR>::scanSkyCondition()
+{
+  if(equals("/////////") || equals("//////"))
+    return true;
+
+  if(equals("CLR") || equals("SKC") || equals("NCD") || equals("NSC"))
+  {
+    if(result.numClouds < MAX_METAR_SCAN_CLOUDS)
+      result.clouds[result.numClouds++] = {MetarCloud::COVERAGE_CLEAR, INVALID_METAR_VALUE};
+    return true;
+  }
+
+  if(equals("CAVOK"))
+  {
+    result.cavok = true;
+    return true;
+  }
+
+  int pos = 3;
+  bool vertVis = false;
+  MetarCloud::Coverage coverage = MetarCloud::COVERAGE_NIL;
+  if(startsWith("VV"))
+    vertVis = true, pos = 2;
+  else if(startsWith("FEW"))
+    coverage = MetarCloud::COVERAGE_FEW;
+  else if(startsWith("SCT"))
+    coverage = MetarCloud::COVERAGE_SCATTERED;
+  else if(startsWith("BKN"))
+    coverage = MetarCloud::COVERAGE_BROKEN;
+  else if(startsWith("OVC"))
+    coverage = MetarCloud::COVERAGE_OVERCAST;
+  else
+    return false;
+
+  // Ignore single OVC/BKN/...
+  if(pos == tokLen)
+    return true;
+
+  int height = -1;
+  if(startsWith("///", pos))
+    pos += 3;
+  else
+    number(pos, height, 2, 3);
+
+  // Cloud type like CB or TCU and sensor failure "///"
+  for(; pos < tokLen; pos++)
+  {
+    if(!isAlpha(at(pos)) && at(pos) != '/')
+      return false;
+  }
+
+  float altitude = height == -1 ? INVALID_METAR_VALUE : atools::geo::feetToMeter(height * 100.f);
+  if(vertVis)
+  {
+    result.vertVisibilityMeter = altitude;
+    return true;
+  }
+
+  if(result.numClouds < MAX_METAR_SCAN_CLOUDS)
+    result.clouds[result.numClouds++] = {coverage, altitude};
+  groups++;
+  return true;
+}
+
+// (M?[0-9]{2}|XX)/(M?[0-9]{2}|XX|//)?
+template<typename CHAR>
+bool Scanner<CHAR>::scanTemperature()
+{
+  if(equals("XX/XX"))
+    return true;
+
+  int pos = 0, sign = 1, temp, dew;
+  if(at(pos) == 'M')
+    sign = -1, pos++;
+  if(!number(pos, temp, 2) || at(pos++) != '/')
+    return false;
+  temp *= sign;
+
+  if(pos < tokLen)
+  {
+    if(startsWith("//", pos) || startsWith("XX", pos))
+      pos += 2;
+    else
+    {
+      sign = 1;
+      if(at(pos) == 'M')
+        sign = -1, pos++;
+      if(!number(pos, dew, 2))
+        return false;
+      result.dewpointC = sign * dew;
+    }
+  }
+
+  if(pos != tokLen)
+    return false;
+
+  result.temperatureC = temp;
+  groups++;
+  return true;
+}
+
+// (A|Q)\d{2}(\d{2}|//)
+template<typename CHAR>
+bool Scanner<CHAR>::scanPressure()
+{
+  char type = at(0);
+  if((type != 'A' && type != 'Q') || tokLen != 5)
+    return false;
+
+  int pos = 1, press, low = 0;
+  if(!number(pos, press, 2))
+    return false;
+
+  if(startsWith("//", pos))
+    pos += 2;
+  else if(!number(pos, low, 2))
+    return false;
+
+  press = press * 100 + low;
+  if(type == 'A')
+    result.pressureMbar = atools::geo::inHgToMbar(press / 100.f);
+  else
+    result.pressureMbar = press;
+  groups++;
+  return true;
+}
+
+/* Same as MetarParser::postProcess() */
+template<typename CHAR>
+void Scanner<CHAR>::postProcess()
+{
+  float minAltitudeMeter = INVALID_METAR_VALUE;
+  float lowestAltitudeMeter = INVALID_METAR_VALUE;
+
+  for(int i = 0; i < result.numClouds; i++)
+  {
+    const MetarScanCloud& cloud = result.clouds[i];
+    if((cloud.coverage == MetarCloud::COVERAGE_BROKEN || cloud.coverage == MetarCloud::COVERAGE_OVERCAST) &&
+       cloud.altitudeMeter < minAltitudeMeter)
+      minAltitudeMeter = cloud.altitudeMeter;
+
+    if(cloud.coverage > result.maxCoverage)
+      result.maxCoverage = cloud.coverage;
+
+    if(cloud.altitudeMeter < lowestAltitudeMeter)
+    {
+      lowestAltitudeMeter = cloud.altitudeMeter;
+      result.lowestCoverage = cloud.coverage;
+    }
+  }
+
+  float ceilingFt = atools::geo::meterToFeet(minAltitudeMeter);
+  float visibilityMi = atools::geo::meterToMi(result.visibilityMeter);
+
+  if(visibilityMi < 1.f || ceilingFt < 500.f)
+    result.flightRules = MetarParser::LIFR;
+  else if(visibilityMi < 3.f || ceilingFt < 1000.f)
+    result.flightRules = MetarParser::IFR;
+  else if(visibilityMi <= 5.f || ceilingFt <= 3000.f)
+    result.flightRules = MetarParser::MVFR;
+  else
+    result.flightRules = MetarParser::VFR;
+
+  if(result.windDir >= 0)
+    result.prevailingWindDir = result.windDir;
+  else if(result.windRangeFrom != -1 && result.windRangeTo != -1)
+  {
+    int from = result.windRangeFrom, to;
+    if(result.windRangeFrom < result.windRangeTo)
+      to = result.windRangeTo;
+    else
+      to = result.windRangeTo + 360;
+    result.prevailingWindDir = atools::geo::normalizeCourse(from + (to - from) / 2);
+  }
+
+  result.prevailingWindSpeedMeterPerSec = result.windSpeedMeterPerSec;
+}
+
+} // namespace
+
+bool MetarScanner::scan(MetarScanResult& result, const char *data, int length)
+{
+  return Scanner<char>(result, data, length).scan();
+}
+
+bool MetarScanner::scan(MetarScanResult& result, const QChar *data, int length)
+{
+  return Scanner<QChar>(result, data, length).scan();
+}
+
+bool MetarScanner::scan(MetarScanResult& result, const QByteArray& metar)
+{
+  return scan(result, metar.constData(), metar.size());
+}
+
+bool MetarScanner::scan(MetarScanResult& result, const QStringRef& metar)
+{
+  return scan(result, metar.unicode(), metar.size());
+}
+
+bool MetarScanner::scan(MetarScanResult& result, const QString& metar)
+{
+  return scan(result, metar.unicode(), metar.size());
+}
+
+} // namespace weather
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,114 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_WEATHER_METARSCANNER_H
+#define ATOOLS_FS_WEATHER_METARSCANNER_H
+
+#include "fs/weather/metarparser.h"
+
+class QByteArray;
+class QStringRef;
+
+namespace atools {
+namespace fs {
+namespace weather {
+
+/* Maximum number of cloud layers kept by the scanner. Further layers are ignored. */
+const int MAX_METAR_SCAN_CLOUDS = 8;
+
+/* Present weather flags of the main observation */
+enum MetarScanWeather
+{
+  WEATHER_NONE = 0,
+  WEATHER_RAIN = 1 << 0,
+  WEATHER_DRIZZLE = 1 << 1,
+  WEATHER_SNOW = 1 << 2,
+  WEATHER_HAIL = 1 << 3, /* GR, GS and PL */
+  WEATHER_ICE = 1 << 4, /* IC and SG */
+  WEATHER_FOG = 1 << 5,
+  WEATHER_MIST = 1 << 6,
+  WEATHER_HAZE = 1 << 7, /* HZ, FU, DU, SA and VA */
+  WEATHER_THUNDERSTORM = 1 << 8,
+  WEATHER_SHOWER = 1 << 9,
+  WEATHER_FREEZING = 1 << 10,
+  WEATHER_SQUALL = 1 << 11 /* SQ, FC, SS and DS */
+};
+
+struct MetarScanCloud
+{
+  MetarCloud::Coverage coverage;
+  float altitudeMeter;
+};
+
+/* Values of the main observation in the same units as MetarParser. Fixed size and trivially copyable.
+ * Invalid values are INVALID_METAR_VALUE or -1 for integers. */
+struct MetarScanResult
+{
+  char station[5];
+  int day, hour, minute;
+
+  int windDir, windRangeFrom, windRangeTo;
+  float windSpeedMeterPerSec, gustSpeedMeterPerSec;
+
+  float visibilityMeter, vertVisibilityMeter;
+  bool cavok;
+
+  float temperatureC, dewpointC, pressureMbar;
+
+  MetarScanCloud clouds[MAX_METAR_SCAN_CLOUDS];
+  int numClouds;
+
+  /* Combination of MetarScanWeather values and strongest intensity */
+  int weather;
+  MetarParser::Intensity intensity;
+
+  /* Same as calculated in MetarParser */
+  MetarParser::FlightRules flightRules;
+  MetarCloud::Coverage maxCoverage, lowestCoverage;
+  int prevailingWindDir;
+  float prevailingWindSpeedMeterPerSec;
+
+  bool valid;
+
+  void clear();
+};
+
+/*
+ * Fast scanner for the main observation part of METAR reports. Reads a borrowed character buffer
+ * without copying and does not allocate memory. Trends, runway reports and remarks are ignored.
+ *
+ * Use MetarParser or Metar to get the full decoded report for display.
+ */
+class MetarScanner
+{
+public:
+  /* Scan the report in data with length characters. Returns false for NIL or incomplete reports.
+   * result is always cleared before. */
+  static bool scan(atools::fs::weather::MetarScanResult& result, const char *data, int length);
+  static bool scan(atools::fs::weather::MetarScanResult& result, const QChar *data, int length);
+
+  static bool scan(atools::fs::weather::MetarScanResult& result, const QByteArray& metar);
+  static bool scan(atools::fs::weather::MetarScanResult& result, const QStringRef& metar);
+  static bool scan(atools::fs::weather::MetarScanResult& result, const QString& metar);
+
+};
+
+} // namespace weather
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_WEATHER_METARSCANNER_H
@@ -0,0 +1,245 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/weather/weatherfield.h"
+
+#include "fs/weather/metarindex.h"
+#include "geo/calculations.h"
+#include "geo/simplespatialindex.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+
+namespace atools {
+namespace fs {
+namespace weather {
+
+/* Stations closer than this are used without weighting */
+const static float MIN_INTERPOLATION_DIST_METER = 1000.f;
+
+/* Wind speeds below this are calm */
+const static float MIN_WIND_SPEED_KTS = 0.5f;
+
+const static float MPS_TO_KT = static_cast<float>(3600. / atools::geo::nmToMeter(1.));
+
+/* Scanned values and position of a station */
+struct FieldStation
+{
+  atools::geo::Pos pos;
+  float windU, windV, temperatureC, pressureMbar;
+  bool windValid, temperatureValid, pressureValid;
+};
+
+WeatherField::WeatherField(float cellSizeDeg, int numStations, float maxDistanceNm)
+  : cellSize(std::max(cellSizeDeg, 0.1f)), maxDistanceMeter(atools::geo::nmToMeter(maxDistanceNm)),
+  numStations(std::max(numStations, 1))
+{
+}
+
+void WeatherField::clear()
+{
+  nodes.clear();
+  numCols = numRows = 0;
+}
+
+int WeatherField::build(MetarIndex& index)
+{
+  clear();
+
+  // Collect all stations with scanned values ====================
+  QVector<FieldStation> stations;
+  atools::geo::SimpleSpatialIndex<int, int> stationIndex(1);
+  for(const QString& ident : index.getIdents())
+  {
+    MetarScanResult scan;
+    atools::geo::Pos pos = index.getPosition(ident);
+    if(!pos.isValid() || !index.getScanned(scan, ident))
+      continue;
+
+    FieldStation station;
+    station.pos = pos;
+
+    station.windValid = scan.windSpeedMeterPerSec < INVALID_METAR_VALUE;
+    if(station.windValid && scan.prevailingWindDir >= 0)
+    {
+      // Variable or calm wind is a zero vector
+      float speed = scan.windSpeedMeterPerSec * MPS_TO_KT;
+      station.windU = speed * atools::geo::sinDeg(static_cast<float>(scan.prevailingWindDir));
+      station.windV = speed * atools::geo::cosDeg(static_cast<float>(scan.prevailingWindDir));
+    }
+    else
+      station.windU = station.windV = 0.f;
+
+    station.temperatureValid = scan.temperatureC < INVALID_METAR_VALUE;
+    station.temperatureC = station.temperatureValid ? scan.temperatureC : 0.f;
+    station.pressureValid = scan.pressureMbar < INVALID_METAR_VALUE;
+    station.pressureMbar = station.pressureValid ? scan.pressureMbar : 0.f;
+
+    if(station.windValid || station.temperatureValid || station.pressureValid)
+    {
+      stationIndex.insert(stations.size(), pos);
+      stations.append(station);
+    }
+  }
+
+  if(stations.isEmpty())
+    return 0;
+
+  // Fill grid ====================
+  numCols = static_cast<int>(std::ceil(360.f / cellSize));
+  numRows = static_cast<int>(std::floor(180.f / cellSize)) + 1;
+  nodes.resize(numCols * numRows);
+
+  int numValid = 0;
+  for(int row = 0; row < numRows; row++)
+  {
+    float lat = std::min(-90.f + row * cellSize, 90.f);
+    for(int col = 0; col < numCols; col++)
+    {
+      atools::geo::Pos pos(-180.f + col * cellSize, lat);
+
+      // Weighted sums and sum of weights for each value
+      double windU = 0., windV = 0., windW = 0., temp = 0., tempW = 0., press = 0., pressW = 0.;
+      for(int stationIdx : stationIndex.getNearest(pos, numStations))
+      {
+        const FieldStation& station = stations.at(stationIdx);
+        float dist = pos.distanceMeterTo(station.pos);
+        if(dist > maxDistanceMeter)
+          break;
+
+        // Inverse distance weighting
+        double weight = 1. / std::pow(std::max(dist, MIN_INTERPOLATION_DIST_METER), 2.);
+
+        if(station.windValid)
+          windU += weight * station.windU, windV += weight * station.windV, windW += weight;
+        if(station.temperatureValid)
+          temp += weight * station.temperatureC, tempW += weight;
+        if(station.pressureValid)
+          press += weight * station.pressureMbar, pressW += weight;
+      }
+
+      Node& node = nodes[row * numCols + col];
+      node.windValid = windW > 0.;
+      node.windU = node.windValid ? static_cast<float>(windU / windW) : 0.f;
+      node.windV = node.windValid ? static_cast<float>(windV / windW) : 0.f;
+      node.temperatureValid = tempW > 0.;
+      node.temperatureC = node.temperatureValid ? static_cast<float>(temp / tempW) : 0.f;
+      node.pressureValid = pressW > 0.;
+      node.pressureMbar = node.pressureValid ? static_cast<float>(press / pressW) : 0.f;
+
+      if(node.windValid || node.temperatureValid || node.pressureValid)
+        numValid++;
+    }
+  }
+
+  qDebug() << Q_FUNC_INFO << "stations" << stations.size() << "grid" << numCols << "x" << numRows
+           << "valid nodes" << numValid;
+
+  return numValid;
+}
+
+WeatherFieldValue WeatherField::getValue(const atools::geo::Pos& pos) const
+{
+  WeatherFieldValue value;
+  if(nodes.isEmpty() || !pos.isValid())
+    return value;
+
+  // Grid coordinates and fraction inside cell
+  float x = (atools::geo::normalizeLonXDeg(pos.getLonX()) + 180.f) / cellSize;
+  float y = (std::max(std::min(pos.getLatY(), 90.f), -90.f) + 90.f) / cellSize;
+  int col = std::min(static_cast<int>(x), numCols - 1);
+  int row = std::min(static_cast<int>(y), numRows - 2);
+  float fx = x - col, fy = std::min(y - row, 1.f);
+
+  // Corners with bilinear weights - longitude wraps around at the anti meridian
+  const Node *corners[4] = {&node(col, row), &node(col + 1, row), &node(col, row + 1), &node(col + 1, row + 1)};
+  const float weights[4] = {(1.f - fx) * (1.f - fy), fx * (1.f - fy), (1.f - fx) * fy, fx * fy};
+
+  // Invalid corners are left out and the weights of the others are normalized
+  float windU = 0.f, windV = 0.f, windW = 0.f, temp = 0.f, tempW = 0.f, press = 0.f, pressW = 0.f;
+  for(int i = 0; i < 4; i++)
+  {
+    const Node *n = corners[i];
+    float w = weights[i];
+    if(n->windValid)
+      windU += w * n->windU, windV += w * n->windV, windW += w;
+    if(n->temperatureValid)
+      temp += w * n->temperatureC, tempW += w;
+    if(n->pressureValid)
+      press += w * n->pressureMbar, pressW += w;
+  }
+
+  if(windW > 0.f)
+  {
+    windU /= windW;
+    windV /= windW;
+    value.windValid = true;
+    value.windSpeedKts = std::sqrt(windU * windU + windV * windV);
+    if(value.windSpeedKts >= MIN_WIND_SPEED_KTS)
+      value.windDirDeg = atools::geo::normalizeCourse(atools::geo::atan2Deg(windU, windV));
+  }
+
+  if(tempW > 0.f)
+  {
+    value.temperatureValid = true;
+    value.temperatureC = temp / tempW;
+  }
+
+  if(pressW > 0.f)
+  {
+    value.pressureValid = true;
+    value.pressureMbar = press / pressW;
+  }
+  return value;
+}
+
+bool WeatherField::getWind(float& windSpeedKts, float& windDirDeg, const atools::geo::Pos& pos) const
+{
+  WeatherFieldValue value = getValue(pos);
+  windSpeedKts = value.windSpeedKts;
+  windDirDeg = value.windDirDeg;
+  return value.windValid;
+}
+
+void WeatherField::windForCourse(float& headWind, float& crossWind, const atools::geo::Pos& pos,
+                                 float courseDeg) const
+{
+  float speed, dir;
+  if(getWind(speed, dir, pos) && dir >= 0.f)
+    atools::geo::windForCourse(headWind, crossWind, speed, dir, courseDeg);
+  else
+    headWind = crossWind = 0.f;
+}
+
+float WeatherField::windCorrectedHeading(float& groundSpeed, const atools::geo::Pos& pos, float courseDeg,
+                                         float trueAirspeed) const
+{
+  float speed, dir;
+  if(getWind(speed, dir, pos) && dir >= 0.f)
+    return atools::geo::windCorrectedHeading(groundSpeed, speed, dir, courseDeg, trueAirspeed);
+  else
+  {
+    groundSpeed = trueAirspeed;
+    return courseDeg;
+  }
+}
+
+} // namespace weather
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,111 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_WEATHER_WEATHERFIELD_H
+#define ATOOLS_FS_WEATHER_WEATHERFIELD_H
+
+#include "geo/pos.h"
+
+#include <QVector>
+
+namespace atools {
+namespace fs {
+namespace weather {
+
+class MetarIndex;
+
+/* Interpolated surface weather at a position. Values are invalid if no station was near. */
+struct WeatherFieldValue
+{
+  /* Direction the wind is coming from in degrees true. -1 if calm or unknown. */
+  float windDirDeg = -1.f;
+  float windSpeedKts = 0.f, temperatureC = 0.f, pressureMbar = 0.f;
+  bool windValid = false, temperatureValid = false, pressureValid = false;
+
+  bool isValid() const
+  {
+    return windValid || temperatureValid || pressureValid;
+  }
+};
+
+/*
+ * Regular lat/lon grid of surface wind, temperature and pressure interpolated by inverse distance weighting
+ * from the stations of a MetarIndex. Built once after each METAR update. Lookups are bilinear between the
+ * four surrounding grid nodes and do not need a station search.
+ *
+ * Not thread safe while building. Lookups on a built field can be done from any thread.
+ */
+class WeatherField
+{
+public:
+  /* cellSizeDeg is the grid spacing. numStations nearest stations within maxDistanceNm are used for each node. */
+  explicit WeatherField(float cellSizeDeg = 1.f, int numStations = 4, float maxDistanceNm = 200.f);
+
+  /* Rebuild the grid from all scanned METARs of the index. Returns number of grid nodes having values. */
+  int build(atools::fs::weather::MetarIndex& index);
+
+  void clear();
+
+  /* Bilinear interpolated weather at pos. Returns an invalid value if the field is empty or pos is invalid. */
+  atools::fs::weather::WeatherFieldValue getValue(const atools::geo::Pos& pos) const;
+
+  /* Wind at position in knots. Returns false if no wind is available. */
+  bool getWind(float& windSpeedKts, float& windDirDeg, const atools::geo::Pos& pos) const;
+
+  /* Head and cross wind for a course at position. See atools::geo::windForCourse. Both are 0 if no wind. */
+  void windForCourse(float& headWind, float& crossWind, const atools::geo::Pos& pos, float courseDeg) const;
+
+  /* Wind corrected heading and ground speed for a course at position using atools::geo::windCorrectedHeading.
+   * Returns courseDeg and trueAirspeed as ground speed if no wind is available. */
+  float windCorrectedHeading(float& groundSpeed, const atools::geo::Pos& pos, float courseDeg,
+                             float trueAirspeed) const;
+
+  bool isEmpty() const
+  {
+    return nodes.isEmpty();
+  }
+
+  float getCellSizeDeg() const
+  {
+    return cellSize;
+  }
+
+private:
+  /* Values of a grid node. Wind is stored as vector to allow interpolation. */
+  struct Node
+  {
+    float windU, windV, temperatureC, pressureMbar;
+    bool windValid, temperatureValid, pressureValid;
+  };
+
+  const Node& node(int col, int row) const
+  {
+    return nodes.at(row * numCols + (col % numCols));
+  }
+
+  float cellSize, maxDistanceMeter;
+  int numStations, numCols = 0, numRows = 0;
+
+  /* Row major starting at 90° south and 180° west */
+  QVector<Node> nodes;
+};
+
+} // namespace weather
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_WEATHER_WEATHERFIELD_H
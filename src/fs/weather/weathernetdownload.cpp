@@ -28,6 +28,13 @@ WeatherNetDownload::WeatherNetDownload(QObject *parent, bool verboseLogging)
 {
   downloader = new atools::util::HttpDownloader(parent, verboseLogging);
 
+  // Parse lines while downloading - also decompresses GZIP files
+  downloader->setLineStreaming(true);
+  downloader->setConditionalRequests(true);
+  connect(downloader, &atools::util::HttpDownloader::linesReceived, this, &WeatherNetDownload::linesReceived);
+  connect(downloader, &atools::util::HttpDownloader::downloadNotModified,
+          this, &WeatherNetDownload::downloadNotModified);
+
   connect(downloader, &atools::util::HttpDownloader::downloadFinished, this, &WeatherNetDownload::downloadFinished);
   connect(downloader, &atools::util::HttpDownloader::downloadFailed, this, &WeatherNetDownload::downloadFailed);
 }
@@ -39,27 +46,20 @@ WeatherNetDownload::~WeatherNetDownload()
 
 atools::fs::weather::MetarResult WeatherNetDownload::getMetar(const QString& airportIcao, const atools::geo::Pos& pos)
 {
-  atools::fs::weather::MetarResult result;
-  result.requestIdent = airportIcao;
-  result.requestPos = pos;
-
   if(index.isEmpty())
-    downloader->startDownload();
-  else
   {
-    QString data;
-    QString foundKey = index.getTypeOrNearest(data, airportIcao, pos);
-    if(!foundKey.isEmpty())
-    {
-      if(foundKey == airportIcao)
-        result.metarForStation = data;
-      else
-        result.metarForNearest = data;
-    }
-  }
+    // Restarts a running download
+    pendingMetars.clear();
+    downloader->startDownload();
 
-  result.timestamp = QDateTime::currentDateTime();
-  return result;
+    atools::fs::weather::MetarResult result;
+    result.requestIdent = airportIcao;
+    result.requestPos = pos;
+    result.timestamp = QDateTime::currentDateTime();
+    return result;
+  }
+  else
+    return index.getMetar(airportIcao, pos, numInterpolate);
 }
 
 void WeatherNetDownload::setRequestUrl(const QString& url)
@@ -72,13 +72,43 @@ void WeatherNetDownload::downloadFinished(const QByteArray& data, QString url)
   if(verbose)
     qDebug() << Q_FUNC_INFO << "url" << url << "data size" << data.size();
 
-  parseFile(data);
+  if(!data.isEmpty())
+    parseFile(data);
+
+  // Resolves coordinates for new stations only and keeps unchanged stations
+  int numChanged = index.update(pendingMetars);
+  pendingMetars.clear();
+
+  if(buildWeatherField && (numChanged > 0 || field.isEmpty()))
+    field.build(index);
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "Loaded" << index.size() << "metars from" << downloader->getUrl()
+             << "changed" << numChanged;
+
   emit weatherUpdated();
 }
 
 void WeatherNetDownload::downloadFailed(const QString& error, QString url)
 {
   qWarning() << Q_FUNC_INFO << "Error downloading from" << url << ":" << error;
+  pendingMetars.clear();
+}
+
+void WeatherNetDownload::downloadNotModified(QString url)
+{
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "Not modified" << url;
+
+  // Keep index from last download
+  pendingMetars.clear();
+}
+
+void WeatherNetDownload::linesReceived(const QList<QByteArray>& lines, QString url)
+{
+  Q_UNUSED(url);
+  for(const QByteArray& line : lines)
+    parseLine(QString::fromLatin1(line));
 }
 
 void WeatherNetDownload::setUpdatePeriod(int seconds)
@@ -94,18 +124,16 @@ void WeatherNetDownload::parseFile(const QByteArray& data)
   QTextStream stream(data, QIODevice::ReadOnly | QIODevice::Text);
 
   while(!stream.atEnd())
-  {
-    QString line = stream.readLine().simplified();
-    QString ident = line.section(' ', 0, 0);
+    parseLine(stream.readLine());
+}
 
-    atools::geo::Pos pos = fetchAirportCoords(ident);
+void WeatherNetDownload::parseLine(const QString& line)
+{
+  QString metar = line.simplified();
+  QString ident = metar.section(' ', 0, 0);
 
-    if(pos.isValid())
-      index.insert(ident, line, pos);
-  }
-  if(verbose)
-    qDebug() << Q_FUNC_INFO << "Loaded" << data.size() << "bytes and" << index.size()
-             << "metars from" << downloader->getUrl();
+  if(!ident.isEmpty())
+    pendingMetars.append({ident, metar, QDateTime()});
 }
 
 } // namespace weather
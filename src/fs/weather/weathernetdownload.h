@@ -18,7 +18,8 @@
 #ifndef ATOOLS_FS_WEATHERNETDOWNLOAD_H
 #define ATOOLS_FS_WEATHERNETDOWNLOAD_H
 
-#include "geo/simplespatialindex.h"
+#include "fs/weather/metarindex.h"
+#include "fs/weather/weatherfield.h"
 
 namespace atools {
 namespace util {
@@ -59,7 +60,32 @@ public:
   /* Set to a function that returns the coordinates for an airport ident. Needed to find the nearest. */
   void setFetchAirportCoords(const std::function<atools::geo::Pos(const QString&)>& value)
   {
-    fetchAirportCoords = value;
+    index.setFetchAirportCoords(value);
+  }
+
+  /* Fill metarForInterpolated from the given number of nearest stations if the station was not found.
+   * 0 disables interpolation (default). */
+  void setInterpolationStations(int value)
+  {
+    numInterpolate = value;
+  }
+
+  /* Rebuild the weather field after each download that changed stations. Disabled by default. */
+  void setBuildWeatherField(bool value)
+  {
+    buildWeatherField = value;
+  }
+
+  /* Interpolated grid of the last download. Empty if not enabled. */
+  const atools::fs::weather::WeatherField& getWeatherField() const
+  {
+    return field;
+  }
+
+  /* Access to the stations of the last download */
+  atools::fs::weather::MetarIndex& getMetarIndex()
+  {
+    return index;
   }
 
 signals:
@@ -69,11 +95,18 @@ signals:
 private:
   void downloadFinished(const QByteArray& data, QString url);
   void downloadFailed(const QString& error, QString url);
+  void linesReceived(const QList<QByteArray>& lines, QString url);
+  void downloadNotModified(QString url);
   void parseFile(const QByteArray& data);
+  void parseLine(const QString& line);
 
-  std::function<atools::geo::Pos(const QString&)> fetchAirportCoords;
+  atools::fs::weather::MetarIndex index;
+  atools::fs::weather::WeatherField field;
 
-  atools::geo::SimpleSpatialIndex<QString, QString> index;
+  /* Collects METARs while the file is downloaded */
+  QVector<atools::fs::weather::MetarData> pendingMetars;
+  int numInterpolate = 0;
+  bool buildWeatherField = false;
   atools::util::HttpDownloader *downloader = nullptr;
   bool verbose = false;
 };
@@ -24,6 +24,8 @@
 #include <QTextStream>
 #include <QDebug>
 
+#include <algorithm>
+
 namespace atools {
 namespace fs {
 namespace weather {
@@ -57,34 +59,18 @@ void XpWeatherReader::clear()
   deleteFsWatcher();
   index.clear();
   weatherFile.clear();
+  fileData.clear();
+  fileRecords.clear();
 }
 
 atools::fs::weather::MetarResult XpWeatherReader::getXplaneMetar(const QString& station, const atools::geo::Pos& pos)
 {
-  atools::fs::weather::MetarResult result;
-  result.requestIdent = station;
-  result.requestPos = pos;
-
-  MetarData data;
-  QString foundKey = index.getTypeOrNearest(data, station, pos);
-  if(!foundKey.isEmpty())
-  {
-    // Found a METAR
-    if(foundKey == station)
-      // Found exact match
-      result.metarForStation = data.metar;
-    else
-      // Found a station nearby
-      result.metarForNearest = data.metar;
-  }
-
-  result.timestamp = QDateTime::currentDateTime();
-  return result;
+  return index.getMetar(station, pos, numInterpolate);
 }
 
 QString XpWeatherReader::getMetar(const QString& ident)
 {
-  return index.value(ident).metar;
+  return index.getMetar(ident);
 }
 
 // 2017/07/30 18:45
@@ -96,6 +82,58 @@ QString XpWeatherReader::getMetar(const QString& ident)
 // 2017/07/30 18:47
 // KADS 301847Z 06005G14KT 13SM SKC 32/19 A3007
 bool XpWeatherReader::read()
+{
+  QFile file(weatherFile);
+  if(file.open(QIODevice::ReadOnly))
+  {
+    QByteArray data = file.readAll();
+    file.close();
+
+    if(data == fileData)
+      // File written again without changes
+      return false;
+
+    // Find first modified byte
+    qint64 prefix = 0, minSize = std::min(data.size(), fileData.size());
+    while(prefix < minSize && data.at(static_cast<int>(prefix)) == fileData.at(static_cast<int>(prefix)))
+      prefix++;
+
+    // Keep all METAR lines which end before the first change and include the line feed
+    int numUnchanged = 0;
+    while(numUnchanged < fileRecords.size() && fileRecords.at(numUnchanged).end <= prefix &&
+          fileData.at(static_cast<int>(fileRecords.at(numUnchanged).end - 1)) == '\n')
+      numUnchanged++;
+
+    QVector<MetarRecord> records = fileRecords.mid(0, numUnchanged);
+    qint64 offset = 0;
+    QDateTime lastTimestamp;
+    if(numUnchanged > 0)
+    {
+      // Continue after the last unchanged METAR using its timestamp
+      offset = records.last().end;
+      lastTimestamp = records.last().data.timestamp;
+    }
+
+    parse(data, offset, lastTimestamp, records);
+    int numChanged = updateIndex(records);
+
+    qDebug() << Q_FUNC_INFO << "Loaded" << index.size() << "metars" << "skipped" << numUnchanged
+             << "unchanged lines" << "updated" << numChanged << "stations";
+
+    fileData = data;
+    fileRecords.swap(records);
+  }
+  else
+  {
+    qWarning() << "cannot open" << file.fileName() << "reason" << file.errorString();
+    return false;
+  }
+
+  return true;
+}
+
+void XpWeatherReader::parse(const QByteArray& data, qint64 offset, QDateTime lastTimestamp,
+                            QVector<MetarRecord>& records)
 {
   // Recognize METAR airport
   static const QRegularExpression IDENT_REGEXP("^[A-Z0-9]{2,5}$");
@@ -103,64 +141,52 @@ bool XpWeatherReader::read()
   // Recognize date part
   static const QRegularExpression DATE_REGEXP("^[\\d]{4}/[\\d]{2}/[\\d]{2}");
 
-  QFile file(weatherFile);
-  if(file.open(QIODevice::ReadOnly | QIODevice::Text))
+  qint64 size = data.size();
+  while(offset < size)
   {
-    index.clear();
-
-    QTextStream stream(&file);
+    int lineBegin = static_cast<int>(offset);
+    int lineEnd = data.indexOf('\n', lineBegin);
+    offset = lineEnd == -1 ? size : lineEnd + 1;
 
-    int lineNum = 1;
-    QString line;
-    QDateTime lastTimestamp;
+    QString line = QString::fromUtf8(data.constData() + lineBegin,
+                                     (lineEnd == -1 ? data.size() : lineEnd) - lineBegin).trimmed();
 
-    while(!stream.atEnd())
+    if(line.size() >= 4)
     {
-      line = stream.readLine().trimmed();
-
-      if(line.isEmpty())
-        continue;
-
-      if(line.size() >= 4)
+      if(DATE_REGEXP.match(line).hasMatch())
       {
-        if(DATE_REGEXP.match(line).hasMatch())
-        {
-          // 2017/10/29 11:45
-          lastTimestamp = QDateTime::fromString(line, "yyyy/MM/dd hh:mm");
-          continue;
-        }
-
-        QString ident = line.section(' ', 0, 0);
-        if(IDENT_REGEXP.match(ident).hasMatch())
-        {
-          if(index.contains(ident))
-          {
-            MetarData md = index.value(ident);
-            if(md.timestamp > lastTimestamp)
-              // Ignore. Already loaded is newer.
-              continue;
-          }
-
-          // Starts with an airport ident - add if position is valid
-          atools::geo::Pos pos = fetchAirportCoords(ident);
-          if(pos.isValid())
-            index.insert(ident, {ident, line, lastTimestamp}, pos);
-        }
-        else
-          qWarning() << "Metar does not match in file" << file.fileName() << "line num" << lineNum << "line" << line;
+        // 2017/10/29 11:45
+        lastTimestamp = QDateTime::fromString(line, "yyyy/MM/dd hh:mm");
+        continue;
       }
-      lineNum++;
+
+      QString ident = line.section(' ', 0, 0);
+      if(IDENT_REGEXP.match(ident).hasMatch())
+        records.append({offset, {ident, line, lastTimestamp}});
+      else
+        qWarning() << "Metar does not match in file" << weatherFile << "offset" << lineBegin << "line" << line;
     }
-    file.close();
   }
-  else
+}
+
+int XpWeatherReader::updateIndex(const QVector<MetarRecord>& records)
+{
+  // Use the last METAR for each station unless an earlier one is newer
+  QHash<QString, const MetarData *> metars;
+  for(const MetarRecord& record : records)
   {
-    qWarning() << "cannot open" << file.fileName() << "reason" << file.errorString();
-    return false;
+    const MetarData *& md = metars[record.data.ident];
+    if(md == nullptr || !(md->timestamp > record.data.timestamp))
+      md = &record.data;
   }
 
-  qDebug() << Q_FUNC_INFO << "Loaded" << index.size() << "metars";
-  return true;
+  QVector<MetarData> latest;
+  latest.reserve(metars.size());
+  for(const MetarData *md : metars)
+    latest.append(*md);
+
+  // Removes missing stations and updates changed ones only
+  return index.update(latest);
 }
 
 void XpWeatherReader::pathChanged(const QString& filename)
@@ -200,7 +226,7 @@ void XpWeatherReader::createFsWatcher()
 {
   if(fsWatcher == nullptr)
   {
-    // Watch file for changes and directory too to catch file deletions
+    // Watcher coalesces bursts of writes and ignores writes without size or timestamp change
     fsWatcher = new FileSystemWatcher(this, verbose);
     fsWatcher->connect(fsWatcher, &FileSystemWatcher::fileUpdated, this, &XpWeatherReader::pathChanged);
   }
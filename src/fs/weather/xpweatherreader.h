@@ -20,7 +20,7 @@
 
 #include "fs/weather/weathertypes.h"
 
-#include "geo/simplespatialindex.h"
+#include "fs/weather/metarindex.h"
 
 namespace atools {
 namespace util {
@@ -32,6 +32,9 @@ namespace weather {
 
 /*
  * Reads the X-Plane METAR.rwx the watches the file for changes.
+ *
+ * The file content and the offset of each METAR are kept after reading. If the file changes only the part after
+ * the first modified byte is parsed again and only stations with a changed METAR are updated in the spatial index.
  */
 class XpWeatherReader
   : public QObject
@@ -51,7 +54,7 @@ public:
   /* Get all ICAO codes that have a weather station */
   QSet<QString> getMetarAirportIdents() const
   {
-    return index.keys().toSet();
+    return index.getIdents();
   }
 
   /* Read METAR.rwx and watch the file if needed */
@@ -63,7 +66,20 @@ public:
   /* Set to a function that returns the coordinates for an airport ident. Needed to find the nearest. */
   void setFetchAirportCoords(const std::function<atools::geo::Pos(const QString&)>& value)
   {
-    fetchAirportCoords = value;
+    index.setFetchAirportCoords(value);
+  }
+
+  /* Fill metarForInterpolated from the given number of nearest stations if the station was not found.
+   * 0 disables interpolation (default). */
+  void setInterpolationStations(int value)
+  {
+    numInterpolate = value;
+  }
+
+  /* Access to the stations of the file */
+  atools::fs::weather::MetarIndex& getMetarIndex()
+  {
+    return index;
   }
 
 signals:
@@ -75,17 +91,29 @@ private:
   void createFsWatcher();
   void pathChanged(const QString& filename);
 
-  struct MetarData
+  /* METAR line in file order */
+  struct MetarRecord
   {
-    QString ident, metar;
-    QDateTime timestamp;
+    qint64 end; /* Offset after the line including the line feed */
+    atools::fs::weather::MetarData data;
   };
 
+  /* Parse METAR lines from offset and append them to records */
+  void parse(const QByteArray& data, qint64 offset, QDateTime lastTimestamp,
+             QVector<atools::fs::weather::XpWeatherReader::MetarRecord>& records);
+
+  /* Build the index from records. Returns number of changed stations. */
+  int updateIndex(const QVector<atools::fs::weather::XpWeatherReader::MetarRecord>& records);
+
   QString weatherFile;
-  atools::geo::SimpleSpatialIndex<QString, MetarData> index;
-  atools::util::FileSystemWatcher *fsWatcher = nullptr;
+  atools::fs::weather::MetarIndex index;
+  int numInterpolate = 0;
 
-  std::function<atools::geo::Pos(const QString&)> fetchAirportCoords;
+  /* Content of the last read file and METARs found */
+  QByteArray fileData;
+  QVector<MetarRecord> fileRecords;
+
+  atools::util::FileSystemWatcher *fsWatcher = nullptr;
 
   bool verbose;
 };
@@ -25,6 +25,9 @@
 #include "atools.h"
 
 #include <QDebug>
+#include <QSet>
+
+#include <numeric>
 
 using atools::sql::SqlQuery;
 using atools::sql::SqlUtil;
@@ -103,6 +106,9 @@ QString convertAirwayType(AirwayType type)
   return QString();
 }
 
+/* Number of airway_point rows collected before inserting */
+static const int BATCH_SIZE = 5000;
+
 // ==================================================================
 
 AirwayPostProcess::AirwayPostProcess(sql::SqlDatabase& sqlDb, const NavDatabaseOptions& opts,
@@ -117,13 +123,6 @@ AirwayPostProcess::~AirwayPostProcess()
 
 bool AirwayPostProcess::postProcessEarthAirway()
 {
-  // A29
-  // A123 - 1
-  // A105 - 2
-  // A126 -5
-  // A125 -8
-  // V16 -216
-  // where name in ('V16')
   SqlQuery query("select name, type, direction, minimum_altitude, maximum_altitude, "
                  "previous_type, previous_ident, previous_region, "
                  "next_type, next_ident, next_region from airway_temp order by name", db);
@@ -133,15 +132,25 @@ bool AirwayPostProcess::postProcessEarthAirway()
                                                   {"airway_point_id", "waypoint_id", "next_airport_ident",
                                                    "previous_airport_ident"}));
 
+  // Resolve column indexes once for the whole result
+  const int nameIdx = query.columnIndex("name"), typeIdx = query.columnIndex("type"),
+            directionIdx = query.columnIndex("direction"),
+            minAltIdx = query.columnIndex("minimum_altitude"), maxAltIdx = query.columnIndex("maximum_altitude"),
+            nextIdentIdx = query.columnIndex("next_ident"), nextRegionIdx = query.columnIndex("next_region"),
+            nextTypeIdx = query.columnIndex("next_type"),
+            prevIdentIdx = query.columnIndex("previous_ident"), prevRegionIdx = query.columnIndex("previous_region"),
+            prevTypeIdx = query.columnIndex("previous_type");
+
   QString currentAirway;
   AirwayType currentAirwayType = NONE;
-  QList<AirwaySegment> segments;
+  QVector<AirwaySegment> segments;
+  numRows = 0;
 
   // Read duplets from temp table
   while(query.next())
   {
-    QString airway = query.value("name").toString();
-    AirwayType airwayType = static_cast<AirwayType>(query.value("type").toInt());
+    QString airway = query.valueStr(nameIdx);
+    AirwayType airwayType = static_cast<AirwayType>(query.valueInt(typeIdx));
 
     if(currentAirway.isEmpty())
     {
@@ -153,7 +162,10 @@ bool AirwayPostProcess::postProcessEarthAirway()
     if(currentAirway != airway && !segments.isEmpty())
     {
       // Airway has changed - order and write all its segments
-      writeSegments(segments, insert, currentAirway, currentAirwayType);
+      writeSegments(segments, currentAirway, currentAirwayType);
+
+      if(rows.names.size() >= BATCH_SIZE)
+        flushRows(insert);
 
       segments.clear();
       currentAirway = airway;
@@ -162,113 +174,114 @@ bool AirwayPostProcess::postProcessEarthAirway()
 
     // Add a segment from the database
     AirwaySegment segment;
-    segment.minAlt = query.value("minimum_altitude").toInt();
-    segment.maxAlt = query.value("maximum_altitude").toInt();
-    segment.next.ident = query.value("next_ident").toString();
-    segment.next.region = query.value("next_region").toString();
-    segment.next.type = static_cast<AirwayPointType>(query.value("next_type").toInt());
-    segment.prev.ident = query.value("previous_ident").toString();
-    segment.prev.region = query.value("previous_region").toString();
-    segment.prev.type = static_cast<AirwayPointType>(query.value("previous_type").toInt());
-    segment.dir = atools::strToChar(query.value("direction").toString());
-
-    segments.insert(segments.size(), segment);
+    segment.minAlt = query.valueInt(minAltIdx);
+    segment.maxAlt = query.valueInt(maxAltIdx);
+    segment.next.ident = query.valueStr(nextIdentIdx);
+    segment.next.region = query.valueStr(nextRegionIdx);
+    segment.next.type = static_cast<AirwayPointType>(query.valueInt(nextTypeIdx));
+    segment.prev.ident = query.valueStr(prevIdentIdx);
+    segment.prev.region = query.valueStr(prevRegionIdx);
+    segment.prev.type = static_cast<AirwayPointType>(query.valueInt(prevTypeIdx));
+    segment.dir = atools::strToChar(query.valueStr(directionIdx));
+
+    segments.append(segment);
   }
 
   // Write the last airway
   if(!segments.isEmpty())
-    writeSegments(segments, insert, currentAirway, currentAirwayType);
+    writeSegments(segments, currentAirway, currentAirwayType);
+  flushRows(insert);
+
+  qInfo() << Q_FUNC_INFO << "Added" << numRows << "airway points";
 
   return false;
 }
 
-void AirwayPostProcess::writeSegments(QList<AirwaySegment>& segments, SqlQuery& insert, const QString& name,
-                                      AirwayType type)
+void AirwayPostProcess::writeSegments(QVector<AirwaySegment>& segments, const QString& name, AirwayType type)
 {
-  // if(name != "UJ20" && name != "UJ3")
-  // return;
-
-  // Create a list ordered by next waypoint id
-  QVector<AirwaySegment> segsByNext(segments.toVector());
-  std::sort(segsByNext.begin(), segsByNext.end(), nextOrderFunc);
-
-  // Create a list ordered by previous waypoint id
-  QVector<AirwaySegment> segsByPrev(segments.toVector());
-  std::sort(segsByPrev.begin(), segsByPrev.end(), prevOrderFunc);
-
-  // List of finished segments with original and reversed from/to
+  // List of segments with original and reversed from/to to remove duplicates
   QSet<AirwaySegment> done;
-
-  // for(const Segment& s : segsByNext)
-  // qDebug() << "BYNEXT" << s.prev.ident << s.prev.region << s.prev.type
-  // << s.next.ident << s.next.region << s.next.type;
-  // for(const Segment& s : segsByPrev)
-  // qDebug() << "BYPREV" << s.prev.ident << s.prev.region << s.prev.type
-  // << s.next.ident << s.next.region << s.next.type;
+  QVector<AirwaySegment> uniqueSegments;
+  uniqueSegments.reserve(segments.size());
+  for(const AirwaySegment& segment : segments)
+  {
+    if(!done.contains(segment))
+    {
+      uniqueSegments.append(segment);
+      done.insert(segment);
+      done.insert(segment.reversed());
+    }
+  }
+  segments.swap(uniqueSegments);
+
+  // Create index lists ordered by next and previous waypoint
+  QVector<int> segsByNext(segments.size()), segsByPrev(segments.size());
+  std::iota(segsByNext.begin(), segsByNext.end(), 0);
+  std::iota(segsByPrev.begin(), segsByPrev.end(), 0);
+  std::sort(segsByNext.begin(), segsByNext.end(), [&segments](int i1, int i2) -> bool
+        {
+          return nextOrderFunc(segments.at(i1), segments.at(i2));
+        });
+  std::sort(segsByPrev.begin(), segsByPrev.end(), [&segments](int i1, int i2) -> bool
+        {
+          return prevOrderFunc(segments.at(i1), segments.at(i2));
+        });
+
+  // Finished segments
+  QVector<bool> used(segments.size(), false);
 
   // Iterate over all segments of this airway
-  while(!segments.isEmpty())
+  for(int start = 0; start < segments.size(); start++)
   {
-    // Create an airway fragment
-    QVector<AirwaySegment> found;
-    QVector<AirwaySegment> sortedSegments;
+    if(used.at(start))
+      continue;
 
-    // Insert start segment
-    sortedSegments.append(segments.first());
+    // Create an airway fragment - list allows fast prepend
+    QList<AirwaySegment> sortedSegments;
 
-    // Start segment is finished here - add from/to and to/from to simplify search
-    done.insert(segments.first());
-    done.insert(segments.first().reversed());
-    segments.removeFirst();
+    // Insert start segment
+    sortedSegments.append(segments.at(start));
+    used[start] = true;
 
     bool foundPrev = true, foundNext = true;
+    int found;
     while(foundNext || foundPrev)
     {
       // Find next for last segment
-      const AirwaySegment& last = sortedSegments.last();
-      if(findSegment(found, done, segsByPrev, last.next, last.prev, true))
+      AirwaySegment last = sortedSegments.last();
+      if((found = findSegment(segments, segsByPrev, used, last.next, last.prev, true)) != -1)
       {
         // Found segment is in correct order
-        segments.removeOne(found.first());
-        sortedSegments.append(found.first());
+        sortedSegments.append(segments.at(found));
         foundNext = true;
       }
-      else if(findSegment(found, done, segsByNext, last.next, last.prev, false))
+      else if((found = findSegment(segments, segsByNext, used, last.next, last.prev, false)) != -1)
       {
         // Found segment is in reversed order
-        segments.removeOne(found.first());
-        sortedSegments.append(found.first().reversed());
+        sortedSegments.append(segments.at(found).reversed());
         foundNext = true;
       }
       else
         foundNext = false;
 
       // Find previous for first segment
-      const AirwaySegment& first = sortedSegments.first();
-      if(findSegment(found, done, segsByNext, first.prev, first.next, false))
+      AirwaySegment first = sortedSegments.first();
+      if((found = findSegment(segments, segsByNext, used, first.prev, first.next, false)) != -1)
       {
         // Found segment is in correct order
-        segments.removeOne(found.first());
-        sortedSegments.prepend(found.first());
+        sortedSegments.prepend(segments.at(found));
         foundPrev = true;
       }
-      else if(findSegment(found, done, segsByPrev, first.prev, first.next, true))
+      else if((found = findSegment(segments, segsByPrev, used, first.prev, first.next, true)) != -1)
       {
         // Found segment is in reversed order
-        segments.removeOne(found.first());
-        sortedSegments.prepend(found.first().reversed());
+        sortedSegments.prepend(segments.at(found).reversed());
         foundPrev = true;
       }
       else
         foundPrev = false;
     }
 
-    // qDebug() << "-------";
-    // for(const Segment& s: sortedSegments)
-    // qDebug() << "SORTED" << s.prev.ident << s.prev.region << s.prev.type
-    // << s.next.ident << s.next.region << s.next.type;
-    // qDebug() << "-------";
-
     // Write the from/via/to triplets now
     for(int i = 0; i < sortedSegments.size(); i++)
     {
@@ -281,54 +294,92 @@ void AirwayPostProcess::writeSegments(QList<AirwaySegment>& segments, SqlQuery&
       AirwaySegment next34 = sortedSegments.value(i + 1);
 
       // Write in order 1 -> 2 -> 3
-      // qDebug() << "1 -> 2 -> 3 ###################################################";
-      // qDebug() << name << prev12.prev.ident << ">" << QChar(prev12.dir) << ">" << prev12.next.ident
-      // << mid23.prev.ident << ">" << QChar(mid23.dir) << ">" << mid23.next.ident;
-
       if(i == 0) // Avoid overlapping/duplicates
-        writeSegment(insert, name, type, prev12, mid23);
+        writeSegment(name, type, prev12, mid23);
 
       // Write in order 2 -> 3 -> 4
-      // qDebug() << "2 -> 3 -> 4 ######";
-      // qDebug() << name << mid23.prev.ident << ">" << QChar(mid23.dir) << ">" << mid23.next.ident
-      // << next34.prev.ident << ">" << QChar(next34.dir) << ">" << next34.next.ident;
-      writeSegment(insert, name, type, mid23, next34);
+      writeSegment(name, type, mid23, next34);
     }
   }
+  segments.clear();
 }
 
-void AirwayPostProcess::writeSegment(SqlQuery& insert, const QString& name, AirwayType type,
+void AirwayPostProcess::writeSegment(const QString& name, AirwayType type,
                                      const AirwaySegment& prevSeg, const AirwaySegment& nextSeg)
 {
-  insert.clearBoundValues();
+  const QVariant nullStr(QVariant::String), nullInt(QVariant::Int);
 
-  insert.bindValue(":name", name);
-  insert.bindValue(":type", convertAirwayType(type));
-  insert.bindValue(":mid_type", convertType(prevSeg.next.type));
-  insert.bindValue(":mid_ident", prevSeg.next.ident);
-  insert.bindValue(":mid_region", prevSeg.next.region);
+  rows.names.append(name);
+  rows.types.append(convertAirwayType(type));
+  rows.midTypes.append(convertType(prevSeg.next.type));
+  rows.midIdents.append(prevSeg.next.ident);
+  rows.midRegions.append(prevSeg.next.region);
 
   if(!prevSeg.prev.ident.isEmpty())
   {
-    insert.bindValue(":previous_type", convertType(prevSeg.prev.type));
-    insert.bindValue(":previous_ident", prevSeg.prev.ident);
-    insert.bindValue(":previous_region", prevSeg.prev.region);
-    insert.bindValue(":previous_minimum_altitude", prevSeg.minAlt * 100);
-    insert.bindValue(":previous_maximum_altitude", prevSeg.maxAlt * 100);
-    insert.bindValue(":previous_direction", atools::charToStr(prevSeg.dir));
+    rows.previousTypes.append(convertType(prevSeg.prev.type));
+    rows.previousIdents.append(prevSeg.prev.ident);
+    rows.previousRegions.append(prevSeg.prev.region);
+    rows.previousMinAltitudes.append(prevSeg.minAlt * 100);
+    rows.previousMaxAltitudes.append(prevSeg.maxAlt * 100);
+    rows.previousDirections.append(atools::charToStr(prevSeg.dir));
+  }
+  else
+  {
+    rows.previousTypes.append(nullStr);
+    rows.previousIdents.append(nullStr);
+    rows.previousRegions.append(nullStr);
+    rows.previousMinAltitudes.append(nullInt);
+    rows.previousMaxAltitudes.append(nullInt);
+    rows.previousDirections.append(nullStr);
   }
 
   if(!nextSeg.next.ident.isEmpty())
   {
-    insert.bindValue(":next_type", convertType(nextSeg.next.type));
-    insert.bindValue(":next_ident", nextSeg.next.ident);
-    insert.bindValue(":next_region", nextSeg.next.region);
-    insert.bindValue(":next_minimum_altitude", nextSeg.minAlt * 100);
-    insert.bindValue(":next_maximum_altitude", nextSeg.maxAlt * 100);
-    insert.bindValue(":next_direction", atools::charToStr(nextSeg.dir));
+    rows.nextTypes.append(convertType(nextSeg.next.type));
+    rows.nextIdents.append(nextSeg.next.ident);
+    rows.nextRegions.append(nextSeg.next.region);
+    rows.nextMinAltitudes.append(nextSeg.minAlt * 100);
+    rows.nextMaxAltitudes.append(nextSeg.maxAlt * 100);
+    rows.nextDirections.append(atools::charToStr(nextSeg.dir));
   }
+  else
+  {
+    rows.nextTypes.append(nullStr);
+    rows.nextIdents.append(nullStr);
+    rows.nextRegions.append(nullStr);
+    rows.nextMinAltitudes.append(nullInt);
+    rows.nextMaxAltitudes.append(nullInt);
+    rows.nextDirections.append(nullStr);
+  }
+}
 
-  insert.exec();
+void AirwayPostProcess::flushRows(SqlQuery& insert)
+{
+  if(rows.names.isEmpty())
+    return;
+
+  insert.bindValue(":name", rows.names);
+  insert.bindValue(":type", rows.types);
+  insert.bindValue(":mid_type", rows.midTypes);
+  insert.bindValue(":mid_ident", rows.midIdents);
+  insert.bindValue(":mid_region", rows.midRegions);
+  insert.bindValue(":previous_type", rows.previousTypes);
+  insert.bindValue(":previous_ident", rows.previousIdents);
+  insert.bindValue(":previous_region", rows.previousRegions);
+  insert.bindValue(":previous_minimum_altitude", rows.previousMinAltitudes);
+  insert.bindValue(":previous_maximum_altitude", rows.previousMaxAltitudes);
+  insert.bindValue(":previous_direction", rows.previousDirections);
+  insert.bindValue(":next_type", rows.nextTypes);
+  insert.bindValue(":next_ident", rows.nextIdents);
+  insert.bindValue(":next_region", rows.nextRegions);
+  insert.bindValue(":next_minimum_altitude", rows.nextMinAltitudes);
+  insert.bindValue(":next_maximum_altitude", rows.nextMaxAltitudes);
+  insert.bindValue(":next_direction", rows.nextDirections);
+  insert.execBatch();
+
+  numRows += rows.names.size();
+  rows = AirwayPointRows();
 }
 
 bool AirwayPostProcess::nextOrderFunc(const AirwaySegment& s1, const AirwaySegment& s2)
@@ -357,54 +408,47 @@ bool AirwayPostProcess::prevOrderFunc(const AirwaySegment& s1, const AirwaySegme
     return s1.prev.ident < s2.prev.ident;
 }
 
-bool AirwayPostProcess::findSegment(QVector<AirwaySegment>& found, QSet<AirwaySegment>& done,
-                                    const QVector<AirwaySegment>& segments,
-                                    AirwayPoint airwayPoint, AirwayPoint excludePoint, bool searchPrevious)
+int AirwayPostProcess::findSegment(const QVector<AirwaySegment>& segments, const QVector<int>& index,
+                                   QVector<bool>& done, const AirwayPoint& airwayPoint,
+                                   const AirwayPoint& excludePoint, bool searchPrevious)
 {
-  found.clear();
-
-  AirwaySegment segment;
-  if(searchPrevious)
-    segment.prev = airwayPoint;
-  else
-    segment.next = airwayPoint;
-
-  QVector<AirwaySegment>::const_iterator lower =
-    std::lower_bound(segments.begin(), segments.end(), segment, searchPrevious ? prevOrderFunc : nextOrderFunc);
-  QVector<AirwaySegment>::const_iterator upper =
-    std::upper_bound(segments.begin(), segments.end(), segment, searchPrevious ? prevOrderFunc : nextOrderFunc);
-
-  // qDebug() << "SEARCH" << idx.ident << idx.region << idx.type << prev;
-
-  for(QVector<AirwaySegment>::const_iterator it = lower; it < upper; ++it)
+  // Compare index entries with the searched point only
+  auto lessThan = [&segments, searchPrevious](int i, const AirwayPoint& point) -> bool
+                  {
+                    AirwaySegment segment;
+                    segment.prev = segment.next = point;
+                    return searchPrevious ?
+                           prevOrderFunc(segments.at(i), segment) : nextOrderFunc(segments.at(i), segment);
+                  };
+  auto greaterThan = [&segments, searchPrevious](const AirwayPoint& point, int i) -> bool
+                     {
+                       AirwaySegment segment;
+                       segment.prev = segment.next = point;
+                       return searchPrevious ?
+                              prevOrderFunc(segment, segments.at(i)) : nextOrderFunc(segment, segments.at(i));
+                     };
+
+  QVector<int>::const_iterator lower = std::lower_bound(index.begin(), index.end(), airwayPoint, lessThan);
+  QVector<int>::const_iterator upper = std::upper_bound(lower, index.end(), airwayPoint, greaterThan);
+
+  int found = -1, numFound = 0;
+  for(QVector<int>::const_iterator it = lower; it < upper; ++it)
   {
-    // qDebug() << "FOUND" << (*it).prev.ident << (*it).prev.region << (*it).prev.type
-    // << (*it).next.ident << (*it).next.region << (*it).next.type;
-
-    if(searchPrevious)
+    const AirwaySegment& segment = segments.at(*it);
+    if((searchPrevious ? segment.next : segment.prev) != excludePoint && !done.at(*it))
     {
-      if(it->next != excludePoint && !done.contains(*it))
-      {
-        found.append(*it);
-        done.insert(*it);
-        done.insert((*it).reversed());
-      }
-    }
-    else
-    {
-      if(it->prev != excludePoint && !done.contains(*it))
-      {
-        found.append(*it);
-        done.insert(*it);
-        done.insert((*it).reversed());
-      }
+      // Only the first one is used but all are marked as done
+      if(found == -1)
+        found = *it;
+      done[*it] = true;
+      numFound++;
     }
   }
 
-  if(found.size() > 1)
+  if(numFound > 1)
     qWarning() << "Found more than one airway segment";
 
-  return !found.isEmpty();
+  return found;
 }
 
 } // namespace xp
@@ -19,6 +19,8 @@
 #define ATOOLS_XP_POSTPROCESS_H
 
 #include <QString>
+#include <QVariantList>
+#include <QVector>
 
 namespace atools {
 
@@ -83,7 +85,8 @@ struct AirwaySegment
 
 /*
  * Takes the unordered from/to and to/from lists from X-Plane and converts them into an ordered list with from/via/to rows.
- * Reads from table airway_temp and inserts into airway_point
+ * Reads from table airway_temp and inserts into airway_point.
+ * Segments are read ordered by airway name and only one airway is kept in memory. Rows are inserted in batches.
  */
 class AirwayPostProcess
 {
@@ -96,17 +99,29 @@ public:
   bool postProcessEarthAirway();
 
 private:
-  /* Sort and write out all segments of an airway. This also includes multiple fragments of the same airway name.
+  /* Columns of airway_point rows collected for a batch insert */
+  struct AirwayPointRows
+  {
+    QVariantList names, types, midTypes, midIdents, midRegions,
+                 nextDirections, nextTypes, nextIdents, nextRegions, nextMinAltitudes, nextMaxAltitudes,
+                 previousDirections, previousTypes, previousIdents, previousRegions,
+                 previousMinAltitudes, previousMaxAltitudes;
+  };
+
+  /* Sort and collect all segments of an airway. This also includes multiple fragments of the same airway name.
    * The list segments is emptied during this process. */
-  void writeSegments(QList<AirwaySegment>& segments, sql::SqlQuery& insert, const QString& name, AirwayType type);
+  void writeSegments(QVector<AirwaySegment>& segments, const QString& name, AirwayType type);
 
-  /* Finds an airway segment starting or ending with airwayPoint in the list segments which can sorted by next or prev ids.*/
-  bool findSegment(QVector<AirwaySegment>& found, QSet<AirwaySegment>& done, const QVector<AirwaySegment>& segments,
-                   AirwayPoint airwayPoint, AirwayPoint excludePoint, bool searchPrevious);
+  /* Finds an airway segment starting or ending with airwayPoint in the segments using the index list
+   * which is sorted by next or prev ids. Returns the segment index or -1 if nothing was found. */
+  int findSegment(const QVector<AirwaySegment>& segments, const QVector<int>& index, QVector<bool>& done,
+                  const AirwayPoint& airwayPoint, const AirwayPoint& excludePoint, bool searchPrevious);
 
-  /* Write a from/via/to (prev/mid/next) triplet into the database */
-  void writeSegment(atools::sql::SqlQuery& insert, const QString& name, AirwayType type,
-                    const AirwaySegment& prevSeg, const AirwaySegment& nextSeg);
+  /* Add a from/via/to (prev/mid/next) triplet to the rows */
+  void writeSegment(const QString& name, AirwayType type, const AirwaySegment& prevSeg, const AirwaySegment& nextSeg);
+
+  /* Insert all collected rows using one batch query */
+  void flushRows(atools::sql::SqlQuery& insert);
 
   /* Used for sorting and binary search in the ordered segment lists. Sorts by next/to */
   static bool nextOrderFunc(const AirwaySegment& s1, const AirwaySegment& s2);
@@ -114,6 +129,9 @@ private:
   /* Used for sorting and binary search in the ordered segment lists. Sorts by previous/from */
   static bool prevOrderFunc(const AirwaySegment& s1, const AirwaySegment& s2);
 
+  AirwayPointRows rows;
+  int numRows = 0;
+
   const atools::fs::NavDatabaseOptions& options;
   atools::sql::SqlDatabase& db;
   atools::fs::ProgressHandler *progressHandler = nullptr;
@@ -21,6 +21,7 @@
 
 #include <QFile>
 #include <QFileInfo>
+#include <QDir>
 
 namespace atools {
 namespace fs {
@@ -38,6 +39,9 @@ SceneryPacks::~SceneryPacks()
 
 void SceneryPacks::read(const QString& basePath)
 {
+  // Resolve case insensitive paths of all entries with one listing per directory
+  atools::PathNoCaseCache pathCache;
+
   entries.clear();
   index.clear();
 
@@ -152,7 +156,7 @@ void SceneryPacks::read(const QString& basePath)
               pack.errorLine = -1;
 
               // Add only to index if path exists
-              QString absoluteFilePath = QFileInfo(pack.filepath).absoluteFilePath();
+              QString absoluteFilePath = normalizePath(pack.filepath);
               if(!absoluteFilePath.isEmpty())
                 index.insert(absoluteFilePath, entries.size());
             }
@@ -177,11 +181,17 @@ const QVector<SceneryPack>& SceneryPacks::getEntries() const
 
 const SceneryPack *SceneryPacks::getEntryByPath(const QString& filepath) const
 {
-  QFileInfo fi(filepath);
-  int idx = index.value(fi.absoluteFilePath(), -1);
+  int idx = index.value(normalizePath(filepath), -1);
   return idx >= 0 ? &entries.at(idx) : nullptr;
 }
 
+QString SceneryPacks::normalizePath(const QString& filepath)
+{
+  // Avoid QFileInfo file system access for lookups
+  QString path = QDir::isAbsolutePath(filepath) ? filepath : QDir::current().absoluteFilePath(filepath);
+  return QDir::cleanPath(QDir::fromNativeSeparators(path));
+}
+
 } // namespace xp
 } // namespace fs
 } // namespace atools
@@ -78,9 +78,12 @@ public:
   }
 
 private:
+  /* Absolute and clean path with forward slashes for the index */
+  static QString normalizePath(const QString& filepath);
+
   QVector<SceneryPack> entries;
 
-  /* Absolute path to index in entry list */
+  /* Normalized absolute path to index in entry list */
   QHash<QString, int> index;
   int fileVersion;
 
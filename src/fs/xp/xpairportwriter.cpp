@@ -1569,6 +1569,18 @@ int XpAirportWriter::compareRamp(const QString& ramp1, const QString& ramp2)
   return 0;
 }
 
+void XpAirportWriter::initIdsFromDatabase()
+{
+  curAirportId = getMaxId("airport");
+  curRunwayEndId = getMaxId("runway_end");
+  curHelipadId = getMaxId("helipad");
+  curComId = getMaxId("com");
+  curStartId = getMaxId("start");
+  curParkingId = getMaxId("parking");
+  curApronId = getMaxId("apron");
+  curTaxiPathId = getMaxId("taxi_path");
+}
+
 void XpAirportWriter::initQueries()
 {
   deInitQueries();
@@ -65,6 +65,7 @@ public:
   virtual void finish(const XpWriterContext& context) override;
 
   virtual void reset() override;
+  virtual void initIdsFromDatabase() override;
 
 private:
   void initQueries();
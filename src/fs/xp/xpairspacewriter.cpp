@@ -26,8 +26,11 @@
 #include "geo/calculations.h"
 #include "fs/util/coordinates.h"
 #include "fs/common/binarygeometry.h"
+#include "fs/navdatabaseoptions.h"
 
 #include "sql/sqlutil.h"
+#include "exception.h"
+#include "logging/loggingratelimiter.h"
 
 #include <QRegularExpression>
 #include <QTextCodec>
@@ -46,61 +49,80 @@ namespace xp {
 // Extract values from AH and AL values
 static QRegularExpression MATCH_ALT("^(FL)?\\s*([0-9]+)\\s*(FL|FT|M[ $])?\\s*(AMSL|MSL|AGL|GND|AAGL|ASFC)?");
 
-XpAirspaceWriter::XpAirspaceWriter(atools::sql::SqlDatabase& sqlDb,
-                                   const NavDatabaseOptions& opts, ProgressHandler *progressHandler,
-                                   atools::fs::NavDatabaseErrors *navdatabaseErrors)
-  : XpWriter(sqlDb, opts, progressHandler, navdatabaseErrors)
-{
-  initQueries();
-}
-
-XpAirspaceWriter::~XpAirspaceWriter()
+/* Same check as in XpWriter::at() */
+static void checkSize(const XpLineTokenizer& line, int size, const XpWriterContext *context)
 {
-  deInitQueries();
+  if(line.size() < size)
+    // Have to stop reading the file since the rest can be corrupted
+    throw atools::Exception(context->messagePrefix() +
+                            QString(": Index out of bounds: Index: %1, size: %2").arg(size - 1).arg(line.size()));
 }
 
-void XpAirspaceWriter::write(const QStringList& line, const XpWriterContext& context)
+void XpAirspaceParser::parse(const XpLineTokenizer& line, const XpWriterContext& context)
 {
   ctx = &context;
 
-  QString key = at(line, 0);
+  checkSize(line, 1, ctx);
+  const QStringRef& key = line.at(0);
 
-  if(writingCoordinates && !key.startsWith("D") && key != "V")
+  if(isAirspaceEnd(key))
   {
-    // Done with coordinates - write old boundary an start a new one
+    // Done with coordinates - finish old boundary an start a new one
     writingCoordinates = false;
-    writeBoundary();
+    finishAirspace();
   }
 
-  if(key.startsWith("D") || key == "V")
+  if(isGeometryKey(key))
   {
     // Geomety or variables
     writingCoordinates = true;
     bindCoordinate(line);
   }
-  else if(key == "AC")
+  else if(key == QLatin1String("AC"))
+  {
     // Class
-    bindClass(at(line, 1));
-  else if(key == "AN")
+    checkSize(line, 2, ctx);
+    bindClass(line.at(1).toString());
+  }
+  else if(key == QLatin1String("AN"))
+  {
     // Name
-    bindName(mid(line, 1));
-  else if(key == "AH")
+    checkSize(line, 2, ctx);
+    current.name = line.toStringList(1).join(" ");
+  }
+  else if(key == QLatin1String("AH"))
     // Upper limit
     bindAltitude(line, true /* max altitude */);
-  else if(key == "AL")
+  else if(key == QLatin1String("AL"))
     // Lower limit
     bindAltitude(line, false /* min altitude */);
 }
 
-void XpAirspaceWriter::writeBoundary()
+void XpAirspaceParser::finish(const XpWriterContext& context)
 {
-  // insertAirspaceQuery->bindValue(":com_type", );
-  // insertAirspaceQuery->bindValue(":com_frequency", );
-  // insertAirspaceQuery->bindValue(":com_name", );
-  // insertAirspaceQuery->bindValue(":comment", );
+  ctx = &context;
+  finishAirspace();
+}
 
-  insertAirspaceQuery->bindValue(":boundary_id", ++curAirspaceId);
-  insertAirspaceQuery->bindValue(":file_id", ctx->curFileId);
+void XpAirspaceParser::reset()
+{
+  current = XpAirspace();
+  clockwise = true;
+  writingCoordinates = false;
+  center = Pos();
+}
+
+void XpAirspaceParser::warn(const QString& msg)
+{
+  if(ctx != nullptr)
+    ATOOLS_LOG_LIMITED(qWarning() << ctx->messagePrefix() << msg);
+  else
+    ATOOLS_LOG_LIMITED(qWarning() << msg);
+}
+
+void XpAirspaceParser::finishAirspace()
+{
+  LineString& curLine = current.line;
 
   // Remove all remaining invalid points
   LineString::iterator it = std::remove_if(curLine.begin(), curLine.end(), [](const Pos& p) -> bool
@@ -110,57 +132,36 @@ void XpAirspaceWriter::writeBoundary()
 
   if(it != curLine.end())
   {
-    errWarn("Found invalid coordinates in airspace");
+    warn("Found invalid coordinates in airspace");
     curLine.erase(it, curLine.end());
   }
 
   if(curLine.size() > 2)
   {
-    // calculate bounding rectangle
-    Rect bounding = curLine.boundingRect();
-
-    if(!bounding.isPoint())
-    {
-      insertAirspaceQuery->bindValue(":max_lonx", bounding.getEast());
-      insertAirspaceQuery->bindValue(":max_laty", bounding.getNorth());
-      insertAirspaceQuery->bindValue(":min_lonx", bounding.getWest());
-      insertAirspaceQuery->bindValue(":min_laty", bounding.getSouth());
-
-      // Create geometry blob
-      atools::fs::common::BinaryGeometry geo(curLine);
-      insertAirspaceQuery->bindValue(":geometry", geo.writeToByteArray());
-
-      // Fields not used by X-Plane
-      insertAirspaceQuery->bindValue(":restrictive_designation", QVariant(QVariant::String));
-      insertAirspaceQuery->bindValue(":restrictive_type", QVariant(QVariant::String));
-      insertAirspaceQuery->bindValue(":multiple_code", QVariant(QVariant::String));
-      insertAirspaceQuery->bindValue(":time_code", "U");
-
-      insertAirspaceQuery->exec();
-
-      progress->incNumBoundaries();
-    }
+    if(!curLine.boundingRect().isPoint())
+      airspaces.append(current);
     else
-      errWarn("Found invalid bounding rectangle for airspace");
+      warn("Found invalid bounding rectangle for airspace");
   }
   else
-    errWarn("Airspace has not enough points");
+    warn("Airspace has not enough points");
   reset();
 }
 
-void XpAirspaceWriter::bindCoordinate(const QStringList& line)
+void XpAirspaceParser::bindCoordinate(const XpLineTokenizer& line)
 {
-  QString key = at(line, 0).toUpper();
-  QString value = mid(line, 1).trimmed().toUpper();
+  QString key = line.at(0).toString().toUpper();
+  checkSize(line, 2, ctx);
+  QString value = line.toStringList(1).join(" ").trimmed().toUpper();
 
   if(key == "DP")
   {
     // DP coordinate - add polygon point
     Pos pos = fromOpenAirFormat(value);
     if(pos.isValidRange())
-      curLine.append(pos);
+      current.line.append(pos);
     else
-      errWarn("Found invalid coordinates in airspace record DP: \"" + value + "\"");
+      warn("Found invalid coordinates in airspace record DP: \"" + value + "\"");
   }
   else if(key == "DA")
   {
@@ -175,9 +176,9 @@ void XpAirspaceWriter::bindCoordinate(const QStringList& line)
       Pos pos1 = center.endpoint(atools::geo::nmToMeter(radius), angleStart).normalize();
       Pos pos2 = center.endpoint(atools::geo::nmToMeter(radius), angleEnd).normalize();
       if(pos1.isValid() && pos2.isValid() && center.isValidRange())
-        curLine.append(LineString(center, pos1, pos2, clockwise, 24));
+        current.line.append(LineString(center, pos1, pos2, clockwise, 24));
       else
-        errWarn("Found invalid coordinates in airspace record DA: \"" + value + "\"");
+        warn("Found invalid coordinates in airspace record DA: \"" + value + "\"");
     }
     clockwise = true;
   }
@@ -188,9 +189,9 @@ void XpAirspaceWriter::bindCoordinate(const QStringList& line)
     Pos pos2 = fromOpenAirFormat(value.section(',', 1, 1).trimmed());
 
     if(pos1.isValid() && pos2.isValid() && center.isValidRange())
-      curLine.append(LineString(center, pos1, pos2, clockwise, 24));
+      current.line.append(LineString(center, pos1, pos2, clockwise, 24));
     else
-      errWarn("Found invalid coordinates in airspace record DB: \"" + value + "\"");
+      warn("Found invalid coordinates in airspace record DB: \"" + value + "\"");
     clockwise = true;
   }
   else if(key == "DC")
@@ -198,7 +199,7 @@ void XpAirspaceWriter::bindCoordinate(const QStringList& line)
     // DC radius - draw a circle (center taken from the previous V X=... record, radius in nm
     float radius = value.toFloat();
     if(radius > 0.2f && center.isValidRange())
-      curLine.append(LineString(center, atools::geo::nmToMeter(radius), 24));
+      current.line.append(LineString(center, atools::geo::nmToMeter(radius), 24));
     else
       // Small values are apparently used to define colors
       qWarning() << ctx->messagePrefix() << "Found invalid radius or center coordinate in airspace record DC" << value;
@@ -218,24 +219,19 @@ void XpAirspaceWriter::bindCoordinate(const QStringList& line)
         // automatically reset to '+' at the begining of new airspace segment
         clockwise = variableValue == "+";
       else
-        errWarn("Invalid direction value in airspace record D: \"" + variableValue + "\"");
+        warn("Invalid direction value in airspace record D: \"" + variableValue + "\"");
     }
     else if(variableName == "X")
     {
       // X=coordinate : sets the center for the following records: DA, DB, and DC
       center = fromOpenAirFormat(variableValue);
       if(!center.isValidRange())
-        errWarn("Invalid center coordinate in airspace record D: \"" + variableValue + "\"");
+        warn("Invalid center coordinate in airspace record D: \"" + variableValue + "\"");
     }
   }
 }
 
-void XpAirspaceWriter::bindName(const QString& name)
-{
-  insertAirspaceQuery->bindValue(":name", name);
-}
-
-void XpAirspaceWriter::bindClass(const QString& cls)
+void XpAirspaceParser::bindClass(const QString& cls)
 {
   QString type;
 
@@ -271,19 +267,18 @@ void XpAirspaceWriter::bindClass(const QString& cls)
     type = "MC"; // Mode C
   else
     qWarning() << ctx->messagePrefix() << "Unknown airspace class" << cls;
-  insertAirspaceQuery->bindValue(":type", type);
+  current.type = type;
 }
 
-void XpAirspaceWriter::bindAltitude(const QStringList& line, bool isMax)
+void XpAirspaceParser::bindAltitude(const XpLineTokenizer& line, bool isMax)
 {
-  QString prefix = isMax ? ":max" : ":min";
   int unlimited = isMax ? 100000 : 0;
   int altitude = unlimited;
 
   QString altStr, type;
   if(line.size() > 1)
     // Leave unknown if not given
-    altStr = mid(line, 1).toUpper();
+    altStr = line.toStringList(1).join(" ").toUpper();
 
   if(altStr.startsWith("UN"))
   {
@@ -348,23 +343,114 @@ void XpAirspaceWriter::bindAltitude(const QStringList& line, bool isMax)
     }
   }
 
-  insertAirspaceQuery->bindValue(prefix + "_altitude_type", type);
-  insertAirspaceQuery->bindValue(prefix + "_altitude", altitude);
+  if(isMax)
+  {
+    current.maxAltitudeType = type;
+    current.maxAltitude = altitude;
+  }
+  else
+  {
+    current.minAltitudeType = type;
+    current.minAltitude = altitude;
+  }
+}
+
+XpAirspaceWriter::XpAirspaceWriter(atools::sql::SqlDatabase& sqlDb,
+                                   const NavDatabaseOptions& opts, ProgressHandler *progressHandler,
+                                   atools::fs::NavDatabaseErrors *navdatabaseErrors)
+  : XpWriter(sqlDb, opts, progressHandler, navdatabaseErrors)
+{
+  initQueries();
+}
+
+XpAirspaceWriter::~XpAirspaceWriter()
+{
+  deInitQueries();
+}
+
+void XpAirspaceWriter::write(const QStringList& line, const XpWriterContext& context)
+{
+  XpLineTokenizer tokens;
+  tokens.setFields(line);
+  write(tokens, context);
+}
+
+void XpAirspaceWriter::write(const XpLineTokenizer& line, const XpWriterContext& context)
+{
+  ctx = &context;
+
+  parser.parse(line, context);
+  if(!parser.getAirspaces().isEmpty())
+  {
+    write(parser.getAirspaces(), context);
+    parser.getAirspaces().clear();
+  }
+}
+
+void XpAirspaceWriter::write(const QVector<XpAirspace>& airspaces, const XpWriterContext& context)
+{
+  ctx = &context;
+  for(const XpAirspace& airspace : airspaces)
+    writeAirspace(airspace);
+}
+
+void XpAirspaceWriter::writeAirspace(const XpAirspace& airspace)
+{
+  // insertAirspaceQuery->bindValue(":com_type", );
+  // insertAirspaceQuery->bindValue(":com_frequency", );
+  // insertAirspaceQuery->bindValue(":com_name", );
+  // insertAirspaceQuery->bindValue(":comment", );
+
+  insertAirspaceQuery->bindValue(":boundary_id", ++curAirspaceId);
+  insertAirspaceQuery->bindValue(":file_id", ctx->curFileId);
+  insertAirspaceQuery->bindValue(":name", airspace.name);
+  insertAirspaceQuery->bindValue(":type", airspace.type);
+  insertAirspaceQuery->bindValue(":max_altitude_type", airspace.maxAltitudeType);
+  insertAirspaceQuery->bindValue(":max_altitude", airspace.maxAltitude);
+  insertAirspaceQuery->bindValue(":min_altitude_type", airspace.minAltitudeType);
+  insertAirspaceQuery->bindValue(":min_altitude", airspace.minAltitude);
+
+  // calculate bounding rectangle
+  Rect bounding = airspace.line.boundingRect();
+  insertAirspaceQuery->bindValue(":max_lonx", bounding.getEast());
+  insertAirspaceQuery->bindValue(":max_laty", bounding.getNorth());
+  insertAirspaceQuery->bindValue(":min_lonx", bounding.getWest());
+  insertAirspaceQuery->bindValue(":min_laty", bounding.getSouth());
+
+  // Create geometry blob
+  atools::fs::common::BinaryGeometry geo(airspace.line);
+  insertAirspaceQuery->bindValue(":geometry", geo.writeToByteArray(options.isPackedGeometry() ?
+                                                                   atools::fs::common::BinaryGeometry::FORMAT_PACKED :
+                                                                   atools::fs::common::BinaryGeometry::FORMAT_FLOAT));
+
+  // Fields not used by X-Plane
+  insertAirspaceQuery->bindValue(":restrictive_designation", QVariant(QVariant::String));
+  insertAirspaceQuery->bindValue(":restrictive_type", QVariant(QVariant::String));
+  insertAirspaceQuery->bindValue(":multiple_code", QVariant(QVariant::String));
+  insertAirspaceQuery->bindValue(":time_code", "U");
+
+  insertAirspaceQuery->exec();
+
+  progress->incNumBoundaries();
 }
 
 void XpAirspaceWriter::finish(const XpWriterContext& context)
 {
   ctx = &context;
-  writeBoundary();
+  parser.finish(context);
+  write(parser.getAirspaces(), context);
+  parser.getAirspaces().clear();
 }
 
 void XpAirspaceWriter::reset()
 {
-  insertAirspaceQuery->clearBoundValues();
-  curLine.clear();
-  clockwise = true;
-  writingCoordinates = false;
-  center = Pos();
+  parser.reset();
+  parser.getAirspaces().clear();
+}
+
+void XpAirspaceWriter::initIdsFromDatabase()
+{
+  curAirspaceId = getMaxId("boundary");
 }
 
 void XpAirspaceWriter::initQueries()
@@ -22,6 +22,9 @@
 
 #include "geo/linestring.h"
 
+#include <QVariant>
+#include <QVector>
+
 namespace atools {
 
 namespace sql {
@@ -37,6 +40,64 @@ class NavDatabaseErrors;
 
 namespace xp {
 
+/* Airspace read from an OpenAir file. Null values are left unbound for the boundary table. */
+struct XpAirspace
+{
+  QVariant name, type, minAltitudeType, minAltitude, maxAltitudeType, maxAltitude;
+
+  /* Polygon including arcs and circles with valid coordinates only */
+  atools::geo::LineString line;
+};
+
+/*
+ * Parses OpenAir airspace lines into airspaces including geometry for arcs and circles.
+ * Does not access the database and can be used in threads. One instance per thread.
+ */
+class XpAirspaceParser
+{
+public:
+  /* Parse one line. Completed airspaces are added to the list returned by getAirspaces(). */
+  void parse(const atools::fs::xp::XpLineTokenizer& line, const atools::fs::xp::XpWriterContext& context);
+
+  /* Complete the last airspace at the end of a file or a chunk */
+  void finish(const atools::fs::xp::XpWriterContext& context);
+
+  /* Clear state of current airspace */
+  void reset();
+
+  /* true if key finishes an airspace when following coordinate records. A new parser can start at such a line
+   * with the same results which allows to split files into chunks. */
+  bool isAirspaceEnd(const QStringRef& key) const
+  {
+    return writingCoordinates && !isGeometryKey(key);
+  }
+
+  static bool isGeometryKey(const QStringRef& key)
+  {
+    return key.startsWith('D') || key == QLatin1String("V");
+  }
+
+  QVector<atools::fs::xp::XpAirspace>& getAirspaces()
+  {
+    return airspaces;
+  }
+
+private:
+  void finishAirspace();
+  void bindAltitude(const atools::fs::xp::XpLineTokenizer& line, bool isMax);
+  void bindClass(const QString& cls);
+  void bindCoordinate(const atools::fs::xp::XpLineTokenizer& line);
+  void warn(const QString& msg);
+
+  const atools::fs::xp::XpWriterContext *ctx = nullptr;
+  bool writingCoordinates = false;
+  atools::fs::xp::XpAirspace current;
+  atools::geo::Pos center;
+  bool clockwise = true;
+
+  QVector<atools::fs::xp::XpAirspace> airspaces;
+};
+
 /*
  * Reads OpenAir files containing airspaces and writes them to the boundary table.
  */
@@ -52,23 +113,21 @@ public:
   virtual ~XpAirspaceWriter();
 
   virtual void write(const QStringList& line, const XpWriterContext& context) override;
+  virtual void write(const atools::fs::xp::XpLineTokenizer& line, const XpWriterContext& context) override;
   virtual void finish(const XpWriterContext& context) override;
   virtual void reset() override;
+  virtual void initIdsFromDatabase() override;
+
+  /* Write airspaces which were read by a XpAirspaceParser */
+  void write(const QVector<atools::fs::xp::XpAirspace>& airspaces, const XpWriterContext& context);
 
 private:
   void initQueries();
   void deInitQueries();
 
-  void writeBoundary();
-  void bindAltitude(const QStringList& line, bool isMax);
-  void bindClass(const QString& cls);
-  void bindName(const QString& name);
-  void bindCoordinate(const QStringList& line);
+  void writeAirspace(const atools::fs::xp::XpAirspace& airspace);
 
-  bool writingCoordinates = false;
-  atools::geo::LineString curLine;
-  atools::geo::Pos center;
-  bool clockwise = true;
+  XpAirspaceParser parser;
 
   atools::sql::SqlQuery *insertAirspaceQuery = nullptr;
   int curAirspaceId = 0;
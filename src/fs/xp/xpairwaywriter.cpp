@@ -58,27 +58,44 @@ atools::fs::xp::XpAirwayWriter::~XpAirwayWriter()
 
 void XpAirwayWriter::write(const QStringList& line, const XpWriterContext& context)
 {
-  ctx = &context;
+  XpLineTokenizer tokens;
+  tokens.setFields(line);
+  write(tokens, context);
+}
 
-  QString names = at(line, NAME);
+void XpAirwayWriter::write(const XpLineTokenizer& line, const XpWriterContext& context)
+{
+  ctx = &context;
 
-  for(const QString& name : names.split("-"))
+  // Convert fields only once for all airways of the segment
+  int type = at(line, TYPE).toInt();
+  QString direction = internAt(line, DIRECTION);
+  int minAltitude = at(line, MIN_ALT).toInt();
+  int maxAltitude = at(line, MAX_ALT).toInt();
+  QString fromIdent = internAt(line, FROM_IDENT);
+  QString fromRegion = internAt(line, FROM_REGION);
+  int fromType = at(line, FROM_TYPE).toInt();
+  QString toIdent = internAt(line, TO_IDENT);
+  QString toRegion = internAt(line, TO_REGION);
+  int toType = at(line, TO_TYPE).toInt();
+
+  for(const QStringRef& name : at(line, NAME).split('-'))
   {
     // Split dash separated airway list
     insertAirwayQuery->bindValue(":airway_temp_id", ++curAirwayId);
-    insertAirwayQuery->bindValue(":name", name);
-    insertAirwayQuery->bindValue(":type", at(line, TYPE).toInt());
-    insertAirwayQuery->bindValue(":direction", at(line, DIRECTION));
-    insertAirwayQuery->bindValue(":minimum_altitude", at(line, MIN_ALT).toInt());
-    insertAirwayQuery->bindValue(":maximum_altitude", at(line, MAX_ALT).toInt());
+    insertAirwayQuery->bindValue(":name", atools::util::StringPool::compileInstance().intern(name));
+    insertAirwayQuery->bindValue(":type", type);
+    insertAirwayQuery->bindValue(":direction", direction);
+    insertAirwayQuery->bindValue(":minimum_altitude", minAltitude);
+    insertAirwayQuery->bindValue(":maximum_altitude", maxAltitude);
 
-    insertAirwayQuery->bindValue(":previous_ident", at(line, FROM_IDENT));
-    insertAirwayQuery->bindValue(":previous_region", at(line, FROM_REGION));
-    insertAirwayQuery->bindValue(":previous_type", at(line, FROM_TYPE).toInt());
+    insertAirwayQuery->bindValue(":previous_ident", fromIdent);
+    insertAirwayQuery->bindValue(":previous_region", fromRegion);
+    insertAirwayQuery->bindValue(":previous_type", fromType);
 
-    insertAirwayQuery->bindValue(":next_ident", at(line, TO_IDENT));
-    insertAirwayQuery->bindValue(":next_region", at(line, TO_REGION));
-    insertAirwayQuery->bindValue(":next_type", at(line, TO_TYPE).toInt());
+    insertAirwayQuery->bindValue(":next_ident", toIdent);
+    insertAirwayQuery->bindValue(":next_region", toRegion);
+    insertAirwayQuery->bindValue(":next_type", toType);
 
     insertAirwayQuery->exec();
   }
@@ -94,6 +111,11 @@ void XpAirwayWriter::reset()
 
 }
 
+void XpAirwayWriter::initIdsFromDatabase()
+{
+  curAirwayId = getMaxId("airway_temp");
+}
+
 void XpAirwayWriter::initQueries()
 {
   deInitQueries();
@@ -20,6 +20,7 @@
 #include "fs/common/airportindex.h"
 #include "fs/common/procedurewriter.h"
  #include "atools.h"
+#include "exception.h"
 
 namespace atools {
 namespace fs {
@@ -76,6 +77,9 @@ XpCifpWriter::XpCifpWriter(atools::sql::SqlDatabase& sqlDb, atools::fs::common::
   : XpWriter(sqlDb, opts, progressHandler, navdatabaseErrors)
 {
   procWriter = new atools::fs::common::ProcedureWriter(sqlDb, airportIndexParam);
+
+  // CIFP is read after all navaids and waypoints
+  procWriter->setBatchMode(true);
 }
 
 XpCifpWriter::~XpCifpWriter()
@@ -83,46 +87,82 @@ XpCifpWriter::~XpCifpWriter()
   delete procWriter;
 }
 
+/* Same as XpWriter::at() but usable without instance */
+static const QStringRef& fieldAt(const XpLineTokenizer& line, int index, const XpWriterContext& context)
+{
+  if(index < line.size())
+    return line.at(index);
+  else
+    // Have to stop reading the file since the rest can be corrupted
+    throw atools::Exception(context.messagePrefix() +
+                            QString(": Index out of bounds: Index: %1, size: %2").arg(index).arg(line.size()));
+}
+
 void XpCifpWriter::write(const QStringList& line, const XpWriterContext& context)
+{
+  XpLineTokenizer tokens;
+  tokens.setFields(line);
+  write(tokens, context);
+}
+
+void XpCifpWriter::write(const XpLineTokenizer& line, const XpWriterContext& context)
+{
+  ctx = &context;
+
+  atools::fs::common::ProcedureInput procInput;
+  if(toProcedureInput(line, context, procInput))
+    procWriter->write(procInput);
+}
+
+void XpCifpWriter::write(const QVector<atools::fs::common::ProcedureInput>& procInputs,
+                         const XpWriterContext& context)
 {
   ctx = &context;
+
+  for(const atools::fs::common::ProcedureInput& procInput : procInputs)
+    procWriter->write(procInput);
+
+  finish(context);
+}
+
+bool XpCifpWriter::toProcedureInput(const XpLineTokenizer& line, const XpWriterContext& context,
+                                    atools::fs::common::ProcedureInput& procInput)
+{
   if(line.isEmpty())
-    return;
+    return false;
 
-  QString rowCode = line.at(PROC_ROW_CODE);
-  if(!(rowCode == "SID" || rowCode == "STAR" || rowCode == "APPCH"))
+  const QStringRef& rowCode = line.at(PROC_ROW_CODE);
+  if(!(rowCode == QLatin1String("SID") || rowCode == QLatin1String("STAR") || rowCode == QLatin1String("APPCH")))
     // Skip all unknown row codes
-    return;
-
-  atools::fs::common::ProcedureInput procInput;
+    return false;
 
   procInput.context = context.messagePrefix();
   procInput.airportIdent = context.cifpAirportIdent;
   procInput.airportId = context.cifpAirportId;
 
-  procInput.rowCode = at(line, PROC_ROW_CODE).trimmed();
-  procInput.seqNr = at(line, SEQ_NR).toInt();
-  procInput.routeType = atools::strToChar(at(line, RT_TYPE));
-  procInput.sidStarAppIdent = at(line, SID_STAR_APP_IDENT).trimmed();
-  procInput.transIdent = at(line, TRANS_IDENT).trimmed();
-  procInput.fixIdent = at(line, FIX_IDENT).trimmed();
-  procInput.region = at(line, ICAO_CODE).trimmed();
-  procInput.secCode = at(line, SEC_CODE);
-  procInput.subCode = at(line, SUB_CODE);
-  procInput.descCode = at(line, DESC_CODE);
-  procInput.turnDir = at(line, TURN_DIR).trimmed();
-  procInput.pathTerm = at(line, PATH_TERM).trimmed();
-  procInput.recdNavaid = at(line, RECD_NAVAID).trimmed();
-  procInput.recdRegion = at(line, RECD_ICAO_CODE).trimmed();
-  procInput.recdSecCode = at(line, RECD_SEC_CODE);
-  procInput.recdSubCode = at(line, RECD_SUB_CODE);
-
-  procInput.theta = at(line, THETA).toFloat() / 10.f;
-  procInput.rho = at(line, RHO).toFloat() / 10.f;
-  procInput.magCourse = at(line, MAG_CRS).toFloat() / 10.f;
+  procInput.rowCode = fieldAt(line, PROC_ROW_CODE, context).trimmed().toString();
+  procInput.seqNr = fieldAt(line, SEQ_NR, context).toInt();
+  procInput.routeType = atools::strToChar(fieldAt(line, RT_TYPE, context).toString());
+  procInput.sidStarAppIdent = fieldAt(line, SID_STAR_APP_IDENT, context).trimmed().toString();
+  procInput.transIdent = fieldAt(line, TRANS_IDENT, context).trimmed().toString();
+  procInput.fixIdent = fieldAt(line, FIX_IDENT, context).trimmed().toString();
+  procInput.region = fieldAt(line, ICAO_CODE, context).trimmed().toString();
+  procInput.secCode = fieldAt(line, SEC_CODE, context).toString();
+  procInput.subCode = fieldAt(line, SUB_CODE, context).toString();
+  procInput.descCode = fieldAt(line, DESC_CODE, context).toString();
+  procInput.turnDir = fieldAt(line, TURN_DIR, context).trimmed().toString();
+  procInput.pathTerm = fieldAt(line, PATH_TERM, context).trimmed().toString();
+  procInput.recdNavaid = fieldAt(line, RECD_NAVAID, context).trimmed().toString();
+  procInput.recdRegion = fieldAt(line, RECD_ICAO_CODE, context).trimmed().toString();
+  procInput.recdSecCode = fieldAt(line, RECD_SEC_CODE, context).toString();
+  procInput.recdSubCode = fieldAt(line, RECD_SUB_CODE, context).toString();
+
+  procInput.theta = fieldAt(line, THETA, context).toFloat() / 10.f;
+  procInput.rho = fieldAt(line, RHO, context).toFloat() / 10.f;
+  procInput.magCourse = fieldAt(line, MAG_CRS, context).toFloat() / 10.f;
 
   procInput.rteHoldTime = procInput.rteHoldDist = 0.f;
-  QString distTime = at(line, RTE_DIST_HOLD_DIST_TIME).trimmed();
+  QString distTime = fieldAt(line, RTE_DIST_HOLD_DIST_TIME, context).trimmed().toString();
   if(distTime.startsWith("T"))
     // time minutes/10
     procInput.rteHoldTime = distTime.mid(1).toFloat() / 10.f;
@@ -130,19 +170,19 @@ void XpCifpWriter::write(const QStringList& line, const XpWriterContext& context
     // distance nm/10
     procInput.rteHoldDist = distTime.toFloat() / 10.f;
 
-  procInput.altDescr = at(line, ALT_DESCR).trimmed();
-  procInput.altitude = at(line, ALTITUDE).trimmed();
-  procInput.altitude2 = at(line, ALTITUDE2).trimmed();
-  procInput.transAlt = at(line, TRANS_ALT).trimmed();
-  procInput.speedLimitDescr = at(line, SPD_LIMIT_DESCR).trimmed();
-  procInput.speedLimit = at(line, SPEED_LIMIT).toInt();
-  procInput.centerFixOrTaaPt = at(line, CENTER_FIX_OR_TAA_PT).trimmed();
-  procInput.centerIcaoCode = at(line, CENTER_ICAO_CODE).trimmed();
-  procInput.centerSecCode = at(line, CENTER_SEC_CODE);
-  procInput.centerSubCode = at(line, CENTER_SUB_CODE);
-  procInput.gnssFmsIndicator = at(line, GNSS_FMS_IND);
-
-  procWriter->write(procInput);
+  procInput.altDescr = fieldAt(line, ALT_DESCR, context).trimmed().toString();
+  procInput.altitude = fieldAt(line, ALTITUDE, context).trimmed().toString();
+  procInput.altitude2 = fieldAt(line, ALTITUDE2, context).trimmed().toString();
+  procInput.transAlt = fieldAt(line, TRANS_ALT, context).trimmed().toString();
+  procInput.speedLimitDescr = fieldAt(line, SPD_LIMIT_DESCR, context).trimmed().toString();
+  procInput.speedLimit = fieldAt(line, SPEED_LIMIT, context).toInt();
+  procInput.centerFixOrTaaPt = fieldAt(line, CENTER_FIX_OR_TAA_PT, context).trimmed().toString();
+  procInput.centerIcaoCode = fieldAt(line, CENTER_ICAO_CODE, context).trimmed().toString();
+  procInput.centerSecCode = fieldAt(line, CENTER_SEC_CODE, context).toString();
+  procInput.centerSubCode = fieldAt(line, CENTER_SUB_CODE, context).toString();
+  procInput.gnssFmsIndicator = fieldAt(line, GNSS_FMS_IND, context).toString();
+
+  return true;
 }
 
 void XpCifpWriter::finish(const XpWriterContext& context)
@@ -161,6 +201,11 @@ void XpCifpWriter::reset()
   procWriter->reset();
 }
 
+void XpCifpWriter::flush()
+{
+  procWriter->flush();
+}
+
 } // namespace xp
 } // namespace fs
 } // namespace atools
@@ -37,6 +37,7 @@ class ProgressHandler;
 namespace common {
 class AirportIndex;
 class ProcedureWriter;
+struct ProcedureInput;
 }
 
 namespace xp {
@@ -54,9 +55,21 @@ public:
   virtual ~XpCifpWriter();
 
   virtual void write(const QStringList& line, const XpWriterContext& context) override;
+  virtual void write(const atools::fs::xp::XpLineTokenizer& line, const XpWriterContext& context) override;
+
+  /* Write all procedures of a file which were read using toProcedureInput() and call finish() */
+  void write(const QVector<atools::fs::common::ProcedureInput>& procInputs, const XpWriterContext& context);
   virtual void finish(const XpWriterContext& context) override;
   virtual void reset() override;
 
+  /* Write all collected procedures. Call when all files are read. */
+  void flush();
+
+  /* Convert a CIFP line into procedure input. Returns false for empty lines and unknown row codes.
+   * Does not access the database and can be called from threads. Throws an exception if fields are missing. */
+  static bool toProcedureInput(const atools::fs::xp::XpLineTokenizer& line, const XpWriterContext& context,
+                               atools::fs::common::ProcedureInput& procInput);
+
 private:
 
   atools::fs::common::ProcedureWriter *procWriter = nullptr;
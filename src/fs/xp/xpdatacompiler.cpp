@@ -23,6 +23,8 @@
 #include "fs/xp/xpairwaywriter.h"
 #include "fs/xp/xpairportwriter.h"
 #include "fs/xp/xpcifpwriter.h"
+#include "fs/common/procedurewriter.h"
+#include "fs/xp/xplinetokenizer.h"
 #include "fs/xp/xpairspacewriter.h"
 #include "fs/xp/scenerypacks.h"
 #include "fs/common/magdecreader.h"
@@ -39,15 +41,18 @@
 #include "fs/common/airportindex.h"
 #include "fs/common/metadatawriter.h"
 #include "fs/navdatabaseerrors.h"
+#include "util/tracerecorder.h"
 
 #include <QFileInfo>
 #include <QDir>
 #include <QDebug>
 #include <QDateTime>
-#include <QElapsedTimer>
 #include <QRegularExpression>
 #include <QStandardPaths>
 #include <QTextCodec>
+#include <QThreadPool>
+
+#include <algorithm>
 
 using atools::sql::SqlQuery;
 using atools::sql::SqlUtil;
@@ -66,8 +71,20 @@ namespace xp {
 // Reports per large file
 const static int NUM_REPORT_STEPS = 10000;
 
-/* Report progress twice a second */
-const static int MIN_PROGRESS_REPORT_MS = 500;
+/* Minimum number of lines per parallel apt.dat chunk. Chunks are extended up to the next airport header. */
+const static int APT_CHUNK_LINES = 20000;
+
+/* Minimum apt.dat file size in bytes for parallel reading */
+const static qint64 APT_PARALLEL_MIN_SIZE = 1024 * 1024;
+
+/* Number of CIFP files per thread read ahead while the previous ones are written */
+const static int CIFP_FILES_PER_THREAD = 16;
+
+/* Minimum number of lines per parallel airspace chunk. Chunks are extended up to the end of the next airspace. */
+const static int AIRSPACE_CHUNK_LINES = 5000;
+
+/* Number of chunks per thread read ahead while the previous ones are written */
+const static int APT_CHUNKS_PER_THREAD = 2;
 
 // Check for correct CIFP file basenames
 const static QRegularExpression CIFP_MATCH("^[A-Z0-9]{3,8}$");
@@ -112,6 +129,8 @@ bool XpDataCompiler::writeBasepathScenery()
 
 bool XpDataCompiler::compileEarthFix()
 {
+  ATOOLS_TRACE_SPAN("XpDataCompiler::compileEarthFix", "xplane");
+
   QString path = buildPathNoCase({basePath, "earth_fix.dat"});
 
   if(QFileInfo::exists(path))
@@ -128,6 +147,8 @@ bool XpDataCompiler::compileEarthFix()
 
 bool XpDataCompiler::compileEarthAirway()
 {
+  ATOOLS_TRACE_SPAN("XpDataCompiler::compileEarthAirway", "xplane");
+
 
   QString path = buildPathNoCase({basePath, "earth_awy.dat"});
 
@@ -145,6 +166,8 @@ bool XpDataCompiler::compileEarthAirway()
 
 bool XpDataCompiler::postProcessEarthAirway()
 {
+  ATOOLS_TRACE_SPAN("XpDataCompiler::postProcessEarthAirway", "xplane");
+
   bool aborted = false;
   if((aborted = progress->reportOther(tr("Post procecssing Airways"))))
     return true;
@@ -157,6 +180,8 @@ bool XpDataCompiler::postProcessEarthAirway()
 
 bool XpDataCompiler::compileEarthNav()
 {
+  ATOOLS_TRACE_SPAN("XpDataCompiler::compileEarthNav", "xplane");
+
   QString path = buildPathNoCase({basePath, "earth_nav.dat"});
   if(QFileInfo::exists(path))
   {
@@ -171,6 +196,8 @@ bool XpDataCompiler::compileEarthNav()
 
 bool XpDataCompiler::compileCustomApt()
 {
+  ATOOLS_TRACE_SPAN("XpDataCompiler::compileCustomApt", "xplane");
+
   // X-Plane 11/Custom Scenery/KSEA Demo Area/Earth nav data/apt.dat
   // X-Plane 11/Custom Scenery/LFPG Paris - Charles de Gaulle/Earth Nav data/apt.dat
   QStringList localFindCustomAptDatFiles = findCustomAptDatFiles(options, errors, progress);
@@ -185,6 +212,8 @@ bool XpDataCompiler::compileCustomApt()
 
 bool XpDataCompiler::compileCustomGlobalApt()
 {
+  ATOOLS_TRACE_SPAN("XpDataCompiler::compileCustomGlobalApt", "xplane");
+
   // X-Plane 11/Custom Scenery/Global Airports/Earth nav data/apt.dat
   QString path = buildPathNoCase({options.getBasepath(),
                                   "Custom Scenery", "Global Airports", "Earth nav data", "apt.dat"});
@@ -204,6 +233,8 @@ bool XpDataCompiler::compileCustomGlobalApt()
 
 bool XpDataCompiler::compileDefaultApt()
 {
+  ATOOLS_TRACE_SPAN("XpDataCompiler::compileDefaultApt", "xplane");
+
   // X-Plane 11/Resources/default scenery/default apt dat/Earth nav data/apt.dat
   QString defaultAptDat = buildPathNoCase({options.getBasepath(),
                                            "Resources", "default scenery", "default apt dat",
@@ -222,14 +253,27 @@ bool XpDataCompiler::compileDefaultApt()
 
 bool XpDataCompiler::compileCifp()
 {
+  ATOOLS_TRACE_SPAN("XpDataCompiler::compileCifp", "xplane");
+
   QStringList cifpFiles = findCifpFiles(options);
 
+  if(options.isReadParallel() && options.getNumThreads() > 1 && cifpFiles.size() > 1)
+  {
+    // Read and parse files in threads and write procedures in file order
+    if(compileCifpParallel(cifpFiles))
+      return true;
+    cifpWriter->flush();
+    db.commit();
+    return false;
+  }
+
   for(const QString& file : cifpFiles)
   {
     if(options.isIncludedFilename(file))
       if(readDataFile(file, 1, cifpWriter, READ_CIFP | READ_SHORT_REPORT))
         return true;
   }
+  cifpWriter->flush();
   db.commit();
 
   return false;
@@ -237,8 +281,19 @@ bool XpDataCompiler::compileCifp()
 
 bool XpDataCompiler::compileAirspaces()
 {
+  ATOOLS_TRACE_SPAN("XpDataCompiler::compileAirspaces", "xplane");
+
   QStringList airspaceFiles = findAirspaceFiles(options);
 
+  if(options.isReadParallel() && options.getNumThreads() > 1)
+  {
+    // Parse airspaces and build geometry in threads and write them in file order
+    if(compileAirspacesParallel(airspaceFiles))
+      return true;
+    db.commit();
+    return false;
+  }
+
   for(const QString& file : airspaceFiles)
   {
     if(options.isIncludedFilename(file))
@@ -252,6 +307,8 @@ bool XpDataCompiler::compileAirspaces()
 
 bool XpDataCompiler::compileLocalizers()
 {
+  ATOOLS_TRACE_SPAN("XpDataCompiler::compileLocalizers", "xplane");
+
   QString path = buildPathNoCase({options.getBasepath(), "Custom Scenery", "Global Airports",
                                   "Earth nav data", "earth_nav.dat"});
 
@@ -271,6 +328,8 @@ bool XpDataCompiler::compileLocalizers()
 
 bool XpDataCompiler::compileUserNav()
 {
+  ATOOLS_TRACE_SPAN("XpDataCompiler::compileUserNav", "xplane");
+
   QString path = buildPathNoCase({options.getBasepath(), "Custom Data", "user_nav.dat"});
 
   if(QFileInfo::exists(path))
@@ -286,6 +345,8 @@ bool XpDataCompiler::compileUserNav()
 
 bool XpDataCompiler::compileUserFix()
 {
+  ATOOLS_TRACE_SPAN("XpDataCompiler::compileUserFix", "xplane");
+
   QString path = buildPathNoCase({options.getBasepath(), "Custom Data", "user_fix.dat"});
 
   if(QFileInfo::exists(path))
@@ -301,6 +362,8 @@ bool XpDataCompiler::compileUserFix()
 
 bool XpDataCompiler::compileMagDeclBgl()
 {
+  ATOOLS_TRACE_SPAN("XpDataCompiler::compileMagDeclBgl", "xplane");
+
   // Look first in config dir and then in local dir
   QString file =
     Settings::instance().getOverloadedPath(buildPath({QApplication::applicationDirPath(), "magdec", "magdec.bgl"}));
@@ -318,6 +381,7 @@ bool XpDataCompiler::readDataFile(const QString& filepath, int minColumns, XpWri
 {
   QFile file;
   QTextStream stream;
+  XpLineTokenizer reader; // Has to be destroyed before file
   bool aborted = false;
 
   QString progressMsg = tr("Reading: %1").arg(filepath);
@@ -330,12 +394,12 @@ bool XpDataCompiler::readDataFile(const QString& filepath, int minColumns, XpWri
     // Clear add-on flag if directory is excluded
     flags &= ~atools::fs::xp::IS_ADDON;
 
-  int lineNum = 1, totalNumLines, fileVersion = 0;
+  int lineNum = 1, fileVersion = 0;
 
   try
   {
     // Open file and read header
-    if(openFile(stream, file, filepath, flags, lineNum, totalNumLines, fileVersion))
+    if(openFile(reader, stream, file, filepath, flags, lineNum, fileVersion))
     {
       XpWriterContext context;
       context.curFileId = curFileId;
@@ -361,83 +425,78 @@ bool XpDataCompiler::readDataFile(const QString& filepath, int minColumns, XpWri
         context.cifpAirportId = airportIndex->getAirportId(context.cifpAirportIdent).toInt();
       }
 
-      QString line;
-      QStringList fields;
-
-      QElapsedTimer timer;
-      timer.start();
-      qint64 elapsed = timer.elapsed();
+      // Estimate progress from byte offset in mapped files
+      qint64 bytesPerStep = std::max(reader.getSize() / NUM_REPORT_STEPS, static_cast<qint64>(1));
+      qint64 nextReportPos = 0;
+      int steps = 0;
 
-      int rowsPerStep =
-        static_cast<int>(std::ceil(static_cast<float>(totalNumLines) / static_cast<float>(NUM_REPORT_STEPS)));
-      int row = 0, steps = 0;
-
-      // Read lines
-      while(!stream.atEnd() && line != "99")
+      // Report progress for all steps up to bytePos - returns true if aborted
+      auto reportProgress = [&](qint64 bytePos) -> bool
       {
-        line = stream.readLine().trimmed();
-
         if(!(flags & READ_SHORT_REPORT))
         {
-          if((row++ % rowsPerStep) == 0)
+          while(bytePos >= nextReportPos && steps < NUM_REPORT_STEPS)
           {
-            qint64 elapsed2 = timer.elapsed();
+            nextReportPos += bytesPerStep;
 
-            // Update only every 500 ms - otherwise update only progress count
-            bool silent = !(elapsed + MIN_PROGRESS_REPORT_MS < elapsed2);
-            if(!silent)
-              elapsed = elapsed2;
+            // Calls handler only every 500 ms - otherwise updates only progress count
             steps++;
-            if((aborted = progress->reportOther(progressMsg, -1, silent)) == true)
-              break;
+            if(progress->reportOtherThrottled(progressMsg))
+              return true;
           }
         }
+        return false;
+      };
 
-        if(flags & READ_AIRSPACE && !line.startsWith("AN"))
-        {
-          // Strip OpenAirport file comments except for airport names
-          int idx = line.indexOf("*");
-          if(idx != -1)
-            line = line.left(line.indexOf("*"));
-        }
-        else if(!(flags & READ_CIFP))
+      if(writer == airportWriter && options.isReadParallel() && options.getNumThreads() > 1 &&
+         reader.getSize() > APT_PARALLEL_MIN_SIZE)
+        // Large apt.dat file - tokenize airports in parallel
+        aborted = readAptDataParallel(reader, minColumns, writer, context, lineNum, reportProgress);
+      else
+      {
+        // Read lines into a reused buffer - fields are views into the buffer
+        while(reader.line() != QLatin1String("99") && reader.readLine())
         {
-          // Strip dat-file comments
-          if(line.startsWith("#"))
-            line.clear();
-        }
+          if((aborted = reportProgress(reader.getPos())) == true)
+            break;
 
-        if(!line.isEmpty())
-        {
-          if(flags & READ_CIFP)
-            fields = line.split(",");
-          else
-            fields = line.simplified().split(" ");
+          QStringRef line = reader.line();
+          if(flags & READ_AIRSPACE && !line.startsWith(QLatin1String("AN")))
+          {
+            // Strip OpenAirport file comments except for airport names
+            int idx = line.indexOf('*');
+            if(idx != -1)
+              reader.truncate(idx);
+          }
+          else if(!(flags & READ_CIFP))
+          {
+            // Strip dat-file comments
+            if(line.startsWith('#'))
+              reader.truncate(0);
+          }
 
-          if(fields.size() >= minColumns)
+          if(!reader.line().isEmpty())
           {
             if(flags & READ_CIFP)
+              reader.tokenizeCifp();
+            else
+              reader.tokenizeSpace();
+
+            if(reader.size() >= minColumns)
             {
-              // Extract colon separated row code
-              QString first = fields.takeFirst();
-              QStringList rowCode = first.split(":");
-              if(rowCode.size() == 2)
-              {
-                fields.prepend(rowCode.at(1));
-                fields.prepend(rowCode.at(0));
-              }
-            }
-            context.lineNumber = lineNum;
+              context.lineNumber = lineNum;
 
-            // Call writer
-            writer->write(fields, context);
+              // Call writer
+              writer->write(reader, context);
+            }
           }
+          lineNum++;
         }
-        lineNum++;
       }
       if(!aborted)
         writer->finish(context);
 
+      reader.close();
       file.close();
 
       if(!(flags & READ_SHORT_REPORT))
@@ -465,9 +524,550 @@ bool XpDataCompiler::readDataFile(const QString& filepath, int minColumns, XpWri
   return aborted;
 }
 
-bool XpDataCompiler::openFile(QTextStream& stream, QFile& filepath, const QString& filename,
-                              atools::fs::xp::ContextFlags flags,
-                              int& lineNum, int& totalNumLines, int& fileVersion)
+/* Tokenized row of an apt.dat file */
+struct AptRow
+{
+  QStringList fields;
+  int lineNumber;
+};
+
+/* Lines of one or more complete airports and the tokenized rows */
+struct AptChunk
+{
+  QStringList lines;
+  int firstLineNumber = 0;
+  qint64 beginPos = 0, endPos = 0; /* Byte offsets in file for progress */
+  QVector<AptRow> rows;
+};
+
+/* Line starts with an airport, seaplane base or heliport header row code */
+static bool isAptHeader(const QStringRef& line)
+{
+  int i = 0;
+  while(i < line.size() && line.at(i).isSpace())
+    i++;
+
+  if(i + 1 < line.size() && line.at(i) == '1')
+  {
+    QChar c = line.at(i + 1);
+    if(c.isSpace())
+      return true; // 1 Land airport
+
+    if((c == '6' || c == '7') && i + 2 < line.size() && line.at(i + 2).isSpace())
+      return true; // 16 Seaplane base, 17 Heliport
+  }
+  return false;
+}
+
+/* Tokenizes a range of chunks. Does the same as the sequential loop in XpDataCompiler::readDataFile. */
+class AptChunkTask :
+  public QRunnable
+{
+public:
+  AptChunkTask(QVector<AptChunk> *chunkList, int beginIndex, int endIndex, int minColumns)
+    : chunks(chunkList), begin(beginIndex), end(endIndex), columns(minColumns)
+  {
+    setAutoDelete(true);
+  }
+
+  virtual void run() override
+  {
+    ATOOLS_TRACE_SPAN("AptChunkTask", "xplane");
+
+    for(int i = begin; i < end; i++)
+    {
+      AptChunk& chunk = (*chunks)[i];
+      chunk.rows.reserve(chunk.lines.size());
+
+      int lineNumber = chunk.firstLineNumber;
+      for(const QString& rawLine : chunk.lines)
+      {
+        QString line = rawLine.trimmed();
+
+        // Strip dat-file comments
+        if(!line.isEmpty() && !line.startsWith("#"))
+        {
+          QStringList fields = line.simplified().split(" ");
+          if(fields.size() >= columns)
+            chunk.rows.append({fields, lineNumber});
+        }
+        lineNumber++;
+      }
+      chunk.lines.clear();
+    }
+  }
+
+private:
+  QVector<AptChunk> *chunks;
+  int begin, end, columns;
+};
+
+/* CIFP file read by a thread and all procedure rows found */
+struct CifpFile
+{
+  XpWriterContext context;
+  QVector<atools::fs::common::ProcedureInput> procInputs;
+  QString errorMessage; /* Not empty if reading failed */
+  int errorLineNum = 0;
+};
+
+/* Reads and converts a range of CIFP files. Does the same as readDataFile for the CIFP flag. */
+class CifpFileTask :
+  public QRunnable
+{
+public:
+  CifpFileTask(QVector<CifpFile> *fileList, int beginIndex, int endIndex)
+    : files(fileList), begin(beginIndex), end(endIndex)
+  {
+    setAutoDelete(true);
+  }
+
+  virtual void run() override
+  {
+    ATOOLS_TRACE_SPAN("CifpFileTask", "xplane");
+
+    for(int i = begin; i < end; i++)
+    {
+      CifpFile& cifpFile = (*files)[i];
+      if(!cifpFile.errorMessage.isEmpty())
+        continue;
+
+      XpWriterContext& context = cifpFile.context;
+      context.lineNumber = 1;
+      try
+      {
+        QFile file(context.filePath);
+        if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+          throw atools::Exception("Cannot open file. Reason: " + file.errorString() + ".");
+
+        QTextStream stream(&file);
+        stream.setCodec("UTF-8");
+        stream.setAutoDetectUnicode(true);
+
+        XpLineTokenizer reader;
+        reader.setStream(&stream);
+        while(reader.line() != QLatin1String("99") && reader.readLine())
+        {
+          if(!reader.line().isEmpty())
+          {
+            reader.tokenizeCifp();
+
+            atools::fs::common::ProcedureInput procInput;
+            if(XpCifpWriter::toProcedureInput(reader, context, procInput))
+              cifpFile.procInputs.append(procInput);
+          }
+          context.lineNumber++;
+        }
+        reader.close();
+      }
+      catch(std::exception& e)
+      {
+        cifpFile.errorMessage = e.what();
+        cifpFile.errorLineNum = context.lineNumber;
+      }
+    }
+  }
+
+private:
+  QVector<CifpFile> *files;
+  int begin, end;
+};
+
+bool XpDataCompiler::compileCifpParallel(const QStringList& cifpFiles)
+{
+  // Prepare contexts in file order - database access and id assignment stay in this thread
+  QVector<CifpFile> allFiles;
+  for(const QString& filepath : cifpFiles)
+  {
+    QFileInfo fileinfo(filepath);
+    if(!options.isIncludedFilename(filepath) || !includeFile(fileinfo))
+      continue;
+
+    CifpFile cifpFile;
+    XpWriterContext& context = cifpFile.context;
+    context.fileName = fileinfo.fileName();
+    context.filePath = fileinfo.filePath();
+    context.localPath = QDir(options.getBasepath()).relativeFilePath(fileinfo.path());
+    context.flags = READ_CIFP | READ_SHORT_REPORT | flagsFromOptions();
+    context.magDecReader = magDecReader;
+
+    QString ident = fileinfo.baseName().toUpper();
+    if(CIFP_MATCH.match(ident).hasMatch())
+    {
+      // Add additional information for procedure files
+      context.cifpAirportIdent = ident;
+      context.cifpAirportId = airportIndex->getAirportId(ident).toInt();
+    }
+    else
+      cifpFile.errorMessage = "CIFP file has no valid name which should match airport ident.";
+
+    allFiles.append(cifpFile);
+  }
+
+  int numThreads = options.getNumThreads();
+  int batchSize = numThreads * CIFP_FILES_PER_THREAD;
+
+  // Files being written and files being read - declared before the pool which waits for all tasks
+  QVector<CifpFile> current, next;
+
+  QThreadPool threadPool;
+  threadPool.setMaxThreadCount(numThreads);
+
+  int nextFile = 0;
+  auto startFiles = [&](QVector<CifpFile>& files) -> void
+  {
+    files = allFiles.mid(nextFile, batchSize);
+    nextFile += files.size();
+
+    int rangeSize = std::max(files.size() / numThreads, 1);
+    for(int rangeBegin = 0; rangeBegin < files.size(); rangeBegin += rangeSize)
+      threadPool.start(new CifpFileTask(&files, rangeBegin, std::min(rangeBegin + rangeSize, files.size())));
+  };
+
+  startFiles(current);
+  threadPool.waitForDone();
+
+  while(!current.isEmpty())
+  {
+    // Read the next set of files while the current ones are written
+    startFiles(next);
+
+    for(CifpFile& cifpFile : current)
+    {
+      XpWriterContext& context = cifpFile.context;
+      try
+      {
+        metadataWriter->writeFile(context.filePath, QString(), curSceneryId, ++curFileId);
+        progress->incNumFiles();
+        context.curFileId = curFileId;
+
+        if(progress->reportOther(tr("Reading: %1").arg(context.filePath)))
+        {
+          threadPool.waitForDone();
+          return true;
+        }
+
+        if(!cifpFile.errorMessage.isEmpty())
+          throw atools::Exception(cifpFile.errorMessage);
+
+        cifpWriter->write(cifpFile.procInputs, context);
+      }
+      catch(std::exception& e)
+      {
+        int lineNum = cifpFile.errorMessage.isEmpty() ? 0 : cifpFile.errorLineNum;
+        if(errors != nullptr)
+        {
+          progress->reportError();
+          errors->sceneryErrors.first().fileErrors.append({context.filePath, e.what(), lineNum});
+          qWarning() << Q_FUNC_INFO << "Error in file" << context.filePath << "line" << lineNum << ":" << e.what();
+        }
+        else
+        {
+          cifpWriter->reset();
+          threadPool.waitForDone();
+          // Enrich error message and rethrow a new one
+          throw atools::Exception(QString("Caught exception in file \"%1\" in line %2. Message: %3").
+                                  arg(context.filePath).arg(lineNum).arg(e.what()));
+        }
+      }
+      cifpWriter->reset();
+    }
+
+    threadPool.waitForDone();
+    current.swap(next);
+  }
+  return false;
+}
+
+/* Lines of one or more complete airspaces and the airspaces built by the parser */
+struct AirspaceChunk
+{
+  XpWriterContext context;
+  QStringList lines;
+  QVector<int> lineNumbers;
+  QVector<XpAirspace> airspaces;
+  QString errorMessage; /* Not empty if parsing failed */
+  int errorLineNum = 0;
+};
+
+/* Parses a chunk of airspace lines. Does the same as readDataFile for the airspace flag. */
+class AirspaceChunkTask :
+  public QRunnable
+{
+public:
+  explicit AirspaceChunkTask(AirspaceChunk *airspaceChunk)
+    : chunk(airspaceChunk)
+  {
+    setAutoDelete(true);
+  }
+
+  virtual void run() override
+  {
+    ATOOLS_TRACE_SPAN("AirspaceChunkTask", "xplane");
+
+    XpAirspaceParser parser;
+    XpLineTokenizer tokens;
+    XpWriterContext& context = chunk->context;
+    try
+    {
+      for(int i = 0; i < chunk->lines.size(); i++)
+      {
+        QStringList fields = chunk->lines.at(i).simplified().split(" ");
+        tokens.setFields(fields);
+        context.lineNumber = chunk->lineNumbers.at(i);
+        parser.parse(tokens, context);
+      }
+
+      // Chunk ends before a line which finishes the airspace or at the end of the file
+      parser.finish(context);
+    }
+    catch(std::exception& e)
+    {
+      chunk->errorMessage = e.what();
+      chunk->errorLineNum = context.lineNumber;
+    }
+    chunk->airspaces.swap(parser.getAirspaces());
+    chunk->lines.clear();
+  }
+
+private:
+  AirspaceChunk *chunk;
+};
+
+bool XpDataCompiler::compileAirspacesParallel(const QStringList& airspaceFiles)
+{
+  int numThreads = options.getNumThreads();
+
+  for(const QString& filepath : airspaceFiles)
+  {
+    QFileInfo fileinfo(filepath);
+    if(!options.isIncludedFilename(filepath) || !includeFile(fileinfo))
+      continue;
+
+    XpWriterContext context;
+    context.fileName = fileinfo.fileName();
+    context.filePath = fileinfo.filePath();
+    context.localPath = QDir(options.getBasepath()).relativeFilePath(fileinfo.path());
+    context.flags = READ_AIRSPACE | READ_SHORT_REPORT | flagsFromOptions();
+    context.magDecReader = magDecReader;
+
+    // Chunks are declared before the pool which waits for all tasks
+    QVector<AirspaceChunk> chunks;
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(numThreads);
+
+    QFile file;
+    QTextStream stream;
+    XpLineTokenizer reader; // Has to be destroyed before file
+    int lineNum = 1, fileVersion = 0;
+    try
+    {
+      // Open file, detect codec and write file metadata
+      openFile(reader, stream, file, filepath, READ_AIRSPACE | READ_SHORT_REPORT, lineNum, fileVersion);
+      context.curFileId = curFileId;
+      context.fileVersion = fileVersion;
+
+      if(progress->reportOther(tr("Reading: %1").arg(filepath)))
+        return true;
+
+      // Split lines into chunks at the end of an airspace where a new parser gives the same result
+      AirspaceChunk chunk;
+      chunk.context = context;
+      bool prevGeometry = false;
+      while(reader.line() != QLatin1String("99") && reader.readLine())
+      {
+        QStringRef line = reader.line();
+        if(!line.startsWith(QLatin1String("AN")))
+        {
+          // Strip OpenAirport file comments except for airport names
+          int idx = line.indexOf('*');
+          if(idx != -1)
+            reader.truncate(idx);
+        }
+
+        line = reader.line();
+        if(!line.isEmpty())
+        {
+          int keyEnd = 0;
+          while(keyEnd < line.size() && !line.at(keyEnd).isSpace())
+            keyEnd++;
+          bool geometry = XpAirspaceParser::isGeometryKey(line.left(keyEnd));
+
+          if(prevGeometry && !geometry && chunk.lines.size() >= AIRSPACE_CHUNK_LINES)
+          {
+            chunks.append(chunk);
+            chunk.lines.clear();
+            chunk.lineNumbers.clear();
+          }
+
+          chunk.lines.append(line.toString());
+          chunk.lineNumbers.append(lineNum);
+          prevGeometry = geometry;
+        }
+        lineNum++;
+      }
+      chunks.append(chunk);
+      reader.close();
+      file.close();
+
+      // Parse and build geometry for all chunks
+      for(AirspaceChunk& airspaceChunk : chunks)
+        threadPool.start(new AirspaceChunkTask(&airspaceChunk));
+      threadPool.waitForDone();
+
+      // Write in file order and stop at the first error like the sequential reader
+      for(const AirspaceChunk& airspaceChunk : chunks)
+      {
+        airspaceWriter->write(airspaceChunk.airspaces, context);
+        if(!airspaceChunk.errorMessage.isEmpty())
+        {
+          lineNum = airspaceChunk.errorLineNum;
+          throw atools::Exception(airspaceChunk.errorMessage);
+        }
+      }
+    }
+    catch(std::exception& e)
+    {
+      threadPool.waitForDone();
+      if(errors != nullptr)
+      {
+        progress->reportError();
+        errors->sceneryErrors.first().fileErrors.append({fileinfo.filePath(), e.what(), lineNum});
+        qWarning() << Q_FUNC_INFO << "Error in file" << fileinfo.filePath() << "line" << lineNum << ":" << e.what();
+      }
+      else
+      {
+        airspaceWriter->reset();
+        // Enrich error message and rethrow a new one
+        throw atools::Exception(QString("Caught exception in file \"%1\" in line %2. Message: %3").
+                                arg(fileinfo.filePath()).arg(lineNum).arg(e.what()));
+      }
+    }
+    airspaceWriter->reset();
+  }
+  return false;
+}
+
+bool XpDataCompiler::readAptDataParallel(XpLineTokenizer& reader, int minColumns, XpWriter *writer,
+                                         XpWriterContext& context, int& lineNum,
+                                         const std::function<bool(qint64 bytePos)>& reportProgress)
+{
+  int numThreads = options.getNumThreads();
+  int numChunks = numThreads * APT_CHUNKS_PER_THREAD;
+  bool endOfFile = false;
+  int nextLineNumber = lineNum;
+
+  // Read a set of chunks with complete airports each ending before an airport header
+  // The line "99" is the last one passed to the writer
+  QString pendingLine;
+  qint64 pendingPos = 0;
+  bool hasPendingLine = false;
+  auto readChunks = [&](QVector<AptChunk>& chunks) -> void
+  {
+    chunks.clear();
+    while(!endOfFile && chunks.size() < numChunks)
+    {
+      AptChunk chunk;
+      chunk.firstLineNumber = nextLineNumber;
+      chunk.beginPos = reader.getPos();
+      chunk.lines.reserve(APT_CHUNK_LINES + 1000);
+
+      if(hasPendingLine)
+      {
+        chunk.beginPos = pendingPos;
+        chunk.lines.append(pendingLine);
+        hasPendingLine = false;
+        nextLineNumber++;
+      }
+
+      qint64 linePos = reader.getPos();
+      while(reader.readLine())
+      {
+        QStringRef line = reader.line();
+        if(chunk.lines.size() >= APT_CHUNK_LINES && isAptHeader(line))
+        {
+          // Keep header for the next chunk
+          pendingLine = line.toString();
+          pendingPos = linePos;
+          hasPendingLine = true;
+          break;
+        }
+
+        chunk.lines.append(line.toString());
+        nextLineNumber++;
+
+        if(line == QLatin1String("99"))
+        {
+          endOfFile = true;
+          break;
+        }
+        linePos = reader.getPos();
+      }
+
+      if(!hasPendingLine)
+        endOfFile = true;
+
+      chunk.endPos = hasPendingLine ? pendingPos : reader.getPos();
+
+      if(!chunk.lines.isEmpty())
+        chunks.append(chunk);
+    }
+  };
+
+  // Chunks being written and chunks being tokenized - declared before the pool which waits for all tasks
+  QVector<AptChunk> current, next;
+
+  QThreadPool threadPool;
+  threadPool.setMaxThreadCount(numThreads);
+
+  auto startChunks = [&](QVector<AptChunk>& chunks) -> void
+  {
+    for(int i = 0; i < chunks.size(); i++)
+      threadPool.start(new AptChunkTask(&chunks, i, i + 1, minColumns));
+  };
+
+  readChunks(current);
+  startChunks(current);
+  threadPool.waitForDone();
+
+  while(!current.isEmpty())
+  {
+    // Tokenize the next set of chunks while the current ones are written
+    readChunks(next);
+    startChunks(next);
+
+    for(const AptChunk& chunk : current)
+    {
+      int numRows = chunk.rows.size();
+      for(int i = 0; i < numRows; i++)
+      {
+        // Interpolate file position of row for progress
+        if(reportProgress(chunk.beginPos + (chunk.endPos - chunk.beginPos) * i / numRows))
+        {
+          threadPool.waitForDone();
+          return true;
+        }
+
+        const AptRow& row = chunk.rows.at(i);
+        lineNum = row.lineNumber;
+        context.lineNumber = row.lineNumber;
+
+        // Call writer
+        writer->write(row.fields, context);
+      }
+    }
+
+    threadPool.waitForDone();
+    current.swap(next);
+  }
+
+  lineNum = nextLineNumber;
+  return false;
+}
+
+bool XpDataCompiler::openFile(XpLineTokenizer& reader, QTextStream& stream, QFile& filepath,
+                              const QString& filename, atools::fs::xp::ContextFlags flags,
+                              int& lineNum, int& fileVersion)
 {
   filepath.setFileName(filename);
   lineNum = 1;
@@ -479,26 +1079,31 @@ bool XpDataCompiler::openFile(QTextStream& stream, QFile& filepath, const QStrin
       // Try to detect code using the BOM for airspaces only - use ANSI as fallback
       stream.setDevice(&filepath);
       stream.setCodec(atools::codecForFile(filepath, QTextCodec::codecForName("Windows-1252")));
+      stream.setAutoDetectUnicode(true);
+      reader.setStream(&stream);
     }
-    else
+    else if(flags & READ_CIFP)
     {
       stream.setDevice(&filepath);
       stream.setCodec("UTF-8");
+      stream.setAutoDetectUnicode(true);
+      reader.setStream(&stream);
     }
-    stream.setAutoDetectUnicode(true);
-
-    QString line;
+    else
+      // Large dat files are read only once from mapped memory - progress is calculated from byte offset
+      reader.mapFile(filepath);
 
     if(!(flags & READ_CIFP) && !(flags & READ_AIRSPACE))
     {
       // Read file header =============================
       // Byte order identifier
-      line = stream.readLine();
+      reader.readLine();
       lineNum++;
-      qInfo() << line;
+      qInfo() << reader.line();
 
       // Metadata and copyright
-      line = stream.readLine();
+      reader.readLine();
+      QString line = reader.line().toString();
       lineNum++;
       qInfo() << line;
 
@@ -519,18 +1124,6 @@ bool XpDataCompiler::openFile(QTextStream& stream, QFile& filepath, const QStrin
 
       if(flags & UPDATE_CYCLE)
         updateAiracCycleFromHeader(line, filename, lineNum);
-
-      qDebug() << "Counting lines for" << filename;
-      qint64 pos = stream.pos();
-      int lines = 0;
-      while(!stream.atEnd())
-      {
-        stream.readLine();
-        lines++;
-      }
-      totalNumLines = lines;
-      stream.seek(pos);
-      qDebug() << lines;
     }
     else
     {
@@ -543,6 +1136,40 @@ bool XpDataCompiler::openFile(QTextStream& stream, QFile& filepath, const QStrin
   return true;
 }
 
+void XpDataCompiler::initFromDatabase(const QString& cycle)
+{
+  airacCycle = cycle;
+
+  SqlQuery query(db);
+  query.exec("select max(bgl_file_id) from bgl_file");
+  curFileId = query.next() ? query.valueInt(0) : 0;
+  query.exec("select max(scenery_area_id) from scenery_area");
+  curSceneryId = query.next() ? query.valueInt(0) : 0;
+
+  fixWriter->initIdsFromDatabase();
+  navWriter->initIdsFromDatabase();
+  airspaceWriter->initIdsFromDatabase();
+  airwayWriter->initIdsFromDatabase();
+  airportWriter->initIdsFromDatabase();
+
+  // Airports loaded before have precedence over the ones read later
+  query.exec("select airport_id, ident from airport");
+  while(query.next())
+    airportIndex->addAirport(query.valueStr("ident"), query.valueInt("airport_id"));
+
+  query.exec("select a.ident, e.name, e.runway_end_id from runway r "
+             "join airport a on r.airport_id = a.airport_id "
+             "join runway_end e on e.runway_end_id = r.primary_end_id or e.runway_end_id = r.secondary_end_id");
+  while(query.next())
+    airportIndex->addRunwayEnd(query.valueStr("ident"), query.valueStr("name"), query.valueInt("runway_end_id"));
+
+  query.exec("select loc_airport_ident, region, ident, ils_id from ils");
+  while(query.next())
+    airportIndex->addAirportIls(query.valueStr("loc_airport_ident"), query.valueStr("region"),
+                                query.valueStr("ident"), query.valueInt("ils_id"));
+  query.finish();
+}
+
 void XpDataCompiler::close()
 {
 
@@ -716,6 +1343,46 @@ int XpDataCompiler::calculateReportCount(const NavDatabaseOptions& opts)
   return reportCount;
 }
 
+QStringList XpDataCompiler::findAllFiles(const NavDatabaseOptions& opts)
+{
+  QStringList files;
+  QString base = buildBasePath(opts);
+
+  // earth_fix.dat earth_awy.dat earth_nav.dat from default or custom data
+  files.append(buildPathNoCase({base, "earth_fix.dat"}));
+  files.append(buildPathNoCase({base, "earth_awy.dat"}));
+  files.append(buildPathNoCase({base, "earth_nav.dat"}));
+
+  // Default and global airports, localizers and user data
+  files.append(buildPathNoCase({opts.getBasepath(), "Resources", "default scenery", "default apt dat",
+                                "Earth nav data", "apt.dat"}));
+  files.append(buildPathNoCase({opts.getBasepath(), "Custom Scenery", "Global Airports", "Earth nav data",
+                                "apt.dat"}));
+  files.append(buildPathNoCase({opts.getBasepath(), "Custom Scenery", "Global Airports", "Earth nav data",
+                                "earth_nav.dat"}));
+  files.append(buildPathNoCase({opts.getBasepath(), "Custom Data", "user_nav.dat"}));
+  files.append(buildPathNoCase({opts.getBasepath(), "Custom Data", "user_fix.dat"}));
+
+  // Order and enabled state of packs
+  files.append(buildPathNoCase({opts.getBasepath(), "Custom Scenery", "scenery_packs.ini"}));
+
+  files.append(Settings::instance().getOverloadedPath(buildPath({QApplication::applicationDirPath(),
+                                                                 "magdec", "magdec.bgl"})));
+
+  // Files are added in the same order as they are read which keeps the order of add-on airports
+  files.append(findCustomAptDatFiles(opts, nullptr, nullptr));
+  files.append(findCifpFiles(opts));
+  files.append(findAirspaceFiles(opts));
+
+  QStringList existing;
+  for(const QString& file : files)
+  {
+    if(QFileInfo(file).isFile())
+      existing.append(file);
+  }
+  return existing;
+}
+
 QStringList XpDataCompiler::loadFilepathsFromSceneryPacks(const NavDatabaseOptions& opts,
                                                           ProgressHandler *progressHandler,
                                                           NavDatabaseErrors *navdatabaseErrors)
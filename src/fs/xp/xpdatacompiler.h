@@ -22,6 +22,8 @@
 
 #include <QApplication>
 
+#include <functional>
+
 class QTextStream;
 class QFile;
 class QFileInfo;
@@ -53,6 +55,7 @@ class XpAirportWriter;
 class XpCifpWriter;
 class XpAirspaceWriter;
 class XpWriter;
+class XpLineTokenizer;
 class AirwayPostProcess;
 
 /*
@@ -192,6 +195,10 @@ public:
   /* Calculate number of files to be read */
   static int calculateReportCount(const atools::fs::NavDatabaseOptions& opts);
 
+  /* All existing files which are read by a compilation including scenery_packs.ini and the magnetic declination
+   * file. Used to detect changes between compilations in incremental mode. */
+  static QStringList findAllFiles(const atools::fs::NavDatabaseOptions& opts);
+
   /* minmum accepted file version */
   void setMinVersion(int value)
   {
@@ -207,17 +214,36 @@ public:
     return airacCycle;
   }
 
+  /* Restore ids, airport index and cycle from the already loaded data when resuming an aborted compilation.
+   * Cycle is saved with the checkpoint since the files containing it might not be read again. */
+  void initFromDatabase(const QString& cycle);
+
 private:
   void initQueries();
   void deInitQueries();
 
-  /* Open file and read header */
-  bool openFile(QTextStream& stream, QFile& filepath, const QString& filename, ContextFlags flags,
-                int& lineNum, int& totalNumLines, int& fileVersion);
+  /* Open file and read header. Dat files are memory mapped and CIFP and airspace files are read using the stream. */
+  bool openFile(atools::fs::xp::XpLineTokenizer& reader, QTextStream& stream, QFile& filepath,
+                const QString& filename, ContextFlags flags, int& lineNum, int& fileVersion);
 
   /* Read file line by line and call writer for each one */
   bool readDataFile(const QString& filepath, int minColumns, atools::fs::xp::XpWriter *writer,
                     atools::fs::xp::ContextFlags flags = atools::fs::xp::NO_FLAG);
+
+  /* Read and parse CIFP files in a thread pool and write procedures in file order.
+   * @return true if the process was aborted */
+  bool compileCifpParallel(const QStringList& cifpFiles);
+
+  /* Read airspace files, parse airspaces and build their geometry in a thread pool and write them in file order.
+   * @return true if the process was aborted */
+  bool compileAirspacesParallel(const QStringList& airspaceFiles);
+
+  /* Read remaining lines of an apt.dat file in chunks split at airport headers. Chunks are tokenized
+   * in parallel and rows are passed to the writer in file order. reportProgress is called with the byte offset.
+   * @return true if the process was aborted */
+  bool readAptDataParallel(atools::fs::xp::XpLineTokenizer& reader, int minColumns, atools::fs::xp::XpWriter *writer,
+                           atools::fs::xp::XpWriterContext& context, int& lineNum,
+                           const std::function<bool(qint64 bytePos)>& reportProgress);
   static QString buildBasePath(const NavDatabaseOptions& opts);
 
   /* FInd custom apt.dat like X-Plane 11/Custom Scenery/LFPG Paris - Charles de Gaulle/Earth Nav data/apt.dat */
@@ -57,6 +57,13 @@ XpFixWriter::~XpFixWriter()
 }
 
 void XpFixWriter::write(const QStringList& line, const XpWriterContext& context)
+{
+  XpLineTokenizer tokens;
+  tokens.setFields(line);
+  write(tokens, context);
+}
+
+void XpFixWriter::write(const XpLineTokenizer& line, const XpWriterContext& context)
 {
   ctx = &context;
 
@@ -64,9 +71,9 @@ void XpFixWriter::write(const QStringList& line, const XpWriterContext& context)
 
   insertWaypointQuery->bindValue(":waypoint_id", ++curFixId);
   insertWaypointQuery->bindValue(":file_id", context.curFileId);
-  insertWaypointQuery->bindValue(":ident", at(line, IDENT));
-  insertWaypointQuery->bindValue(":airport_id", airportIndex->getAirportId(at(line, AIRPORT)));
-  insertWaypointQuery->bindValue(":region", at(line, REGION)); // ZZ for no region
+  insertWaypointQuery->bindValue(":ident", internAt(line, IDENT));
+  insertWaypointQuery->bindValue(":airport_id", airportIndex->getAirportId(internAt(line, AIRPORT)));
+  insertWaypointQuery->bindValue(":region", internAt(line, REGION)); // ZZ for no region
   insertWaypointQuery->bindValue(":type", "WN"); // All named waypoints
   insertWaypointQuery->bindValue(":num_victor_airway", 0); // filled  by sql/fs/db/xplane/prepare_airway.sql
   insertWaypointQuery->bindValue(":num_jet_airway", 0); // as above
@@ -88,6 +95,11 @@ void XpFixWriter::reset()
 
 }
 
+void XpFixWriter::initIdsFromDatabase()
+{
+  curFixId = getMaxId("waypoint");
+}
+
 void XpFixWriter::initQueries()
 {
   deInitQueries();
@@ -52,8 +52,10 @@ public:
   virtual ~XpFixWriter();
 
   virtual void write(const QStringList& line, const XpWriterContext& context) override;
+  virtual void write(const atools::fs::xp::XpLineTokenizer& line, const XpWriterContext& context) override;
   virtual void finish(const XpWriterContext& context) override;
   virtual void reset() override;
+  virtual void initIdsFromDatabase() override;
 
 private:
   void initQueries();
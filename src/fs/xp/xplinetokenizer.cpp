@@ -0,0 +1,252 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/xp/xplinetokenizer.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cstring>
+
+namespace atools {
+namespace fs {
+namespace xp {
+
+XpLineTokenizer::XpLineTokenizer()
+{
+  buffer.reserve(256);
+  fields.reserve(32);
+}
+
+XpLineTokenizer::~XpLineTokenizer()
+{
+  close();
+}
+
+void XpLineTokenizer::setStream(QTextStream *textStream)
+{
+  close();
+  stream = textStream;
+}
+
+void XpLineTokenizer::mapFile(QFile& file)
+{
+  close();
+
+  size = file.size();
+  if(size > 0)
+  {
+    mappedData = file.map(0, size);
+    if(mappedData != nullptr)
+    {
+      mappedFile = &file;
+      data = reinterpret_cast<const char *>(mappedData);
+    }
+    else
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot map" << file.fileName() << file.errorString() << "reading into memory";
+      fileData = file.readAll();
+      size = fileData.size();
+      data = fileData.constData();
+    }
+  }
+
+  // Skip UTF-8 byte order mark
+  if(size >= 3 && data[0] == '\xEF' && data[1] == '\xBB' && data[2] == '\xBF')
+    pos = 3;
+}
+
+void XpLineTokenizer::close()
+{
+  if(mappedFile != nullptr && mappedData != nullptr)
+    mappedFile->unmap(mappedData);
+  mappedFile = nullptr;
+  mappedData = nullptr;
+  fileData.clear();
+  data = nullptr;
+  stream = nullptr;
+  pos = size = 0;
+}
+
+bool XpLineTokenizer::readLine()
+{
+  numFields = 0;
+  if(stream != nullptr)
+  {
+    if(!stream->readLineInto(&buffer))
+    {
+      buffer.clear();
+      lineBegin = lineEnd = 0;
+      return false;
+    }
+  }
+  else if(data != nullptr && pos < size)
+  {
+    // memchr is vectorized by the C library
+    const char *linePtr = data + pos;
+    qint64 remaining = size - pos;
+    const char *newline = static_cast<const char *>(std::memchr(linePtr, '\n', static_cast<size_t>(remaining)));
+    qint64 length = newline != nullptr ? newline - linePtr : remaining;
+    pos += newline != nullptr ? length + 1 : length;
+
+    if(length > 0 && linePtr[length - 1] == '\r')
+      length--;
+
+    decodeLine(linePtr, static_cast<int>(length));
+  }
+  else
+  {
+    buffer.clear();
+    lineBegin = lineEnd = 0;
+    return false;
+  }
+
+  // Find trimmed region
+  lineBegin = 0;
+  lineEnd = buffer.size();
+  while(lineBegin < lineEnd && buffer.at(lineBegin).isSpace())
+    lineBegin++;
+  while(lineEnd > lineBegin && buffer.at(lineEnd - 1).isSpace())
+    lineEnd--;
+  return true;
+}
+
+void XpLineTokenizer::decodeLine(const char *linePtr, int length)
+{
+  // Copy ASCII directly into the reused buffer
+  buffer.resize(length);
+  QChar *dest = buffer.data();
+  for(int i = 0; i < length; i++)
+  {
+    uchar c = static_cast<uchar>(linePtr[i]);
+    if(c >= 0x80)
+    {
+      // Rare - decode the whole line
+      buffer = QString::fromUtf8(linePtr, length);
+      return;
+    }
+    dest[i] = QChar(c);
+  }
+}
+
+void XpLineTokenizer::truncate(int pos)
+{
+  lineEnd = std::min(lineEnd, lineBegin + std::max(pos, 0));
+
+  // Remove trailing whitespace left by cutting
+  while(lineEnd > lineBegin && buffer.at(lineEnd - 1).isSpace())
+    lineEnd--;
+}
+
+void XpLineTokenizer::clear()
+{
+  buffer.clear();
+  lineBegin = lineEnd = 0;
+  numFields = 0;
+}
+
+void XpLineTokenizer::addField(int begin, int end)
+{
+  QStringRef field = buffer.midRef(begin, end - begin);
+  if(numFields < fields.size())
+    fields[numFields] = field;
+  else
+    fields.append(field);
+  numFields++;
+}
+
+void XpLineTokenizer::tokenizeSpace()
+{
+  numFields = 0;
+  int i = lineBegin;
+  while(i < lineEnd)
+  {
+    // Line is trimmed - skip whitespace between fields
+    while(i < lineEnd && buffer.at(i).isSpace())
+      i++;
+
+    int begin = i;
+    while(i < lineEnd && !buffer.at(i).isSpace())
+      i++;
+
+    if(i > begin)
+      addField(begin, i);
+  }
+}
+
+void XpLineTokenizer::tokenizeCifp()
+{
+  numFields = 0;
+  if(lineEnd == lineBegin)
+    return;
+
+  int begin = lineBegin;
+  bool first = true;
+  for(int i = lineBegin; i <= lineEnd; i++)
+  {
+    if(i == lineEnd || buffer.at(i) == ',')
+    {
+      if(first)
+      {
+        // Extract colon separated row code from first field
+        QStringRef rowCode = buffer.midRef(begin, i - begin);
+        int colon = rowCode.indexOf(':');
+        if(colon != -1 && rowCode.indexOf(':', colon + 1) == -1)
+        {
+          addField(begin, begin + colon);
+          addField(begin + colon + 1, i);
+        }
+        else
+          addField(begin, i);
+        first = false;
+      }
+      else
+        addField(begin, i);
+      begin = i + 1;
+    }
+  }
+}
+
+void XpLineTokenizer::setFields(const QStringList& fieldList)
+{
+  numFields = 0;
+  lineBegin = lineEnd = 0;
+  for(const QString& field : fieldList)
+  {
+    QStringRef ref(&field);
+    if(numFields < fields.size())
+      fields[numFields] = ref;
+    else
+      fields.append(ref);
+    numFields++;
+  }
+}
+
+QStringList XpLineTokenizer::toStringList(int from) const
+{
+  QStringList list;
+  list.reserve(std::max(numFields - from, 0));
+  for(int i = from; i < numFields; i++)
+    list.append(fields.at(i).toString());
+  return list;
+}
+
+} // namespace xp
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,137 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_XP_LINETOKENIZER_H
+#define ATOOLS_FS_XP_LINETOKENIZER_H
+
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+
+class QTextStream;
+class QFile;
+
+namespace atools {
+namespace fs {
+namespace xp {
+
+/*
+ * Reads lines of X-Plane dat files and splits them into fields without allocating memory per line.
+ *
+ * Lines are read either from a memory mapped file or from a text stream. Mapped files are scanned for line
+ * ends using memchr and lines are decoded as UTF-8 with a fast path for ASCII. Progress can be estimated from
+ * the byte offset which avoids counting lines before reading.
+ *
+ * The line is read into a buffer which is reused for all lines and fields are views into this buffer.
+ * Fields are valid until the next line is read. Convert to QString, int or float only where needed.
+ */
+class XpLineTokenizer
+{
+public:
+  XpLineTokenizer();
+  ~XpLineTokenizer();
+
+  /* Read lines from a text stream. Used for files which need codec detection. */
+  void setStream(QTextStream *textStream);
+
+  /* Read lines from the open file using memory mapping. The whole file is read into memory if mapping fails.
+   * A UTF-8 byte order mark is skipped. File has to stay open until close() is called. */
+  void mapFile(QFile& file);
+
+  /* Unmap file or detach stream */
+  void close();
+
+  /* Read next line into the buffer and clear all fields. Returns false at end of input. */
+  bool readLine();
+
+  /* Byte offset of the next line in a mapped file. 0 for streams. */
+  qint64 getPos() const
+  {
+    return pos;
+  }
+
+  /* Size of a mapped file in bytes. 0 for streams. */
+  qint64 getSize() const
+  {
+    return size;
+  }
+
+  /* Line without leading and trailing whitespace */
+  QStringRef line() const
+  {
+    return buffer.midRef(lineBegin, lineEnd - lineBegin);
+  }
+
+  /* Cut the line at position pos relative to line() */
+  void truncate(int pos);
+
+  /* Clear line and fields */
+  void clear();
+
+  /* Split at whitespace. Same as QString::simplified().split(" ") for a non empty line. */
+  void tokenizeSpace();
+
+  /* Split at commas and the first field at a colon if it contains exactly one.
+   * Used for CIFP files with row codes like "APPCH:010". */
+  void tokenizeCifp();
+
+  /* Use fields of an already split line. The list has to stay valid while the fields are used. */
+  void setFields(const QStringList& fieldList);
+
+  int size() const
+  {
+    return numFields;
+  }
+
+  bool isEmpty() const
+  {
+    return numFields == 0;
+  }
+
+  const QStringRef& at(int index) const
+  {
+    return fields.at(index);
+  }
+
+  /* Copy fields from index to end into a string list */
+  QStringList toStringList(int from = 0) const;
+
+private:
+  void addField(int begin, int end);
+  void decodeLine(const char *linePtr, int length);
+
+  QString buffer;
+  int lineBegin = 0, lineEnd = 0;
+
+  /* Input is either a stream or mapped or loaded file data */
+  QTextStream *stream = nullptr;
+  QFile *mappedFile = nullptr;
+  uchar *mappedData = nullptr;
+  QByteArray fileData;
+  const char *data = nullptr;
+  qint64 pos = 0, size = 0;
+
+  /* Vector only grows to avoid reallocation - numFields gives the number of valid entries */
+  QVector<QStringRef> fields;
+  int numFields = 0;
+};
+
+} // namespace xp
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_XP_LINETOKENIZER_H
@@ -398,6 +398,14 @@ void XpNavWriter::reset()
   airportIndex->clearSkippedIls();
 }
 
+void XpNavWriter::initIdsFromDatabase()
+{
+  curVorId = getMaxId("vor");
+  curNdbId = getMaxId("ndb");
+  curMarkerId = getMaxId("marker");
+  curIlsId = getMaxId("ils");
+}
+
 void XpNavWriter::initQueries()
 {
   deInitQueries();
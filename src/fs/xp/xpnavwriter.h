@@ -55,6 +55,7 @@ public:
   virtual void write(const QStringList& line, const XpWriterContext& context) override;
   virtual void finish(const XpWriterContext& context) override;
   virtual void reset() override;
+  virtual void initIdsFromDatabase() override;
 
 private:
   void initQueries();
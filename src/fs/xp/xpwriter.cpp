@@ -17,6 +17,8 @@
 
 #include "fs/xp/xpwriter.h"
 #include "fs/navdatabaseerrors.h"
+#include "logging/loggingratelimiter.h"
+#include "sql/sqlquery.h"
 
 #include <QDebug>
 
@@ -36,12 +38,27 @@ XpWriter::~XpWriter()
 
 }
 
+int XpWriter::getMaxId(const QString& table) const
+{
+  atools::sql::SqlQuery query(db);
+  query.exec("select max(" + table + "_id) from " + table);
+  int maxId = query.next() ? query.valueInt(0) : 0;
+  query.finish();
+  return maxId;
+}
+
+void XpWriter::write(const XpLineTokenizer& line, const XpWriterContext& context)
+{
+  write(line.toStringList(), context);
+}
+
 void XpWriter::err(const QString& msg)
 {
+  // Error list below is always complete
   if(ctx != nullptr)
-    qWarning() << ctx->messagePrefix() << msg;
+    ATOOLS_LOG_LIMITED(qWarning() << ctx->messagePrefix() << msg);
   else
-    qWarning() << msg;
+    ATOOLS_LOG_LIMITED(qWarning() << msg);
 
   if(errors != nullptr)
   {
@@ -65,9 +82,9 @@ void XpWriter::err(const QString& msg)
 void XpWriter::errWarn(const QString& msg)
 {
   if(ctx != nullptr)
-    qWarning() << ctx->messagePrefix() << msg;
+    ATOOLS_LOG_LIMITED(qWarning() << ctx->messagePrefix() << msg);
   else
-    qWarning() << msg;
+    ATOOLS_LOG_LIMITED(qWarning() << msg);
 }
 
 } // namespace xp
@@ -20,6 +20,8 @@
 
 #include "exception.h"
 #include "fs/xp/xpconstants.h"
+#include "fs/xp/xplinetokenizer.h"
+#include "util/stringpool.h"
 
 #include <QStringList>
 
@@ -54,12 +56,21 @@ public:
   /* Called for each line read from a dat file */
   virtual void write(const QStringList& line, const atools::fs::xp::XpWriterContext& context) = 0;
 
+  /* Called for each line read from a dat file with fields pointing into the line buffer.
+   * Default implementation copies the fields and calls the method above. Override to avoid the copy. */
+  virtual void write(const atools::fs::xp::XpLineTokenizer& line, const atools::fs::xp::XpWriterContext& context);
+
   /* Called when finished with reading a dat file */
   virtual void finish(const atools::fs::xp::XpWriterContext& context) = 0;
 
   /* Reset all internal states/caches etc. */
   virtual void reset() = 0;
 
+  /* Continue ids after the rows in the database when resuming an aborted compilation */
+  virtual void initIdsFromDatabase()
+  {
+  }
+
 protected:
   /* Called very often - make inline. Throws exception if index is out of bounds */
   const QString& at(const QStringList& line, int index)
@@ -72,6 +83,23 @@ protected:
                               QString(": Index out of bounds: Index: %1, size: %2").arg(index).arg(line.size()));
   }
 
+  const QStringRef& at(const atools::fs::xp::XpLineTokenizer& line, int index)
+  {
+    if(index < line.size())
+      return line.at(index);
+    else
+      // Have to stop reading the file since the rest can be corrupted
+      throw atools::Exception(ctx->messagePrefix() +
+                              QString(": Index out of bounds: Index: %1, size: %2").arg(index).arg(line.size()));
+  }
+
+  /* Field as shared instance from the compiler string pool. Use for short and often repeated values like
+   * idents, regions or types. Throws exception if index is out of bounds. */
+  QString internAt(const atools::fs::xp::XpLineTokenizer& line, int index)
+  {
+    return atools::util::StringPool::compileInstance().intern(at(line, index));
+  }
+
   QString mid(const QStringList& line, int index, bool ignoreError = false)
   {
     if(index < line.size())
@@ -83,6 +111,9 @@ protected:
     return QString();
   }
 
+  /* Largest value of column "table_id" or 0 if the table is empty */
+  int getMaxId(const QString& table) const;
+
   /* Report error in log without throwing an exception */
   void err(const QString& msg);
 
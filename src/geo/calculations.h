@@ -34,6 +34,9 @@ const float INVALID_FLOAT = std::numeric_limits<float>::max();
 const double INVALID_DOUBLE = std::numeric_limits<double>::max();
 const int INVALID_INT = std::numeric_limits<int>::max();
 
+/* Mean earth radius used for all great circle calculations */
+const double EARTH_RADIUS_METER = 6371. * 1000.;
+
 class Line;
 class LineString;
 class Pos;
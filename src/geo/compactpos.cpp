@@ -0,0 +1,97 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "geo/compactpos.h"
+#include "geo/linestring.h"
+
+#include <QDataStream>
+
+#include <cmath>
+
+namespace atools {
+namespace geo {
+
+CompactPos::CompactPos(const Pos& pos)
+{
+  if(pos.isValid())
+  {
+    lonX = static_cast<qint32>(std::lround(static_cast<double>(pos.getLonX()) * MICRO_DEGREES));
+    latY = static_cast<qint32>(std::lround(static_cast<double>(pos.getLatY()) * MICRO_DEGREES));
+  }
+}
+
+CompactPos::CompactPos(float longitudeX, float latitudeY)
+  : CompactPos(Pos(longitudeX, latitudeY))
+{
+}
+
+Pos CompactPos::toPos() const
+{
+  if(isValid())
+    return Pos(lonX / MICRO_DEGREES, latY / MICRO_DEGREES);
+  else
+    return EMPTY_POS;
+}
+
+uint qHash(const CompactPos& pos)
+{
+  return static_cast<uint>(pos.lonX) ^ (static_cast<uint>(pos.latY) << 16 | static_cast<uint>(pos.latY) >> 16);
+}
+
+QDataStream& operator<<(QDataStream& out, const CompactPos& obj)
+{
+  out << obj.lonX << obj.latY;
+  return out;
+}
+
+QDataStream& operator>>(QDataStream& in, CompactPos& obj)
+{
+  in >> obj.lonX >> obj.latY;
+  return in;
+}
+
+QDebug operator<<(QDebug out, const CompactPos& record)
+{
+  QDebugStateSaver saver(out);
+  out.nospace().noquote() << "CompactPos[lonX " << record.getLonX() << ", latY " << record.getLatY() << "]";
+  return out;
+}
+
+CompactLineString::CompactLineString(const LineString& line)
+{
+  fromLineString(line);
+}
+
+LineString CompactLineString::toLineString() const
+{
+  LineString line;
+  line.reserve(size());
+  for(const CompactPos& pos : *this)
+    line.append(pos.toPos());
+  return line;
+}
+
+void CompactLineString::fromLineString(const LineString& line)
+{
+  clear();
+  reserve(line.size());
+  for(const Pos& pos : line)
+    append(CompactPos(pos));
+}
+
+} // namespace geo
+} // namespace atools
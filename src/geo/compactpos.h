@@ -0,0 +1,126 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_GEO_COMPACTPOS_H
+#define ATOOLS_GEO_COMPACTPOS_H
+
+#include "geo/pos.h"
+
+#include <QVector>
+
+#include <limits>
+
+class QDataStream;
+
+namespace atools {
+namespace geo {
+
+class LineString;
+
+/*
+ * Compact two dimensional position storing coordinates as integer micro degrees (about 0.1 meter resolution).
+ * Uses eight bytes instead of twelve for Pos and has no altitude.
+ *
+ * Intended for large in memory datasets like airspace or airway geometries. Convert to Pos for calculations.
+ */
+class CompactPos
+{
+public:
+  CompactPos()
+  {
+  }
+
+  explicit CompactPos(const atools::geo::Pos& pos);
+  explicit CompactPos(float longitudeX, float latitudeY);
+
+  /* Compares exact integer values */
+  bool operator==(const atools::geo::CompactPos& other) const
+  {
+    return lonX == other.lonX && latY == other.latY;
+  }
+
+  bool operator!=(const atools::geo::CompactPos& other) const
+  {
+    return !operator==(other);
+  }
+
+  /* Returns invalid Pos if this is not valid. Altitude is zero. */
+  atools::geo::Pos toPos() const;
+
+  float getLonX() const
+  {
+    return isValid() ? static_cast<float>(lonX / MICRO_DEGREES) : Pos::INVALID_VALUE;
+  }
+
+  float getLatY() const
+  {
+    return isValid() ? static_cast<float>(latY / MICRO_DEGREES) : Pos::INVALID_VALUE;
+  }
+
+  /* false if position is not initialized */
+  bool isValid() const
+  {
+    return lonX != INVALID_VALUE && latY != INVALID_VALUE;
+  }
+
+private:
+  friend QDataStream& operator<<(QDataStream& out, const atools::geo::CompactPos& obj);
+
+  friend QDataStream& operator>>(QDataStream& in, atools::geo::CompactPos& obj);
+
+  friend QDebug operator<<(QDebug out, const atools::geo::CompactPos& record);
+
+  friend uint qHash(const atools::geo::CompactPos& pos);
+
+  Q_DECL_CONSTEXPR static double MICRO_DEGREES = 1000000.;
+  Q_DECL_CONSTEXPR static qint32 INVALID_VALUE = std::numeric_limits<qint32>::max();
+
+  qint32 lonX = INVALID_VALUE, latY = INVALID_VALUE;
+};
+
+uint qHash(const atools::geo::CompactPos& pos);
+
+/*
+ * List of compact positions. Convert to LineString for calculations.
+ */
+class CompactLineString :
+  public QVector<atools::geo::CompactPos>
+{
+public:
+  CompactLineString()
+  {
+  }
+
+  explicit CompactLineString(const atools::geo::LineString& line);
+
+  atools::geo::LineString toLineString() const;
+
+  /* Replace content with the converted positions of line */
+  void fromLineString(const atools::geo::LineString& line);
+
+};
+
+} // namespace geo
+} // namespace atools
+
+Q_DECLARE_TYPEINFO(atools::geo::CompactPos, Q_PRIMITIVE_TYPE);
+Q_DECLARE_METATYPE(atools::geo::CompactPos);
+
+Q_DECLARE_TYPEINFO(atools::geo::CompactLineString, Q_MOVABLE_TYPE);
+Q_DECLARE_METATYPE(atools::geo::CompactLineString);
+
+#endif // ATOOLS_GEO_COMPACTPOS_H
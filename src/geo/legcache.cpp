@@ -0,0 +1,133 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "geo/legcache.h"
+#include "geo/calculations.h"
+#include "atools.h"
+
+#include <QMutexLocker>
+
+#include <cmath>
+
+namespace atools {
+namespace geo {
+
+uint qHash(const LegCache::Key& key)
+{
+  return qHash(key.lonX1) ^ (qHash(key.latY1) << 8) ^ (qHash(key.lonX2) << 16) ^ (qHash(key.latY2) << 24);
+}
+
+LegCache::LegCache(int maxEntries)
+  : cache(maxEntries)
+{
+}
+
+LegMetrics LegCache::metrics(const Pos& from, const Pos& to)
+{
+  Key key = {from.getLonX(), from.getLatY(), to.getLonX(), to.getLatY()};
+
+  {
+    QMutexLocker locker(&mutex);
+    LegMetrics *metrics = cache.object(key);
+    if(metrics != nullptr)
+      return *metrics;
+  }
+
+  // Calculate outside of lock - concurrent misses for the same key insert equal values
+  LegMetrics metrics = calculate(from, to);
+
+  QMutexLocker locker(&mutex);
+  cache.insert(key, new LegMetrics(metrics));
+  return metrics;
+}
+
+LegMetrics LegCache::calculate(const Pos& from, const Pos& to)
+{
+  if(!from.isValid() || !to.isValid())
+    return {Pos::INVALID_VALUE, Pos::INVALID_VALUE, Pos::INVALID_VALUE, Pos::INVALID_VALUE};
+  else if(from == to)
+    // Equal positions have no great circle course
+    return {0.f, Pos::INVALID_VALUE, 0.f, 0.f};
+
+  double lon1 = toRadians(static_cast<double>(from.getLonX()));
+  double lat1 = toRadians(static_cast<double>(from.getLatY()));
+  double lon2 = toRadians(static_cast<double>(to.getLonX()));
+  double lat2 = toRadians(static_cast<double>(to.getLatY()));
+  double cosLat1 = cos(lat1), cosLat2 = cos(lat2);
+
+  LegMetrics metrics;
+
+  // Great circle distance and initial course - same terms as Pos::distanceRad and Pos::courseRad
+  double l1 = sin((lat1 - lat2) / 2.);
+  double l2 = sin((lon1 - lon2) / 2.);
+  metrics.distanceMeter = static_cast<float>(2. * asin(sqrt(l1 * l1 + cosLat1 * cosLat2 * l2 * l2)) *
+                                             EARTH_RADIUS_METER);
+
+  double course = atan2(sin(lon2 - lon1) * cosLat2, cosLat1 * sin(lat2) - sin(lat1) * cosLat2 * cos(lon2 - lon1));
+  course = std::fmod(course + M_PI * 2., M_PI * 2.);
+  metrics.courseDeg = static_cast<float>(normalizeCourse(toDegree(course)));
+
+  // Rhumb line distance and course - same as Pos::distanceMeterToRhumb and Pos::angleDegToRhumb
+  // which convert to radians in float precision
+  lon1 = toRadians(from.getLonX());
+  lat1 = toRadians(from.getLatY());
+  lon2 = toRadians(to.getLonX());
+  lat2 = toRadians(to.getLatY());
+
+  double dlonWest = remainder(lon2 - lon1, 2. * M_PI);
+  double dlonEast = remainder(lon1 - lon2, 2. * M_PI);
+  double dphi = log(tan(lat2 / 2. + M_PI / 4.) / tan(lat1 / 2. + M_PI / 4.));
+  double q = atools::almostEqual(lat2, lat1) ? cos(lat1) : (lat2 - lat1) / dphi;
+
+  double distance, tc;
+  if(dlonWest < dlonEast)
+  {
+    // To west is shorter
+    distance = sqrt(q * q * dlonWest * dlonWest + (lat2 - lat1) * (lat2 - lat1));
+    tc = remainder(atan2(-dlonWest, dphi), 2. * M_PI);
+  }
+  else
+  {
+    distance = sqrt(q * q * dlonEast * dlonEast + (lat2 - lat1) * (lat2 - lat1));
+    tc = remainder(atan2(dlonEast, dphi), 2. * M_PI);
+  }
+  metrics.distanceMeterRhumb = static_cast<float>(distance * EARTH_RADIUS_METER);
+  metrics.courseDegRhumb = static_cast<float>(normalizeCourse(-toDegree(tc) + 360.));
+
+  return metrics;
+}
+
+void LegCache::clear()
+{
+  QMutexLocker locker(&mutex);
+  cache.clear();
+}
+
+int LegCache::size() const
+{
+  QMutexLocker locker(&mutex);
+  return cache.size();
+}
+
+void LegCache::setMaxEntries(int maxEntries)
+{
+  QMutexLocker locker(&mutex);
+  cache.setMaxCost(maxEntries);
+}
+
+} // namespace geo
+} // namespace atools
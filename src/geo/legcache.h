@@ -0,0 +1,82 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_GEO_LEGCACHE_H
+#define ATOOLS_GEO_LEGCACHE_H
+
+#include "geo/pos.h"
+
+#include <QCache>
+#include <QMutex>
+
+namespace atools {
+namespace geo {
+
+/* Great circle and rhumb line values for a leg. Values are the same as returned by the Pos methods. */
+struct LegMetrics
+{
+  float distanceMeter, /* Pos::distanceMeterTo */
+        courseDeg, /* Pos::angleDegTo - initial great circle course */
+        distanceMeterRhumb, /* Pos::distanceMeterToRhumb */
+        courseDegRhumb; /* Pos::angleDegToRhumb */
+};
+
+/*
+ * Thread safe cache for leg distances and courses keyed by the exact coordinates of both positions.
+ * Least recently used entries are removed if the cache is full.
+ *
+ * Avoids repeated trigonometry when route tables are recalculated for each change.
+ */
+class LegCache
+{
+public:
+  explicit LegCache(int maxEntries = 10000);
+
+  /* Get cached values or calculate and insert them */
+  atools::geo::LegMetrics metrics(const atools::geo::Pos& from, const atools::geo::Pos& to);
+
+  /* Calculate all values for a leg sharing intermediate terms */
+  static atools::geo::LegMetrics calculate(const atools::geo::Pos& from, const atools::geo::Pos& to);
+
+  void clear();
+
+  int size() const;
+
+  void setMaxEntries(int maxEntries);
+
+private:
+  struct Key
+  {
+    float lonX1, latY1, lonX2, latY2;
+
+    bool operator==(const Key& other) const
+    {
+      return lonX1 == other.lonX1 && latY1 == other.latY1 && lonX2 == other.lonX2 && latY2 == other.latY2;
+    }
+
+  };
+
+  friend uint qHash(const atools::geo::LegCache::Key& key);
+
+  QCache<Key, LegMetrics> cache;
+  mutable QMutex mutex;
+};
+
+} // namespace geo
+} // namespace atools
+
+#endif // ATOOLS_GEO_LEGCACHE_H
@@ -124,6 +124,11 @@ void Line::interpolatePoints(float distanceMeter, int numPoints, QList<Pos>& pos
   return pos1.interpolatePoints(pos2, distanceMeter, numPoints, positions);
 }
 
+void Line::interpolatePoints(float distanceMeter, int numPoints, LineString& positions) const
+{
+  pos1.interpolatePoints(pos2, distanceMeter, numPoints, positions);
+}
+
 Pos Line::interpolateRhumb(float distanceMeter, float fraction) const
 {
   return pos1.interpolateRhumb(pos2, distanceMeter, fraction);
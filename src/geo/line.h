@@ -81,6 +81,7 @@ public:
   /* Find point between start and end on GC route if distance between points is not known. 0 < fraction <= 1 */
   atools::geo::Pos interpolate(float fraction) const;
   void interpolatePoints(float lengthMeter, int numPoints, QList<atools::geo::Pos>& positions) const;
+  void interpolatePoints(float lengthMeter, int numPoints, atools::geo::LineString& positions) const;
 
   /* Find point between start and end on rhumb line */
   atools::geo::Pos interpolateRhumb(float lengthMeter, float fraction) const;
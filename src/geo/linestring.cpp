@@ -17,12 +17,17 @@
 
 #include "geo/linestring.h"
 #include "geo/calculations.h"
+#include "geo/linestringindex.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace atools {
 namespace geo {
 
+/* Covers float rounding errors when comparing distance bounds */
+const static float PRUNE_MARGIN_METER = 10.f;
+
 LineString::LineString()
 {
 
@@ -168,40 +173,73 @@ void LineString::removeDuplicates()
   resize(static_cast<int>(std::distance(begin(), it)));
 }
 
-void LineString::distanceMeterToLineString(const Pos& pos, LineDistance& result, int *index) const
+void LineString::simplify(float toleranceDeg)
 {
-  LineDistance lineResult, closestLineResult;
-  int closestIndex = -1;
+  if(size() < 3)
+    return;
 
-  lineResult.distance = std::numeric_limits<float>::max();
-  closestLineResult.distance = std::numeric_limits<float>::max();
+  QVector<bool> keep(size(), false);
+  keep.first() = keep.last() = true;
 
-  for(int i = 0; i < size() - 1; i++)
+  // Iterative to avoid deep recursion for large boundaries
+  QVector<std::pair<int, int> > stack;
+  stack.append(std::make_pair(0, size() - 1));
+  while(!stack.isEmpty())
   {
-    pos.distanceMeterToLine(at(i), at(i + 1), lineResult);
-    if(lineResult.status != INVALID &&
-       std::abs(lineResult.distance) < std::abs(closestLineResult.distance))
+    std::pair<int, int> range = stack.takeLast();
+    const Pos& p1 = at(range.first);
+    const Pos& p2 = at(range.second);
+    float dx = p2.getLonX() - p1.getLonX(), dy = p2.getLatY() - p1.getLatY();
+    float len = std::sqrt(dx * dx + dy * dy);
+
+    int maxIndex = -1;
+    float maxDist = toleranceDeg;
+    for(int i = range.first + 1; i < range.second; i++)
     {
-      closestLineResult = lineResult;
-      closestIndex = i;
+      const Pos& p = at(i);
+      float dist = len > 0.f ?
+                   std::abs(dy * (p.getLonX() - p1.getLonX()) - dx * (p.getLatY() - p1.getLatY())) / len :
+                   std::hypot(p.getLonX() - p1.getLonX(), p.getLatY() - p1.getLatY());
+      if(dist > maxDist)
+      {
+        maxDist = dist;
+        maxIndex = i;
+      }
+    }
+
+    if(maxIndex != -1)
+    {
+      keep[maxIndex] = true;
+      stack.append(std::make_pair(range.first, maxIndex));
+      stack.append(std::make_pair(maxIndex, range.second));
     }
   }
 
+  int num = 0;
+  for(int i = 0; i < size(); i++)
+  {
+    if(keep.at(i))
+      (*this)[num++] = at(i);
+  }
+  resize(num);
+}
+
+/* Fill result from closest segment or set it to invalid if nothing was found */
+static void finishLineDistance(const LineDistance& closestLineResult, int closestIndex, int numPoints,
+                               float distanceFrom1, float length, LineDistance& result, int *index)
+{
   if(closestIndex != -1)
   {
     result = closestLineResult;
-
-    for(int i = 0; i < closestIndex; i++)
-      result.distanceFrom1 += at(i).distanceMeterTo(at(i + 1));
-
-    result.distanceFrom2 = lengthMeter() - result.distanceFrom1;
+    result.distanceFrom1 += distanceFrom1;
+    result.distanceFrom2 = length - result.distanceFrom1;
 
     if(closestIndex == 0)
     {
       if(result.status != BEFORE_START)
         result.status = ALONG_TRACK;
     }
-    else if(closestIndex == size() - 2)
+    else if(closestIndex == numPoints - 2)
     {
       if(result.status != AFTER_END)
         result.status = ALONG_TRACK;
@@ -222,6 +260,122 @@ void LineString::distanceMeterToLineString(const Pos& pos, LineDistance& result,
   }
 }
 
+void LineString::distanceMeterToLineString(const Pos& pos, LineDistance& result, int *index) const
+{
+  LineDistance lineResult, closestLineResult;
+  int closestIndex = -1;
+
+  lineResult.distance = std::numeric_limits<float>::max();
+  closestLineResult.distance = std::numeric_limits<float>::max();
+
+  // Distances to all points and segment lengths - each needs only one trigonometric distance calculation
+  QVector<float> pointDistances, segmentLengths;
+  pointDistances.reserve(size());
+  segmentLengths.reserve(size());
+  for(int i = 0; i < size(); i++)
+  {
+    pointDistances.append(pos.distanceMeterTo(at(i)));
+    if(i < size() - 1)
+      segmentLengths.append(at(i).distanceMeterTo(at(i + 1)));
+  }
+
+  for(int i = 0; i < size() - 1; i++)
+  {
+    // Lower bound for the distance to any point on the segment from the triangle inequality.
+    // Skip the costly cross track calculation if the segment cannot be closer.
+    float lowerBound = (pointDistances.at(i) + pointDistances.at(i + 1) - segmentLengths.at(i)) / 2.f;
+    if(lowerBound > std::abs(closestLineResult.distance) + PRUNE_MARGIN_METER)
+      continue;
+
+    pos.distanceMeterToLine(at(i), at(i + 1), lineResult);
+    if(lineResult.status != INVALID &&
+       std::abs(lineResult.distance) < std::abs(closestLineResult.distance))
+    {
+      closestLineResult = lineResult;
+      closestIndex = i;
+    }
+  }
+
+  float distanceFrom1 = 0.f, length = 0.f;
+  for(int i = 0; i < segmentLengths.size(); i++)
+  {
+    if(i < closestIndex)
+      distanceFrom1 += segmentLengths.at(i);
+    length += segmentLengths.at(i);
+  }
+
+  finishLineDistance(closestLineResult, closestIndex, size(), distanceFrom1, length, result, index);
+}
+
+void LineString::distanceMeterToLineString(const Pos& pos, LineDistance& result, const LineStringIndex& segmentIndex,
+                                           int *index) const
+{
+  if(!segmentIndex.isValidFor(*this))
+  {
+    // Index is empty or outdated
+    distanceMeterToLineString(pos, result, index);
+    return;
+  }
+
+  LineDistance lineResult, closestLineResult;
+  int closestIndex = -1;
+
+  lineResult.distance = std::numeric_limits<float>::max();
+  closestLineResult.distance = std::numeric_limits<float>::max();
+
+  // Lower bound for the distance to each chunk from its bounding circle - visit closest chunks first
+  QVector<std::pair<float, int> > chunkBounds;
+  chunkBounds.reserve(segmentIndex.chunks.size());
+  for(int i = 0; i < segmentIndex.chunks.size(); i++)
+  {
+    const LineStringIndex::Chunk& chunk = segmentIndex.chunks.at(i);
+    float dist = pos.distanceMeterTo(chunk.center);
+    chunkBounds.append(std::make_pair(chunk.radiusMeter == std::numeric_limits<float>::max() ?
+                                      -std::numeric_limits<float>::max() : dist - chunk.radiusMeter, i));
+  }
+  std::sort(chunkBounds.begin(), chunkBounds.end());
+
+  QVector<float> pointDistances;
+  for(const std::pair<float, int>& chunkBound : chunkBounds)
+  {
+    // All remaining chunks are farther away
+    if(chunkBound.first > std::abs(closestLineResult.distance) + PRUNE_MARGIN_METER)
+      break;
+
+    const LineStringIndex::Chunk& chunk = segmentIndex.chunks.at(chunkBound.second);
+
+    pointDistances.clear();
+    for(int i = chunk.first; i <= chunk.last + 1; i++)
+      pointDistances.append(pos.distanceMeterTo(at(i)));
+
+    for(int i = chunk.first; i <= chunk.last; i++)
+    {
+      float lowerBound = (pointDistances.at(i - chunk.first) + pointDistances.at(i - chunk.first + 1) -
+                          segmentIndex.segmentLengths.at(i)) / 2.f;
+      if(lowerBound > std::abs(closestLineResult.distance) + PRUNE_MARGIN_METER)
+        continue;
+
+      pos.distanceMeterToLine(at(i), at(i + 1), lineResult);
+
+      // Chunks are visited out of order - prefer the lower index on equal distance like the sequential search
+      if(lineResult.status != INVALID &&
+         (std::abs(lineResult.distance) < std::abs(closestLineResult.distance) ||
+          (std::abs(lineResult.distance) == std::abs(closestLineResult.distance) && i < closestIndex)))
+      {
+        closestLineResult = lineResult;
+        closestIndex = i;
+      }
+    }
+  }
+
+  float distanceFrom1 = 0.f;
+  for(int i = 0; i < closestIndex; i++)
+    distanceFrom1 += segmentIndex.segmentLengths.at(i);
+
+  finishLineDistance(closestLineResult, closestIndex, size(), distanceFrom1, segmentIndex.getLengthMeter(),
+                     result, index);
+}
+
 Pos LineString::interpolate(float fraction) const
 {
   return interpolate(lengthMeter(), fraction);
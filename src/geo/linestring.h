@@ -23,6 +23,8 @@
 namespace atools {
 namespace geo {
 
+class LineStringIndex;
+
 /*
  * List of geographic positions
  */
@@ -58,10 +60,19 @@ public:
   /* Remove consecutive duplicates */
   void removeDuplicates();
 
+  /* Douglas-Peucker simplification keeping all points deviating more than toleranceDeg degrees from the
+   * simplified line. Works on plain coordinates without anti-meridian handling. First and last point are kept. */
+  void simplify(float toleranceDeg);
+
   /* Calculate status, cross track distance and more to this line. */
   void distanceMeterToLineString(const atools::geo::Pos& pos, LineDistance& result,
                                  int *index = nullptr) const;
 
+  /* Same as above but uses a prebuilt segment index to skip parts of the line which cannot contain the closest
+   * segment. Falls back to the method above if the index does not match this line string. */
+  void distanceMeterToLineString(const atools::geo::Pos& pos, LineDistance& result,
+                                 const atools::geo::LineStringIndex& segmentIndex, int *index = nullptr) const;
+
   /* Find point between start and end on GC route if distance between points is already known.
    *  fraction is 0 <= fraction <= 1 where 0 equals first and 1 equal last pos */
   atools::geo::Pos interpolate(float fraction) const;
@@ -0,0 +1,112 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "geo/linestringindex.h"
+#include "geo/linestring.h"
+
+#include <QHash>
+
+#include <algorithm>
+#include <limits>
+
+namespace atools {
+namespace geo {
+
+/* Bounding circles have to be smaller than a hemisphere to contain all great circle segments.
+ * Use a quarter of the earth circumference which leaves a wide margin. */
+const static float MAX_CHUNK_RADIUS_METER = 10000000.f;
+
+static uint hashCoordinates(const LineString& line)
+{
+  uint hash = qHash(line.size());
+  for(const Pos& pos : line)
+    hash = qHash(pos.getLatY(), qHash(pos.getLonX(), hash));
+  return hash;
+}
+
+LineStringIndex::LineStringIndex()
+{
+
+}
+
+LineStringIndex::LineStringIndex(const LineString& line, int segmentsPerChunk)
+{
+  build(line, segmentsPerChunk);
+}
+
+void LineStringIndex::build(const LineString& line, int segmentsPerChunk)
+{
+  clear();
+
+  int numSegments = line.size() - 1;
+  if(numSegments < 1)
+    return;
+
+  segmentsPerChunk = std::max(segmentsPerChunk, 1);
+  coordinateHash = hashCoordinates(line);
+
+  segmentLengths.reserve(numSegments);
+  for(int i = 0; i < numSegments; i++)
+  {
+    float length = line.at(i).distanceMeterTo(line.at(i + 1));
+    segmentLengths.append(length);
+    lengthMeter += length;
+  }
+
+  chunks.reserve(numSegments / segmentsPerChunk + 1);
+  for(int first = 0; first < numSegments; first += segmentsPerChunk)
+  {
+    Chunk chunk;
+    chunk.first = first;
+    chunk.last = std::min(first + segmentsPerChunk, numSegments) - 1;
+
+    // Use the middle point as center and the largest distance to any chunk point as radius
+    chunk.center = line.at((chunk.first + chunk.last + 1) / 2);
+    chunk.radiusMeter = 0.f;
+    for(int i = chunk.first; i <= chunk.last + 1; i++)
+    {
+      if(!chunk.center.isValid() || !line.at(i).isValid())
+      {
+        // Cannot bound chunk - never skip it
+        chunk.radiusMeter = std::numeric_limits<float>::max();
+        break;
+      }
+      chunk.radiusMeter = std::max(chunk.radiusMeter, chunk.center.distanceMeterTo(line.at(i)));
+    }
+
+    if(chunk.radiusMeter > MAX_CHUNK_RADIUS_METER)
+      chunk.radiusMeter = std::numeric_limits<float>::max();
+
+    chunks.append(chunk);
+  }
+}
+
+void LineStringIndex::clear()
+{
+  chunks.clear();
+  segmentLengths.clear();
+  lengthMeter = 0.f;
+  coordinateHash = 0;
+}
+
+bool LineStringIndex::isValidFor(const LineString& line) const
+{
+  return !chunks.isEmpty() && segmentLengths.size() == line.size() - 1 && coordinateHash == hashCoordinates(line);
+}
+
+} // namespace geo
+} // namespace atools
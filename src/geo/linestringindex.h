@@ -0,0 +1,88 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_GEO_LINESTRINGINDEX_H
+#define ATOOLS_GEO_LINESTRINGINDEX_H
+
+#include "geo/pos.h"
+
+#include <QVector>
+
+namespace atools {
+namespace geo {
+
+class LineString;
+
+/*
+ * Optional segment index for long line strings like airspace or boundary geometries.
+ *
+ * Groups consecutive segments into chunks and stores a bounding circle (center and radius) for each chunk
+ * as well as all segment lengths. LineString::distanceMeterToLineString can use this to skip whole chunks
+ * which cannot contain the closest segment. Results are the same as without index.
+ *
+ * The index has to be rebuilt if the line string is changed. isValidFor() detects changes by a hash of the coordinates.
+ */
+class LineStringIndex
+{
+public:
+  LineStringIndex();
+  explicit LineStringIndex(const atools::geo::LineString& line, int segmentsPerChunk = DEFAULT_SEGMENTS_PER_CHUNK);
+
+  /* Build index for the given line string. Previous content is removed. */
+  void build(const atools::geo::LineString& line, int segmentsPerChunk = DEFAULT_SEGMENTS_PER_CHUNK);
+
+  void clear();
+
+  bool isEmpty() const
+  {
+    return chunks.isEmpty();
+  }
+
+  /* true if index was built for a line string with the same number of points and coordinates */
+  bool isValidFor(const atools::geo::LineString& line) const;
+
+  /* Length of all segments in meter */
+  float getLengthMeter() const
+  {
+    return lengthMeter;
+  }
+
+  static Q_DECL_CONSTEXPR int DEFAULT_SEGMENTS_PER_CHUNK = 16;
+
+private:
+  friend class atools::geo::LineString;
+
+  /* Segments first to last (inclusive) where segment i connects point i and i + 1 */
+  struct Chunk
+  {
+    atools::geo::Pos center;
+    float radiusMeter;
+    int first, last;
+  };
+
+  QVector<Chunk> chunks;
+  QVector<float> segmentLengths;
+  float lengthMeter = 0.f;
+
+  /* Hash of all coordinates of the line string the index was built for */
+  uint coordinateHash = 0;
+};
+
+} // namespace geo
+} // namespace atools
+
+#endif // ATOOLS_GEO_LINESTRINGINDEX_H
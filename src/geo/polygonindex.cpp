@@ -0,0 +1,166 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "geo/polygonindex.h"
+#include "geo/linestring.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace atools {
+namespace geo {
+
+PolygonIndex::PolygonIndex()
+{
+
+}
+
+PolygonIndex::PolygonIndex(const LineString& polygon)
+{
+  build(polygon);
+}
+
+void PolygonIndex::clear()
+{
+  edges.clear();
+  slabLatY.clear();
+  slabOffsets.clear();
+  slabEdges.clear();
+  minLonX = 0.;
+}
+
+void PolygonIndex::build(const LineString& polygon)
+{
+  clear();
+
+  // Unwrap longitudes so that no edge crosses the anti-meridian
+  QVector<double> lonX, latY;
+  double lastRawLon = 0.;
+  for(const Pos& pos : polygon)
+  {
+    if(!pos.isValid())
+      continue;
+
+    double lon = static_cast<double>(pos.getLonX());
+    lonX.append(lonX.isEmpty() ? lon : lonX.last() + std::remainder(lon - lastRawLon, 360.));
+    latY.append(static_cast<double>(pos.getLatY()));
+    lastRawLon = lon;
+  }
+
+  if(lonX.size() < 2)
+    return;
+
+  // Longitude of the first point when coming back to it along the ring
+  double endLon;
+  if(std::remainder(lonX.last() - lonX.first(), 360.) == 0. && latY.last() == latY.first())
+  {
+    // Closed polygon - remove closing point
+    endLon = lonX.takeLast();
+    latY.removeLast();
+  }
+  else
+    endLon = lonX.last() + std::remainder(lonX.first() - lonX.last(), 360.);
+
+  if(lonX.size() < 3)
+    return;
+
+  if(std::abs(endLon - lonX.first()) > 180.)
+  {
+    // Ring winds around a pole - close it along the pole on the side of the polygon
+    double latSum = 0.;
+    for(double lat : latY)
+      latSum += lat;
+    double poleLat = latSum >= 0. ? 90. : -90.;
+
+    lonX.append(endLon);
+    latY.append(latY.first());
+    lonX.append(endLon);
+    latY.append(poleLat);
+    lonX.append(lonX.first());
+    latY.append(poleLat);
+  }
+
+  minLonX = *std::min_element(lonX.begin(), lonX.end());
+
+  slabLatY = latY;
+  std::sort(slabLatY.begin(), slabLatY.end());
+  slabLatY.erase(std::unique(slabLatY.begin(), slabLatY.end()), slabLatY.end());
+
+  // Collect non horizontal edges and the range of slabs they span
+  QVector<std::pair<int, int> > edgeSlabs;
+  QVector<int> slabCounts(slabLatY.size(), 0);
+  int num = lonX.size();
+  for(int i = 0; i < num; i++)
+  {
+    int j = (i + 1) % num;
+    if(latY.at(i) == latY.at(j))
+      continue;
+
+    edges.append({lonX.at(i), latY.at(i), (lonX.at(j) - lonX.at(i)) / (latY.at(j) - latY.at(i))});
+
+    double lat1 = std::min(latY.at(i), latY.at(j)), lat2 = std::max(latY.at(i), latY.at(j));
+    int first = static_cast<int>(std::lower_bound(slabLatY.begin(), slabLatY.end(), lat1) - slabLatY.begin());
+    int last = static_cast<int>(std::lower_bound(slabLatY.begin(), slabLatY.end(), lat2) - slabLatY.begin());
+    edgeSlabs.append(std::make_pair(first, last));
+    for(int slab = first; slab < last; slab++)
+      slabCounts[slab]++;
+  }
+
+  // Fill flat slab arrays
+  slabOffsets.fill(0, slabLatY.size());
+  for(int slab = 1; slab < slabLatY.size(); slab++)
+    slabOffsets[slab] = slabOffsets.at(slab - 1) + slabCounts.at(slab - 1);
+
+  slabEdges.fill(0, slabOffsets.last());
+  QVector<int> insertPos(slabOffsets);
+  for(int i = 0; i < edgeSlabs.size(); i++)
+  {
+    for(int slab = edgeSlabs.at(i).first; slab < edgeSlabs.at(i).second; slab++)
+      slabEdges[insertPos[slab]++] = i;
+  }
+}
+
+bool PolygonIndex::contains(const Pos& pos) const
+{
+  if(!pos.isValid() || slabLatY.size() < 2)
+    return false;
+
+  double lat = static_cast<double>(pos.getLatY());
+  if(lat < slabLatY.first() || lat >= slabLatY.last())
+    return false;
+
+  // Move longitude into the unwrapped range of the polygon
+  double lon = std::fmod(static_cast<double>(pos.getLonX()) - minLonX, 360.);
+  if(lon < 0.)
+    lon += 360.;
+  lon += minLonX;
+
+  int slab = static_cast<int>(std::upper_bound(slabLatY.begin(), slabLatY.end(), lat) - slabLatY.begin()) - 1;
+
+  // Count edges crossing the ray going east from pos
+  bool inside = false;
+  for(int i = slabOffsets.at(slab); i < slabOffsets.at(slab + 1); i++)
+  {
+    const Edge& edge = edges.at(slabEdges.at(i));
+    if(edge.lonX + (lat - edge.latY) * edge.slope > lon)
+      inside = !inside;
+  }
+  return inside;
+}
+
+} // namespace geo
+} // namespace atools
@@ -0,0 +1,80 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_GEO_POLYGONINDEX_H
+#define ATOOLS_GEO_POLYGONINDEX_H
+
+#include "geo/pos.h"
+
+#include <QVector>
+
+namespace atools {
+namespace geo {
+
+class LineString;
+
+/*
+ * Preprocessed polygon for fast point in polygon tests like airspace or boundary containment.
+ *
+ * Divides the polygon into horizontal slabs between all vertex latitudes and stores the edges crossing each slab.
+ * A test finds the slab by binary search and counts crossings of the edges in this slab only.
+ *
+ * Coordinates are treated as planar like usual ray casting. Polygons crossing the anti-meridian are unwrapped
+ * and polygons enclosing a pole are closed along the pole.
+ */
+class PolygonIndex
+{
+public:
+  PolygonIndex();
+  explicit PolygonIndex(const atools::geo::LineString& polygon);
+
+  /* Build index. Polygon does not need to be closed. Invalid positions are ignored. */
+  void build(const atools::geo::LineString& polygon);
+
+  void clear();
+
+  /* true if pos is inside polygon */
+  bool contains(const atools::geo::Pos& pos) const;
+
+  bool isEmpty() const
+  {
+    return slabLatY.isEmpty();
+  }
+
+private:
+  /* Edge non horizontal with unwrapped longitude */
+  struct Edge
+  {
+    double lonX, latY, slope; /* Start point and longitude change per degree latitude */
+  };
+
+  QVector<Edge> edges;
+
+  /* Sorted unique latitudes of all vertices - slab i covers slabLatY[i] <= lat < slabLatY[i + 1] */
+  QVector<double> slabLatY;
+
+  /* Edges of slab i are slabEdges[slabOffsets[i]] to slabEdges[slabOffsets[i + 1] - 1] */
+  QVector<int> slabOffsets, slabEdges;
+
+  /* Start of the unwrapped longitude range */
+  double minLonX = 0.;
+};
+
+} // namespace geo
+} // namespace atools
+
+#endif // ATOOLS_GEO_POLYGONINDEX_H
@@ -17,6 +17,7 @@
 
 #include "geo/calculations.h"
 #include "geo/pos.h"
+#include "geo/linestring.h"
 #include "exception.h"
 #include "atools.h"
 
@@ -29,7 +30,6 @@ namespace geo {
 const static QString OVERFLOW_60_TEST("%1");
 const static QString OVERFLOW_60_TEST_TEXT("60");
 const static float MAX_SECONDS = 59.98f;
-const static double EARTH_RADIUS_METER = 6371. * 1000.;
 
 const static QString SHORT_FORMAT("%1,%2");
 const static QString SHORT_FORMAT_ALT("%1,%2,%3");
@@ -536,6 +536,54 @@ void Pos::interpolatePoints(const Pos& otherPos, float distanceMeter, int numPoi
     positions.append(interpolate(otherPos, distanceMeter, step * static_cast<float>(j)));
 }
 
+void Pos::interpolatePoints(const Pos& otherPos, float distanceMeter, int numPoints, LineString& positions) const
+{
+  if(!isValid() || !otherPos.isValid() || numPoints <= 0)
+    return;
+  else if(*this == otherPos)
+    return;
+
+  double distanceRad = nmToRad(meterToNm(distanceMeter));
+  double sinDist = sin(distanceRad);
+  if(std::abs(sinDist) < std::numeric_limits<double>::epsilon())
+  {
+    // Points are antipodal or distance is zero - leave it to the single point interpolation
+    float step = 1.f / numPoints;
+    for(int j = 0; j < numPoints; j++)
+      positions.append(interpolate(otherPos, distanceMeter, step * static_cast<float>(j)));
+    return;
+  }
+
+  // Unit vectors of both points
+  double lon1 = toRadians(lonX), lat1 = toRadians(latY);
+  double lon2 = toRadians(otherPos.lonX), lat2 = toRadians(otherPos.latY);
+  double x1 = cos(lat1) * cos(lon1), y1 = cos(lat1) * sin(lon1), z1 = sin(lat1);
+  double x2 = cos(lat2) * cos(lon2), y2 = cos(lat2) * sin(lon2), z2 = sin(lat2);
+  double cotDist = cos(distanceRad) / sinDist;
+
+  // Sine and cosine of the angle from the start are advanced by rotation for each step
+  double stepRad = distanceRad / numPoints;
+  double sinStep = sin(stepRad), cosStep = cos(stepRad);
+  double sinAngle = 0., cosAngle = 1.;
+
+  positions.reserve(positions.size() + numPoints);
+  positions.append(*this);
+  for(int j = 1; j < numPoints; j++)
+  {
+    double sinNext = sinAngle * cosStep + cosAngle * sinStep;
+    cosAngle = cosAngle * cosStep - sinAngle * sinStep;
+    sinAngle = sinNext;
+
+    // Same as sin((1 - fraction) * distance) / sin(distance) and sin(fraction * distance) / sin(distance)
+    double A = cosAngle - cotDist * sinAngle;
+    double B = sinAngle / sinDist;
+    double x = A * x1 + B * x2;
+    double y = A * y1 + B * y2;
+    double z = A * z1 + B * z2;
+    positions.append(atools::geo::Pos(atan2(y, x), atan2(z, sqrt(x * x + y * y))).toDeg().normalize());
+  }
+}
+
 /* Check if seconds or minutes value is rounded up to 60.00 when convertin to string */
 inline bool Pos::doesOverflow60(float value) const
 {
@@ -25,6 +25,8 @@ class QRegularExpression;
 namespace atools {
 namespace geo {
 
+class LineString;
+
 enum CrossTrackStatus
 {
   INVALID, /* No distance found */
@@ -213,6 +215,11 @@ public:
   void interpolatePoints(const atools::geo::Pos& otherPos, float distanceMeter, int numPoints,
                          QList<atools::geo::Pos>& positions) const;
 
+  /* Same as above but appends to a line string. Great circle constants are calculated once for all points
+   * which leaves only the conversion back to coordinates for each point. */
+  void interpolatePoints(const atools::geo::Pos& otherPos, float distanceMeter, int numPoints,
+                         atools::geo::LineString& positions) const;
+
   /* Find point between start and end on rhumb line */
   atools::geo::Pos interpolateRhumb(const atools::geo::Pos& otherPos, float distanceMeter,
                                     float fraction) const;
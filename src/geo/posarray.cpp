@@ -0,0 +1,180 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "geo/posarray.h"
+#include "geo/calculations.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace atools {
+namespace geo {
+
+PosArray::PosArray()
+{
+
+}
+
+PosArray::PosArray(const QVector<Pos>& positions)
+{
+  reserve(positions.size());
+  for(const Pos& pos : positions)
+    append(pos);
+}
+
+void PosArray::append(const Pos& pos)
+{
+  lonX.append(pos.getLonX());
+  latY.append(pos.getLatY());
+
+  if(pos.isValid())
+  {
+    double lon = toRadians(static_cast<double>(pos.getLonX()));
+    double lat = toRadians(static_cast<double>(pos.getLatY()));
+    x.append(std::cos(lat) * std::cos(lon));
+    y.append(std::cos(lat) * std::sin(lon));
+    z.append(std::sin(lat));
+  }
+  else
+  {
+    x.append(std::numeric_limits<double>::quiet_NaN());
+    y.append(std::numeric_limits<double>::quiet_NaN());
+    z.append(std::numeric_limits<double>::quiet_NaN());
+  }
+}
+
+void PosArray::reserve(int size)
+{
+  lonX.reserve(size);
+  latY.reserve(size);
+  x.reserve(size);
+  y.reserve(size);
+  z.reserve(size);
+}
+
+void PosArray::clear()
+{
+  lonX.clear();
+  latY.clear();
+  x.clear();
+  y.clear();
+  z.clear();
+}
+
+void PosArray::distancesMeter(const Pos& pos, QVector<float>& result) const
+{
+  // Copy to avoid odr-use of the constexpr member
+  const float invalid = Pos::INVALID_VALUE;
+  result.fill(invalid, size());
+  if(!pos.isValid())
+    return;
+
+  double lon = toRadians(static_cast<double>(pos.getLonX()));
+  double lat = toRadians(static_cast<double>(pos.getLatY()));
+  double px = std::cos(lat) * std::cos(lon), py = std::cos(lat) * std::sin(lon), pz = std::sin(lat);
+
+  const double *xp = x.constData(), *yp = y.constData(), *zp = z.constData();
+  float *res = result.data();
+  int num = size();
+  for(int i = 0; i < num; i++)
+  {
+    double dx = xp[i] - px, dy = yp[i] - py, dz = zp[i] - pz;
+
+    // Chord length to angle - always within the valid range of asin for unit vectors
+    double chord = std::sqrt(dx * dx + dy * dy + dz * dz);
+    res[i] = static_cast<float>(2. * std::asin(std::min(chord / 2., 1.)) * EARTH_RADIUS_METER);
+  }
+
+  // NaN for invalid positions
+  for(int i = 0; i < num; i++)
+  {
+    if(std::isnan(res[i]))
+      res[i] = Pos::INVALID_VALUE;
+  }
+}
+
+void PosArray::coursesDeg(const Pos& pos, QVector<float>& result) const
+{
+  // Copy to avoid odr-use of the constexpr member
+  const float invalid = Pos::INVALID_VALUE;
+  result.fill(invalid, size());
+  if(!pos.isValid())
+    return;
+
+  // North and east unit vectors at pos - course is the angle of the target vector in this tangent plane
+  double lon = toRadians(static_cast<double>(pos.getLonX()));
+  double lat = toRadians(static_cast<double>(pos.getLatY()));
+  double nx = -std::sin(lat) * std::cos(lon), ny = -std::sin(lat) * std::sin(lon), nz = std::cos(lat);
+  double ex = -std::sin(lon), ey = std::cos(lon);
+
+  const double *xp = x.constData(), *yp = y.constData(), *zp = z.constData();
+  float *res = result.data();
+  int num = size();
+  for(int i = 0; i < num; i++)
+  {
+    double course = toDegree(std::atan2(xp[i] * ex + yp[i] * ey, xp[i] * nx + yp[i] * ny + zp[i] * nz));
+    res[i] = static_cast<float>(course < 0. ? course + 360. : course);
+  }
+
+  // NaN for invalid positions and no course for the same position
+  for(int i = 0; i < num; i++)
+  {
+    if(std::isnan(res[i]) || (lonX.at(i) == pos.getLonX() && latY.at(i) == pos.getLatY()))
+      res[i] = Pos::INVALID_VALUE;
+  }
+}
+
+int PosArray::nearest(const Pos& pos, float *distanceMeter) const
+{
+  if(distanceMeter != nullptr)
+    *distanceMeter = Pos::INVALID_VALUE;
+
+  if(!pos.isValid() || isEmpty())
+    return -1;
+
+  double lon = toRadians(static_cast<double>(pos.getLonX()));
+  double lat = toRadians(static_cast<double>(pos.getLatY()));
+  double px = std::cos(lat) * std::cos(lon), py = std::cos(lat) * std::sin(lon), pz = std::sin(lat);
+
+  // Largest dot product is the nearest - comparisons with NaN are false which skips invalid positions
+  const double *xp = x.constData(), *yp = y.constData(), *zp = z.constData();
+  double maxDot = -2.;
+  int index = -1;
+  for(int i = 0; i < size(); i++)
+  {
+    double dot = xp[i] * px + yp[i] * py + zp[i] * pz;
+    if(dot > maxDot)
+    {
+      maxDot = dot;
+      index = i;
+    }
+  }
+
+  if(index != -1 && distanceMeter != nullptr)
+  {
+    // Use chord instead of the dot product for precision at short distances
+    double dx = xp[index] - px, dy = yp[index] - py, dz = zp[index] - pz;
+    double chord = std::sqrt(dx * dx + dy * dy + dz * dz);
+    *distanceMeter = static_cast<float>(2. * std::asin(std::min(chord / 2., 1.)) * EARTH_RADIUS_METER);
+  }
+
+  return index;
+}
+
+} // namespace geo
+} // namespace atools
@@ -0,0 +1,82 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_GEO_POSARRAY_H
+#define ATOOLS_GEO_POSARRAY_H
+
+#include "geo/pos.h"
+
+#include <QVector>
+
+namespace atools {
+namespace geo {
+
+/*
+ * List of positions stored as separate arrays of unit vector components to allow fast
+ * distance calculations from one position to all positions in the array.
+ *
+ * Distances are calculated from the straight line distance of the unit vectors which needs only
+ * multiply-adds and one square root and arc sine per point. Finding the nearest position needs no
+ * trigonometry at all. The loops are free of branches and function calls to allow vectorization by the compiler.
+ */
+class PosArray
+{
+public:
+  PosArray();
+  explicit PosArray(const QVector<atools::geo::Pos>& positions);
+
+  /* Invalid positions are stored but never returned as nearest and have a distance of Pos::INVALID_VALUE */
+  void append(const atools::geo::Pos& pos);
+  void reserve(int size);
+  void clear();
+
+  atools::geo::Pos at(int index) const
+  {
+    return Pos(lonX.at(index), latY.at(index));
+  }
+
+  int size() const
+  {
+    return lonX.size();
+  }
+
+  bool isEmpty() const
+  {
+    return lonX.isEmpty();
+  }
+
+  /* Fills result with the distances in meter from pos to all positions */
+  void distancesMeter(const atools::geo::Pos& pos, QVector<float>& result) const;
+
+  /* Fills result with the great circle initial course in degree from pos to all positions */
+  void coursesDeg(const atools::geo::Pos& pos, QVector<float>& result) const;
+
+  /* Index of the position nearest to pos or -1 if array is empty or all positions are invalid.
+   * Distance is returned in distanceMeter if not null. */
+  int nearest(const atools::geo::Pos& pos, float *distanceMeter = nullptr) const;
+
+private:
+  QVector<float> lonX, latY;
+
+  /* Unit vector components. NaN for invalid positions. */
+  QVector<double> x, y, z;
+};
+
+} // namespace geo
+} // namespace atools
+
+#endif // ATOOLS_GEO_POSARRAY_H
@@ -0,0 +1,340 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_GEO_RTREE_H
+#define ATOOLS_GEO_RTREE_H
+
+#include "geo/rect.h"
+
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+
+namespace atools {
+namespace geo {
+
+/*
+ * Static R-tree for objects bounded by a rectangle allowing to find all objects overlapping a rectangle
+ * or containing a position.
+ *
+ * The tree is bulk loaded on demand after inserts using sort-tile-recursive (STR) packing and stored in a flat
+ * node array. Rectangles crossing the anti-meridian are split into two parts which can both refer to the same
+ * entry. Results never contain duplicates and are returned in insertion order.
+ */
+template<typename TYPE>
+class RTree
+{
+public:
+  RTree(int nodeCapacity = 16)
+    : capacity(std::max(nodeCapacity, 2))
+  {
+  }
+
+  ~RTree()
+  {
+  }
+
+  /* Add entry. Invalid rectangles are stored but never returned. */
+  void insert(const atools::geo::Rect& rect, const TYPE& type);
+
+  /* Build tree now. Otherwise done on first query after an insert. */
+  void build();
+
+  /* Get all entries with bounding rectangles overlapping rect */
+  QVector<TYPE> getOverlapping(const atools::geo::Rect& rect);
+  void getOverlapping(QVector<TYPE>& result, const atools::geo::Rect& rect);
+
+  /* Get all entries with bounding rectangles containing pos */
+  QVector<TYPE> getContaining(const atools::geo::Pos& pos);
+  void getContaining(QVector<TYPE>& result, const atools::geo::Pos& pos);
+
+  void clear();
+
+  bool isEmpty() const
+  {
+    return entries.isEmpty();
+  }
+
+  int size() const
+  {
+    return entries.size();
+  }
+
+private:
+  /* Box not crossing the anti-meridian */
+  struct Box
+  {
+    float west, south, east, north;
+
+    bool overlaps(const Box& other) const
+    {
+      return west <= other.east && other.west <= east && south <= other.north && other.south <= north;
+    }
+
+    void extend(const Box& other)
+    {
+      west = std::min(west, other.west);
+      south = std::min(south, other.south);
+      east = std::max(east, other.east);
+      north = std::max(north, other.north);
+    }
+
+    float centerX() const
+    {
+      return (west + east) / 2.f;
+    }
+
+    float centerY() const
+    {
+      return (south + north) / 2.f;
+    }
+
+  };
+
+  struct Entry
+  {
+    atools::geo::Rect rect;
+    TYPE type;
+  };
+
+  /* Leaf item pointing to entries */
+  struct Item
+  {
+    Box box;
+    int entry;
+  };
+
+  /* Node covering the range first to first + count in items for leaves or nodes otherwise */
+  struct Node
+  {
+    Box box;
+    int first, count;
+    bool leaf;
+  };
+
+  static void toBoxes(QVector<Box>& boxes, const atools::geo::Rect& rect);
+
+  /* Sort elements into tiles of slices so that each consecutive group of capacity elements is a tight cluster */
+  template<typename ELEMENT>
+  void sortTiles(QVector<ELEMENT>& elements) const;
+
+  /* Create parent nodes for consecutive groups of elements starting at offset */
+  template<typename ELEMENT>
+  QVector<Node> packNodes(const QVector<ELEMENT>& elements, int offset, bool leaf) const;
+
+  void invalidateTree();
+  void search(QVector<TYPE>& result, const QVector<Box>& queryBoxes);
+
+  QVector<Entry> entries;
+
+  /* Items sorted by tiles and all nodes from the lowest level up with the root last */
+  QVector<Item> items;
+  QVector<Node> nodes;
+  bool treeValid = false;
+  int capacity;
+};
+
+template<typename TYPE>
+void RTree<TYPE>::insert(const Rect& rect, const TYPE& type)
+{
+  entries.append({rect, type});
+  invalidateTree();
+}
+
+template<typename TYPE>
+void RTree<TYPE>::invalidateTree()
+{
+  if(treeValid)
+  {
+    items.clear();
+    nodes.clear();
+    treeValid = false;
+  }
+}
+
+template<typename TYPE>
+void RTree<TYPE>::toBoxes(QVector<Box>& boxes, const Rect& rect)
+{
+  for(const Rect& r : rect.splitAtAntiMeridian())
+    boxes.append({r.getWest(), r.getSouth(), r.getEast(), r.getNorth()});
+}
+
+template<typename TYPE>
+template<typename ELEMENT>
+void RTree<TYPE>::sortTiles(QVector<ELEMENT>& elements) const
+{
+  int numNodes = (elements.size() + capacity - 1) / capacity;
+  int numSlices = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(numNodes))));
+  int sliceSize = numSlices * capacity;
+
+  // Sort all by x into vertical slices and each slice by y
+  std::sort(elements.begin(), elements.end(), [](const ELEMENT& e1, const ELEMENT& e2) -> bool
+        {
+          return e1.box.centerX() < e2.box.centerX();
+        });
+
+  for(int begin = 0; begin < elements.size(); begin += sliceSize)
+  {
+    int end = std::min(begin + sliceSize, elements.size());
+    std::sort(elements.begin() + begin, elements.begin() + end, [](const ELEMENT& e1, const ELEMENT& e2) -> bool
+          {
+            return e1.box.centerY() < e2.box.centerY();
+          });
+  }
+}
+
+template<typename TYPE>
+template<typename ELEMENT>
+QVector<typename RTree<TYPE>::Node> RTree<TYPE>::packNodes(const QVector<ELEMENT>& elements, int offset,
+                                                           bool leaf) const
+{
+  QVector<Node> parents;
+  parents.reserve((elements.size() + capacity - 1) / capacity);
+
+  for(int begin = 0; begin < elements.size(); begin += capacity)
+  {
+    int end = std::min(begin + capacity, elements.size());
+    Node node = {elements.at(begin).box, offset + begin, end - begin, leaf};
+    for(int i = begin + 1; i < end; i++)
+      node.box.extend(elements.at(i).box);
+    parents.append(node);
+  }
+  return parents;
+}
+
+template<typename TYPE>
+void RTree<TYPE>::build()
+{
+  if(treeValid)
+    return;
+
+  items.clear();
+  nodes.clear();
+
+  QVector<Box> boxes;
+  for(int i = 0; i < entries.size(); i++)
+  {
+    boxes.clear();
+    toBoxes(boxes, entries.at(i).rect);
+    for(const Box& box : boxes)
+      items.append({box, i});
+  }
+
+  if(!items.isEmpty())
+  {
+    sortTiles(items);
+    QVector<Node> level = packNodes(items, 0, true);
+
+    // Pack each level into the next higher until only the root is left
+    while(level.size() > 1)
+    {
+      sortTiles(level);
+      int offset = nodes.size();
+      nodes.append(level);
+      level = packNodes(level, offset, false);
+    }
+    nodes.append(level.first());
+  }
+  treeValid = true;
+}
+
+template<typename TYPE>
+void RTree<TYPE>::search(QVector<TYPE>& result, const QVector<Box>& queryBoxes)
+{
+  build();
+
+  if(nodes.isEmpty() || queryBoxes.isEmpty())
+    return;
+
+  QVector<int> found, stack;
+  for(const Box& query : queryBoxes)
+  {
+    stack.append(nodes.size() - 1);
+    while(!stack.isEmpty())
+    {
+      const Node& node = nodes.at(stack.takeLast());
+      if(!node.box.overlaps(query))
+        continue;
+
+      for(int i = node.first; i < node.first + node.count; i++)
+      {
+        if(node.leaf)
+        {
+          const Item& item = items.at(i);
+          if(item.box.overlaps(query))
+            found.append(item.entry);
+        }
+        else
+          stack.append(i);
+      }
+    }
+  }
+
+  // Remove duplicates from split rectangles and restore insertion order
+  std::sort(found.begin(), found.end());
+  found.erase(std::unique(found.begin(), found.end()), found.end());
+
+  result.reserve(result.size() + found.size());
+  for(int entry : found)
+    result.append(entries.at(entry).type);
+}
+
+template<typename TYPE>
+void RTree<TYPE>::getOverlapping(QVector<TYPE>& result, const Rect& rect)
+{
+  QVector<Box> queryBoxes;
+  toBoxes(queryBoxes, rect);
+  search(result, queryBoxes);
+}
+
+template<typename TYPE>
+QVector<TYPE> RTree<TYPE>::getOverlapping(const Rect& rect)
+{
+  QVector<TYPE> result;
+  getOverlapping(result, rect);
+  return result;
+}
+
+template<typename TYPE>
+void RTree<TYPE>::getContaining(QVector<TYPE>& result, const Pos& pos)
+{
+  if(pos.isValid())
+    search(result, {{pos.getLonX(), pos.getLatY(), pos.getLonX(), pos.getLatY()}});
+}
+
+template<typename TYPE>
+QVector<TYPE> RTree<TYPE>::getContaining(const Pos& pos)
+{
+  QVector<TYPE> result;
+  getContaining(result, pos);
+  return result;
+}
+
+template<typename TYPE>
+void RTree<TYPE>::clear()
+{
+  entries.clear();
+  items.clear();
+  nodes.clear();
+  treeValid = false;
+}
+
+} // namespace geo
+} // namespace atools
+
+#endif // ATOOLS_GEO_RTREE_H
@@ -18,18 +18,27 @@
 #ifndef ATOOLS_SIMPLESPATIALINDEX_H
 #define ATOOLS_SIMPLESPATIALINDEX_H
 
+#include "geo/calculations.h"
 #include "geo/pos.h"
+#include "util/perfcounters.h"
 
 #include <QCache>
 #include <QVector>
+
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <limits>
 
 namespace atools {
 namespace geo {
 
 /*
- * Simple and inefficient spatial index using full search.
- * Do not use for performance critical applications or large datasets.
+ * Simple spatial index allowing to find the nearest entries for a position.
+ *
+ * Positions are converted to unit vectors and stored in a KD-tree which is built on demand after inserts.
+ * The straight line distance between unit vectors increases with the great circle distance which
+ * allows exact nearest searches without trigonometry for each candidate.
  */
 template<typename KEY, typename TYPE>
 class SimpleSpatialIndex
@@ -48,6 +57,9 @@ public:
   void insert(const KEY& key, const TYPE& type, const atools::geo::Pos& pos);
   void insert(const KEY& key, const atools::geo::Pos& pos);
 
+  /* Remove entry. Returns false if key was not found. */
+  bool remove(const KEY& key);
+
   /* Returned KEY will differ if only nearest was found.
    * Will be equal to passed key is exact was found.
    * Key is empty if nothing was found.
@@ -55,6 +67,12 @@ public:
   KEY getTypeOrNearest(TYPE& type, const KEY& key, const atools::geo::Pos& pos);
   KEY getTypeOrNearest(const KEY& key, const atools::geo::Pos& pos);
 
+  /* Get keys of the num nearest entries ordered by distance. Entries with invalid positions are ignored. */
+  QVector<KEY> getNearest(const atools::geo::Pos& pos, int num);
+
+  /* Get keys of all entries within the radius ordered by distance */
+  QVector<KEY> getRadius(const atools::geo::Pos& pos, float radiusMeter);
+
   bool contains(const KEY& key) const
   {
     return index.contains(key);
@@ -89,8 +107,42 @@ private:
     atools::geo::Pos pos;
   };
 
+  /* Position as unit vector with pointer into index */
+  struct TreePoint
+  {
+    double x, y, z;
+    const Entry *entry;
+  };
+
+  typedef std::pair<double, const Entry *> TreeResult;
+
+  void invalidateTree();
+  void buildTree();
+  void buildTree(int begin, int end, int axis);
+
+  /* Collect entries with a squared distance below maxDistSq. Keeps the num nearest if num is not -1. */
+  void searchTree(int begin, int end, int axis, const TreePoint& query, int num, double maxDistSq,
+                  QVector<TreeResult>& results) const;
+  QVector<KEY> search(const atools::geo::Pos& pos, int num, double maxDistSq);
+
+  static TreePoint toTreePoint(const atools::geo::Pos& pos, const Entry *entry);
+
+  static double coord(const TreePoint& point, int axis)
+  {
+    return axis == 0 ? point.x : (axis == 1 ? point.y : point.z);
+  }
+
+  static double distSq(const TreePoint& p1, const TreePoint& p2)
+  {
+    return (p1.x - p2.x) * (p1.x - p2.x) + (p1.y - p2.y) * (p1.y - p2.y) + (p1.z - p2.z) * (p1.z - p2.z);
+  }
+
   QHash<KEY, Entry> index;
 
+  /* Implicit KD-tree: the middle element of each range is the node splitting the range */
+  QVector<TreePoint> tree;
+  bool treeValid = false;
+
   /* Maps keys to nearest entries */
   QCache<KEY, Entry> cache;
 
@@ -100,12 +152,170 @@ template<typename KEY, typename TYPE>
 void SimpleSpatialIndex<KEY, TYPE>::insert(const KEY& key, const TYPE& type, const geo::Pos& pos)
 {
   index.insert(key, {key, type, pos});
+  invalidateTree();
 }
 
 template<typename KEY, typename TYPE>
 void SimpleSpatialIndex<KEY, TYPE>::insert(const KEY& key, const Pos& pos)
 {
   index.insert(key, {key, TYPE(), pos});
+  invalidateTree();
+}
+
+template<typename KEY, typename TYPE>
+bool SimpleSpatialIndex<KEY, TYPE>::remove(const KEY& key)
+{
+  if(index.remove(key) > 0)
+  {
+    invalidateTree();
+    return true;
+  }
+  return false;
+}
+
+template<typename KEY, typename TYPE>
+void SimpleSpatialIndex<KEY, TYPE>::invalidateTree()
+{
+  if(treeValid)
+  {
+    tree.clear();
+    treeValid = false;
+  }
+
+  // Nearest results might change
+  if(!cache.isEmpty())
+    cache.clear();
+}
+
+template<typename KEY, typename TYPE>
+typename SimpleSpatialIndex<KEY, TYPE>::TreePoint SimpleSpatialIndex<KEY, TYPE>::toTreePoint(const Pos& pos,
+                                                                                            const Entry *entry)
+{
+  double lon = atools::geo::toRadians(static_cast<double>(pos.getLonX()));
+  double lat = atools::geo::toRadians(static_cast<double>(pos.getLatY()));
+  return {std::cos(lat) * std::cos(lon), std::cos(lat) * std::sin(lon), std::sin(lat), entry};
+}
+
+template<typename KEY, typename TYPE>
+void SimpleSpatialIndex<KEY, TYPE>::buildTree()
+{
+  tree.clear();
+  tree.reserve(index.size());
+
+  // Entry pointers stay valid until the hash is modified which invalidates the tree
+  for(auto it = index.constBegin(); it != index.constEnd(); ++it)
+  {
+    if(it.value().pos.isValid())
+      tree.append(toTreePoint(it.value().pos, &it.value()));
+  }
+
+  buildTree(0, tree.size(), 0);
+  treeValid = true;
+}
+
+template<typename KEY, typename TYPE>
+void SimpleSpatialIndex<KEY, TYPE>::buildTree(int begin, int end, int axis)
+{
+  if(end - begin <= 1)
+    return;
+
+  int mid = (begin + end) / 2;
+  std::nth_element(tree.begin() + begin, tree.begin() + mid, tree.begin() + end,
+                   [axis](const TreePoint& p1, const TreePoint& p2) -> bool
+        {
+          return coord(p1, axis) < coord(p2, axis);
+        });
+
+  buildTree(begin, mid, (axis + 1) % 3);
+  buildTree(mid + 1, end, (axis + 1) % 3);
+}
+
+template<typename KEY, typename TYPE>
+void SimpleSpatialIndex<KEY, TYPE>::searchTree(int begin, int end, int axis, const TreePoint& query, int num,
+                                               double maxDistSq, QVector<TreeResult>& results) const
+{
+  if(begin >= end)
+    return;
+
+  int mid = (begin + end) / 2;
+  const TreePoint& node = tree.at(mid);
+
+  double dist = distSq(node, query);
+  double bound = num != -1 && results.size() >= num ? std::min(maxDistSq, results.last().first) : maxDistSq;
+  if(dist <= bound)
+  {
+    if(num == -1)
+      results.append(std::make_pair(dist, node.entry));
+    else
+    {
+      // Keep the list sorted and limited to num entries
+      auto it = std::upper_bound(results.begin(), results.end(), dist,
+                                 [](double d, const TreeResult& result) -> bool
+            {
+              return d < result.first;
+            });
+      results.insert(it, std::make_pair(dist, node.entry));
+      if(results.size() > num)
+        results.removeLast();
+    }
+  }
+
+  // Search the side containing the query first
+  double diff = coord(query, axis) - coord(node, axis);
+  int nextAxis = (axis + 1) % 3;
+  if(diff < 0.)
+    searchTree(begin, mid, nextAxis, query, num, maxDistSq, results);
+  else
+    searchTree(mid + 1, end, nextAxis, query, num, maxDistSq, results);
+
+  // Search other side only if the splitting plane is closer than the current bound
+  bound = num != -1 && results.size() >= num ? std::min(maxDistSq, results.last().first) : maxDistSq;
+  if(diff * diff <= bound)
+  {
+    if(diff < 0.)
+      searchTree(mid + 1, end, nextAxis, query, num, maxDistSq, results);
+    else
+      searchTree(begin, mid, nextAxis, query, num, maxDistSq, results);
+  }
+}
+
+template<typename KEY, typename TYPE>
+QVector<KEY> SimpleSpatialIndex<KEY, TYPE>::search(const Pos& pos, int num, double maxDistSq)
+{
+  QVector<KEY> keys;
+  if(!pos.isValid() || num == 0)
+    return keys;
+
+  if(!treeValid)
+    buildTree();
+
+  QVector<TreeResult> results;
+  searchTree(0, tree.size(), 0, toTreePoint(pos, nullptr), num, maxDistSq, results);
+
+  if(num == -1)
+    std::sort(results.begin(), results.end(), [](const TreeResult& r1, const TreeResult& r2) -> bool
+          {
+            return r1.first < r2.first;
+          });
+
+  for(const TreeResult& result : results)
+    keys.append(result.second->key);
+  return keys;
+}
+
+template<typename KEY, typename TYPE>
+QVector<KEY> SimpleSpatialIndex<KEY, TYPE>::getNearest(const Pos& pos, int num)
+{
+  return search(pos, num, std::numeric_limits<double>::max());
+}
+
+template<typename KEY, typename TYPE>
+QVector<KEY> SimpleSpatialIndex<KEY, TYPE>::getRadius(const Pos& pos, float radiusMeter)
+{
+  // Straight line distance between unit vectors for the angle
+  double angle = std::min(static_cast<double>(radiusMeter) / EARTH_RADIUS_METER, M_PI);
+  double chord = 2. * std::sin(angle / 2.);
+  return search(pos, -1, chord * chord);
 }
 
 template<typename KEY, typename TYPE>
@@ -126,30 +336,19 @@ KEY SimpleSpatialIndex<KEY, TYPE>::getTypeOrNearest(TYPE& type, const KEY& key,
       Entry *nearest = cache.object(key);
       if(nearest == nullptr)
       {
-        // Create new entry for cache
-        nearest = new Entry;
-        float nearestDistance = std::numeric_limits<float>::max();
-
-        for(const Entry& entry : index.values())
+        ATOOLS_PERF_COUNT("geo.spatialindex.cache_miss", 1);
+        QVector<KEY> nearestKeys = getNearest(pos, 1);
+        if(!nearestKeys.isEmpty())
         {
-          float dist = entry.pos.distanceMeterTo(pos);
-          if(dist < nearestDistance)
-          {
-            nearestDistance = dist;
-            *nearest = entry;
-          }
-        }
-
-        if(nearestDistance < std::numeric_limits<float>::max())
-          // Found an entry
+          // Found an entry - create new entry for cache
+          nearest = new Entry(index.value(nearestKeys.first()));
           cache.insert(key, nearest);
-        else
-        {
-          delete nearest;
-          nearest = nullptr;
         }
       }
 
+      else
+        ATOOLS_PERF_COUNT("geo.spatialindex.cache_hit", 1);
+
       if(nearest != nullptr)
       {
         type = nearest->type;
@@ -191,6 +390,8 @@ template<typename KEY, typename TYPE>
 void SimpleSpatialIndex<KEY, TYPE>::clear()
 {
   index.clear();
+  tree.clear();
+  treeValid = false;
   cache.clear();
 }
 
@@ -35,7 +35,14 @@ GridDelegate::~GridDelegate()
 
 void GridDelegate::styleChanged()
 {
-  gridPen = QPen(QApplication::palette().color(QPalette::Active, QPalette::Window), 1.5);
+  updatePen();
+}
+
+void GridDelegate::updatePen() const
+{
+  QPalette palette = QApplication::palette();
+  gridPen = QPen(palette.color(QPalette::Active, QPalette::Window), 1.5);
+  paletteCacheKey = palette.cacheKey();
 }
 
 void GridDelegate::paint(QPainter *painter, const QStyleOptionViewItem& option,
@@ -43,10 +50,17 @@ void GridDelegate::paint(QPainter *painter, const QStyleOptionViewItem& option,
 {
   QStyledItemDelegate::paint(painter, option, index);
 
-  painter->save();
+  if(QApplication::palette().cacheKey() != paletteCacheKey)
+    updatePen();
+
+  // Change only pen and brush instead of saving the whole painter state for each cell
+  QPen oldPen = painter->pen();
+  QBrush oldBrush = painter->brush();
   painter->setPen(gridPen);
+  painter->setBrush(Qt::NoBrush);
   painter->drawRect(option.rect);
-  painter->restore();
+  painter->setPen(oldPen);
+  painter->setBrush(oldBrush);
 }
 
 } // namespace gui
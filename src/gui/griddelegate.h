@@ -32,12 +32,16 @@ public:
   GridDelegate(QObject *parent);
   virtual ~GridDelegate();
 
+  /* Update pen from palette. Also done automatically on the next paint if the application palette changes. */
   void styleChanged();
 
 private:
   void paint(QPainter *painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+  void updatePen() const;
 
-  QPen gridPen;
+  /* Pen is cached and only created again if the palette changes */
+  mutable QPen gridPen;
+  mutable qint64 paletteCacheKey = 0;
 };
 
 } // namespace gui
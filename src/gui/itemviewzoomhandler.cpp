@@ -63,26 +63,45 @@ void ItemViewZoomHandler::fontChanged()
 {
   qDebug() << Q_FUNC_INFO;
 
+  fontHeightCache.clear();
   setTableViewFontSize(defaultTableViewFontPointSize);
 }
 
+int ItemViewZoomHandler::fontHeight(const QFont& font)
+{
+  int key = static_cast<int>(font.pointSizeF() * 10.);
+  QHash<int, int>::const_iterator it = fontHeightCache.constFind(key);
+  if(it != fontHeightCache.constEnd())
+    return it.value();
+
+  int height = QFontMetrics(font).height();
+  fontHeightCache.insert(key, height);
+  return height;
+}
+
 void ItemViewZoomHandler::setTableViewFontSize(float pointSize)
 {
   QFont newFont(itemView->font());
   newFont.setPointSizeF(pointSize);
 
-  int newFontHeight = QFontMetrics(newFont).height();
+  int newFontHeight = fontHeight(newFont);
 
   qDebug() << "new font height" << newFontHeight << "point size" << newFont.pointSize();
 
-  itemView->setFont(newFont);
+  // Setting the font causes a relayout of the whole view - skip if not changed
+  if(newFont != itemView->font())
+    itemView->setFont(newFont);
 
   QTableView *tableView = dynamic_cast<QTableView *>(itemView);
   if(tableView != nullptr)
   {
     // Adjust the cell height - default is too big
-    tableView->verticalHeader()->setDefaultSectionSize(newFontHeight + sectionToFontSize);
-    tableView->verticalHeader()->setMinimumSectionSize(newFontHeight + sectionToFontSize);
+    QHeaderView *header = tableView->verticalHeader();
+    int sectionSize = newFontHeight + sectionToFontSize;
+    if(header->defaultSectionSize() != sectionSize)
+      header->setDefaultSectionSize(sectionSize);
+    if(header->minimumSectionSize() != sectionSize)
+      header->setMinimumSectionSize(sectionSize);
   }
 }
 
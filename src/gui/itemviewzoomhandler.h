@@ -19,6 +19,7 @@
 #define ATOOLS_TABLEZOOMHANDLER_H
 
 #include <QObject>
+#include <QHash>
 
 class QAction;
 class QAbstractItemView;
@@ -98,6 +99,9 @@ private:
   /* Change font size and adjust row height accordingly */
   void setTableViewFontSize(float pointSize);
 
+  /* Font height for point size from cache */
+  int fontHeight(const QFont& font);
+
 private:
   float defaultTableViewFontPointSize;
 
@@ -108,6 +112,9 @@ private:
   QAbstractItemView *itemView;
   QAction *actionZoomIn, *actionZoomOut, *actionZoomDefault;
   QString settingsKey;
+
+  /* Font height by point size times ten. Cleared on font change. */
+  QHash<int, int> fontHeightCache;
 };
 
 } // namespace gui
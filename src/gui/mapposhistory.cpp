@@ -24,6 +24,8 @@
 #include <QDataStream>
 #include <QFile>
 
+#include <algorithm>
+
 namespace atools {
 namespace gui {
 
@@ -84,21 +86,33 @@ QDebug operator<<(QDebug debug, const MapPosHistoryEntry& entry)
 MapPosHistory::MapPosHistory(QObject *parent)
   : QObject(parent)
 {
+  ring.resize(MAX_NUMBER_OF_ENTRIES);
 }
 
 MapPosHistory::~MapPosHistory()
 {
 }
 
+const MapPosHistoryEntry& MapPosHistory::entryAt(int index) const
+{
+  return ring.at((ringStart + index) % MAX_NUMBER_OF_ENTRIES);
+}
+
+MapPosHistoryEntry& MapPosHistory::entryAt(int index)
+{
+  return ring[(ringStart + index) % MAX_NUMBER_OF_ENTRIES];
+}
+
 const MapPosHistoryEntry& MapPosHistory::next()
 {
   if(active)
   {
-    if(currentIndex < entries.size() - 1)
+    if(currentIndex < numEntries - 1)
     {
       currentIndex++;
-      emit historyChanged(0, currentIndex, entries.size() - 1);
-      return entries.at(currentIndex);
+      journal.append({JOURNAL_INDEX, currentIndex, MapPosHistoryEntry()});
+      emit historyChanged(0, currentIndex, numEntries - 1);
+      return entryAt(currentIndex);
     }
   }
   return EMPTY_MAP_POS;
@@ -111,8 +125,9 @@ const MapPosHistoryEntry& MapPosHistory::back()
     if(currentIndex > 0)
     {
       currentIndex--;
-      emit historyChanged(0, currentIndex, entries.size() - 1);
-      return entries.at(currentIndex);
+      journal.append({JOURNAL_INDEX, currentIndex, MapPosHistoryEntry()});
+      emit historyChanged(0, currentIndex, numEntries - 1);
+      return entryAt(currentIndex);
     }
   }
   return EMPTY_MAP_POS;
@@ -120,12 +135,49 @@ const MapPosHistoryEntry& MapPosHistory::back()
 
 const MapPosHistoryEntry& MapPosHistory::current() const
 {
-  if(!entries.isEmpty())
-    return entries.at(currentIndex);
+  if(numEntries > 0)
+    return entryAt(currentIndex);
 
   return EMPTY_MAP_POS;
 }
 
+void MapPosHistory::appendInternal(const MapPosHistoryEntry& entry)
+{
+  // Prune forward history
+  numEntries = currentIndex + 1;
+
+  if(numEntries < MAX_NUMBER_OF_ENTRIES)
+  {
+    numEntries++;
+    currentIndex++;
+  }
+  else
+    // Full - overwrite oldest entry
+    ringStart = (ringStart + 1) % MAX_NUMBER_OF_ENTRIES;
+
+  entryAt(currentIndex) = entry;
+}
+
+void MapPosHistory::apply(const JournalRecord& record)
+{
+  switch(record.type)
+  {
+    case JOURNAL_APPEND:
+      appendInternal(record.entry);
+      break;
+
+    case JOURNAL_REPLACE:
+      if(numEntries > 0)
+        entryAt(currentIndex) = record.entry;
+      break;
+
+    case JOURNAL_INDEX:
+      if(record.index >= 0 && record.index < numEntries)
+        currentIndex = record.index;
+      break;
+  }
+}
+
 void MapPosHistory::addEntry(atools::geo::Pos pos, double distance)
 {
   if(!active)
@@ -140,33 +192,55 @@ void MapPosHistory::addEntry(atools::geo::Pos pos, double distance)
   if(curEntry.getTimestamp() > newEntry.getTimestamp() - MAX_MS_FOR_NEW_ENTRY)
   {
     // Entries are added too close - overwrite the current one
-    entries[currentIndex] = newEntry;
+    entryAt(currentIndex) = newEntry;
+
+    // Collapse consecutive replacements into one record
+    if(!journal.isEmpty() && journal.last().type == JOURNAL_REPLACE)
+      journal.last().entry = newEntry;
+    else
+      journal.append({JOURNAL_REPLACE, currentIndex, newEntry});
   }
   else
   {
-    if(currentIndex != -1)
-    {
-      int size = entries.size();
-      // Prune forward history
-      for(int i = currentIndex + 1; i < size; i++)
-        entries.removeLast();
-    }
+    appendInternal(newEntry);
+    journal.append({JOURNAL_APPEND, currentIndex, newEntry});
+    emit historyChanged(0, currentIndex, numEntries - 1);
+  }
+}
 
-    entries.append(newEntry);
-    currentIndex++;
+void MapPosHistory::writeRecord(QDataStream& out, const JournalRecord& record)
+{
+  out << static_cast<quint8>(record.type);
+  if(record.type == JOURNAL_INDEX)
+    out << record.index;
+  else
+    // Compact entry with distance as float
+    out << record.entry.getTimestamp() << record.entry.getPos() << static_cast<float>(record.entry.getDistance());
+}
 
-    while(entries.size() > MAX_NUMBER_OF_ENTRIES)
-    {
-      // Remove additional entries
-      entries.removeFirst();
-      currentIndex--;
-    }
+bool MapPosHistory::readRecord(QDataStream& in, JournalRecord& record)
+{
+  quint8 type;
+  in >> type;
+  record.type = static_cast<JournalType>(type);
 
-    emit historyChanged(0, currentIndex, entries.size() - 1);
+  if(record.type == JOURNAL_INDEX)
+    in >> record.index;
+  else if(record.type == JOURNAL_APPEND || record.type == JOURNAL_REPLACE)
+  {
+    qint64 timestamp;
+    atools::geo::Pos pos;
+    float distance;
+    in >> timestamp >> pos >> distance;
+    record.entry = MapPosHistoryEntry(pos, distance, timestamp);
   }
+  else
+    return false;
+
+  return in.status() == QDataStream::Ok;
 }
 
-void MapPosHistory::saveState(const QString& filename)
+bool MapPosHistory::writeFull(const QString& filename)
 {
   QFile historyFile(filename);
 
@@ -175,17 +249,70 @@ void MapPosHistory::saveState(const QString& filename)
     QDataStream out(&historyFile);
     out.setVersion(QDataStream::Qt_5_5);
 
-    out << FILE_MAGIC_NUMBER << FILE_VERSION << currentIndex << entries;
+    out << FILE_MAGIC_NUMBER << FILE_VERSION;
+
+    // Snapshot of the current state
+    for(int i = 0; i < numEntries; i++)
+      writeRecord(out, {JOURNAL_APPEND, i, entryAt(i)});
+    writeRecord(out, {JOURNAL_INDEX, currentIndex, MapPosHistoryEntry()});
     historyFile.close();
+
+    journalFileRecords = numEntries + 1;
+    return true;
   }
   else
     qWarning() << "Cannot write history" << historyFile.fileName() << ":" << historyFile.errorString();
+  return false;
 }
 
-void MapPosHistory::restoreState(const QString& filename)
+void MapPosHistory::saveState(const QString& filename)
+{
+  if(filename == journalFilename && journalFileRecords + journal.size() <= MAX_JOURNAL_RECORDS &&
+     QFile::exists(filename))
+  {
+    if(journal.isEmpty())
+      return;
+
+    // Append changes only
+    QFile historyFile(filename);
+    if(historyFile.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+      QDataStream out(&historyFile);
+      out.setVersion(QDataStream::Qt_5_5);
+
+      for(const JournalRecord& record : journal)
+        writeRecord(out, record);
+      historyFile.close();
+
+      journalFileRecords += journal.size();
+      journal.clear();
+      return;
+    }
+    else
+      qWarning() << "Cannot append history" << historyFile.fileName() << ":" << historyFile.errorString();
+  }
+
+  // Compact by writing a new file
+  journal.clear();
+  if(writeFull(filename))
+    journalFilename = filename;
+  else
+    journalFilename.clear();
+}
+
+void MapPosHistory::clearHistory()
 {
-  entries.clear();
+  ringStart = 0;
+  numEntries = 0;
   currentIndex = -1;
+  journal.clear();
+  journalFilename.clear();
+  journalFileRecords = 0;
+}
+
+void MapPosHistory::restoreState(const QString& filename)
+{
+  clearHistory();
 
   QFile historyFile(filename);
 
@@ -203,7 +330,42 @@ void MapPosHistory::restoreState(const QString& filename)
       {
         in >> version;
         if(version == FILE_VERSION)
-          in >> currentIndex >> entries;
+        {
+          // Replay journal
+          JournalRecord record;
+          int numRecords = 0;
+          bool ok = true;
+          while(!in.atEnd() && (ok = readRecord(in, record)))
+          {
+            apply(record);
+            numRecords++;
+          }
+
+          if(ok)
+          {
+            // Following saves can append
+            journalFilename = filename;
+            journalFileRecords = numRecords;
+          }
+          else
+            // Broken or partially written record - file is rewritten on next save
+            qWarning() << "Cannot read history" << historyFile.fileName() << ". Truncated after" << numRecords
+                       << "records";
+        }
+        else if(version == FILE_VERSION_LIST)
+        {
+          // Old format with full list - converted on next save
+          qint32 index;
+          QList<MapPosHistoryEntry> entries;
+          in >> index >> entries;
+
+          for(const MapPosHistoryEntry& entry : entries)
+            appendInternal(entry);
+
+          if(index >= 0 && index < numEntries)
+            // Index is shifted if entries were dropped
+            currentIndex = std::max(0, index - (entries.size() - numEntries));
+        }
         else
           qWarning() << "Cannot read history" << historyFile.fileName() << ". Invalid version number:" <<
           version;
@@ -217,10 +379,10 @@ void MapPosHistory::restoreState(const QString& filename)
       qWarning() << "Cannot read history" << historyFile.fileName() << ":" << historyFile.errorString();
   }
 
-  if(entries.isEmpty())
+  if(numEntries == 0)
     emit historyChanged(0, 0, 0);
   else
-    emit historyChanged(0, currentIndex, entries.size() - 1);
+    emit historyChanged(0, currentIndex, numEntries - 1);
 }
 
 void MapPosHistory::activate()
@@ -22,6 +22,7 @@
 
 #include <QObject>
 #include <QApplication>
+#include <QVector>
 
 namespace atools {
 namespace gui {
@@ -85,6 +86,10 @@ const MapPosHistoryEntry EMPTY_MAP_POS;
 /*
  * Maintains a history list of position/zoom distance combinations.
  *
+ * Entries are kept in a ring buffer of fixed capacity. The history file is a journal of changes
+ * where saveState() appends only the changes since the last save or restore. The file is rewritten with
+ * the current history only if the journal gets too long or the file was not written by this instance.
+ *
  * To use this class register the stream operators:
  *  qRegisterMetaTypeStreamOperators<atools::geo::Pos>();
  *  qRegisterMetaTypeStreamOperators<atools::gui::MapPosHistoryEntry>();
@@ -113,10 +118,10 @@ public:
    * Will also emit signal historyChanged  */
   void addEntry(atools::geo::Pos pos, double distance);
 
-  /* Save history to file */
+  /* Save history to file. Appends only changes if the file was read or written before. */
   void saveState(const QString& filename);
 
-  /* load history from file */
+  /* load history from file. Reads journal and files of the old format version 1. */
   void restoreState(const QString& filename);
 
   void activate();
@@ -130,14 +135,64 @@ signals:
   void historyChanged(int minIndex, int curIndex, int maxIndex);
 
 private:
+  /* Journal record types */
+  enum JournalType : quint8
+  {
+    /* Prune forward history and append entry */
+    JOURNAL_APPEND = 1,
+
+    /* Overwrite current entry */
+    JOURNAL_REPLACE = 2,
+
+    /* Change current index after back or next */
+    JOURNAL_INDEX = 3
+  };
+
+  struct JournalRecord
+  {
+    JournalType type;
+    qint32 index;
+    MapPosHistoryEntry entry;
+  };
+
+  /* Entry at index where 0 is the oldest */
+  const MapPosHistoryEntry& entryAt(int index) const;
+  MapPosHistoryEntry& entryAt(int index);
+
+  /* Change history without journal */
+  void appendInternal(const MapPosHistoryEntry& entry);
+  void apply(const JournalRecord& record);
+
+  /* Write compact record */
+  static void writeRecord(QDataStream& out, const JournalRecord& record);
+  static bool readRecord(QDataStream& in, JournalRecord& record);
+
+  /* Write header and the current history as journal */
+  bool writeFull(const QString& filename);
+  void clearHistory();
+
   // Aggregate all entry that are close than this value
   const int MAX_MS_FOR_NEW_ENTRY = 200;
   const int MAX_NUMBER_OF_ENTRIES = 50;
 
+  /* Rewrite file if the journal has more records */
+  const int MAX_JOURNAL_RECORDS = MAX_NUMBER_OF_ENTRIES * 20;
+
   const quint32 FILE_MAGIC_NUMBER = 0x4C8D1F09;
-  const quint16 FILE_VERSION = 1;
+  const quint16 FILE_VERSION_LIST = 1;
+  const quint16 FILE_VERSION = 2;
+
+  /* Ring buffer where ringStart is the oldest entry */
+  QVector<MapPosHistoryEntry> ring;
+  int ringStart = 0, numEntries = 0;
+
+  /* Changes not saved yet */
+  QVector<JournalRecord> journal;
+
+  /* File the journal can be appended to and number of records in this file */
+  QString journalFilename;
+  int journalFileRecords = 0;
 
-  QList<MapPosHistoryEntry> entries;
   qint32 currentIndex = -1;
   bool active = false;
 };
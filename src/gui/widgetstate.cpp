@@ -22,6 +22,7 @@
 #include <QDebug>
 #include <QCheckBox>
 #include <QComboBox>
+#include <QEvent>
 #include <QFileDialog>
 #include <QHeaderView>
 #include <QLabel>
@@ -46,6 +47,38 @@ namespace gui {
 
 using atools::settings::Settings;
 
+/* Dynamic property for widgets waiting for lazy restore */
+static const char *LAZY_RESTORE_PROPERTY = "atools_widgetstate_lazy";
+
+/* Restores the widget on the first show event and deletes itself */
+class WidgetStateLazyRestore :
+  public QObject
+{
+public:
+  WidgetStateLazyRestore(QWidget *widget, const WidgetState& widgetState)
+    : QObject(widget), state(widgetState)
+  {
+    state.setLazyRestore(false);
+    widget->setProperty(LAZY_RESTORE_PROPERTY, true);
+    widget->installEventFilter(this);
+  }
+
+  virtual bool eventFilter(QObject *object, QEvent *event) override
+  {
+    if(event->type() == QEvent::Show)
+    {
+      object->removeEventFilter(this);
+      object->setProperty(LAZY_RESTORE_PROPERTY, QVariant());
+      state.restore(object);
+      deleteLater();
+    }
+    return false;
+  }
+
+private:
+  WidgetState state;
+};
+
 WidgetState::WidgetState(const QString& settingsKeyPrefix, bool saveVisibility, bool blockSignals)
   : keyPrefix(settingsKeyPrefix), visibility(saveVisibility), block(blockSignals)
 {
@@ -56,6 +89,10 @@ void WidgetState::save(const QObject *widget) const
 {
   if(widget != nullptr)
   {
+    if(widget->property(LAZY_RESTORE_PROPERTY).toBool())
+      // Not restored yet - keep saved state
+      return;
+
     Settings& s = Settings::instance();
 
     if(const QLayout * layout = dynamic_cast<const QLayout *>(widget))
@@ -150,10 +187,30 @@ void WidgetState::save(const QObject *widget) const
     qWarning() << "Found null widget in save";
 }
 
+bool WidgetState::restoreLazy(QObject *widget) const
+{
+  if(lazy)
+  {
+    QWidget *w = dynamic_cast<QWidget *>(widget);
+    if(w != nullptr && !w->isVisible() && !w->property(LAZY_RESTORE_PROPERTY).toBool() &&
+       (dynamic_cast<QHeaderView *>(w) != nullptr || dynamic_cast<QAbstractItemView *>(w) != nullptr ||
+        dynamic_cast<QSplitter *>(w) != nullptr))
+    {
+      // Filter is deleted with the widget or after restore
+      new WidgetStateLazyRestore(w, *this);
+      return true;
+    }
+  }
+  return false;
+}
+
 void WidgetState::restore(QObject *widget) const
 {
   if(widget != nullptr)
   {
+    if(restoreLazy(widget))
+      return;
+
     if(block)
       widget->blockSignals(true);
 
@@ -346,8 +403,23 @@ void WidgetState::save(const QList<QObject *>& widgets) const
 
 void WidgetState::restore(const QList<QObject *>& widgets) const
 {
+  // Avoid repeated layout and repaint of windows while restoring
+  QList<QWidget *> windows;
+  for(QObject *obj : widgets)
+  {
+    QWidget *w = dynamic_cast<QWidget *>(obj);
+    if(w != nullptr && w->window()->updatesEnabled() && !windows.contains(w->window()))
+    {
+      windows.append(w->window());
+      w->window()->setUpdatesEnabled(false);
+    }
+  }
+
   for(QObject *w : widgets)
     restore(w);
+
+  for(QWidget *window : windows)
+    window->setUpdatesEnabled(true);
 }
 
 void WidgetState::saveWidgetVisible(Settings& settings, const QWidget *w) const
@@ -52,6 +52,7 @@ namespace gui {
  * QAbstractButton
  * QFrame
  *
+ * Values are read from the memory cache of Settings and unchanged values are not written again.
  */
 class WidgetState
 {
@@ -66,6 +67,8 @@ public:
               bool saveVisibility = true, bool blockSignals = false);
 
   void save(const QList<QObject *>& widgets) const;
+
+  /* Restores all widgets in one pass with screen updates of the affected windows disabled */
   void restore(const QList<QObject *>& widgets) const;
 
   void save(const QObject *widget) const;
@@ -94,6 +97,21 @@ public:
     block = value;
   }
 
+  /*
+   * Delay restoring the state of hidden header views, table and tree views and splitters until they are shown
+   * the first time. State of these widgets is not saved before it was restored.
+   * Do not use if the application reads the state of these widgets before showing them.
+   */
+  bool getLazyRestore() const
+  {
+    return lazy;
+  }
+
+  void setLazyRestore(bool value)
+  {
+    lazy = value;
+  }
+
   /*
    * @param position if true save position of QMainWindow widgets
    * @param size if true save size of QMainWindow widgets
@@ -119,7 +137,10 @@ private:
   void loadWidgetVisible(atools::settings::Settings& settings, QWidget *w) const;
 
   QString keyPrefix;
-  bool visibility = true, block = false;
+  /* Installs an event filter to restore the widget on first show if lazy restore applies */
+  bool restoreLazy(QObject *widget) const;
+
+  bool visibility = true, block = false, lazy = false;
   bool positionRestoreMainWindow = true, sizeRestoreMainWindow = true, stateRestoreMainWindow = true;
 };
 
@@ -19,6 +19,8 @@
 
 #include <QFile>
 #include <QDebug>
+#include <QtEndian>
+#include <QVarLengthArray>
 
 namespace atools {
 namespace io {
@@ -27,21 +29,64 @@ namespace io {
  * Big endian 1A2B3C4D = 1A 2B 3C 4D in mem
  * Little endian 1A2B3C4D =  4D 3C 2B 1A in mem
  */
-BinaryStream::BinaryStream(QFile *binaryFile, QDataStream::ByteOrder order)
+BinaryStream::BinaryStream(QFile *binaryFile, QDataStream::ByteOrder order, bool useMemoryMap)
   : file(binaryFile)
 {
-  this->is = new QDataStream(file);
-  this->is->setByteOrder(order);
+  bigEndian = order == QDataStream::BigEndian;
+
+  if(useMemoryMap && file->isOpen() && !file->isSequential() && file->size() > 0)
+  {
+    // Map the whole file - is null if it fails
+    mapped = file->map(0, file->size());
+    if(mapped != nullptr)
+    {
+      mappedSize = file->size();
+      mappedPos = file->pos();
+    }
+  }
+
+  if(mapped == nullptr)
+  {
+    this->is = new QDataStream(file);
+    this->is->setByteOrder(order);
+  }
   checkStream("constructor");
 }
 
 BinaryStream::~BinaryStream()
 {
+  if(mapped != nullptr && file->isOpen())
+    file->unmap(const_cast<uchar *>(mapped));
   delete is;
 }
 
+template<typename TYPE>
+TYPE BinaryStream::readMapped(const char *what)
+{
+  checkMapped(sizeof(TYPE), what);
+
+  const uchar *src = mapped + mappedPos;
+  mappedPos += sizeof(TYPE);
+  return bigEndian ? qFromBigEndian<TYPE>(src) : qFromLittleEndian<TYPE>(src);
+}
+
+void BinaryStream::checkMapped(qint64 size, const char *what) const
+{
+  if(mappedPos < 0 || mappedPos + size > mappedSize)
+  {
+    QString msg = QString("%1 for file \"%2\" failed. Reason %3").
+                  arg(what).arg(getFilename()).arg(QDataStream::ReadPastEnd);
+
+    qWarning() << msg << "Position" << hex << "0x" << mappedPos << dec << mappedPos;
+    throw Exception(msg);
+  }
+}
+
 quint32 BinaryStream::readUInt()
 {
+  if(mapped != nullptr)
+    return readMapped<quint32>("readInt");
+
   quint32 retval;
   (*is) >> retval;
 
@@ -52,25 +97,64 @@ quint32 BinaryStream::readUInt()
 
 int BinaryStream::readBytes(char bytes[], int size)
 {
+  if(mapped != nullptr)
+  {
+    checkMapped(size, "readBytes");
+    memcpy(bytes, mapped + mappedPos, static_cast<size_t>(size));
+    mappedPos += size;
+    return size;
+  }
+
   int numRead = is->readRawData(bytes, size);
   checkStream("readBytes");
   return numRead;
 }
 
+const uchar *BinaryStream::readBlock(uchar *buffer, int size)
+{
+  if(mapped != nullptr)
+  {
+    checkMapped(size, "readBlock");
+    const uchar *block = mapped + mappedPos;
+    mappedPos += size;
+    return block;
+  }
+
+  is->readRawData(reinterpret_cast<char *>(buffer), size);
+  checkStream("readBlock");
+  return buffer;
+}
+
 qint64 BinaryStream::tellg() const
 {
+  if(mapped != nullptr)
+    return mappedPos;
+
   checkStream("tellg");
   return is->device()->pos();
 }
 
 void BinaryStream::skip(qint64 bytes)
 {
+  if(mapped != nullptr)
+  {
+    // Positions outside of the file are allowed here like for QFile but will fail on next read
+    mappedPos += bytes;
+    return;
+  }
+
   checkStream("skip");
   is->device()->seek(tellg() + bytes);
 }
 
 void BinaryStream::seekg(qint64 pos)
 {
+  if(mapped != nullptr)
+  {
+    mappedPos = pos;
+    return;
+  }
+
   checkStream("seekg");
   is->device()->seek(pos);
 }
@@ -102,6 +186,9 @@ float BinaryStream::readFloat()
 
 quint16 BinaryStream::readUShort()
 {
+  if(mapped != nullptr)
+    return readMapped<quint16>("readShort");
+
   quint16 retval;
   (*is) >> retval;
 
@@ -112,6 +199,12 @@ quint16 BinaryStream::readUShort()
 
 quint8 BinaryStream::readUByte()
 {
+  if(mapped != nullptr)
+  {
+    checkMapped(1, "readByte");
+    return mapped[mappedPos++];
+  }
+
   quint8 retval;
   (*is) >> retval;
 
@@ -122,6 +215,9 @@ quint8 BinaryStream::readUByte()
 
 qint32 BinaryStream::readInt()
 {
+  if(mapped != nullptr)
+    return readMapped<qint32>("readInt");
+
   qint32 retval;
   (*is) >> retval;
 
@@ -132,6 +228,9 @@ qint32 BinaryStream::readInt()
 
 qint16 BinaryStream::readShort()
 {
+  if(mapped != nullptr)
+    return readMapped<qint16>("readShort");
+
   qint16 retval;
   (*is) >> retval;
 
@@ -142,6 +241,12 @@ qint16 BinaryStream::readShort()
 
 qint8 BinaryStream::readByte()
 {
+  if(mapped != nullptr)
+  {
+    checkMapped(1, "readByte");
+    return static_cast<qint8>(mapped[mappedPos++]);
+  }
+
   qint8 retval;
   (*is) >> retval;
 
@@ -157,39 +262,62 @@ QChar BinaryStream::readChar()
 
 QString BinaryStream::readString()
 {
-  QString retval;
+  if(mapped != nullptr)
+  {
+    // Find terminating null or control character in the mapped buffer and convert in one step
+    const char *buf = reinterpret_cast<const char *>(mapped + mappedPos);
+    qint64 len = 0, maxLen = mappedSize - mappedPos;
+    while(len < maxLen && !iscntrl(buf[len]))
+      len++;
+
+    mappedPos += len;
+    // Skip terminator - throws if at end of file
+    readByte();
+    return QString::fromLatin1(buf, static_cast<int>(len));
+  }
+
+  // Collect characters on the stack and convert only once
+  QVarLengthArray<char, 256> buf;
   char c = 0;
   while((c = readByte()) != 0)
   {
     if(iscntrl(c))
       break;
-    retval.append(QChar::fromLatin1(c));
+    buf.append(c);
   }
 
   checkStream("readString");
 
-  return retval;
+  return QString::fromLatin1(buf.constData(), buf.size());
 }
 
 QString BinaryStream::readString(int length)
 {
-  char *buf = new char[length];
-  readBytes(buf, length);
-
-  QString retval;
-  for(int i = 0; i < length; i++)
+  if(mapped != nullptr)
   {
-    if(iscntrl(buf[i]))
-      break;
-    retval.append(QChar::fromLatin1(buf[i]));
+    // Read directly from the mapped buffer without copying
+    checkMapped(length, "readString");
+    const char *buf = reinterpret_cast<const char *>(mapped + mappedPos);
+    mappedPos += length;
+
+    int len = 0;
+    while(len < length && !iscntrl(buf[len]))
+      len++;
+    return QString::fromLatin1(buf, len);
   }
-  delete[] buf;
-  return retval;
+
+  QVarLengthArray<char, 256> buf(length);
+  readBytes(buf.data(), length);
+
+  int len = 0;
+  while(len < length && !iscntrl(buf.at(len)))
+    len++;
+  return QString::fromLatin1(buf.constData(), len);
 }
 
 void BinaryStream::checkStream(const QString& what) const
 {
-  if(is->status() != QDataStream::Ok)
+  if(is != nullptr && is->status() != QDataStream::Ok)
   {
     QString msg = QString("%1 for file \"%2\" failed. Reason %3").arg(what).arg(getFilename()).arg(is->status());
 
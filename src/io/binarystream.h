@@ -31,11 +31,20 @@ namespace io {
  * Simple wrapper for binary file reading around QDataStream
  * that will throw an Exception in case of
  * errors.
+ *
+ * The file is memory mapped if possible and all values are read directly from the mapped buffer.
+ * Reading falls back to QDataStream if mapping is not possible (e.g. resource files or sequential devices).
  */
 class BinaryStream
 {
 public:
-  BinaryStream(QFile *binaryFile, QDataStream::ByteOrder order = QDataStream::LittleEndian);
+  /*
+   * @param binaryFile An open file. Has to stay open while reading.
+   * @param order Byte order for all numeric values
+   * @param useMemoryMap Map the whole file into memory if possible
+   */
+  BinaryStream(QFile *binaryFile, QDataStream::ByteOrder order = QDataStream::LittleEndian,
+               bool useMemoryMap = true);
   virtual ~BinaryStream();
 
   qint8 readByte();
@@ -61,6 +70,11 @@ public:
 
   int readBytes(char bytes[], int size);
 
+  /* Returns a pointer to the next size bytes and advances the position. Points into the mapped file without
+   * copying or to buffer which is filled if the file is not mapped. The pointer is valid as long as the file
+   * is open or buffer exists. */
+  const uchar *readBlock(uchar *buffer, int size);
+
   qint64 tellg() const;
   void skip(qint64 bytes);
   void seekg(qint64 pos);
@@ -68,11 +82,29 @@ public:
   qint64 getFileSize() const;
   QString getFilename() const;
 
+  /* true if the file could be memory mapped */
+  bool isMapped() const
+  {
+    return mapped != nullptr;
+  }
+
 private:
   void checkStream(const QString& what) const;
 
-  QDataStream *is;
+  /* Read a numeric value from the mapped buffer */
+  template<typename TYPE>
+  TYPE readMapped(const char *what);
+
+  /* Throws exception if less than size bytes are left at the current position in the mapped buffer */
+  void checkMapped(qint64 size, const char *what) const;
+
+  QDataStream *is = nullptr;
   QFile *file;
+
+  /* Fields for memory mapped mode */
+  const uchar *mapped = nullptr;
+  qint64 mappedSize = 0, mappedPos = 0;
+  bool bigEndian = false;
 };
 
 } /* namespace io */
@@ -17,12 +17,55 @@
 
 #include "io/fileroller.h"
 
+#include "zip/gzip.h"
+
+#include <QDateTime>
+#include <QDebug>
 #include <QFile>
+#include <QRunnable>
 #include <QStringList>
+#include <QThreadPool>
+
+#include <atomic>
 
 namespace atools {
 namespace io {
 
+/* Suffixes of uncompressed and compressed backups */
+static const QStringList BACKUP_SUFFIXES({QString(), ".gz"});
+
+/* One thread for all background work to keep the order of rolls */
+static QThreadPool *backgroundPool()
+{
+  static QThreadPool *pool = [] {
+    QThreadPool *p = new QThreadPool;
+    p->setMaxThreadCount(1);
+    return p;
+  }();
+  return pool;
+}
+
+/* Does the work of rollFileInBackground() */
+class FileRollerTask :
+  public QRunnable
+{
+public:
+  FileRollerTask(const FileRoller& fileRoller, const QString& filename, const QString& source)
+    : roller(fileRoller), file(filename), sourceFile(source)
+  {
+    setAutoDelete(true);
+  }
+
+  virtual void run() override
+  {
+    roller.rollInto(file, sourceFile);
+  }
+
+private:
+  FileRoller roller;
+  QString file, sourceFile;
+};
+
 FileRoller::FileRoller(int maxNumFiles)
   : maxFiles(maxNumFiles)
 {
@@ -37,24 +80,103 @@ void FileRoller::rollFiles(const QStringList& filenames)
 
 void FileRoller::rollFile(const QString& filename)
 {
+  rollInto(filename, filename);
+}
+
+void FileRoller::rollFileInBackground(const QString& filename)
+{
+  if(maxFiles > 0 && QFile::exists(filename))
+  {
+    static std::atomic<int> counter(0);
+
+    // Unique name to allow further rolls before the background work is done
+    QString source = QString("%1.roll%2-%3").arg(filename).arg(QDateTime::currentMSecsSinceEpoch()).arg(counter++);
+    if(QFile(filename).rename(source))
+      backgroundPool()->start(new FileRollerTask(*this, filename, source));
+    else
+      // Fall back to synchronous rolling
+      rollFile(filename);
+  }
+}
+
+void FileRoller::waitForBackground()
+{
+  backgroundPool()->waitForDone();
+}
+
+void FileRoller::rollInto(const QString& filename, const QString& source)
+{
+  if(maxFiles <= 0)
+    return;
+
   for(int i = maxFiles; i >= 1; --i)
   {
-    QFile oldFile(filename + "." + QString::number(i));
-    QFile newFile(filename + "." + QString::number(i + 1));
+    for(const QString& suffix : BACKUP_SUFFIXES)
+    {
+      QFile oldFile(filename + "." + QString::number(i) + suffix);
+      QFile newFile(filename + "." + QString::number(i + 1) + suffix);
 
-    if(oldFile.exists())
+      if(oldFile.exists())
+      {
+        if(i == maxFiles)
+          // Remove oldest
+          oldFile.remove();
+        else
+          // Move all other to higher number
+          renameSafe(oldFile.fileName(), newFile.fileName());
+      }
+    }
+  }
+
+  if(!compress || !compressFile(source, filename + ".1.gz"))
+    renameSafe(source, filename + ".1");
+
+  if(maxTotalSizeBytes > 0)
+    removeOversize(filename);
+}
+
+void FileRoller::removeOversize(const QString& filename)
+{
+  // Sum up from newest to oldest and remove all backups exceeding the limit
+  qint64 totalSize = 0;
+  for(int i = 1; i <= maxFiles; i++)
+  {
+    for(const QString& suffix : BACKUP_SUFFIXES)
     {
-      if(i == maxFiles)
-        // Remove oldest
-        oldFile.remove();
-      else
-        // Move all other to higher number
-        renameSafe(oldFile.fileName(), newFile.fileName());
+      QFile file(filename + "." + QString::number(i) + suffix);
+      if(file.exists())
+      {
+        totalSize += file.size();
+        if(totalSize > maxTotalSizeBytes)
+          file.remove();
+      }
     }
   }
+}
+
+bool FileRoller::compressFile(const QString& source, const QString& target)
+{
+  QFile sourceFile(source);
+  if(sourceFile.open(QIODevice::ReadOnly))
+  {
+    QByteArray compressed;
+    bool ok = atools::zip::gzipCompress(sourceFile.readAll(), compressed);
+    sourceFile.close();
 
-  if(maxFiles > 0)
-    renameSafe(filename, filename + ".1");
+    if(ok)
+    {
+      QFile targetFile(target);
+      if(targetFile.open(QIODevice::WriteOnly) && targetFile.write(compressed) == compressed.size())
+      {
+        targetFile.close();
+        sourceFile.remove();
+        return true;
+      }
+      targetFile.remove();
+    }
+  }
+  qWarning() << Q_FUNC_INFO << "Cannot compress" << source;
+  return false;
 }
 
 void FileRoller::renameSafe(const QString& oldFile, const QString& newFile)
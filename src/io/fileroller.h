@@ -24,7 +24,7 @@ namespace atools {
 namespace io {
 
 /*
- * Creates numbered backups from e.g. log files.
+ * Creates numbered backups from e.g. log files. Backups can be compressed with gzip and limited by total size.
  */
 class FileRoller
 {
@@ -34,6 +34,18 @@ public:
    */
   FileRoller(int maxNumFiles);
 
+  /* Compress backups using gzip which appends ".gz" to the backup names */
+  void setCompress(bool value)
+  {
+    compress = value;
+  }
+
+  /* Delete oldest backups if the total size of all backups exceeds this value. 0 disables the limit. */
+  void setMaxTotalSizeBytes(qint64 value)
+  {
+    maxTotalSizeBytes = value;
+  }
+
   /*
    * Create numbered backups of a file. Maximum number of files results in:
    * file.log, file.log.1, ... , file.log.maxFiles
@@ -48,10 +60,34 @@ public:
    */
   void rollFiles(const QStringList& filenames);
 
+  /*
+   * Only renames the file to a temporary name and returns. Renaming of backups, compression and
+   * deletion are done in a background thread. The file can be created again immediately after this call.
+   * Background work is done in order of calls.
+   */
+  void rollFileInBackground(const QString& filename);
+
+  /* Wait until all background work is done */
+  static void waitForBackground();
+
 private:
-  int maxFiles = 0;
+  friend class FileRollerTask;
+
+  /* Move backups up, move or compress source into the first backup and apply the size limit */
+  void rollInto(const QString& filename, const QString& source);
+
+  /* Apply total size limit to all backups */
+  void removeOversize(const QString& filename);
+
+  /* Compress source into target and delete source. Returns false on error. */
+  bool compressFile(const QString& source, const QString& target);
+
   void renameSafe(const QString& oldFile, const QString& newFile);
 
+  int maxFiles = 0;
+  bool compress = false;
+  qint64 maxTotalSizeBytes = 0;
+
 };
 
 } /* namespace io */
@@ -18,14 +18,68 @@
 #include "io/inireader.h"
 #include "exception.h"
 
+#include <QDateTime>
 #include <QDebug>
-#include <QTextStream>
-#include <QIODevice>
 #include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QTextCodec>
 
 namespace atools {
 namespace io {
 
+/* Limit number of cached files */
+static const int MAX_CACHE_ENTRIES = 100;
+
+/* Global cache of parse results keyed by filename and codec */
+class IniCache
+{
+public:
+  struct Entry
+  {
+    QDateTime lastModified;
+    qint64 size;
+    QVector<IniReader::IniEntry> entries;
+  };
+
+  static IniCache& instance()
+  {
+    static IniCache cache;
+    return cache;
+  }
+
+  bool get(const QString& key, const QFileInfo& fileinfo, QVector<IniReader::IniEntry>& entries)
+  {
+    QMutexLocker locker(&mutex);
+    auto it = cache.constFind(key);
+    if(it != cache.constEnd() && it->lastModified == fileinfo.lastModified() && it->size == fileinfo.size())
+    {
+      entries = it->entries;
+      return true;
+    }
+    return false;
+  }
+
+  void insert(const QString& key, const QFileInfo& fileinfo, const QVector<IniReader::IniEntry>& entries)
+  {
+    QMutexLocker locker(&mutex);
+    if(cache.size() >= MAX_CACHE_ENTRIES)
+      cache.clear();
+    cache.insert(key, {fileinfo.lastModified(), fileinfo.size(), entries});
+  }
+
+  void clear()
+  {
+    QMutexLocker locker(&mutex);
+    cache.clear();
+  }
+
+private:
+  QMutex mutex;
+  QHash<QString, Entry> cache;
+};
+
 IniReader::IniReader(const QString& textCodec)
   : currentLineNum(0), codec(textCodec)
 {
@@ -35,65 +89,131 @@ IniReader::~IniReader()
 {
 }
 
-void IniReader::handleComment()
+void IniReader::clearCache()
 {
-  int c = currentLine.indexOf(';');
-  if(c >= 0)
-    currentLine.truncate(c);
+  IniCache::instance().clear();
 }
 
-void IniReader::handleKeyValue()
+void IniReader::parseSection(const QString& line, IniEntry& entry)
 {
-  QString name, value;
+  QString tempSection, tempSectionSuffix;
+
+  if(line.at(line.size() - 1) == ']')
+    tempSection = line.mid(1, line.size() - 2);
+  else
+  {
+    tempSection = line.mid(1, line.size() - 1);
+    qWarning() << "Missing closing \"]\":" << line;
+  }
+
+  int dotPos = tempSection.indexOf('.');
+  if(dotPos >= 0)
+  {
+    QString sectPrefix = tempSection.left(dotPos);
+    if(sectPrefix.isEmpty())
+      qWarning() << "Missing section name before \".\":" << line;
+
+    tempSectionSuffix = tempSection.mid(dotPos + 1);
+    if(tempSectionSuffix.isEmpty())
+      qWarning() << "Missing section suffix after \".\":" << line;
+
+    tempSection = sectPrefix;
+  }
+
+  entry.section = true;
+  entry.name = tempSection.toLower();
+  entry.suffix = tempSectionSuffix.toLower();
+}
 
-  int c = currentLine.indexOf('=');
+bool IniReader::parseKeyValue(const QString& line, IniEntry& entry)
+{
+  int c = line.indexOf('=');
   if(c >= 0)
   {
-    name = currentLine.left(c).toLower();
-    if(name.isEmpty())
-      qWarning() << "Missing key name before \"=\":" << currentLine;
+    if(c == 0)
+      qWarning() << "Missing key name before \"=\":" << line;
     else
     {
-      value = currentLine.mid(c + 1);
-      onKeyValue(currentSection, currentSectionSuffix, name, value);
+      entry.section = false;
+      entry.name = line.left(c).toLower();
+      entry.value = line.mid(c + 1);
+      return true;
     }
   }
   else
-    qWarning() << "Missing \"=\":" << currentLine;
+    qWarning() << "Missing \"=\":" << line;
+  return false;
 }
 
-void IniReader::handleSection()
+void IniReader::parse(const QString& text, QVector<IniEntry>& entries)
 {
-  QString tempSection, tempSectionSuffix;
+  const QChar *data = text.constData();
+  int size = text.size(), lineNum = 0, pos = 0;
 
-  if(currentLine.at(currentLine.size() - 1) == ']')
-    tempSection = currentLine.mid(1, currentLine.size() - 2);
-  else
+  while(pos < size)
   {
-    tempSection = currentLine.mid(1, currentLine.size() - 1);
-    qWarning() << "Missing closing \"]\":" << currentLine;
-  }
+    // Find end of line - \n, \r\n or \r
+    int start = pos, end = pos;
+    while(end < size && data[end] != '\n' && data[end] != '\r')
+      end++;
+
+    pos = end + 1;
+    if(end < size && data[end] == '\r' && pos < size && data[pos] == '\n')
+      pos++;
+    lineNum++;
+
+    // Trim leading and trailing whitespace
+    while(start < end && data[start].isSpace())
+      start++;
+    while(end > start && data[end - 1].isSpace())
+      end--;
+
+    // Remove comment after trimming
+    for(int i = start; i < end; i++)
+    {
+      if(data[i] == ';')
+      {
+        end = i;
+        break;
+      }
+    }
 
-  int dotPos = tempSection.indexOf('.');
-  if(dotPos >= 0)
-  {
-    QString sectPrefix = tempSection.mid(0, dotPos).toLower();
-    if(sectPrefix.isEmpty())
-      qWarning() << "Missing section name before \".\":" << currentLine;
+    if(start == end)
+      continue;
 
-    tempSectionSuffix = tempSection.mid(dotPos + 1).toLower();
-    if(tempSectionSuffix.isEmpty())
-      qWarning() << "Missing section suffix after \".\":" << currentLine;
+    IniEntry entry;
+    entry.lineNum = lineNum;
+    entry.line = QString(data + start, end - start);
 
-    tempSection = sectPrefix;
+    if(data[start] == '[')
+    {
+      parseSection(entry.line, entry);
+      entries.append(entry);
+    }
+    else if(parseKeyValue(entry.line, entry))
+      entries.append(entry);
   }
+}
 
-  if(!currentSection.isEmpty())
-    onEndSection(currentSection, currentSectionSuffix);
+void IniReader::readEntries(QVector<IniEntry>& entries)
+{
+  QFile iniFile(filename);
 
-  currentSection = tempSection.toLower();
-  currentSectionSuffix = tempSectionSuffix.toLower();
-  onStartSection(currentSection, currentSectionSuffix);
+  if(iniFile.open(QIODevice::ReadOnly))
+  {
+    QByteArray bytes = iniFile.readAll();
+    iniFile.close();
+
+    // Detect BOM like QTextStream does and fall back to given codec or locale
+    QTextCodec *textCodec = codec.isEmpty() ? nullptr : QTextCodec::codecForName(codec.toLatin1());
+    if(textCodec == nullptr)
+      textCodec = QTextCodec::codecForLocale();
+    textCodec = QTextCodec::codecForUtfText(bytes, textCodec);
+
+    parse(textCodec->toUnicode(bytes), entries);
+  }
+  else
+    throw Exception(tr("Cannot open file %1. Reason: %2").arg(filename).arg(iniFile.errorString()));
 }
 
 void IniReader::read(const QString& iniFilename)
@@ -105,42 +225,44 @@ void IniReader::read(const QString& iniFilename)
 
   this->filename = iniFilename;
 
-  QFile sceneryCfgFile(filename);
-
-  if(sceneryCfgFile.open(QIODevice::ReadOnly | QIODevice::Text))
+  QVector<IniEntry> entries;
+  if(useCache)
   {
-    QTextStream sceneryCfg(&sceneryCfgFile);
+    QFileInfo fileinfo(filename);
+    QString key = fileinfo.absoluteFilePath() + "|" + codec;
+    if(!IniCache::instance().get(key, fileinfo, entries))
+    {
+      readEntries(entries);
+      IniCache::instance().insert(key, fileinfo, entries);
+    }
+  }
+  else
+    readEntries(entries);
 
-    if(!codec.isEmpty())
-      sceneryCfg.setCodec(codec.toLatin1().constData());
+  onStartDocument(filename);
 
-    onStartDocument(filename);
+  for(const IniEntry& entry : entries)
+  {
+    currentLine = entry.line;
+    currentLineNum = entry.lineNum;
 
-    currentLine.clear();
-    while(sceneryCfg.readLineInto(&currentLine, 1024))
+    if(entry.section)
     {
-      currentLine = currentLine.trimmed();
-      currentLineNum++;
-
-      handleComment();
-
-      if(currentLine.isEmpty())
-        continue;
+      if(!currentSection.isEmpty())
+        onEndSection(currentSection, currentSectionSuffix);
 
-      if(currentLine.at(0) == '[')
-        handleSection();
-      else
-        handleKeyValue();
+      currentSection = entry.name;
+      currentSectionSuffix = entry.suffix;
+      onStartSection(currentSection, currentSectionSuffix);
     }
+    else
+      onKeyValue(currentSection, currentSectionSuffix, entry.name, entry.value);
+  }
 
-    if(!currentSection.isEmpty())
-      onEndSection(currentSection, currentSectionSuffix);
+  if(!currentSection.isEmpty())
+    onEndSection(currentSection, currentSectionSuffix);
 
-    onEndDocument(filename);
-    sceneryCfgFile.close();
-  }
-  else
-    throw Exception(tr("Cannot open file %1. Reason: %2").arg(iniFilename).arg(sceneryCfgFile.errorString()));
+  onEndDocument(filename);
 }
 
 void IniReader::throwException(const QString& message)
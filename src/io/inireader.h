@@ -20,6 +20,7 @@
 
 #include <QString>
 #include <QCoreApplication>
+#include <QVector>
 
 namespace atools {
 namespace io {
@@ -27,6 +28,9 @@ namespace io {
 /*
  * Abstract class that can read ini files and supports numbered sections like [area.001].
  * Line comments starting with "#" and ";" are supported.
+ *
+ * The file is read and decoded at once and parsed in a single pass. Parse results can optionally be kept in
+ * a global cache and are reused as long as file modification time and size do not change.
  */
 class IniReader
 {
@@ -39,6 +43,16 @@ public:
   /* Read the file and trigger the on* methods */
   void read(const QString& iniFilename);
 
+  /* Use parse results of a previous read of the same unchanged file with the same codec.
+   * Allows to avoid parsing twice, e.g. on validation and compilation. Default is false. */
+  void setUseCache(bool value)
+  {
+    useCache = value;
+  }
+
+  /* Remove all cached parse results */
+  static void clearCache();
+
 protected:
   /*
    * Called on reading the document
@@ -92,14 +106,29 @@ protected:
   int toInt(const QString& str);
 
 private:
+  friend class IniCache;
+
+  /* Section start or key/value pair with line information for error messages */
+  struct IniEntry
+  {
+    bool section;
+    int lineNum;
+    QString line, name, suffix, value;
+  };
+
+  /* Parse decoded text into entries */
+  static void parse(const QString& text, QVector<IniEntry>& entries);
+  static void parseSection(const QString& line, IniEntry& entry);
+  static bool parseKeyValue(const QString& line, IniEntry& entry);
+
+  /* Read, decode and parse file. Throws Exception if the file cannot be read. */
+  void readEntries(QVector<IniEntry>& entries);
+
   int currentLineNum;
   QString currentLine, currentSection, currentSectionSuffix;
 
-  void handleComment();
-  void handleKeyValue();
-  void handleSection();
-
   QString codec;
+  bool useCache = false;
 };
 
 } // namespace io
@@ -0,0 +1,216 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "io/textwriter.h"
+
+#include "exception.h"
+
+#include <QIODevice>
+#include <QVariant>
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace atools {
+namespace io {
+
+/* Values above are formatted by QByteArray::number */
+const static double MAX_FIXED_SCALED = 9.0e15;
+const static int MAX_FIXED_PRECISION = 15;
+const static double POW10[MAX_FIXED_PRECISION + 1] =
+{1., 1.e1, 1.e2, 1.e3, 1.e4, 1.e5, 1.e6, 1.e7, 1.e8, 1.e9, 1.e10, 1.e11, 1.e12, 1.e13, 1.e14, 1.e15};
+
+TextWriter::TextWriter(QIODevice *ioDevice, int bufferSize)
+  : device(ioDevice), maxSize(std::max(bufferSize, 1024))
+{
+  // Leave room for a line after the limit
+  buffer.reserve(maxSize + 4096);
+}
+
+TextWriter::~TextWriter()
+{
+  try
+  {
+    flush();
+  }
+  catch(atools::Exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << e.getMessage();
+  }
+}
+
+TextWriter& TextWriter::operator<<(const QString& str)
+{
+  // Copy ASCII directly and convert only strings containing other characters
+  const QChar *data = str.constData();
+  int size = str.size(), i = 0;
+  while(i < size && data[i].unicode() < 0x80)
+    i++;
+
+  if(i == size)
+  {
+    int oldSize = buffer.size();
+    buffer.resize(oldSize + size);
+    char *dest = buffer.data() + oldSize;
+    for(int j = 0; j < size; j++)
+      dest[j] = static_cast<char>(data[j].unicode());
+  }
+  else
+    buffer.append(str.toUtf8());
+
+  flushIfFull();
+  return *this;
+}
+
+TextWriter& TextWriter::operator<<(const char *str)
+{
+  buffer.append(str);
+  flushIfFull();
+  return *this;
+}
+
+TextWriter& TextWriter::operator<<(char c)
+{
+  buffer.append(c);
+  flushIfFull();
+  return *this;
+}
+
+TextWriter& TextWriter::operator<<(QChar c)
+{
+  if(c.unicode() < 0x80)
+    buffer.append(static_cast<char>(c.unicode()));
+  else
+    buffer.append(QString(c).toUtf8());
+
+  flushIfFull();
+  return *this;
+}
+
+void TextWriter::writeFixed(double value, int precision)
+{
+  // Format scaled integer digits from the end into a stack buffer. Independent of the C locale unlike printf.
+  if(precision >= 0 && precision <= MAX_FIXED_PRECISION && std::isfinite(value))
+  {
+    double scaled = std::round(std::abs(value) * POW10[precision]);
+    if(scaled < MAX_FIXED_SCALED)
+    {
+      quint64 num = static_cast<quint64>(scaled);
+      char buf[40];
+      int pos = sizeof(buf);
+      for(int i = 0; i < precision; i++)
+      {
+        buf[--pos] = static_cast<char>('0' + num % 10);
+        num /= 10;
+      }
+
+      if(precision > 0)
+        buf[--pos] = '.';
+
+      do
+      {
+        buf[--pos] = static_cast<char>('0' + num % 10);
+        num /= 10;
+      } while(num > 0);
+
+      if(value < 0.)
+        buf[--pos] = '-';
+
+      buffer.append(buf + pos, static_cast<int>(sizeof(buf)) - pos);
+      flushIfFull();
+      return;
+    }
+  }
+
+  // Huge values, NaN or infinite
+  buffer.append(QByteArray::number(value, 'f', precision));
+  flushIfFull();
+}
+
+void TextWriter::writeInt(qint64 value)
+{
+  char buf[24];
+  int len = std::snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(value));
+  buffer.append(buf, len);
+  flushIfFull();
+}
+
+void TextWriter::writeCsvString(const QString& value, QChar separator, QChar escape)
+{
+  // Same as SqlExport::needsEscape
+  bool needsEscape = false, whitespaceOnly = !value.isEmpty();
+  for(const QChar& c : value)
+  {
+    if(c == separator || c == escape || c == QChar::LineFeed || c == QChar::CarriageReturn)
+    {
+      needsEscape = true;
+      break;
+    }
+    whitespaceOnly &= c.isSpace();
+  }
+
+  if(needsEscape || whitespaceOnly)
+  {
+    QString escaped(value);
+    escaped.replace(escape, QString(escape) + QString(escape));
+    *this << escape << escaped << escape;
+  }
+  else
+    *this << value;
+}
+
+void TextWriter::writeCsvValue(const QVariant& value, QChar separator, QChar escape, int precision)
+{
+  if(value.isNull())
+    return;
+
+  switch(value.type())
+  {
+    case QVariant::Double:
+      writeFixed(value.toDouble(), precision);
+      break;
+
+    case QVariant::Int:
+    case QVariant::LongLong:
+      writeInt(value.toLongLong());
+      break;
+
+    default:
+      writeCsvString(value.toString(), separator, escape);
+      break;
+  }
+}
+
+void TextWriter::flush()
+{
+  if(!buffer.isEmpty())
+  {
+    qint64 written = device->write(buffer);
+    if(written != buffer.size())
+      throw atools::Exception(QString("Error writing file: %1").arg(device->errorString()));
+
+    bytesFlushed += written;
+
+    // Keeps the reserved capacity
+    buffer.resize(0);
+  }
+}
+
+} // namespace io
+} // namespace atools
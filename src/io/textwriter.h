@@ -0,0 +1,90 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_IO_TEXTWRITER_H
+#define ATOOLS_IO_TEXTWRITER_H
+
+#include <QByteArray>
+#include <QChar>
+
+class QIODevice;
+class QString;
+class QVariant;
+
+namespace atools {
+namespace io {
+
+/*
+ * Writes UTF-8 text into a large buffer which is passed to the device when full.
+ * Numbers are formatted directly into the buffer without temporary strings.
+ * Used for exports of large tables where QTextStream and QString::arg would create many temporaries.
+ *
+ * Throws an Exception if writing to the device fails. The destructor flushes without throwing.
+ */
+class TextWriter
+{
+public:
+  /* device has to be open and writeable */
+  explicit TextWriter(QIODevice *ioDevice, int bufferSize = 1024 * 1024);
+  ~TextWriter();
+
+  TextWriter(const TextWriter& other) = delete;
+  TextWriter& operator=(const TextWriter& other) = delete;
+
+  TextWriter& operator<<(const QString& str);
+  TextWriter& operator<<(const char *str);
+  TextWriter& operator<<(char c);
+  TextWriter& operator<<(QChar c);
+
+  /* Same as QString::number(value, 'f', precision) */
+  void writeFixed(double value, int precision);
+
+  void writeInt(qint64 value);
+
+  /* Write value for a CSV file using the same rules as SqlExport.
+   * Surrounds with escape characters if the value contains separator, escape or linefeed or is whitespace only. */
+  void writeCsvString(const QString& value, QChar separator, QChar escape);
+
+  /* Write value like SqlExport::writeValue does using the given precision for floating point numbers */
+  void writeCsvValue(const QVariant& value, QChar separator, QChar escape, int precision);
+
+  /* Pass buffer to device */
+  void flush();
+
+  /* Number of bytes passed to the device and in the buffer */
+  qint64 getBytesWritten() const
+  {
+    return bytesFlushed + buffer.size();
+  }
+
+private:
+  void flushIfFull()
+  {
+    if(buffer.size() >= maxSize)
+      flush();
+  }
+
+  QIODevice *device;
+  QByteArray buffer;
+  int maxSize;
+  qint64 bytesFlushed = 0;
+};
+
+} // namespace io
+} // namespace atools
+
+#endif // ATOOLS_IO_TEXTWRITER_H
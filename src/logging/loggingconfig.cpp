@@ -18,6 +18,7 @@
 #include "logging/loggingconfig.h"
 #include "settings/settings.h"
 #include "io/fileroller.h"
+#include "logging/loggingratelimiter.h"
 
 #include <QDebug>
 #include <QDir>
@@ -87,6 +88,9 @@ LoggingConfig::~LoggingConfig()
   closeStreams(channels, fatalStreamsCat);
   closeStreams(channels, emptyStreamsCat);
 
+  // Finish compression and deletion of log backups
+  io::FileRoller::waitForBackground();
+
   // Delete channels
   qDeleteAll(channels);
 }
@@ -164,6 +168,18 @@ void LoggingConfig::collectFileNames(QSet<QString>& filenames, const ChannelVect
   }
 }
 
+void LoggingConfig::rollFile(const QString& filename, bool background)
+{
+  io::FileRoller roller(maximumBackupFiles);
+  roller.setCompress(compressBackups);
+  roller.setMaxTotalSizeBytes(maximumTotalSizeBytes);
+
+  if(background)
+    roller.rollFileInBackground(filename);
+  else
+    roller.rollFile(filename);
+}
+
 void LoggingConfig::checkStreamSize(Channel *channel)
 {
   // This needs to be called withing mutex lock
@@ -181,8 +197,8 @@ void LoggingConfig::checkStreamSize(Channel *channel)
     delete channel->file;
     channel->file = nullptr;
 
-    // Backup and delete log
-    io::FileRoller(maximumBackupFiles).rollFile(filename);
+    // Backup and delete log - only a rename is done here and the rest in background
+    rollFile(filename, true /* background */);
 
     // Create new log file
     QFile *file = new QFile(filename);
@@ -311,6 +327,21 @@ void LoggingConfig::readConfigurationSection(QSettings *settings)
 
   rolling = settings->value("configuration/files").toString() == "roll";
   maximumBackupFiles = settings->value("configuration/maxfiles").toInt();
+  compressBackups = settings->value("configuration/compress", false).toBool();
+  maximumTotalSizeBytes = settings->value("configuration/maxtotalsize", 0).toLongLong();
+
+  async = settings->value("configuration/async", false).toBool();
+  flushIntervalMs = settings->value("configuration/flushinterval", 1000).toInt();
+  if(flushIntervalMs <= 0)
+  {
+    qWarning() << "Invalid value for configuration/flushinterval:" << flushIntervalMs;
+    flushIntervalMs = 1000;
+  }
+
+  // Limits for ATOOLS_LOG_LIMITED statements
+  atools::logging::LoggingRateLimiter::setDefaults(settings->value("configuration/ratelimitfirst", 100).toInt(),
+                                                   settings->value("configuration/ratelimitevery", 100).toInt(),
+                                                   settings->value("configuration/ratelimitpersecond", 0).toInt());
 
   QString abortOn = settings->value("configuration/abort", QVariant("fatal")).toString();
   if(abortOn == "warning")
@@ -369,7 +400,7 @@ void LoggingConfig::readChannels(QSettings *settings, QHash<QString, Channel *>&
 
       if(rolling && maximumFileSizeBytes <= 0)
         // Create log file backups
-        io::FileRoller(maximumBackupFiles).rollFile(filename);
+        rollFile(filename, false /* background */);
 
       QFile *file = new QFile(filename);
       if(file->open(mode))
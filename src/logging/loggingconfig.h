@@ -33,6 +33,7 @@ namespace atools {
 namespace logging {
 class LoggingHandler;
 namespace internal {
+class LoggingWriterThread;
 
 /* Internal logging class that reads the configuration and sets up all the
  * streams. */
@@ -44,10 +45,23 @@ public:
 
 private:
   friend class atools::logging::LoggingHandler;
+  friend class atools::logging::internal::LoggingWriterThread;
 
   /* get a list of log files (excluding stdout and stderr) */
   QStringList getLogFiles();
 
+  /* Write messages in a background thread */
+  bool isAsync() const
+  {
+    return async;
+  }
+
+  /* Maximum time in milliseconds before queued messages are flushed in async mode */
+  int getFlushIntervalMs() const
+  {
+    return flushIntervalMs;
+  }
+
   /* Get the message level that should cause the application to abort */
   QtMsgType getAbortType() const
   {
@@ -103,13 +117,20 @@ private:
   /* Check if file size exceeds limit. Rolls files, creates a new one and replaces device in text stream */
   void checkStreamSize(Channel *channel);
 
+  /* Create backups of log file. Compression and deletion are done in a thread if background is true. */
+  void rollFile(const QString& filename, bool background);
+
   QIODevice::OpenMode mode = QIODevice::NotOpen;
-  bool rolling = false;
+  bool rolling = false, async = false, compressBackups = false;
+  int flushIntervalMs = 1000;
   int maximumBackupFiles = 0;
 
   /* 0 of -1 if not used */
   qint64 maximumFileSizeBytes = 0;
 
+  /* Limit for all backups of a log file. 0 if not used. */
+  qint64 maximumTotalSizeBytes = 0;
+
   QString logConfig, logDir, logPrefix;
 
   // Messages of this type or worse cause a call to abort()
@@ -17,6 +17,8 @@
 
 #include "logging/logginghandler.h"
 #include "logging/loggingconfig.h"
+#include "logging/loggingwriterthread.h"
+#include "logging/loggingratelimiter.h"
 
 #include <QDebug>
 #include <QDir>
@@ -40,6 +42,12 @@ LoggingHandler::LoggingHandler(const QString& logConfiguration,
 {
   logConfig = new LoggingConfig(logConfiguration, logDirectory, logFilePrefix);
 
+  if(logConfig->isAsync())
+  {
+    writerThread = new internal::LoggingWriterThread(logConfig, logConfig->getFlushIntervalMs());
+    writerThread->start();
+  }
+
   // Override category filter since some systems disable debug logging in the qtlogging.ini
   oldCategoryFilter = QLoggingCategory::installFilter(categoryFilter);
 
@@ -49,8 +57,14 @@ LoggingHandler::LoggingHandler(const QString& logConfiguration,
 
 LoggingHandler::~LoggingHandler()
 {
+  if(LoggingRateLimiter::getTotalSuppressed() > 0)
+    qInfo() << "Rate limited logging suppressed" << LoggingRateLimiter::getTotalSuppressed() << "messages";
+
   qInstallMessageHandler(oldMessageHandler);
   QLoggingCategory::installFilter(oldCategoryFilter);
+
+  // Write remaining messages before closing streams
+  delete writerThread;
   delete logConfig;
 }
 
@@ -103,6 +117,12 @@ QStringList LoggingHandler::getLogFiles()
     return QStringList();
 }
 
+void LoggingHandler::flush()
+{
+  if(instance != nullptr && instance->writerThread != nullptr)
+    instance->writerThread->flushAndWait();
+}
+
 void LoggingHandler::setLogFunction(LoggingHandler::LogFunctionType loggingFunction)
 {
   logFunc = loggingFunction;
@@ -173,6 +193,9 @@ void LoggingHandler::checkAbortType(QtMsgType type, const QMessageLogContext& co
 
   if(doAbort)
   {
+    if(writerThread != nullptr)
+      writerThread->flushAndWait();
+
     if(abortFunc)
       abortFunc(type, context, msg);
     else
@@ -190,10 +213,20 @@ void LoggingHandler::messageHandler(QtMsgType type, const QMessageLogContext& co
   if(category == "default")
     category.clear();
 
-  instance->logToCatChannels(instance->logConfig->getCatStream(type),
-                             instance->logConfig->getStream(type),
-                             qFormatLogMessage(type, context, msg),
-                             category);
+  if(instance->writerThread != nullptr)
+  {
+    // Format here since context is only valid during this call
+    instance->writerThread->enqueue(type, category, qFormatLogMessage(type, context, msg));
+
+    if(type == QtFatalMsg)
+      // Make sure the message is written before a possible abort
+      instance->writerThread->flushAndWait();
+  }
+  else
+    instance->logToCatChannels(instance->logConfig->getCatStream(type),
+                               instance->logConfig->getStream(type),
+                               qFormatLogMessage(type, context, msg),
+                               category);
 
   instance->checkAbortType(type, context, msg);
 }
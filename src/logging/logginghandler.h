@@ -38,6 +38,7 @@ namespace atools {
 namespace logging {
 namespace internal {
 class LoggingConfig;
+class LoggingWriterThread;
 }
 
 class LoggingGuiAbortHandler;
@@ -59,6 +60,21 @@ class LoggingGuiAbortHandler;
  * maxfiles = 2
  * abort = fatal
  *
+ * # Compress log backups with gzip and delete oldest backups if all exceed maxtotalsize bytes.
+ * # Compression and deletion are done in a background thread when rolling by maxsize.
+ * compress = true
+ * maxtotalsize = 10000000
+ *
+ * # Write messages in a background thread. Streams are flushed every flushinterval milliseconds and on
+ * # warning, critical and fatal messages. Fatal messages are always written before returning.
+ * async = true
+ * flushinterval = 1000
+ *
+ * # Limits for ATOOLS_LOG_LIMITED statements. See LoggingRateLimiter.
+ * ratelimitfirst = 100
+ * ratelimitevery = 100
+ * ratelimitpersecond = 0
+ *
  * [channels]
  * console     = stdio
  * console-err = stderr
@@ -111,6 +127,9 @@ public:
    */
   static QStringList getLogFiles();
 
+  /* Wait until all queued messages are written and flushed. Does nothing if async mode is disabled. */
+  static void flush();
+
   typedef std::function<void (QtMsgType type, const QMessageLogContext& context, const QString& msg)> LogFunctionType;
   /* Function will be called on the calling thread context */
   static void setLogFunction(LogFunctionType loggingFunction);
@@ -144,6 +163,9 @@ private:
   static LoggingHandler *instance;
 
   atools::logging::internal::LoggingConfig *logConfig;
+
+  /* Not null if async mode is enabled */
+  atools::logging::internal::LoggingWriterThread *writerThread = nullptr;
   QtMessageHandler oldMessageHandler = nullptr;
   QLoggingCategory::CategoryFilter oldCategoryFilter = nullptr;
 
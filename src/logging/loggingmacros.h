@@ -0,0 +1,76 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_LOGGING_LOGGINGMACROS_H
+#define ATOOLS_LOGGING_LOGGINGMACROS_H
+
+#include <QDebug>
+#include <QLoggingCategory>
+
+/*
+ * Logging macros which compile away below the minimum level. The level is set in atools.pro by
+ * "qmake ATOOLS_LOG_LEVEL=n" with 0 = debug (default), 1 = info, 2 = warning and 3 = critical.
+ *
+ * Removed statements do not evaluate their stream arguments. Category macros are checked at runtime like
+ * qCDebug and do not evaluate arguments if the category level is disabled.
+ *
+ * ATOOLS_DEBUG() << "Writing waypoint" << ident;
+ * ATOOLS_CDEBUG(category) << "Received" << id;
+ * if(ATOOLS_VERBOSE(options->isVerbose()))
+ *   qDebug() << "Records of" << offset;
+ */
+#ifndef ATOOLS_MIN_LOG_LEVEL
+#define ATOOLS_MIN_LOG_LEVEL 0
+#endif
+
+#define ATOOLS_LOG_LEVEL_DEBUG 0
+#define ATOOLS_LOG_LEVEL_INFO 1
+#define ATOOLS_LOG_LEVEL_WARNING 2
+#define ATOOLS_LOG_LEVEL_CRITICAL 3
+
+/* Never enters the loop. Allows the compiler to remove the whole statement. */
+#define ATOOLS_LOG_NOOP while(false) QMessageLogger().noDebug()
+
+#if ATOOLS_MIN_LOG_LEVEL <= ATOOLS_LOG_LEVEL_DEBUG
+#define ATOOLS_DEBUG() qDebug()
+#define ATOOLS_CDEBUG(category) qCDebug(category)
+
+/* Verbose guard. Always false if debug is not compiled in. */
+#define ATOOLS_VERBOSE(condition) (condition)
+#else
+#define ATOOLS_DEBUG() ATOOLS_LOG_NOOP
+#define ATOOLS_CDEBUG(category) ATOOLS_LOG_NOOP
+#define ATOOLS_VERBOSE(condition) (false && (condition))
+#endif
+
+#if ATOOLS_MIN_LOG_LEVEL <= ATOOLS_LOG_LEVEL_INFO
+#define ATOOLS_INFO() qInfo()
+#define ATOOLS_CINFO(category) qCInfo(category)
+#else
+#define ATOOLS_INFO() ATOOLS_LOG_NOOP
+#define ATOOLS_CINFO(category) ATOOLS_LOG_NOOP
+#endif
+
+#if ATOOLS_MIN_LOG_LEVEL <= ATOOLS_LOG_LEVEL_WARNING
+#define ATOOLS_WARNING() qWarning()
+#define ATOOLS_CWARNING(category) qCWarning(category)
+#else
+#define ATOOLS_WARNING() ATOOLS_LOG_NOOP
+#define ATOOLS_CWARNING(category) ATOOLS_LOG_NOOP
+#endif
+
+#endif // ATOOLS_LOGGING_LOGGINGMACROS_H
@@ -0,0 +1,100 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_LOGGING_LOGGINGQUEUE_H
+#define ATOOLS_LOGGING_LOGGINGQUEUE_H
+
+#include <QString>
+
+#include <atomic>
+
+namespace atools {
+namespace logging {
+namespace internal {
+
+/* Preformatted message waiting to be written by the logging thread */
+struct LogMessage
+{
+  QtMsgType type;
+  QString category, message;
+};
+
+/*
+ * Lock free queue for multiple producers and a single consumer (D. Vyukov's MPSC node queue).
+ *
+ * push() can be called from any thread and never blocks. pop() must be called from one thread only.
+ * A message can be invisible to pop() for a short moment while another producer is in the middle of a push.
+ */
+class LogMessageQueue
+{
+public:
+  LogMessageQueue()
+  {
+    Node *stub = new Node;
+    head.store(stub, std::memory_order_relaxed);
+    tail = stub;
+  }
+
+  ~LogMessageQueue()
+  {
+    LogMessage message;
+    while(pop(message))
+      ;
+    delete tail;
+  }
+
+  LogMessageQueue(const LogMessageQueue& other) = delete;
+  LogMessageQueue& operator=(const LogMessageQueue& other) = delete;
+
+  void push(LogMessage&& message)
+  {
+    Node *node = new Node;
+    node->value = std::move(message);
+    Node *prev = head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  /* Returns false if the queue is empty */
+  bool pop(LogMessage& message)
+  {
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if(next == nullptr)
+      return false;
+
+    // Next becomes the new stub node
+    message = std::move(next->value);
+    delete tail;
+    tail = next;
+    return true;
+  }
+
+private:
+  struct Node
+  {
+    std::atomic<Node *> next {nullptr};
+    LogMessage value;
+  };
+
+  std::atomic<Node *> head;
+  Node *tail; /* Only used by consumer */
+};
+
+} // namespace internal
+} // namespace logging
+} // namespace atools
+
+#endif // ATOOLS_LOGGING_LOGGINGQUEUE_H
@@ -0,0 +1,95 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "logging/loggingratelimiter.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace atools {
+namespace logging {
+
+std::atomic<int> LoggingRateLimiter::defaultFirst(100);
+std::atomic<int> LoggingRateLimiter::defaultEvery(100);
+std::atomic<int> LoggingRateLimiter::defaultPerSecond(0);
+std::atomic<qint64> LoggingRateLimiter::totalSuppressed(0);
+
+static qint64 nowUs()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+LoggingRateLimiter::LoggingRateLimiter(int first, int every, int maxPerSecond)
+  : firstNum(first), everyNum(every), perSecond(maxPerSecond)
+{
+}
+
+bool LoggingRateLimiter::check(int& suppressed)
+{
+  int first = firstNum >= 0 ? firstNum : defaultFirst.load(std::memory_order_relaxed);
+  int every = everyNum >= 0 ? everyNum : defaultEvery.load(std::memory_order_relaxed);
+  int maxPerSecond = perSecond >= 0 ? perSecond : defaultPerSecond.load(std::memory_order_relaxed);
+
+  qint64 num = count.fetch_add(1, std::memory_order_relaxed) + 1;
+
+  bool pass = num <= first;
+  if(!pass && every > 0 && (num - first) % every == 0)
+    // Lock only for every nth message
+    pass = maxPerSecond <= 0 || takeToken(maxPerSecond);
+
+  if(pass)
+    suppressed = suppressedCount.exchange(0, std::memory_order_relaxed);
+  else
+  {
+    suppressedCount.fetch_add(1, std::memory_order_relaxed);
+    totalSuppressed.fetch_add(1, std::memory_order_relaxed);
+    suppressed = 0;
+  }
+  return pass;
+}
+
+bool LoggingRateLimiter::takeToken(int maxPerSecond)
+{
+  QMutexLocker locker(&mutex);
+  qint64 now = nowUs();
+
+  if(tokens < 0.)
+    // Start with a full bucket
+    tokens = maxPerSecond;
+  else
+    tokens = std::min(static_cast<double>(maxPerSecond),
+                      tokens + (now - lastRefillUs) * maxPerSecond / 1000000.);
+  lastRefillUs = now;
+
+  if(tokens >= 1.)
+  {
+    tokens -= 1.;
+    return true;
+  }
+  return false;
+}
+
+void LoggingRateLimiter::setDefaults(int first, int every, int maxPerSecond)
+{
+  defaultFirst.store(std::max(first, 0));
+  defaultEvery.store(std::max(every, 0));
+  defaultPerSecond.store(std::max(maxPerSecond, 0));
+}
+
+} // namespace logging
+} // namespace atools
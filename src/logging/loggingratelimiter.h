@@ -0,0 +1,104 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_LOGGING_LOGGINGRATELIMITER_H
+#define ATOOLS_LOGGING_LOGGINGRATELIMITER_H
+
+#include <QDebug>
+#include <QMutex>
+
+#include <atomic>
+
+namespace atools {
+namespace logging {
+
+/*
+ * Limits the number of messages logged by one call site. The first messages are always logged. After that only
+ * every nth message is logged and optionally at most a number of messages per second (token bucket).
+ *
+ * Limits are taken from the logging configuration if not given in the constructor:
+ *
+ * [configuration]
+ * ratelimitfirst = 100
+ * ratelimitevery = 100
+ * ratelimitpersecond = 0
+ *
+ * Thread safe. See ATOOLS_LOG_LIMITED for usage.
+ */
+class LoggingRateLimiter
+{
+public:
+  /* -1 uses configuration values. every = 1 logs all and 0 none after first. maxPerSecond = 0 disables the
+   * token bucket. */
+  explicit LoggingRateLimiter(int first = -1, int every = -1, int maxPerSecond = -1);
+
+  LoggingRateLimiter(const LoggingRateLimiter& other) = delete;
+  LoggingRateLimiter& operator=(const LoggingRateLimiter& other) = delete;
+
+  /* Returns true if the message should be logged. Sets suppressed to the number of messages dropped at this
+   * site since the last logged message. */
+  bool check(int& suppressed);
+
+  /* Set configuration values used by all limiters without explicit values */
+  static void setDefaults(int first, int every, int maxPerSecond);
+
+  /* Number of messages suppressed by all limiters */
+  static qint64 getTotalSuppressed()
+  {
+    return totalSuppressed.load(std::memory_order_relaxed);
+  }
+
+private:
+  bool takeToken(int maxPerSecond);
+
+  int firstNum, everyNum, perSecond;
+
+  std::atomic<qint64> count {0};
+  std::atomic<int> suppressedCount {0};
+
+  /* Token bucket - only used for every nth message */
+  QMutex mutex;
+  double tokens = -1.;
+  qint64 lastRefillUs = 0;
+
+  static std::atomic<int> defaultFirst, defaultEvery, defaultPerSecond;
+  static std::atomic<qint64> totalSuppressed;
+};
+
+} // namespace logging
+} // namespace atools
+
+/*
+ * Log statement which is rate limited per call site. A line with the number of suppressed messages is logged
+ * before the next message that passes.
+ *
+ * ATOOLS_LOG_LIMITED(qWarning() << "Found invalid record" << rec->getObjectName());
+ */
+#define ATOOLS_LOG_LIMITED(statement) \
+  do { \
+    static atools::logging::LoggingRateLimiter atoolsRateLimiter; \
+    int atoolsRateSuppressed = 0; \
+    if(atoolsRateLimiter.check(atoolsRateSuppressed)) \
+    { \
+      if(atoolsRateSuppressed > 0) \
+        qInfo().nospace() << "Suppressed " << atoolsRateSuppressed << " messages at " << __FILE__ << ":" \
+                          << __LINE__; \
+      statement; \
+    } \
+  } while(false)
+
+#endif // ATOOLS_LOGGING_LOGGINGRATELIMITER_H
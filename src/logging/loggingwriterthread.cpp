@@ -0,0 +1,174 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "logging/loggingwriterthread.h"
+#include "logging/loggingconfig.h"
+
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace atools {
+namespace logging {
+namespace internal {
+
+/* Wake up the writer if this number of messages is waiting */
+static const int WAKE_QUEUE_SIZE = 1000;
+
+/* Maximum time to wait for a flush in milliseconds */
+static const unsigned long FLUSH_WAIT_MS = 5000;
+
+LoggingWriterThread::LoggingWriterThread(LoggingConfig *loggingConfig, int flushIntervalMs)
+  : config(loggingConfig), flushInterval(std::max(flushIntervalMs, 1))
+{
+  setObjectName("LoggingWriterThread");
+}
+
+LoggingWriterThread::~LoggingWriterThread()
+{
+  stop();
+}
+
+void LoggingWriterThread::enqueue(QtMsgType type, const QString& category, const QString& message)
+{
+  queue.push({type, category, message});
+  int queued = numQueued.fetch_add(1, std::memory_order_relaxed) + 1;
+
+  // Lock only for rare messages or if the batch is full
+  if((type != QtDebugMsg && type != QtInfoMsg) || queued == WAKE_QUEUE_SIZE)
+  {
+    QMutexLocker locker(&waitMutex);
+    wakeCondition.wakeOne();
+  }
+}
+
+void LoggingWriterThread::flushAndWait()
+{
+  if(QThread::currentThread() == this || !isRunning())
+    return;
+
+  QMutexLocker locker(&waitMutex);
+  quint64 request = flushRequests.fetch_add(1) + 1;
+  wakeCondition.wakeOne();
+
+  QElapsedTimer timer;
+  timer.start();
+  while(flushesDone < request && timer.elapsed() < static_cast<qint64>(FLUSH_WAIT_MS))
+    flushedCondition.wait(&waitMutex, FLUSH_WAIT_MS);
+}
+
+void LoggingWriterThread::stop()
+{
+  if(isRunning())
+  {
+    {
+      QMutexLocker locker(&waitMutex);
+      terminate.store(true);
+      wakeCondition.wakeOne();
+    }
+    wait();
+  }
+}
+
+void LoggingWriterThread::run()
+{
+  QElapsedTimer flushTimer;
+  flushTimer.start();
+
+  while(!terminate.load())
+  {
+    {
+      QMutexLocker locker(&waitMutex);
+      if(!terminate.load() && numQueued.load() < WAKE_QUEUE_SIZE && flushRequests.load() == flushesDone)
+        wakeCondition.wait(&waitMutex, static_cast<unsigned long>(flushInterval));
+    }
+
+    // Read request before writing to include all messages pushed before the request
+    quint64 request = flushRequests.load();
+    bool flush = writeQueued();
+
+    if(flush || request != flushesDone || flushTimer.elapsed() >= flushInterval)
+    {
+      flushStreams();
+      flushTimer.restart();
+    }
+
+    if(request != flushesDone)
+    {
+      QMutexLocker locker(&waitMutex);
+      flushesDone = request;
+      flushedCondition.wakeAll();
+    }
+  }
+
+  // Write all remaining messages before terminating
+  writeQueued();
+  flushStreams();
+
+  QMutexLocker locker(&waitMutex);
+  flushesDone = flushRequests.load();
+  flushedCondition.wakeAll();
+}
+
+bool LoggingWriterThread::writeQueued()
+{
+  bool flush = false;
+  LogMessage message;
+  while(queue.pop(message))
+  {
+    numQueued.fetch_sub(1, std::memory_order_relaxed);
+
+    const ChannelVector *channels = nullptr;
+    if(message.category.isEmpty())
+      channels = &config->getStream(message.type);
+    else
+    {
+      const ChannelMap& catStreams = config->getCatStream(message.type);
+      ChannelMap::const_iterator it = catStreams.constFind(message.category);
+      if(it != catStreams.constEnd())
+        channels = &it.value();
+    }
+
+    if(channels != nullptr)
+    {
+      for(Channel *channel : *channels)
+      {
+        // No endl since it flushes
+        (*channel->stream) << message.message << '\n';
+        dirtyChannels.insert(channel);
+      }
+    }
+
+    flush |= message.type != QtDebugMsg && message.type != QtInfoMsg;
+  }
+  return flush;
+}
+
+void LoggingWriterThread::flushStreams()
+{
+  for(Channel *channel : dirtyChannels)
+  {
+    channel->stream->flush();
+    config->checkStreamSize(channel);
+  }
+  dirtyChannels.clear();
+}
+
+} // namespace internal
+} // namespace logging
+} // namespace atools
@@ -0,0 +1,93 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_LOGGING_LOGGINGWRITERTHREAD_H
+#define ATOOLS_LOGGING_LOGGINGWRITERTHREAD_H
+
+#include "logging/loggingqueue.h"
+#include "logging/loggingtypes.h"
+
+#include <QMutex>
+#include <QSet>
+#include <QThread>
+#include <QWaitCondition>
+
+namespace atools {
+namespace logging {
+namespace internal {
+
+class LoggingConfig;
+
+/*
+ * Background thread for asynchronous logging. Producers push preformatted messages into a lock free queue.
+ * This thread writes them in batches to the channels and flushes the streams periodically, on warning and worse
+ * messages or when requested. Also does the file rollover.
+ *
+ * Only this thread accesses the streams while running.
+ */
+class LoggingWriterThread :
+  public QThread
+{
+public:
+  LoggingWriterThread(LoggingConfig *loggingConfig, int flushIntervalMs);
+  virtual ~LoggingWriterThread() override;
+
+  /* Add message to queue. Does not block for debug and info messages. */
+  void enqueue(QtMsgType type, const QString& category, const QString& message);
+
+  /* Wait until all messages queued by the calling thread are written and flushed.
+   * Returns immediately if called from the writer thread itself. */
+  void flushAndWait();
+
+  /* Write remaining messages and stop thread */
+  void stop();
+
+private:
+  virtual void run() override;
+
+  /* Write all queued messages. Returns true if a message requires flushing. */
+  bool writeQueued();
+
+  /* Flush all streams written to since last flush and roll files if needed */
+  void flushStreams();
+
+  LoggingConfig *config;
+  int flushInterval;
+
+  LogMessageQueue queue;
+
+  /* Number of messages waiting in queue. Used to wake the thread if the batch is large. */
+  std::atomic<int> numQueued {0};
+  std::atomic<bool> terminate {false};
+
+  /* Incremented by flush requests and copied into flushesDone once the flush is finished */
+  std::atomic<quint64> flushRequests {0};
+  quint64 flushesDone = 0;
+
+  /* Only for waking up - the queue itself is not locked */
+  QMutex waitMutex;
+  QWaitCondition wakeCondition, flushedCondition;
+
+  /* Channels having unflushed data */
+  QSet<Channel *> dirtyChannels;
+};
+
+} // namespace internal
+} // namespace logging
+} // namespace atools
+
+#endif // ATOOLS_LOGGING_LOGGINGWRITERTHREAD_H
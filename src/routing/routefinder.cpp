@@ -0,0 +1,271 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "routing/routefinder.h"
+#include "geo/compactpos.h"
+
+#include <QDebug>
+#include <QHash>
+
+#include <algorithm>
+
+namespace atools {
+namespace routing {
+
+using atools::fs::common::RouteNetwork;
+using atools::fs::common::ROUTE_RADIO;
+using atools::fs::common::ROUTE_AIRWAY;
+using atools::geo::Pos;
+
+/* Values of route_edge_airway.type */
+static Q_DECL_CONSTEXPR int EDGE_VICTOR = 5;
+static Q_DECL_CONSTEXPR int EDGE_JET = 6;
+
+/* route_edge_airway.direction relative to the stored edge */
+static Q_DECL_CONSTEXPR int DIRECTION_BACKWARD = 2;
+
+RouteFinder::RouteFinder(const fs::common::RouteGraph& routeGraph)
+  : graph(routeGraph), openHeap(1000)
+{
+
+}
+
+void RouteFinder::clear()
+{
+  costs.clear();
+  heuristics.clear();
+  predecessors.clear();
+  predecessorEdges.clear();
+  stamps.clear();
+  closedStamps.clear();
+  generation = 0;
+  openHeap.clear();
+  transferOffsets.clear();
+  transferTargets.clear();
+  nodePositions[ROUTE_RADIO].clear();
+  nodePositions[ROUTE_AIRWAY].clear();
+  numRadioNodes = 0;
+}
+
+RouteNode RouteFinder::node(int state) const
+{
+  if(state < numRadioNodes)
+    return {ROUTE_RADIO, state};
+  else
+    return {ROUTE_AIRWAY, state - numRadioNodes};
+}
+
+void RouteFinder::prepare(RouteMode mode)
+{
+  int numStates = graph.numNodes(ROUTE_RADIO) + graph.numNodes(ROUTE_AIRWAY);
+  if(stamps.size() != numStates)
+  {
+    numRadioNodes = graph.numNodes(ROUTE_RADIO);
+    costs.fill(0.f, numStates);
+    heuristics.fill(0.f, numStates);
+    predecessors.fill(-1, numStates);
+    predecessorEdges.fill(-1, numStates);
+    stamps.fill(0, numStates);
+    closedStamps.fill(0, numStates);
+    generation = 0;
+    transferOffsets.clear();
+    transferTargets.clear();
+  }
+
+  // Invalidate all buffers at once
+  generation++;
+  if(generation == 0)
+  {
+    // Wrapped - reset stamps
+    stamps.fill(0);
+    closedStamps.fill(0);
+    generation = 1;
+  }
+
+  if(mode == MODE_MIXED && transferOffsets.isEmpty() && numStates > 0)
+  {
+    // Connect all radio and airway nodes at the same position
+    QMultiHash<atools::geo::CompactPos, int> airwayNodes;
+    for(int i = 0; i < graph.numNodes(ROUTE_AIRWAY); i++)
+      airwayNodes.insert(atools::geo::CompactPos(graph.nodeLonX(ROUTE_AIRWAY, i), graph.nodeLatY(ROUTE_AIRWAY, i)),
+                         numRadioNodes + i);
+
+    // Pairs of from and to state in both directions
+    QVector<QPair<int, int> > links;
+    for(int i = 0; i < numRadioNodes; i++)
+    {
+      atools::geo::CompactPos pos(graph.nodeLonX(ROUTE_RADIO, i), graph.nodeLatY(ROUTE_RADIO, i));
+      for(auto it = airwayNodes.constFind(pos); it != airwayNodes.constEnd() && it.key() == pos; ++it)
+      {
+        links.append(qMakePair(i, it.value()));
+        links.append(qMakePair(it.value(), i));
+      }
+    }
+    std::sort(links.begin(), links.end());
+
+    transferOffsets.fill(0, numStates + 1);
+    transferTargets.reserve(links.size());
+    for(const QPair<int, int>& link : links)
+    {
+      transferOffsets[link.first + 1]++;
+      transferTargets.append(link.second);
+    }
+
+    for(int i = 0; i < numStates; i++)
+      transferOffsets[i + 1] += transferOffsets.at(i);
+  }
+
+  openHeap.clear();
+}
+
+bool RouteFinder::calculateRoute(RouteMode mode, const RouteNode& from, const RouteNode& to,
+                                 QVector<RouteLeg>& route)
+{
+  route.clear();
+  distanceMeter = 0.f;
+  numNodesVisited = 0;
+
+  if(!graph.isOpen())
+  {
+    qWarning() << Q_FUNC_INFO << "Route graph not open";
+    return false;
+  }
+
+  if((mode == MODE_RADIO && (from.network != ROUTE_RADIO || to.network != ROUTE_RADIO)) ||
+     (mode == MODE_AIRWAY && (from.network != ROUTE_AIRWAY || to.network != ROUTE_AIRWAY)))
+  {
+    qWarning() << Q_FUNC_INFO << "Network does not match mode" << mode;
+    return false;
+  }
+
+  if(from.index < 0 || from.index >= graph.numNodes(from.network) ||
+     to.index < 0 || to.index >= graph.numNodes(to.network))
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid node index" << from.index << to.index;
+    return false;
+  }
+
+  prepare(mode);
+
+  int start = state(from), dest = state(to);
+  Pos destPos(graph.nodeLonX(to.network, to.index), graph.nodeLatY(to.network, to.index));
+
+  relax(-1, start, 0.f, -1, destPos);
+
+  while(!openHeap.isEmpty())
+  {
+    int current;
+    openHeap.pop(current);
+
+    if(current == dest)
+    {
+      distanceMeter = costs.at(dest);
+      buildRoute(dest, route);
+      return true;
+    }
+
+    closedStamps[current] = generation;
+    numNodesVisited++;
+
+    RouteNode currentNode = node(current);
+    float currentCost = costs.at(current);
+    int end = graph.edgesEnd(currentNode.network, currentNode.index);
+    for(int edge = graph.edgesBegin(currentNode.network, currentNode.index); edge < end; edge++)
+    {
+      if(isEdgeAllowed(currentNode.network, edge))
+        relax(current, state({currentNode.network, graph.edgeTarget(currentNode.network, edge)}),
+              currentCost + graph.edgeDistanceMeter(currentNode.network, edge), edge, destPos);
+    }
+
+    // Change network at the same position without costs
+    if(mode == MODE_MIXED)
+    {
+      for(int t = transferOffsets.at(current); t < transferOffsets.at(current + 1); t++)
+        relax(current, transferTargets.at(t), currentCost, -1, destPos);
+    }
+  }
+  return false;
+}
+
+void RouteFinder::relax(int current, int next, float cost, int edge, const Pos& destPos)
+{
+  if(closedStamps.at(next) == generation)
+    return;
+
+  if(stamps.at(next) != generation)
+  {
+    // First visit in this search - heuristic is calculated only once per node
+    RouteNode nextNode = node(next);
+    heuristics[next] = Pos(graph.nodeLonX(nextNode.network, nextNode.index),
+                           graph.nodeLatY(nextNode.network, nextNode.index)).distanceMeterTo(destPos);
+    stamps[next] = generation;
+  }
+  else if(cost >= costs.at(next))
+    return;
+
+  costs[next] = cost;
+  predecessors[next] = current;
+  predecessorEdges[next] = edge;
+  openHeap.push(next, cost + heuristics.at(next));
+}
+
+bool RouteFinder::isEdgeAllowed(RouteNetwork network, int edge) const
+{
+  if(network == ROUTE_RADIO)
+    return true;
+
+  if(graph.edgeDirection(network, edge) == DIRECTION_BACKWARD)
+    return false;
+
+  int type = graph.edgeType(network, edge);
+  if((type == EDGE_VICTOR && !(airwayTypes & AIRWAY_VICTOR)) || (type == EDGE_JET && !(airwayTypes & AIRWAY_JET)))
+    return false;
+
+  if(altitudeFt > 0)
+  {
+    int minAltitude = graph.edgeMinAltitude(network, edge);
+    int maxAltitude = graph.edgeMaxAltitude(network, edge);
+    if((minAltitude > 0 && altitudeFt < minAltitude) || (maxAltitude > 0 && altitudeFt > maxAltitude))
+      return false;
+  }
+  return true;
+}
+
+void RouteFinder::buildRoute(int dest, QVector<RouteLeg>& route) const
+{
+  for(int current = dest; current != -1; current = predecessors.at(current))
+  {
+    RouteNode currentNode = node(current);
+    route.append({currentNode.network, currentNode.index, predecessorEdges.at(current)});
+  }
+  std::reverse(route.begin(), route.end());
+}
+
+int RouteFinder::nearestNode(RouteNetwork network, const Pos& pos)
+{
+  atools::geo::PosArray& positions = nodePositions[network];
+  if(positions.isEmpty() && graph.numNodes(network) > 0)
+  {
+    positions.reserve(graph.numNodes(network));
+    for(int i = 0; i < graph.numNodes(network); i++)
+      positions.append(Pos(graph.nodeLonX(network, i), graph.nodeLatY(network, i)));
+  }
+  return positions.nearest(pos);
+}
+
+} // namespace routing
+} // namespace atools
@@ -0,0 +1,146 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_ROUTING_ROUTEFINDER_H
+#define ATOOLS_ROUTING_ROUTEFINDER_H
+
+#include "fs/common/routegraph.h"
+#include "geo/posarray.h"
+#include "util/indexedheap.h"
+
+#include <QVector>
+
+namespace atools {
+namespace routing {
+
+/* Networks used for a route search */
+enum RouteMode
+{
+  MODE_RADIO, /* VOR and NDB to VOR and NDB */
+  MODE_AIRWAY, /* Airways only */
+  MODE_MIXED /* Airways and radio navaids - networks are connected at nodes having the same position */
+};
+
+/* Airway types to use in airway and mixed mode */
+enum AirwayTypes
+{
+  AIRWAY_VICTOR = 1 << 0,
+  AIRWAY_JET = 1 << 1,
+  AIRWAY_ALL = AIRWAY_VICTOR | AIRWAY_JET
+};
+
+/* Node of a route graph network */
+struct RouteNode
+{
+  atools::fs::common::RouteNetwork network;
+  int index; /* Node index in the route graph */
+};
+
+/* Leg of a calculated route */
+struct RouteLeg
+{
+  atools::fs::common::RouteNetwork network;
+  int nodeIndex;
+
+  /* Edge index used to reach the node in its network. -1 for the start node and when changing networks. */
+  int edgeIndex;
+};
+
+/*
+ * A* route finder working on a memory mapped atools::fs::common::RouteGraph.
+ *
+ * Costs are edge distances in meter and the heuristic is the great circle distance to the destination.
+ * Search buffers are kept between calls and are invalidated using a generation counter, so a query
+ * touches only the nodes it visits. The graph is read only which allows to run one finder per thread.
+ */
+class RouteFinder
+{
+public:
+  explicit RouteFinder(const atools::fs::common::RouteGraph& routeGraph);
+
+  /* Calculate route from start to destination. Returns false if no route was found.
+   * Route contains start and destination. Networks of start and destination have to match the mode. */
+  bool calculateRoute(RouteMode mode, const RouteNode& from, const RouteNode& to, QVector<RouteLeg>& route);
+
+  /* Index of the node nearest to pos or -1 if the network is empty */
+  int nearestNode(atools::fs::common::RouteNetwork network, const atools::geo::Pos& pos);
+
+  /* Cruise altitude used to check airway minimum and maximum altitudes. 0 ignores restrictions. */
+  void setAltitudeFt(int value)
+  {
+    altitudeFt = value;
+  }
+
+  void setAirwayTypes(AirwayTypes value)
+  {
+    airwayTypes = value;
+  }
+
+  /* Sum of edge distances of the last found route */
+  float getDistanceMeter() const
+  {
+    return distanceMeter;
+  }
+
+  /* Number of nodes expanded by the last search */
+  int getNumNodesVisited() const
+  {
+    return numNodesVisited;
+  }
+
+  /* Drop lookup tables and buffers. Has to be called if the graph was reopened. */
+  void clear();
+
+private:
+  /* States are radio node indexes followed by airway node indexes */
+  int state(const RouteNode& node) const
+  {
+    return node.network == atools::fs::common::ROUTE_RADIO ? node.index : numRadioNodes + node.index;
+  }
+
+  RouteNode node(int state) const;
+
+  void prepare(RouteMode mode);
+  void relax(int current, int next, float cost, int edge, const atools::geo::Pos& destPos);
+  bool isEdgeAllowed(atools::fs::common::RouteNetwork network, int edge) const;
+  void buildRoute(int dest, QVector<RouteLeg>& route) const;
+
+  const atools::fs::common::RouteGraph& graph;
+  int altitudeFt = 0;
+  AirwayTypes airwayTypes = AIRWAY_ALL;
+  float distanceMeter = 0.f;
+  int numNodesVisited = 0, numRadioNodes = 0;
+
+  /* Search buffers indexed by state. Values are valid only if stamp matches generation. */
+  QVector<float> costs, heuristics;
+  QVector<int> predecessors, predecessorEdges;
+  QVector<quint32> stamps, closedStamps;
+  quint32 generation = 0;
+  atools::util::DenseIndexedHeap openHeap;
+
+  /* Connection states in the other network at the same position. Several nodes can share a position.
+   * Transfers of state s are transferTargets[transferOffsets[s]] to transferTargets[transferOffsets[s + 1] - 1].
+   * Built on first mixed search. */
+  QVector<int> transferOffsets, transferTargets;
+
+  atools::geo::PosArray nodePositions[atools::fs::common::ROUTE_NUM_NETWORKS];
+};
+
+} // namespace routing
+} // namespace atools
+
+#endif // ATOOLS_ROUTING_ROUTEFINDER_H
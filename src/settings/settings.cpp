@@ -23,12 +23,14 @@
 #include <QApplication>
 #include <QFileInfo>
 #include <QDir>
+#include <QTimer>
 
 namespace atools {
 namespace settings {
 
 Settings *Settings::settingsInstance = nullptr;
 QString Settings::overrideOrganisation;
+int Settings::flushDelayMs = 2000;
 
 Settings::Settings()
 {
@@ -43,13 +45,84 @@ Settings::Settings()
   if(qSettings->status() != QSettings::NoError)
     throw Exception(QString("Error creating settings file \"%1\" reason %2").
                     arg(qSettings->fileName()).arg(qSettings->status()));
+
+  flushTimer = new QTimer();
+  flushTimer->setSingleShot(true);
+  QObject::connect(flushTimer, &QTimer::timeout, [this]() {
+    flush();
+  });
+
+  loadCache();
 }
 
 Settings::~Settings()
 {
+  flush();
+  delete flushTimer;
   delete qSettings;
 }
 
+QSettings *Settings::getQSettings()
+{
+  Settings& settings = instance();
+  settings.flush();
+  settings.cacheValid = false;
+  return settings.qSettings;
+}
+
+void Settings::loadCache() const
+{
+  if(!cacheValid)
+  {
+    cache.clear();
+    for(const QString& key : qSettings->allKeys())
+      cache.insert(key, qSettings->value(key));
+    cacheValid = true;
+  }
+}
+
+void Settings::flush()
+{
+  flushTimer->stop();
+
+  // Removals first since a key might be set again after removing it
+  for(const QString& key : removedKeys)
+    qSettings->remove(key);
+
+  for(const QString& key : dirtyKeys)
+    qSettings->setValue(key, cache.value(key));
+
+  removedKeys.clear();
+  dirtyKeys.clear();
+}
+
+void Settings::scheduleFlush()
+{
+  if(flushDelayMs <= 0)
+    flush();
+  else if(!flushTimer->isActive())
+    flushTimer->start(flushDelayMs);
+}
+
+void Settings::setValueInternal(const QString& key, const QVariant& value)
+{
+  loadCache();
+
+  QHash<QString, QVariant>::const_iterator it = cache.constFind(key);
+  if(it != cache.constEnd())
+  {
+    // Skip unchanged values to avoid writing the file. Values read from the file are strings for simple types.
+    if(it->userType() == value.userType() ? *it == value :
+       it->userType() == QMetaType::QString && value.canConvert<QString>() && it->toString() == value.toString())
+      return;
+  }
+
+  cache.insert(key, value);
+  dirtyKeys.insert(key);
+
+  scheduleFlush();
+}
+
 Settings& Settings::instance()
 {
   if(settingsInstance == nullptr)
@@ -76,7 +149,7 @@ void Settings::logSettingsInformation()
 
 QString Settings::getFilename()
 {
-  return instance().getQSettings()->fileName();
+  return instance().qSettings->fileName();
 }
 
 QString Settings::getConfigFilename(const QString& extension, const QString& subdir)
@@ -124,22 +197,26 @@ QString Settings::getOverloadedPath(const QString& filename)
 
 QVariant Settings::getAndStoreValue(const QString& key, const QVariant& defaultValue) const
 {
-  QSettings *settings = instance().getQSettings();
-
-  if(settings->contains(key))
-    return settings->value(key, defaultValue);
+  if(contains(key))
+    return valueVar(key, defaultValue);
   else
   {
-    settings->setValue(key, defaultValue);
+    instance().setValueInternal(key, defaultValue);
     return defaultValue;
   }
 }
 
 void Settings::syncSettings()
 {
-  QSettings *qs = instance().getQSettings();
+  Settings& settings = instance();
+  settings.flush();
+
+  QSettings *qs = settings.qSettings;
   qs->sync();
 
+  // Pick up changes in the file
+  settings.cacheValid = false;
+
   if(qs->status() != QSettings::NoError)
     throw Exception(QString("Error creating settings file \"%1\" reason %2").
                     arg(qs->fileName()).arg(qs->status()));
@@ -147,12 +224,29 @@ void Settings::syncSettings()
 
 bool Settings::contains(const QString& key) const
 {
-  return qSettings->contains(key);
+  loadCache();
+  return cache.contains(key);
 }
 
 void Settings::remove(const QString& key)
 {
-  qSettings->remove(key);
+  loadCache();
+
+  // Remove key and all keys in the group like QSettings::remove()
+  QString group = key + "/";
+  for(auto it = cache.begin(); it != cache.end();)
+  {
+    if(key.isEmpty() || it.key() == key || it.key().startsWith(group))
+    {
+      dirtyKeys.remove(it.key());
+      it = cache.erase(it);
+    }
+    else
+      ++it;
+  }
+  removedKeys.insert(key);
+
+  scheduleFlush();
 }
 
 QStringList Settings::valueStrList(const QString& key, const QStringList& defaultValue) const
@@ -160,7 +254,7 @@ QStringList Settings::valueStrList(const QString& key, const QStringList& defaul
   if(!contains(key))
     return defaultValue;
 
-  QStringList list = qSettings->value(key, defaultValue).toStringList();
+  QStringList list = valueVar(key, defaultValue).toStringList();
 
   if(list.isEmpty() || (list.size() == 1 && list.first().isEmpty()))
     return QStringList();
@@ -170,80 +264,83 @@ QStringList Settings::valueStrList(const QString& key, const QStringList& defaul
 
 QString Settings::valueStr(const QString& key, const QString& defaultValue) const
 {
-  return qSettings->value(key, defaultValue).toString();
+  return valueVar(key, defaultValue).toString();
 }
 
 bool Settings::valueBool(const QString& key, bool defaultValue) const
 {
-  return qSettings->value(key, defaultValue).toBool();
+  return valueVar(key, defaultValue).toBool();
 }
 
 int Settings::valueInt(const QString& key, int defaultValue) const
 {
-  return qSettings->value(key, defaultValue).toInt();
+  return valueVar(key, defaultValue).toInt();
 }
 
 float Settings::valueFloat(const QString& key, float defaultValue) const
 {
-  return qSettings->value(key, defaultValue).toFloat();
+  return valueVar(key, defaultValue).toFloat();
 }
 
 double Settings::valueDouble(const QString& key, double defaultValue) const
 {
-  return qSettings->value(key, defaultValue).toDouble();
+  return valueVar(key, defaultValue).toDouble();
 }
 
 QVariant Settings::valueVar(const QString& key, QVariant defaultValue) const
 {
-  return qSettings->value(key, defaultValue);
+  loadCache();
+  return cache.value(key, defaultValue);
 }
 
 void Settings::setValue(const QString& key, const QStringList& value)
 {
   if(value.isEmpty())
-    qSettings->setValue(key, QString());
+    setValueInternal(key, QString());
   else
-    qSettings->setValue(key, value);
+    setValueInternal(key, value);
 }
 
 void Settings::setValue(const QString& key, const QString& value)
 {
-  qSettings->setValue(key, value);
+  setValueInternal(key, value);
 }
 
 void Settings::setValue(const QString& key, bool value)
 {
-  qSettings->setValue(key, value);
+  setValueInternal(key, value);
 }
 
 void Settings::setValue(const QString& key, int value)
 {
-  qSettings->setValue(key, QString::number(value));
+  setValueInternal(key, QString::number(value));
 }
 
 void Settings::setValue(const QString& key, float value)
 {
-  qSettings->setValue(key, QString::number(value, 'f', 10));
+  setValueInternal(key, QString::number(value, 'f', 10));
 }
 
 void Settings::setValue(const QString& key, double value)
 {
-  qSettings->setValue(key, QString::number(value, 'f', 18));
+  setValueInternal(key, QString::number(value, 'f', 18));
 }
 
 void Settings::setValueVar(const QString& key, const QVariant& value)
 {
-  qSettings->setValue(key, value);
+  setValueInternal(key, value);
 }
 
 QStringList Settings::childGroups() const
 {
+  // Write pending changes since groups are taken from QSettings
+  instance().flush();
   return qSettings->childGroups();
 }
 
 QString Settings::getPath()
 {
-  return QFileInfo(instance().getQSettings()->fileName()).path();
+  return QFileInfo(instance().qSettings->fileName()).path();
 }
 
 QString Settings::orgNameForDirs()
@@ -18,10 +18,13 @@
 #ifndef ATOOLS_SETTINGS_SETTINGS_H
 #define ATOOLS_SETTINGS_SETTINGS_H
 
+#include <QHash>
+#include <QSet>
 #include <QString>
 #include <QVariant>
 
 class QSettings;
+class QTimer;
 
 namespace atools {
 namespace settings {
@@ -34,6 +37,10 @@ namespace settings {
  * QApplication::applicationName() in lowercase with
  * spaces replaced by underscrores.
  * If an error occurs Exception is thrown.
+ *
+ * All values are read at once on startup and kept in memory. Changed values are written to QSettings
+ * after a delay, on syncSettings() or on shutdown. This avoids stalls when many values are saved at once.
+ * Not thread safe. Use from the main thread only.
  */
 class Settings
 {
@@ -90,13 +97,19 @@ public:
   /* Write settings to file and reload all changes in settings file */
   static void syncSettings();
 
+  /* Delay for writing changed values to QSettings. Default is 2000 ms. 0 writes immediately. */
+  static void setFlushDelayMs(int value)
+  {
+    flushDelayMs = value;
+  }
+
   /*
+   * Writes all pending changes before returning. The memory cache is reloaded on the next access
+   * since the caller might modify QSettings directly.
+   *
    * @return The single QSettings object.
    */
-  static QSettings *getQSettings()
-  {
-    return instance().qSettings;
-  }
+  static QSettings *getQSettings();
 
   static QString getFilename();
 
@@ -125,8 +138,32 @@ private:
   Settings();
   ~Settings();
 
+  /* Write changed and removed values to QSettings */
+  void flush();
+
+  /* Read all values from QSettings if cache was invalidated */
+  void loadCache() const;
+
+  /* Update cache and start timer for writing. Does nothing if the value is not changed. */
+  void setValueInternal(const QString& key, const QVariant& value);
+
+  /* Start timer for delayed writing or write immediately if delay is 0 */
+  void scheduleFlush();
+
   QSettings *qSettings;
 
+  /* All values read from QSettings plus changes not written yet */
+  mutable QHash<QString, QVariant> cache;
+  mutable bool cacheValid = false;
+
+  /* Keys changed or removed since last flush */
+  QSet<QString> dirtyKeys, removedKeys;
+
+  /* Single shot timer for delayed writing */
+  QTimer *flushTimer = nullptr;
+
+  static int flushDelayMs;
+
   static QString overrideOrganisation;
 
   static Settings *settingsInstance;
@@ -0,0 +1,97 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "sql/sqlbatch.h"
+
+#include "sql/sqlexception.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlrecord.h"
+
+namespace atools {
+namespace sql {
+
+SqlBatch::SqlBatch(SqlQuery *sqlQuery, int batchSize)
+  : query(sqlQuery), maxRows(batchSize)
+{
+}
+
+SqlBatch::~SqlBatch()
+{
+}
+
+void SqlBatch::bindConstant(const QString& placeholder, const QVariant& value)
+{
+  constants.insert(placeholder, value);
+}
+
+void SqlBatch::bindValue(const QString& placeholder, const QVariant& value)
+{
+  QVariantList& list = values[placeholder];
+  if(list.size() != numRows)
+    throw SqlException(QString("SqlBatch::bindValue(): Placeholder \"%1\" has %2 values for row %3").
+                       arg(placeholder).arg(list.size()).arg(numRows));
+  list.append(value);
+}
+
+void SqlBatch::addRow()
+{
+  numRows++;
+  if(numRows >= maxRows)
+    exec();
+}
+
+void SqlBatch::addRecord(const SqlRecord& record)
+{
+  for(int i = 0; i < record.count(); i++)
+    bindValue(record.fieldName(i), record.value(i));
+  addRow();
+}
+
+void SqlBatch::exec()
+{
+  if(numRows == 0)
+    return;
+
+  for(auto it = values.begin(); it != values.end(); ++it)
+  {
+    if(it.value().size() != numRows)
+      throw SqlException(QString("SqlBatch::exec(): Placeholder \"%1\" has %2 values for %3 rows").
+                         arg(it.key()).arg(it.value().size()).arg(numRows));
+    query->bindValue(it.key(), it.value());
+  }
+
+  for(auto it = constants.constBegin(); it != constants.constEnd(); ++it)
+  {
+    QVariantList list;
+    list.reserve(numRows);
+    for(int i = 0; i < numRows; i++)
+      list.append(it.value());
+    query->bindValue(it.key(), list);
+  }
+
+  query->execBatch();
+
+  // Keep placeholders for the next batch
+  for(auto it = values.begin(); it != values.end(); ++it)
+    it.value().clear();
+
+  numExecuted += numRows;
+  numRows = 0;
+}
+
+} // namespace sql
+} // namespace atools
@@ -0,0 +1,84 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_SQL_SQLBATCH_H
+#define ATOOLS_SQL_SQLBATCH_H
+
+#include <QHash>
+#include <QVariantList>
+
+namespace atools {
+namespace sql {
+
+class SqlQuery;
+class SqlRecord;
+
+/*
+ * Collects rows of values for the named placeholders of a prepared insert or update query and executes
+ * them with SqlQuery::execBatch() once batchSize rows are collected.
+ *
+ * Each placeholder which is not a constant has to get a value for each row.
+ * Call exec() to write the remaining rows. Rows not executed are discarded in the destructor.
+ */
+class SqlBatch
+{
+public:
+  explicit SqlBatch(atools::sql::SqlQuery *sqlQuery, int batchSize = 5000);
+  ~SqlBatch();
+
+  SqlBatch(const SqlBatch& other) = delete;
+  SqlBatch& operator=(const SqlBatch& other) = delete;
+
+  /* Value used for all rows */
+  void bindConstant(const QString& placeholder, const QVariant& value);
+
+  /* Value for the current row */
+  void bindValue(const QString& placeholder, const QVariant& value);
+
+  /* Finish current row and execute the batch if full */
+  void addRow();
+
+  /* Bind all fields of the record by name as values for the current row and finish the row.
+   * Field names have to be the placeholders including the colon. */
+  void addRecord(const atools::sql::SqlRecord& record);
+
+  /* Execute all collected rows */
+  void exec();
+
+  /* Rows collected and not executed yet */
+  int size() const
+  {
+    return numRows;
+  }
+
+  /* Total number of rows executed */
+  int getNumExecuted() const
+  {
+    return numExecuted;
+  }
+
+private:
+  atools::sql::SqlQuery *query;
+  QHash<QString, QVariant> constants;
+  QHash<QString, QVariantList> values;
+  int maxRows, numRows = 0, numExecuted = 0;
+};
+
+} // namespace sql
+} // namespace atools
+
+#endif // ATOOLS_SQL_SQLBATCH_H
@@ -0,0 +1,156 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "sql/sqlconnectionpool.h"
+
+#include "sql/sqldatabase.h"
+#include "sql/sqlexception.h"
+
+#include <QDebug>
+#include <QMutex>
+#include <QThread>
+
+namespace atools {
+namespace sql {
+
+/* Counters for all threads */
+class SqlConnectionPoolState
+{
+public:
+  QMutex mutex;
+  int numConnections = 0;
+  quint64 nextId = 0;
+  QString poolName;
+};
+
+/* Connection owned by the thread storage. Deleted on thread exit. */
+class SqlThreadConnection
+{
+public:
+  SqlThreadConnection(const QSharedPointer<SqlConnectionPoolState>& poolState, const QString& connectionName)
+    : state(poolState), name(connectionName)
+  {
+  }
+
+  ~SqlThreadConnection()
+  {
+    if(db != nullptr)
+    {
+      if(db->isOpen())
+        db->close();
+      delete db;
+      SqlDatabase::removeDatabase(name);
+    }
+
+    QMutexLocker locker(&state->mutex);
+    state->numConnections--;
+  }
+
+  QSharedPointer<SqlConnectionPoolState> state;
+  QString name;
+  SqlDatabase *db = nullptr;
+};
+
+SqlConnectionPool::SqlConnectionPool(const QString& filename, int maxConnections, bool enableWal,
+                                     const QStringList& connectionPragmas)
+  : databaseFile(filename), pragmas(connectionPragmas), maxNumConnections(maxConnections),
+  state(new SqlConnectionPoolState)
+{
+  state->poolName = QString("SqlConnectionPool_%1").arg(reinterpret_cast<quintptr>(this), 0, 16);
+
+  if(enableWal)
+  {
+    // Journal mode is persistent in the file and cannot be changed by read only connections
+    QString name = state->poolName + "_wal";
+    {
+      SqlDatabase db = SqlDatabase::addDatabase("QSQLITE", name);
+      db.setDatabaseName(filename);
+      db.setAutomaticTransactions(false);
+      db.open();
+      db.exec("PRAGMA journal_mode=WAL");
+      db.close();
+    }
+    SqlDatabase::removeDatabase(name);
+  }
+}
+
+SqlConnectionPool::~SqlConnectionPool()
+{
+  // Delete connection of the owning thread - others are deleted on thread exit
+  releaseConnection();
+
+  int num = getNumConnections();
+  if(num > 0)
+    qWarning() << Q_FUNC_INFO << num << "connections still in use";
+}
+
+SqlDatabase *SqlConnectionPool::connection()
+{
+  if(connections.hasLocalData())
+    return connections.localData()->db;
+
+  QString name;
+  {
+    QMutexLocker locker(&state->mutex);
+    if(maxNumConnections > 0 && state->numConnections >= maxNumConnections)
+      throw SqlException(QString("Maximum number of %1 connections reached for %2").
+                         arg(maxNumConnections).arg(databaseFile));
+    state->numConnections++;
+    name = QString("%1_%2").arg(state->poolName).arg(state->nextId++);
+  }
+
+  // Counter is decremented when the connection is deleted
+  SqlThreadConnection *threadConnection = new SqlThreadConnection(state, name);
+  try
+  {
+    threadConnection->db = new SqlDatabase(SqlDatabase::addDatabase("QSQLITE", name));
+    threadConnection->db->setDatabaseName(databaseFile);
+    threadConnection->db->setConnectOptions("QSQLITE_OPEN_READONLY");
+    threadConnection->db->setReadonly();
+    threadConnection->db->open(pragmas);
+
+    for(const QString& query : preparedQueries)
+      threadConnection->db->cachedQuery(query);
+  }
+  catch(...)
+  {
+    delete threadConnection;
+    throw;
+  }
+
+  // Thread storage takes ownership
+  connections.setLocalData(threadConnection);
+
+  qDebug() << Q_FUNC_INFO << "Opened" << name << "for thread" << QThread::currentThread();
+  return threadConnection->db;
+}
+
+void SqlConnectionPool::releaseConnection()
+{
+  if(connections.hasLocalData())
+    // Deletes the old connection
+    connections.setLocalData(nullptr);
+}
+
+int SqlConnectionPool::getNumConnections() const
+{
+  QMutexLocker locker(&state->mutex);
+  return state->numConnections;
+}
+
+} // namespace sql
+} // namespace atools
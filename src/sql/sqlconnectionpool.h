@@ -0,0 +1,89 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_SQL_SQLCONNECTIONPOOL_H
+#define ATOOLS_SQL_SQLCONNECTIONPOOL_H
+
+#include <QSharedPointer>
+#include <QStringList>
+#include <QThreadStorage>
+
+namespace atools {
+namespace sql {
+
+class SqlDatabase;
+class SqlConnectionPoolState;
+class SqlThreadConnection;
+
+/*
+ * Hands out read only connections to a SQLite database file with one connection per thread.
+ * Connections are opened on first use in a thread and closed automatically when the thread exits.
+ *
+ * Connections use the statement cache of SqlDatabase. Queries given to setPreparedQueries() are prepared
+ * in the cache of each new connection.
+ *
+ * connection() is thread safe. The pool has to be deleted in the thread that created it and only after all
+ * threads using it have finished. Connections of still running threads are leaked otherwise.
+ */
+class SqlConnectionPool
+{
+public:
+  /* maxConnections limits the number of concurrent threads. 0 means no limit.
+   * Switches the database into WAL mode if enableWal is true which allows reading while another
+   * connection writes. */
+  SqlConnectionPool(const QString& filename, int maxConnections = 8, bool enableWal = true,
+                    const QStringList& connectionPragmas = QStringList());
+  ~SqlConnectionPool();
+
+  SqlConnectionPool(const SqlConnectionPool& other) = delete;
+  SqlConnectionPool& operator=(const SqlConnectionPool& other) = delete;
+
+  /* Connection for the current thread. Opened on first call. Must not be passed to other threads.
+   * Throws SqlException if the maximum number of connections is reached or the database cannot be opened. */
+  atools::sql::SqlDatabase *connection();
+
+  /* Close the connection of the current thread before the thread exits. Does nothing if there is none. */
+  void releaseConnection();
+
+  /* Number of open connections for all threads */
+  int getNumConnections() const;
+
+  /* SQL statements to prepare for each new connection */
+  void setPreparedQueries(const QStringList& queries)
+  {
+    preparedQueries = queries;
+  }
+
+  const QString& getDatabaseFile() const
+  {
+    return databaseFile;
+  }
+
+private:
+  QString databaseFile;
+  QStringList pragmas, preparedQueries;
+  int maxNumConnections;
+
+  /* Shared with the thread connections which can outlive the pool */
+  QSharedPointer<atools::sql::SqlConnectionPoolState> state;
+  QThreadStorage<atools::sql::SqlThreadConnection *> connections;
+};
+
+} // namespace sql
+} // namespace atools
+
+#endif // ATOOLS_SQL_SQLCONNECTIONPOOL_H
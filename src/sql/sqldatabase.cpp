@@ -21,11 +21,45 @@
 #include <QSettings>
 #include <QDebug>
 #include <QFileInfo>
+#include <QHash>
+#include <QMutex>
 
 namespace atools {
 
 namespace sql {
 
+/* Prepared queries for one connection */
+struct SqlQueryCache
+{
+  ~SqlQueryCache()
+  {
+    qDeleteAll(queries);
+  }
+
+  QHash<QString, SqlQuery *> queries;
+  int hits = 0, misses = 0;
+};
+
+/* Caches by connection name. Not part of the SqlDatabase object since queries keep a copy of it. */
+static QHash<QString, SqlQueryCache *> queryCaches;
+static QMutex queryCacheMutex;
+
+/* Remove and delete the cache of a connection */
+static void removeQueryCache(const QString& connectionName)
+{
+  SqlQueryCache *cache = nullptr;
+  {
+    QMutexLocker locker(&queryCacheMutex);
+    cache = queryCaches.take(connectionName);
+  }
+
+  if(cache != nullptr)
+  {
+    qDebug() << "Query cache for" << connectionName << "hits" << cache->hits << "misses" << cache->misses;
+    delete cache;
+  }
+}
+
 SqlDatabase::SqlDatabase()
 {
 }
@@ -123,12 +157,64 @@ void SqlDatabase::open(const QString& user, const QString& password, const QStri
     transactionInternal();
 }
 
+SqlQuery *SqlDatabase::cachedQuery(const QString& sql)
+{
+  SqlQueryCache *cache = nullptr;
+  {
+    QMutexLocker locker(&queryCacheMutex);
+    cache = queryCaches.value(connectionName(), nullptr);
+    if(cache == nullptr)
+    {
+      cache = new SqlQueryCache;
+      queryCaches.insert(connectionName(), cache);
+    }
+  }
+
+  SqlQuery *query = cache->queries.value(sql, nullptr);
+  if(query != nullptr)
+  {
+    cache->hits++;
+    query->finish();
+    query->clearBoundValues();
+  }
+  else
+  {
+    cache->misses++;
+    query = new SqlQuery(this);
+    query->prepare(sql);
+    cache->queries.insert(sql, query);
+  }
+  return query;
+}
+
+void SqlDatabase::clearQueryCache()
+{
+  removeQueryCache(connectionName());
+}
+
+int SqlDatabase::getQueryCacheHits() const
+{
+  QMutexLocker locker(&queryCacheMutex);
+  SqlQueryCache *cache = queryCaches.value(connectionName(), nullptr);
+  return cache != nullptr ? cache->hits : 0;
+}
+
+int SqlDatabase::getQueryCacheMisses() const
+{
+  QMutexLocker locker(&queryCacheMutex);
+  SqlQueryCache *cache = queryCaches.value(connectionName(), nullptr);
+  return cache != nullptr ? cache->misses : 0;
+}
+
 void SqlDatabase::close()
 {
   checkError(isValid(), "Trying to close invalid database");
   checkError(isOpen(), "Closing already closed database");
   if(!readonly && automaticTransactions)
     rollback();
+
+  // Queries have to be deleted before the connection is closed
+  clearQueryCache();
   db.close();
 
   qInfo() << "Closed database" << databaseName();
@@ -187,6 +273,13 @@ void SqlDatabase::vacuum()
   checkError(db.transaction(), "SqlDatabase::detachDatabase() error");
 }
 
+void SqlDatabase::vacuumInto(const QString& filename)
+{
+  checkError(db.rollback(), "SqlDatabase::vacuumInto() error");
+  exec("vacuum into '" + QString(filename).replace("'", "''") + "'");
+  checkError(db.transaction(), "SqlDatabase::vacuumInto() error");
+}
+
 void SqlDatabase::analyze()
 {
   exec("analyze");
@@ -407,6 +500,7 @@ SqlDatabase SqlDatabase::database(const QString& connectionName, bool open)
 
 void SqlDatabase::removeDatabase(const QString& connectionName)
 {
+  removeQueryCache(connectionName);
   QSqlDatabase::removeDatabase(connectionName);
 }
 
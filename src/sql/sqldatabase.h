@@ -154,9 +154,28 @@ public:
   /* Sqlite only. Compresses the database */
   void vacuum();
 
+  /* Sqlite only. Writes a compressed copy of the database into a new file in one sequential pass.
+   * The file must not exist or be empty. Needs SQLite 3.27 or later. */
+  void vacuumInto(const QString& filename);
+
   /* Sqlite only. Gather schema statistics for query optimization. */
   void analyze();
 
+  /*
+   * Get a prepared query from the statement cache of this connection. The query is prepared on
+   * first use. Later calls finish the query and reset all bound values to null.
+   * The query is owned by the cache and valid until close(), removeDatabase() or clearQueryCache().
+   * Cached queries must only be used in the thread of the connection.
+   */
+  atools::sql::SqlQuery *cachedQuery(const QString& sql);
+
+  /* Delete all cached queries of this connection */
+  void clearQueryCache();
+
+  /* Statistics for the statement cache of this connection */
+  int getQueryCacheHits() const;
+  int getQueryCacheMisses() const;
+
   bool isAutomaticTransactions() const
   {
     return automaticTransactions;
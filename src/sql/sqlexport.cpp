@@ -17,7 +17,7 @@
 
 #include "sql/sqlexport.h"
 
-#include <QRegularExpression>
+#include <QTextStream>
 
 namespace atools {
 
@@ -72,15 +72,25 @@ QString SqlExport::getResultSetRow(const QVariantList& values) const
   return retval;
 }
 
-QString SqlExport::buildString(QString value) const
+bool SqlExport::needsEscape(const QString& value) const
 {
-  static const QRegularExpression WHITESPACE("^\\s+$");
+  // Surround the string with " if any special characters or separator are found or if it consists of whitespace only
+  bool whitespaceOnly = !value.isEmpty();
+  for(const QChar& c : value)
+  {
+    if(c == separator || c == escapeString || c == QChar::LineFeed || c == QChar::CarriageReturn)
+      return true;
+
+    whitespaceOnly &= c.isSpace();
+  }
+  return whitespaceOnly;
+}
 
+QString SqlExport::buildString(QString value) const
+{
   QString retval = value;
 
-  // Surround the string with " if any special characters or separator are found
-  if(value.contains(separator) || value.contains(escapeString) || value.contains(QChar::LineFeed) ||
-     value.contains(QChar::CarriageReturn) || WHITESPACE.match(value).hasMatch())
+  if(needsEscape(value))
   {
     // Escape any escapes inside the string
     retval.replace(QString(escapeString), QString(escapeString) + QString(escapeString));
@@ -114,6 +124,123 @@ QString SqlExport::printValue(QVariant value) const
   return retval;
 }
 
+void SqlExport::writeValue(QTextStream& out, const QVariant& value) const
+{
+  if(!value.isValid() && !value.isNull())
+    out << "[INVALID_VALUE]";
+  else if(value.isNull())
+    out << nullValue;
+  else
+  {
+    if(value.type() == QVariant::Double)
+      out << value.toDouble();
+    else if(value.canConvert(QVariant::String))
+    {
+      scratch = value.toString();
+      if(needsEscape(scratch))
+      {
+        // Escape any escapes inside the string
+        scratch.replace(escapeString, QString(escapeString) + QString(escapeString));
+        out << escapeString << scratch << escapeString;
+      }
+      else
+        out << scratch;
+    }
+    else
+      out << "[CANNOT_CONVERT_VALUE:" << value.typeName() << "]";
+  }
+}
+
+void SqlExport::writeResultSetHeader(QTextStream& out, const SqlRecord& record) const
+{
+  for(int i = 0; i < record.count(); i++)
+  {
+    if(i > 0)
+    {
+      out << separator;
+      out << buildString(record.fieldName(i));
+    }
+    else
+      out << record.fieldName(i);
+  }
+
+  if(endline)
+    out << "\n";
+}
+
+void SqlExport::writeResultSetRow(QTextStream& out, const SqlRecord& record) const
+{
+  QTextStream::RealNumberNotation notation = out.realNumberNotation();
+  int precision = out.realNumberPrecision();
+  out.setRealNumberNotation(QTextStream::FixedNotation);
+  out.setRealNumberPrecision(numberPrecision);
+
+  for(int i = 0; i < record.count(); i++)
+  {
+    if(i > 0)
+      out << separator;
+    writeValue(out, record.value(i));
+  }
+
+  if(endline)
+    out << "\n";
+
+  out.setRealNumberNotation(notation);
+  out.setRealNumberPrecision(precision);
+}
+
+void SqlExport::writeResultSetRow(QTextStream& out, const SqlQuery& query, int numColumns) const
+{
+  for(int i = 0; i < numColumns; i++)
+  {
+    if(i > 0)
+      out << separator;
+    writeValue(out, query.value(i));
+  }
+
+  if(endline)
+    out << "\n";
+}
+
+int SqlExport::exportResultSet(SqlQuery& query, QTextStream& out) const
+{
+  QTextStream::RealNumberNotation notation = out.realNumberNotation();
+  int precision = out.realNumberPrecision();
+  out.setRealNumberNotation(QTextStream::FixedNotation);
+  out.setRealNumberPrecision(numberPrecision);
+
+  int numColumns = -1, numRows = 0;
+  while(query.next())
+  {
+    if(numColumns == -1)
+    {
+      // Get record only once for header and column count
+      SqlRecord record = query.record();
+      numColumns = record.count();
+      if(header)
+        writeResultSetHeader(out, record);
+    }
+
+    if(numRows >= maxValues && maxValues != -1)
+      break;
+
+    writeResultSetRow(out, query, numColumns);
+    numRows++;
+  }
+
+  out.setRealNumberNotation(notation);
+  out.setRealNumberPrecision(precision);
+  out.flush();
+  return numRows;
+}
+
+int SqlExport::exportResultSet(SqlQuery& query, QIODevice& device) const
+{
+  QTextStream out(&device);
+  out.setCodec("UTF-8");
+  return exportResultSet(query, out);
+}
+
 QString SqlExport::printEndl() const
 {
   if(endline)
@@ -22,6 +22,9 @@
 
 #include <QString>
 
+class QIODevice;
+class QTextStream;
+
 namespace atools {
 namespace sql {
 
@@ -103,6 +106,24 @@ public:
   /* Build a data row from the given QVariant list */
   QString getResultSetRow(const QVariantList& values) const;
 
+  /* Streaming methods which write directly into the stream without building a string for each row.
+   * Nothing is flushed. Use "\n" instead of endl in the caller to keep the stream buffering. */
+  void writeResultSetHeader(QTextStream& out, const SqlRecord& record) const;
+  void writeResultSetRow(QTextStream& out, const SqlRecord& record) const;
+
+  /* Write the current row of the query reading values by index */
+  void writeResultSetRow(QTextStream& out, const SqlQuery& query, int numColumns) const;
+
+  /*
+   * Writes the full result set of an executed query including header if enabled.
+   * Runs in constant memory independent of the number of rows. Stream is flushed at the end.
+   * @return number of rows written
+   */
+  int exportResultSet(SqlQuery& query, QTextStream& out) const;
+
+  /* As above using a UTF-8 text stream on the open device */
+  int exportResultSet(SqlQuery& query, QIODevice& device) const;
+
   int getNumberPrecision() const;
 
   void setNumberPrecision(int value)
@@ -114,6 +135,11 @@ private:
   QString printEndl() const;
   QString buildString(QString value) const;
   QString printValue(QVariant value) const;
+  void writeValue(QTextStream& out, const QVariant& value) const;
+  bool needsEscape(const QString& value) const;
+
+  /* Reused in writeValue to avoid allocations for each escaped value */
+  mutable QString scratch;
 
   bool endline = true, header = true;
   int maxValues = -1;
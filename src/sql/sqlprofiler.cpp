@@ -0,0 +1,95 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "sql/sqlprofiler.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
+
+namespace atools {
+namespace sql {
+
+QAtomicInt SqlProfiler::enabled(0);
+
+/* Keyed by raw statement text which avoids normalization for each call */
+static QHash<QString, SqlProfileEntry> profileEntries;
+static QMutex profileMutex;
+
+void SqlProfiler::setEnabled(bool value)
+{
+  enabled.store(value ? 1 : 0);
+}
+
+void SqlProfiler::addExec(const QString& statement, qint64 nanoseconds, int rowsAffected)
+{
+  QMutexLocker locker(&profileMutex);
+  SqlProfileEntry& entry = profileEntries[statement];
+  entry.calls++;
+  entry.nanoseconds += nanoseconds;
+  if(rowsAffected > 0)
+    entry.rowsAffected += rowsAffected;
+}
+
+void SqlProfiler::addNext(const QString& statement, qint64 nanoseconds, bool hasRow)
+{
+  QMutexLocker locker(&profileMutex);
+  SqlProfileEntry& entry = profileEntries[statement];
+  entry.nanoseconds += nanoseconds;
+  if(hasRow)
+    entry.rowsReturned++;
+}
+
+QVector<SqlProfileEntry> SqlProfiler::getEntries()
+{
+  QHash<QString, SqlProfileEntry> merged;
+  {
+    QMutexLocker locker(&profileMutex);
+    for(auto it = profileEntries.constBegin(); it != profileEntries.constEnd(); ++it)
+    {
+      // Normalize whitespace and line breaks so that the same statement from different sources is merged
+      QString normalized = it.key().simplified();
+      SqlProfileEntry& entry = merged[normalized];
+      entry.statement = normalized;
+      entry.calls += it.value().calls;
+      entry.nanoseconds += it.value().nanoseconds;
+      entry.rowsReturned += it.value().rowsReturned;
+      entry.rowsAffected += it.value().rowsAffected;
+    }
+  }
+
+  QVector<SqlProfileEntry> retval;
+  for(const SqlProfileEntry& entry : merged)
+    retval.append(entry);
+
+  std::sort(retval.begin(), retval.end(), [](const SqlProfileEntry& e1, const SqlProfileEntry& e2) -> bool
+        {
+          return e1.nanoseconds > e2.nanoseconds;
+        });
+  return retval;
+}
+
+void SqlProfiler::reset()
+{
+  QMutexLocker locker(&profileMutex);
+  profileEntries.clear();
+}
+
+} // namespace sql
+} // namespace atools
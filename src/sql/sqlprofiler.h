@@ -0,0 +1,71 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_SQL_SQLPROFILER_H
+#define ATOOLS_SQL_SQLPROFILER_H
+
+#include <QAtomicInt>
+#include <QString>
+#include <QVector>
+
+namespace atools {
+namespace sql {
+
+/* Aggregated values for one normalized statement */
+struct SqlProfileEntry
+{
+  QString statement;
+  qint64 calls = 0, nanoseconds = 0, rowsReturned = 0, rowsAffected = 0;
+};
+
+/*
+ * Statement level profiler for SqlQuery. Collects call count, time, rows returned by next() and rows
+ * affected by exec() for each statement. Disabled by default. Costs only an atomic read per call if disabled.
+ *
+ * Thread safe. Statistics are collected for all database connections.
+ */
+class SqlProfiler
+{
+public:
+  /* Runtime switch. Does not clear collected values. */
+  static void setEnabled(bool value);
+
+  static bool isEnabled()
+  {
+    return enabled.load() != 0;
+  }
+
+  /* Called by SqlQuery after exec() or execBatch() */
+  static void addExec(const QString& statement, qint64 nanoseconds, int rowsAffected);
+
+  /* Called by SqlQuery after next() */
+  static void addNext(const QString& statement, qint64 nanoseconds, bool hasRow);
+
+  /* Get statistics merged by normalized statement text and sorted by total time descending */
+  static QVector<atools::sql::SqlProfileEntry> getEntries();
+
+  /* Remove all collected values */
+  static void reset();
+
+private:
+  static QAtomicInt enabled;
+};
+
+} // namespace sql
+} // namespace atools
+
+#endif // ATOOLS_SQL_SQLPROFILER_H
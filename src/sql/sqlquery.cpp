@@ -20,7 +20,9 @@
 #include "sql/sqldatabase.h"
 
 #include "sql/sqlrecord.h"
+#include "sql/sqlprofiler.h"
 
+#include <QElapsedTimer>
 #include <QSqlError>
 
 namespace atools {
@@ -66,6 +68,8 @@ SqlQuery::SqlQuery(const SqlQuery& other)
 {
   this->query = other.query;
   this->queryString = other.queryString;
+  this->placeholderIndexMap = other.placeholderIndexMap;
+  this->placeholdersResolved = other.placeholdersResolved;
   this->db = new SqlDatabase(*other.db);
 
 }
@@ -81,6 +85,8 @@ SqlQuery& SqlQuery::operator=(const SqlQuery& other)
 {
   this->query = other.query;
   this->queryString = other.queryString;
+  this->placeholderIndexMap = other.placeholderIndexMap;
+  this->placeholdersResolved = other.placeholdersResolved;
 
   delete db;
   this->db = new SqlDatabase(*other.db);
@@ -105,10 +111,13 @@ bool SqlQuery::isActive() const
 
 bool SqlQuery::isNull(int field) const
 {
-  checkError(isValid(), "SqlQuery::isNull() on invalid query");
-  checkError(isActive(), "SqlQuery::isNull() on inactive query");
+  if(!query.isValid())
+    checkError(false, "SqlQuery::isNull() on invalid query");
+  if(!query.isActive())
+    checkError(false, "SqlQuery::isNull() on inactive query");
 
-  if(field >= query.record().count())
+  // Avoid building a record object for each call
+  if(!query.value(field).isValid())
     throw SqlException("SqlQuery::isNull(): Value index " +
                        QString::number(field) + " does not exist in query \"" + queryString + "\"");
 
@@ -197,7 +206,16 @@ void SqlQuery::setForwardOnly(bool forward)
 void SqlQuery::exec(const QString& queryStr)
 {
   this->queryString = queryStr;
-  checkError(query.exec(queryStr), "SqlQuery::exec(): Error executing query");
+
+  if(SqlProfiler::isEnabled())
+  {
+    QElapsedTimer timer;
+    timer.start();
+    checkError(query.exec(queryStr), "SqlQuery::exec(): Error executing query");
+    SqlProfiler::addExec(queryStr, timer.nsecsElapsed(), query.numRowsAffected());
+  }
+  else
+    checkError(query.exec(queryStr), "SqlQuery::exec(): Error executing query");
 
   if(db->isAutocommit())
     db->commit();
@@ -205,8 +223,12 @@ void SqlQuery::exec(const QString& queryStr)
 
 QVariant SqlQuery::value(int i) const
 {
-  checkError(isValid(), "SqlQuery::value() on invalid query");
-  checkError(isActive(), "SqlQuery::value() on inactive query");
+  // Check state first to avoid copying the error object and building messages for each call
+  if(!query.isValid())
+    checkError(false, "SqlQuery::value() on invalid query");
+  if(!query.isActive())
+    checkError(false, "SqlQuery::value() on inactive query");
+
   QVariant retval = query.value(i);
   if(!retval.isValid())
     throw SqlException("SqlQuery::value(): Value index " + QString::number(
@@ -216,8 +238,10 @@ QVariant SqlQuery::value(int i) const
 
 QVariant SqlQuery::value(const QString& name) const
 {
-  checkError(isValid(), "SqlQuery::value() on invalid query");
-  checkError(isActive(), "SqlQuery::value() on inactive query");
+  if(!query.isValid())
+    checkError(false, "SqlQuery::value() on invalid query");
+  if(!query.isActive())
+    checkError(false, "SqlQuery::value() on inactive query");
   QVariant retval = query.value(name);
   if(!retval.isValid())
     throw SqlException(
@@ -225,6 +249,34 @@ QVariant SqlQuery::value(const QString& name) const
   return retval;
 }
 
+int SqlQuery::columnIndex(const QString& name) const
+{
+  checkError(isActive(), "SqlQuery::columnIndex() on inactive query");
+
+  int idx = query.record().indexOf(name);
+  if(idx == -1)
+    throw SqlException(
+            "SqlQuery::columnIndex(): Value name \"" + name + "\" does not exist in query \"" + queryString + "\"");
+  return idx;
+}
+
+QVector<int> SqlQuery::columnIndexes(const QStringList& names) const
+{
+  checkError(isActive(), "SqlQuery::columnIndexes() on inactive query");
+
+  QSqlRecord rec = query.record();
+  QVector<int> indexes;
+  for(const QString& name : names)
+  {
+    int idx = rec.indexOf(name);
+    if(idx == -1)
+      throw SqlException(
+              "SqlQuery::columnIndexes(): Value name \"" + name + "\" does not exist in query \"" + queryString + "\"");
+    indexes.append(idx);
+  }
+  return indexes;
+}
+
 bool SqlQuery::hasField(const QString& name) const
 {
   checkError(isValid(), "SqlQuery::hasField() on invalid query");
@@ -251,9 +303,22 @@ bool SqlQuery::seek(int i, bool relative)
 
 bool SqlQuery::next()
 {
-  checkError(isSelect(), "SqlQuery::next() on query which is not a select");
-  checkError(isActive(), "SqlQuery::next() on inactive query");
-  return query.next();
+  // Check state first to avoid copying the error object and building messages for each call
+  if(!query.isSelect())
+    checkError(false, "SqlQuery::next() on query which is not a select");
+  if(!query.isActive())
+    checkError(false, "SqlQuery::next() on inactive query");
+
+  if(SqlProfiler::isEnabled())
+  {
+    QElapsedTimer timer;
+    timer.start();
+    bool hasRow = query.next();
+    SqlProfiler::addNext(profileStatement(), timer.nsecsElapsed(), hasRow);
+    return hasRow;
+  }
+  else
+    return query.next();
 }
 
 bool SqlQuery::previous()
@@ -296,14 +361,31 @@ void SqlQuery::clearBoundValues()
 
 void SqlQuery::exec()
 {
-  checkError(query.exec(), "SqlQuery::exec(): Error executing query");
+  if(SqlProfiler::isEnabled())
+  {
+    QElapsedTimer timer;
+    timer.start();
+    checkError(query.exec(), "SqlQuery::exec(): Error executing query");
+    SqlProfiler::addExec(profileStatement(), timer.nsecsElapsed(), query.numRowsAffected());
+  }
+  else
+    checkError(query.exec(), "SqlQuery::exec(): Error executing query");
+
   if(db->isAutocommit())
     db->commit();
 }
 
 void SqlQuery::execBatch(QSqlQuery::BatchExecutionMode mode)
 {
-  checkError(query.execBatch(mode), "SqlQuery::execBatch(): Error executing query batch");
+  if(SqlProfiler::isEnabled())
+  {
+    QElapsedTimer timer;
+    timer.start();
+    checkError(query.execBatch(mode), "SqlQuery::execBatch(): Error executing query batch");
+    SqlProfiler::addExec(profileStatement(), timer.nsecsElapsed(), query.numRowsAffected());
+  }
+  else
+    checkError(query.execBatch(mode), "SqlQuery::execBatch(): Error executing query batch");
 
   if(db->isAutocommit())
     db->commit();
@@ -312,6 +394,8 @@ void SqlQuery::execBatch(QSqlQuery::BatchExecutionMode mode)
 void SqlQuery::prepare(const QString& queryStr)
 {
   this->queryString = queryStr;
+  placeholderIndexMap.clear();
+  placeholdersResolved = false;
   checkError(query.prepare(queryStr), "SqlQuery::prepare(): Error executing prepare");
 }
 
@@ -350,16 +434,111 @@ void SqlQuery::bindRecord(const SqlRecord& record)
     bindValue(record.fieldName(i), record.value(i));
 }
 
+void SqlQuery::bindRecord(const SqlRecord& record, const QVector<int>& indexes)
+{
+  for(int i = 0; i < record.count(); i++)
+    bindValue(indexes.at(i), record.value(i));
+}
+
 void SqlQuery::bindAndExecRecords(const SqlRecordVector& records)
 {
+  QVector<int> indexes;
+  QStringList fieldNames;
   for(const SqlRecord& record:records)
   {
-    bindRecord(record);
+    // Resolve placeholders again only if the record layout changes
+    bool sameFields = record.count() == fieldNames.size();
+    for(int i = 0; sameFields && i < record.count(); i++)
+      sameFields = record.fieldName(i) == fieldNames.at(i);
+
+    if(!sameFields)
+    {
+      indexes = placeholderIndexes(record);
+      fieldNames = record.fieldNames();
+    }
+
+    bindRecord(record, indexes);
     exec();
     clearBoundValues();
   }
 }
 
+const QHash<QString, int>& SqlQuery::getPlaceholderIndexes() const
+{
+  if(!placeholdersResolved)
+  {
+    // Named placeholders are numbered in order of appearance like done by Qt for drivers
+    // without native named placeholder support like SQLite
+    int pos = 0;
+    QChar quote;
+    for(int i = 0; i < queryString.size(); i++)
+    {
+      QChar c = queryString.at(i);
+      if(!quote.isNull())
+      {
+        // Skip string literals and quoted identifiers
+        if(c == quote)
+          quote = QChar();
+      }
+      else if(c == '\'' || c == '"')
+        quote = c;
+      else if(c == '-' && i + 1 < queryString.size() && queryString.at(i + 1) == '-')
+      {
+        // Skip line comment
+        int end = queryString.indexOf('\n', i + 2);
+        i = end == -1 ? queryString.size() : end;
+      }
+      else if(c == '/' && i + 1 < queryString.size() && queryString.at(i + 1) == '*')
+      {
+        // Skip block comment
+        int end = queryString.indexOf("*/", i + 2);
+        i = end == -1 ? queryString.size() : end + 1;
+      }
+      else if(c == '?')
+        pos++;
+      else if(c == ':' && i + 1 < queryString.size() &&
+              (queryString.at(i + 1).isLetterOrNumber() || queryString.at(i + 1) == '_'))
+      {
+        int end = i + 1;
+        while(end < queryString.size() &&
+              (queryString.at(end).isLetterOrNumber() || queryString.at(end) == '_'))
+          end++;
+
+        QString name = queryString.mid(i, end - i);
+        if(placeholderIndexMap.contains(name))
+          placeholderIndexMap.insert(name, -1);
+        else
+          placeholderIndexMap.insert(name, pos);
+        pos++;
+        i = end - 1;
+      }
+    }
+    placeholdersResolved = true;
+  }
+  return placeholderIndexMap;
+}
+
+int SqlQuery::placeholderIndex(const QString& placeholder) const
+{
+  int idx = getPlaceholderIndexes().value(placeholder, -2);
+
+  if(idx == -2)
+    throw SqlException("SqlQuery::placeholderIndex(): Bind name \"" + placeholder +
+                       "\" does not exist in query \"" + queryString + "\"");
+  else if(idx == -1)
+    throw SqlException("SqlQuery::placeholderIndex(): Bind name \"" + placeholder +
+                       "\" is used more than once in query \"" + queryString + "\"");
+  return idx;
+}
+
+QVector<int> SqlQuery::placeholderIndexes(const SqlRecord& record) const
+{
+  QVector<int> indexes;
+  for(int i = 0; i < record.count(); i++)
+    indexes.append(placeholderIndex(record.fieldName(i)));
+  return indexes;
+}
+
 void SqlQuery::bindAndExecRecord(const SqlRecord& record)
 {
   bindRecord(record);
@@ -413,6 +592,12 @@ bool SqlQuery::nextResult()
   return query.nextResult();
 }
 
+QString SqlQuery::profileStatement() const
+{
+  // Query string is empty if created from a QSqlResult
+  return queryString.isEmpty() ? query.lastQuery() : queryString;
+}
+
 QString SqlQuery::boundValuesAsString() const
 {
   QMap<QString, QVariant> boundValues = query.boundValues();
@@ -20,6 +20,7 @@
 
 #include "sql/sqlrecord.h"
 
+#include <QHash>
 #include <QSqlQuery>
 #include <QSqlResult>
 #include <QString>
@@ -74,6 +75,13 @@ public:
   QVariant value(const QString& name) const;
   bool hasField(const QString& name) const;
 
+  /* Get the column index for a field name of the active result set. Resolve once after exec() and use the
+   * index based getters in loops to avoid a field lookup per call. Throws exception if name does not exist. */
+  int columnIndex(const QString& name) const;
+
+  /* Get column indexes for all names in the same order. Throws exception if a name does not exist. */
+  QVector<int> columnIndexes(const QStringList& names) const;
+
   /* Typed getters. Throw exception if value does not exist as field. */
   QString valueStr(int i) const
   {
@@ -180,6 +188,22 @@ public:
 
   void bindRecord(const atools::sql::SqlRecord& record);
 
+  /* Binds all record values by the positional indexes returned by placeholderIndexes() for a record
+   * having the same fields. Avoids placeholder name lookups when binding many records. */
+  void bindRecord(const atools::sql::SqlRecord& record, const QVector<int>& indexes);
+
+  /* Get the positional index of a named placeholder like ":ident" in the prepared query.
+   * Resolve once after prepare and bind by index in loops using bindValue(int pos, ...).
+   * Throws SqlException if the placeholder does not exist or is used more than once in the query. */
+  int placeholderIndex(const QString& placeholder) const;
+
+  /* Get positional indexes for all fields of the record which are used as placeholder names */
+  QVector<int> placeholderIndexes(const atools::sql::SqlRecord& record) const;
+
+  /* Get all named placeholders of the prepared query mapped to their positional index.
+   * Placeholders used more than once in the query have an index of -1. String literals and comments are skipped. */
+  const QHash<QString, int>& getPlaceholderIndexes() const;
+
   void bindAndExecRecords(const atools::sql::SqlRecordVector& records);
   void bindAndExecRecord(const SqlRecord& record);
 
@@ -217,6 +241,13 @@ private:
   SqlDatabase *db = nullptr;
   QString boundValuesAsString() const;
 
+  /* Statement text used as key for SqlProfiler */
+  QString profileStatement() const;
+
+  /* Filled on demand from the query string */
+  mutable QHash<QString, int> placeholderIndexMap;
+  mutable bool placeholdersResolved = false;
+
 };
 
 } // namespace sql
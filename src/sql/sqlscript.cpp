@@ -17,6 +17,7 @@
 
 #include "sql/sqlexception.h"
 #include "sql/sqlscript.h"
+#include "util/tracerecorder.h"
 
 #include <QDebug>
 #include <QFile>
@@ -26,6 +27,9 @@ namespace atools {
 
 namespace sql {
 
+QHash<QString, QList<SqlScript::ScriptCmd> > SqlScript::resourceScriptCache;
+QMutex SqlScript::resourceScriptMutex;
+
 SqlScript::SqlScript(SqlDatabase *sqlDb, bool verboseLogging)
   : db(sqlDb), verbose(verboseLogging)
 {
@@ -39,6 +43,35 @@ SqlScript::SqlScript(SqlDatabase& sqlDb, bool verboseLogging)
 
 void SqlScript::executeScript(const QString& filename)
 {
+  ATOOLS_TRACE_SPAN("SqlScript::executeScript", "sql", filename);
+
+  bool resource = filename.startsWith(":/");
+  if(resource)
+  {
+    QList<ScriptCmd> statements;
+    bool found = false;
+    {
+      QMutexLocker locker(&resourceScriptMutex);
+      auto it = resourceScriptCache.constFind(filename);
+      if(it != resourceScriptCache.constEnd())
+      {
+        statements = it.value();
+        found = true;
+      }
+    }
+
+    if(found)
+    {
+      if(verbose)
+      {
+        qDebug() << "-- Running script ------------------------------------------";
+        qDebug() << "--" << filename << "-- (cached)";
+      }
+      executeStatements(statements);
+      return;
+    }
+  }
+
   QFile scriptFile(filename);
   if(scriptFile.open(QIODevice::Text | QIODevice::ReadOnly))
   {
@@ -49,7 +82,16 @@ void SqlScript::executeScript(const QString& filename)
       qDebug() << "-- Running script ------------------------------------------";
       qDebug() << "--" << scriptFile.fileName() << "--";
     }
-    executeScript(scriptStream);
+
+    QList<ScriptCmd> statements;
+    parseSqlScript(scriptStream, statements);
+
+    if(resource)
+    {
+      QMutexLocker locker(&resourceScriptMutex);
+      resourceScriptCache.insert(filename, statements);
+    }
+    executeStatements(statements);
   }
   else
     throw SqlException(
@@ -62,13 +104,21 @@ void SqlScript::executeScript(QTextStream& script)
 {
   QList<ScriptCmd> statements;
   parseSqlScript(script, statements);
+  executeStatements(statements);
+}
 
+void SqlScript::executeStatements(const QList<ScriptCmd>& statements)
+{
   SqlQuery query(db);
-  for(ScriptCmd cmd : statements)
+  for(const ScriptCmd& cmd : statements)
   {
     if(verbose)
       qDebug().nospace() << cmd.lineNumber << ": " << QString(cmd.sql).replace('\n', ' ');
     query.exec(cmd.sql);
+
+    if(!query.isSelect() && query.numRowsAffected() > 0)
+      numRowsAffected += query.numRowsAffected();
+
     if(verbose)
     {
       qDebug().nospace() << "[" << query.numRowsAffected() << "]";
@@ -20,6 +20,9 @@
 
 #include "sql/sqldatabase.h"
 
+#include <QHash>
+#include <QMutex>
+
 class QTextStream;
 
 namespace atools {
@@ -35,6 +38,9 @@ namespace sql {
  * is thrown in case of error.
  *
  * Complex SQL as Oracle PL/SQL is not supported.
+ *
+ * Scripts from Qt resources (":/" prefix) are parsed only once and the statements are shared by all instances
+ * in all threads.
  */
 class SqlScript
 {
@@ -51,6 +57,12 @@ public:
   /* Read script from stream and execute it */
   void executeScript(QTextStream& script);
 
+  /* Sum of rows affected by all statements executed so far */
+  int getNumRowsAffected() const
+  {
+    return numRowsAffected;
+  }
+
 private:
   struct ScriptCmd
   {
@@ -61,8 +73,16 @@ private:
   /* Extract line number / SQL statement pairs from the script */
   void parseSqlScript(QTextStream& script, QList<ScriptCmd>& statements);
 
+  /* Run all parsed statements */
+  void executeStatements(const QList<ScriptCmd>& statements);
+
+  /* Parsed statements of resource scripts which cannot change at runtime */
+  static QHash<QString, QList<ScriptCmd> > resourceScriptCache;
+  static QMutex resourceScriptMutex;
+
   SqlDatabase *db;
   bool verbose = true;
+  int numRowsAffected = 0;
 };
 
 } // namespace sql
@@ -16,6 +16,8 @@
 *****************************************************************************/
 
 #include "sql/sqlutil.h"
+#include "sql/sqlprofiler.h"
+#include "sql/sqltransaction.h"
 
 #include <QDebug>
 #include <QString>
@@ -141,18 +143,49 @@ void SqlUtil::copyRowValuesInternal(const SqlQuery& from, SqlQuery& to,
   }
 }
 
+SqlUtil::CopyColumns SqlUtil::copyColumns(const SqlRecord& fromRec, const SqlQuery& to)
+{
+  CopyColumns columns;
+  const QHash<QString, int>& placeholders = to.getPlaceholderIndexes();
+
+  for(int i = 0; i < fromRec.count(); i++)
+  {
+    QString bind = ":" + fromRec.fieldName(i);
+    int pos = placeholders.value(bind, -2);
+    if(pos >= 0)
+      columns.positional.append(std::make_pair(i, pos));
+    else if(pos == -1)
+      // Placeholder is used more than once - bind by name to fill all occurences
+      columns.named.append(std::make_pair(i, bind));
+  }
+  return columns;
+}
+
+void SqlUtil::copyRowValuesInternal(const SqlQuery& from, SqlQuery& to, const CopyColumns& columns)
+{
+  for(const std::pair<int, int>& col : columns.positional)
+    to.bindValue(col.second, from.value(col.first));
+
+  for(const std::pair<int, QString>& col : columns.named)
+    to.bindValue(col.second, from.value(col.first));
+}
+
 int SqlUtil::copyResultValues(SqlQuery& from, SqlQuery& to, std::function<bool(SqlQuery&, SqlQuery &)> func)
 {
   int copied = 0;
-  SqlRecord fromRec;
-  QMap<QString, QVariant> bound = to.boundValues();
+  CopyColumns columns;
+  bool columnsResolved = false;
 
   while(from.next())
   {
-    if(fromRec.isEmpty())
-      fromRec = from.record();
+    if(!columnsResolved)
+    {
+      // Resolve column to bind position mapping only once for all rows
+      columns = copyColumns(from.record(), to);
+      columnsResolved = true;
+    }
 
-    copyRowValuesInternal(from, to, fromRec, bound);
+    copyRowValuesInternal(from, to, columns);
 
     if(func(from, to))
     {
@@ -169,23 +202,10 @@ int SqlUtil::copyResultValues(SqlQuery& from, SqlQuery& to, std::function<bool(S
 
 int SqlUtil::copyResultValues(SqlQuery& from, SqlQuery& to)
 {
-  int copied = 0;
-  SqlRecord fromRec;
-  QMap<QString, QVariant> bound = to.boundValues();
-  while(from.next())
-  {
-    if(fromRec.isEmpty())
-      fromRec = from.record();
-
-    copyRowValuesInternal(from, to, fromRec, bound);
-    to.exec();
-    if(to.numRowsAffected() != 1)
-      throw SqlException("Error executing statement in Utility::copyResultValues(). "
-                         "Number of inserted rows not 1. "
-                         "(SQL \"" + to.lastQuery() + "\")");
-    copied++;
-  }
-  return copied;
+  return copyResultValues(from, to, [](SqlQuery&, SqlQuery&) -> bool
+        {
+          return true;
+        });
 }
 
 void SqlUtil::updateColumnInTable(const QString& table, const QString& idColum, const QStringList& queryColumns,
@@ -228,6 +248,84 @@ void SqlUtil::updateColumnInTable(const QString& table, const QString& idColum,
 
 }
 
+void SqlUtil::updateColumnInTableBulk(const QString& table, const QString& idColum, const QStringList& queryColumns,
+                                      const QStringList& insertcolumns, UpdateColFuncType func)
+{
+  updateColumnInTableBulk(table, idColum, queryColumns, insertcolumns, QString(), func);
+}
+
+void SqlUtil::updateColumnInTableBulk(const QString& table, const QString& idColum, const QStringList& queryColumns,
+                                      const QStringList& insertcolumns, const QString& whereClause,
+                                      UpdateColFuncType func)
+{
+  SqlTransaction transaction(db);
+  SqlUtil util(db);
+  QString tempTable = "temp_update_" + table;
+
+  // Collect calculated values keyed by id - no types needed since affinity of the target columns is applied on update
+  SqlQuery query(db);
+  query.exec("drop table if exists temp." + tempTable);
+  query.exec("create temp table " + tempTable + " (" + idColum + " primary key, " + insertcolumns.join(", ") + ")");
+
+  QStringList queryCols(queryColumns);
+  queryCols.append(idColum);
+
+  // Calculate values only for rows matching the filter
+  QString selectStr = util.buildSelectStatement(table, queryCols);
+  if(!whereClause.isEmpty())
+    selectStr += " where " + whereClause;
+  SqlQuery select(selectStr, db);
+
+  QStringList bindCols;
+  for(const QString& ic : insertcolumns)
+    bindCols.append(":" + ic);
+
+  SqlQuery insert(db);
+  insert.prepare("insert into temp." + tempTable + " (" + idColum + ", " + insertcolumns.join(", ") + ") "
+                 "values (:" + idColum + ", " + bindCols.join(", ") + ")");
+
+  select.exec();
+  int idIndex = select.columnIndex(idColum);
+  while(select.next())
+  {
+    if(func(select, insert))
+    {
+      insert.bindValue(":" + idColum, select.value(idIndex));
+      insert.exec();
+    }
+  }
+
+  // Apply all values with one statement - correlated sub queries since update from is not supported by older SQLite
+  QStringList setCols;
+  for(const QString& ic : insertcolumns)
+    setCols.append(ic + " = (select t." + ic + " from temp." + tempTable + " t where t." + idColum + " = " +
+                   table + "." + idColum + ")");
+
+  query.exec("update " + table + " set " + setCols.join(", ") +
+             " where " + idColum + " in (select " + idColum + " from temp." + tempTable + ")");
+  query.exec("drop table temp." + tempTable);
+  transaction.commit();
+}
+
+void SqlUtil::printQueryProfile(QDebug& out, int maxEntries)
+{
+  QDebugStateSaver saver(out);
+  out.noquote().nospace();
+
+  QVector<SqlProfileEntry> entries = SqlProfiler::getEntries();
+  out << "Query profile (total ms / calls / rows returned / rows affected / statement):" << endl;
+
+  int num = 0;
+  for(const SqlProfileEntry& entry : entries)
+  {
+    if(maxEntries != -1 && num++ >= maxEntries)
+      break;
+
+    out << (entry.nanoseconds / 1000000) << " / " << entry.calls << " / " << entry.rowsReturned << " / "
+        << entry.rowsAffected << " / " << entry.statement << endl;
+  }
+}
+
 void SqlUtil::printTableStats(QDebug& out, const QStringList& tables)
 {
   QDebugStateSaver saver(out);
@@ -264,12 +362,13 @@ void SqlUtil::printTableStats(QDebug& out, const QStringList& tables)
   out << "Total" << ": " << totalCount << " rows" << endl;
 }
 
-void SqlUtil::createColumnReport(QDebug& out, const QStringList& tables)
+void SqlUtil::createColumnReport(QDebug& out, const QStringList& tables, bool printHeader)
 {
   QDebugStateSaver saver(out);
   out.noquote().nospace();
 
-  out << "Column value report for database:" << endl;
+  if(printHeader)
+    out << "Column value report for database:" << endl;
 
   QStringList tableList = buildTableList(tables);
 
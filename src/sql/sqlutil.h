@@ -45,7 +45,12 @@ public:
    */
   void printTableStats(QDebug& out, const QStringList& tables = QStringList());
 
-  void createColumnReport(QDebug& out, const QStringList& tables = QStringList());
+  /* Print statements collected by SqlProfiler ordered by total time. Prints all if maxEntries is -1. */
+  static void printQueryProfile(QDebug& out, int maxEntries = 50);
+
+  /* Print columns having less than two distinct values. Header line can be omitted if a report is
+   * assembled from several calls. */
+  void createColumnReport(QDebug& out, const QStringList& tables = QStringList(), bool printHeader = true);
   void reportDuplicates(QDebug& out, const QString& table, const QString& idColumn,
                         const QStringList& identityColumns);
 
@@ -110,14 +115,33 @@ public:
   void updateColumnInTable(const QString& table, const QString& idColum, const QStringList& queryColumns,
                            const QStringList& insertcolumns, atools::sql::SqlUtil::UpdateColFuncType func);
 
+  /* Same as updateColumnInTable but collects all calculated values in a temporary table first and updates
+   * the table with one statement. Much faster for large tables. The function has to bind
+   * all insertcolumns. Runs in one transaction which is committed at the end.
+   * whereClause is added to the select statement and limits the rows passed to func. */
+  void updateColumnInTableBulk(const QString& table, const QString& idColum, const QStringList& queryColumns,
+                               const QStringList& insertcolumns, const QString& whereClause,
+                               atools::sql::SqlUtil::UpdateColFuncType func);
+  void updateColumnInTableBulk(const QString& table, const QString& idColum, const QStringList& queryColumns,
+                               const QStringList& insertcolumns, atools::sql::SqlUtil::UpdateColFuncType func);
+
 private:
   SqlDatabase *db;
 
   QStringList buildTableList(const QStringList& tables);
   QStringList buildResultList(SqlQuery& query);
 
+  /* Source column index to target bind position or target placeholder name for placeholders used more than once */
+  struct CopyColumns
+  {
+    QVector<std::pair<int, int> > positional;
+    QVector<std::pair<int, QString> > named;
+  };
+
   static void copyRowValuesInternal(const SqlQuery& from, SqlQuery& to,
                                     const SqlRecord& fromRec, const QMap<QString, QVariant>& bound);
+  static void copyRowValuesInternal(const SqlQuery& from, SqlQuery& to, const CopyColumns& columns);
+  static CopyColumns copyColumns(const SqlRecord& fromRec, const SqlQuery& to);
 
 };
 
@@ -0,0 +1,150 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "sql/sqlwarmup.h"
+
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QDebug>
+#include <QRunnable>
+
+namespace atools {
+namespace sql {
+
+class SqlWarmupTask :
+  public QRunnable
+{
+public:
+  SqlWarmupTask(SqlWarmup *sqlWarmup)
+    : warmup(sqlWarmup)
+  {
+    setAutoDelete(true);
+  }
+
+  virtual void run() override
+  {
+    warmup->run();
+  }
+
+private:
+  SqlWarmup *warmup;
+};
+
+SqlWarmup::SqlWarmup(const QString& filename, const QStringList& tableNames)
+  : databaseFile(filename), tables(tableNames)
+{
+  pool.setMaxThreadCount(1);
+}
+
+SqlWarmup::~SqlWarmup()
+{
+  cancel();
+  pool.waitForDone();
+}
+
+QStringList SqlWarmup::readOptimizedPragmas(int mmapSizeMb, int cacheSizeMb)
+{
+  return QStringList({QString("PRAGMA mmap_size=%1").arg(static_cast<qint64>(mmapSizeMb) * 1024 * 1024),
+                      QString("PRAGMA cache_size=-%1").arg(cacheSizeMb * 1024),
+                      QString("PRAGMA query_only=ON")});
+}
+
+void SqlWarmup::start()
+{
+  if(started)
+    return;
+
+  started = true;
+  timer.start();
+  pool.start(new SqlWarmupTask(this));
+}
+
+void SqlWarmup::cancel()
+{
+  canceled.storeRelease(1);
+}
+
+bool SqlWarmup::waitForFinished(int timeoutMs)
+{
+  return pool.waitForDone(timeoutMs) && isFinished();
+}
+
+void SqlWarmup::run()
+{
+  QString name = QString("SqlWarmup_%1").arg(reinterpret_cast<quintptr>(this), 0, 16);
+  int numStatements = 0;
+
+  try
+  {
+    SqlDatabase db = SqlDatabase::addDatabase("QSQLITE", name);
+    db.setDatabaseName(databaseFile);
+    db.setConnectOptions("QSQLITE_OPEN_READONLY");
+    db.setReadonly();
+    db.open(readOptimizedPragmas());
+
+    for(const QString& table : tables)
+    {
+      if(canceled.loadAcquire() == 1)
+        break;
+
+      QStringList statements;
+
+      // Unary plus disables index usage and forces a scan of all table pages
+      statements.append(QString("select count(*) from %1 where +rowid is not null").arg(table));
+
+      SqlQuery indexQuery(db);
+      indexQuery.prepare("select name from sqlite_master where type = 'index' and tbl_name = :table");
+      indexQuery.bindValue(":table", table);
+      indexQuery.exec();
+      while(indexQuery.next())
+        // Full scan of the index pages
+        statements.append(QString("select count(*) from %1 indexed by %2").
+                          arg(table).arg(indexQuery.valueStr(0)));
+      indexQuery.finish();
+
+      for(const QString& statement : statements)
+      {
+        if(canceled.loadAcquire() == 1)
+          break;
+
+        SqlQuery query(db);
+        query.exec(statement);
+        query.finish();
+        numStatements++;
+      }
+    }
+    db.close();
+  }
+  catch(std::exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Warmup failed" << e.what();
+  }
+  catch(...)
+  {
+    qWarning() << Q_FUNC_INFO << "Warmup failed";
+  }
+  SqlDatabase::removeDatabase(name);
+
+  readyMs = timer.elapsed();
+  finished.storeRelease(1);
+  qInfo() << Q_FUNC_INFO << databaseFile << "ready after" << readyMs << "ms" << numStatements << "statements"
+          << (canceled.loadAcquire() == 1 ? "canceled" : "");
+}
+
+} // namespace sql
+} // namespace atools
@@ -0,0 +1,91 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_SQL_SQLWARMUP_H
+#define ATOOLS_SQL_SQLWARMUP_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QThreadPool>
+
+namespace atools {
+namespace sql {
+
+/*
+ * Reads tables and their indexes of a SQLite database in a background thread to fill the operating system
+ * page cache and the memory map after opening. Uses its own read only connection.
+ *
+ * Usage:
+ * db.open(SqlWarmup::readOptimizedPragmas());
+ * SqlWarmup warmup(db.databaseName(), {"airport", "nav_search"});
+ * warmup.start();
+ */
+class SqlWarmup
+{
+public:
+  SqlWarmup(const QString& filename, const QStringList& tableNames);
+
+  /* Cancels and waits for the background thread */
+  ~SqlWarmup();
+
+  SqlWarmup(const SqlWarmup& other) = delete;
+  SqlWarmup& operator=(const SqlWarmup& other) = delete;
+
+  /* Pragmas for read only use. Memory mapped IO up to mmapSizeMb and a page cache of cacheSizeMb
+   * for the connection. query_only prevents accidental changes. Pass to SqlDatabase::open(). */
+  static QStringList readOptimizedPragmas(int mmapSizeMb = 256, int cacheSizeMb = 64);
+
+  /* Start reading in the background. Does nothing if already started. */
+  void start();
+
+  /* Stop after the current statement */
+  void cancel();
+
+  /* Wait until finished or timeout. Returns true if finished. */
+  bool waitForFinished(int timeoutMs = -1);
+
+  bool isFinished() const
+  {
+    return finished.loadAcquire() == 1;
+  }
+
+  /* Time from start() until all tables and indexes were read or -1 if not finished */
+  qint64 getTimeToReadyMs() const
+  {
+    return isFinished() ? readyMs : -1;
+  }
+
+private:
+  friend class SqlWarmupTask;
+
+  /* Called in background thread */
+  void run();
+
+  QString databaseFile;
+  QStringList tables;
+  QThreadPool pool;
+  QElapsedTimer timer;
+  QAtomicInt canceled = 0, finished = 0;
+  qint64 readyMs = -1;
+  bool started = false;
+};
+
+} // namespace sql
+} // namespace atools
+
+#endif // ATOOLS_SQL_SQLWARMUP_H
@@ -39,8 +39,29 @@ CsvReader::~CsvReader()
 void CsvReader::readCsvLine(const QString& line)
 {
   if(!inEscape)
+  {
     // Reading a full new line
     reset();
+
+    if(scanLine(line))
+    {
+      // Complete line without escaped linefeeds - copy the fields only
+      for(const Field& field : fields)
+      {
+        if(field.start == -1)
+          values.append(escapedValues.at(field.length));
+        else
+        {
+          QStringRef ref(&line, field.start, field.length);
+          values.append(trim ? ref.trimmed().toString() : ref.toString());
+        }
+      }
+      return;
+    }
+
+    // Line ends in escape - read again character by character
+    reset();
+  }
   else
     // In escape - add e new line
     curValue += "\n";
@@ -95,9 +116,119 @@ void CsvReader::readCsvLine(const QString& line)
   }
 }
 
+void CsvReader::readCsvLineRefs(const QString& line)
+{
+  refs.clear();
+  if(!inEscape)
+  {
+    reset();
+    if(scanLine(line))
+    {
+      refs.reserve(fields.size());
+      for(const Field& field : fields)
+      {
+        if(field.start == -1)
+          // escapedValues is not modified anymore until the next line
+          refs.append(QStringRef(&escapedValues.at(field.length)));
+        else
+        {
+          QStringRef ref(&line, field.start, field.length);
+          refs.append(trim ? ref.trimmed() : ref);
+        }
+      }
+      return;
+    }
+    reset();
+  }
+
+  // Escaped linefeed in this or previous line
+  readCsvLine(line);
+  if(!inEscape)
+  {
+    refs.reserve(values.size());
+    for(const QString& value : values)
+      refs.append(QStringRef(&value));
+  }
+}
+
+bool CsvReader::scanLine(const QString& line)
+{
+  const QChar *data = line.constData();
+  int size = line.size();
+  int pos = 0;
+
+  while(true)
+  {
+    // Find end of field or first escape character
+    int end = pos;
+    while(end < size && data[end] != separator && data[end] != escape)
+      end++;
+
+    if(end < size && data[end] == escape)
+    {
+      // Slow path for this field only
+      if(!scanEscapedField(line, pos))
+        return false;
+      fields.append({-1, escapedValues.size() - 1});
+    }
+    else
+    {
+      fields.append({pos, end - pos});
+      pos = end;
+    }
+
+    if(pos >= size)
+      break;
+
+    // Skip separator
+    pos++;
+  }
+  return true;
+}
+
+bool CsvReader::scanEscapedField(const QString& line, int& pos)
+{
+  // Same as the loop in readCsvLine for a single field
+  QString value;
+  bool escaped = false;
+  QChar last = '\0';
+  for(; pos < line.size(); pos++)
+  {
+    QChar c = line.at(pos);
+    if(c == escape)
+    {
+      if(escaped)
+        escaped = false;
+      else
+      {
+        if(last == escape)
+          value.append(c);
+        escaped = true;
+      }
+      last = c;
+      continue;
+    }
+
+    if(c == separator && !escaped)
+      break;
+
+    value.append(c);
+    last = c;
+  }
+
+  if(escaped)
+    return false;
+
+  // Escaped values are not trimmed
+  escapedValues.append(value);
+  return true;
+}
+
 void CsvReader::reset()
 {
   values.clear();
+  fields.clear();
+  escapedValues.clear();
   inEscape = false;
   curValue.clear();
   lastChar = '\0';
@@ -19,6 +19,7 @@
 #define ATOOLS_UTIL_CSVREADER_H
 
 #include <QStringList>
+#include <QVector>
 
 namespace atools {
 namespace util {
@@ -38,12 +39,23 @@ public:
    * Example: value1,"value2 with , separator",value3,"value4 with "" escaped",value4*/
   void readCsvLine(const QString& line);
 
+  /* Same as readCsvLine but does not copy fields. Get the values with getRefs() which point into line or into
+   * an internal buffer for fields that contain escape characters. line has to stay valid until the next call.
+   * Lines with escaped linefeeds fall back to readCsvLine. */
+  void readCsvLineRefs(const QString& line);
+
   /* Get values after calling readCsvLine once or more */
   const QStringList& getValues() const
   {
     return values;
   }
 
+  /* Get values after calling readCsvLineRefs. Valid until the next call or reset. */
+  const QVector<QStringRef>& getRefs() const
+  {
+    return refs;
+  }
+
   /* inEscape is set if the line ended but is still escaped - continue reading lines until false */
   bool isInEscape() const
   {
@@ -54,6 +66,18 @@ public:
   void reset();
 
 private:
+  /* Field position in line. If start is -1 length is the index into escapedValues. */
+  struct Field
+  {
+    int start, length;
+  };
+
+  /* Scan a line which does not start in an escape. Returns false if the line ends in an escaped field. */
+  bool scanLine(const QString& line);
+
+  /* Unescape a field containing escape characters starting at pos. Returns false if the line ends in escape. */
+  bool scanEscapedField(const QString& line, int& pos);
+
   /* State */
 
   /* List of column values */
@@ -62,6 +86,11 @@ private:
   /* Current column value read */
   QString curValue;
 
+  /* Fast mode */
+  QVector<Field> fields;
+  QVector<QString> escapedValues;
+  QVector<QStringRef> refs;
+
   bool inEscape = false, /* Currently in escaped text */
        curValueEscaped = false; /* Current value read is in escape - do no trim */
 
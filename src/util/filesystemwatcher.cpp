@@ -33,6 +33,11 @@ FileSystemWatcher::FileSystemWatcher(QObject *parent, bool verboseLogging)
 
   delayTimer.setSingleShot(true);
   delayTimer.connect(&delayTimer, &QTimer::timeout, this, &FileSystemWatcher::fileUpdatedDelayed);
+  periodicCheckTimer.connect(&periodicCheckTimer, &QTimer::timeout, this, &FileSystemWatcher::pathOrFileChanged);
+
+  // Directory watch catches created, removed, renamed and modified files
+  fsWatcher = new QFileSystemWatcher(this);
+  fsWatcher->connect(fsWatcher, &QFileSystemWatcher::directoryChanged, this, &FileSystemWatcher::pathOrFileChanged);
 }
 
 FileSystemWatcher::~FileSystemWatcher()
@@ -44,61 +49,83 @@ FileSystemWatcher::~FileSystemWatcher()
 
 void FileSystemWatcher::clear()
 {
-  deleteFsWatcher();
+  delayTimer.stop();
+  periodicCheckTimer.stop();
+
+  if(!watchedDir.isEmpty())
+  {
+    fsWatcher->removePath(watchedDir);
+    watchedDir.clear();
+  }
+
   filename.clear();
+  notifiedState = changedState = FileState();
 }
 
-/* Called on directory or file change and QTimer event */
+FileSystemWatcher::FileState FileSystemWatcher::currentState() const
+{
+  FileState state;
+  QFileInfo fileinfo(filename);
+  if(fileinfo.exists() && fileinfo.isFile())
+  {
+    state.exists = true;
+    state.size = fileinfo.size();
+    state.lastModified = fileinfo.lastModified();
+  }
+  return state;
+}
+
+/* Called on directory change and QTimer event */
 void FileSystemWatcher::pathOrFileChanged()
 {
-  if(verbose)
-    qDebug() << Q_FUNC_INFO;
+  if(filename.isEmpty())
+    return;
 
-  periodicCheckTimer.stop();
+  FileState state = currentState();
 
-  QFileInfo fileinfo(filename);
-  if(fileinfo.exists() && fileinfo.isFile() && fileinfo.size() > minFileSize)
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "File" << filename << "exists" << state.exists << "size" << state.size
+             << "last modified" << state.lastModified.toString(Qt::DefaultLocaleShortDate);
+
+  if(state != changedState)
   {
-    if(verbose)
-      qDebug() << Q_FUNC_INFO << "File" << filename
-               << "exists" << fileinfo.exists()
-               << "size" << fileinfo.size()
-               << "last modified" << fileinfo.lastModified().toString(Qt::DefaultLocaleShortDate);
-
-    // File exists - first call or older than two minutes or file differs
-    if(!fileTimestamp.isValid() || fileinfo.lastModified() > fileTimestamp || lastFileSize != fileinfo.size())
-    {
-      // Timestamp of file has changed
-      if(verbose)
-        qDebug() << Q_FUNC_INFO << "changed" << filename;
-
-      fileTimestamp = fileinfo.lastModified();
-      lastFileSize = fileinfo.size();
-
-      // Start or extend the delayed notification
-      delayTimer.start(delayMs);
-    }
-    else
-    {
-      if(verbose)
-        qDebug() << Q_FUNC_INFO << "File" << filename << "not changed";
-      periodicCheckTimer.start(checkMs);
-    }
+    // Changed since last event - start or extend the delayed notification to coalesce bursts
+    changedState = state;
+    delayTimer.start(delayMs);
   }
-  else
-  {
-    // File was deleted - keep current weather information
-    qDebug() << Q_FUNC_INFO << "File" << filename << "does not exist.";
+  else if(!delayTimer.isActive())
     periodicCheckTimer.start(checkMs);
-  }
 }
 
 void FileSystemWatcher::fileUpdatedDelayed()
 {
-  if(verbose)
-    qDebug() << Q_FUNC_INFO;
+  FileState state = currentState();
+
+  if(state != changedState)
+  {
+    // Still being written - wait again
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << "File" << filename << "still changing";
+    changedState = state;
+    delayTimer.start(delayMs);
+    return;
+  }
+
+  if(!state.exists)
+    // File was deleted - keep current information
+    qDebug() << Q_FUNC_INFO << "File" << filename << "does not exist.";
+  else if(state.size < minFileSize)
+    qDebug() << Q_FUNC_INFO << "File" << filename << "too small" << state.size;
+  else if(state != notifiedState)
+  {
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << "changed" << filename;
 
-  emit fileUpdated(filename);
+    notifiedState = state;
+    emit fileUpdated(filename);
+  }
+  else if(verbose)
+    qDebug() << Q_FUNC_INFO << "File" << filename << "not changed";
 
   periodicCheckTimer.start(checkMs);
 }
@@ -109,46 +136,19 @@ void FileSystemWatcher::setFilenameAndStart(const QString& value)
 
   clear();
   filename = value;
-  createFsWatcher();
-}
 
-void FileSystemWatcher::deleteFsWatcher()
-{
-  delayTimer.stop();
-  periodicCheckTimer.stop();
-  periodicCheckTimer.disconnect(&periodicCheckTimer, &QTimer::timeout, this, &FileSystemWatcher::pathOrFileChanged);
-
-  if(fsWatcher != nullptr)
+  // Watch only the directory since file watches get lost if the file is replaced
+  watchedDir = QFileInfo(filename).path();
+  if(!fsWatcher->addPath(watchedDir))
   {
-    fsWatcher->disconnect(fsWatcher, &QFileSystemWatcher::fileChanged, this, &FileSystemWatcher::pathOrFileChanged);
-    fsWatcher->disconnect(fsWatcher, &QFileSystemWatcher::directoryChanged, this,
-                          &FileSystemWatcher::pathOrFileChanged);
-    fsWatcher->deleteLater();
-    fsWatcher = nullptr;
+    qWarning() << "cannot watch" << watchedDir;
+    watchedDir.clear();
   }
-}
 
-void FileSystemWatcher::createFsWatcher()
-{
-  if(fsWatcher == nullptr)
-  {
-    // Watch file for changes and directory too to catch file deletions
-    fsWatcher = new QFileSystemWatcher(this);
-    fsWatcher->connect(fsWatcher, &QFileSystemWatcher::fileChanged, this, &FileSystemWatcher::pathOrFileChanged);
-    fsWatcher->connect(fsWatcher, &QFileSystemWatcher::directoryChanged, this, &FileSystemWatcher::pathOrFileChanged);
-  }
-
-  // Watch file to get changes
-  if(!fsWatcher->addPath(filename))
-    qWarning() << "cannot watch" << filename;
-
-  // Watch directory to get added or removed file changes
-  QFileInfo fileinfo(filename);
-  if(!fsWatcher->addPath(fileinfo.path()))
-    qWarning() << "cannot watch" << fileinfo.path();
+  // Current state is the base line for changes since the caller reads the file anyway after starting
+  notifiedState = changedState = currentState();
 
   // Check every ten seconds since the watcher is unreliable
-  periodicCheckTimer.connect(&periodicCheckTimer, &QTimer::timeout, this, &FileSystemWatcher::pathOrFileChanged);
   periodicCheckTimer.start(checkMs);
 }
 
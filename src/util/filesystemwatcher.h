@@ -20,6 +20,7 @@
 
 #include "fs/weather/weathertypes.h"
 
+#include <QDateTime>
 #include <QTimer>
 
 class QFileSystemWatcher;
@@ -31,7 +32,11 @@ namespace util {
  * A better file system watch class which works around for files which are removed, deleted and renamed in
  * the process by checking size and timestamp.
  *
- * Notifications are sent with a delay to catch intermediate changes.
+ * Only the parent directory is watched with native change notification since watches on the file itself are
+ * lost when the file is replaced. A slow periodic check is used as fallback for unreliable file systems.
+ *
+ * Bursts of changes are coalesced into one notification which is sent after the file did not change for the
+ * delay time. No notification is sent if size and modification time are the same as on the last notification.
  */
 class FileSystemWatcher
   : public QObject
@@ -47,7 +52,7 @@ public:
     return filename;
   }
 
-  /* Set file and start watching */
+  /* Set file and start watching. The current state of the file does not cause a notification. */
   void setFilenameAndStart(const QString& value);
 
   void clear();
@@ -78,14 +83,37 @@ signals:
   void fileUpdated(const QString& filename);
 
 private:
-  void deleteFsWatcher();
-  void createFsWatcher();
+  /* Size and modification time of the file */
+  struct FileState
+  {
+    bool exists = false;
+    qint64 size = 0;
+    QDateTime lastModified;
+
+    bool operator==(const FileState& other) const
+    {
+      return exists == other.exists && size == other.size && lastModified == other.lastModified;
+    }
+
+    bool operator!=(const FileState& other) const
+    {
+      return !operator==(other);
+    }
+  };
+
+  /* Called on directory change and by the periodic check */
   void pathOrFileChanged();
+
+  /* Called when the delay timer fires */
   void fileUpdatedDelayed();
 
-  QString filename;
-  QDateTime fileTimestamp;
-  qint64 lastFileSize = 0;
+  FileState currentState() const;
+
+  QString filename, watchedDir;
+
+  /* State on last notification and on last change event */
+  FileState notifiedState, changedState;
+
   QFileSystemWatcher *fsWatcher = nullptr;
   QTimer periodicCheckTimer, delayTimer;
 
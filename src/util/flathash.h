@@ -0,0 +1,263 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_FLATHASH_H
+#define ATOOLS_UTIL_FLATHASH_H
+
+#include <QHash>
+#include <QVector>
+
+#include <utility>
+
+namespace atools {
+namespace util {
+
+/* Default hash function using qHash() and a finalizer which spreads weak hash values over all bits */
+template<typename KEY>
+struct FlatHashFunction
+{
+  uint operator()(const KEY& key) const
+  {
+    uint hash = qHash(key);
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bU;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35U;
+    hash ^= hash >> 16;
+    return hash;
+  }
+
+};
+
+/*
+ * Open addressing hash map with linear Robin Hood probing. Keys and values are stored inline in one array
+ * which needs only one or two cache lines for a lookup compared to the node based QHash.
+ *
+ * Key and value have to be default constructible and copyable. Pointers returned by find() are invalidated
+ * by insert() and remove().
+ */
+template<typename KEY, typename VALUE, typename HASH = FlatHashFunction<KEY> >
+class FlatHash
+{
+public:
+  FlatHash()
+  {
+  }
+
+  /* Insert or replace value for key */
+  void insert(const KEY& key, const VALUE& value);
+
+  /* Remove key if contained. Returns true if the key was found. */
+  bool remove(const KEY& key);
+
+  /* Get pointer to value or null if not found */
+  const VALUE *find(const KEY& key) const;
+
+  VALUE value(const KEY& key, const VALUE& defaultValue = VALUE()) const
+  {
+    const VALUE *val = find(key);
+    return val != nullptr ? *val : defaultValue;
+  }
+
+  bool contains(const KEY& key) const
+  {
+    return find(key) != nullptr;
+  }
+
+  /* Prepare for at least size elements without rehashing */
+  void reserve(int size);
+
+  /* Remove all entries but keep the allocated memory */
+  void clear();
+
+  int size() const
+  {
+    return numEntries;
+  }
+
+  bool isEmpty() const
+  {
+    return numEntries == 0;
+  }
+
+private:
+  struct Slot
+  {
+    KEY key;
+    VALUE value;
+
+    /* Distance from home slot plus one. 0 means empty. */
+    int distance = 0;
+  };
+
+  void rehash(int newCapacity);
+  void insertInternal(KEY key, VALUE value);
+
+  /* Maximum load factor is 7/8 */
+  static int capacityFor(int size)
+  {
+    int capacity = 16;
+    while(capacity - capacity / 8 < size)
+      capacity *= 2;
+    return capacity;
+  }
+
+  QVector<Slot> slots;
+  int numEntries = 0, mask = 0;
+  HASH hashFunc;
+};
+
+template<typename KEY, typename VALUE, typename HASH>
+void FlatHash<KEY, VALUE, HASH>::insert(const KEY& key, const VALUE& value)
+{
+  if(slots.isEmpty() || numEntries + 1 > slots.size() - slots.size() / 8)
+    rehash(capacityFor(numEntries + 1));
+
+  // Replace existing
+  int index = static_cast<int>(hashFunc(key) & static_cast<uint>(mask));
+  for(int distance = 1; slots.at(index).distance >= distance; distance++)
+  {
+    if(slots.at(index).key == key)
+    {
+      slots[index].value = value;
+      return;
+    }
+    index = (index + 1) & mask;
+  }
+
+  insertInternal(key, value);
+}
+
+template<typename KEY, typename VALUE, typename HASH>
+void FlatHash<KEY, VALUE, HASH>::insertInternal(KEY key, VALUE value)
+{
+  Slot *data = slots.data();
+  int index = static_cast<int>(hashFunc(key) & static_cast<uint>(mask));
+  int distance = 1;
+
+  while(true)
+  {
+    Slot& slot = data[index];
+    if(slot.distance == 0)
+    {
+      slot.key = std::move(key);
+      slot.value = std::move(value);
+      slot.distance = distance;
+      numEntries++;
+      return;
+    }
+
+    if(slot.distance < distance)
+    {
+      // Robin Hood - take the place of the entry which is closer to its home slot and move it further
+      std::swap(slot.key, key);
+      std::swap(slot.value, value);
+      std::swap(slot.distance, distance);
+    }
+
+    index = (index + 1) & mask;
+    distance++;
+  }
+}
+
+template<typename KEY, typename VALUE, typename HASH>
+bool FlatHash<KEY, VALUE, HASH>::remove(const KEY& key)
+{
+  if(numEntries == 0)
+    return false;
+
+  Slot *data = slots.data();
+  int index = static_cast<int>(hashFunc(key) & static_cast<uint>(mask));
+  for(int distance = 1; data[index].distance >= distance; distance++)
+  {
+    if(data[index].key == key)
+    {
+      // Backward shift deletion - move following entries one slot closer to their home
+      int next = (index + 1) & mask;
+      while(data[next].distance > 1)
+      {
+        data[index].key = std::move(data[next].key);
+        data[index].value = std::move(data[next].value);
+        data[index].distance = data[next].distance - 1;
+        index = next;
+        next = (next + 1) & mask;
+      }
+      data[index] = Slot();
+      numEntries--;
+      return true;
+    }
+    index = (index + 1) & mask;
+  }
+  return false;
+}
+
+template<typename KEY, typename VALUE, typename HASH>
+const VALUE *FlatHash<KEY, VALUE, HASH>::find(const KEY& key) const
+{
+  if(numEntries == 0)
+    return nullptr;
+
+  const Slot *data = slots.constData();
+  int index = static_cast<int>(hashFunc(key) & static_cast<uint>(mask));
+
+  // Stop at the first empty slot or at an entry which is closer to its home than the key would be
+  for(int distance = 1; data[index].distance >= distance; distance++)
+  {
+    if(data[index].key == key)
+      return &data[index].value;
+    index = (index + 1) & mask;
+  }
+  return nullptr;
+}
+
+template<typename KEY, typename VALUE, typename HASH>
+void FlatHash<KEY, VALUE, HASH>::reserve(int size)
+{
+  int capacity = capacityFor(size);
+  if(capacity > slots.size())
+    rehash(capacity);
+}
+
+template<typename KEY, typename VALUE, typename HASH>
+void FlatHash<KEY, VALUE, HASH>::clear()
+{
+  if(numEntries > 0)
+  {
+    std::fill(slots.begin(), slots.end(), Slot());
+    numEntries = 0;
+  }
+}
+
+template<typename KEY, typename VALUE, typename HASH>
+void FlatHash<KEY, VALUE, HASH>::rehash(int newCapacity)
+{
+  QVector<Slot> oldSlots(newCapacity);
+  oldSlots.swap(slots);
+  mask = newCapacity - 1;
+  numEntries = 0;
+
+  for(Slot& slot : oldSlots)
+  {
+    if(slot.distance > 0)
+      insertInternal(std::move(slot.key), std::move(slot.value));
+  }
+}
+
+} // namespace util
+} // namespace atools
+
+#endif // ATOOLS_UTIL_FLATHASH_H
@@ -24,6 +24,7 @@
 #include <QBuffer>
 #include <QIcon>
 #include <QRegularExpression>
+#include <QStringBuilder>
 
 namespace atools {
 namespace util {
@@ -32,6 +33,11 @@ namespace util {
 static const QRegularExpression LINK_REGEXP(
   "\\b((http[s]?|ftp|file)://[a-zA-Z0-9\\./:_\\?\\&=\\-\\$\\+\\!\\*'\\(\\),;%#\\[\\]@]+)\\b");
 
+/* Tag names for the formatting flags BOLD to NOBR in order of the bits */
+static const char *FLAG_TAGS[] = {"b", "i", "u", "s", "sub", "sup", "small", "big", "code", "nobr"};
+static const int NUM_FLAG_TAGS = 10;
+static const int FLAG_TAGS_MASK = (1 << NUM_FLAG_TAGS) - 1;
+
 HtmlBuilder::HtmlBuilder(const QColor& rowColor, const QColor& rowColorAlt)
   : hasBackColor(true)
 {
@@ -64,13 +70,13 @@ HtmlBuilder& HtmlBuilder::operator=(const atools::util::HtmlBuilder& other)
 {
   rowBackColor = other.rowBackColor;
   rowBackColorAlt = other.rowBackColorAlt;
-  tableRowHeader = other.tableRowHeader;
-  tableRow = other.tableRow;
-  tableRowAlignRight = other.tableRowAlignRight;
   tableRowBegin = other.tableRowBegin;
+  colorNameCache = other.colorNameCache;
+  tagCache = other.tagCache;
   tableIndex = other.tableIndex;
   defaultPrecision = other.defaultPrecision;
   numLines = other.numLines;
+  reservedCapacity = other.reservedCapacity;
   htmlText = other.htmlText;
   locale = other.locale;
   dateFormat = other.dateFormat;
@@ -85,38 +91,41 @@ void HtmlBuilder::initColors(const QColor& rowColor, const QColor& rowColorAlt)
   rowBackColor = rowColor.name(QColor::HexRgb);
   rowBackColorAlt = rowColorAlt.name(QColor::HexRgb);
 
+  tableRowBegin.clear();
   if(hasBackColor)
   {
-    tableRow.append("<tr bgcolor=\"" + rowBackColor + "\"><td>%1</td><td>%2</td></tr>");
-    tableRow.append("<tr bgcolor=\"" + rowBackColorAlt + "\"><td>%1</td><td>%2</td></tr>");
-
-    tableRowAlignRight.append(
-      "<tr bgcolor=\"" + rowBackColor + "\"><td>%1</td><td align=\"right\">%2</td></tr>");
-    tableRowAlignRight.append(
-      "<tr bgcolor=\"" + rowBackColorAlt + "\"><td>%1</td><td align=\"right\">%2</td></tr>");
-
     tableRowBegin.append("<tr bgcolor=\"" + rowBackColor + "\">");
     tableRowBegin.append("<tr bgcolor=\"" + rowBackColorAlt + "\">");
   }
   else
   {
-    tableRow.append("<tr><td>%1</td><td>%2</td></tr>");
-    tableRow.append("<tr><td>%1</td><td>%2</td></tr>");
-
-    tableRowAlignRight.append("<tr><td>%1</td><td align=\"right\">%2</td></tr>");
-    tableRowAlignRight.append("<tr><td>%1</td><td align=\"right\">%2</td></tr>");
+    tableRowBegin.append("<tr>");
+    tableRowBegin.append("<tr>");
   }
-  tableRowHeader = "<tr><td>%1</td></tr>";
 }
 
 HtmlBuilder& HtmlBuilder::clear()
 {
-  htmlText.clear();
+  // Keep buffer - QString::clear() would free it
+  htmlText.resize(0);
+
+  // Buffer is detached and reallocated if the text was shared with a copy
+  if(reservedCapacity > 0 && htmlText.capacity() < reservedCapacity)
+    htmlText.reserve(reservedCapacity);
+
   numLines = 0;
   tableIndex = 0;
   return *this;
 }
 
+HtmlBuilder& HtmlBuilder::reserve(int capacity)
+{
+  reservedCapacity = capacity;
+  if(htmlText.capacity() < capacity)
+    htmlText.reserve(capacity);
+  return *this;
+}
+
 HtmlBuilder HtmlBuilder::cleared() const
 {
   HtmlBuilder html(*this);
@@ -201,8 +210,12 @@ HtmlBuilder& HtmlBuilder::row2Var(const QString& name, const QVariant& value, ht
       valueStr = QString("Error: Invalid variant type \"%1\"").arg(value.typeName());
 
   }
-  htmlText += alt(flags & html::ALIGN_RIGHT ? tableRowAlignRight : tableRow).
-              arg(asText(name, flags, color), value.toString());
+
+  // Value is inserted unformatted and not escaped - only the name is formatted using the flags
+  htmlText += alt(tableRowBegin) % QLatin1String("<td>");
+  appendText(htmlText, name, flags, color);
+  htmlText += (flags & html::ALIGN_RIGHT ? QLatin1String("</td><td align=\"right\">") : QLatin1String("</td><td>")) %
+              value.toString() % QLatin1String("</td></tr>");
   tableIndex++;
   numLines++;
   return *this;
@@ -211,13 +224,7 @@ HtmlBuilder& HtmlBuilder::row2Var(const QString& name, const QVariant& value, ht
 HtmlBuilder& HtmlBuilder::row2If(const QString& name, const QString& value, html::Flags flags, QColor color)
 {
   if(!value.isEmpty())
-  {
-    htmlText += alt(flags & html::ALIGN_RIGHT ? tableRowAlignRight : tableRow).
-                arg(asText(name, flags | atools::util::html::BOLD, color)).
-                arg(asText(value, flags, color));
-    tableIndex++;
-    numLines++;
-  }
+    appendRow2(name, value, flags | atools::util::html::BOLD, flags, color);
   return *this;
 }
 
@@ -244,12 +251,20 @@ HtmlBuilder& HtmlBuilder::row2(const QString& name, const HtmlBuilder& value, ht
 
 HtmlBuilder& HtmlBuilder::row2(const QString& name, const QString& value, html::Flags flags, QColor color)
 {
-  htmlText += alt(flags & html::ALIGN_RIGHT ? tableRowAlignRight : tableRow).
-              arg(asText(name, flags | atools::util::html::BOLD, color)).
-              arg(asText(value, flags, color));
+  appendRow2(name, value, flags | atools::util::html::BOLD, flags, color);
+  return *this;
+}
+
+void HtmlBuilder::appendRow2(const QString& name, const QString& value, html::Flags nameFlags,
+                             html::Flags valueFlags, QColor color)
+{
+  htmlText += alt(tableRowBegin) % QLatin1String("<td>");
+  appendText(htmlText, name, nameFlags, color);
+  htmlText += valueFlags & html::ALIGN_RIGHT ? QLatin1String("</td><td align=\"right\">") : QLatin1String("</td><td>");
+  appendText(htmlText, value, valueFlags, color);
+  htmlText += QLatin1String("</td></tr>");
   tableIndex++;
   numLines++;
-  return *this;
 }
 
 HtmlBuilder& HtmlBuilder::row2(const QString& name, float value, int precision, html::Flags flags,
@@ -273,16 +288,15 @@ HtmlBuilder& HtmlBuilder::row2(const QString& name, int value, html::Flags flags
 
 HtmlBuilder& HtmlBuilder::td(const QString& str, html::Flags flags, QColor color)
 {
-  htmlText += QString("<td") + (flags & html::ALIGN_RIGHT ? " style=\"text-align: right;\"" : "") + ">";
-  text(str, flags, color);
-  htmlText += "</td>\n";
+  htmlText += flags & html::ALIGN_RIGHT ? QLatin1String("<td style=\"text-align: right;\">") : QLatin1String("<td>");
+  appendText(htmlText, str, flags, color);
+  htmlText += QLatin1String("</td>\n");
   return *this;
 }
 
 HtmlBuilder& HtmlBuilder::tdF(html::Flags flags)
 {
-  htmlText += QString("<td") +
-              (flags & html::ALIGN_RIGHT ? " style=\"text-align: right;\"" : "") + ">";
+  htmlText += flags & html::ALIGN_RIGHT ? QLatin1String("<td style=\"text-align: right;\">") : QLatin1String("<td>");
   return *this;
 }
 
@@ -299,34 +313,34 @@ HtmlBuilder& HtmlBuilder::tdAtts(const QHash<QString, QString>& attributes)
 
 HtmlBuilder& HtmlBuilder::td()
 {
-  htmlText += QString("<td>");
+  htmlText += QLatin1String("<td>");
   return *this;
 }
 
 HtmlBuilder& HtmlBuilder::tdW(int widthPercent)
 {
-  htmlText += QString("<td width=\"%1%\">").arg(widthPercent);
+  htmlText += QLatin1String("<td width=\"") % QString::number(widthPercent) % QLatin1String("%\">");
   return *this;
 }
 
 HtmlBuilder& HtmlBuilder::tdEnd()
 {
-  htmlText += QString("</td>\n");
+  htmlText += QLatin1String("</td>\n");
   return *this;
 }
 
 HtmlBuilder& HtmlBuilder::th(const QString& str, html::Flags flags, QColor color)
 {
-  htmlText += QString("<th") + (flags & html::ALIGN_RIGHT ? " align=\"right\"" : "") + ">";
-  text(str, flags, color);
-  htmlText += "</th>\n";
+  htmlText += flags & html::ALIGN_RIGHT ? QLatin1String("<th align=\"right\">") : QLatin1String("<th>");
+  appendText(htmlText, str, flags, color);
+  htmlText += QLatin1String("</th>\n");
   return *this;
 }
 
 HtmlBuilder& HtmlBuilder::tr(QColor backgroundColor)
 {
   if(backgroundColor.isValid())
-    htmlText += "<tr bgcolor=\"" + backgroundColor.name(QColor::HexRgb) + "\">\n";
+    htmlText += QLatin1String("<tr bgcolor=\"") % colorName(backgroundColor) % QLatin1String("\">\n");
   else
   {
     if(hasBackColor)
@@ -382,8 +396,12 @@ HtmlBuilder& HtmlBuilder::h(int level, const QString& str, html::Flags flags, QC
                             const QString& id)
 {
   QString num = QString::number(level);
-  htmlText += "<h" + num + (id.isEmpty() ? QString() : " id=\"" + id + "\"") + ">" +
-              asText(str, flags, color) + "</h" + num + ">\n";
+  htmlText += QLatin1String("<h") % num;
+  if(!id.isEmpty())
+    htmlText += QLatin1String(" id=\"") % id % QLatin1String("\"");
+  htmlText += QLatin1Char('>');
+  appendText(htmlText, str, flags, color);
+  htmlText += QLatin1String("</h") % num % QLatin1String(">\n");
   tableIndex = 0;
   numLines++;
   return *this;
@@ -677,94 +695,83 @@ HtmlBuilder& HtmlBuilder::ulEnd()
 
 HtmlBuilder& HtmlBuilder::li(const QString& str, html::Flags flags, QColor color)
 {
-  htmlText += "<li>" + asText(str, flags, color) + "</li>\n";
+  htmlText += QLatin1String("<li>");
+  appendText(htmlText, str, flags, color);
+  htmlText += QLatin1String("</li>\n");
   numLines++;
   return *this;
 }
 
-QString HtmlBuilder::asText(QString str, html::Flags flags, QColor color)
+QString HtmlBuilder::asText(const QString& str, html::Flags flags, QColor color)
 {
-  QString prefix, suffix;
-  if(flags & html::BOLD)
-  {
-    prefix.append("<b>");
-    suffix.prepend("</b>");
-  }
-
-  if(flags & html::ITALIC)
-  {
-    prefix.append("<i>");
-    suffix.prepend("</i>");
-  }
-
-  if(flags & html::UNDERLINE)
-  {
-    prefix.append("<u>");
-    suffix.prepend("</u>");
-  }
-
-  if(flags & html::STRIKEOUT)
-  {
-    prefix.append("<s>");
-    suffix.prepend("</s>");
-  }
-
-  if(flags & html::SUBSCRIPT)
-  {
-    prefix.append("<sub>");
-    suffix.prepend("</sub>");
-  }
+  QString retval;
+  appendText(retval, str, flags, color);
+  return retval;
+}
 
-  if(flags & html::SUPERSCRIPT)
-  {
-    prefix.append("<sup>");
-    suffix.prepend("</sup>");
-  }
+void HtmlBuilder::appendText(QString& dest, const QString& str, html::Flags flags, QColor color)
+{
+  const QPair<QString, QString>& tagPair = tags(flags);
+  dest += tagPair.first;
 
-  if(flags & html::SMALL)
-  {
-    prefix.append("<small>");
-    suffix.prepend("</small>");
-  }
+  if(color.isValid())
+    dest += QLatin1String("<span style=\"color:") % colorName(color) % QLatin1String("\">");
 
-  if(flags & html::BIG)
+  if(flags & html::REPLACE_CRLF || flags & html::AUTOLINK || !(flags & html::NO_ENTITIES))
   {
-    prefix.append("<big>");
-    suffix.prepend("</big>");
-  }
+    QString txt(str);
+    if(!(flags & html::NO_ENTITIES))
+      txt = toEntities(txt.toHtmlEscaped()).replace("\n", "<br/>");
 
-  if(flags & html::CODE)
-  {
-    prefix.append("<code>");
-    suffix.prepend("</code>");
-  }
+    if(flags & html::REPLACE_CRLF)
+    {
+      txt = txt.replace("\r\n", "<br/>");
+      txt = txt.replace("\n", "<br/>");
+      txt = txt.replace("\r", "<br/>");
+    }
 
-  if(flags & html::NOBR)
-  {
-    prefix.append("<nobr>");
-    suffix.prepend("</nobr>");
+    if(flags & html::AUTOLINK)
+      txt.replace(LINK_REGEXP, "<a href=\"\\1\">\\1</a>");
+    dest += txt;
   }
+  else
+    // Raw HTML - append without copy
+    dest += str;
 
   if(color.isValid())
-  {
-    prefix.append("<span style=\"color:" + color.name(QColor::HexRgb) + "\">");
-    suffix.prepend("</span>");
-  }
+    dest += QLatin1String("</span>");
+
+  dest += tagPair.second;
+}
 
-  if(!(flags & html::NO_ENTITIES))
-    str = toEntities(str.toHtmlEscaped()).replace("\n", "<br/>");
+const QString& HtmlBuilder::colorName(const QColor& color)
+{
+  QRgb rgb = color.rgb();
+  QHash<QRgb, QString>::iterator it = colorNameCache.find(rgb);
+  if(it == colorNameCache.end())
+    it = colorNameCache.insert(rgb, color.name(QColor::HexRgb));
+  return it.value();
+}
 
-  if(flags & html::REPLACE_CRLF)
+const QPair<QString, QString>& HtmlBuilder::tags(html::Flags flags)
+{
+  int tagFlags = static_cast<int>(flags) & FLAG_TAGS_MASK;
+  QHash<int, QPair<QString, QString> >::iterator it = tagCache.find(tagFlags);
+  if(it == tagCache.end())
   {
-    str = str.replace("\r\n", "<br/>");
-    str = str.replace("\n", "<br/>");
-    str = str.replace("\r", "<br/>");
+    // Build prefix and reversed suffix once for this combination
+    QString prefix, suffix;
+    for(int i = 0; i < NUM_FLAG_TAGS; i++)
+    {
+      if(tagFlags & (1 << i))
+      {
+        prefix.append(QLatin1Char('<') % QLatin1String(FLAG_TAGS[i]) % QLatin1Char('>'));
+        suffix.prepend(QLatin1String("</") % QLatin1String(FLAG_TAGS[i]) % QLatin1Char('>'));
+      }
+    }
+    it = tagCache.insert(tagFlags, qMakePair(prefix, suffix));
   }
-
-  if(flags & html::AUTOLINK)
-    str.replace(LINK_REGEXP, "<a href=\"\\1\">\\1</a>");
-
-  return prefix + str + suffix;
+  return it.value();
 }
 
 bool HtmlBuilder::checklength(int maxLines, const QString& msg)
@@ -781,7 +788,7 @@ bool HtmlBuilder::checklength(int maxLines, const QString& msg)
 
 HtmlBuilder& HtmlBuilder::text(const QString& str, html::Flags flags, QColor color)
 {
-  htmlText += asText(str, flags, color);
+  appendText(htmlText, str, flags, color);
   return *this;
 }
 
@@ -22,6 +22,7 @@
 #include <QCoreApplication>
 #include <QColor>
 #include <QSize>
+#include <QHash>
 
 namespace atools {
 namespace util {
@@ -86,9 +87,19 @@ public:
 
   HtmlBuilder& operator=(const atools::util::HtmlBuilder& other);
 
-  /* Clears this instance except settings */
+  /* Clears this instance except settings. Keeps the allocated buffer to allow reuse of the builder
+   * for repeated updates. */
   HtmlBuilder& clear();
 
+  /* Preallocate buffer for at least capacity characters. The capacity is kept across calls of clear().
+   * Use for builders which are refilled frequently, e.g. information panels. */
+  HtmlBuilder& reserve(int capacity);
+
+  int getCapacity() const
+  {
+    return htmlText.capacity();
+  }
+
   /* Returns a clean copy of this instance */
   HtmlBuilder cleared() const;
 
@@ -323,13 +334,30 @@ public:
 private:
   /* Select alternating entries based on the index from the string list */
   const QString& alt(const QStringList& list) const;
-  QString asText(QString str, html::Flags flags, QColor color);
+  QString asText(const QString& str, html::Flags flags, QColor color);
+
+  /* Appends formatted text directly to dest without temporary strings */
+  void appendText(QString& dest, const QString& str, html::Flags flags, QColor color);
+
+  /* Append a table row with two columns */
+  void appendRow2(const QString& name, const QString& value, html::Flags nameFlags, html::Flags valueFlags,
+                  QColor color);
+
+  /* Cached color name like "#ff0000" */
+  const QString& colorName(const QColor& color);
+
+  /* Cached opening and closing tags for the formatting flags */
+  const QPair<QString, QString>& tags(html::Flags flags);
   void initColors(const QColor& rowColor, const QColor& rowColorAlt);
 
-  QString rowBackColor, rowBackColorAlt, tableRowHeader;
-  QStringList tableRow, tableRowAlignRight, tableRowBegin;
+  QString rowBackColor, rowBackColorAlt;
+  QStringList tableRowBegin;
+
+  /* Formatting caches. Key is the RGB value or the formatting flags. */
+  QHash<QRgb, QString> colorNameCache;
+  QHash<int, QPair<QString, QString> > tagCache;
 
-  int tableIndex = 0, defaultPrecision = 0, numLines = 0;
+  int tableIndex = 0, defaultPrecision = 0, numLines = 0, reservedCapacity = 0;
   QString htmlText;
 
   QLocale locale;
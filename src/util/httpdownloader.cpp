@@ -16,15 +16,21 @@
 *****************************************************************************/
 
 #include "util/httpdownloader.h"
+#include "util/perfcounters.h"
 #include "util/timedcache.h"
+#include "zip/gzip.h"
 
 #include <QApplication>
 #include <QFileInfo>
+#include <QNetworkDiskCache>
 #include <QNetworkReply>
 
 namespace atools {
 namespace util {
 
+/* Read size for local files in line streaming mode */
+const static qint64 STREAM_CHUNK_SIZE = 64 * 1024;
+
 HttpDownloader::HttpDownloader(QObject *parent, bool logVerbose)
   : QObject(parent), verbose(logVerbose)
 {
@@ -36,6 +42,7 @@ HttpDownloader::~HttpDownloader()
   stopTimer();
   deleteReply();
   delete dataCache;
+  resetStream();
 }
 
 void HttpDownloader::startDownload()
@@ -62,15 +69,32 @@ void HttpDownloader::startDownload()
     }
   }
 
+  resetStream();
+
   if(!filename.isEmpty())
   {
     QFile file(filename);
     if(file.open(QIODevice::ReadOnly))
     {
-      data = file.readAll();
-      file.close();
+      if(lineStreaming)
+      {
+        bool ok = true;
+        while(ok && !file.atEnd())
+          ok = streamChunk(file.read(STREAM_CHUNK_SIZE), false, downloadUrl);
+        file.close();
+
+        if(ok && streamChunk(QByteArray(), true, downloadUrl))
+          emit downloadFinished(QByteArray(), downloadUrl);
+        else
+          emit downloadFailed(tr("Error decompressing data"), downloadUrl);
+      }
+      else
+      {
+        data = file.readAll();
+        file.close();
 
-      emit downloadFinished(data, downloadUrl);
+        emit downloadFinished(data, downloadUrl);
+      }
 
       startTimer();
     }
@@ -78,7 +102,7 @@ void HttpDownloader::startDownload()
   else
   {
     QByteArray *cachedData = nullptr;
-    if(dataCache != nullptr && (cachedData = dataCache->value(QUrl(downloadUrl).toString())) != nullptr)
+    if(!lineStreaming && dataCache != nullptr && (cachedData = dataCache->value(QUrl(downloadUrl).toString())) != nullptr)
     {
       // Found value in the cache
       data = *cachedData;
@@ -95,6 +119,23 @@ void HttpDownloader::startDownload()
       if(!userAgent.isEmpty())
         request.setHeader(QNetworkRequest::UserAgentHeader, userAgent);
 
+      if(networkManager.cache() != nullptr)
+      {
+        if(preferDiskCache)
+        {
+          // Use a non-expired reply from the last session without asking the server
+          request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
+          preferDiskCache = false;
+        }
+      }
+      else if(conditionalRequests && validatorUrl == downloadUrl && (lineStreaming || !lastData.isEmpty()))
+      {
+        if(!etag.isEmpty())
+          request.setRawHeader("If-None-Match", etag);
+        if(!lastModified.isEmpty())
+          request.setRawHeader("If-Modified-Since", lastModified);
+      }
+
       reply = networkManager.get(request);
 
       if(reply != nullptr)
@@ -114,6 +155,7 @@ void HttpDownloader::cancelDownload()
   stopTimer();
   deleteReply();
   data.clear();
+  resetStream();
 }
 
 void HttpDownloader::enableCache(int secondsTimeout)
@@ -128,6 +170,39 @@ void HttpDownloader::disableCache()
   dataCache = nullptr;
 }
 
+void HttpDownloader::enableDiskCache(const QString& directory, qint64 maxSizeBytes)
+{
+  QNetworkDiskCache *diskCache = new QNetworkDiskCache;
+  diskCache->setCacheDirectory(directory);
+  diskCache->setMaximumCacheSize(maxSizeBytes);
+
+  // Manager takes ownership and deletes the old cache
+  networkManager.setCache(diskCache);
+  preferDiskCache = true;
+}
+
+void HttpDownloader::disableDiskCache()
+{
+  networkManager.setCache(nullptr);
+  preferDiskCache = false;
+}
+
+void HttpDownloader::saveValidators()
+{
+  if(conditionalRequests && reply != nullptr)
+  {
+    validatorUrl = downloadUrl;
+    etag = reply->rawHeader("ETag");
+    lastModified = reply->rawHeader("Last-Modified");
+    lastData = lineStreaming ? QByteArray() : data;
+  }
+}
+
+bool HttpDownloader::isNotModified() const
+{
+  return reply != nullptr && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304;
+}
+
 void HttpDownloader::startTimer()
 {
   if(updatePeriodSeconds > 0)
@@ -209,10 +284,45 @@ void HttpDownloader::httpFinished()
     if(verbose)
       qDebug() << Q_FUNC_INFO << "URL" << curUrl();
 
+    ATOOLS_PERF_COUNT("http.bytes_downloaded", reply->bytesAvailable());
+
+    if(lineStreaming)
+    {
+      // Remaining lines were already sent - nothing to cache
+      if(reply->error() != QNetworkReply::NoError)
+        emit downloadFailed(reply->errorString(), curUrl());
+      else if(isNotModified())
+      {
+        resetStream();
+        emit downloadNotModified(reply->url().toString());
+      }
+      else if(!streamChunk(reply->readAll(), true, curUrl()))
+        emit downloadFailed(tr("Error decompressing data"), curUrl());
+      else
+      {
+        saveValidators();
+        emit downloadFinished(QByteArray(), reply->url().toString());
+      }
+      deleteReply();
+      startTimer();
+      return;
+    }
+
     data.append(reply->readAll());
 
     if(reply->error() == QNetworkReply::NoError)
     {
+      if(isNotModified())
+      {
+        if(verbose)
+          qDebug() << Q_FUNC_INFO << "Not modified" << curUrl();
+
+        // Reuse data of the last reply
+        data = lastData;
+      }
+      else
+        saveValidators();
+
       if(dataCache != nullptr)
         dataCache->insert(reply->url().toString(), data);
 
@@ -245,10 +355,88 @@ void HttpDownloader::readyRead()
     {
       // if(verbose)
       // qDebug() << Q_FUNC_INFO << "reply->bytesAvailable()" << reply->bytesAvailable() << "URL" << curUrl();
-      data.append(reply->read(reply->bytesAvailable()));
+      ATOOLS_PERF_COUNT("http.bytes_downloaded", reply->bytesAvailable());
+      if(lineStreaming)
+      {
+        if(!streamChunk(reply->read(reply->bytesAvailable()), false, curUrl()))
+        {
+          emit downloadFailed(tr("Error decompressing data"), curUrl());
+          deleteReply();
+          startTimer();
+        }
+      }
+      else
+        data.append(reply->read(reply->bytesAvailable()));
     }
   }
 }
 
+bool HttpDownloader::streamChunk(const QByteArray& chunk, bool last, const QString& url)
+{
+  QByteArray input;
+  if(!streamStarted)
+  {
+    // Collect enough bytes to detect the GZIP magic number
+    streamHeader.append(chunk);
+    if(streamHeader.size() < 2 && !last)
+      return true;
+
+    streamStarted = true;
+    if(atools::zip::GzipInflater::isGzip(streamHeader))
+      inflater = new atools::zip::GzipInflater;
+    input.swap(streamHeader);
+  }
+  else
+    input = chunk;
+
+  if(inflater != nullptr)
+  {
+    if(!inflater->inflateChunk(input, lineBuffer))
+    {
+      qWarning() << Q_FUNC_INFO << "Error decompressing data from" << url;
+      return false;
+    }
+  }
+  else
+    lineBuffer.append(input);
+
+  // Split off complete lines and keep the rest for the next chunk
+  QList<QByteArray> lines;
+  int start = 0, end;
+  while((end = lineBuffer.indexOf('\n', start)) != -1)
+  {
+    int len = end - start;
+    if(len > 0 && lineBuffer.at(end - 1) == '\r')
+      len--;
+    lines.append(lineBuffer.mid(start, len));
+    start = end + 1;
+  }
+  lineBuffer.remove(0, start);
+
+  if(last)
+  {
+    if(!lineBuffer.isEmpty())
+    {
+      if(lineBuffer.endsWith('\r'))
+        lineBuffer.chop(1);
+      lines.append(lineBuffer);
+    }
+    resetStream();
+  }
+
+  if(!lines.isEmpty())
+    emit linesReceived(lines, url);
+  return true;
+}
+
+void HttpDownloader::resetStream()
+{
+  streamStarted = false;
+  lineBuffer.clear();
+  streamHeader.clear();
+  delete inflater;
+  inflater = nullptr;
+}
+
 } // namespace util
 } // namespace atools
@@ -25,6 +25,10 @@
 class QNetworkReply;
 
 namespace atools {
+namespace zip {
+class GzipInflater;
+}
+
 namespace util {
 
 template<typename KEY, typename TYPE>
@@ -61,6 +65,19 @@ public:
   /* Disable and clear cache*/
   void disableCache();
 
+  /* Keep replies in a disk cache in directory limited to maxSizeBytes. Qt revalidates cached replies using
+   * ETag and Last-Modified. The first download after enabling is loaded from the disk cache if not expired. */
+  void enableDiskCache(const QString& directory, qint64 maxSizeBytes);
+  void disableDiskCache();
+
+  /* Send If-None-Match and If-Modified-Since with the validators of the last reply for the same URL.
+   * A "304 Not Modified" reply emits downloadFinished with the last data or downloadNotModified in
+   * line streaming mode. Not used if the disk cache is enabled. */
+  void setConditionalRequests(bool value)
+  {
+    conditionalRequests = value;
+  }
+
   const QString& getUrl() const
   {
     return downloadUrl;
@@ -73,7 +90,15 @@ public:
   void startTimer();
   void stopTimer();
 
-  /* Is valid until next startDownload call */
+  /* Do not collect the data but emit linesReceived for each chunk containing complete lines.
+   * GZIP compressed data is detected and decompressed on the fly. downloadFinished is emitted with empty
+   * data after the last lines. The cache is not used in this mode. */
+  void setLineStreaming(bool value)
+  {
+    lineStreaming = value;
+  }
+
+  /* Is valid until next startDownload call. Empty in line streaming mode. */
   const QByteArray& getData() const
   {
     return data;
@@ -109,10 +134,20 @@ signals:
   void downloadFailed(const QString& error, QString downloadUrl);
   void downloadProgress(qint64 bytesReceived, qint64 bytesTotal, QString downloadUrl);
 
+  /* Server replied "304 Not Modified" in line streaming mode. No lines were sent. */
+  void downloadNotModified(QString downloadUrl);
+
+  /* Complete lines of a chunk without line feed in line streaming mode */
+  void linesReceived(const QList<QByteArray>& lines, QString downloadUrl);
+
 private:
   /* Request completely finished */
   void httpFinished();
 
+  /* Remember ETag and Last-Modified of the reply for conditional requests */
+  void saveValidators();
+  bool isNotModified() const;
+
   /* Cancel request and free resources */
   void deleteReply();
 
@@ -121,6 +156,10 @@ private:
 
   void downloadProgressInternal(qint64 bytesReceived, qint64 bytesTotal);
 
+  /* Decompress if needed, split into lines and emit linesReceived. Returns false if decompression failed. */
+  bool streamChunk(const QByteArray& chunk, bool last, const QString& url);
+  void resetStream();
+
   QString curUrl();
 
   QNetworkAccessManager networkManager;
@@ -131,6 +170,16 @@ private:
   QByteArray data;
   bool verbose;
 
+  /* Validators and data of the last reply for conditional requests */
+  bool conditionalRequests = false, preferDiskCache = false;
+  QString validatorUrl;
+  QByteArray etag, lastModified, lastData;
+
+  /* Line streaming state. Header collects the first bytes to detect compression. */
+  bool lineStreaming = false, streamStarted = false;
+  QByteArray lineBuffer, streamHeader;
+  atools::zip::GzipInflater *inflater = nullptr;
+
   /* Maps URL to result */
   atools::util::TimedCache<QString, QByteArray> *dataCache = nullptr;
 
@@ -0,0 +1,279 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_INDEXEDHEAP_H
+#define ATOOLS_UTIL_INDEXEDHEAP_H
+
+#include <QHash>
+#include <QVector>
+
+#include <algorithm>
+
+namespace atools {
+namespace util {
+
+/* Maps heap data to positions using a hash. Works for all types having qHash. */
+template<typename TYPE>
+class HeapHashPositions
+{
+public:
+  void reserve(int size)
+  {
+    positions.reserve(size);
+  }
+
+  int value(const TYPE& data) const
+  {
+    return positions.value(data, -1);
+  }
+
+  void set(const TYPE& data, int pos)
+  {
+    positions.insert(data, pos);
+  }
+
+  void remove(const TYPE& data)
+  {
+    positions.remove(data);
+  }
+
+  void clear()
+  {
+    positions.clear();
+  }
+
+private:
+  QHash<TYPE, int> positions;
+};
+
+/* Maps dense integer ids 0 to n - 1 like node indexes to positions using an array. Grows as needed. */
+class HeapDensePositions
+{
+public:
+  void reserve(int size)
+  {
+    if(size > positions.size())
+      positions.resize(size);
+    std::fill(positions.begin(), positions.end(), -1);
+  }
+
+  int value(int data) const
+  {
+    return data < positions.size() ? positions.at(data) : -1;
+  }
+
+  void set(int data, int pos)
+  {
+    if(data >= positions.size())
+    {
+      int oldSize = positions.size();
+      positions.resize(std::max(data + 1, oldSize * 2));
+      std::fill(positions.begin() + oldSize, positions.end(), -1);
+    }
+    positions[data] = pos;
+  }
+
+  void remove(int data)
+  {
+    positions[data] = -1;
+  }
+
+  void clear()
+  {
+    std::fill(positions.begin(), positions.end(), -1);
+  }
+
+private:
+  QVector<int> positions;
+};
+
+/*
+ * Binary heap like Heap which keeps track of the position of each element.
+ * contains() is O(1) and change() is O(log n) which is needed for Dijkstra or A* on large graphs.
+ * Each data value can be contained only once.
+ *
+ * Use IndexedHeap for generic data and DenseIndexedHeap for integer ids like node indexes.
+ */
+template<typename TYPE, typename POSITIONS>
+class IndexedHeapBase
+{
+public:
+  IndexedHeapBase(int reserve)
+  {
+    heap.reserve(reserve);
+    positions.reserve(reserve);
+  }
+
+  /* Take an element from the top of the heap. This will be the one with the lowest cost assigned */
+  float pop(TYPE& data);
+  void pop(TYPE& data, float& cost);
+
+  /* Add element to the heap. Calls change() if the element is already contained. */
+  void push(const TYPE& data, float cost);
+
+  bool contains(const TYPE& data) const
+  {
+    return positions.value(data) != -1;
+  }
+
+  /* Update the costs of an element if contained. The heap will be updated. */
+  void change(const TYPE& data, float cost);
+
+  /* Cost of an element or -1 if not contained */
+  float cost(const TYPE& data) const
+  {
+    int pos = positions.value(data);
+    return pos != -1 ? heap.at(pos).cost : -1.f;
+  }
+
+  void clear()
+  {
+    heap.clear();
+    positions.clear();
+  }
+
+  bool isEmpty() const
+  {
+    return heap.isEmpty();
+  }
+
+  int size() const
+  {
+    return heap.size();
+  }
+
+private:
+  struct HeapNode
+  {
+    TYPE data;
+    float cost;
+  };
+
+  void siftUp(int pos);
+  void siftDown(int pos);
+
+  void place(int pos, const HeapNode& node)
+  {
+    heap[pos] = node;
+    positions.set(node.data, pos);
+  }
+
+  QVector<HeapNode> heap;
+  POSITIONS positions;
+};
+
+template<typename TYPE>
+using IndexedHeap = IndexedHeapBase<TYPE, HeapHashPositions<TYPE> >;
+
+typedef IndexedHeapBase<int, HeapDensePositions> DenseIndexedHeap;
+
+template<typename TYPE, typename POSITIONS>
+float IndexedHeapBase<TYPE, POSITIONS>::pop(TYPE& data)
+{
+  HeapNode top = heap.first();
+  positions.remove(top.data);
+
+  HeapNode last = heap.last();
+  heap.removeLast();
+  if(!heap.isEmpty())
+  {
+    place(0, last);
+    siftDown(0);
+  }
+
+  data = top.data;
+  return top.cost;
+}
+
+template<typename TYPE, typename POSITIONS>
+void IndexedHeapBase<TYPE, POSITIONS>::pop(TYPE& data, float& cost)
+{
+  cost = pop(data);
+}
+
+template<typename TYPE, typename POSITIONS>
+void IndexedHeapBase<TYPE, POSITIONS>::push(const TYPE& data, float cost)
+{
+  if(contains(data))
+    change(data, cost);
+  else
+  {
+    heap.append({data, cost});
+    positions.set(data, heap.size() - 1);
+    siftUp(heap.size() - 1);
+  }
+}
+
+template<typename TYPE, typename POSITIONS>
+void IndexedHeapBase<TYPE, POSITIONS>::change(const TYPE& data, float cost)
+{
+  int pos = positions.value(data);
+  if(pos == -1)
+    return;
+
+  float oldCost = heap.at(pos).cost;
+  heap[pos].cost = cost;
+  if(cost < oldCost)
+    siftUp(pos);
+  else
+    siftDown(pos);
+}
+
+template<typename TYPE, typename POSITIONS>
+void IndexedHeapBase<TYPE, POSITIONS>::siftUp(int pos)
+{
+  HeapNode node = heap.at(pos);
+  while(pos > 0)
+  {
+    int parent = (pos - 1) / 2;
+    if(heap.at(parent).cost <= node.cost)
+      break;
+
+    place(pos, heap.at(parent));
+    pos = parent;
+  }
+  place(pos, node);
+}
+
+template<typename TYPE, typename POSITIONS>
+void IndexedHeapBase<TYPE, POSITIONS>::siftDown(int pos)
+{
+  HeapNode node = heap.at(pos);
+  int size = heap.size();
+  while(true)
+  {
+    int child = 2 * pos + 1;
+    if(child >= size)
+      break;
+
+    // Use the smaller child
+    if(child + 1 < size && heap.at(child + 1).cost < heap.at(child).cost)
+      child++;
+
+    if(node.cost <= heap.at(child).cost)
+      break;
+
+    place(pos, heap.at(child));
+    pos = child;
+  }
+  place(pos, node);
+}
+
+} // namespace util
+} // namespace atools
+
+#endif // ATOOLS_UTIL_INDEXEDHEAP_H
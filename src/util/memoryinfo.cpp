@@ -0,0 +1,93 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "util/memoryinfo.h"
+
+#include <QFile>
+
+#if defined(Q_OS_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_MAC)
+#include <mach/mach.h>
+#include <sys/resource.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace atools {
+namespace util {
+
+#if defined(Q_OS_LINUX)
+/* Read value of a line like "VmHWM:     1234 kB" from /proc/self/status */
+static qint64 procStatusKb(const QByteArray& key)
+{
+  QFile file("/proc/self/status");
+  if(file.open(QIODevice::ReadOnly))
+  {
+    // Procfs files have no size - read line by line
+    QByteArray line;
+    while(!(line = file.readLine()).isEmpty())
+    {
+      if(line.startsWith(key))
+        return line.mid(key.size()).simplified().split(' ').value(0).toLongLong();
+    }
+  }
+  return -1;
+}
+
+#endif
+
+qint64 MemoryInfo::currentRssKb()
+{
+#if defined(Q_OS_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return static_cast<qint64>(counters.WorkingSetSize / 1024);
+#elif defined(Q_OS_MAC)
+  mach_task_basic_info info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if(task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS)
+    return static_cast<qint64>(info.resident_size / 1024);
+#elif defined(Q_OS_LINUX)
+  return procStatusKb("VmRSS:");
+#endif
+  return -1;
+}
+
+qint64 MemoryInfo::peakRssKb()
+{
+#if defined(Q_OS_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return static_cast<qint64>(counters.PeakWorkingSetSize / 1024);
+#elif defined(Q_OS_UNIX)
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) == 0)
+#if defined(Q_OS_MAC)
+    // Bytes on macOS
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+  return -1;
+}
+
+} // namespace util
+} // namespace atools
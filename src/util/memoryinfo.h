@@ -0,0 +1,45 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_MEMORYINFO_H
+#define ATOOLS_UTIL_MEMORYINFO_H
+
+#include <QtGlobal>
+
+namespace atools {
+namespace util {
+
+/*
+ * Resident memory of the current process. Values are in kilobytes or -1 if not available on this platform.
+ */
+class MemoryInfo
+{
+public:
+  /* Current resident set size (working set on Windows) */
+  static qint64 currentRssKb();
+
+  /* Highest resident set size since start of the process */
+  static qint64 peakRssKb();
+
+private:
+  MemoryInfo() = delete;
+};
+
+} // namespace util
+} // namespace atools
+
+#endif // ATOOLS_UTIL_MEMORYINFO_H
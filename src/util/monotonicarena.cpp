@@ -0,0 +1,84 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "util/monotonicarena.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+
+namespace atools {
+namespace util {
+
+MonotonicArena::MonotonicArena(size_t blockSizeParam)
+  : blockSize(blockSizeParam)
+{
+}
+
+MonotonicArena::~MonotonicArena()
+{
+  reset();
+  for(const Block& block : blocks)
+    ::operator delete(block.data);
+}
+
+void MonotonicArena::reset()
+{
+  for(int i = objects.size() - 1; i >= 0; i--)
+    objects.at(i).destructor(objects.at(i).ptr);
+  objects.clear();
+
+  currentBlock = 0;
+  currentOffset = 0;
+}
+
+size_t MonotonicArena::getReservedBytes() const
+{
+  size_t bytes = 0;
+  for(const Block& block : blocks)
+    bytes += block.size;
+  return bytes;
+}
+
+void *MonotonicArena::allocate(size_t bytes, size_t alignment)
+{
+  while(currentBlock < blocks.size())
+  {
+    const Block& block = blocks.at(currentBlock);
+    size_t offset = (currentOffset + alignment - 1) & ~(alignment - 1);
+    if(offset + bytes <= block.size)
+    {
+      currentOffset = offset + bytes;
+      return block.data + offset;
+    }
+
+    // Does not fit - try next kept block
+    currentBlock++;
+    currentOffset = 0;
+  }
+
+  // Need a new block - operator new returns memory aligned for any fundamental type
+  Q_ASSERT(alignment <= alignof(std::max_align_t));
+  size_t size = std::max(blockSize, bytes);
+  blocks.append({static_cast<char *>(::operator new(size)), size});
+  currentBlock = blocks.size() - 1;
+  currentOffset = bytes;
+  return blocks.last().data;
+}
+
+} // namespace util
+} // namespace atools
@@ -0,0 +1,140 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_MONOTONICARENA_H
+#define ATOOLS_UTIL_MONOTONICARENA_H
+
+#include <QVector>
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace atools {
+namespace util {
+
+/*
+ * Monotonic buffer that owns objects of arbitrary types. Memory is taken from large blocks and
+ * never freed individually. reset() calls all destructors in reverse order and rewinds the
+ * buffer while keeping the blocks for the next use.
+ *
+ * Not thread safe. Use one arena per thread or reader.
+ */
+class MonotonicArena
+{
+public:
+  explicit MonotonicArena(size_t blockSizeParam = 64 * 1024);
+  ~MonotonicArena();
+
+  MonotonicArena(const MonotonicArena& other) = delete;
+  MonotonicArena& operator=(const MonotonicArena& other) = delete;
+
+  /* Create a new object in the arena. The object is destroyed by reset() or the destructor. */
+  template<typename TYPE, typename ... ARGS>
+  TYPE *create(ARGS&& ... args);
+
+  /* Destroy the last object created and give its memory back to the arena.
+   * Used to drop records that turned out to be invalid or excluded. */
+  template<typename TYPE>
+  void destroyLast(TYPE *obj);
+
+  /* Destroy all objects and rewind. Allocated blocks are kept. */
+  void reset();
+
+  /* Number of live objects */
+  int size() const
+  {
+    return objects.size();
+  }
+
+  /* Total memory reserved in blocks */
+  size_t getReservedBytes() const;
+
+private:
+  struct Block
+  {
+    char *data;
+    size_t size;
+  };
+
+  /* Registered object with its destructor and the buffer position before allocation */
+  struct Object
+  {
+    void *ptr;
+    void (*destructor)(void *);
+    int block;
+    size_t offset;
+  };
+
+  template<typename TYPE>
+  static void destroy(void *ptr)
+  {
+    static_cast<TYPE *>(ptr)->~TYPE();
+  }
+
+  void *allocate(size_t bytes, size_t alignment);
+
+  QVector<Block> blocks;
+  QVector<Object> objects;
+  size_t blockSize;
+  int currentBlock = 0;
+  size_t currentOffset = 0;
+};
+
+// -------------------------------------------------------------------
+
+template<typename TYPE, typename ... ARGS>
+TYPE *MonotonicArena::create(ARGS&& ... args)
+{
+  int block = currentBlock;
+  size_t offset = currentOffset;
+
+  void *ptr = allocate(sizeof(TYPE), alignof(TYPE));
+  TYPE *obj = nullptr;
+  try
+  {
+    obj = new (ptr)TYPE(std::forward<ARGS>(args) ...);
+  }
+  catch(...)
+  {
+    // Give memory back and pass exception on
+    currentBlock = block;
+    currentOffset = offset;
+    throw;
+  }
+
+  objects.append({obj, &MonotonicArena::destroy<TYPE>, block, offset});
+  return obj;
+}
+
+template<typename TYPE>
+void MonotonicArena::destroyLast(TYPE *obj)
+{
+  if(objects.isEmpty() || objects.last().ptr != obj)
+    return;
+
+  const Object& last = objects.last();
+  last.destructor(last.ptr);
+  currentBlock = last.block;
+  currentOffset = last.offset;
+  objects.removeLast();
+}
+
+} // namespace util
+} // namespace atools
+
+#endif // ATOOLS_UTIL_MONOTONICARENA_H
@@ -0,0 +1,255 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "util/perfcounters.h"
+
+#include <QDebug>
+#include <QJsonObject>
+#include <QMap>
+#include <QMutex>
+
+#include <algorithm>
+
+namespace atools {
+namespace util {
+
+/* Registry content. Objects are never deleted. */
+struct PerfRegistryData
+{
+  QMutex mutex;
+  QMap<QString, PerfCounter *> counters;
+  QMap<QString, PerfHistogram *> histograms;
+};
+
+static PerfRegistryData& registryData()
+{
+  static PerfRegistryData *data = new PerfRegistryData;
+  return *data;
+}
+
+/* Bucket for value. 0 for value 0, otherwise number of significant bits. */
+static int bucketIndex(quint64 value)
+{
+  int index = 0;
+  while(value > 0 && index < 63)
+  {
+    value >>= 1;
+    index++;
+  }
+  return index;
+}
+
+// ==========================================================================
+PerfCounter::PerfCounter(const QString& counterName)
+  : name(counterName)
+{
+  reset();
+}
+
+qint64 PerfCounter::getValue() const
+{
+  qint64 value = 0;
+  for(const Shard& shard : shards)
+    value += shard.value.load(std::memory_order_relaxed);
+  return value;
+}
+
+void PerfCounter::reset()
+{
+  for(Shard& shard : shards)
+    shard.value.store(0, std::memory_order_relaxed);
+}
+
+int PerfCounter::shardIndex()
+{
+  static std::atomic<int> nextIndex(0);
+  thread_local int index = nextIndex.fetch_add(1, std::memory_order_relaxed) % NUM_SHARDS;
+  return index;
+}
+
+// ==========================================================================
+PerfHistogram::PerfHistogram(const QString& histogramName)
+  : name(histogramName)
+{
+  reset();
+}
+
+void PerfHistogram::addSample(qint64 value)
+{
+  value = std::max(value, 0LL);
+
+  buckets[bucketIndex(static_cast<quint64>(value))].fetch_add(1, std::memory_order_relaxed);
+  sum.fetch_add(value, std::memory_order_relaxed);
+
+  qint64 curMax = maxValue.load(std::memory_order_relaxed);
+  while(value > curMax && !maxValue.compare_exchange_weak(curMax, value, std::memory_order_relaxed))
+    ;
+}
+
+qint64 PerfHistogram::getCount() const
+{
+  qint64 count = 0;
+  for(const std::atomic<qint64>& bucket : buckets)
+    count += bucket.load(std::memory_order_relaxed);
+  return count;
+}
+
+qint64 PerfHistogram::getSum() const
+{
+  return sum.load(std::memory_order_relaxed);
+}
+
+qint64 PerfHistogram::getMax() const
+{
+  return maxValue.load(std::memory_order_relaxed);
+}
+
+qint64 PerfHistogram::getPercentile(int percent) const
+{
+  qint64 count = getCount();
+  if(count == 0)
+    return 0;
+
+  // Nearest rank
+  qint64 rank = std::max((percent * count + 99) / 100, 1LL), seen = 0;
+  for(int i = 0; i < NUM_BUCKETS; i++)
+  {
+    seen += buckets[i].load(std::memory_order_relaxed);
+    if(seen >= rank)
+      // Upper limit of bucket but not more than the maximum
+      return i == 0 ? 0 : std::min((1LL << i) - 1, getMax());
+  }
+  return getMax();
+}
+
+void PerfHistogram::reset()
+{
+  for(std::atomic<qint64>& bucket : buckets)
+    bucket.store(0, std::memory_order_relaxed);
+  sum.store(0, std::memory_order_relaxed);
+  maxValue.store(0, std::memory_order_relaxed);
+}
+
+// ==========================================================================
+PerfCounter *PerfRegistry::counter(const QString& name)
+{
+  PerfRegistryData& data = registryData();
+  QMutexLocker locker(&data.mutex);
+
+  PerfCounter *& counter = data.counters[name];
+  if(counter == nullptr)
+    counter = new PerfCounter(name);
+  return counter;
+}
+
+PerfHistogram *PerfRegistry::histogram(const QString& name)
+{
+  PerfRegistryData& data = registryData();
+  QMutexLocker locker(&data.mutex);
+
+  PerfHistogram *& histogram = data.histograms[name];
+  if(histogram == nullptr)
+    histogram = new PerfHistogram(name);
+  return histogram;
+}
+
+void PerfRegistry::reset()
+{
+  PerfRegistryData& data = registryData();
+  QMutexLocker locker(&data.mutex);
+
+  for(PerfCounter *counter : data.counters)
+    counter->reset();
+  for(PerfHistogram *histogram : data.histograms)
+    histogram->reset();
+}
+
+bool PerfRegistry::isEmpty()
+{
+  PerfRegistryData& data = registryData();
+  QMutexLocker locker(&data.mutex);
+
+  for(const PerfCounter *counter : data.counters)
+  {
+    if(counter->getValue() != 0)
+      return false;
+  }
+  for(const PerfHistogram *histogram : data.histograms)
+  {
+    if(histogram->getCount() > 0)
+      return false;
+  }
+  return true;
+}
+
+void PerfRegistry::print(QDebug& out)
+{
+  PerfRegistryData& data = registryData();
+  QMutexLocker locker(&data.mutex);
+
+  QDebugStateSaver saver(out);
+  out.noquote().nospace();
+
+  for(const PerfCounter *counter : data.counters)
+  {
+    if(counter->getValue() != 0)
+      out << endl << "Counter " << counter->getName() << ": " << counter->getValue();
+  }
+
+  for(const PerfHistogram *histogram : data.histograms)
+  {
+    qint64 count = histogram->getCount();
+    if(count > 0)
+      out << endl << "Histogram " << histogram->getName() << ": count " << count
+          << " mean " << histogram->getSum() / count
+          << " p50 " << histogram->getPercentile(50)
+          << " p95 " << histogram->getPercentile(95)
+          << " p99 " << histogram->getPercentile(99)
+          << " max " << histogram->getMax();
+  }
+}
+
+QJsonObject PerfRegistry::toJson()
+{
+  PerfRegistryData& data = registryData();
+  QMutexLocker locker(&data.mutex);
+
+  QJsonObject counters;
+  for(const PerfCounter *counter : data.counters)
+    counters.insert(counter->getName(), counter->getValue());
+
+  QJsonObject histograms;
+  for(const PerfHistogram *histogram : data.histograms)
+  {
+    QJsonObject obj;
+    obj.insert("count", histogram->getCount());
+    obj.insert("sum", histogram->getSum());
+    obj.insert("p50", histogram->getPercentile(50));
+    obj.insert("p95", histogram->getPercentile(95));
+    obj.insert("p99", histogram->getPercentile(99));
+    obj.insert("max", histogram->getMax());
+    histograms.insert(histogram->getName(), obj);
+  }
+
+  QJsonObject json;
+  json.insert("counters", counters);
+  json.insert("histograms", histograms);
+  return json;
+}
+
+} // namespace util
+} // namespace atools
@@ -0,0 +1,200 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_PERFCOUNTERS_H
+#define ATOOLS_UTIL_PERFCOUNTERS_H
+
+#include <QString>
+
+#include <atomic>
+#include <chrono>
+
+class QDebug;
+class QJsonObject;
+
+namespace atools {
+namespace util {
+
+/*
+ * Named event counter. Values are added to one of several padded atomic shards selected by a thread local
+ * index to avoid contention between threads. Reading sums up all shards.
+ *
+ * Get instances from PerfRegistry only. Thread safe.
+ */
+class PerfCounter
+{
+public:
+  void add(qint64 value = 1)
+  {
+    shards[shardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  qint64 getValue() const;
+
+  const QString& getName() const
+  {
+    return name;
+  }
+
+private:
+  friend class PerfRegistry;
+
+  explicit PerfCounter(const QString& counterName);
+  PerfCounter(const PerfCounter& other) = delete;
+  PerfCounter& operator=(const PerfCounter& other) = delete;
+
+  void reset();
+
+  /* Index of the shard for the calling thread */
+  static int shardIndex();
+
+  static const int NUM_SHARDS = 16;
+
+  /* Padded to a cache line */
+  struct Shard
+  {
+    std::atomic<qint64> value;
+    char padding[64 - sizeof(std::atomic<qint64>)];
+  };
+
+  Shard shards[NUM_SHARDS];
+  QString name;
+};
+
+/*
+ * Named histogram with buckets for powers of two. Percentiles are estimated with the upper limit of the bucket.
+ * Used for durations in microseconds by PerfTimer but can take any positive values.
+ *
+ * Get instances from PerfRegistry only. Thread safe.
+ */
+class PerfHistogram
+{
+public:
+  /* Negative values are counted as 0 */
+  void addSample(qint64 value);
+
+  qint64 getCount() const;
+  qint64 getSum() const;
+  qint64 getMax() const;
+
+  /* Estimated percentile. 0 if empty. */
+  qint64 getPercentile(int percent) const;
+
+  const QString& getName() const
+  {
+    return name;
+  }
+
+private:
+  friend class PerfRegistry;
+
+  explicit PerfHistogram(const QString& histogramName);
+  PerfHistogram(const PerfHistogram& other) = delete;
+  PerfHistogram& operator=(const PerfHistogram& other) = delete;
+
+  void reset();
+
+  static const int NUM_BUCKETS = 64;
+
+  std::atomic<qint64> buckets[NUM_BUCKETS];
+  std::atomic<qint64> sum, maxValue;
+  QString name;
+};
+
+/*
+ * Adds the time in microseconds between construction and destruction to a histogram.
+ */
+class PerfTimer
+{
+public:
+  explicit PerfTimer(atools::util::PerfHistogram *perfHistogram)
+    : histogram(perfHistogram), start(std::chrono::steady_clock::now())
+  {
+  }
+
+  ~PerfTimer()
+  {
+    histogram->addSample(std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - start).count());
+  }
+
+private:
+  PerfTimer(const PerfTimer& other) = delete;
+  PerfTimer& operator=(const PerfTimer& other) = delete;
+
+  atools::util::PerfHistogram *histogram;
+  std::chrono::steady_clock::time_point start;
+};
+
+/*
+ * Library wide registry of performance counters and histograms. Objects are created on first use and never
+ * deleted, so pointers can be cached in static variables. Use the ATOOLS_PERF_* macros for this.
+ *
+ * Lookup by name needs a lock. Updating counters is lock free. Thread safe.
+ */
+class PerfRegistry
+{
+public:
+  /* Get or create counter */
+  static atools::util::PerfCounter *counter(const QString& name);
+
+  /* Get or create histogram */
+  static atools::util::PerfHistogram *histogram(const QString& name);
+
+  /* Set all values to zero */
+  static void reset();
+
+  /* true if no counter or histogram has values */
+  static bool isEmpty();
+
+  /* Print one line for each counter and histogram having values ordered by name */
+  static void print(QDebug& out);
+
+  /* Object with "counters" and "histograms" containing all values */
+  static QJsonObject toJson();
+
+private:
+  PerfRegistry() = delete;
+};
+
+} // namespace util
+} // namespace atools
+
+#define ATOOLS_PERF_CONCAT_INTERNAL(a, b) a ## b
+#define ATOOLS_PERF_CONCAT(a, b) ATOOLS_PERF_CONCAT_INTERNAL(a, b)
+
+/* Add value to counter. The counter is looked up on the first call only. */
+#define ATOOLS_PERF_COUNT(name, value) \
+  do { \
+    static atools::util::PerfCounter *atoolsPerfCounter = atools::util::PerfRegistry::counter(name); \
+    atoolsPerfCounter->add(value); \
+  } while(false)
+
+/* Add sample to histogram. The histogram is looked up on the first call only. */
+#define ATOOLS_PERF_SAMPLE(name, value) \
+  do { \
+    static atools::util::PerfHistogram *atoolsPerfHistogram = atools::util::PerfRegistry::histogram(name); \
+    atoolsPerfHistogram->addSample(value); \
+  } while(false)
+
+/* Measure time until end of scope in microseconds and add it to histogram */
+#define ATOOLS_PERF_SCOPED_TIMER(name) \
+  static atools::util::PerfHistogram *ATOOLS_PERF_CONCAT(atoolsPerfHistogram, __LINE__) = \
+    atools::util::PerfRegistry::histogram(name); \
+  atools::util::PerfTimer ATOOLS_PERF_CONCAT(atoolsPerfTimer, __LINE__)(ATOOLS_PERF_CONCAT(atoolsPerfHistogram, __LINE__))
+
+#endif // ATOOLS_UTIL_PERFCOUNTERS_H
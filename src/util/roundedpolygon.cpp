@@ -17,66 +17,91 @@
 
 #include "util/roundedpolygon.h"
 
-#include <QPainterPath>
+#include <QHash>
+
+#include <algorithm>
 #include <cmath>
 
 namespace atools {
 namespace util {
 
-double RoundedPolygon::distance(QPointF pt1, QPointF pt2) const
+/* Point at the given ratio on the line from pt1 to pt2 */
+inline static QPointF interpolate(const QPointF& pt1, const QPointF& pt2, double ratio)
 {
-  return std::sqrt((pt1.x() - pt2.x()) * (pt1.x() - pt2.x()) +
-                   (pt1.y() - pt2.y()) * (pt1.y() - pt2.y()));
+  return QPointF((1.0 - ratio) * pt1.x() + ratio * pt2.x(), (1.0 - ratio) * pt1.y() + ratio * pt2.y());
 }
 
-QPointF RoundedPolygon::lineStart(int i) const
+void RoundedPolygon::buildPath(QPainterPath& path, const QPolygonF& polygon, double cornerRadius)
 {
-  QPointF pt1 = at(i);
-  QPointF pt2 = at((i + 1) % count());
-  double ratio = radius / distance(pt1, pt2);
-  if(ratio > 0.5)
-    ratio = 0.5;
-
-  return QPointF((1.0 - ratio) * pt1.x() + ratio * pt2.x(),
-                 (1.0 - ratio) * pt1.y() + ratio * pt2.y());
+  int num = polygon.size();
+  if(num < 3)
+    return;
+
+  QPointF firstStart;
+  for(int i = 0; i < num; i++)
+  {
+    const QPointF& pt1 = polygon.at(i);
+    const QPointF& pt2 = polygon.at((i + 1) % num);
+
+    // Calculate distance only once for start and end of the line
+    double dist = std::sqrt((pt1.x() - pt2.x()) * (pt1.x() - pt2.x()) + (pt1.y() - pt2.y()) * (pt1.y() - pt2.y()));
+    double ratio = dist > 0. ? std::min(cornerRadius / dist, 0.5) : 0.5;
+
+    QPointF start = interpolate(pt1, pt2, ratio);
+    if(i == 0)
+    {
+      path.moveTo(start);
+      firstStart = start;
+    }
+    else
+      path.quadTo(pt1, start);
+
+    path.lineTo(interpolate(pt1, pt2, 1.0 - ratio));
+  }
+
+  path.quadTo(polygon.at(0), firstStart);
 }
 
-QPointF RoundedPolygon::lineEnd(int i) const
+const QPainterPath& RoundedPolygon::getPainterPath() const
 {
-  QPointF pt1 = at(i);
-  QPointF pt2 = at((i + 1) % count());
-  double ratio = radius / distance(pt1, pt2);
-  if(ratio > 0.5)
-    ratio = 0.5;
-  return QPointF(ratio * pt1.x() + (1.0 - ratio) * pt2.x(),
-                 ratio * pt1.y() + (1.0 - ratio) * pt2.y());
+  if(cachedRadius != radius || cachedPoints != *this)
+  {
+    cachedPath = QPainterPath();
+    buildPath(cachedPath, *this, radius);
+    cachedPoints = *this;
+    cachedRadius = radius;
+  }
+  return cachedPath;
 }
 
-QPainterPath RoundedPolygon::getPainterPath()
+void RoundedPolygon::addRoundedRects(QPainterPath& path, const QVector<QRectF>& rects, float cornerRadius)
 {
-  QPainterPath path;
-
-  if(count() < 3)
-    return path;
+  // Paths at origin for each rectangle size
+  QHash<QPair<qreal, qreal>, QPainterPath> sizePaths;
 
-  QPointF pt1;
-  QPointF pt2;
-  for(int i = 0; i < count(); i++)
+  for(const QRectF& rect : rects)
   {
-    pt1 = lineStart(i);
-
-    if(i == 0)
-      path.moveTo(pt1);
-    else
-      path.quadTo(at(i), pt1);
+    QPair<qreal, qreal> key(rect.width(), rect.height());
+    QHash<QPair<qreal, qreal>, QPainterPath>::iterator it = sizePaths.find(key);
+    if(it == sizePaths.end())
+    {
+      // Four corners only - QPolygonF(QRectF) would add the closing point
+      QPolygonF corners;
+      corners << QPointF(0., 0.) << QPointF(rect.width(), 0.) << QPointF(rect.width(), rect.height())
+              << QPointF(0., rect.height());
 
-    pt2 = lineEnd(i);
-    path.lineTo(pt2);
+      QPainterPath sizePath;
+      buildPath(sizePath, corners, cornerRadius);
+      it = sizePaths.insert(key, sizePath);
+    }
+    path.addPath(it.value().translated(rect.topLeft()));
   }
+}
 
-  pt1 = lineStart(0);
-  path.quadTo(at(0), pt1);
-
+QPainterPath RoundedPolygon::getPainterPath(const QVector<QRectF>& rects, float cornerRadius)
+{
+  QPainterPath path;
+  addRoundedRects(path, rects, cornerRadius);
   return path;
 }
 
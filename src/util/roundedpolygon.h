@@ -19,8 +19,7 @@
 #define ROUNDEDPOLYGON_H
 
 #include <QPolygonF>
-
-class QPainterPath;
+#include <QPainterPath>
 
 namespace atools {
 namespace util {
@@ -43,15 +42,37 @@ public:
   {
   }
 
-  /* Builds a path of the polygon with rounded corners */
-  QPainterPath getPainterPath();
+  /* Builds a path of the polygon with rounded corners. The path is cached and only rebuilt if points or
+   * radius were changed since the last call. */
+  const QPainterPath& getPainterPath() const;
+
+  float getRadius() const
+  {
+    return radius;
+  }
+
+  void setRadius(float value)
+  {
+    radius = value;
+  }
+
+  /* Adds a closed subpath for each rectangle with rounded corners to path. Rectangles of the same size
+   * share the corner geometry. Use this to draw many label boxes with one call to QPainter::drawPath(). */
+  static void addRoundedRects(QPainterPath& path, const QVector<QRectF>& rects, float cornerRadius);
+
+  /* Builds a path containing all rounded rectangles */
+  static QPainterPath getPainterPath(const QVector<QRectF>& rects, float cornerRadius);
 
 private:
-  QPointF lineStart(int i) const;
-  QPointF lineEnd(int i) const;
-  double distance(QPointF pt1, QPointF pt2) const;
+  /* Adds the rounded polygon as closed subpath to the path */
+  static void buildPath(QPainterPath& path, const QPolygonF& polygon, double cornerRadius);
 
   float radius;
+
+  /* Path cache and the values it was built from */
+  mutable QPainterPath cachedPath;
+  mutable QPolygonF cachedPoints;
+  mutable float cachedRadius = -1.f;
 };
 
 } // namespace util
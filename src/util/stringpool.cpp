@@ -0,0 +1,146 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "util/stringpool.h"
+
+namespace atools {
+namespace util {
+
+StringPool::StringPool()
+{
+}
+
+StringPool::~StringPool()
+{
+}
+
+StringPool& StringPool::instance()
+{
+  // Never deleted to allow use in destructors of static objects
+  static StringPool *pool = new StringPool;
+  return *pool;
+}
+
+StringPool& StringPool::compileInstance()
+{
+  static StringPool *pool = new StringPool;
+  return *pool;
+}
+
+QString StringPool::intern(const QString& str)
+{
+  QString result;
+  if(lookup(str, &result) == -1)
+    return str;
+  else
+    return result;
+}
+
+QString StringPool::intern(const QStringRef& str)
+{
+  QString result;
+  if(lookup(str, &result) == -1)
+    return str.toString();
+  else
+    return result;
+}
+
+int StringPool::id(const QString& str)
+{
+  return lookup(str, nullptr);
+}
+
+int StringPool::id(const QStringRef& str)
+{
+  return lookup(str, nullptr);
+}
+
+template<typename STRING>
+int StringPool::lookup(const STRING& str, QString *result)
+{
+  if(str.isEmpty() || str.size() > MAX_LENGTH)
+    return -1;
+
+  // qHash() gives the same value for QString and QStringRef
+  uint hash = qHash(str);
+  int shardIndex = static_cast<int>((hash ^ (hash >> 16)) % NUM_SHARDS);
+  Shard& shard = shards[shardIndex];
+
+  QMutexLocker locker(&shard.mutex);
+  QVarLengthArray<int, 1>& indexes = shard.indexes[hash];
+  for(int index : indexes)
+  {
+    const QString& pooled = shard.strings.at(index);
+    if(pooled == str)
+    {
+      if(result != nullptr)
+        *result = pooled;
+      return index * NUM_SHARDS + shardIndex;
+    }
+  }
+
+  if(shard.strings.size() >= MAX_SHARD_SIZE)
+  {
+    if(indexes.isEmpty())
+      shard.indexes.remove(hash);
+    return -1;
+  }
+
+  // Copy to avoid keeping over allocated buffers of parsed strings in the pool
+  QString value(str.constData(), str.size());
+  indexes.append(shard.strings.size());
+  shard.strings.append(value);
+
+  if(result != nullptr)
+    *result = value;
+  return (shard.strings.size() - 1) * NUM_SHARDS + shardIndex;
+}
+
+QString StringPool::string(int id) const
+{
+  if(id < 0)
+    return QString();
+
+  const Shard& shard = shards[id % NUM_SHARDS];
+  QMutexLocker locker(&shard.mutex);
+  int index = id / NUM_SHARDS;
+  return index < shard.strings.size() ? shard.strings.at(index) : QString();
+}
+
+int StringPool::size() const
+{
+  int size = 0;
+  for(const Shard& shard : shards)
+  {
+    QMutexLocker locker(&shard.mutex);
+    size += shard.strings.size();
+  }
+  return size;
+}
+
+void StringPool::clear()
+{
+  for(Shard& shard : shards)
+  {
+    QMutexLocker locker(&shard.mutex);
+    shard.indexes.clear();
+    shard.strings.clear();
+  }
+}
+
+} // namespace util
+} // namespace atools
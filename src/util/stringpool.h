@@ -0,0 +1,98 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_STRINGPOOL_H
+#define ATOOLS_UTIL_STRINGPOOL_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVarLengthArray>
+#include <QVector>
+
+namespace atools {
+namespace util {
+
+/*
+ * Thread safe pool of short strings like idents, region codes and types which are repeated in many records.
+ * intern() returns an implicitly shared instance so each distinct value is allocated only once.
+ * Each pooled string has a small integer id which can be used as a compact key.
+ *
+ * The pool is split into shards with separate locks to reduce contention between reader threads.
+ * Strings longer than MAX_LENGTH and strings added after a shard is full are returned unchanged and have no id.
+ */
+class StringPool
+{
+public:
+  StringPool();
+  ~StringPool();
+
+  /* Global pool used by flight plan readers and the read side memory store. Never cleared. */
+  static atools::util::StringPool& instance();
+
+  /* Pool used by the database compilers. Cleared by atools::fs::NavDatabase when the last running
+   * compilation is finished. Use intern() only since ids are not valid after a compilation. */
+  static atools::util::StringPool& compileInstance();
+
+  /* Get shared instance of the string. Lookup of QStringRef does not allocate if the string is already pooled. */
+  QString intern(const QString& str);
+  QString intern(const QStringRef& str);
+
+  /* Get id of the string, adding it to the pool if needed. Returns -1 for empty, long or not pooled strings. */
+  int id(const QString& str);
+  int id(const QStringRef& str);
+
+  /* Get string for id or an empty string if id is not valid */
+  QString string(int id) const;
+
+  /* Number of pooled strings */
+  int size() const;
+
+  /* Remove all strings. Invalidates all ids but strings returned by intern() stay valid. */
+  void clear();
+
+  /* Strings longer than this are not pooled */
+  static constexpr int MAX_LENGTH = 12;
+
+private:
+  StringPool(const StringPool& other) = delete;
+  StringPool& operator=(const StringPool& other) = delete;
+
+  template<typename STRING>
+  int lookup(const STRING& str, QString *result);
+
+  static constexpr int NUM_SHARDS = 16;
+
+  /* Maximum number of strings per shard */
+  static constexpr int MAX_SHARD_SIZE = 1 << 18;
+
+  struct Shard
+  {
+    mutable QMutex mutex;
+
+    /* Map from hash value to indexes in strings. Collisions are resolved by comparing all indexes. */
+    QHash<uint, QVarLengthArray<int, 1> > indexes;
+    QVector<QString> strings;
+  };
+
+  Shard shards[NUM_SHARDS];
+};
+
+} // namespace util
+} // namespace atools
+
+#endif // ATOOLS_UTIL_STRINGPOOL_H
@@ -0,0 +1,280 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "util/taskscheduler.h"
+
+#include <QDebug>
+#include <QThread>
+
+namespace atools {
+namespace util {
+
+/* Queue of one worker. Owner pushes and pops at the back, thieves take from the front. */
+struct TaskQueue
+{
+  QMutex mutex;
+  std::deque<TaskScheduler::Task> tasks;
+};
+
+class TaskWorker :
+  public QThread
+{
+public:
+  TaskWorker(TaskScheduler *taskScheduler, int index)
+    : scheduler(taskScheduler), workerIndex(index)
+  {
+  }
+
+  virtual void run() override
+  {
+    scheduler->workerLoop(workerIndex);
+  }
+
+  TaskScheduler *scheduler;
+  int workerIndex;
+};
+
+/* Scheduler and worker index of the current thread */
+static thread_local const TaskScheduler *threadScheduler = nullptr;
+static thread_local int threadWorkerIndex = -1;
+
+TaskScheduler::TaskScheduler(int numThreads)
+{
+  if(numThreads < 1)
+    numThreads = std::max(QThread::idealThreadCount(), 1);
+
+  for(int i = 0; i < numThreads; i++)
+    queues.append(new TaskQueue);
+
+  for(int i = 0; i < numThreads; i++)
+  {
+    TaskWorker *worker = new TaskWorker(this, i);
+    workers.append(worker);
+    worker->start();
+  }
+  qDebug() << Q_FUNC_INFO << "Started" << numThreads << "workers";
+}
+
+TaskScheduler::~TaskScheduler()
+{
+  {
+    QMutexLocker locker(&sleepMutex);
+    stopping = true;
+    sleepCondition.wakeAll();
+  }
+
+  for(TaskWorker *worker : workers)
+  {
+    worker->wait();
+    delete worker;
+  }
+  qDeleteAll(queues);
+}
+
+int TaskScheduler::currentWorkerIndex() const
+{
+  return threadScheduler == this ? threadWorkerIndex : -1;
+}
+
+void TaskScheduler::push(TaskGroup *group, const std::function<void()>& function)
+{
+  // Count first to avoid workers going to sleep with a task in a queue
+  numPending.fetchAndAddOrdered(1);
+
+  int index = currentWorkerIndex();
+  if(index != -1)
+  {
+    QMutexLocker locker(&queues.at(index)->mutex);
+    queues.at(index)->tasks.push_back({group, function});
+  }
+  else
+  {
+    QMutexLocker locker(&sharedMutex);
+    sharedQueue.push_back({group, function});
+  }
+
+  QMutexLocker locker(&sleepMutex);
+  sleepCondition.wakeOne();
+}
+
+bool TaskScheduler::takeTask(Task& task, int workerIndex)
+{
+  // Own queue newest first - keeps data of nested tasks in the caches
+  if(workerIndex != -1)
+  {
+    QMutexLocker locker(&queues.at(workerIndex)->mutex);
+    std::deque<Task>& tasks = queues.at(workerIndex)->tasks;
+    if(!tasks.empty())
+    {
+      task = tasks.back();
+      tasks.pop_back();
+      numPending.fetchAndAddOrdered(-1);
+      return true;
+    }
+  }
+
+  {
+    QMutexLocker locker(&sharedMutex);
+    if(!sharedQueue.empty())
+    {
+      task = sharedQueue.front();
+      sharedQueue.pop_front();
+      numPending.fetchAndAddOrdered(-1);
+      return true;
+    }
+  }
+
+  // Steal oldest task from other workers
+  for(int i = 1; i <= queues.size(); i++)
+  {
+    int victim = (std::max(workerIndex, 0) + i) % queues.size();
+    if(victim == workerIndex)
+      continue;
+
+    QMutexLocker locker(&queues.at(victim)->mutex);
+    std::deque<Task>& tasks = queues.at(victim)->tasks;
+    if(!tasks.empty())
+    {
+      task = tasks.front();
+      tasks.pop_front();
+      numPending.fetchAndAddOrdered(-1);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TaskScheduler::runOne()
+{
+  Task task;
+  if(takeTask(task, currentWorkerIndex()))
+  {
+    execute(task);
+    return true;
+  }
+  return false;
+}
+
+void TaskScheduler::execute(Task& task)
+{
+  std::exception_ptr exception;
+  if(!task.group->isCanceled())
+  {
+    try
+    {
+      task.function();
+    }
+    catch(...)
+    {
+      exception = std::current_exception();
+    }
+  }
+
+  // Release captured data before the group is signaled
+  task.function = nullptr;
+  task.group->taskDone(exception);
+}
+
+void TaskScheduler::workerLoop(int workerIndex)
+{
+  threadScheduler = this;
+  threadWorkerIndex = workerIndex;
+
+  while(true)
+  {
+    Task task;
+    if(takeTask(task, workerIndex))
+    {
+      execute(task);
+      continue;
+    }
+
+    QMutexLocker locker(&sleepMutex);
+    if(stopping && numPending.loadAcquire() == 0)
+      break;
+
+    if(numPending.loadAcquire() == 0)
+      sleepCondition.wait(&sleepMutex);
+  }
+}
+
+// =====================================================================================
+TaskGroup::TaskGroup(TaskScheduler& taskScheduler)
+  : scheduler(taskScheduler)
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+  try
+  {
+    wait();
+  }
+  catch(std::exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Unhandled task exception" << e.what();
+  }
+  catch(...)
+  {
+    qWarning() << Q_FUNC_INFO << "Unhandled task exception";
+  }
+}
+
+void TaskGroup::run(const std::function<void()>& function)
+{
+  pending.fetchAndAddOrdered(1);
+  scheduler.push(this, function);
+}
+
+void TaskGroup::wait()
+{
+  while(pending.loadAcquire() > 0)
+  {
+    // Help instead of blocking a worker
+    if(scheduler.runOne())
+      continue;
+
+    QMutexLocker locker(&mutex);
+    if(pending.loadAcquire() > 0)
+      // Wake up periodically to help with tasks added by other threads
+      doneCondition.wait(&mutex, 5);
+  }
+
+  std::exception_ptr exception;
+  {
+    QMutexLocker locker(&mutex);
+    std::swap(exception, firstException);
+  }
+  if(exception)
+    std::rethrow_exception(exception);
+}
+
+void TaskGroup::taskDone(std::exception_ptr exception)
+{
+  QMutexLocker locker(&mutex);
+  if(exception && !firstException)
+  {
+    firstException = exception;
+    canceled.storeRelease(1);
+  }
+
+  if(pending.fetchAndAddOrdered(-1) == 1)
+    doneCondition.wakeAll();
+}
+
+} // namespace util
+} // namespace atools
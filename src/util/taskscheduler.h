@@ -0,0 +1,166 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_TASKSCHEDULER_H
+#define ATOOLS_UTIL_TASKSCHEDULER_H
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <deque>
+#include <exception>
+#include <functional>
+
+namespace atools {
+namespace util {
+
+class TaskGroup;
+class TaskWorker;
+struct TaskQueue;
+
+/*
+ * Work stealing task scheduler with a fixed number of worker threads to be shared by all parallel stages.
+ *
+ * Each worker has its own double ended queue. Tasks started from within a worker are pushed to the queue of
+ * this worker and executed in last in first out order. Idle workers steal the oldest tasks of other workers.
+ * Tasks started from other threads go into a shared queue.
+ *
+ * Tasks are always started through a TaskGroup. Threads waiting for a group execute pending tasks themselves
+ * which allows nested groups without blocking workers or oversubscribing cores.
+ */
+class TaskScheduler
+{
+public:
+  /* Number of threads is QThread::idealThreadCount() if numThreads < 1 */
+  explicit TaskScheduler(int numThreads = 0);
+
+  /* Waits for all tasks and stops the workers */
+  ~TaskScheduler();
+
+  TaskScheduler(const TaskScheduler& other) = delete;
+  TaskScheduler& operator=(const TaskScheduler& other) = delete;
+
+  int getNumThreads() const
+  {
+    return workers.size();
+  }
+
+  /* Called before each task is started. Tasks of all groups are skipped if it returns true.
+   * Has to be thread safe. E.g. ProgressHandler::isAborted(). */
+  void setCancelCheck(const std::function<bool()>& value)
+  {
+    cancelCheck = value;
+  }
+
+  bool isCanceled() const
+  {
+    return cancelCheck && cancelCheck();
+  }
+
+private:
+  friend class atools::util::TaskGroup;
+  friend class atools::util::TaskWorker;
+  friend struct atools::util::TaskQueue;
+
+  struct Task
+  {
+    atools::util::TaskGroup *group;
+    std::function<void()> function;
+  };
+
+  /* Add task to the queue of the current worker or to the shared queue */
+  void push(atools::util::TaskGroup *group, const std::function<void()>& function);
+
+  /* Take a task from own queue, shared queue or other workers. Returns false if nothing is pending. */
+  bool takeTask(Task& task, int workerIndex);
+
+  /* Take and execute one task in the calling thread. Returns false if nothing is pending. */
+  bool runOne();
+
+  void execute(Task& task);
+
+  /* Worker thread loop */
+  void workerLoop(int workerIndex);
+
+  /* Index of the calling worker or -1 for other threads */
+  int currentWorkerIndex() const;
+
+  QVector<atools::util::TaskWorker *> workers;
+  QVector<atools::util::TaskQueue *> queues;
+  std::deque<Task> sharedQueue;
+  QMutex sharedMutex;
+
+  /* Sleeping workers */
+  QMutex sleepMutex;
+  QWaitCondition sleepCondition;
+  QAtomicInt numPending = 0;
+  bool stopping = false;
+
+  std::function<bool()> cancelCheck;
+};
+
+/*
+ * Set of tasks which can be waited for and canceled together. Waits in the destructor.
+ * An exception thrown by a task cancels the group and is rethrown by wait().
+ */
+class TaskGroup
+{
+public:
+  explicit TaskGroup(atools::util::TaskScheduler& taskScheduler);
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup& other) = delete;
+  TaskGroup& operator=(const TaskGroup& other) = delete;
+
+  /* Start a task. Thread safe and can be called from within tasks of this group. */
+  void run(const std::function<void()>& function);
+
+  /* Block until all tasks are done or skipped. Executes pending tasks in the calling thread while waiting.
+   * Rethrows the first exception of a task. */
+  void wait();
+
+  /* Skip all tasks not yet started. Running tasks can check isCanceled(). */
+  void cancel()
+  {
+    canceled.storeRelease(1);
+  }
+
+  /* true if canceled or if the cancel check of the scheduler returned true */
+  bool isCanceled() const
+  {
+    return canceled.loadAcquire() == 1 || scheduler.isCanceled();
+  }
+
+private:
+  friend class atools::util::TaskScheduler;
+
+  /* Called by scheduler after a task was executed or skipped */
+  void taskDone(std::exception_ptr exception);
+
+  atools::util::TaskScheduler& scheduler;
+  QAtomicInt pending = 0, canceled = 0;
+  QMutex mutex;
+  QWaitCondition doneCondition;
+  std::exception_ptr firstException;
+};
+
+} // namespace util
+} // namespace atools
+
+#endif // ATOOLS_UTIL_TASKSCHEDULER_H
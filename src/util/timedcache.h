@@ -19,20 +19,32 @@
 #define ATOOLS_UTIL_TIMEDCACHE_H
 
 #include <QDateTime>
+#include <QHash>
+
+#include <list>
 
 namespace atools {
 namespace util {
 
-/* Simple hash that removes entries on timeout when they are accessed */
+/*
+ * Simple hash that removes entries on timeout when they are accessed.
+ *
+ * Optionally bounded: if maxEntries is > 0 the least recently used entry is removed when inserting
+ * into a full cache. A purge interval > 0 removes all timed out entries while the cache is used.
+ */
 template<typename KEY, typename TYPE>
 class TimedCache
 {
 public:
-  TimedCache(int timeoutSeconds)
-    : timeout(timeoutSeconds)
+  TimedCache(int timeoutSeconds, int maxEntriesParam = 0, int purgeIntervalSeconds = 0)
+    : timeout(timeoutSeconds), maxEntries(maxEntriesParam), purgeInterval(purgeIntervalSeconds)
   {
   }
 
+  /* Not copyable since entries refer to positions in the usage list */
+  TimedCache(const TimedCache&) = delete;
+  TimedCache& operator=(const TimedCache&) = delete;
+
   /* Add an entry and assign a timestamp to it **/
   void insert(const KEY& key, const TYPE& type);
 
@@ -51,6 +63,7 @@ public:
   void clear()
   {
     hash.clear();
+    lru.clear();
   }
 
   /* true if object is old. does not modify cache */
@@ -73,46 +86,134 @@ public:
 
   void remove(const KEY& key);
 
+  /* Remove all timed out entries */
+  void purge();
+
+  /* Limit number of entries. 0 is unbounded. Removes least recently used entries if needed. */
+  void setMaxEntries(int value);
+
+  int size() const
+  {
+    return hash.size();
+  }
+
+  /* Statistics for value() and contains() */
+  quint64 getHits() const
+  {
+    return hits;
+  }
+
+  quint64 getMisses() const
+  {
+    return misses;
+  }
+
+  /* Entries removed because the cache was full */
+  quint64 getEvictions() const
+  {
+    return evictions;
+  }
+
+  void resetStatistics()
+  {
+    hits = misses = evictions = 0;
+  }
+
 private:
   struct Entry
   {
     TYPE value;
-    QDateTime timestamp;
+    qint64 timestampMs;
+
+    /* Position in the usage list */
+    typename std::list<KEY>::iterator lruPos;
   };
 
   TYPE *checkTimeout(const KEY& key);
+  bool isTimedOut(const Entry& entry, qint64 now) const;
+  void removeEntry(typename QHash<KEY, Entry>::iterator it);
+  void purgeIfDue(qint64 now);
 
   QHash<KEY, Entry> hash;
-  int timeout;
+
+  /* Keys in order of use. Most recently used first. */
+  std::list<KEY> lru;
+
+  int timeout, maxEntries, purgeInterval;
+  qint64 lastPurgeMs = 0;
+  quint64 hits = 0, misses = 0, evictions = 0;
 };
 
 template<typename KEY, typename TYPE>
 void TimedCache<KEY, TYPE>::insert(const KEY& key, const TYPE& type)
 {
-  hash.insert(key, {type, QDateTime::currentDateTime()});
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  purgeIfDue(now);
+
+  auto it = hash.find(key);
+  if(it != hash.end())
+  {
+    // Replace and move to front
+    it.value().value = type;
+    it.value().timestampMs = now;
+    lru.splice(lru.begin(), lru, it.value().lruPos);
+    return;
+  }
+
+  if(maxEntries > 0)
+  {
+    while(hash.size() >= maxEntries && !lru.empty())
+    {
+      hash.remove(lru.back());
+      lru.pop_back();
+      evictions++;
+    }
+  }
+
+  lru.push_front(key);
+  hash.insert(key, {type, now, lru.begin()});
 }
 
 template<typename KEY, typename TYPE>
 TYPE *TimedCache<KEY, TYPE>::checkTimeout(const KEY& key)
 {
-  if(!hash.contains(key))
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  purgeIfDue(now);
+
+  auto it = hash.find(key);
+  if(it == hash.end())
+  {
+    misses++;
     return nullptr;
+  }
   else
   {
-    if(isTimedOut(key))
+    if(isTimedOut(it.value(), now))
     {
-      hash.remove(key);
+      removeEntry(it);
+      misses++;
       return nullptr;
     }
     else
-      return &hash[key].value;
+    {
+      lru.splice(lru.begin(), lru, it.value().lruPos);
+      hits++;
+      return &it.value().value;
+    }
   }
 }
 
 template<typename KEY, typename TYPE>
 bool TimedCache<KEY, TYPE>::isTimedOut(const KEY& key) const
 {
-  return hash.value(key).timestamp.addSecs(timeout) < QDateTime::currentDateTime();
+  auto it = hash.constFind(key);
+  return it == hash.constEnd() || isTimedOut(it.value(), QDateTime::currentMSecsSinceEpoch());
+}
+
+template<typename KEY, typename TYPE>
+bool TimedCache<KEY, TYPE>::isTimedOut(const Entry& entry, qint64 now) const
+{
+  return entry.timestampMs + timeout * 1000LL < now;
 }
 
 template<typename KEY, typename TYPE>
@@ -124,8 +225,9 @@ bool TimedCache<KEY, TYPE>::timeOut(const KEY& key)
 template<typename KEY, typename TYPE>
 TYPE *TimedCache<KEY, TYPE>::valueNoTimeout(const KEY& key)
 {
-  if(containsNoTimeout(key))
-    return &hash[key].value;
+  auto it = hash.find(key);
+  if(it != hash.end())
+    return &it.value().value;
   else
     return nullptr;
 }
@@ -144,7 +246,57 @@ TYPE TimedCache<KEY, TYPE>::valueCopyAndTimeout(const KEY& key)
 template<typename KEY, typename TYPE>
 void TimedCache<KEY, TYPE>::remove(const KEY& key)
 {
-  hash.remove(key);
+  auto it = hash.find(key);
+  if(it != hash.end())
+    removeEntry(it);
+}
+
+template<typename KEY, typename TYPE>
+void TimedCache<KEY, TYPE>::removeEntry(typename QHash<KEY, Entry>::iterator it)
+{
+  lru.erase(it.value().lruPos);
+  hash.erase(it);
+}
+
+template<typename KEY, typename TYPE>
+void TimedCache<KEY, TYPE>::purge()
+{
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  lastPurgeMs = now;
+  for(auto it = hash.begin(); it != hash.end();)
+  {
+    if(isTimedOut(it.value(), now))
+    {
+      lru.erase(it.value().lruPos);
+      it = hash.erase(it);
+    }
+    else
+      ++it;
+  }
+}
+
+template<typename KEY, typename TYPE>
+void TimedCache<KEY, TYPE>::purgeIfDue(qint64 now)
+{
+  if(purgeInterval > 0)
+  {
+    if(lastPurgeMs == 0)
+      lastPurgeMs = now;
+    else if(now - lastPurgeMs >= purgeInterval * 1000LL)
+      purge();
+  }
+}
+
+template<typename KEY, typename TYPE>
+void TimedCache<KEY, TYPE>::setMaxEntries(int value)
+{
+  maxEntries = value;
+  while(maxEntries > 0 && hash.size() > maxEntries && !lru.empty())
+  {
+    hash.remove(lru.back());
+    lru.pop_back();
+    evictions++;
+  }
 }
 
 } // namespace util
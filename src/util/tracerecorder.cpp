@@ -0,0 +1,195 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "util/tracerecorder.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+
+namespace atools {
+namespace util {
+
+/* Limit memory usage if tracing is left enabled */
+static const int MAX_EVENTS = 2000000;
+
+std::atomic<bool> TraceRecorder::enabled(false);
+
+namespace {
+
+struct TraceEvent
+{
+  QString name, detail;
+  const char *category;
+  char phase; // "B" begin, "E" end or "M" metadata for thread name
+  int threadId;
+  qint64 timestampUs;
+};
+
+struct TraceData
+{
+  TraceData()
+  {
+    timer.start();
+  }
+
+  QMutex mutex;
+  QVector<TraceEvent> events;
+  QElapsedTimer timer;
+  int numDropped = 0;
+
+  /* Incremented on clear to write thread names again */
+  int generation = 0;
+};
+
+TraceData& traceData()
+{
+  static TraceData *data = new TraceData;
+  return *data;
+}
+
+std::atomic<int> nextThreadId(1);
+
+}
+
+void TraceRecorder::setEnabled(bool value)
+{
+  enabled.store(value, std::memory_order_relaxed);
+}
+
+void TraceRecorder::begin(const QString& name, const char *category, const QString& detail)
+{
+  addEvent(name, category, 'B', detail);
+}
+
+void TraceRecorder::end(const QString& name, const char *category)
+{
+  addEvent(name, category, 'E', QString());
+}
+
+void TraceRecorder::addEvent(const QString& name, const char *category, char phase, const QString& detail)
+{
+  // Small sequential ids are easier to read in the viewer than native thread handles
+  thread_local int threadId = 0, threadGeneration = -1;
+  if(threadId == 0)
+    threadId = nextThreadId.fetch_add(1);
+
+  TraceData& data = traceData();
+  QMutexLocker locker(&data.mutex);
+  qint64 timestamp = data.timer.nsecsElapsed() / 1000;
+
+  if(data.events.size() >= MAX_EVENTS)
+  {
+    data.numDropped++;
+    return;
+  }
+
+  if(threadGeneration != data.generation)
+  {
+    // First event of this thread since last clear
+    threadGeneration = data.generation;
+    QString threadName = QThread::currentThread()->objectName();
+    if(threadName.isEmpty())
+      threadName = QString("Thread %1").arg(threadId);
+    data.events.append({threadName, QString(), "__metadata", 'M', threadId, timestamp});
+  }
+
+  data.events.append({name, detail, category, phase, threadId, timestamp});
+}
+
+void TraceRecorder::clear()
+{
+  TraceData& data = traceData();
+  QMutexLocker locker(&data.mutex);
+  data.events.clear();
+  data.numDropped = 0;
+  data.timer.restart();
+  data.generation++;
+}
+
+int TraceRecorder::getNumEvents()
+{
+  TraceData& data = traceData();
+  QMutexLocker locker(&data.mutex);
+  return data.events.size();
+}
+
+bool TraceRecorder::writeJson(const QString& filename)
+{
+  TraceData& data = traceData();
+  QJsonArray events;
+  int numDropped;
+  {
+    QMutexLocker locker(&data.mutex);
+    numDropped = data.numDropped;
+    qint64 pid = QCoreApplication::applicationPid();
+
+    for(const TraceEvent& event : data.events)
+    {
+      QJsonObject obj;
+      obj.insert("pid", pid);
+      obj.insert("tid", event.threadId);
+      obj.insert("ph", QString(QChar(event.phase)));
+
+      if(event.phase == 'M')
+      {
+        obj.insert("name", "thread_name");
+        obj.insert("args", QJsonObject({{"name", event.name}}));
+      }
+      else
+      {
+        obj.insert("name", event.name);
+        obj.insert("cat", QLatin1String(event.category));
+        obj.insert("ts", event.timestampUs);
+        if(!event.detail.isEmpty())
+          obj.insert("args", QJsonObject({{"detail", event.detail}}));
+      }
+      events.append(obj);
+    }
+  }
+
+  if(numDropped > 0)
+    qWarning() << Q_FUNC_INFO << "Dropped" << numDropped << "trace events";
+
+  QJsonObject trace;
+  trace.insert("traceEvents", events);
+  trace.insert("displayTimeUnit", "ms");
+
+  QFile file(filename);
+  if(file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+    file.close();
+    qInfo() << "Wrote" << events.size() << "trace events to" << filename;
+    return true;
+  }
+  else
+  {
+    qWarning() << "Cannot write trace file" << filename << file.errorString();
+    return false;
+  }
+}
+
+} // namespace util
+} // namespace atools
@@ -0,0 +1,111 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_TRACERECORDER_H
+#define ATOOLS_UTIL_TRACERECORDER_H
+
+#include <QString>
+
+#include <atomic>
+
+namespace atools {
+namespace util {
+
+/*
+ * Records begin and end events of named spans with thread ids and writes them in the Chrome trace event
+ * JSON format which can be loaded into chrome://tracing or Perfetto (https://ui.perfetto.dev).
+ *
+ * Disabled by default. Recording costs only an atomic load when disabled. Thread safe.
+ * Begin and end of a span have to be called in the same thread. Use TraceSpan or ATOOLS_TRACE_SPAN for this.
+ */
+class TraceRecorder
+{
+public:
+  /* Start or stop recording. Recorded events are kept. */
+  static void setEnabled(bool value);
+
+  static bool isEnabled()
+  {
+    return enabled.load(std::memory_order_relaxed);
+  }
+
+  /* Add begin event. Detail is shown as argument of the event if not empty. */
+  static void begin(const QString& name, const char *category, const QString& detail = QString());
+
+  /* Add end event for the innermost open span of the calling thread */
+  static void end(const QString& name, const char *category);
+
+  /* Remove all events */
+  static void clear();
+
+  /* Number of recorded events */
+  static int getNumEvents();
+
+  /* Write all events to the file. Returns false and prints a warning on error. */
+  static bool writeJson(const QString& filename);
+
+private:
+  TraceRecorder() = delete;
+
+  static void addEvent(const QString& name, const char *category, char phase, const QString& detail);
+
+  static std::atomic<bool> enabled;
+};
+
+/*
+ * Records a span from construction to destruction if tracing is enabled.
+ */
+class TraceSpan
+{
+public:
+  explicit TraceSpan(const char *spanName, const char *spanCategory = "atools",
+                     const QString& detail = QString())
+    : category(spanCategory)
+  {
+    if(TraceRecorder::isEnabled())
+    {
+      name = QLatin1String(spanName);
+      active = true;
+      TraceRecorder::begin(name, category, detail);
+    }
+  }
+
+  ~TraceSpan()
+  {
+    if(active)
+      TraceRecorder::end(name, category);
+  }
+
+private:
+  TraceSpan(const TraceSpan& other) = delete;
+  TraceSpan& operator=(const TraceSpan& other) = delete;
+
+  QString name;
+  const char *category;
+  bool active = false;
+};
+
+} // namespace util
+} // namespace atools
+
+#define ATOOLS_TRACE_CONCAT_INTERNAL(a, b) a ## b
+#define ATOOLS_TRACE_CONCAT(a, b) ATOOLS_TRACE_CONCAT_INTERNAL(a, b)
+
+/* Record span until end of scope. Category and detail are optional. */
+#define ATOOLS_TRACE_SPAN(...) atools::util::TraceSpan ATOOLS_TRACE_CONCAT(atoolsTraceSpan, __LINE__)(__VA_ARGS__)
+
+#endif // ATOOLS_UTIL_TRACERECORDER_H
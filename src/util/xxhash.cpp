@@ -0,0 +1,177 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "util/xxhash.h"
+
+#include <QFile>
+#include <QDebug>
+#include <QtEndian>
+
+#include <cstring>
+
+namespace atools {
+namespace util {
+
+static const quint64 PRIME1 = 11400714785074694791ULL;
+static const quint64 PRIME2 = 14029467366897019727ULL;
+static const quint64 PRIME3 = 1609587929392839161ULL;
+static const quint64 PRIME4 = 9650029242287828579ULL;
+static const quint64 PRIME5 = 2870177450012600261ULL;
+
+static inline quint64 rotl(quint64 value, int bits)
+{
+  return (value << bits) | (value >> (64 - bits));
+}
+
+/* Unaligned little endian reads */
+static inline quint64 read64(const char *ptr)
+{
+  quint64 value;
+  std::memcpy(&value, ptr, sizeof(value));
+  return qFromLittleEndian(value);
+}
+
+static inline quint32 read32(const char *ptr)
+{
+  quint32 value;
+  std::memcpy(&value, ptr, sizeof(value));
+  return qFromLittleEndian(value);
+}
+
+static inline quint64 accumulate(quint64 acc, quint64 input)
+{
+  acc += input * PRIME2;
+  acc = rotl(acc, 31);
+  return acc * PRIME1;
+}
+
+static inline quint64 mergeRound(quint64 acc, quint64 value)
+{
+  acc ^= accumulate(0, value);
+  return acc * PRIME1 + PRIME4;
+}
+
+quint64 xxHash64(const char *data, qint64 length, quint64 seed)
+{
+  const char *ptr = data;
+  const char *end = data + length;
+  quint64 hash;
+
+  if(length >= 32)
+  {
+    // Process stripes of 32 bytes with four accumulators
+    const char *limit = end - 32;
+    quint64 v1 = seed + PRIME1 + PRIME2;
+    quint64 v2 = seed + PRIME2;
+    quint64 v3 = seed;
+    quint64 v4 = seed - PRIME1;
+
+    do
+    {
+      v1 = accumulate(v1, read64(ptr));
+      v2 = accumulate(v2, read64(ptr + 8));
+      v3 = accumulate(v3, read64(ptr + 16));
+      v4 = accumulate(v4, read64(ptr + 24));
+      ptr += 32;
+    } while(ptr <= limit);
+
+    hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    hash = mergeRound(hash, v1);
+    hash = mergeRound(hash, v2);
+    hash = mergeRound(hash, v3);
+    hash = mergeRound(hash, v4);
+  }
+  else
+    hash = seed + PRIME5;
+
+  hash += static_cast<quint64>(length);
+
+  // Remaining bytes
+  while(ptr + 8 <= end)
+  {
+    hash ^= accumulate(0, read64(ptr));
+    hash = rotl(hash, 27) * PRIME1 + PRIME4;
+    ptr += 8;
+  }
+
+  if(ptr + 4 <= end)
+  {
+    hash ^= static_cast<quint64>(read32(ptr)) * PRIME1;
+    hash = rotl(hash, 23) * PRIME2 + PRIME3;
+    ptr += 4;
+  }
+
+  while(ptr < end)
+  {
+    hash ^= static_cast<quint64>(static_cast<unsigned char>(*ptr)) * PRIME5;
+    hash = rotl(hash, 11) * PRIME1;
+    ptr++;
+  }
+
+  // Avalanche
+  hash ^= hash >> 33;
+  hash *= PRIME2;
+  hash ^= hash >> 29;
+  hash *= PRIME3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+quint64 xxHash64File(const QString& filepath, bool *ok)
+{
+  if(ok != nullptr)
+    *ok = false;
+
+  QFile file(filepath);
+  if(!file.open(QIODevice::ReadOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filepath << file.errorString();
+    return 0;
+  }
+
+  quint64 hash;
+  qint64 size = file.size();
+  if(size == 0)
+    hash = xxHash64(nullptr, 0);
+  else
+  {
+    uchar *mapped = file.map(0, size);
+    if(mapped != nullptr)
+    {
+      hash = xxHash64(reinterpret_cast<const char *>(mapped), size);
+      file.unmap(mapped);
+    }
+    else
+    {
+      // Mapping not possible - read into memory
+      QByteArray bytes = file.readAll();
+      if(bytes.size() != size)
+      {
+        qWarning() << Q_FUNC_INFO << "Cannot read" << filepath << file.errorString();
+        return 0;
+      }
+      hash = xxHash64(bytes.constData(), bytes.size());
+    }
+  }
+
+  if(ok != nullptr)
+    *ok = true;
+  return hash;
+}
+
+} // namespace util
+} // namespace atools
@@ -0,0 +1,40 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_XXHASH_H
+#define ATOOLS_UTIL_XXHASH_H
+
+#include <QtGlobal>
+
+class QString;
+
+namespace atools {
+namespace util {
+
+/*
+ * XXH64 non-cryptographic hash. Fast and well distributed which makes it suitable for detecting
+ * identical file content. Do not use for security related purposes.
+ */
+quint64 xxHash64(const char *data, qint64 length, quint64 seed = 0);
+
+/* Hash of the whole file content. Memory maps the file if possible. ok is set to false on read errors. */
+quint64 xxHash64File(const QString& filepath, bool *ok = nullptr);
+
+} // namespace util
+} // namespace atools
+
+#endif // ATOOLS_UTIL_XXHASH_H
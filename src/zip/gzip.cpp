@@ -214,5 +214,95 @@ bool gzipDecompress(const QByteArray& input, QByteArray& output)
     return true;
 }
 
+GzipInflater::GzipInflater()
+{
+  init();
+}
+
+GzipInflater::~GzipInflater()
+{
+  deInit();
+}
+
+void GzipInflater::init()
+{
+  strm.zalloc = Z_NULL;
+  strm.zfree = Z_NULL;
+  strm.opaque = Z_NULL;
+  strm.avail_in = 0;
+  strm.next_in = Z_NULL;
+
+  initialized = inflateInit2(&strm, GZIP_WINDOWS_BIT) == Z_OK;
+  error = !initialized;
+  finished = false;
+}
+
+void GzipInflater::deInit()
+{
+  if(initialized)
+    inflateEnd(&strm);
+  initialized = false;
+}
+
+void GzipInflater::reset()
+{
+  deInit();
+  init();
+}
+
+bool GzipInflater::isGzip(const QByteArray& data)
+{
+  return data.size() >= 2 && static_cast<unsigned char>(data.at(0)) == 0x1f &&
+         static_cast<unsigned char>(data.at(1)) == 0x8b;
+}
+
+bool GzipInflater::inflateChunk(const QByteArray& input, QByteArray& output)
+{
+  return inflateChunk(input.constData(), input.size(), output);
+}
+
+bool GzipInflater::inflateChunk(const char *input, int size, QByteArray& output)
+{
+  if(error)
+    return false;
+
+  if(finished || size <= 0)
+    return true;
+
+  strm.next_in = reinterpret_cast<unsigned char *>(const_cast<char *>(input));
+  strm.avail_in = static_cast<unsigned int>(size);
+
+  do
+  {
+    char out[GZIP_CHUNK_SIZE];
+    strm.next_out = reinterpret_cast<unsigned char *>(out);
+    strm.avail_out = GZIP_CHUNK_SIZE;
+
+    int ret = inflate(&strm, Z_NO_FLUSH);
+    if(ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR)
+    {
+      error = true;
+      deInit();
+      return false;
+    }
+
+    int have = GZIP_CHUNK_SIZE - static_cast<int>(strm.avail_out);
+    if(have > 0)
+      output.append(out, have);
+
+    if(ret == Z_STREAM_END)
+    {
+      finished = true;
+      break;
+    }
+
+    // Z_BUF_ERROR: no progress possible - need more input
+    if(ret == Z_BUF_ERROR)
+      break;
+  } while(strm.avail_in > 0 || strm.avail_out == 0);
+
+  return true;
+}
+
 } // namespace zip
 } // namespace atools
@@ -44,6 +44,49 @@ bool gzipCompress(const QByteArray& input, QByteArray& output, int level = -1);
  */
 bool gzipDecompress(const QByteArray& input, QByteArray& output);
 
+/*
+ * Incremental GZIP decompression for data arriving in chunks like network replies.
+ * Avoids keeping the full compressed and decompressed data in memory.
+ */
+class GzipInflater
+{
+public:
+  GzipInflater();
+  ~GzipInflater();
+
+  GzipInflater(const GzipInflater& other) = delete;
+  GzipInflater& operator=(const GzipInflater& other) = delete;
+
+  /* Decompress the next chunk and append the result to output.
+   * Returns false on error. Data after the end of the GZIP stream is ignored. */
+  bool inflateChunk(const char *input, int size, QByteArray& output);
+  bool inflateChunk(const QByteArray& input, QByteArray& output);
+
+  /* True if the end of the GZIP stream was reached */
+  bool isFinished() const
+  {
+    return finished;
+  }
+
+  bool hasError() const
+  {
+    return error;
+  }
+
+  /* Prepare for a new stream */
+  void reset();
+
+  /* True if data starts with the GZIP magic number */
+  static bool isGzip(const QByteArray& data);
+
+private:
+  void init();
+  void deInit();
+
+  z_stream strm;
+  bool initialized = false, finished = false, error = false;
+};
+
 } // namespace zip
 } // namespace atools
 
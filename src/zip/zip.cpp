@@ -40,6 +40,11 @@
 #include <QDateTime>
 #include <QtEndian>
 #include <QDir>
+#include <QHash>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <algorithm>
 
 #if defined(Q_CC_MSVC)
 #include <QtZlib/zlib.h>
@@ -196,6 +201,70 @@ static int deflate(Bytef *dest, ulong *destLen, const Bytef *source, ulong sourc
   return err;
 }
 
+/* Deflate contents into data. data is empty on error. */
+static void compressData(const uchar *contents, int length, QByteArray& data)
+{
+  ulong len = length;
+  // shamelessly copied form zlib
+  len += (len >> 12) + (len >> 14) + 11;
+  int res;
+  do
+  {
+    data.resize(len);
+    res = deflate((uchar *)data.data(), &len, contents, length);
+
+    switch(res)
+    {
+      case Z_OK:
+        data.resize(len);
+        break;
+      case Z_MEM_ERROR:
+        qWarning("Zip: Z_MEM_ERROR: Not enough memory to compress file, skipping");
+        data.resize(0);
+        break;
+      case Z_BUF_ERROR:
+        len *= 2;
+        break;
+    }
+  } while(res == Z_BUF_ERROR);
+}
+
+/* Raw deflate of one block of a larger stream like pigz does. The preceding 32 KB are used as dictionary and
+ * all blocks except the last end with a sync flush. The compressed blocks can be concatenated to one stream. */
+static void compressBlock(const uchar *dict, int dictLength, const uchar *source, int length, bool last,
+                          QByteArray& data)
+{
+  z_stream stream;
+  memset(&stream, 0, sizeof(z_stream));
+  data.clear();
+
+  if(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+  {
+    qWarning("Zip: Z_MEM_ERROR: Not enough memory to compress file, skipping");
+    return;
+  }
+
+  if(dictLength > 0)
+    deflateSetDictionary(&stream, dict, static_cast<uInt>(dictLength));
+
+  // Bound is for Z_FINISH - add space for the sync flush marker
+  data.resize(static_cast<int>(deflateBound(&stream, static_cast<uLong>(length))) + 64);
+  stream.next_in = const_cast<Bytef *>(source);
+  stream.avail_in = static_cast<uInt>(length);
+  stream.next_out = (Bytef *)data.data();
+  stream.avail_out = static_cast<uInt>(data.size());
+
+  int err = ::deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+  if((last && err == Z_STREAM_END) || (!last && err == Z_OK && stream.avail_in == 0 && stream.avail_out > 0))
+    data.resize(static_cast<int>(stream.total_out));
+  else
+  {
+    qWarning("Zip: Deflate error %d: Cannot compress block, skipping", err);
+    data.clear();
+  }
+  deflateEnd(&stream);
+}
+
 namespace WindowsFileAttributes {
 enum
 {
@@ -556,7 +625,71 @@ public:
 
   void scanFiles();
 
+  /* Index of the entry in fileHeaders or -1 if not found */
+  int indexOf(const QString& fileName) const
+  {
+    return nameIndex.value(fileName, -1);
+  }
+
+  /* Checks the entry and reads the local header. Returns offset of the compressed data in the archive.
+   * Returns false and sets status on error. */
+  bool entryData(int index, qint64& dataOffset, int& compressionMethod, int& compressedSize, int& uncompressedSize);
+
+  /* Copy size bytes at offset from mapped file or device. Returns number of bytes read. */
+  qint64 readAt(qint64 offset, char *dest, qint64 size);
+
+  /* Pointer into the mapped file or null if not mapped or out of range */
+  const uchar *mapped(qint64 offset, qint64 size) const
+  {
+    return mappedData != nullptr && offset >= 0 && offset + size <= mappedSize ? mappedData + offset : nullptr;
+  }
+
+  void unmap();
+
   ZipReader::Status status;
+
+  /* Entry index by file name for lookup in fileData() */
+  QHash<QString, int> nameIndex;
+
+  /* Whole archive if mapped into memory */
+  bool useMemoryMap = true;
+  uchar *mappedData = nullptr;
+  qint64 mappedSize = 0;
+};
+
+/* Compressed part of an entry. Whole entry if no block compression is used. */
+struct DeflateBlock
+{
+  int offset, length;
+  QByteArray data;
+  uint crc;
+};
+
+/* Entry waiting for parallel compression */
+struct PendingEntry
+{
+  FileHeader header;
+  QByteArray contents;
+  bool compress;
+  QVector<DeflateBlock> blocks;
+};
+
+/* Compresses and checksums one block on the thread pool */
+class DeflateTask :
+  public QRunnable
+{
+public:
+  DeflateTask(const PendingEntry *pendingEntry, DeflateBlock *deflateBlock, bool lastBlock)
+    : entry(pendingEntry), block(deflateBlock), last(lastBlock)
+  {
+  }
+
+  virtual void run() override;
+
+private:
+  const PendingEntry *entry;
+  DeflateBlock *block;
+  bool last;
 };
 
 class ZipWriterPrivate :
@@ -574,6 +707,12 @@ public:
   QFile::Permissions permissions;
   ZipWriter::CompressionPolicy compressionPolicy;
 
+  /* Parallel compression if > 1 */
+  int numThreads = 1;
+
+  /* Split large entries into blocks of this size for parallel compression if > 0 */
+  int blockSize = 0;
+
   enum EntryType
   {
     Directory, File, Symlink
@@ -581,8 +720,40 @@ public:
 
   void addEntry(EntryType type, const QString& fileName, const QByteArray& contents);
 
+  /* Compress all pending entries in parallel and write them in order of adding */
+  void flushPending();
+
+private:
+  /* Write local header and data and add to directory */
+  void writeEntry(FileHeader& header, const QByteArray& data, uint crc_32);
+
+  /* Entries queued for parallel compression and their uncompressed size */
+  QVector<PendingEntry> pending;
+  qint64 pendingBytes = 0;
+
+  /* Flush queue when exceeding this to limit memory usage */
+  static Q_DECL_CONSTEXPR qint64 MAX_PENDING_BYTES = 256LL * 1024LL * 1024LL;
 };
 
+void DeflateTask::run()
+{
+  const uchar *source = (const uchar *)entry->contents.constData() + block->offset;
+
+  block->crc = ::crc32(::crc32(0, 0, 0), source, static_cast<uInt>(block->length));
+
+  if(entry->compress)
+  {
+    if(entry->blocks.size() == 1)
+      // Same result as sequential compression
+      compressData(source, block->length, block->data);
+    else
+    {
+      int dictLength = std::min(block->offset, 32768);
+      compressBlock(source - dictLength, dictLength, source, block->length, last, block->data);
+    }
+  }
+}
+
 LocalFileHeader CentralFileHeader::toLocalHeader() const
 {
   LocalFileHeader h;
@@ -704,8 +875,92 @@ void ZipReaderPrivate::scanFiles()
     }
 
     ZDEBUG("found file '%s'", header.file_name.data());
+
+    // First entry wins if names are duplicated
+    QString name = QString::fromLocal8Bit(header.file_name);
+    if(!nameIndex.contains(name))
+      nameIndex.insert(name, fileHeaders.size());
     fileHeaders.append(header);
   }
+
+  // Map whole archive to avoid reads and copies for entry data
+  QFile *file = qobject_cast<QFile *>(device);
+  if(useMemoryMap && file != nullptr && mappedData == nullptr)
+  {
+    mappedData = file->map(0, file->size());
+    if(mappedData != nullptr)
+      mappedSize = file->size();
+    else
+      ZDEBUG() << "Cannot map" << file->fileName() << file->errorString();
+  }
+}
+
+void ZipReaderPrivate::unmap()
+{
+  QFile *file = qobject_cast<QFile *>(device);
+  if(mappedData != nullptr && file != nullptr)
+    file->unmap(mappedData);
+  mappedData = nullptr;
+  mappedSize = 0;
+}
+
+qint64 ZipReaderPrivate::readAt(qint64 offset, char *dest, qint64 size)
+{
+  const uchar *src = mapped(offset, size);
+  if(src != nullptr)
+  {
+    memcpy(dest, src, static_cast<size_t>(size));
+    return size;
+  }
+
+  device->seek(offset);
+  return device->read(dest, size);
+}
+
+bool ZipReaderPrivate::entryData(int index, qint64& dataOffset, int& compressionMethod, int& compressedSize,
+                                 int& uncompressedSize)
+{
+  const FileHeader& header = fileHeaders.at(index);
+
+  ushort version_needed = readUShort(header.h.version_needed);
+  if(version_needed > ZIP_VERSION)
+  {
+    qWarning("Zip: .ZIP specification version %d implementationis needed to extract the data.",
+             version_needed);
+    status = ZipReader::FileNotSupported;
+    return false;
+  }
+
+  ushort general_purpose_bits = readUShort(header.h.general_purpose_bits);
+  compressedSize = readUInt(header.h.compressed_size);
+  uncompressedSize = readUInt(header.h.uncompressed_size);
+  qint64 start = readUInt(header.h.offset_local_header);
+
+  LocalFileHeader lh;
+  if(readAt(start, (char *)&lh, sizeof(LocalFileHeader)) != sizeof(LocalFileHeader))
+  {
+    qWarning("Zip: Failed to read local header");
+    status = ZipReader::FileCorrupted;
+    return false;
+  }
+  uint skip = readUShort(lh.file_name_length) + readUShort(lh.extra_field_length);
+  dataOffset = start + qint64(sizeof(LocalFileHeader)) + skip;
+  compressionMethod = readUShort(lh.compression_method);
+
+  if((general_purpose_bits & Encrypted) != 0)
+  {
+    qWarning("Zip: Unsupported encryption method is needed to extract the data.");
+    status = ZipReader::FileEncryptionMethodNotSupported;
+    return false;
+  }
+
+  if(compressionMethod != CompressionMethodStored && compressionMethod != CompressionMethodDeflated)
+  {
+    qWarning("Zip: Unsupported compression method %d is needed to extract the data.", compressionMethod);
+    status = ZipReader::FileEncryptionMethodNotSupported;
+    return false;
+  }
+  return true;
 }
 
 void ZipWriterPrivate::addEntry(EntryType type, const QString& fileName, const QByteArray& contents /*, QFile::Permissions permissions, QZip::Method m*/)
@@ -726,7 +981,6 @@ void ZipWriterPrivate::addEntry(EntryType type, const QString& fileName, const Q
     status = ZipWriter::FileOpenError;
     return;
   }
-  device->seek(start_of_directory);
 
   // don't compress small files
   ZipWriter::CompressionPolicy compression = compressionPolicy;
@@ -745,42 +999,9 @@ void ZipWriterPrivate::addEntry(EntryType type, const QString& fileName, const Q
   writeUShort(header.h.version_needed, ZIP_VERSION);
   writeUInt(header.h.uncompressed_size, contents.length());
   writeMSDosDate(header.h.last_mod_file, QDateTime::currentDateTime());
-  QByteArray data = contents;
   if(compression == ZipWriter::AlwaysCompress)
-  {
     writeUShort(header.h.compression_method, CompressionMethodDeflated);
 
-    ulong len = contents.length();
-    // shamelessly copied form zlib
-    len += (len >> 12) + (len >> 14) + 11;
-    int res;
-    do
-    {
-      data.resize(len);
-      res = deflate((uchar *)data.data(), &len, (const uchar *)contents.constData(), contents.length());
-
-      switch(res)
-      {
-        case Z_OK:
-          data.resize(len);
-          break;
-        case Z_MEM_ERROR:
-          qWarning("Zip: Z_MEM_ERROR: Not enough memory to compress file, skipping");
-          data.resize(0);
-          break;
-        case Z_BUF_ERROR:
-          len *= 2;
-          break;
-      }
-    } while(res == Z_BUF_ERROR);
-  }
-  // TODO add a check if data.length() > contents.length().
-  // Then try to store the original and revert the compression method to be uncompressed
-  writeUInt(header.h.compressed_size, data.length());
-  uint crc_32 = ::crc32(0, 0, 0);
-  crc_32 = ::crc32(crc_32, (const uchar *)contents.constData(), contents.length());
-  writeUInt(header.h.crc_32, crc_32);
-
   // if bit 11 is set, the filename and comment fields must be encoded using UTF-8
   ushort general_purpose_bits = Utf8Names; // always use utf-8
   writeUShort(header.h.general_purpose_bits, general_purpose_bits);
@@ -820,10 +1041,54 @@ void ZipWriterPrivate::addEntry(EntryType type, const QString& fileName, const Q
       break;
   }
   writeUInt(header.h.external_file_attributes, mode << 16);
+
+  if(numThreads <= 1)
+  {
+    QByteArray data = contents;
+    if(compression == ZipWriter::AlwaysCompress)
+      compressData((const uchar *)contents.constData(), contents.length(), data);
+
+    uint crc_32 = ::crc32(0, 0, 0);
+    crc_32 = ::crc32(crc_32, (const uchar *)contents.constData(), contents.length());
+    writeEntry(header, data, crc_32);
+  }
+  else
+  {
+    // Queue for parallel compression - header is completed when writing
+    PendingEntry entry;
+    entry.header = header;
+    entry.contents = contents;
+    entry.compress = compression == ZipWriter::AlwaysCompress;
+
+    // Split large entries into blocks if enabled
+    int numBlocks = entry.compress && blockSize > 0 ? std::max(1, contents.length() / blockSize) : 1;
+    for(int i = 0; i < numBlocks; i++)
+    {
+      DeflateBlock block;
+      block.offset = i * (contents.length() / numBlocks);
+      block.length = i == numBlocks - 1 ? contents.length() - block.offset : contents.length() / numBlocks;
+      block.crc = 0;
+      entry.blocks.append(block);
+    }
+    pending.append(entry);
+    pendingBytes += contents.length();
+
+    if(pendingBytes >= MAX_PENDING_BYTES)
+      flushPending();
+  }
+}
+
+void ZipWriterPrivate::writeEntry(FileHeader& header, const QByteArray& data, uint crc_32)
+{
+  // TODO add a check if data.length() > contents.length().
+  // Then try to store the original and revert the compression method to be uncompressed
+  writeUInt(header.h.compressed_size, data.length());
+  writeUInt(header.h.crc_32, crc_32);
   writeUInt(header.h.offset_local_header, start_of_directory);
 
   fileHeaders.append(header);
 
+  device->seek(start_of_directory);
   LocalFileHeader h = header.h.toLocalHeader();
   device->write((const char *)&h, sizeof(LocalFileHeader));
   device->write(header.file_name);
@@ -832,6 +1097,50 @@ void ZipWriterPrivate::addEntry(EntryType type, const QString& fileName, const Q
   dirtyFileTree = true;
 }
 
+void ZipWriterPrivate::flushPending()
+{
+  if(pending.isEmpty())
+    return;
+
+  {
+    // Entries and blocks must not be reallocated while tasks are running - pool waits in destructor
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(numThreads);
+    for(PendingEntry& entry : pending)
+    {
+      // Detach before passing pointers to tasks
+      DeflateBlock *blocks = entry.blocks.data();
+      for(int i = 0; i < entry.blocks.size(); i++)
+        threadPool.start(new DeflateTask(&entry, blocks + i, i == entry.blocks.size() - 1));
+    }
+    threadPool.waitForDone();
+  }
+
+  // Write in order of adding which gives the same layout as sequential compression
+  for(PendingEntry& entry : pending)
+  {
+    const DeflateBlock& first = entry.blocks.first();
+    uint crc_32 = first.crc;
+    QByteArray data = entry.compress ? first.data : entry.contents;
+    for(int i = 1; i < entry.blocks.size(); i++)
+    {
+      const DeflateBlock& block = entry.blocks.at(i);
+      crc_32 = static_cast<uint>(::crc32_combine(crc_32, block.crc, block.length));
+      if(block.data.isEmpty())
+      {
+        // Compression of one block failed - skip contents like sequential compression does
+        data.clear();
+        break;
+      }
+      data.append(block.data);
+    }
+
+    writeEntry(entry.header, data, crc_32);
+  }
+  pending.clear();
+  pendingBytes = 0;
+}
+
 // ////////////////////////////  Reader
 
 /*!
@@ -1020,69 +1329,39 @@ ZipReader::FileInfo ZipReader::entryInfoAt(int index) const
 QByteArray ZipReader::fileData(const QString& fileName) const
 {
   d->scanFiles();
-  int i;
-  for(i = 0; i < d->fileHeaders.size(); i++)
-  {
-    if(QString::fromLocal8Bit(d->fileHeaders.at(i).file_name) == fileName)
-      break;
-  }
-  if(i == d->fileHeaders.size())
+  int i = d->indexOf(fileName);
+  if(i == -1)
     return QByteArray();
 
-  FileHeader header = d->fileHeaders.at(i);
-
-  ushort version_needed = readUShort(header.h.version_needed);
-  if(version_needed > ZIP_VERSION)
-  {
-    qWarning("Zip: .ZIP specification version %d implementationis needed to extract the data.",
-             version_needed);
-    d->status = FileNotSupported;
+  qint64 offset;
+  int compression_method, compressed_size, uncompressed_size;
+  if(!d->entryData(i, offset, compression_method, compressed_size, uncompressed_size))
     return QByteArray();
-  }
-
-  ushort general_purpose_bits = readUShort(header.h.general_purpose_bits);
-  int compressed_size = readUInt(header.h.compressed_size);
-  int uncompressed_size = readUInt(header.h.uncompressed_size);
-  int start = readUInt(header.h.offset_local_header);
-  // qDebug("uncompressing file %d: local header at %d", i, start);
 
-  d->device->seek(start);
-  LocalFileHeader lh;
-  d->device->read((char *)&lh, sizeof(LocalFileHeader));
-  uint skip = readUShort(lh.file_name_length) + readUShort(lh.extra_field_length);
-  d->device->seek(d->device->pos() + skip);
-
-  int compression_method = readUShort(lh.compression_method);
-  // qDebug("file=%s: compressed_size=%d, uncompressed_size=%d", fileName.toLocal8Bit().data(), compressed_size, uncompressed_size);
-
-  if((general_purpose_bits & Encrypted) != 0)
+  // Use data in mapped file directly or read it
+  QByteArray compressed;
+  const uchar *source = d->mapped(offset, compressed_size);
+  if(source == nullptr)
   {
-    qWarning("Zip: Unsupported encryption method is needed to extract the data.");
-    d->status = FileEncryptionMethodNotSupported;
-    return QByteArray();
+    d->device->seek(offset);
+    compressed = d->device->read(compressed_size);
+    compressed_size = compressed.size();
+    source = (const uchar *)compressed.constData();
   }
 
-  // qDebug("file at %lld", d->device->pos());
-  QByteArray compressed = d->device->read(compressed_size);
   if(compression_method == CompressionMethodStored)
-  {
     // no compression
-    compressed.truncate(uncompressed_size);
-    return compressed;
-  }
-  else if(compression_method == CompressionMethodDeflated)
+    return QByteArray((const char *)source, qMin(compressed_size, uncompressed_size));
+  else
   {
     // Deflate
-    // qDebug("compressed=%d", compressed.size());
-    compressed.truncate(compressed_size);
     QByteArray baunzip;
     ulong len = qMax(uncompressed_size, 1);
     int res;
     do
     {
       baunzip.resize(len);
-      res = inflate((uchar *)baunzip.data(), &len,
-                    (const uchar *)compressed.constData(), compressed_size);
+      res = inflate((uchar *)baunzip.data(), &len, source, compressed_size);
 
       switch(res)
       {
@@ -1105,10 +1384,117 @@ QByteArray ZipReader::fileData(const QString& fileName) const
     } while(res == Z_BUF_ERROR);
     return baunzip;
   }
+}
+
+bool ZipReader::extractFile(const QString& fileName, QIODevice *sink) const
+{
+  Q_ASSERT(sink != nullptr);
+
+  d->scanFiles();
+  int i = d->indexOf(fileName);
+  if(i == -1)
+    return false;
+
+  qint64 offset;
+  int compression_method, compressed_size, uncompressed_size;
+  if(!d->entryData(i, offset, compression_method, compressed_size, uncompressed_size))
+    return false;
+
+  const qint64 CHUNK_SIZE = 256 * 1024;
+  QByteArray inBuffer;
+  qint64 inPos = offset, inRemaining = compressed_size;
+
+  // Get next chunk of compressed data from the mapped file or the device
+  auto nextInput = [&](const uchar *& data, qint64& size) -> bool {
+          size = qMin(inRemaining, CHUNK_SIZE);
+          data = d->mapped(inPos, size);
+          if(data == nullptr)
+          {
+            d->device->seek(inPos);
+            inBuffer = d->device->read(size);
+            if(inBuffer.size() != size)
+              return false;
+            data = (const uchar *)inBuffer.constData();
+          }
+          inPos += size;
+          inRemaining -= size;
+          return true;
+        };
+
+  const uchar *data;
+  qint64 size;
+  if(compression_method == CompressionMethodStored)
+  {
+    inRemaining = qMin(compressed_size, uncompressed_size);
+    while(inRemaining > 0)
+    {
+      if(!nextInput(data, size))
+      {
+        d->status = FileReadError;
+        return false;
+      }
+      if(sink->write((const char *)data, size) != size)
+        return false;
+    }
+    return true;
+  }
+
+  // Deflated - inflate chunk by chunk into the sink
+  z_stream stream;
+  memset(&stream, 0, sizeof(z_stream));
+  if(inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+  {
+    d->status = MemoryError;
+    return false;
+  }
+
+  QByteArray outBuffer(static_cast<int>(CHUNK_SIZE), Qt::Uninitialized);
+  int err = Z_OK;
+  bool ok = true;
+  while(ok && err != Z_STREAM_END)
+  {
+    if(stream.avail_in == 0)
+    {
+      if(inRemaining == 0 || !nextInput(data, size))
+      {
+        qWarning("Zip: Z_DATA_ERROR: Input data is corrupted or truncated");
+        d->status = FileCorrupted;
+        ok = false;
+        break;
+      }
+      stream.next_in = const_cast<Bytef *>(data);
+      stream.avail_in = static_cast<uInt>(size);
+    }
+
+    stream.next_out = (Bytef *)outBuffer.data();
+    stream.avail_out = static_cast<uInt>(outBuffer.size());
+    err = ::inflate(&stream, Z_NO_FLUSH);
+
+    if(err != Z_OK && err != Z_STREAM_END)
+    {
+      qWarning("Zip: Inflate error %d: Input data is corrupted", err);
+      d->status = err == Z_MEM_ERROR ? MemoryError : FileCorrupted;
+      ok = false;
+    }
+    else
+    {
+      qint64 produced = outBuffer.size() - stream.avail_out;
+      if(produced > 0 && sink->write(outBuffer.constData(), produced) != produced)
+        ok = false;
+    }
+  }
+  inflateEnd(&stream);
+  return ok;
+}
 
-  qWarning("Zip: Unsupported compression method %d is needed to extract the data.", compression_method);
-  d->status = FileEncryptionMethodNotSupported;
-  return QByteArray();
+void ZipReader::setMemoryMapped(bool value)
+{
+  d->useMemoryMap = value;
+}
+
+bool ZipReader::isMemoryMapped() const
+{
+  return d->mappedData != nullptr;
 }
 
 /*!
@@ -1166,7 +1552,9 @@ bool ZipReader::extractAll(const QString& destinationDir) const
       if(!f.open(QIODevice::WriteOnly))
         return false;
 
-      f.write(fileData(fi.filePath));
+      // Stream into file without keeping the whole entry in memory
+      if(!extractFile(fi.filePath, &f))
+        return false;
       f.setPermissions(fi.permissions);
       f.close();
     }
@@ -1201,6 +1589,7 @@ ZipReader::Status ZipReader::status() const
  */
 void ZipReader::close()
 {
+  d->unmap();
   d->device->close();
 }
 
@@ -1368,6 +1757,40 @@ QFile::Permissions ZipWriter::creationPermissions() const
   return d->permissions;
 }
 
+/*!
+ *   Compress files using up to \a numThreads threads. Files are queued and written in order of adding
+ *   which gives the same archive as sequential compression.
+ *
+ *   \note the default is 1 which compresses each file when adding it.
+ */
+void ZipWriter::setNumThreads(int numThreads)
+{
+  d->flushPending();
+  d->numThreads = std::max(1, numThreads);
+}
+
+int ZipWriter::numThreads() const
+{
+  return d->numThreads;
+}
+
+/*!
+ *   Split files larger than \a blockSize bytes into blocks compressed in parallel. Blocks are joined
+ *   to a single deflate stream which is readable by all unzip tools but differs from sequential compression.
+ *   Only used if more than one thread is set.
+ *
+ *   \note the default is 0 which disables splitting.
+ */
+void ZipWriter::setParallelBlockSize(int blockSize)
+{
+  d->blockSize = std::max(0, blockSize);
+}
+
+int ZipWriter::parallelBlockSize() const
+{
+  return d->blockSize;
+}
+
 /*!
  *   Add a file to the archive with \a data as the file contents.
  *   The file will be stored in the archive using the \a fileName which
@@ -1445,6 +1868,8 @@ void ZipWriter::close()
     return;
   }
 
+  d->flushPending();
+
   // qDebug("Zip::close writing directory, %d entries", d->fileHeaders.size());
   d->device->seek(d->start_of_directory);
   // write new directory
@@ -82,9 +82,23 @@ public:
   int count() const;
 
   FileInfo entryInfoAt(int index) const;
+
+  /* Uncompressed data of the entry. Entry is found by an index built when reading the directory. */
   QByteArray fileData(const QString& fileName) const;
+
+  /* Decompress entry in chunks and write it into sink without keeping the whole entry in memory.
+   * Returns false if the entry was not found or on error. */
+  bool extractFile(const QString& fileName, QIODevice *sink) const;
+
   bool extractAll(const QString& destinationDir) const;
 
+  /* Map the archive file into memory when reading the directory if possible. Default is true.
+   * Has to be set before the first access. Ignored for devices that are not files. */
+  void setMemoryMapped(bool value);
+
+  /* true if the archive is mapped into memory */
+  bool isMemoryMapped() const;
+
   enum Status
   {
     NoError,
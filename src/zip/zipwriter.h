@@ -81,6 +81,16 @@ public:
   void setCreationPermissions(QFile::Permissions permissions);
   QFile::Permissions creationPermissions() const;
 
+  /* Compress added files in parallel on a thread pool. Files are written in order when the queue is full
+   * or on close. Default is 1 which compresses each file in addFile. */
+  void setNumThreads(int numThreads);
+  int numThreads() const;
+
+  /* Split files into blocks of this size for parallel compression of single large files (pigz-style).
+   * 0 disables splitting (default). */
+  void setParallelBlockSize(int blockSize);
+  int parallelBlockSize() const;
+
   void addFile(const QString& fileName, const QByteArray& data);
 
   void addFile(const QString& fileName, QIODevice *device);